@@ -16,8 +16,105 @@ const wss = new WebSocket.Server({ server });
 const OUTPUT_DIR = path.resolve(__dirname, './output');
 const ORCA_DIR = path.resolve(__dirname, './orca');
 
-// Function to find and read the latest orca_tick_*.json file
+// Shared-memory telemetry ring written by the backend (layout:
+// backend/api/TelemetryRing.hh); orca_tick_*.json files are the fallback
+const TELEMETRY_RING_PATH = path.join(ORCA_DIR, 'telemetry.ring');
+const TELEMETRY_RING_VERSION = 1;
+const RING_HEADER_BYTES = 64;
+const RING_SLOT_HEADER_BYTES = 32;
+const RING_RECORD_BYTES = 40;
+const RING_STATUS_NAMES = ['IDLE', 'BUSY', 'CHARGING', 'ERROR'];
+const RING_DRIVER_STATE_NAMES = ['IDLE', 'COMPUTING_PATH', 'MOVING', 'ARRIVED', 'STUCK', 'COLLISION_WAIT'];
+
+// Read the newest complete frame of the ring, or null if there is none
+async function readTelemetryRing() {
+  let file;
+  try {
+    file = await fs.open(TELEMETRY_RING_PATH, 'r');
+  } catch (error) {
+    return null;  // Backend writes orca_tick_*.json files instead
+  }
+  try {
+    const header = Buffer.alloc(RING_HEADER_BYTES);
+    const { bytesRead } = await file.read(header, 0, RING_HEADER_BYTES, 0);
+    if (bytesRead < RING_HEADER_BYTES || header.toString('ascii', 0, 8) !== 'AMRTELEM' ||
+        header.readUInt32LE(8) !== TELEMETRY_RING_VERSION) {
+      return null;
+    }
+    const slotCount = header.readUInt32LE(16);
+    const slotBytes = header.readUInt32LE(20);
+    const recordBytes = header.readUInt32LE(28);
+    const slot = Buffer.alloc(slotBytes);
+
+    // A frame is torn only if the writer laps the ring during the copy; retry then
+    for (let attempt = 0; attempt < 3; attempt++) {
+      await file.read(header, 0, RING_HEADER_BYTES, 0);
+      const framesWritten = header.readBigUInt64LE(32);
+      if (framesWritten === 0n) return null;
+      const frame = framesWritten - 1n;
+      const offset = RING_HEADER_BYTES + Number(frame % BigInt(slotCount)) * slotBytes;
+      await file.read(slot, 0, slotBytes, offset);
+
+      const seqFront = slot.readBigUInt64LE(0);
+      const seqBack = slot.readBigUInt64LE(slotBytes - 8);
+      if (seqFront !== frame + 1n || seqBack !== seqFront) continue;
+
+      const robots = [];
+      const robotCount = slot.readUInt32LE(24);
+      for (let i = 0; i < robotCount; i++) {
+        const at = RING_SLOT_HEADER_BYTES + i * recordBytes;
+        robots.push({
+          id: slot.readInt32LE(at),
+          x: slot.readInt32LE(at + 4),
+          y: slot.readInt32LE(at + 8),
+          vx: slot.readFloatLE(at + 12),
+          vy: slot.readFloatLE(at + 16),
+          battery: slot.readFloatLE(at + 20),
+          currentNodeId: slot.readInt32LE(at + 24),
+          targetNodeId: slot.readInt32LE(at + 28),
+          remainingWaypoints: slot.readInt32LE(at + 32),
+          status: RING_STATUS_NAMES[slot.readUInt8(at + 36)] || 'IDLE',
+          driverState: RING_DRIVER_STATE_NAMES[slot.readUInt8(at + 37)] || 'IDLE',
+          hasPackage: slot.readUInt8(at + 38) !== 0,
+          loadCount: slot.readUInt8(at + 38)
+        });
+      }
+      return {
+        tick: Number(slot.readBigUInt64LE(8)),
+        timestamp: new Date(Number(slot.readBigInt64LE(16))).toISOString(),
+        robots
+      };
+    }
+    return null;
+  } catch (error) {
+    console.error('Error reading telemetry ring:', error);
+    return null;
+  } finally {
+    await file.close();
+  }
+}
+
+// Newest tick file named by orca/latest (written by the backend after
+// each tick file), or null to list the directory instead
+async function readLatestPointer(dir) {
+  try {
+    const name = (await fs.readFile(path.join(dir, 'latest'), 'utf8')).trim();
+    if (!name) return null;
+    return JSON.parse(await fs.readFile(path.join(dir, name), 'utf8'));
+  } catch (error) {
+    return null;  // No pointer yet, or its file was just cleaned up
+  }
+}
+
+// Function to find and read the latest telemetry frame (ring, else the
+// file orca/latest names, else the latest orca_tick_*.json file)
 async function getLatestOrcaTick() {
+  const ringFrame = await readTelemetryRing();
+  if (ringFrame) return ringFrame;
+
+  const pointed = await readLatestPointer(ORCA_DIR);
+  if (pointed) return pointed;
+
   try {
     // Read all files in the orca directory
     const files = await fs.readdir(ORCA_DIR);
@@ -13,18 +13,35 @@
 #ifndef BACKEND_API_SERVICE_HH
 #define BACKEND_API_SERVICE_HH
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include <string>
 #include <fstream>
+#include <iostream>
 #include <mutex>
 #include <filesystem>
-#include <sstream>
-#include <iomanip>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <set>
+#include <unordered_map>
 
 #include "../common/include/Coordinates.hh"
+#include "../common/include/LatencyHistogram.hh"
+#include "../common/include/MemoryUsage.hh"
 #include "../layer3/include/Vector2.hh"
+#include "TelemetryRing.hh"
+#include "TelemetryCodec.hh"
+#include "JsonWriter.hh"
+#include "../include/PushServer.hh"
+#include "../include/BoundedMPSCQueue.hh"
+
+/// Times the private serializers for the microbenchmarks (backend/kernel_benchmark.cc)
+struct KernelBenchmarkAccess;
 
 namespace Backend {
 namespace API {
@@ -42,6 +59,17 @@ struct TasksInfo {
     int pending = 0;      ///< Pending tasks in queue
 };
 
+/**
+ * @brief Deadlock metrics for API output.
+ */
+struct DeadlockInfo {
+    int waiting = 0;                ///< Robots currently waiting on another robot
+    long long detected = 0;         ///< Wait-for cycles and long blocks found
+    long long resolved = 0;         ///< Of those, cleared by a reroute, back-off or yield
+    double blockedSeconds = 0.0;    ///< Robot-seconds spent waiting on another robot
+    double longestWaitSeconds = 0.0;  ///< Longest single wait
+};
+
 /**
  * @brief Charging station status for API output.
  */
@@ -75,7 +103,7 @@ struct RobotTelemetry {
     int currentNodeId;              ///< Current nearest NavMesh node
     int targetNodeId;               ///< Target node (or -1 if none)
     int remainingWaypoints;         ///< Remaining waypoints in itinerary
-    bool hasPackage;                ///< Whether robot is carrying a package
+    int loadCount;                  ///< Packages on board
 };
 
 /**
@@ -88,12 +116,44 @@ struct ObstacleInfo {
     std::string type;               ///< Obstacle type (e.g., "forklift", "pallet")
 };
 
+/**
+ * @brief One latency histogram for the metrics export.
+ */
+struct LatencyMetric {
+    std::string name;                           ///< Prometheus name without unit, e.g. "physics_tick"
+    std::string help;                           ///< One-line description
+    Common::LatencyHistogram::Summary summary;
+};
+
 /**
  * @brief Path segment for visualization.
  */
 struct PathSegment {
     int robotId;
-    std::vector<Common::Coordinates> waypoints;
+    std::vector<Common::Coordinates> waypoints;     ///< Empty = the robot has no path
+    uint64_t version = 0;                           ///< Driver's path version (RobotDriver::GetPathVersion)
+};
+
+/**
+ * @brief A serialized file waiting for the writer thread.
+ */
+struct FileWrite {
+    std::string folder;
+    std::string stem;               ///< File name without extension
+    std::string extension = ".json";
+    std::string content;
+    std::string stream;             ///< Writes of one stream supersede each other
+    long long tick = -1;            ///< Tick file (>= 0): old ticks are cleaned and folder/latest updated
+};
+
+/**
+ * @brief Counters of the writer thread.
+ */
+struct APIWriterStats {
+    uint64_t filesWritten = 0;
+    uint64_t coalesced = 0;         ///< Superseded by a newer write of the stream before reaching disk
+    uint64_t dropped = 0;           ///< Queue full
+    size_t maxBacklog = 0;          ///< Most writes taken in one batch
 };
 
 // =============================================================================
@@ -104,15 +164,30 @@ struct PathSegment {
  * @brief File-based API service for fleet visualization.
  * 
  * Writes JSON files to disk for the frontend to consume:
- * - orca/orca_tick_{N}.json - Robot telemetry at 20Hz
+ * - orca/telemetry.ring - Robot telemetry at 20Hz, shared-memory ring
+ *   (see TelemetryRing.hh) once OpenTelemetryRing succeeded
+ * - orca/orca_tick_{N}.json - Robot telemetry at 20Hz otherwise
  * - fleet/fleet_tick_{N}.json - Dynamic obstacles at 1Hz
  * - paths/paths_tick_{N}.json - Robot paths (on request)
+ * - output/metrics.prom - Latency percentiles (Prometheus text format)
+ * 
+ * With a PushServer attached, telemetry, obstacles and paths are also
+ * pushed to its WebSocket clients as they are broadcast.
  * 
- * Thread-safe: Uses internal mutex for file operations.
+ * Once StartWriter ran, callers only serialize: files go through a
+ * bounded queue to a writer thread, which writes each with a temp file
+ * and a rename, keeps only the newest queued write of each stream when
+ * behind, and points folder/latest at the newest tick file. A full queue
+ * drops the write rather than waiting. Before StartWriter (and after
+ * StopWriter) files are written by the caller.
+ * 
+ * Thread-safe: Uses internal mutex for the tick counters and the ring.
  */
 class APIService {
 private:
-    mutable std::mutex apiMutex_;   ///< Protects file I/O
+    friend struct ::KernelBenchmarkAccess;
+    
+    mutable std::mutex apiMutex_;   ///< Protects tick counters, the ring and synchronous writes
     std::string basePath_;          ///< Base directory for output
     long long tickPhysics_ = 0;     ///< Physics tick counter
     long long tickMap_ = 0;         ///< Map tick counter
@@ -121,6 +196,32 @@ private:
     bool enabled_ = true;           ///< Enable/disable file output
     int keepLastNFiles_ = 100;      ///< Keep only last N files per folder
     
+    TelemetryRing telemetryRing_;   ///< Replaces orca_tick_{N}.json while open
+    std::vector<TelemetryRecord> ringRecords_;  ///< Frame being encoded (reused)
+    
+    PushServer* pushServer_ = nullptr;  ///< Also pushes every broadcast when set (not owned)
+    /// Binary telemetry stream; only the push server's I/O thread uses it
+    std::shared_ptr<TelemetryDeltaEncoder> binaryEncoder_ = std::make_shared<TelemetryDeltaEncoder>();
+    std::map<int, PathSegment> pathsByRobot_;   ///< Every robot's current path (the PATHS snapshot)
+    
+    static constexpr size_t WRITE_QUEUE_CAPACITY = 256;
+    static constexpr int WRITER_IDLE_WAIT_MS = 20;      ///< Bounds a missed wake-up
+    
+    BoundedMPSCQueue<FileWrite> writeQueue_{WRITE_QUEUE_CAPACITY};
+    std::thread writerThread_;
+    std::atomic<bool> writerRunning_{false};
+    std::mutex writerMutex_;
+    std::condition_variable writerWake_;
+    std::condition_variable writerIdle_;
+    std::atomic<uint64_t> writesQueued_{0};
+    std::atomic<uint64_t> writesDone_{0};   ///< Written, coalesced or failed
+    std::atomic<uint64_t> filesWritten_{0};
+    std::atomic<uint64_t> writesCoalesced_{0};
+    std::atomic<uint64_t> writesDropped_{0};
+    std::atomic<size_t> maxBacklog_{0};
+    std::set<std::string> ensuredDirs_;             ///< Writer only
+    std::map<std::string, long long> cleanedBelow_; ///< Per folder; writer only
+    
     // =========================================================================
     // HELPERS
     // =========================================================================
@@ -135,49 +236,323 @@ private:
     }
     
     /**
-     * @brief Write content to a file.
+     * @brief Write folder/stem + extension through a temp file and a rename,
+     *        so concurrent readers never see a partial file.
      */
-    void WriteFile(const std::string& folder, const std::string& filename, 
-                   const std::string& content) const {
+    void WriteFileAtomic(const std::string& folder, const std::string& stem,
+                         const std::string& content, const std::string& extension = ".json") const {
+        // ATOMIC WRITE: Write to temp file, then rename
+        // Use a unique temp file to avoid conflicts with concurrent reads
         std::string dir = basePath_ + "/" + folder;
         EnsureDirectory(dir);
         
-        std::ofstream f(dir + "/" + filename);
+        // Use process-unique temp file to avoid conflicts
+        auto tempMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::string tempPath = dir + "/" + stem + "." + std::to_string(tempMs) + ".tmp";
+        std::string finalPath = dir + "/" + stem + extension;
+        
+        // Write to temp file
+        std::ofstream f(tempPath);
         if (f.is_open()) {
             f << content;
+            f.flush();  // Ensure data is written to disk
             f.close();
+            
+            // Atomic rename with retry for Windows
+            // Windows requires remove before rename, which creates a brief gap
+            // We retry to handle the case where another process is reading
+            #ifdef _WIN32
+            bool success = false;
+            for (int retry = 0; retry < 3 && !success; ++retry) {
+                try {
+                    // Try to remove old file (may fail if locked)
+                    std::error_code ec;
+                    std::filesystem::remove(finalPath, ec);
+                    // Ignore removal errors - file may not exist
+                    
+                    // Rename temp to final
+                    std::filesystem::rename(tempPath, finalPath);
+                    success = true;
+                } catch (const std::filesystem::filesystem_error&) {
+                    // Sleep briefly and retry
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            // Clean up temp file if rename failed
+            if (!success) {
+                std::filesystem::remove(tempPath);
+            }
+            #else
+            // POSIX: atomic rename
+            std::filesystem::rename(tempPath, finalPath);
+            #endif
         }
     }
     
     /**
      * @brief Clean old files, keeping only the last N.
+     * 
+     * Removes every tick below currentTick - N not removed yet, since
+     * coalescing may skip ticks.
      */
     void CleanOldFiles(const std::string& folder, const std::string& prefix, 
-                       long long currentTick) const {
+                       long long currentTick) {
         if (currentTick <= keepLastNFiles_) return;
         
         std::string dir = basePath_ + "/" + folder;
         long long deleteBelow = currentTick - keepLastNFiles_;
+        auto cleaned = cleanedBelow_.emplace(folder, deleteBelow).first;
         
-        std::string oldFile = dir + "/" + prefix + std::to_string(deleteBelow) + ".json";
-        if (std::filesystem::exists(oldFile)) {
-            std::filesystem::remove(oldFile);
+        std::error_code ec;
+        for (long long tick = std::min(cleaned->second, deleteBelow); tick <= deleteBelow; ++tick) {
+            std::filesystem::remove(dir + "/" + prefix + std::to_string(tick) + ".json", ec);
         }
+        cleaned->second = deleteBelow + 1;
     }
     
+    // =========================================================================
+    // WRITER THREAD
+    // =========================================================================
+    
     /**
-     * @brief Get current timestamp as ISO string.
+     * @brief Put a write on disk (writer thread, or the caller without one).
      */
-    std::string GetTimestamp() const {
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()) % 1000;
+    void PerformWrite(const FileWrite& write) {
+        try {
+            if (ensuredDirs_.insert(write.folder).second) EnsureDirectory(basePath_ + "/" + write.folder);
+            WriteFileAtomic(write.folder, write.stem, write.content, write.extension);
+            if (write.tick >= 0) {
+                WriteFileAtomic(write.folder, "latest", write.stem + write.extension + "\n", "");
+                CleanOldFiles(write.folder, write.stem.substr(0, write.stem.size() - std::to_string(write.tick).size()),
+                              write.tick);
+            }
+            filesWritten_++;
+        } catch (const std::filesystem::filesystem_error& e) {
+            std::cerr << "[API] Warning: could not write " << write.folder << "/" << write.stem
+                      << write.extension << ": " << e.what() << "\n";
+        }
+    }
+    
+    /**
+     * @brief Hand a write to the writer thread (or write it now without one).
+     */
+    void QueueWrite(FileWrite&& write) {
+        if (!writerRunning_.load()) {
+            std::lock_guard<std::mutex> lock(writerMutex_);
+            PerformWrite(write);
+            return;
+        }
+        if (!writeQueue_.TryPush(write)) {
+            writesDropped_++;
+            return;
+        }
+        writesQueued_++;
+        writerWake_.notify_one();
+    }
+    
+    void RunWriter(const std::function<void()>& onThreadStart) {
+        if (onThreadStart) onThreadStart();
+        std::vector<FileWrite> batch;
+        std::unordered_map<std::string, size_t> newest;
+        while (true) {
+            batch.clear();
+            writeQueue_.PopBatch(batch);
+            if (batch.empty()) {
+                if (!writerRunning_.load()) break;
+                std::unique_lock<std::mutex> lock(writerMutex_);
+                writerWake_.wait_for(lock, std::chrono::milliseconds(WRITER_IDLE_WAIT_MS));
+                continue;
+            }
+            if (batch.size() > maxBacklog_.load()) maxBacklog_ = batch.size();
+            
+            // Behind: only the newest write of each stream reaches disk
+            newest.clear();
+            for (size_t i = 0; i < batch.size(); ++i) newest[batch[i].stream] = i;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (newest[batch[i].stream] != i) {
+                    writesCoalesced_++;
+                    continue;
+                }
+                PerformWrite(batch[i]);
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(writerMutex_);
+                writesDone_ += batch.size();
+            }
+            writerIdle_.notify_all();
+        }
+    }
+
+    
+    /**
+     * @brief Index of name in names (0 if absent).
+     */
+    template <size_t N>
+    static uint8_t NameIndex(const std::string& name, const char* const (&names)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            if (name == names[i]) return static_cast<uint8_t>(i);
+        }
+        return 0;
+    }
+    
+    // =========================================================================
+    // ENCODERS (shared by the tick files and the push server)
+    // =========================================================================
+    
+    /// Bytes per element of each document, so a writer allocates once
+    static constexpr size_t TELEMETRY_BYTES_PER_ROBOT = 400;
+    static constexpr size_t OBSTACLE_BYTES = 160;
+    static constexpr size_t PATH_BYTES = 64;
+    static constexpr size_t WAYPOINT_BYTES = 32;
+    
+    static void WriteHeader(JsonWriter& out, long long tick, std::chrono::system_clock::time_point at,
+                            std::string_view arrayName) {
+        out.Raw("{\n  \"tick\": ").Int(tick).Raw(",\n  \"timestamp\": \"").Timestamp(at)
+           .Raw("\",\n  \"").Raw(arrayName).Raw("\": [\n");
+    }
+    
+    static std::string EncodeTelemetry(long long tick, std::chrono::system_clock::time_point at,
+                                       const std::vector<RobotTelemetry>& data) {
+        JsonWriter out(128 + data.size() * TELEMETRY_BYTES_PER_ROBOT);
+        WriteHeader(out, tick, at, "robots");
+        
+        for (size_t i = 0; i < data.size(); ++i) {
+            const auto& r = data[i];
+            out.Raw("    {\n      \"id\": ").Int(r.id)
+               .Raw(",\n      \"x\": ").Int(r.pos.x)
+               .Raw(",\n      \"y\": ").Int(r.pos.y)
+               .Raw(",\n      \"vx\": ").Fixed(r.velocity.x, 4)
+               .Raw(",\n      \"vy\": ").Fixed(r.velocity.y, 4)
+               .Raw(",\n      \"status\": ").String(r.status)
+               .Raw(",\n      \"driverState\": ").String(r.driverState)
+               .Raw(",\n      \"battery\": ").Fixed(r.battery, 4)
+               .Raw(",\n      \"currentNodeId\": ").Int(r.currentNodeId)
+               .Raw(",\n      \"targetNodeId\": ").Int(r.targetNodeId)
+               .Raw(",\n      \"remainingWaypoints\": ").Int(r.remainingWaypoints)
+               .Raw(",\n      \"hasPackage\": ").Bool(r.loadCount > 0)
+               .Raw(",\n      \"loadCount\": ").Int(r.loadCount)
+               .Raw(i + 1 < data.size() ? "\n    },\n" : "\n    }\n");
+        }
+        
+        out.Raw("  ]\n}\n");
+        return out.Take();
+    }
+    
+    static std::string EncodeObstacles(long long tick, std::chrono::system_clock::time_point at,
+                                       const std::vector<ObstacleInfo>& obstacles) {
+        JsonWriter out(128 + obstacles.size() * OBSTACLE_BYTES);
+        WriteHeader(out, tick, at, "obstacles");
+        
+        for (size_t i = 0; i < obstacles.size(); ++i) {
+            const auto& o = obstacles[i];
+            out.Raw("    {\n      \"x\": ").Int(o.topLeft.x)
+               .Raw(",\n      \"y\": ").Int(o.topLeft.y)
+               .Raw(",\n      \"width\": ").Int(o.width)
+               .Raw(",\n      \"height\": ").Int(o.height)
+               .Raw(",\n      \"type\": ").String(o.type)
+               .Raw(i + 1 < obstacles.size() ? "\n    },\n" : "\n    }\n");
+        }
         
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&time), "%Y-%m-%dT%H:%M:%S");
-        ss << "." << std::setfill('0') << std::setw(3) << ms.count();
-        return ss.str();
+        out.Raw("  ]\n}\n");
+        return out.Take();
+    }
+    
+    static std::string EncodePaths(long long tick, std::chrono::system_clock::time_point at,
+                                   const std::vector<PathSegment>& paths) {
+        size_t waypoints = 0;
+        for (const auto& p : paths) waypoints += p.waypoints.size();
+        JsonWriter out(128 + paths.size() * PATH_BYTES + waypoints * WAYPOINT_BYTES);
+        WriteHeader(out, tick, at, "paths");
+        
+        for (size_t i = 0; i < paths.size(); ++i) {
+            const auto& p = paths[i];
+            out.Raw("    {\n      \"robotId\": ").Int(p.robotId).Raw(",\n      \"version\": ").UInt(p.version)
+               .Raw(",\n      \"waypoints\": [\n");
+            for (size_t j = 0; j < p.waypoints.size(); ++j) {
+                out.Raw("        {\"x\": ").Int(p.waypoints[j].x).Raw(", \"y\": ").Int(p.waypoints[j].y)
+                   .Raw(j + 1 < p.waypoints.size() ? "},\n" : "}\n");
+            }
+            out.Raw(i + 1 < paths.size() ? "      ]\n    },\n" : "      ]\n    }\n");
+        }
+        
+        out.Raw("  ]\n}\n");
+        return out.Take();
+    }
+    
+    /**
+     * @brief Hand a copy of data to the push server, encoded on its I/O thread.
+     */
+    template <typename T>
+    void Push(PushChannel channel, long long tick, std::chrono::system_clock::time_point at,
+              const std::vector<T>& data,
+              std::string (*encode)(long long, std::chrono::system_clock::time_point, const std::vector<T>&)) {
+        if (!pushServer_ || !pushServer_->IsRunning()) return;
+        auto copy = std::make_shared<const std::vector<T>>(data);
+        pushServer_->Publish(channel, [encode, tick, at, copy]() { return encode(tick, at, *copy); });
+    }
+    
+    /// Hash of what a client sees of a robot (changedOnly compares these)
+    static uint64_t Fingerprint(const RobotTelemetry& r) {
+        uint64_t h = 1469598103934665603ull;
+        auto mix = [&h](uint64_t v) { h = (h ^ v) * 1099511628211ull; };
+        mix(static_cast<uint32_t>(r.pos.x));
+        mix(static_cast<uint32_t>(r.pos.y));
+        mix(static_cast<uint64_t>(std::llround(r.velocity.x * 10000.0)));
+        mix(static_cast<uint64_t>(std::llround(r.velocity.y * 10000.0)));
+        mix(static_cast<uint64_t>(std::llround(r.battery * 10000.0)));
+        mix(std::hash<std::string>{}(r.status));
+        mix(std::hash<std::string>{}(r.driverState));
+        mix(static_cast<uint32_t>(r.currentNodeId));
+        mix(static_cast<uint32_t>(r.targetNodeId));
+        mix(static_cast<uint32_t>(r.remainingWaypoints));
+        mix(static_cast<uint32_t>(r.loadCount));
+        return h;
+    }
+    
+    /**
+     * @brief Telemetry for one subscribed client: its robots, in its
+     *        viewport, and with changedOnly those it has not seen as they are.
+     */
+    static std::string EncodeTelemetryFor(long long tick, std::chrono::system_clock::time_point at,
+                                          const std::vector<RobotTelemetry>& data,
+                                          const PushInterest& interest, PushClientMemory& memory) {
+        std::vector<RobotTelemetry> kept;
+        kept.reserve(data.size());
+        for (const auto& r : data) {
+            if (!interest.WantsRobot(r.id) || !interest.WantsPosition(r.pos.x, r.pos.y)) continue;
+            if (interest.changedOnly) {
+                uint64_t fingerprint = Fingerprint(r);
+                auto [it, inserted] = memory.sent.try_emplace(r.id, fingerprint);
+                if (!inserted) {
+                    if (it->second == fingerprint) continue;
+                    it->second = fingerprint;
+                }
+            }
+            kept.push_back(r);
+        }
+        if (kept.empty() && interest.changedOnly) return "";
+        return EncodeTelemetry(tick, at, kept);
+    }
+    
+    /**
+     * @brief Changed paths for one subscribed client: its robots, and in a
+     *        viewport those with a waypoint inside it (or just cleared).
+     */
+    static std::string EncodePathsFor(long long tick, std::chrono::system_clock::time_point at,
+                                      const std::vector<PathSegment>& paths, const PushInterest& interest) {
+        std::vector<PathSegment> kept;
+        for (const auto& p : paths) {
+            if (!interest.WantsRobot(p.robotId)) continue;
+            bool visible = p.waypoints.empty() || !interest.hasViewport;
+            for (size_t i = 0; i < p.waypoints.size() && !visible; ++i) {
+                visible = interest.WantsPosition(p.waypoints[i].x, p.waypoints[i].y);
+            }
+            if (visible) kept.push_back(p);
+        }
+        if (kept.empty()) return "";
+        return EncodePaths(tick, at, kept);
     }
 
 public:
@@ -208,6 +583,82 @@ public:
     
     void SetKeepLastNFiles(int n) { keepLastNFiles_ = n; }
     
+    /**
+     * @brief Move file writes off the calling threads onto a writer thread.
+     * 
+     * @param onThreadStart Run first on the writer thread (e.g. thread placement)
+     */
+    void StartWriter(std::function<void()> onThreadStart = nullptr) {
+        if (writerRunning_.exchange(true)) return;
+        writerThread_ = std::thread(&APIService::RunWriter, this, std::move(onThreadStart));
+    }
+    
+    /**
+     * @brief Wait until every write queued so far is on disk (or coalesced).
+     */
+    void Flush() {
+        if (!writerRunning_.load()) return;
+        std::unique_lock<std::mutex> lock(writerMutex_);
+        uint64_t target = writesQueued_.load();
+        writerIdle_.wait(lock, [&]() { return writesDone_.load() >= target; });
+    }
+    
+    /**
+     * @brief Write what is queued and join the writer thread.
+     */
+    void StopWriter() {
+        if (!writerRunning_.load()) return;
+        Flush();
+        writerRunning_ = false;
+        writerWake_.notify_one();
+        if (writerThread_.joinable()) writerThread_.join();
+    }
+    
+    APIWriterStats GetWriterStats() const {
+        APIWriterStats stats;
+        stats.filesWritten = filesWritten_.load();
+        stats.coalesced = writesCoalesced_.load();
+        stats.dropped = writesDropped_.load();
+        stats.maxBacklog = maxBacklog_.load();
+        return stats;
+    }
+    
+    ~APIService() { StopWriter(); }
+    
+    /**
+     * @brief Publish telemetry through orca/telemetry.ring from now on.
+     * 
+     * @param slots Frames kept (0 = per-tick JSON files; a ring left by an
+     *              earlier run is removed so readers fall back to them)
+     * @param maxRobots Robots per frame
+     * @return false if the ring is not used (JSON files continue)
+     */
+    bool OpenTelemetryRing(int slots, int maxRobots) {
+        std::lock_guard<std::mutex> lock(apiMutex_);
+        std::string path = basePath_ + "/orca/telemetry.ring";
+        if (slots <= 0) {
+            telemetryRing_.Close();
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return false;
+        }
+        EnsureDirectory(basePath_ + "/orca");
+        return telemetryRing_.Open(path, static_cast<uint32_t>(slots),
+                                   static_cast<uint32_t>(std::max(1, maxRobots)));
+    }
+    
+    bool IsTelemetryRingOpen() const { return telemetryRing_.IsOpen(); }
+    
+    /**
+     * @brief Also push every broadcast through server (nullptr = stop).
+     * 
+     * The server must outlive this service or be detached first.
+     */
+    void SetPushServer(PushServer* server) {
+        std::lock_guard<std::mutex> lock(apiMutex_);
+        pushServer_ = server;
+    }
+    
     void SetBasePath(const std::string& path) { 
         basePath_ = path;
         EnsureDirectory(basePath_ + "/orca");
@@ -222,7 +673,9 @@ public:
     /**
      * @brief Broadcast robot telemetry (20 Hz).
      * 
-     * Writes to: orca/orca_tick_{N}.json
+     * Writes to: orca/telemetry.ring, else orca/orca_tick_{N}.json;
+     * pushed on PushChannel::TELEMETRY as JSON and as the binary
+     * keyframe / delta stream of TelemetryCodec.hh
      * 
      * @param data Vector of robot telemetry data
      */
@@ -230,45 +683,67 @@ public:
         if (!enabled_) return;
         
         std::lock_guard<std::mutex> lock(apiMutex_);
-        
-        std::stringstream ss;
-        ss << "{\n";
-        ss << "  \"tick\": " << tickPhysics_ << ",\n";
-        ss << "  \"timestamp\": \"" << GetTimestamp() << "\",\n";
-        ss << "  \"robots\": [\n";
-        
-        for (size_t i = 0; i < data.size(); ++i) {
-            const auto& r = data[i];
-            ss << "    {\n";
-            ss << "      \"id\": " << r.id << ",\n";
-            ss << "      \"x\": " << r.pos.x << ",\n";
-            ss << "      \"y\": " << r.pos.y << ",\n";
-            ss << "      \"vx\": " << std::fixed << std::setprecision(4) << r.velocity.x << ",\n";
-            ss << "      \"vy\": " << std::fixed << std::setprecision(4) << r.velocity.y << ",\n";
-            ss << "      \"status\": \"" << r.status << "\",\n";
-            ss << "      \"driverState\": \"" << r.driverState << "\",\n";
-            ss << "      \"battery\": " << r.battery << ",\n";
-            ss << "      \"currentNodeId\": " << r.currentNodeId << ",\n";
-            ss << "      \"targetNodeId\": " << r.targetNodeId << ",\n";
-            ss << "      \"remainingWaypoints\": " << r.remainingWaypoints << ",\n";
-            ss << "      \"hasPackage\": " << (r.hasPackage ? "true" : "false") << "\n";
-            ss << "    }";
-            if (i < data.size() - 1) ss << ",";
-            ss << "\n";
+        const auto now = std::chrono::system_clock::now();
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        const bool pushing = pushServer_ && pushServer_->IsRunning();
+        if (pushing) {
+            auto copy = std::make_shared<const std::vector<RobotTelemetry>>(data);
+            long long tick = tickPhysics_;
+            pushServer_->Publish(PushChannel::TELEMETRY,
+                [copy, tick, now]() { return EncodeTelemetry(tick, now, *copy); },
+                [copy, tick, now](const PushInterest& interest, PushClientMemory& memory) {
+                    return EncodeTelemetryFor(tick, now, *copy, interest, memory);
+                });
+        }
+        if (telemetryRing_.IsOpen() || pushing) {
+            ringRecords_.resize(data.size());
+            for (size_t i = 0; i < data.size(); ++i) {
+                const auto& r = data[i];
+                TelemetryRecord& record = ringRecords_[i];
+                record.id = r.id;
+                record.x = r.pos.x;
+                record.y = r.pos.y;
+                record.vx = static_cast<float>(r.velocity.x);
+                record.vy = static_cast<float>(r.velocity.y);
+                record.battery = r.battery;
+                record.currentNodeId = r.currentNodeId;
+                record.targetNodeId = r.targetNodeId;
+                record.remainingWaypoints = r.remainingWaypoints;
+                record.status = NameIndex(r.status, TELEMETRY_STATUS_NAMES);
+                record.driverState = NameIndex(r.driverState, TELEMETRY_DRIVER_STATE_NAMES);
+                record.loadCount = static_cast<uint8_t>(std::min(r.loadCount, 255));
+                record.reserved = 0;
+            }
+        }
+        if (pushing) {
+            auto records = std::make_shared<const std::vector<TelemetryRecord>>(ringRecords_);
+            auto encoder = binaryEncoder_;
+            uint64_t tick = static_cast<uint64_t>(tickPhysics_);
+            pushServer_->PublishBinary(PushChannel::TELEMETRY, [encoder, records, tick, ms]() {
+                TelemetryBinaryFrame encoded = encoder->Encode(tick, ms, records->data(), records->size());
+                PushBinaryFrame frame;
+                frame.id = encoded.tick;
+                frame.base = encoded.baseTick;
+                frame.keyframe = std::move(encoded.keyframe);
+                frame.delta = std::move(encoded.delta);
+                return frame;
+            });
+        }
+        if (telemetryRing_.IsOpen()) {
+            telemetryRing_.Write(static_cast<uint64_t>(tickPhysics_), ms, ringRecords_.data(), ringRecords_.size());
+            tickPhysics_++;
+            return;
         }
         
-        ss << "  ]\n";
-        ss << "}\n";
-        
-        WriteFile("orca", "orca_tick_" + std::to_string(tickPhysics_) + ".json", ss.str());
-        CleanOldFiles("orca", "orca_tick_", tickPhysics_);
+        QueueWrite({"orca", "orca_tick_" + std::to_string(tickPhysics_), ".json",
+                    EncodeTelemetry(tickPhysics_, now, data), "orca", tickPhysics_});
         tickPhysics_++;
     }
     
     /**
      * @brief Broadcast dynamic obstacles (1 Hz).
      * 
-     * Writes to: fleet/fleet_tick_{N}.json
+     * Writes to: fleet/fleet_tick_{N}.json; pushed on PushChannel::OBSTACLES
      * 
      * @param obstacles Vector of obstacle data
      */
@@ -276,76 +751,56 @@ public:
         if (!enabled_) return;
         
         std::lock_guard<std::mutex> lock(apiMutex_);
+        const auto now = std::chrono::system_clock::now();
+        Push(PushChannel::OBSTACLES, tickMap_, now, obstacles, &APIService::EncodeObstacles);
         
-        std::stringstream ss;
-        ss << "{\n";
-        ss << "  \"tick\": " << tickMap_ << ",\n";
-        ss << "  \"timestamp\": \"" << GetTimestamp() << "\",\n";
-        ss << "  \"obstacles\": [\n";
-        
-        for (size_t i = 0; i < obstacles.size(); ++i) {
-            const auto& o = obstacles[i];
-            ss << "    {\n";
-            ss << "      \"x\": " << o.topLeft.x << ",\n";
-            ss << "      \"y\": " << o.topLeft.y << ",\n";
-            ss << "      \"width\": " << o.width << ",\n";
-            ss << "      \"height\": " << o.height << ",\n";
-            ss << "      \"type\": \"" << o.type << "\"\n";
-            ss << "    }";
-            if (i < obstacles.size() - 1) ss << ",";
-            ss << "\n";
-        }
-        
-        ss << "  ]\n";
-        ss << "}\n";
-        
-        WriteFile("fleet", "fleet_tick_" + std::to_string(tickMap_) + ".json", ss.str());
-        CleanOldFiles("fleet", "fleet_tick_", tickMap_);
+        QueueWrite({"fleet", "fleet_tick_" + std::to_string(tickMap_), ".json",
+                    EncodeObstacles(tickMap_, now, obstacles), "fleet", tickMap_});
         tickMap_++;
     }
     
     /**
-     * @brief Broadcast robot paths (on demand).
+     * @brief Broadcast the robot paths that changed.
      * 
-     * Writes to: paths/paths_tick_{N}.json
+     * Writes to: paths/paths_tick_{N}.json; pushed on PushChannel::PATHS.
+     * Both carry only the given paths (a cleared path has no waypoints);
+     * clients joining later, and GET /paths, get every robot's current path.
+     * Paths whose version was already broadcast are skipped.
      * 
-     * @param paths Vector of path segments per robot
+     * @param changed Path segments of the robots whose path changed
      */
-    void BroadcastPaths(const std::vector<PathSegment>& paths) {
+    void BroadcastPaths(const std::vector<PathSegment>& changed) {
         if (!enabled_) return;
         
         std::lock_guard<std::mutex> lock(apiMutex_);
-        
-        std::stringstream ss;
-        ss << "{\n";
-        ss << "  \"tick\": " << tickPaths_ << ",\n";
-        ss << "  \"timestamp\": \"" << GetTimestamp() << "\",\n";
-        ss << "  \"paths\": [\n";
-        
-        for (size_t i = 0; i < paths.size(); ++i) {
-            const auto& p = paths[i];
-            ss << "    {\n";
-            ss << "      \"robotId\": " << p.robotId << ",\n";
-            ss << "      \"waypoints\": [\n";
-            
-            for (size_t j = 0; j < p.waypoints.size(); ++j) {
-                ss << "        {\"x\": " << p.waypoints[j].x 
-                   << ", \"y\": " << p.waypoints[j].y << "}";
-                if (j < p.waypoints.size() - 1) ss << ",";
-                ss << "\n";
-            }
-            
-            ss << "      ]\n";
-            ss << "    }";
-            if (i < paths.size() - 1) ss << ",";
-            ss << "\n";
+        std::vector<PathSegment> paths;
+        paths.reserve(changed.size());
+        for (const auto& p : changed) {
+            auto it = pathsByRobot_.find(p.robotId);
+            if (it != pathsByRobot_.end() && p.version != 0 && it->second.version == p.version) continue;
+            pathsByRobot_[p.robotId] = p;
+            paths.push_back(p);
+        }
+        if (paths.empty()) return;
+        
+        const auto now = std::chrono::system_clock::now();
+        if (pushServer_ && pushServer_->IsRunning()) {
+            auto copy = std::make_shared<const std::vector<PathSegment>>(paths);
+            std::vector<PathSegment> all;
+            all.reserve(pathsByRobot_.size());
+            for (const auto& entry : pathsByRobot_) all.push_back(entry.second);
+            auto current = std::make_shared<const std::vector<PathSegment>>(std::move(all));
+            long long tick = tickPaths_;
+            pushServer_->Publish(PushChannel::PATHS,
+                [copy, tick, now]() { return EncodePaths(tick, now, *copy); },
+                [copy, tick, now](const PushInterest& interest, PushClientMemory&) {
+                    return EncodePathsFor(tick, now, *copy, interest);
+                },
+                [current, tick, now]() { return EncodePaths(tick, now, *current); });
         }
         
-        ss << "  ]\n";
-        ss << "}\n";
-        
-        WriteFile("paths", "paths_tick_" + std::to_string(tickPaths_) + ".json", ss.str());
-        CleanOldFiles("paths", "paths_tick_", tickPaths_);
+        QueueWrite({"paths", "paths_tick_" + std::to_string(tickPaths_), ".json",
+                    EncodePaths(tickPaths_, now, paths), "paths", tickPaths_});
         tickPaths_++;
     }
     
@@ -359,8 +814,7 @@ public:
     void WriteSolution(const std::string& content) {
         if (!enabled_) return;
         
-        std::lock_guard<std::mutex> lock(apiMutex_);
-        WriteFile(".", "solution.json", content);
+        QueueWrite({".", "solution", ".json", content, "solution"});
     }
     
     /**
@@ -373,17 +827,17 @@ public:
      * @param tasks Task statistics
      * @param stations Charging station statuses
      * @param history History points (computed atomically by FleetManager)
+     * @param deadlocks Deadlock metrics
      */
     void WriteRobotsJSON(
         const std::vector<RobotTelemetry>& robots,
         const TasksInfo& tasks,
         const std::vector<ChargingStationStatus>& stations,
-        const std::vector<HistoryPoint>& history
+        const std::vector<HistoryPoint>& history,
+        const DeadlockInfo& deadlocks = DeadlockInfo()
     ) {
         if (!enabled_) return;
         
-        std::lock_guard<std::mutex> lock(apiMutex_);
-        
         // Get current timestamp in milliseconds
         auto now = std::chrono::system_clock::now();
         auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -394,117 +848,133 @@ public:
         // =====================================================================
         // JSON OUTPUT
         // =====================================================================
-        std::stringstream ss;
-        ss << "{\n";
-        ss << "  \"timestamp\": " << ms << ",\n";
-        ss << "  \"robotCount\": " << robots.size() << ",\n";
+        JsonWriter out(1024 + robots.size() * 256 + stations.size() * 128 + history.size() * 96);
+        out.Raw("{\n  \"timestamp\": ").Int(ms)
+           .Raw(",\n  \"robotCount\": ").UInt(robots.size()).Raw(",\n");
         
         // Robots array
-        ss << "  \"robots\": [\n";
+        out.Raw("  \"robots\": [\n");
         for (size_t i = 0; i < robots.size(); ++i) {
             const auto& r = robots[i];
-            ss << "    {\n";
-            ss << "      \"id\": " << r.id << ",\n";
-            ss << "      \"x\": " << r.pos.x << ",\n";
-            ss << "      \"y\": " << r.pos.y << ",\n";
-            ss << "      \"vx\": " << std::fixed << std::setprecision(2) << r.velocity.x << ",\n";
-            ss << "      \"vy\": " << std::fixed << std::setprecision(2) << r.velocity.y << ",\n";
-            ss << "      \"state\": \"" << r.driverState << "\",\n";
-            ss << "      \"batteryLevel\": " << static_cast<int>(r.battery * 100) << ",\n";
-            ss << "      \"goal\": " << (r.targetNodeId >= 0 ? std::to_string(r.targetNodeId) : "null") << ",\n";
-            ss << "      \"itinerary\": " << r.remainingWaypoints << "\n";
-            ss << "    }";
-            if (i < robots.size() - 1) ss << ",";
-            ss << "\n";
+            out.Raw("    {\n      \"id\": ").Int(r.id)
+               .Raw(",\n      \"x\": ").Int(r.pos.x)
+               .Raw(",\n      \"y\": ").Int(r.pos.y)
+               .Raw(",\n      \"vx\": ").Fixed(r.velocity.x, 2)
+               .Raw(",\n      \"vy\": ").Fixed(r.velocity.y, 2)
+               .Raw(",\n      \"state\": ").String(r.driverState)
+               .Raw(",\n      \"batteryLevel\": ").Int(static_cast<int>(r.battery * 100))
+               .Raw(",\n      \"goal\": ");
+            if (r.targetNodeId >= 0) out.Int(r.targetNodeId); else out.Raw("null");
+            out.Raw(",\n      \"itinerary\": ").Int(r.remainingWaypoints)
+               .Raw(i + 1 < robots.size() ? "\n    },\n" : "\n    }\n");
         }
-        ss << "  ],\n";
+        out.Raw("  ],\n");
         
         // Tasks object
-        ss << "  \"tasks\": {\n";
-        ss << "    \"active\": " << tasks.active << ",\n";
-        ss << "    \"completed\": " << tasks.completed << ",\n";
-        ss << "    \"pending\": " << tasks.pending << "\n";
-        ss << "  },\n";
+        out.Raw("  \"tasks\": {\n    \"active\": ").Int(tasks.active)
+           .Raw(",\n    \"completed\": ").Int(tasks.completed)
+           .Raw(",\n    \"pending\": ").Int(tasks.pending).Raw("\n  },\n");
+        
+        // Deadlocks object
+        out.Raw("  \"deadlocks\": {\n    \"waiting\": ").Int(deadlocks.waiting)
+           .Raw(",\n    \"detected\": ").Int(deadlocks.detected)
+           .Raw(",\n    \"resolved\": ").Int(deadlocks.resolved)
+           .Raw(",\n    \"blockedSeconds\": ").Fixed(deadlocks.blockedSeconds, 1)
+           .Raw(",\n    \"longestWaitSeconds\": ").Fixed(deadlocks.longestWaitSeconds, 1).Raw("\n  },\n");
         
         // Charging stations array
-        ss << "  \"charging_stations\": [\n";
+        out.Raw("  \"charging_stations\": [\n");
         for (size_t i = 0; i < stations.size(); ++i) {
             const auto& s = stations[i];
-            ss << "    {\n";
-            ss << "      \"id\": " << s.id << ",\n";
-            ss << "      \"x\": " << s.x << ",\n";
-            ss << "      \"y\": " << s.y << ",\n";
-            ss << "      \"status\": \"" << s.status << "\",\n";
-            ss << "      \"robot\": " << (s.robotId >= 0 ? std::to_string(s.robotId) : "null") << "\n";
-            ss << "    }";
-            if (i < stations.size() - 1) ss << ",";
-            ss << "\n";
+            out.Raw("    {\n      \"id\": ").Int(s.id)
+               .Raw(",\n      \"x\": ").Int(s.x)
+               .Raw(",\n      \"y\": ").Int(s.y)
+               .Raw(",\n      \"status\": ").String(s.status)
+               .Raw(",\n      \"robot\": ");
+            if (s.robotId >= 0) out.Int(s.robotId); else out.Raw("null");
+            out.Raw(i + 1 < stations.size() ? "\n    },\n" : "\n    }\n");
         }
-        ss << "  ],\n";
+        out.Raw("  ],\n");
         
         // History array (last 20 minutes of per-minute data)
-        ss << "  \"history\": [\n";
+        out.Raw("  \"history\": [\n");
         for (size_t i = 0; i < history.size(); ++i) {
             const auto& h = history[i];
-            ss << "    {\n";
-            ss << "      \"timestamp\": " << h.timestamp << ",\n";
-            ss << "      \"completedDelta\": " << h.completedDelta << ",\n";
-            ss << "      \"activeCount\": " << h.activeCount << "\n";
-            ss << "    }";
-            if (i < history.size() - 1) ss << ",";
-            ss << "\n";
+            out.Raw("    {\n      \"timestamp\": ").Int(h.timestamp)
+               .Raw(",\n      \"completedDelta\": ").Int(h.completedDelta)
+               .Raw(",\n      \"activeCount\": ").Int(h.activeCount)
+               .Raw(i + 1 < history.size() ? "\n    },\n" : "\n    }\n");
         }
-        ss << "  ]\n";
+        out.Raw("  ]\n}\n");
         
-        ss << "}\n";
-        
-        // ATOMIC WRITE: Write to temp file, then rename
-        // Use a unique temp file to avoid conflicts with concurrent reads
-        std::string dir = basePath_ + "/output";
-        EnsureDirectory(dir);
-        
-        // Use process-unique temp file to avoid conflicts
-        auto tempMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now().time_since_epoch()).count();
-        std::string tempPath = dir + "/robots." + std::to_string(tempMs) + ".tmp";
-        std::string finalPath = dir + "/robots.json";
+        QueueWrite({"output", "robots", ".json", out.Take(), "output/robots"});
+    }
+    
+    /**
+     * @brief Bytes held by the telemetry ring mapping, the frame scratch
+     *        and the path snapshot (queued file writes are not counted).
+     */
+    size_t GetMemoryBytes() const {
+        std::lock_guard<std::mutex> lock(apiMutex_);
+        size_t bytes = telemetryRing_.GetMappedBytes() + Common::VectorBytes(ringRecords_);
+        for (const auto& entry : pathsByRobot_) {
+            bytes += sizeof(entry) + 3 * sizeof(void*) + Common::VectorBytes(entry.second.waypoints);
+        }
+        return bytes;
+    }
+    
+    /**
+     * @brief Write output/metrics.prom in the Prometheus text format.
+     * 
+     * Each histogram becomes a summary in seconds with p50, p99 and p99.9
+     * quantiles, its _sum and _count, plus a _max gauge, so a scraper (or
+     * the node exporter's textfile collector) can alert on the tail.
+     * A memory report adds one bytes gauge per subsystem and the bytes
+     * per robot, POI and map pixel.
+     * Written with the same temp-file rename as robots.json.
+     */
+    void WriteMetrics(const std::vector<LatencyMetric>& metrics,
+                      const Common::MemoryReport* memory = nullptr) {
+        if (!enabled_) return;
         
-        // Write to temp file
-        std::ofstream f(tempPath);
-        if (f.is_open()) {
-            f << ss.str();
-            f.flush();  // Ensure data is written to disk
-            f.close();
-            
-            // Atomic rename with retry for Windows
-            // Windows requires remove before rename, which creates a brief gap
-            // We retry to handle the case where another process is reading
-            #ifdef _WIN32
-            bool success = false;
-            for (int retry = 0; retry < 3 && !success; ++retry) {
-                try {
-                    // Try to remove old file (may fail if locked)
-                    std::error_code ec;
-                    std::filesystem::remove(finalPath, ec);
-                    // Ignore removal errors - file may not exist
-                    
-                    // Rename temp to final
-                    std::filesystem::rename(tempPath, finalPath);
-                    success = true;
-                } catch (const std::filesystem::filesystem_error&) {
-                    // Sleep briefly and retry
-                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                }
-            }
-            // Clean up temp file if rename failed
-            if (!success) {
-                std::filesystem::remove(tempPath);
+        auto seconds = [](uint64_t us) { return static_cast<double>(us) / 1e6; };
+        JsonWriter out(metrics.size() * 640);
+        for (const auto& metric : metrics) {
+            const std::string name = "mecalux_" + metric.name + "_seconds";
+            const auto& summary = metric.summary;
+            out.Raw("# HELP ").Raw(name).Raw(" ").Raw(metric.help).Raw("\n");
+            out.Raw("# TYPE ").Raw(name).Raw(" summary\n");
+            out.Raw(name).Raw("{quantile=\"0.5\"} ").General(seconds(summary.p50Us)).Raw("\n");
+            out.Raw(name).Raw("{quantile=\"0.99\"} ").General(seconds(summary.p99Us)).Raw("\n");
+            out.Raw(name).Raw("{quantile=\"0.999\"} ").General(seconds(summary.p999Us)).Raw("\n");
+            out.Raw(name).Raw("_sum ").General(seconds(summary.sumUs)).Raw("\n");
+            out.Raw(name).Raw("_count ").UInt(summary.count).Raw("\n");
+            out.Raw("# HELP ").Raw(name).Raw("_max Largest sample of ").Raw(metric.name).Raw("\n");
+            out.Raw("# TYPE ").Raw(name).Raw("_max gauge\n");
+            out.Raw(name).Raw("_max ").General(seconds(summary.maxUs)).Raw("\n");
+        }
+        if (memory) {
+            out.Raw("# HELP mecalux_memory_bytes Heap bytes held per subsystem\n");
+            out.Raw("# TYPE mecalux_memory_bytes gauge\n");
+            for (const auto& entry : memory->entries) {
+                out.Raw("mecalux_memory_bytes{subsystem=\"").Raw(entry.name).Raw("\",scale=\"")
+                   .Raw(Common::MemoryReport::ScaleName(entry.scale)).Raw("\"} ").UInt(entry.bytes).Raw("\n");
             }
-            #else
-            // POSIX: atomic rename
-            std::filesystem::rename(tempPath, finalPath);
-            #endif
+            auto gauge = [&out](const char* name, const char* help, double value, int significant) {
+                out.Raw("# HELP ").Raw(name).Raw(" ").Raw(help).Raw("\n");
+                out.Raw("# TYPE ").Raw(name).Raw(" gauge\n");
+                out.Raw(name).Raw(" ").General(value, significant).Raw("\n");
+            };
+            gauge("mecalux_memory_total_bytes", "Heap bytes held by all subsystems",
+                  static_cast<double>(memory->GetTotalBytes()), 15);
+            gauge("mecalux_memory_resident_bytes", "Process resident set",
+                  static_cast<double>(memory->rssBytes), 15);
+            gauge("mecalux_memory_bytes_per_robot", "Robot-scaled bytes per robot", memory->GetBytesPerRobot(), 6);
+            gauge("mecalux_memory_bytes_per_poi", "POI-scaled bytes per POI", memory->GetBytesPerPOI(), 6);
+            gauge("mecalux_memory_bytes_per_map_pixel", "Map-scaled bytes per map pixel", memory->GetBytesPerPixel(), 6);
         }
+        
+        QueueWrite({"output", "metrics", ".prom", out.Take(), "output/metrics"});
     }
     
     /**
@@ -0,0 +1,149 @@
+/**
+ * @file JsonWriter.hh
+ * @brief Append-only text buffer for the API's JSON (and Prometheus) output
+ *
+ * std::stringstream pays for a locale, a virtual streambuf and sticky
+ * format flags on every value, and put_time formats the whole date for
+ * every timestamp. JsonWriter appends into one std::string reserved up
+ * front for the whole document: numbers go through std::to_chars, strings
+ * are escaped only when they hold a character that needs it, and the
+ * date part of a timestamp is formatted once per second per thread.
+ *
+ * Output matches what the stream code produced (std::fixed with N digits
+ * == Fixed(v, N); the default 6-digit general format == General(v)), so
+ * readers see the same bytes.
+ */
+
+#ifndef BACKEND_API_JSON_WRITER_HH
+#define BACKEND_API_JSON_WRITER_HH
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+namespace Backend {
+namespace API {
+
+class JsonWriter {
+private:
+    std::string buffer_;
+
+    template <typename T>
+    JsonWriter& AppendNumber(T value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer_.append(digits, result.ptr);
+        return *this;
+    }
+
+    static bool NeedsEscape(std::string_view text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) return true;
+        }
+        return false;
+    }
+
+public:
+    /**
+     * @param reserveBytes Expected document size (one allocation if right)
+     */
+    explicit JsonWriter(size_t reserveBytes = 256) { buffer_.reserve(reserveBytes); }
+
+    JsonWriter& Raw(std::string_view text) {
+        buffer_.append(text);
+        return *this;
+    }
+
+    JsonWriter& Int(long long value) { return AppendNumber(value); }
+    JsonWriter& UInt(unsigned long long value) { return AppendNumber(value); }
+
+    /// value with exactly decimals digits after the point (as std::fixed)
+    JsonWriter& Fixed(double value, int decimals) {
+        char digits[64];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, decimals);
+        if (result.ec != std::errc()) return Raw("0");     // |value| too large for the buffer
+        buffer_.append(digits, result.ptr);
+        return *this;
+    }
+
+    /// value with significant digits, trailing zeros dropped (as a stream's default)
+    JsonWriter& General(double value, int significant = 6) {
+        char digits[64];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, significant);
+        buffer_.append(digits, result.ptr);
+        return *this;
+    }
+
+    JsonWriter& Bool(bool value) { return Raw(value ? "true" : "false"); }
+
+    /// text quoted, escaped where JSON requires it
+    JsonWriter& String(std::string_view text) {
+        buffer_.push_back('"');
+        if (!NeedsEscape(text)) {
+            buffer_.append(text);
+        } else {
+            static const char* hex = "0123456789abcdef";
+            for (char c : text) {
+                switch (c) {
+                    case '"':  buffer_.append("\\\""); break;
+                    case '\\': buffer_.append("\\\\"); break;
+                    case '\n': buffer_.append("\\n"); break;
+                    case '\r': buffer_.append("\\r"); break;
+                    case '\t': buffer_.append("\\t"); break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            buffer_.append("\\u00");
+                            buffer_.push_back(hex[(c >> 4) & 0xF]);
+                            buffer_.push_back(hex[c & 0xF]);
+                        } else {
+                            buffer_.push_back(c);
+                        }
+                }
+            }
+        }
+        buffer_.push_back('"');
+        return *this;
+    }
+
+    /// Local time as YYYY-MM-DDTHH:MM:SS.mmm (unquoted)
+    JsonWriter& Timestamp(std::chrono::system_clock::time_point at) {
+        // localtime_r is the slow part; the date changes once a second
+        thread_local std::time_t cachedSecond = -1;
+        thread_local char cachedDate[32];
+        thread_local size_t cachedLength = 0;
+
+        std::time_t second = std::chrono::system_clock::to_time_t(at);
+        if (second != cachedSecond) {
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &second);
+#else
+            localtime_r(&second, &local);
+#endif
+            cachedLength = std::strftime(cachedDate, sizeof(cachedDate), "%Y-%m-%dT%H:%M:%S", &local);
+            cachedSecond = second;
+        }
+        buffer_.append(cachedDate, cachedLength);
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(at.time_since_epoch()).count() % 1000;
+        if (ms < 0) ms += 1000;
+        char fraction[4] = {'.', static_cast<char>('0' + ms / 100), static_cast<char>('0' + ms / 10 % 10),
+                            static_cast<char>('0' + ms % 10)};
+        buffer_.append(fraction, sizeof(fraction));
+        return *this;
+    }
+
+    size_t Size() const { return buffer_.size(); }
+    const std::string& View() const { return buffer_; }
+
+    /// The document (the writer is left empty)
+    std::string Take() { return std::move(buffer_); }
+};
+
+} // namespace API
+} // namespace Backend
+
+#endif // BACKEND_API_JSON_WRITER_HH
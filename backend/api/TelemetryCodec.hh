@@ -0,0 +1,341 @@
+/**
+ * @file TelemetryCodec.hh
+ * @brief Compact binary telemetry: keyframes plus deltas against them
+ *
+ * The JSON telemetry document spends ~330 bytes per robot per tick, most
+ * of them on field names and on values that did not change. The binary
+ * stream sends a keyframe (every robot, every field) every
+ * keyframeInterval frames and, in between, deltas that carry only the
+ * robots and fields that differ from that keyframe: a robot driving
+ * straight costs its id, a mask and two position offsets.
+ *
+ * Frame (little-endian; "varint" is LEB128, "zigzag" maps signed values
+ * to varints as (v << 1) ^ (v >> 63)):
+ *
+ *   u8      kind | version << 4      (kind 0 = keyframe, 1 = delta)
+ *   varint  tick
+ *   varint  tick - baseTick          (0 in a keyframe)
+ *   i64     timestampMs
+ *   varint  records
+ *   record[records]:
+ *     varint  id
+ *     u8      mask                   (every bit set in a keyframe)
+ *     fields present in the mask, in bit order:
+ *       bit 0  zigzag x, zigzag y    (pixels; a delta holds x - base.x, y - base.y)
+ *       bit 1  zigzag vx, vy         (1e-4 px units, as the JSON's 4 decimals)
+ *       bit 2  u8 status | driverState << 2 | min(loadCount, 7) << 5
+ *              (indices into TELEMETRY_STATUS_NAMES / TELEMETRY_DRIVER_STATE_NAMES)
+ *       bit 3  varint battery        (1e-4 units)
+ *       bit 4  zigzag currentNodeId
+ *       bit 5  zigzag targetNodeId   (-1 = none)
+ *       bit 6  zigzag remainingWaypoints
+ *
+ * A delta applies to the keyframe whose tick is baseTick, never to the
+ * previous delta, so a reader that skips frames only needs that keyframe.
+ * Robots absent from a delta equal the keyframe; the robot set of a delta
+ * is always the keyframe's.
+ */
+
+#ifndef BACKEND_API_TELEMETRY_CODEC_HH
+#define BACKEND_API_TELEMETRY_CODEC_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TelemetryRing.hh"
+
+namespace Backend {
+namespace API {
+
+constexpr uint8_t TELEMETRY_CODEC_VERSION = 2;
+constexpr uint8_t TELEMETRY_FRAME_KEYFRAME = 0;
+constexpr uint8_t TELEMETRY_FRAME_DELTA = 1;
+
+constexpr uint8_t TELEMETRY_FIELD_POSITION = 1 << 0;
+constexpr uint8_t TELEMETRY_FIELD_VELOCITY = 1 << 1;
+constexpr uint8_t TELEMETRY_FIELD_STATE = 1 << 2;
+constexpr uint8_t TELEMETRY_FIELD_BATTERY = 1 << 3;
+constexpr uint8_t TELEMETRY_FIELD_CURRENT_NODE = 1 << 4;
+constexpr uint8_t TELEMETRY_FIELD_TARGET_NODE = 1 << 5;
+constexpr uint8_t TELEMETRY_FIELD_REMAINING = 1 << 6;
+constexpr uint8_t TELEMETRY_FIELDS_ALL = 0x7F;
+
+/// Fixed-point scale of velocities and battery
+constexpr double TELEMETRY_FIXED_SCALE = 10000.0;
+
+/**
+ * @brief A robot as the stream carries it.
+ */
+struct QuantizedTelemetry {
+    int64_t id = 0;
+    int64_t x = 0;
+    int64_t y = 0;
+    int64_t vx = 0;
+    int64_t vy = 0;
+    uint8_t state = 0;
+    int64_t battery = 0;
+    int64_t currentNodeId = 0;
+    int64_t targetNodeId = -1;
+    int64_t remainingWaypoints = 0;
+
+    static QuantizedTelemetry From(const TelemetryRecord& r) {
+        QuantizedTelemetry q;
+        q.id = r.id;
+        q.x = r.x;
+        q.y = r.y;
+        q.vx = std::llround(r.vx * TELEMETRY_FIXED_SCALE);
+        q.vy = std::llround(r.vy * TELEMETRY_FIXED_SCALE);
+        q.state = static_cast<uint8_t>((r.status & 0x3) | ((r.driverState & 0x7) << 2) | (std::min<uint8_t>(r.loadCount, 7) << 5));
+        q.battery = std::llround(r.battery * TELEMETRY_FIXED_SCALE);
+        q.currentNodeId = r.currentNodeId;
+        q.targetNodeId = r.targetNodeId;
+        q.remainingWaypoints = r.remainingWaypoints;
+        return q;
+    }
+
+    /// Fields of this robot that differ from base
+    uint8_t ChangedFrom(const QuantizedTelemetry& base) const {
+        uint8_t mask = 0;
+        if (x != base.x || y != base.y) mask |= TELEMETRY_FIELD_POSITION;
+        if (vx != base.vx || vy != base.vy) mask |= TELEMETRY_FIELD_VELOCITY;
+        if (state != base.state) mask |= TELEMETRY_FIELD_STATE;
+        if (battery != base.battery) mask |= TELEMETRY_FIELD_BATTERY;
+        if (currentNodeId != base.currentNodeId) mask |= TELEMETRY_FIELD_CURRENT_NODE;
+        if (targetNodeId != base.targetNodeId) mask |= TELEMETRY_FIELD_TARGET_NODE;
+        if (remainingWaypoints != base.remainingWaypoints) mask |= TELEMETRY_FIELD_REMAINING;
+        return mask;
+    }
+};
+
+/**
+ * @brief One frame in both encodings a reader may need.
+ */
+struct TelemetryBinaryFrame {
+    uint64_t tick = 0;
+    uint64_t baseTick = 0;      ///< Keyframe the delta applies to (== tick: this frame is that keyframe)
+    std::string keyframe;       ///< This frame in full (for readers without baseTick)
+    std::string delta;          ///< This frame against baseTick (empty when baseTick == tick)
+};
+
+/**
+ * @brief Encoder of the stream; one thread at a time.
+ */
+class TelemetryDeltaEncoder {
+private:
+    int keyframeInterval_;
+    bool hasBase_ = false;
+    uint64_t baseTick_ = 0;
+    int framesSinceBase_ = 0;
+    std::vector<QuantizedTelemetry> base_;
+    std::vector<QuantizedTelemetry> current_;
+
+    static void PutVarint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    static void PutZigzag(std::string& out, int64_t value) {
+        PutVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    static void PutHeader(std::string& out, uint8_t kind, uint64_t tick, uint64_t baseTick,
+                          int64_t timestampMs, size_t records) {
+        out.push_back(static_cast<char>(kind | (TELEMETRY_CODEC_VERSION << 4)));
+        PutVarint(out, tick);
+        PutVarint(out, tick - baseTick);
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((static_cast<uint64_t>(timestampMs) >> (i * 8)) & 0xFF));
+        PutVarint(out, records);
+    }
+
+    /// Fields in mask; positions relative to base when given
+    static void PutRecord(std::string& out, const QuantizedTelemetry& r, uint8_t mask,
+                          const QuantizedTelemetry* base) {
+        PutVarint(out, static_cast<uint64_t>(r.id));
+        out.push_back(static_cast<char>(mask));
+        if (mask & TELEMETRY_FIELD_POSITION) {
+            PutZigzag(out, base ? r.x - base->x : r.x);
+            PutZigzag(out, base ? r.y - base->y : r.y);
+        }
+        if (mask & TELEMETRY_FIELD_VELOCITY) {
+            PutZigzag(out, r.vx);
+            PutZigzag(out, r.vy);
+        }
+        if (mask & TELEMETRY_FIELD_STATE) out.push_back(static_cast<char>(r.state));
+        if (mask & TELEMETRY_FIELD_BATTERY) PutVarint(out, static_cast<uint64_t>(r.battery < 0 ? 0 : r.battery));
+        if (mask & TELEMETRY_FIELD_CURRENT_NODE) PutZigzag(out, r.currentNodeId);
+        if (mask & TELEMETRY_FIELD_TARGET_NODE) PutZigzag(out, r.targetNodeId);
+        if (mask & TELEMETRY_FIELD_REMAINING) PutZigzag(out, r.remainingWaypoints);
+    }
+
+    bool SameRobots() const {
+        if (current_.size() != base_.size()) return false;
+        for (size_t i = 0; i < current_.size(); ++i) {
+            if (current_[i].id != base_[i].id) return false;
+        }
+        return true;
+    }
+
+public:
+    /**
+     * @param keyframeInterval Frames per keyframe (20 = one a second at 20 Hz)
+     */
+    explicit TelemetryDeltaEncoder(int keyframeInterval = 20)
+        : keyframeInterval_(keyframeInterval < 1 ? 1 : keyframeInterval) {}
+
+    /**
+     * @brief Encode a frame.
+     *
+     * Starts a new keyframe every keyframeInterval frames, on the first
+     * frame and whenever the robot set changes.
+     */
+    TelemetryBinaryFrame Encode(uint64_t tick, int64_t timestampMs, const TelemetryRecord* records, size_t count) {
+        current_.resize(count);
+        for (size_t i = 0; i < count; ++i) current_[i] = QuantizedTelemetry::From(records[i]);
+
+        TelemetryBinaryFrame frame;
+        frame.tick = tick;
+        frame.keyframe.reserve(16 + count * 20);
+        PutHeader(frame.keyframe, TELEMETRY_FRAME_KEYFRAME, tick, tick, timestampMs, count);
+        for (const auto& r : current_) PutRecord(frame.keyframe, r, TELEMETRY_FIELDS_ALL, nullptr);
+
+        if (!hasBase_ || tick < baseTick_ || ++framesSinceBase_ >= keyframeInterval_ || !SameRobots()) {
+            base_.swap(current_);
+            baseTick_ = tick;
+            framesSinceBase_ = 0;
+            hasBase_ = true;
+            frame.baseTick = tick;
+            return frame;
+        }
+
+        frame.baseTick = baseTick_;
+        size_t changed = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (current_[i].ChangedFrom(base_[i]) != 0) changed++;
+        }
+        frame.delta.reserve(16 + changed * 10);
+        PutHeader(frame.delta, TELEMETRY_FRAME_DELTA, tick, baseTick_, timestampMs, changed);
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t mask = current_[i].ChangedFrom(base_[i]);
+            if (mask != 0) PutRecord(frame.delta, current_[i], mask, &base_[i]);
+        }
+        return frame;
+    }
+};
+
+/**
+ * @brief Decoder of the stream (for C++ readers and checks).
+ */
+class TelemetryDeltaDecoder {
+private:
+    bool hasKeyframe_ = false;
+    uint64_t keyframeTick_ = 0;
+    std::vector<QuantizedTelemetry> keyframe_;
+
+    static bool GetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            uint8_t byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    static bool GetZigzag(const uint8_t*& p, const uint8_t* end, int64_t& value) {
+        uint64_t raw;
+        if (!GetVarint(p, end, raw)) return false;
+        value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+        return true;
+    }
+
+public:
+    /**
+     * @brief Decode a frame into robots (every robot, deltas applied).
+     *
+     * @return false on a malformed frame or a delta whose keyframe this
+     *         decoder has not seen
+     */
+    bool Decode(const std::string& frame, uint64_t& tick, int64_t& timestampMs,
+                std::vector<QuantizedTelemetry>& robots) {
+        const auto* p = reinterpret_cast<const uint8_t*>(frame.data());
+        const uint8_t* end = p + frame.size();
+        if (p == end || (*p >> 4) != TELEMETRY_CODEC_VERSION) return false;
+        uint8_t kind = *p++ & 0x0F;
+
+        uint64_t baseOffset, records;
+        if (!GetVarint(p, end, tick) || !GetVarint(p, end, baseOffset) || end - p < 8) return false;
+        uint64_t ms = 0;
+        for (int i = 0; i < 8; ++i) ms |= static_cast<uint64_t>(*p++) << (i * 8);
+        timestampMs = static_cast<int64_t>(ms);
+        if (!GetVarint(p, end, records)) return false;
+
+        if (kind == TELEMETRY_FRAME_KEYFRAME) {
+            robots.clear();
+        } else if (kind == TELEMETRY_FRAME_DELTA && hasKeyframe_ && tick - baseOffset == keyframeTick_) {
+            robots = keyframe_;
+        } else {
+            return false;
+        }
+
+        for (uint64_t n = 0; n < records; ++n) {
+            uint64_t id;
+            if (!GetVarint(p, end, id) || p == end) return false;
+            uint8_t mask = *p++;
+            QuantizedTelemetry* r = nullptr;
+            const QuantizedTelemetry* base = nullptr;
+            if (kind == TELEMETRY_FRAME_KEYFRAME) {
+                robots.emplace_back();
+                r = &robots.back();
+                r->id = static_cast<int64_t>(id);
+            } else {
+                for (size_t i = 0; i < robots.size() && !r; ++i) {
+                    if (robots[i].id == static_cast<int64_t>(id)) {
+                        r = &robots[i];
+                        base = &keyframe_[i];
+                    }
+                }
+                if (!r) return false;
+            }
+            bool ok = true;
+            if (mask & TELEMETRY_FIELD_POSITION) {
+                ok = ok && GetZigzag(p, end, r->x) && GetZigzag(p, end, r->y);
+                if (ok && base) {
+                    r->x += base->x;
+                    r->y += base->y;
+                }
+            }
+            if (mask & TELEMETRY_FIELD_VELOCITY) ok = ok && GetZigzag(p, end, r->vx) && GetZigzag(p, end, r->vy);
+            if (mask & TELEMETRY_FIELD_STATE) {
+                ok = ok && p < end;
+                if (ok) r->state = *p++;
+            }
+            if (mask & TELEMETRY_FIELD_BATTERY) {
+                uint64_t battery = 0;
+                ok = ok && GetVarint(p, end, battery);
+                r->battery = static_cast<int64_t>(battery);
+            }
+            if (mask & TELEMETRY_FIELD_CURRENT_NODE) ok = ok && GetZigzag(p, end, r->currentNodeId);
+            if (mask & TELEMETRY_FIELD_TARGET_NODE) ok = ok && GetZigzag(p, end, r->targetNodeId);
+            if (mask & TELEMETRY_FIELD_REMAINING) ok = ok && GetZigzag(p, end, r->remainingWaypoints);
+            if (!ok) return false;
+        }
+
+        if (kind == TELEMETRY_FRAME_KEYFRAME) {
+            keyframe_ = robots;
+            keyframeTick_ = tick;
+            hasKeyframe_ = true;
+        }
+        return p == end;
+    }
+};
+
+} // namespace API
+} // namespace Backend
+
+#endif // BACKEND_API_TELEMETRY_CODEC_HH
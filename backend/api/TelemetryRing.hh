@@ -0,0 +1,240 @@
+/**
+ * @file TelemetryRing.hh
+ * @brief Shared-memory ring of robot telemetry frames (orca/telemetry.ring)
+ *
+ * Writing orca_tick_{N}.json every physics tick creates and deletes a
+ * file 20 times a second, and every reader lists and sorts the directory
+ * to find the newest one. The ring is a single fixed-size file mapped by
+ * the writer: each tick overwrites one slot in place, and a reader maps
+ * (or preads) the same pages, so a frame is published by a memcpy and
+ * read in microseconds with no directory traffic. Dirty pages are only
+ * flushed to disk in the background by the kernel.
+ *
+ * Layout (host byte order, little-endian on every supported target):
+ *
+ *   TelemetryRingHeader                      64 bytes at offset 0
+ *   slot[slotCount]                          slotBytes each
+ *     TelemetrySlotHeader                    32 bytes (seqFront first)
+ *     TelemetryRecord[maxRobots]             40 bytes each, robotCount used
+ *     uint64_t seqBack
+ *
+ * Frame n (counted from 0) goes to slot n % slotCount with sequence
+ * n + 1. The writer stores seqBack, then the frame, then seqFront; a
+ * reader copies the slot front to back and keeps it only if seqFront ==
+ * seqBack == n + 1 (a write that overlapped the copy changes seqBack
+ * before any frame byte). The newest complete frame is
+ * header.framesWritten - 1. A restarted writer replaces the file, so a
+ * reader that sees no new frame for a while should open it again.
+ *
+ * Readers: api/server.js (readTelemetryRing) and the Qt simulator
+ * (TelemetryReader). Keep them in step with TELEMETRY_RING_VERSION.
+ */
+
+#ifndef BACKEND_API_TELEMETRY_RING_HH
+#define BACKEND_API_TELEMETRY_RING_HH
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Backend {
+namespace API {
+
+constexpr char TELEMETRY_RING_MAGIC[8] = {'A', 'M', 'R', 'T', 'E', 'L', 'E', 'M'};
+constexpr uint32_t TELEMETRY_RING_VERSION = 1;
+
+/// TelemetryRecord::status, in Layer2::RobotStatus order
+constexpr const char* TELEMETRY_STATUS_NAMES[] = {"IDLE", "BUSY", "CHARGING", "ERROR"};
+/// TelemetryRecord::driverState, in Layer3::Core::DriverState order
+constexpr const char* TELEMETRY_DRIVER_STATE_NAMES[] = {
+    "IDLE", "COMPUTING_PATH", "MOVING", "ARRIVED", "STUCK", "COLLISION_WAIT"};
+
+/**
+ * @brief File header; written once, except framesWritten.
+ */
+struct TelemetryRingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;               ///< sizeof(TelemetryRingHeader)
+    uint32_t slotCount;
+    uint32_t slotBytes;
+    uint32_t maxRobots;                 ///< Records per slot
+    uint32_t recordBytes;               ///< sizeof(TelemetryRecord)
+    std::atomic<uint64_t> framesWritten;    ///< Complete frames (0 = none yet)
+    uint64_t writerPid;                 ///< Process writing the ring
+    uint8_t reserved[16];
+};
+
+/**
+ * @brief Per-slot header; seqFront is its first field.
+ */
+struct TelemetrySlotHeader {
+    std::atomic<uint64_t> seqFront;     ///< Frame number + 1 once the frame is complete
+    uint64_t tick;                      ///< Physics tick of the frame
+    int64_t timestampMs;                ///< Wall clock (ms since the epoch)
+    uint32_t robotCount;
+    uint32_t reserved;
+};
+
+/**
+ * @brief One robot in a frame.
+ */
+struct TelemetryRecord {
+    int32_t id;
+    int32_t x;                          ///< Pixels
+    int32_t y;
+    float vx;
+    float vy;
+    float battery;                      ///< 0.0 - 1.0
+    int32_t currentNodeId;
+    int32_t targetNodeId;               ///< -1 = none
+    int32_t remainingWaypoints;
+    uint8_t status;                     ///< Index into TELEMETRY_STATUS_NAMES
+    uint8_t driverState;                ///< Index into TELEMETRY_DRIVER_STATE_NAMES
+    uint8_t loadCount;                  ///< Packages on board (saturates at 255; nonzero = carrying)
+    uint8_t reserved;
+};
+
+static_assert(sizeof(TelemetryRingHeader) == 64, "ring header layout is shared with the readers");
+static_assert(sizeof(TelemetrySlotHeader) == 32, "slot header layout is shared with the readers");
+static_assert(sizeof(TelemetryRecord) == 40, "record layout is shared with the readers");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring sequences must be plain words in memory");
+
+/**
+ * @brief Writer side of the ring (one writing thread).
+ */
+class TelemetryRing {
+private:
+    void* mapping_ = nullptr;
+    size_t mappedBytes_ = 0;
+    size_t slotBytes_ = 0;
+    uint32_t slotCount_ = 0;
+    uint32_t maxRobots_ = 0;
+    uint64_t frames_ = 0;
+
+    TelemetryRingHeader* Header() const { return static_cast<TelemetryRingHeader*>(mapping_); }
+
+    char* Slot(uint64_t frame) const {
+        return static_cast<char*>(mapping_) + sizeof(TelemetryRingHeader) + (frame % slotCount_) * slotBytes_;
+    }
+
+public:
+    TelemetryRing() = default;
+    TelemetryRing(const TelemetryRing&) = delete;
+    TelemetryRing& operator=(const TelemetryRing&) = delete;
+    ~TelemetryRing() { Close(); }
+
+    static size_t SlotBytes(uint32_t maxRobots) {
+        return sizeof(TelemetrySlotHeader) + maxRobots * sizeof(TelemetryRecord) + sizeof(uint64_t);
+    }
+
+    /**
+     * @brief Create (or replace) the ring file at path and map it.
+     *
+     * @return false if it could not be created or mapped (or on Windows)
+     */
+    bool Open(const std::string& path, uint32_t slotCount, uint32_t maxRobots) {
+        Close();
+        if (slotCount == 0) return false;
+#ifdef _WIN32
+        (void)path;
+        (void)maxRobots;
+        return false;
+#else
+        slotBytes_ = SlotBytes(maxRobots);
+        size_t bytes = sizeof(TelemetryRingHeader) + slotCount * slotBytes_;
+
+        // A new inode, so a reader still mapping an older ring keeps its pages
+        std::string tmpPath = path + ".tmp";
+        int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            ::close(fd);
+            ::unlink(tmpPath.c_str());
+            return false;
+        }
+        void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            ::unlink(tmpPath.c_str());
+            return false;
+        }
+
+        mapping_ = mapping;
+        mappedBytes_ = bytes;
+        slotCount_ = slotCount;
+        maxRobots_ = maxRobots;
+        frames_ = 0;
+
+        // ftruncate zero-fills: every slot starts with seqFront == seqBack == 0, i.e. empty
+        TelemetryRingHeader* header = Header();
+        std::memcpy(header->magic, TELEMETRY_RING_MAGIC, sizeof(header->magic));
+        header->version = TELEMETRY_RING_VERSION;
+        header->headerBytes = sizeof(TelemetryRingHeader);
+        header->slotCount = slotCount;
+        header->slotBytes = static_cast<uint32_t>(slotBytes_);
+        header->maxRobots = maxRobots;
+        header->recordBytes = sizeof(TelemetryRecord);
+        header->writerPid = static_cast<uint64_t>(::getpid());
+        header->framesWritten.store(0, std::memory_order_release);
+
+        if (::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            Close();
+            ::unlink(tmpPath.c_str());
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    void Close() {
+#ifndef _WIN32
+        if (mapping_) ::munmap(mapping_, mappedBytes_);
+#endif
+        mapping_ = nullptr;
+        mappedBytes_ = 0;
+    }
+
+    bool IsOpen() const { return mapping_ != nullptr; }
+    uint32_t GetMaxRobots() const { return maxRobots_; }
+    size_t GetMappedBytes() const { return mappedBytes_; }
+    uint64_t GetFramesWritten() const { return frames_; }
+
+    /**
+     * @brief Publish one frame (records beyond maxRobots are dropped).
+     */
+    void Write(uint64_t tick, int64_t timestampMs, const TelemetryRecord* records, size_t count) {
+        if (!mapping_) return;
+        uint32_t used = static_cast<uint32_t>(count < maxRobots_ ? count : maxRobots_);
+        char* slot = Slot(frames_);
+        auto* slotHeader = reinterpret_cast<TelemetrySlotHeader*>(slot);
+        auto* seqBack = reinterpret_cast<std::atomic<uint64_t>*>(slot + slotBytes_ - sizeof(uint64_t));
+        const uint64_t sequence = frames_ + 1;
+
+        // seqBack, frame, seqFront: a reader copying front to back sees
+        // the two differ if any frame byte it copied is new
+        seqBack->store(sequence, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slotHeader->tick = tick;
+        slotHeader->timestampMs = timestampMs;
+        slotHeader->robotCount = used;
+        std::memcpy(slot + sizeof(TelemetrySlotHeader), records, used * sizeof(TelemetryRecord));
+        slotHeader->seqFront.store(sequence, std::memory_order_release);
+
+        frames_++;
+        Header()->framesWritten.store(frames_, std::memory_order_release);
+    }
+};
+
+} // namespace API
+} // namespace Backend
+
+#endif // BACKEND_API_TELEMETRY_RING_HH
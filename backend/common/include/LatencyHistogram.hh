@@ -0,0 +1,163 @@
+/**
+ * @file LatencyHistogram.hh
+ * @brief Lock-free log-linear latency histogram with percentile queries
+ *
+ * Averages and maxima hide what matters for a 20 Hz loop: how often it
+ * stalls. The histogram keeps every sample in a bucket of about 3% width,
+ * so p50 / p99 / p99.9 of physics ticks, solves and path queries can be
+ * read at any time and exported for alerting on the tail.
+ */
+
+#ifndef BACKEND_COMMON_LATENCYHISTOGRAM_HH
+#define BACKEND_COMMON_LATENCYHISTOGRAM_HH
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Backend {
+namespace Common {
+
+/**
+ * @brief Counts of microsecond samples in HDR-style log-linear buckets.
+ *
+ * Values below LINEAR_BUCKETS us get a bucket each; above, every power
+ * of two is split in SUB_BUCKETS equal buckets, so a reported percentile
+ * is at most 1 / SUB_BUCKETS above the true sample. Samples beyond
+ * MAX_VALUE_US (about 12 days) land in the last bucket.
+ *
+ * Record is a few relaxed atomic adds, safe from any number of threads;
+ * readers see exact counts, only not ordered against each other. The
+ * histogram is never reset, like a Prometheus summary.
+ */
+class LatencyHistogram {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;     ///< 32 per power of two
+    static constexpr uint64_t LINEAR_BUCKETS = SUB_BUCKETS * 2;                 ///< 0..63 us exact
+    static constexpr int MAX_MAGNITUDE = 40;                                    ///< Top bit of the largest value
+    static constexpr uint64_t MAX_VALUE_US = (uint64_t(1) << (MAX_MAGNITUDE + 1)) - 1;
+    static constexpr size_t BUCKET_COUNT =
+        LINEAR_BUCKETS + (MAX_MAGNITUDE - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    /**
+     * @brief Percentiles and totals read from the histogram (microseconds).
+     */
+    struct Summary {
+        uint64_t count = 0;
+        uint64_t sumUs = 0;
+        uint64_t maxUs = 0;
+        uint64_t p50Us = 0;
+        uint64_t p99Us = 0;
+        uint64_t p999Us = 0;
+
+        double GetMeanUs() const { return count > 0 ? static_cast<double>(sumUs) / count : 0.0; }
+    };
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sumUs_;
+    std::atomic<uint64_t> maxUs_;
+
+    static int TopBit(uint64_t value) {
+        int bit = 0;
+        while (value >>= 1) bit++;
+        return bit;
+    }
+
+    static size_t BucketOf(uint64_t valueUs) {
+        if (valueUs < LINEAR_BUCKETS) return static_cast<size_t>(valueUs);
+        if (valueUs > MAX_VALUE_US) valueUs = MAX_VALUE_US;
+        // Keep the top SUB_BUCKET_BITS + 1 bits: [SUB_BUCKETS, 2 * SUB_BUCKETS)
+        int shift = TopBit(valueUs) - SUB_BUCKET_BITS;
+        uint64_t top = valueUs >> shift;
+        return static_cast<size_t>(LINEAR_BUCKETS + (shift - 1) * SUB_BUCKETS + (top - SUB_BUCKETS));
+    }
+
+    /// Largest value that falls in a bucket
+    static uint64_t BucketUpperBound(size_t bucket) {
+        if (bucket < LINEAR_BUCKETS) return bucket;
+        size_t offset = bucket - LINEAR_BUCKETS;
+        int shift = static_cast<int>(offset / SUB_BUCKETS) + 1;
+        uint64_t top = SUB_BUCKETS + offset % SUB_BUCKETS;
+        return ((top + 1) << shift) - 1;
+    }
+
+public:
+    LatencyHistogram() : count_(0), sumUs_(0), maxUs_(0) {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief Add one sample.
+     */
+    void Record(uint64_t valueUs) {
+        buckets_[BucketOf(valueUs)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sumUs_.fetch_add(valueUs, std::memory_order_relaxed);
+        uint64_t max = maxUs_.load(std::memory_order_relaxed);
+        while (valueUs > max &&
+               !maxUs_.compare_exchange_weak(max, valueUs, std::memory_order_relaxed)) {}
+    }
+
+    void Record(Clock::duration duration) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        Record(static_cast<uint64_t>(us > 0 ? us : 0));
+    }
+
+    /// Sample the time since start
+    void RecordSince(Clock::time_point start) { Record(Clock::now() - start); }
+
+    uint64_t GetCount() const { return count_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Smallest bucket bound at or above the given share of samples.
+     *
+     * @param quantile In [0, 1], e.g. 0.99
+     * @return Microseconds (0 if empty), never above the largest sample
+     */
+    uint64_t GetValueAtQuantile(double quantile) const {
+        uint64_t count = GetCount();
+        if (count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(count) + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > count) rank = count;
+
+        uint64_t seen = 0;
+        uint64_t max = maxUs_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t bound = BucketUpperBound(i);
+                return bound < max ? bound : max;
+            }
+        }
+        return max;
+    }
+
+    Summary GetSummary() const {
+        Summary summary;
+        summary.count = GetCount();
+        summary.sumUs = sumUs_.load(std::memory_order_relaxed);
+        summary.maxUs = maxUs_.load(std::memory_order_relaxed);
+        summary.p50Us = GetValueAtQuantile(0.5);
+        summary.p99Us = GetValueAtQuantile(0.99);
+        summary.p999Us = GetValueAtQuantile(0.999);
+        return summary;
+    }
+};
+
+} // namespace Common
+} // namespace Backend
+
+#endif // BACKEND_COMMON_LATENCYHISTOGRAM_HH
@@ -0,0 +1,123 @@
+/**
+ * @file MemoryUsage.hh
+ * @brief Heap accounting helpers and the per-subsystem memory report
+ *
+ * Peak RSS says how much the process holds, not who holds it. Every large
+ * structure reports its own bytes (GetMemoryBytes), and FleetManager adds
+ * them up per subsystem, normalised by what each one scales with: map
+ * pixels, POIs or robots. A site that grows then shows which term grew.
+ */
+
+#ifndef BACKEND_COMMON_MEMORYUSAGE_HH
+#define BACKEND_COMMON_MEMORYUSAGE_HH
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Backend {
+namespace Common {
+
+/// Heap bytes of a vector's buffer (capacity, not size: that is what is held)
+template <typename T>
+size_t VectorBytes(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+/// Heap bytes of a vector of vectors, inner buffers included
+template <typename T>
+size_t NestedVectorBytes(const std::vector<std::vector<T>>& values) {
+    size_t bytes = VectorBytes(values);
+    for (const auto& inner : values) bytes += VectorBytes(inner);
+    return bytes;
+}
+
+/// Heap bytes of a string beyond the small-string buffer
+inline size_t StringBytes(const std::string& value) {
+    return value.capacity() > sizeof(std::string) ? value.capacity() + 1 : 0;
+}
+
+/**
+ * @brief Estimated heap bytes of an unordered_map, its values' own heap excluded.
+ *
+ * One node per element (the pair plus a next pointer and the cached hash)
+ * and one pointer per bucket, as libstdc++ lays them out.
+ */
+template <typename K, typename V, typename H, typename E, typename A>
+size_t HashMapBytes(const std::unordered_map<K, V, H, E, A>& map) {
+    const size_t nodeBytes = sizeof(std::pair<const K, V>) + 2 * sizeof(void*);
+    return map.size() * nodeBytes + map.bucket_count() * sizeof(void*);
+}
+
+/**
+ * @brief Bytes per subsystem at one point in time.
+ *
+ * Entries are tagged with what their size grows with, so the report can
+ * say "so many bytes per robot" without knowing the structures.
+ */
+struct MemoryReport {
+    enum class Scale { MAP, POI, ROBOT, OTHER };
+
+    struct Entry {
+        std::string name;
+        Scale scale;
+        size_t bytes;
+    };
+
+    std::vector<Entry> entries;
+    size_t robots = 0;
+    size_t pois = 0;
+    size_t mapPixels = 0;
+    size_t rssBytes = 0;            ///< Process resident set (0 = unknown)
+    double timestamp = 0.0;         ///< Simulation time of the report
+
+    void Add(const std::string& name, Scale scale, size_t bytes) {
+        entries.push_back({name, scale, bytes});
+    }
+
+    size_t GetTotalBytes() const {
+        size_t total = 0;
+        for (const Entry& entry : entries) total += entry.bytes;
+        return total;
+    }
+
+    size_t GetBytes(Scale scale) const {
+        size_t total = 0;
+        for (const Entry& entry : entries) {
+            if (entry.scale == scale) total += entry.bytes;
+        }
+        return total;
+    }
+
+    double GetBytesPerRobot() const { return robots > 0 ? double(GetBytes(Scale::ROBOT)) / robots : 0.0; }
+    double GetBytesPerPOI() const { return pois > 0 ? double(GetBytes(Scale::POI)) / pois : 0.0; }
+    double GetBytesPerPixel() const { return mapPixels > 0 ? double(GetBytes(Scale::MAP)) / mapPixels : 0.0; }
+
+    static const char* ScaleName(Scale scale) {
+        switch (scale) {
+            case Scale::MAP: return "map";
+            case Scale::POI: return "poi";
+            case Scale::ROBOT: return "robot";
+            default: return "other";
+        }
+    }
+};
+
+/// Current resident set of this process in bytes (0 where /proc is missing)
+inline size_t ReadResidentBytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return std::stoul(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+}
+
+} // namespace Common
+} // namespace Backend
+
+#endif // BACKEND_COMMON_MEMORYUSAGE_HH
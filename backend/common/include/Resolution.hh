@@ -23,14 +23,80 @@ namespace Common {
      * @brief Helper to get the conversion factor to Meters.
      * Example: If res is CENTIMETERS, returns 0.01.
      */
-    double GetConversionFactorToMeters(Resolution res);
-    
+    constexpr double GetConversionFactorToMeters(Resolution res) {
+        switch (res) {
+            case Resolution::DECIMETERS:  return 0.1;
+            case Resolution::CENTIMETERS: return 0.01;
+            case Resolution::MILLIMETERS: return 0.001;
+            default:                      return 0.1; // Default to decimeters
+        }
+    }
+
+    /**
+     * @brief Pixels per meter: the exact inverse of GetConversionFactorToMeters.
+     */
+    constexpr int GetPixelsPerMeter(Resolution res) {
+        switch (res) {
+            case Resolution::DECIMETERS:  return 10;
+            case Resolution::CENTIMETERS: return 100;
+            case Resolution::MILLIMETERS: return 1000;
+            default:                      return 10;
+        }
+    }
+
+    /**
+     * @brief Whole pixels in a length in meters (rounded, at least 1).
+     */
+    constexpr int MetersToPixels(double meters, Resolution res) {
+        int pixels = static_cast<int>(meters * GetPixelsPerMeter(res) + 0.5);
+        return pixels > 0 ? pixels : 1;
+    }
+
     /**
      * @brief Get the robot footprint size in pixels for a given resolution.
      * Robot physical size is 60cm x 60cm.
+     * We use 5x5 for decimeters (50cm, slightly smaller for safety margin).
+     */
+    constexpr int GetRobotFootprintPixels(Resolution res) {
+        switch (res) {
+            case Resolution::DECIMETERS:  return 5;   // 5 pixels = 50cm (with center)
+            case Resolution::CENTIMETERS: return 60;  // 60 pixels = 60cm
+            case Resolution::MILLIMETERS: return 600; // 600 pixels = 60cm
+            default:                      return 5;
+        }
+    }
+
+    /**
+     * @brief Compile-time constants of one resolution.
+     *
+     * Grid code templated on the policy folds its pixel steps into
+     * constants; DispatchResolution picks the instantiation once per call.
+     */
+    template <Resolution R>
+    struct ResolutionPolicy {
+        static constexpr Resolution RESOLUTION = R;
+        static constexpr int PIXELS_PER_METER = GetPixelsPerMeter(R);
+        static constexpr double METERS_PER_PIXEL = GetConversionFactorToMeters(R);
+
+        static constexpr int ToPixels(double meters) { return MetersToPixels(meters, R); }
+    };
+
+    /**
+     * @brief Call visitor with the ResolutionPolicy of res.
+     *
+     * The one runtime switch in front of resolution-templated code:
+     * visitor is a generic lambda taking the policy by value.
      */
-    int GetRobotFootprintPixels(Resolution res);
-    
+    template <typename Visitor>
+    decltype(auto) DispatchResolution(Resolution res, Visitor&& visitor) {
+        switch (res) {
+            case Resolution::CENTIMETERS: return visitor(ResolutionPolicy<Resolution::CENTIMETERS>{});
+            case Resolution::MILLIMETERS: return visitor(ResolutionPolicy<Resolution::MILLIMETERS>{});
+            case Resolution::DECIMETERS:
+            default:                      return visitor(ResolutionPolicy<Resolution::DECIMETERS>{});
+        }
+    }
+
     /**
      * @brief Get a human-readable name for the resolution.
      */
@@ -0,0 +1,138 @@
+/**
+ * @file TaskScheduler.hh
+ * @brief Work-stealing thread pool with priority lanes for background work
+ *
+ * Replans, cost-matrix refreshes and checkpoint writes each started a
+ * thread of their own (std::async), and the cost-matrix searches started
+ * one per core on every call: thread counts grew with the load and every
+ * replan paid thread creation before its first iteration. The scheduler
+ * starts a fixed set of workers once; subsystems hand it tasks instead.
+ *
+ * Every worker has a deque per lane. A task submitted from a worker goes
+ * to that worker's deque (it is likely to touch what the worker just
+ * did), others are dealt round-robin. A worker takes its newest task of
+ * the highest non-empty lane and, with none, steals the oldest of that
+ * lane from the others, so a replan never waits behind a checkpoint.
+ *
+ * The periodic loops and blocking consumers (path workers, push and
+ * ingest servers) keep dedicated threads: a task must finish, not sleep.
+ */
+
+#ifndef BACKEND_COMMON_TASKSCHEDULER_HH
+#define BACKEND_COMMON_TASKSCHEDULER_HH
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Backend {
+namespace Common {
+
+/**
+ * @brief Lane a task is queued in; a lower lane runs only when every
+ *        higher one is empty.
+ */
+enum class TaskPriority {
+    HIGH = 0,       ///< Latency-bound: background replans
+    NORMAL,         ///< Cost-matrix refreshes and precomputes
+    LOW             ///< File writes (checkpoints)
+};
+
+constexpr size_t TASK_PRIORITY_COUNT = 3;
+
+/**
+ * @brief Fixed set of workers running submitted tasks to completion.
+ *
+ * Submit and ParallelFor are safe from any thread, workers included.
+ * Tasks must not block on other tasks except through ParallelFor, which
+ * runs jobs on the waiting thread too. Destruction runs every task still
+ * queued, then joins the workers.
+ */
+class TaskScheduler {
+public:
+    /**
+     * @brief Tasks run and stolen so far.
+     */
+    struct Stats {
+        uint64_t executed = 0;
+        uint64_t stolen = 0;            ///< Run by a worker other than the one it was queued on
+        std::array<uint64_t, TASK_PRIORITY_COUNT> submitted{};
+    };
+
+    /**
+     * @param threads Workers (0 = one per hardware thread)
+     */
+    explicit TaskScheduler(size_t threads = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    size_t GetThreadCount() const { return threads_.size(); }
+
+    /**
+     * @brief Queue fn; its result (or exception) arrives through the future.
+     *
+     * Unlike a std::async future, the returned one does not wait for the
+     * task when destroyed.
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<std::decay_t<F>>> Submit(TaskPriority priority, F&& fn) {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> result = task->get_future();
+        Enqueue(priority, [task]() { (*task)(); });
+        return result;
+    }
+
+    /**
+     * @brief Run job(0) .. job(jobs - 1) and return when all have finished.
+     *
+     * The calling thread claims jobs too, so this completes even when
+     * every worker is busy (or the caller is a worker). Jobs must not
+     * throw.
+     */
+    void ParallelFor(size_t jobs, const std::function<void(size_t)>& job,
+                     TaskPriority priority = TaskPriority::NORMAL);
+
+    Stats GetStats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<std::function<void()>>, TASK_PRIORITY_COUNT> lanes;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;          ///< Workers: a task was queued or the scheduler stops
+    std::atomic<size_t> queued_{0};         ///< Tasks in any deque
+    bool stopping_ = false;                 ///< Guarded by sleepMutex_
+    std::atomic<size_t> nextWorker_{0};     ///< Round-robin target of outside submissions
+
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> stolen_{0};
+    std::array<std::atomic<uint64_t>, TASK_PRIORITY_COUNT> submitted_{};
+
+    void Enqueue(TaskPriority priority, std::function<void()> task);
+    bool TryRunOne(size_t self);
+    void WorkerLoop(size_t self);
+};
+
+} // namespace Common
+} // namespace Backend
+
+#endif // BACKEND_COMMON_TASKSCHEDULER_HH
@@ -0,0 +1,206 @@
+/**
+ * @file Trace.hh
+ * @brief Scoped tracing zones with Chrome trace (Perfetto) export
+ *
+ * A tick that overruns says nothing about where the time went: neighbor
+ * gathering, a synchronous path search, a lock wait or API I/O. Zones
+ * placed across the layers and the FleetManager loops record when they
+ * started and how long they took, per thread, and the whole recording
+ * can be written as a Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * Built with MECALUX_TRACING defined (make TRACING=1) the macros below
+ * record; otherwise they compile to nothing and TracedLockGuard is a
+ * plain lock. The Tracer itself is always linked, so a trace written
+ * from an untraced build is simply empty.
+ */
+
+#ifndef BACKEND_COMMON_TRACE_HH
+#define BACKEND_COMMON_TRACE_HH
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Backend {
+namespace Common {
+
+/**
+ * @brief One finished zone ("complete" event in the Chrome trace format).
+ */
+struct TraceEvent {
+    const char* name = nullptr;         ///< String literal
+    const char* category = nullptr;     ///< String literal, e.g. "fleet", "lock"
+    int64_t startNs = 0;                ///< Since the tracer's epoch
+    int64_t durationNs = 0;
+};
+
+/**
+ * @brief Process-wide recorder of trace events.
+ *
+ * Each thread writes into its own ring buffer of EVENTS_PER_THREAD
+ * events, created on its first event; once full, the oldest events are
+ * overwritten, so a trace always holds the most recent history of every
+ * thread. A buffer's mutex is only ever contended while a trace is being
+ * written. Buffers outlive their threads (e.g. finished solver threads).
+ */
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+private:
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::string name;
+        int id = 0;
+        std::vector<TraceEvent> ring;   ///< EVENTS_PER_THREAD once the first event arrives
+        uint64_t written = 0;           ///< Events ever recorded (ring index = written % size)
+    };
+
+    Clock::time_point epoch_;
+    std::atomic<bool> enabled_;
+
+    std::mutex buffersMutex_;           ///< Guards buffers_ (not their contents)
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+    Tracer();
+
+    /// The calling thread's buffer, registered on first use
+    ThreadBuffer& LocalBuffer();
+
+public:
+    static Tracer& Instance();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief Pause or resume recording at run time (traced builds start enabled).
+     */
+    void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Name the calling thread in the trace (e.g. "FleetLoop").
+     */
+    void SetThreadName(const std::string& name);
+
+    /**
+     * @brief Record a zone of the calling thread.
+     *
+     * @param name String literal (kept by pointer)
+     * @param category String literal (kept by pointer)
+     */
+    void Record(const char* name, const char* category, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * @brief Events currently held over all threads.
+     */
+    size_t GetEventCount();
+
+    /**
+     * @brief Drop all recorded events (thread names are kept).
+     */
+    void Clear();
+
+    /**
+     * @brief Write every held event as Chrome trace JSON.
+     *
+     * May be called while threads keep recording.
+     *
+     * @return false if the file could not be written
+     */
+    bool WriteChromeTrace(const std::string& path);
+};
+
+/**
+ * @brief Records the enclosing scope as a zone (see TRACE_ZONE).
+ */
+class ScopedTraceZone {
+private:
+    const char* name_;
+    const char* category_;
+    Tracer::Clock::time_point start_;
+    bool active_;
+
+public:
+    ScopedTraceZone(const char* name, const char* category)
+        : name_(name)
+        , category_(category)
+        , active_(Tracer::Instance().IsEnabled()) {
+        if (active_) start_ = Tracer::Clock::now();
+    }
+
+    ~ScopedTraceZone() {
+        if (active_) Tracer::Instance().Record(name_, category_, start_, Tracer::Clock::now());
+    }
+
+    ScopedTraceZone(const ScopedTraceZone&) = delete;
+    ScopedTraceZone& operator=(const ScopedTraceZone&) = delete;
+};
+
+/**
+ * @brief std::lock_guard that records the time spent waiting for the lock.
+ *
+ * Only contended acquisitions record a zone (category "lock"): an
+ * uncontended lock costs one try_lock, as in an untraced build.
+ */
+template <typename Mutex>
+class TracedLockGuard {
+private:
+    Mutex& mutex_;
+
+public:
+    TracedLockGuard(Mutex& mutex, const char* name) : mutex_(mutex) {
+#ifdef MECALUX_TRACING
+        if (mutex_.try_lock()) return;
+        auto start = Tracer::Clock::now();
+        mutex_.lock();
+        if (Tracer::Instance().IsEnabled()) {
+            Tracer::Instance().Record(name, "lock", start, Tracer::Clock::now());
+        }
+#else
+        (void)name;
+        mutex_.lock();
+#endif
+    }
+
+    ~TracedLockGuard() { mutex_.unlock(); }
+
+    TracedLockGuard(const TracedLockGuard&) = delete;
+    TracedLockGuard& operator=(const TracedLockGuard&) = delete;
+};
+
+} // namespace Common
+} // namespace Backend
+
+// =============================================================================
+// MACROS
+// =============================================================================
+
+#define MECALUX_TRACE_CONCAT_INNER(a, b) a##b
+#define MECALUX_TRACE_CONCAT(a, b) MECALUX_TRACE_CONCAT_INNER(a, b)
+
+#ifdef MECALUX_TRACING
+
+/// Record the rest of the enclosing scope as a zone (name and category: string literals)
+#define TRACE_ZONE(name, category) \
+    ::Backend::Common::ScopedTraceZone MECALUX_TRACE_CONCAT(traceZone_, __LINE__)(name, category)
+
+/// Name the calling thread in traces
+#define TRACE_THREAD_NAME(name) ::Backend::Common::Tracer::Instance().SetThreadName(name)
+
+#else
+
+#define TRACE_ZONE(name, category) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
+
+#endif // BACKEND_COMMON_TRACE_HH
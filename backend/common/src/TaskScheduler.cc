@@ -0,0 +1,153 @@
+/**
+ * @file TaskScheduler.cc
+ * @brief Implementation of the work-stealing task scheduler
+ */
+
+#include "TaskScheduler.hh"
+#include <algorithm>
+
+namespace Backend {
+namespace Common {
+
+namespace {
+
+/// Scheduler and deque of the worker running on this thread (none outside workers)
+thread_local const TaskScheduler* currentScheduler = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // namespace
+
+TaskScheduler::TaskScheduler(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void TaskScheduler::Enqueue(TaskPriority priority, std::function<void()> task) {
+    const size_t lane = static_cast<size_t>(priority);
+    const size_t target = currentScheduler == this
+        ? currentWorker
+        : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->lanes[lane].push_back(std::move(task));
+    }
+    submitted_[lane].fetch_add(1, std::memory_order_relaxed);
+    queued_.fetch_add(1);
+
+    // Taking the lock orders this against a worker about to sleep
+    { std::lock_guard<std::mutex> lock(sleepMutex_); }
+    wake_.notify_one();
+}
+
+bool TaskScheduler::TryRunOne(size_t self) {
+    const size_t count = workers_.size();
+    for (size_t lane = 0; lane < TASK_PRIORITY_COUNT; ++lane) {
+        // Own deque newest first, then the others' oldest first
+        for (size_t k = 0; k < count; ++k) {
+            const size_t victim = (self + k) % count;
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(workers_[victim]->mutex);
+                auto& deque = workers_[victim]->lanes[lane];
+                if (deque.empty()) continue;
+                if (k == 0) {
+                    task = std::move(deque.back());
+                    deque.pop_back();
+                } else {
+                    task = std::move(deque.front());
+                    deque.pop_front();
+                }
+            }
+            queued_.fetch_sub(1);
+            if (k != 0) stolen_.fetch_add(1, std::memory_order_relaxed);
+            task();
+            executed_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::WorkerLoop(size_t self) {
+    currentScheduler = this;
+    currentWorker = self;
+    while (true) {
+        if (TryRunOne(self)) continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+        // Queued tasks still run when stopping
+        if (stopping_ && queued_.load() == 0) return;
+    }
+}
+
+void TaskScheduler::ParallelFor(size_t jobs, const std::function<void(size_t)>& job, TaskPriority priority) {
+    if (jobs <= 1) {
+        if (jobs == 1) job(0);
+        return;
+    }
+
+    // Helpers that start after the last job was claimed find nothing left
+    // and never touch job, so the state outlives this call but job need not
+    struct State {
+        const std::function<void(size_t)>* job;
+        size_t jobs;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+    state->job = &job;
+    state->jobs = jobs;
+
+    auto runJobs = [state]() {
+        for (size_t i = state->next.fetch_add(1); i < state->jobs; i = state->next.fetch_add(1)) {
+            (*state->job)(i);
+            if (state->done.fetch_add(1) + 1 == state->jobs) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(jobs - 1, threads_.size());
+    for (size_t h = 0; h < helpers; ++h) {
+        Enqueue(priority, runJobs);
+    }
+    runJobs();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done.load() == jobs; });
+}
+
+TaskScheduler::Stats TaskScheduler::GetStats() const {
+    Stats stats;
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    for (size_t lane = 0; lane < TASK_PRIORITY_COUNT; ++lane) {
+        stats.submitted[lane] = submitted_[lane].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+} // namespace Common
+} // namespace Backend
@@ -0,0 +1,146 @@
+/**
+ * @file Trace.cc
+ * @brief Implementation of the trace recorder and its Chrome trace export
+ */
+
+#include "Trace.hh"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace Backend {
+namespace Common {
+
+namespace {
+
+/// JSON string body (names are literals and thread names, but stay safe)
+void WriteEscaped(std::ostream& out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+}
+
+double ToMicroseconds(int64_t ns) {
+    return static_cast<double>(ns) / 1000.0;
+}
+
+} // namespace
+
+Tracer::Tracer()
+    : epoch_(Clock::now())
+    , enabled_(true) {}
+
+Tracer& Tracer::Instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::ThreadBuffer& Tracer::LocalBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> local;
+    if (!local) {
+        local = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        local->id = static_cast<int>(buffers_.size()) + 1;
+        local->name = "Thread " + std::to_string(local->id);
+        buffers_.push_back(local);
+    }
+    return *local;
+}
+
+void Tracer::SetThreadName(const std::string& name) {
+    ThreadBuffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.name = name;
+}
+
+void Tracer::Record(const char* name, const char* category, Clock::time_point start, Clock::time_point end) {
+    ThreadBuffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.ring.empty()) {
+        buffer.ring.resize(EVENTS_PER_THREAD);
+    }
+    TraceEvent& event = buffer.ring[buffer.written % buffer.ring.size()];
+    event.name = name;
+    event.category = category;
+    event.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch_).count();
+    event.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    buffer.written++;
+}
+
+size_t Tracer::GetEventCount() {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    size_t count = 0;
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        count += static_cast<size_t>(std::min<uint64_t>(buffer->written, buffer->ring.size()));
+    }
+    return count;
+}
+
+void Tracer::Clear() {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->written = 0;
+    }
+}
+
+bool Tracer::WriteChromeTrace(const std::string& path) {
+    // Copy out thread by thread: a recording thread waits for one copy at most
+    struct ThreadEvents {
+        int id;
+        std::string name;
+        std::vector<TraceEvent> events;
+    };
+    std::vector<ThreadEvents> threads;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        threads.reserve(buffers_.size());
+        for (const auto& buffer : buffers_) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            ThreadEvents copy{buffer->id, buffer->name, {}};
+            size_t size = buffer->ring.size();
+            size_t held = static_cast<size_t>(std::min<uint64_t>(buffer->written, size));
+            copy.events.reserve(held);
+            for (uint64_t i = buffer->written - held; i < buffer->written; ++i) {
+                copy.events.push_back(buffer->ring[i % size]);
+            }
+            threads.push_back(std::move(copy));
+        }
+    }
+
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& thread : threads) {
+        out << (first ? "" : ",\n")
+            << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread.id
+            << ",\"args\":{\"name\":\"";
+        WriteEscaped(out, thread.name);
+        out << "\"}}";
+        first = false;
+        for (const auto& event : thread.events) {
+            out << ",\n{\"ph\":\"X\",\"name\":\"";
+            WriteEscaped(out, event.name);
+            out << "\",\"cat\":\"";
+            WriteEscaped(out, event.category);
+            out << "\",\"pid\":1,\"tid\":" << thread.id
+                << ",\"ts\":" << ToMicroseconds(event.startNs)
+                << ",\"dur\":" << ToMicroseconds(event.durationNs) << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+} // namespace Common
+} // namespace Backend
@@ -0,0 +1,634 @@
+/**
+ * @file fleet_stress.cc
+ * @brief Large-fleet scalability stress test over generated warehouses
+ *
+ * For each fleet size, generates a parametric warehouse (parallel aisles
+ * between single and back-to-back racks, a charging yard with one station
+ * per robot above the racks and a dock of dropoffs below them), runs the
+ * full FleetManager on it in batch mode under a seeded order stream and
+ * reports how the system scales:
+ *
+ * - physics tick time (p50 / p99 / p99.9 / max of the 20 Hz fleet loop)
+ * - replan latency (background VRP solves and whole strategic ticks)
+ * - throughput (tasks completed per simulated hour) and backlog
+ * - peak resident memory of the run
+ *
+ * Simulated time is fleet loop ticks times the tick period, so results do
+ * not depend on how fast batch mode runs. Orders arrive as a Poisson
+ * process of --order-rate orders per robot per hour (load grows with the
+ * fleet); pickup and dropoff are drawn with mt19937 modulo, as in
+ * layer2/solver_benchmark.cc, so every run with the same seed sees the
+ * same stream. A run ends after --duration simulated seconds, or after
+ * --max-wall seconds of real time if the fleet cannot keep up.
+ *
+ * Orders injected one at a time never exceed SystemConfig::batchThreshold,
+ * so they all take cheap insertion and no background solve ever runs.
+ * --wave holds the orders that arrive within a window and injects them
+ * together at its end; with --batch-threshold and --starter-tasks low
+ * enough each wave goes to a background replan, which is what the
+ * replan_solve metrics measure (make perf-check runs this way). Solves
+ * run on the wall clock, which batch mode outruns, so waved orders wait
+ * longer for a robot than they would live and throughput drops.
+ *
+ * Usage:
+ *   make stress ARGS="--robots 10,50,100,500,1000 --csv stress.csv"
+ *   ./build/fleet_stress --aisles 16 --rack-depth 1.2 --hall 80x50 --robots 200
+ *
+ * Options:
+ *   --robots a,b,...           Fleet sizes to run (default 10,50,100)
+ *   --aisles N                 Aisles in the rack block (default 10)
+ *   --rack-depth M             Depth of one rack in meters (default 1.0)
+ *   --aisle-width M            Width of an aisle in meters (default 2.5)
+ *   --hall WxL                 Minimum hall width x aisle length in meters (default 60x30);
+ *                              the width grows to fit the aisles, the length by the yard and dock
+ *   --resolution dm|cm         Map resolution (default dm)
+ *   --order-rate R             Orders per robot per simulated hour (default 30)
+ *   --duration S               Simulated seconds per run (default 300)
+ *   --max-wall S               Real seconds per run before it is cut short (default 120)
+ *   --wave S                   Inject the orders of each S simulated seconds together at the
+ *                              end of the window (default 0: each one as it arrives)
+ *   --batch-threshold N        SystemConfig::batchThreshold (default 5)
+ *   --starter-tasks N          SystemConfig::starterTasksPerRobot (default 2)
+ *   --physics-threads N        SystemConfig::physicsThreads (default 1)
+ *   --path-threads N           SystemConfig::pathfindingThreads (default 0: paths are
+ *                              computed inline and arrive the tick they are asked for,
+ *                              as in a replay; workers run on the wall clock, which
+ *                              batch mode outruns)
+ *   --fidelity full|kinematic  SystemConfig::simulationFidelity (default full; kinematic
+ *                              drives cost-matrix travel times from arrival to arrival)
+ *   --queue-seconds S          SystemConfig::kinematicQueueSeconds (default 0)
+ *   --load-capacity N          SystemConfig::robotLoadCapacity (default 1: one packet per trip)
+ *   --seed S                   Order stream seed (default 1)
+ *   --site DIR                 Where each run's warehouse is written (default build/stress/site)
+ *   --label TEXT               Recorded in the JSON output (e.g. a commit)
+ *   --csv FILE                 Write the results as CSV (default: stdout)
+ *   --json FILE                Write the results as JSON
+ *   --verbose 1                Keep the fleet manager's own logging (stdout)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "FleetManager.hh"
+#include "Resolution.hh"
+
+using namespace Backend;
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+const double WALL_METERS = 0.2;             ///< Outer wall thickness
+const double CHARGER_SPACING_METERS = 1.5;  ///< Between stations in the yard (two robot diameters and then some)
+const double CROSS_AISLE_METERS = 3.0;      ///< Open floor around the rack block
+const double PICK_SPACING_METERS = 4.0;     ///< Between pickups along an aisle
+const double DOCK_SPACING_METERS = 3.0;     ///< Between dropoffs along the dock
+const double DOCK_DEPTH_METERS = 4.0;
+const float TICK_MS = 50.0f;                ///< Physics period the simulated clock counts in
+const int POLL_INTERVAL_MS = 1;
+
+struct StressOptions {
+    std::vector<int> robotCounts = {10, 50, 100};
+    int aisles = 10;
+    double rackDepthMeters = 1.0;
+    double aisleWidthMeters = 2.5;
+    double hallWidthMeters = 60.0;
+    double aisleLengthMeters = 30.0;
+    Common::Resolution resolution = Common::Resolution::DECIMETERS;
+    double orderRate = 30.0;
+    double durationSeconds = 300.0;
+    double maxWallSeconds = 120.0;
+    double waveSeconds = 0.0;
+    int batchThreshold = 5;
+    int starterTasks = 2;
+    int physicsThreads = 1;
+    int pathThreads = 0;
+    SimulationFidelity fidelity = SimulationFidelity::FULL;
+    double queueSeconds = 0.0;
+    int loadCapacity = 1;
+    unsigned int seed = 1;
+    std::string siteDir = "build/stress/site";
+    std::string label;
+    std::string csvPath;
+    std::string jsonPath;
+    bool verbose = false;
+};
+
+/// The generated warehouse: grid size and POIs (pixels)
+struct Site {
+    int width = 0;
+    int height = 0;
+    double widthMeters = 0.0;
+    double heightMeters = 0.0;
+    int chargers = 0;
+    int pickups = 0;
+    int dropoffs = 0;
+};
+
+struct StressResult {
+    int robots = 0;
+    Site site;
+    double simSeconds = 0.0;
+    double wallSeconds = 0.0;
+    bool cutShort = false;              ///< --max-wall reached before --duration
+    int injected = 0;
+    int completed = 0;
+    uint64_t refused = 0;
+    double throughputPerHour = 0.0;
+    Common::LatencyHistogram::Summary physicsTick;
+    Common::LatencyHistogram::Summary mainTick;
+    Common::LatencyHistogram::Summary replanSolve;
+    Common::LatencyHistogram::Summary pathQuery;
+    long peakRssKb = -1;
+};
+
+// =============================================================================
+// HELPER FUNCTIONS
+// =============================================================================
+
+std::vector<int> SplitInts(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+unsigned int Draw(std::mt19937& rng, size_t n) {
+    return static_cast<unsigned int>(rng() % n);
+}
+
+/// Exponential inter-arrival time for a rate in events per second
+double DrawInterval(std::mt19937& rng, double ratePerSecond) {
+    double u = (static_cast<double>(rng()) + 1.0) / (static_cast<double>(std::mt19937::max()) + 2.0);
+    return -std::log(u) / ratePerSecond;
+}
+
+bool ResetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (!clearRefs) return false;
+    clearRefs << "5";
+    return static_cast<bool>(clearRefs.flush());
+}
+
+long PeakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::atol(line.c_str() + 6);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+Common::LatencyHistogram::Summary FindMetric(const std::vector<API::LatencyMetric>& metrics,
+                                             const std::string& name) {
+    for (const auto& metric : metrics) {
+        if (metric.name == name) return metric.summary;
+    }
+    return Common::LatencyHistogram::Summary();
+}
+
+// =============================================================================
+// WAREHOUSE GENERATION
+// =============================================================================
+
+/**
+ * @brief Write map_layout.txt, poi_config.json and system_config.json for
+ *        a warehouse with at least chargers stations into options.siteDir.
+ *
+ * Top to bottom: the charging yard (stations on a CHARGER_SPACING grid), a
+ * cross aisle, the rack block (rack, aisle, double rack, aisle, ..., rack,
+ * with pickups along the middle of each aisle), another cross aisle and
+ * the dock (a row of dropoffs).
+ */
+bool GenerateSite(const StressOptions& options, int chargers, Site& site) {
+    const double metersPerPixel = Common::GetConversionFactorToMeters(options.resolution);
+    auto px = [metersPerPixel](double meters) { return static_cast<int>(std::lround(meters / metersPerPixel)); };
+
+    const double blockWidth = options.aisles * (options.aisleWidthMeters + 2.0 * options.rackDepthMeters);
+    const double widthMeters = std::max(options.hallWidthMeters, blockWidth + 2.0 * (CROSS_AISLE_METERS + WALL_METERS));
+    const double usableWidth = widthMeters - 2.0 * WALL_METERS;
+
+    const int chargersPerRow = std::max(1, static_cast<int>(usableWidth / CHARGER_SPACING_METERS) - 1);
+    const int chargerRows = (chargers + chargersPerRow - 1) / chargersPerRow;
+    const double yardDepth = (chargerRows + 1) * CHARGER_SPACING_METERS;
+
+    const double yardTop = WALL_METERS;
+    const double blockTop = yardTop + yardDepth + CROSS_AISLE_METERS;
+    const double blockBottom = blockTop + options.aisleLengthMeters;
+    const double dockTop = blockBottom + CROSS_AISLE_METERS;
+    const double heightMeters = dockTop + DOCK_DEPTH_METERS + WALL_METERS;
+
+    site.width = px(widthMeters);
+    site.height = px(heightMeters);
+    site.widthMeters = widthMeters;
+    site.heightMeters = heightMeters;
+
+    std::vector<std::string> grid(site.height, std::string(site.width, '.'));
+    auto fill = [&grid, &site](int x0, int y0, int x1, int y1) {
+        for (int y = std::max(0, y0); y < std::min(site.height, y1); ++y) {
+            for (int x = std::max(0, x0); x < std::min(site.width, x1); ++x) grid[y][x] = '#';
+        }
+    };
+    const int wall = std::max(1, px(WALL_METERS));
+    fill(0, 0, site.width, wall);
+    fill(0, site.height - wall, site.width, site.height);
+    fill(0, 0, wall, site.height);
+    fill(site.width - wall, 0, site.width, site.height);
+
+    // Rack block, centered
+    std::vector<double> aisleCenters;
+    double x = (widthMeters - blockWidth) / 2.0;
+    for (int a = 0; a < options.aisles; ++a) {
+        double rackWidth = options.rackDepthMeters * (a == 0 ? 1.0 : 2.0);
+        fill(px(x), px(blockTop), px(x + rackWidth), px(blockBottom));
+        x += rackWidth;
+        aisleCenters.push_back(x + options.aisleWidthMeters / 2.0);
+        x += options.aisleWidthMeters;
+    }
+    fill(px(x), px(blockTop), px(x + options.rackDepthMeters), px(blockBottom));
+
+    std::ofstream map(options.siteDir + "/map_layout.txt");
+    for (const auto& row : grid) map << row << "\n";
+    if (!map) return false;
+
+    std::ofstream poi(options.siteDir + "/poi_config.json");
+    poi << "{\n"
+        << "    \"description\": \"Generated by fleet_stress\",\n"
+        << "    \"coordinate_system\": \"pixels (" << metersPerPixel << "m/pixel)\",\n"
+        << "    \"physical_dimensions\": {\n"
+        << "        \"width_m\": " << widthMeters << ",\n"
+        << "        \"height_m\": " << heightMeters << "\n"
+        << "    },\n"
+        << "    \"poi\": [";
+    bool first = true;
+    auto emit = [&poi, &first, &px](const std::string& id, const char* type, double xMeters, double yMeters) {
+        poi << (first ? "\n" : ",\n") << "        {\"id\": \"" << id << "\", \"type\": \"" << type
+            << "\", \"x\": " << px(xMeters) << ", \"y\": " << px(yMeters) << ", \"active\": true}";
+        first = false;
+    };
+
+    site.chargers = 0;
+    for (int i = 0; i < chargers; ++i) {
+        double cx = WALL_METERS + CHARGER_SPACING_METERS * (1 + i % chargersPerRow);
+        double cy = yardTop + CHARGER_SPACING_METERS * (1 + i / chargersPerRow);
+        emit("C" + std::to_string(i), "CHARGING", cx, cy);
+        ++site.chargers;
+    }
+
+    site.pickups = 0;
+    for (size_t a = 0; a < aisleCenters.size(); ++a) {
+        for (double y = blockTop + PICK_SPACING_METERS / 2.0; y < blockBottom; y += PICK_SPACING_METERS) {
+            emit("P" + std::to_string(site.pickups), "PICKUP", aisleCenters[a], y);
+            ++site.pickups;
+        }
+    }
+
+    site.dropoffs = 0;
+    for (double dx = WALL_METERS + DOCK_SPACING_METERS; dx < widthMeters - DOCK_SPACING_METERS; dx += DOCK_SPACING_METERS) {
+        emit("D" + std::to_string(site.dropoffs), "DROPOFF", dx, dockTop + DOCK_DEPTH_METERS / 2.0);
+        ++site.dropoffs;
+    }
+    poi << "\n    ]\n}\n";
+    if (!poi) return false;
+
+    // FleetManager::Initialize takes the POI path from here
+    std::ofstream config(options.siteDir + "/system_config.json");
+    config << "{\n"
+           << "    \"orca_tick_ms\": " << TICK_MS << ",\n"
+           << "    \"robot_radius_meters\": 0.3,\n"
+           << "    \"poi_config_path\": \"poi_config.json\"\n"
+           << "}\n";
+    return static_cast<bool>(config);
+}
+
+// =============================================================================
+// STRESS RUN
+// =============================================================================
+
+StressResult RunFleet(const StressOptions& options, int robots) {
+    StressResult result;
+    result.robots = robots;
+
+    // The yard grows with the fleet, the rack block stays the same
+    std::error_code ec;
+    std::filesystem::create_directories(options.siteDir, ec);
+    if (ec || !GenerateSite(options, robots, result.site)) {
+        std::cerr << "[Stress] Could not write the warehouse to " << options.siteDir << "\n";
+        return result;
+    }
+    const Site& site = result.site;
+    std::cerr << "[Stress] " << robots << " robots: warehouse " << std::fixed << std::setprecision(1)
+              << site.widthMeters << " x " << site.heightMeters << " m (" << site.width << "x" << site.height
+              << " px), " << site.chargers << " chargers, " << site.pickups << " pickups, "
+              << site.dropoffs << " dropoffs\n";
+
+    SystemConfig config;
+    config.numRobots = robots;
+    config.batchMode = true;
+    config.orcaTickMs = TICK_MS;
+    config.mapResolution = options.resolution;
+    config.physicsThreads = options.physicsThreads;
+    config.pathfindingThreads = options.pathThreads;
+    config.simulationFidelity = options.fidelity;
+    config.kinematicQueueSeconds = options.queueSeconds;
+    config.robotLoadCapacity = options.loadCapacity;
+    config.batchThreshold = options.batchThreshold;
+    config.starterTasksPerRobot = options.starterTasks;
+    config.mapPath = "map_layout.txt";
+    config.poiConfigPath = "poi_config.json";
+    config.mapCachePath = "";           // Every site is new
+    config.graphExportDir = "";
+    config.costMatrixCachePath = "";
+    config.telemetryRingSlots = 0;
+
+    bool peakReset = ResetPeakRss();
+    FleetManager manager(config, options.siteDir);
+    if (!manager.Initialize()) {
+        std::cerr << "[Stress] FleetManager failed to initialize with " << robots << " robots\n";
+        return result;
+    }
+    std::vector<int> pickups = manager.GetPickupNodes();
+    std::vector<int> dropoffs = manager.GetDropoffNodes();
+    if (pickups.empty() || dropoffs.empty()) {
+        std::cerr << "[Stress] Site has no usable pickups or dropoffs\n";
+        return result;
+    }
+
+    // Same stream for every fleet size, scaled to it
+    std::mt19937 rng(options.seed);
+    const double ratePerSecond = options.orderRate * robots / 3600.0;
+    double nextArrival = DrawInterval(rng, ratePerSecond);
+    std::vector<std::pair<int, int>> wave;      ///< Orders held until nextWave
+    double nextWave = options.waveSeconds;
+
+    const double tickSeconds = TICK_MS / 1000.0;
+    auto wallStart = std::chrono::steady_clock::now();
+    manager.Start();
+
+    double simSeconds = 0.0;
+    while (simSeconds < options.durationSeconds) {
+        simSeconds = manager.GetStats().fleetLoopCount * tickSeconds;
+        while (nextArrival <= simSeconds && nextArrival < options.durationSeconds) {
+            int source = pickups[Draw(rng, pickups.size())];
+            int dest = dropoffs[Draw(rng, dropoffs.size())];
+            wave.emplace_back(source, dest);
+            nextArrival += DrawInterval(rng, ratePerSecond);
+        }
+        // The main loop drains the queue whole, so a wave becomes one batch
+        if (options.waveSeconds <= 0.0 || simSeconds >= nextWave) {
+            for (const auto& order : wave) {
+                if (manager.InjectTask(order.first, order.second)) ++result.injected;
+            }
+            wave.clear();
+            nextWave += options.waveSeconds;
+        }
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        if (wall >= options.maxWallSeconds) {
+            result.cutShort = true;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+    }
+
+    manager.Stop();
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    FleetStats stats = manager.GetStats();
+    result.simSeconds = stats.fleetLoopCount * tickSeconds;
+    result.completed = stats.completedTasks;
+    result.refused = manager.GetInjectionsRefused();
+    result.throughputPerHour = result.simSeconds > 0.0 ? result.completed * 3600.0 / result.simSeconds : 0.0;
+
+    std::vector<API::LatencyMetric> metrics = manager.GetLatencyMetrics();
+    result.physicsTick = FindMetric(metrics, "physics_tick");
+    result.mainTick = FindMetric(metrics, "main_tick");
+    result.replanSolve = FindMetric(metrics, "replan_solve");
+    result.pathQuery = FindMetric(metrics, "path_query");
+    result.peakRssKb = peakReset ? PeakRssKb() : -1;
+    return result;
+}
+
+// =============================================================================
+// OUTPUT
+// =============================================================================
+
+void WriteCSV(std::ostream& out, const std::vector<StressResult>& results) {
+    out << "robots,width_m,height_m,sim_s,wall_s,cut_short,injected,completed,refused,throughput_per_hour,"
+        << "tick_p50_ms,tick_p99_ms,tick_p999_ms,tick_max_ms,"
+        << "main_tick_p50_ms,main_tick_p99_ms,replans,replan_p50_ms,replan_p99_ms,replan_max_ms,"
+        << "path_query_p99_ms,peak_rss_mb\n";
+    out << std::fixed;
+    for (const auto& r : results) {
+        out << r.robots << "," << std::setprecision(1) << r.site.widthMeters << "," << r.site.heightMeters
+            << "," << r.simSeconds << "," << std::setprecision(3) << r.wallSeconds << std::setprecision(1) << ","
+            << (r.cutShort ? 1 : 0) << "," << r.injected << "," << r.completed << "," << r.refused << ","
+            << r.throughputPerHour << "," << std::setprecision(3)
+            << r.physicsTick.p50Us / 1000.0 << "," << r.physicsTick.p99Us / 1000.0 << ","
+            << r.physicsTick.p999Us / 1000.0 << "," << r.physicsTick.maxUs / 1000.0 << ","
+            << r.mainTick.p50Us / 1000.0 << "," << r.mainTick.p99Us / 1000.0 << ","
+            << r.replanSolve.count << "," << r.replanSolve.p50Us / 1000.0 << ","
+            << r.replanSolve.p99Us / 1000.0 << "," << r.replanSolve.maxUs / 1000.0 << ","
+            << r.pathQuery.p99Us / 1000.0 << "," << std::setprecision(1) << r.peakRssKb / 1024.0 << "\n";
+    }
+}
+
+void WriteSummary(const std::string& name, const Common::LatencyHistogram::Summary& summary, std::ostream& out) {
+    out << "\"" << name << "\": {\"count\": " << summary.count << std::setprecision(3)
+        << ", \"mean_ms\": " << summary.GetMeanUs() / 1000.0 << ", \"p50_ms\": " << summary.p50Us / 1000.0
+        << ", \"p99_ms\": " << summary.p99Us / 1000.0 << ", \"p999_ms\": " << summary.p999Us / 1000.0
+        << ", \"max_ms\": " << summary.maxUs / 1000.0 << "}";
+}
+
+void WriteJSON(std::ostream& out, const std::vector<StressResult>& results, const StressOptions& options) {
+    std::time_t now = std::time(nullptr);
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << std::fixed << "{\n"
+        << "  \"label\": \"" << options.label << "\",\n"
+        << "  \"timestamp\": \"" << timestamp << "\",\n"
+        << "  \"seed\": " << options.seed << ",\n"
+        << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+        << std::setprecision(1)
+        << "  \"layout\": {\"resolution\": \"" << Common::GetResolutionName(options.resolution) << "\""
+        << ", \"aisles\": " << options.aisles << ", \"rack_depth_m\": " << options.rackDepthMeters
+        << ", \"aisle_width_m\": " << options.aisleWidthMeters << ", \"aisle_length_m\": "
+        << options.aisleLengthMeters << "},\n"
+        << "  \"order_rate_per_robot_hour\": " << options.orderRate << ",\n"
+        << "  \"duration_s\": " << options.durationSeconds << ",\n"
+        << "  \"wave_s\": " << options.waveSeconds << ",\n"
+        << "  \"batch_threshold\": " << options.batchThreshold << ",\n"
+        << "  \"starter_tasks_per_robot\": " << options.starterTasks << ",\n"
+        << "  \"runs\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"robots\": " << r.robots << std::setprecision(1)
+            << ", \"site\": {\"width_m\": " << r.site.widthMeters << ", \"height_m\": " << r.site.heightMeters
+            << ", \"width_px\": " << r.site.width << ", \"height_px\": " << r.site.height
+            << ", \"chargers\": " << r.site.chargers << ", \"pickups\": " << r.site.pickups
+            << ", \"dropoffs\": " << r.site.dropoffs << "}"
+            << ", \"sim_s\": " << r.simSeconds
+            << std::setprecision(3) << ", \"wall_s\": " << r.wallSeconds << std::setprecision(1) << ", \"cut_short\": " << (r.cutShort ? "true" : "false")
+            << ", \"injected\": " << r.injected << ", \"completed\": " << r.completed
+            << ", \"refused\": " << r.refused << ", \"throughput_per_hour\": " << r.throughputPerHour
+            << ", \"peak_rss_kb\": " << r.peakRssKb << ", ";
+        WriteSummary("physics_tick", r.physicsTick, out);
+        out << ", ";
+        WriteSummary("main_tick", r.mainTick, out);
+        out << ", ";
+        WriteSummary("replan_solve", r.replanSolve, out);
+        out << ", ";
+        WriteSummary("path_query", r.pathQuery, out);
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+bool ParseArguments(int argc, char** argv, StressOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--robots") {
+            options.robotCounts = SplitInts(value);
+        } else if (arg == "--aisles") {
+            options.aisles = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--rack-depth") {
+            options.rackDepthMeters = std::max(0.1, std::atof(value.c_str()));
+        } else if (arg == "--aisle-width") {
+            options.aisleWidthMeters = std::max(1.0, std::atof(value.c_str()));
+        } else if (arg == "--hall") {
+            size_t split = value.find('x');
+            if (split == std::string::npos) {
+                std::cerr << "--hall takes WIDTHxLENGTH in meters\n";
+                return false;
+            }
+            options.hallWidthMeters = std::atof(value.substr(0, split).c_str());
+            options.aisleLengthMeters = std::max(PICK_SPACING_METERS, std::atof(value.substr(split + 1).c_str()));
+        } else if (arg == "--resolution") {
+            if (value == "dm") {
+                options.resolution = Common::Resolution::DECIMETERS;
+            } else if (value == "cm") {
+                options.resolution = Common::Resolution::CENTIMETERS;
+            } else {
+                std::cerr << "--resolution takes dm or cm\n";
+                return false;
+            }
+        } else if (arg == "--order-rate") {
+            options.orderRate = std::max(0.1, std::atof(value.c_str()));
+        } else if (arg == "--duration") {
+            options.durationSeconds = std::max(1.0, std::atof(value.c_str()));
+        } else if (arg == "--max-wall") {
+            options.maxWallSeconds = std::max(1.0, std::atof(value.c_str()));
+        } else if (arg == "--wave") {
+            options.waveSeconds = std::max(0.0, std::atof(value.c_str()));
+        } else if (arg == "--batch-threshold") {
+            options.batchThreshold = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--starter-tasks") {
+            options.starterTasks = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--physics-threads") {
+            options.physicsThreads = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--path-threads") {
+            options.pathThreads = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--fidelity") {
+            if (value != "full" && value != "kinematic") {
+                std::cerr << "--fidelity takes full or kinematic\n";
+                return false;
+            }
+            options.fidelity = value == "kinematic" ? SimulationFidelity::KINEMATIC : SimulationFidelity::FULL;
+        } else if (arg == "--queue-seconds") {
+            options.queueSeconds = std::max(0.0, std::atof(value.c_str()));
+        } else if (arg == "--load-capacity") {
+            options.loadCapacity = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--seed") {
+            options.seed = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--site") {
+            options.siteDir = value;
+        } else if (arg == "--label") {
+            options.label = value;
+        } else if (arg == "--csv") {
+            options.csvPath = value;
+        } else if (arg == "--json") {
+            options.jsonPath = value;
+        } else if (arg == "--verbose") {
+            options.verbose = value != "0";
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.robotCounts.empty()) {
+        std::cerr << "--robots needs at least one fleet size\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    StressOptions options;
+    if (!ParseArguments(argc, argv, options)) return 1;
+
+    // The fleet manager logs every tick's events to stdout; muted unless
+    // asked for so CSV on stdout stays parseable
+    std::streambuf* stdoutBuffer = std::cout.rdbuf();
+    if (!options.verbose) std::cout.rdbuf(nullptr);
+
+    std::vector<StressResult> results;
+    for (int robots : options.robotCounts) {
+        results.push_back(RunFleet(options, robots));
+        const StressResult& r = results.back();
+        std::cerr << "[Stress] " << std::setw(5) << robots << " robots: " << std::setprecision(1)
+                  << r.simSeconds << " s simulated in " << r.wallSeconds << " s" << (r.cutShort ? " (cut short)" : "")
+                  << ", tick p99 " << std::setprecision(2) << r.physicsTick.p99Us / 1000.0 << " ms"
+                  << ", replan p99 " << r.replanSolve.p99Us / 1000.0 << " ms"
+                  << ", " << std::setprecision(0) << r.throughputPerHour << " tasks/h"
+                  << " (" << r.completed << "/" << r.injected << ")"
+                  << ", peak RSS " << r.peakRssKb / 1024 << " MB\n";
+    }
+
+    std::cout.rdbuf(stdoutBuffer);
+    std::cout.clear();
+
+    if (options.csvPath.empty() && options.jsonPath.empty()) {
+        WriteCSV(std::cout, results);
+    }
+    if (!options.csvPath.empty()) {
+        std::ofstream csv(options.csvPath);
+        WriteCSV(csv, results);
+        std::cerr << "[Stress] Wrote " << results.size() << " runs to " << options.csvPath << "\n";
+    }
+    if (!options.jsonPath.empty()) {
+        std::ofstream json(options.jsonPath);
+        WriteJSON(json, results, options);
+        std::cerr << "[Stress] Wrote " << results.size() << " runs to " << options.jsonPath << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,781 @@
+/**
+ * @file fleet_tests.cc
+ * @brief Fleet Manager component tests
+ *
+ * The layer test drivers (layerN/main.cc) cover each layer; this one
+ * covers the pieces of the fleet manager itself that need no running
+ * fleet:
+ * 1. BoundedMPSCQueue (task injection): wrap-around, a full queue, and
+ *    several producers with one consumer
+ * 2. FleetCheckpoint: Save / Load round trip, another mesh's checkpoint
+ *    and damaged files
+ * 3. EventLog: write / Read round trip and a torn last record, then a
+ *    recorded batch shift and its replay, which must reach every logged
+ *    goal at its logged tick
+ * 4. TaskIngestServer: acks over a real socket for a good batch, an
+ *    empty one, garbage and a truncated batch
+ * 5. PushServer: a robot subscription is refused on a binary connection
+ *    (which keeps getting every robot) and honoured on a JSON one
+ * 6. TelemetryCodec: keyframe / delta round trip through the decoder,
+ *    with robots joining and leaving, and a decoder joining mid-stream
+ *
+ * Usage:
+ *   make check
+ *   ./build/fleet_tests
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "BoundedMPSCQueue.hh"
+#include "EventLog.hh"
+#include "FleetCheckpoint.hh"
+#include "FleetManager.hh"
+#include "PushServer.hh"
+#include "TaskIngestServer.hh"
+#include "TaskLoader.hh"
+#include "../api/TelemetryCodec.hh"
+
+using namespace Backend;
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+const size_t QUEUE_CAPACITY = 4;
+const int QUEUE_LAPS = 10;
+const int PRODUCERS = 4;
+const int VALUES_PER_PRODUCER = 20000;
+const std::string TASKS_PATH = "../api/set_of_tasks.json";     // As fleet_manager, run from backend/
+const double SHIFT_WALL_SECONDS = 120.0;                        // A batch shift that takes longer is stuck
+
+// =============================================================================
+// ANSI Color Codes for test output
+// =============================================================================
+#define COLOR_RESET   "\033[0m"
+#define COLOR_GREEN   "\033[32m"
+#define COLOR_RED     "\033[31m"
+#define COLOR_CYAN    "\033[36m"
+
+void PrintHeader(const std::string& title) {
+    std::cout << "\n" << COLOR_CYAN
+              << "======================================================\n"
+              << "  " << title << "\n"
+              << "======================================================"
+              << COLOR_RESET << "\n\n";
+}
+
+int totalTests = 0;
+int passedTests = 0;
+
+void Check(bool passed, const std::string& test) {
+    totalTests++;
+    if (passed) {
+        passedTests++;
+        std::cout << COLOR_GREEN << "[PASS] " << COLOR_RESET << test << std::endl;
+    } else {
+        std::cout << COLOR_RED << "[FAIL] " << COLOR_RESET << test << std::endl;
+    }
+}
+
+// =============================================================================
+// PHASE 1: BoundedMPSCQueue
+// =============================================================================
+
+void TestInjectionQueue() {
+    PrintHeader("PHASE 1: BoundedMPSCQueue");
+
+    // --- 1a. Values come out in order while positions lap the ring ---
+    {
+        BoundedMPSCQueue<int> queue(QUEUE_CAPACITY);
+        bool inOrder = queue.GetCapacity() == QUEUE_CAPACITY;
+        int next = 0;
+        int expected = 0;
+        for (int lap = 0; lap < QUEUE_LAPS; ++lap) {
+            // Fill, then drain half, so the next fill starts mid-ring
+            while (queue.TryPush(next)) next++;
+            for (size_t i = 0; i < QUEUE_CAPACITY / 2; ++i) {
+                int value = -1;
+                inOrder = inOrder && queue.TryPop(value) && value == expected++;
+            }
+        }
+        std::vector<int> rest;
+        queue.PopBatch(rest);
+        for (int value : rest) inOrder = inOrder && value == expected++;
+        int none = 0;
+        inOrder = inOrder && expected == next && !queue.TryPop(none) && queue.EmptyApprox();
+        Check(inOrder, std::to_string(next) + " values through " + std::to_string(QUEUE_CAPACITY) +
+                       " slots came out in order");
+    }
+
+    // --- 1b. A full queue refuses and leaves the value with the caller ---
+    {
+        BoundedMPSCQueue<std::string> queue(QUEUE_CAPACITY);
+        for (size_t i = 0; i < QUEUE_CAPACITY; ++i) {
+            queue.TryPush(std::string("queued ") + std::to_string(i));
+        }
+        std::string value = "refused";
+        bool refused = !queue.TryPush(value) && value == "refused" &&
+                       queue.SizeApprox() == QUEUE_CAPACITY;
+
+        // One pop frees one slot, and the oldest value is what comes out
+        std::string oldest;
+        bool freed = queue.TryPop(oldest) && oldest == "queued 0" &&
+                     queue.TryPush(value) && !queue.TryPush(std::string("again"));
+        std::vector<std::string> rest;
+        freed = freed && queue.PopBatch(rest) == QUEUE_CAPACITY && rest.back() == "refused";
+        Check(refused, "Full queue refused TryPush and left the value untouched");
+        Check(freed, "Popping one value let exactly one more in");
+    }
+
+    // --- 1c. Several producers, one consumer: every value exactly once ---
+    {
+        BoundedMPSCQueue<int> queue(256);
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            producers.emplace_back([&queue, p]() {
+                for (int i = 0; i < VALUES_PER_PRODUCER; ++i) {
+                    int value = p * VALUES_PER_PRODUCER + i;
+                    while (!queue.TryPush(value)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        const int total = PRODUCERS * VALUES_PER_PRODUCER;
+        std::vector<int> seen(total, 0);
+        std::vector<int> lastOfProducer(PRODUCERS, -1);
+        bool producerOrder = true;
+        int received = 0;
+        std::vector<int> batch;
+        while (received < total) {
+            batch.clear();
+            if (queue.PopBatch(batch, 64) == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (int value : batch) {
+                if (value < 0 || value >= total) {
+                    producerOrder = false;
+                    continue;
+                }
+                seen[value]++;
+                // Each producer's values keep their order
+                int producer = value / VALUES_PER_PRODUCER;
+                producerOrder = producerOrder && value > lastOfProducer[producer];
+                lastOfProducer[producer] = value;
+            }
+            received += static_cast<int>(batch.size());
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        int duplicates = 0;
+        int missing = 0;
+        for (int count : seen) {
+            duplicates += count > 1 ? 1 : 0;
+            missing += count == 0 ? 1 : 0;
+        }
+        Check(duplicates == 0 && missing == 0 && queue.EmptyApprox(),
+              std::to_string(PRODUCERS) + " producers x " + std::to_string(VALUES_PER_PRODUCER) +
+              " values: " + std::to_string(duplicates) + " duplicated, " + std::to_string(missing) + " missing");
+        Check(producerOrder, "Each producer's values arrived in the order pushed");
+    }
+}
+
+// =============================================================================
+// PHASE 2: FleetCheckpoint
+// =============================================================================
+
+bool SameTasks(const std::vector<Layer2::Task>& a, const std::vector<Layer2::Task>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].taskId != b[i].taskId || a[i].sourceNode != b[i].sourceNode ||
+            a[i].destinationNode != b[i].destinationNode || a[i].sourceId != b[i].sourceId ||
+            a[i].destId != b[i].destId) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SameCheckpoint(const FleetCheckpoint& a, const FleetCheckpoint& b) {
+    if (a.meshFingerprint != b.meshFingerprint || a.sequence != b.sequence || a.nextTaskId != b.nextTaskId ||
+        a.totalTasks != b.totalTasks || a.waypointsVisited != b.waypointsVisited ||
+        a.robots.size() != b.robots.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.robots.size(); ++i) {
+        const auto& ra = a.robots[i];
+        const auto& rb = b.robots[i];
+        if (ra.id != rb.id || ra.status != rb.status || ra.currentNodeId != rb.currentNodeId ||
+            ra.positionX != rb.positionX || ra.positionY != rb.positionY || ra.loadCount != rb.loadCount ||
+            ra.itinerary != rb.itinerary) {
+            return false;
+        }
+    }
+    return SameTasks(a.pendingTasks, b.pendingTasks) && SameTasks(a.queuedTasks, b.queuedTasks);
+}
+
+void TestCheckpoint() {
+    PrintHeader("PHASE 2: FleetCheckpoint");
+
+    const uint64_t fingerprint = 0x5eed5eed12345678ull;
+    FleetCheckpoint saved;
+    saved.meshFingerprint = fingerprint;
+    saved.sequence = 7;
+    saved.nextTaskId = 1042;
+    saved.totalTasks = 45;
+    saved.waypointsVisited = 58;
+    FleetCheckpoint::Robot busy;
+    busy.id = 0;
+    busy.status = Layer2::RobotStatus::BUSY;
+    busy.currentNodeId = 12;
+    busy.positionX = 340;
+    busy.positionY = -15;
+    busy.loadCount = 2;
+    busy.itinerary = {31, 44, 45, 12};
+    FleetCheckpoint::Robot idle;
+    idle.id = 1;
+    idle.status = Layer2::RobotStatus::CHARGING;
+    idle.currentNodeId = 3;
+    saved.robots = {busy, idle};
+    saved.pendingTasks = {Layer2::Task(1040, 31, 45, "P1", "D3")};
+    saved.queuedTasks = {Layer2::Task(1041, 44, 12), Layer2::Task(1042, 7, 9, "P2", "")};
+
+    const std::string path = (std::filesystem::temp_directory_path() / "fleet_tests_checkpoint.bin").string();
+
+    // --- 2a. Round trip ---
+    FleetCheckpoint loaded;
+    bool written = FleetCheckpoint::Save(path, saved);
+    bool roundTrip = written && FleetCheckpoint::Load(path, fingerprint, loaded) && SameCheckpoint(saved, loaded) &&
+                     !std::filesystem::exists(path + ".tmp");
+    Check(roundTrip, "Saved checkpoint loads back field for field (2 robots, 3 tasks)");
+
+    // --- 2b. A checkpoint of another mesh is refused ---
+    FleetCheckpoint other;
+    other.sequence = 99;
+    bool refused = written && !FleetCheckpoint::Load(path, fingerprint + 1, other) && other.sequence == 99;
+    Check(refused, "Fingerprint mismatch refused, output left untouched");
+
+    // --- 2c. Every truncation of the file, and trailing bytes, are refused ---
+    std::string bytes;
+    {
+        std::ifstream file(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    size_t accepted = 0;
+    for (size_t length = 0; length < bytes.size(); ++length) {
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(bytes.data(), static_cast<std::streamsize>(length));
+        }
+        FleetCheckpoint damaged;
+        accepted += FleetCheckpoint::Load(path, fingerprint, damaged) ? 1 : 0;
+    }
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        file.put('\0');
+    }
+    FleetCheckpoint padded;
+    bool trailingRefused = !FleetCheckpoint::Load(path, fingerprint, padded);
+    Check(!bytes.empty() && accepted == 0 && trailingRefused,
+          "All " + std::to_string(bytes.size()) + " truncations and a trailing byte refused (" +
+          std::to_string(accepted) + " accepted)");
+
+    FleetCheckpoint missing;
+    std::filesystem::remove(path);
+    Check(!FleetCheckpoint::Load(path, fingerprint, missing), "Missing file refused");
+}
+
+// =============================================================================
+// PHASE 3: EventLog and replay
+// =============================================================================
+
+bool SameEvents(const std::vector<LoggedEvent>& a, const std::vector<LoggedEvent>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].type != b[i].type || a[i].tick != b[i].tick || a[i].robotId != b[i].robotId ||
+            a[i].nodeId != b[i].nodeId || !SameTasks(a[i].tasks, b[i].tasks)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Run a batch shift of config until every task is done (or it is stuck)
+bool RunShift(const SystemConfig& config, ReplayStats& replay) {
+    FleetManager manager(config, ".");
+    if (!manager.Initialize()) return false;
+    if (config.replayPath.empty() && manager.LoadTasks(TASKS_PATH) == 0) return false;
+
+    manager.Start();
+    auto start = std::chrono::steady_clock::now();
+    while (!manager.IsAllTasksComplete() &&
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < SHIFT_WALL_SECONDS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    bool complete = manager.IsAllTasksComplete();
+    manager.Stop();
+    replay = manager.GetReplayStats();
+    return complete;
+}
+
+void TestEventLog() {
+    PrintHeader("PHASE 3: EventLog and replay");
+
+    EventLogHeader header;
+    header.meshFingerprint = 0x5eed5eed12345678ull;
+    header.robotCount = 3;
+    header.tickMs = 50.0f;
+
+    std::vector<LoggedEvent> written(5);
+    written[0].type = EventType::TASKS_ADDED;
+    written[0].tasks = {Layer2::Task(1, 31, 45, "P1", "D3"), Layer2::Task(2, 44, 12)};
+    written[1].type = EventType::FULL_SOLVE;
+    written[2].type = EventType::TASK_BATCH;
+    written[2].tick = 40;
+    written[2].tasks = {Layer2::Task(3, 7, 9, "P2", "")};
+    written[3].type = EventType::GOAL_REACHED;
+    written[3].tick = 95;
+    written[3].robotId = 2;
+    written[3].nodeId = 427;
+    written[4].type = EventType::REPLAN_FINISHED;
+    written[4].tick = 120;
+
+    const std::string path = (std::filesystem::temp_directory_path() / "fleet_tests_events.bin").string();
+
+    // --- 3a. Round trip ---
+    {
+        EventLog log;
+        bool opened = log.Open(path, header);
+        for (const auto& event : written) {
+            if (event.type == EventType::GOAL_REACHED) {
+                log.LogGoalReached(event.tick, event.robotId, event.nodeId);
+            } else if (event.tasks.empty()) {
+                log.LogMarker(event.type, event.tick);
+            } else {
+                log.LogTasks(event.type, event.tick, event.tasks);
+            }
+        }
+        log.Close();
+
+        EventLogHeader readHeader;
+        std::vector<LoggedEvent> read;
+        bool roundTrip = opened && EventLog::Read(path, readHeader, read) && SameEvents(written, read) &&
+                         readHeader.meshFingerprint == header.meshFingerprint &&
+                         readHeader.robotCount == header.robotCount && readHeader.tickMs == header.tickMs;
+        Check(roundTrip, "Logged header and " + std::to_string(written.size()) + " events read back field for field");
+    }
+
+    // --- 3b. A torn last record ends the log; a file that is no log is refused ---
+    {
+        auto size = std::filesystem::file_size(path);
+        std::filesystem::resize_file(path, size - 1);
+        EventLogHeader readHeader;
+        std::vector<LoggedEvent> read;
+        bool torn = EventLog::Read(path, readHeader, read) &&
+                    SameEvents(std::vector<LoggedEvent>(written.begin(), written.end() - 1), read);
+        Check(torn, "Log cut inside its last record reads the records before it");
+
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file << "not an event log";
+        }
+        bool refused = !EventLog::Read(path, readHeader, read);
+        std::filesystem::remove(path);
+        refused = refused && !EventLog::Read(path, readHeader, read);
+        Check(refused, "Other file and missing file refused");
+    }
+
+    // --- 3c. A recorded shift replays goal for goal ---
+    {
+        // Paths planned inline, as the replay plans them
+        SystemConfig config;
+        config.batchMode = true;
+        config.pathfindingThreads = 0;
+        config.robotRadiusMeters = 0.2f;
+        config.memoryReportIntervalMs = 0;
+
+        const std::string recorded = (std::filesystem::temp_directory_path() / "fleet_tests_shift.bin").string();
+        SystemConfig record = config;
+        record.eventLogPath = recorded;
+        ReplayStats none;
+        bool shiftDone = RunShift(record, none);
+
+        SystemConfig replay = config;
+        replay.replayPath = recorded;
+        ReplayStats stats;
+        bool replayDone = shiftDone && RunShift(replay, stats);
+        std::filesystem::remove(recorded);
+
+        Check(shiftDone && replayDone, "Recorded shift and its replay completed every task");
+        Check(stats.loggedGoals > 0 && stats.matched == stats.loggedGoals && stats.diverged == 0,
+              "Replay reached " + std::to_string(stats.matched) + " of " + std::to_string(stats.loggedGoals) +
+              " logged goals at their tick (" + std::to_string(stats.diverged) + " diverged)");
+    }
+}
+
+// =============================================================================
+// PHASE 4: TaskIngestServer
+// =============================================================================
+
+/// Send one length-prefixed frame and read the one that answers it ("" on failure)
+std::string ExchangeFrame(int fd, const std::string& json) {
+    uint32_t length = htonl(static_cast<uint32_t>(json.size()));
+    std::string frame(reinterpret_cast<const char*>(&length), sizeof(length));
+    frame += json;
+    if (send(fd, frame.data(), frame.size(), 0) != static_cast<ssize_t>(frame.size())) return "";
+
+    auto readAll = [fd](char* out, size_t bytes) {
+        while (bytes > 0) {
+            ssize_t got = recv(fd, out, bytes, 0);
+            if (got <= 0) return false;
+            out += got;
+            bytes -= static_cast<size_t>(got);
+        }
+        return true;
+    };
+    uint32_t replyLength = 0;
+    if (!readAll(reinterpret_cast<char*>(&replyLength), sizeof(replyLength))) return "";
+    std::string reply(ntohl(replyLength), '\0');
+    return readAll(reply.data(), reply.size()) ? reply : "";
+}
+
+bool Contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+void TestTaskIngest() {
+    PrintHeader("PHASE 4: TaskIngestServer");
+
+    // Parsed as FleetManager::ingestBatch parses; a batch's POIs resolve
+    // nowhere here, which only matters for "rejected"
+    Layer1::NavMesh mesh;
+    Layer1::POIRegistry registry;
+    TaskIngestServer server(
+        [&](std::string_view document, size_t) {
+            TaskIngestResult result;
+            Layer2::TaskLoader::ParseTasksWithPOI(document, mesh, registry, &result.rejected, &result.error);
+            return result;
+        },
+        []() { return size_t(0); }, 64);
+    if (!server.Start(0)) {
+        Check(false, "Ingestion server listens on a free port");
+        return;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(server.GetPort()));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        Check(false, "Connected to the ingestion server");
+        if (fd >= 0) close(fd);
+        server.Stop();
+        return;
+    }
+
+    std::string unknown = ExchangeFrame(fd, "{\"batch\": 1, \"tasks\": [{\"id\": 1, \"pickup\": \"X\", \"dropoff\": \"Y\"}]}");
+    Check(Contains(unknown, "\"status\":\"ok\"") && Contains(unknown, "\"rejected\":1") &&
+              !Contains(unknown, "\"error\""),
+          "Batch naming unknown POIs acked ok with the task rejected: " + unknown);
+
+    std::string empty = ExchangeFrame(fd, "{\"batch\": 2, \"tasks\": []}");
+    Check(Contains(empty, "\"status\":\"ok\"") && Contains(empty, "\"accepted\":0") &&
+              !Contains(empty, "\"error\""),
+          "Empty batch acked ok: " + empty);
+
+    std::string garbage = ExchangeFrame(fd, "this is not json");
+    Check(Contains(garbage, "\"status\":\"error\"") && Contains(garbage, "Malformed JSON at byte 0"),
+          "Garbage acked as an error: " + garbage);
+
+    std::string truncated = ExchangeFrame(fd, "{\"batch\": 4, \"tasks\": [{\"id\": 1, \"pickup\": ");
+    Check(Contains(truncated, "\"batch\":4") && Contains(truncated, "\"status\":\"error\"") &&
+              Contains(truncated, "Malformed JSON at byte"),
+          "Truncated batch acked as an error: " + truncated);
+
+    std::string noTasks = ExchangeFrame(fd, "{\"batch\": 5}");
+    Check(Contains(noTasks, "\"status\":\"error\"") && Contains(noTasks, "No 'tasks' array"),
+          "Batch without tasks acked as an error: " + noTasks);
+
+    close(fd);
+    server.Stop();
+    Check(server.GetStats().errorReplies == 3, "Server counted 3 unparsable batches");
+}
+
+// =============================================================================
+// PHASE 5: PushServer subscriptions
+// =============================================================================
+
+int ConnectLocal(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    timeval timeout{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// Handshake on path; false unless the server switched protocols
+bool OpenWebSocket(int fd, const std::string& path) {
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+                          "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                          "Sec-WebSocket-Version: 13\r\n\r\n";
+    if (send(fd, request.data(), request.size(), 0) != static_cast<ssize_t>(request.size())) return false;
+    std::string head;
+    char byte;
+    while (head.find("\r\n\r\n") == std::string::npos && recv(fd, &byte, 1, 0) == 1) head += byte;
+    return head.find(" 101 ") != std::string::npos;
+}
+
+/// One masked text message (a zero mask leaves the payload as is)
+bool SendText(int fd, const std::string& text) {
+    std::string frame(1, static_cast<char>(0x81));
+    frame += static_cast<char>(0x80 | text.size());
+    frame.append(4, '\0');
+    frame += text;
+    return send(fd, frame.data(), frame.size(), 0) == static_cast<ssize_t>(frame.size());
+}
+
+/// Next message's payload ("" after the 2 s receive timeout)
+std::string ReadMessage(int fd) {
+    auto readAll = [fd](unsigned char* out, size_t bytes) {
+        while (bytes > 0) {
+            ssize_t got = recv(fd, out, bytes, 0);
+            if (got <= 0) return false;
+            out += got;
+            bytes -= static_cast<size_t>(got);
+        }
+        return true;
+    };
+    unsigned char header[8];
+    if (!readAll(header, 2)) return "";
+    size_t length = header[1] & 0x7f;
+    if (length == 126) {
+        if (!readAll(header, 2)) return "";
+        length = (static_cast<size_t>(header[0]) << 8) | header[1];
+    } else if (length == 127) {
+        if (!readAll(header, 8)) return "";
+        length = 0;
+        for (int i = 0; i < 8; ++i) length = (length << 8) | header[i];
+    }
+    std::string payload(length, '\0');
+    return readAll(reinterpret_cast<unsigned char*>(payload.data()), length) ? payload : "";
+}
+
+void TestPushSubscriptions() {
+    PrintHeader("PHASE 5: PushServer subscriptions");
+
+    PushServer server;
+    if (!server.Start(0)) {
+        Check(false, "Push server listens on a free port");
+        return;
+    }
+    int binary = ConnectLocal(server.GetPort());
+    int json = ConnectLocal(server.GetPort());
+    if (binary < 0 || json < 0 || !OpenWebSocket(binary, "/binary") || !OpenWebSocket(json, "/")) {
+        Check(false, "Opened a binary and a JSON WebSocket");
+        if (binary >= 0) close(binary);
+        if (json >= 0) close(json);
+        server.Stop();
+        return;
+    }
+
+    const std::string ROBOT_SUBSCRIPTION = "{\"type\": \"subscribe\", \"robots\": [3]}";
+    SendText(binary, ROBOT_SUBSCRIPTION);
+    std::string refusal = ReadMessage(binary);
+    Check(Contains(refusal, "\"type\":\"error\"") && Contains(refusal, "JSON connection"),
+          "Robot subscription refused on the binary connection: " + refusal);
+
+    // The JSON client gets the filtered encoding once its subscription is
+    // in; until then (and the binary client always) the fleet-wide one
+    SendText(json, ROBOT_SUBSCRIPTION);
+    auto publish = [&server]() {
+        server.Publish(PushChannel::TELEMETRY, []() { return std::string("{\"robots\":\"all\"}"); },
+                       [](const PushInterest& interest, PushClientMemory&) {
+                           return std::string(interest.WantsRobot(3) && !interest.WantsRobot(4)
+                                                  ? "{\"robots\":\"robot 3\"}" : "");
+                       });
+    };
+    std::string filtered;
+    for (int attempt = 0; attempt < 20 && !Contains(filtered, "robot 3"); ++attempt) {
+        publish();
+        filtered = ReadMessage(json);
+    }
+    Check(Contains(filtered, "robot 3"), "JSON client gets only its robot: " + filtered);
+
+    std::string unfiltered = ReadMessage(binary);
+    Check(Contains(unfiltered, "\"all\""), "Binary client keeps getting every robot: " + unfiltered);
+
+    close(binary);
+    close(json);
+    server.Stop();
+    Check(server.GetStats().subscriptionsRejected == 1, "Server counted 1 rejected subscription");
+}
+
+// =============================================================================
+// PHASE 6: TelemetryCodec
+// =============================================================================
+
+bool SameTelemetry(const std::vector<API::QuantizedTelemetry>& decoded,
+                   const std::vector<API::TelemetryRecord>& records) {
+    if (decoded.size() != records.size()) return false;
+    for (size_t i = 0; i < records.size(); ++i) {
+        API::QuantizedTelemetry want = API::QuantizedTelemetry::From(records[i]);
+        const API::QuantizedTelemetry& got = decoded[i];
+        if (got.id != want.id || got.x != want.x || got.y != want.y || got.vx != want.vx ||
+            got.vy != want.vy || got.state != want.state || got.battery != want.battery ||
+            got.currentNodeId != want.currentNodeId || got.targetNodeId != want.targetNodeId ||
+            got.remainingWaypoints != want.remainingWaypoints) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestTelemetryCodec() {
+    PrintHeader("PHASE 6: TelemetryCodec");
+
+    // 16 ticks, a keyframe every 5: robot 3 joins at tick 7 and robot 1
+    // leaves at tick 10, each forcing a keyframe of its own. Robot 0
+    // drives east, robot 1 stands still, robot 2 drains its battery
+    // every other tick and robot 3 goes west from a node to the next.
+    const uint64_t TICKS = 16;
+    API::TelemetryDeltaEncoder encoder(5);
+    std::vector<std::vector<API::TelemetryRecord>> fleets;
+    std::vector<API::TelemetryBinaryFrame> frames;
+    for (uint64_t tick = 0; tick < TICKS; ++tick) {
+        std::vector<API::TelemetryRecord> fleet;
+        auto robot = [&fleet](int32_t id, int32_t x, int32_t y) {
+            API::TelemetryRecord r{};
+            r.id = id;
+            r.x = x;
+            r.y = y;
+            r.battery = 1.0f;
+            r.currentNodeId = id * 10;
+            r.targetNodeId = -1;
+            fleet.push_back(r);
+            return &fleet.back();
+        };
+        API::TelemetryRecord* driving = robot(0, 100 + 3 * static_cast<int32_t>(tick), 50);
+        driving->vx = 1.2345f;
+        driving->status = 1;
+        driving->targetNodeId = 7;
+        driving->remainingWaypoints = 20 - static_cast<int32_t>(tick);
+        if (tick < 10) robot(1, 40, 40);
+        robot(2, 200, 80)->battery = 1.0f - 0.01f * static_cast<float>(tick / 2);
+        if (tick >= 7) {
+            API::TelemetryRecord* joined = robot(3, 300 - static_cast<int32_t>(tick), 120);
+            joined->vx = -0.5f;
+            joined->loadCount = 2;
+            joined->currentNodeId = tick < 10 ? 30 : 31;
+        }
+        frames.push_back(encoder.Encode(tick, 1000 + static_cast<int64_t>(tick) * 50, fleet.data(), fleet.size()));
+        fleets.push_back(std::move(fleet));
+    }
+
+    auto isKeyframe = [](const API::TelemetryBinaryFrame& frame) { return frame.baseTick == frame.tick; };
+    Check(isKeyframe(frames[0]) && isKeyframe(frames[5]) && isKeyframe(frames[7]) && isKeyframe(frames[10]) &&
+              isKeyframe(frames[15]) && !isKeyframe(frames[4]) && !isKeyframe(frames[9]) && !isKeyframe(frames[11]),
+          "Keyframes on the interval and when robots join or leave");
+    bool smaller = true;
+    for (const auto& frame : frames) {
+        if (!isKeyframe(frame) && frame.delta.size() >= frame.keyframe.size()) smaller = false;
+    }
+    Check(smaller, "Every delta is smaller than its frame in full");
+
+    // From the first frame on: keyframes in full, deltas against them
+    API::TelemetryDeltaDecoder decoder;
+    bool roundTrip = true;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        uint64_t tick = 0;
+        int64_t timestampMs = 0;
+        std::vector<API::QuantizedTelemetry> robots;
+        const std::string& bytes = isKeyframe(frames[i]) ? frames[i].keyframe : frames[i].delta;
+        if (!decoder.Decode(bytes, tick, timestampMs, robots) || tick != i ||
+            timestampMs != 1000 + static_cast<int64_t>(i) * 50 || !SameTelemetry(robots, fleets[i])) {
+            std::cout << "  tick " << i << " decodes wrong\n";
+            roundTrip = false;
+        }
+    }
+    Check(roundTrip, "All 16 frames decode to the robots encoded");
+
+    // Joining at tick 2 as PushServer serves a new client: full frames
+    // until a keyframe is on the wire, deltas against it from then on
+    API::TelemetryDeltaDecoder late;
+    uint64_t lateTick = 0;
+    int64_t lateMs = 0;
+    std::vector<API::QuantizedTelemetry> lateRobots;
+    bool joinedFull = late.Decode(frames[2].keyframe, lateTick, lateMs, lateRobots) &&
+                      SameTelemetry(lateRobots, fleets[2]);
+    bool refusedDelta = !late.Decode(frames[3].delta, lateTick, lateMs, lateRobots);
+    Check(joinedFull && refusedDelta, "Late decoder reads a frame in full and refuses a delta of a keyframe it missed");
+
+    bool caughtUp = true;
+    int deltasAfterJoin = 0;
+    uint64_t heldKeyframe = UINT64_MAX;
+    for (size_t i = 3; i < frames.size(); ++i) {
+        bool useDelta = !isKeyframe(frames[i]) && frames[i].baseTick == heldKeyframe;
+        if (isKeyframe(frames[i])) heldKeyframe = frames[i].tick;
+        if (!late.Decode(useDelta ? frames[i].delta : frames[i].keyframe, lateTick, lateMs, lateRobots) ||
+            !SameTelemetry(lateRobots, fleets[i])) {
+            std::cout << "  late decoder: tick " << i << " decodes wrong\n";
+            caughtUp = false;
+        }
+        if (useDelta) deltasAfterJoin++;
+    }
+    Check(caughtUp && deltasAfterJoin > 0,
+          "Late decoder follows the stream and reads deltas after the next keyframe (" +
+              std::to_string(deltasAfterJoin) + " deltas)");
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main() {
+    std::cout << "\n";
+    std::cout << "╔═══════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║     FLEET MANAGER COMPONENT TESTS                             ║\n";
+    std::cout << "╚═══════════════════════════════════════════════════════════════╝\n";
+
+    TestInjectionQueue();
+    TestCheckpoint();
+    TestEventLog();
+    TestTaskIngest();
+    TestPushSubscriptions();
+    TestTelemetryCodec();
+
+    std::cout << "\n";
+    if (passedTests == totalTests) {
+        std::cout << COLOR_GREEN << "ALL " << passedTests << " TESTS PASSED!" << COLOR_RESET << "\n";
+    } else {
+        std::cout << COLOR_RED << passedTests << "/" << totalTests << " tests passed" << COLOR_RESET << "\n";
+    }
+    return passedTests == totalTests ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file BinaryIO.hh
+ * @brief Byte buffer encoding shared by the fleet checkpoint and event log
+ *
+ * Values are stored in host byte order, as the map cache and cost matrix
+ * snapshot are: the files are read back by the machine that wrote them.
+ * The reader never reads past its buffer; a truncated or damaged record
+ * just makes IsOk() false.
+ */
+
+#ifndef BACKEND_BINARYIO_HH
+#define BACKEND_BINARYIO_HH
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Task.hh"
+
+namespace Backend {
+
+/**
+ * @brief Appends values to a byte string.
+ */
+class BinaryWriter {
+private:
+    std::string& out_;
+
+public:
+    explicit BinaryWriter(std::string& out) : out_(out) {}
+
+    template <typename T>
+    void Put(T value) {
+        out_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void PutString(const std::string& text) {
+        Put<uint32_t>(static_cast<uint32_t>(text.size()));
+        out_.append(text);
+    }
+
+    void PutNodes(const std::vector<int>& nodes) {
+        Put<uint32_t>(static_cast<uint32_t>(nodes.size()));
+        for (int node : nodes) Put<int32_t>(node);
+    }
+
+    void PutTasks(const std::vector<Layer2::Task>& tasks) {
+        Put<uint32_t>(static_cast<uint32_t>(tasks.size()));
+        for (const auto& task : tasks) {
+            Put<int32_t>(task.taskId);
+            Put<int32_t>(task.sourceNode);
+            Put<int32_t>(task.destinationNode);
+            PutString(task.sourceId);
+            PutString(task.destId);
+        }
+    }
+};
+
+/**
+ * @brief Reads values written by BinaryWriter from a byte range.
+ */
+class BinaryReader {
+private:
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+    bool ok_ = true;
+
+public:
+    BinaryReader(const char* data, size_t size) : data_(data), size_(size) {}
+    explicit BinaryReader(const std::string& in) : BinaryReader(in.data(), in.size()) {}
+
+    bool IsOk() const { return ok_; }
+    bool AtEnd() const { return offset_ == size_; }
+    size_t GetOffset() const { return offset_; }
+
+    template <typename T>
+    T Get() {
+        T value{};
+        if (!ok_ || size_ - offset_ < sizeof(T)) {
+            ok_ = false;
+            return value;
+        }
+        std::memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return value;
+    }
+
+    /// Skip bytes (e.g. a record of a type this build does not know)
+    void Skip(size_t bytes) {
+        if (!ok_ || size_ - offset_ < bytes) {
+            ok_ = false;
+            return;
+        }
+        offset_ += bytes;
+    }
+
+    /// A count of items of at least itemSize bytes each (bounded by what is left)
+    size_t GetCount(size_t itemSize) {
+        uint32_t count = Get<uint32_t>();
+        if (ok_ && static_cast<uint64_t>(count) * itemSize > size_ - offset_) ok_ = false;
+        return ok_ ? count : 0;
+    }
+
+    std::string GetString() {
+        size_t size = GetCount(1);
+        std::string text(data_ + offset_, ok_ ? size : 0);
+        offset_ += size;
+        return text;
+    }
+
+    std::vector<int> GetNodes() {
+        std::vector<int> nodes(GetCount(sizeof(int32_t)));
+        for (int& node : nodes) node = Get<int32_t>();
+        return nodes;
+    }
+
+    std::vector<Layer2::Task> GetTasks() {
+        // Three IDs and two string lengths per task
+        std::vector<Layer2::Task> tasks(GetCount(5 * sizeof(int32_t)));
+        for (auto& task : tasks) {
+            task.taskId = Get<int32_t>();
+            task.sourceNode = Get<int32_t>();
+            task.destinationNode = Get<int32_t>();
+            task.sourceId = GetString();
+            task.destId = GetString();
+        }
+        return tasks;
+    }
+};
+
+} // namespace Backend
+
+#endif // BACKEND_BINARYIO_HH
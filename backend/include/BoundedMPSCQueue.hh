@@ -0,0 +1,157 @@
+/**
+ * @file BoundedMPSCQueue.hh
+ * @brief Fixed-capacity lock-free queue for many producers and one consumer
+ *
+ * Tasks arrive from API threads and WMS connectors while the main loop
+ * drains them once per tick. A mutex around a std::queue makes every
+ * producer wait for the others and for the drain; here a producer claims
+ * a slot with one compare-and-swap and the consumer never blocks anyone.
+ */
+
+#ifndef BACKEND_BOUNDEDMPSCQUEUE_HH
+#define BACKEND_BOUNDEDMPSCQUEUE_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Backend {
+
+/**
+ * @brief Bounded ring of slots, each with a sequence number (Vyukov).
+ *
+ * Slot i of lap k is free for the producer claiming position
+ * k * capacity + i while its sequence equals that position, and holds a
+ * value for the consumer once the producer set it to position + 1. A full
+ * queue refuses the value instead of growing or waiting (TryPush returns
+ * false), so producers can push back on their own source.
+ *
+ * TryPush may be called from any number of threads at once; TryPop and
+ * PopBatch from one thread at a time. A value whose producer has claimed
+ * its slot but not yet written it holds back the values behind it until
+ * the next pop. T must be default constructible and movable.
+ */
+template <typename T>
+class BoundedMPSCQueue {
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    // Apart from each other: producers hammer one, the consumer the other
+    alignas(CACHE_LINE) std::atomic<size_t> pushPosition_;
+    alignas(CACHE_LINE) std::atomic<size_t> popPosition_;
+
+    static size_t RoundUpToPowerOfTwo(size_t value) {
+        size_t power = 2;
+        while (power < value) power <<= 1;
+        return power;
+    }
+
+public:
+    /**
+     * @param capacity Most values queued at once (rounded up to a power of two)
+     */
+    explicit BoundedMPSCQueue(size_t capacity)
+        : capacity_(RoundUpToPowerOfTwo(capacity))
+        , mask_(capacity_ - 1)
+        , slots_(new Slot[capacity_])
+        , pushPosition_(0)
+        , popPosition_(0) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMPSCQueue(const BoundedMPSCQueue&) = delete;
+    BoundedMPSCQueue& operator=(const BoundedMPSCQueue&) = delete;
+
+    /**
+     * @brief Queue a value unless the queue is full.
+     *
+     * @return false if full (value is left untouched)
+     */
+    bool TryPush(T& value) {
+        size_t position = pushPosition_.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[position & mask_];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (lag == 0) {
+                if (pushPosition_.compare_exchange_weak(position, position + 1,
+                                                        std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                return false;   // The consumer has not freed this slot of the last lap
+            } else {
+                position = pushPosition_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPush(T&& value) { return TryPush(value); }
+
+    /**
+     * @brief Take the oldest value (consumer only).
+     *
+     * @return false if nothing is ready
+     */
+    bool TryPop(T& out) {
+        size_t position = popPosition_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[position & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+        out = std::move(slot.value);
+        slot.sequence.store(position + capacity_, std::memory_order_release);
+        popPosition_.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Append up to maxValues ready values to out (consumer only).
+     *
+     * @return Values taken
+     */
+    size_t PopBatch(std::vector<T>& out, size_t maxValues = SIZE_MAX) {
+        size_t taken = 0;
+        T value;
+        while (taken < maxValues && TryPop(value)) {
+            out.push_back(std::move(value));
+            taken++;
+        }
+        return taken;
+    }
+
+    /**
+     * @brief Values queued (exact only while no one pushes or pops).
+     */
+    size_t SizeApprox() const {
+        size_t popped = popPosition_.load(std::memory_order_relaxed);
+        size_t pushed = pushPosition_.load(std::memory_order_relaxed);
+        return pushed > popped ? std::min(pushed - popped, capacity_) : 0;
+    }
+
+    bool EmptyApprox() const { return SizeApprox() == 0; }
+
+    size_t GetCapacity() const { return capacity_; }
+};
+
+} // namespace Backend
+
+#endif // BACKEND_BOUNDEDMPSCQUEUE_HH
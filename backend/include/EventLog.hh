@@ -0,0 +1,126 @@
+/**
+ * @file EventLog.hh
+ * @brief Append-only binary log of a shift's inputs and decisions, for replay
+ *
+ * The per-tick JSON in api/ shows what the fleet looked like, not why:
+ * which tasks arrived together, when a solve ran, when its result was
+ * taken. The event log records exactly the things the main loop reacts
+ * to, stamped with the fleet tick (simulated time) they happened at, and
+ * the goals robots reached as the outcome to compare against.
+ *
+ * Replaying a log (FleetManager with SystemConfig::replayPath) feeds the
+ * inputs back at their ticks in batch mode, holding the physics loop at
+ * each one until the main loop has acted on it, so a shift runs as fast
+ * as the machine allows and the same way every time. Solver or ORCA
+ * changes can then be measured on recorded traffic.
+ */
+
+#ifndef BACKEND_EVENTLOG_HH
+#define BACKEND_EVENTLOG_HH
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Task.hh"
+
+namespace Backend {
+
+/**
+ * @brief Kinds of log records.
+ */
+enum class EventType : uint32_t {
+    TASKS_ADDED = 1,        ///< Tasks for the next full solve (LoadTasks / AddTask)
+    TASK_BATCH = 2,         ///< Injected tasks the main loop took in at once (Scenario B / C)
+    FULL_SOLVE = 3,         ///< Scenario A solve of the pending tasks (at the tick its plan was taken)
+    REPLAN_FINISHED = 4,    ///< A background solve had finished and was handled
+    GOAL_REACHED = 5        ///< Outcome: a robot reached a goal
+};
+
+/**
+ * @brief One log record.
+ */
+struct LoggedEvent {
+    EventType type = EventType::TASKS_ADDED;
+    uint64_t tick = 0;                  ///< Fleet ticks completed when it happened
+    int robotId = -1;                   ///< GOAL_REACHED
+    int nodeId = -1;                    ///< GOAL_REACHED
+    std::vector<Layer2::Task> tasks;    ///< TASKS_ADDED, TASK_BATCH
+
+    /// Whether replay acts on it (all but the outcomes)
+    bool IsInput() const { return type != EventType::GOAL_REACHED; }
+};
+
+/**
+ * @brief What a log was recorded on (written once, at the head of the file).
+ */
+struct EventLogHeader {
+    uint64_t meshFingerprint = 0;       ///< CostMatrixProvider::ComputeMeshFingerprint before any overlay
+    int robotCount = 0;
+    float tickMs = 0.0f;                ///< Simulated time per fleet tick
+};
+
+/**
+ * @brief Writes a log; any thread may append.
+ *
+ * Records go to an in-memory buffer under a mutex (the fleet thread only
+ * pays for a copy); Flush writes the buffer out and is called from the
+ * main loop, so no loop thread ever waits for the disk.
+ */
+class EventLog {
+private:
+    std::mutex mutex_;
+    std::ofstream file_;
+    std::string buffer_;                ///< Encoded records not written yet
+    uint64_t events_ = 0;
+    uint64_t bytesWritten_ = 0;
+
+    void AppendRecord(const LoggedEvent& event);
+
+public:
+    EventLog() = default;
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /**
+     * @brief Start a new log at path (replacing any previous one).
+     *
+     * @return false if the file could not be created
+     */
+    bool Open(const std::string& path, const EventLogHeader& header);
+
+    bool IsOpen() const { return file_.is_open(); }
+
+    void LogTasks(EventType type, uint64_t tick, const std::vector<Layer2::Task>& tasks);
+    void LogMarker(EventType type, uint64_t tick);
+    void LogGoalReached(uint64_t tick, int robotId, int nodeId);
+
+    /**
+     * @brief Write buffered records once at least minBytes are buffered.
+     */
+    void Flush(size_t minBytes = 0);
+
+    /**
+     * @brief Flush and close.
+     */
+    void Close();
+
+    uint64_t GetEventCount();
+    uint64_t GetBytesWritten();
+
+    /**
+     * @brief Read a whole log.
+     *
+     * Records of unknown types are skipped; a torn last record (the writer
+     * was killed mid-flush) ends the log.
+     *
+     * @return false if the file is missing or not an event log
+     */
+    static bool Read(const std::string& path, EventLogHeader& header, std::vector<LoggedEvent>& events);
+};
+
+} // namespace Backend
+
+#endif // BACKEND_EVENTLOG_HH
@@ -0,0 +1,75 @@
+/**
+ * @file FleetCheckpoint.hh
+ * @brief Binary checkpoint of the fleet's plan, robots and unassigned tasks
+ *
+ * A restart mid-shift used to lose every itinerary and pending task, and
+ * the fleet could only start over from the task file with a full solve.
+ * A checkpoint holds what is needed to carry on instead: per robot its
+ * position, packages on board, the goal its driver is on and the rest of its
+ * itinerary, plus the tasks not assigned to any robot yet. It is built
+ * from the published FleetSnapshot / PlanSnapshot (no lock on the fleet)
+ * and written off the main loop; restoring it needs no VRP solve, the
+ * drivers only plan paths to goals they already had.
+ */
+
+#ifndef BACKEND_FLEETCHECKPOINT_HH
+#define BACKEND_FLEETCHECKPOINT_HH
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "RobotAgent.hh"
+#include "Task.hh"
+
+namespace Backend {
+
+/**
+ * @brief Fleet state at one point of a shift.
+ *
+ * Node IDs are only meaningful on the NavMesh they were taken on, so a
+ * checkpoint carries the mesh fingerprint and Load rejects any other.
+ */
+struct FleetCheckpoint {
+    /**
+     * @brief One robot; its goal in progress is itinerary[0] when it had one.
+     */
+    struct Robot {
+        int id = -1;
+        Layer2::RobotStatus status = Layer2::RobotStatus::IDLE;
+        int currentNodeId = -1;
+        int positionX = 0;                  ///< Layer 3 position (pixels)
+        int positionY = 0;
+        int loadCount = 0;                  ///< Packages on board
+        std::vector<int> itinerary;         ///< Goals still to visit, in order
+    };
+
+    uint64_t meshFingerprint = 0;           ///< CostMatrixProvider::ComputeMeshFingerprint of the unblocked mesh
+    uint64_t sequence = 0;                  ///< Checkpoints taken before this one in the run
+    int nextTaskId = 0;                     ///< Next ID handed to an injected task
+    int totalTasks = 0;
+    int waypointsVisited = 0;               ///< Goals reached (2 per completed task)
+    std::vector<Robot> robots;              ///< In robot ID order
+    std::vector<Layer2::Task> pendingTasks; ///< Waiting for a full (Scenario A) solve
+    std::vector<Layer2::Task> queuedTasks;  ///< Injected, not yet in any robot's itinerary
+
+    /**
+     * @brief Write the checkpoint next to path and rename it into place.
+     *
+     * @return false if the file could not be written (the previous
+     *         checkpoint at path is then left untouched)
+     */
+    static bool Save(const std::string& path, const FleetCheckpoint& checkpoint);
+
+    /**
+     * @brief Read a checkpoint written by Save.
+     *
+     * @param meshFingerprint Fingerprint of the current NavMesh
+     * @return false if there is none, it is damaged or of another mesh
+     */
+    static bool Load(const std::string& path, uint64_t meshFingerprint, FleetCheckpoint& checkpoint);
+};
+
+} // namespace Backend
+
+#endif // BACKEND_FLEETCHECKPOINT_HH
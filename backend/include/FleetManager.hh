@@ -18,6 +18,7 @@
 #define BACKEND_FLEETMANAGER_HH
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include <mutex>
@@ -28,39 +29,88 @@
 #include <future>
 #include <queue>
 #include <optional>
+#include <limits>
+#include <cstdint>
 
 // Layer 1 includes
 #include "StaticBitMap.hh"
 #include "InflatedBitMap.hh"
+#include "InflationVariants.hh"
 #include "DynamicBitMap.hh"
 #include "NavMesh.hh"
 #include "NavMeshGenerator.hh"
+#include "HierarchicalNavMesh.hh"
+#include "CongestionMap.hh"
+#include "POISchedule.hh"
+#include "MapCache.hh"
+#include "GraphExport.hh"
 #include "POIRegistry.hh"
 #include "Resolution.hh"
 #include "Coordinates.hh"
+#include "LatencyHistogram.hh"
+#include "MemoryUsage.hh"
+#include "Trace.hh"
+#include "TaskScheduler.hh"
 
 // Layer 2 includes
 #include "RobotAgent.hh"
 #include "Task.hh"
 #include "TaskLoader.hh"
 #include "CostMatrixProvider.hh"
+#include "DemandForecast.hh"
 #include "IVRPSolver.hh"
 #include "TabuSearch.hh"
 #include "SimulatedAnnealing.hh"
 #include "HillClimbing.hh"
 #include "ALNS.hh"
+#include "PortfolioSolver.hh"
+#include "ZoneDecomposedSolver.hh"
+#include "AdaptiveSolver.hh"
 
 // Layer 3 includes
 #include "Core/RobotDriver.hh"
+#include "Core/DeadlockResolver.hh"
+#include "Core/PathIndex.hh"
 #include "Core/FastLoopManager.hh"
+#include "Core/WorkerPool.hh"
+#include "Pathfinding/MultiAgentPlanner.hh"
 #include "Pathfinding/PathfindingService.hh"
 #include "Physics/ObstacleData.hh"
+#include "Physics/KinematicsStore.hh"
+#include "Physics/SpatialHash.hh"
 
 // API includes
 #include "../api/APIService.hh"
 
+// Backend includes
+#include "BoundedMPSCQueue.hh"
+#include "EventLog.hh"
+#include "FleetCheckpoint.hh"
+#include "LoopScheduler.hh"
+#include "ThreadPlacement.hh"
+#include "PushServer.hh"
+#include "TaskIngestServer.hh"
+
 namespace Backend {
 
+/**
+ * @brief Robots of one size in a mixed fleet (SystemConfig::robotClasses).
+ */
+struct RobotClassConfig {
+    std::string name;                   ///< For logs and the API
+    float radiusMeters = 0.3f;          ///< Collision radius; the map is inflated for it
+    int count = 0;                      ///< Robots of the class
+};
+
+/**
+ * @brief How closely the fleet loop simulates robot motion
+ *        (SystemConfig::simulationFidelity).
+ */
+enum class SimulationFidelity {
+    FULL,           ///< Paths, ORCA and acceleration limits every tick
+    KINEMATIC       ///< Each leg takes its cost-matrix travel time along a straight line; batch mode steps from arrival to arrival
+};
+
 /**
  * @brief System configuration loaded from JSON.
  */
@@ -69,10 +119,21 @@ struct SystemConfig {
     float orcaTickMs = 50.0f;           ///< Physics loop tick (20 Hz)
     float warehouseTickMs = 1000.0f;    ///< Strategic loop tick (1 Hz)
     float obstacleTickMs = 1000.0f;     ///< Obstacle loop tick (1 Hz)
+    double orcaNeighborRadiusMeters = 10.0;  ///< Robots passed to ORCA per robot (>= ORCA's reach of ~7.5 m)
+    bool orcaHalfPlanes = false;        ///< True ORCA half-plane solver instead of the stop-and-wait heuristic
+    bool adaptiveTickRate = false;      ///< Step robots alone in their aisle every few ticks and sub-step robots in crowds (else every robot once per tick)
+    int adaptiveCoarseTicks = 2;        ///< Most ticks an isolated robot goes between steps
+    int adaptiveCrowdNeighbors = 3;     ///< Robots within orcaNeighborRadiusMeters per extra sub-step
+    int adaptiveMaxSubsteps = 4;        ///< Most sub-steps per tick
+    int physicsThreads = 1;             ///< Threads stepping robots zone by zone (1 = the fleet thread alone, 0 = one per hardware thread)
+    int physicsZones = 0;               ///< Map zones robots are stepped in when physicsThreads != 1 (0 = 4 per thread)
+    ThreadPlacementConfig threadPlacement;  ///< CPUs and priority per thread role (default: left to the OS)
     
     // Robot parameters
     float robotRadiusMeters = 0.3f;     ///< Robot collision radius
     float robotSpeedMps = 1.6f;         ///< Robot average speed (m/s)
+    int robotLoadCapacity = 1;          ///< Packets a robot carries at once; above 1 the solvers batch several pickups before their dropoffs
+    std::vector<RobotClassConfig> robotClasses;  ///< Robots of other sizes, taken in order from robot 0 on (the rest has robotRadiusMeters); each radius plans on its own inflation of the shared clearance field
     
     // Resolution
     Common::Resolution mapResolution = Common::Resolution::DECIMETERS;
@@ -81,17 +142,82 @@ struct SystemConfig {
     std::string mapPath = "layer1/assets/map_layout.txt";
     std::string poiConfigPath = "layer1/assets/poi_config.json";
     std::string taskPath = "../api/set_of_tasks.json";
+    std::string mapCachePath = "build/map_cache.bin";  ///< Binary Layer 1 cache ("" = disabled)
+    std::string graphExportDir = "../api/output";  ///< navmesh.navgraph / navmesh.navbits for the API and tools ("" = disabled)
+    std::string costMatrixCachePath = "build/cost_matrix.bin";  ///< POI cost matrix snapshot ("" = disabled)
+    std::string checkpointPath = "";    ///< Fleet checkpoint written while running and restored on start ("" = disabled)
+    int checkpointIntervalMs = 5000;    ///< Time between checkpoints
+    int memoryReportIntervalMs = 60000; ///< Time between per-subsystem memory reports (printed live, exported to metrics.prom; 0 = only at Stop)
+    int telemetryRingSlots = 64;        ///< Frames in the orca/telemetry.ring shared-memory ring (0 = one orca_tick_N.json per tick)
+    int pushServerPort = 0;             ///< WebSocket / HTTP push of telemetry, paths and obstacles (0 = disabled)
+    std::string pushServerAddress = "127.0.0.1";    ///< Interface the push server listens on
+    int ingestPort = 0;                 ///< Framed TCP task ingestion endpoint (0 = disabled)
+    std::string ingestAddress = "127.0.0.1";        ///< Interface the ingestion endpoint listens on
+    std::string ingestSocketPath = "";  ///< Unix socket for task ingestion, instead of / besides TCP ("" = none)
+    int ingestMaxBacklog = 4096;        ///< Injected tasks not yet planned beyond which ingested batches are refused
+    std::string eventLogPath = "";      ///< Binary log of the shift's inputs and goal completions ("" = disabled)
+    std::string replayPath = "";        ///< Event log to replay in batch mode instead of loading / injecting tasks ("" = live)
+    bool parallelStartup = true;        ///< Overlap independent startup steps (POI parsing with the map build, Layer 3 setup with the cost precompute)
+    
+    // Planning
+    int navMeshMaxRegionTiles = 0;      ///< >0 merges free tiles into rectangles of up to N x N tiles (0 = uniform tiles)
+    int hierarchyMinNodes = 0;          ///< Use a HierarchicalNavMesh at/above this many nodes (0 = never; costs can run a few % over exact)
+    int costLandmarkCount = 0;          ///< ALT landmarks for on-demand cost searches without a hierarchy (0 = Euclidean only)
+    bool bidirectionalCostSearch = false; ///< Bidirectional instead of single-direction A* for on-demand costs
+    bool quantizedCostMatrix = false;   ///< uint16 fixed-point cost matrix (half the memory, lookups within half a step of exact)
+    Layer3::Pathfinding::PathAlgorithm pathAlgorithm = Layer3::Pathfinding::PathAlgorithm::THETA_STAR;  ///< Grid search for robot paths (JPS / JPS_PLUS: grid-optimal + smoothing, faster, slightly longer)
+    bool lazyThetaStar = true;          ///< Robot paths check line of sight once per expansion (Lazy Theta*) instead of per relaxation
+    int pathfindingThreads = 2;         ///< Workers computing robot paths off the fleet loop (0 = inline on the fleet thread)
+    int backgroundThreads = 0;          ///< Task scheduler workers shared by replans, cost-matrix searches and checkpoint writes (0 = one per hardware thread)
+    int pathCacheCapacity = 4096;       ///< Robot paths reused per (start tile, goal tile) until the dynamic map changes (0 = disabled)
+    bool corridorPlanning = true;       ///< Route robot paths over the NavMesh first and run Theta* in that corridor (when tiles are coarser than the Theta* lattice)
+    int corridorMarginTiles = 1;        ///< Tiles of slack around the NavMesh route
+    int flowFieldGoals = 8;             ///< Flow fields kept for this many of the busiest DROPOFF / CHARGING POIs, whose robot paths then need no search (0 = none)
+    int itineraryPrefetchLegs = 4;      ///< Legs of a robot's itinerary after its current goal planned on the path workers while it drives (0 = none)
+    bool multiAgentPlanning = false;    ///< Plan all robots together on the NavMesh with a space-time reservation table (WHCA*) instead of one Theta* path each
+    int multiAgentWindowTicks = 32;     ///< Ticks of a cooperative planning window (replanned every half window)
+    double multiAgentTickSeconds = 0.0; ///< Duration of one planning tick (0 = one NavMesh tile at robot speed)
+    bool deadlockResolution = true;     ///< Break robots waiting on each other (head-on in an aisle, parked in the way) by rerouting, backing off or yielding (not with multiAgentPlanning)
+    double deadlockWaitSeconds = 2.0;   ///< Time a robot waits on another before that is resolved
+    bool congestionCosts = false;       ///< Learn per-node traversal delays from the fleet and add them to NavMesh edge costs (cost matrix, hierarchy, detours)
+    double congestionHalfLifeSeconds = 300.0;  ///< Fleet time after which a measured delay counts half
+    int congestionRefreshMs = 10000;    ///< Fleet time between penalty refreshes (the cost matrix then recomputes the affected rows)
+    bool poiSlotScheduling = false;     ///< Stagger robot arrivals at PICKUP / DROPOFF POIs by capacity (POI metadata "capacity"); early robots wait at a holding spot
+    double poiSlotSeconds = 6.0;        ///< Time a robot is expected to occupy a POI
+    double poiHoldingDistanceMeters = 2.5;  ///< Distance from a POI at which robots wait for their slot
+    bool demandForecast = false;        ///< Forecast task arrivals per pickup/dropoff pair from recent tasks and park idle robots near the pickups expecting work
+    double forecastHalfLifeSeconds = 900.0;  ///< Fleet time after which an observed task counts half
+    double forecastHorizonSeconds = 60.0;    ///< Arrivals ahead that idle robots are positioned for
+    int repositionIntervalMs = 5000;    ///< Fleet time between repositioning rounds
     
     // Fleet size (0 = auto from charging stations)
     int numRobots = 0;
     
     // Simulation mode
     bool batchMode = false;             ///< Batch mode: no sleep, auto-terminate
+    SimulationFidelity simulationFidelity = SimulationFidelity::FULL;  ///< KINEMATIC: no path searches, ORCA, multi-agent planning or deadlock handling (travel times only)
+    double kinematicQueueSeconds = 0.0; ///< KINEMATIC congestion: seconds added to a leg per other robot driving to the same node
     
     // Dynamic Scheduling Configuration
     int batchThreshold = 5;              ///< If > threshold tasks arrive, trigger full re-plan
-    int estimatedReplanTimeMs = 100;     ///< Estimated VRP solver time in ms
+    int estimatedReplanTimeMs = 100;     ///< Estimated VRP solver time in ms (until replans have been measured)
     int starterTasksPerRobot = 2;        ///< Tasks to assign immediately in Scenario C (keeps robots busy)
+    int insertionCandidateRobots = 8;    ///< Scenario B scores each task on the robots whose routes pass nearest its pickup (0 = all robots)
+    bool rollingHorizon = false;         ///< Batch injected tasks over an adaptive window and re-plan them with queued work (replaces batchThreshold)
+    int horizonMinWindowMs = 1000;       ///< Shortest rolling-horizon window
+    int horizonMaxWindowMs = 10000;      ///< Longest rolling-horizon window (bounds how long an injected task waits)
+    int horizonFrozenTasks = 1;          ///< Per robot, queued tasks after the one in progress kept out of horizon replans
+    int solverPortfolioSize = 0;         ///< >1 runs that many solvers concurrently per replan (0/1 = single ALNS)
+    int solverTemperingReplicas = 0;     ///< >1 replans with parallel-tempering annealing over that many replicas on the background workers (0/1 = ALNS; solverPortfolioSize wins)
+    int solverTimeBudgetMs = 0;          ///< Portfolio wall-clock budget per replan (0 = one run per solver)
+    int solverZoneRobots = 0;            ///< >0 splits replans into zones of about this many robots, solved concurrently (0 = one global solve)
+    int replanDeadlineMs = 0;            ///< Background replan returns its best so far after this long (0 = no limit)
+    bool solverBatteryAware = false;     ///< Solvers plan charging stops and count them in the makespan
+    bool chargerMatching = true;         ///< Share chargers between the planned stops by min-cost matching with queueing (solverBatteryAware)
+    double solverStopGap = 0.0;          ///< Solvers stop once within this fraction of the makespan lower bound (0 = only when proven optimal, <0 = never)
+    int solverRegretK = 2;               ///< ALNS repair inserts first the task whose k - 1 runner-up insertions cost most more than its best (2..8)
+    int injectionQueueCapacity = 16384;  ///< Injected tasks waiting for the main loop; beyond this InjectTasks refuses them
+    int replanLatencyTargetMs = 0;       ///< >0 picks the solver tier per replan from measured latency to meet this (keep below the 1 s strategic tick; 0 = fixed solver)
     
     /**
      * @brief Load configuration from JSON file.
@@ -99,6 +225,21 @@ struct SystemConfig {
     static SystemConfig LoadFromJSON(const std::string& filepath);
 };
 
+/**
+ * @brief Read-only Layer 1 / Layer 2 products of one site, shared by the
+ *        FleetManagers of a scenario sweep (FleetManager::ShareStaticLayers).
+ * 
+ * Each manager still owns everything it changes while running: dynamic
+ * map, POI registry, path services and a copy of the cost matrix.
+ */
+struct StaticLayers {
+    std::uint64_t key = 0;              ///< MapCache::ComputeKey of the map, radius, resolution and tiling
+    std::shared_ptr<const Layer1::StaticBitMap> staticMap;
+    std::shared_ptr<const Layer1::InflatedBitMap> inflatedMap;
+    std::shared_ptr<const Layer1::NavMesh> navMesh;
+    std::shared_ptr<const Layer2::CostMatrixProvider> costMatrix;  ///< POI costs on navMesh
+};
+
 /**
  * @brief Fleet statistics for monitoring.
  */
@@ -108,12 +249,70 @@ struct FleetStats {
     int pendingTasks = 0;
     double simulationTime = 0.0;
     int fleetLoopCount = 0;
+    long long driverSteps = 0;          ///< Driver updates (sub-steps count one each)
     int mainLoopCount = 0;
     int obstacleLoopCount = 0;
+    LoopTimingStats fleetLoopTiming;    ///< Deadlines of the physics loop (the 20 Hz contract)
+    LoopTimingStats mainLoopTiming;
+    LoopTimingStats obstacleLoopTiming;
     
     void Print() const;
 };
 
+/**
+ * @brief How the goals of a replay compared with the log's.
+ */
+struct ReplayStats {
+    uint64_t loggedGoals = 0;
+    uint64_t matched = 0;               ///< Reached at their logged tick
+    uint64_t diverged = 0;
+    uint64_t beyondLog = 0;             ///< After a robot's last logged goal (shift ran on)
+    uint64_t missedReplans = 0;         ///< Logged replan results with no solve running here
+};
+
+/**
+ * @brief Immutable view of the plan Layer 2 hands to Layer 3.
+ * 
+ * Each change of any robot's itinerary publishes a new snapshot with the
+ * next version; a published snapshot is never modified, so readers may
+ * keep one for as long as they like without locking.
+ */
+struct PlanSnapshot {
+    uint64_t version = 0;
+    std::map<int, std::vector<int>> itineraries;    ///< Robot ID -> goals not yet handed to its driver
+    std::map<int, size_t> dispatched;               ///< Robot ID -> goals handed to its driver so far
+};
+
+/**
+ * @brief One robot as the fleet last published it.
+ */
+struct RobotSnapshot {
+    int id = -1;
+    Layer2::RobotStatus status = Layer2::RobotStatus::IDLE;
+    int currentNodeId = -1;                 ///< Layer 2 node
+    int targetNodeId = -1;                  ///< Goal node of the driver
+    Common::Coordinates position{0, 0};     ///< Layer 3 position (pixels)
+    Layer3::Vector2 velocity;
+    Layer3::Core::DriverState driverState = Layer3::Core::DriverState::IDLE;
+    int remainingWaypoints = 0;             ///< Goals not yet handed to the driver
+    int loadCount = 0;                      ///< Packages on board
+};
+
+/**
+ * @brief Immutable state of every robot, taken under fleetMutex_.
+ * 
+ * The fleet loop publishes one at the end of each tick and the main loop
+ * whenever it changes a plan. A published snapshot is never modified, so
+ * the main loop, CLI and API read robots from it without taking
+ * fleetMutex_ and never hold up the physics tick.
+ */
+struct FleetSnapshot {
+    uint64_t version = 0;                   ///< Snapshots published before this one
+    int fleetLoopCount = 0;                 ///< Fleet ticks done when it was taken
+    uint64_t planVersion = 0;               ///< PlanSnapshot the itineraries were published with (0 = none yet)
+    std::vector<RobotSnapshot> robots;      ///< In robot ID order
+};
+
 /**
  * @brief Central orchestrator for the AMR system.
  * 
@@ -140,10 +339,16 @@ private:
     // LAYER 1: Infrastructure
     // =========================================================================
     
-    std::unique_ptr<Layer1::StaticBitMap> staticMap_;
-    std::unique_ptr<Layer1::InflatedBitMap> inflatedMap_;
+    std::shared_ptr<const Layer1::StaticBitMap> staticMap_;
+    std::shared_ptr<const Layer1::InflatedBitMap> inflatedMap_;
     std::unique_ptr<Layer1::DynamicBitMap> dynamicMap_;
-    std::unique_ptr<Layer1::NavMesh> navMesh_;
+    std::shared_ptr<const Layer1::NavMesh> navMesh_;
+    /// navMesh_ when its overlay is this manager's to change (congestion
+    /// penalties); nullptr while it is shared read-only
+    std::shared_ptr<Layer1::NavMesh> ownMesh_;
+    /// Site products handed in by UseStaticLayers (nullptr = built here)
+    std::shared_ptr<const StaticLayers> sharedLayers_;
+    std::unique_ptr<Layer1::HierarchicalNavMesh> navHierarchy_;  ///< Optional, large maps only
     std::unique_ptr<Layer1::POIRegistry> poiRegistry_;
     
     // =========================================================================
@@ -156,23 +361,112 @@ private:
     /// VRP Solver (Strategy Pattern)
     std::unique_ptr<Layer2::IVRPSolver> vrpSolver_;
     
+    /// vrpSolver_ when replans are latency-targeted (nullptr = fixed solver)
+    Layer2::AdaptiveSolver* adaptiveSolver_ = nullptr;
+    
     /// Cost matrix for path planning
     std::unique_ptr<Layer2::CostMatrixProvider> costMatrix_;
     
+    /// Latest published plan (read and replaced with std::atomic_load / atomic_store)
+    std::shared_ptr<const PlanSnapshot> planSnapshot_;
+    
+    /// Latest published robots (read and replaced with std::atomic_load / atomic_store)
+    std::shared_ptr<const FleetSnapshot> fleetSnapshot_;
+    
+    /// Snapshots published before, reused by publishFleetSnapshot once no
+    /// reader holds them (guarded by fleetMutex_)
+    static constexpr size_t FLEET_SNAPSHOT_POOL = 4;
+    std::vector<std::shared_ptr<FleetSnapshot>> snapshotPool_;
+    
+    /// Per robot, goals handed to its driver (guarded by fleetMutex_)
+    std::map<int, size_t> goalsDispatched_;
+    
     /// Pending tasks (from JSON or dynamically added)
     std::vector<Layer2::Task> pendingTasks_;
     
-    /// Injection queue for new tasks arriving dynamically
-    std::queue<Layer2::Task> injectionQueue_;
-    std::mutex injectionMutex_;          ///< Protects injectionQueue_
+    /// Injection queue for new tasks arriving dynamically (any thread
+    /// pushes, the main loop drains)
+    BoundedMPSCQueue<Layer2::Task> injectionQueue_;
+    std::atomic<uint64_t> injectionsRefused_;   ///< Tasks refused because the queue was full
     
     // =========================================================================
     // LAYER 3: Physics
     // =========================================================================
     
+    /// Path requests of this fleet's drivers (declared first: outlives them)
+    std::unique_ptr<Layer3::Pathfinding::PathfindingService> pathService_;
+    
+    /// Inflated maps and NavMeshes of the robot classes' radii (nullptr = one robot size)
+    std::unique_ptr<Layer1::InflationVariants> inflationVariants_;
+    /// Path services of the radii other than robotRadiusMeters, by radius in pixels
+    std::map<int, std::unique_ptr<Layer3::Pathfinding::PathfindingService>> classPathServices_;
+    
+    /// Overlay change version the path caches and flow fields are keyed on
+    /// (published by notifyMapChanges as the drivers are told)
+    std::atomic<uint64_t> pathMapVersion_{0};
+    
+    /// Robot goals per DROPOFF / CHARGING node: tasks delivered there and
+    /// robots homed there. The busiest get flow fields (main thread).
+    std::unordered_map<int, uint64_t> goalTraffic_;
+    std::vector<int> flowFieldNodes_;   ///< Nodes the path services keep flow fields for (sorted)
+    std::vector<float> robotRadii_;     ///< Per robot, collision radius (meters)
+    
     /// The Physical Drivers (Physics view)
     std::vector<std::unique_ptr<Layer3::Core::RobotDriver>> drivers_;
     
+    /// Cooperative planner of the drivers' moves (nullptr = independent paths; fleet thread only)
+    std::unique_ptr<Layer3::Pathfinding::MultiAgentPlanner> multiAgentPlanner_;
+    int multiAgentTicksLeft_ = 0;       ///< Fleet ticks until the next planning window
+    bool multiAgentGoalsChanged_ = false;  ///< A driver got a goal since the last window
+    size_t multiAgentRound_ = 0;        ///< Windows planned (rotates the priority order)
+    /// Per driver index, overlay version its goal was found unreachable at:
+    /// a STUCK robot is planned again once the overlay moved on (fleet thread)
+    std::vector<uint64_t> multiAgentStuckAt_;
+    uint64_t meshVersionSeen_ = 0;      ///< Overlay change version the drivers were told about
+    /// NavMesh nodes each driver's path crosses, by driver index (fleet thread only)
+    std::unique_ptr<Layer3::Core::PathIndex> pathIndex_;
+    std::vector<size_t> affectedDrivers_;   ///< notifyMapChanges scratch (reused)
+    
+    /// Measured delays per NavMesh node (nullptr = congestionCosts off; fleet thread only)
+    std::unique_ptr<Layer1::CongestionMap> congestionMap_;
+    static constexpr double CONGESTION_SAMPLE_SECONDS = 0.25;  ///< Fleet time between position samples
+    struct CongestionTrack {
+        int node = -1;                  ///< NavMesh node the robot was last sampled in
+        double enteredAt = 0.0;         ///< Fleet time it was first sampled there
+        Common::Coordinates enteredFrom{0, 0};
+        bool enRoute = false;           ///< Driving (or waiting to) at every sample since
+    };
+    std::vector<CongestionTrack> congestionTracks_;     ///< Per driver
+    std::vector<float> congestionPenalties_;           ///< Refresh scratch (reused)
+    double congestionSampledAt_ = 0.0;
+    double congestionRefreshedAt_ = 0.0;
+    
+    /// Arrival slots at the packet POIs (nullptr = poiSlotScheduling off; fleet thread only)
+    std::unique_ptr<Layer1::POISchedule> poiSchedule_;
+    static constexpr double POI_SLOT_SLACK_SECONDS = 1.0;  ///< Lateness of a slot a robot still sets off for
+    
+    /// Per driver, a goal that is no task stop (a holding spot) and is not
+    /// counted as a waypoint when reached (-1 = none; fleet thread only)
+    std::vector<int> positioningGoals_;
+    
+    /// Task arrivals per POI pair (nullptr = demandForecast off; main thread only)
+    std::unique_ptr<Layer2::DemandForecast> demandForecast_;
+    /// Pickups expected within forecastHorizonSeconds, most first (atomic_load / atomic_store)
+    std::shared_ptr<const std::vector<Layer2::DemandForecast::Demand>> expectedPickups_;
+    static constexpr double REPOSITION_MIN_DEFICIT = 0.5;  ///< Expected pickups not yet covered that draw an idle robot
+    std::vector<int> repositionTargets_;    ///< Per driver, pickup it is parked for (-1 = none; fleet thread only)
+    std::unordered_map<int, int> parkingSpots_;  ///< Pickup node -> free node robots park at (cache)
+    double repositionedAt_ = 0.0;
+    
+    /// Wait-for graph of the drivers (nullptr = disabled; fleet thread only)
+    std::unique_ptr<Layer3::Core::DeadlockResolver> deadlockResolver_;
+    std::vector<Layer3::Core::RobotDriver*> deadlockRobots_;   ///< Drivers handed to it (reused every tick)
+    
+    // Path publishing (fleet thread only): a path goes out when its version changes
+    std::vector<uint64_t> publishedPathVersions_;   ///< Indexed by robot id
+    std::vector<API::RobotTelemetry> telemetry_;    ///< Fleet thread only, refilled in place every tick
+    std::vector<API::PathSegment> changedPaths_;    ///< Collected under the fleet lock, broadcast after it
+    
     // =========================================================================
     // THREADING
     // =========================================================================
@@ -183,7 +477,41 @@ private:
     
     std::atomic<bool> running_;     ///< Control flag for threads
     
-    std::mutex fleetMutex_;         ///< Protects fleetRegistry_ and drivers_
+    ThreadPlacement threadPlacement_;   ///< Resolved from config_.threadPlacement; each thread applies its role
+    
+    // Deadlines of the three loops (each used by its own thread)
+    LoopScheduler mainLoopScheduler_;       ///< Skips ticks it is a period behind on
+    LoopScheduler fleetLoopScheduler_;      ///< Catches up on missed physics ticks (fixed dt)
+    LoopScheduler obstacleLoopScheduler_;   ///< Skips ticks it is a period behind on
+    
+    std::mutex fleetMutex_;         ///< Protects fleetRegistry_ and drivers_ (readers of robot state use fleetSnapshot_)
+    
+    // Fleet loop neighbor gathering (fleet thread only, reused every tick)
+    Layer3::Physics::SpatialHash neighborGrid_;       ///< tickObstacles_ positions (moved on for the deadlock resolver)
+    Layer3::Physics::KinematicsStore tickObstacles_;  ///< Per non-null driver, tick start
+    std::vector<size_t> tickObstacleOf_;              ///< Per driver: index in tickObstacles_
+    std::vector<size_t> neighborIndices_;
+    Layer3::Physics::KinematicsStore neighbors_;
+    std::vector<float> driverTickDebt_;     ///< Per driver (adaptiveTickRate): seconds skipped, integrated by its next step
+    std::vector<int> driverTicksToSkip_;    ///< Per driver (adaptiveTickRate): ticks before its next step
+    std::vector<float> driverStepDt_;       ///< Per driver: seconds its current step covers
+    
+    // Zone-sharded physics (physicsThreads != 1; fleet thread only)
+    struct PhysicsZone {
+        std::vector<size_t> drivers;                ///< Drivers in the zone at tick start
+        std::vector<size_t> indices;                ///< Neighbor query scratch
+        Layer3::Physics::KinematicsStore neighbors;
+        long long steps = 0;                        ///< Driver steps this tick
+    };
+    std::unique_ptr<Layer3::Core::WorkerPool> physicsWorkers_;  ///< Started on the first sharded tick
+    std::vector<PhysicsZone> physicsZones_;
+    std::vector<size_t> busyZones_;         ///< Zones with drivers this tick
+    int zoneColumns_ = 1;
+    double zoneWidth_ = 1.0;                ///< Pixels
+    double zoneHeight_ = 1.0;
+    std::vector<int> driverZone_;           ///< Per driver: zone at the last tick (-1 = none yet)
+    std::vector<int> driverSubsteps_;       ///< Per driver: sub-steps this tick (0 = not stepped)
+    uint64_t zoneHandoffs_ = 0;             ///< Drivers that crossed into another zone
     std::mutex mapMutex_;           ///< Protects dynamicMap_
     std::mutex taskMutex_;          ///< Protects pendingTasks_
     
@@ -192,6 +520,8 @@ private:
     // =========================================================================
     
     API::APIService apiService_;    ///< File-based API for visualization
+    std::unique_ptr<PushServer> pushServer_;    ///< Attached to apiService_ (nullptr = pushServerPort unset)
+    std::vector<std::unique_ptr<TaskIngestServer>> ingestServers_;     ///< TCP and / or Unix endpoint feeding InjectTasks
     
     // =========================================================================
     // STATISTICS
@@ -200,6 +530,12 @@ private:
     FleetStats stats_;
     std::chrono::steady_clock::time_point startTime_;
     
+    // Latency distributions for the metrics export (recorded lock-free)
+    Common::LatencyHistogram physicsTickLatency_;   ///< Fleet loop work per tick
+    Common::LatencyHistogram mainTickLatency_;      ///< Main loop work per tick
+    Common::LatencyHistogram replanSolveLatency_;   ///< Background VRP solves
+    Common::LatencyHistogram apiWriteLatency_;      ///< Telemetry and robots.json writes
+    
     /// Track total waypoints visited (every 2 = 1 task completed)
     std::atomic<int> totalWaypointsVisited_{0};
     
@@ -209,6 +545,7 @@ private:
     
     static constexpr int HISTORY_LIMIT = 20;     ///< Sliding window size (20 minutes)
     std::vector<API::HistoryPoint> history_;     ///< Sliding window buffer
+    std::atomic<size_t> historyBytes_{0};        ///< Bytes of history_ as the fleet thread last left it (read by memory reports)
     int lastCompletedTotal_ = 0;                 ///< For delta calculation
     long long lastHistoryUpdate_ = 0;            ///< Last history update timestamp (ms)
     
@@ -216,13 +553,126 @@ private:
     // DYNAMIC SCHEDULING STATE (Scenarios A, B, C)
     // =========================================================================
     
+    /// Asks the background solver to return its best solution so far
+    std::atomic<bool> replanCancel_{false};
+    
+    /// Best makespan the background solver has reported so far (guarded by replanProgressMutex_)
+    std::mutex replanProgressMutex_;
+    double replanBestMakespan_ = 0.0;
+    int replanImprovements_ = 0;
+    int replanImprovementsLogged_ = 0;
+    
     /// Background re-planning future (Scenario C)
     std::future<Layer2::VRPResult> replanFuture_;
     std::atomic<bool> replanInProgress_{false};
     
+    /// Tasks of the running Scenario C solve, and tasks injected since, to merge into its re-solve
+    std::vector<Layer2::Task> replanTasks_;
+    std::vector<Layer2::Task> replanMergeTasks_;
+    bool replanPreempted_ = false;      ///< Running solve was cancelled in favour of a merged re-solve
+    int replanMerges_ = 0;              ///< Merged re-solves since a replan result was last applied
+    
+    /// Preemptions in a row before a result is applied anyway (a surge cannot hold off every plan)
+    static constexpr int MAX_REPLAN_MERGES = 3;
+    /// How long the main loop waits for a cancelled solve before leaving it to the next tick
+    static constexpr int PREEMPT_WAIT_MS = 50;
+    
     /// Robots waiting for re-plan to complete (Scenario C)
     std::vector<int> robotsWaitingForReplan_;
     
+    /// Checkpoints (checkpointPath set; main thread only)
+    uint64_t meshFingerprint_ = 0;      ///< Of the NavMesh before any overlay, the key of a checkpoint
+    std::future<bool> checkpointFuture_;
+    std::chrono::steady_clock::time_point lastMemoryReportAt_;
+    std::shared_ptr<const Common::MemoryReport> memoryReport_;  ///< Latest report (atomic_load / atomic_store)
+    std::chrono::steady_clock::time_point lastCheckpointAt_;
+    uint64_t checkpointSequence_ = 0;   ///< Checkpoints taken (continued from a restored one)
+    uint64_t checkpointsWritten_ = 0;
+    uint64_t checkpointFailures_ = 0;
+    
+    /// Event log being recorded (nullptr = eventLogPath unset)
+    std::unique_ptr<EventLog> eventLog_;
+    
+    /// Replay of replayPath: the main loop acts on the logged inputs at
+    /// their ticks and the fleet loop does not start a tick with inputs
+    /// before it has
+    bool replaying_ = false;
+    std::vector<LoggedEvent> replayEvents_;     ///< Main thread only
+    size_t replayCursor_ = 0;                   ///< First event not acted on yet
+    std::atomic<size_t> replayInputsLeft_{0};
+    std::atomic<uint64_t> replayHoldTick_{UINT64_MAX};     ///< Fleet loop waits before starting this tick
+    std::vector<std::vector<std::pair<uint64_t, int>>> replayGoals_;  ///< Per robot, logged (tick, node) goals
+    std::vector<size_t> replayGoalCursor_;      ///< Per robot, next logged goal (fleet thread)
+    uint64_t replayGoalsMatched_ = 0;           ///< Goals reached at their logged tick (fleet thread)
+    uint64_t replayGoalsDiverged_ = 0;
+    uint64_t replayGoalsBeyondLog_ = 0;         ///< Goals after a robot's last logged one (shift ran on)
+    uint64_t replayFirstDivergence_ = UINT64_MAX;
+    uint64_t replayMissedReplans_ = 0;          ///< Logged replan results with no solve running here
+    
+    /// Fleet-thread work that reads the overlay is put off a tick while
+    /// someone else holds it, except in recorded and replayed runs: they
+    /// wait for it, so the replay sees the ticks the recording did
+    bool waitsForOverlay() const { return replaying_ || eventLog_ != nullptr; }
+    
+    /// Buffered event log bytes written at once in batch mode (live: every main tick)
+    static constexpr size_t EVENT_LOG_FLUSH_BYTES = 64 * 1024;
+    
+    /// Cost-matrix rows being recomputed after overlay changes
+    std::future<Layer2::CostMatrixProvider::RowRefresh> costRefreshFuture_;
+    bool costRefreshInProgress_ = false;
+    
+    /**
+     * @brief A robot's remaining route as planned on by cheap insertion.
+     *
+     * nodes[0] is where the robot is next free to change course (the goal
+     * it is driving to, or where it stands); nodes[k + 1] is itinerary goal k.
+     */
+    struct InsertionRoute {
+        int robotId = -1;
+        std::vector<int> nodes;
+        std::vector<signed char> kinds;     ///< Per node: +1 pickup, -1 dropoff, 0 other (charger, waypoint)
+        std::vector<float> legCosts;        ///< legCosts[k]: nodes[k] -> nodes[k + 1]
+        float totalCost = 0.0f;             ///< Sum of legCosts
+        std::vector<char> freeAfter;        ///< freeAfter[k]: no package carried on leaving nodes[k]
+        int loadAtStart = 0;                ///< Packages on board on leaving nodes[0]
+        int capacity = 1;                   ///< Packets the robot carries at once
+        std::vector<int> original;          ///< Itinerary when the snapshot was taken
+        size_t firstChange = SIZE_MAX;      ///< Lowest itinerary index changed by insertions
+        std::vector<Layer2::Task> inserted;
+    };
+    
+    /// Cheapest place to insert a task into one route
+    struct InsertionSlot {
+        int slot = -1;                      ///< Insert after nodes[slot] (-1 = none)
+        float cost = std::numeric_limits<float>::max();
+    };
+    
+    /**
+     * @brief Rolling horizon: the part of a robot's itinerary a horizon
+     *        replan keeps (its leading goals), as captured at launch.
+     */
+    struct HorizonPrefix {
+        std::vector<int> original;          ///< Itinerary when the replan was launched
+        size_t kept = 0;                    ///< Leading goals of original not re-planned
+    };
+    
+    /// Window >= this many solver latencies, so the solver is busy at most 1/4 of the time
+    static constexpr double HORIZON_LATENCY_FACTOR = 4.0;
+    /// Weight of the newest sample in the arrival rate and latency averages
+    static constexpr double HORIZON_SMOOTHING = 0.2;
+    
+    std::vector<Layer2::Task> horizonTasks_;            ///< Injected, waiting for the window to close
+    std::vector<Layer2::Task> horizonBatch_;            ///< Injected tasks in the running horizon replan
+    std::map<int, HorizonPrefix> horizonPrefixes_;      ///< Per robot, for the running horizon replan
+    std::vector<Layer2::Task> horizonSolveTasks_;       ///< Batch + queued tasks the running horizon replan solves
+    std::map<int, std::vector<Layer2::Task>> plannedTasks_;  ///< Per robot: tasks its itinerary was last solved with (ids kept across horizon replans)
+    bool replanIsHorizon_ = false;                      ///< Running replan re-plans queued work too
+    std::chrono::steady_clock::time_point horizonOpenedAt_;
+    std::chrono::steady_clock::time_point arrivalSampledAt_;
+    std::chrono::steady_clock::time_point replanLaunchedAt_;
+    double arrivalRatePerSec_ = 0.0;                    ///< Smoothed injection rate
+    double replanLatencyMs_ = 0.0;                      ///< Smoothed background solve time (0 = none measured yet)
+    
     /// Task counter for unique IDs
     std::atomic<int> nextTaskId_{1000};
     
@@ -238,6 +688,15 @@ private:
     
     TaskCompletedCallback onTaskCompleted_;
     RobotArrivedCallback onRobotArrived_;
+    
+    // =========================================================================
+    // BACKGROUND WORK
+    // =========================================================================
+    
+    /// Workers for replans, cost-matrix searches and checkpoint writes
+    /// (config_.backgroundThreads). Declared last: destroyed first, it runs
+    /// the tasks still queued while every member they use is alive.
+    std::unique_ptr<Common::TaskScheduler> taskScheduler_;
 
 public:
     // =========================================================================
@@ -269,6 +728,37 @@ public:
      */
     bool Initialize();
     
+    /**
+     * @brief Resume from the checkpoint at config.checkpointPath.
+     * 
+     * Call after Initialize and before Start, instead of LoadTasks. Robots
+     * get back their position, package and itinerary (the goal they were
+     * driving to first), unassigned tasks are queued again; no VRP solve
+     * is run for work that was already planned.
+     * 
+     * @return false if checkpoints are disabled or none matches this map
+     */
+    bool RestoreCheckpoint();
+    
+    /**
+     * @brief Plan on another manager's maps, NavMesh and POI costs instead
+     *        of loading and computing them.
+     * 
+     * Call before Initialize. The layers must have been built for the same
+     * map, robot radius, resolution and NavMesh tiling (Initialize fails
+     * otherwise); POIs are loaded and mapped by every manager.
+     */
+    void UseStaticLayers(std::shared_ptr<const StaticLayers> layers) { sharedLayers_ = std::move(layers); }
+    
+    /**
+     * @brief This manager's maps, NavMesh and POI costs for others to use.
+     * 
+     * Call after Initialize and before Start. The cost matrix is copied
+     * (this manager keeps extending its own), and so is the NavMesh when
+     * congestion penalties may change it here.
+     */
+    std::shared_ptr<const StaticLayers> ShareStaticLayers() const;
+    
     /**
      * @brief Start all worker threads.
      */
@@ -319,28 +809,45 @@ public:
     int GetPendingTaskCount() const;
     
     /**
-     * @brief Inject new tasks dynamically (thread-safe).
+     * @brief Inject new tasks dynamically (thread-safe, lock-free).
      * 
      * This is the main entry point for Scenarios B and C.
-     * Tasks are queued and processed on the next MainLoop tick.
+     * Tasks are queued and processed on the next MainLoop tick. Once
+     * config.injectionQueueCapacity tasks wait, the rest are refused:
+     * the caller should hold them back and retry.
      * 
      * @param tasks Vector of tasks to inject
+     * @return Tasks queued (a prefix of tasks)
      */
-    void InjectTasks(const std::vector<Layer2::Task>& tasks);
+    size_t InjectTasks(const std::vector<Layer2::Task>& tasks);
     
     /**
-     * @brief Inject a single task dynamically (thread-safe).
+     * @brief Inject a single task dynamically (thread-safe, lock-free).
      * 
      * @param sourceNodeId Pickup node ID
      * @param destNodeId Dropoff node ID
+     * @return false if the queue is full (the task was refused)
      */
-    void InjectTask(int sourceNodeId, int destNodeId);
+    bool InjectTask(int sourceNodeId, int destNodeId);
     
     /**
-     * @brief Get number of tasks in injection queue.
+     * @brief Get number of tasks in injection queue (approximate while
+     *        tasks are injected).
      */
     int GetInjectionQueueSize() const;
     
+    /**
+     * @brief Tasks refused because the injection queue was full.
+     */
+    uint64_t GetInjectionsRefused() const { return injectionsRefused_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Goals of a replay (replayPath set) against the log.
+     *
+     * Counted on the fleet thread: read after Stop.
+     */
+    ReplayStats GetReplayStats() const;
+    
     /**
      * @brief Check if a background re-plan is in progress.
      */
@@ -355,6 +862,28 @@ public:
      */
     FleetStats GetStats() const;
     
+    /**
+     * @brief Latency percentiles of the loops, solves, path queries,
+     *        cost-matrix misses and API writes (also in output/metrics.prom).
+     */
+    std::vector<API::LatencyMetric> GetLatencyMetrics() const;
+    
+    /**
+     * @brief Bytes held per subsystem, with the robot, POI and map pixel
+     *        counts they scale with.
+     * 
+     * Walks every large structure, so it costs about a millisecond per
+     * thousand cached paths; MainLoop takes one every memoryReportIntervalMs.
+     * Call from the main loop's thread or after Stop (the cost matrix is
+     * only resized there).
+     */
+    Common::MemoryReport GetMemoryReport();
+    
+    /**
+     * @brief Print a memory report, largest subsystem first.
+     */
+    static void PrintMemoryReport(const Common::MemoryReport& report);
+    
     /**
      * @brief Print current robot states.
      */
@@ -365,6 +894,16 @@ public:
      */
     const Layer2::RobotAgent* GetRobotAgent(int robotId) const;
     
+    /**
+     * @brief Latest published plan (nullptr before the first assignment).
+     */
+    std::shared_ptr<const PlanSnapshot> GetPlanSnapshot() const { return std::atomic_load(&planSnapshot_); }
+    
+    /**
+     * @brief Latest published state of the robots (nullptr before they are created).
+     */
+    std::shared_ptr<const FleetSnapshot> GetFleetSnapshot() const { return std::atomic_load(&fleetSnapshot_); }
+    
     /**
      * @brief Get robot driver by ID.
      */
@@ -444,19 +983,196 @@ private:
      * Called from fleetLoop to update RobotAgent::currentNodeId
      * based on the driver's current position.
      * 
-     * @param robotId Robot to sync
+     * @param driver Driver of the robot to sync
      */
-    void syncL3toL2(int robotId);
+    void syncL3toL2(const Layer3::Core::RobotDriver& driver);
     
     /**
      * @brief Feed next goal from Layer 2 itinerary to Layer 3 driver.
      * 
      * If L2 agent has an itinerary but L3 driver is idle,
      * pop the next node from the itinerary and call driver->SetGoal().
+     * A driver is only ever handed its next goal once it has reached the
+     * last one, so replans never re-path a robot on its way to a goal.
+     * 
+     * @param driver Driver of the robot to update
+     */
+    void feedL2toL3(Layer3::Core::RobotDriver& driver);
+    
+    /**
+     * @brief Whether a robot may set off for goalNode now (poiSchedule_).
+     * 
+     * Books the robot's slot at a scheduled POI from its straight-line
+     * arrival time. A slot more than POI_SLOT_SLACK_SECONDS later holds it
+     * back: the driver is sent to the POI's holding spot (or stays where it
+     * is) and asked again on every tick until the slot is near.
+     * 
+     * @return true to hand the driver goalNode
+     */
+    bool admitToPOI(Layer3::Core::RobotDriver& driver, int goalNode, double now);
+    
+    /**
+     * @brief Kinematic fidelity: send a driver to goalNode on a timed leg.
+     * 
+     * The leg lasts the cost-matrix cost from the driver's node at its
+     * speed, plus kinematicQueueSeconds per other robot driving to the
+     * same node. Called from fleetLoop with fleetMutex_ held; takes
+     * mapMutex_, under which the matrix is written.
+     * 
+     * @return false at full fidelity or with no known cost (set the goal as usual)
+     */
+    bool startTimedLeg(Layer3::Core::RobotDriver& driver, int goalNode);
+    
+    /**
+     * @brief Kinematic batch runs: fleet ticks the next step may cover.
+     * 
+     * Up to the next timed-leg arrival, at most KINEMATIC_MAX_STEP_SECONDS
+     * (task arrivals and charging are not events the loop knows of); a
+     * single tick while a driver waits for a path or drives one.
+     */
+    int kinematicStepTicks(float dt) const;
+    static constexpr double KINEMATIC_MAX_STEP_SECONDS = 1.0;
+    
+    /// Kinematic batch runs: the fleet loop waits before starting this tick.
+    /// The main loop moves it a strategic tick past the fleet after every
+    /// iteration, so event jumps never run ahead of task assignment.
+    std::atomic<uint64_t> kinematicHoldTick_{0};
+    
+    /**
+     * @brief Every repositionIntervalMs, send idle robots to park near the
+     *        pickups expectedPickups_ lists.
+     * 
+     * Called from fleetLoop with fleetMutex_ held, after the drivers were
+     * fed. A pickup draws robots while its expected arrivals exceed the
+     * robots already at or parked for it by REPOSITION_MIN_DEFICIT; each
+     * gets the nearest idle robot. Parking is a positioning goal, so it
+     * counts no waypoint, and a real task replaces it as usual.
+     */
+    void repositionIdleRobots(double now);
+    
+    /**
+     * @brief Advance one driver by a fleet tick.
+     * 
+     * Called from fleetLoop with fleetMutex_ held, after the tick's
+     * obstacle snapshot. Parked drivers are skipped. With adaptiveTickRate
+     * a moving driver with nobody in reach for the next few ticks (the
+     * query radius grows by what both could close in that time) is only
+     * stepped every adaptiveCoarseTicks ticks, with the skipped time, and
+     * one with a crowd around it is stepped in sub-steps.
+     */
+    void stepDriver(size_t index, float dt);
+    
+    /**
+     * @brief Bookkeeping and neighbors for one driver's step (see stepDriver).
+     * 
+     * Safe to call for different drivers at once, each with its own
+     * scratch: reads only the tick's obstacle snapshot and the driver.
+     * 
+     * @return Sub-steps to take (0 = not stepped this tick); the step
+     *         covers driverStepDt_[index] seconds
+     */
+    int planDriverStep(size_t index, float dt, std::vector<size_t>& indices,
+                       Layer3::Physics::KinematicsStore& neighbors);
+    
+    /**
+     * @brief Robots within ORCA's reach of a driver in the tick's snapshot.
      * 
-     * @param robotId Robot to update
+     * @return true if nobody was within the (adaptive) query radius
      */
-    void feedL2toL3(int robotId);
+    bool gatherDriverNeighbors(size_t index, float dt, std::vector<size_t>& indices,
+                               Layer3::Physics::KinematicsStore& neighbors) const;
+    
+    /**
+     * @brief Advance every driver by a fleet tick, zone by zone on physicsWorkers_.
+     * 
+     * Drivers are assigned to the zone under their tick-start position, so
+     * a robot crossing a boundary is handed to the next zone on the next
+     * tick. Neighbors come from the shared tick-start snapshot, which
+     * includes robots just across a boundary (the halo), so ORCA sees the
+     * same neighbors as in stepDriver. Velocities are computed on the
+     * workers and moves applied on the fleet thread in robot order, once
+     * per sub-step round: the result does not depend on the thread count.
+     */
+    void stepDriversByZone(float dt);
+    
+    /**
+     * @brief Pass the NavMesh nodes the overlay changed to the drivers
+     *        whose path crosses them.
+     * 
+     * Called from fleetLoop with fleetMutex_ and mapMutex_ held. Drivers
+     * are found through pathIndex_ (re-indexed when their path changed),
+     * plus those repairing a detour, which hear of every change. Drivers
+     * whose path became blocked detour (RobotDriver::OnMapChanged) and the
+     * next cooperative window is planned at once.
+     */
+    void notifyMapChanges();
+    
+    /**
+     * @brief Record the NavMesh nodes robots finished crossing since the
+     *        last sample in congestionMap_.
+     * 
+     * Called from fleetLoop with fleetMutex_ held, after the drivers moved;
+     * samples every CONGESTION_SAMPLE_SECONDS of fleet time. Only crossings
+     * spent driving count, so a robot parked at a dock adds no delay.
+     */
+    void sampleCongestion(double now);
+    
+    /**
+     * @brief Every congestionRefreshMs, write congestionMap_'s penalties
+     *        into the NavMesh overlay.
+     * 
+     * Called from fleetLoop with fleetMutex_ and mapMutex_ held, before
+     * notifyMapChanges, which then hands the changed nodes to the drivers;
+     * the main loop recomputes the affected cost rows (checkCostMatrixRefresh).
+     */
+    void refreshCongestionPenalties(double now);
+    
+    /**
+     * @brief Plan the next cooperative window for every driver.
+     * 
+     * Called from fleetLoop with fleetMutex_ and mapMutex_ held, before the drivers
+     * move. Does nothing until half a window has passed or a driver got
+     * a new goal. Drivers with goals are planned first, in an order
+     * rotated every window so no robot always yields.
+     */
+    void planMultiAgentWindow();
+    
+    /**
+     * @brief Publish every robot's state as the next FleetSnapshot.
+     * 
+     * Called with fleetMutex_ held: by the fleet loop after every tick and
+     * by publishPlan, so a reader never sees a new plan's robots as idle.
+     * Recycles a pooled snapshot when one is free, so steady-state ticks
+     * publish without allocating.
+     */
+    void publishFleetSnapshot();
+    
+    /// A pooled snapshot no reader holds, or a new one (fleetMutex_ held)
+    std::shared_ptr<FleetSnapshot> takeFreeFleetSnapshot();
+    
+    /**
+     * @brief Inject an ingested batch: the first capacity valid tasks get
+     *        fleet task ids and go to InjectTasks (runs on the ingestion thread).
+     */
+    TaskIngestResult ingestBatch(std::string_view document, size_t capacity);
+    
+    /**
+     * @brief Start the ingestion endpoints set in the config.
+     */
+    void startTaskIngestion();
+    
+    /**
+     * @brief Publish the fleet's itineraries as the next PlanSnapshot.
+     * 
+     * Called with fleetMutex_ held after the main loop changes any
+     * itinerary. Logs, against the previous snapshot, how many robots'
+     * plans changed and how many of those will head to a different next
+     * goal; robots whose plan only lost the goals since handed to their
+     * driver count as unchanged.
+     * 
+     * @param reason Source of the change, for the log
+     */
+    void publishPlan(const char* reason);
     
     /**
      * @brief Run VRP solver and assign itineraries to robots.
@@ -470,10 +1186,46 @@ private:
      */
     void processInjectedTasks();
     
+    /**
+     * @brief Scenario B or C for tasks that arrived together (logged as
+     *        one TASK_BATCH).
+     */
+    void processTaskBatch(const std::vector<Layer2::Task>& newTasks);
+    
+    /**
+     * @brief Act on the logged inputs due at the current fleet tick and
+     *        let the fleet loop run up to the next one (MainLoop, replay).
+     */
+    void runReplayStep();
+    
+    /**
+     * @brief Compare a goal reached in a replay with the log (fleet thread).
+     */
+    void compareReplayGoal(uint64_t tick, int robotId, int nodeId);
+    
+    /**
+     * @brief Resolve config_.threadPlacement and cap solver threads to its CPUs (start of Initialize).
+     */
+    void initializeThreadPlacement();
+    
+    /**
+     * @brief Load replayPath and open eventLogPath (end of Initialize).
+     */
+    bool initializeEventLog();
+    
+    /// Fleet ticks completed, as last published
+    uint64_t getFleetTick() const;
+    
     /**
      * @brief Scenario B: Cheap insertion heuristic for small batches.
      * Inserts each task at the cheapest position in existing itineraries.
      * 
+     * Plans on a snapshot of the routes, so the physics loop is only held
+     * up while the result is committed. Each task is scored on the
+     * insertionCandidateRobots robots whose routes pass nearest its pickup.
+     * A robot whose itinerary changed other than by reaching goals in the
+     * meantime gets its new tasks appended instead.
+     * 
      * @param tasks Tasks to insert
      */
     void runCheapInsertion(const std::vector<Layer2::Task>& tasks);
@@ -482,10 +1234,104 @@ private:
      * @brief Scenario C: Launch background re-planning.
      * Starts VRP solver in a separate thread.
      * 
+     * If a replan is already running, it is cancelled instead (it returns
+     * its best solution so far) and the tasks wait to be merged into a
+     * re-solve warm-started from that solution (launchMergedReplan). After
+     * MAX_REPLAN_MERGES preemptions in a row the running solve is left to
+     * finish and be applied, and the tasks go into the next replan.
+     * 
      * @param tasks Tasks to include in re-plan
      */
     void launchBackgroundReplan(const std::vector<Layer2::Task>& tasks);
     
+    /**
+     * @brief Re-plan replanMergeTasks_ once the running solve has returned.
+     * 
+     * @param incumbent Result of the superseded solve, whose tasks are
+     *        re-planned too (nullptr: none, or it was applied)
+     * @param carryOver Re-plan the superseded solve's tasks (it was not applied)
+     */
+    void launchMergedReplan(const Layer2::VRPResult* incumbent, bool carryOver);
+    
+    /**
+     * @brief Start the background solver on tasks for the given robot states.
+     * 
+     * @param warmStart Per robot, task indices to start from (empty: the
+     *        order the robots' itineraries already follow)
+     */
+    void startBackgroundSolve(const std::vector<Layer2::Task>& tasks, std::vector<Layer2::RobotAgent> robots,
+                              std::vector<std::vector<int>> warmStart = {});
+    
+    /**
+     * @brief Search the cost rows from the robots' current nodes to the
+     *        task endpoints and chargers before a solve starts.
+     * 
+     * Main thread, while no solve or cost refresh reads the matrix.
+     */
+    void prefetchStartCosts(const std::vector<Layer2::Task>& tasks, const std::vector<Layer2::RobotAgent>& robots);
+    
+    /**
+     * @brief Expected latency of a replan of this size: the adaptive
+     *        solver's prediction, else the measured average, else
+     *        estimatedReplanTimeMs.
+     */
+    double expectedReplanMs(size_t tasks, size_t robots) const;
+    
+    /**
+     * @brief Rolling-horizon alternative to Scenarios B and C.
+     * 
+     * Injected tasks accumulate until the window (horizonWindowMs) has
+     * passed, or the minimum window has and a robot has run out of work,
+     * and no replan is running. They are then solved together with the
+     * tasks robots have queued but not started (launchHorizonReplan).
+     * 
+     * @param newTasks Tasks injected since the last main-loop tick
+     */
+    void processRollingHorizon(const std::vector<Layer2::Task>& newTasks);
+    
+    /**
+     * @brief Current rolling-horizon window: enough solver latencies to
+     *        cap the replan rate, and long enough at the observed arrival
+     *        rate to gather a batch worth a replan, within the configured bounds.
+     */
+    double horizonWindowMs() const;
+    
+    /**
+     * @brief Re-plan the horizon batch with every robot's queued tasks.
+     * 
+     * Each robot keeps its itinerary up to the end of the task in
+     * progress plus horizonFrozenTasks more; the (pickup, dropoff) pairs
+     * after that are re-planned. Robots whose queue cannot be read as such
+     * pairs (goals that are neither task POIs nor chargers) keep it whole.
+     * Live itineraries are not touched until the result is applied.
+     */
+    void launchHorizonReplan();
+    
+    /**
+     * @brief Apply a horizon replan: kept prefix + solved route per robot.
+     * 
+     * @return false (nothing applied) if a robot has gone past its kept
+     *         prefix or its itinerary changed other than by reaching goals
+     *         or gaining charging goals at the front
+     */
+    bool applyHorizonReplan(const Layer2::VRPResult& result);
+    
+    /// Put the running horizon batch back into the window, which closes
+    /// again at once (the replan failed or could not be applied)
+    void requeueHorizonBatch();
+    
+    /**
+     * @brief Remember which task each pickup -> dropoff pair of the
+     *        solved itineraries is, so a later horizon replan keeps its id.
+     */
+    void recordPlannedTasks(const std::vector<Layer2::Task>& tasks, const Layer2::VRPResult& result);
+    
+    /// Task robotId has queued as (pickup, dropoff), taken out of available
+    /// (a copy of plannedTasks_); one with a new id if no solve planned it
+    /// (e.g. restored goals)
+    Layer2::Task takePlannedTask(std::map<int, std::vector<Layer2::Task>>& available,
+                                 int robotId, int pickup, int dropoff);
+    
     /**
      * @brief Check and apply background re-plan results.
      * Called from MainLoop to check if async solver finished.
@@ -493,13 +1339,61 @@ private:
     void checkBackgroundReplan();
     
     /**
-     * @brief Calculate insertion cost for a task into a robot's itinerary.
+     * @brief Keep the cost matrix in step with the NavMesh overlay.
+     * Called from MainLoop: starts recomputing the rows affected by
+     * blocked / freed nodes in the background and swaps them in once
+     * ready and no solver is running.
+     */
+    void checkCostMatrixRefresh();
+    
+    /**
+     * @brief Write a checkpoint every checkpointIntervalMs (MainLoop).
+     * The state is taken from the published snapshots and encoded and
+     * written in the background, one checkpoint at a time.
+     */
+    void checkCheckpoint();
+    
+    /**
+     * @brief Take a memory report every memoryReportIntervalMs (MainLoop),
+     *        publish it for metrics.prom and print it in live mode.
+     */
+    void checkMemoryReport();
+    
+    /**
+     * @brief Fleet state from the latest FleetSnapshot and PlanSnapshot.
+     * Main thread (or after Stop): reads the replan and horizon task lists.
+     * 
+     * @return nullptr if a plan was published in between (try next tick)
+     */
+    std::shared_ptr<FleetCheckpoint> captureCheckpoint() const;
+    
+    /// config_.checkpointPath, relative to basePath_ unless absolute
+    std::string getCheckpointFile() const;
+    
+    /**
+     * @brief Copy every robot's remaining route for cheap insertion
+     *        (holds fleetMutex_ only while copying).
      * 
-     * @param robot Robot to consider
+     * @param agents If given, receives a copy of every robot, in route order
+     */
+    std::vector<InsertionRoute> snapshotInsertionRoutes(std::vector<Layer2::RobotAgent>* agents = nullptr);
+    
+    /**
+     * @brief Recompute a route's leg costs and where it carries a package.
+     */
+    void refreshInsertionRoute(InsertionRoute& route) const;
+    
+    /**
+     * @brief Cheapest position for a task's pickup and dropoff in a route.
+     * 
+     * Both go in back to back, at a point where the robot carries nothing
+     * (robots carry one package), or at the end of the route.
+     * 
+     * @param route Route to insert into
      * @param task Task to insert
-     * @return Additional cost (distance) to add this task
+     * @return Slot and additional cost (distance); slot -1 if unreachable
      */
-    float calculateInsertionCost(const Layer2::RobotAgent& robot, const Layer2::Task& task) const;
+    InsertionSlot findCheapestInsertion(const InsertionRoute& route, const Layer2::Task& task) const;
     
     /**
      * @brief Estimate remaining time for a robot to complete current work.
@@ -510,6 +1404,13 @@ private:
      */
     int estimateRobotRemainingTimeMs(int robotId) const;
     
+    /**
+     * @brief Battery model for solves (disabled unless solverBatteryAware).
+     * Chargers are the CHARGING POIs; cost units per second follow from
+     * the robot speed and map resolution.
+     */
+    Layer2::BatteryModel makeBatteryModel() const;
+    
     /**
      * @brief Find nearest NavMesh node ID for a given position.
      */
@@ -523,6 +1424,30 @@ private:
     bool initializeLayer2();
     bool initializeLayer3();
     void createRobots();
+    
+    /**
+     * @brief Apply the configured search, corridor, cache, flow field and
+     *        worker settings to a path service planning on safetyMap.
+     * 
+     * @param mesh NavMesh generated from safetyMap (corridor routing)
+     */
+    void configurePathService(Layer3::Pathfinding::PathfindingService& service,
+                              const Layer1::InflatedBitMap& safetyMap, const Layer1::NavMesh& mesh);
+    
+    /// Path service robots of radiusMeters plan with
+    Layer3::Pathfinding::PathfindingService& pathServiceFor(float radiusMeters);
+    
+    /**
+     * @brief Count the dropoffs of tasks as robot goals and give the
+     *        busiest goals flow fields (main thread).
+     * 
+     * Called before the tasks are planned, so fields are in place before
+     * robots head there.
+     */
+    void noteGoalTraffic(const std::vector<Layer2::Task>& tasks);
+    
+    /// Hand the flowFieldGoals busiest goals of goalTraffic_ to the path services
+    void refreshFlowFieldGoals();
 };
 
 } // namespace Backend
@@ -0,0 +1,133 @@
+/**
+ * @file LoopScheduler.hh
+ * @brief Fixed-rate timing of the FleetManager loops
+ *
+ * Sleeping for "period minus the time this tick took" loses whatever the
+ * sleep oversleeps, so a loop drifts late, and a tick that overruns is
+ * simply forgotten. The scheduler keeps absolute deadlines (the n-th tick
+ * is due n periods after Start), sleeps until them and counts every
+ * deadline missed.
+ */
+
+#ifndef BACKEND_LOOPSCHEDULER_HH
+#define BACKEND_LOOPSCHEDULER_HH
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "LatencyHistogram.hh"
+
+namespace Backend {
+
+/**
+ * @brief What a loop does once it is a whole period or more behind.
+ */
+enum class OverrunPolicy {
+    CATCH_UP,       ///< Run the missed ticks back to back (up to a limit), e.g. fixed-step physics
+    SKIP            ///< Drop the missed ticks and resume on the next deadline, e.g. 1 Hz decisions
+};
+
+/**
+ * @brief Timing counters of one loop.
+ */
+struct LoopTimingStats {
+    uint64_t ticks = 0;             ///< Ticks run
+    uint64_t overruns = 0;          ///< Ticks that ended after the next tick was due
+    uint64_t skippedTicks = 0;      ///< Deadlines dropped (SKIP, or CATCH_UP past its limit)
+    double maxLatenessMs = 0.0;     ///< Latest tick start after its deadline
+    double meanLatenessMs = 0.0;
+    double jitterMs = 0.0;          ///< RMS deviation of tick start-to-start intervals from the period
+    double maxTickMs = 0.0;         ///< Longest tick (work only, no sleeping)
+};
+
+/**
+ * @brief Absolute-deadline periodic scheduler with overrun accounting.
+ *
+ * Usage from the loop's thread:
+ *   LoopScheduler scheduler(std::chrono::milliseconds(50), OverrunPolicy::CATCH_UP);
+ *   scheduler.Start();
+ *   while (running) {
+ *       scheduler.BeginTick();
+ *       ...work...
+ *       scheduler.EndTick();        // counts the tick
+ *       scheduler.WaitForNextTick(); // sleep_until the next deadline (skip in batch mode)
+ *   }
+ *
+ * GetStats may be called from any thread.
+ */
+class LoopScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// CATCH_UP runs at most this many periods late before it skips
+    static constexpr int DEFAULT_MAX_CATCH_UP_TICKS = 5;
+
+private:
+    Clock::duration period_;
+    OverrunPolicy policy_;
+    int maxCatchUpTicks_;
+
+    Clock::time_point deadline_;        ///< When the current tick was due
+    Clock::time_point tickStart_;
+    Clock::time_point previousStart_;
+    bool started_;
+    Common::LatencyHistogram* tickHistogram_;   ///< Tick work times (nullptr = not recorded)
+
+    // Counters (guarded by statsMutex_; written by the loop's thread only)
+    mutable std::mutex statsMutex_;
+    LoopTimingStats stats_;
+    double latenessSumMs_;
+    double jitterSquaresSum_;
+    uint64_t intervals_;
+
+public:
+    /**
+     * @param period Time between deadlines
+     * @param policy What to do about ticks that are a period or more late
+     * @param maxCatchUpTicks CATCH_UP: periods behind beyond which the rest is skipped
+     */
+    explicit LoopScheduler(Clock::duration period,
+                           OverrunPolicy policy = OverrunPolicy::SKIP,
+                           int maxCatchUpTicks = DEFAULT_MAX_CATCH_UP_TICKS);
+
+    /**
+     * @brief Make now the deadline of the first tick.
+     */
+    void Start();
+
+    /**
+     * @brief Mark the start of a tick (measures lateness and jitter).
+     */
+    void BeginTick();
+
+    /**
+     * @brief Mark the end of the tick's work and move the deadline on.
+     *
+     * A tick that ends past the next deadline is an overrun; once it is a
+     * whole period or more late, the policy decides whether the missed
+     * deadlines are run back to back or skipped.
+     */
+    void EndTick();
+
+    /**
+     * @brief Sleep until the next deadline (returns at once if it passed).
+     */
+    void WaitForNextTick() const;
+
+    /**
+     * @brief Also record every tick's work time in a histogram (nullptr = stop).
+     *
+     * The histogram must outlive the loop; set it before Start.
+     */
+    void SetTickHistogram(Common::LatencyHistogram* histogram) { tickHistogram_ = histogram; }
+
+    Clock::duration GetPeriod() const { return period_; }
+    OverrunPolicy GetPolicy() const { return policy_; }
+
+    LoopTimingStats GetStats() const;
+};
+
+} // namespace Backend
+
+#endif // BACKEND_LOOPSCHEDULER_HH
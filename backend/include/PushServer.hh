@@ -0,0 +1,256 @@
+/**
+ * @file PushServer.hh
+ * @brief Embedded WebSocket / HTTP server pushing telemetry, paths and obstacles
+ *
+ * Without it every frame goes C++ -> JSON file -> server.js polling the
+ * directory -> WebSocket, a disk round trip plus up to a polling period
+ * of delay. The push server lets clients connect to the backend itself:
+ *
+ * - ws://host:port/  (any path with an Upgrade header) receives every
+ *   frame as a text message {"type": "<channel>", "data": <document>},
+ *   where the document is what orca_tick_N.json / fleet_tick_N.json /
+ *   paths_tick_N.json would hold, starting with the latest of each.
+ * - GET /telemetry, /paths, /obstacles returns the latest document.
+ * - ws://host:port/binary (or ?format=binary) receives channels that
+ *   publish a binary stream as binary messages instead: a keyframe, then
+ *   deltas against it (api/TelemetryCodec.hh). A client gets a delta only
+ *   once its keyframe is on the wire, and full frames until then.
+ *   GET /telemetry.bin returns the latest frame in full.
+ *
+ * A client narrows what it gets with a text message
+ *
+ *   {"type": "subscribe", "channels": ["telemetry", "paths"],
+ *    "viewport": [minX, minY, maxX, maxY], "robots": [3, 7],
+ *    "rate": 5, "changedOnly": true}
+ *
+ * (every key optional; a new subscription replaces the last). Channels
+ * it left out are not sent, telemetry comes at most rate times a second,
+ * and a channel published with a filtered encoder is encoded for that
+ * client alone: only the robots it asked for, inside its viewport, and
+ * with changedOnly only those that changed since its previous frame.
+ * Clients without a subscription share one encoding per frame. Binary
+ * streams go to every binary client alike, so on a binary connection a
+ * subscription with robots, viewport or changedOnly is refused with
+ * {"type": "error", ...} and the previous one stays in force.
+ *
+ * Publishing only stores the message's encoder and wakes the I/O thread,
+ * which encodes it once and frames it for every client; the publisher
+ * never waits on a socket. A client holds at most one unsent frame per
+ * channel: a newer one replaces it (counted as decimated), so a slow
+ * client gets fewer frames instead of an ever longer queue, and a client
+ * that has not taken a byte for CLIENT_STALL_MS is dropped.
+ *
+ * POSIX sockets; on other platforms Start fails and nothing is pushed.
+ */
+
+#ifndef BACKEND_PUSHSERVER_HH
+#define BACKEND_PUSHSERVER_HH
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Backend {
+
+/**
+ * @brief Streams a client may receive.
+ */
+enum class PushChannel {
+    TELEMETRY = 0,      ///< Robot telemetry (physics rate)
+    PATHS,              ///< Robot paths
+    OBSTACLES           ///< Dynamic obstacles (1 Hz)
+};
+
+constexpr size_t PUSH_CHANNEL_COUNT = 3;
+
+/// "telemetry", "paths", "obstacles" (message type and HTTP path)
+const char* ToString(PushChannel channel);
+
+/**
+ * @brief What a client asked for (its last "subscribe" message).
+ */
+struct PushInterest {
+    uint32_t channels = (1u << PUSH_CHANNEL_COUNT) - 1;     ///< Bit per PushChannel
+    bool hasViewport = false;
+    int minX = 0;                       ///< Viewport in pixels, inclusive
+    int minY = 0;
+    int maxX = 0;
+    int maxY = 0;
+    std::vector<int> robots;            ///< Sorted robot ids (empty = every robot)
+    int maxRateHz = 0;                  ///< Telemetry frames per second (0 = every frame)
+    bool changedOnly = false;           ///< Omit robots unchanged since the client's previous frame
+
+    bool Wants(PushChannel channel) const { return (channels >> static_cast<size_t>(channel)) & 1u; }
+    bool WantsRobot(int robotId) const;
+    bool WantsPosition(int x, int y) const;
+
+    /// Whether a filtered encoder would drop anything for this client
+    bool FiltersRobots() const { return hasViewport || !robots.empty() || changedOnly; }
+};
+
+/**
+ * @brief What a filtered encoder keeps per client and channel.
+ */
+struct PushClientMemory {
+    std::unordered_map<int, uint64_t> sent;     ///< Robot id -> fingerprint of what the client last got
+};
+
+/**
+ * @brief One frame of a channel's binary keyframe / delta stream.
+ */
+struct PushBinaryFrame {
+    uint64_t id = 0;            ///< Frame (e.g. tick)
+    uint64_t base = 0;          ///< Keyframe the delta applies to (== id: this frame is one)
+    std::string keyframe;       ///< The frame in full
+    std::string delta;          ///< The frame against base ("" = none)
+};
+
+/**
+ * @brief Counters of a push server.
+ */
+struct PushServerStats {
+    size_t clients = 0;                 ///< WebSocket clients connected now
+    uint64_t clientsAccepted = 0;       ///< WebSocket handshakes completed
+    uint64_t clientsDropped = 0;        ///< Stalled, misbehaving or over MAX_CLIENTS
+    uint64_t messagesPublished = 0;
+    uint64_t framesSent = 0;            ///< Frames fully written to a client
+    uint64_t framesDecimated = 0;       ///< Frames replaced by a newer one before a slow client got them
+    uint64_t framesThrottled = 0;       ///< Frames skipped for a client's telemetry rate
+    uint64_t framesFiltered = 0;        ///< Frames encoded for one client's subscription
+    uint64_t subscriptionsRejected = 0; ///< Robot / viewport filters asked for on a binary connection
+    uint64_t binaryKeyframesSent = 0;   ///< Binary frames sent in full
+    uint64_t binaryDeltasSent = 0;      ///< Binary frames sent as a delta
+    uint64_t bytesSent = 0;
+    uint64_t httpRequests = 0;
+};
+
+/**
+ * @brief Single-threaded non-blocking server (poll) on its own I/O thread.
+ */
+class PushServer {
+public:
+    /// Builds a channel's JSON document; runs on the I/O thread
+    using Encoder = std::function<std::string()>;
+    /// Builds a channel's binary frame; runs on the I/O thread
+    using BinaryEncoder = std::function<PushBinaryFrame()>;
+    /// Builds a channel's document for one subscribed client ("" = nothing to send it)
+    using FilteredEncoder = std::function<std::string(const PushInterest&, PushClientMemory&)>;
+
+    static constexpr int MAX_CLIENTS = 64;
+    static constexpr size_t MAX_REQUEST_BYTES = 8 * 1024;       ///< HTTP request head
+    static constexpr size_t MAX_CLIENT_MESSAGE_BYTES = 64 * 1024;
+    static constexpr int CLIENT_STALL_MS = 5000;                ///< Output pending and none sent for this long
+    static constexpr int POLL_TIMEOUT_MS = 250;
+
+private:
+    struct Client;      // PushServer.cc
+
+    int listenFd_ = -1;
+    int wakeRead_ = -1;
+    int wakeWrite_ = -1;
+    int port_ = 0;
+    std::thread ioThread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> wakePending_{false};
+
+    struct PendingMessage {
+        Encoder encode;
+        FilteredEncoder filtered;
+        Encoder snapshot;
+    };
+
+    std::mutex publishMutex_;
+    std::array<PendingMessage, PUSH_CHANNEL_COUNT> pending_;   ///< Newest unencoded message per channel
+    std::array<BinaryEncoder, PUSH_CHANNEL_COUNT> pendingBinary_;
+
+    // I/O thread only
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::array<std::shared_ptr<const std::string>, PUSH_CHANNEL_COUNT> latestDocument_;
+    std::array<std::shared_ptr<const std::string>, PUSH_CHANNEL_COUNT> latestFrame_;
+    std::array<Encoder, PUSH_CHANNEL_COUNT> snapshotEncoder_;   ///< Channels whose messages are changes only
+    std::array<std::shared_ptr<const std::string>, PUSH_CHANNEL_COUNT> snapshotDocument_;  ///< Encoded on first use
+    std::array<std::shared_ptr<const std::string>, PUSH_CHANNEL_COUNT> snapshotFrame_;
+    std::array<std::shared_ptr<const std::string>, PUSH_CHANNEL_COUNT> latestBinaryDocument_;  ///< Keyframe bytes
+    std::array<std::shared_ptr<const std::string>, PUSH_CHANNEL_COUNT> latestBinaryFrame_;     ///< Keyframe message
+    std::array<uint64_t, PUSH_CHANNEL_COUNT> latestBinaryId_{};
+
+    mutable std::mutex statsMutex_;
+    PushServerStats stats_;
+
+    void RunIO();
+    void TakePublished();
+    void AcceptClients();
+    void ReadClient(Client& client);
+    void HandleRequest(Client& client, const std::string& head);
+    void HandleClientFrames(Client& client);
+    void WriteClient(Client& client);
+    void Enqueue(Client& client, size_t channel, const std::shared_ptr<const std::string>& frame,
+                 uint64_t keyframeId = UINT64_MAX);
+    void DropClient(Client& client, const char* reason);
+    void Subscribe(Client& client, const std::string& message);
+    bool Throttled(Client& client, size_t channel, std::chrono::steady_clock::time_point now);
+    /// What a client joining now gets of the channel (nullptr = nothing yet)
+    std::shared_ptr<const std::string> SnapshotDocument(size_t channel);
+    std::shared_ptr<const std::string> SnapshotFrame(size_t channel);
+
+public:
+    PushServer();
+    ~PushServer();
+    PushServer(const PushServer&) = delete;
+    PushServer& operator=(const PushServer&) = delete;
+
+    /**
+     * @brief Listen on address:port and start the I/O thread.
+     *
+     * @param port 0 = any free port (see GetPort)
+     * @param onThreadStart Run first on the I/O thread (e.g. thread placement)
+     * @return false if the socket could not be bound
+     */
+    bool Start(int port, const std::string& address = "127.0.0.1",
+               std::function<void()> onThreadStart = nullptr);
+
+    /**
+     * @brief Close every connection and join the I/O thread.
+     */
+    void Stop();
+
+    bool IsRunning() const { return running_.load(); }
+    int GetPort() const { return port_; }
+
+    /**
+     * @brief Push a channel's next document to every client.
+     *
+     * Replaces a message of that channel not taken by the I/O thread yet.
+     * Safe from any thread; never blocks on the network.
+     *
+     * @param filtered Encodes the message for a client whose subscription
+     *                 narrows the robots (nullptr = it gets encode's)
+     * @param snapshot Full state for clients that join (and HTTP GETs)
+     *                 when messages only carry changes (nullptr = the
+     *                 latest message is the state)
+     */
+    void Publish(PushChannel channel, Encoder encode, FilteredEncoder filtered = nullptr,
+                 Encoder snapshot = nullptr);
+
+    /**
+     * @brief Push a channel's next binary frame to clients that asked for binary.
+     *
+     * Replaces a binary frame of that channel not taken yet, like
+     * Publish, so a delta encoder must not rely on seeing every frame.
+     */
+    void PublishBinary(PushChannel channel, BinaryEncoder encode);
+
+    PushServerStats GetStats() const;
+};
+
+} // namespace Backend
+
+#endif // BACKEND_PUSHSERVER_HH
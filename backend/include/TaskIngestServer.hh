@@ -0,0 +1,167 @@
+/**
+ * @file TaskIngestServer.hh
+ * @brief Framed TCP / Unix-socket endpoint a WMS pushes task batches to
+ *
+ * Tasks otherwise come from the task file at startup or one CLI command
+ * at a time. The ingestion endpoint takes batches over a socket and
+ * feeds them to InjectTasks (its lock-free queue) from its own thread.
+ *
+ * Every message, both ways, is a 4-byte big-endian length and that many
+ * bytes of JSON. A client sends batches in the task file format:
+ *
+ *   {"batch": 7, "tasks": [{"id": 1, "pickup": "PU3", "dropoff": "DO4"}, ...]}
+ *
+ * and gets one ack per batch, in order:
+ *
+ *   {"type": "ack", "batch": 7, "status": "ok" | "partial" | "busy" | "error",
+ *    "accepted": 2, "ids": [1, 2], "taskIds": [1000, 1001],
+ *    "rejected": 0, "refused": 1, "refusedIds": [3], "backlog": 4100}
+ *
+ * "ids" are the batch's own task ids and "taskIds" the ids the fleet gave
+ * them; "rejected" tasks were malformed or named an unknown POI. When the
+ * backlog (tasks injected or pending but not yet planned) would pass
+ * maxBacklog, the tasks beyond it are "refused" ("partial"), or with the
+ * backlog already full the batch is not read at all ("busy"). The client
+ * keeps what was refused and resends it after a
+ *
+ *   {"type": "resume", "backlog": 3000}
+ *
+ * message. Until then the server stops reading that client, so batches
+ * it sends in the meantime wait in the socket (TCP flow control) rather
+ * than in the fleet. Resume is sent once the backlog drops below
+ * RESUME_PERCENT of maxBacklog.
+ *
+ * A batch that is not valid JSON, or has no "tasks" array, is acked with
+ * "status": "error" and an "error" message naming the byte it failed at;
+ * tasks before that byte are still taken, so the client can tell a bad
+ * batch from an empty one.
+ *
+ * POSIX sockets; on other platforms Start fails and nothing is ingested.
+ */
+
+#ifndef BACKEND_TASKINGESTSERVER_HH
+#define BACKEND_TASKINGESTSERVER_HH
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Backend {
+
+/**
+ * @brief What became of one batch (filled by the batch handler).
+ */
+struct TaskIngestResult {
+    std::vector<int> ids;           ///< Batch ids of the accepted tasks
+    std::vector<int> taskIds;       ///< Fleet task ids given to them (same order)
+    std::vector<int> refusedIds;    ///< Batch ids of valid tasks over capacity
+    size_t rejected = 0;            ///< Malformed or naming unknown POIs
+    std::string error;              ///< Why the document could not be parsed ("" = it was)
+};
+
+/**
+ * @brief Counters of an ingestion server.
+ */
+struct TaskIngestStats {
+    uint64_t connections = 0;
+    uint64_t batches = 0;
+    uint64_t tasksAccepted = 0;
+    uint64_t tasksRejected = 0;
+    uint64_t tasksRefused = 0;
+    uint64_t busyReplies = 0;       ///< Batches refused whole (backlog full)
+    uint64_t errorReplies = 0;      ///< Batches that could not be parsed
+    uint64_t protocolErrors = 0;    ///< Oversized frames (connection closed)
+};
+
+/**
+ * @brief Single-threaded non-blocking server (poll) on its own I/O thread.
+ */
+class TaskIngestServer {
+public:
+    /// Parse document and inject up to capacity of its tasks; runs on the I/O thread
+    using BatchHandler = std::function<TaskIngestResult(std::string_view document, size_t capacity)>;
+    /// Tasks waiting to be planned
+    using BacklogProbe = std::function<size_t()>;
+
+    static constexpr int MAX_CLIENTS = 16;
+    static constexpr uint32_t MAX_FRAME_BYTES = 16 * 1024 * 1024;
+    static constexpr int RESUME_PERCENT = 75;
+    static constexpr int POLL_TIMEOUT_MS = 100;     ///< Also how often paused clients see the backlog
+
+private:
+    struct Client;      // TaskIngestServer.cc
+
+    BatchHandler handler_;
+    BacklogProbe backlog_;
+    size_t maxBacklog_;
+
+    int listenFd_ = -1;
+    int wakeRead_ = -1;
+    int wakeWrite_ = -1;
+    int port_ = 0;
+    std::string unixPath_;          ///< Unlinked on Stop
+    std::thread ioThread_;
+    std::atomic<bool> running_{false};
+
+    // I/O thread only
+    std::vector<std::unique_ptr<Client>> clients_;
+
+    mutable std::mutex statsMutex_;
+    TaskIngestStats stats_;
+
+    bool StartThread(std::function<void()> onThreadStart);
+    void RunIO();
+    void AcceptClients();
+    void ReadClient(Client& client);
+    void ProcessFrames(Client& client);
+    void HandleBatch(Client& client, std::string_view document);
+    void ResumeClients();
+    void WriteClient(Client& client);
+    static void QueueMessage(Client& client, const std::string& json);
+
+public:
+    /**
+     * @param handler Injects a batch's tasks
+     * @param backlog Tasks injected but not planned yet
+     * @param maxBacklog Backlog beyond which batches are refused
+     */
+    TaskIngestServer(BatchHandler handler, BacklogProbe backlog, size_t maxBacklog);
+    ~TaskIngestServer();
+    TaskIngestServer(const TaskIngestServer&) = delete;
+    TaskIngestServer& operator=(const TaskIngestServer&) = delete;
+
+    /**
+     * @brief Listen on address:port (TCP) and start the I/O thread.
+     *
+     * @param port 0 = any free port (see GetPort)
+     * @param onThreadStart Run first on the I/O thread (e.g. thread placement)
+     * @return false if the socket could not be bound
+     */
+    bool Start(int port, const std::string& address = "127.0.0.1",
+               std::function<void()> onThreadStart = nullptr);
+
+    /**
+     * @brief Listen on a Unix domain socket (replacing a stale one) and start the I/O thread.
+     */
+    bool StartUnix(const std::string& path, std::function<void()> onThreadStart = nullptr);
+
+    /**
+     * @brief Close every connection and join the I/O thread.
+     */
+    void Stop();
+
+    bool IsRunning() const { return running_.load(); }
+    int GetPort() const { return port_; }
+
+    TaskIngestStats GetStats() const;
+};
+
+} // namespace Backend
+
+#endif // BACKEND_TASKINGESTSERVER_HH
@@ -0,0 +1,149 @@
+/**
+ * @file ThreadPlacement.hh
+ * @brief CPU pinning and scheduling priority of the FleetManager threads
+ *
+ * The physics loop shares the machine with background VRP solves (an
+ * ALNS portfolio can start a thread per member), path workers and file
+ * writers; left to the OS, a solve landing next to it shows up as 20 Hz
+ * jitter. Each thread role gets a CPU list and a priority class, applied
+ * by every thread of that role when it starts. Threads a role's thread
+ * creates (zone workers, solver members) inherit its placement.
+ *
+ * Isolating physics keeps every other role off the physics CPUs, and the
+ * solver role's CPU count caps how many threads a replan may start.
+ */
+
+#ifndef BACKEND_THREADPLACEMENT_HH
+#define BACKEND_THREADPLACEMENT_HH
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Backend {
+
+/**
+ * @brief What a thread is for.
+ */
+enum class ThreadRole {
+    PHYSICS = 0,    ///< Fleet loop (20 Hz) and its zone workers
+    STRATEGIC,      ///< Main loop (1 Hz): task intake, Scenario A solves
+    OBSTACLE,       ///< Obstacle loop (1 Hz)
+    SOLVER,         ///< Background replans, cost refreshes and path workers
+    IO              ///< Checkpoint writer
+};
+
+constexpr size_t THREAD_ROLE_COUNT = 5;
+
+/**
+ * @brief Scheduling class of a role.
+ *
+ * HIGH and REALTIME need CAP_SYS_NICE (or a raised RLIMIT_NICE /
+ * RLIMIT_RTPRIO); without it the thread keeps running at its inherited
+ * priority and a warning is printed once.
+ */
+enum class ThreadPriority {
+    NORMAL,         ///< SCHED_OTHER, nice 0
+    HIGH,           ///< SCHED_OTHER, nice -10
+    LOW,            ///< SCHED_BATCH, nice 10 (yields to everything interactive)
+    REALTIME        ///< SCHED_FIFO: preempts every normal thread
+};
+
+/**
+ * @brief Placement requested for one role.
+ */
+struct ThreadRoleConfig {
+    std::string cpus;                           ///< e.g. "3" or "0,2-3" ("" = any CPU the process may use)
+    ThreadPriority priority = ThreadPriority::NORMAL;
+};
+
+/**
+ * @brief Placement requested for every role (SystemConfig::threadPlacement).
+ */
+struct ThreadPlacementConfig {
+    std::array<ThreadRoleConfig, THREAD_ROLE_COUNT> roles;
+    bool isolatePhysics = false;                ///< No other role on the physics CPUs (picks the last CPU if physics has none)
+
+    ThreadRoleConfig& operator[](ThreadRole role) { return roles[static_cast<size_t>(role)]; }
+    const ThreadRoleConfig& operator[](ThreadRole role) const { return roles[static_cast<size_t>(role)]; }
+
+    /// Whether anything differs from leaving placement to the OS
+    bool IsSet() const;
+};
+
+const char* ToString(ThreadRole role);
+const char* ToString(ThreadPriority priority);
+
+/// "physics", "strategic", "obstacle", "solver", "io"
+bool ParseThreadRole(const std::string& text, ThreadRole& role);
+
+/// "normal", "high", "low", "realtime"
+bool ParseThreadPriority(const std::string& text, ThreadPriority& priority);
+
+/**
+ * @brief Parse a CPU list ("3", "0,2-3").
+ *
+ * @return false on a malformed list (cpus is then left empty)
+ */
+bool ParseCpuList(const std::string& text, std::vector<int>& cpus);
+
+/**
+ * @brief Placement resolved against the CPUs this process may use.
+ *
+ * Resolve once before the threads start; Apply is then safe from any
+ * thread.
+ */
+class ThreadPlacement {
+private:
+    struct ResolvedRole {
+        std::vector<int> cpus;                  ///< Empty = every allowed CPU
+        ThreadPriority priority = ThreadPriority::NORMAL;
+    };
+
+    bool active_ = false;
+    std::vector<int> allowedCpus_;              ///< Process affinity when resolved
+    std::array<ResolvedRole, THREAD_ROLE_COUNT> roles_;
+    mutable std::array<std::atomic<bool>, THREAD_ROLE_COUNT> warned_{};  ///< Apply failure reported
+
+public:
+    ThreadPlacement() = default;
+    ThreadPlacement(const ThreadPlacement&) = delete;
+    ThreadPlacement& operator=(const ThreadPlacement&) = delete;
+
+    /**
+     * @brief Resolve config against the process affinity.
+     *
+     * CPUs the process may not use are dropped with a warning; a role
+     * left with none runs anywhere.
+     */
+    void Resolve(const ThreadPlacementConfig& config);
+
+    /// Whether Apply does anything
+    bool IsActive() const { return active_; }
+
+    /**
+     * @brief Move the calling thread to the role's CPUs and priority.
+     *
+     * Resets both even where the role asked for nothing, since a thread
+     * starts with its creator's placement.
+     *
+     * @return false if the OS refused part of it (reported once per role)
+     */
+    bool Apply(ThreadRole role) const;
+
+    /**
+     * @brief CPUs the role's threads run on.
+     */
+    size_t GetCpuCount(ThreadRole role) const;
+
+    /**
+     * @brief One line per role, for the startup log.
+     */
+    std::string Describe() const;
+};
+
+} // namespace Backend
+
+#endif // BACKEND_THREADPLACEMENT_HH
@@ -0,0 +1,535 @@
+/**
+ * @file kernel_benchmark.cc
+ * @brief Microbenchmarks of the hot kernels of every layer
+ *
+ * Times single operations over the real warehouse map, so an optimization
+ * of one kernel can be measured on its own (the fleet manager's own
+ * latency histograms mix them all):
+ *
+ * - layer1: InflatedBitMap construction, NavMeshGenerator::ComputeRecast
+ *   (uniform tiles and merged rectangles)
+ * - layer2: CostMatrixProvider::RunDijkstra (plain and with congestion
+ *   penalties) and RunAStar
+ * - layer3: ThetaStarSolver::ComputePath, ORCASolver::CalculateSafeVelocity,
+ *   FastLoopManager::GatherNeighbors
+ * - api: APIService's JSON serializers and the binary telemetry encoder
+ *
+ * Each benchmark is calibrated to a number of operations per repetition
+ * that takes at least --min-time, then repeated; results are per
+ * operation: median, mean, standard deviation, min and max over the
+ * repetitions. Query inputs (node pairs, robot positions) are seeded
+ * mt19937 draws reduced by modulo, as in layer2/solver_benchmark.cc, so
+ * every run times the same work.
+ *
+ * Usage:
+ *   make benchmark ARGS="--json kernels.json --label baseline"
+ *   ./build/kernel_benchmark --filter layer3/orca --repetitions 30
+ *
+ * Options:
+ *   --filter a,b,...           Only benchmarks whose name contains one of these
+ *   --repetitions N            Timed repetitions per benchmark (default 10)
+ *   --min-time MS              Minimum duration of a repetition (default 50)
+ *   --seed S                   Input seed (default 1)
+ *   --map FILE                 Map layout (default layer1/assets/map_layout.txt)
+ *   --label TEXT               Recorded in the JSON output (e.g. a commit)
+ *   --json FILE                Also write the results as JSON
+ *   --list 1                   Print the benchmark names and exit
+ *   --verbose 1                Keep the kernels' own logging (stdout)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Layer 1 includes
+#include "StaticBitMap.hh"
+#include "InflatedBitMap.hh"
+#include "NavMesh.hh"
+#include "NavMeshGenerator.hh"
+
+// Layer 2 includes
+#include "CostMatrixProvider.hh"
+
+// Layer 3 includes
+#include "Pathfinding/PathfindingService.hh"
+#include "Pathfinding/ThetaStarSolver.hh"
+#include "Physics/KinematicsStore.hh"
+#include "Physics/ORCASolver.hh"
+#include "Core/FastLoopManager.hh"
+
+// API includes
+#include "../api/APIService.hh"
+
+// Common includes
+#include "Resolution.hh"
+
+using namespace Backend;
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+const Common::Resolution MAP_RESOLUTION = Common::Resolution::DECIMETERS;
+const float ROBOT_RADIUS_METERS = 0.3f;     ///< FleetManager's default
+const double ROBOT_RADIUS_PIXELS = 3.0;
+const double ROBOT_SPEED_PIXELS = 16.0;     ///< 1.6 m/s
+
+const int QUERY_POOL_SIZE = 64;             ///< Node pairs / sources cycled through
+const int FLEET_SIZE = 200;                 ///< Robots for GatherNeighbors and the serializers
+const int OBSTACLE_COUNT = 50;
+const int WAYPOINTS_PER_PATH = 20;
+const size_t MAX_CALIBRATED_ITERATIONS = 100000000;
+
+struct BenchmarkOptions {
+    std::vector<std::string> filters;
+    int repetitions = 10;
+    double minTimeMs = 50.0;
+    unsigned int seed = 1;
+    std::string mapPath = "layer1/assets/map_layout.txt";
+    std::string label;
+    std::string jsonPath;
+    bool list = false;
+    bool verbose = false;
+};
+
+/// One operation of a kernel; inputs are set up once, outside the timing
+struct Benchmark {
+    std::string name;
+    std::function<void()> operation;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    size_t iterations = 0;              ///< Operations per repetition
+    std::vector<double> nsPerOp;        ///< One per repetition
+    double median = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+/// Results of the kernels go here so the compiler cannot drop the calls
+volatile size_t g_sink = 0;
+
+// =============================================================================
+// PRIVATE KERNELS
+// =============================================================================
+
+/**
+ * @brief Friend of FastLoopManager and APIService (see their headers).
+ */
+struct KernelBenchmarkAccess {
+    using ShardScratch = Layer3::Core::FastLoopManager::ShardScratch;
+
+    /// Neighbors of every robot in the manager's last tick snapshot
+    static size_t GatherAllNeighbors(const Layer3::Core::FastLoopManager& manager,
+                                     ShardScratch& scratch) {
+        size_t found = 0;
+        for (size_t i = 0; i < manager.robots_.size(); ++i) {
+            manager.GatherNeighbors(i, scratch);
+            found += scratch.neighbors.Size();
+        }
+        return found;
+    }
+
+    static std::string EncodeTelemetry(const std::vector<API::RobotTelemetry>& data) {
+        return API::APIService::EncodeTelemetry(1, std::chrono::system_clock::time_point(), data);
+    }
+
+    static std::string EncodeObstacles(const std::vector<API::ObstacleInfo>& obstacles) {
+        return API::APIService::EncodeObstacles(1, std::chrono::system_clock::time_point(), obstacles);
+    }
+
+    static std::string EncodePaths(const std::vector<API::PathSegment>& paths) {
+        return API::APIService::EncodePaths(1, std::chrono::system_clock::time_point(), paths);
+    }
+};
+
+// =============================================================================
+// HELPER FUNCTIONS
+// =============================================================================
+
+std::vector<std::string> SplitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+unsigned int Draw(std::mt19937& rng, size_t n) {
+    return static_cast<unsigned int>(rng() % n);
+}
+
+double DrawSigned(std::mt19937& rng) {
+    return 2.0 * static_cast<double>(rng()) / (static_cast<double>(std::mt19937::max()) + 1.0) - 1.0;
+}
+
+bool Selected(const std::string& name, const BenchmarkOptions& options) {
+    if (options.filters.empty()) return true;
+    for (const auto& filter : options.filters) {
+        if (name.find(filter) != std::string::npos) return true;
+    }
+    return false;
+}
+
+double ElapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Run count operations back to back; total nanoseconds
+double TimeOperations(const Benchmark& benchmark, size_t count) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) benchmark.operation();
+    return ElapsedNs(start);
+}
+
+std::string FormatDuration(double ns) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    if (ns < 1e3) {
+        out << ns << " ns";
+    } else if (ns < 1e6) {
+        out << ns / 1e3 << " us";
+    } else if (ns < 1e9) {
+        out << ns / 1e6 << " ms";
+    } else {
+        out << ns / 1e9 << " s";
+    }
+    return out.str();
+}
+
+// =============================================================================
+// MEASUREMENT
+// =============================================================================
+
+BenchmarkResult Measure(const Benchmark& benchmark, const BenchmarkOptions& options) {
+    BenchmarkResult result;
+    result.name = benchmark.name;
+
+    // Warm-up (caches, workspaces, first-touch allocations), then grow the
+    // batch until one takes long enough to time reliably
+    double minTimeNs = options.minTimeMs * 1e6;
+    size_t iterations = 1;
+    double batchNs = TimeOperations(benchmark, iterations);
+    while (batchNs < minTimeNs && iterations < MAX_CALIBRATED_ITERATIONS) {
+        double scale = batchNs > 0.0 ? 1.2 * minTimeNs / batchNs : 10.0;
+        iterations = std::min(MAX_CALIBRATED_ITERATIONS,
+                              std::max(iterations + 1, static_cast<size_t>(iterations * std::min(scale, 10.0))));
+        batchNs = TimeOperations(benchmark, iterations);
+    }
+    result.iterations = iterations;
+
+    for (int r = 0; r < options.repetitions; ++r) {
+        result.nsPerOp.push_back(TimeOperations(benchmark, iterations) / static_cast<double>(iterations));
+    }
+
+    std::vector<double> sorted = result.nsPerOp;
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    result.median = n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+    result.min = sorted.front();
+    result.max = sorted.back();
+    double sum = 0.0;
+    for (double value : sorted) sum += value;
+    result.mean = sum / static_cast<double>(n);
+    double squares = 0.0;
+    for (double value : sorted) squares += (value - result.mean) * (value - result.mean);
+    result.stddev = n > 1 ? std::sqrt(squares / static_cast<double>(n - 1)) : 0.0;
+    return result;
+}
+
+// =============================================================================
+// OUTPUT
+// =============================================================================
+
+void PrintTable(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    out << std::left << std::setw(44) << "benchmark" << std::right
+        << std::setw(12) << "iterations" << std::setw(13) << "median" << std::setw(13) << "mean"
+        << std::setw(13) << "stddev" << std::setw(13) << "min" << std::setw(8) << "cv" << "\n";
+    for (const auto& result : results) {
+        double cv = result.mean > 0.0 ? 100.0 * result.stddev / result.mean : 0.0;
+        out << std::left << std::setw(44) << result.name << std::right
+            << std::setw(12) << result.iterations
+            << std::setw(13) << FormatDuration(result.median) << std::setw(13) << FormatDuration(result.mean)
+            << std::setw(13) << FormatDuration(result.stddev) << std::setw(13) << FormatDuration(result.min)
+            << std::setw(7) << std::fixed << std::setprecision(1) << cv << "%\n";
+    }
+}
+
+void WriteJSON(std::ostream& out, const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options) {
+    std::time_t now = std::time(nullptr);
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << std::fixed << "{\n"
+        << "  \"label\": \"" << options.label << "\",\n"
+        << "  \"timestamp\": \"" << timestamp << "\",\n"
+        << "  \"map\": \"" << options.mapPath << "\",\n"
+        << "  \"seed\": " << options.seed << ",\n"
+        << "  \"repetitions\": " << options.repetitions << ",\n"
+        << "  \"min_time_ms\": " << std::setprecision(1) << options.minTimeMs << ",\n"
+        << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+        << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        out << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+            << std::setprecision(1)
+            << ", \"median_ns\": " << result.median << ", \"mean_ns\": " << result.mean
+            << ", \"stddev_ns\": " << result.stddev << ", \"min_ns\": " << result.min
+            << ", \"max_ns\": " << result.max << ", \"repetitions_ns\": [";
+        for (size_t r = 0; r < result.nsPerOp.size(); ++r) {
+            out << (r ? ", " : "") << result.nsPerOp[r];
+        }
+        out << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+bool ParseArguments(int argc, char** argv, BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--filter") {
+            options.filters = SplitList(value);
+        } else if (arg == "--repetitions") {
+            options.repetitions = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--min-time") {
+            options.minTimeMs = std::max(0.0, std::atof(value.c_str()));
+        } else if (arg == "--seed") {
+            options.seed = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--map") {
+            options.mapPath = value;
+        } else if (arg == "--label") {
+            options.label = value;
+        } else if (arg == "--json") {
+            options.jsonPath = value;
+        } else if (arg == "--list") {
+            options.list = value != "0";
+        } else if (arg == "--verbose") {
+            options.verbose = value != "0";
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    if (!ParseArguments(argc, argv, options)) return 1;
+
+    std::streambuf* stdoutBuffer = std::cout.rdbuf();
+    if (!options.verbose) std::cout.rdbuf(nullptr);
+
+    // --- Fixtures: the map as the fleet manager builds it ---
+    auto staticMap = std::make_unique<Layer1::StaticBitMap>(
+        Layer1::StaticBitMap::CreateFromFile(options.mapPath, MAP_RESOLUTION));
+    auto inflatedMap = std::make_unique<Layer1::InflatedBitMap>(*staticMap, ROBOT_RADIUS_METERS);
+    Layer1::NavMesh navMesh;
+    Layer1::NavMeshGenerator().ComputeRecast(*inflatedMap, navMesh);
+    const auto& nodes = navMesh.GetAllNodes();
+    if (nodes.size() < 2) {
+        std::cout.rdbuf(stdoutBuffer);
+        std::cerr << "[Benchmark] NavMesh of " << options.mapPath << " has fewer than 2 nodes\n";
+        return 1;
+    }
+
+    std::mt19937 rng(options.seed);
+    std::vector<std::pair<int, int>> nodePairs;
+    for (int i = 0; i < QUERY_POOL_SIZE; ++i) {
+        nodePairs.emplace_back(Draw(rng, nodes.size()), Draw(rng, nodes.size()));
+    }
+
+    Layer2::CostMatrixProvider costs(navMesh);
+
+    // The same mesh under congestion penalties: costs are no longer multiples
+    // of the tile size (own generator, so the other fixtures keep their draws)
+    Layer1::NavMesh penalizedMesh = navMesh;
+    std::mt19937 penaltyRng(options.seed + 1);
+    std::vector<float> penalties(nodes.size());
+    for (float& penalty : penalties) penalty = static_cast<float>(10.0 * std::fabs(DrawSigned(penaltyRng)));
+    penalizedMesh.UpdatePenalties(penalties);
+    Layer2::CostMatrixProvider penalizedCosts(penalizedMesh);
+    Layer3::Pathfinding::ThetaStarSolver thetaStar;
+    Layer3::Pathfinding::ThetaStarSolver::SearchWorkspace workspace;
+
+    // ORCA: neighbors around one robot (none overlapping it), moving in random directions
+    Layer3::Physics::ORCASolver orca;
+    Layer3::Physics::ObstacleData me(0, {500, 500}, Layer3::Vector2(ROBOT_SPEED_PIXELS, 0.0), ROBOT_RADIUS_PIXELS);
+    Layer3::Vector2 preferredVelocity(ROBOT_SPEED_PIXELS, 0.0);
+    auto makeNeighbors = [&](int count) {
+        std::vector<Layer3::Physics::ObstacleData> neighbors;
+        for (int i = 0; i < count; ++i) {
+            double angle = M_PI * DrawSigned(rng);
+            double distance = 10.0 + 50.0 * std::fabs(DrawSigned(rng));
+            Common::Coordinates position{500 + static_cast<int>(distance * std::cos(angle)),
+                                         500 + static_cast<int>(distance * std::sin(angle))};
+            neighbors.emplace_back(i + 1, position,
+                                   Layer3::Vector2(ROBOT_SPEED_PIXELS * DrawSigned(rng), ROBOT_SPEED_PIXELS * DrawSigned(rng)),
+                                   ROBOT_RADIUS_PIXELS);
+        }
+        return neighbors;
+    };
+    auto pack = [](const std::vector<Layer3::Physics::ObstacleData>& neighbors) {
+        Layer3::Physics::KinematicsStore store;
+        for (const auto& neighbor : neighbors) store.Push(neighbor);
+        return store;
+    };
+    std::vector<Layer3::Physics::ObstacleData> neighbors8 = makeNeighbors(8);
+    std::vector<Layer3::Physics::ObstacleData> neighbors32 = makeNeighbors(32);
+    Layer3::Physics::KinematicsStore packed8 = pack(neighbors8);
+    Layer3::Physics::KinematicsStore packed32 = pack(neighbors32);
+
+    // A fleet parked on random nodes; one tick builds the neighbor snapshot
+    Layer3::Pathfinding::PathfindingService pathService;
+    Layer3::Core::FastLoopManager fleet;
+    fleet.SetThreadCount(1);
+    for (int i = 0; i < FLEET_SIZE; ++i) {
+        fleet.CreateRobot(i, nodes[Draw(rng, nodes.size())].coords, navMesh, pathService);
+    }
+    fleet.RunSingleTick();
+    KernelBenchmarkAccess::ShardScratch scratch;
+
+    // API payloads of the same fleet size
+    std::vector<API::RobotTelemetry> telemetry;
+    std::vector<API::TelemetryRecord> records;
+    std::vector<API::PathSegment> paths;
+    for (int i = 0; i < FLEET_SIZE; ++i) {
+        const auto& node = nodes[Draw(rng, nodes.size())];
+        telemetry.push_back({i, node.coords, Layer3::Vector2(ROBOT_SPEED_PIXELS * DrawSigned(rng), 0.0),
+                             "MOVING", "MOVING", 0.75f, static_cast<int>(i % nodes.size()), -1, 12, i % 2 == 0});
+        API::TelemetryRecord record{};
+        record.id = i;
+        record.x = node.coords.x;
+        record.y = node.coords.y;
+        record.vx = static_cast<float>(telemetry.back().velocity.x);
+        record.battery = 0.75f;
+        record.targetNodeId = -1;
+        records.push_back(record);
+
+        API::PathSegment path{i, {}, 1};
+        for (int w = 0; w < WAYPOINTS_PER_PATH; ++w) path.waypoints.push_back(nodes[Draw(rng, nodes.size())].coords);
+        paths.push_back(path);
+    }
+    std::vector<API::ObstacleInfo> obstacles;
+    for (int i = 0; i < OBSTACLE_COUNT; ++i) {
+        obstacles.push_back({nodes[Draw(rng, nodes.size())].coords, 10, 10, "forklift"});
+    }
+    API::TelemetryDeltaEncoder deltaEncoder;
+    uint64_t frameTick = 0;
+
+    // --- Benchmarks ---
+    size_t next = 0;
+    std::vector<Benchmark> benchmarks = {
+        {"layer1/InflatedBitMap", [&]() {
+            Layer1::InflatedBitMap inflated(*staticMap, ROBOT_RADIUS_METERS);
+            g_sink += static_cast<size_t>(inflated.GetInflationRadiusPixels());
+        }},
+        {"layer1/ComputeRecast/uniform", [&]() {
+            Layer1::NavMesh mesh;
+            Layer1::NavMeshGenerator().ComputeRecast(*inflatedMap, mesh);
+            g_sink += mesh.GetAllNodes().size();
+        }},
+        {"layer1/ComputeRecast/merged", [&]() {
+            Layer1::NavMesh mesh;
+            Layer1::NavMeshGenerator generator;
+            generator.SetTilingMode(Layer1::NavMeshGenerator::TilingMode::MERGED_RECTANGLES);
+            generator.ComputeRecast(*inflatedMap, mesh);
+            g_sink += mesh.GetAllNodes().size();
+        }},
+        {"layer2/RunDijkstra", [&]() {
+            g_sink += costs.RunDijkstra(nodePairs[next++ % nodePairs.size()].first).size();
+        }},
+        {"layer2/RunDijkstra/penalized", [&]() {
+            g_sink += penalizedCosts.RunDijkstra(nodePairs[next++ % nodePairs.size()].first).size();
+        }},
+        {"layer2/RunAStar", [&]() {
+            const auto& pair = nodePairs[next++ % nodePairs.size()];
+            g_sink += static_cast<size_t>(costs.RunAStar(pair.first, pair.second) > 0.0f);
+        }},
+        {"layer3/ThetaStar/ComputePath", [&]() {
+            const auto& pair = nodePairs[next++ % nodePairs.size()];
+            auto result = thetaStar.ComputePath(nodes[pair.first].coords, nodes[pair.second].coords,
+                                                *inflatedMap, workspace);
+            g_sink += result.path.size();
+        }},
+        {"layer3/orca/vector/8", [&]() {
+            g_sink += static_cast<size_t>(orca.CalculateSafeVelocity(me, neighbors8, preferredVelocity).x > 0.0);
+        }},
+        {"layer3/orca/packed/8", [&]() {
+            g_sink += static_cast<size_t>(orca.CalculateSafeVelocity(me, packed8, preferredVelocity).x > 0.0);
+        }},
+        {"layer3/orca/packed/32", [&]() {
+            g_sink += static_cast<size_t>(orca.CalculateSafeVelocity(me, packed32, preferredVelocity).x > 0.0);
+        }},
+        {"layer3/GatherNeighbors/" + std::to_string(FLEET_SIZE) + "_robots", [&]() {
+            g_sink += KernelBenchmarkAccess::GatherAllNeighbors(fleet, scratch);
+        }},
+        {"api/EncodeTelemetry/" + std::to_string(FLEET_SIZE) + "_robots", [&]() {
+            g_sink += KernelBenchmarkAccess::EncodeTelemetry(telemetry).size();
+        }},
+        {"api/EncodeObstacles/" + std::to_string(OBSTACLE_COUNT), [&]() {
+            g_sink += KernelBenchmarkAccess::EncodeObstacles(obstacles).size();
+        }},
+        {"api/EncodePaths/" + std::to_string(FLEET_SIZE) + "_robots", [&]() {
+            g_sink += KernelBenchmarkAccess::EncodePaths(paths).size();
+        }},
+        {"api/TelemetryDeltaEncoder/" + std::to_string(FLEET_SIZE) + "_robots", [&]() {
+            records[frameTick % records.size()].x += 1;     // Something to encode besides keyframes
+            API::TelemetryBinaryFrame frame = deltaEncoder.Encode(++frameTick, 0, records.data(), records.size());
+            g_sink += frame.keyframe.size() + frame.delta.size();
+        }},
+    };
+
+    if (options.list) {
+        std::cout.rdbuf(stdoutBuffer);
+        for (const auto& benchmark : benchmarks) std::cout << benchmark.name << "\n";
+        return 0;
+    }
+
+    std::vector<BenchmarkResult> results;
+    for (const auto& benchmark : benchmarks) {
+        if (!Selected(benchmark.name, options)) continue;
+        std::cerr << "[Benchmark] " << benchmark.name << "...\n";
+        next = 0;
+        results.push_back(Measure(benchmark, options));
+    }
+
+    std::cout.rdbuf(stdoutBuffer);
+    std::cout << "Map: " << options.mapPath << " (" << nodes.size() << " NavMesh nodes), "
+              << options.repetitions << " repetitions of at least " << options.minTimeMs << " ms\n\n";
+    PrintTable(std::cout, results);
+
+    if (!options.jsonPath.empty()) {
+        std::ofstream json(options.jsonPath);
+        WriteJSON(json, results, options);
+        std::cerr << "[Benchmark] Wrote " << results.size() << " benchmarks to " << options.jsonPath << "\n";
+    }
+    return 0;
+}
@@ -8,6 +8,8 @@
 namespace Backend {
 namespace Layer1 {
 
+    class PackedGrid;
+
     class AbstractGrid {
     protected:
         int width;
@@ -29,6 +31,11 @@ namespace Layer1 {
 
         // The Pure Virtual Contract
         virtual bool IsAccessible(Backend::Common::Coordinates coords) const = 0;
+
+        // Optional fast path: grids backed by a PackedGrid expose it so bulk
+        // scans can test 64 cells per word. Returns nullptr when not available
+        // (e.g. grids whose reads must go through a snapshot).
+        virtual const PackedGrid* GetPackedGrid() const { return nullptr; }
     };
 
 } // namespace Layer1
@@ -0,0 +1,84 @@
+#ifndef BACKEND_LAYER1_CONGESTIONMAP_HH
+#define BACKEND_LAYER1_CONGESTIONMAP_HH
+
+#include <cstddef>
+#include <vector>
+
+namespace Backend {
+namespace Layer1 {
+
+    /**
+     * @brief Measured traversal delays per NavMesh node, decayed over time.
+     *
+     * The fleet reports every node a robot drove across with the time it
+     * took and the distance it covered there. What exceeds the free-flow
+     * time (distance / speed) is delay: queueing at an aisle mouth,
+     * yielding at a crossing, slowing down in a crowd. Delays and
+     * traversal counts are kept as exponentially decayed sums, so a
+     * hotspot fades with the configured half-life once robots stop
+     * queueing there.
+     *
+     * ComputePenalties turns the sums into NavMesh traversal penalties:
+     * the mean delay per traversal as the distance driven in that time at
+     * free-flow speed, i.e. in edge cost units. A node crossed only a few
+     * times is shrunk towards zero (PRIOR_TRAVERSALS), so one robot that
+     * waited once does not reroute the fleet.
+     *
+     * Not thread-safe: one thread records and computes.
+     */
+    class CongestionMap {
+    public:
+        static constexpr double DEFAULT_HALF_LIFE_SECONDS = 300.0;
+
+        // Free-flow traversals every penalty is averaged with
+        static constexpr float PRIOR_TRAVERSALS = 2.0f;
+
+        // Longest delay one traversal contributes (a robot parked by a
+        // fault is not congestion)
+        static constexpr float MAX_SAMPLE_DELAY_SECONDS = 60.0f;
+
+    private:
+        double freeSpeed;           // Pixels per second
+        double halfLifeSeconds;
+
+        // Per node: decayed sums of delay (seconds) and of traversals
+        std::vector<float> delaySum;
+        std::vector<float> traversalSum;
+
+        double decayedAt;           // Time the sums were last decayed to
+        size_t samples;             // Traversals recorded since construction
+
+    public:
+        /**
+         * @param nodeCount Nodes of the NavMesh the delays are kept for
+         * @param freeSpeedPixelsPerSecond Speed of an unhindered robot
+         * @param halfLife Seconds after which a delay counts half
+         */
+        CongestionMap(size_t nodeCount, double freeSpeedPixelsPerSecond,
+                      double halfLife = DEFAULT_HALF_LIFE_SECONDS);
+
+        // Robot crossed nodeId in seconds, covering distance pixels.
+        // Out-of-range node IDs are ignored.
+        void RecordTraversal(int nodeId, double seconds, double distance);
+
+        // Age the sums to time now (seconds, monotonic; earlier is a no-op)
+        void Decay(double now);
+
+        // Penalty per node in edge cost units, written to penalties (resized
+        // to the node count). Penalties below minPenalty are 0.
+        void ComputePenalties(std::vector<float>& penalties, float minPenalty = 0.0f) const;
+
+        // Mean delay per traversal of a node (seconds, shrunk like the penalty)
+        float GetDelaySeconds(int nodeId) const;
+
+        size_t GetNodeCount() const;
+        size_t GetSampleCount() const;
+
+        /// Bytes held by the per-node sums
+        size_t GetMemoryBytes() const;
+    };
+
+} // namespace Layer1
+} // namespace Backend
+
+#endif // BACKEND_LAYER1_CONGESTIONMAP_HH
@@ -3,32 +3,127 @@
 
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <cstdint>
 #include "AbstractGrid.hh"
 #include "StaticBitMap.hh"
+#include "PackedGrid.hh"
 #include "DynamicObstacle.hh"
 
 namespace Backend {
 namespace Layer1 {
 
-    class DynamicBitMap : public AbstractGrid {
+    /**
+     * @brief Static map plus painted dynamic obstacles, double-buffered.
+     *
+     * Two grids are kept: readers (Layer 3) always see the published front
+     * buffer, Update() (Layer 1 obstacle loop) writes into the back buffer and
+     * then publishes it with a single atomic store. Readers never take a lock:
+     * they pin the front buffer with an atomic reader count, and the writer
+     * waits for the back buffer's pins to drain before reusing it.
+     *
+     * Update() does not rebuild the grid. Each buffer remembers which obstacle
+     * footprints it has painted; only the bounding boxes of footprints that
+     * appeared or disappeared since then are reset from the static map, and
+     * the footprints touching them are repainted span by span.
+     */
+    class DynamicBitMap final : public AbstractGrid {
+    public:
+        /**
+         * @brief Pinned, immutable view of the published grid.
+         *
+         * Hold one for the duration of a multi-cell query (e.g. a whole path
+         * search) instead of calling IsAccessible per cell. Keep it short
+         * lived: the writer cannot reuse a pinned buffer.
+         */
+        class Snapshot {
+        private:
+            const DynamicBitMap* owner;
+            int bufferIndex;
+
+        public:
+            explicit Snapshot(const DynamicBitMap& map);
+            ~Snapshot();
+
+            Snapshot(const Snapshot&) = delete;
+            Snapshot& operator=(const Snapshot&) = delete;
+
+            const PackedGrid& GetGrid() const;
+            uint64_t GetVersion() const;
+            bool IsAccessible(Backend::Common::Coordinates coords) const;
+        };
+
     private:
-        std::vector<bool> activeGrid;
-        
-        // Critical for Layer 3 (Reading) vs Layer 1 (Writing) safety
-        mutable std::mutex mapMutex; 
+        // Half-open cell rectangle [x, x + w) x [y, y + h), clipped to the map
+        struct CellRect {
+            int x, y, w, h;
+
+            bool operator<(const CellRect& o) const;
+            bool operator==(const CellRect& o) const;
+            bool Intersects(const CellRect& o) const;
+        };
+
+        PackedGrid buffers[2];
+
+        // An obstacle as painted into a buffer, with its bounds clipped to the map
+        struct PaintedObstacle {
+            CellRect bounds;
+            DynamicObstacle obstacle;
+
+            bool operator<(const PaintedObstacle& o) const;
+            bool operator==(const PaintedObstacle& o) const;
+        };
+
+        // Obstacles currently painted into each buffer (sorted, unique)
+        std::vector<PaintedObstacle> paintedObstacles[2];
+
+        // Span scratch reused across Update() calls (guarded by writeMutex)
+        std::vector<RowSpan> spanScratch;
+
+        // Update() version each buffer holds
+        uint64_t bufferVersion[2];
+
+        // Index of the buffer readers should use
+        std::atomic<int> frontIndex;
+
+        // Pinned readers per buffer
+        mutable std::atomic<int> readerCount[2];
+
+        // Serialises writers (readers never touch it)
+        std::mutex writeMutex;
+
+        // Pin the current front buffer; returns its index
+        int AcquireFront() const;
+        void Release(int index) const;
+
+        // Reset a rectangle of buf to the static map
+        static void RestoreRect(PackedGrid& buf, const PackedGrid& source, const CellRect& r);
+
+        // Mark an obstacle's spans of buf as blocked (run writes, clipped to the grid)
+        static void PaintObstacle(PackedGrid& buf, const DynamicObstacle& obstacle,
+                                  std::vector<RowSpan>& spans);
 
     public:
         // Constructor copies the static map initially
         explicit DynamicBitMap(const StaticBitMap& source);
 
+        // Lock-free single-cell read of the published grid
         bool IsAccessible(Backend::Common::Coordinates coords) const override;
 
+        // Number of Update() calls published so far (0 = static map only)
+        uint64_t GetVersion() const;
+
         // The Update Loop
-        // We use the Static Map to "Reset" the canvas, then paint obstacles
+        // Resets only the regions whose obstacles changed, repaints them and
+        // publishes the result. source must be the map passed to the constructor.
         void Update(const std::vector<DynamicObstacle>& obstacles, const StaticBitMap& source);
+
+        /// Bytes held by both buffers (fixed at construction; the obstacle
+        /// lists are small and owned by the writer, so they are left out)
+        size_t GetMemoryBytes() const { return buffers[0].GetMemoryBytes() + buffers[1].GetMemoryBytes(); }
     };
 
 } // namespace Layer1
 } // namespace Backend
 
-#endif
\ No newline at end of file
+#endif
@@ -7,18 +7,84 @@
 namespace Backend {
 namespace Layer1 {
 
+    // Cells [x, x + length) of row y
+    struct RowSpan {
+        int y;
+        int x;
+        int length;
+    };
+
+    // Half-open cell rectangle [x, x + w) x [y, y + h)
+    struct CellBounds {
+        int x, y, w, h;
+    };
+
+    /**
+     * @brief Footprint of a moving obstacle (forklift, person, pallet).
+     *
+     * Either an axis-aligned size x size square (the original shape) or a
+     * polygon in cell units, e.g. a rotated rectangle. Footprints are
+     * rasterized to row spans so the dynamic grid can fill them with
+     * word-level run writes; a cell is covered when its centre lies inside
+     * the shape.
+     */
     class DynamicObstacle {
+    public:
+        // Polygon vertex in cell units ((0, 0) = top-left corner of cell (0, 0))
+        struct Vertex {
+            float x;
+            float y;
+        };
+
     private:
         int size; 
         Backend::Common::Coordinates top_left_anchor;
 
+        // Non-empty for polygon footprints
+        std::vector<Vertex> polygon;
+
+        // Covered cells' bounding box
+        CellBounds bounds;
+
+        explicit DynamicObstacle(std::vector<Vertex> vertices);
+
+        // Scanline fill of the polygon at cell-centre rows
+        void RasterizePolygon(std::vector<RowSpan>& out) const;
+
     public:
         DynamicObstacle(Backend::Common::Coordinates anchor, int s);
 
+        // Arbitrary simple polygon (even-odd rule)
+        static DynamicObstacle FromPolygon(std::vector<Vertex> vertices);
+
+        // Rectangle of halfLength x halfWidth around center, rotated by
+        // angleRadians (0 = length along +x)
+        static DynamicObstacle FromRotatedRect(Vertex center, float halfLength, float halfWidth,
+                                               float angleRadians);
+
+        // Covered cells as row spans (cleared first; reuse out across calls
+        // to avoid reallocating). Spans are not clipped to any map.
+        void GetSpans(std::vector<RowSpan>& out) const;
+
+        // Bounding box of the covered cells (w = h = 0 if nothing is covered)
+        const CellBounds& GetBounds() const;
+
+        bool IsPolygon() const;
+
+        // Every covered cell, row-major (allocates; prefer GetSpans)
         std::vector<Backend::Common::Coordinates> GetOccupiedCells() const;
+
+        // Square footprints: the size x size square starting at the anchor.
+        // Polygons report their bounding box corner and larger extent.
+        Backend::Common::Coordinates GetAnchor() const;
+        int GetSize() const;
+
+        // Same footprint (ordering is arbitrary but strict)
+        bool operator==(const DynamicObstacle& o) const;
+        bool operator<(const DynamicObstacle& o) const;
     };
 
 } // namespace Layer1
 } // namespace Backend
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,150 @@
+#ifndef BACKEND_LAYER1_GRAPHEXPORT_HH
+#define BACKEND_LAYER1_GRAPHEXPORT_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "NavMesh.hh"
+#include "PackedGrid.hh"
+
+namespace Backend {
+namespace Layer1 {
+
+    /**
+     * @brief Binary NavMesh graph and bitmap exports for visualization
+     *        consumers.
+     *
+     * ExportGraphToCSV and InflatedBitMap::ExportToFile format one node or
+     * one pixel at a time, and every reader parses the text back. These
+     * files hold the same data as flat arrays that a reader maps and
+     * indexes in place: GraphFile / BitmapFile below, numpy.frombuffer over
+     * an mmap, or JS typed arrays over the fetched buffer.
+     *
+     * Graph file (little-endian, every section 8-byte aligned, section
+     * offsets recorded in the header):
+     *   GraphFileHeader | int32 x[n] | int32 y[n] | uint32 offsets[n + 1] |
+     *   int32 targets[e] | float32 costs[e]
+     * The edges of node i are targets/costs[offsets[i] .. offsets[i + 1]).
+     *
+     * Bitmap file:
+     *   BitmapFileHeader | uint64 words[wordsPerRow * height]
+     * in the PackedGrid layout: row-major, bit (x & 63) of word x >> 6 of a
+     * row set = walkable.
+     *
+     * Bump FORMAT_VERSION whenever either layout changes.
+     */
+    class GraphExport {
+    public:
+        static constexpr std::uint32_t FORMAT_VERSION = 1;
+
+        static const char GRAPH_MAGIC[8];
+        static const char BITMAP_MAGIC[8];
+
+        /**
+         * @brief Write the graph of navMesh (finalized or not).
+         *
+         * Written next to path and renamed into place, so readers never map
+         * a partial file.
+         *
+         * @return true on success
+         */
+        static bool WriteGraph(const std::string& path, const NavMesh& navMesh);
+
+        /// Write grid as a bitmap file (same write protocol as WriteGraph)
+        static bool WriteBitmap(const std::string& path, const PackedGrid& grid);
+    };
+
+    struct GraphFileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t nodeCount;
+        std::uint64_t edgeCount;
+        std::uint64_t xOffset;          ///< Byte offsets of the sections
+        std::uint64_t yOffset;
+        std::uint64_t csrOffset;
+        std::uint64_t targetOffset;
+        std::uint64_t costOffset;
+    };
+
+    struct BitmapFileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::int32_t width;
+        std::int32_t height;
+        std::uint32_t wordsPerRow;
+        std::uint64_t wordOffset;       ///< Byte offset of the words
+    };
+
+    /**
+     * @brief Read-only mapping of a graph file; the arrays point into it.
+     *
+     * The header and section bounds are checked on open, the edge targets
+     * are not (the writer only emits valid IDs).
+     */
+    class GraphFile {
+    private:
+        void* data;
+        size_t size;
+        const GraphFileHeader* header;
+
+    public:
+        // Map and check the file. Throws std::runtime_error if it cannot be
+        // opened or is not a graph file of this FORMAT_VERSION.
+        explicit GraphFile(const std::string& path);
+        ~GraphFile();
+
+        GraphFile(const GraphFile&) = delete;
+        GraphFile& operator=(const GraphFile&) = delete;
+
+        size_t GetNodeCount() const { return static_cast<size_t>(header->nodeCount); }
+        size_t GetEdgeCount() const { return static_cast<size_t>(header->edgeCount); }
+
+        const std::int32_t* GetX() const { return Section<std::int32_t>(header->xOffset); }
+        const std::int32_t* GetY() const { return Section<std::int32_t>(header->yOffset); }
+        const std::uint32_t* GetOffsets() const { return Section<std::uint32_t>(header->csrOffset); }
+        const std::int32_t* GetTargets() const { return Section<std::int32_t>(header->targetOffset); }
+        const float* GetCosts() const { return Section<float>(header->costOffset); }
+
+    private:
+        template <typename T>
+        const T* Section(std::uint64_t offset) const {
+            return reinterpret_cast<const T*>(static_cast<const unsigned char*>(data) + offset);
+        }
+    };
+
+    /**
+     * @brief Read-only mapping of a bitmap file.
+     */
+    class BitmapFile {
+    private:
+        void* data;
+        size_t size;
+        const BitmapFileHeader* header;
+        const PackedGrid::Word* words;
+
+    public:
+        // Same contract as GraphFile
+        explicit BitmapFile(const std::string& path);
+        ~BitmapFile();
+
+        BitmapFile(const BitmapFile&) = delete;
+        BitmapFile& operator=(const BitmapFile&) = delete;
+
+        int GetWidth() const { return header->width; }
+        int GetHeight() const { return header->height; }
+
+        // Pointer to the first word of row y
+        const PackedGrid::Word* GetRow(int y) const {
+            return words + static_cast<size_t>(y) * header->wordsPerRow;
+        }
+
+        bool IsWalkable(int x, int y) const {
+            return (GetRow(y)[x >> 6] >> (x & 63)) & 1;
+        }
+    };
+
+} // namespace Layer1
+} // namespace Backend
+
+#endif // BACKEND_LAYER1_GRAPHEXPORT_HH
@@ -0,0 +1,208 @@
+#ifndef BACKEND_LAYER1_GRIDVIEW_HH
+#define BACKEND_LAYER1_GRIDVIEW_HH
+
+#include <cstdlib>
+#include <algorithm>
+#include <utility>
+#include "AbstractGrid.hh"
+#include "PackedGrid.hh"
+
+namespace Backend {
+namespace Layer1 {
+
+    // =========================================================================
+    // GRID VIEWS
+    // =========================================================================
+    // Small value types with one non-virtual interface, used as template
+    // parameters by the hot loops (tiling, line of sight, neighbour
+    // expansion) so each algorithm is instantiated per storage type:
+    //
+    //   int  Width() / Height()
+    //   bool InBounds(x, y)
+    //   bool IsFree(x, y)            - bounds checked
+    //   bool IsFreeUnchecked(x, y)   - caller guarantees bounds
+    //   bool IsRunFree(x, y, length) - out-of-bounds cells count as blocked
+    //
+    // AbstractGrid::IsAccessible stays the interface for cold paths.
+    // =========================================================================
+
+    /**
+     * @brief Direct view over a PackedGrid (StaticBitMap, InflatedBitMap,
+     *        DynamicBitMap snapshots). Everything inlines to word loads.
+     */
+    class PackedGridView {
+    private:
+        const PackedGrid* grid;
+
+    public:
+        explicit PackedGridView(const PackedGrid& g) : grid(&g) {}
+
+        int Width() const { return grid->GetWidth(); }
+        int Height() const { return grid->GetHeight(); }
+
+        bool InBounds(int x, int y) const {
+            return static_cast<unsigned>(x) < static_cast<unsigned>(grid->GetWidth()) &&
+                   static_cast<unsigned>(y) < static_cast<unsigned>(grid->GetHeight());
+        }
+
+        bool IsFreeUnchecked(int x, int y) const { return grid->Get(x, y); }
+        bool IsFree(int x, int y) const { return InBounds(x, y) && grid->Get(x, y); }
+        bool IsRunFree(int x, int y, int length) const { return grid->IsRunSet(x, y, length); }
+
+        // Cells [x, x + length) of row y, length >= 1, all in bounds: tested
+        // a word at a time without leaving the header
+        bool IsRunFreeUnchecked(int x, int y, int length) const {
+            using Word = PackedGrid::Word;
+            const Word* row = grid->GetRow(y);
+            const int lastX = x + length - 1;
+            int word = x >> 6;
+            const int lastWord = lastX >> 6;
+
+            Word mask = ~Word(0) << (x & 63);
+            for (; word < lastWord; ++word) {
+                if ((row[word] & mask) != mask) return false;
+                mask = ~Word(0);
+            }
+            mask &= ~Word(0) >> (63 - (lastX & 63));
+            return (row[word] & mask) == mask;
+        }
+    };
+
+    /**
+     * @brief Fallback view through the virtual AbstractGrid interface, for
+     *        grids without packed storage.
+     */
+    class AbstractGridView {
+    private:
+        const AbstractGrid* grid;
+        int width;
+        int height;
+
+    public:
+        explicit AbstractGridView(const AbstractGrid& g)
+            : grid(&g), width(g.GetDimensions().first), height(g.GetDimensions().second) {}
+
+        int Width() const { return width; }
+        int Height() const { return height; }
+
+        bool InBounds(int x, int y) const {
+            return static_cast<unsigned>(x) < static_cast<unsigned>(width) &&
+                   static_cast<unsigned>(y) < static_cast<unsigned>(height);
+        }
+
+        bool IsFreeUnchecked(int x, int y) const { return grid->IsAccessible({x, y}); }
+        bool IsFree(int x, int y) const { return InBounds(x, y) && grid->IsAccessible({x, y}); }
+
+        bool IsRunFree(int x, int y, int length) const {
+            if (length <= 0) return true;
+            if (x < 0 || y < 0 || y >= height || x + length > width) return false;
+            for (int i = x; i < x + length; ++i) {
+                if (!grid->IsAccessible({i, y})) return false;
+            }
+            return true;
+        }
+    };
+
+    /**
+     * @brief Call fn with the fastest view available for map.
+     *
+     * Dispatches once per call (not per cell): fn is instantiated for both
+     * view types and receives a PackedGridView when the grid exposes its
+     * packed storage.
+     */
+    template <typename Fn>
+    decltype(auto) VisitGridView(const AbstractGrid& map, Fn&& fn) {
+        if (const PackedGrid* packed = map.GetPackedGrid()) {
+            return std::forward<Fn>(fn)(PackedGridView(*packed));
+        }
+        return std::forward<Fn>(fn)(AbstractGridView(map));
+    }
+
+    // =========================================================================
+    // GENERIC ALGORITHMS
+    // =========================================================================
+
+    /**
+     * @brief True if every cell of the Bresenham segment (x1,y1)-(x2,y2),
+     *        endpoints included, is free.
+     *
+     * Bresenham never leaves the bounding box of its endpoints, so bounds
+     * are checked once up front and the walk uses unchecked reads.
+     * Horizontal segments are tested as a single run.
+     */
+    template <typename View>
+    bool HasLineOfSight(const View& view, int x1, int y1, int x2, int y2) {
+        if (!view.InBounds(x1, y1) || !view.InBounds(x2, y2)) return false;
+
+        if (y1 == y2) {
+            return view.IsRunFree(std::min(x1, x2), y1, std::abs(x2 - x1) + 1);
+        }
+
+        int dx = std::abs(x2 - x1);
+        int dy = std::abs(y2 - y1);
+        int sx = (x1 < x2) ? 1 : -1;
+        int sy = (y1 < y2) ? 1 : -1;
+        int err = dx - dy;
+
+        int x = x1;
+        int y = y1;
+
+        while (true) {
+            if (!view.IsFreeUnchecked(x, y)) return false;
+            if (x == x2 && y == y2) return true;
+
+            int e2 = 2 * err;
+            if (e2 > -dy) {
+                err -= dy;
+                x += sx;
+            }
+            if (e2 < dx) {
+                err += dx;
+                y += sy;
+            }
+        }
+    }
+
+    /**
+     * @brief HasLineOfSight on a packed grid, testing whole runs of cells.
+     *
+     * Visits exactly the cells of the generic Bresenham walk. A segment
+     * running closer to horizontal than to the diagonal crosses each row
+     * in a run of cells; the run length follows from the Bresenham error
+     * term, and the run is tested with masked word loads instead of cell
+     * by cell. Steeper segments visit about one cell per row and use the
+     * generic walk.
+     */
+    inline bool HasLineOfSight(const PackedGridView& view, int x1, int y1, int x2, int y2) {
+        const int dx = std::abs(x2 - x1);
+        const int dy = std::abs(y2 - y1);
+        if (dy == 0 || 2 * dy > dx) {
+            return HasLineOfSight<PackedGridView>(view, x1, y1, x2, y2);
+        }
+        if (!view.InBounds(x1, y1) || !view.InBounds(x2, y2)) return false;
+
+        // With dx >= 2 dy the walk steps x on every iteration (err stays
+        // >= 0) and also y when 2 * err < dx. A row therefore holds its entry
+        // cell plus one cell per x-only step, taken while 2 * err >= dx with
+        // err dropping by dy each time
+        const int sx = (x1 < x2) ? 1 : -1;
+        const int sy = (y1 < y2) ? 1 : -1;
+        int err = dx - dy;
+        int x = x1;
+
+        for (int y = y1; y != y2; y += sy) {
+            const int steps = (2 * err < dx) ? 0 : (2 * err - dx) / (2 * dy) + 1;
+            const int last = x + steps * sx;
+            if (!view.IsRunFreeUnchecked(std::min(x, last), y, steps + 1)) return false;
+
+            // Run, then the diagonal step into the next row
+            err += dx - dy - steps * dy;
+            x = last + sx;
+        }
+        return view.IsRunFreeUnchecked(std::min(x, x2), y2, std::abs(x2 - x) + 1);
+    }
+
+} // namespace Layer1
+} // namespace Backend
+
+#endif // BACKEND_LAYER1_GRIDVIEW_HH
@@ -0,0 +1,151 @@
+#ifndef BACKEND_LAYER1_HIERARCHICALNAVMESH_HH
+#define BACKEND_LAYER1_HIERARCHICALNAVMESH_HH
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "NavMesh.hh"
+
+namespace Backend {
+namespace Layer1 {
+
+    /**
+     * @brief Cluster abstraction over a NavMesh (HPA*-style).
+     *
+     * The map is cut into square clusters of clusterTiles x clusterTiles
+     * NavMesh tiles. The edges from one cluster into a neighbouring one
+     * form contiguous runs along their border; each run is crossed at its
+     * middle edge, or at both its end edges once it is LONG_RUN_EDGES
+     * long. The nodes of those crossing edges are the entrances, and for
+     * each cluster the shortest in-cluster cost between each pair of its
+     * entrances is precomputed. The abstract graph is then:
+     *   - entrance -> entrance of the same cluster (precomputed cost)
+     *   - entrance -> entrance across a cluster border (crossing edge)
+     *
+     * A query searches the start and goal clusters locally, then runs A*
+     * over the abstract graph (Euclidean distance to the goal, which no
+     * edge undercuts), so it touches two clusters plus a few entrances
+     * instead of the whole mesh. Paths must cross borders at the chosen
+     * edges, so costs can be slightly above the exact shortest path;
+     * every run keeps a crossing, so reachability is exact.
+     *
+     * Nodes blocked by the NavMesh overlay are treated as impassable and
+     * its traversal penalties are added to edge costs. After overlay
+     * changes, Refresh() re-selects the crossings around the open border
+     * edges and recomputes only the clusters whose nodes or entrances
+     * changed.
+     *
+     * The NavMesh must outlive this object and keep its node IDs.
+     */
+    class HierarchicalNavMesh {
+    public:
+        static constexpr float INFINITY_COST = std::numeric_limits<float>::max();
+        static constexpr int DEFAULT_CLUSTER_TILES = 16;
+        static constexpr int LONG_RUN_EDGES = 6;     ///< Border runs this long are crossed at both ends
+
+    private:
+        const NavMesh& mesh;
+
+        // Cluster grid (in pixels)
+        int clusterSizePixels;
+        int clusterOriginX;
+        int clusterOriginY;
+        int clusterCols;
+        int clusterRows;
+
+        // Per mesh node
+        std::vector<int> nodeCluster;        // Cluster index
+        std::vector<int> nodeLocalIndex;     // Index within its cluster
+        std::vector<int> nodeEntrance;       // Global entrance index, -1 if none
+
+        // Per cluster (CSR): member nodes and entrances
+        std::vector<int> clusterNodeOffsets;
+        std::vector<int> clusterNodes;
+        std::vector<int> clusterEntranceOffsets;
+        std::vector<int> entranceNodes;      // Global entrance index -> mesh node
+
+        // Per entrance (CSR): crossing edges to entrances of other clusters
+        // (edge cost without penalties)
+        std::vector<int> crossingOffsets;
+        std::vector<int> crossingTargets;
+        std::vector<float> crossingCosts;
+
+        // Per cluster: k x k in-cluster entrance costs, row-major,
+        // block starting at intraOffsets[cluster]
+        std::vector<size_t> intraOffsets;
+        std::vector<float> intraCosts;
+
+        // NavMesh overlay version the entrances and intra costs reflect
+        uint64_t builtVersion;
+
+        // Pick the crossing edges of every open border run and fill the
+        // entrance and crossing tables from them
+        void SelectEntrances();
+
+        // Size intraOffsets / intraCosts for the current entrances
+        void LayOutIntraCosts();
+
+        // Dijkstra from source restricted to its cluster.
+        // dist / parent are indexed by local node index (parent = mesh node ID, -1 at source)
+        void LocalSearch(int source, std::vector<float>& dist, std::vector<int>& parent) const;
+
+        // Recompute the entrance cost matrix of one cluster
+        void ComputeIntraCosts(int cluster);
+
+        // Cost of crossing edge i of entrance e (penalties included)
+        float CrossingCost(int e, int i) const;
+
+        // Dijkstra over the abstract graph seeded from source's entrances;
+        // fills dist over global entrance indices
+        void AbstractSearch(int source, std::vector<float>& dist) const;
+
+        // A* over the abstract graph from source to target, given the
+        // in-cluster costs to the target (LocalSearch from it). Returns the
+        // best cost, with the target-cluster entrance it enters by (-1 =
+        // inside the cluster) and the entrance parents when parent != nullptr.
+        float AbstractSearchTo(int source, int target, const std::vector<float>& toTarget,
+                               int& lastEntrance, std::vector<int>* parent) const;
+
+    public:
+        /**
+         * @brief Build the cluster abstraction.
+         *
+         * @param navMesh Mesh to abstract (tile size must be set)
+         * @param clusterTiles Cluster edge length in tiles
+         */
+        explicit HierarchicalNavMesh(const NavMesh& navMesh, int clusterTiles = DEFAULT_CLUSTER_TILES);
+
+        // --- Queries ---
+
+        // Shortest-path cost between two mesh nodes, INFINITY_COST if unreachable
+        float GetCost(int sourceId, int targetId) const;
+
+        // Costs from one node to many (one abstract search for all targets)
+        std::vector<float> GetCostsFrom(int sourceId, const std::vector<int>& targetIds) const;
+
+        // Shortest path as mesh node IDs (source first), empty if unreachable
+        std::vector<int> FindPath(int sourceId, int targetId) const;
+
+        // --- Dynamic Overlay ---
+
+        // True if the NavMesh overlay changed since the last build/Refresh
+        bool IsStale() const;
+
+        // Re-select the entrances and recompute the clusters whose nodes
+        // changed since the last build/Refresh or whose entrances moved.
+        // Returns the number of clusters recomputed.
+        int Refresh();
+
+        // --- Stats ---
+        int GetClusterCount() const { return clusterCols * clusterRows; }
+        int GetEntranceCount() const { return static_cast<int>(entranceNodes.size()); }
+        int GetClusterSizePixels() const { return clusterSizePixels; }
+
+        /// Bytes held by the cluster tables and entrance costs
+        size_t GetMemoryBytes() const;
+    };
+
+} // namespace Layer1
+} // namespace Backend
+
+#endif // BACKEND_LAYER1_HIERARCHICALNAVMESH_HH
@@ -1,9 +1,12 @@
 #ifndef BACKEND_LAYER1_INFLATEDBITMAP_HH
 #define BACKEND_LAYER1_INFLATEDBITMAP_HH
 
+#include <memory>
 #include <vector>
+#include <limits>
 #include "AbstractGrid.hh"
 #include "StaticBitMap.hh"
+#include "PackedGrid.hh"
 
 namespace Backend {
 namespace Layer1 {
@@ -21,15 +24,30 @@ namespace Layer1 {
      * 
      * The inflation is computed once at construction time using a Minkowski Sum approach:
      * For each obstacle cell, mark all cells within robot_radius as inaccessible.
+     * It is implemented as a threshold on an exact Euclidean distance transform,
+     * so the cost is linear in the map size regardless of the robot radius.
+     * The resulting clearance field (distance to the nearest obstacle) is kept
+     * and can be queried for other radii without recomputing. A map for
+     * another robot radius can be derived from it: the variant thresholds
+     * the shared field again and holds only its own packed grid.
      * 
      * This is the map that should be used by NavMeshGenerator to build the navigation graph.
      */
-    class InflatedBitMap : public AbstractGrid {
+    class InflatedBitMap final : public AbstractGrid {
     private:
-        // Flattened 2D grid: index = y * width + x
-        // false = inaccessible (obstacle or within robot radius of obstacle)
-        // true = accessible (safe for robot center)
-        std::vector<bool> inflatedGrid;
+        // Word-packed 2D grid, row-major
+        // clear bit = inaccessible (obstacle or within robot radius of obstacle)
+        // set bit = accessible (safe for robot center)
+        PackedGrid inflatedGrid;
+        
+        // Squared Euclidean distance (pixels^2) from each cell to the nearest
+        // obstacle in the source map, row-major. NO_OBSTACLE if the map has none,
+        // saturated beyond MAX_CLEARANCE_PIXELS.
+        // Shared with the maps derived for other radii.
+        std::shared_ptr<const std::vector<int>> clearanceSq;
+        
+        // Derived from another map: the clearance field is accounted to that one
+        bool derived;
         
         // The inflation radius in pixels (derived from robot physical radius)
         int inflationRadiusPixels;
@@ -37,7 +55,28 @@ namespace Layer1 {
         // Store the original static map reference for comparisons
         const StaticBitMap* sourceMap;
 
+        /**
+         * @brief Fill clearanceSq with an exact squared distance transform.
+         * 
+         * Separable two-pass algorithm (column pass, then lower envelope of
+         * parabolas per row), linear in the number of cells.
+         */
+        void ComputeClearanceField(const PackedGrid& sourceData);
+
+        // Threshold the clearance field into inflatedGrid (obstacles and the
+        // map border band inflated by inflationRadiusPixels)
+        void BuildInflatedGrid();
+
     public:
+        /// Clearance value for cells with no obstacle anywhere in the map
+        static constexpr int NO_OBSTACLE = std::numeric_limits<int>::max();
+
+        /// Largest clearance stored exactly: its square is the largest that
+        /// fits an int. Farther cells (very large maps at CENTIMETERS or
+        /// MILLIMETERS) saturate at NO_OBSTACLE - 1, which still clears
+        /// every radius up to this one.
+        static constexpr int MAX_CLEARANCE_PIXELS = 46340;
+
         /**
          * @brief Construct an InflatedBitMap from a StaticBitMap.
          * 
@@ -48,10 +87,39 @@ namespace Layer1 {
          * The constructor performs the inflation operation:
          * 1. Copy dimensions and resolution from source
          * 2. Calculate inflation radius in pixels
-         * 3. For each obstacle cell in source, mark surrounding cells as inaccessible
+         * 3. Compute the clearance field of the source map
+         * 4. Mark every cell with clearance <= radius (and the map border band)
+         *    as inaccessible
          */
         InflatedBitMap(const StaticBitMap& source, float robotRadiusMeters);
 
+        /**
+         * @brief Restore a previously computed inflation without recomputing it.
+         * 
+         * Used by MapCache. The grid and clearance field must have been
+         * produced from the same source map and radius.
+         * 
+         * @param source The static bitmap the inflation was computed from
+         * @param radiusPixels The inflation radius in pixels
+         * @param grid The inflated grid (same dimensions as source)
+         * @param clearance The squared clearance field (width * height values)
+         * @throws std::invalid_argument if the dimensions do not match source
+         */
+        InflatedBitMap(const StaticBitMap& source, int radiusPixels,
+                       PackedGrid grid, std::vector<int> clearance);
+
+        /**
+         * @brief Derive the inflation for another robot radius.
+         * 
+         * Shares base's clearance field (no distance transform, no copy) and
+         * builds only the packed grid, 1 bit per cell. base may be destroyed
+         * before the variant; both keep the field alive.
+         * 
+         * @param base Map of the same source, any radius
+         * @param radiusPixels The inflation radius in pixels
+         */
+        InflatedBitMap(const InflatedBitMap& base, int radiusPixels);
+
         /**
          * @brief Check if a coordinate is accessible in the inflated map.
          * 
@@ -64,6 +132,7 @@ namespace Layer1 {
          * @return true if accessible (safe for robot center), false otherwise
          */
         bool IsAccessible(Backend::Common::Coordinates coords) const override;
+        const PackedGrid* GetPackedGrid() const override;
 
         /**
          * @brief Get the inflation radius in pixels.
@@ -72,6 +141,50 @@ namespace Layer1 {
          */
         int GetInflationRadiusPixels() const;
 
+        /**
+         * @brief Inflation radius in pixels for a robot radius in meters.
+         * 
+         * Rounded up, as the constructor does (a robot must fit).
+         */
+        static int RadiusToPixels(float robotRadiusMeters, Backend::Common::Resolution res);
+
+        /**
+         * @brief Distance from a cell to the nearest static obstacle, in pixels.
+         * 
+         * Exact Euclidean distance between cell centres (0 on obstacles).
+         * The map border is not treated as an obstacle here.
+         * 
+         * @return Clearance in pixels, 0 if out of bounds, +infinity if the
+         *         map has no obstacles
+         */
+        float GetClearancePixels(Backend::Common::Coordinates coords) const;
+
+        /**
+         * @brief Distance from a cell to the nearest static obstacle, in meters.
+         */
+        float GetClearanceMeters(Backend::Common::Coordinates coords) const;
+
+        /**
+         * @brief Check if a robot of a different radius could stand at a cell.
+         * 
+         * Applies the same rule as the inflated grid (clearance above the
+         * radius, outside the border band) for an arbitrary radius, reusing
+         * the clearance field instead of building another InflatedBitMap.
+         * 
+         * @param coords The coordinates to check
+         * @param radiusPixels Robot radius in pixels
+         * @return true if a robot of that radius fits centred at coords
+         */
+        bool IsClearFor(Backend::Common::Coordinates coords, int radiusPixels) const;
+
+        /**
+         * @brief Get the raw clearance field.
+         * 
+         * @return Squared distances (pixels^2), row-major (index = y * width + x),
+         *         NO_OBSTACLE where no obstacle exists
+         */
+        const std::vector<int>& GetClearanceField() const;
+
         /**
          * @brief Get the raw inflated grid data.
          * 
@@ -80,7 +193,7 @@ namespace Layer1 {
          * 
          * @return Reference to the internal grid data
          */
-        const std::vector<bool>& GetRawData() const;
+        const PackedGrid& GetRawData() const;
 
         /**
          * @brief Get a reference to the original source map.
@@ -89,6 +202,12 @@ namespace Layer1 {
          */
         const StaticBitMap* GetSourceMap() const;
 
+        /// Bytes held by the inflated grid and the clearance field (the
+        /// grid only for a derived map, which shares the field)
+        size_t GetMemoryBytes() const {
+            return inflatedGrid.GetMemoryBytes() + (derived ? 0 : clearanceSq->capacity() * sizeof(int));
+        }
+
         /**
          * @brief Export the inflated map to a file for visualization.
          * 
@@ -0,0 +1,76 @@
+#ifndef BACKEND_LAYER1_INFLATIONVARIANTS_HH
+#define BACKEND_LAYER1_INFLATIONVARIANTS_HH
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "InflatedBitMap.hh"
+#include "NavMesh.hh"
+#include "NavMeshGenerator.hh"
+
+namespace Backend {
+namespace Layer1 {
+
+    /**
+     * @brief Inflated maps and NavMeshes for every robot radius of a fleet.
+     *
+     * A fleet of tuggers and wide pallet robots needs a configuration
+     * space per radius. All of them threshold the same clearance field, so
+     * the variants are derived from the base InflatedBitMap (1 bit per cell
+     * each, the field is shared) and tiled into a NavMesh with the base
+     * mesh's generator settings. A variant is built on first request and
+     * shared by every robot class of that radius; the base radius returns
+     * the base map and mesh.
+     *
+     * The variant meshes stand for where a robot of that radius fits
+     * (corridor routing, reachability); robots of all classes are still
+     * given goals by node ID of the base mesh.
+     *
+     * Thread-safe: Get* may be called concurrently, returned references
+     * stay valid for the lifetime of the object.
+     */
+    class InflationVariants {
+    private:
+        struct Variant {
+            std::unique_ptr<InflatedBitMap> map;
+            std::unique_ptr<NavMesh> mesh;
+        };
+
+        const InflatedBitMap& baseMap;
+        const NavMesh& baseMesh;
+        NavMeshGenerator generator;
+
+        mutable std::mutex mutex;
+        std::map<int, Variant> variants;    // Radius (pixels) -> variant
+
+        // Variant of radiusPixels, built under the lock on first request
+        const Variant& Acquire(int radiusPixels);
+
+    public:
+        /**
+         * @param base Inflation of the fleet's default radius
+         * @param mesh NavMesh generated from base
+         * @param meshGenerator Settings the variant meshes are generated with
+         */
+        InflationVariants(const InflatedBitMap& base, const NavMesh& mesh,
+                          const NavMeshGenerator& meshGenerator);
+
+        // Inflated map for robots of radiusPixels
+        const InflatedBitMap& GetMap(int radiusPixels);
+
+        // NavMesh of GetMap(radiusPixels)
+        const NavMesh& GetNavMesh(int radiusPixels);
+
+        // Variants built so far (the base radius excluded)
+        size_t GetVariantCount() const;
+
+        /// Bytes of the variant grids and meshes (the shared clearance field
+        /// and the base map are accounted to the base map)
+        size_t GetMemoryBytes() const;
+    };
+
+} // namespace Layer1
+} // namespace Backend
+
+#endif // BACKEND_LAYER1_INFLATIONVARIANTS_HH
@@ -0,0 +1,91 @@
+#ifndef BACKEND_LAYER1_MAPCACHE_HH
+#define BACKEND_LAYER1_MAPCACHE_HH
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "Resolution.hh"
+#include "StaticBitMap.hh"
+#include "InflatedBitMap.hh"
+#include "NavMesh.hh"
+
+namespace Backend {
+namespace Layer1 {
+
+    /**
+     * @brief Versioned binary snapshot of the Layer 1 static infrastructure.
+     *
+     * Parsing map_layout.txt, inflating it and tiling the NavMesh is only a
+     * function of the map file, the robot radius and the resolution, so the
+     * result is stored once in a binary artifact keyed by a hash of those
+     * inputs. On the next start the artifact is memory-mapped and the packed
+     * grids, the clearance field and the NavMesh CSR are copied straight out
+     * of the mapping - no text parsing, no distance transform, no tiling.
+     *
+     * File layout (native endianness, every section 8-byte aligned):
+     *   Header | static grid words | inflated grid words | clearance field |
+     *   nodes | CSR offsets | CSR edges | node regions | region cells
+     * (the region sections are empty for uniformly tiled meshes)
+     *
+     * A cache whose magic, format version, key or size does not match is
+     * ignored (Load returns false) and the caller rebuilds from source.
+     * Bump FORMAT_VERSION whenever the layout or the grid/NavMesh generation
+     * rules change, so stale artifacts are never reused.
+     */
+    class MapCache {
+    public:
+        static constexpr std::uint32_t FORMAT_VERSION = 3;
+
+        // Everything a cache artifact restores. inflatedMap points into
+        // staticMap, so keep them together (the unique_ptrs keep addresses
+        // stable when moved).
+        struct Contents {
+            std::unique_ptr<StaticBitMap> staticMap;
+            std::unique_ptr<InflatedBitMap> inflatedMap;
+            std::unique_ptr<NavMesh> navMesh;
+        };
+
+        /**
+         * @brief Hash the inputs that determine the cached artifacts.
+         *
+         * FNV-1a over the raw map file bytes, the robot radius, the
+         * resolution, the generator variant and FORMAT_VERSION.
+         *
+         * @param generatorVariant Caller-defined code for NavMeshGenerator
+         *                         settings that change the mesh (tiling mode)
+         * @throws std::runtime_error if the map file cannot be read
+         */
+        static std::uint64_t ComputeKey(const std::string& mapPath,
+                                        float robotRadiusMeters,
+                                        Backend::Common::Resolution res,
+                                        std::uint32_t generatorVariant = 0);
+
+        /**
+         * @brief Memory-map a cache file and restore its contents.
+         *
+         * @param cachePath Path of the cache artifact
+         * @param key Expected key (from ComputeKey)
+         * @param out Filled on success, untouched otherwise
+         * @return true if the cache existed, matched the key and was valid
+         */
+        static bool Load(const std::string& cachePath, std::uint64_t key, Contents& out);
+
+        /**
+         * @brief Write a cache artifact.
+         *
+         * The file is written next to cachePath and renamed into place, so a
+         * crash mid-write never leaves a truncated cache behind.
+         * The NavMesh must be finalized (see NavMesh::Finalize).
+         *
+         * @return true on success
+         */
+        static bool Save(const std::string& cachePath, std::uint64_t key,
+                         const StaticBitMap& staticMap,
+                         const InflatedBitMap& inflatedMap,
+                         const NavMesh& navMesh);
+    };
+
+} // namespace Layer1
+} // namespace Backend
+
+#endif // BACKEND_LAYER1_MAPCACHE_HH
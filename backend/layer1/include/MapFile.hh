@@ -0,0 +1,67 @@
+#ifndef BACKEND_LAYER1_MAPFILE_HH
+#define BACKEND_LAYER1_MAPFILE_HH
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "PackedGrid.hh"
+
+namespace Backend {
+namespace Layer1 {
+
+    /**
+     * @brief Read-only memory mapping of a text map layout with a row index.
+     *
+     * The file is mapped once and scanned once for line breaks, so both the
+     * dimensions and random access to any row come from a single read.
+     * Lines follow the StaticBitMap format: one row per non-empty line,
+     * '.' = walkable, anything else = obstacle. Width is the length of the
+     * first non-empty line; cells past the end of a shorter line read as
+     * walkable.
+     *
+     * Rows are decoded straight from the mapping, so the page cache (not the
+     * process) holds the text and untouched parts of the file are never read.
+     */
+    class MapFile {
+    private:
+        const char* data;
+        size_t size;
+        int width;
+        int height;
+
+        // Byte offset and length of every non-empty line, in row order
+        std::vector<size_t> rowOffsets;
+        std::vector<int> rowLengths;
+
+    public:
+        // Map and index the file. Throws std::runtime_error if it cannot be opened.
+        explicit MapFile(const std::string& filepath);
+        ~MapFile();
+
+        MapFile(const MapFile&) = delete;
+        MapFile& operator=(const MapFile&) = delete;
+
+        int GetWidth() const { return width; }
+        int GetHeight() const { return height; }
+
+        /**
+         * @brief Decode cells [x, x + count) of file row y into row outY of
+         *        out, starting at column 0.
+         *
+         * Cells are packed 64 at a time and written as whole words; count
+         * must not exceed out's width, and cells of the last word past count
+         * are set walkable.
+         *
+         * @return Number of obstacle characters decoded (cells past the end
+         *         of the line are walkable and not counted)
+         */
+        int DecodeRow(int y, int x, int count, PackedGrid& out, int outY) const;
+
+        // Number of characters row y actually provides (before padding)
+        int GetRowLength(int y) const { return rowLengths[y]; }
+    };
+
+} // namespace Layer1
+} // namespace Backend
+
+#endif // BACKEND_LAYER1_MAPFILE_HH
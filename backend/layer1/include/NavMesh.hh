@@ -3,7 +3,9 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 #include "Coordinates.hh" // From common
+#include "PackedGrid.hh"
 
 // Since Node and Edge are simple structs defined in Common, we use them here.
 // Ideally, create Node.hh and Edge.hh in Common, or define them here if specific to NavMesh.
@@ -27,28 +29,238 @@ namespace Common {
 
 namespace Layer1 {
 
+    /**
+     * @brief Read-only view over a contiguous run of edges.
+     * 
+     * Returned by NavMesh::GetNeighbors. Behaves like a span: range-for,
+     * size(), operator[]. Valid until the mesh is next modified.
+     */
+    class EdgeRange {
+    private:
+        const Backend::Common::Edge* first;
+        const Backend::Common::Edge* last;
+
+    public:
+        EdgeRange() : first(nullptr), last(nullptr) {}
+        EdgeRange(const Backend::Common::Edge* b, const Backend::Common::Edge* e) : first(b), last(e) {}
+
+        const Backend::Common::Edge* begin() const { return first; }
+        const Backend::Common::Edge* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+        const Backend::Common::Edge& operator[](size_t i) const { return first[i]; }
+    };
+
+    /**
+     * @brief Half-open pixel rectangle [x, x + w) x [y, y + h) covered by
+     *        one node of a region-merged mesh.
+     */
+    struct RegionRect {
+        int x, y, w, h;
+    };
+
     class NavMesh {
     private:
         // The Nodes (Polygons/Centroids)
         std::vector<Backend::Common::Node> allNodes;
 
         // Adjacency List: Index = Source Node ID, Value = List of Edges
+        // Build-time representation; emptied by Finalize()
         std::vector<std::vector<Backend::Common::Edge>> adjacencyList;
 
+        // Frozen CSR representation (valid when finalized):
+        // edges of node n are csrEdges[csrOffsets[n] .. csrOffsets[n + 1])
+        std::vector<int> csrOffsets;
+        std::vector<Backend::Common::Edge> csrEdges;
+        bool finalized;
+
+        // Convert CSR back to adjacency lists so the graph can be modified
+        void Thaw();
+
+        // Spatial index for GetNodeIdAt: a uniform grid of square buckets over
+        // the node bounding box, stored CSR-style. Bucket b holds node IDs
+        // bucketNodes[bucketOffsets[b] .. bucketOffsets[b + 1]).
+        int indexCellSize;
+        int indexOriginX;
+        int indexOriginY;
+        int indexCols;
+        int indexRows;
+        std::vector<int> bucketOffsets;
+        std::vector<int> bucketNodes;
+        bool spatialIndexValid;     // Cleared by any node modification
+
+        // Nearest node by brute force (used when the index is not built)
+        int FindNearestLinear(Backend::Common::Coordinates coords) const;
+
+        // Edge length of the square tile each node stands for, centered on
+        // its coordinates (0 = unknown, dynamic overlay disabled)
+        int tileSize;
+
+        // Dynamic overlay (empty = nothing blocked). Written by the obstacle
+        // loop; callers synchronise it like DynamicBitMap::Update.
+        std::vector<char> nodeBlocked;
+        std::vector<uint64_t> nodeChangeVersion;   // Version of last flip or penalty change
+        uint64_t changeVersion;                     // Bumped per effective update
+
+        // Traversal penalties of the overlay (empty = none), in edge cost
+        // units; penalizedNodes counts the nonzero ones
+        std::vector<float> nodePenalty;
+        size_t penalizedNodes;
+
+        // Drop the overlay when node IDs change
+        void ResetOverlay();
+
+        // Region geometry of meshes whose nodes stand for merged rectangles
+        // (empty = uniform tiles described by tileSize). nodeRegions[n] is
+        // the rectangle of node n; regionCellNode maps every regionCellSize
+        // square of the map (origin (0, 0), row-major) to the node whose
+        // rectangle contains it, or -1.
+        std::vector<RegionRect> nodeRegions;
+        int regionCellSize;
+        int regionCols;
+        int regionRows;
+        std::vector<int> regionCellNode;
+
+        // Drop the region geometry (node set changed)
+        void ClearRegions();
+
+        // Node whose region contains coords, -1 if none
+        int FindRegionAt(Backend::Common::Coordinates coords) const;
+
     public:
         // Constructor
         NavMesh();
 
         // --- Graph Accessors ---
         const std::vector<Backend::Common::Node>& GetAllNodes() const;
-        const std::vector<Backend::Common::Edge>& GetNeighbors(int nodeId) const;
+        // Outgoing edges of a node (empty range for invalid IDs)
+        EdgeRange GetNeighbors(int nodeId) const;
+        
+        // Total number of directed edges
+        size_t GetEdgeCount() const;
+
+        /// Bytes held by nodes, edges (either layout), spatial index,
+        /// overlay and region geometry
+        size_t GetMemoryBytes() const;
+
+        // --- Frozen Layout ---
+        
+        // Pack adjacency into contiguous CSR arrays and build the spatial
+        // index. Call once generation (and RemoveOrphanNodes) is done; graph
+        // traversal is then cache-friendly with no per-node allocations.
+        // spatialCellSize is forwarded to BuildSpatialIndex().
+        // Modifying the mesh afterwards is allowed but un-freezes it.
+        void Finalize(int spatialCellSize = 0);
+        bool IsFinalized() const;
+
+        // Replace the whole graph with an already-frozen CSR layout
+        // (e.g. restored from MapCache) and build the spatial index.
+        // offsets must have nodes.size() + 1 entries, ending at edges.size().
+        // Throws std::invalid_argument on inconsistent input.
+        void LoadFrozen(std::vector<Backend::Common::Node> nodes,
+                        std::vector<int> offsets,
+                        std::vector<Backend::Common::Edge> edges,
+                        int spatialCellSize = 0);
+
+        // Raw CSR arrays (empty unless finalized)
+        const std::vector<int>& GetCSROffsets() const;
+        const std::vector<Backend::Common::Edge>& GetCSREdges() const;
 
         // --- Geometry Lookups ---
         
         // Converts a world coordinate (x,y) to the nearest NavMesh Node ID.
-        // Returns -1 if not accessible or out of bounds.
+        // On region-merged meshes a coordinate inside a region resolves to
+        // that region's node; anything else falls back to nearest centroid.
+        // Ties go to the lowest node ID. Returns -1 if the mesh is empty.
+        // Constant time once BuildSpatialIndex() has run (ring search over
+        // buckets); falls back to a linear scan otherwise.
         int GetNodeIdAt(Backend::Common::Coordinates coords) const;
 
+        // Build the bucket index used by GetNodeIdAt.
+        // cellSize: bucket edge in pixels. Pass the tile size for uniformly
+        // tiled meshes (one node per bucket); 0 estimates it from the node
+        // density, which suits meshes with arbitrary node placement.
+        // Must be called again after nodes are added or removed.
+        void BuildSpatialIndex(int cellSize = 0);
+        bool HasSpatialIndex() const;
+        int GetSpatialIndexCellSize() const;
+
+        // --- Tile Geometry ---
+        
+        // Set by the generator: node n covers the tileSize x tileSize square
+        // starting at (coords.x - tileSize / 2, coords.y - tileSize / 2).
+        // Region-merged meshes set it to the base tile they were cut from.
+        void SetTileSize(int size);
+        int GetTileSize() const;
+
+        // --- Region Geometry (merged-rectangle meshes) ---
+        
+        // Set by the generator once all nodes exist: regions[n] is the
+        // rectangle node n covers, cellNodes (cols x rows cells of cellSize
+        // pixels, row-major from (0, 0)) the node covering each cell or -1.
+        // Node IDs are remapped by RemoveOrphanNodes; AddNode and LoadFrozen
+        // drop the regions. Throws std::invalid_argument on inconsistent input.
+        void SetRegions(std::vector<RegionRect> regions, int cellSize, int cols, int rows,
+                        std::vector<int> cellNodes);
+        bool HasRegions() const;
+        const std::vector<RegionRect>& GetNodeRegions() const;
+        const std::vector<int>& GetRegionCellNodes() const;
+        int GetRegionCellSize() const;
+        int GetRegionCols() const;
+        int GetRegionRows() const;
+
+        // --- Dynamic Overlay (blocked nodes / edges) ---
+        
+        // Reclassify only the nodes whose tile intersects the w x h rectangle
+        // at (x, y): a node is blocked while any cell of its tile is blocked
+        // in grid (typically a DynamicBitMap snapshot). On region-merged
+        // meshes the node's whole region rectangle is tested instead.
+        // Returns the IDs of nodes whose blocked state changed; if any did,
+        // the change version is incremented once and stamped on those nodes.
+        std::vector<int> UpdateBlockedRegion(int x, int y, int w, int h, const PackedGrid& grid);
+        
+        // Unblock every node (counts as one change if anything was blocked)
+        void ClearBlocked();
+        
+        bool IsNodeBlocked(int nodeId) const;
+        
+        // An edge is unusable while either endpoint is blocked
+        bool IsEdgeBlocked(int sourceId, int targetId) const;
+        
+        // Connected-component label per node: two nodes share a label iff
+        // a path joins them (edges taken as undirected, as the generator
+        // adds them). withOverlay: only edges between unblocked nodes
+        // count and blocked nodes are labelled -1. O(V + E).
+        std::vector<int> LabelComponents(bool withOverlay) const;
+        
+        // Monotonic counter of overlay changes (0 = never changed).
+        // Cache a result together with the version it was computed at; it
+        // stays valid while none of the nodes it used changed after that.
+        uint64_t GetChangeVersion() const;
+        
+        // Version at which a node's blocked state last changed (0 = never)
+        uint64_t GetNodeChangeVersion(int nodeId) const;
+        
+        // True if any of the given nodes changed after the given version
+        bool HasChangedSince(const std::vector<int>& nodeIds, uint64_t version) const;
+
+        // --- Traversal Penalties (part of the dynamic overlay) ---
+
+        // Replace the per-node penalties (edge cost units, negatives count
+        // as 0; one per node, or empty to clear them all), e.g. measured
+        // congestion. Only nodes whose penalty moves by more than tolerance
+        // take the new value; like UpdateBlockedRegion, they are stamped
+        // with one new change version and their IDs returned.
+        // Throws std::invalid_argument if the size does not match the nodes.
+        std::vector<int> UpdatePenalties(const std::vector<float>& penalties, float tolerance = 0.0f);
+
+        // Per-node penalties, or nullptr while no node has one. An edge
+        // costs its length plus half the penalty of each endpoint, so a
+        // path pays a node's penalty once and costs stay symmetric.
+        const float* GetNodePenalties() const;
+        float GetNodePenalty(int nodeId) const;
+        size_t GetPenalizedNodeCount() const;
+
         // --- Modifiers (Used by Generator) ---
         void AddNode(Backend::Common::Coordinates centroid);
         void AddEdge(int sourceId, int targetId, float cost);
@@ -18,12 +18,50 @@ namespace Layer1 {
      * 
      * For safety-critical pathfinding, use InflatedBitMap to ensure the
      * robot body will physically fit through all generated paths.
+     * 
+     * Tile and corridor clearance checks are answered in O(1) from a
+     * summed-area table of blocked pixels built once per call, and tile
+     * rows are classified in parallel across the available cores.
+     * 
+     * Two tiling modes are available:
+     * - UNIFORM_TILES: one node per accessible tile (default)
+     * - MERGED_RECTANGLES: accessible tiles are greedily merged into
+     *   rectangles of up to maxRegionTiles x maxRegionTiles tiles, one node
+     *   per rectangle at its centre. Rectangles sharing a border are joined
+     *   through the midpoint of the shared segment (cost = centre -> portal
+     *   -> centre). Open floor collapses to a few nodes; the mesh records
+     *   each node's rectangle so GetNodeIdAt and the dynamic overlay work
+     *   on regions.
      */
     class NavMeshGenerator {
     public:
+        enum class TilingMode {
+            UNIFORM_TILES,
+            MERGED_RECTANGLES
+        };
+
+        static constexpr int DEFAULT_MAX_REGION_TILES = 8;
+
+    private:
+        TilingMode mode;
+        int maxRegionTiles;
+
+    public:
+        NavMeshGenerator();
+
+        /**
+         * @brief Select how accessible tiles become nodes.
+         * 
+         * @param tilingMode Uniform tiles or merged rectangles
+         * @param maxTiles Rectangle edge limit in tiles (MERGED_RECTANGLES only).
+         *                 Bounds the detour error of centre-to-centre costs.
+         */
+        void SetTilingMode(TilingMode tilingMode, int maxTiles = DEFAULT_MAX_REGION_TILES);
+        TilingMode GetTilingMode() const;
+
         /**
          * @brief The main factory method.
-         * Reads the grid, performs uniform tiling, and populates the NavMesh object.
+         * Reads the grid, tiles it in the selected mode, and populates the NavMesh object.
          * 
          * @param map The input grid (any AbstractGrid derivative).
          *            Use InflatedBitMap for configuration space pathfinding.
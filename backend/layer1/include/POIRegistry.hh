@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
 #include <unordered_map>
 #include "Coordinates.hh"
 #include "NavMesh.hh"
@@ -42,6 +43,7 @@ namespace Layer1 {
         int nearestNodeId;                      // Cached NavMesh node ID (-1 if not mapped)
         float distanceToNode;                   // Distance from worldCoords to node center
         bool isActive;                          // Whether this POI is currently operational
+        int capacity;                           // Robots it serves at once (metadata "capacity", default 1)
         
         // Additional metadata
         std::map<std::string, std::string> metadata; // Custom key-value pairs (e.g., capacity, priority)
@@ -62,7 +64,8 @@ namespace Layer1 {
      * Key Features:
      * - Load POI definitions from JSON configuration
      * - Automatically map POIs to nearest valid NavMesh nodes
-     * - Provide O(1) lookup by type: GetNodesByType(POIType::CHARGING)
+     * - Provide O(result) lookup by type: GetNodesByType(POIType::CHARGING),
+     *   GetActiveNodesByType() (index maintained by SetPOIActive)
      * 
      * Usage:
      *   POIRegistry registry;
@@ -91,6 +94,37 @@ namespace Layer1 {
         
         // Whether POIs have been mapped to NavMesh
         bool isMappedToNavMesh;
+        
+        // Per-type node index, rebuilt after (re)mapping and kept current by
+        // SetPOIActive, so type queries cost O(result) instead of a scan
+        struct TypeNodeIndex {
+            // Unique nodes of mapped POIs, in POI order
+            std::vector<int> mappedNodes;
+            
+            // First active mapped POI at a node -> that node; iterating
+            // yields the unique active nodes in POI order
+            std::map<int, int> activeNodeByFirstPOI;
+            
+            // Node -> active mapped POI indices of this type at the node
+            std::unordered_map<int, std::set<int>> activePOIsAtNode;
+        };
+        std::unordered_map<POIType, TypeNodeIndex> nodeIndexByType;
+        
+        // Rebuild nodeIndexByType from allPOIs
+        void RebuildNodeIndex();
+        
+        // Move one mapped POI in or out of its type's active index
+        void UpdateActiveIndex(int poiIdx, bool active);
+        
+        // Nearest node (and distance) per POI, -1 for POIs failing the
+        // safety check (safetyMap may be null). Runs in parallel for large
+        // registries: the lookups only read the mesh and the map.
+        struct NodeLookup {
+            bool isSafe;
+            int nodeId;
+            float distance;
+        };
+        std::vector<NodeLookup> LookupNodes(const NavMesh& mesh, const AbstractGrid* safetyMap) const;
 
     public:
         /**
@@ -114,7 +148,7 @@ namespace Layer1 {
          *       "x": 100,
          *       "y": 50,
          *       "active": true,
-         *       "metadata": { "power_kw": "5.0" }
+         *       "metadata": { "power_kw": "5.0", "capacity": "2" }
          *     },
          *     ...
          *   ]
@@ -279,6 +313,16 @@ namespace Layer1 {
          */
         bool SetPOIActive(const std::string& id, bool active);
 
+        /**
+         * @brief Set a metadata entry of a POI.
+         * 
+         * "capacity" also sets PointOfInterest::capacity (a positive
+         * integer; anything else leaves it unchanged).
+         * 
+         * @return true if POI was found and updated
+         */
+        bool SetPOIMetadata(const std::string& id, const std::string& key, const std::string& value);
+
         /**
          * @brief Get only active POI nodes of a specific type.
          * 
@@ -301,6 +345,11 @@ namespace Layer1 {
          */
         size_t GetPOICountByType(POIType type) const;
 
+        /**
+         * @brief Estimated bytes held by the POIs and the lookup indices.
+         */
+        size_t GetMemoryBytes() const;
+
         /**
          * @brief Clear all POIs and mappings.
          */
@@ -0,0 +1,102 @@
+#ifndef BACKEND_LAYER1_POISCHEDULE_HH
+#define BACKEND_LAYER1_POISCHEDULE_HH
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "NavMesh.hh"
+#include "POIRegistry.hh"
+
+namespace Backend {
+namespace Layer1 {
+
+    /**
+     * @brief Time-slotted reservations of the PICKUP/DROPOFF POI nodes.
+     *
+     * A node serves as many robots at once as its active packet POIs have
+     * capacity (PointOfInterest::capacity). A robot about to set off for
+     * one reserves a slot of slotSeconds from its arrival time on; when the
+     * node is booked then, it gets the earliest later slot instead and is
+     * sent to the node's holding spot (a free mesh node about
+     * holdingDistance from it) until it is due. Robots then arrive one
+     * after the other instead of queueing in front of the station.
+     *
+     * A reservation lasts until the robot releases it on leaving, so a
+     * robot that stays longer than its slot keeps the node booked: other
+     * reservations are scheduled as if it left now.
+     *
+     * Charging nodes are not scheduled (a charger is held for hours, the
+     * charging policy decides who gets it). Not thread-safe: one thread
+     * reserves and releases.
+     */
+    class POISchedule {
+    public:
+        struct Reservation {
+            int robotId;
+            double start;           // Seconds
+            double end;
+        };
+
+    private:
+        struct Station {
+            int capacity;
+            int holdingNode;                    // -1 if the mesh has none
+            std::vector<Reservation> reservations;  // By start
+        };
+
+        double slotSeconds;
+        std::unordered_map<int, Station> stations;  // POI node -> station
+        std::unordered_map<int, int> nodeOfRobot;   // Robot -> node it holds a slot at
+
+    public:
+        /**
+         * @param registry Mapped registry; its active packet POIs are scheduled
+         * @param mesh The mesh the registry is mapped to
+         * @param slot Seconds a robot is expected to occupy a POI
+         * @param holdingDistance Pixels from a POI to its holding spot
+         */
+        POISchedule(const POIRegistry& registry, const NavMesh& mesh,
+                    double slot, float holdingDistance);
+
+        // Connected mesh node that is no POI node, about distance pixels
+        // from nodeId (-1 if none). O(nodes): for setup, or cached.
+        static int FindHoldingNode(const NavMesh& mesh, const POIRegistry& registry,
+                                   int nodeId, float distance);
+
+        bool IsScheduled(int nodeId) const;
+
+        // Robots served at once (0 for unscheduled nodes)
+        int GetCapacity(int nodeId) const;
+
+        // Where robots wait for their slot (-1 = none, wait in place)
+        int GetHoldingNode(int nodeId) const;
+
+        /**
+         * @brief Book the earliest slot at nodeId starting at or after arrival.
+         *
+         * Replaces any reservation the robot held (at this node or another).
+         * Unscheduled nodes are always free: returns arrival, books nothing.
+         *
+         * @param now Current time; reservations not released by then are
+         *            taken to end no earlier
+         * @return Start of the booked slot
+         */
+        double Reserve(int nodeId, int robotId, double arrival, double now);
+
+        // Drop the robot's reservation (it left the node or will not come)
+        void Release(int robotId);
+
+        // Node the robot holds a slot at, -1 if none
+        int GetReservedNode(int robotId) const;
+
+        size_t GetStationCount() const;
+        size_t GetReservationCount() const;
+
+        /// Bytes held by the stations and reservations
+        size_t GetMemoryBytes() const;
+    };
+
+} // namespace Layer1
+} // namespace Backend
+
+#endif // BACKEND_LAYER1_POISCHEDULE_HH
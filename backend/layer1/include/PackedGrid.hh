@@ -0,0 +1,131 @@
+#ifndef BACKEND_LAYER1_PACKEDGRID_HH
+#define BACKEND_LAYER1_PACKEDGRID_HH
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Backend {
+namespace Layer1 {
+
+    /**
+     * @brief Word-packed bitset storage shared by the bitmap grids.
+     *
+     * Cells are stored one bit each in 64-bit words, row-major, with every
+     * row padded up to a whole number of words. Bit (x & 63) of word (x >> 6)
+     * holds cell x, so the lowest bit is the leftmost cell of the word.
+     *
+     * A set bit means walkable (same convention as the old std::vector<bool>).
+     * Padding bits past the row width are always kept clear: they read as
+     * blocked and never show up in CountSet().
+     *
+     * Besides per-cell access the grid answers "is this run / rectangle fully
+     * walkable" one word at a time, which is what the NavMesh tiling, the
+     * inflation pass and line-of-sight checks actually need.
+     */
+    class PackedGrid {
+    public:
+        using Word = std::uint64_t;
+        static constexpr int BITS_PER_WORD = 64;
+
+    private:
+        int width;
+        int height;
+        int wordsPerRow;
+        std::vector<Word> words;
+
+        // Clear the unused high bits of the last word of every row
+        void ClearPadding();
+
+    public:
+        // Empty 0x0 grid
+        PackedGrid();
+
+        // w x h grid with every cell set to value
+        PackedGrid(int w, int h, bool value);
+
+        // w x h grid copied from raw words in the layout of GetWords()
+        // (row-major, GetWordsPerRow() words per row). Padding is re-cleared.
+        PackedGrid(int w, int h, const Word* data);
+
+        int GetWidth() const { return width; }
+        int GetHeight() const { return height; }
+        int GetWordsPerRow() const { return wordsPerRow; }
+
+        // =====================================================================
+        // PER-CELL ACCESS (unchecked - caller guarantees bounds)
+        // =====================================================================
+
+        bool Get(int x, int y) const {
+            const Word w = words[static_cast<size_t>(y) * wordsPerRow + (x >> 6)];
+            return (w >> (x & 63)) & 1u;
+        }
+
+        void Set(int x, int y, bool value) {
+            Word& w = words[static_cast<size_t>(y) * wordsPerRow + (x >> 6)];
+            const Word bit = Word(1) << (x & 63);
+            if (value) w |= bit;
+            else w &= ~bit;
+        }
+
+        // =====================================================================
+        // WORD ACCESS
+        // =====================================================================
+
+        // Pointer to the first of GetWordsPerRow() words of row y
+        const Word* GetRow(int y) const {
+            return words.data() + static_cast<size_t>(y) * wordsPerRow;
+        }
+
+        // Mask of the valid (non-padding) bits of word index wordIdx in a row
+        Word GetValidMask(int wordIdx) const;
+
+        // Overwrite word wordIdx of row y (padding bits are masked off)
+        void SetWord(int wordIdx, int y, Word value) {
+            words[static_cast<size_t>(y) * wordsPerRow + wordIdx] = value & GetValidMask(wordIdx);
+        }
+
+        // Whole backing store (GetWordsPerRow() * GetHeight() words)
+        const Word* GetWords() const { return words.data(); }
+        size_t GetWordCount() const { return words.size(); }
+
+        /// Bytes held by the word store
+        size_t GetMemoryBytes() const { return words.capacity() * sizeof(Word); }
+
+        // =====================================================================
+        // RUN / RECTANGLE QUERIES
+        // =====================================================================
+        // Out-of-bounds cells count as blocked, so any run or rectangle that
+        // leaves the grid is reported as not free. Empty ranges are free.
+
+        // True if cells [x, x + length) on row y are all set
+        bool IsRunSet(int x, int y, int length) const;
+
+        // True if every cell in the w x h rectangle at (x, y) is set
+        bool IsRectSet(int x, int y, int w, int h) const;
+
+        // =====================================================================
+        // BULK WRITES
+        // =====================================================================
+
+        // Set cells [x, x + length) on row y to value (clipped to the grid)
+        void SetRun(int x, int y, int length, bool value);
+
+        // Copy cells [x, x + length) on row y from src (same dimensions,
+        // clipped to the grid)
+        void CopyRun(const PackedGrid& src, int x, int y, int length);
+
+        // Set every cell to value
+        void Fill(bool value);
+
+        // Number of set cells
+        int CountSet() const;
+
+        bool operator==(const PackedGrid& other) const;
+        bool operator!=(const PackedGrid& other) const { return !(*this == other); }
+    };
+
+} // namespace Layer1
+} // namespace Backend
+
+#endif // BACKEND_LAYER1_PACKEDGRID_HH
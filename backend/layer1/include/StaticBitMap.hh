@@ -5,30 +5,44 @@
 #include <string>
 #include <utility>
 #include "AbstractGrid.hh"
+#include "PackedGrid.hh"
 
 namespace Backend {
 namespace Layer1 {
 
-    class StaticBitMap : public AbstractGrid {
+    class MapFile;
+
+    class StaticBitMap final : public AbstractGrid {
     private:
-        // Flattened 2D grid: index = y * width + x
-        std::vector<bool> gridData;
+        // Word-packed 2D grid, row-major (bit set = walkable)
+        PackedGrid gridData;
+
+        // Decode an already-mapped layout into gridData
+        void LoadFromMapFile(const MapFile& file);
 
     public:
         // Default constructor for manual sizing
         StaticBitMap(int w, int h, Backend::Common::Resolution res);
 
+        // Adopt an already-decoded grid (e.g. restored from MapCache)
+        StaticBitMap(PackedGrid grid, Backend::Common::Resolution res);
+
         // Implement the contract
         bool IsAccessible(Backend::Common::Coordinates coords) const override;
+        const PackedGrid* GetPackedGrid() const override;
 
         // Load map from file - reads dimensions from first line, then parses grid
         // '.' = walkable, '#' = obstacle
         void LoadFromFile(const std::string& filepath);
         
         // Used by DynamicBitMap to clone data
-        const std::vector<bool>& GetRawData() const;
+        const PackedGrid& GetRawData() const;
+
+        /// Bytes held by the grid
+        size_t GetMemoryBytes() const { return gridData.GetMemoryBytes(); }
         
         // Static factory to create from file with auto-detected dimensions
+        // (the file is mapped and scanned once)
         static StaticBitMap CreateFromFile(const std::string& filepath, 
                                            Backend::Common::Resolution res);
         
@@ -25,6 +25,7 @@
 #include "NavMeshGenerator.hh"
 #include "DynamicObstacleGenerator.hh"
 #include "POIRegistry.hh"
+#include "GraphExport.hh"
 
 // Common includes
 #include "Coordinates.hh"
@@ -138,6 +139,27 @@ int main() {
     }
     totalTests++;
 
+    try {
+        GraphExport::WriteBitmap("assets/inflated_map.navbits", inflatedMap.GetRawData());
+        BitmapFile bitmap("assets/inflated_map.navbits");
+        const PackedGrid& grid = inflatedMap.GetRawData();
+        bool same = bitmap.GetWidth() == grid.GetWidth() && bitmap.GetHeight() == grid.GetHeight();
+        for (int y = 0; same && y < bitmap.GetHeight(); ++y) {
+            for (int x = 0; same && x < bitmap.GetWidth(); ++x) {
+                same = bitmap.IsWalkable(x, y) == grid.Get(x, y);
+            }
+        }
+        if (same) {
+            PrintPass("Binary bitmap export maps back to the inflated grid");
+            passedTests++;
+        } else {
+            PrintFail("Binary bitmap export does not match the inflated grid");
+        }
+    } catch (const std::exception& e) {
+        PrintFail("Failed to export binary bitmap: " + std::string(e.what()));
+    }
+    totalTests++;
+
     // =========================================================================
     // TEST 3: NavMesh Graph Generation (using InflatedBitMap)
     // =========================================================================
@@ -186,6 +208,30 @@ int main() {
     }
     totalTests++;
 
+    try {
+        GraphExport::WriteGraph("assets/graph.navgraph", navMesh);
+        GraphFile graph("assets/graph.navgraph");
+        bool same = graph.GetNodeCount() == nodes.size() && graph.GetEdgeCount() == navMesh.GetEdgeCount();
+        for (size_t n = 0; same && n < graph.GetNodeCount(); ++n) {
+            EdgeRange neighbors = navMesh.GetNeighbors(static_cast<int>(n));
+            same = graph.GetX()[n] == nodes[n].coords.x && graph.GetY()[n] == nodes[n].coords.y
+                && graph.GetOffsets()[n + 1] - graph.GetOffsets()[n] == neighbors.size();
+            for (size_t i = 0; same && i < neighbors.size(); ++i) {
+                same = graph.GetTargets()[graph.GetOffsets()[n] + i] == neighbors[i].targetNodeId
+                    && graph.GetCosts()[graph.GetOffsets()[n] + i] == neighbors[i].cost;
+            }
+        }
+        if (same) {
+            PrintPass("Binary graph export maps back to the NavMesh CSR");
+            passedTests++;
+        } else {
+            PrintFail("Binary graph export does not match the NavMesh");
+        }
+    } catch (const std::exception& e) {
+        PrintFail("Failed to export binary graph: " + std::string(e.what()));
+    }
+    totalTests++;
+
     // =========================================================================
     // TEST 4: POI Registry (Semantic Overlay)
     // =========================================================================
@@ -0,0 +1,63 @@
+#include "CongestionMap.hh"
+#include "MemoryUsage.hh"
+#include <algorithm>
+#include <cmath>
+
+namespace Backend {
+namespace Layer1 {
+
+    CongestionMap::CongestionMap(size_t nodeCount, double freeSpeedPixelsPerSecond, double halfLife)
+        : freeSpeed(std::max(freeSpeedPixelsPerSecond, 1e-6)),
+          halfLifeSeconds(halfLife),
+          delaySum(nodeCount, 0.0f),
+          traversalSum(nodeCount, 0.0f),
+          decayedAt(0.0),
+          samples(0) {}
+
+    void CongestionMap::RecordTraversal(int nodeId, double seconds, double distance) {
+        if (nodeId < 0 || nodeId >= static_cast<int>(delaySum.size())) return;
+        double delay = seconds - distance / freeSpeed;
+        delaySum[nodeId] += static_cast<float>(std::clamp(delay, 0.0, double(MAX_SAMPLE_DELAY_SECONDS)));
+        traversalSum[nodeId] += 1.0f;
+        ++samples;
+    }
+
+    void CongestionMap::Decay(double now) {
+        if (now <= decayedAt) return;
+        if (halfLifeSeconds > 0.0) {
+            const float factor = static_cast<float>(std::exp2(-(now - decayedAt) / halfLifeSeconds));
+            for (size_t id = 0; id < delaySum.size(); ++id) {
+                delaySum[id] *= factor;
+                traversalSum[id] *= factor;
+            }
+        }
+        decayedAt = now;
+    }
+
+    void CongestionMap::ComputePenalties(std::vector<float>& penalties, float minPenalty) const {
+        penalties.resize(delaySum.size());
+        for (size_t id = 0; id < delaySum.size(); ++id) {
+            float penalty = static_cast<float>(freeSpeed) * GetDelaySeconds(static_cast<int>(id));
+            penalties[id] = penalty >= minPenalty ? penalty : 0.0f;
+        }
+    }
+
+    float CongestionMap::GetDelaySeconds(int nodeId) const {
+        if (nodeId < 0 || nodeId >= static_cast<int>(delaySum.size())) return 0.0f;
+        return delaySum[nodeId] / (traversalSum[nodeId] + PRIOR_TRAVERSALS);
+    }
+
+    size_t CongestionMap::GetNodeCount() const {
+        return delaySum.size();
+    }
+
+    size_t CongestionMap::GetSampleCount() const {
+        return samples;
+    }
+
+    size_t CongestionMap::GetMemoryBytes() const {
+        return Backend::Common::VectorBytes(delaySum) + Backend::Common::VectorBytes(traversalSum);
+    }
+
+} // namespace Layer1
+} // namespace Backend
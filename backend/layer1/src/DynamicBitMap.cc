@@ -1,38 +1,176 @@
 #include "DynamicBitMap.hh"
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <tuple>
 
 namespace Backend {
 namespace Layer1 {
 
+    // =========================================================================
+    // CELL RECT
+    // =========================================================================
+
+    bool DynamicBitMap::CellRect::operator<(const CellRect& o) const {
+        return std::tie(y, x, h, w) < std::tie(o.y, o.x, o.h, o.w);
+    }
+
+    bool DynamicBitMap::CellRect::operator==(const CellRect& o) const {
+        return x == o.x && y == o.y && w == o.w && h == o.h;
+    }
+
+    bool DynamicBitMap::CellRect::Intersects(const CellRect& o) const {
+        return x < o.x + o.w && o.x < x + w && y < o.y + o.h && o.y < y + h;
+    }
+
+    bool DynamicBitMap::PaintedObstacle::operator<(const PaintedObstacle& o) const {
+        if (!(bounds == o.bounds)) return bounds < o.bounds;
+        return obstacle < o.obstacle;
+    }
+
+    bool DynamicBitMap::PaintedObstacle::operator==(const PaintedObstacle& o) const {
+        return bounds == o.bounds && obstacle == o.obstacle;
+    }
+
+    // =========================================================================
+    // SNAPSHOT
+    // =========================================================================
+
+    DynamicBitMap::Snapshot::Snapshot(const DynamicBitMap& map)
+        : owner(&map), bufferIndex(map.AcquireFront()) {}
+
+    DynamicBitMap::Snapshot::~Snapshot() {
+        owner->Release(bufferIndex);
+    }
+
+    const PackedGrid& DynamicBitMap::Snapshot::GetGrid() const {
+        return owner->buffers[bufferIndex];
+    }
+
+    uint64_t DynamicBitMap::Snapshot::GetVersion() const {
+        return owner->bufferVersion[bufferIndex];
+    }
+
+    bool DynamicBitMap::Snapshot::IsAccessible(Backend::Common::Coordinates coords) const {
+        if (!owner->IsWithinBounds(coords)) return false;
+        return owner->buffers[bufferIndex].Get(coords.x, coords.y);
+    }
+
+    // =========================================================================
+    // DYNAMIC BITMAP
+    // =========================================================================
+
     DynamicBitMap::DynamicBitMap(const StaticBitMap& source)
-        : AbstractGrid(source.GetDimensions().first, source.GetDimensions().second, source.GetResolution()) {
-        
-        activeGrid = source.GetRawData();
+        : AbstractGrid(source.GetDimensions().first, source.GetDimensions().second, source.GetResolution()),
+          bufferVersion{0, 0},
+          frontIndex(0),
+          readerCount{{0}, {0}} {
+
+        buffers[0] = source.GetRawData();
+        buffers[1] = source.GetRawData();
     }
 
-    bool DynamicBitMap::IsAccessible(Backend::Common::Coordinates coords) const {
-        // LOCK READ
-        std::lock_guard<std::mutex> lock(mapMutex);
+    int DynamicBitMap::AcquireFront() const {
+        // Pin, then re-check: if the writer flipped in between, the pinned
+        // buffer may be the one it is about to overwrite, so try again.
+        while (true) {
+            int index = frontIndex.load();
+            readerCount[index].fetch_add(1);
+            if (frontIndex.load() == index) return index;
+            readerCount[index].fetch_sub(1);
+        }
+    }
+
+    void DynamicBitMap::Release(int index) const {
+        readerCount[index].fetch_sub(1);
+    }
 
+    bool DynamicBitMap::IsAccessible(Backend::Common::Coordinates coords) const {
         if (!IsWithinBounds(coords)) return false;
-        return activeGrid[coords.y * width + coords.x];
+
+        int index = AcquireFront();
+        bool accessible = buffers[index].Get(coords.x, coords.y);
+        Release(index);
+        return accessible;
+    }
+
+    uint64_t DynamicBitMap::GetVersion() const {
+        Snapshot snapshot(*this);
+        return snapshot.GetVersion();
+    }
+
+    void DynamicBitMap::RestoreRect(PackedGrid& buf, const PackedGrid& source, const CellRect& r) {
+        for (int y = r.y; y < r.y + r.h; ++y) {
+            buf.CopyRun(source, r.x, y, r.w);
+        }
+    }
+
+    void DynamicBitMap::PaintObstacle(PackedGrid& buf, const DynamicObstacle& obstacle,
+                                      std::vector<RowSpan>& spans) {
+        obstacle.GetSpans(spans);
+        for (const auto& span : spans) {
+            buf.SetRun(span.x, span.y, span.length, false);
+        }
     }
 
     void DynamicBitMap::Update(const std::vector<DynamicObstacle>& obstacles, const StaticBitMap& source) {
-        // LOCK WRITE
-        std::lock_guard<std::mutex> lock(mapMutex);
+        // LOCK WRITE (writers only - readers are never blocked)
+        std::lock_guard<std::mutex> lock(writeMutex);
+
+        const int back = 1 - frontIndex.load();
 
-        // 1. Wipe Canvas (Reset to Static)
-        activeGrid = source.GetRawData();
+        // Wait for readers still pinned on the buffer we are about to reuse
+        while (readerCount[back].load() != 0) {
+            std::this_thread::yield();
+        }
+
+        PackedGrid& grid = buffers[back];
+        const PackedGrid& staticData = source.GetRawData();
 
-        // 2. Paint Obstacles
+        // 1. Obstacle footprints with their bounds clipped to the map
+        std::vector<PaintedObstacle> newObstacles;
+        newObstacles.reserve(obstacles.size());
         for (const auto& obs : obstacles) {
-            for (const auto& cell : obs.GetOccupiedCells()) {
-                if (IsWithinBounds(cell)) {
-                    activeGrid[cell.y * width + cell.x] = false;
+            const CellBounds& b = obs.GetBounds();
+            int x0 = std::max(b.x, 0);
+            int y0 = std::max(b.y, 0);
+            int x1 = std::min(b.x + b.w, width);
+            int y1 = std::min(b.y + b.h, height);
+            if (x0 < x1 && y0 < y1) {
+                newObstacles.push_back({{x0, y0, x1 - x0, y1 - y0}, obs});
+            }
+        }
+        std::sort(newObstacles.begin(), newObstacles.end());
+        newObstacles.erase(std::unique(newObstacles.begin(), newObstacles.end()), newObstacles.end());
+
+        // 2. Dirty regions: bounds of obstacles painted in this buffer but
+        //    gone now, and of obstacles that are new
+        const std::vector<PaintedObstacle>& oldObstacles = paintedObstacles[back];
+        std::vector<PaintedObstacle> changed;
+        std::set_symmetric_difference(oldObstacles.begin(), oldObstacles.end(),
+                                      newObstacles.begin(), newObstacles.end(),
+                                      std::back_inserter(changed));
+
+        // 3. Wipe dirty regions (reset to static), then repaint every current
+        //    obstacle touching them (an unchanged neighbour may overlap)
+        for (const auto& d : changed) {
+            RestoreRect(grid, staticData, d.bounds);
+        }
+        for (const auto& p : newObstacles) {
+            for (const auto& d : changed) {
+                if (p.bounds.Intersects(d.bounds)) {
+                    PaintObstacle(grid, p.obstacle, spanScratch);
+                    break;
                 }
             }
         }
+
+        paintedObstacles[back] = std::move(newObstacles);
+        bufferVersion[back] = bufferVersion[1 - back] + 1;
+
+        // 4. Publish
+        frontIndex.store(back);
     }
 
 } // namespace Layer1
-} // namespace Backend
\ No newline at end of file
+} // namespace Backend
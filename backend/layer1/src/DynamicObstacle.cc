@@ -1,25 +1,152 @@
 #include "DynamicObstacle.hh"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <tuple>
+#include <utility>
 
 namespace Backend {
 namespace Layer1 {
 
     DynamicObstacle::DynamicObstacle(Backend::Common::Coordinates anchor, int s)
-        : size(s), top_left_anchor(anchor) {}
+        : size(s), top_left_anchor(anchor),
+          bounds{anchor.x, anchor.y, std::max(s, 0), std::max(s, 0)} {}
+
+    DynamicObstacle::DynamicObstacle(std::vector<Vertex> vertices)
+        : size(0), top_left_anchor{0, 0}, polygon(std::move(vertices)), bounds{0, 0, 0, 0} {
+        // Bounds are taken from the rasterized spans, so they are exact
+        std::vector<RowSpan> spans;
+        RasterizePolygon(spans);
+        if (spans.empty()) return;
+
+        int minX = INT_MAX, maxX = INT_MIN;
+        for (const auto& span : spans) {
+            minX = std::min(minX, span.x);
+            maxX = std::max(maxX, span.x + span.length);
+        }
+        bounds = {minX, spans.front().y, maxX - minX, spans.back().y + 1 - spans.front().y};
+        top_left_anchor = {bounds.x, bounds.y};
+        size = std::max(bounds.w, bounds.h);
+    }
+
+    DynamicObstacle DynamicObstacle::FromPolygon(std::vector<Vertex> vertices) {
+        return DynamicObstacle(std::move(vertices));
+    }
+
+    DynamicObstacle DynamicObstacle::FromRotatedRect(Vertex center, float halfLength, float halfWidth,
+                                                     float angleRadians) {
+        const float c = std::cos(angleRadians);
+        const float s = std::sin(angleRadians);
+        const float ax = c * halfLength, ay = s * halfLength;   // Along the length
+        const float bx = -s * halfWidth, by = c * halfWidth;    // Along the width
+
+        return DynamicObstacle(std::vector<Vertex>{
+            {center.x + ax + bx, center.y + ay + by},
+            {center.x - ax + bx, center.y - ay + by},
+            {center.x - ax - bx, center.y - ay - by},
+            {center.x + ax - bx, center.y + ay - by},
+        });
+    }
+
+    void DynamicObstacle::RasterizePolygon(std::vector<RowSpan>& out) const {
+        if (polygon.size() < 3) return;
+
+        float minY = polygon[0].y, maxY = polygon[0].y;
+        for (const auto& v : polygon) {
+            minY = std::min(minY, v.y);
+            maxY = std::max(maxY, v.y);
+        }
+
+        // Rows whose centre (y + 0.5) can be inside [minY, maxY)
+        const int firstRow = static_cast<int>(std::ceil(minY - 0.5f));
+        const int lastRow = static_cast<int>(std::ceil(maxY - 0.5f)) - 1;
+
+        std::vector<float> crossings;
+        const size_t n = polygon.size();
+        for (int row = firstRow; row <= lastRow; ++row) {
+            const float sy = row + 0.5f;
+
+            // Edges are half-open in y so shared vertices count once
+            crossings.clear();
+            for (size_t i = 0; i < n; ++i) {
+                const Vertex& a = polygon[i];
+                const Vertex& b = polygon[(i + 1) % n];
+                if ((a.y <= sy) != (b.y <= sy)) {
+                    crossings.push_back(a.x + (sy - a.y) * (b.x - a.x) / (b.y - a.y));
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            // Cells whose centre (x + 0.5) lies in [left, right)
+            for (size_t k = 0; k + 1 < crossings.size(); k += 2) {
+                const int x0 = static_cast<int>(std::ceil(crossings[k] - 0.5f));
+                const int x1 = static_cast<int>(std::ceil(crossings[k + 1] - 0.5f));
+                if (x1 > x0) out.push_back({row, x0, x1 - x0});
+            }
+        }
+    }
+
+    void DynamicObstacle::GetSpans(std::vector<RowSpan>& out) const {
+        out.clear();
+        if (!polygon.empty()) {
+            RasterizePolygon(out);
+            return;
+        }
+        for (int y = 0; y < bounds.h; ++y) {
+            out.push_back({bounds.y + y, bounds.x, bounds.w});
+        }
+    }
+
+    const CellBounds& DynamicObstacle::GetBounds() const {
+        return bounds;
+    }
+
+    bool DynamicObstacle::IsPolygon() const {
+        return !polygon.empty();
+    }
 
     std::vector<Backend::Common::Coordinates> DynamicObstacle::GetOccupiedCells() const {
+        std::vector<RowSpan> spans;
+        GetSpans(spans);
+
         std::vector<Backend::Common::Coordinates> cells;
-        cells.reserve(size * size); 
-
-        for (int x = 0; x < size; ++x) {
-            for (int y = 0; y < size; ++y) {
-                cells.push_back({
-                    top_left_anchor.x + x,
-                    top_left_anchor.y + y
-                });
+        for (const auto& span : spans) {
+            for (int x = span.x; x < span.x + span.length; ++x) {
+                cells.push_back({x, span.y});
             }
         }
         return cells;
     }
 
+    Backend::Common::Coordinates DynamicObstacle::GetAnchor() const {
+        return top_left_anchor;
+    }
+
+    int DynamicObstacle::GetSize() const {
+        return size;
+    }
+
+    bool DynamicObstacle::operator==(const DynamicObstacle& o) const {
+        if (size != o.size || top_left_anchor.x != o.top_left_anchor.x ||
+            top_left_anchor.y != o.top_left_anchor.y || polygon.size() != o.polygon.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < polygon.size(); ++i) {
+            if (polygon[i].x != o.polygon[i].x || polygon[i].y != o.polygon[i].y) return false;
+        }
+        return true;
+    }
+
+    bool DynamicObstacle::operator<(const DynamicObstacle& o) const {
+        if (std::tie(size, top_left_anchor.x, top_left_anchor.y) !=
+            std::tie(o.size, o.top_left_anchor.x, o.top_left_anchor.y)) {
+            return std::tie(size, top_left_anchor.x, top_left_anchor.y) <
+                   std::tie(o.size, o.top_left_anchor.x, o.top_left_anchor.y);
+        }
+        return std::lexicographical_compare(
+            polygon.begin(), polygon.end(), o.polygon.begin(), o.polygon.end(),
+            [](const Vertex& a, const Vertex& b) { return std::tie(a.x, a.y) < std::tie(b.x, b.y); });
+    }
+
 } // namespace Layer1
-} // namespace Backend
\ No newline at end of file
+} // namespace Backend
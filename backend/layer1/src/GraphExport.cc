@@ -0,0 +1,235 @@
+#include "GraphExport.hh"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Backend {
+namespace Layer1 {
+
+    // Consumers read the files as little-endian without converting
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+                  "GraphExport writes native arrays: add byte swapping for big-endian hosts");
+    static_assert(sizeof(GraphFileHeader) == 72 && sizeof(BitmapFileHeader) == 32,
+                  "Export header layout changed: bump GraphExport::FORMAT_VERSION");
+
+    const char GraphExport::GRAPH_MAGIC[8] = {'A', 'M', 'R', 'L', '1', 'G', 'R', 'F'};
+    const char GraphExport::BITMAP_MAGIC[8] = {'A', 'M', 'R', 'L', '1', 'B', 'M', 'P'};
+
+    namespace {
+
+        inline std::uint64_t AlignUp(std::uint64_t n) {
+            return (n + 7) & ~std::uint64_t(7);
+        }
+
+        void WritePadded(std::ofstream& file, const void* data, std::uint64_t bytes) {
+            static const char zeros[8] = {0};
+            if (bytes > 0) file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            file.write(zeros, static_cast<std::streamsize>(AlignUp(bytes) - bytes));
+        }
+
+        // Write the sections to path + ".tmp", then rename over path
+        template <typename WriteSections>
+        bool WriteAtomically(const std::string& path, const char* tag, WriteSections writeSections) {
+            std::error_code ec;
+            const std::filesystem::path target(path);
+            if (target.has_parent_path()) {
+                std::filesystem::create_directories(target.parent_path(), ec);
+            }
+
+            const std::string tmpPath = path + ".tmp";
+            {
+                std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) {
+                    std::cerr << "[" << tag << "] Failed to open for writing: " << tmpPath << std::endl;
+                    return false;
+                }
+                writeSections(file);
+                if (!file.good()) {
+                    std::cerr << "[" << tag << "] Write failed: " << tmpPath << std::endl;
+                    file.close();
+                    std::remove(tmpPath.c_str());
+                    return false;
+                }
+            }
+
+            if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+                std::cerr << "[" << tag << "] Failed to move export into place: " << path << std::endl;
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        // Read-only private mapping of a whole file. Throws on failure.
+        void* MapWholeFile(const std::string& path, size_t& size, const char* tag) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error(std::string("[") + tag + "] Failed to open file: " + path);
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+                ::close(fd);
+                throw std::runtime_error(std::string("[") + tag + "] Empty or unreadable file: " + path);
+            }
+
+            size = static_cast<size_t>(st.st_size);
+            void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);  // The mapping stays valid after close
+            if (mapped == MAP_FAILED) {
+                throw std::runtime_error(std::string("[") + tag + "] Failed to map file: " + path);
+            }
+            return mapped;
+        }
+
+        // True if [offset, offset + bytes) lies in a file of the given size
+        bool SectionFits(std::uint64_t offset, std::uint64_t bytes, size_t size) {
+            return offset % 8 == 0 && offset <= size && bytes <= size - offset;
+        }
+
+    } // namespace
+
+    // =========================================================================
+    // WRITE
+    // =========================================================================
+
+    bool GraphExport::WriteGraph(const std::string& path, const NavMesh& navMesh) {
+        const auto& nodes = navMesh.GetAllNodes();
+        const size_t nodeCount = nodes.size();
+
+        // Split nodes and edges into the file's arrays
+        std::vector<std::int32_t> xs(nodeCount);
+        std::vector<std::int32_t> ys(nodeCount);
+        std::vector<std::uint32_t> offsets(nodeCount + 1);
+        std::vector<std::int32_t> targets;
+        std::vector<float> costs;
+        targets.reserve(navMesh.GetEdgeCount());
+        costs.reserve(navMesh.GetEdgeCount());
+        for (size_t n = 0; n < nodeCount; ++n) {
+            xs[n] = nodes[n].coords.x;
+            ys[n] = nodes[n].coords.y;
+            offsets[n] = static_cast<std::uint32_t>(targets.size());
+            for (const auto& edge : navMesh.GetNeighbors(static_cast<int>(n))) {
+                targets.push_back(edge.targetNodeId);
+                costs.push_back(edge.cost);
+            }
+        }
+        offsets[nodeCount] = static_cast<std::uint32_t>(targets.size());
+
+        GraphFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, GRAPH_MAGIC, sizeof(GRAPH_MAGIC));
+        header.version = FORMAT_VERSION;
+        header.nodeCount = nodeCount;
+        header.edgeCount = targets.size();
+        header.xOffset = AlignUp(sizeof(GraphFileHeader));
+        header.yOffset = AlignUp(header.xOffset + nodeCount * sizeof(std::int32_t));
+        header.csrOffset = AlignUp(header.yOffset + nodeCount * sizeof(std::int32_t));
+        header.targetOffset = AlignUp(header.csrOffset + (nodeCount + 1) * sizeof(std::uint32_t));
+        header.costOffset = AlignUp(header.targetOffset + header.edgeCount * sizeof(std::int32_t));
+
+        bool written = WriteAtomically(path, "GraphExport", [&](std::ofstream& file) {
+            WritePadded(file, &header, sizeof(header));
+            WritePadded(file, xs.data(), nodeCount * sizeof(std::int32_t));
+            WritePadded(file, ys.data(), nodeCount * sizeof(std::int32_t));
+            WritePadded(file, offsets.data(), offsets.size() * sizeof(std::uint32_t));
+            WritePadded(file, targets.data(), targets.size() * sizeof(std::int32_t));
+            WritePadded(file, costs.data(), costs.size() * sizeof(float));
+        });
+        if (written) {
+            std::cout << "[GraphExport] Exported " << nodeCount << " nodes, " << header.edgeCount
+                      << " edges to: " << path << std::endl;
+        }
+        return written;
+    }
+
+    bool GraphExport::WriteBitmap(const std::string& path, const PackedGrid& grid) {
+        BitmapFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, BITMAP_MAGIC, sizeof(BITMAP_MAGIC));
+        header.version = FORMAT_VERSION;
+        header.width = grid.GetWidth();
+        header.height = grid.GetHeight();
+        header.wordsPerRow = static_cast<std::uint32_t>(grid.GetWordsPerRow());
+        header.wordOffset = AlignUp(sizeof(BitmapFileHeader));
+
+        bool written = WriteAtomically(path, "GraphExport", [&](std::ofstream& file) {
+            WritePadded(file, &header, sizeof(header));
+            WritePadded(file, grid.GetWords(), grid.GetWordCount() * sizeof(PackedGrid::Word));
+        });
+        if (written) {
+            std::cout << "[GraphExport] Exported " << header.width << "x" << header.height
+                      << " bitmap to: " << path << std::endl;
+        }
+        return written;
+    }
+
+    // =========================================================================
+    // READ (mmap)
+    // =========================================================================
+
+    GraphFile::GraphFile(const std::string& path)
+        : data(nullptr), size(0), header(nullptr) {
+        data = MapWholeFile(path, size, "GraphFile");
+        header = static_cast<const GraphFileHeader*>(data);
+
+        const std::uint64_t n = size >= sizeof(GraphFileHeader) ? header->nodeCount : 0;
+        const std::uint64_t e = size >= sizeof(GraphFileHeader) ? header->edgeCount : 0;
+        bool valid = size >= sizeof(GraphFileHeader)
+            && std::memcmp(header->magic, GraphExport::GRAPH_MAGIC, sizeof(header->magic)) == 0
+            && header->version == GraphExport::FORMAT_VERSION
+            && n < (std::uint64_t(1) << 31) && e < (std::uint64_t(1) << 32)
+            && SectionFits(header->xOffset, n * sizeof(std::int32_t), size)
+            && SectionFits(header->yOffset, n * sizeof(std::int32_t), size)
+            && SectionFits(header->csrOffset, (n + 1) * sizeof(std::uint32_t), size)
+            && SectionFits(header->targetOffset, e * sizeof(std::int32_t), size)
+            && SectionFits(header->costOffset, e * sizeof(float), size)
+            && GetOffsets()[n] == e;
+        if (!valid) {
+            ::munmap(data, size);
+            throw std::runtime_error("[GraphFile] Not a graph export (version "
+                                     + std::to_string(GraphExport::FORMAT_VERSION) + "): " + path);
+        }
+    }
+
+    GraphFile::~GraphFile() {
+        ::munmap(data, size);
+    }
+
+    BitmapFile::BitmapFile(const std::string& path)
+        : data(nullptr), size(0), header(nullptr), words(nullptr) {
+        data = MapWholeFile(path, size, "BitmapFile");
+        header = static_cast<const BitmapFileHeader*>(data);
+
+        bool valid = size >= sizeof(BitmapFileHeader)
+            && std::memcmp(header->magic, GraphExport::BITMAP_MAGIC, sizeof(header->magic)) == 0
+            && header->version == GraphExport::FORMAT_VERSION
+            && header->width >= 0 && header->height >= 0
+            && header->wordsPerRow == static_cast<std::uint32_t>((header->width + 63) / 64)
+            && SectionFits(header->wordOffset,
+                           std::uint64_t(header->wordsPerRow) * std::uint64_t(header->height)
+                               * sizeof(PackedGrid::Word),
+                           size);
+        if (!valid) {
+            ::munmap(data, size);
+            throw std::runtime_error("[BitmapFile] Not a bitmap export (version "
+                                     + std::to_string(GraphExport::FORMAT_VERSION) + "): " + path);
+        }
+        words = reinterpret_cast<const PackedGrid::Word*>(static_cast<const unsigned char*>(data)
+                                                          + header->wordOffset);
+    }
+
+    BitmapFile::~BitmapFile() {
+        ::munmap(data, size);
+    }
+
+} // namespace Layer1
+} // namespace Backend
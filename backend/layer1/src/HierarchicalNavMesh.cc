@@ -0,0 +1,587 @@
+#include "HierarchicalNavMesh.hh"
+#include "Trace.hh"
+#include "MemoryUsage.hh"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+namespace Backend {
+namespace Layer1 {
+
+    namespace {
+        using QueueEntry = std::pair<float, int>;
+        using MinQueue = std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>>;
+    }
+
+    // =========================================================================
+    // CONSTRUCTION
+    // =========================================================================
+
+    HierarchicalNavMesh::HierarchicalNavMesh(const NavMesh& navMesh, int clusterTiles)
+        : mesh(navMesh),
+          clusterSizePixels(1), clusterOriginX(0), clusterOriginY(0),
+          clusterCols(0), clusterRows(0),
+          builtVersion(navMesh.GetChangeVersion()) {
+
+        const auto& nodes = mesh.GetAllNodes();
+        const int numNodes = static_cast<int>(nodes.size());
+
+        int tileSize = mesh.GetTileSize();
+        if (tileSize <= 0) tileSize = std::max(1, mesh.GetSpatialIndexCellSize());
+        clusterSizePixels = std::max(1, clusterTiles) * tileSize;
+
+        if (numNodes == 0) {
+            clusterNodeOffsets.assign(1, 0);
+            clusterEntranceOffsets.assign(1, 0);
+            intraOffsets.assign(1, 0);
+            return;
+        }
+
+        // =====================================================================
+        // PHASE 1: Node -> cluster (uniform square grid over the node extent)
+        // =====================================================================
+        int minX = nodes[0].coords.x, maxX = minX;
+        int minY = nodes[0].coords.y, maxY = minY;
+        for (const auto& node : nodes) {
+            minX = std::min(minX, node.coords.x);
+            maxX = std::max(maxX, node.coords.x);
+            minY = std::min(minY, node.coords.y);
+            maxY = std::max(maxY, node.coords.y);
+        }
+        clusterOriginX = minX;
+        clusterOriginY = minY;
+        clusterCols = (maxX - minX) / clusterSizePixels + 1;
+        clusterRows = (maxY - minY) / clusterSizePixels + 1;
+        const int numClusters = clusterCols * clusterRows;
+
+        nodeCluster.resize(numNodes);
+        nodeLocalIndex.resize(numNodes);
+        clusterNodeOffsets.assign(numClusters + 1, 0);
+        for (int id = 0; id < numNodes; ++id) {
+            int cx = (nodes[id].coords.x - clusterOriginX) / clusterSizePixels;
+            int cy = (nodes[id].coords.y - clusterOriginY) / clusterSizePixels;
+            nodeCluster[id] = cy * clusterCols + cx;
+            nodeLocalIndex[id] = clusterNodeOffsets[nodeCluster[id] + 1]++;
+        }
+        for (int c = 0; c < numClusters; ++c) {
+            clusterNodeOffsets[c + 1] += clusterNodeOffsets[c];
+        }
+        clusterNodes.resize(numNodes);
+        for (int id = 0; id < numNodes; ++id) {
+            clusterNodes[clusterNodeOffsets[nodeCluster[id]] + nodeLocalIndex[id]] = id;
+        }
+
+        // =====================================================================
+        // PHASE 2: Entrances (crossing edges of the border runs)
+        // =====================================================================
+        SelectEntrances();
+
+        // =====================================================================
+        // PHASE 3: In-cluster entrance-to-entrance costs
+        // =====================================================================
+        LayOutIntraCosts();
+        for (int c = 0; c < numClusters; ++c) {
+            ComputeIntraCosts(c);
+        }
+
+        std::cout << "[HierarchicalNavMesh] " << numClusters << " clusters ("
+                  << clusterTiles << "x" << clusterTiles << " tiles), "
+                  << entranceNodes.size() << " entrances for " << numNodes << " nodes" << std::endl;
+    }
+
+    // =========================================================================
+    // ENTRANCES
+    // =========================================================================
+
+    void HierarchicalNavMesh::SelectEntrances() {
+        const auto& nodes = mesh.GetAllNodes();
+        const int numNodes = static_cast<int>(nodes.size());
+        const int numClusters = clusterCols * clusterRows;
+
+        // Open edges between clusters, each border pair once (from the
+        // lower cluster)
+        struct Crossing { int from; int to; float cost; };
+        std::vector<Crossing> crossings;
+        std::vector<int> nodeCrossingOffsets(numNodes + 1, 0);
+        std::vector<int> nodeCrossings;
+        for (int id = 0; id < numNodes; ++id) {
+            if (mesh.IsNodeBlocked(id)) continue;
+            for (const auto& edge : mesh.GetNeighbors(id)) {
+                int v = edge.targetNodeId;
+                if (nodeCluster[v] > nodeCluster[id] && !mesh.IsNodeBlocked(v)) {
+                    crossings.push_back({id, v, edge.cost});
+                    nodeCrossingOffsets[id + 1]++;
+                    nodeCrossingOffsets[v + 1]++;
+                }
+            }
+        }
+        for (int id = 0; id < numNodes; ++id) {
+            nodeCrossingOffsets[id + 1] += nodeCrossingOffsets[id];
+        }
+        nodeCrossings.resize(nodeCrossingOffsets[numNodes]);
+        {
+            std::vector<int> fill(nodeCrossingOffsets.begin(), nodeCrossingOffsets.end() - 1);
+            for (int i = 0; i < static_cast<int>(crossings.size()); ++i) {
+                nodeCrossings[fill[crossings[i].from]++] = i;
+                nodeCrossings[fill[crossings[i].to]++] = i;
+            }
+        }
+
+        // Runs: crossings between the same two clusters whose ends are the
+        // same or adjacent nodes on both sides, so a run can be walked
+        // along inside either cluster
+        std::vector<int> root(crossings.size());
+        std::iota(root.begin(), root.end(), 0);
+        std::function<int(int)> find = [&](int i) { return root[i] == i ? i : root[i] = find(root[i]); };
+        auto touches = [this](int a, int b) {
+            if (a == b) return true;
+            for (const auto& edge : mesh.GetNeighbors(a)) {
+                if (edge.targetNodeId == b) return true;
+            }
+            return false;
+        };
+        for (int i = 0; i < static_cast<int>(crossings.size()); ++i) {
+            const Crossing& ci = crossings[i];
+            auto joinAround = [&](int node) {
+                for (int k = nodeCrossingOffsets[node]; k < nodeCrossingOffsets[node + 1]; ++k) {
+                    int j = nodeCrossings[k];
+                    const Crossing& cj = crossings[j];
+                    if (j == i || nodeCluster[cj.from] != nodeCluster[ci.from] ||
+                        nodeCluster[cj.to] != nodeCluster[ci.to]) continue;
+                    if (touches(ci.from, cj.from) && touches(ci.to, cj.to)) root[find(j)] = find(i);
+                }
+            };
+            joinAround(ci.from);
+            for (const auto& edge : mesh.GetNeighbors(ci.from)) {
+                if (nodeCluster[edge.targetNodeId] == nodeCluster[ci.from]) joinAround(edge.targetNodeId);
+            }
+        }
+
+        // Cross each run at its middle, or at both ends when long, ordered
+        // along the border
+        std::vector<std::vector<int>> runs(crossings.size());
+        for (int i = 0; i < static_cast<int>(crossings.size()); ++i) {
+            runs[find(i)].push_back(i);
+        }
+        std::vector<int> chosen;
+        for (auto& run : runs) {
+            if (run.empty()) continue;
+            const bool sideBySide = nodeCluster[crossings[run[0]].to] == nodeCluster[crossings[run[0]].from] + 1;
+            auto along = [&](int i) {
+                const auto& at = nodes[crossings[i].from].coords;
+                return sideBySide ? at.y : at.x;
+            };
+            std::sort(run.begin(), run.end(), [&](int a, int b) { return along(a) < along(b); });
+            if (static_cast<int>(run.size()) >= LONG_RUN_EDGES) {
+                chosen.push_back(run.front());
+                chosen.push_back(run.back());
+            } else {
+                chosen.push_back(run[run.size() / 2]);
+            }
+        }
+
+        // Entrances grouped by cluster, then the crossings of each
+        nodeEntrance.assign(numNodes, -1);
+        std::vector<char> isEntrance(numNodes, 0);
+        for (int i : chosen) {
+            isEntrance[crossings[i].from] = 1;
+            isEntrance[crossings[i].to] = 1;
+        }
+        entranceNodes.clear();
+        clusterEntranceOffsets.assign(numClusters + 1, 0);
+        for (int c = 0; c < numClusters; ++c) {
+            for (int k = clusterNodeOffsets[c]; k < clusterNodeOffsets[c + 1]; ++k) {
+                int id = clusterNodes[k];
+                if (isEntrance[id]) {
+                    nodeEntrance[id] = static_cast<int>(entranceNodes.size());
+                    entranceNodes.push_back(id);
+                }
+            }
+            clusterEntranceOffsets[c + 1] = static_cast<int>(entranceNodes.size());
+        }
+
+        const int numEntrances = static_cast<int>(entranceNodes.size());
+        crossingOffsets.assign(numEntrances + 1, 0);
+        for (int i : chosen) {
+            crossingOffsets[nodeEntrance[crossings[i].from] + 1]++;
+            crossingOffsets[nodeEntrance[crossings[i].to] + 1]++;
+        }
+        for (int e = 0; e < numEntrances; ++e) {
+            crossingOffsets[e + 1] += crossingOffsets[e];
+        }
+        crossingTargets.resize(crossingOffsets[numEntrances]);
+        crossingCosts.resize(crossingOffsets[numEntrances]);
+        std::vector<int> fill(crossingOffsets.begin(), crossingOffsets.end() - 1);
+        for (int i : chosen) {
+            int from = nodeEntrance[crossings[i].from];
+            int to = nodeEntrance[crossings[i].to];
+            crossingTargets[fill[from]] = to;
+            crossingCosts[fill[from]++] = crossings[i].cost;
+            crossingTargets[fill[to]] = from;
+            crossingCosts[fill[to]++] = crossings[i].cost;
+        }
+    }
+
+    void HierarchicalNavMesh::LayOutIntraCosts() {
+        const int numClusters = clusterCols * clusterRows;
+        intraOffsets.assign(numClusters + 1, 0);
+        for (int c = 0; c < numClusters; ++c) {
+            size_t k = clusterEntranceOffsets[c + 1] - clusterEntranceOffsets[c];
+            intraOffsets[c + 1] = intraOffsets[c] + k * k;
+        }
+        intraCosts.assign(intraOffsets[numClusters], INFINITY_COST);
+    }
+
+    // =========================================================================
+    // LOCAL (IN-CLUSTER) SEARCH
+    // =========================================================================
+
+    void HierarchicalNavMesh::LocalSearch(int source, std::vector<float>& dist, std::vector<int>& parent) const {
+        const int cluster = nodeCluster[source];
+        const int base = clusterNodeOffsets[cluster];
+        const int size = clusterNodeOffsets[cluster + 1] - base;
+
+        dist.assign(size, INFINITY_COST);
+        parent.assign(size, -1);
+        if (mesh.IsNodeBlocked(source)) return;
+
+        MinQueue pq;
+        dist[nodeLocalIndex[source]] = 0.0f;
+        pq.push({0.0f, source});
+        const float* penalty = mesh.GetNodePenalties();
+
+        while (!pq.empty()) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (d > dist[nodeLocalIndex[u]]) continue;
+
+            for (const auto& edge : mesh.GetNeighbors(u)) {
+                int v = edge.targetNodeId;
+                if (nodeCluster[v] != cluster || mesh.IsNodeBlocked(v)) continue;
+                float nd = d + edge.cost;
+                if (penalty) nd += 0.5f * (penalty[u] + penalty[v]);
+                int lv = nodeLocalIndex[v];
+                if (nd < dist[lv]) {
+                    dist[lv] = nd;
+                    parent[lv] = u;
+                    pq.push({nd, v});
+                }
+            }
+        }
+    }
+
+    void HierarchicalNavMesh::ComputeIntraCosts(int cluster) {
+        const int first = clusterEntranceOffsets[cluster];
+        const int k = clusterEntranceOffsets[cluster + 1] - first;
+        float* block = intraCosts.data() + intraOffsets[cluster];
+
+        std::vector<float> dist;
+        std::vector<int> parent;
+        for (int i = 0; i < k; ++i) {
+            LocalSearch(entranceNodes[first + i], dist, parent);
+            for (int j = 0; j < k; ++j) {
+                block[i * k + j] = dist[nodeLocalIndex[entranceNodes[first + j]]];
+            }
+        }
+    }
+
+    // =========================================================================
+    // ABSTRACT SEARCH
+    // =========================================================================
+
+    float HierarchicalNavMesh::CrossingCost(int e, int i) const {
+        const float* penalty = mesh.GetNodePenalties();
+        if (!penalty) return crossingCosts[i];
+        return crossingCosts[i] + 0.5f * (penalty[entranceNodes[e]] + penalty[entranceNodes[crossingTargets[i]]]);
+    }
+
+    void HierarchicalNavMesh::AbstractSearch(int source, std::vector<float>& dist) const {
+        const int numEntrances = static_cast<int>(entranceNodes.size());
+        dist.assign(numEntrances, INFINITY_COST);
+
+        MinQueue pq;
+
+        // Seed with the in-cluster costs from source to its cluster's entrances
+        std::vector<float> local;
+        std::vector<int> localParent;
+        LocalSearch(source, local, localParent);
+        const int sourceCluster = nodeCluster[source];
+        for (int e = clusterEntranceOffsets[sourceCluster]; e < clusterEntranceOffsets[sourceCluster + 1]; ++e) {
+            float d = local[nodeLocalIndex[entranceNodes[e]]];
+            if (d < dist[e]) {
+                dist[e] = d;
+                pq.push({d, e});
+            }
+        }
+
+        while (!pq.empty()) {
+            auto [d, e] = pq.top();
+            pq.pop();
+            if (d > dist[e]) continue;
+
+            auto relax = [&](int target, float cost) {
+                float nd = d + cost;
+                if (nd < dist[target]) {
+                    dist[target] = nd;
+                    pq.push({nd, target});
+                }
+            };
+
+            // Intra-cluster: precomputed entrance costs
+            const int cluster = nodeCluster[entranceNodes[e]];
+            const int first = clusterEntranceOffsets[cluster];
+            const int k = clusterEntranceOffsets[cluster + 1] - first;
+            const float* row = intraCosts.data() + intraOffsets[cluster] + static_cast<size_t>(e - first) * k;
+            for (int j = 0; j < k; ++j) {
+                if (j != e - first && row[j] < INFINITY_COST) relax(first + j, row[j]);
+            }
+
+            // Inter-cluster: crossing edges
+            for (int i = crossingOffsets[e]; i < crossingOffsets[e + 1]; ++i) {
+                relax(crossingTargets[i], CrossingCost(e, i));
+            }
+        }
+    }
+
+    float HierarchicalNavMesh::AbstractSearchTo(int source, int target, const std::vector<float>& toTarget,
+                                                int& lastEntrance, std::vector<int>* parent) const {
+        const int numEntrances = static_cast<int>(entranceNodes.size());
+        const int targetCluster = nodeCluster[target];
+        const auto& nodes = mesh.GetAllNodes();
+        const auto& goal = nodes[target].coords;
+
+        // Edge costs are at least their straight length, so the distance
+        // to the target never overestimates
+        auto heuristic = [&](int e) {
+            const auto& at = nodes[entranceNodes[e]].coords;
+            return static_cast<float>(std::hypot(at.x - goal.x, at.y - goal.y));
+        };
+
+        lastEntrance = -1;
+        float best = (nodeCluster[source] == targetCluster) ? toTarget[nodeLocalIndex[source]] : INFINITY_COST;
+
+        std::vector<float> dist(numEntrances, INFINITY_COST);
+        std::vector<char> settled(numEntrances, 0);
+        if (parent) parent->assign(numEntrances, -1);
+        MinQueue pq;
+
+        std::vector<float> local;
+        std::vector<int> localParent;
+        LocalSearch(source, local, localParent);
+        const int sourceCluster = nodeCluster[source];
+        for (int e = clusterEntranceOffsets[sourceCluster]; e < clusterEntranceOffsets[sourceCluster + 1]; ++e) {
+            float d = local[nodeLocalIndex[entranceNodes[e]]];
+            if (d < dist[e]) {
+                dist[e] = d;
+                pq.push({d + heuristic(e), e});
+            }
+        }
+
+        while (!pq.empty()) {
+            auto [f, e] = pq.top();
+            pq.pop();
+            if (f >= best) break;
+            if (settled[e]) continue;
+            settled[e] = 1;
+
+            const float d = dist[e];
+            const int node = entranceNodes[e];
+            const int cluster = nodeCluster[node];
+            if (cluster == targetCluster) {
+                float last = toTarget[nodeLocalIndex[node]];
+                if (last < INFINITY_COST && d + last < best) {
+                    best = d + last;
+                    lastEntrance = e;
+                }
+            }
+
+            auto relax = [&](int next, float cost) {
+                float nd = d + cost;
+                if (!settled[next] && nd < dist[next]) {
+                    dist[next] = nd;
+                    if (parent) (*parent)[next] = e;
+                    pq.push({nd + heuristic(next), next});
+                }
+            };
+
+            const int first = clusterEntranceOffsets[cluster];
+            const int k = clusterEntranceOffsets[cluster + 1] - first;
+            const float* row = intraCosts.data() + intraOffsets[cluster] + static_cast<size_t>(e - first) * k;
+            for (int j = 0; j < k; ++j) {
+                if (j != e - first && row[j] < INFINITY_COST) relax(first + j, row[j]);
+            }
+            for (int i = crossingOffsets[e]; i < crossingOffsets[e + 1]; ++i) {
+                relax(crossingTargets[i], CrossingCost(e, i));
+            }
+        }
+        return best;
+    }
+
+    // =========================================================================
+    // QUERIES
+    // =========================================================================
+
+    float HierarchicalNavMesh::GetCost(int sourceId, int targetId) const {
+        const int numNodes = static_cast<int>(nodeCluster.size());
+        if (sourceId < 0 || sourceId >= numNodes || targetId < 0 || targetId >= numNodes) {
+            return INFINITY_COST;
+        }
+        if (mesh.IsNodeBlocked(sourceId) || mesh.IsNodeBlocked(targetId)) return INFINITY_COST;
+        if (sourceId == targetId) return 0.0f;
+
+        // Edges are symmetric, so a search from the target gives in-cluster
+        // costs *to* the target
+        std::vector<float> toTarget;
+        std::vector<int> localParent;
+        LocalSearch(targetId, toTarget, localParent);
+
+        int lastEntrance;
+        return AbstractSearchTo(sourceId, targetId, toTarget, lastEntrance, nullptr);
+    }
+
+    std::vector<float> HierarchicalNavMesh::GetCostsFrom(int sourceId, const std::vector<int>& targetIds) const {
+        std::vector<float> costs(targetIds.size(), INFINITY_COST);
+        const int numNodes = static_cast<int>(nodeCluster.size());
+        if (sourceId < 0 || sourceId >= numNodes || mesh.IsNodeBlocked(sourceId)) return costs;
+
+        std::vector<float> dist;
+        AbstractSearch(sourceId, dist);
+
+        std::vector<float> toTarget;
+        std::vector<int> localParent;
+        for (size_t i = 0; i < targetIds.size(); ++i) {
+            int targetId = targetIds[i];
+            if (targetId < 0 || targetId >= numNodes || mesh.IsNodeBlocked(targetId)) continue;
+            if (targetId == sourceId) {
+                costs[i] = 0.0f;
+                continue;
+            }
+
+            LocalSearch(targetId, toTarget, localParent);
+            const int targetCluster = nodeCluster[targetId];
+            float best = (nodeCluster[sourceId] == targetCluster)
+                ? toTarget[nodeLocalIndex[sourceId]]
+                : INFINITY_COST;
+            for (int e = clusterEntranceOffsets[targetCluster]; e < clusterEntranceOffsets[targetCluster + 1]; ++e) {
+                float last = toTarget[nodeLocalIndex[entranceNodes[e]]];
+                if (dist[e] < INFINITY_COST && last < INFINITY_COST) {
+                    best = std::min(best, dist[e] + last);
+                }
+            }
+            costs[i] = best;
+        }
+        return costs;
+    }
+
+    std::vector<int> HierarchicalNavMesh::FindPath(int sourceId, int targetId) const {
+        std::vector<int> path;
+        const int numNodes = static_cast<int>(nodeCluster.size());
+        if (sourceId < 0 || sourceId >= numNodes || targetId < 0 || targetId >= numNodes) return path;
+        if (mesh.IsNodeBlocked(sourceId) || mesh.IsNodeBlocked(targetId)) return path;
+        if (sourceId == targetId) return {sourceId};
+
+        std::vector<float> toTarget;
+        std::vector<int> localParent;
+        LocalSearch(targetId, toTarget, localParent);
+
+        int bestEntrance;  // -1 = stay inside the cluster
+        std::vector<int> parent;
+        float best = AbstractSearchTo(sourceId, targetId, toTarget, bestEntrance, &parent);
+        if (best == INFINITY_COST) return path;
+
+        // Abstract waypoints: source, entrance chain, target
+        std::vector<int> waypoints;
+        for (int e = bestEntrance; e >= 0; e = parent[e]) {
+            waypoints.push_back(entranceNodes[e]);
+        }
+        waypoints.push_back(sourceId);
+        std::reverse(waypoints.begin(), waypoints.end());
+        waypoints.push_back(targetId);
+
+        // Refine: consecutive waypoints are either the two ends of a border
+        // edge or two nodes of the same cluster joined by a local search
+        path.push_back(sourceId);
+        for (size_t i = 0; i + 1 < waypoints.size(); ++i) {
+            int from = waypoints[i];
+            int to = waypoints[i + 1];
+            if (from == to) continue;
+
+            if (nodeCluster[from] != nodeCluster[to]) {
+                path.push_back(to);
+                continue;
+            }
+
+            std::vector<float> segDist;
+            LocalSearch(from, segDist, localParent);
+            std::vector<int> segment;
+            for (int n = to; n != from && n >= 0; n = localParent[nodeLocalIndex[n]]) {
+                segment.push_back(n);
+            }
+            path.insert(path.end(), segment.rbegin(), segment.rend());
+        }
+        return path;
+    }
+
+    // =========================================================================
+    // DYNAMIC OVERLAY
+    // =========================================================================
+
+    size_t HierarchicalNavMesh::GetMemoryBytes() const {
+        using Backend::Common::VectorBytes;
+        return VectorBytes(nodeCluster) + VectorBytes(nodeLocalIndex) + VectorBytes(nodeEntrance) +
+               VectorBytes(clusterNodeOffsets) + VectorBytes(clusterNodes) +
+               VectorBytes(clusterEntranceOffsets) + VectorBytes(entranceNodes) +
+               VectorBytes(crossingOffsets) + VectorBytes(crossingTargets) + VectorBytes(crossingCosts) +
+               VectorBytes(intraOffsets) + VectorBytes(intraCosts);
+    }
+
+    bool HierarchicalNavMesh::IsStale() const {
+        return mesh.GetChangeVersion() != builtVersion;
+    }
+
+    int HierarchicalNavMesh::Refresh() {
+        if (!IsStale()) return 0;
+        TRACE_ZONE("HierarchyRefresh", "layer1");
+
+        const int numClusters = clusterCols * clusterRows;
+        std::vector<char> dirty(numClusters, 0);
+        for (int id = 0; id < static_cast<int>(nodeCluster.size()); ++id) {
+            if (mesh.GetNodeChangeVersion(id) > builtVersion) {
+                dirty[nodeCluster[id]] = 1;
+            }
+        }
+
+        // Blocking and unblocking splits and joins border runs, which moves
+        // entrances in the neighbouring clusters too: those recompute
+        // unless they kept the same entrances
+        const std::vector<int> oldEntranceNodes = std::move(entranceNodes);
+        const std::vector<int> oldEntranceOffsets = std::move(clusterEntranceOffsets);
+        const std::vector<size_t> oldIntraOffsets = std::move(intraOffsets);
+        const std::vector<float> oldIntraCosts = std::move(intraCosts);
+        SelectEntrances();
+        LayOutIntraCosts();
+
+        int recomputed = 0;
+        for (int c = 0; c < numClusters; ++c) {
+            const bool sameEntrances = std::equal(
+                entranceNodes.begin() + clusterEntranceOffsets[c], entranceNodes.begin() + clusterEntranceOffsets[c + 1],
+                oldEntranceNodes.begin() + oldEntranceOffsets[c], oldEntranceNodes.begin() + oldEntranceOffsets[c + 1]);
+            if (dirty[c] || !sameEntrances) {
+                ComputeIntraCosts(c);
+                ++recomputed;
+            } else {
+                std::copy(oldIntraCosts.begin() + oldIntraOffsets[c], oldIntraCosts.begin() + oldIntraOffsets[c + 1],
+                          intraCosts.begin() + intraOffsets[c]);
+            }
+        }
+
+        builtVersion = mesh.GetChangeVersion();
+        return recomputed;
+    }
+
+} // namespace Layer1
+} // namespace Backend
@@ -4,6 +4,9 @@
 #include <fstream>
 #include <cmath>
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
 
 namespace Backend {
 namespace Layer1 {
@@ -12,74 +15,83 @@ namespace Layer1 {
         : AbstractGrid(source.GetDimensions().first, 
                        source.GetDimensions().second, 
                        source.GetResolution()),
+          derived(false),
           sourceMap(&source) {
         
         // Calculate inflation radius in pixels based on resolution
         double metersPerPixel = Backend::Common::GetConversionFactorToMeters(resolution);
-        
-        // Convert robot radius from meters to pixels
-        // We use ceiling to be conservative (round up for safety)
-        inflationRadiusPixels = static_cast<int>(std::ceil(robotRadiusMeters / metersPerPixel));
+        inflationRadiusPixels = RadiusToPixels(robotRadiusMeters, resolution);
         
         std::cout << "[InflatedBitMap] Robot radius: " << robotRadiusMeters << "m" << std::endl;
         std::cout << "[InflatedBitMap] Resolution: " << metersPerPixel << " meters/pixel" << std::endl;
         std::cout << "[InflatedBitMap] Inflation radius: " << inflationRadiusPixels << " pixels" << std::endl;
 
-        // Initialize inflated grid - start as copy of source
-        const std::vector<bool>& sourceData = source.GetRawData();
-        inflatedGrid = sourceData;
+        const PackedGrid& sourceData = source.GetRawData();
+        const int originalWalkable = sourceData.CountSet();
 
         // =========================================================================
-        // INFLATION ALGORITHM (Minkowski Sum via Brushfire)
+        // INFLATION ALGORITHM (Minkowski Sum via Euclidean Distance Transform)
         // =========================================================================
-        // For each obstacle cell, mark all cells within inflationRadius as blocked.
+        // A cell is blocked if any obstacle lies within inflationRadius of it.
         // This is equivalent to performing a Minkowski sum of the obstacles with
         // a circular structuring element of radius = inflationRadiusPixels.
         //
-        // We use a simple but effective approach:
-        // 1. Iterate through all cells
-        // 2. For each obstacle cell, paint a circle of blocked cells around it
+        // Instead of stamping a circle around every obstacle (O(obstacles * r^2)),
+        // we compute the exact squared distance to the nearest obstacle for every
+        // cell in linear time, then threshold it:
+        //   accessible  <=>  clearance^2 > inflationRadius^2
+        // The clearance field is kept so other consumers can reuse it.
         // =========================================================================
 
-        int inflationCount = 0;
+        ComputeClearanceField(sourceData);
+        BuildInflatedGrid();
+
+        // Calculate and print statistics
+        const int inflatedWalkable = inflatedGrid.CountSet();
+
+        std::cout << "[InflatedBitMap] Original walkable cells: " << originalWalkable << std::endl;
+        std::cout << "[InflatedBitMap] Remaining walkable cells: " << inflatedWalkable << std::endl;
+        std::cout << "[InflatedBitMap] Reduction: " 
+                  << (100.0 * (originalWalkable - inflatedWalkable) / originalWalkable) 
+                  << "%" << std::endl;
+    }
+
+    InflatedBitMap::InflatedBitMap(const StaticBitMap& source, int radiusPixels,
+                                   PackedGrid grid, std::vector<int> clearance)
+        : AbstractGrid(source.GetDimensions().first,
+                       source.GetDimensions().second,
+                       source.GetResolution()),
+          inflatedGrid(std::move(grid)),
+          clearanceSq(std::make_shared<const std::vector<int>>(std::move(clearance))),
+          derived(false),
+          inflationRadiusPixels(radiusPixels),
+          sourceMap(&source) {
         
-        // Pre-compute the circular mask offsets for efficiency
-        // All (dx, dy) pairs where dx^2 + dy^2 <= inflationRadius^2
-        std::vector<std::pair<int, int>> circleOffsets;
-        for (int dy = -inflationRadiusPixels; dy <= inflationRadiusPixels; ++dy) {
-            for (int dx = -inflationRadiusPixels; dx <= inflationRadiusPixels; ++dx) {
-                // Use squared distance to avoid sqrt
-                int distSq = dx * dx + dy * dy;
-                int radiusSq = inflationRadiusPixels * inflationRadiusPixels;
-                
-                if (distSq <= radiusSq) {
-                    circleOffsets.push_back({dx, dy});
-                }
-            }
+        if (inflatedGrid.GetWidth() != width || inflatedGrid.GetHeight() != height ||
+            clearanceSq->size() != static_cast<size_t>(width) * height) {
+            throw std::invalid_argument("[InflatedBitMap] Restored data does not match source map dimensions");
         }
-        
-        std::cout << "[InflatedBitMap] Circle mask size: " << circleOffsets.size() << " pixels" << std::endl;
+    }
 
-        // Scan for obstacle cells and inflate
+    InflatedBitMap::InflatedBitMap(const InflatedBitMap& base, int radiusPixels)
+        : AbstractGrid(base.width, base.height, base.resolution),
+          clearanceSq(base.clearanceSq),
+          derived(true),
+          inflationRadiusPixels(std::max(0, radiusPixels)),
+          sourceMap(base.sourceMap) {
+        BuildInflatedGrid();
+    }
+
+    void InflatedBitMap::BuildInflatedGrid() {
+        // accessible  <=>  clearance^2 > inflationRadius^2
+        const std::vector<int>& field = *clearanceSq;
+        const long long radiusSq = static_cast<long long>(inflationRadiusPixels) * inflationRadiusPixels;
+        inflatedGrid = PackedGrid(width, height, false);
         for (int y = 0; y < height; ++y) {
+            const int* row = field.data() + static_cast<size_t>(y) * width;
             for (int x = 0; x < width; ++x) {
-                // Check if this is an obstacle in the original map
-                if (!sourceData[y * width + x]) {
-                    // This is an obstacle - inflate around it
-                    for (const auto& offset : circleOffsets) {
-                        int nx = x + offset.first;
-                        int ny = y + offset.second;
-                        
-                        // Bounds check
-                        if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
-                            int idx = ny * width + nx;
-                            // Only count if it was previously walkable
-                            if (inflatedGrid[idx]) {
-                                inflatedGrid[idx] = false;
-                                ++inflationCount;
-                            }
-                        }
-                    }
+                if (row[x] > radiusSq) {
+                    inflatedGrid.Set(x, y, true);
                 }
             }
         }
@@ -89,78 +101,160 @@ namespace Layer1 {
         // =========================================================================
         // Also inflate around the map edges - robot can't get too close to boundaries
         // =========================================================================
-        
-        int boundaryInflation = 0;
+        const int band = std::min({inflationRadiusPixels, width, height});
         
         // Top and bottom edges
-        for (int y = 0; y < inflationRadiusPixels && y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                int idx = y * width + x;
-                if (inflatedGrid[idx]) {
-                    inflatedGrid[idx] = false;
-                    ++boundaryInflation;
-                }
-                
-                // Bottom edge
-                int bottomY = height - 1 - y;
-                if (bottomY >= 0 && bottomY != y) {
-                    int bottomIdx = bottomY * width + x;
-                    if (inflatedGrid[bottomIdx]) {
-                        inflatedGrid[bottomIdx] = false;
-                        ++boundaryInflation;
-                    }
-                }
-            }
+        for (int y = 0; y < band; ++y) {
+            inflatedGrid.SetRun(0, y, width, false);
+            inflatedGrid.SetRun(0, height - 1 - y, width, false);
         }
         
-        // Left and right edges (excluding corners already done)
-        for (int x = 0; x < inflationRadiusPixels && x < width; ++x) {
-            for (int y = inflationRadiusPixels; y < height - inflationRadiusPixels; ++y) {
-                int idx = y * width + x;
-                if (inflatedGrid[idx]) {
-                    inflatedGrid[idx] = false;
-                    ++boundaryInflation;
+        // Left and right edges
+        for (int y = 0; y < height; ++y) {
+            inflatedGrid.SetRun(0, y, band, false);
+            inflatedGrid.SetRun(width - band, y, band, false);
+        }
+    }
+
+    bool InflatedBitMap::IsAccessible(Backend::Common::Coordinates coords) const {
+        if (!IsWithinBounds(coords)) return false;
+        return inflatedGrid.Get(coords.x, coords.y);
+    }
+
+    const PackedGrid* InflatedBitMap::GetPackedGrid() const {
+        return &inflatedGrid;
+    }
+
+    // =========================================================================
+    // CLEARANCE FIELD (Felzenszwalb-Huttenlocher separable distance transform)
+    // =========================================================================
+    // Pass 1 (columns): squared vertical distance to the nearest obstacle.
+    // Pass 2 (rows): lower envelope of the parabolas (x - q)^2 + f(q), which
+    // turns the column distances into exact squared Euclidean distances.
+    // Both passes are linear in the number of cells.
+    // =========================================================================
+    void InflatedBitMap::ComputeClearanceField(const PackedGrid& sourceData) {
+        const int INF = NO_OBSTACLE;
+        auto computed = std::make_shared<std::vector<int>>(static_cast<size_t>(width) * height, INF);
+        std::vector<int>& field = *computed;
+
+        // PASS 1: Columns
+        for (int x = 0; x < width; ++x) {
+            // Forward sweep: distance to the nearest obstacle above
+            int lastObstacle = -1;
+            for (int y = 0; y < height; ++y) {
+                size_t idx = static_cast<size_t>(y) * width + x;
+                if (!sourceData.Get(x, y)) {
+                    lastObstacle = y;
+                    field[idx] = 0;
+                } else if (lastObstacle >= 0) {
+                    field[idx] = y - lastObstacle;
                 }
-                
-                // Right edge
-                int rightX = width - 1 - x;
-                if (rightX >= 0 && rightX != x) {
-                    int rightIdx = y * width + rightX;
-                    if (inflatedGrid[rightIdx]) {
-                        inflatedGrid[rightIdx] = false;
-                        ++boundaryInflation;
-                    }
+            }
+            // Backward sweep: distance to the nearest obstacle below, then square
+            // (saturated, so tall maps cannot overflow)
+            int nextObstacle = -1;
+            for (int y = height - 1; y >= 0; --y) {
+                size_t idx = static_cast<size_t>(y) * width + x;
+                int& d = field[idx];
+                if (d == 0) {
+                    nextObstacle = y;
+                    continue;
+                }
+                if (nextObstacle >= 0) {
+                    d = std::min(d, nextObstacle - y);
+                }
+                if (d != INF) {
+                    d = d > MAX_CLEARANCE_PIXELS ? INF - 1 : d * d;
                 }
             }
         }
 
-        // Calculate and print statistics
-        int originalWalkable = 0;
-        int inflatedWalkable = 0;
-        for (int i = 0; i < width * height; ++i) {
-            if (sourceData[i]) ++originalWalkable;
-            if (inflatedGrid[i]) ++inflatedWalkable;
+        // PASS 2: Rows
+        std::vector<int> f(width);          // Column distances for this row
+        std::vector<int> v(width);          // Parabola vertices in the envelope
+        std::vector<double> z(width + 1);   // Boundaries between parabolas
+        const double infinity = std::numeric_limits<double>::infinity();
+
+        for (int y = 0; y < height; ++y) {
+            int* row = field.data() + static_cast<size_t>(y) * width;
+            std::copy(row, row + width, f.begin());
+
+            // Build the lower envelope (columns without obstacles contribute nothing)
+            int k = -1;
+            for (int q = 0; q < width; ++q) {
+                if (f[q] == INF) continue;
+
+                double s = -infinity;
+                while (k >= 0) {
+                    int p = v[k];
+                    s = ((static_cast<double>(f[q]) + static_cast<double>(q) * q) -
+                         (static_cast<double>(f[p]) + static_cast<double>(p) * p)) /
+                        (2.0 * (q - p));
+                    if (s > z[k]) break;
+                    --k;
+                }
+
+                ++k;
+                v[k] = q;
+                z[k] = (k == 0) ? -infinity : s;
+                z[k + 1] = infinity;
+            }
+
+            if (k < 0) continue;  // No obstacle reachable from this row
+
+            // Sample the envelope
+            k = 0;
+            for (int q = 0; q < width; ++q) {
+                while (z[k + 1] < q) ++k;
+                long long dx = q - v[k];
+                long long d = dx * dx + f[v[k]];
+                row[q] = static_cast<int>(std::min<long long>(d, INF - 1));
+            }
         }
+        clearanceSq = std::move(computed);
+    }
 
-        std::cout << "[InflatedBitMap] Original walkable cells: " << originalWalkable << std::endl;
-        std::cout << "[InflatedBitMap] Cells closed by obstacle inflation: " << inflationCount << std::endl;
-        std::cout << "[InflatedBitMap] Cells closed by boundary inflation: " << boundaryInflation << std::endl;
-        std::cout << "[InflatedBitMap] Remaining walkable cells: " << inflatedWalkable << std::endl;
-        std::cout << "[InflatedBitMap] Reduction: " 
-                  << (100.0 * (originalWalkable - inflatedWalkable) / originalWalkable) 
-                  << "%" << std::endl;
+    float InflatedBitMap::GetClearancePixels(Backend::Common::Coordinates coords) const {
+        if (!IsWithinBounds(coords)) return 0.0f;
+        int d = (*clearanceSq)[static_cast<size_t>(coords.y) * width + coords.x];
+        if (d == NO_OBSTACLE) return std::numeric_limits<float>::infinity();
+        return std::sqrt(static_cast<float>(d));
     }
 
-    bool InflatedBitMap::IsAccessible(Backend::Common::Coordinates coords) const {
+    float InflatedBitMap::GetClearanceMeters(Backend::Common::Coordinates coords) const {
+        double metersPerPixel = Backend::Common::GetConversionFactorToMeters(resolution);
+        return static_cast<float>(GetClearancePixels(coords) * metersPerPixel);
+    }
+
+    bool InflatedBitMap::IsClearFor(Backend::Common::Coordinates coords, int radiusPixels) const {
         if (!IsWithinBounds(coords)) return false;
-        return inflatedGrid[coords.y * width + coords.x];
+
+        // Same boundary band the inflated grid applies
+        if (coords.x < radiusPixels || coords.x >= width - radiusPixels ||
+            coords.y < radiusPixels || coords.y >= height - radiusPixels) {
+            return false;
+        }
+
+        long long radiusSq = static_cast<long long>(radiusPixels) * radiusPixels;
+        return (*clearanceSq)[static_cast<size_t>(coords.y) * width + coords.x] > radiusSq;
+    }
+
+    const std::vector<int>& InflatedBitMap::GetClearanceField() const {
+        return *clearanceSq;
+    }
+
+    int InflatedBitMap::RadiusToPixels(float robotRadiusMeters, Backend::Common::Resolution res) {
+        // We use ceiling to be conservative (round up for safety)
+        double metersPerPixel = Backend::Common::GetConversionFactorToMeters(res);
+        return static_cast<int>(std::ceil(robotRadiusMeters / metersPerPixel));
     }
 
     int InflatedBitMap::GetInflationRadiusPixels() const {
         return inflationRadiusPixels;
     }
 
-    const std::vector<bool>& InflatedBitMap::GetRawData() const {
+    const PackedGrid& InflatedBitMap::GetRawData() const {
         return inflatedGrid;
     }
 
@@ -181,7 +275,7 @@ namespace Layer1 {
         // Write grid data
         for (int y = 0; y < height; ++y) {
             for (int x = 0; x < width; ++x) {
-                file << (inflatedGrid[y * width + x] ? '.' : '#');
+                file << (inflatedGrid.Get(x, y) ? '.' : '#');
             }
             file << "\n";
         }
@@ -191,16 +285,8 @@ namespace Layer1 {
     }
 
     void InflatedBitMap::GetInflationStats(int& originalWalkable, int& inflatedWalkable, int& closedCells) const {
-        originalWalkable = 0;
-        inflatedWalkable = 0;
-        
-        const std::vector<bool>& sourceData = sourceMap->GetRawData();
-        
-        for (int i = 0; i < width * height; ++i) {
-            if (sourceData[i]) ++originalWalkable;
-            if (inflatedGrid[i]) ++inflatedWalkable;
-        }
-        
+        originalWalkable = sourceMap->GetRawData().CountSet();
+        inflatedWalkable = inflatedGrid.CountSet();
         closedCells = originalWalkable - inflatedWalkable;
     }
 
@@ -0,0 +1,53 @@
+#include "InflationVariants.hh"
+#include <iostream>
+
+namespace Backend {
+namespace Layer1 {
+
+    InflationVariants::InflationVariants(const InflatedBitMap& base, const NavMesh& mesh,
+                                         const NavMeshGenerator& meshGenerator)
+        : baseMap(base), baseMesh(mesh), generator(meshGenerator) {}
+
+    const InflationVariants::Variant& InflationVariants::Acquire(int radiusPixels) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = variants.find(radiusPixels);
+        if (it != variants.end()) return it->second;
+
+        Variant variant;
+        variant.map = std::make_unique<InflatedBitMap>(baseMap, radiusPixels);
+        variant.mesh = std::make_unique<NavMesh>();
+        NavMeshGenerator meshGenerator = generator;
+        meshGenerator.ComputeRecast(*variant.map, *variant.mesh);
+        std::cout << "[InflationVariants] Radius " << radiusPixels << " px: "
+                  << variant.mesh->GetAllNodes().size() << " nodes (base "
+                  << baseMap.GetInflationRadiusPixels() << " px: "
+                  << baseMesh.GetAllNodes().size() << ")" << std::endl;
+        return variants.emplace(radiusPixels, std::move(variant)).first->second;
+    }
+
+    const InflatedBitMap& InflationVariants::GetMap(int radiusPixels) {
+        if (radiusPixels == baseMap.GetInflationRadiusPixels()) return baseMap;
+        return *Acquire(radiusPixels).map;
+    }
+
+    const NavMesh& InflationVariants::GetNavMesh(int radiusPixels) {
+        if (radiusPixels == baseMap.GetInflationRadiusPixels()) return baseMesh;
+        return *Acquire(radiusPixels).mesh;
+    }
+
+    size_t InflationVariants::GetVariantCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return variants.size();
+    }
+
+    size_t InflationVariants::GetMemoryBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t bytes = 0;
+        for (const auto& entry : variants) {
+            bytes += entry.second.map->GetMemoryBytes() + entry.second.mesh->GetMemoryBytes();
+        }
+        return bytes;
+    }
+
+} // namespace Layer1
+} // namespace Backend
@@ -0,0 +1,348 @@
+#include "MapCache.hh"
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Backend {
+namespace Layer1 {
+
+    // Node and Edge are copied to/from the file as raw bytes
+    static_assert(std::is_trivially_copyable<Backend::Common::Node>::value &&
+                  sizeof(Backend::Common::Node) == 2 * sizeof(std::int32_t),
+                  "Node layout changed: bump MapCache::FORMAT_VERSION");
+    static_assert(std::is_trivially_copyable<Backend::Common::Edge>::value &&
+                  sizeof(Backend::Common::Edge) == sizeof(std::int32_t) + sizeof(float),
+                  "Edge layout changed: bump MapCache::FORMAT_VERSION");
+    static_assert(std::is_trivially_copyable<RegionRect>::value &&
+                  sizeof(RegionRect) == 4 * sizeof(std::int32_t),
+                  "RegionRect layout changed: bump MapCache::FORMAT_VERSION");
+
+    namespace {
+
+        const char CACHE_MAGIC[8] = {'A', 'M', 'R', 'L', '1', 'C', 'A', 'C'};
+
+        struct CacheHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t resolution;
+            std::uint64_t key;
+            std::int32_t width;
+            std::int32_t height;
+            std::int32_t inflationRadiusPixels;
+            std::int32_t spatialCellSize;
+            std::int32_t tileSize;
+            std::int32_t regionCellSize;
+            std::int32_t regionCols;
+            std::int32_t regionRows;
+            std::uint64_t staticWordCount;
+            std::uint64_t inflatedWordCount;
+            std::uint64_t clearanceCount;
+            std::uint64_t nodeCount;
+            std::uint64_t offsetCount;
+            std::uint64_t edgeCount;
+            std::uint64_t regionCount;
+            std::uint64_t regionCellCount;
+        };
+
+        inline std::uint64_t AlignUp(std::uint64_t n) {
+            return (n + 7) & ~std::uint64_t(7);
+        }
+
+        // Byte offsets of every section, derived from the header counts
+        struct SectionLayout {
+            std::uint64_t staticWords;
+            std::uint64_t inflatedWords;
+            std::uint64_t clearance;
+            std::uint64_t nodes;
+            std::uint64_t offsets;
+            std::uint64_t edges;
+            std::uint64_t regions;
+            std::uint64_t regionCells;
+            std::uint64_t totalSize;
+
+            explicit SectionLayout(const CacheHeader& h) {
+                std::uint64_t pos = AlignUp(sizeof(CacheHeader));
+                staticWords = pos;   pos = AlignUp(pos + h.staticWordCount * sizeof(PackedGrid::Word));
+                inflatedWords = pos; pos = AlignUp(pos + h.inflatedWordCount * sizeof(PackedGrid::Word));
+                clearance = pos;     pos = AlignUp(pos + h.clearanceCount * sizeof(int));
+                nodes = pos;         pos = AlignUp(pos + h.nodeCount * sizeof(Backend::Common::Node));
+                offsets = pos;       pos = AlignUp(pos + h.offsetCount * sizeof(int));
+                edges = pos;         pos = AlignUp(pos + h.edgeCount * sizeof(Backend::Common::Edge));
+                regions = pos;       pos = AlignUp(pos + h.regionCount * sizeof(RegionRect));
+                regionCells = pos;   pos = AlignUp(pos + h.regionCellCount * sizeof(int));
+                totalSize = pos;
+            }
+        };
+
+        // FNV-1a, 64 bit
+        class Fnv1a {
+        private:
+            std::uint64_t hash = 14695981039346656037ull;
+
+        public:
+            void Update(const void* data, size_t size) {
+                const unsigned char* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    hash ^= bytes[i];
+                    hash *= 1099511628211ull;
+                }
+            }
+            std::uint64_t Value() const { return hash; }
+        };
+
+        // Read-only private mapping of a whole file, unmapped on destruction
+        class MappedFile {
+        private:
+            void* data = MAP_FAILED;
+            size_t size = 0;
+
+        public:
+            explicit MappedFile(const std::string& path) {
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) return;
+
+                struct stat st;
+                if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                    size = static_cast<size_t>(st.st_size);
+                    data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                }
+                ::close(fd);  // The mapping stays valid after close
+            }
+
+            ~MappedFile() {
+                if (data != MAP_FAILED) ::munmap(data, size);
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            bool IsValid() const { return data != MAP_FAILED; }
+            size_t GetSize() const { return size; }
+            const unsigned char* GetBytes() const { return static_cast<const unsigned char*>(data); }
+        };
+
+        template <typename T>
+        std::vector<T> CopySection(const unsigned char* base, std::uint64_t offset, std::uint64_t count) {
+            std::vector<T> out(static_cast<size_t>(count));
+            if (count > 0) {
+                std::memcpy(out.data(), base + offset, static_cast<size_t>(count) * sizeof(T));
+            }
+            return out;
+        }
+
+        void WritePadded(std::ofstream& file, const void* data, std::uint64_t bytes) {
+            static const char zeros[8] = {0};
+            if (bytes > 0) file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            file.write(zeros, static_cast<std::streamsize>(AlignUp(bytes) - bytes));
+        }
+
+    } // namespace
+
+    // =========================================================================
+    // KEY
+    // =========================================================================
+
+    std::uint64_t MapCache::ComputeKey(const std::string& mapPath,
+                                       float robotRadiusMeters,
+                                       Backend::Common::Resolution res,
+                                       std::uint32_t generatorVariant) {
+        std::ifstream file(mapPath, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("[MapCache] Failed to open map file: " + mapPath);
+        }
+
+        Fnv1a hash;
+        char buffer[1 << 16];
+        while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+            hash.Update(buffer, static_cast<size_t>(file.gcount()));
+        }
+
+        const std::uint32_t version = FORMAT_VERSION;
+        const std::uint32_t resolution = static_cast<std::uint32_t>(res);
+        hash.Update(&robotRadiusMeters, sizeof(robotRadiusMeters));
+        hash.Update(&resolution, sizeof(resolution));
+        hash.Update(&generatorVariant, sizeof(generatorVariant));
+        hash.Update(&version, sizeof(version));
+        return hash.Value();
+    }
+
+    // =========================================================================
+    // LOAD (mmap)
+    // =========================================================================
+
+    bool MapCache::Load(const std::string& cachePath, std::uint64_t key, Contents& out) {
+        MappedFile mapped(cachePath);
+        if (!mapped.IsValid()) return false;
+
+        if (mapped.GetSize() < sizeof(CacheHeader)) {
+            std::cerr << "[MapCache] Ignoring truncated cache: " << cachePath << std::endl;
+            return false;
+        }
+
+        CacheHeader header;
+        std::memcpy(&header, mapped.GetBytes(), sizeof(header));
+
+        if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+            header.version != FORMAT_VERSION) {
+            std::cout << "[MapCache] Cache format mismatch, rebuilding" << std::endl;
+            return false;
+        }
+        if (header.key != key) {
+            std::cout << "[MapCache] Cache key mismatch (map or parameters changed), rebuilding" << std::endl;
+            return false;
+        }
+
+        const SectionLayout layout(header);
+        const std::uint64_t cells = static_cast<std::uint64_t>(header.width) * header.height;
+        const std::uint64_t gridWords =
+            static_cast<std::uint64_t>((header.width + PackedGrid::BITS_PER_WORD - 1) / PackedGrid::BITS_PER_WORD) * header.height;
+        if (layout.totalSize != mapped.GetSize() || header.width <= 0 || header.height <= 0 ||
+            header.staticWordCount != gridWords || header.inflatedWordCount != gridWords ||
+            header.clearanceCount != cells || header.offsetCount != header.nodeCount + 1 ||
+            (header.regionCount != 0 && header.regionCount != header.nodeCount) ||
+            header.regionCellCount != static_cast<std::uint64_t>(header.regionCols) * header.regionRows) {
+            std::cerr << "[MapCache] Ignoring corrupt cache: " << cachePath << std::endl;
+            return false;
+        }
+
+        const unsigned char* base = mapped.GetBytes();
+        const auto res = static_cast<Backend::Common::Resolution>(header.resolution);
+
+        try {
+            Contents restored;
+            restored.staticMap = std::make_unique<StaticBitMap>(
+                PackedGrid(header.width, header.height,
+                           reinterpret_cast<const PackedGrid::Word*>(base + layout.staticWords)),
+                res);
+
+            restored.inflatedMap = std::make_unique<InflatedBitMap>(
+                *restored.staticMap, header.inflationRadiusPixels,
+                PackedGrid(header.width, header.height,
+                           reinterpret_cast<const PackedGrid::Word*>(base + layout.inflatedWords)),
+                CopySection<int>(base, layout.clearance, header.clearanceCount));
+
+            restored.navMesh = std::make_unique<NavMesh>();
+            restored.navMesh->LoadFrozen(
+                CopySection<Backend::Common::Node>(base, layout.nodes, header.nodeCount),
+                CopySection<int>(base, layout.offsets, header.offsetCount),
+                CopySection<Backend::Common::Edge>(base, layout.edges, header.edgeCount),
+                header.spatialCellSize);
+            restored.navMesh->SetTileSize(header.tileSize);
+            if (header.regionCount > 0) {
+                restored.navMesh->SetRegions(
+                    CopySection<RegionRect>(base, layout.regions, header.regionCount),
+                    header.regionCellSize, header.regionCols, header.regionRows,
+                    CopySection<int>(base, layout.regionCells, header.regionCellCount));
+            }
+
+            out = std::move(restored);
+        } catch (const std::exception& e) {
+            std::cerr << "[MapCache] Ignoring invalid cache: " << e.what() << std::endl;
+            return false;
+        }
+
+        std::cout << "[MapCache] Loaded " << header.width << "x" << header.height << " map, "
+                  << header.nodeCount << " nodes, " << header.edgeCount << " edges from "
+                  << cachePath << std::endl;
+        return true;
+    }
+
+    // =========================================================================
+    // SAVE
+    // =========================================================================
+
+    bool MapCache::Save(const std::string& cachePath, std::uint64_t key,
+                        const StaticBitMap& staticMap,
+                        const InflatedBitMap& inflatedMap,
+                        const NavMesh& navMesh) {
+        if (!navMesh.IsFinalized()) {
+            std::cerr << "[MapCache] NavMesh must be finalized before saving" << std::endl;
+            return false;
+        }
+
+        const PackedGrid& staticGrid = staticMap.GetRawData();
+        const PackedGrid& inflatedGrid = inflatedMap.GetRawData();
+        const std::vector<int>& clearance = inflatedMap.GetClearanceField();
+        const auto& nodes = navMesh.GetAllNodes();
+        const std::vector<int>& offsets = navMesh.GetCSROffsets();
+        const auto& edges = navMesh.GetCSREdges();
+        const std::vector<RegionRect>& regions = navMesh.GetNodeRegions();
+        const std::vector<int>& regionCells = navMesh.GetRegionCellNodes();
+
+        CacheHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = FORMAT_VERSION;
+        header.resolution = static_cast<std::uint32_t>(staticMap.GetResolution());
+        header.key = key;
+        header.width = staticGrid.GetWidth();
+        header.height = staticGrid.GetHeight();
+        header.inflationRadiusPixels = inflatedMap.GetInflationRadiusPixels();
+        header.spatialCellSize = navMesh.GetSpatialIndexCellSize();
+        header.tileSize = navMesh.GetTileSize();
+        header.regionCellSize = navMesh.GetRegionCellSize();
+        header.regionCols = navMesh.GetRegionCols();
+        header.regionRows = navMesh.GetRegionRows();
+        header.staticWordCount = staticGrid.GetWordCount();
+        header.inflatedWordCount = inflatedGrid.GetWordCount();
+        header.clearanceCount = clearance.size();
+        header.nodeCount = nodes.size();
+        header.offsetCount = offsets.size();
+        header.edgeCount = edges.size();
+        header.regionCount = regions.size();
+        header.regionCellCount = regionCells.size();
+
+        std::error_code ec;
+        const std::filesystem::path target(cachePath);
+        if (target.has_parent_path()) {
+            std::filesystem::create_directories(target.parent_path(), ec);
+        }
+
+        const std::string tmpPath = cachePath + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "[MapCache] Failed to open for writing: " << tmpPath << std::endl;
+                return false;
+            }
+
+            WritePadded(file, &header, sizeof(header));
+            WritePadded(file, staticGrid.GetWords(), header.staticWordCount * sizeof(PackedGrid::Word));
+            WritePadded(file, inflatedGrid.GetWords(), header.inflatedWordCount * sizeof(PackedGrid::Word));
+            WritePadded(file, clearance.data(), header.clearanceCount * sizeof(int));
+            WritePadded(file, nodes.data(), header.nodeCount * sizeof(Backend::Common::Node));
+            WritePadded(file, offsets.data(), header.offsetCount * sizeof(int));
+            WritePadded(file, edges.data(), header.edgeCount * sizeof(Backend::Common::Edge));
+            WritePadded(file, regions.data(), header.regionCount * sizeof(RegionRect));
+            WritePadded(file, regionCells.data(), header.regionCellCount * sizeof(int));
+
+            if (!file.good()) {
+                std::cerr << "[MapCache] Write failed: " << tmpPath << std::endl;
+                file.close();
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+        }
+
+        if (std::rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+            std::cerr << "[MapCache] Failed to move cache into place: " << cachePath << std::endl;
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+
+        std::cout << "[MapCache] Wrote cache (" << SectionLayout(header).totalSize
+                  << " bytes) to " << cachePath << std::endl;
+        return true;
+    }
+
+} // namespace Layer1
+} // namespace Backend
@@ -0,0 +1,84 @@
+#include "MapFile.hh"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Backend {
+namespace Layer1 {
+
+    MapFile::MapFile(const std::string& filepath)
+        : data(nullptr), size(0), width(0), height(0) {
+        int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("[MapFile] Failed to open file: " + filepath);
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("[MapFile] Failed to stat file: " + filepath);
+        }
+
+        if (st.st_size > 0) {
+            size = static_cast<size_t>(st.st_size);
+            void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("[MapFile] Failed to map file: " + filepath);
+            }
+            data = static_cast<const char*>(mapped);
+            ::madvise(mapped, size, MADV_SEQUENTIAL);
+        }
+        ::close(fd);  // The mapping stays valid after close
+
+        // One pass over the bytes: record every non-empty line
+        size_t pos = 0;
+        while (pos < size) {
+            const void* nl = std::memchr(data + pos, '\n', size - pos);
+            size_t end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - data) : size;
+            if (end > pos) {
+                rowOffsets.push_back(pos);
+                rowLengths.push_back(static_cast<int>(std::min<size_t>(end - pos, INT_MAX)));
+            }
+            pos = end + 1;
+        }
+
+        height = static_cast<int>(rowOffsets.size());
+        width = height > 0 ? rowLengths[0] : 0;
+    }
+
+    MapFile::~MapFile() {
+        if (data) ::munmap(const_cast<char*>(data), size);
+    }
+
+    int MapFile::DecodeRow(int y, int x, int count, PackedGrid& out, int outY) const {
+        const char* row = data + rowOffsets[y];
+        const int available = std::max(0, std::min(count, rowLengths[y] - x));
+        int obstacles = 0;
+
+        for (int base = 0; base < count; base += PackedGrid::BITS_PER_WORD) {
+            const int n = std::min(PackedGrid::BITS_PER_WORD, available - base);
+            PackedGrid::Word word = ~PackedGrid::Word(0);  // Missing cells stay walkable
+            if (n > 0) {
+                const char* chars = row + x + base;
+                PackedGrid::Word bits = 0;
+                for (int i = 0; i < n; ++i) {
+                    bits |= PackedGrid::Word(chars[i] == '.') << i;
+                }
+                const PackedGrid::Word present =
+                    (n == PackedGrid::BITS_PER_WORD) ? ~PackedGrid::Word(0) : ((PackedGrid::Word(1) << n) - 1);
+                word = (word & ~present) | bits;
+                obstacles += n - __builtin_popcountll(bits);
+            }
+            out.SetWord(base / PackedGrid::BITS_PER_WORD, outY, word);
+        }
+        return obstacles;
+    }
+
+} // namespace Layer1
+} // namespace Backend
@@ -1,61 +1,571 @@
 #include "NavMesh.hh"
+#include "Trace.hh"
+#include "MemoryUsage.hh"
 #include <cmath>
 #include <limits>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <utility>
 
 namespace Backend {
 namespace Layer1 {
 
-    NavMesh::NavMesh() {}
+    NavMesh::NavMesh()
+        : finalized(false), indexCellSize(0), indexOriginX(0), indexOriginY(0),
+          indexCols(0), indexRows(0), spatialIndexValid(false),
+          tileSize(0), changeVersion(0), penalizedNodes(0),
+          regionCellSize(0), regionCols(0), regionRows(0) {}
 
     const std::vector<Backend::Common::Node>& NavMesh::GetAllNodes() const {
         return allNodes;
     }
 
-    const std::vector<Backend::Common::Edge>& NavMesh::GetNeighbors(int nodeId) const {
-        if (nodeId < 0 || nodeId >= (int)adjacencyList.size()) {
-            static const std::vector<Backend::Common::Edge> empty;
-            return empty;
+    EdgeRange NavMesh::GetNeighbors(int nodeId) const {
+        if (nodeId < 0 || nodeId >= (int)allNodes.size()) {
+            return EdgeRange();
         }
-        return adjacencyList[nodeId];
+        if (finalized) {
+            const Backend::Common::Edge* base = csrEdges.data();
+            return EdgeRange(base + csrOffsets[nodeId], base + csrOffsets[nodeId + 1]);
+        }
+        const auto& edges = adjacencyList[nodeId];
+        return EdgeRange(edges.data(), edges.data() + edges.size());
     }
 
-    int NavMesh::GetNodeIdAt(Backend::Common::Coordinates coords) const {
-        // Naive implementation: Linear Search for nearest centroid.
-        // OPTIMIZATION: In production, use a Spatial Hash, QuadTree, or 2D Grid Lookup.
-        
+    size_t NavMesh::GetEdgeCount() const {
+        if (finalized) return csrEdges.size();
+        size_t count = 0;
+        for (const auto& edges : adjacencyList) {
+            count += edges.size();
+        }
+        return count;
+    }
+
+    size_t NavMesh::GetMemoryBytes() const {
+        using Backend::Common::VectorBytes;
+        return VectorBytes(allNodes) + Backend::Common::NestedVectorBytes(adjacencyList) +
+               VectorBytes(csrOffsets) + VectorBytes(csrEdges) +
+               VectorBytes(bucketOffsets) + VectorBytes(bucketNodes) +
+               VectorBytes(nodeBlocked) + VectorBytes(nodeChangeVersion) + VectorBytes(nodePenalty) +
+               VectorBytes(nodeRegions) + VectorBytes(regionCellNode);
+    }
+
+    // =========================================================================
+    // FROZEN LAYOUT
+    // =========================================================================
+
+    void NavMesh::Finalize(int spatialCellSize) {
+        if (!finalized) {
+            csrOffsets.assign(allNodes.size() + 1, 0);
+            for (size_t i = 0; i < adjacencyList.size(); ++i) {
+                csrOffsets[i + 1] = csrOffsets[i] + static_cast<int>(adjacencyList[i].size());
+            }
+
+            csrEdges.clear();
+            csrEdges.reserve(csrOffsets.back());
+            for (const auto& edges : adjacencyList) {
+                csrEdges.insert(csrEdges.end(), edges.begin(), edges.end());
+            }
+
+            // Release the per-node allocations
+            std::vector<std::vector<Backend::Common::Edge>>().swap(adjacencyList);
+            finalized = true;
+        }
+
+        BuildSpatialIndex(spatialCellSize);
+    }
+
+    void NavMesh::LoadFrozen(std::vector<Backend::Common::Node> nodes,
+                             std::vector<int> offsets,
+                             std::vector<Backend::Common::Edge> edges,
+                             int spatialCellSize) {
+        if (offsets.size() != nodes.size() + 1 || offsets.front() != 0 ||
+            offsets.back() != static_cast<int>(edges.size())) {
+            throw std::invalid_argument("[NavMesh] Inconsistent CSR offsets");
+        }
+        for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+            if (offsets[i] > offsets[i + 1]) {
+                throw std::invalid_argument("[NavMesh] Inconsistent CSR offsets");
+            }
+        }
+        for (const auto& edge : edges) {
+            if (edge.targetNodeId < 0 || edge.targetNodeId >= static_cast<int>(nodes.size())) {
+                throw std::invalid_argument("[NavMesh] CSR edge target out of range");
+            }
+        }
+
+        ResetOverlay();
+        ClearRegions();
+        allNodes = std::move(nodes);
+        csrOffsets = std::move(offsets);
+        csrEdges = std::move(edges);
+        std::vector<std::vector<Backend::Common::Edge>>().swap(adjacencyList);
+        finalized = true;
+
+        BuildSpatialIndex(spatialCellSize);
+    }
+
+    bool NavMesh::IsFinalized() const {
+        return finalized;
+    }
+
+    const std::vector<int>& NavMesh::GetCSROffsets() const {
+        return csrOffsets;
+    }
+
+    const std::vector<Backend::Common::Edge>& NavMesh::GetCSREdges() const {
+        return csrEdges;
+    }
+
+    void NavMesh::Thaw() {
+        if (!finalized) return;
+
+        adjacencyList.assign(allNodes.size(), {});
+        for (size_t i = 0; i < allNodes.size(); ++i) {
+            adjacencyList[i].assign(csrEdges.begin() + csrOffsets[i],
+                                    csrEdges.begin() + csrOffsets[i + 1]);
+        }
+
+        csrOffsets.clear();
+        csrEdges.clear();
+        finalized = false;
+    }
+
+    int NavMesh::FindNearestLinear(Backend::Common::Coordinates coords) const {
         int bestNode = -1;
-        float minDist = std::numeric_limits<float>::max();
+        long long minDistSq = std::numeric_limits<long long>::max();
 
         for (int i = 0; i < (int)allNodes.size(); ++i) {
-            float dist = coords.DistanceTo(allNodes[i].coords);
-            
-            // Simple threshold: If we are close enough to a node center
-            // (You might want strict polygon containment checks here later)
-            if (dist < minDist) {
-                minDist = dist;
+            long long dx = allNodes[i].coords.x - coords.x;
+            long long dy = allNodes[i].coords.y - coords.y;
+            long long distSq = dx * dx + dy * dy;
+            if (distSq < minDistSq) {
+                minDistSq = distSq;
                 bestNode = i;
             }
         }
-        
-        // Threshold check (e.g., must be within 5 units of a node)
-        // if (minDist > 5.0f) return -1; 
+        return bestNode;
+    }
+
+    int NavMesh::GetNodeIdAt(Backend::Common::Coordinates coords) const {
+        if (allNodes.empty()) return -1;
+
+        int region = FindRegionAt(coords);
+        if (region >= 0) return region;
+
+        if (!spatialIndexValid) return FindNearestLinear(coords);
+
+        // Bucket containing the query (clamped onto the grid)
+        int cx = (coords.x - indexOriginX) / indexCellSize;
+        int cy = (coords.y - indexOriginY) / indexCellSize;
+        if (coords.x < indexOriginX) cx = -1;
+        if (coords.y < indexOriginY) cy = -1;
+        cx = std::max(0, std::min(cx, indexCols - 1));
+        cy = std::max(0, std::min(cy, indexRows - 1));
+
+        int bestNode = -1;
+        long long bestDistSq = std::numeric_limits<long long>::max();
+
+        auto scanBucket = [&](int bx, int by) {
+            int b = by * indexCols + bx;
+            for (int k = bucketOffsets[b]; k < bucketOffsets[b + 1]; ++k) {
+                int id = bucketNodes[k];
+                long long dx = allNodes[id].coords.x - coords.x;
+                long long dy = allNodes[id].coords.y - coords.y;
+                long long distSq = dx * dx + dy * dy;
+                if (distSq < bestDistSq || (distSq == bestDistSq && id < bestNode)) {
+                    bestDistSq = distSq;
+                    bestNode = id;
+                }
+            }
+        };
+
+        // Expanding square rings of buckets around (cx, cy)
+        int maxRing = std::max(std::max(cx, indexCols - 1 - cx), std::max(cy, indexRows - 1 - cy));
+        for (int r = 0; r <= maxRing; ++r) {
+            for (int by = cy - r; by <= cy + r; ++by) {
+                if (by < 0 || by >= indexRows) continue;
+                bool edgeRow = (by == cy - r || by == cy + r);
+                for (int bx = cx - r; bx <= cx + r; bx += (edgeRow ? 1 : 2 * r)) {
+                    if (bx >= 0 && bx < indexCols) scanBucket(bx, by);
+                    if (r == 0) break;
+                }
+            }
+
+            if (bestNode < 0) continue;
+
+            // Any unvisited node lies outside the (2r+1)^2 block of buckets,
+            // so it is at least as far as the nearest edge of that block
+            long long blockMinX = indexOriginX + static_cast<long long>(cx - r) * indexCellSize;
+            long long blockMaxX = indexOriginX + static_cast<long long>(cx + r + 1) * indexCellSize;
+            long long blockMinY = indexOriginY + static_cast<long long>(cy - r) * indexCellSize;
+            long long blockMaxY = indexOriginY + static_cast<long long>(cy + r + 1) * indexCellSize;
+            long long margin = std::min(std::min(coords.x - blockMinX, blockMaxX - coords.x),
+                                        std::min(coords.y - blockMinY, blockMaxY - coords.y));
+            if (margin > 0 && bestDistSq < margin * margin) break;
+        }
 
         return bestNode;
     }
 
+    void NavMesh::BuildSpatialIndex(int cellSize) {
+        spatialIndexValid = false;
+        bucketOffsets.clear();
+        bucketNodes.clear();
+        if (allNodes.empty()) return;
+
+        int minX = allNodes[0].coords.x, maxX = minX;
+        int minY = allNodes[0].coords.y, maxY = minY;
+        for (const auto& node : allNodes) {
+            minX = std::min(minX, node.coords.x);
+            maxX = std::max(maxX, node.coords.x);
+            minY = std::min(minY, node.coords.y);
+            maxY = std::max(maxY, node.coords.y);
+        }
+
+        if (cellSize <= 0) {
+            // Roughly one node per bucket on average
+            double area = static_cast<double>(maxX - minX + 1) * (maxY - minY + 1);
+            cellSize = static_cast<int>(std::ceil(std::sqrt(area / allNodes.size())));
+        }
+
+        indexCellSize = std::max(1, cellSize);
+        indexOriginX = minX;
+        indexOriginY = minY;
+        indexCols = (maxX - minX) / indexCellSize + 1;
+        indexRows = (maxY - minY) / indexCellSize + 1;
+
+        // Counting sort of node IDs into buckets (keeps IDs ascending per bucket)
+        size_t numBuckets = static_cast<size_t>(indexCols) * indexRows;
+        bucketOffsets.assign(numBuckets + 1, 0);
+        std::vector<int> nodeBucket(allNodes.size());
+        for (size_t i = 0; i < allNodes.size(); ++i) {
+            int bx = (allNodes[i].coords.x - minX) / indexCellSize;
+            int by = (allNodes[i].coords.y - minY) / indexCellSize;
+            nodeBucket[i] = by * indexCols + bx;
+            ++bucketOffsets[nodeBucket[i] + 1];
+        }
+        for (size_t b = 0; b < numBuckets; ++b) {
+            bucketOffsets[b + 1] += bucketOffsets[b];
+        }
+        bucketNodes.resize(allNodes.size());
+        std::vector<int> fill(bucketOffsets.begin(), bucketOffsets.end() - 1);
+        for (size_t i = 0; i < allNodes.size(); ++i) {
+            bucketNodes[fill[nodeBucket[i]]++] = static_cast<int>(i);
+        }
+
+        spatialIndexValid = true;
+    }
+
+    bool NavMesh::HasSpatialIndex() const {
+        return spatialIndexValid;
+    }
+
+    int NavMesh::GetSpatialIndexCellSize() const {
+        return indexCellSize;
+    }
+
+    // =========================================================================
+    // DYNAMIC OVERLAY
+    // =========================================================================
+
+    void NavMesh::SetTileSize(int size) {
+        tileSize = std::max(0, size);
+    }
+
+    int NavMesh::GetTileSize() const {
+        return tileSize;
+    }
+
+    // =========================================================================
+    // REGION GEOMETRY
+    // =========================================================================
+
+    void NavMesh::SetRegions(std::vector<RegionRect> regions, int cellSize, int cols, int rows,
+                             std::vector<int> cellNodes) {
+        if (regions.size() != allNodes.size() || cellSize <= 0 || cols < 0 || rows < 0 ||
+            cellNodes.size() != static_cast<size_t>(cols) * rows) {
+            throw std::invalid_argument("[NavMesh] Inconsistent region geometry");
+        }
+        for (int id : cellNodes) {
+            if (id < -1 || id >= static_cast<int>(allNodes.size())) {
+                throw std::invalid_argument("[NavMesh] Region cell node out of range");
+            }
+        }
+
+        ResetOverlay();
+        nodeRegions = std::move(regions);
+        regionCellSize = cellSize;
+        regionCols = cols;
+        regionRows = rows;
+        regionCellNode = std::move(cellNodes);
+    }
+
+    void NavMesh::ClearRegions() {
+        nodeRegions.clear();
+        regionCellNode.clear();
+        regionCellSize = 0;
+        regionCols = 0;
+        regionRows = 0;
+    }
+
+    int NavMesh::FindRegionAt(Backend::Common::Coordinates coords) const {
+        if (nodeRegions.empty() || coords.x < 0 || coords.y < 0) return -1;
+        int cx = coords.x / regionCellSize;
+        int cy = coords.y / regionCellSize;
+        if (cx >= regionCols || cy >= regionRows) return -1;
+        return regionCellNode[static_cast<size_t>(cy) * regionCols + cx];
+    }
+
+    bool NavMesh::HasRegions() const {
+        return !nodeRegions.empty();
+    }
+
+    const std::vector<RegionRect>& NavMesh::GetNodeRegions() const {
+        return nodeRegions;
+    }
+
+    const std::vector<int>& NavMesh::GetRegionCellNodes() const {
+        return regionCellNode;
+    }
+
+    int NavMesh::GetRegionCellSize() const {
+        return regionCellSize;
+    }
+
+    int NavMesh::GetRegionCols() const {
+        return regionCols;
+    }
+
+    int NavMesh::GetRegionRows() const {
+        return regionRows;
+    }
+
+    void NavMesh::ResetOverlay() {
+        nodeBlocked.clear();
+        nodeChangeVersion.clear();
+        nodePenalty.clear();
+        penalizedNodes = 0;
+    }
+
+    std::vector<int> NavMesh::UpdateBlockedRegion(int x, int y, int w, int h, const PackedGrid& grid) {
+        TRACE_ZONE("UpdateBlockedRegion", "layer1");
+        std::vector<int> changed;
+        if (w <= 0 || h <= 0 || allNodes.empty()) return changed;
+        if (tileSize <= 0 && nodeRegions.empty()) return changed;
+
+        if (nodeBlocked.size() != allNodes.size()) {
+            nodeBlocked.assign(allNodes.size(), 0);
+            nodeChangeVersion.assign(allNodes.size(), 0);
+        }
+
+        // Rectangle a node stands for: its region, or the tile around it
+        const int half = tileSize / 2;
+        auto nodeRect = [&](int id) -> RegionRect {
+            if (!nodeRegions.empty()) return nodeRegions[id];
+            return {allNodes[id].coords.x - half, allNodes[id].coords.y - half, tileSize, tileSize};
+        };
+
+        auto reclassify = [&](int id) {
+            const RegionRect r = nodeRect(id);
+            if (r.x >= x + w || x >= r.x + r.w ||
+                r.y >= y + h || y >= r.y + r.h) {
+                return;  // Node does not touch the region
+            }
+            char blocked = grid.IsRectSet(r.x, r.y, r.w, r.h) ? 0 : 1;
+            if (blocked != nodeBlocked[id]) {
+                nodeBlocked[id] = blocked;
+                changed.push_back(id);
+            }
+        };
+
+        if (!nodeRegions.empty()) {
+            // Candidates are the nodes owning the region cells the rectangle touches
+            std::vector<int> candidates;
+            int cx0 = std::max(0, x / regionCellSize);
+            int cy0 = std::max(0, y / regionCellSize);
+            int cx1 = std::min(regionCols - 1, (x + w - 1) / regionCellSize);
+            int cy1 = std::min(regionRows - 1, (y + h - 1) / regionCellSize);
+            for (int cy = cy0; cy <= cy1; ++cy) {
+                for (int cx = cx0; cx <= cx1; ++cx) {
+                    int id = regionCellNode[static_cast<size_t>(cy) * regionCols + cx];
+                    if (id >= 0) candidates.push_back(id);
+                }
+            }
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            for (int id : candidates) {
+                reclassify(id);
+            }
+        } else if (spatialIndexValid) {
+            // Node centres whose tile can touch the region lie within
+            // [x - tileSize, x + w + tileSize) (same for y)
+            auto bucketOf = [](int p, int origin, int cell, int count) {
+                int b = (p < origin) ? 0 : (p - origin) / cell;
+                return std::max(0, std::min(b, count - 1));
+            };
+            int bx0 = bucketOf(x - tileSize, indexOriginX, indexCellSize, indexCols);
+            int bx1 = bucketOf(x + w + tileSize, indexOriginX, indexCellSize, indexCols);
+            int by0 = bucketOf(y - tileSize, indexOriginY, indexCellSize, indexRows);
+            int by1 = bucketOf(y + h + tileSize, indexOriginY, indexCellSize, indexRows);
+            for (int by = by0; by <= by1; ++by) {
+                for (int bx = bx0; bx <= bx1; ++bx) {
+                    int b = by * indexCols + bx;
+                    for (int k = bucketOffsets[b]; k < bucketOffsets[b + 1]; ++k) {
+                        reclassify(bucketNodes[k]);
+                    }
+                }
+            }
+            std::sort(changed.begin(), changed.end());
+        } else {
+            for (int id = 0; id < static_cast<int>(allNodes.size()); ++id) {
+                reclassify(id);
+            }
+        }
+
+        if (!changed.empty()) {
+            ++changeVersion;
+            for (int id : changed) {
+                nodeChangeVersion[id] = changeVersion;
+            }
+        }
+        return changed;
+    }
+
+    void NavMesh::ClearBlocked() {
+        bool any = false;
+        for (size_t id = 0; id < nodeBlocked.size(); ++id) {
+            if (nodeBlocked[id]) {
+                if (!any) ++changeVersion;
+                any = true;
+                nodeBlocked[id] = 0;
+                nodeChangeVersion[id] = changeVersion;
+            }
+        }
+    }
+
+    bool NavMesh::IsNodeBlocked(int nodeId) const {
+        if (nodeId < 0 || nodeId >= static_cast<int>(nodeBlocked.size())) return false;
+        return nodeBlocked[nodeId] != 0;
+    }
+
+    bool NavMesh::IsEdgeBlocked(int sourceId, int targetId) const {
+        return IsNodeBlocked(sourceId) || IsNodeBlocked(targetId);
+    }
+
+    std::vector<int> NavMesh::LabelComponents(bool withOverlay) const {
+        const int numNodes = static_cast<int>(allNodes.size());
+        std::vector<int> labels(numNodes, -1);
+        std::vector<int> stack;
+        int next = 0;
+
+        for (int seed = 0; seed < numNodes; ++seed) {
+            if (labels[seed] >= 0 || (withOverlay && IsNodeBlocked(seed))) continue;
+            labels[seed] = next;
+            stack.push_back(seed);
+            while (!stack.empty()) {
+                int current = stack.back();
+                stack.pop_back();
+                for (const auto& edge : GetNeighbors(current)) {
+                    int neighbor = edge.targetNodeId;
+                    if (labels[neighbor] >= 0 || (withOverlay && IsNodeBlocked(neighbor))) continue;
+                    labels[neighbor] = next;
+                    stack.push_back(neighbor);
+                }
+            }
+            ++next;
+        }
+        return labels;
+    }
+
+    uint64_t NavMesh::GetChangeVersion() const {
+        return changeVersion;
+    }
+
+    uint64_t NavMesh::GetNodeChangeVersion(int nodeId) const {
+        if (nodeId < 0 || nodeId >= static_cast<int>(nodeChangeVersion.size())) return 0;
+        return nodeChangeVersion[nodeId];
+    }
+
+    bool NavMesh::HasChangedSince(const std::vector<int>& nodeIds, uint64_t version) const {
+        if (changeVersion <= version) return false;
+        for (int id : nodeIds) {
+            if (GetNodeChangeVersion(id) > version) return true;
+        }
+        return false;
+    }
+
+    std::vector<int> NavMesh::UpdatePenalties(const std::vector<float>& penalties, float tolerance) {
+        std::vector<int> changed;
+        if (!penalties.empty() && penalties.size() != allNodes.size()) {
+            throw std::invalid_argument("NavMesh::UpdatePenalties: one penalty per node expected");
+        }
+        if (penalties.empty() && penalizedNodes == 0) return changed;
+
+        // Penalty changes are stamped like blocked flips
+        if (nodeBlocked.size() != allNodes.size()) {
+            nodeBlocked.assign(allNodes.size(), 0);
+            nodeChangeVersion.assign(allNodes.size(), 0);
+        }
+        if (nodePenalty.size() != allNodes.size()) {
+            nodePenalty.assign(allNodes.size(), 0.0f);
+            penalizedNodes = 0;
+        }
+
+        for (size_t id = 0; id < nodePenalty.size(); ++id) {
+            float penalty = penalties.empty() ? 0.0f : std::max(0.0f, penalties[id]);
+            float current = nodePenalty[id];
+            // Dropping to zero always counts, so no penalty lingers below tolerance
+            bool moved = std::fabs(penalty - current) > tolerance || (penalty == 0.0f && current != 0.0f);
+            if (!moved) continue;
+            if (current == 0.0f) ++penalizedNodes;
+            if (penalty == 0.0f) --penalizedNodes;
+            nodePenalty[id] = penalty;
+            changed.push_back(static_cast<int>(id));
+        }
+
+        if (!changed.empty()) {
+            ++changeVersion;
+            for (int id : changed) {
+                nodeChangeVersion[id] = changeVersion;
+            }
+        }
+        return changed;
+    }
+
+    const float* NavMesh::GetNodePenalties() const {
+        return penalizedNodes > 0 ? nodePenalty.data() : nullptr;
+    }
+
+    float NavMesh::GetNodePenalty(int nodeId) const {
+        if (nodeId < 0 || nodeId >= static_cast<int>(nodePenalty.size())) return 0.0f;
+        return nodePenalty[nodeId];
+    }
+
+    size_t NavMesh::GetPenalizedNodeCount() const {
+        return penalizedNodes;
+    }
+
     void NavMesh::AddNode(Backend::Common::Coordinates centroid) {
+        Thaw();
+        ResetOverlay();
+        ClearRegions();
+        
         Backend::Common::Node n;
         n.coords = centroid;
         allNodes.push_back(n);
+        spatialIndexValid = false;
         
         // Resize adjacency list to match node count
         adjacencyList.resize(allNodes.size());
     }
 
     void NavMesh::AddEdge(int sourceId, int targetId, float cost) {
+        Thaw();
+        
         if (sourceId >= 0 && sourceId < (int)adjacencyList.size()) {
             Backend::Common::Edge e;
             e.targetNodeId = targetId;
@@ -66,6 +576,7 @@ namespace Layer1 {
 
     int NavMesh::RemoveOrphanNodes() {
         if (allNodes.empty()) return 0;
+        Thaw();
         
         // Use BFS to find all nodes reachable from node 0 (the main connected component)
         std::vector<bool> reachable(allNodes.size(), false);
@@ -109,6 +620,8 @@ namespace Layer1 {
             return 0;  // No orphans to remove
         }
         
+        ResetOverlay();
+        
         // Build new node list (only reachable nodes)
         std::vector<Backend::Common::Node> newNodes;
         newNodes.reserve(newId);
@@ -133,8 +646,24 @@ namespace Layer1 {
             }
         }
         
+        // Keep region geometry (if any) in step with the new IDs
+        if (!nodeRegions.empty()) {
+            std::vector<RegionRect> newRegions;
+            newRegions.reserve(newId);
+            for (size_t i = 0; i < nodeRegions.size(); ++i) {
+                if (oldToNew[i] != -1) {
+                    newRegions.push_back(nodeRegions[i]);
+                }
+            }
+            nodeRegions = std::move(newRegions);
+            for (int& id : regionCellNode) {
+                if (id >= 0) id = oldToNew[id];
+            }
+        }
+        
         // Replace with cleaned data
         allNodes = std::move(newNodes);
+        spatialIndexValid = false;
         adjacencyList = std::move(newAdjList);
         
         return orphanCount;
@@ -159,13 +688,11 @@ namespace Layer1 {
             file << nodeId << ", " << node.coords.x << ", " << node.coords.y << ", ";
             
             // Write neighbors
-            if (nodeId < adjacencyList.size()) {
-                const auto& neighbors = adjacencyList[nodeId];
-                for (size_t i = 0; i < neighbors.size(); ++i) {
-                    file << neighbors[i].targetNodeId << ":" << neighbors[i].cost;
-                    if (i < neighbors.size() - 1) {
-                        file << "|";
-                    }
+            EdgeRange neighbors = GetNeighbors(static_cast<int>(nodeId));
+            for (size_t i = 0; i < neighbors.size(); ++i) {
+                file << neighbors[i].targetNodeId << ":" << neighbors[i].cost;
+                if (i < neighbors.size() - 1) {
+                    file << "|";
                 }
             }
             
@@ -2,11 +2,19 @@
 
 #include "NavMeshGenerator.hh"
 #include "AbstractGrid.hh"
+#include "PackedGrid.hh"
+#include "GridView.hh"
 #include "Resolution.hh"
 #include <vector>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iostream>
-#include <unordered_map>
+#include <map>
+#include <thread>
+#include <utility>
 
 namespace Backend {
 namespace Layer1 {
@@ -39,125 +47,109 @@ namespace Layer1 {
     }
 
     // =========================================================================
-    // HELPER: Check if a tile is FULLY accessible (all pixels must be walkable)
-    // AND if a robot can actually reach it (check clearance in all 4 directions)
+    // HELPER: Summed-area table of blocked pixels
     // =========================================================================
-    static bool IsTileAccessible(const AbstractGrid& map, int tileX, int tileY, int stepSize) {
-        auto dims = map.GetDimensions();
-        int mapW = dims.first;
-        int mapH = dims.second;
-        
-        // Check ALL pixels within the tile
-        for (int dy = 0; dy < stepSize; ++dy) {
-            for (int dx = 0; dx < stepSize; ++dx) {
-                int px = tileX + dx;
-                int py = tileY + dy;
-                
-                // Bounds check
-                if (px >= mapW || py >= mapH) {
-                    return false;
-                }
-                
-                // If ANY pixel is an obstacle, tile is not accessible
-                if (!map.IsAccessible({px, py})) {
-                    return false;
+    // sums[(y + 1) * (mapW + 1) + (x + 1)] = number of blocked pixels in the
+    // rectangle [0, x] x [0, y]. Built once per ComputeRecast (one probe per
+    // pixel), after which any "is this rectangle fully free" query is O(1).
+    // =========================================================================
+    class BlockedAreaTable {
+    private:
+        int mapW;
+        int mapH;
+        std::vector<uint32_t> sums;
+
+        uint32_t At(int x, int y) const {
+            return sums[static_cast<size_t>(y) * (mapW + 1) + x];
+        }
+
+        // Instantiated per view type: the inner loop is a plain inlined read
+        template <typename View>
+        void Build(const View& view) {
+            for (int y = 0; y < mapH; ++y) {
+                uint32_t rowBlocked = 0;
+                const uint32_t* above = &sums[static_cast<size_t>(y) * (mapW + 1)];
+                uint32_t* current = &sums[static_cast<size_t>(y + 1) * (mapW + 1)];
+                for (int x = 0; x < mapW; ++x) {
+                    rowBlocked += view.IsFreeUnchecked(x, y) ? 0u : 1u;
+                    current[x + 1] = above[x + 1] + rowBlocked;
                 }
             }
         }
+
+    public:
+        explicit BlockedAreaTable(const AbstractGrid& map) {
+            auto dims = map.GetDimensions();
+            mapW = dims.first;
+            mapH = dims.second;
+            sums.assign(static_cast<size_t>(mapW + 1) * (mapH + 1), 0);
+
+            // Packed grids get a devirtualized build, others go through
+            // AbstractGrid::IsAccessible
+            VisitGridView(map, [this](const auto& view) { Build(view); });
+        }
+
+        // True if the w x h rectangle at (x, y) lies inside the map and has
+        // no blocked pixel (out-of-bounds pixels count as obstacles)
+        bool IsRectFree(int x, int y, int w, int h) const {
+            if (x < 0 || y < 0 || x + w > mapW || y + h > mapH) return false;
+            uint32_t blocked = At(x + w, y + h) - At(x, y + h) - At(x + w, y) + At(x, y);
+            return blocked == 0;
+        }
+    };
+
+    // =========================================================================
+    // HELPER: Check if a tile is FULLY accessible (all pixels must be walkable)
+    // AND if a robot can actually reach it (check clearance in all 4 directions)
+    // =========================================================================
+    static bool IsTileAccessible(const BlockedAreaTable& table, int mapW, int mapH,
+                                 int tileX, int tileY, int stepSize) {
+        // If ANY pixel within the tile is an obstacle, tile is not accessible
+        if (!table.IsRectFree(tileX, tileY, stepSize, stepSize)) {
+            return false;
+        }
         
         // Additional check: Can a robot actually REACH this tile?
         // The robot needs at least ONE direction where it can approach with full clearance
         // Check if there's clearance to move INTO this tile from at least one cardinal direction
+        // (a corridor of stepSize width spanning this tile and its neighbour)
         
-        bool canReachFromLeft = true;
-        bool canReachFromRight = true;
-        bool canReachFromTop = true;
-        bool canReachFromBottom = true;
-        
-        // Check LEFT approach (robot moving from left needs corridor of stepSize width)
-        if (tileX >= stepSize) {
-            for (int dy = 0; dy < stepSize; ++dy) {
-                for (int dx = -stepSize; dx < stepSize; ++dx) {
-                    int px = tileX + dx;
-                    int py = tileY + dy;
-                    if (px < 0 || px >= mapW || py < 0 || py >= mapH || !map.IsAccessible({px, py})) {
-                        canReachFromLeft = false;
-                        break;
-                    }
-                }
-                if (!canReachFromLeft) break;
-            }
-        } else {
-            canReachFromLeft = false;
+        // LEFT approach
+        if (tileX >= stepSize &&
+            table.IsRectFree(tileX - stepSize, tileY, 2 * stepSize, stepSize)) {
+            return true;
         }
         
-        // Check RIGHT approach
-        if (tileX + 2 * stepSize <= mapW) {
-            for (int dy = 0; dy < stepSize; ++dy) {
-                for (int dx = 0; dx < 2 * stepSize; ++dx) {
-                    int px = tileX + dx;
-                    int py = tileY + dy;
-                    if (px >= mapW || py >= mapH || !map.IsAccessible({px, py})) {
-                        canReachFromRight = false;
-                        break;
-                    }
-                }
-                if (!canReachFromRight) break;
-            }
-        } else {
-            canReachFromRight = false;
+        // RIGHT approach
+        if (tileX + 2 * stepSize <= mapW &&
+            table.IsRectFree(tileX, tileY, 2 * stepSize, stepSize)) {
+            return true;
         }
         
-        // Check TOP approach
-        if (tileY >= stepSize) {
-            for (int dx = 0; dx < stepSize; ++dx) {
-                for (int dy = -stepSize; dy < stepSize; ++dy) {
-                    int px = tileX + dx;
-                    int py = tileY + dy;
-                    if (px >= mapW || py < 0 || py >= mapH || !map.IsAccessible({px, py})) {
-                        canReachFromTop = false;
-                        break;
-                    }
-                }
-                if (!canReachFromTop) break;
-            }
-        } else {
-            canReachFromTop = false;
+        // TOP approach
+        if (tileY >= stepSize &&
+            table.IsRectFree(tileX, tileY - stepSize, stepSize, 2 * stepSize)) {
+            return true;
         }
         
-        // Check BOTTOM approach
-        if (tileY + 2 * stepSize <= mapH) {
-            for (int dx = 0; dx < stepSize; ++dx) {
-                for (int dy = 0; dy < 2 * stepSize; ++dy) {
-                    int px = tileX + dx;
-                    int py = tileY + dy;
-                    if (px >= mapW || py >= mapH || !map.IsAccessible({px, py})) {
-                        canReachFromBottom = false;
-                        break;
-                    }
-                }
-                if (!canReachFromBottom) break;
-            }
-        } else {
-            canReachFromBottom = false;
+        // BOTTOM approach
+        if (tileY + 2 * stepSize <= mapH &&
+            table.IsRectFree(tileX, tileY, stepSize, 2 * stepSize)) {
+            return true;
         }
         
-        // Tile is only accessible if robot can reach it from at least ONE direction
-        return canReachFromLeft || canReachFromRight || canReachFromTop || canReachFromBottom;
+        // Robot cannot reach the tile from any direction
+        return false;
     }
 
     // =========================================================================
     // HELPER: Check if a robot can pass between two adjacent tiles
     // The ENTIRE robot body (stepSize x stepSize) must fit through the passage
     // =========================================================================
-    static bool CanRobotPassBetween(const AbstractGrid& map, 
+    static bool CanRobotPassBetween(const BlockedAreaTable& table,
                                      int tile1X, int tile1Y, 
                                      int tile2X, int tile2Y, 
                                      int stepSize) {
-        auto dims = map.GetDimensions();
-        int mapW = dims.first;
-        int mapH = dims.second;
-        
         // Both tiles are already verified to be fully walkable
         // Now check if the robot can physically move between them
         
@@ -169,46 +161,169 @@ namespace Layer1 {
         
         if (dx != 0) {
             // Horizontal movement (left/right)
-            // The robot sweeps a rectangle from tile1 to tile2
+            // Swept rectangle: height = stepSize, width = 2*stepSize
             int minX = std::min(tile1X, tile2X);
             int maxX = std::max(tile1X, tile2X) + stepSize;
-            
-            // Check the entire swept area (height = stepSize, width = 2*stepSize)
-            for (int y = tile1Y; y < tile1Y + stepSize; ++y) {
-                for (int x = minX; x < maxX; ++x) {
-                    if (x < 0 || x >= mapW || y < 0 || y >= mapH) {
-                        return false;
-                    }
-                    if (!map.IsAccessible({x, y})) {
-                        return false;
-                    }
-                }
-            }
+            return table.IsRectFree(minX, tile1Y, maxX - minX, stepSize);
         } else if (dy != 0) {
             // Vertical movement (up/down)
-            // The robot sweeps a rectangle from tile1 to tile2
+            // Swept rectangle: width = stepSize, height = 2*stepSize
             int minY = std::min(tile1Y, tile2Y);
             int maxY = std::max(tile1Y, tile2Y) + stepSize;
-            
-            // Check the entire swept area (width = stepSize, height = 2*stepSize)
-            for (int y = minY; y < maxY; ++y) {
-                for (int x = tile1X; x < tile1X + stepSize; ++x) {
-                    if (x < 0 || x >= mapW || y < 0 || y >= mapH) {
-                        return false;
+            return table.IsRectFree(tile1X, minY, stepSize, maxY - minY);
+        }
+        
+        return true;
+    }
+
+    // =========================================================================
+    // HELPER: Merge accessible tiles into rectangles (MERGED_RECTANGLES mode)
+    // =========================================================================
+    // Tiles are covered greedily in row-major order: each uncovered accessible
+    // tile starts a rectangle that grows right, then down, while every tile
+    // it would take is accessible and uncovered. Two accessible neighbouring
+    // tiles are always passable (both are fully free, so the swept corridor
+    // is too), which makes every rectangle convex free space and every shared
+    // border a valid portal.
+    static void BuildMergedRegions(const std::vector<char>& tileAccessible,
+                                   int tilesX, int tilesY, int stepSize,
+                                   int maxRegionTiles, NavMesh& mesh) {
+        auto getTileKey = [tilesX](int gx, int gy) -> size_t {
+            return static_cast<size_t>(gy) * tilesX + gx;
+        };
+
+        // PHASE 1: Greedy rectangle cover, one node per rectangle
+        std::vector<int> tileRegion(static_cast<size_t>(tilesX) * tilesY, -1);
+        std::vector<RegionRect> regions;  // In pixels
+
+        auto isOpen = [&](int gx, int gy) {
+            size_t key = getTileKey(gx, gy);
+            return tileAccessible[key] && tileRegion[key] < 0;
+        };
+
+        for (int tileGridY = 0; tileGridY < tilesY; ++tileGridY) {
+            for (int tileGridX = 0; tileGridX < tilesX; ++tileGridX) {
+                if (!isOpen(tileGridX, tileGridY)) continue;
+
+                int w = 1;
+                while (w < maxRegionTiles && tileGridX + w < tilesX && isOpen(tileGridX + w, tileGridY)) {
+                    ++w;
+                }
+
+                int h = 1;
+                while (h < maxRegionTiles && tileGridY + h < tilesY) {
+                    bool rowOpen = true;
+                    for (int i = 0; i < w && rowOpen; ++i) {
+                        rowOpen = isOpen(tileGridX + i, tileGridY + h);
                     }
-                    if (!map.IsAccessible({x, y})) {
-                        return false;
+                    if (!rowOpen) break;
+                    ++h;
+                }
+
+                int regionId = static_cast<int>(regions.size());
+                for (int j = 0; j < h; ++j) {
+                    for (int i = 0; i < w; ++i) {
+                        tileRegion[getTileKey(tileGridX + i, tileGridY + j)] = regionId;
                     }
                 }
+
+                RegionRect rect{tileGridX * stepSize, tileGridY * stepSize, w * stepSize, h * stepSize};
+                regions.push_back(rect);
+                mesh.AddNode({rect.x + rect.w / 2, rect.y + rect.h / 2});
             }
         }
-        
-        return true;
+
+        std::cout << "[NavMeshGenerator] Merged tiles into " << regions.size()
+                  << " rectangular regions (max " << maxRegionTiles << "x" << maxRegionTiles
+                  << " tiles)" << std::endl;
+
+        // PHASE 2: Portals = shared border segments between two regions.
+        // Two rectangles share at most one contiguous segment, so the extent
+        // along the border is enough to describe it.
+        struct Portal {
+            bool vertical;  // Border is a vertical line at x = line
+            int line;
+            int lo;         // Segment [lo, hi) along the border, in pixels
+            int hi;
+        };
+        std::map<std::pair<int, int>, Portal> portals;
+
+        auto addPortalPiece = [&](int a, int b, bool vertical, int line, int lo) {
+            auto key = std::make_pair(std::min(a, b), std::max(a, b));
+            auto it = portals.find(key);
+            if (it == portals.end()) {
+                portals.emplace(key, Portal{vertical, line, lo, lo + stepSize});
+            } else {
+                it->second.lo = std::min(it->second.lo, lo);
+                it->second.hi = std::max(it->second.hi, lo + stepSize);
+            }
+        };
+
+        for (int tileGridY = 0; tileGridY < tilesY; ++tileGridY) {
+            for (int tileGridX = 0; tileGridX < tilesX; ++tileGridX) {
+                int current = tileRegion[getTileKey(tileGridX, tileGridY)];
+                if (current < 0) continue;
+
+                if (tileGridX + 1 < tilesX) {
+                    int right = tileRegion[getTileKey(tileGridX + 1, tileGridY)];
+                    if (right >= 0 && right != current) {
+                        addPortalPiece(current, right, true, (tileGridX + 1) * stepSize, tileGridY * stepSize);
+                    }
+                }
+                if (tileGridY + 1 < tilesY) {
+                    int down = tileRegion[getTileKey(tileGridX, tileGridY + 1)];
+                    if (down >= 0 && down != current) {
+                        addPortalPiece(current, down, false, (tileGridY + 1) * stepSize, tileGridX * stepSize);
+                    }
+                }
+            }
+        }
+
+        // Cost = centre -> portal midpoint -> centre (straight inside each
+        // convex region, so never shorter than the real free-space path)
+        const auto& nodes = mesh.GetAllNodes();
+        for (const auto& entry : portals) {
+            int a = entry.first.first;
+            int b = entry.first.second;
+            const Portal& portal = entry.second;
+
+            float midAlong = 0.5f * (portal.lo + portal.hi);
+            float px = portal.vertical ? static_cast<float>(portal.line) : midAlong;
+            float py = portal.vertical ? midAlong : static_cast<float>(portal.line);
+
+            float cost = std::hypot(nodes[a].coords.x - px, nodes[a].coords.y - py) +
+                         std::hypot(nodes[b].coords.x - px, nodes[b].coords.y - py);
+            mesh.AddEdge(a, b, cost);
+            mesh.AddEdge(b, a, cost);
+        }
+
+        std::cout << "[NavMeshGenerator] Created " << portals.size() << " portal edges (bi-directional)" << std::endl;
+
+        // PHASE 3: Record region geometry, then drop unreachable regions
+        // (IDs in the region table are remapped along with the nodes)
+        mesh.SetRegions(std::move(regions), stepSize, tilesX, tilesY, std::move(tileRegion));
+
+        int orphansRemoved = mesh.RemoveOrphanNodes();
+        if (orphansRemoved > 0) {
+            std::cout << "[NavMeshGenerator] Removed " << orphansRemoved << " unreachable regions" << std::endl;
+        }
     }
 
     // =========================================================================
     // MAIN COMPUTE FUNCTION - UNIFORM TILING
     // =========================================================================
+    NavMeshGenerator::NavMeshGenerator()
+        : mode(TilingMode::UNIFORM_TILES), maxRegionTiles(DEFAULT_MAX_REGION_TILES) {}
+
+    void NavMeshGenerator::SetTilingMode(TilingMode tilingMode, int maxTiles) {
+        mode = tilingMode;
+        maxRegionTiles = std::max(1, maxTiles);
+    }
+
+    NavMeshGenerator::TilingMode NavMeshGenerator::GetTilingMode() const {
+        return mode;
+    }
+
     void NavMeshGenerator::ComputeRecast(const AbstractGrid& map, NavMesh& mesh) {
         auto dims = map.GetDimensions();
         int mapW = dims.first;
@@ -216,8 +331,10 @@ namespace Layer1 {
         
         Backend::Common::Resolution resolution = map.GetResolution();
         int stepSize = GetStepSize(resolution);
-
-        std::cout << "[NavMeshGenerator] Starting Uniform Tiling..." << std::endl;
+        
+        std::cout << "[NavMeshGenerator] Starting "
+                  << (mode == TilingMode::MERGED_RECTANGLES ? "Merged-Rectangle" : "Uniform")
+                  << " Tiling..." << std::endl;
         std::cout << "[NavMeshGenerator] Map: " << mapW << "x" << mapH << " pixels" << std::endl;
         std::cout << "[NavMeshGenerator] Resolution: " 
                   << Backend::Common::GetResolutionName(resolution)
@@ -229,34 +346,79 @@ namespace Layer1 {
         std::cout << "[NavMeshGenerator] Expected Grid: " << tilesX << "x" << tilesY 
                   << " = " << (tilesX * tilesY) << " max tiles" << std::endl;
 
+        // One pass over the map; every tile and corridor check below is O(1)
+        BlockedAreaTable table(map);
+
+        // Tile rows are independent, so classification runs in parallel
+        // across cores. Results are written to per-tile slots and merged in
+        // row-major order afterwards, keeping node IDs and edge order identical
+        // to a sequential scan.
+        auto forEachTileRow = [tilesY](const std::function<void(int)>& work) {
+            int numThreads = static_cast<int>(std::thread::hardware_concurrency());
+            numThreads = std::max(1, std::min(numThreads, tilesY));
+            
+            std::atomic<int> nextRow{0};
+            auto worker = [&]() {
+                for (int row = nextRow++; row < tilesY; row = nextRow++) {
+                    work(row);
+                }
+            };
+            
+            std::vector<std::thread> threads;
+            for (int t = 1; t < numThreads; ++t) {
+                threads.emplace_back(worker);
+            }
+            worker();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        };
+
         // =====================================================================
         // PHASE 1: Create Nodes (Uniform Grid Sampling)
         // =====================================================================
-        // Map from (tileGridX, tileGridY) -> nodeId for edge creation
-        std::unordered_map<int, int> tileToNodeId;
+        // tileNodeId[gy * tilesX + gx] -> nodeId, or -1 if the tile has no node
+        std::vector<int> tileNodeId(static_cast<size_t>(tilesX) * tilesY, -1);
+        std::vector<char> tileAccessible(static_cast<size_t>(tilesX) * tilesY, 0);
         
         auto getTileKey = [tilesX](int gx, int gy) -> int {
             return gy * tilesX + gx;
         };
 
-        int nodeIdCounter = 0;
-        
-        for (int tileGridY = 0; tileGridY < tilesY; ++tileGridY) {
+        forEachTileRow([&](int tileGridY) {
             for (int tileGridX = 0; tileGridX < tilesX; ++tileGridX) {
                 // Calculate pixel coordinates of tile's top-left
                 int pixelX = tileGridX * stepSize;
                 int pixelY = tileGridY * stepSize;
                 
-                // Check if tile is accessible
-                if (IsTileAccessible(map, pixelX, pixelY, stepSize)) {
-                    // Create node at tile center
-                    int centerX = pixelX + stepSize / 2;
-                    int centerY = pixelY + stepSize / 2;
-                    
-                    mesh.AddNode({centerX, centerY});
-                    tileToNodeId[getTileKey(tileGridX, tileGridY)] = nodeIdCounter;
-                    ++nodeIdCounter;
-                }
+                tileAccessible[getTileKey(tileGridX, tileGridY)] =
+                    IsTileAccessible(table, mapW, mapH, pixelX, pixelY, stepSize);
+            }
+        });
+
+        if (mode == TilingMode::MERGED_RECTANGLES) {
+            BuildMergedRegions(tileAccessible, tilesX, tilesY, stepSize, maxRegionTiles, mesh);
+            
+            // Nodes are sparse and unevenly spaced: let the spatial index
+            // pick its bucket size from the node density
+            mesh.SetTileSize(stepSize);
+            mesh.Finalize();
+            return;
+        }
+
+        int nodeIdCounter = 0;
+        
+        for (int tileGridY = 0; tileGridY < tilesY; ++tileGridY) {
+            for (int tileGridX = 0; tileGridX < tilesX; ++tileGridX) {
+                if (!tileAccessible[getTileKey(tileGridX, tileGridY)]) continue;
+                
+                // Create node at tile center
+                int centerX = tileGridX * stepSize + stepSize / 2;
+                int centerY = tileGridY * stepSize + stepSize / 2;
+                
+                mesh.AddNode({centerX, centerY});
+                tileNodeId[getTileKey(tileGridX, tileGridY)] = nodeIdCounter;
+                ++nodeIdCounter;
             }
         }
 
@@ -265,62 +427,63 @@ namespace Layer1 {
         // =====================================================================
         // PHASE 2: Create Edges (4-Connected Neighbors with Robot Clearance Check)
         // =====================================================================
+        // Node IDs grow in row-major order, so each undirected edge is owned
+        // by the tile on its left / top: only the Right and Down neighbours
+        // need checking.
+        enum : char { PASS_RIGHT = 1, PASS_DOWN = 2 };
+        std::vector<char> tilePassable(static_cast<size_t>(tilesX) * tilesY, 0);
+        
+        forEachTileRow([&](int tileGridY) {
+            for (int tileGridX = 0; tileGridX < tilesX; ++tileGridX) {
+                if (tileNodeId[getTileKey(tileGridX, tileGridY)] < 0) continue;
+                
+                int pixelX = tileGridX * stepSize;
+                int pixelY = tileGridY * stepSize;
+                char flags = 0;
+                
+                // CHECK: Can a robot actually pass between these tiles?
+                if (tileGridX + 1 < tilesX &&
+                    tileNodeId[getTileKey(tileGridX + 1, tileGridY)] >= 0 &&
+                    CanRobotPassBetween(table, pixelX, pixelY,
+                                        pixelX + stepSize, pixelY, stepSize)) {
+                    flags |= PASS_RIGHT;
+                }
+                if (tileGridY + 1 < tilesY &&
+                    tileNodeId[getTileKey(tileGridX, tileGridY + 1)] >= 0 &&
+                    CanRobotPassBetween(table, pixelX, pixelY,
+                                        pixelX, pixelY + stepSize, stepSize)) {
+                    flags |= PASS_DOWN;
+                }
+                
+                tilePassable[getTileKey(tileGridX, tileGridY)] = flags;
+            }
+        });
+
         int edgeCount = 0;
         
-        // Direction offsets for 4-connectivity
-        const int dx[] = {1, 0, -1, 0};  // Right, Down, Left, Up
-        const int dy[] = {0, 1, 0, -1};
+        // Cost = Euclidean distance = stepSize for cardinal directions
+        const float cost = static_cast<float>(stepSize);
         
         for (int tileGridY = 0; tileGridY < tilesY; ++tileGridY) {
             for (int tileGridX = 0; tileGridX < tilesX; ++tileGridX) {
                 int currentKey = getTileKey(tileGridX, tileGridY);
+                char flags = tilePassable[currentKey];
+                if (flags == 0) continue;
                 
-                // Skip if this tile has no node
-                auto currentIt = tileToNodeId.find(currentKey);
-                if (currentIt == tileToNodeId.end()) continue;
-                
-                int currentNodeId = currentIt->second;
-                
-                // Pixel coordinates of current tile
-                int currentPixelX = tileGridX * stepSize;
-                int currentPixelY = tileGridY * stepSize;
+                int currentNodeId = tileNodeId[currentKey];
                 
-                // Check all 4 neighbors
-                for (int d = 0; d < 4; ++d) {
-                    int neighborGridX = tileGridX + dx[d];
-                    int neighborGridY = tileGridY + dy[d];
-                    
-                    // Bounds check
-                    if (neighborGridX < 0 || neighborGridX >= tilesX ||
-                        neighborGridY < 0 || neighborGridY >= tilesY) {
-                        continue;
-                    }
-                    
-                    int neighborKey = getTileKey(neighborGridX, neighborGridY);
-                    auto neighborIt = tileToNodeId.find(neighborKey);
-                    
-                    if (neighborIt != tileToNodeId.end()) {
-                        int neighborNodeId = neighborIt->second;
-                        
-                        // Pixel coordinates of neighbor tile
-                        int neighborPixelX = neighborGridX * stepSize;
-                        int neighborPixelY = neighborGridY * stepSize;
-                        
-                        // Only add edge in one direction to avoid double-counting
-                        if (currentNodeId < neighborNodeId) {
-                            // CHECK: Can a robot actually pass between these tiles?
-                            if (CanRobotPassBetween(map, currentPixelX, currentPixelY,
-                                                    neighborPixelX, neighborPixelY, stepSize)) {
-                                // Cost = Euclidean distance = stepSize for cardinal directions
-                                float cost = static_cast<float>(stepSize);
-                                
-                                // Add bi-directional edges
-                                mesh.AddEdge(currentNodeId, neighborNodeId, cost);
-                                mesh.AddEdge(neighborNodeId, currentNodeId, cost);
-                                ++edgeCount;
-                            }
-                        }
-                    }
+                // Add bi-directional edges
+                if (flags & PASS_RIGHT) {
+                    int neighborNodeId = tileNodeId[getTileKey(tileGridX + 1, tileGridY)];
+                    mesh.AddEdge(currentNodeId, neighborNodeId, cost);
+                    mesh.AddEdge(neighborNodeId, currentNodeId, cost);
+                    ++edgeCount;
+                }
+                if (flags & PASS_DOWN) {
+                    int neighborNodeId = tileNodeId[getTileKey(tileGridX, tileGridY + 1)];
+                    mesh.AddEdge(currentNodeId, neighborNodeId, cost);
+                    mesh.AddEdge(neighborNodeId, currentNodeId, cost);
+                    ++edgeCount;
                 }
             }
         }
@@ -335,6 +498,12 @@ namespace Layer1 {
             std::cout << "[NavMeshGenerator] Removed " << orphansRemoved << " unreachable nodes" << std::endl;
         }
         
+        // =====================================================================
+        // PHASE 4: Freeze into CSR layout + spatial index (one tile per bucket)
+        // =====================================================================
+        mesh.SetTileSize(stepSize);
+        mesh.Finalize(stepSize);
+        
         // Calculate physical dimensions for verification
         float physicalW = mapW * Backend::Common::GetConversionFactorToMeters(resolution);
         float physicalH = mapH * Backend::Common::GetConversionFactorToMeters(resolution);
@@ -1,10 +1,14 @@
 #include "POIRegistry.hh"
+#include "MemoryUsage.hh"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdlib>
 #include <limits>
+#include <thread>
 
 namespace Backend {
 namespace Layer1 {
@@ -15,6 +19,9 @@ namespace Layer1 {
 
     POIRegistry::POIRegistry() : isMappedToNavMesh(false) {}
 
+    // Below this many POIs the lookups are cheaper than starting threads
+    constexpr size_t PARALLEL_LOOKUP_MIN_POIS = 256;
+
     // =========================================================================
     // TYPE CONVERSION UTILITIES
     // =========================================================================
@@ -110,6 +117,44 @@ namespace Layer1 {
         return defaultVal;
     }
 
+    // Simple helper to extract the flat "key": value pairs of a nested
+    // object (string or bare values, e.g. "metadata": { "capacity": 2 })
+    static std::map<std::string, std::string> extractObjectPairs(const std::string& json, const std::string& key) {
+        std::map<std::string, std::string> pairs;
+        size_t keyPos = json.find("\"" + key + "\"");
+        if (keyPos == std::string::npos) return pairs;
+        
+        size_t objStart = json.find('{', keyPos);
+        size_t objEnd = json.find('}', objStart);
+        if (objStart == std::string::npos || objEnd == std::string::npos) return pairs;
+        
+        size_t pos = objStart + 1;
+        while (true) {
+            size_t nameStart = json.find('"', pos);
+            if (nameStart == std::string::npos || nameStart > objEnd) break;
+            size_t nameEnd = json.find('"', nameStart + 1);
+            size_t colonPos = json.find(':', nameEnd);
+            if (nameEnd == std::string::npos || colonPos == std::string::npos || colonPos > objEnd) break;
+            
+            size_t valueStart = json.find_first_not_of(" \t\r\n", colonPos + 1);
+            if (valueStart == std::string::npos || valueStart >= objEnd) break;
+            std::string value;
+            if (json[valueStart] == '"') {
+                size_t valueEnd = json.find('"', valueStart + 1);
+                if (valueEnd == std::string::npos) break;
+                value = json.substr(valueStart + 1, valueEnd - valueStart - 1);
+                pos = valueEnd + 1;
+            } else {
+                size_t valueEnd = std::min(json.find(',', valueStart), objEnd);
+                value = json.substr(valueStart, valueEnd - valueStart);
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                pos = valueEnd;
+            }
+            pairs[json.substr(nameStart + 1, nameEnd - nameStart - 1)] = value;
+        }
+        return pairs;
+    }
+
     bool POIRegistry::LoadFromJSON(const std::string& filepath) {
         std::cout << "[POIRegistry] Loading POI configuration from: " << filepath << std::endl;
         
@@ -155,8 +200,13 @@ namespace Layer1 {
             size_t objStart = content.find('{', pos);
             if (objStart == std::string::npos) break;
             
-            size_t objEnd = content.find('}', objStart);
-            if (objEnd == std::string::npos) break;
+            // Matching brace: the metadata object nests inside
+            size_t objEnd = objStart;
+            for (int depth = 0; objEnd < content.size(); ++objEnd) {
+                if (content[objEnd] == '{') ++depth;
+                if (content[objEnd] == '}' && --depth == 0) break;
+            }
+            if (objEnd >= content.size()) break;
             
             // Check if we've gone past the array end
             size_t arrayEnd = content.find(']', arrayStart);
@@ -177,7 +227,11 @@ namespace Layer1 {
                 Backend::Common::Coordinates coords{x, y};
                 
                 // All types now map to CHARGING or PACKET
-                AddPOI(id, type, coords, active);
+                if (AddPOI(id, type, coords, active) >= 0) {
+                    for (const auto& [key, value] : extractObjectPairs(poiObj, "metadata")) {
+                        SetPOIMetadata(id, key, value);
+                    }
+                }
                 ++loadedCount;
             }
             
@@ -208,6 +262,7 @@ namespace Layer1 {
         poi.nearestNodeId = -1;  // Not mapped yet
         poi.distanceToNode = -1.0f;
         poi.isActive = active;
+        poi.capacity = 1;
 
         int index = static_cast<int>(allPOIs.size());
         allPOIs.push_back(poi);
@@ -245,7 +300,8 @@ namespace Layer1 {
         int failCount = 0;
         int disabledCount = 0;
         
-        const auto& nodes = mesh.GetAllNodes();
+        // Safety checks and nearest-node lookups (parallel for large sites)
+        const std::vector<NodeLookup> lookups = LookupNodes(mesh, &safetyMap);
         
         for (size_t i = 0; i < allPOIs.size(); ++i) {
             PointOfInterest& poi = allPOIs[i];
@@ -255,7 +311,7 @@ namespace Layer1 {
             // If the POI coordinate is in the "Gray Zone" of the Inflated Map,
             // the robot physically cannot go there without clipping a wall.
             // ===================================================================
-            if (!safetyMap.IsAccessible(poi.worldCoords)) {
+            if (!lookups[i].isSafe) {
                 std::cerr << "[POIRegistry] \033[1;31mCRITICAL WARNING\033[0m: POI '" << poi.id 
                           << "' at (" << poi.worldCoords.x << "," << poi.worldCoords.y << ")"
                           << " is inside an Obstacle Inflation Zone!" << std::endl;
@@ -269,17 +325,9 @@ namespace Layer1 {
                 continue;
             }
             
-            // Find nearest node
-            int bestNodeId = -1;
-            float bestDist = std::numeric_limits<float>::max();
-            
-            for (size_t n = 0; n < nodes.size(); ++n) {
-                float dist = poi.worldCoords.DistanceTo(nodes[n].coords);
-                if (dist < bestDist) {
-                    bestDist = dist;
-                    bestNodeId = static_cast<int>(n);
-                }
-            }
+            // Nearest node
+            int bestNodeId = lookups[i].nodeId;
+            float bestDist = lookups[i].distance;
             
             // Check if within max distance (if specified)
             if (maxDistance > 0.0f && bestDist > maxDistance) {
@@ -301,6 +349,7 @@ namespace Layer1 {
         }
         
         isMappedToNavMesh = true;
+        RebuildNodeIndex();
         
         std::cout << "[POIRegistry] Validation complete:" << std::endl;
         std::cout << "              " << successCount << " POIs validated and mapped successfully" << std::endl;
@@ -324,22 +373,15 @@ namespace Layer1 {
         int successCount = 0;
         int failCount = 0;
         
-        const auto& nodes = mesh.GetAllNodes();
+        // Nearest-node lookups (parallel for large sites)
+        const std::vector<NodeLookup> lookups = LookupNodes(mesh, nullptr);
         
         for (size_t i = 0; i < allPOIs.size(); ++i) {
             PointOfInterest& poi = allPOIs[i];
             
-            // Find nearest node
-            int bestNodeId = -1;
-            float bestDist = std::numeric_limits<float>::max();
-            
-            for (size_t n = 0; n < nodes.size(); ++n) {
-                float dist = poi.worldCoords.DistanceTo(nodes[n].coords);
-                if (dist < bestDist) {
-                    bestDist = dist;
-                    bestNodeId = static_cast<int>(n);
-                }
-            }
+            // Nearest node
+            int bestNodeId = lookups[i].nodeId;
+            float bestDist = lookups[i].distance;
             
             // Check if within max distance (if specified)
             if (maxDistance > 0.0f && bestDist > maxDistance) {
@@ -361,6 +403,7 @@ namespace Layer1 {
         }
         
         isMappedToNavMesh = true;
+        RebuildNodeIndex();
         
         std::cout << "[POIRegistry] Mapped " << successCount << " POIs successfully";
         if (failCount > 0) {
@@ -371,6 +414,101 @@ namespace Layer1 {
         return successCount;
     }
 
+    std::vector<POIRegistry::NodeLookup> POIRegistry::LookupNodes(const NavMesh& mesh,
+                                                                  const AbstractGrid* safetyMap) const {
+        std::vector<NodeLookup> lookups(allPOIs.size());
+        const auto& nodes = mesh.GetAllNodes();
+        
+        auto lookup = [&](size_t i) {
+            const PointOfInterest& poi = allPOIs[i];
+            NodeLookup& result = lookups[i];
+            result.isSafe = (safetyMap == nullptr) || safetyMap->IsAccessible(poi.worldCoords);
+            result.nodeId = -1;
+            result.distance = std::numeric_limits<float>::max();
+            if (!result.isSafe) return;
+            
+            result.nodeId = mesh.GetNodeIdAt(poi.worldCoords);
+            if (result.nodeId >= 0) {
+                result.distance = poi.worldCoords.DistanceTo(nodes[result.nodeId].coords);
+            }
+        };
+        
+        int numThreads = static_cast<int>(std::thread::hardware_concurrency());
+        if (allPOIs.size() < PARALLEL_LOOKUP_MIN_POIS || numThreads <= 1) {
+            for (size_t i = 0; i < allPOIs.size(); ++i) {
+                lookup(i);
+            }
+            return lookups;
+        }
+        
+        // Each POI writes only its own slot; chunks are handed out dynamically
+        constexpr size_t CHUNK = 64;
+        std::atomic<size_t> nextChunk{0};
+        auto worker = [&]() {
+            for (size_t begin = nextChunk.fetch_add(CHUNK); begin < allPOIs.size();
+                 begin = nextChunk.fetch_add(CHUNK)) {
+                size_t end = std::min(begin + CHUNK, allPOIs.size());
+                for (size_t i = begin; i < end; ++i) {
+                    lookup(i);
+                }
+            }
+        };
+        
+        std::vector<std::thread> threads;
+        for (int t = 1; t < numThreads; ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return lookups;
+    }
+
+    void POIRegistry::RebuildNodeIndex() {
+        nodeIndexByType.clear();
+        
+        for (const auto& entry : poiByType) {
+            TypeNodeIndex& index = nodeIndexByType[entry.first];
+            std::set<int> seen;
+            
+            for (int poiIdx : entry.second) {
+                const PointOfInterest& poi = allPOIs[poiIdx];
+                if (poi.nearestNodeId < 0) continue;
+                
+                if (seen.insert(poi.nearestNodeId).second) {
+                    index.mappedNodes.push_back(poi.nearestNodeId);
+                }
+                if (poi.isActive) {
+                    UpdateActiveIndex(poiIdx, true);
+                }
+            }
+        }
+    }
+
+    void POIRegistry::UpdateActiveIndex(int poiIdx, bool active) {
+        const PointOfInterest& poi = allPOIs[poiIdx];
+        if (poi.nearestNodeId < 0) return;
+        
+        TypeNodeIndex& index = nodeIndexByType[poi.type];
+        std::set<int>& atNode = index.activePOIsAtNode[poi.nearestNodeId];
+        
+        // The node is keyed by its lowest active POI index; re-key on change
+        if (!atNode.empty()) {
+            index.activeNodeByFirstPOI.erase(*atNode.begin());
+        }
+        if (active) {
+            atNode.insert(poiIdx);
+        } else {
+            atNode.erase(poiIdx);
+        }
+        if (!atNode.empty()) {
+            index.activeNodeByFirstPOI[*atNode.begin()] = poi.nearestNodeId;
+        } else {
+            index.activePOIsAtNode.erase(poi.nearestNodeId);
+        }
+    }
+
     bool POIRegistry::IsMapped() const {
         return isMappedToNavMesh;
     }
@@ -380,24 +518,9 @@ namespace Layer1 {
     // =========================================================================
 
     std::vector<int> POIRegistry::GetNodesByType(POIType type) const {
-        std::vector<int> nodeIds;
-        
-        auto it = poiByType.find(type);
-        if (it == poiByType.end()) return nodeIds;
-        
-        for (int poiIdx : it->second) {
-            if (poiIdx >= 0 && poiIdx < static_cast<int>(allPOIs.size())) {
-                int nodeId = allPOIs[poiIdx].nearestNodeId;
-                if (nodeId >= 0) {
-                    // Avoid duplicates if multiple POIs map to same node
-                    if (std::find(nodeIds.begin(), nodeIds.end(), nodeId) == nodeIds.end()) {
-                        nodeIds.push_back(nodeId);
-                    }
-                }
-            }
-        }
-        
-        return nodeIds;
+        auto it = nodeIndexByType.find(type);
+        if (it == nodeIndexByType.end()) return {};
+        return it->second.mappedNodes;
     }
 
     std::vector<int> POIRegistry::GetNodesByTypeName(const std::string& typeName) const {
@@ -489,25 +612,39 @@ namespace Layer1 {
         auto it = poiById.find(id);
         if (it == poiById.end()) return false;
         
-        allPOIs[it->second].isActive = active;
+        PointOfInterest& poi = allPOIs[it->second];
+        if (poi.isActive != active) {
+            poi.isActive = active;
+            UpdateActiveIndex(it->second, active);
+        }
+        return true;
+    }
+
+    bool POIRegistry::SetPOIMetadata(const std::string& id, const std::string& key, const std::string& value) {
+        auto it = poiById.find(id);
+        if (it == poiById.end()) return false;
+        
+        PointOfInterest& poi = allPOIs[it->second];
+        poi.metadata[key] = value;
+        if (key == "capacity") {
+            char* end = nullptr;
+            long capacity = std::strtol(value.c_str(), &end, 10);
+            if (end != value.c_str() && *end == '\0' && capacity > 0) {
+                poi.capacity = static_cast<int>(std::min<long>(capacity, std::numeric_limits<int>::max()));
+            }
+        }
         return true;
     }
 
     std::vector<int> POIRegistry::GetActiveNodesByType(POIType type) const {
         std::vector<int> nodeIds;
         
-        auto it = poiByType.find(type);
-        if (it == poiByType.end()) return nodeIds;
+        auto it = nodeIndexByType.find(type);
+        if (it == nodeIndexByType.end()) return nodeIds;
         
-        for (int poiIdx : it->second) {
-            if (poiIdx >= 0 && poiIdx < static_cast<int>(allPOIs.size())) {
-                const PointOfInterest& poi = allPOIs[poiIdx];
-                if (poi.isActive && poi.nearestNodeId >= 0) {
-                    if (std::find(nodeIds.begin(), nodeIds.end(), poi.nearestNodeId) == nodeIds.end()) {
-                        nodeIds.push_back(poi.nearestNodeId);
-                    }
-                }
-            }
+        nodeIds.reserve(it->second.activeNodeByFirstPOI.size());
+        for (const auto& entry : it->second.activeNodeByFirstPOI) {
+            nodeIds.push_back(entry.second);
         }
         
         return nodeIds;
@@ -526,12 +663,32 @@ namespace Layer1 {
         return it != poiByType.end() ? it->second.size() : 0;
     }
 
+    size_t POIRegistry::GetMemoryBytes() const {
+        using namespace Backend::Common;
+        size_t bytes = VectorBytes(allPOIs);
+        for (const auto& poi : allPOIs) {
+            bytes += StringBytes(poi.id) + StringBytes(poi.typeName);
+        }
+        bytes += HashMapBytes(poiById);
+        for (const auto& entry : poiById) bytes += StringBytes(entry.first);
+        bytes += HashMapBytes(poiByNodeId);
+        for (const auto& entry : poiByNodeId) bytes += VectorBytes(entry.second);
+        bytes += HashMapBytes(poiByType) + HashMapBytes(poiByTypeName);
+        for (const auto& entry : poiByType) bytes += VectorBytes(entry.second);
+        for (const auto& entry : poiByTypeName) bytes += VectorBytes(entry.second);
+        for (const auto& entry : nodeIndexByType) {
+            bytes += VectorBytes(entry.second.mappedNodes) + HashMapBytes(entry.second.activePOIsAtNode);
+        }
+        return bytes;
+    }
+
     void POIRegistry::Clear() {
         allPOIs.clear();
         poiByType.clear();
         poiByTypeName.clear();
         poiByNodeId.clear();
         poiById.clear();
+        nodeIndexByType.clear();
         isMappedToNavMesh = false;
     }
 
@@ -554,6 +711,7 @@ namespace Layer1 {
             file << "      \"x\": " << poi.worldCoords.x << ",\n";
             file << "      \"y\": " << poi.worldCoords.y << ",\n";
             file << "      \"active\": " << (poi.isActive ? "true" : "false") << ",\n";
+            file << "      \"capacity\": " << poi.capacity << ",\n";
             file << "      \"nearestNodeId\": " << poi.nearestNodeId << ",\n";
             file << "      \"distanceToNode\": " << poi.distanceToNode << "\n";
             file << "    }";
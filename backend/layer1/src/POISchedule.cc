@@ -0,0 +1,135 @@
+#include "POISchedule.hh"
+#include "MemoryUsage.hh"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Backend {
+namespace Layer1 {
+
+    POISchedule::POISchedule(const POIRegistry& registry, const NavMesh& mesh,
+                             double slot, float holdingDistance)
+        : slotSeconds(std::max(slot, 0.0)) {
+        const int nodeCount = static_cast<int>(mesh.GetAllNodes().size());
+        for (POIType type : {POIType::PICKUP, POIType::DROPOFF}) {
+            for (const PointOfInterest* poi : registry.GetPOIsByType(type)) {
+                int node = poi->nearestNodeId;
+                if (node < 0 || node >= nodeCount || !poi->isActive) continue;
+                Station& station = stations.try_emplace(node, Station{0, -1, {}}).first->second;
+                station.capacity += std::max(1, poi->capacity);
+            }
+        }
+        for (auto& [nodeId, station] : stations) {
+            station.holdingNode = FindHoldingNode(mesh, registry, nodeId, holdingDistance);
+        }
+    }
+
+    int POISchedule::FindHoldingNode(const NavMesh& mesh, const POIRegistry& registry,
+                                     int nodeId, float distance) {
+        const auto& nodes = mesh.GetAllNodes();
+        if (nodeId < 0 || nodeId >= static_cast<int>(nodes.size())) return -1;
+        std::vector<char> isPOINode(nodes.size(), 0);
+        for (POIType type : {POIType::CHARGING, POIType::PICKUP, POIType::DROPOFF}) {
+            for (const PointOfInterest* poi : registry.GetPOIsByType(type)) {
+                int node = poi->nearestNodeId;
+                if (node >= 0 && node < static_cast<int>(nodes.size())) isPOINode[node] = 1;
+            }
+        }
+
+        // Closest to the wanted distance, so a holding spot is off the
+        // station but not across the hall
+        const auto& at = nodes[nodeId].coords;
+        int best = -1;
+        double bestError = std::numeric_limits<double>::max();
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            if (isPOINode[n] || mesh.GetNeighbors(static_cast<int>(n)).empty()) continue;
+            double dx = nodes[n].coords.x - at.x;
+            double dy = nodes[n].coords.y - at.y;
+            double error = std::abs(std::sqrt(dx * dx + dy * dy) - distance);
+            if (error < bestError) {
+                bestError = error;
+                best = static_cast<int>(n);
+            }
+        }
+        return best;
+    }
+
+    bool POISchedule::IsScheduled(int nodeId) const {
+        return stations.count(nodeId) > 0;
+    }
+
+    int POISchedule::GetCapacity(int nodeId) const {
+        auto it = stations.find(nodeId);
+        return it != stations.end() ? it->second.capacity : 0;
+    }
+
+    int POISchedule::GetHoldingNode(int nodeId) const {
+        auto it = stations.find(nodeId);
+        return it != stations.end() ? it->second.holdingNode : -1;
+    }
+
+    double POISchedule::Reserve(int nodeId, int robotId, double arrival, double now) {
+        Release(robotId);
+        auto it = stations.find(nodeId);
+        if (it == stations.end()) return arrival;
+        Station& station = it->second;
+
+        // The earliest free slot starts at the arrival or when a booked one ends
+        auto endOf = [now](const Reservation& r) { return std::max(r.end, now); };
+        auto overlapping = [&](double start) {
+            int count = 0;
+            for (const Reservation& r : station.reservations) {
+                if (r.start < start + slotSeconds && endOf(r) > start) ++count;
+            }
+            return count;
+        };
+        double start = arrival;
+        if (overlapping(start) >= station.capacity) {
+            start = std::numeric_limits<double>::max();
+            for (const Reservation& r : station.reservations) {
+                double candidate = endOf(r);
+                if (candidate > arrival && candidate < start && overlapping(candidate) < station.capacity) {
+                    start = candidate;
+                }
+            }
+        }
+
+        Reservation booked{robotId, start, start + slotSeconds};
+        auto at = std::upper_bound(station.reservations.begin(), station.reservations.end(), start,
+                                   [](double s, const Reservation& r) { return s < r.start; });
+        station.reservations.insert(at, booked);
+        nodeOfRobot[robotId] = nodeId;
+        return start;
+    }
+
+    void POISchedule::Release(int robotId) {
+        auto held = nodeOfRobot.find(robotId);
+        if (held == nodeOfRobot.end()) return;
+        auto& reservations = stations[held->second].reservations;
+        reservations.erase(std::remove_if(reservations.begin(), reservations.end(),
+                                          [robotId](const Reservation& r) { return r.robotId == robotId; }),
+                           reservations.end());
+        nodeOfRobot.erase(held);
+    }
+
+    int POISchedule::GetReservedNode(int robotId) const {
+        auto held = nodeOfRobot.find(robotId);
+        return held != nodeOfRobot.end() ? held->second : -1;
+    }
+
+    size_t POISchedule::GetStationCount() const {
+        return stations.size();
+    }
+
+    size_t POISchedule::GetReservationCount() const {
+        return nodeOfRobot.size();
+    }
+
+    size_t POISchedule::GetMemoryBytes() const {
+        size_t bytes = Common::HashMapBytes(stations) + Common::HashMapBytes(nodeOfRobot);
+        for (const auto& entry : stations) bytes += Common::VectorBytes(entry.second.reservations);
+        return bytes;
+    }
+
+} // namespace Layer1
+} // namespace Backend
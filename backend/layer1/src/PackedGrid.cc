@@ -0,0 +1,144 @@
+#include "PackedGrid.hh"
+#include <algorithm>
+
+namespace Backend {
+namespace Layer1 {
+
+    // Mask with bits [lo, hi] set (0 <= lo <= hi < 64)
+    static inline PackedGrid::Word BitRange(int lo, int hi) {
+        const PackedGrid::Word upper = ~PackedGrid::Word(0) >> (63 - hi);
+        const PackedGrid::Word lower = ~PackedGrid::Word(0) << lo;
+        return upper & lower;
+    }
+
+    PackedGrid::PackedGrid()
+        : width(0), height(0), wordsPerRow(0) {}
+
+    PackedGrid::PackedGrid(int w, int h, bool value)
+        : width(w), height(h),
+          wordsPerRow((w + BITS_PER_WORD - 1) / BITS_PER_WORD) {
+        words.assign(static_cast<size_t>(wordsPerRow) * height,
+                     value ? ~Word(0) : Word(0));
+        if (value) ClearPadding();
+    }
+
+    PackedGrid::PackedGrid(int w, int h, const Word* data)
+        : width(w), height(h),
+          wordsPerRow((w + BITS_PER_WORD - 1) / BITS_PER_WORD) {
+        words.assign(data, data + static_cast<size_t>(wordsPerRow) * height);
+        ClearPadding();
+    }
+
+    void PackedGrid::ClearPadding() {
+        if (wordsPerRow == 0) return;
+        const Word lastMask = GetValidMask(wordsPerRow - 1);
+        for (int y = 0; y < height; ++y) {
+            words[static_cast<size_t>(y) * wordsPerRow + wordsPerRow - 1] &= lastMask;
+        }
+    }
+
+    PackedGrid::Word PackedGrid::GetValidMask(int wordIdx) const {
+        const int firstCell = wordIdx * BITS_PER_WORD;
+        const int remaining = width - firstCell;
+        if (remaining >= BITS_PER_WORD) return ~Word(0);
+        if (remaining <= 0) return 0;
+        return BitRange(0, remaining - 1);
+    }
+
+    bool PackedGrid::IsRunSet(int x, int y, int length) const {
+        if (length <= 0) return true;
+        if (x < 0 || y < 0 || y >= height || x + length > width) return false;
+
+        const Word* row = GetRow(y);
+        const int lastX = x + length - 1;
+        const int firstWord = x >> 6;
+        const int lastWord = lastX >> 6;
+
+        if (firstWord == lastWord) {
+            const Word mask = BitRange(x & 63, lastX & 63);
+            return (row[firstWord] & mask) == mask;
+        }
+
+        const Word headMask = BitRange(x & 63, 63);
+        if ((row[firstWord] & headMask) != headMask) return false;
+
+        for (int i = firstWord + 1; i < lastWord; ++i) {
+            if (row[i] != ~Word(0)) return false;
+        }
+
+        const Word tailMask = BitRange(0, lastX & 63);
+        return (row[lastWord] & tailMask) == tailMask;
+    }
+
+    bool PackedGrid::IsRectSet(int x, int y, int w, int h) const {
+        if (w <= 0 || h <= 0) return true;
+        if (y < 0 || y + h > height) return false;
+
+        for (int row = y; row < y + h; ++row) {
+            if (!IsRunSet(x, row, w)) return false;
+        }
+        return true;
+    }
+
+    void PackedGrid::SetRun(int x, int y, int length, bool value) {
+        if (y < 0 || y >= height) return;
+
+        // Clip to [0, width)
+        int startX = std::max(x, 0);
+        int endX = std::min(x + length, width);  // exclusive
+        if (startX >= endX) return;
+
+        Word* row = words.data() + static_cast<size_t>(y) * wordsPerRow;
+        const int lastX = endX - 1;
+        const int firstWord = startX >> 6;
+        const int lastWord = lastX >> 6;
+
+        for (int i = firstWord; i <= lastWord; ++i) {
+            const int lo = (i == firstWord) ? (startX & 63) : 0;
+            const int hi = (i == lastWord) ? (lastX & 63) : 63;
+            const Word mask = BitRange(lo, hi);
+            if (value) row[i] |= mask;
+            else row[i] &= ~mask;
+        }
+    }
+
+    void PackedGrid::CopyRun(const PackedGrid& src, int x, int y, int length) {
+        if (y < 0 || y >= height) return;
+
+        int startX = std::max(x, 0);
+        int endX = std::min(x + length, width);  // exclusive
+        if (startX >= endX) return;
+
+        Word* row = words.data() + static_cast<size_t>(y) * wordsPerRow;
+        const Word* srcRow = src.GetRow(y);
+        const int lastX = endX - 1;
+        const int firstWord = startX >> 6;
+        const int lastWord = lastX >> 6;
+
+        for (int i = firstWord; i <= lastWord; ++i) {
+            const int lo = (i == firstWord) ? (startX & 63) : 0;
+            const int hi = (i == lastWord) ? (lastX & 63) : 63;
+            const Word mask = BitRange(lo, hi);
+            row[i] = (row[i] & ~mask) | (srcRow[i] & mask);
+        }
+    }
+
+    void PackedGrid::Fill(bool value) {
+        std::fill(words.begin(), words.end(), value ? ~Word(0) : Word(0));
+        if (value) ClearPadding();
+    }
+
+    int PackedGrid::CountSet() const {
+        int count = 0;
+        for (Word w : words) {
+            count += __builtin_popcountll(w);
+        }
+        return count;
+    }
+
+    bool PackedGrid::operator==(const PackedGrid& other) const {
+        return width == other.width && height == other.height && words == other.words;
+    }
+
+} // namespace Layer1
+} // namespace Backend
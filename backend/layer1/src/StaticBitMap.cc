@@ -1,91 +1,74 @@
 #include "StaticBitMap.hh"
+#include "MapFile.hh"
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
 
 namespace Backend {
 namespace Layer1 {
 
     StaticBitMap::StaticBitMap(int w, int h, Backend::Common::Resolution res)
-        : AbstractGrid(w, h, res) {
-        // Initialize all true (walkable)
-        gridData.resize(w * h, true);
+        : AbstractGrid(w, h, res),
+          gridData(w, h, true) {  // Initialize all true (walkable)
+    }
+
+    StaticBitMap::StaticBitMap(PackedGrid grid, Backend::Common::Resolution res)
+        : AbstractGrid(grid.GetWidth(), grid.GetHeight(), res),
+          gridData(std::move(grid)) {
     }
 
     bool StaticBitMap::IsAccessible(Backend::Common::Coordinates coords) const {
         if (!IsWithinBounds(coords)) return false;
-        return gridData[coords.y * width + coords.x];
+        return gridData.Get(coords.x, coords.y);
     }
 
-    std::pair<int, int> StaticBitMap::GetFileDimensions(const std::string& filepath) {
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
-            throw std::runtime_error("[StaticBitMap] Failed to open file: " + filepath);
-        }
+    const PackedGrid* StaticBitMap::GetPackedGrid() const {
+        return &gridData;
+    }
 
-        std::string line;
-        int fileHeight = 0;
-        int fileWidth = 0;
-        
-        while (std::getline(file, line)) {
-            if (line.empty()) continue;
-            // Width is the length of the first non-empty line
-            if (fileWidth == 0) {
-                fileWidth = static_cast<int>(line.size());
-            }
-            fileHeight++;
-        }
-        
-        file.close();
-        return {fileWidth, fileHeight};
+    std::pair<int, int> StaticBitMap::GetFileDimensions(const std::string& filepath) {
+        MapFile file(filepath);
+        return {file.GetWidth(), file.GetHeight()};
     }
 
     StaticBitMap StaticBitMap::CreateFromFile(const std::string& filepath, 
                                                Backend::Common::Resolution res) {
-        auto [w, h] = GetFileDimensions(filepath);
-        std::cout << "[StaticBitMap] Detected map dimensions: " << w << "x" << h << std::endl;
+        // One mapping serves both the dimension scan and the decode
+        MapFile file(filepath);
+        std::cout << "[StaticBitMap] Detected map dimensions: "
+                  << file.GetWidth() << "x" << file.GetHeight() << std::endl;
         
-        StaticBitMap map(w, h, res);
-        map.LoadFromFile(filepath);
+        StaticBitMap map(file.GetWidth(), file.GetHeight(), res);
+        std::cout << "[StaticBitMap] Loading map layout from: " << filepath << std::endl;
+        map.LoadFromMapFile(file);
         return map;
     }
 
     void StaticBitMap::LoadFromFile(const std::string& filepath) {
         std::cout << "[StaticBitMap] Loading map layout from: " << filepath << std::endl;
         
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
-            throw std::runtime_error("[StaticBitMap] Failed to open file: " + filepath);
-        }
+        MapFile file(filepath);
+        LoadFromMapFile(file);
+    }
 
-        // Read the grid data row by row (no header line - pure grid format)
-        std::string line;
-        int y = 0;
-        int walkable = 0;
-        int obstacles = 0;
+    void StaticBitMap::LoadFromMapFile(const MapFile& file) {
+        // Read the grid data row by row (no header line - pure grid format),
+        // 64 cells per word write
+        const int rows = std::min(height, file.GetHeight());
+        long long decoded = 0;
+        long long obstacles = 0;
         
-        while (std::getline(file, line) && y < height) {
-            if (line.empty()) continue;  // Skip empty lines
-            
-            for (int x = 0; x < width && x < (int)line.size(); ++x) {
-                char c = line[x];
-                // '.' = walkable (true), '#' = obstacle (false)
-                bool isWalkable = (c == '.');
-                gridData[y * width + x] = isWalkable;
-                if (isWalkable) walkable++;
-                else obstacles++;
-            }
-            ++y;
+        for (int y = 0; y < rows; ++y) {
+            obstacles += file.DecodeRow(y, 0, width, gridData, y);
+            decoded += std::min(width, file.GetRowLength(y));
         }
-
-        file.close();
         
         std::cout << "[StaticBitMap] Loaded " << width << "x" << height << " map. "
-                  << "Walkable: " << walkable << ", Obstacles: " << obstacles << std::endl;
+                  << "Walkable: " << (decoded - obstacles) << ", Obstacles: " << obstacles << std::endl;
     }
 
-    const std::vector<bool>& StaticBitMap::GetRawData() const {
+    const PackedGrid& StaticBitMap::GetRawData() const {
         return gridData;
     }
 
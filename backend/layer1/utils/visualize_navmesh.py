@@ -28,6 +28,8 @@ import json
 import os
 import sys
 import csv
+import mmap
+import struct
 from PIL import Image, ImageDraw, ImageFont
 import math
 
@@ -152,6 +154,45 @@ def load_graph(graph_path):
     return nodes, edges
 
 
+
+# Binary export written by GraphExport::WriteGraph (layer1/include/GraphExport.hh)
+GRAPH_MAGIC = b'AMRL1GRF'
+GRAPH_FORMAT_VERSION = 1
+GRAPH_HEADER = struct.Struct('<8sIIQQQQQQQ')
+
+
+def load_graph_binary(graph_path):
+    """Load the NavMesh graph from its binary export (same result as load_graph).
+
+    The file is memory-mapped and its arrays are read in place, so nothing
+    is parsed line by line.
+    """
+    with open(graph_path, 'rb') as f:
+        with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            (magic, version, _, node_count, edge_count,
+             x_off, y_off, csr_off, target_off, cost_off) = GRAPH_HEADER.unpack_from(mm, 0)
+            if magic != GRAPH_MAGIC or version != GRAPH_FORMAT_VERSION:
+                raise ValueError(f"Not a graph export (version {GRAPH_FORMAT_VERSION}): {graph_path}")
+
+            view = memoryview(mm)
+            xs = view[x_off:x_off + 4 * node_count].cast('i')
+            ys = view[y_off:y_off + 4 * node_count].cast('i')
+            offsets = view[csr_off:csr_off + 4 * (node_count + 1)].cast('I')
+            targets = view[target_off:target_off + 4 * edge_count].cast('i')
+            costs = view[cost_off:cost_off + 4 * edge_count].cast('f')
+
+            nodes = [{'id': n, 'x': xs[n], 'y': ys[n]} for n in range(node_count)]
+            edges = []
+            for n in range(node_count):
+                for k in range(offsets[n], offsets[n + 1]):
+                    # Only add edge once (from lower to higher ID)
+                    if n < targets[k]:
+                        edges.append({'from': n, 'to': targets[k], 'cost': costs[k]})
+
+            for array in (xs, ys, offsets, targets, costs, view):
+                array.release()
+    return nodes, edges
+
 def load_pois(poi_path):
     """Load POIs from JSON configuration."""
     with open(poi_path, 'r') as f:
@@ -339,6 +380,7 @@ def main():
     
     map_path = os.path.join(assets_dir, 'map_layout.txt')
     graph_path = os.path.join(assets_dir, 'graph_dump.csv')
+    graph_binary_path = os.path.join(assets_dir, 'graph.navgraph')
     poi_path = os.path.join(assets_dir, 'poi_config.json')
     registry_path = os.path.join(assets_dir, 'poi_registry_export.json')
     output_path = os.path.join(assets_dir, 'navmesh_graph.png')
@@ -355,11 +397,15 @@ def main():
     grid, width, height = load_map(map_path)
     print(f"  Map size: {width} x {height} pixels")
     
-    print(f"Loading graph from: {graph_path}")
-    if not os.path.exists(graph_path):
-        print(f"  Error: Graph file not found. Run the C++ test first to generate it.")
-        sys.exit(1)
-    nodes, edges = load_graph(graph_path)
+    if os.path.exists(graph_binary_path):
+        print(f"Loading graph from: {graph_binary_path}")
+        nodes, edges = load_graph_binary(graph_binary_path)
+    else:
+        print(f"Loading graph from: {graph_path}")
+        if not os.path.exists(graph_path):
+            print(f"  Error: Graph file not found. Run the C++ test first to generate it.")
+            sys.exit(1)
+        nodes, edges = load_graph(graph_path)
     print(f"  Loaded {len(nodes)} nodes, {len(edges)} edges")
     
     print(f"Loading POIs from: {poi_path}")
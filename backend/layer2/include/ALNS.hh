@@ -4,22 +4,46 @@
  * 
  * ALNS is a powerful metaheuristic that uses "Destroy and Repair" philosophy:
  * - Destroy: Remove 20-30% of tasks (focusing on expensive outliers)
- * - Repair: Re-insert using Regret-2 heuristic (not just greedy)
+ * - Repair: Re-insert using a Regret-k heuristic (not just greedy)
  * 
  * This creates massive perturbations that escape local optima much faster
  * than local swapping methods like Hill Climbing or Tabu Search.
  * 
  * Key Operators:
  * - Worst Removal: Remove tasks contributing most to current cost
- * - Regret-2 Insertion: Insert task with highest regret (2nd best - best cost)
+ * - Random Removal: Remove uniformly drawn tasks (diversity)
+ * - Shaw Removal: Remove tasks related to a seed task (close pickups and
+ *   dropoffs), which the repair can then trade between routes
+ * - Route Removal: Empty whole routes
+ * - Cluster Removal: Remove one spatial cluster of a route, then nearby
+ *   clusters of other routes
+ * - Regret-k Insertion: Insert task with highest regret (sum of the 2nd..k-th
+ *   best insertion costs minus the best; k = 2 by default)
+ * - Greedy Insertion: Insert each task at its cheapest position (fast)
+ * 
+ * Each iteration draws one destroy and one repair operator by roulette
+ * wheel. Every SEGMENT_ITERATIONS iterations the weights move towards the
+ * score each operator earned per use in that segment (Ropke & Pisinger),
+ * so the budget goes to the operators that improve this instance. An
+ * improving iteration also scores its relative gain: large instances run
+ * few segments, and one big step from worst removal should outweigh a
+ * few marginal ones. Route and cluster removal start at a lower weight;
+ * emptying whole areas rarely pays off before the routes take shape.
+ * 
+ * The repair's insertion evaluations, the hottest loop of a solve, are
+ * split over SolveOptions::scheduler's workers on large instances.
  */
 
 #ifndef LAYER2_ALNS_HH
 #define LAYER2_ALNS_HH
 
 #include "IVRPSolver.hh"
+#include "FlatSolution.hh"
+#include "GranularLocalSearch.hh"
+#include "ScratchArena.hh"
 #include <random>
 #include <algorithm>
+#include <functional>
 #include <limits>
 
 namespace Backend {
@@ -31,14 +55,15 @@ namespace Layer2 {
  * Strategy:
  * 1. Generate initial solution (Round-Robin assignment)
  * 2. At each iteration:
- *    a. DESTROY: Remove worst tasks (highest cost contribution)
- *    b. REPAIR: Re-insert using Regret-2 heuristic
- *    c. Accept if improved (greedy acceptance)
+ *    a. DESTROY: Remove tasks with an operator drawn by weight
+ *    b. REPAIR: Re-insert them with an operator drawn by weight
+ *    c. Accept if improved (greedy acceptance), score both operators
+ *    d. Every segment, re-weight the operators from their scores
  * 3. Track best solution across all iterations
  * 
- * Why Regret-2?
+ * Why Regret-k?
  * - Greedy insertion: Insert task where it's cheapest
- * - Regret-2: Insert task where deferring is most costly
+ * - Regret-k: Insert task where deferring is most costly
  *   (If we don't place task X now, the penalty later is biggest)
  * 
  * Performance:
@@ -52,9 +77,13 @@ private:
     int maxIterations_;           ///< Number of destroy-repair cycles
     double destructionFactor_;    ///< Percentage of tasks to remove (0.20 = 20%)
     unsigned int seed_;           ///< Random seed for reproducibility
+    int regretK_;                 ///< Insertions the repair's regret looks ahead (2 = Regret-2)
     
     // Random number generator
     mutable std::mt19937 rng_;
+    
+    // Per-iteration scratch (removal orders, insertion tables)
+    mutable ScratchArena arena_;
 
 public:
     // =========================================================================
@@ -67,25 +96,47 @@ public:
      * @param iterations Number of destroy-repair iterations
      * @param destroyPercentage Fraction of tasks to remove each iteration (0.0-1.0)
      * @param seed Random seed (0 = use random device)
+     * @param regretK Insertion options summed into a task's regret (2..MAX_REGRET_K)
      */
     explicit ALNS(
         int iterations = 250,
         double destroyPercentage = 0.25,
-        unsigned int seed = 0
+        unsigned int seed = 0,
+        int regretK = 2
     )
         : maxIterations_(iterations)
         , destructionFactor_(destroyPercentage)
         , seed_(seed)
+        , regretK_(std::clamp(regretK, 2, MAX_REGRET_K))
         , rng_(seed == 0 ? std::random_device{}() : seed) {}
+    
+    static constexpr int MAX_REGRET_K = 8;
+    
+    /// Repair rounds evaluating fewer insertion positions than this stay
+    /// on the calling thread (a hand-off costs more than the scan)
+    static constexpr size_t PARALLEL_REPAIR_MIN_POSITIONS = 4096;
+    
+    // Adaptive weights (Ropke & Pisinger's scheme, greedy acceptance)
+    static constexpr int SEGMENT_ITERATIONS = 10;   ///< Iterations between re-weightings
+    static constexpr double REACTION = 0.1;         ///< Share of a segment's score in the new weight
+    static constexpr double SCORE_NEW_BEST = 33.0;  ///< Iteration found a new best solution
+    static constexpr double SCORE_IMPROVED = 9.0;   ///< Iteration improved the current solution
+    static constexpr double SCORE_GAIN = 1000.0;    ///< Plus this times the relative makespan gain
+    static constexpr double MIN_WEIGHT = 0.05;      ///< No operator drops out of the wheel
+    static constexpr double SPECIALIZED_WEIGHT = 0.5;   ///< Start weight of route / cluster removal
+    static constexpr double SHAW_RANDOMNESS = 6.0;  ///< Shaw removal draws rank y^p of the candidates
 
     // =========================================================================
     // IVRPSOLVER INTERFACE
     // =========================================================================
     
+    using IVRPSolver::Solve;
+
     VRPResult Solve(
         const std::vector<Task>& tasks,
         std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const CostMatrixProvider& costs,
+        const SolveOptions& options
     ) override;
 
     std::string GetName() const override { 
@@ -93,7 +144,8 @@ public:
     }
     
     std::string GetDescription() const override {
-        return "Adaptive Large Neighborhood Search with Worst-Removal and Regret-2 Insertion";
+        return "Adaptive Large Neighborhood Search with Worst, Random, Shaw, Route and Cluster Removal and "
+               "Regret-" + std::to_string(regretK_) + " / Greedy Insertion";
     }
     
     bool IsExact() const override { return false; }
@@ -103,8 +155,53 @@ private:
     // INTERNAL TYPES
     // =========================================================================
     
-    /// Solution representation: Robot index → List of tasks assigned
-    using Solution = std::vector<std::vector<Task>>;
+    enum DestroyOperator { DESTROY_WORST, DESTROY_RANDOM, DESTROY_SHAW, DESTROY_ROUTE, DESTROY_CLUSTER,
+                           DESTROY_COUNT };
+    enum RepairOperator { REPAIR_REGRET, REPAIR_GREEDY, REPAIR_COUNT };
+    
+    /// Roulette-wheel entry of one operator
+    struct AdaptiveOperator {
+        double weight = 1.0;
+        double segmentScore = 0.0;          ///< Score earned in the current segment
+        int segmentUses = 0;
+        VRPResult::OperatorStats stats;
+    };
+    
+    /// Task endpoints as seen by the search (routes refer to tasks by index)
+    struct TaskNodes {
+        int source;           ///< Pickup node
+        int destination;      ///< Dropoff node
+        float serviceCost;    ///< cost(source -> destination), looked up once
+    };
+    
+    /// Solution representation: Robot index → task indices in visiting order.
+    /// Destroy / repair edit it in place; a rejected iteration rolls back.
+    using Solution = FlatSolution;
+    
+    /// Everything one Solve() call searches over
+    struct SearchContext {
+        std::vector<TaskNodes> tasks;       ///< Indexed by task index
+        std::vector<int> startNodes;        ///< Robot index → start node
+        const CostMatrixProvider* costs;
+        Common::TaskScheduler* scheduler = nullptr;     ///< SolveOptions::scheduler
+        const LoadPlanner* load = nullptr;              ///< Multi-pick batching (nullptr = one task at a time)
+        RouteScorer scorer;                             ///< Whole-route travel legs
+    };
+    
+    /**
+     * @brief Cached costs of one route.
+     * 
+     * Rebuilt only for the routes a destroy / repair step touched, so the
+     * makespan of a candidate is a max over cached completion times and
+     * worst-removal reads its savings instead of re-walking every route.
+     */
+    struct RouteCache {
+        std::vector<double> completion;      ///< Completion time after each task (prefix cost)
+        std::vector<double> removalSavings;  ///< Cost saved by removing each task
+        std::vector<float> legs;             ///< Scratch: the route's legs (RouteScorer::RouteTime)
+        
+        double Cost() const { return completion.empty() ? 0.0 : completion.back(); }
+    };
     
     /// Insertion move: where to insert a task
     struct InsertionMove {
@@ -116,6 +213,26 @@ private:
         InsertionMove(int r, int p, double c) : robotIndex(r), position(p), insertionCost(c) {}
     };
     
+    /// Best and second-best insertion of one task into one route
+    struct RouteInsertion {
+        int bestPosition = -1;
+        double bestCost = std::numeric_limits<double>::max();
+        double secondCost = std::numeric_limits<double>::max();
+    };
+    
+    /// Task a repair round inserts next, as chosen within one chunk of tasks
+    struct RegretChoice {
+        int task = -1;                      ///< Into unassigned (-1 = none)
+        double regret = -std::numeric_limits<double>::max();
+        InsertionMove move;
+    };
+    
+    /// Position of a task in the solution (for removals)
+    struct TaskPosition {
+        int robotIndex;
+        int taskIndex;
+    };
+    
     /// Task with its cost contribution (for worst removal)
     struct TaskCost {
         int robotIndex;   ///< Which robot owns this task
@@ -132,23 +249,23 @@ private:
     /**
      * @brief Remove the worst (most expensive) tasks from the solution.
      * 
-     * Calculates the cost contribution of each task and removes the
-     * top `count` most expensive ones.
+     * Reads each task's cost contribution from the route caches and removes
+     * the top `count` most expensive ones.
      * 
      * Cost contribution = cost(prev→task) + cost(task→next) - cost(prev→next)
      * 
      * @param sol Current solution (modified in-place)
-     * @param unassigned Vector to collect removed tasks
+     * @param cache Route caches matching sol
+     * @param unassigned Vector to collect removed task indices (reserved for count)
      * @param count Number of tasks to remove
-     * @param robots Robot agents for start positions
-     * @param costs Cost matrix provider
+     * @param touched Set to 1 for every route that lost a task
      */
     void DestroyWorst(
         Solution& sol,
-        std::vector<Task>& unassigned,
+        const std::vector<RouteCache>& cache,
+        ArenaVector<int>& unassigned,
         int count,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        std::vector<char>& touched
     ) const;
     
     /**
@@ -157,42 +274,151 @@ private:
      * Less sophisticated than worst removal but adds diversity.
      * 
      * @param sol Current solution (modified in-place)
-     * @param unassigned Vector to collect removed tasks
+     * @param unassigned Vector to collect removed task indices (reserved for count)
      * @param count Number of tasks to remove
+     * @param touched Set to 1 for every route that lost a task
      */
     void DestroyRandom(
         Solution& sol,
-        std::vector<Task>& unassigned,
-        int count
+        ArenaVector<int>& unassigned,
+        int count,
+        std::vector<char>& touched
+    ) const;
+    
+    /**
+     * @brief Remove tasks related to a random seed task (Shaw removal).
+     * 
+     * Relatedness is the travel cost between the two pickups plus the one
+     * between the two dropoffs. The ranking is drawn from with bias
+     * y^SHAW_RANDOMNESS towards the most related, so repeated calls with
+     * the same seed task still differ.
+     */
+    void DestroyShaw(
+        Solution& sol,
+        ArenaVector<int>& unassigned,
+        int count,
+        const SearchContext& ctx,
+        std::vector<char>& touched
+    ) const;
+    
+    /**
+     * @brief Empty random routes (the last one from its end) until count
+     *        tasks are removed.
+     */
+    void DestroyRoute(
+        Solution& sol,
+        ArenaVector<int>& unassigned,
+        int count,
+        std::vector<char>& touched
+    ) const;
+    
+    /**
+     * @brief Remove spatial clusters of tasks.
+     * 
+     * A random route is split in two around its seed task and the task
+     * farthest from it (nearest pickup wins); the seed's half is removed.
+     * The next route is the one holding the task nearest to a removed
+     * one, until count tasks are removed.
+     */
+    void DestroyCluster(
+        Solution& sol,
+        ArenaVector<int>& unassigned,
+        int count,
+        const SearchContext& ctx,
+        std::vector<char>& touched
     ) const;
+    
+    /**
+     * @brief Erase the tasks at positions from the solution into unassigned.
+     * 
+     * @param positions Reordered (back to front per route) before erasing
+     */
+    static void EraseTasks(
+        Solution& sol,
+        TaskPosition* positions,
+        size_t count,
+        ArenaVector<int>& unassigned,
+        std::vector<char>& touched
+    );
+    
+    /// Relatedness of two tasks: pickup-to-pickup plus dropoff-to-dropoff cost
+    static double Relatedness(int a, int b, const SearchContext& ctx);
+    
+    // =========================================================================
+    // ADAPTIVE OPERATOR SELECTION
+    // =========================================================================
+    
+    /// Roulette-wheel draw of an operator index, proportional to weight
+    int SelectOperator(const std::vector<AdaptiveOperator>& operators) const;
+    
+    /// Fold a finished segment's scores into the weights and log them
+    static void UpdateWeights(std::vector<AdaptiveOperator>& operators);
 
     // =========================================================================
     // REPAIR OPERATORS
     // =========================================================================
     
     /**
-     * @brief Re-insert tasks using Regret-2 heuristic.
+     * @brief Re-insert tasks using the Regret-k heuristic.
      * 
      * For each unassigned task:
      * 1. Find best insertion position (lowest cost)
-     * 2. Find second-best insertion position
-     * 3. Regret = 2nd_best_cost - best_cost
+     * 2. Find the next k - 1 options: the best position in each other
+     *    route, and the second-best position in the best route
+     * 3. Regret = sum of (option cost - best cost) over those options
      * 
      * Insert the task with HIGHEST regret first.
-     * Why? If we don't place it in its best spot now, the alternative is much worse.
+     * Why? If we don't place it in its best spot now, the alternatives are much worse.
+     * 
+     * The best / second-best insertion of every task into every route is
+     * kept between rounds; after an insertion only the changed route is
+     * rescanned. With a scheduler and enough positions to evaluate, each
+     * round's rescan and regret scan run in chunks of tasks on its
+     * workers, each chunk keeping its own best choice; the chunks are
+     * reduced in order, so the result does not depend on the split.
      * 
      * @param sol Current solution (modified in-place)
      * @param unassigned Tasks to insert (emptied on return)
-     * @param robots Robot agents for start positions
-     * @param costs Cost matrix provider
+     * @param ctx Search context
+     * @param touched Set to 1 for every route that gained a task
      */
     void RepairRegret(
         Solution& sol,
-        std::vector<Task>& unassigned,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        ArenaVector<int>& unassigned,
+        const SearchContext& ctx,
+        std::vector<char>& touched
+    ) const;
+    
+    /**
+     * @brief Regret of one task from its per-route insertions, and the
+     *        move to its best position.
+     * 
+     * @param positionCount Insertion positions over all routes
+     */
+    double ScoreRegret(
+        const RouteInsertion* row,
+        const ArenaVector<double>& routeCosts,
+        size_t positionCount,
+        InsertionMove& move
     ) const;
     
+    /**
+     * @brief Call scan(chunk, begin, end) for chunks splitting [0, count),
+     *        on the scheduler's workers when chunks > 1.
+     */
+    static void RunChunks(
+        Common::TaskScheduler* scheduler,
+        size_t chunks,
+        size_t count,
+        const std::function<void(size_t, size_t, size_t)>& scan
+    );
+    
+    /**
+     * @brief Chunks a repair scan of count tasks over positions insertion
+     *        positions is split into (1 = stay on the calling thread).
+     */
+    static size_t RepairChunks(const SearchContext& ctx, size_t count, size_t positions);
+    
     /**
      * @brief Greedy insertion (simpler, faster, lower quality).
      * 
@@ -200,14 +426,14 @@ private:
      * 
      * @param sol Current solution (modified in-place)
      * @param unassigned Tasks to insert
-     * @param robots Robot agents for start positions
-     * @param costs Cost matrix provider
+     * @param ctx Search context
+     * @param touched Set to 1 for every route that gained a task
      */
     void RepairGreedy(
         Solution& sol,
-        std::vector<Task>& unassigned,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        ArenaVector<int>& unassigned,
+        const SearchContext& ctx,
+        std::vector<char>& touched
     ) const;
 
     // =========================================================================
@@ -215,47 +441,43 @@ private:
     // =========================================================================
     
     /**
-     * @brief Calculate total solution cost (makespan).
-     * 
-     * Returns the maximum route cost across all robots.
-     * 
-     * @param sol Solution to evaluate
-     * @param robots Robot agents for start positions
-     * @param costs Cost matrix provider
-     * @return Makespan (max robot completion time)
+     * @brief Recompute the cache of one route (prefix completion times and
+     *        removal savings), O(route length).
      */
-    double CalculateSolutionCost(
-        const Solution& sol,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+    void RebuildRouteCache(
+        RouteView route,
+        int robotIndex,
+        const SearchContext& ctx,
+        RouteCache& cache
     ) const;
     
     /**
-     * @brief Calculate total distance (sum of all robot routes).
-     * 
-     * @param sol Solution to evaluate
-     * @param robots Robot agents for start positions
-     * @param costs Cost matrix provider
-     * @return Total distance
+     * @brief Completion time of one route, without building a cache.
      */
-    double CalculateTotalDistance(
-        const Solution& sol,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+    double CalculateRouteCost(
+        RouteView route,
+        int robotIndex,
+        const SearchContext& ctx
     ) const;
     
     /**
-     * @brief Calculate cost of a single robot's route.
-     * 
-     * @param route List of tasks for this robot
-     * @param startNode Robot's starting node
-     * @param costs Cost matrix provider
-     * @return Total route cost
+     * @brief Solution makespan: the maximum cached route completion time.
      */
-    double CalculateRouteCost(
-        const std::vector<Task>& route,
-        int startNode,
-        const CostMatrixProvider& costs
+    static double CalculateMakespan(const std::vector<RouteCache>& cache);
+    
+    /**
+     * @brief Total distance (sum of all cached route costs).
+     */
+    static double CalculateTotalDistance(const std::vector<RouteCache>& cache);
+    
+    /**
+     * @brief Best and second-best insertion of a task into one route.
+     */
+    RouteInsertion EvaluateRouteInsertion(
+        RouteView route,
+        int robotIndex,
+        int taskIndex,
+        const SearchContext& ctx
     ) const;
     
     /**
@@ -265,37 +487,18 @@ private:
      *                - cost(prev→next)
      * 
      * @param route Current route
-     * @param task Task to insert
+     * @param taskIndex Task to insert
      * @param position Index to insert at (0 = front, route.size() = back)
-     * @param startNode Robot's starting node
-     * @param costs Cost matrix provider
+     * @param robotIndex Route owner (for its start node)
+     * @param ctx Search context
      * @return Cost increase from insertion
      */
     double CalculateInsertionCost(
-        const std::vector<Task>& route,
-        const Task& task,
-        int position,
-        int startNode,
-        const CostMatrixProvider& costs
-    ) const;
-    
-    /**
-     * @brief Calculate the cost contribution of a task in a route.
-     * 
-     * Removal savings = cost(prev→task.src) + cost(task.src→task.dst) + cost(task.dst→next)
-     *                 - cost(prev→next)
-     * 
-     * @param route Current route
-     * @param taskIndex Index of task in route
-     * @param startNode Robot's starting node
-     * @param costs Cost matrix provider
-     * @return Cost contribution (savings if removed)
-     */
-    double CalculateRemovalSavings(
-        const std::vector<Task>& route,
+        RouteView route,
         int taskIndex,
-        int startNode,
-        const CostMatrixProvider& costs
+        int position,
+        int robotIndex,
+        const SearchContext& ctx
     ) const;
 
     // =========================================================================
@@ -308,11 +511,13 @@ private:
      * Expands tasks into pickup/dropoff node sequences.
      * 
      * @param sol Internal solution
+     * @param ctx Search context (task nodes)
      * @param robots Robot agents (for IDs)
      * @return Map of robot ID → itinerary (node list)
      */
     std::map<int, std::vector<int>> FormatResult(
         const Solution& sol,
+        const SearchContext& ctx,
         const std::vector<RobotAgent>& robots
     ) const;
     
@@ -323,12 +528,12 @@ private:
     /**
      * @brief Generate initial solution using round-robin assignment.
      * 
-     * @param tasks All tasks to assign
+     * @param numTasks Number of tasks to assign
      * @param numRobots Number of robots
      * @return Initial solution
      */
     Solution GenerateInitialSolution(
-        const std::vector<Task>& tasks,
+        size_t numTasks,
         size_t numRobots
     ) const;
 };
@@ -0,0 +1,157 @@
+/**
+ * @file AdaptiveSolver.hh
+ * @brief Picks a solver tier per solve from measured latency to meet a target
+ *
+ * A fixed solver with fixed iteration counts is either too slow for large
+ * waves or wastes quality on small ones. This front-end holds tiers of
+ * solvers (the same algorithms at smaller iteration budgets, down to a
+ * cheap local search), learns from every solve how long each tier takes at
+ * a given instance size and how good its makespans are, and runs the best
+ * tier predicted to finish within the target latency.
+ */
+
+#ifndef LAYER2_ADAPTIVESOLVER_HH
+#define LAYER2_ADAPTIVESOLVER_HH
+
+#include "IVRPSolver.hh"
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Latency-targeted tier selection for any IVRPSolvers (Strategy Pattern).
+ *
+ * Latency model, per tier: a power law time = c * work^b in the instance
+ * work tasks * robots (every task is tried on every robot), fitted by
+ * least squares on log time vs log work with older samples decaying by
+ * MODEL_DECAY, so the fit follows load and machine changes. The exponent
+ * is clamped to [MIN_EXPONENT, MAX_EXPONENT] and falls back to 1 until
+ * two sizes have been seen. A solve that hit its deadline only bounds the
+ * tier's time from below, so it is recorded only if it ran longer than
+ * predicted.
+ *
+ * Quality, per tier and per doubling of the work: the smoothed ratio of
+ * makespan to IVRPSolver::MakespanLowerBound. Tiers are only compared on
+ * instances of about the same size.
+ *
+ * Selection: tiers are ordered from most to least expensive. The first
+ * tier predicted to meet the target (or not measured yet) is chosen, then
+ * a cheaper tier that also fits replaces it while its measured quality is
+ * within QUALITY_TOLERANCE at this size. If no tier fits, the cheapest
+ * runs. Every solve gets a deadline (tightened by the caller's own) so a
+ * mispredicted tier still returns about in time with its best so far: the
+ * target minus the tier's smoothed overrun past earlier deadlines (work
+ * such as the initial construction is not interruptible), but at least
+ * MIN_BUDGET_FRACTION of the target.
+ *
+ * Solve may be called from any one thread at a time; the model is guarded
+ * so Predict can be called concurrently (e.g. for progress logging).
+ */
+class AdaptiveSolver : public IVRPSolver {
+public:
+    /// Weight kept by older samples when a new one is added
+    static constexpr double MODEL_DECAY = 0.9;
+    static constexpr double MIN_EXPONENT = 0.5;
+    static constexpr double MAX_EXPONENT = 3.0;
+    /// Weight of the newest makespan ratio in a tier's quality
+    static constexpr double QUALITY_SMOOTHING = 0.2;
+    /// A cheaper tier within this fraction of the quality is preferred
+    static constexpr double QUALITY_TOLERANCE = 0.01;
+    /// Deadline never set below this fraction of the target
+    static constexpr double MIN_BUDGET_FRACTION = 0.25;
+
+    /// Tier chosen for a solve
+    struct Choice {
+        size_t tier = 0;
+        double predictedMs = -1.0;          ///< < 0 = tier not measured yet
+        double budgetMs = 0.0;              ///< Deadline given to the tier
+    };
+
+private:
+    /// Decayed least-squares sums of log time vs log work
+    struct LatencyModel {
+        double weight = 0.0;
+        double sumX = 0.0;
+        double sumY = 0.0;
+        double sumXX = 0.0;
+        double sumXY = 0.0;
+
+        bool IsFitted() const { return weight > 0.0; }
+        void Add(double x, double y);
+        double Predict(double x) const;     ///< Time in ms for log work x
+    };
+
+    struct Tier {
+        std::unique_ptr<IVRPSolver> solver;
+        LatencyModel latency;
+        std::map<int, double> quality;      ///< Work bucket -> smoothed makespan / lower bound
+        double overrunMs = 0.0;             ///< Smoothed time past the deadline when stopped by it
+    };
+
+    std::vector<Tier> tiers_;
+    double targetLatencyMs_;
+    mutable std::mutex modelMutex_;
+
+    static double LogWork(size_t tasks, size_t robots);
+    static int WorkBucket(double logWork);
+
+    /// Measured quality of tier on instances of bucket's size (0 = none)
+    double QualityAt(size_t tier, int bucket) const;
+
+    /// Record a finished solve of tier
+    void Record(size_t tier, double logWork, const VRPResult& result, double budgetMs, double lowerBound);
+
+public:
+    /**
+     * @param tiers Solvers from most to least expensive
+     * @param targetLatencyMs Solve latency to meet (> 0)
+     * @throws std::invalid_argument if tiers is empty or contains null,
+     *         or the target is not positive
+     */
+    AdaptiveSolver(std::vector<std::unique_ptr<IVRPSolver>> tiers, double targetLatencyMs);
+
+    /**
+     * @brief Tier (and budget) a solve of this size would run now.
+     */
+    Choice Select(size_t tasks, size_t robots) const;
+
+    /**
+     * @brief Predicted latency of the tier Select would choose (< 0 = unknown).
+     */
+    double Predict(size_t tasks, size_t robots) const { return Select(tasks, robots).predictedMs; }
+
+    // =========================================================================
+    // IVRPSOLVER INTERFACE
+    // =========================================================================
+
+    using IVRPSolver::Solve;
+
+    VRPResult Solve(
+        const std::vector<Task>& tasks,
+        std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs,
+        const SolveOptions& options
+    ) override;
+
+    std::string GetName() const override { return "Adaptive"; }
+
+    std::string GetDescription() const override {
+        return "Runs the best solver tier predicted to meet a target latency, learnt from past solves";
+    }
+
+    bool IsExact() const override { return false; }
+
+    // --- Configuration ---
+    size_t GetTierCount() const { return tiers_.size(); }
+    const IVRPSolver& GetTier(size_t tier) const { return *tiers_[tier].solver; }
+    double GetTargetLatencyMs() const;
+    void SetTargetLatencyMs(double ms);     ///< Ignored unless > 0
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_ADAPTIVESOLVER_HH
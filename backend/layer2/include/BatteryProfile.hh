@@ -0,0 +1,175 @@
+/**
+ * @file BatteryProfile.hh
+ * @brief Battery-aware route evaluation with automatic charging stops
+ *
+ * The solvers score routes by travel cost alone, but a robot whose battery
+ * runs low detours to a charger mid-route, so the executed makespan can be
+ * far from the solved one. A BatteryPlanner walks a route with the robot's
+ * battery, inserts a charging stop wherever the next task would leave it
+ * below the reserve, and caches the result per route as a BatteryProfile
+ * so that local search can tell in O(1) whether a move needs a new stop.
+ *
+ * Energy and time share the cost matrix unit: a robot drains one unit of
+ * battery per unit of travel, and BatteryModel::costPerSecond converts the
+ * RobotAgent battery constants (seconds) into that unit.
+ */
+
+#ifndef LAYER2_BATTERYPROFILE_HH
+#define LAYER2_BATTERYPROFILE_HH
+
+#include "Task.hh"
+#include "RobotAgent.hh"
+#include "CostMatrixProvider.hh"
+#include "ChargerAssignment.hh"
+#include "FlatSolution.hh"
+#include <limits>
+#include <vector>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Battery parameters of a solve (disabled by default).
+ */
+struct BatteryModel {
+    std::vector<int> chargerNodes;      ///< Nodes a robot may recharge at (empty = battery ignored)
+    double costPerSecond = 0.0;         ///< Cost units travelled per second of battery
+    bool matchChargers = true;          ///< Share chargers between the routes' stops (ChargerAssignment) instead of each taking its cheapest
+
+    /// Charging time per unit of energy restored (0% -> 100% in BATTERY_CHARGE_TIME)
+    static constexpr double CHARGE_TIME_PER_UNIT = BATTERY_CHARGE_TIME / BATTERY_FULL_SECONDS;
+
+    bool IsEnabled() const { return !chargerNodes.empty() && costPerSecond > 0.0; }
+
+    double Capacity() const { return BATTERY_FULL_SECONDS * costPerSecond; }
+    double Reserve() const { return BATTERY_LOW_THRESHOLD * Capacity(); }
+};
+
+/**
+ * @brief Cached battery state along one route (indices are route positions).
+ *
+ * A charging stop is made before task k when stopCharger[k] >= 0. slack[k]
+ * is how much extra energy can be drained before task k without any task
+ * from k up to the next stop falling below the reserve, so a move that
+ * adds drain d there keeps every stop iff d <= slack[k].
+ */
+struct BatteryProfile {
+    std::vector<double> time;           ///< time[k]: completion of the first k tasks, charging included
+    std::vector<double> energy;         ///< energy[k]: battery left after the first k tasks
+    std::vector<double> slack;          ///< slack[k]: drain absorbed before task k (size + 1 entries)
+    std::vector<int> nextStop;          ///< nextStop[k]: first position >= k with a stop (size if none)
+    std::vector<int> stopCharger;       ///< Per position: charger visited before the task (-1 = none)
+    int stops = 0;
+    bool feasible = true;               ///< False if a task needs more than a full battery
+
+    double Total() const { return time.back(); }
+    int Size() const { return static_cast<int>(stopCharger.size()); }
+};
+
+/**
+ * @brief Plans charging stops for the routes of one solve.
+ *
+ * Policy, task by task: if doing the task would leave less than the
+ * reserve (BATTERY_LOW_THRESHOLD, kept for reaching a charger), the robot
+ * first detours to the charger that adds the least travel between its
+ * current position and the task's pickup (chosen by cost matrix), and
+ * charges to full there. Planning a route is O(route length), plus
+ * O(chargers) per stop.
+ */
+class BatteryPlanner {
+public:
+    static constexpr double NO_FIT = std::numeric_limits<double>::infinity();
+
+    /**
+     * @param model Battery parameters (may be disabled)
+     * @param tasks Tasks being solved (routes hold indices into it)
+     * @param robots Robots routes start from, with their current battery
+     * @param costs Cost matrix
+     */
+    BatteryPlanner(
+        const BatteryModel& model,
+        const std::vector<Task>& tasks,
+        const std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs
+    );
+
+    bool IsEnabled() const { return enabled_; }
+
+    /**
+     * @brief Walk robot's route, inserting charging stops.
+     *
+     * @param profile Filled with the route's battery state
+     * @return Completion time of the route, charging included
+     */
+    double Plan(RouteView route, int robot, BatteryProfile& profile) const {
+        return Walk(route, robot, &profile, nullptr);
+    }
+
+    /**
+     * @brief Plan with the chargers of a ChargerAssignment.
+     *
+     * @param chargers Per route position; a stop there uses its charger and
+     *                 queues its wait (stops without one take the cheapest)
+     */
+    double Plan(RouteView route, int robot, BatteryProfile& profile,
+                const std::vector<ChargerSlot>& chargers) const {
+        return Walk(route, robot, &profile, &chargers);
+    }
+
+    /// Completion time only (allocation-free, safe to call concurrently)
+    double Plan(RouteView route, int robot) const { return Walk(route, robot, nullptr, nullptr); }
+
+    /**
+     * @brief Extra charging time of draining drain more energy before
+     *        position pos (negative = less), or NO_FIT if that needs a new stop.
+     *
+     * O(1). Stops are assumed to stay where they are, so a lower drain is
+     * credited only on the next stop's charging time.
+     */
+    double ChargeTimeDelta(const BatteryProfile& profile, int pos, double drain) const {
+        if (drain > profile.slack[pos]) return NO_FIT;
+        return profile.nextStop[pos] < profile.Size()
+            ? drain * BatteryModel::CHARGE_TIME_PER_UNIT : 0.0;
+    }
+
+    /**
+     * @brief Whether tasks draining drain can run on energy without a stop.
+     */
+    bool SegmentFits(double energy, double drain) const {
+        return energy - drain >= reserve_;
+    }
+
+    /**
+     * @brief Itinerary of a planned route: pickups, dropoffs and charger visits.
+     */
+    std::vector<int> Itinerary(RouteView route, const BatteryProfile& profile) const;
+
+    /**
+     * @brief Append the charging stops of a planned route to stops.
+     */
+    void CollectStops(RouteView route, int robot, const BatteryProfile& profile,
+                      std::vector<ChargingStop>& stops) const;
+
+private:
+    bool enabled_;
+    const BatteryModel& model_;
+    const std::vector<Task>& tasks_;
+    const CostMatrixProvider& costs_;
+    double capacity_;
+    double reserve_;
+    std::vector<int> startNodes_;           ///< Per robot
+    std::vector<double> startEnergy_;       ///< Per robot
+    std::vector<float> serviceCost_;        ///< Per task: pickup -> dropoff
+
+    /// Plan the route; the profile is only filled when given
+    double Walk(RouteView route, int robot, BatteryProfile* profile,
+                const std::vector<ChargerSlot>* chargers) const;
+
+    /// Charger minimising from -> charger -> to; detour set to that travel
+    int CheapestCharger(int from, int to, float& detour) const;
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_BATTERYPROFILE_HH
@@ -0,0 +1,88 @@
+/**
+ * @file ChargerAssignment.hh
+ * @brief Sharing chargers between the charging stops of one solve
+ *
+ * BatteryPlanner picks each stop's charger on its own route: the one that
+ * adds the least travel. Robots working the same part of the warehouse
+ * then all pick the same charger at about the same time and queue there
+ * while others stand free. ChargerAssignment assigns the stops of all
+ * routes together, each to a charger by min-cost bipartite matching on
+ * detour plus the queueing time the charger's earlier stops cause.
+ */
+
+#ifndef LAYER2_CHARGERASSIGNMENT_HH
+#define LAYER2_CHARGERASSIGNMENT_HH
+
+#include "CostMatrixProvider.hh"
+#include <vector>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief One planned charging stop (times in cost units from solve start).
+ */
+struct ChargingStop {
+    int robot = -1;                     ///< Route index
+    int position = -1;                  ///< Route position of the task the stop precedes
+    int fromNode = -1;                  ///< Where the robot sets off for the charger
+    int toNode = -1;                    ///< Pickup it heads for afterwards
+    double departure = 0.0;             ///< When it leaves fromNode
+    double chargeTime = 0.0;            ///< Time spent charging
+};
+
+/**
+ * @brief Charger given to a stop and the time the robot queues there.
+ */
+struct ChargerSlot {
+    int charger = -1;                   ///< Charger node (-1 = not assigned)
+    double wait = 0.0;
+};
+
+/**
+ * @brief Min-cost matching of charging stops to chargers.
+ *
+ * Stops are taken in departure order, in rounds whose departures lie
+ * within one charge of each other (at most MAX_QUEUE_PLACES per charger). A round is matched against places in
+ * the chargers' queues: the q-th robot of the round at a charger costs
+ * its detour, the wait for the charger's earlier rounds and q mean charges
+ * of the round. The round is solved exactly (Hungarian algorithm,
+ * O(stops^2 * chargers * places)), so robots share a near charger while
+ * queueing is cheaper than driving to a free one. The chargers are then
+ * busy until their robots are charged, which later rounds queue behind.
+ */
+class ChargerAssignment {
+public:
+    static constexpr size_t MAX_ROUND_STOPS = 64;      ///< Larger rounds are split (bounds the matching)
+    static constexpr size_t MAX_QUEUE_PLACES = 4;      ///< Robots of one round queued at a charger
+
+    /**
+     * @param chargerNodes Chargers to share (one robot charges at each at a time)
+     * @param costs Cost matrix (detours and arrival times)
+     */
+    ChargerAssignment(const std::vector<int>& chargerNodes, const CostMatrixProvider& costs);
+
+    /**
+     * @brief One slot per stop (same order), minimising detours and queueing.
+     */
+    std::vector<ChargerSlot> Assign(const std::vector<ChargingStop>& stops) const;
+
+    /**
+     * @brief Rectangular assignment problem: column per row, each column
+     *        at most once, minimising the total cost.
+     *
+     * @param cost rows x columns, rows <= columns
+     * @return Column assigned to each row
+     * @throws std::invalid_argument if there are more rows than columns
+     */
+    static std::vector<int> SolveAssignment(const std::vector<std::vector<double>>& cost);
+
+private:
+    const std::vector<int>& chargerNodes_;
+    const CostMatrixProvider& costs_;
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_CHARGERASSIGNMENT_HH
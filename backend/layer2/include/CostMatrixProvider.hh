@@ -2,35 +2,51 @@
  * @file CostMatrixProvider.hh
  * @brief Pre-computed cost matrix using A* on NavMesh
  * 
- * Provides O(1) cost lookups between any two POI nodes after
- * O(N² × (E + V log V)) offline precomputation.
+ * Provides O(1) cost lookups (dense matrix) between any two POI nodes after
+ * O(N² × (E + V log V)) offline precomputation, or about O(N² × V / 64)
+ * on unit-cost grid meshes (bit-parallel BFS, 64 sources per sweep).
+ * Dijkstra searches use monotone queues (MonotoneQueue.hh) instead of a
+ * binary heap.
  */
 
 #ifndef LAYER2_COSTMATRIXPROVIDER_HH
 #define LAYER2_COSTMATRIXPROVIDER_HH
 
 #include "../../layer1/include/NavMesh.hh"
+#include "../../layer1/include/HierarchicalNavMesh.hh"
+#include "../../common/include/LatencyHistogram.hh"
+#include "../../common/include/TaskScheduler.hh"
+#include "MonotoneQueue.hh"
+#include "PairCostCache.hh"
 #include <unordered_map>
 #include <vector>
 #include <limits>
 #include <utility>
 #include <functional>
 #include <cmath>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
 
 namespace Backend {
 namespace Layer2 {
 
 /**
- * @brief Hash function for pair<int,int> keys.
+ * @brief Point-to-point search used for on-demand cost queries.
  */
-struct PairHash {
-    std::size_t operator()(const std::pair<int, int>& p) const {
-        // Combine the two integers into a single hash
-        return std::hash<long long>()(
-            (static_cast<long long>(p.first) << 32) | 
-            static_cast<unsigned int>(p.second)
-        );
-    }
+enum class CostSearchMode {
+    ASTAR,            ///< Single-direction A* (default)
+    BIDIRECTIONAL     ///< A* from both ends with averaged potentials
+};
+
+/**
+ * @brief Element type of the cost matrix.
+ */
+enum class CostStorage {
+    FLOAT32,          ///< Exact costs, 4 bytes per pair (default)
+    QUANTIZED16       ///< uint16 fixed point over the map's cost range, 2 bytes per pair
 };
 
 /**
@@ -45,19 +61,315 @@ struct PairHash {
  * 3. Query costs with GetCost()
  * 
  * The cost matrix is symmetric (undirected graph assumption).
+ * 
+ * Storage is a dense row-major float matrix over compact slots: every
+ * node passed to PrecomputeForNodes / AddRowForNode gets a slot, and a
+ * node -> slot table turns GetCost into three array loads. Solvers can
+ * resolve slots once (GetSlot) and call GetCostBySlot directly.
+ * 
+ * With CostStorage::QUANTIZED16 the matrix holds uint16 codes instead,
+ * step = cost range / QUANT_MAX_CODE, where the range is the mesh's
+ * bounding-box Manhattan extent times its largest edge cost per pixel
+ * times QUANT_DETOUR_FACTOR. Lookups decode inline (one multiply) and are
+ * off by at most half a step; costs beyond the range are left out of the
+ * matrix and answered on demand like any other missing pair. Half the
+ * bytes per pair keeps twice the POIs cache-resident.
+ * 
+ * Searches skip nodes blocked by the NavMesh dynamic overlay and add its
+ * traversal penalties (e.g. measured congestion) to edge costs. The
+ * overlay change version seen by the last computation is recorded so
+ * callers can tell when the cached costs no longer reflect it.
  */
 class CostMatrixProvider {
 private:
     // Reference to the NavMesh for pathfinding
     const Backend::Layer1::NavMesh& navMesh_;
     
-    // Cost matrix: (from, to) -> cost
-    std::unordered_map<std::pair<int, int>, float, PairHash> costMatrix_;
-    
     // Infinity constant for unreachable paths
     static constexpr float INFINITY_COST = std::numeric_limits<float>::max();
+    
+    // Matrix entry not computed yet (costs are never negative)
+    static constexpr float UNKNOWN_COST = -1.0f;
+    
+    // NavMesh node ID -> slot (-1 = no slot), and slot -> node ID
+    std::vector<int> nodeToSlot_;
+    std::vector<int> slotToNode_;
+    
+    // slotCapacity_ x slotCapacity_ row-major costs; the first
+    // slotToNode_.size() rows / columns are in use. Exactly one of the
+    // two matrices is allocated, as selected by storage_.
+    std::vector<float> costMatrix_;
+    std::vector<uint16_t> quantizedMatrix_;
+    int slotCapacity_ = 0;
+    
+    // Quantized codes: cost = code * quantStep_ up to QUANT_MAX_CODE
+    CostStorage storage_ = CostStorage::FLOAT32;
+    float quantStep_ = 1.0f;
+    static constexpr uint16_t QUANT_UNKNOWN = 0xFFFF;
+    static constexpr uint16_t QUANT_INFINITY = 0xFFFE;
+    
+    // Matrix entry at a row-major index, decoded (UNKNOWN_COST if none)
+    float LoadEntry(size_t index) const {
+        if (storage_ == CostStorage::FLOAT32) return costMatrix_[index];
+        uint16_t code = quantizedMatrix_[index];
+        if (code >= QUANT_INFINITY) return code == QUANT_UNKNOWN ? UNKNOWN_COST : INFINITY_COST;
+        return static_cast<float>(code) * quantStep_;
+    }
+    
+    // Cost step of the quantized codes for the current mesh
+    float ComputeQuantStep() const;
+    
+    // Entries holding a computed cost
+    size_t computedPairs_ = 0;
+    
+    // Slot of a node, allocating one (and growing the matrix) if needed
+    int EnsureSlot(int nodeId);
+    
+    // Store one computed entry
+    void SetEntry(int fromSlot, int toSlot, float cost);
+    
+    // GetCost for pairs outside the matrix: cached, else searched on demand
+    float GetCostSlow(int fromNodeId, int toNodeId) const;
+    
+    // Legs slots[k] -> slots[k + 1] for k < count into out (GetPathCostBySlots)
+    void GatherLegs(const int* slots, size_t count, float* out) const;
+    
+    // Rows of nodes without a slot (robot positions) towards slots, by
+    // PrecomputeStartRows: startCosts_[row * startRowWidth_ + toSlot],
+    // answered while the overlay is at startRowsVersion_
+    std::vector<int> startRowOf_;           // Per node: row, or -1
+    std::vector<int> startRowNodes_;        // Per row: source node
+    std::vector<float> startCosts_;
+    int startRowWidth_ = 0;
+    uint64_t startRowsVersion_ = 0;
+    
+    // Start row entry of a pair (UNKNOWN_COST if none or outdated)
+    float GetStartRowCost(int fromNodeId, int toSlot) const {
+        if (fromNodeId < 0 || fromNodeId >= static_cast<int>(startRowOf_.size())) return UNKNOWN_COST;
+        int row = startRowOf_[fromNodeId];
+        if (row < 0 || startRowsVersion_ != navMesh_.GetChangeVersion()) return UNKNOWN_COST;
+        return startCosts_[static_cast<size_t>(row) * startRowWidth_ + toSlot];
+    }
+    
+    // Drop every start row
+    void ClearStartRows();
+    
+    // Connected components of the overlay at a mesh change version (see
+    // NavMesh::LabelComponents), rebuilt on first use after a change.
+    // Readers take the current snapshot without locking.
+    struct ComponentLabels {
+        uint64_t version = 0;
+        std::vector<int> labels;
+    };
+    mutable std::shared_ptr<const ComponentLabels> components_;
+    mutable std::mutex componentsMutex_;    // Serialises rebuilds
+    std::shared_ptr<const ComponentLabels> GetComponents() const;
+    
+    // IsReachable against a snapshot of the labels
+    bool IsReachable(const ComponentLabels& components, int fromNodeId, int toNodeId) const;
+    
+    // On-demand results for pairs outside the matrix (thread-safe)
+    mutable PairCostCache fallbackCache_;
+    
+    // Time taken by the searches behind fallback misses
+    mutable Common::LatencyHistogram missLatency_;
+    
+    // NavMesh::GetChangeVersion() when costs were last (re)computed
+    uint64_t meshVersion_ = 0;
+    
+    // Optional cluster abstraction (not owned); used instead of flat
+    // Dijkstra / A* when set
+    const Backend::Layer1::HierarchicalNavMesh* hierarchy_ = nullptr;
+    
+    // Workers for precompute and refresh searches (not owned; nullptr =
+    // threads started per call)
+    Backend::Common::TaskScheduler* scheduler_ = nullptr;
+    
+    // Point-to-point search flavour (see SetSearchMode)
+    CostSearchMode searchMode_ = CostSearchMode::ASTAR;
+    
+    // ALT landmarks: landmarkDist_[i * landmarkNodeCount_ + v] is the
+    // unblocked shortest-path cost between landmark i and node v
+    std::vector<int> landmarkNodes_;
+    std::vector<float> landmarkDist_;
+    int landmarkNodeCount_ = 0;
+    
+    // Row invalidation: node positions are bucketed into square regions of
+    // INVALIDATION_REGION_PIXELS; each slot's row keeps a bitset
+    // (regionWords_ words) of the regions its shortest paths cross
+    int regionOriginX_ = 0;
+    int regionOriginY_ = 0;
+    int regionCols_ = 0;
+    int regionRows_ = 0;
+    int regionWords_ = 0;
+    int regionNodeCount_ = 0;              // Node count the grid was built for
+    std::vector<uint64_t> rowRegions_;
+    
+    // Bumped by Clear(), so refreshes prepared before it are rejected
+    uint64_t layoutGeneration_ = 0;
+    
+    // (Re)build the region grid for the current mesh
+    void EnsureRegionGrid();
+    int RegionOf(int nodeId) const;
+    uint64_t* RowRegions(int slot) { return rowRegions_.data() + static_cast<size_t>(slot) * regionWords_; }
+    
+    // Nodes settled by point-to-point searches (RunAStar)
+    mutable std::atomic<uint64_t> expandedNodes_{0};
+    
+    // True if the landmark tables match the current mesh
+    bool HasLandmarks() const {
+        return !landmarkNodes_.empty() &&
+               landmarkNodeCount_ == static_cast<int>(navMesh_.GetAllNodes().size());
+    }
+    
+    // Admissible lower bound on the cost between two nodes: Euclidean
+    // distance, tightened by the landmark triangle inequality when present
+    float LowerBound(int nodeId, int targetId) const;
+    
+    // Edge costs as multiples of costUnit_: every edge costs k units for
+    // an integer k in 1..costUnitMaxSteps_ (0 = costs not all multiples of
+    // one unit). Dijkstra searches without penalties then queue nodes in
+    // buckets, others in a radix heap. Read once, from the built mesh.
+    float costUnit_ = 0.0f;
+    uint32_t costUnitMaxSteps_ = 0;
+    static constexpr uint32_t MAX_BUCKET_STEPS = 64;
+    void DetectCostUnit();
+    
+    // Unit to reset a MonotoneQueue with for a search over costs with
+    // the given penalties (0 = not multiples of one unit)
+    float QueueUnit(const float* penalty) const { return penalty ? 0.0f : costUnit_; }
+    
+    // Dijkstra ignoring the blocked overlay, filling dist over all nodes
+    void RunUnblockedDijkstra(int sourceId, std::vector<float>& dist) const;
+    
+    float RunUnidirectional(int sourceId, int targetId) const;
+    float RunBidirectional(int sourceId, int targetId) const;
+    
+    // Reusable Dijkstra state, one per thread. dist[v] is valid only while
+    // stamp[v] == generation, so a new search starts in O(1) instead of
+    // re-filling arrays sized to the mesh.
+    struct DijkstraWorkspace {
+        std::vector<float> dist;
+        std::vector<uint32_t> stamp;          // == generation: dist[v] valid
+        std::vector<uint32_t> settledStamp;   // == generation: v settled
+        std::vector<uint32_t> targetStamp;    // == generation: v is a target
+        std::vector<uint32_t> pathStamp;      // == generation: v's path recorded
+        std::vector<int> parent;              // Valid where stamp == generation
+        MonotoneQueue open;                   // Reset by the search (see QueueUnit)
+        uint32_t generation = 0;
+        
+        // Start a new search over numNodes nodes
+        void Begin(int numNodes);
+    };
+    
+    // Dijkstra from source that stops as soon as every target is settled.
+    // Writes one cost per target (INFINITY_COST if unreachable) and, when
+    // regionsOut is set, ORs in the regions crossed by the paths found.
+    void RunDijkstraToTargets(int sourceId, const std::vector<int>& targetIds,
+                              DijkstraWorkspace& ws, float* costsOut,
+                              uint64_t* regionsOut = nullptr) const;
+    
+    // Costs from one source to each target (INFINITY_COST if unreachable).
+    // Searches without path information mark every region in regionsOut.
+    void ComputeCostsFrom(int sourceId, const std::vector<int>& targetIds,
+                          DijkstraWorkspace& ws, float* costsOut,
+                          uint64_t* regionsOut = nullptr) const;
+    
+    // Reusable bit-parallel BFS state, one per thread. Bit i of a node's
+    // masks stands for the i-th source of the batch; level[i * nodes + v]
+    // is v's hop count from source i modulo 2^16 (valid where visited has
+    // bit i), enough to walk paths back since a predecessor is one hop less.
+    struct BfsWorkspace {
+        std::vector<int> offsets;             // Incoming edges of v: predecessors[offsets[v] .. offsets[v + 1])
+        std::vector<int> predecessors;        // Edge sources (edges into blocked nodes left out)
+        std::vector<uint64_t> visited;
+        std::vector<uint64_t> frontier;       // Bits that reached v at the current level
+        std::vector<uint64_t> next;           // Bits reaching v at the next level
+        std::vector<uint64_t> onPath;         // Bits whose path through v is recorded
+        std::vector<uint16_t> level;
+        std::vector<int> targetIndex;         // Node -> index into targets (-1 = none)
+        std::vector<int> targets;             // Union of the batch's targets
+        std::vector<uint64_t> wanted;         // Per target: sources still to reach it
+        std::vector<uint32_t> depth;          // Per target and source: hop count (UNREACHED = none)
+        std::vector<int> region;              // Per node: RegionOf (when paths are recorded)
+        std::vector<int> scratch;             // Fill cursors while Begin builds predecessors
+        
+        // Start a new batch on the mesh's current blocked overlay
+        void Begin(const Backend::Layer1::NavMesh& mesh);
+    };
+    
+    // Sources searched together by one bit-parallel BFS
+    static constexpr int BFS_BATCH = 64;
+    static constexpr uint32_t UNREACHED = std::numeric_limits<uint32_t>::max();
+    
+    // Cost shared by every edge of the mesh, or 0 if edge costs differ
+    // or penalties apply (weighted meshes are searched with Dijkstra)
+    float UniformEdgeCost() const;
+    
+    // Rows per search: 1 for Dijkstra, else up to BFS_BATCH, small enough
+    // to keep every core busy
+    static size_t BatchSize(float edgeCost, size_t rows);
+    
+    // One search per row (per BFS_BATCH rows on unit-cost meshes), spread
+    // across workers: costs from sourceIds[r] to each of *targets[r] into
+    // costsOut[r], regions the paths cross into regionsOut[r]
+    void SearchRows(const std::vector<int>& sourceIds, const std::vector<const std::vector<int>*>& targets,
+                    std::vector<std::vector<float>>& costsOut,
+                    std::vector<std::vector<uint64_t>>& regionsOut) const;
+    
+    // Threads searches are spread over: the scheduler's workers plus the
+    // caller, or one per core without a scheduler
+    int WorkerCount() const;
+    
+    // Run worker on threads threads, the caller among them, and return
+    // when every one has returned
+    void RunWorkers(int threads, const std::function<void()>& worker) const;
+    
+    // BFS from up to BFS_BATCH sources at once on a mesh whose edges all
+    // cost edgeCost (see UniformEdgeCost), each level advancing every
+    // source's frontier with one OR per edge. Per source i, writes one cost
+    // per targets[i] entry to costsOut[i] and the regions crossed by the
+    // paths found to regionsOut[i] (if not null), like RunDijkstraToTargets.
+    void RunBitParallelBFS(const std::vector<int>& sourceIds,
+                           const std::vector<const std::vector<int>*>& targets,
+                           float edgeCost, BfsWorkspace& ws,
+                           const std::vector<float*>& costsOut,
+                           const std::vector<uint64_t*>& regionsOut) const;
 
 public:
+    static constexpr int DEFAULT_LANDMARK_COUNT = 8;
+    
+    // Edge length of the square regions rows are invalidated by
+    static constexpr int INVALIDATION_REGION_PIXELS = 16;
+    
+    /**
+     * @brief Recomputed rows, prepared off the planning thread by
+     *        PrepareRefresh and swapped in by CommitRefresh.
+     */
+    struct RowRefresh {
+        uint64_t baseVersion = 0;        // Matrix version the rows were judged against
+        uint64_t meshVersion = 0;        // Overlay version the rows were computed on
+        uint64_t layoutGeneration = 0;
+        int slotCount = 0;               // Columns per row
+        std::vector<int> slots;          // Recomputed rows
+        std::vector<float> costs;        // slots.size() x slotCount (UNKNOWN = not known)
+        std::vector<uint64_t> regions;   // Path regions per recomputed row
+    };
+    
+    // Bump whenever the snapshot layout or the cost rules change
+    static constexpr uint32_t SNAPSHOT_FORMAT_VERSION = 1;
+    
+    // Largest finite quantized code; QUANT_MAX_CODE steps span the range
+    static constexpr uint16_t QUANT_MAX_CODE = 0xFFFD;
+    
+    // Quantized range: this many times the mesh's bounding-box Manhattan
+    // extent (aisle detours and penalties; longer costs are not stored)
+    static constexpr float QUANT_DETOUR_FACTOR = 4.0f;
+    
+    // Rows with at most this many targets use one point-to-point search
+    // per target instead of a multi-target Dijkstra when landmarks exist
+    static constexpr size_t LANDMARK_ROW_MAX_TARGETS = 4;
+    
     // =========================================================================
     // CONSTRUCTOR
     // =========================================================================
@@ -65,20 +377,99 @@ public:
     /**
      * @brief Construct with NavMesh reference.
      * 
-     * @param mesh The NavMesh to use for A* pathfinding
+     * @param mesh The NavMesh to use for A* pathfinding (fully built: its
+     *             edge costs are read once, here)
      */
     explicit CostMatrixProvider(const Backend::Layer1::NavMesh& mesh)
-        : navMesh_(mesh) {}
+        : navMesh_(mesh) {
+        DetectCostUnit();
+    }
 
+    /**
+     * @brief Route cost queries through a hierarchical NavMesh.
+     * 
+     * For large meshes: precomputation and on-demand queries then search
+     * two clusters plus the abstract graph instead of the whole mesh.
+     * Pass nullptr to go back to flat searches. The hierarchy must be
+     * built on the same NavMesh and outlive this provider.
+     */
+    void SetHierarchy(const Backend::Layer1::HierarchicalNavMesh* hierarchy) {
+        hierarchy_ = hierarchy;
+        fallbackCache_.Clear();
+    }
+    
+    /**
+     * @brief Spread PrecomputeForNodes and ComputeRefresh searches over
+     *        the scheduler's workers instead of threads of their own.
+     * 
+     * The scheduler must outlive this provider; nullptr goes back to a
+     * thread per core per call.
+     */
+    void SetScheduler(Backend::Common::TaskScheduler* scheduler) { scheduler_ = scheduler; }
+    
+    /**
+     * @brief Select the search used by RunAStar (and so by on-demand
+     *        GetCost queries when no hierarchy is set).
+     */
+    void SetSearchMode(CostSearchMode mode) { searchMode_ = mode; }
+    CostSearchMode GetSearchMode() const { return searchMode_; }
+    
+    /**
+     * @brief Select the matrix element type (see CostStorage).
+     * 
+     * Clears the matrix when the type changes; set it before
+     * PrecomputeForNodes / LoadSnapshot. CopyFrom takes the source's.
+     */
+    void SetStorage(CostStorage storage);
+    CostStorage GetStorage() const { return storage_; }
+    
+    /**
+     * @brief Largest lookup error of the quantized matrix (half a code
+     *        step; 0 for FLOAT32).
+     */
+    float GetQuantizationError() const {
+        return storage_ == CostStorage::QUANTIZED16 ? 0.5f * quantStep_ : 0.0f;
+    }
+    
     // =========================================================================
     // PRECOMPUTATION
     // =========================================================================
     
+    /**
+     * @brief Pick ALT landmarks and compute their distance tables.
+     * 
+     * Landmarks are chosen by farthest-point selection: each new landmark
+     * is the node farthest from the ones already chosen. With the tables,
+     * |d(L, t) - d(L, v)| is a lower bound on d(v, t), which usually beats
+     * the Euclidean bound by a wide margin in aisle layouts.
+     * 
+     * Distances ignore the blocked overlay (blocking only lengthens paths,
+     * so the bounds stay admissible). Tables are dropped automatically
+     * when the mesh gains or loses nodes; call again afterwards.
+     * Memory: count x nodes floats.
+     * 
+     * @param count Number of landmarks (0 removes them)
+     * @return Number of landmarks selected
+     */
+    int PrecomputeLandmarks(int count = DEFAULT_LANDMARK_COUNT);
+    
+    /**
+     * @brief Landmark node IDs (empty if none / out of date).
+     */
+    const std::vector<int>& GetLandmarks() const { return landmarkNodes_; }
+    
     /**
      * @brief Precompute costs between all pairs of specified nodes.
      * 
-     * This runs A* for each source node to all destination nodes.
-     * Time complexity: O(N² × (E + V log V)) where N = number of nodes.
+     * This runs one early-exit Dijkstra per source node (or one
+     * hierarchical query when a hierarchy is set), spread across all
+     * cores with a preallocated workspace per thread.
+     * Time complexity: O(N × (E + V log V)) where N = number of nodes.
+     * 
+     * Pairs already in the matrix (e.g. restored by LoadSnapshot) are not
+     * searched again: new nodes get full rows, known rows are only
+     * extended by the new columns. Entries from an older overlay version
+     * (IsStale()) are discarded first.
      * 
      * For a typical warehouse with ~100 POIs and ~500 NavMesh nodes:
      * - 100² = 10,000 A* runs
@@ -101,6 +492,110 @@ public:
      * @return Number of paths successfully computed
      */
     int AddRowForNode(int fromNodeId, const std::vector<int>& toNodeIds);
+    
+    /**
+     * @brief Search the rows of robot start nodes before a solve.
+     * 
+     * Robots rarely stand on a POI, so a solver evaluating start legs
+     * would miss the matrix and search the same pairs on demand again and
+     * again. Each source without a slot gets one search towards the
+     * targets that have one, rows spread across the workers as in
+     * PrecomputeForNodes, into a table answered by GetCost until the
+     * overlay changes. The table replaces the previous call's (a source
+     * seen then keeps the entries it had), so it holds one row per robot
+     * instead of growing the matrix with every node robots stop at.
+     * 
+     * Not safe while a solve or PrepareRefresh reads the provider.
+     * 
+     * @param sourceIds Robot start nodes (POI nodes are skipped)
+     * @param targetIds Task endpoints and chargers (nodes without a slot are left to on-demand searches)
+     * @return Number of rows searched
+     */
+    int PrecomputeStartRows(const std::vector<int>& sourceIds, const std::vector<int>& targetIds);
+    
+    /// Rows held by the start-row table
+    size_t GetStartRowCount() const { return startRowNodes_.size(); }
+
+    // =========================================================================
+    // INCREMENTAL INVALIDATION
+    // =========================================================================
+    
+    /**
+     * @brief Rows whose costs may have changed since the matrix version.
+     * 
+     * A node that became blocked or got a penalty invalidates the rows
+     * whose shortest paths cross its region; a node that became free or
+     * cheaper invalidates the rows where a detour through it could beat a
+     * known cost (by the lower bound used for A*). Every other row is
+     * still exact.
+     */
+    std::vector<int> FindAffectedRows() const;
+    
+    /**
+     * @brief Recompute the affected rows into a RowRefresh, in parallel.
+     * 
+     * Reads the matrix and the NavMesh without modifying anything, so it
+     * can run on a background thread while solvers keep querying; the
+     * NavMesh overlay and this provider must not be modified meanwhile.
+     */
+    RowRefresh PrepareRefresh() const;
+    
+    /**
+     * @brief Swap prepared rows in and advance the matrix version.
+     * 
+     * Call while no solver is reading. Rejects (returns false) a refresh
+     * prepared against another version or before a Clear().
+     */
+    bool CommitRefresh(const RowRefresh& refresh);
+    
+    /**
+     * @brief PrepareRefresh + CommitRefresh on the calling thread.
+     * 
+     * @return Number of rows recomputed
+     */
+    int RefreshStaleRows();
+    
+    // =========================================================================
+    // SNAPSHOTS
+    // =========================================================================
+    
+    /**
+     * @brief Hash of everything the costs depend on: node positions, edges
+     *        with their costs and the blocked overlay.
+     * 
+     * POIs are deliberately not part of it: a snapshot stores its own node
+     * list, so added POIs only cost their own rows and columns.
+     */
+    static uint64_t ComputeMeshFingerprint(const Backend::Layer1::NavMesh& mesh);
+    
+    /**
+     * @brief Write the matrix (nodes and known entries) to a binary file.
+     * 
+     * Written next to path and renamed into place.
+     * 
+     * @return true on success
+     */
+    bool SaveSnapshot(const std::string& path, uint64_t fingerprint) const;
+    
+    /**
+     * @brief Replace the matrix with a snapshot written for the same mesh.
+     * 
+     * @return false (matrix untouched) if the file is missing, corrupt, of
+     *         another format version or fingerprint
+     */
+    bool LoadSnapshot(const std::string& path, uint64_t fingerprint);
+    
+    /**
+     * @brief Replace the matrix with another provider's, computed on this
+     *        mesh or a copy of it (one precomputation, a matrix per fleet).
+     * 
+     * Slots, costs, path regions and landmark tables are copied; the
+     * hierarchy and search mode stay as set on this provider. other must
+     * not be modified meanwhile.
+     * 
+     * @return false (matrix untouched) if other's mesh has another node count
+     */
+    bool CopyFrom(const CostMatrixProvider& other);
 
     // =========================================================================
     // QUERIES
@@ -109,26 +604,147 @@ public:
     /**
      * @brief Get the cost between two nodes.
      * 
+     * Precomputed pairs are answered from the matrix (or the start rows,
+     * see PrecomputeStartRows); any other pair is looked up in a bounded
+     * LRU cache and searched on demand on a miss.
+     * Safe to call from several threads as long as the matrix itself is
+     * not being modified.
+     * 
      * @param fromNodeId Source node ID
      * @param toNodeId Destination node ID
      * @return Travel cost (distance), or INFINITY if unreachable
      */
-    float GetCost(int fromNodeId, int toNodeId) const;
+    float GetCost(int fromNodeId, int toNodeId) const {
+        if (fromNodeId == toNodeId) return 0.0f;
+        int fromSlot = GetSlot(fromNodeId);
+        int toSlot = GetSlot(toNodeId);
+        if (fromSlot >= 0 && toSlot >= 0) {
+            float cost = LoadEntry(static_cast<size_t>(fromSlot) * slotCapacity_ + toSlot);
+            if (cost != UNKNOWN_COST) return cost;
+        } else if (toSlot >= 0 && toSlot < startRowWidth_) {
+            float cost = GetStartRowCost(fromNodeId, toSlot);
+            if (cost != UNKNOWN_COST) return cost;
+        }
+        return GetCostSlow(fromNodeId, toNodeId);
+    }
+    
+    /**
+     * @brief Matrix slot of a node, or -1 if it has none.
+     * 
+     * Slots stay valid until Clear().
+     */
+    int GetSlot(int nodeId) const {
+        if (nodeId < 0 || nodeId >= static_cast<int>(nodeToSlot_.size())) return -1;
+        return nodeToSlot_[nodeId];
+    }
+    
+    /**
+     * @brief Cost between two slots (see GetSlot), a plain array load for
+     *        precomputed pairs.
+     */
+    float GetCostBySlot(int fromSlot, int toSlot) const {
+        float cost = LoadEntry(static_cast<size_t>(fromSlot) * slotCapacity_ + toSlot);
+        if (cost != UNKNOWN_COST) return cost;
+        return GetCostSlow(slotToNode_[fromSlot], slotToNode_[toSlot]);
+    }
+    
+    /**
+     * @brief Cost of the path slots[0] -> slots[1] -> ... -> slots[count - 1]
+     *        in one call (see GetSlot).
+     *
+     * Scoring a whole route pair by pair pays a call, two slot lookups and
+     * a storage branch per leg. This gathers the legs from the matrix in
+     * one loop and sums them in double, two lanes at a time with SSE2.
+     * Legs not precomputed are answered like GetCostBySlot. The legs are
+     * floats, so at warehouse cost ranges the double sum is exact and
+     * equals a leg-by-leg walk whatever the order. Thread-safe like GetCost.
+     *
+     * @param legs If not null, receives the count - 1 leg costs
+     * @return Sum of the legs (0 for fewer than two slots)
+     */
+    double GetPathCostBySlots(const int* slots, size_t count, float* legs = nullptr) const;
+    
+    /**
+     * @brief Number of nodes with a matrix slot.
+     */
+    int GetSlotCount() const { return static_cast<int>(slotToNode_.size()); }
+    
+    /**
+     * @brief Node ID owning a slot.
+     */
+    int GetSlotNode(int slot) const { return slotToNode_[slot]; }
     
     /**
      * @brief Check if a path exists between two nodes.
      */
     bool HasPath(int fromNodeId, int toNodeId) const;
     
+    /**
+     * @brief Whether a path joins two nodes on the current overlay.
+     *
+     * Compares connected-component labels computed once per mesh change
+     * version, so it is O(1) after the first call following a change. A
+     * pair outside the matrix that fails this costs INFINITY_COST without
+     * a search (which would otherwise settle the whole component), and
+     * row searches stop waiting for targets that fail it. Thread-safe.
+     */
+    bool IsReachable(int fromNodeId, int toNodeId) const {
+        return IsReachable(*GetComponents(), fromNodeId, toNodeId);
+    }
+    
     /**
      * @brief Get the number of precomputed pairs.
      */
-    size_t GetMatrixSize() const { return costMatrix_.size(); }
+    size_t GetMatrixSize() const { return computedPairs_; }
+    
+    /**
+     * @brief GetCost calls answered by the on-demand cache / that needed a
+     *        search. A growing miss count means a solver is running on
+     *        searches instead of the matrix.
+     */
+    uint64_t GetFallbackHits() const { return fallbackCache_.GetHits(); }
+    uint64_t GetFallbackMisses() const { return fallbackCache_.GetMisses(); }
+    
+    /**
+     * @brief Search time of every on-demand miss (what a solver stalls on).
+     */
+    const Common::LatencyHistogram& GetMissLatency() const { return missLatency_; }
     
     /**
-     * @brief Clear all cached costs.
+     * @brief Number of pairs held by the on-demand cache.
      */
-    void Clear() { costMatrix_.clear(); }
+    size_t GetFallbackCacheSize() const { return fallbackCache_.GetSize(); }
+    
+    /**
+     * @brief Bytes held by the matrix, its slot maps, landmarks, row
+     *        regions and the on-demand cache. Call from the thread that
+     *        refreshes the matrix; the per-thread search scratch is not
+     *        counted.
+     */
+    size_t GetMemoryBytes() const;
+    
+    /**
+     * @brief Reset the on-demand hit / miss counters.
+     */
+    void ResetFallbackStats() { fallbackCache_.ResetStats(); }
+    
+    /**
+     * @brief Check if the NavMesh overlay changed since costs were computed.
+     * 
+     * When true, RefreshStaleRows() (or PrepareRefresh / CommitRefresh)
+     * recomputes just the rows affected by newly blocked or freed nodes.
+     */
+    bool IsStale() const { return navMesh_.GetChangeVersion() != meshVersion_; }
+    
+    /**
+     * @brief Overlay version the cached costs were computed against.
+     */
+    uint64_t GetMeshVersion() const { return meshVersion_; }
+    
+    /**
+     * @brief Clear all cached costs (matrix and on-demand cache).
+     */
+    void Clear();
 
     // =========================================================================
     // A* ALGORITHM
@@ -137,6 +753,9 @@ public:
     /**
      * @brief Run A* from source to target on the NavMesh.
      * 
+     * Uses the search selected with SetSearchMode and, when landmarks are
+     * available, the ALT lower bound as heuristic.
+     * 
      * @param sourceId Source node ID
      * @param targetId Target node ID
      * @return Optimal path cost, or INFINITY if no path exists
@@ -153,6 +772,20 @@ public:
      * @return Map of targetId -> cost for all reachable nodes
      */
     std::unordered_map<int, float> RunDijkstra(int sourceId) const;
+    
+    /**
+     * @brief Edge cost unit of the mesh's bucket queue (0 = costs not all
+     *        multiples of one unit: Dijkstra searches use the radix heap).
+     * 
+     * Searches under congestion penalties use the radix heap either way.
+     */
+    float GetCostUnit() const { return costUnit_; }
+
+    /**
+     * @brief Nodes settled by RunAStar calls so far (all threads).
+     */
+    uint64_t GetExpandedNodeCount() const { return expandedNodes_.load(std::memory_order_relaxed); }
+    void ResetExpandedNodeCount() { expandedNodes_.store(0, std::memory_order_relaxed); }
 
     // =========================================================================
     // DEBUG
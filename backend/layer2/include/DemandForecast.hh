@@ -0,0 +1,96 @@
+/**
+ * @file DemandForecast.hh
+ * @brief Expected task arrivals per POI pair from recent task history
+ *
+ * Planning reacts to tasks once they are injected, so a robot that has
+ * gone idle at a dropoff waits there until the next order appears and
+ * then drives all the way to its pickup. Orders repeat: the same pickups
+ * feed the same dropoffs through a shift. DemandForecast keeps an
+ * exponentially decayed count of the tasks seen per (pickup, dropoff)
+ * and turns it into arrival rates, so idle robots can be sent toward the
+ * pickups that are about to get work.
+ */
+
+#ifndef LAYER2_DEMANDFORECAST_HH
+#define LAYER2_DEMANDFORECAST_HH
+
+#include "Task.hh"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Decayed task counts per (source, destination) node pair.
+ *
+ * With half-life h a steady stream of r tasks per second settles at a
+ * weight of r * h / ln 2; a history shorter than that is scaled by the
+ * time observed, so the first tasks of a run already give a rate.
+ *
+ * Not thread-safe: one thread observes and queries.
+ */
+class DemandForecast {
+public:
+    static constexpr double DEFAULT_HALF_LIFE_SECONDS = 900.0;
+
+    /// Expected tasks at one node
+    struct Demand {
+        int node = -1;
+        double expected = 0.0;
+    };
+
+    /**
+     * @param halfLifeSeconds Time after which a task counts half
+     */
+    explicit DemandForecast(double halfLifeSeconds = DEFAULT_HALF_LIFE_SECONDS);
+
+    /**
+     * @brief Record tasks that arrived at time now (seconds, monotonic).
+     */
+    void Observe(const std::vector<Task>& tasks, double now);
+
+    /**
+     * @brief Tasks per second expected from source to destination.
+     */
+    double GetRate(int sourceNode, int destinationNode, double now) const;
+
+    /**
+     * @brief Expected pickups per source node within horizon seconds,
+     *        most first; nodes expecting less than minExpected are left out.
+     *        Until horizon seconds of history are seen, a node expects at
+     *        most the decayed count it had.
+     */
+    std::vector<Demand> ExpectedPickups(double now, double horizonSeconds, double minExpected) const;
+
+    size_t GetObservedCount() const { return observed_; }
+    size_t GetPairCount() const { return pairWeight_.size(); }
+
+    /// Heap bytes of the pair table
+    size_t GetMemoryBytes() const;
+
+private:
+    double halfLifeSeconds_;
+    double firstSeen_ = -1.0;           ///< Time of the first task (-1 = none yet)
+    double decayedAt_ = 0.0;            ///< Time the weights are decayed to
+    size_t observed_ = 0;
+    std::unordered_map<uint64_t, double> pairWeight_;   ///< (source, destination) -> decayed count
+
+    static uint64_t PairKey(int sourceNode, int destinationNode) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(sourceNode)) << 32) |
+               static_cast<uint32_t>(destinationNode);
+    }
+
+    /// Decay factor from decayedAt_ to now
+    double DecayTo(double now) const;
+
+    /// Seconds of history a weight stands for at time now
+    double Window(double now) const;
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_DEMANDFORECAST_HH
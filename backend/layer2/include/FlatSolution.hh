@@ -0,0 +1,142 @@
+/**
+ * @file FlatSolution.hh
+ * @brief Compact task-to-robot assignment shared by the Layer 2 solvers
+ *
+ * All routes live in one array of task indices (indices into the tasks
+ * passed to IVRPSolver::Solve), robot r owning the slice
+ * [offset[r], offset[r + 1]). Copying a solution is two flat copies that
+ * reuse the destination's storage, and every edit can be journaled and
+ * rolled back, so a solver tries a move in place instead of copying the
+ * whole assignment.
+ */
+
+#ifndef LAYER2_FLATSOLUTION_HH
+#define LAYER2_FLATSOLUTION_HH
+
+#include <cstddef>
+#include <vector>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Read-only view of one robot's route.
+ */
+class RouteView {
+    const int* data_;
+    int size_;
+
+public:
+    RouteView(const int* data, int size) : data_(data), size_(size) {}
+
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const int* begin() const { return data_; }
+    const int* end() const { return data_ + size_; }
+    int operator[](int i) const { return data_[i]; }
+    int front() const { return data_[0]; }
+    int back() const { return data_[size_ - 1]; }
+};
+
+/**
+ * @brief Flat multi-route solution with an undo journal.
+ *
+ * Edits shift the tail of the flat array (a memmove of at most the task
+ * count) and adjust the offsets of the robots after the edited one.
+ *
+ * Journal: between Commit() calls every edit records its inverse;
+ * Rollback() undoes them newest first and restores the solution as it
+ * was at the last Commit(). Journal entries are plain values in a reused
+ * vector, so trying and rejecting a move allocates nothing.
+ */
+class FlatSolution {
+public:
+    FlatSolution() = default;
+
+    /**
+     * @param numRobots Number of routes (all start empty)
+     * @param capacity Tasks to reserve room for
+     */
+    explicit FlatSolution(int numRobots, int capacity = 0);
+
+    /// Copies the routes, not the journal (the copy starts committed)
+    FlatSolution(const FlatSolution& other);
+    FlatSolution& operator=(const FlatSolution& other);
+    FlatSolution(FlatSolution&&) noexcept = default;
+    FlatSolution& operator=(FlatSolution&&) noexcept = default;
+
+    /**
+     * @brief Build from per-robot task index lists.
+     */
+    static FlatSolution FromRoutes(const std::vector<std::vector<int>>& routes);
+
+    /**
+     * @brief Per-robot task index lists (for interfaces that need them).
+     */
+    std::vector<std::vector<int>> ToRoutes() const;
+
+    // --- Queries ---
+    int GetRobotCount() const { return static_cast<int>(offset_.size()) - 1; }
+    int GetTaskCount() const { return static_cast<int>(order_.size()); }
+    int RouteSize(int robot) const { return offset_[robot + 1] - offset_[robot]; }
+    int At(int robot, int pos) const { return order_[offset_[robot] + pos]; }
+
+    RouteView Route(int robot) const {
+        return RouteView(order_.data() + offset_[robot], RouteSize(robot));
+    }
+
+    // --- Edits (journaled) ---
+
+    /// Insert task before position pos of robot's route (pos == size appends)
+    void Insert(int robot, int pos, int task);
+
+    /// Remove and return the task at position pos of robot's route
+    int Erase(int robot, int pos);
+
+    void PushBack(int robot, int task) { Insert(robot, RouteSize(robot), task); }
+
+    /// Exchange two entries (same or different robots)
+    void Swap(int robot1, int pos1, int robot2, int pos2);
+
+    /// Remove from (fromRobot, fromPos), then insert at (toRobot, toPos)
+    /// of the route as it is after the removal
+    void Relocate(int fromRobot, int fromPos, int toRobot, int toPos);
+
+    /// Exchange the tails of two different routes: robot1's tasks from
+    /// pos1 on and robot2's tasks from pos2 on (2-opt*). One pass over the
+    /// array between the two tails; its own inverse
+    void ExchangeTails(int robot1, int pos1, int robot2, int pos2);
+
+    /// Empty every route (not journaled; also commits)
+    void Clear();
+
+    // --- Journal ---
+    void Commit() { journal_.clear(); }
+    void Rollback();
+    bool HasPendingEdits() const { return !journal_.empty(); }
+
+private:
+    std::vector<int> order_;    ///< All routes, robot 0 first
+    std::vector<int> offset_;   ///< Robot r's route starts at offset_[r]; size robots + 1
+
+    struct JournalEntry {
+        enum Kind : int { INSERTED, ERASED, SWAPPED, TAILS_EXCHANGED } kind;
+        int robot1;
+        int pos1;
+        int robot2;     ///< SWAPPED / TAILS_EXCHANGED only
+        int pos2;       ///< SWAPPED / TAILS_EXCHANGED only
+        int task;       ///< ERASED only
+    };
+    std::vector<JournalEntry> journal_;
+
+    // Raw edits (no journaling)
+    void InsertRaw(int robot, int pos, int task);
+    int EraseRaw(int robot, int pos);
+    void SwapRaw(int robot1, int pos1, int robot2, int pos2);
+    void ExchangeTailsRaw(int robot1, int pos1, int robot2, int pos2);
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_FLATSOLUTION_HH
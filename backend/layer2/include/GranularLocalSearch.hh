@@ -0,0 +1,228 @@
+/**
+ * @file GranularLocalSearch.hh
+ * @brief Neighbour lists and granular local search shared by the Layer 2 solvers
+ *
+ * A full relocate / exchange neighbourhood is quadratic in the task count,
+ * which is too slow for 1000+ task waves. Granular search only tries moves
+ * that create an edge between a task and one of its k nearest neighbours
+ * (precomputed once per solve from the cost matrix), so one pass costs
+ * O(tasks * k) move evaluations, each an O(1) delta.
+ */
+
+#ifndef LAYER2_GRANULARLOCALSEARCH_HH
+#define LAYER2_GRANULARLOCALSEARCH_HH
+
+#include "IVRPSolver.hh"
+#include "FlatSolution.hh"
+#include <utility>
+#include <vector>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Per task, its k nearest tasks and robot starts by travel cost.
+ *
+ * Task u is near t if a robot could chain them cheaply in either order;
+ * a robot start is near t by the cost of reaching t's pickup. An entry
+ * c >= 0 is a task index, c < 0 the start of robot (-c - 1).
+ */
+class NeighborLists {
+public:
+    static constexpr int DEFAULT_SIZE = 30;
+
+    /**
+     * @brief Compute the lists (O(tasks^2) cost lookups, once per solve).
+     *
+     * @param tasks Tasks being solved (lists hold indices into it)
+     * @param startNodes Per robot, the node its route starts from
+     * @param costs Cost matrix
+     * @param k Neighbours kept per task
+     */
+    void Build(
+        const std::vector<Task>& tasks,
+        const std::vector<int>& startNodes,
+        const CostMatrixProvider& costs,
+        int k
+    );
+
+    /**
+     * @brief Compute the lists over nearby groups only.
+     *
+     * Task t (and a robot start in group g) only competes for t's list if
+     * its group is in nearbyGroups[groupOf[t]], so with groups of bounded
+     * size the build is linear in the task count instead of quadratic.
+     *
+     * @param taskGroup Per task, its group
+     * @param robotGroup Per robot, its group
+     * @param nearbyGroups Per group, the groups (itself included) to pair with
+     */
+    void BuildPartitioned(
+        const std::vector<Task>& tasks,
+        const std::vector<int>& startNodes,
+        const CostMatrixProvider& costs,
+        int k,
+        const std::vector<int>& taskGroup,
+        const std::vector<int>& robotGroup,
+        const std::vector<std::vector<int>>& nearbyGroups
+    );
+
+    const std::vector<int>& Of(int task) const { return lists_[task]; }
+    int GetTaskCount() const { return static_cast<int>(lists_.size()); }
+
+    static bool IsRobotStart(int candidate) { return candidate < 0; }
+    static int StartRobot(int candidate) { return -candidate - 1; }
+
+private:
+    std::vector<std::vector<int>> lists_;
+
+    // Keep the count nearest of scored as task's list
+    void Keep(int task, std::vector<std::pair<float, int>>& scored, size_t count);
+};
+
+/**
+ * @brief Descent with granular relocate, Or-opt and 2-opt* moves.
+ *
+ * For every task u and neighbour v of u:
+ * - Relocate / Or-opt: move the segment of 1..MAX_SEGMENT_LENGTH tasks
+ *   starting at u right after v, or right before it (same or other robot).
+ *   A robot start as v means the front of that robot's route.
+ * - 2-opt*: when v is on another robot, exchange the route tails so that
+ *   v is followed by u (or u by v).
+ *
+ * Routes are evaluated with O(1) deltas from per-route prefix times. A
+ * move is applied when it lowers the larger completion time of the routes
+ * it touches, or keeps it and lowers their sum, so the makespan never
+ * rises and, once the bottleneck cannot improve, the remaining routes are
+ * shortened. The best such move for u is applied before moving on to the
+ * next task; passes repeat until one finds nothing.
+ *
+ * With a battery planner (SetBatteryPlanner), route times include charging
+ * stops and moves are screened in O(1) against each route's cached
+ * BatteryProfile: a move that would need a new stop is not considered.
+ * Since that screen assumes the remaining stops stay put, the chosen move
+ * is re-planned exactly before it is kept, and undone if it does not help.
+ */
+class GranularLocalSearch {
+public:
+    static constexpr int MAX_SEGMENT_LENGTH = 3;
+    static constexpr int DEFAULT_MAX_PASSES = 50;
+
+    struct Stats {
+        int passes = 0;
+        int relocates = 0;      ///< Single-task moves
+        int orOpts = 0;         ///< Segment moves (2..MAX_SEGMENT_LENGTH tasks)
+        int twoOptStars = 0;    ///< Tail exchanges
+
+        int Moves() const { return relocates + orOpts + twoOptStars; }
+    };
+
+    /**
+     * @param tasks Tasks being solved (solutions hold indices into it)
+     * @param startNodes Per robot, the node its route starts from
+     * @param costs Cost matrix
+     * @param neighbors Lists built for the same tasks and robots
+     */
+    GranularLocalSearch(
+        const std::vector<Task>& tasks,
+        const std::vector<int>& startNodes,
+        const CostMatrixProvider& costs,
+        const NeighborLists& neighbors
+    );
+
+    /**
+     * @brief Improve solution in place until no granular move helps.
+     *
+     * @param solution Assignment to improve (committed on return)
+     * @param routeTimes Set to the completion time of every route
+     * @param options Checked before each pass
+     * @param maxPasses Upper bound on passes over the tasks
+     * @return true if any move was applied
+     */
+    bool Run(
+        FlatSolution& solution,
+        std::vector<double>& routeTimes,
+        const SolveOptions& options,
+        int maxPasses = DEFAULT_MAX_PASSES
+    );
+
+    /**
+     * @brief Completion time of one robot's route.
+     */
+    double RouteTime(RouteView route, int robot) const;
+
+    const Stats& GetStats() const { return stats_; }
+
+    /**
+     * @brief Score routes with charging stops (nullptr or disabled = travel only).
+     */
+    void SetBatteryPlanner(const BatteryPlanner* planner) {
+        battery_ = (planner && planner->IsEnabled()) ? planner : nullptr;
+    }
+
+private:
+    enum class MoveKind { NONE, SEGMENT, TAILS };
+
+    /// Best move found for the current task
+    struct Candidate {
+        MoveKind kind = MoveKind::NONE;
+        int robot1 = 0;
+        int pos1 = 0;         ///< SEGMENT: first task; TAILS: robot1's tail start
+        int length = 0;       ///< SEGMENT only
+        int robot2 = 0;
+        int pos2 = 0;         ///< SEGMENT: insert position once removed; TAILS: robot2's tail start
+        double deltaMax = 0.0;  ///< Change of the larger touched completion time
+        double deltaSum = 0.0;  ///< Change of the touched completion times' sum
+    };
+
+    /// Deltas below this are float noise, not improvements
+    static constexpr double IMPROVEMENT_EPSILON = 1e-4;
+
+    const std::vector<Task>& tasks_;
+    const std::vector<int>& startNodes_;
+    const CostMatrixProvider& costs_;
+    const NeighborLists& neighbors_;
+    std::vector<float> serviceCost_;            ///< Per task: pickup -> dropoff
+    RouteScorer scorer_;
+    const BatteryPlanner* battery_ = nullptr;
+
+    // Search state, rebuilt for the routes each applied move touches
+    FlatSolution* solution_ = nullptr;
+    std::vector<int> robotOf_;                  ///< Per task
+    std::vector<int> positionOf_;               ///< Per task
+    std::vector<std::vector<double>> prefix_;   ///< Per robot: time after its first k tasks
+    std::vector<BatteryProfile> profiles_;      ///< Per robot, with a battery planner
+    std::vector<int> segment_;                  ///< Tasks being moved
+    Stats stats_;
+
+    // Travel from the end of pred (task, or robot start as -r - 1) to task's pickup
+    float Transition(int pred, int task) const;
+    int Predecessor(int robot, int pos) const;
+    double RouteTotal(int robot) const { return prefix_[robot].back(); }
+
+    /// Time of robot's tasks from pos on, not counting the travel into pos
+    double TailTime(int robot, int pos) const;
+
+    void RebuildRoute(int robot);
+
+    void TrySegmentMoves(int task, Candidate& best) const;
+    void TryTailExchanges(int task, Candidate& best) const;
+
+    /// Insert the segment [pos, pos + length) of robot right after pred
+    /// (task, or -r - 1 for the front of robot r)
+    void EvaluateSegmentMove(int robot, int pos, int length, int pred, Candidate& best) const;
+
+    /// Make robot1's tasks before pos1 continue with robot2's tasks from pos2, and vice versa
+    void EvaluateTailExchange(int robot1, int pos1, int robot2, int pos2, Candidate& best) const;
+
+    /// Fill move's deltas from the new completion times and keep it if it beats best
+    void Consider(Candidate& move, double newTime1, double newTime2, Candidate& best) const;
+
+    /// Apply move; false if the exact battery re-plan rejected (and undid) it
+    bool Apply(const Candidate& move);
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_GRANULARLOCALSEARCH_HH
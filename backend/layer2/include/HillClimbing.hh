@@ -3,13 +3,17 @@
  * @brief Hill Climbing VRP solver implementation
  * 
  * A metaheuristic that iteratively improves a greedy initial solution
- * through local search (task swaps between robots).
+ * through local search (granular relocate / Or-opt / 2-opt* moves, then
+ * task moves off the bottleneck robot).
  */
 
 #ifndef LAYER2_HILLCLIMBING_HH
 #define LAYER2_HILLCLIMBING_HH
 
 #include "IVRPSolver.hh"
+#include "FlatSolution.hh"
+#include "GranularLocalSearch.hh"
+#include "ScratchArena.hh"
 #include <random>
 #include <algorithm>
 
@@ -22,11 +26,15 @@ namespace Layer2 {
  * Strategy:
  * 1. Generate initial solution using greedy heuristic
  *    - For each task, assign to the robot that minimizes additional cost
- * 2. Iteratively improve through local search:
+ * 2. Descend with granular moves (GranularLocalSearch): relocate, Or-opt
+ *    and 2-opt* restricted to each task's k nearest neighbours, so a pass
+ *    stays near-linear in the task count
+ * 3. Iteratively improve the bottleneck robot:
+ *    - Try moving its last task to another robot
  *    - Try swapping tasks between robots
  *    - Try reordering tasks within a robot's itinerary
  *    - Accept changes that reduce makespan
- * 3. Use random restarts to escape local optima
+ * 4. Use random restarts to escape local optima
  * 
  * This is a heuristic (not exact), trading optimality for speed.
  */
@@ -36,9 +44,13 @@ private:
     int maxIterations_;       ///< Maximum iterations without improvement
     int maxRestarts_;         ///< Maximum random restarts
     unsigned int seed_;       ///< Random seed for reproducibility
+    int neighborListSize_;    ///< Nearest tasks each task may be moved next to
     
     // Random number generator
     mutable std::mt19937 rng_;
+    
+    // Per-move scratch (candidate lists, restart shuffles)
+    mutable ScratchArena arena_;
 
 public:
     // =========================================================================
@@ -51,11 +63,18 @@ public:
      * @param maxIterations Max iterations without improvement before stopping
      * @param maxRestarts Max random restarts when stuck
      * @param seed Random seed (0 = use time)
+     * @param neighborListSize Nearest tasks each task may be moved next to
      */
-    explicit HillClimbing(int maxIterations = 1000, int maxRestarts = 10, unsigned int seed = 0)
+    explicit HillClimbing(
+        int maxIterations = 1000,
+        int maxRestarts = 10,
+        unsigned int seed = 0,
+        int neighborListSize = NeighborLists::DEFAULT_SIZE
+    )
         : maxIterations_(maxIterations)
         , maxRestarts_(maxRestarts)
         , seed_(seed)
+        , neighborListSize_(std::max(1, neighborListSize))
         , rng_(seed == 0 ? std::random_device{}() : seed) {}
 
     // =========================================================================
@@ -65,16 +84,19 @@ public:
     /**
      * @brief Solve VRP using Hill Climbing.
      */
+    using IVRPSolver::Solve;
+
     VRPResult Solve(
         const std::vector<Task>& tasks,
         std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const CostMatrixProvider& costs,
+        const SolveOptions& options
     ) override;
 
     std::string GetName() const override { return "Hill Climbing"; }
     
     std::string GetDescription() const override {
-        return "Greedy initial + local search (inter-robot swaps, intra-robot reordering)";
+        return "Greedy initial + granular local search (relocate, Or-opt, 2-opt*) + bottleneck moves";
     }
     
     bool IsExact() const override { return false; }
@@ -87,9 +109,19 @@ private:
     /**
      * @brief Internal representation of a solution.
      * 
-     * Maps robot index to assigned tasks.
+     * Maps robot index to its assigned tasks (indices into the Solve()
+     * input). Moves are tried in place and rolled back when they fail.
      */
-    using Assignment = std::vector<std::vector<Task>>;
+    using Assignment = FlatSolution;
+
+    /// Everything one Solve() call searches over
+    struct SearchContext {
+        const std::vector<Task>* tasks = nullptr;
+        const CostMatrixProvider* costs = nullptr;
+        std::vector<int> startNodes;        ///< Per robot
+        const BatteryPlanner* battery = nullptr;    ///< Charging-aware route times (nullptr = travel only)
+        RouteScorer scorer;                 ///< Travel-only route times
+    };
 
     // =========================================================================
     // SOLUTION GENERATION
@@ -102,24 +134,26 @@ private:
      * - Compute insertion cost for each robot
      * - Assign to robot with minimum additional cost
      * 
-     * @param tasks Tasks to assign
-     * @param robots Available robots
-     * @param costs Cost matrix
+     * @param ctx Tasks, robot starts and cost matrix
      * @return Initial assignment
      */
-    Assignment GenerateGreedySolution(
+    Assignment GenerateGreedySolution(const SearchContext& ctx) const;
+
+    /**
+     * @brief Initial assignment from SolveOptions::warmStart, with the
+     *        tasks it does not cover inserted at their cheapest position.
+     */
+    Assignment GenerateWarmStartSolution(
         const std::vector<Task>& tasks,
         const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const CostMatrixProvider& costs,
+        const std::vector<std::vector<int>>& warmStart
     ) const;
 
     /**
-     * @brief Generate a random solution (for restarts).
+     * @brief Overwrite assignment with a random solution (for restarts).
      */
-    Assignment GenerateRandomSolution(
-        const std::vector<Task>& tasks,
-        int numRobots
-    ) const;
+    void GenerateRandomSolution(Assignment& assignment, int numTasks) const;
 
     // =========================================================================
     // COST CALCULATION
@@ -131,14 +165,12 @@ private:
      * Makespan = maximum completion time across all robots.
      * 
      * @param assignment Current task assignment
-     * @param robots Robot list (for starting positions)
-     * @param costs Cost matrix
+     * @param ctx Tasks, robot starts and cost matrix
      * @return Makespan value
      */
     double CalculateMakespan(
         const Assignment& assignment,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const SearchContext& ctx
     ) const;
 
     /**
@@ -146,9 +178,8 @@ private:
      */
     double CalculateRobotTime(
         int robotIdx,
-        const std::vector<Task>& robotTasks,
-        const RobotAgent& robot,
-        const CostMatrixProvider& costs
+        RouteView robotTasks,
+        const SearchContext& ctx
     ) const;
 
     // =========================================================================
@@ -159,15 +190,13 @@ private:
      * @brief Try to improve solution through local moves.
      * 
      * @param assignment Current assignment (modified in place if improved)
-     * @param robots Robot list
-     * @param costs Cost matrix
+     * @param ctx Tasks, robot starts and cost matrix
      * @param currentMakespan Current makespan (updated if improved)
      * @return true if improvement found
      */
     bool TryImprovement(
         Assignment& assignment,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs,
+        const SearchContext& ctx,
         double& currentMakespan
     ) const;
 
@@ -180,8 +209,7 @@ private:
      */
     bool TryInterRobotMove(
         Assignment& assignment,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs,
+        const SearchContext& ctx,
         double& currentMakespan
     ) const;
 
@@ -194,8 +222,7 @@ private:
      */
     bool TryInterRobotSwap(
         Assignment& assignment,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs,
+        const SearchContext& ctx,
         double& currentMakespan
     ) const;
 
@@ -208,8 +235,7 @@ private:
      */
     bool TryIntraRobotReorder(
         Assignment& assignment,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs,
+        const SearchContext& ctx,
         double& currentMakespan
     ) const;
 
@@ -224,8 +250,7 @@ private:
         Assignment& assignment,
         std::vector<double>& robotTimes,
         double& currentMakespan,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const SearchContext& ctx
     ) const;
 
     /**
@@ -235,8 +260,7 @@ private:
         Assignment& assignment,
         std::vector<double>& robotTimes,
         double& currentMakespan,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const SearchContext& ctx
     ) const;
 
     /**
@@ -247,8 +271,7 @@ private:
         std::vector<double>& robotTimes,
         double& currentMakespan,
         int robotIdx,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const SearchContext& ctx
     ) const;
 
     /**
@@ -256,10 +279,9 @@ private:
      */
     double CalculateRobotTimeWithout(
         int robotIdx,
-        const std::vector<Task>& robotTasks,
-        size_t excludeIdx,
-        const RobotAgent& robot,
-        const CostMatrixProvider& costs
+        RouteView robotTasks,
+        int excludeIdx,
+        const SearchContext& ctx
     ) const;
 
     /**
@@ -267,10 +289,9 @@ private:
      */
     double CalculateRobotTimeWithExtra(
         int robotIdx,
-        const std::vector<Task>& robotTasks,
-        const Task& extraTask,
-        const RobotAgent& robot,
-        const CostMatrixProvider& costs
+        RouteView robotTasks,
+        int extraTask,
+        const SearchContext& ctx
     ) const;
 
     // =========================================================================
@@ -282,6 +303,7 @@ private:
      */
     std::map<int, std::vector<int>> AssignmentToItineraries(
         const Assignment& assignment,
+        const SearchContext& ctx,
         const std::vector<RobotAgent>& robots
     ) const;
 };
@@ -12,10 +12,16 @@
 #include "Task.hh"
 #include "RobotAgent.hh"
 #include "CostMatrixProvider.hh"
+#include "BatteryProfile.hh"
+#include "LoadProfile.hh"
+#include "RouteScorer.hh"
+#include "FlatSolution.hh"
 #include <vector>
 #include <map>
 #include <string>
 #include <chrono>
+#include <atomic>
+#include <functional>
 
 namespace Backend {
 namespace Layer2 {
@@ -24,6 +30,18 @@ namespace Layer2 {
  * @brief Result of a VRP solver execution.
  */
 struct VRPResult {
+    /// Relative slack for float rounding when comparing against the bound
+    static constexpr double BOUND_TOLERANCE = 1e-6;
+    
+    /// How often an adaptive search picked one of its operators and how it paid off
+    struct OperatorStats {
+        std::string name;
+        int uses = 0;
+        int improvements = 0;               ///< Iterations that improved the current solution
+        int newBests = 0;                   ///< Iterations that improved the best solution
+        std::vector<double> weights;        ///< Selection weight after each segment (starts at 1)
+    };
+    
     // Robot ID -> Ordered list of goal node IDs (the itinerary)
     std::map<int, std::vector<int>> robotItineraries;
     
@@ -35,8 +53,14 @@ struct VRPResult {
     // Quality metrics
     bool isFeasible;            ///< Whether all constraints are satisfied
     bool isOptimal;             ///< Whether the solution is guaranteed optimal
+    bool stoppedEarly;          ///< Deadline or cancellation ended the search before its iteration limit
+    double lowerBound;          ///< Makespan lower bound of the instance (0 = not computed)
     std::string algorithmName;  ///< Name of the algorithm that produced this result
     
+    // Adaptive operator selection (ALNS; empty for other solvers)
+    std::vector<OperatorStats> operatorStats;   ///< Destroy operators, then repair operators
+    int weightSegments = 0;     ///< Segments after which the operator weights were re-scored
+    
     /**
      * @brief Default constructor.
      */
@@ -46,14 +70,109 @@ struct VRPResult {
         , computationTimeMs(0.0)
         , isFeasible(false)
         , isOptimal(false)
+        , stoppedEarly(false)
+        , lowerBound(0.0)
         , algorithmName("Unknown") {}
     
+    /**
+     * @brief Relative gap of the makespan to the lower bound (< 0 = unknown).
+     */
+    double Gap() const {
+        return lowerBound > 0.0 ? (makespan - lowerBound) / lowerBound : -1.0;
+    }
+    
+    /**
+     * @brief Record the instance's lower bound (call once makespan is final);
+     *        a makespan that meets it is marked optimal.
+     */
+    void SetLowerBound(double bound) {
+        lowerBound = bound;
+        if (bound > 0.0 && makespan <= bound * (1.0 + BOUND_TOLERANCE)) isOptimal = true;
+    }
+    
     /**
      * @brief Print result summary.
      */
     void Print() const;
 };
 
+/**
+ * @brief Anytime controls for a single Solve call.
+ *
+ * Solvers check ShouldStop() once per iteration, after the initial
+ * solution is built, and return their best solution so far when it fires:
+ * a deadline or a cancellation never yields an empty result, only an
+ * earlier one (VRPResult::stoppedEarly is set).
+ *
+ * Solvers also stop once their best makespan is within stopGap of
+ * IVRPSolver::MakespanLowerBound: no schedule can beat the bound, so the
+ * remaining iterations could gain at most that fraction. With the default
+ * of 0 this only fires when the bound is met, i.e. the solution is proven
+ * optimal; a negative stopGap disables it.
+ *
+ * onImprovement is called from the solving thread each time the best
+ * known solution improves, with the best itineraries, makespan and
+ * elapsed time so far. Solvers only build that result when a callback is
+ * set, so leaving it empty costs nothing.
+ */
+struct SolveOptions {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point deadline = Clock::time_point::max();  ///< Wall-clock stop (max = none)
+    const std::atomic<bool>* cancelToken = nullptr;         ///< Set to true to stop (nullptr = none)
+    std::function<void(const VRPResult&)> onImprovement;    ///< Best-so-far callback (empty = none)
+
+    /// Warm start: per robot (same order as the robots argument), the
+    /// ordered indices into tasks it already carries. Tasks not listed are
+    /// repair-inserted before the search starts. Empty = build from scratch.
+    /// See IVRPSolver::ExtractWarmStart.
+    std::vector<std::vector<int>> warmStart;
+
+    /// Battery model: when enabled, results include charging stops and
+    /// their makespan counts the detours and charging time (see
+    /// BatteryPlanner). Disabled by default: routes are scored by travel.
+    BatteryModel battery;
+
+    double stopGap = 0.0;               ///< Stop within this fraction of the lower bound (< 0 = never)
+    Common::TaskScheduler* scheduler = nullptr;     ///< Workers for parallel steps inside one solve (ALNS repair; nullptr = sequential)
+
+    /**
+     * @brief Options with a deadline budgetMs from now (<= 0 = no deadline).
+     */
+    static SolveOptions WithBudget(double budgetMs) {
+        SolveOptions options;
+        if (budgetMs > 0.0) {
+            options.deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::milli>(budgetMs));
+        }
+        return options;
+    }
+
+    bool HasDeadline() const { return deadline != Clock::time_point::max(); }
+    bool HasWarmStart() const { return !warmStart.empty(); }
+    bool WantsProgress() const { return static_cast<bool>(onImprovement); }
+
+    bool IsCancelled() const {
+        return cancelToken && cancelToken->load(std::memory_order_relaxed);
+    }
+
+    bool ShouldStop() const {
+        return IsCancelled() || (HasDeadline() && Clock::now() >= deadline);
+    }
+
+    /**
+     * @brief Whether makespan is close enough to lowerBound to stop searching.
+     */
+    bool ReachedBound(double makespan, double lowerBound) const {
+        return stopGap >= 0.0 && lowerBound > 0.0 &&
+               makespan <= lowerBound * (1.0 + stopGap + VRPResult::BOUND_TOLERANCE);
+    }
+
+    void NotifyImprovement(const VRPResult& result) const {
+        if (onImprovement) onImprovement(result);
+    }
+};
+
 /**
  * @brief Abstract interface for VRP solvers (Strategy Pattern).
  * 
@@ -96,14 +215,27 @@ public:
      * @param tasks List of tasks to assign
      * @param robots List of available robots (with current states)
      * @param costs Cost matrix provider for travel distances
+     * @param options Deadline, cancellation and progress reporting
      * @return VRPResult containing itineraries and metrics
      */
     virtual VRPResult Solve(
         const std::vector<Task>& tasks,
         std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const CostMatrixProvider& costs,
+        const SolveOptions& options
     ) = 0;
 
+    /**
+     * @brief Solve to the algorithm's own iteration limit.
+     */
+    VRPResult Solve(
+        const std::vector<Task>& tasks,
+        std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs
+    ) {
+        return Solve(tasks, robots, costs, SolveOptions());
+    }
+
     /**
      * @brief Get the name of the algorithm.
      */
@@ -119,7 +251,104 @@ public:
      */
     virtual bool IsExact() const = 0;
 
+    /**
+     * @brief Recover each robot's current task order from its itinerary.
+     *
+     * A task is matched where its dropoff follows its pickup with fewer
+     * than the robot's capacity unmatched goals from the pickup on (right
+     * after it for capacity 1, within a multi-pick batch otherwise); each
+     * task is matched at most once and ordered by its dropoff. Goals that
+     * match no task (e.g. the dropoff of a package already picked up,
+     * charging visits) are skipped.
+     *
+     * @return Per robot, the ordered task indices (suitable for
+     *         SolveOptions::warmStart); empty if no robot carries any task
+     */
+    static std::vector<std::vector<int>> ExtractWarmStart(
+        const std::vector<Task>& tasks,
+        const std::vector<RobotAgent>& robots
+    );
+
+    /**
+     * @brief Cheap lower bound on the makespan of any assignment.
+     *
+     * The larger of two bounds, both O(tasks * robots) cost lookups:
+     * - every task is done by some robot, which must at least reach its
+     *   pickup from its start and carry it: max over tasks of (nearest
+     *   robot start -> pickup + pickup -> dropoff);
+     * - the robots share the service work: sum of pickup -> dropoff / robots.
+     *   Only when every robot carries one packet at a time: multi-pick
+     *   batches share the travel between several tasks' endpoints.
+     * Charging stops only add time, so the bound holds with battery too.
+     *
+     * @return 0 if there are no tasks or no robots
+     */
+    static double MakespanLowerBound(
+        const std::vector<Task>& tasks,
+        const std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs
+    );
+
 protected:
+    /**
+     * @brief Turn a warm start into a complete initial assignment.
+     *
+     * Invalid and duplicate entries are dropped; every task the warm start
+     * does not cover is inserted at the (robot, position) that finishes
+     * that robot earliest, so robots keep their current order.
+     *
+     * @param newTasks Set to the number of tasks that had to be inserted
+     * @return Per robot, ordered task indices covering every task once
+     */
+    static std::vector<std::vector<int>> CompleteWarmStart(
+        const std::vector<Task>& tasks,
+        const std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs,
+        const std::vector<std::vector<int>>& warmStart,
+        int& newTasks
+    );
+
+    /**
+     * @brief Re-plan a finished solution with charging stops.
+     *
+     * No-op unless options.battery is enabled. Otherwise every robot keeps
+     * its task order in routes, charger visits are inserted where its
+     * battery would run low, and result's itineraries, makespan and
+     * totalDistance become the battery-aware ones, so the solved plan is
+     * the one the robots execute.
+     *
+     * @param routes Per robot (same order as robots), ordered task indices
+     */
+    static void ApplyBatteryPlan(
+        VRPResult& result,
+        const std::vector<Task>& tasks,
+        const std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs,
+        const SolveOptions& options,
+        const FlatSolution& routes
+    );
+
+    /**
+     * @brief Re-plan a finished solution with multi-pick batches.
+     *
+     * No-op unless some robot's capacity exceeds one packet, or when
+     * options.battery is enabled (charging stops are planned per task).
+     * Otherwise every robot keeps its task order in routes, consecutive
+     * tasks are grouped into batches within its capacity (LoadPlanner), and
+     * result's itineraries, makespan and totalDistance become the batched
+     * ones. Batching never lengthens a route.
+     *
+     * @param routes Per robot (same order as robots), ordered task indices
+     */
+    static void ApplyLoadPlan(
+        VRPResult& result,
+        const std::vector<Task>& tasks,
+        const std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs,
+        const SolveOptions& options,
+        const FlatSolution& routes
+    );
+
     /**
      * @brief Helper: Calculate total cost of an itinerary.
      * 
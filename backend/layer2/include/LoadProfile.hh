@@ -0,0 +1,111 @@
+/**
+ * @file LoadProfile.hh
+ * @brief Multi-pick route evaluation for robots carrying several packets
+ *
+ * The solvers order each robot's tasks and score the order as one task at
+ * a time: pickup, dropoff, next pickup. A robot with RobotAgent capacity
+ * k can instead collect up to k packets before delivering them. A
+ * LoadPlanner keeps a route's task order and splits it into consecutive
+ * batches of at most k tasks; a batch visits its pickups in route order,
+ * then its dropoffs in the same order:
+ *
+ *     P1 P2 D1 D2 | P3 D3 | ...
+ *
+ * The split is chosen by dynamic programming over route positions, so it
+ * is never worse than one task at a time (a split into single tasks) and,
+ * with capacity 1, is exactly that. The load along a batch is its task
+ * count, so whether a batch fits is a comparison with the capacity, and a
+ * batch's travel grows by one pickup and one dropoff leg as it is extended:
+ * a route is planned in O(route length * capacity).
+ */
+
+#ifndef LAYER2_LOADPROFILE_HH
+#define LAYER2_LOADPROFILE_HH
+
+#include "Task.hh"
+#include "RobotAgent.hh"
+#include "CostMatrixProvider.hh"
+#include "FlatSolution.hh"
+#include <vector>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Cached batching of one route (indices are route positions).
+ *
+ * Batch b covers positions [batchStart[b], batchStart[b + 1]) (the last
+ * one up to the route's end).
+ */
+struct LoadProfile {
+    std::vector<double> time;           ///< time[k]: best completion of the first k tasks (size + 1 entries)
+    std::vector<int> batchStart;        ///< First position of each batch, ascending
+    int maxLoad = 0;                    ///< Most packets carried at once
+
+    double Total() const { return time.back(); }
+    int Batches() const { return static_cast<int>(batchStart.size()); }
+};
+
+/**
+ * @brief Plans multi-pick batches for the routes of one solve.
+ *
+ * Every task is one packet. Enabled when some robot carries more than one;
+ * otherwise routes keep their pickup-then-dropoff pairs and callers skip
+ * the planner.
+ */
+class LoadPlanner {
+public:
+    /**
+     * @param tasks Tasks being solved (routes hold indices into it)
+     * @param robots Robots routes start from, with their load capacity
+     * @param costs Cost matrix
+     */
+    LoadPlanner(
+        const std::vector<Task>& tasks,
+        const std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs
+    );
+
+    bool IsEnabled() const { return enabled_; }
+
+    /// Packets robot carries at once (at least 1)
+    int Capacity(int robot) const { return capacity_[robot]; }
+
+    /**
+     * @brief Split robot's route into batches minimising its completion time.
+     *
+     * @param profile Filled with the route's batches
+     * @return Completion time of the route
+     */
+    double Plan(RouteView route, int robot, LoadProfile& profile) const;
+
+    /**
+     * @brief Completion time after each task of the best split (same as
+     *        profile.time without its leading 0).
+     *
+     * @param completion Resized to the route length
+     */
+    void Completion(RouteView route, int robot, std::vector<double>& completion) const;
+
+    /**
+     * @brief Itinerary of a planned route: per batch, its pickups then its dropoffs.
+     */
+    std::vector<int> Itinerary(RouteView route, const LoadProfile& profile) const;
+
+private:
+    bool enabled_ = false;
+    const std::vector<Task>& tasks_;
+    const CostMatrixProvider& costs_;
+    std::vector<int> startNodes_;           ///< Per robot
+    std::vector<int> capacity_;             ///< Per robot
+    std::vector<float> serviceCost_;        ///< Per task: pickup -> dropoff
+
+    /// Forward pass over size + 1 entries: best[k] is the completion of
+    /// the first k tasks, from[k] (if given) where the batch ending at k starts
+    void Walk(RouteView route, int robot, double* best, int* from) const;
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_LOADPROFILE_HH
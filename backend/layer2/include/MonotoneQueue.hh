@@ -0,0 +1,187 @@
+/**
+ * @file MonotoneQueue.hh
+ * @brief Priority queues for Dijkstra searches whose popped keys never
+ *        decrease
+ *
+ * A binary heap with lazy deletion pays O(log n) per push and pop and
+ * grows with duplicate entries. Dijkstra over non-negative edge costs
+ * only ever pushes keys at least as large as the last one popped, which
+ * two cheaper structures exploit:
+ *
+ * - BucketQueue (Dial): for meshes whose edge costs are all small integer
+ *   multiples of one unit (uniform tilings). A ring of buckets indexed by
+ *   distance in units; O(1) push and pop.
+ * - RadixHeap: for any non-negative float costs (penalized or merged
+ *   meshes). Entries sit in the bucket of the highest bit in which their
+ *   key differs from the last popped one; each entry moves down at most
+ *   32 times over the whole search.
+ *
+ * Both hand back entries of equal key in no particular order and, like
+ * the lazy heap, keep stale duplicates: callers skip settled nodes.
+ */
+
+#ifndef LAYER2_MONOTONEQUEUE_HH
+#define LAYER2_MONOTONEQUEUE_HH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Dial's bucket queue over distances that are multiples of a unit.
+ *
+ * Queued distances lie within maxSteps units of the smallest one, so a
+ * ring of maxSteps + 1 buckets holds them without collisions.
+ */
+class BucketQueue {
+public:
+    /// Empty the queue for distances in multiples of unit (> 0) that grow
+    /// by at most maxSteps units per push
+    void Reset(float unit, uint32_t maxSteps) {
+        for (auto& bucket : buckets_) bucket.clear();
+        buckets_.resize(static_cast<size_t>(maxSteps) + 1);
+        unit_ = unit;
+        cursor_ = 0;
+        size_ = 0;
+    }
+
+    /// distance must be a multiple of the unit, not below the last popped
+    /// distance and at most maxSteps units above it
+    void Push(float distance, int node) {
+        auto key = static_cast<uint32_t>(std::lround(distance / unit_));
+        buckets_[key % buckets_.size()].push_back({distance, node});
+        ++size_;
+    }
+
+    bool Empty() const { return size_ == 0; }
+
+    /// Remove a node of the smallest distance (not empty)
+    int Pop(float& distance) {
+        while (buckets_[cursor_ % buckets_.size()].empty()) ++cursor_;
+        auto& bucket = buckets_[cursor_ % buckets_.size()];
+        auto [popped, node] = bucket.back();
+        bucket.pop_back();
+        --size_;
+        distance = popped;
+        return node;
+    }
+
+private:
+    std::vector<std::vector<std::pair<float, int>>> buckets_;
+    float unit_ = 1.0f;
+    uint32_t cursor_ = 0;       ///< Smallest key (distance in units) that may still be queued
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Radix heap over non-negative float keys.
+ *
+ * Non-negative IEEE floats order like their bit patterns, so the heap
+ * works on those: exact, whatever the costs.
+ */
+class RadixHeap {
+public:
+    void Clear() {
+        for (auto& bucket : buckets_) bucket.clear();
+        last_ = 0;
+        size_ = 0;
+    }
+
+    /// key must be non-negative and not below the last popped key
+    void Push(float key, int node) {
+        uint32_t bits = ToBits(key);
+        buckets_[BucketOf(bits)].push_back({bits, node});
+        ++size_;
+    }
+
+    bool Empty() const { return size_ == 0; }
+
+    /// Remove a node of the smallest key (not empty)
+    int Pop(float& key) {
+        if (buckets_[0].empty()) {
+            // Redistribute the first non-empty bucket around its minimum:
+            // every entry lands in a lower bucket
+            size_t i = 1;
+            while (buckets_[i].empty()) ++i;
+            uint32_t minimum = buckets_[i][0].first;
+            for (const auto& entry : buckets_[i]) minimum = std::min(minimum, entry.first);
+            last_ = minimum;
+            for (const auto& entry : buckets_[i]) buckets_[BucketOf(entry.first)].push_back(entry);
+            buckets_[i].clear();
+        }
+        auto [bits, node] = buckets_[0].back();
+        buckets_[0].pop_back();
+        --size_;
+        key = FromBits(bits);
+        return node;
+    }
+
+private:
+    std::array<std::vector<std::pair<uint32_t, int>>, 33> buckets_;
+    uint32_t last_ = 0;         ///< Bits of the last popped key
+    size_t size_ = 0;
+
+    static uint32_t ToBits(float key) {
+        uint32_t bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        return bits;
+    }
+
+    static float FromBits(uint32_t bits) {
+        float key;
+        std::memcpy(&key, &bits, sizeof(key));
+        return key;
+    }
+
+    // 0 for keys equal to last_, else one past the highest differing bit
+    size_t BucketOf(uint32_t bits) const {
+        return bits == last_ ? 0 : 32 - static_cast<size_t>(__builtin_clz(bits ^ last_));
+    }
+};
+
+/**
+ * @brief BucketQueue when the search's costs are multiples of a unit,
+ *        else RadixHeap.
+ */
+class MonotoneQueue {
+public:
+    /// Empty the queue; unit 0 = arbitrary costs (see BucketQueue::Reset)
+    void Reset(float unit, uint32_t maxSteps) {
+        useBuckets_ = unit > 0.0f;
+        if (useBuckets_) {
+            buckets_.Reset(unit, maxSteps);
+        } else {
+            radix_.Clear();
+        }
+    }
+
+    void Push(float distance, int node) {
+        if (useBuckets_) {
+            buckets_.Push(distance, node);
+        } else {
+            radix_.Push(distance, node);
+        }
+    }
+
+    bool Empty() const { return useBuckets_ ? buckets_.Empty() : radix_.Empty(); }
+
+    int Pop(float& distance) { return useBuckets_ ? buckets_.Pop(distance) : radix_.Pop(distance); }
+
+private:
+    BucketQueue buckets_;
+    RadixHeap radix_;
+    bool useBuckets_ = false;
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_MONOTONEQUEUE_HH
@@ -0,0 +1,108 @@
+/**
+ * @file PairCostCache.hh
+ * @brief Bounded, thread-safe cache of on-demand node-pair costs
+ *
+ * Holds the results of searches for pairs outside the CostMatrixProvider
+ * matrix, so a solver that keeps asking for the same cold pair (e.g. a
+ * robot's current node) pays for the search once.
+ */
+
+#ifndef LAYER2_PAIRCOSTCACHE_HH
+#define LAYER2_PAIRCOSTCACHE_HH
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Sharded LRU map (fromNode, toNode) -> cost.
+ *
+ * The key space is split over SHARD_COUNT shards, each with its own
+ * mutex, LRU list and capacity, so concurrent readers (solver threads,
+ * the background replan thread) rarely contend. Each entry is tagged with
+ * the NavMesh overlay version it was computed against; a lookup with a
+ * different version misses and drops the shard's stale entries.
+ *
+ * Hit / miss counters are relaxed atomics: exact totals, no ordering.
+ */
+class PairCostCache {
+public:
+    static constexpr size_t SHARD_COUNT = 16;
+    static constexpr size_t DEFAULT_CAPACITY = 16384;
+
+private:
+    struct Shard {
+        std::mutex mutex;
+
+        // Most recently used at the front
+        std::list<std::pair<uint64_t, float>> lru;
+        std::unordered_map<uint64_t, std::list<std::pair<uint64_t, float>>::iterator> index;
+
+        // Overlay version of every entry in this shard
+        uint64_t version = 0;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards_;
+    size_t shardCapacity_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+
+    static uint64_t MakeKey(int fromNodeId, int toNodeId) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(fromNodeId)) << 32) |
+               static_cast<uint32_t>(toNodeId);
+    }
+
+    Shard& ShardFor(uint64_t key);
+
+    // Drop all entries of a shard whose version differs (caller holds the lock)
+    static void SyncVersion(Shard& shard, uint64_t version);
+
+public:
+    /**
+     * @param capacity Maximum number of entries, split evenly over the shards
+     */
+    explicit PairCostCache(size_t capacity = DEFAULT_CAPACITY);
+
+    PairCostCache(const PairCostCache&) = delete;
+    PairCostCache& operator=(const PairCostCache&) = delete;
+
+    /**
+     * @brief Look up a pair computed against the given overlay version.
+     *
+     * @return true and sets cost on a hit (the entry becomes most recent)
+     */
+    bool Find(int fromNodeId, int toNodeId, uint64_t version, float& cost);
+
+    /**
+     * @brief Insert or refresh a pair, evicting the shard's least recently
+     *        used entry when it is full.
+     */
+    void Insert(int fromNodeId, int toNodeId, uint64_t version, float cost);
+
+    /**
+     * @brief Remove every entry (counters are kept).
+     */
+    void Clear();
+
+    // --- Stats ---
+    size_t GetSize();
+    size_t GetMemoryBytes();        ///< Estimated bytes held by all shards
+    size_t GetCapacity() const { return shardCapacity_ * SHARD_COUNT; }
+    uint64_t GetHits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t GetMisses() const { return misses_.load(std::memory_order_relaxed); }
+    void ResetStats();
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_PAIRCOSTCACHE_HH
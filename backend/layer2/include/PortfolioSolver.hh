@@ -0,0 +1,115 @@
+/**
+ * @file PortfolioSolver.hh
+ * @brief Runs several VRP solvers concurrently and keeps the best result
+ *
+ * ALNS, Tabu Search, Simulated Annealing and Hill Climbing each win on
+ * different instance shapes (see algorithm_comparison.cc). The portfolio
+ * runs a set of configured members (different algorithms and/or seeds)
+ * on their own threads and returns the best itinerary set any of them
+ * found within a wall-clock budget.
+ */
+
+#ifndef LAYER2_PORTFOLIOSOLVER_HH
+#define LAYER2_PORTFOLIOSOLVER_HH
+
+#include "IVRPSolver.hh"
+#include <memory>
+#include <mutex>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Parallel solver portfolio with a shared incumbent (Strategy Pattern).
+ *
+ * Every member runs on its own thread (the last one on the calling
+ * thread), or as one job of a ParallelFor when SolveOptions::scheduler is
+ * set, so each member instance is only ever used by one thread and its
+ * RNG needs no locking. After each run a member publishes its result
+ * to a mutex-protected incumbent slot; the best feasible result with the
+ * lowest makespan wins, ties going to the earlier member.
+ *
+ * Time budget:
+ * - 0 (and no caller deadline): every member runs exactly once
+ * - >0: members keep restarting (their RNG continues, so each run differs)
+ *   until the earlier of the budget and the caller's SolveOptions deadline;
+ *   the run in progress at the deadline stops with its best so far.
+ *
+ * A caller cancellation stops every member; improvement callbacks are
+ * forwarded (serialised) whenever a member beats the best reported so far.
+ *
+ * The CostMatrixProvider is shared read-only by all members.
+ */
+class PortfolioSolver : public IVRPSolver {
+public:
+    static constexpr unsigned int DEFAULT_BASE_SEED = 42;
+
+private:
+    std::vector<std::unique_ptr<IVRPSolver>> members_;
+    double timeBudgetMs_;   ///< Wall-clock budget per Solve (0 = one run per member)
+
+    // Best result published so far (guarded by incumbentMutex_)
+    struct Incumbent {
+        bool valid = false;
+        VRPResult result;
+        std::vector<RobotAgent> robots;   ///< Robot states after the winning run
+        size_t memberIndex = 0;
+    };
+
+    std::mutex incumbentMutex_;
+    Incumbent incumbent_;
+
+    // Publish a member's result; returns true if it became the incumbent
+    bool Publish(size_t memberIndex, const VRPResult& result,
+                 const std::vector<RobotAgent>& robots);
+
+public:
+    /**
+     * @param members Solvers to run concurrently (one thread each)
+     * @param timeBudgetMs Wall-clock budget per Solve (0 = one run per member)
+     * @throws std::invalid_argument if members is empty or contains null
+     */
+    explicit PortfolioSolver(std::vector<std::unique_ptr<IVRPSolver>> members,
+                             double timeBudgetMs = 0.0);
+
+    /**
+     * @brief Build a mixed portfolio of count members.
+     *
+     * Cycles ALNS, Tabu Search, Simulated Annealing and Hill Climbing,
+     * giving member i the seed baseSeed + i so repeated algorithms explore
+     * different neighbourhoods.
+     */
+    static std::vector<std::unique_ptr<IVRPSolver>> MakeDefaultMembers(
+        int count, unsigned int baseSeed = DEFAULT_BASE_SEED);
+
+    // =========================================================================
+    // IVRPSOLVER INTERFACE
+    // =========================================================================
+
+    using IVRPSolver::Solve;
+
+    VRPResult Solve(
+        const std::vector<Task>& tasks,
+        std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs,
+        const SolveOptions& options
+    ) override;
+
+    std::string GetName() const override { return "Portfolio"; }
+
+    std::string GetDescription() const override {
+        return "Runs several metaheuristics concurrently and keeps the best makespan";
+    }
+
+    bool IsExact() const override;
+
+    // --- Configuration ---
+    size_t GetMemberCount() const { return members_.size(); }
+    double GetTimeBudgetMs() const { return timeBudgetMs_; }
+    void SetTimeBudgetMs(double ms) { timeBudgetMs_ = ms; }
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_PORTFOLIOSOLVER_HH
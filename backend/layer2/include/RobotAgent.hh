@@ -15,6 +15,7 @@
 #define LAYER2_ROBOTAGENT_HH
 
 #include "../../common/include/Coordinates.hh"
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -56,6 +57,79 @@ inline std::string StatusToString(RobotStatus status) {
     }
 }
 
+/**
+ * @brief Goal node IDs in visiting order, with O(1) removal from the front.
+ * 
+ * Goals live in a vector read from an offset: popping a goal advances the
+ * offset, and the consumed prefix is only compacted away once it is larger
+ * than the goals left (amortised O(1) per pop). Assigning a whole plan
+ * moves its vector in, so a replan hands over an itinerary without
+ * copying its goals, and a goal pushed back onto the front reuses a
+ * consumed slot.
+ */
+class GoalQueue {
+public:
+    using const_iterator = std::vector<int>::const_iterator;
+    
+    GoalQueue() = default;
+    explicit GoalQueue(std::vector<int> goals) : goals_(std::move(goals)) {}
+    
+    const_iterator begin() const { return goals_.begin() + head_; }
+    const_iterator end() const { return goals_.end(); }
+    size_t size() const { return goals_.size() - head_; }
+    bool empty() const { return head_ == goals_.size(); }
+    int front() const { return goals_[head_]; }
+    int operator[](size_t index) const { return goals_[head_ + index]; }
+    
+    /// Replace every goal (moves the vector in)
+    void Assign(std::vector<int> goals) {
+        goals_ = std::move(goals);
+        head_ = 0;
+    }
+    
+    template<typename Iterator>
+    void Append(Iterator first, Iterator last) { goals_.insert(goals_.end(), first, last); }
+    
+    void PushBack(int goal) { goals_.push_back(goal); }
+    
+    void PushFront(int goal) {
+        if (head_ > 0) {
+            goals_[--head_] = goal;
+        } else {
+            goals_.insert(goals_.begin(), goal);
+        }
+    }
+    
+    /// Remove the first goal (the queue must not be empty)
+    int PopFront() {
+        int goal = goals_[head_++];
+        if (head_ == goals_.size()) {
+            goals_.clear();
+            head_ = 0;
+        } else if (head_ > goals_.size() - head_) {
+            goals_.erase(goals_.begin(), goals_.begin() + head_);
+            head_ = 0;
+        }
+        return goal;
+    }
+    
+    void Clear() {
+        goals_.clear();
+        head_ = 0;
+    }
+    
+    std::vector<int> ToVector() const { return std::vector<int>(begin(), end()); }
+    
+    bool operator==(const std::vector<int>& goals) const {
+        return std::equal(begin(), end(), goals.begin(), goals.end());
+    }
+    bool operator!=(const std::vector<int>& goals) const { return !(*this == goals); }
+
+private:
+    std::vector<int> goals_;
+    size_t head_ = 0;                   ///< Goals before this were consumed
+};
+
 /**
  * @brief Current state of a robot (mutable data).
  * 
@@ -66,7 +140,7 @@ struct RobotState {
     int currentNodeId;                  ///< Current NavMesh node (or nearest)
     RobotStatus status;                 ///< Current operational status
     float currentBatteryLevel;          ///< Battery level (0.0 - 1.0, percentage)
-    std::vector<int> currentItinerary;  ///< Ordered list of goal node IDs
+    GoalQueue currentItinerary;         ///< Ordered list of goal node IDs
     
     /**
      * @brief Default constructor (idle at node 0 with full battery).
@@ -91,9 +165,7 @@ struct RobotState {
      */
     int PopNextGoal() {
         if (currentItinerary.empty()) return -1;
-        int goal = currentItinerary.front();
-        currentItinerary.erase(currentItinerary.begin());
-        return goal;
+        return currentItinerary.PopFront();
     }
     
     /**
@@ -180,7 +252,7 @@ public:
     int GetCurrentNodeId() const { return currentState_.currentNodeId; }
     RobotStatus GetStatus() const { return currentState_.status; }
     float GetCurrentBattery() const { return currentState_.currentBatteryLevel; }
-    const std::vector<int>& GetItinerary() const { return currentState_.currentItinerary; }
+    const GoalQueue& GetItinerary() const { return currentState_.currentItinerary; }
 
     // =========================================================================
     // SETTERS - Dynamic State
@@ -200,11 +272,12 @@ public:
      * This replaces the current itinerary with a new one.
      * Called by the VRP solver when (re)assigning tasks.
      * 
-     * @param nodes Ordered list of goal node IDs to visit
+     * @param nodes Ordered list of goal node IDs to visit (moved in)
      */
-    void AssignItinerary(const std::vector<int>& nodes) {
-        currentState_.currentItinerary = nodes;
-        if (!nodes.empty() && currentState_.status == RobotStatus::IDLE) {
+    void AssignItinerary(std::vector<int> nodes) {
+        bool hasGoals = !nodes.empty();
+        currentState_.currentItinerary.Assign(std::move(nodes));
+        if (hasGoals && currentState_.status == RobotStatus::IDLE) {
             currentState_.status = RobotStatus::BUSY;
         }
     }
@@ -217,10 +290,7 @@ public:
      * @param nodes Goals to append
      */
     void AppendToItinerary(const std::vector<int>& nodes) {
-        currentState_.currentItinerary.insert(
-            currentState_.currentItinerary.end(),
-            nodes.begin(), nodes.end()
-        );
+        currentState_.currentItinerary.Append(nodes.begin(), nodes.end());
         if (!currentState_.currentItinerary.empty() && 
             currentState_.status == RobotStatus::IDLE) {
             currentState_.status = RobotStatus::BUSY;
@@ -231,7 +301,7 @@ public:
      * @brief Clear the current itinerary.
      */
     void ClearItinerary() {
-        currentState_.currentItinerary.clear();
+        currentState_.currentItinerary.Clear();
     }
     
     /**
@@ -278,10 +348,7 @@ public:
         if (batteryLevel < 0.1f && currentState_.status != RobotStatus::CHARGING) {
             // Insert charging station as next goal
             if (chargingStationNodeId_ >= 0) {
-                currentState_.currentItinerary.insert(
-                    currentState_.currentItinerary.begin(),
-                    chargingStationNodeId_
-                );
+                currentState_.currentItinerary.PushFront(chargingStationNodeId_);
             }
         }
     }
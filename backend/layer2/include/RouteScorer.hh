@@ -0,0 +1,62 @@
+/**
+ * @file RouteScorer.hh
+ * @brief Whole-route travel times through the batched cost-matrix path API
+ *
+ * Every solver scores a route as start -> pickup -> dropoff -> next pickup
+ * and so on. Walked with GetCost, each leg is a call that looks up both
+ * nodes' slots and branches on the matrix storage. A RouteScorer resolves
+ * every task endpoint's slot once per solve and hands a route's slots to
+ * CostMatrixProvider::GetPathCostBySlots, which gathers and sums the legs
+ * in one pass.
+ */
+
+#ifndef LAYER2_ROUTESCORER_HH
+#define LAYER2_ROUTESCORER_HH
+
+#include "Task.hh"
+#include "CostMatrixProvider.hh"
+#include "FlatSolution.hh"
+#include <vector>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Travel time of task routes of one solve.
+ *
+ * Results equal the leg-by-leg GetCost walk (see GetPathCostBySlots). If
+ * some task endpoint has no matrix slot, routes are walked leg by leg.
+ * Const methods are thread-safe.
+ */
+class RouteScorer {
+public:
+    RouteScorer() = default;
+
+    /**
+     * @param tasks Tasks being solved (routes hold indices into it)
+     * @param costs Cost matrix
+     */
+    RouteScorer(const std::vector<Task>& tasks, const CostMatrixProvider& costs);
+
+    /**
+     * @brief Travel time of route from startNode.
+     *
+     * @param legs If not null, receives 2 * route.size() legs: legs[2k] to
+     *             task k's pickup, legs[2k + 1] from it to its dropoff
+     */
+    double RouteTime(RouteView route, int startNode, float* legs = nullptr) const;
+
+private:
+    const std::vector<Task>* tasks_ = nullptr;
+    const CostMatrixProvider* costs_ = nullptr;
+    std::vector<int> slots_;        ///< slots_[2t] / [2t + 1]: pickup / dropoff slot of task t
+    bool slotted_ = false;          ///< Every endpoint has a slot
+
+    /// Leg-by-leg GetCost walk
+    double WalkRoute(RouteView route, int startNode, float* legs) const;
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_ROUTESCORER_HH
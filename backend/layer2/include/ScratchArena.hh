@@ -0,0 +1,169 @@
+/**
+ * @file ScratchArena.hh
+ * @brief Bump allocator for per-iteration solver scratch buffers
+ *
+ * Metaheuristics need short-lived lists every iteration (candidate
+ * robots, removal orders, insertion tables). Taking them from an arena
+ * that is rewound at the end of the iteration keeps the search loop free
+ * of heap allocations once the arena has grown to its working size.
+ */
+
+#ifndef LAYER2_SCRATCHARENA_HH
+#define LAYER2_SCRATCHARENA_HH
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Backend {
+namespace Layer2 {
+
+class ScratchArena;
+
+/**
+ * @brief Vector of trivially copyable values living in a ScratchArena.
+ *
+ * Only valid until the enclosing ScratchArena::Frame is released. Growing
+ * past the reserved capacity takes a larger buffer from the arena (the
+ * old one is reclaimed with the frame), so push_back never fails; a
+ * vector shared with a helper that opens its own Frame must therefore be
+ * reserved large enough not to grow inside that helper.
+ */
+template <typename T>
+class ArenaVector {
+    static_assert(std::is_trivially_copyable<T>::value &&
+                  std::is_trivially_destructible<T>::value,
+                  "ArenaVector holds trivially copyable values only");
+
+    ScratchArena* arena_;
+    T* data_;
+    size_t size_;
+    size_t capacity_;
+
+    void Grow(size_t minCapacity);
+
+public:
+    ArenaVector(ScratchArena& arena, size_t capacity);
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    T& back() { return data_[size_ - 1]; }
+
+    void clear() { size_ = 0; }
+    void pop_back() { --size_; }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) Grow(size_ + 1);
+        data_[size_++] = value;
+    }
+
+    /// Resize; new elements are value-initialised
+    void resize(size_t count) {
+        if (count > capacity_) Grow(count);
+        for (size_t i = size_; i < count; ++i) data_[i] = T();
+        size_ = count;
+    }
+
+    /// Remove [first, last), shifting the tail down
+    void erase(size_t first, size_t last) {
+        std::memmove(data_ + first, data_ + last, (size_ - last) * sizeof(T));
+        size_ -= last - first;
+    }
+};
+
+/**
+ * @brief Monotonic scratch memory, rewound by RAII frames.
+ *
+ * Allocation bumps an offset into the current block; a Frame records the
+ * offset on construction and rewinds to it on destruction, so nested
+ * helpers can take their own buffers. When a request does not fit, a new
+ * block twice the size is chained; once the arena is fully rewound the
+ * blocks are merged into one, so the steady state is a single block and
+ * no allocation at all.
+ *
+ * Not thread-safe: each solver (or parallel tempering replica) owns one.
+ */
+class ScratchArena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    /// Rewinds the arena to where it was when the frame was opened
+    class Frame {
+        ScratchArena& arena_;
+        size_t block_;
+        size_t offset_;
+
+    public:
+        explicit Frame(ScratchArena& arena)
+            : arena_(arena), block_(arena.block_), offset_(arena.offset_) {}
+        ~Frame() { arena_.Rewind(block_, offset_); }
+
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+    };
+
+    explicit ScratchArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    ScratchArena(ScratchArena&&) noexcept = default;
+    ScratchArena& operator=(ScratchArena&&) noexcept = default;
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * @brief Uninitialised storage for count values of T.
+     */
+    template <typename T>
+    T* Allocate(size_t count) {
+        return static_cast<T*>(AllocateBytes(count * sizeof(T), alignof(T)));
+    }
+
+    // --- Stats ---
+    size_t GetCapacity() const;
+    size_t GetBlockCount() const { return blocks_.size(); }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    size_t blockSize_;    ///< Size of the first block
+    std::vector<Block> blocks_;
+    size_t block_ = 0;    ///< Block currently bumped
+    size_t offset_ = 0;   ///< Bytes used in that block
+
+    void* AllocateBytes(size_t bytes, size_t alignment);
+    void Rewind(size_t block, size_t offset);
+};
+
+template <typename T>
+ArenaVector<T>::ArenaVector(ScratchArena& arena, size_t capacity)
+    : arena_(&arena)
+    , data_(arena.Allocate<T>(capacity))
+    , size_(0)
+    , capacity_(capacity) {}
+
+template <typename T>
+void ArenaVector<T>::Grow(size_t minCapacity) {
+    size_t capacity = capacity_ * 2;
+    if (capacity < minCapacity) capacity = minCapacity;
+    T* data = arena_->Allocate<T>(capacity);
+    if (size_ > 0) std::memcpy(data, data_, size_ * sizeof(T));
+    data_ = data;
+    capacity_ = capacity;
+}
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_SCRATCHARENA_HH
@@ -11,9 +11,12 @@
 #define LAYER2_SIMULATEDANNEALING_HH
 
 #include "IVRPSolver.hh"
+#include "FlatSolution.hh"
+#include "ScratchArena.hh"
 #include <random>
 #include <algorithm>
 #include <cmath>
+#include <functional>
 
 namespace Backend {
 namespace Layer2 {
@@ -31,6 +34,17 @@ namespace Layer2 {
  * 4. Stop when temperature is too low or max iterations reached
  * 
  * This allows escaping local optima better than Hill Climbing.
+ *
+ * Parallel tempering (SetParallelTempering): instead of one cooling chain,
+ * N replicas run at fixed temperatures on a geometric ladder between
+ * minTemp and initialTemp, for as many steps as the cooling chain would
+ * take. Between exchanges the replicas run as one ParallelFor on
+ * SolveOptions::scheduler (in turn on the caller without one). Every exchangeInterval steps, neighbouring
+ * rungs swap solutions with the Metropolis probability
+ * min(1, exp((E_i - E_j) * (1/T_i - 1/T_j))), so good solutions drift to
+ * the cold end while hot replicas keep exploring; the cooling rate no
+ * longer matters. Replica k is seeded with seed + k, so a fixed seed gives
+ * the same result regardless of thread timing.
  */
 class SimulatedAnnealing : public IVRPSolver {
 private:
@@ -40,12 +54,18 @@ private:
     double minTemperature_;       ///< Stop when T < this
     int iterationsPerTemp_;       ///< Iterations at each temperature
     unsigned int seed_;           ///< Random seed for reproducibility
+    int replicaCount_;            ///< Parallel tempering replicas (1 = classic cooling)
+    int exchangeInterval_;        ///< Steps between replica exchanges
     
     // Random number generator
     mutable std::mt19937 rng_;
-    mutable std::uniform_real_distribution<double> uniformDist_;
+    
+    // Per-move scratch of the classic chain (replicas own theirs)
+    mutable ScratchArena arena_;
 
 public:
+    static constexpr int DEFAULT_EXCHANGE_INTERVAL = 50;
+
     // =========================================================================
     // CONSTRUCTOR
     // =========================================================================
@@ -71,20 +91,26 @@ public:
         , minTemperature_(minTemp)
         , iterationsPerTemp_(iterationsPerTemp)
         , seed_(seed)
-        , rng_(seed == 0 ? std::random_device{}() : seed)
-        , uniformDist_(0.0, 1.0) {}
+        , replicaCount_(1)
+        , exchangeInterval_(DEFAULT_EXCHANGE_INTERVAL)
+        , rng_(seed == 0 ? std::random_device{}() : seed) {}
 
     // =========================================================================
     // IVRPSOLVER INTERFACE
     // =========================================================================
     
+    using IVRPSolver::Solve;
+
     VRPResult Solve(
         const std::vector<Task>& tasks,
         std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const CostMatrixProvider& costs,
+        const SolveOptions& options
     ) override;
 
-    std::string GetName() const override { return "Simulated Annealing"; }
+    std::string GetName() const override {
+        return replicaCount_ > 1 ? "Parallel Tempering" : "Simulated Annealing";
+    }
     
     std::string GetDescription() const override {
         return "Probabilistic hill climbing that accepts worse solutions early to escape local optima";
@@ -92,37 +118,103 @@ public:
     
     bool IsExact() const override { return false; }
 
+    /**
+     * @brief Run replicas at a temperature ladder instead of one cooling chain.
+     *
+     * @param replicas Number of replicas (<= 1 = classic cooling)
+     * @param exchangeInterval Steps each replica runs between exchanges
+     */
+    void SetParallelTempering(int replicas, int exchangeInterval = DEFAULT_EXCHANGE_INTERVAL) {
+        replicaCount_ = std::max(1, replicas);
+        exchangeInterval_ = std::max(1, exchangeInterval);
+    }
+
+    int GetReplicaCount() const { return replicaCount_; }
+
 private:
     // =========================================================================
     // INTERNAL TYPES
     // =========================================================================
     
-    using Assignment = std::vector<std::vector<Task>>;
+    /// Per robot, indices into the Solve() tasks; neighbours are tried in
+    /// place and rolled back when rejected
+    using Assignment = FlatSolution;
+
+    /// Everything one Solve() call searches over
+    struct SearchContext {
+        const std::vector<Task>* tasks = nullptr;
+        const CostMatrixProvider* costs = nullptr;
+        std::vector<int> startNodes;        ///< Per robot
+        const BatteryPlanner* battery = nullptr;    ///< Charging-aware route times (nullptr = travel only)
+        RouteScorer scorer;                 ///< Travel-only route times
+    };
+
+    /// Current state of one annealing chain
+    struct ChainState {
+        Assignment current;
+        std::vector<double> robotTimes;     ///< Completion time per robot of current
+        double currentMakespan = 0.0;
+    };
+
+    /// Outcome of one Metropolis step
+    struct StepResult {
+        bool accepted = false;
+        bool improved = false;
+    };
+
+    /// One chain of the parallel tempering ladder
+    struct Replica {
+        ChainState state;
+        Assignment best;
+        double bestMakespan = 0.0;
+        double temperature = 0.0;
+        std::mt19937 rng;
+        ScratchArena arena;
+        int iterations = 0;
+        int accepted = 0;
+        int improved = 0;
+    };
+
+    struct TemperingStats {
+        int iterations = 0;
+        int accepted = 0;
+        int improved = 0;
+        int exchangesTried = 0;
+        int exchangesAccepted = 0;
+        bool stopped = false;
+        bool reachedBound = false;      ///< Best came within the stop gap of the lower bound
+    };
 
     // =========================================================================
     // SOLUTION GENERATION
     // =========================================================================
     
-    Assignment GenerateGreedySolution(
+    Assignment GenerateGreedySolution(const SearchContext& ctx) const;
+
+    /**
+     * @brief Initial assignment from SolveOptions::warmStart, with the
+     *        tasks it does not cover inserted at their cheapest position.
+     */
+    Assignment GenerateWarmStartSolution(
         const std::vector<Task>& tasks,
         const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const CostMatrixProvider& costs,
+        const std::vector<std::vector<int>>& warmStart
     ) const;
 
     // =========================================================================
     // COST CALCULATION
     // =========================================================================
     
-    double CalculateMakespan(
-        const Assignment& assignment,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
-    ) const;
+    /**
+     * @brief Fill state.robotTimes and state.currentMakespan from state.current.
+     */
+    void EvaluateChain(ChainState& state, const SearchContext& ctx) const;
 
     double CalculateRobotTime(
-        const std::vector<Task>& robotTasks,
-        const RobotAgent& robot,
-        const CostMatrixProvider& costs
+        RouteView route,
+        int robot,
+        const SearchContext& ctx
     ) const;
 
     // =========================================================================
@@ -130,16 +222,72 @@ private:
     // =========================================================================
     
     /**
-     * @brief Generate a random neighbor solution.
+     * @brief Apply a random move to the solution in place (journaled).
      * 
      * Randomly chooses one of:
      * - Move a task from one robot to another
      * - Swap tasks between two robots
      * - Reorder tasks within a robot
+     * 
+     * @param robotA, robotB Set to the robots whose routes changed (-1 = none)
      */
-    Assignment GenerateNeighbor(
-        const Assignment& current,
-        const std::vector<RobotAgent>& robots
+    void ApplyRandomMove(
+        Assignment& solution,
+        std::mt19937& rng,
+        ScratchArena& arena,
+        int& robotA,
+        int& robotB
+    ) const;
+
+    /**
+     * @brief Try one random move at the given temperature.
+     *
+     * Worse neighbours are accepted with probability exp(-delta / T);
+     * a rejected move is rolled back, so only the (at most two) changed
+     * routes are ever re-walked.
+     */
+    StepResult MetropolisStep(
+        ChainState& state,
+        double temperature,
+        std::mt19937& rng,
+        ScratchArena& arena,
+        const SearchContext& ctx
+    ) const;
+
+    // =========================================================================
+    // PARALLEL TEMPERING
+    // =========================================================================
+
+    /**
+     * @brief Run the replica ladder from an initial solution.
+     *
+     * bestSolution / bestMakespan are updated (and onImprovement called,
+     * from the calling thread) whenever an exchange round finds a new best.
+     * The ladder stops after the round whose best reaches lowerBound
+     * within options.stopGap.
+     */
+    void RunParallelTempering(
+        const ChainState& initial,
+        int stepsPerReplica,
+        const SearchContext& ctx,
+        const SolveOptions& options,
+        Assignment& bestSolution,
+        double& bestMakespan,
+        const std::function<void()>& onImprovement,
+        double lowerBound,
+        TemperingStats& stats
+    ) const;
+
+    /**
+     * @brief Metropolis steps of one replica at its fixed temperature.
+     *
+     * @return false if options asked to stop
+     */
+    bool RunReplicaSteps(
+        Replica& replica,
+        int steps,
+        const SearchContext& ctx,
+        const SolveOptions& options
     ) const;
 
     // =========================================================================
@@ -148,6 +296,7 @@ private:
     
     std::map<int, std::vector<int>> AssignmentToItineraries(
         const Assignment& assignment,
+        const SearchContext& ctx,
         const std::vector<RobotAgent>& robots
     ) const;
 };
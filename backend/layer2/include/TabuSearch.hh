@@ -10,10 +10,12 @@
 #define LAYER2_TABUSEARCH_HH
 
 #include "IVRPSolver.hh"
+#include "FlatSolution.hh"
+#include "GranularLocalSearch.hh"
 #include <random>
 #include <algorithm>
-#include <deque>
-#include <unordered_set>
+#include <cstdint>
+#include <unordered_map>
 
 namespace Backend {
 namespace Layer2 {
@@ -34,6 +36,16 @@ namespace Layer2 {
  * - Aspiration: Accept a tabu move if it's the best ever found
  * - Intensification: Focus on promising regions
  * - Diversification: Escape to unexplored regions
+ *
+ * Scaling:
+ * - Tabu memory is attribute based and hashed: "task t may not return to
+ *   robot r" / "tasks t, u may not be re-swapped" map to the iteration the
+ *   ban expires, so a membership test is O(1) whatever the tenure.
+ * - Moves are sampled from candidate lists: each task only pairs with its
+ *   k nearest tasks (or a robot's start) by travel cost, so large
+ *   neighbourhoods stay focused on plausible moves.
+ * - Each move is evaluated as an O(1) delta on the (at most two) routes it
+ *   touches; no neighbour solution is materialised.
  */
 class TabuSearch : public IVRPSolver {
 private:
@@ -42,11 +54,14 @@ private:
     int tabuTenure_;              ///< How long a move stays tabu
     int neighborhoodSize_;        ///< Number of neighbors to sample per iteration
     unsigned int seed_;           ///< Random seed for reproducibility
+    int candidateListSize_;       ///< Nearest tasks each task may pair with
     
     // Random number generator
     mutable std::mt19937 rng_;
 
 public:
+    static constexpr int DEFAULT_CANDIDATE_LIST_SIZE = NeighborLists::DEFAULT_SIZE;
+
     // =========================================================================
     // CONSTRUCTOR
     // =========================================================================
@@ -58,27 +73,33 @@ public:
      * @param tabuTenure How many iterations a move stays forbidden
      * @param neighborhoodSize How many neighbors to evaluate per iteration
      * @param seed Random seed (0 = use time)
+     * @param candidateListSize Nearest tasks each task may pair with
      */
     explicit TabuSearch(
         int maxIterations = 100,
         int tabuTenure = 10,
         int neighborhoodSize = 20,
-        unsigned int seed = 0
+        unsigned int seed = 0,
+        int candidateListSize = DEFAULT_CANDIDATE_LIST_SIZE
     )
         : maxIterations_(maxIterations)
         , tabuTenure_(tabuTenure)
         , neighborhoodSize_(neighborhoodSize)
         , seed_(seed)
+        , candidateListSize_(std::max(1, candidateListSize))
         , rng_(seed == 0 ? std::random_device{}() : seed) {}
 
     // =========================================================================
     // IVRPSOLVER INTERFACE
     // =========================================================================
     
+    using IVRPSolver::Solve;
+
     VRPResult Solve(
         const std::vector<Task>& tasks,
         std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const CostMatrixProvider& costs,
+        const SolveOptions& options
     ) override;
 
     std::string GetName() const override { return "Tabu Search"; }
@@ -94,8 +115,32 @@ private:
     // INTERNAL TYPES
     // =========================================================================
     
-    using Assignment = std::vector<std::vector<Task>>;
-    
+    /// Per robot, the ordered indices of its tasks in the Solve() input
+    using Routes = FlatSolution;
+
+    /// Everything one Solve() call searches over
+    struct SearchContext {
+        const std::vector<Task>* tasks = nullptr;
+        const CostMatrixProvider* costs = nullptr;
+        std::vector<int> startNodes;        ///< Per robot
+        std::vector<float> serviceCost;     ///< Per task: pickup -> dropoff
+        const BatteryPlanner* battery = nullptr;    ///< Charging-aware route times (nullptr = travel only)
+        RouteScorer scorer;                 ///< Travel-only route times
+
+        /// Per task, its nearest tasks and robot starts by travel cost
+        NeighborLists candidates;
+
+        float Cost(int from, int to) const { return costs->GetCost(from, to); }
+        int Source(int t) const { return (*tasks)[t].sourceNode; }
+        int Destination(int t) const { return (*tasks)[t].destinationNode; }
+    };
+
+    /// Where each task currently sits
+    struct TaskSlot {
+        int robot;
+        int position;
+    };
+
     /**
      * @brief Represents a move in the search space.
      */
@@ -103,50 +148,58 @@ private:
         int type;          // 0=transfer, 1=swap, 2=reorder
         int robot1;
         int robot2;
-        int taskIdx1;
-        int taskIdx2;
-        
-        bool operator==(const Move& other) const {
-            return type == other.type && robot1 == other.robot1 && 
-                   robot2 == other.robot2 && taskIdx1 == other.taskIdx1 && 
-                   taskIdx2 == other.taskIdx2;
-        }
+        int pos1;          // position of task1 in robot1
+        int pos2;          // transfer: insertion position in robot2, else position of task2
+        int task1;
+        int task2;         // -1 for transfers
     };
-    
-    struct MoveHash {
-        size_t operator()(const Move& m) const {
-            return std::hash<int>()(m.type) ^ 
-                   (std::hash<int>()(m.robot1) << 4) ^
-                   (std::hash<int>()(m.robot2) << 8) ^
-                   (std::hash<int>()(m.taskIdx1) << 12) ^
-                   (std::hash<int>()(m.taskIdx2) << 16);
-        }
+
+    /// Evaluated effect of a move on the routes it touches
+    struct MoveEval {
+        double makespan;
+        double time1;      // new completion time of robot1
+        double time2;      // new completion time of robot2
     };
 
+    /// Tabu attribute -> first iteration at which it is allowed again
+    using TabuMemory = std::unordered_map<uint64_t, int>;
+
+    static uint64_t PlacementKey(int task, int robot) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(task)) << 32) |
+               static_cast<uint32_t>(robot);
+    }
+
+    static uint64_t PairKey(int taskA, int taskB) {
+        uint32_t lo = static_cast<uint32_t>(std::min(taskA, taskB));
+        uint32_t hi = static_cast<uint32_t>(std::max(taskA, taskB));
+        return (uint64_t{1} << 63) | (static_cast<uint64_t>(lo) << 32) | hi;
+    }
+
     // =========================================================================
     // SOLUTION GENERATION
     // =========================================================================
     
-    Assignment GenerateGreedySolution(
+    Routes GenerateGreedySolution(const SearchContext& ctx) const;
+
+    /**
+     * @brief Initial assignment from SolveOptions::warmStart, with the
+     *        tasks it does not cover inserted at their cheapest position.
+     */
+    Routes GenerateWarmStartSolution(
         const std::vector<Task>& tasks,
         const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
+        const CostMatrixProvider& costs,
+        const std::vector<std::vector<int>>& warmStart
     ) const;
 
     // =========================================================================
     // COST CALCULATION
     // =========================================================================
     
-    double CalculateMakespan(
-        const Assignment& assignment,
-        const std::vector<RobotAgent>& robots,
-        const CostMatrixProvider& costs
-    ) const;
-
     double CalculateRobotTime(
-        const std::vector<Task>& robotTasks,
-        const RobotAgent& robot,
-        const CostMatrixProvider& costs
+        RouteView route,
+        int robot,
+        const SearchContext& ctx
     ) const;
 
     // =========================================================================
@@ -154,19 +207,38 @@ private:
     // =========================================================================
     
     /**
-     * @brief Generate a set of neighbor solutions.
+     * @brief Sample a move for a random task and one of its candidates.
+     *
+     * The task comes from the bottleneck robot half of the time. A
+     * candidate on the same robot gives a reorder, one on another robot a
+     * transfer or swap, a robot start a transfer to its front.
+     *
+     * @return false if the sampled pair yields no valid move
      */
-    std::vector<std::pair<Assignment, Move>> GenerateNeighbors(
-        const Assignment& current,
-        const std::vector<RobotAgent>& robots,
-        int count
+    bool SampleMove(
+        const Routes& routes,
+        const std::vector<TaskSlot>& slots,
+        int bottleneckRobot,
+        const SearchContext& ctx,
+        Move& move
     ) const;
-    
+
+    /**
+     * @brief O(1) evaluation of a move against the current route times.
+     */
+    MoveEval EvaluateMove(
+        const Routes& routes,
+        const std::vector<double>& routeTimes,
+        const Move& move,
+        const SearchContext& ctx
+    ) const;
+
     /**
-     * @brief Apply a move to create a new solution.
+     * @brief Apply a move in place and refresh the touched routes' slots.
      */
-    Assignment ApplyMove(
-        const Assignment& current,
+    void ApplyMove(
+        Routes& routes,
+        std::vector<TaskSlot>& slots,
         const Move& move
     ) const;
 
@@ -175,21 +247,22 @@ private:
     // =========================================================================
     
     /**
-     * @brief Check if a move is in the tabu list.
+     * @brief Check whether a move re-creates a banned attribute.
      */
-    bool IsTabu(const Move& move, const std::deque<Move>& tabuList) const;
+    bool IsTabu(const Move& move, const TabuMemory& tabu, int iteration) const;
     
     /**
-     * @brief Get the reverse of a move (for tabu list).
+     * @brief Ban undoing an applied move for tabuTenure_ iterations.
      */
-    Move GetReverseMove(const Move& move) const;
+    void MakeTabu(const Move& move, TabuMemory& tabu, int iteration) const;
 
     // =========================================================================
     // UTILITY
     // =========================================================================
     
-    std::map<int, std::vector<int>> AssignmentToItineraries(
-        const Assignment& assignment,
+    std::map<int, std::vector<int>> RoutesToItineraries(
+        const Routes& routes,
+        const SearchContext& ctx,
         const std::vector<RobotAgent>& robots
     ) const;
 };
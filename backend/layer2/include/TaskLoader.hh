@@ -14,6 +14,7 @@
 #include "../../layer1/include/POIRegistry.hh"
 #include <vector>
 #include <string>
+#include <string_view>
 #include <set>
 
 namespace Backend {
@@ -35,6 +36,13 @@ namespace Layer2 {
  * }
  * 
  * String POI IDs are resolved to NavMesh node IDs via POIRegistry.
+ *
+ * Files are memory-mapped and parsed in one pass by a streaming cursor
+ * that never copies an object: unknown fields (of any nesting) are
+ * skipped, each distinct POI name is resolved once through an interned
+ * table (a WMS wave names a few hundred POIs across 50k tasks), and
+ * syntax errors are reported with their byte offset. The tasks before a
+ * syntax error are kept.
  */
 class TaskLoader {
 public:
@@ -56,6 +64,25 @@ public:
                                               const Backend::Layer1::NavMesh& mesh,
                                               const Backend::Layer1::POIRegistry& poiRegistry);
     
+    /**
+     * @brief Parse tasks from a JSON document in memory (same format as the
+     *        file, e.g. a batch from the ingestion endpoint) and validate them.
+     * 
+     * @param content JSON document with a "tasks" array
+     * @param mesh The NavMesh to validate node IDs against
+     * @param poiRegistry The POIRegistry for resolving string IDs to node IDs
+     * @param rejected If set, receives the task objects skipped as invalid
+     * @param error If set, receives why the document could not be parsed
+     *              to the end (left as is when it could)
+     * @return Vector of valid Task objects, in document order (those before
+     *         a syntax error included)
+     */
+    static std::vector<Task> ParseTasksWithPOI(std::string_view content,
+                                               const Backend::Layer1::NavMesh& mesh,
+                                               const Backend::Layer1::POIRegistry& poiRegistry,
+                                               size_t* rejected = nullptr,
+                                               std::string* error = nullptr);
+    
     /**
      * @brief Load tasks from a JSON file and validate against NavMesh.
      * 
@@ -73,7 +100,8 @@ public:
      * 
      * @param tasks Vector of tasks to validate
      * @param mesh The NavMesh to validate node IDs against
-     * @return Vector of valid Task objects
+     * @return Tasks whose nodes exist and are connected in the mesh
+     *         (ignoring the blocked overlay)
      */
     static std::vector<Task> ValidateTasks(const std::vector<Task>& tasks,
                                            const Backend::Layer1::NavMesh& mesh);
@@ -101,17 +129,21 @@ private:
     /**
      * @brief Parse JSON content and extract tasks (legacy numeric format).
      */
-    static std::vector<Task> ParseJSON(const std::string& content);
+    static std::vector<Task> ParseJSON(std::string_view content);
 
     /**
      * @brief Parse JSON content and extract tasks with string POI IDs.
      * 
      * @param content JSON string content
      * @param poiRegistry Registry for resolving string IDs to node IDs
+     * @param objects If set, receives the task objects seen (valid or not)
+     * @param error If set, receives why the document could not be parsed
      * @return Vector of tasks with resolved node IDs
      */
-    static std::vector<Task> ParseJSONWithPOI(const std::string& content,
-                                              const Backend::Layer1::POIRegistry& poiRegistry);
+    static std::vector<Task> ParseJSONWithPOI(std::string_view content,
+                                              const Backend::Layer1::POIRegistry& poiRegistry,
+                                              size_t* objects = nullptr,
+                                              std::string* error = nullptr);
 };
 
 } // namespace Layer2
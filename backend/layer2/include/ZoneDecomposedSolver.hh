@@ -0,0 +1,127 @@
+/**
+ * @file ZoneDecomposedSolver.hh
+ * @brief Splits large VRP instances into zones solved concurrently
+ *
+ * With 100+ robots one global solve is needlessly slow: most tasks are
+ * local, and robots on opposite sides of the warehouse never compete for
+ * them. This front-end clusters tasks and robots into zones by travel
+ * cost, solves every zone on its own thread with the configured solver,
+ * then runs a short granular pass across zone boundaries.
+ */
+
+#ifndef LAYER2_ZONEDECOMPOSEDSOLVER_HH
+#define LAYER2_ZONEDECOMPOSEDSOLVER_HH
+
+#include "IVRPSolver.hh"
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+namespace Backend {
+namespace Layer2 {
+
+/**
+ * @brief Zone decomposition front-end for any IVRPSolver (Strategy Pattern).
+ *
+ * Zones:
+ * 1. One zone per robotsPerZone robots. Zone centres are task pickups,
+ *    chosen farthest-first and refined by a few k-medoids rounds (medoids
+ *    over a bounded sample), all by CostMatrixProvider travel cost, so
+ *    walls and aisles shape the zones, not straight-line distance.
+ * 2. Every task joins the zone of its nearest centre.
+ * 3. Robots are shared out in proportion to each zone's work (at least one
+ *    per zone with tasks), nearest robots first.
+ *
+ * Each zone is solved by a fresh solver from the factory on its own
+ * thread (the last zone on the calling thread; with a thread limit the
+ * zones are shared out over that many threads instead, and with a
+ * SolveOptions::scheduler over as many of its ParallelFor jobs), with the
+ * caller's deadline and cancel token and the part of the warm start that
+ * falls in the zone. A granular relocate / Or-opt / 2-opt* descent then runs over
+ * the merged routes, with neighbour lists drawn from each zone and its
+ * NEARBY_ZONES nearest zones (robot starts grouped by where the robot
+ * stands), so tasks near a border can still change sides. Every step is linear in the task count for a fixed zone size.
+ *
+ * With robotsPerZone robots or fewer the instance is solved as a whole.
+ */
+class ZoneDecomposedSolver : public IVRPSolver {
+public:
+    /// Builds the solver of one zone (called on the calling thread)
+    using SolverFactory = std::function<std::unique_ptr<IVRPSolver>(int zone)>;
+
+    static constexpr int DEFAULT_ROBOTS_PER_ZONE = 10;
+    static constexpr int DEFAULT_BOUNDARY_PASSES = 50;
+    static constexpr int NEARBY_ZONES = 2;          ///< Zones besides its own a task may pair with
+    static constexpr int MEDOID_ROUNDS = 3;
+    static constexpr int MEDOID_SAMPLE = 32;        ///< Members scored per medoid update
+
+private:
+    SolverFactory factory_;
+    int robotsPerZone_;
+    int maxThreads_ = 0;            ///< Threads zones are solved on (0 = one per zone)
+
+    /// Task and robot to zone assignment
+    struct ZonePlan {
+        int zoneCount = 0;
+        std::vector<int> centreNodes;       ///< Per zone
+        std::vector<int> taskZone;          ///< Per task
+        std::vector<int> robotZone;         ///< Per robot
+    };
+
+    ZonePlan PlanZones(
+        const std::vector<Task>& tasks,
+        const std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs,
+        int zoneCount
+    ) const;
+
+    /// Zone whose centre is cheapest to reach from node
+    int NearestZone(const ZonePlan& plan, const CostMatrixProvider& costs, int node) const;
+
+    /// Robots per zone in proportion to the zone's work (sums to robotCount)
+    std::vector<int> AllocateRobots(const std::vector<double>& zoneWork, int robotCount) const;
+
+    /// Per zone, itself and its NEARBY_ZONES nearest zones by centre cost
+    std::vector<std::vector<int>> NearbyZones(const ZonePlan& plan, const CostMatrixProvider& costs) const;
+
+public:
+    /**
+     * @param factory Builds the solver of each zone
+     * @param robotsPerZone Target fleet size of a zone
+     * @throws std::invalid_argument if factory is empty
+     */
+    explicit ZoneDecomposedSolver(SolverFactory factory,
+                                  int robotsPerZone = DEFAULT_ROBOTS_PER_ZONE);
+
+    // =========================================================================
+    // IVRPSOLVER INTERFACE
+    // =========================================================================
+
+    using IVRPSolver::Solve;
+
+    VRPResult Solve(
+        const std::vector<Task>& tasks,
+        std::vector<RobotAgent>& robots,
+        const CostMatrixProvider& costs,
+        const SolveOptions& options
+    ) override;
+
+    std::string GetName() const override { return "Zone Decomposition"; }
+
+    std::string GetDescription() const override {
+        return "Clusters tasks and robots into zones solved concurrently, then improves across zone borders";
+    }
+
+    bool IsExact() const override { return false; }
+
+    // --- Configuration ---
+    int GetRobotsPerZone() const { return robotsPerZone_; }
+    void SetRobotsPerZone(int robots) { robotsPerZone_ = std::max(1, robots); }
+    int GetMaxThreads() const { return maxThreads_; }
+    void SetMaxThreads(int threads) { maxThreads_ = std::max(0, threads); }
+};
+
+} // namespace Layer2
+} // namespace Backend
+
+#endif // LAYER2_ZONEDECOMPOSEDSOLVER_HH
@@ -10,6 +10,9 @@
  * 4. Robot Agent Management with Battery System
  * 5. VRP Solving (Hill Climbing)
  * 6. Fleet Schedule Report with Time Calculations
+ * 7. Multi-pick batching (LoadPlanner)
+ * 8. Charger sharing (ChargerAssignment)
+ * 9. Hierarchical NavMesh costs against flat searches
  * 
  * Battery System:
  *   Full Battery: 300 seconds of operation
@@ -33,6 +36,9 @@
 #include <sstream>
 #include <algorithm>
 #include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
 
 // Layer 1 includes (dependencies)
 #include "../layer1/include/StaticBitMap.hh"
@@ -40,6 +46,7 @@
 #include "../layer1/include/NavMesh.hh"
 #include "../layer1/include/NavMeshGenerator.hh"
 #include "../layer1/include/POIRegistry.hh"
+#include "../layer1/include/HierarchicalNavMesh.hh"
 
 // Layer 2 includes
 #include "include/Task.hh"
@@ -48,6 +55,9 @@
 #include "include/CostMatrixProvider.hh"
 #include "include/IVRPSolver.hh"
 #include "include/HillClimbing.hh"
+#include "include/AdaptiveSolver.hh"
+#include "include/ChargerAssignment.hh"
+#include "include/LoadProfile.hh"
 
 // Common includes
 #include "../common/include/Coordinates.hh"
@@ -355,6 +365,75 @@ void PrintFinalSummary(
     std::cout << "\n";
 }
 
+// =============================================================================
+// SEARCH CROSS-CHECK
+// =============================================================================
+
+/**
+ * @brief Compare RunDijkstra from a few sources with RunAStar to a spread
+ *        of targets.
+ * 
+ * @return Largest cost difference relative to the A* cost, or INFINITY if
+ *         one search reached a target the other did not
+ */
+double LargestDijkstraError(const CostMatrixProvider& costs, int nodeCount, int& pairsChecked) {
+    const int sourceStride = std::max(1, nodeCount / 4);
+    const int targetStride = std::max(1, nodeCount / 50);
+    double worst = 0.0;
+    pairsChecked = 0;
+    for (int source = 0; source < nodeCount; source += sourceStride) {
+        std::unordered_map<int, float> dist = costs.RunDijkstra(source);
+        for (int target = 0; target < nodeCount; target += targetStride) {
+            float aStar = costs.RunAStar(source, target);
+            auto it = dist.find(target);
+            bool reached = it != dist.end() && it->second < CostMatrixProvider::GetInfinity();
+            if (reached != (aStar < CostMatrixProvider::GetInfinity())) return INFINITY;
+            if (reached) {
+                worst = std::max(worst, std::abs(static_cast<double>(it->second) - aStar) / std::max(1.0f, aStar));
+            }
+            pairsChecked++;
+        }
+    }
+    return worst;
+}
+
+// =============================================================================
+// ADAPTIVE SOLVER TIERS
+// =============================================================================
+
+/**
+ * @brief Solver tier with a known latency and quality: it sleeps
+ *        msPerTask per task (ignoring its deadline, like work that cannot
+ *        be interrupted) and reports a makespan of makespanRatio times its
+ *        lower bound. Builds no routes.
+ */
+class TimedStubSolver : public IVRPSolver {
+private:
+    double msPerTask_;
+    double makespanRatio_;
+
+public:
+    TimedStubSolver(double msPerTask, double makespanRatio)
+        : msPerTask_(msPerTask), makespanRatio_(makespanRatio) {}
+
+    using IVRPSolver::Solve;
+
+    VRPResult Solve(const std::vector<Task>& tasks, std::vector<RobotAgent>&,
+                    const CostMatrixProvider&, const SolveOptions&) override {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(msPerTask_ * tasks.size()));
+        VRPResult result;
+        result.isFeasible = true;
+        result.lowerBound = 100.0;
+        result.makespan = result.lowerBound * makespanRatio_;
+        result.algorithmName = GetName();
+        return result;
+    }
+
+    std::string GetName() const override { return "TimedStub"; }
+    std::string GetDescription() const override { return "Sleeps in proportion to the task count"; }
+    bool IsExact() const override { return false; }
+};
+
 // =============================================================================
 // MAIN TEST DRIVER
 // =============================================================================
@@ -620,6 +699,326 @@ int main() {
     passedTests++;
     totalTests++;
 
+    // =========================================================================
+    // PHASE 7: Multi-pick Batching (LoadPlanner)
+    // =========================================================================
+    PrintHeader("PHASE 7: Multi-pick Batching (LoadPlanner)");
+
+    if (pickupNodes.size() >= 2 && dropoffNodes.size() >= 2 && !chargingNodes.empty()) {
+        // Two tasks from each of two pickups: a robot carrying two takes
+        // each pair in one trip
+        std::vector<Task> batchTasks = {
+            Task(0, pickupNodes[0], dropoffNodes[0]), Task(1, pickupNodes[0], dropoffNodes[0]),
+            Task(2, pickupNodes[1], dropoffNodes[1]), Task(3, pickupNodes[1], dropoffNodes[1])};
+        std::vector<int> order = {0, 1, 2, 3};
+        RouteView route(order.data(), static_cast<int>(order.size()));
+        const int start = chargingNodes[0];
+
+        auto travel = [&](const std::vector<int>& itinerary) {
+            double total = 0.0;
+            int at = start;
+            for (int node : itinerary) {
+                total += costMatrix.GetCost(at, node);
+                at = node;
+            }
+            return total;
+        };
+
+        // One task at a time, as the solvers score a route without a planner
+        std::vector<int> paired;
+        for (int t : order) {
+            paired.push_back(batchTasks[t].sourceNode);
+            paired.push_back(batchTasks[t].destinationNode);
+        }
+        const double pairedTime = travel(paired);
+
+        std::vector<RobotAgent> single = {RobotAgent(0, 1.0f, start, ROBOT_SPEED_MPS, 1)};
+        std::vector<RobotAgent> dual = {RobotAgent(0, 1.0f, start, ROBOT_SPEED_MPS, 2)};
+        single[0].SetCurrentNodeId(start);
+        dual[0].SetCurrentNodeId(start);
+        LoadPlanner singlePlanner(batchTasks, single, costMatrix);
+        LoadPlanner dualPlanner(batchTasks, dual, costMatrix);
+
+        LoadProfile singleProfile;
+        double singleTime = singlePlanner.Plan(route, 0, singleProfile);
+        std::vector<int> singleItinerary = singlePlanner.Itinerary(route, singleProfile);
+        if (!singlePlanner.IsEnabled() && std::abs(singleTime - pairedTime) < 1e-3 &&
+            singleItinerary == paired && singleProfile.maxLoad == 1 && singleProfile.Batches() == 4) {
+            PrintPass("Capacity 1 keeps the pickup-dropoff pairs (" + std::to_string(singleTime) + " px)");
+            passedTests++;
+        } else {
+            PrintFail("Capacity 1 planned " + std::to_string(singleTime) + " px in " +
+                      std::to_string(singleProfile.Batches()) + " batches, pairs take " +
+                      std::to_string(pairedTime) + " px");
+        }
+        totalTests++;
+
+        LoadProfile dualProfile;
+        double dualTime = dualPlanner.Plan(route, 0, dualProfile);
+        std::vector<int> dualItinerary = dualPlanner.Itinerary(route, dualProfile);
+        std::vector<int> expected = {pickupNodes[0], pickupNodes[0], dropoffNodes[0], dropoffNodes[0],
+                                     pickupNodes[1], pickupNodes[1], dropoffNodes[1], dropoffNodes[1]};
+        if (dualPlanner.IsEnabled() && dualTime < pairedTime && dualItinerary == expected &&
+            std::abs(travel(dualItinerary) - dualTime) < 1e-3 && dualProfile.maxLoad == 2) {
+            PrintPass("Capacity 2 batches the pairs: " + std::to_string(dualTime) + " px vs " +
+                      std::to_string(pairedTime) + " px one at a time");
+            passedTests++;
+        } else {
+            PrintFail("Capacity 2 planned " + std::to_string(dualTime) + " px (max load " +
+                      std::to_string(dualProfile.maxLoad) + "), pairs take " + std::to_string(pairedTime) + " px");
+        }
+        totalTests++;
+    } else {
+        PrintFail("Cannot test batching - needs two pickups, two dropoffs and a charger");
+        totalTests++;
+    }
+
+    // =========================================================================
+    // PHASE 8: Dijkstra Queues vs A*
+    // =========================================================================
+    PrintHeader("PHASE 8: Dijkstra Queues vs A*");
+
+    {
+        // Uniform tiles cost multiples of the tile size (bucket queue);
+        // penalties and merged rectangles do not (radix heap)
+        NavMesh penalizedMesh = navMesh;
+        std::vector<float> penalties(nodes.size());
+        for (size_t i = 0; i < penalties.size(); ++i) {
+            penalties[i] = 0.7f * static_cast<float>((i * 37) % 11);
+        }
+        penalizedMesh.UpdatePenalties(penalties);
+
+        NavMesh mergedMesh;
+        NavMeshGenerator mergedGenerator;
+        mergedGenerator.SetTilingMode(NavMeshGenerator::TilingMode::MERGED_RECTANGLES);
+        mergedGenerator.ComputeRecast(inflatedMap, mergedMesh);
+
+        CostMatrixProvider uniformCosts(navMesh);
+        CostMatrixProvider penalizedCosts(penalizedMesh);
+        CostMatrixProvider mergedCosts(mergedMesh);
+        if (uniformCosts.GetCostUnit() > 0.0f) {
+            PrintPass("Uniform mesh costs are multiples of " + std::to_string(uniformCosts.GetCostUnit()) +
+                      " px: its searches use the bucket queue");
+            passedTests++;
+        } else {
+            PrintFail("Uniform mesh costs were not detected as multiples of one unit");
+        }
+        totalTests++;
+
+        // Float sums along different equal-cost paths differ in the last bits
+        const double TOLERANCE = 1e-5;
+        const std::pair<const char*, const CostMatrixProvider*> meshes[] = {
+            {"uniform", &uniformCosts}, {"penalized", &penalizedCosts}, {"merged", &mergedCosts}};
+        for (const auto& [name, costs] : meshes) {
+            int pairs = 0;
+            int nodeCount = static_cast<int>((costs == &mergedCosts ? mergedMesh : navMesh).GetAllNodes().size());
+            double error = LargestDijkstraError(*costs, nodeCount, pairs);
+            std::ostringstream detail;
+            detail << pairs << " pairs on the " << name << " mesh, largest relative difference " << error;
+            if (pairs > 0 && error <= TOLERANCE) {
+                PrintPass("RunDijkstra matches RunAStar: " + detail.str());
+                passedTests++;
+            } else {
+                PrintFail("RunDijkstra differs from RunAStar: " + detail.str());
+            }
+            totalTests++;
+        }
+    }
+
+    // =========================================================================
+    // PHASE 9: Adaptive Solver Tier Selection
+    // =========================================================================
+    PrintHeader("PHASE 9: Adaptive Solver Tier Selection");
+
+    if (!pickupNodes.empty() && !dropoffNodes.empty()) {
+        // A thorough tier at 5 ms per task and a rougher one at 0.5 ms: a
+        // 30 ms target fits the thorough tier on 2 tasks but not on 16
+        const double TARGET_MS = 30.0;
+        std::vector<std::unique_ptr<IVRPSolver>> tiers;
+        tiers.push_back(std::make_unique<TimedStubSolver>(5.0, 1.0));
+        tiers.push_back(std::make_unique<TimedStubSolver>(0.5, 1.2));
+        AdaptiveSolver adaptive(std::move(tiers), TARGET_MS);
+
+        std::vector<Task> smallWave;
+        std::vector<Task> largeWave;
+        for (int t = 0; t < 16; ++t) {
+            Task task(t, pickupNodes[t % pickupNodes.size()], dropoffNodes[t % dropoffNodes.size()]);
+            if (t < 2) smallWave.push_back(task);
+            largeWave.push_back(task);
+        }
+        std::vector<RobotAgent> fleet = {RobotAgent(0, 1.0f, pickupNodes[0], ROBOT_SPEED_MPS, 1)};
+
+        // Nothing measured: the thorough tier is tried first
+        AdaptiveSolver::Choice first = adaptive.Select(smallWave.size(), fleet.size());
+        if (first.tier == 0 && first.predictedMs < 0.0) {
+            PrintPass("Unmeasured solver starts with the most expensive tier");
+            passedTests++;
+        } else {
+            PrintFail("Unmeasured solver chose tier " + std::to_string(first.tier));
+        }
+        totalTests++;
+
+        // Small waves train the thorough tier; extrapolated to the large
+        // wave it misses the target, so large waves train the rough one
+        for (int i = 0; i < 3; ++i) adaptive.Solve(smallWave, fleet, costMatrix);
+        for (int i = 0; i < 3; ++i) adaptive.Solve(largeWave, fleet, costMatrix);
+
+        AdaptiveSolver::Choice small = adaptive.Select(smallWave.size(), fleet.size());
+        AdaptiveSolver::Choice large = adaptive.Select(largeWave.size(), fleet.size());
+        std::ostringstream detail;
+        detail << std::fixed << std::setprecision(1) << "2 tasks -> tier " << small.tier << " (predicted "
+               << small.predictedMs << " ms), 16 tasks -> tier " << large.tier << " (predicted "
+               << large.predictedMs << " ms)";
+        if (small.tier == 0 && small.predictedMs >= 5.0 && small.predictedMs <= TARGET_MS &&
+            large.tier == 1 && large.predictedMs >= 0.0 && large.predictedMs <= TARGET_MS) {
+            PrintPass("Tiers follow the predicted latency: " + detail.str());
+            passedTests++;
+        } else {
+            PrintFail("Tiers do not follow the predicted latency: " + detail.str());
+        }
+        totalTests++;
+
+        // A looser target lets the thorough tier take the large wave too
+        adaptive.SetTargetLatencyMs(400.0);
+        AdaptiveSolver::Choice relaxed = adaptive.Select(largeWave.size(), fleet.size());
+        if (relaxed.tier == 0 && relaxed.predictedMs > TARGET_MS && relaxed.predictedMs <= 400.0) {
+            PrintPass("400 ms target runs the thorough tier on 16 tasks (predicted " +
+                      std::to_string(relaxed.predictedMs) + " ms)");
+            passedTests++;
+        } else {
+            PrintFail("400 ms target chose tier " + std::to_string(relaxed.tier) + " for 16 tasks (predicted " +
+                      std::to_string(relaxed.predictedMs) + " ms)");
+        }
+        totalTests++;
+    } else {
+        PrintFail("Cannot test tier selection - needs a pickup and a dropoff");
+        totalTests++;
+    }
+
+    // =========================================================================
+    // PHASE 10: Charger Sharing
+    // =========================================================================
+    PrintHeader("PHASE 10: Charger Sharing (ChargerAssignment)");
+
+    if (pickupNodes.size() >= 2 && !dropoffNodes.empty()) {
+        // More stops leave together than the chargers' queues hold in one
+        // round (2 chargers x MAX_QUEUE_PLACES): the rest go to later rounds
+        const std::vector<int> chargers = {pickupNodes[0], pickupNodes[1]};
+        const size_t stopCount = 2 * chargers.size() * ChargerAssignment::MAX_QUEUE_PLACES + 3;
+        std::vector<ChargingStop> stops(stopCount);
+        for (size_t s = 0; s < stopCount; ++s) {
+            stops[s].robot = static_cast<int>(s);
+            stops[s].position = 0;
+            stops[s].fromNode = dropoffNodes[s % dropoffNodes.size()];
+            stops[s].toNode = pickupNodes[s % pickupNodes.size()];
+            stops[s].chargeTime = 60.0;
+        }
+        ChargerAssignment assignment(chargers, costMatrix);
+        std::vector<ChargerSlot> slots = assignment.Assign(stops);
+        size_t assigned = 0;
+        for (const ChargerSlot& slot : slots) {
+            if (std::find(chargers.begin(), chargers.end(), slot.charger) != chargers.end()) assigned++;
+        }
+        if (slots.size() == stopCount && assigned == stopCount) {
+            PrintPass(std::to_string(stopCount) + " simultaneous stops shared " + std::to_string(chargers.size()) +
+                      " chargers");
+            passedTests++;
+        } else {
+            PrintFail(std::to_string(assigned) + "/" + std::to_string(stopCount) + " stops got a charger");
+        }
+        totalTests++;
+    } else {
+        PrintFail("Cannot test charger sharing - needs two pickups and a dropoff");
+        totalTests++;
+    }
+
+    // A matching with more rows than columns has no solution
+    try {
+        ChargerAssignment::SolveAssignment(std::vector<std::vector<double>>(5, std::vector<double>(4, 1.0)));
+        PrintFail("5x4 assignment was accepted");
+    } catch (const std::invalid_argument&) {
+        PrintPass("5x4 assignment is rejected");
+        passedTests++;
+    }
+    totalTests++;
+
+    // =========================================================================
+    // PHASE 11: Hierarchical Costs vs Flat Searches
+    // =========================================================================
+    PrintHeader("PHASE 11: Hierarchical Costs vs Flat Searches");
+
+    {
+        // Small clusters, so the test map has many borders to cross. A
+        // border run is crossed at its middle, which costs short hops a
+        // large share of their length but long paths little, so bound the
+        // total cost and each pair's detour in cluster edges
+        const int CLUSTER_TILES = 4;
+        const double MAX_TOTAL_RATIO = 1.05;
+        const double MAX_DETOUR_CLUSTERS = 3.0;
+        NavMesh overlaidMesh = navMesh;
+        HierarchicalNavMesh hierarchy(overlaidMesh, CLUSTER_TILES);
+
+        auto compareWithFlat = [&](const std::string& when) {
+            CostMatrixProvider flatCosts(overlaidMesh);
+            const int nodeCount = static_cast<int>(nodes.size());
+            const int stride = std::max(1, nodeCount / 40);
+            int pairs = 0;
+            int reachMismatches = 0;
+            int belowFlat = 0;
+            double flatTotal = 0.0;
+            double hierTotal = 0.0;
+            double worstDetour = 0.0;
+            for (int a = 0; a < nodeCount; a += stride) {
+                for (int b = stride / 2; b < nodeCount; b += 3 * stride) {
+                    // Flat searches leave a blocked start; the hierarchy does not
+                    if (overlaidMesh.IsNodeBlocked(a) || overlaidMesh.IsNodeBlocked(b)) continue;
+                    float flat = flatCosts.GetCost(a, b);
+                    float hier = hierarchy.GetCost(a, b);
+                    bool flatReached = flat < CostMatrixProvider::GetInfinity();
+                    bool hierReached = hier < HierarchicalNavMesh::INFINITY_COST;
+                    pairs++;
+                    if (flatReached != hierReached) {
+                        reachMismatches++;
+                    } else if (flatReached) {
+                        if (hier < flat * (1.0 - 1e-5)) belowFlat++;
+                        flatTotal += flat;
+                        hierTotal += hier;
+                        worstDetour = std::max(worstDetour,
+                                               static_cast<double>(hier - flat) / hierarchy.GetClusterSizePixels());
+                    }
+                }
+            }
+            const double totalRatio = flatTotal > 0.0 ? hierTotal / flatTotal : 0.0;
+            std::ostringstream detail;
+            detail << when << ", " << pairs << " pairs over " << hierarchy.GetEntranceCount() << " entrances in "
+                   << hierarchy.GetClusterCount() << " clusters: total " << std::fixed << std::setprecision(3)
+                   << totalRatio << "x flat, worst detour " << std::setprecision(1) << worstDetour
+                   << " cluster edges";
+            if (pairs > 0 && reachMismatches == 0 && belowFlat == 0 && totalRatio <= MAX_TOTAL_RATIO &&
+                worstDetour <= MAX_DETOUR_CLUSTERS) {
+                PrintPass("Hierarchy reaches what flat searches reach " + detail.str());
+                passedTests++;
+            } else {
+                PrintFail("Hierarchy costs off (" + std::to_string(reachMismatches) + " reachability mismatches, " +
+                          std::to_string(belowFlat) + " below flat) " + detail.str());
+            }
+            totalTests++;
+        };
+        compareWithFlat("as built");
+
+        // A wall across the middle of the map splits border runs: Refresh
+        // has to move the crossings around it
+        auto [mapWidth, mapHeight] = inflatedMap.GetDimensions();
+        PackedGrid overlay(mapWidth, mapHeight, true);
+        const int wallX = mapWidth / 2;
+        for (int y = mapHeight / 4; y < 3 * mapHeight / 4; ++y) {
+            for (int x = wallX; x < wallX + 3; ++x) overlay.Set(x, y, false);
+        }
+        overlaidMesh.UpdateBlockedRegion(wallX, 0, 3, mapHeight, overlay);
+        int recomputed = hierarchy.Refresh();
+        compareWithFlat("after a wall and " + std::to_string(recomputed) + " clusters refreshed");
+    }
+
     // =========================================================================
     // FINAL SUMMARY
     // =========================================================================
@@ -0,0 +1,625 @@
+/**
+ * @file solver_benchmark.cc
+ * @brief Reproducible VRP solver benchmark over generated instance families
+ *
+ * Generates seeded task sets over the real warehouse NavMesh, runs every
+ * IVRPSolver on each with fixed wall-clock budgets and writes one
+ * machine-readable row per run, so solver performance can be tracked
+ * across releases:
+ *
+ * - Families: uniform (storage locations spread over the whole mesh) or
+ *   clustered (locations in a few zones, most tasks within one zone),
+ *   crossed with task and robot counts.
+ * - Metrics: makespan, total distance, wall time, time to reach the
+ *   target quality (within --target of the best makespan any run found on
+ *   that instance) and peak resident memory during the run.
+ *
+ * Instances depend only on the seed, family, task and robot count:
+ * mt19937 draws are reduced by modulo (not std::uniform_int_distribution,
+ * whose output differs between standard libraries).
+ *
+ * Usage:
+ *   make benchmark ARGS="--suite quick --csv results.csv --json results.json"
+ *   ./build/solver_benchmark --tasks 100,1000 --robots 10,50 --budgets 500 --solvers alns,tabu
+ *
+ * Options:
+ *   --suite quick|full         Preset grid (default quick)
+ *   --tasks N,N,...            Task counts (overrides the suite)
+ *   --robots N,N,...           Robot counts
+ *   --layouts uniform,clustered
+ *   --budgets MS,MS,...        Wall-clock budget per run
+ *   --solvers a,b,...          alns, tabu, sa, hc, portfolio, zones, adaptive (default all)
+ *   --seeds N                  Instances per family (seeds seed..seed+N-1, default 1)
+ *   --seed S                   First seed (default 1)
+ *   --target F                 Time-to-target tolerance (default 0.05 = within 5%)
+ *   --gap F                    Solvers stop within this fraction of the lower bound
+ *                              (default 0 = only when proven optimal, < 0 = never)
+ *   --threads N                Workers for the parallel steps inside one solve
+ *                              (ALNS repair; default 0 = sequential)
+ *   --regret-k K               Insertion options in the ALNS repair's regret (default 2)
+ *   --label TEXT               Recorded in every row (e.g. a release tag)
+ *   --csv FILE / --json FILE   Output files (neither: CSV on stdout)
+ *   --verbose 1                Keep the solvers' own logging (stdout)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+// Layer 1 includes
+#include "../layer1/include/StaticBitMap.hh"
+#include "../layer1/include/InflatedBitMap.hh"
+#include "../layer1/include/NavMesh.hh"
+#include "../layer1/include/NavMeshGenerator.hh"
+
+// Layer 2 includes
+#include "include/Task.hh"
+#include "include/RobotAgent.hh"
+#include "include/CostMatrixProvider.hh"
+#include "include/ALNS.hh"
+#include "include/AdaptiveSolver.hh"
+#include "include/HillClimbing.hh"
+#include "include/PortfolioSolver.hh"
+#include "include/SimulatedAnnealing.hh"
+#include "include/TabuSearch.hh"
+#include "include/ZoneDecomposedSolver.hh"
+
+// Common includes
+#include "../common/include/Resolution.hh"
+#include "../common/include/TaskScheduler.hh"
+
+using namespace Backend::Layer1;
+using namespace Backend::Layer2;
+using namespace Backend::Common;
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+const Resolution MAP_RESOLUTION = Resolution::DECIMETERS;
+const float ROBOT_RADIUS_METERS = 0.3f;
+const float ROBOT_SPEED_MPS = 1.6f;
+
+const int LOCATION_POOL_SIZE = 256;     ///< Storage locations tasks are drawn from
+const int PARKING_POOL_SIZE = 200;      ///< Robot start nodes (robot r starts at the r-th)
+const int CLUSTER_COUNT = 4;
+const double CLUSTER_LOCAL_SHARE = 0.8; ///< Clustered: tasks with both ends in one zone
+
+struct BenchmarkOptions {
+    std::vector<int> taskCounts{10, 100, 500};
+    std::vector<int> robotCounts{1, 10, 50};
+    std::vector<std::string> layouts{"uniform", "clustered"};
+    std::vector<int> budgetsMs{200};
+    std::vector<std::string> solvers{"alns", "tabu", "sa", "hc", "portfolio", "zones", "adaptive"};
+    int seeds = 1;
+    unsigned int firstSeed = 1;
+    double targetTolerance = 0.05;
+    double stopGap = 0.0;
+    int threads = 0;
+    int regretK = 2;
+    std::string label;
+    std::string csvPath;
+    std::string jsonPath;
+    bool verbose = false;
+};
+
+// =============================================================================
+// RESULT STRUCTURE
+// =============================================================================
+
+struct RunResult {
+    std::string layout;
+    int tasks = 0;
+    int robots = 0;
+    unsigned int seed = 0;
+    std::string solver;
+    int budgetMs = 0;
+    bool feasible = false;
+    bool stoppedEarly = false;
+    double makespan = 0.0;
+    double lowerBound = 0.0;            ///< Makespan lower bound (0 = not reported)
+    double totalDistance = 0.0;
+    double timeMs = 0.0;
+    double timeToTargetMs = -1.0;       ///< -1 = never within the target
+    long peakRssKb = 0;
+
+    /// Best makespan so far over the run, as (ms since start, makespan)
+    std::vector<std::pair<double, double>> timeline;
+};
+
+// =============================================================================
+// HELPER FUNCTIONS
+// =============================================================================
+
+std::vector<std::string> SplitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<int> SplitInts(const std::string& text) {
+    std::vector<int> values;
+    for (const auto& item : SplitList(text)) values.push_back(std::atoi(item.c_str()));
+    return values;
+}
+
+unsigned int Draw(std::mt19937& rng, size_t n) {
+    return static_cast<unsigned int>(rng() % n);
+}
+
+double Draw01(std::mt19937& rng) {
+    return static_cast<double>(rng()) / (static_cast<double>(std::mt19937::max()) + 1.0);
+}
+
+/// Reset the kernel's peak-RSS counter; false if unsupported
+bool ResetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (!clearRefs) return false;
+    clearRefs << "5";
+    return static_cast<bool>(clearRefs.flush());
+}
+
+/// Peak resident set in KiB since the last reset (or since start)
+long PeakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::atol(line.c_str() + 6);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+std::unique_ptr<IVRPSolver> MakeSolver(const std::string& name, unsigned int seed, int regretK = 2) {
+    if (name == "alns") return std::make_unique<ALNS>(100, 0.25, seed, regretK);
+    if (name == "tabu") return std::make_unique<TabuSearch>(100, 10, 20, seed);
+    if (name == "sa") return std::make_unique<SimulatedAnnealing>(1000.0, 0.95, 1.0, 50, seed);
+    if (name == "hc") return std::make_unique<HillClimbing>(1000, 10, seed);
+    if (name == "portfolio") {
+        return std::make_unique<PortfolioSolver>(PortfolioSolver::MakeDefaultMembers(4, seed));
+    }
+    if (name == "zones") {
+        return std::make_unique<ZoneDecomposedSolver>([seed, regretK](int zone) -> std::unique_ptr<IVRPSolver> {
+            return std::make_unique<ALNS>(100, 0.25, seed + static_cast<unsigned int>(zone), regretK);
+        });
+    }
+    if (name == "adaptive") {
+        // Target set per run from the budget
+        std::vector<std::unique_ptr<IVRPSolver>> tiers;
+        tiers.push_back(std::make_unique<ALNS>(100, 0.25, seed, regretK));
+        tiers.push_back(std::make_unique<ALNS>(25, 0.25, seed, regretK));
+        tiers.push_back(std::make_unique<HillClimbing>(50, 2, seed));
+        return std::make_unique<AdaptiveSolver>(std::move(tiers), 1000.0);
+    }
+    return nullptr;
+}
+
+// =============================================================================
+// INSTANCE GENERATION
+// =============================================================================
+
+/// Nodes an instance family draws from, with their cost matrix
+struct Family {
+    std::string layout;
+    std::vector<int> locations;                 ///< Task endpoints
+    std::vector<int> locationCluster;           ///< Per location (clustered only)
+    std::vector<std::vector<int>> clusters;     ///< Cluster -> indices into locations
+    std::vector<int> parking;                   ///< Robot starts
+    std::unique_ptr<CostMatrixProvider> costs;
+};
+
+/// Keep the nodes mutually reachable with the best-connected one
+std::vector<int> KeepConnected(const std::vector<int>& nodes, const CostMatrixProvider& costs) {
+    const float inf = CostMatrixProvider::GetInfinity();
+    size_t anchor = 0;
+    int bestReach = -1;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        int reach = 0;
+        for (int other : nodes) reach += costs.GetCost(nodes[i], other) < inf;
+        if (reach > bestReach) {
+            bestReach = reach;
+            anchor = i;
+        }
+    }
+    std::vector<int> kept;
+    for (int node : nodes) {
+        if (costs.GetCost(nodes[anchor], node) < inf && costs.GetCost(node, nodes[anchor]) < inf) {
+            kept.push_back(node);
+        }
+    }
+    return kept;
+}
+
+Family BuildFamily(const std::string& layout, unsigned int seed, const NavMesh& mesh) {
+    const auto& meshNodes = mesh.GetAllNodes();
+    std::mt19937 rng(seed * 2654435761u + (layout == "clustered" ? 1u : 0u));
+
+    auto distinct = [&](std::vector<int>& into, int node) {
+        if (std::find(into.begin(), into.end(), node) == into.end()) into.push_back(node);
+    };
+
+    // Draw a few extra candidates: unreachable ones are dropped below
+    int wanted = LOCATION_POOL_SIZE + LOCATION_POOL_SIZE / 4;
+    std::vector<int> candidates;
+    if (layout == "clustered") {
+        int perCluster = wanted / CLUSTER_COUNT;
+        for (int c = 0; c < CLUSTER_COUNT; ++c) {
+            const Coordinates& centre = meshNodes[Draw(rng, meshNodes.size())].coords;
+            std::vector<std::pair<long long, int>> byDistance;
+            byDistance.reserve(meshNodes.size());
+            for (size_t n = 0; n < meshNodes.size(); ++n) {
+                long long dx = meshNodes[n].coords.x - centre.x;
+                long long dy = meshNodes[n].coords.y - centre.y;
+                byDistance.emplace_back(dx * dx + dy * dy, static_cast<int>(n));
+            }
+            std::sort(byDistance.begin(), byDistance.end());
+            for (int k = 0; k < perCluster && k < static_cast<int>(byDistance.size()); ++k) {
+                distinct(candidates, byDistance[k].second);
+            }
+        }
+    } else {
+        for (int attempts = 0; static_cast<int>(candidates.size()) < wanted && attempts < wanted * 4; ++attempts) {
+            distinct(candidates, static_cast<int>(Draw(rng, meshNodes.size())));
+        }
+    }
+
+    std::vector<int> parking;
+    for (int attempts = 0; static_cast<int>(parking.size()) < PARKING_POOL_SIZE + PARKING_POOL_SIZE / 4 &&
+                           attempts < PARKING_POOL_SIZE * 8; ++attempts) {
+        distinct(parking, static_cast<int>(Draw(rng, meshNodes.size())));
+    }
+
+    Family family;
+    family.layout = layout;
+    family.costs = std::make_unique<CostMatrixProvider>(mesh);
+    std::vector<int> allNodes = candidates;
+    allNodes.insert(allNodes.end(), parking.begin(), parking.end());
+    family.costs->PrecomputeForNodes(allNodes);
+
+    std::vector<int> connected = KeepConnected(allNodes, *family.costs);
+    auto isConnected = [&](int node) {
+        return std::find(connected.begin(), connected.end(), node) != connected.end();
+    };
+    for (int node : candidates) {
+        if (isConnected(node) && static_cast<int>(family.locations.size()) < LOCATION_POOL_SIZE) {
+            family.locations.push_back(node);
+        }
+    }
+    for (int node : parking) {
+        if (isConnected(node) && static_cast<int>(family.parking.size()) < PARKING_POOL_SIZE) {
+            family.parking.push_back(node);
+        }
+    }
+
+    // Zone of a location: nearest centre by travel cost (the first location drawn per cluster)
+    if (layout == "clustered") {
+        std::vector<int> centres;
+        int perCluster = std::max<int>(1, static_cast<int>(family.locations.size()) / CLUSTER_COUNT);
+        for (int c = 0; c < CLUSTER_COUNT && c * perCluster < static_cast<int>(family.locations.size()); ++c) {
+            centres.push_back(family.locations[c * perCluster]);
+        }
+        family.clusters.assign(centres.size(), {});
+        for (size_t i = 0; i < family.locations.size(); ++i) {
+            size_t best = 0;
+            for (size_t c = 1; c < centres.size(); ++c) {
+                if (family.costs->GetCost(centres[c], family.locations[i]) <
+                    family.costs->GetCost(centres[best], family.locations[i])) {
+                    best = c;
+                }
+            }
+            family.locationCluster.push_back(static_cast<int>(best));
+            family.clusters[best].push_back(static_cast<int>(i));
+        }
+    }
+    return family;
+}
+
+std::vector<Task> GenerateTasks(const Family& family, int count, unsigned int seed) {
+    std::mt19937 rng(seed * 40503u + static_cast<unsigned int>(count));
+    const auto& locations = family.locations;
+    std::vector<Task> tasks;
+    tasks.reserve(count);
+    while (static_cast<int>(tasks.size()) < count) {
+        int source = static_cast<int>(Draw(rng, locations.size()));
+        int destination = static_cast<int>(Draw(rng, locations.size()));
+        if (!family.clusters.empty() && Draw01(rng) < CLUSTER_LOCAL_SHARE) {
+            const auto& zone = family.clusters[family.locationCluster[source]];
+            destination = zone[Draw(rng, zone.size())];
+        }
+        if (source == destination) continue;
+        int id = static_cast<int>(tasks.size());
+        tasks.emplace_back(id, locations[source], locations[destination]);
+    }
+    return tasks;
+}
+
+std::vector<RobotAgent> GenerateRobots(const Family& family, int count) {
+    std::vector<RobotAgent> robots;
+    robots.reserve(count);
+    for (int r = 0; r < count; ++r) {
+        int start = family.parking[r % family.parking.size()];
+        RobotAgent robot(r, BATTERY_FULL_SECONDS, start, ROBOT_SPEED_MPS, 1);
+        robot.SetCurrentNodeId(start);
+        robots.push_back(robot);
+    }
+    return robots;
+}
+
+// =============================================================================
+// RUNNING
+// =============================================================================
+
+RunResult RunOne(const std::string& solverName, int budgetMs, const BenchmarkOptions& benchmark,
+                 TaskScheduler* scheduler, const Family& family,
+                 const std::vector<Task>& tasks, const std::vector<RobotAgent>& robots, unsigned int seed) {
+    RunResult run;
+    run.layout = family.layout;
+    run.tasks = static_cast<int>(tasks.size());
+    run.robots = static_cast<int>(robots.size());
+    run.seed = seed;
+    run.solver = solverName;
+    run.budgetMs = budgetMs;
+
+    std::unique_ptr<IVRPSolver> solver = MakeSolver(solverName, seed, benchmark.regretK);
+    if (auto* adaptive = dynamic_cast<AdaptiveSolver*>(solver.get())) {
+        adaptive->SetTargetLatencyMs(budgetMs);
+    }
+
+    std::vector<RobotAgent> robotsCopy = robots;
+    std::mutex timelineMutex;
+    auto start = std::chrono::steady_clock::now();
+
+    SolveOptions options = SolveOptions::WithBudget(budgetMs);
+    options.stopGap = benchmark.stopGap;
+    options.scheduler = scheduler;
+    options.onImprovement = [&](const VRPResult& progress) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(timelineMutex);
+        if (run.timeline.empty() || progress.makespan < run.timeline.back().second) {
+            run.timeline.emplace_back(ms, progress.makespan);
+        }
+    };
+
+    bool peakReset = ResetPeakRss();
+    VRPResult result = solver->Solve(tasks, robotsCopy, *family.costs, options);
+    run.timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    run.peakRssKb = peakReset ? PeakRssKb() : -1;
+
+    run.feasible = result.isFeasible;
+    run.stoppedEarly = result.stoppedEarly;
+    run.makespan = result.makespan;
+    run.lowerBound = result.lowerBound;
+    run.totalDistance = result.totalDistance;
+    if (result.isFeasible && (run.timeline.empty() || result.makespan < run.timeline.back().second)) {
+        run.timeline.emplace_back(run.timeMs, result.makespan);
+    }
+    return run;
+}
+
+/// Fill timeToTargetMs of runs on one instance from the best makespan among them
+void ScoreTimeToTarget(std::vector<RunResult>& runs, size_t first, double tolerance) {
+    double best = std::numeric_limits<double>::max();
+    for (size_t i = first; i < runs.size(); ++i) {
+        if (runs[i].feasible) best = std::min(best, runs[i].makespan);
+    }
+    double target = best * (1.0 + tolerance);
+    for (size_t i = first; i < runs.size(); ++i) {
+        for (const auto& [ms, makespan] : runs[i].timeline) {
+            if (makespan <= target) {
+                runs[i].timeToTargetMs = ms;
+                break;
+            }
+        }
+    }
+}
+
+// =============================================================================
+// OUTPUT
+// =============================================================================
+
+void WriteCSV(std::ostream& out, const std::vector<RunResult>& runs, const BenchmarkOptions& options) {
+    out << "label,layout,tasks,robots,seed,solver,budget_ms,feasible,stopped_early,"
+           "makespan,lower_bound,total_distance,time_ms,time_to_target_ms,peak_rss_kb\n";
+    out << std::fixed;
+    for (const auto& run : runs) {
+        out << options.label << ',' << run.layout << ',' << run.tasks << ',' << run.robots << ','
+            << run.seed << ',' << run.solver << ',' << run.budgetMs << ',' << run.feasible << ','
+            << run.stoppedEarly << ',' << std::setprecision(2) << run.makespan << ','
+            << run.lowerBound << ',' << run.totalDistance << ',' << std::setprecision(3) << run.timeMs << ','
+            << run.timeToTargetMs << ',' << run.peakRssKb << '\n';
+    }
+}
+
+void WriteJSON(std::ostream& out, const std::vector<RunResult>& runs, const BenchmarkOptions& options) {
+    std::time_t now = std::time(nullptr);
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << std::fixed << "{\n"
+        << "  \"label\": \"" << options.label << "\",\n"
+        << "  \"timestamp\": \"" << timestamp << "\",\n"
+        << "  \"target_tolerance\": " << std::setprecision(4) << options.targetTolerance << ",\n"
+        << "  \"stop_gap\": " << options.stopGap << ",\n"
+        << "  \"runs\": [\n";
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const auto& run = runs[i];
+        out << "    {\"layout\": \"" << run.layout << "\", \"tasks\": " << run.tasks
+            << ", \"robots\": " << run.robots << ", \"seed\": " << run.seed
+            << ", \"solver\": \"" << run.solver << "\", \"budget_ms\": " << run.budgetMs
+            << ", \"feasible\": " << (run.feasible ? "true" : "false")
+            << ", \"stopped_early\": " << (run.stoppedEarly ? "true" : "false")
+            << ", \"makespan\": " << std::setprecision(2) << run.makespan
+            << ", \"lower_bound\": " << run.lowerBound
+            << ", \"total_distance\": " << run.totalDistance
+            << ", \"time_ms\": " << std::setprecision(3) << run.timeMs
+            << ", \"time_to_target_ms\": ";
+        if (run.timeToTargetMs >= 0.0) {
+            out << run.timeToTargetMs;
+        } else {
+            out << "null";
+        }
+        out << ", \"peak_rss_kb\": " << run.peakRssKb << "}" << (i + 1 < runs.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+bool ParseArguments(int argc, char** argv, BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--suite") {
+            if (value == "full") {
+                options.taskCounts = {10, 100, 1000, 5000};
+                options.robotCounts = {1, 10, 50, 200};
+                options.budgetsMs = {1000, 5000};
+            } else if (value != "quick") {
+                std::cerr << "Unknown suite: " << value << "\n";
+                return false;
+            }
+        } else if (arg == "--tasks") {
+            options.taskCounts = SplitInts(value);
+        } else if (arg == "--robots") {
+            options.robotCounts = SplitInts(value);
+        } else if (arg == "--layouts") {
+            options.layouts = SplitList(value);
+        } else if (arg == "--budgets") {
+            options.budgetsMs = SplitInts(value);
+        } else if (arg == "--solvers") {
+            options.solvers = SplitList(value);
+        } else if (arg == "--seeds") {
+            options.seeds = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--seed") {
+            options.firstSeed = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--target") {
+            options.targetTolerance = std::atof(value.c_str());
+        } else if (arg == "--gap") {
+            options.stopGap = std::atof(value.c_str());
+        } else if (arg == "--threads") {
+            options.threads = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--regret-k") {
+            options.regretK = std::atoi(value.c_str());
+        } else if (arg == "--label") {
+            options.label = value;
+        } else if (arg == "--csv") {
+            options.csvPath = value;
+        } else if (arg == "--json") {
+            options.jsonPath = value;
+        } else if (arg == "--verbose") {
+            options.verbose = value != "0";
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+
+    for (const auto& layout : options.layouts) {
+        if (layout != "uniform" && layout != "clustered") {
+            std::cerr << "Unknown layout: " << layout << "\n";
+            return false;
+        }
+    }
+    for (const auto& solver : options.solvers) {
+        if (!MakeSolver(solver, 1)) {
+            std::cerr << "Unknown solver: " << solver << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    if (!ParseArguments(argc, argv, options)) return 1;
+
+    // Map loading and solvers log to stdout; muted unless asked for so CSV
+    // on stdout stays parseable
+    std::streambuf* stdoutBuffer = std::cout.rdbuf();
+    if (!options.verbose) std::cout.rdbuf(nullptr);
+
+    // Progress goes to stderr so CSV on stdout stays clean
+    std::cerr << "[Benchmark] Loading NavMesh...\n";
+    StaticBitMap staticMap = StaticBitMap::CreateFromFile("../layer1/assets/map_layout.txt", MAP_RESOLUTION);
+    InflatedBitMap inflatedMap(staticMap, ROBOT_RADIUS_METERS);
+    NavMesh navMesh;
+    NavMeshGenerator generator;
+    generator.ComputeRecast(inflatedMap, navMesh);
+    std::cerr << "[Benchmark] " << navMesh.GetAllNodes().size() << " nodes\n";
+
+    std::unique_ptr<TaskScheduler> scheduler;
+    if (options.threads > 0) scheduler = std::make_unique<TaskScheduler>(options.threads);
+
+    std::vector<RunResult> runs;
+    for (const auto& layout : options.layouts) {
+        for (int s = 0; s < options.seeds; ++s) {
+            unsigned int seed = options.firstSeed + static_cast<unsigned int>(s);
+            Family family = BuildFamily(layout, seed, navMesh);
+            std::cerr << "[Benchmark] Family " << layout << " seed " << seed << ": "
+                      << family.locations.size() << " locations, " << family.parking.size() << " starts\n";
+
+            for (int taskCount : options.taskCounts) {
+                std::vector<Task> tasks = GenerateTasks(family, taskCount, seed);
+                for (int robotCount : options.robotCounts) {
+                    std::vector<RobotAgent> robots = GenerateRobots(family, robotCount);
+                    size_t instanceStart = runs.size();
+                    for (int budgetMs : options.budgetsMs) {
+                        for (const auto& solver : options.solvers) {
+                            runs.push_back(RunOne(solver, budgetMs, options, scheduler.get(), family, tasks, robots, seed));
+                            const RunResult& run = runs.back();
+                            std::cerr << "[Benchmark] " << layout << " tasks=" << taskCount
+                                      << " robots=" << robotCount << " budget=" << budgetMs << "ms "
+                                      << std::left << std::setw(9) << solver << std::right << std::fixed
+                                      << " makespan=" << std::setprecision(1) << run.makespan
+                                      << " time=" << run.timeMs << "ms\n";
+                        }
+                    }
+                    ScoreTimeToTarget(runs, instanceStart, options.targetTolerance);
+                }
+            }
+        }
+    }
+
+    std::cout.rdbuf(stdoutBuffer);
+    std::cout.clear();
+
+    if (options.csvPath.empty() && options.jsonPath.empty()) {
+        WriteCSV(std::cout, runs, options);
+    }
+    if (!options.csvPath.empty()) {
+        std::ofstream csv(options.csvPath);
+        WriteCSV(csv, runs, options);
+        std::cerr << "[Benchmark] Wrote " << runs.size() << " runs to " << options.csvPath << "\n";
+    }
+    if (!options.jsonPath.empty()) {
+        std::ofstream json(options.jsonPath);
+        WriteJSON(json, runs, options);
+        std::cerr << "[Benchmark] Wrote " << runs.size() << " runs to " << options.jsonPath << "\n";
+    }
+    return 0;
+}
@@ -3,19 +3,30 @@
  * @brief Implementation of Adaptive Large Neighborhood Search VRP solver
  * 
  * This implements the "Destroy and Repair" paradigm:
- * - Destroy: Remove 20-30% of tasks (worst removal - remove expensive outliers)
- * - Repair: Re-insert using Regret-2 heuristic (prioritize tasks with high regret)
+ * - Destroy: Remove 20-30% of tasks (worst, random, Shaw, route or cluster removal)
+ * - Repair: Re-insert using Regret-k heuristic (prioritize tasks with high regret) or greedily
+ * - Adapt: Draw both operators by weight, re-weighted per segment by their scores
  */
 
 #include "ALNS.hh"
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 
 namespace Backend {
 namespace Layer2 {
 
+namespace {
+
+/// Operator names in VRPResult::operatorStats, by DestroyOperator / RepairOperator
+const char* const DESTROY_NAMES[] = {"worst removal", "random removal", "shaw removal", "route removal",
+                                     "cluster removal"};
+const char* const REPAIR_NAMES[] = {"regret insertion", "greedy insertion"};
+
+} // namespace
+
 // =============================================================================
 // MAIN SOLVE METHOD
 // =============================================================================
@@ -23,7 +34,8 @@ namespace Layer2 {
 VRPResult ALNS::Solve(
     const std::vector<Task>& tasks,
     std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const CostMatrixProvider& costs,
+    const SolveOptions& options
 ) {
     auto startTime = std::chrono::high_resolution_clock::now();
     
@@ -54,59 +66,180 @@ VRPResult ALNS::Solve(
     std::cout << "[ALNS] Parameters: " << maxIterations_ << " iterations, "
               << (destructionFactor_ * 100) << "% destruction\n";
     
-    // 1. Generate initial solution (Round-Robin)
-    Solution currentSol = GenerateInitialSolution(tasks, robots.size());
-    double currentCost = CalculateSolutionCost(currentSol, robots, costs);
+    // Task endpoints and robot starts, looked up once for the whole search
+    SearchContext ctx;
+    ctx.costs = &costs;
+    ctx.scheduler = options.scheduler;
+    ctx.scorer = RouteScorer(tasks, costs);
+    ctx.tasks.reserve(tasks.size());
+    for (const Task& task : tasks) {
+        ctx.tasks.push_back({task.sourceNode, task.destinationNode,
+                             costs.GetCost(task.sourceNode, task.destinationNode)});
+    }
+    for (const auto& robot : robots) {
+        ctx.startNodes.push_back(robot.GetCurrentNodeId());
+    }
+    // Robots carrying several packets: routes are judged by their batched
+    // completion (repair and removal still price tasks one at a time)
+    LoadPlanner load(tasks, robots, costs);
+    if (load.IsEnabled() && !options.battery.IsEnabled()) ctx.load = &load;
+    const size_t numRoutes = robots.size();
+    
+    // 1. Generate initial solution (warm start, else Round-Robin)
+    Solution currentSol;
+    if (options.HasWarmStart()) {
+        int newTasks = 0;
+        currentSol = FlatSolution::FromRoutes(
+            CompleteWarmStart(tasks, robots, costs, options.warmStart, newTasks));
+        std::cout << "[ALNS] Warm start: " << (tasks.size() - newTasks) << " tasks kept, "
+                  << newTasks << " inserted\n";
+    } else {
+        currentSol = GenerateInitialSolution(tasks.size(), numRoutes);
+    }
+    std::vector<RouteCache> currentCache(numRoutes);
+    for (size_t r = 0; r < numRoutes; ++r) {
+        RebuildRouteCache(currentSol.Route(static_cast<int>(r)), static_cast<int>(r), ctx, currentCache[r]);
+    }
+    double currentCost = CalculateMakespan(currentCache);
     
     // Track best solution
     Solution bestSol = currentSol;
+    std::vector<RouteCache> bestCache = currentCache;
     double bestCost = currentCost;
     
     std::cout << "[ALNS] Initial greedy makespan: " << std::fixed << std::setprecision(2) 
               << currentCost << " px\n";
     
+    // Best-so-far report (only built when someone listens)
+    auto reportProgress = [&]() {
+        if (!options.WantsProgress()) return;
+        VRPResult progress;
+        progress.algorithmName = GetName();
+        progress.robotItineraries = FormatResult(bestSol, ctx, robots);
+        progress.makespan = bestCost;
+        progress.totalDistance = CalculateTotalDistance(bestCache);
+        progress.isFeasible = true;
+        progress.computationTimeMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+        options.NotifyImprovement(progress);
+    };
+    reportProgress();
+    
+    // No schedule beats the lower bound: stop once close enough to it
+    double lowerBound = MakespanLowerBound(tasks, robots, costs);
+    bool reachedBound = options.ReachedBound(bestCost, lowerBound);
+    
     // Calculate number of tasks to remove each iteration
     int numToRemove = std::max(1, static_cast<int>(tasks.size() * destructionFactor_));
     
     // Statistics
     int improvements = 0;
-    int worstRemovals = 0;
-    int randomRemovals = 0;
+    int iterationsRun = 0;
+    int weightSegments = 0;
+    bool stopped = false;
+    
+    // Operator wheels, all weights equal at the start
+    std::vector<AdaptiveOperator> destroyOps(DESTROY_COUNT);
+    std::vector<AdaptiveOperator> repairOps(REPAIR_COUNT);
+    for (int op = 0; op < DESTROY_COUNT; ++op) destroyOps[op].stats.name = DESTROY_NAMES[op];
+    for (int op = 0; op < REPAIR_COUNT; ++op) repairOps[op].stats.name = REPAIR_NAMES[op];
+    destroyOps[DESTROY_ROUTE].weight = SPECIALIZED_WEIGHT;
+    destroyOps[DESTROY_CLUSTER].weight = SPECIALIZED_WEIGHT;
+    
+    // Candidate caches of the touched routes, reused across iterations
+    std::vector<RouteCache> tempCache = currentCache;
+    std::vector<char> touched(numRoutes);
     
     // 2. Main ALNS loop
-    for (int iter = 0; iter < maxIterations_; ++iter) {
-        // Create a copy to work with
-        Solution tempSol = currentSol;
-        std::vector<Task> unassigned;
+    for (int iter = 0; iter < maxIterations_ && !reachedBound; ++iter) {
+        if (options.ShouldStop()) {
+            stopped = true;
+            break;
+        }
+        iterationsRun++;
         
-        // A. DESTROY phase - alternate between worst and random removal
-        if (iter % 3 != 0) {
-            // Worst removal (2/3 of iterations)
-            DestroyWorst(tempSol, unassigned, numToRemove, robots, costs);
-            worstRemovals++;
-        } else {
-            // Random removal (1/3 of iterations for diversity)
-            DestroyRandom(tempSol, unassigned, numToRemove);
-            randomRemovals++;
+        // Destroy / repair edit currentSol in place (journaled)
+        ScratchArena::Frame frame(arena_);
+        ArenaVector<int> unassigned(arena_, numToRemove);
+        std::fill(touched.begin(), touched.end(), 0);
+        
+        // A. DESTROY phase - operator drawn by weight
+        const int destroyOp = SelectOperator(destroyOps);
+        switch (destroyOp) {
+            case DESTROY_WORST:
+                DestroyWorst(currentSol, currentCache, unassigned, numToRemove, touched);
+                break;
+            case DESTROY_RANDOM:
+                DestroyRandom(currentSol, unassigned, numToRemove, touched);
+                break;
+            case DESTROY_SHAW:
+                DestroyShaw(currentSol, unassigned, numToRemove, ctx, touched);
+                break;
+            case DESTROY_ROUTE:
+                DestroyRoute(currentSol, unassigned, numToRemove, touched);
+                break;
+            default:
+                DestroyCluster(currentSol, unassigned, numToRemove, ctx, touched);
+                break;
         }
         
-        // B. REPAIR phase - use Regret-2 insertion
-        RepairRegret(tempSol, unassigned, robots, costs);
+        // B. REPAIR phase - Regret-k or greedy insertion, drawn by weight
+        const int repairOp = SelectOperator(repairOps);
+        if (repairOp == REPAIR_GREEDY) {
+            RepairGreedy(currentSol, unassigned, ctx, touched);
+        } else {
+            RepairRegret(currentSol, unassigned, ctx, touched);
+        }
         
-        // C. EVALUATE - calculate new cost
-        double newCost = CalculateSolutionCost(tempSol, robots, costs);
+        // C. EVALUATE - only the routes that changed are re-walked
+        double newCost = 0;
+        for (size_t r = 0; r < numRoutes; ++r) {
+            if (touched[r]) {
+                RebuildRouteCache(currentSol.Route(static_cast<int>(r)), static_cast<int>(r), ctx, tempCache[r]);
+                newCost = std::max(newCost, tempCache[r].Cost());
+            } else {
+                newCost = std::max(newCost, currentCache[r].Cost());
+            }
+        }
         
-        // D. ACCEPTANCE - greedy (accept if better)
+        // D. ACCEPTANCE - greedy (accept if better), else undo the edits
+        double score = 0.0;
+        bool newBest = false;
         if (newCost < currentCost) {
-            currentSol = tempSol;
+            score = SCORE_IMPROVED + SCORE_GAIN * (currentCost - newCost) / currentCost;
+            currentSol.Commit();
+            for (size_t r = 0; r < numRoutes; ++r) {
+                if (touched[r]) std::swap(currentCache[r], tempCache[r]);
+            }
             currentCost = newCost;
             
             // Update best if this is a new global best
             if (newCost < bestCost) {
-                bestSol = tempSol;
+                score += SCORE_NEW_BEST - SCORE_IMPROVED;
+                newBest = true;
+                bestSol = currentSol;
+                bestCache = currentCache;
                 bestCost = newCost;
                 improvements++;
+                reportProgress();
+                reachedBound = options.ReachedBound(bestCost, lowerBound);
             }
+        } else {
+            currentSol.Rollback();
+        }
+        
+        // E. ADAPT - credit both operators, re-weight at the end of a segment
+        for (AdaptiveOperator* op : {&destroyOps[destroyOp], &repairOps[repairOp]}) {
+            op->segmentScore += score;
+            op->segmentUses++;
+            op->stats.uses++;
+            if (score > 0.0) op->stats.improvements++;
+            if (newBest) op->stats.newBests++;
+        }
+        if (iterationsRun % SEGMENT_ITERATIONS == 0) {
+            UpdateWeights(destroyOps);
+            UpdateWeights(repairOps);
+            weightSegments++;
         }
         
         // Optional: Add Simulated Annealing acceptance for even better exploration
@@ -118,20 +251,51 @@ VRPResult ALNS::Solve(
         // }
     }
     
-    // 3. Format output
-    result.robotItineraries = FormatResult(bestSol, robots);
+    // 3. Polish the best solution to a granular local optimum (never raises
+    //    the makespan; its moves price tasks one at a time, so not for batches)
+    BatteryPlanner battery(options.battery, tasks, robots, costs);
+    if (!stopped && !reachedBound && !ctx.load) {
+        NeighborLists neighbors;
+        neighbors.Build(tasks, ctx.startNodes, costs, NeighborLists::DEFAULT_SIZE);
+        GranularLocalSearch granular(tasks, ctx.startNodes, costs, neighbors);
+        granular.SetBatteryPlanner(&battery);
+        std::vector<double> routeTimes;
+        if (granular.Run(bestSol, routeTimes, options)) {
+            for (size_t r = 0; r < numRoutes; ++r) {
+                RebuildRouteCache(bestSol.Route(static_cast<int>(r)), static_cast<int>(r), ctx, bestCache[r]);
+            }
+            bestCost = CalculateMakespan(bestCache);
+            reportProgress();
+        }
+        std::cout << "[ALNS] Granular polish: " << granular.GetStats().Moves() << " moves\n";
+    }
+    
+    // 4. Format output
+    result.robotItineraries = FormatResult(bestSol, ctx, robots);
     result.makespan = bestCost;
-    result.totalDistance = CalculateTotalDistance(bestSol, robots, costs);
+    result.totalDistance = CalculateTotalDistance(bestCache);
     result.isFeasible = true;
     result.isOptimal = false;
+    result.stoppedEarly = stopped;
+    ApplyLoadPlan(result, tasks, robots, costs, options, bestSol);
+    ApplyBatteryPlan(result, tasks, robots, costs, options, bestSol);
+    result.SetLowerBound(lowerBound);
+    for (const auto& op : destroyOps) result.operatorStats.push_back(op.stats);
+    for (const auto& op : repairOps) result.operatorStats.push_back(op.stats);
+    result.weightSegments = weightSegments;
     
     auto endTime = std::chrono::high_resolution_clock::now();
     result.computationTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
     
-    std::cout << "[ALNS] Completed: " << maxIterations_ << " iterations, " 
-              << improvements << " improvements\n";
-    std::cout << "[ALNS] Destroy stats: " << worstRemovals << " worst, " 
-              << randomRemovals << " random\n";
+    std::cout << "[ALNS] Completed: " << iterationsRun << " iterations, " 
+              << improvements << " improvements"
+              << (reachedBound ? " (within gap of the lower bound)" : "") << "\n";
+    std::cout << "[ALNS] Operator uses (weight):";
+    for (const auto& op : result.operatorStats) {
+        std::cout << " " << op.name << " " << op.uses << " ("
+                  << std::setprecision(2) << (op.weights.empty() ? 1.0 : op.weights.back()) << ")";
+    }
+    std::cout << "\n";
     std::cout << "[ALNS] Final makespan: " << std::fixed << std::setprecision(2) 
               << bestCost << " px\n";
     std::cout << "[ALNS] Computation time: " << std::fixed << std::setprecision(2) 
@@ -146,22 +310,19 @@ VRPResult ALNS::Solve(
 
 void ALNS::DestroyWorst(
     Solution& sol,
-    std::vector<Task>& unassigned,
+    const std::vector<RouteCache>& cache,
+    ArenaVector<int>& unassigned,
     int count,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    std::vector<char>& touched
 ) const {
-    // Collect all tasks with their cost contributions
-    std::vector<TaskCost> taskCosts;
+    ScratchArena::Frame frame(arena_);
     
-    for (size_t r = 0; r < sol.size(); ++r) {
-        if (sol[r].empty()) continue;
-        
-        int startNode = robots[r].GetCurrentNodeId();
-        
-        for (size_t t = 0; t < sol[r].size(); ++t) {
-            double savings = CalculateRemovalSavings(sol[r], static_cast<int>(t), startNode, costs);
-            taskCosts.push_back({static_cast<int>(r), static_cast<int>(t), savings});
+    // Collect all tasks with their (cached) cost contributions
+    ArenaVector<TaskCost> taskCosts(arena_, sol.GetTaskCount());
+    
+    for (int r = 0; r < sol.GetRobotCount(); ++r) {
+        for (int t = 0; t < sol.RouteSize(r); ++t) {
+            taskCosts.push_back({r, t, cache[r].removalSavings[t]});
         }
     }
     
@@ -171,57 +332,219 @@ void ALNS::DestroyWorst(
     
     // Remove the worst tasks (need to handle indices carefully)
     // We'll mark tasks to remove, then remove them in reverse order
-    std::vector<std::pair<int, int>> toRemove; // (robot, taskIndex)
+    ArenaVector<TaskPosition> toRemove(arena_, count);
     
     for (int i = 0; i < std::min(count, static_cast<int>(taskCosts.size())); ++i) {
         toRemove.push_back({taskCosts[i].robotIndex, taskCosts[i].taskIndex});
     }
     
-    // Sort by (robot, taskIndex) descending so we can remove from back to front
-    std::sort(toRemove.begin(), toRemove.end(), 
-              [](const std::pair<int,int>& a, const std::pair<int,int>& b) {
-                  if (a.first != b.first) return a.first > b.first;
-                  return a.second > b.second;
-              });
-    
-    // Remove tasks (from back to front within each robot to preserve indices)
-    for (const auto& [robotIdx, taskIdx] : toRemove) {
-        unassigned.push_back(sol[robotIdx][taskIdx]);
-        sol[robotIdx].erase(sol[robotIdx].begin() + taskIdx);
-    }
+    EraseTasks(sol, toRemove.data(), toRemove.size(), unassigned, touched);
 }
 
 void ALNS::DestroyRandom(
     Solution& sol,
-    std::vector<Task>& unassigned,
-    int count
+    ArenaVector<int>& unassigned,
+    int count,
+    std::vector<char>& touched
 ) const {
+    ScratchArena::Frame frame(arena_);
+    
     // Collect all (robot, taskIndex) pairs
-    std::vector<std::pair<int, int>> allTasks;
+    ArenaVector<TaskPosition> allTasks(arena_, sol.GetTaskCount());
     
-    for (size_t r = 0; r < sol.size(); ++r) {
-        for (size_t t = 0; t < sol[r].size(); ++t) {
-            allTasks.push_back({static_cast<int>(r), static_cast<int>(t)});
+    for (int r = 0; r < sol.GetRobotCount(); ++r) {
+        for (int t = 0; t < sol.RouteSize(r); ++t) {
+            allTasks.push_back({r, t});
         }
     }
     
     // Shuffle and pick first `count`
     std::shuffle(allTasks.begin(), allTasks.end(), rng_);
     
-    // Sort selected tasks by (robot, taskIndex) descending for safe removal
     int numToRemove = std::min(count, static_cast<int>(allTasks.size()));
-    std::vector<std::pair<int, int>> toRemove(allTasks.begin(), allTasks.begin() + numToRemove);
+    EraseTasks(sol, allTasks.data(), numToRemove, unassigned, touched);
+}
+
+void ALNS::DestroyShaw(
+    Solution& sol,
+    ArenaVector<int>& unassigned,
+    int count,
+    const SearchContext& ctx,
+    std::vector<char>& touched
+) const {
+    ScratchArena::Frame frame(arena_);
+    if (sol.GetTaskCount() == 0) return;
+    
+    // Rank every task by relatedness to a random seed task (the seed first)
+    ArenaVector<TaskCost> ranked(arena_, sol.GetTaskCount());
+    for (int r = 0; r < sol.GetRobotCount(); ++r) {
+        for (int t = 0; t < sol.RouteSize(r); ++t) {
+            ranked.push_back({r, t, 0.0});
+        }
+    }
+    const TaskCost& seed = ranked[std::uniform_int_distribution<size_t>(0, ranked.size() - 1)(rng_)];
+    const int seedTask = sol.Route(seed.robotIndex)[seed.taskIndex];
+    for (TaskCost& candidate : ranked) {
+        candidate.cost = Relatedness(seedTask, sol.Route(candidate.robotIndex)[candidate.taskIndex], ctx);
+    }
+    std::sort(ranked.begin(), ranked.end(),
+              [](const TaskCost& a, const TaskCost& b) { return a.cost < b.cost; });
+    
+    // Draw from the ranking, biased towards the most related
+    int numToRemove = std::min(count, static_cast<int>(ranked.size()));
+    ArenaVector<TaskPosition> toRemove(arena_, numToRemove);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (int i = 0; i < numToRemove; ++i) {
+        size_t pick = static_cast<size_t>(std::pow(uniform(rng_), SHAW_RANDOMNESS) * ranked.size());
+        pick = std::min(pick, ranked.size() - 1);
+        toRemove.push_back({ranked[pick].robotIndex, ranked[pick].taskIndex});
+        ranked.erase(pick, pick + 1);
+    }
     
-    std::sort(toRemove.begin(), toRemove.end(),
-              [](const std::pair<int,int>& a, const std::pair<int,int>& b) {
-                  if (a.first != b.first) return a.first > b.first;
-                  return a.second > b.second;
+    EraseTasks(sol, toRemove.data(), toRemove.size(), unassigned, touched);
+}
+
+void ALNS::DestroyRoute(
+    Solution& sol,
+    ArenaVector<int>& unassigned,
+    int count,
+    std::vector<char>& touched
+) const {
+    ScratchArena::Frame frame(arena_);
+    
+    ArenaVector<int> routes(arena_, sol.GetRobotCount());
+    for (int r = 0; r < sol.GetRobotCount(); ++r) {
+        if (sol.RouteSize(r) > 0) routes.push_back(r);
+    }
+    std::shuffle(routes.begin(), routes.end(), rng_);
+    
+    // Whole routes; the last one loses only its tail
+    int numToRemove = std::min(count, sol.GetTaskCount());
+    ArenaVector<TaskPosition> toRemove(arena_, numToRemove);
+    for (int r : routes) {
+        for (int t = sol.RouteSize(r) - 1; t >= 0 && static_cast<int>(toRemove.size()) < numToRemove; --t) {
+            toRemove.push_back({r, t});
+        }
+    }
+    
+    EraseTasks(sol, toRemove.data(), toRemove.size(), unassigned, touched);
+}
+
+void ALNS::DestroyCluster(
+    Solution& sol,
+    ArenaVector<int>& unassigned,
+    int count,
+    const SearchContext& ctx,
+    std::vector<char>& touched
+) const {
+    ScratchArena::Frame frame(arena_);
+    if (sol.GetTaskCount() == 0) return;
+    
+    const int numToRemove = std::min(count, sol.GetTaskCount());
+    ArenaVector<TaskPosition> toRemove(arena_, numToRemove);
+    ArenaVector<char> visited(arena_, sol.GetRobotCount());
+    visited.resize(sol.GetRobotCount());
+    
+    // First cluster: around a random task
+    int pick = std::uniform_int_distribution<int>(0, sol.GetTaskCount() - 1)(rng_);
+    int route = 0;
+    while (pick >= sol.RouteSize(route)) pick -= sol.RouteSize(route++);
+    int seed = pick;
+    
+    while (static_cast<int>(toRemove.size()) < numToRemove) {
+        visited[route] = 1;
+        RouteView tasks = sol.Route(route);
+        
+        // Split the route between its seed and the task farthest from it
+        int far = seed;
+        double farDistance = -1.0;
+        for (int t = 0; t < tasks.size(); ++t) {
+            double distance = Relatedness(tasks[seed], tasks[t], ctx);
+            if (distance > farDistance) {
+                farDistance = distance;
+                far = t;
+            }
+        }
+        for (int t = 0; t < tasks.size() && static_cast<int>(toRemove.size()) < numToRemove; ++t) {
+            if (Relatedness(tasks[seed], tasks[t], ctx) <= Relatedness(tasks[far], tasks[t], ctx)) {
+                toRemove.push_back({route, t});
+            }
+        }
+        
+        // Next cluster: around the task of another route nearest a removed one
+        const TaskPosition& anchor = toRemove[std::uniform_int_distribution<size_t>(0, toRemove.size() - 1)(rng_)];
+        const int anchorTask = sol.Route(anchor.robotIndex)[anchor.taskIndex];
+        double nearest = std::numeric_limits<double>::max();
+        route = -1;
+        for (int r = 0; r < sol.GetRobotCount(); ++r) {
+            if (visited[r]) continue;
+            for (int t = 0; t < sol.RouteSize(r); ++t) {
+                double distance = Relatedness(anchorTask, sol.Route(r)[t], ctx);
+                if (distance < nearest) {
+                    nearest = distance;
+                    route = r;
+                    seed = t;
+                }
+            }
+        }
+        if (route < 0) break;
+    }
+    
+    EraseTasks(sol, toRemove.data(), toRemove.size(), unassigned, touched);
+}
+
+void ALNS::EraseTasks(
+    Solution& sol,
+    TaskPosition* positions,
+    size_t count,
+    ArenaVector<int>& unassigned,
+    std::vector<char>& touched
+) {
+    // Sort by (robot, taskIndex) descending so we can remove from back to front
+    std::sort(positions, positions + count,
+              [](const TaskPosition& a, const TaskPosition& b) {
+                  if (a.robotIndex != b.robotIndex) return a.robotIndex > b.robotIndex;
+                  return a.taskIndex > b.taskIndex;
               });
     
-    // Remove tasks
-    for (const auto& [robotIdx, taskIdx] : toRemove) {
-        unassigned.push_back(sol[robotIdx][taskIdx]);
-        sol[robotIdx].erase(sol[robotIdx].begin() + taskIdx);
+    // Remove tasks (from back to front within each robot to preserve indices)
+    for (size_t i = 0; i < count; ++i) {
+        unassigned.push_back(sol.Erase(positions[i].robotIndex, positions[i].taskIndex));
+        touched[positions[i].robotIndex] = 1;
+    }
+}
+
+double ALNS::Relatedness(int a, int b, const SearchContext& ctx) {
+    const TaskNodes& first = ctx.tasks[a];
+    const TaskNodes& second = ctx.tasks[b];
+    return ctx.costs->GetCost(first.source, second.source) + ctx.costs->GetCost(first.destination, second.destination);
+}
+
+// =============================================================================
+// ADAPTIVE OPERATOR SELECTION
+// =============================================================================
+
+int ALNS::SelectOperator(const std::vector<AdaptiveOperator>& operators) const {
+    double total = 0.0;
+    for (const auto& op : operators) total += op.weight;
+    double draw = std::uniform_real_distribution<double>(0.0, total)(rng_);
+    for (size_t i = 0; i + 1 < operators.size(); ++i) {
+        draw -= operators[i].weight;
+        if (draw < 0.0) return static_cast<int>(i);
+    }
+    return static_cast<int>(operators.size()) - 1;
+}
+
+void ALNS::UpdateWeights(std::vector<AdaptiveOperator>& operators) {
+    for (auto& op : operators) {
+        // Unused operators keep their weight
+        if (op.segmentUses > 0) {
+            op.weight = (1.0 - REACTION) * op.weight + REACTION * op.segmentScore / op.segmentUses;
+            op.weight = std::max(MIN_WEIGHT, op.weight);
+        }
+        op.stats.weights.push_back(op.weight);
+        op.segmentScore = 0.0;
+        op.segmentUses = 0;
     }
 }
 
@@ -231,128 +554,208 @@ void ALNS::DestroyRandom(
 
 void ALNS::RepairRegret(
     Solution& sol,
-    std::vector<Task>& unassigned,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    ArenaVector<int>& unassigned,
+    const SearchContext& ctx,
+    std::vector<char>& touched
 ) const {
+    ScratchArena::Frame frame(arena_);
+    const size_t numRoutes = static_cast<size_t>(sol.GetRobotCount());
+    
+    // Insertion positions available to every task
+    size_t positionCount = 0;
+    for (size_t r = 0; r < numRoutes; ++r) positionCount += sol.RouteSize(static_cast<int>(r)) + 1;
+    
+    // options[t * numRoutes + r]: best / second-best insertion of
+    // unassigned[t] into route r
+    ArenaVector<RouteInsertion> options(arena_, unassigned.size() * numRoutes);
+    options.resize(unassigned.size() * numRoutes);
+    RunChunks(ctx.scheduler, RepairChunks(ctx, unassigned.size(), unassigned.size() * positionCount),
+              unassigned.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            for (size_t r = 0; r < numRoutes; ++r) {
+                options[t * numRoutes + r] = EvaluateRouteInsertion(sol.Route(static_cast<int>(r)), static_cast<int>(r), unassigned[t], ctx);
+            }
+        }
+    });
+    
+    // Route completion times, to break insertion-cost ties towards the
+    // less loaded robot (the objective is the makespan)
+    ArenaVector<double> routeCosts(arena_, numRoutes);
+    for (size_t r = 0; r < numRoutes; ++r) {
+        routeCosts.push_back(CalculateRouteCost(sol.Route(static_cast<int>(r)), static_cast<int>(r), ctx));
+    }
+    
+    // Best choice of each chunk; workers only write their own slot
+    ArenaVector<RegretChoice> choices(arena_, ctx.scheduler ? ctx.scheduler->GetThreadCount() + 1 : 1);
+    choices.resize(ctx.scheduler ? ctx.scheduler->GetThreadCount() + 1 : 1);
+    
+    int changedRoute = -1;      // Route the previous round inserted into
     while (!unassigned.empty()) {
-        int bestTaskIdx = -1;
-        double maxRegret = -std::numeric_limits<double>::max();
-        
-        // Store the best move for each task
-        std::vector<InsertionMove> bestMoves(unassigned.size());
-        
-        // For each unassigned task, find best and 2nd best insertion positions
-        for (size_t t = 0; t < unassigned.size(); ++t) {
-            const Task& task = unassigned[t];
-            
-            // Collect all valid insertion positions
-            std::vector<InsertionMove> validMoves;
-            
-            // Try every robot, every position
-            for (size_t r = 0; r < sol.size(); ++r) {
-                int startNode = robots[r].GetCurrentNodeId();
+        // Rescan the changed route, then score every task's regret
+        const size_t rescanPositions = changedRoute >= 0 ? sol.RouteSize(changedRoute) + 1 : 0;
+        const size_t chunks = RepairChunks(ctx, unassigned.size(), unassigned.size() * (rescanPositions + numRoutes));
+        RunChunks(ctx.scheduler, chunks, unassigned.size(), [&](size_t chunk, size_t begin, size_t end) {
+            RegretChoice best;
+            for (size_t t = begin; t < end; ++t) {
+                RouteInsertion* row = options.data() + t * numRoutes;
+                if (changedRoute >= 0) {
+                    row[changedRoute] = EvaluateRouteInsertion(sol.Route(changedRoute), changedRoute, unassigned[t], ctx);
+                }
+                InsertionMove move;
+                double regret = ScoreRegret(row, routeCosts, positionCount, move);
                 
-                // Can insert at positions 0 to route.size() (inclusive)
-                for (size_t p = 0; p <= sol[r].size(); ++p) {
-                    double insertCost = CalculateInsertionCost(
-                        sol[r], task, static_cast<int>(p), startNode, costs
-                    );
-                    validMoves.emplace_back(static_cast<int>(r), static_cast<int>(p), insertCost);
+                // Track task with highest regret
+                if (regret > best.regret) {
+                    best.task = static_cast<int>(t);
+                    best.regret = regret;
+                    best.move = move;
                 }
             }
-            
-            // Sort by insertion cost (ascending - cheapest first)
-            std::sort(validMoves.begin(), validMoves.end(),
-                      [](const InsertionMove& a, const InsertionMove& b) {
-                          return a.insertionCost < b.insertionCost;
-                      });
-            
-            // Calculate regret = 2nd best - best
-            double regret;
-            if (validMoves.size() >= 2) {
-                regret = validMoves[1].insertionCost - validMoves[0].insertionCost;
-            } else if (validMoves.size() == 1) {
-                // Only one option - must prioritize
-                regret = std::numeric_limits<double>::max();
-            } else {
-                // No valid moves (shouldn't happen)
-                regret = 0;
-            }
-            
-            // Store best move for this task
-            if (!validMoves.empty()) {
-                bestMoves[t] = validMoves[0];
-            }
-            
-            // Track task with highest regret
-            if (regret > maxRegret) {
-                maxRegret = regret;
-                bestTaskIdx = static_cast<int>(t);
-            }
+            choices[chunk] = best;
+        });
+        
+        // Chunks cover ascending tasks: keeping the first of equal regrets
+        // picks the task a single scan would
+        RegretChoice best = choices[0];
+        for (size_t c = 1; c < chunks; ++c) {
+            if (choices[c].regret > best.regret) best = choices[c];
         }
         
         // Insert the task with highest regret at its best position
-        if (bestTaskIdx >= 0 && bestMoves[bestTaskIdx].robotIndex >= 0) {
-            const InsertionMove& move = bestMoves[bestTaskIdx];
-            sol[move.robotIndex].insert(
-                sol[move.robotIndex].begin() + move.position,
-                unassigned[bestTaskIdx]
-            );
-            unassigned.erase(unassigned.begin() + bestTaskIdx);
+        if (best.task >= 0 && best.move.robotIndex >= 0) {
+            changedRoute = best.move.robotIndex;
+            sol.Insert(changedRoute, best.move.position, unassigned[best.task]);
+            unassigned.erase(best.task, best.task + 1);
+            options.erase(static_cast<size_t>(best.task) * numRoutes,
+                          static_cast<size_t>(best.task + 1) * numRoutes);
         } else {
             // Fallback: assign to robot with shortest route
-            if (!unassigned.empty()) {
-                size_t minRobot = 0;
-                size_t minSize = sol[0].size();
-                for (size_t r = 1; r < sol.size(); ++r) {
-                    if (sol[r].size() < minSize) {
-                        minSize = sol[r].size();
-                        minRobot = r;
-                    }
+            int minRobot = 0;
+            int minSize = sol.RouteSize(0);
+            for (int r = 1; r < static_cast<int>(numRoutes); ++r) {
+                if (sol.RouteSize(r) < minSize) {
+                    minSize = sol.RouteSize(r);
+                    minRobot = r;
                 }
-                sol[minRobot].push_back(unassigned.back());
-                unassigned.pop_back();
             }
+            changedRoute = minRobot;
+            sol.PushBack(minRobot, unassigned.back());
+            unassigned.pop_back();
+            options.resize(unassigned.size() * numRoutes);
         }
+        touched[changedRoute] = 1;
+        routeCosts[changedRoute] = CalculateRouteCost(sol.Route(changedRoute), changedRoute, ctx);
+        ++positionCount;
+    }
+}
+
+double ALNS::ScoreRegret(
+    const RouteInsertion* row,
+    const ArenaVector<double>& routeCosts,
+    size_t positionCount,
+    InsertionMove& move
+) const {
+    const size_t numRoutes = routeCosts.size();
+    
+    // Cheapest route (the one finishing earlier on ties)
+    size_t bestRoute = 0;
+    for (size_t r = 1; r < numRoutes; ++r) {
+        if (row[r].bestCost < row[bestRoute].bestCost ||
+            (row[r].bestCost == row[bestRoute].bestCost && routeCosts[r] < routeCosts[bestRoute])) {
+            bestRoute = r;
+        }
+    }
+    move = InsertionMove(static_cast<int>(bestRoute), row[bestRoute].bestPosition, row[bestRoute].bestCost);
+    
+    // Only one option - must prioritize
+    if (positionCount < 2) return std::numeric_limits<double>::max();
+    
+    // Runner-ups: second spot in the same route or best elsewhere
+    const double best = row[bestRoute].bestCost;
+    if (regretK_ == 2) {
+        double second = row[bestRoute].secondCost;
+        for (size_t r = 0; r < numRoutes; ++r) {
+            if (r != bestRoute) second = std::min(second, row[r].bestCost);
+        }
+        return second - best;
+    }
+    
+    // Keep the k - 1 cheapest, ascending
+    double runnerUps[MAX_REGRET_K - 1];
+    const int limit = std::clamp(regretK_ - 1, 1, MAX_REGRET_K - 1);
+    int kept = 0;
+    auto offer = [&](double cost) {
+        if (kept == limit) {
+            if (cost >= runnerUps[limit - 1]) return;
+            --kept;
+        }
+        int i = kept++;
+        for (; i > 0 && runnerUps[i - 1] > cost; --i) runnerUps[i] = runnerUps[i - 1];
+        runnerUps[i] = cost;
+    };
+    offer(row[bestRoute].secondCost);
+    for (size_t r = 0; r < numRoutes; ++r) {
+        if (r != bestRoute) offer(row[r].bestCost);
+    }
+    
+    // Calculate regret = sum of (runner-up - best)
+    double regret = 0.0;
+    for (int j = 0; j < kept; ++j) {
+        if (runnerUps[j] == std::numeric_limits<double>::max()) return std::numeric_limits<double>::max();
+        regret += runnerUps[j] - best;
     }
+    return regret;
+}
+
+void ALNS::RunChunks(
+    Common::TaskScheduler* scheduler,
+    size_t chunks,
+    size_t count,
+    const std::function<void(size_t, size_t, size_t)>& scan
+) {
+    if (chunks <= 1 || !scheduler) {
+        scan(0, 0, count);
+        return;
+    }
+    scheduler->ParallelFor(chunks, [&](size_t chunk) {
+        scan(chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+    }, Common::TaskPriority::HIGH);
+}
+
+size_t ALNS::RepairChunks(const SearchContext& ctx, size_t count, size_t positions) {
+    if (!ctx.scheduler || positions < 2 * PARALLEL_REPAIR_MIN_POSITIONS) return 1;
+    // Every chunk gets at least PARALLEL_REPAIR_MIN_POSITIONS of the work
+    size_t chunks = std::min(ctx.scheduler->GetThreadCount() + 1, positions / PARALLEL_REPAIR_MIN_POSITIONS);
+    return std::max<size_t>(1, std::min(chunks, count));
 }
 
 void ALNS::RepairGreedy(
     Solution& sol,
-    std::vector<Task>& unassigned,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    ArenaVector<int>& unassigned,
+    const SearchContext& ctx,
+    std::vector<char>& touched
 ) const {
     while (!unassigned.empty()) {
-        const Task& task = unassigned.back();
+        int taskIndex = unassigned.back();
         
         InsertionMove bestMove;
         
         // Find cheapest insertion across all robots and positions
-        for (size_t r = 0; r < sol.size(); ++r) {
-            int startNode = robots[r].GetCurrentNodeId();
-            
-            for (size_t p = 0; p <= sol[r].size(); ++p) {
-                double insertCost = CalculateInsertionCost(
-                    sol[r], task, static_cast<int>(p), startNode, costs
-                );
-                
-                if (insertCost < bestMove.insertionCost) {
-                    bestMove = InsertionMove(static_cast<int>(r), static_cast<int>(p), insertCost);
-                }
+        for (int r = 0; r < sol.GetRobotCount(); ++r) {
+            RouteInsertion option = EvaluateRouteInsertion(sol.Route(r), r, taskIndex, ctx);
+            if (option.bestCost < bestMove.insertionCost) {
+                bestMove = InsertionMove(r, option.bestPosition, option.bestCost);
             }
         }
         
         // Insert at best position
         if (bestMove.robotIndex >= 0) {
-            sol[bestMove.robotIndex].insert(
-                sol[bestMove.robotIndex].begin() + bestMove.position,
-                task
-            );
+            sol.Insert(bestMove.robotIndex, bestMove.position, taskIndex);
+            touched[bestMove.robotIndex] = 1;
         } else {
             // Fallback: assign to first robot
-            sol[0].push_back(task);
+            sol.PushBack(0, taskIndex);
+            touched[0] = 1;
         }
         
         unassigned.pop_back();
@@ -363,145 +766,120 @@ void ALNS::RepairGreedy(
 // COST CALCULATIONS
 // =============================================================================
 
-double ALNS::CalculateSolutionCost(
-    const Solution& sol,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+void ALNS::RebuildRouteCache(
+    RouteView route,
+    int robotIndex,
+    const SearchContext& ctx,
+    RouteCache& cache
 ) const {
-    // Makespan = maximum route cost across all robots
-    double makespan = 0;
+    const CostMatrixProvider& costs = *ctx.costs;
+    cache.completion.resize(route.size());
+    cache.removalSavings.resize(route.size());
     
-    for (size_t r = 0; r < sol.size(); ++r) {
-        int startNode = robots[r].GetCurrentNodeId();
-        double routeCost = CalculateRouteCost(sol[r], startNode, costs);
-        makespan = std::max(makespan, routeCost);
-    }
+    // Travel legs in one batched pass: legs[2i] reaches task i's pickup
+    cache.legs.resize(static_cast<size_t>(route.size()) * 2);
+    ctx.scorer.RouteTime(route, ctx.startNodes[robotIndex], cache.legs.data());
     
-    return makespan;
-}
-
-double ALNS::CalculateTotalDistance(
-    const Solution& sol,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
-) const {
     double total = 0;
+    int prevNode = ctx.startNodes[robotIndex];
     
-    for (size_t r = 0; r < sol.size(); ++r) {
-        int startNode = robots[r].GetCurrentNodeId();
-        total += CalculateRouteCost(sol[r], startNode, costs);
+    for (int i = 0; i < route.size(); ++i) {
+        const TaskNodes& task = ctx.tasks[route[i]];
+        
+        // Cost to pickup, then pickup to dropoff
+        float toPickup = cache.legs[2 * i];
+        total += toPickup;
+        total += task.serviceCost;
+        cache.completion[i] = total;
+        
+        // Savings = cost with the task - cost of bridging prev to next
+        double currentCost = toPickup + task.serviceCost;
+        double costWithout = 0;
+        if (i + 1 < route.size()) {
+            int nextNode = ctx.tasks[route[i + 1]].source;
+            currentCost += cache.legs[2 * i + 2];
+            costWithout = costs.GetCost(prevNode, nextNode);
+        }
+        cache.removalSavings[i] = currentCost - costWithout;
+        
+        prevNode = task.destination;
     }
-    
-    return total;
+    if (ctx.load) ctx.load->Completion(route, robotIndex, cache.completion);
 }
 
 double ALNS::CalculateRouteCost(
-    const std::vector<Task>& route,
-    int startNode,
-    const CostMatrixProvider& costs
+    RouteView route,
+    int robotIndex,
+    const SearchContext& ctx
 ) const {
-    if (route.empty()) return 0;
-    
+    return ctx.scorer.RouteTime(route, ctx.startNodes[robotIndex]);
+}
+
+double ALNS::CalculateMakespan(const std::vector<RouteCache>& cache) {
+    // Makespan = maximum route cost across all robots
+    double makespan = 0;
+    for (const RouteCache& route : cache) {
+        makespan = std::max(makespan, route.Cost());
+    }
+    return makespan;
+}
+
+double ALNS::CalculateTotalDistance(const std::vector<RouteCache>& cache) {
     double total = 0;
-    int prevNode = startNode;
-    
-    for (const Task& task : route) {
-        // Cost to pickup
-        total += costs.GetCost(prevNode, task.sourceNode);
-        // Cost from pickup to dropoff
-        total += costs.GetCost(task.sourceNode, task.destinationNode);
-        // Update prev to dropoff
-        prevNode = task.destinationNode;
+    for (const RouteCache& route : cache) {
+        total += route.Cost();
     }
-    
     return total;
 }
 
-double ALNS::CalculateInsertionCost(
-    const std::vector<Task>& route,
-    const Task& task,
-    int position,
-    int startNode,
-    const CostMatrixProvider& costs
+ALNS::RouteInsertion ALNS::EvaluateRouteInsertion(
+    RouteView route,
+    int robotIndex,
+    int taskIndex,
+    const SearchContext& ctx
 ) const {
-    // Get the previous and next nodes
-    int prevNode, nextNode;
-    double oldCost = 0;
-    
-    if (route.empty()) {
-        // Inserting into empty route
-        prevNode = startNode;
-        nextNode = -1; // No next
-    } else if (position == 0) {
-        // Inserting at front
-        prevNode = startNode;
-        nextNode = route[0].sourceNode;
-        oldCost = costs.GetCost(prevNode, nextNode);
-    } else if (position >= static_cast<int>(route.size())) {
-        // Inserting at back
-        prevNode = route.back().destinationNode;
-        nextNode = -1; // No next
-    } else {
-        // Inserting in middle
-        prevNode = route[position - 1].destinationNode;
-        nextNode = route[position].sourceNode;
-        oldCost = costs.GetCost(prevNode, nextNode);
-    }
-    
-    // Calculate new cost with task inserted
-    double newCost = costs.GetCost(prevNode, task.sourceNode) 
-                   + costs.GetCost(task.sourceNode, task.destinationNode);
-    
-    if (nextNode >= 0) {
-        newCost += costs.GetCost(task.destinationNode, nextNode);
+    RouteInsertion result;
+    
+    // Can insert at positions 0 to route.size() (inclusive)
+    for (int p = 0; p <= route.size(); ++p) {
+        double cost = CalculateInsertionCost(route, taskIndex, p, robotIndex, ctx);
+        if (cost < result.bestCost) {
+            result.secondCost = result.bestCost;
+            result.bestCost = cost;
+            result.bestPosition = p;
+        } else if (cost < result.secondCost) {
+            result.secondCost = cost;
+        }
     }
-    
-    return newCost - oldCost;
+    return result;
 }
 
-double ALNS::CalculateRemovalSavings(
-    const std::vector<Task>& route,
+double ALNS::CalculateInsertionCost(
+    RouteView route,
     int taskIndex,
-    int startNode,
-    const CostMatrixProvider& costs
+    int position,
+    int robotIndex,
+    const SearchContext& ctx
 ) const {
-    if (route.empty() || taskIndex < 0 || taskIndex >= static_cast<int>(route.size())) {
-        return 0;
-    }
-    
-    const Task& task = route[taskIndex];
-    
-    // Get previous and next nodes
-    int prevNode, nextNode;
-    
-    if (taskIndex == 0) {
-        prevNode = startNode;
-    } else {
-        prevNode = route[taskIndex - 1].destinationNode;
-    }
+    const CostMatrixProvider& costs = *ctx.costs;
+    const TaskNodes& task = ctx.tasks[taskIndex];
     
-    if (taskIndex == static_cast<int>(route.size()) - 1) {
-        nextNode = -1; // No next
-    } else {
-        nextNode = route[taskIndex + 1].sourceNode;
-    }
-    
-    // Current cost with task
-    double currentCost = costs.GetCost(prevNode, task.sourceNode)
-                       + costs.GetCost(task.sourceNode, task.destinationNode);
+    // Get the previous and next nodes
+    int prevNode = (position == 0) ? ctx.startNodes[robotIndex]
+                                   : ctx.tasks[route[position - 1]].destination;
+    int nextNode = (position < route.size()) ? ctx.tasks[route[position]].source
+                                                               : -1; // No next
     
-    if (nextNode >= 0) {
-        currentCost += costs.GetCost(task.destinationNode, nextNode);
-    }
+    // Calculate new cost with task inserted
+    double newCost = costs.GetCost(prevNode, task.source) + task.serviceCost;
+    double oldCost = 0;
     
-    // Cost without task
-    double costWithout = 0;
     if (nextNode >= 0) {
-        costWithout = costs.GetCost(prevNode, nextNode);
+        newCost += costs.GetCost(task.destination, nextNode);
+        oldCost = costs.GetCost(prevNode, nextNode);
     }
     
-    // Savings = current cost - cost without = what we "save" by removing
-    return currentCost - costWithout;
+    return newCost - oldCost;
 }
 
 // =============================================================================
@@ -510,18 +888,26 @@ double ALNS::CalculateRemovalSavings(
 
 std::map<int, std::vector<int>> ALNS::FormatResult(
     const Solution& sol,
+    const SearchContext& ctx,
     const std::vector<RobotAgent>& robots
 ) const {
     std::map<int, std::vector<int>> result;
     
-    for (size_t r = 0; r < sol.size(); ++r) {
+    for (int r = 0; r < sol.GetRobotCount(); ++r) {
         int robotId = robots[r].GetRobotId();
+        if (ctx.load) {
+            LoadProfile profile;
+            ctx.load->Plan(sol.Route(r), r, profile);
+            result[robotId] = ctx.load->Itinerary(sol.Route(r), profile);
+            continue;
+        }
         std::vector<int> itinerary;
+        itinerary.reserve(sol.RouteSize(r) * 2);
         
         // Expand each task to pickup + dropoff nodes
-        for (const Task& task : sol[r]) {
-            itinerary.push_back(task.sourceNode);      // Pickup
-            itinerary.push_back(task.destinationNode); // Dropoff
+        for (int taskIndex : sol.Route(r)) {
+            itinerary.push_back(ctx.tasks[taskIndex].source);       // Pickup
+            itinerary.push_back(ctx.tasks[taskIndex].destination);  // Dropoff
         }
         
         result[robotId] = itinerary;
@@ -535,17 +921,17 @@ std::map<int, std::vector<int>> ALNS::FormatResult(
 // =============================================================================
 
 ALNS::Solution ALNS::GenerateInitialSolution(
-    const std::vector<Task>& tasks,
+    size_t numTasks,
     size_t numRobots
 ) const {
-    Solution sol(numRobots);
+    std::vector<std::vector<int>> routes(numRobots);
     
     // Round-robin assignment
-    for (size_t i = 0; i < tasks.size(); ++i) {
-        sol[i % numRobots].push_back(tasks[i]);
+    for (size_t i = 0; i < numTasks; ++i) {
+        routes[i % numRobots].push_back(static_cast<int>(i));
     }
     
-    return sol;
+    return FlatSolution::FromRoutes(routes);
 }
 
 } // namespace Layer2
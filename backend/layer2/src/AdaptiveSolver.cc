@@ -0,0 +1,173 @@
+/**
+ * @file AdaptiveSolver.cc
+ * @brief Implementation of latency-targeted solver tier selection
+ */
+
+#include "../include/AdaptiveSolver.hh"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace Backend {
+namespace Layer2 {
+
+void AdaptiveSolver::LatencyModel::Add(double x, double y) {
+    weight = weight * MODEL_DECAY + 1.0;
+    sumX = sumX * MODEL_DECAY + x;
+    sumY = sumY * MODEL_DECAY + y;
+    sumXX = sumXX * MODEL_DECAY + x * x;
+    sumXY = sumXY * MODEL_DECAY + x * y;
+}
+
+double AdaptiveSolver::LatencyModel::Predict(double x) const {
+    double meanX = sumX / weight;
+    double meanY = sumY / weight;
+    double variance = sumXX / weight - meanX * meanX;
+
+    // One instance size seen so far: assume time linear in work
+    double exponent = 1.0;
+    if (variance > 1e-6) {
+        exponent = std::clamp((sumXY / weight - meanX * meanY) / variance, MIN_EXPONENT, MAX_EXPONENT);
+    }
+    return std::exp(meanY + exponent * (x - meanX));
+}
+
+AdaptiveSolver::AdaptiveSolver(std::vector<std::unique_ptr<IVRPSolver>> tiers, double targetLatencyMs)
+    : targetLatencyMs_(targetLatencyMs) {
+    if (tiers.empty()) {
+        throw std::invalid_argument("AdaptiveSolver: at least one solver tier is required");
+    }
+    if (targetLatencyMs <= 0.0) {
+        throw std::invalid_argument("AdaptiveSolver: target latency must be positive");
+    }
+    for (auto& solver : tiers) {
+        if (!solver) {
+            throw std::invalid_argument("AdaptiveSolver: solver tier is null");
+        }
+        Tier tier;
+        tier.solver = std::move(solver);
+        tiers_.push_back(std::move(tier));
+    }
+}
+
+double AdaptiveSolver::LogWork(size_t tasks, size_t robots) {
+    double work = static_cast<double>(std::max<size_t>(tasks, 1)) * std::max<size_t>(robots, 1);
+    return std::log(work);
+}
+
+int AdaptiveSolver::WorkBucket(double logWork) {
+    return static_cast<int>(std::floor(logWork / std::log(2.0)));
+}
+
+double AdaptiveSolver::QualityAt(size_t tier, int bucket) const {
+    auto it = tiers_[tier].quality.find(bucket);
+    return it != tiers_[tier].quality.end() ? it->second : 0.0;
+}
+
+double AdaptiveSolver::GetTargetLatencyMs() const {
+    std::lock_guard<std::mutex> lock(modelMutex_);
+    return targetLatencyMs_;
+}
+
+void AdaptiveSolver::SetTargetLatencyMs(double ms) {
+    std::lock_guard<std::mutex> lock(modelMutex_);
+    if (ms > 0.0) targetLatencyMs_ = ms;
+}
+
+AdaptiveSolver::Choice AdaptiveSolver::Select(size_t tasks, size_t robots) const {
+    std::lock_guard<std::mutex> lock(modelMutex_);
+    double x = LogWork(tasks, robots);
+
+    auto predict = [&](size_t tier) {
+        const LatencyModel& model = tiers_[tier].latency;
+        return model.IsFitted() ? model.Predict(x) : -1.0;
+    };
+    auto fits = [&](double predictedMs) { return predictedMs <= targetLatencyMs_; };
+
+    // Most expensive tier that fits; unmeasured tiers are tried as they come
+    Choice choice;
+    choice.tier = tiers_.size() - 1;
+    choice.predictedMs = predict(choice.tier);
+    for (size_t tier = 0; tier < tiers_.size(); ++tier) {
+        double predictedMs = predict(tier);
+        if (fits(predictedMs)) {
+            choice.tier = tier;
+            choice.predictedMs = predictedMs;
+            break;
+        }
+    }
+
+    // Cheaper tiers that fit as well and lose (almost) nothing in quality
+    int bucket = WorkBucket(x);
+    for (size_t tier = choice.tier + 1; tier < tiers_.size(); ++tier) {
+        double predictedMs = predict(tier);
+        double quality = QualityAt(tier, bucket);
+        double chosenQuality = QualityAt(choice.tier, bucket);
+        if (predictedMs >= 0.0 && fits(predictedMs) && quality > 0.0 && chosenQuality > 0.0 &&
+            quality <= chosenQuality * (1.0 + QUALITY_TOLERANCE)) {
+            choice.tier = tier;
+            choice.predictedMs = predictedMs;
+        }
+    }
+
+    choice.budgetMs = std::max(targetLatencyMs_ - tiers_[choice.tier].overrunMs,
+                               MIN_BUDGET_FRACTION * targetLatencyMs_);
+    return choice;
+}
+
+void AdaptiveSolver::Record(size_t tier, double logWork, const VRPResult& result, double budgetMs,
+                            double lowerBound) {
+    std::lock_guard<std::mutex> lock(modelMutex_);
+    Tier& entry = tiers_[tier];
+
+    // A solve cut short by its deadline ran at least this long, so it can
+    // only raise the prediction
+    double elapsedMs = std::max(result.computationTimeMs, 0.01);
+    if (!result.stoppedEarly || !entry.latency.IsFitted() ||
+        elapsedMs > entry.latency.Predict(logWork)) {
+        entry.latency.Add(logWork, std::log(elapsedMs));
+    }
+    if (result.stoppedEarly) {
+        // Time past the deadline before the tier noticed it
+        double overrunMs = std::max(0.0, elapsedMs - budgetMs);
+        entry.overrunMs += QUALITY_SMOOTHING * (overrunMs - entry.overrunMs);
+    }
+
+    if (lowerBound > 0.0) {
+        double ratio = result.makespan / lowerBound;
+        auto [it, inserted] = entry.quality.try_emplace(WorkBucket(logWork), ratio);
+        if (!inserted) it->second += QUALITY_SMOOTHING * (ratio - it->second);
+    }
+}
+
+VRPResult AdaptiveSolver::Solve(
+    const std::vector<Task>& tasks,
+    std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs,
+    const SolveOptions& options
+) {
+    using Clock = SolveOptions::Clock;
+
+    Choice choice = Select(tasks.size(), robots.size());
+
+    SolveOptions tierOptions = options;
+    Clock::time_point budgetDeadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(choice.budgetMs));
+    tierOptions.deadline = std::min(tierOptions.deadline, budgetDeadline);
+
+    auto start = Clock::now();
+    VRPResult result = tiers_[choice.tier].solver->Solve(tasks, robots, costs, tierOptions);
+    result.computationTimeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // A cancelled solve says nothing about the tier
+    if (result.isFeasible && !options.IsCancelled()) {
+        double lowerBound = result.lowerBound > 0.0 ? result.lowerBound
+                                                    : MakespanLowerBound(tasks, robots, costs);
+        Record(choice.tier, LogWork(tasks.size(), robots.size()), result, choice.budgetMs, lowerBound);
+    }
+    return result;
+}
+
+} // namespace Layer2
+} // namespace Backend
@@ -0,0 +1,158 @@
+/**
+ * @file BatteryProfile.cc
+ * @brief Implementation of the charging-stop planner
+ */
+
+#include "../include/BatteryProfile.hh"
+#include <algorithm>
+
+namespace Backend {
+namespace Layer2 {
+
+BatteryPlanner::BatteryPlanner(
+    const BatteryModel& model,
+    const std::vector<Task>& tasks,
+    const std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs
+)
+    : enabled_(model.IsEnabled())
+    , model_(model)
+    , tasks_(tasks)
+    , costs_(costs)
+    , capacity_(model.Capacity())
+    , reserve_(model.Reserve()) {
+    startNodes_.reserve(robots.size());
+    startEnergy_.reserve(robots.size());
+    for (const auto& robot : robots) {
+        startNodes_.push_back(robot.GetCurrentNodeId());
+        startEnergy_.push_back(std::clamp(static_cast<double>(robot.GetCurrentBattery()), 0.0, 1.0) * capacity_);
+    }
+
+    serviceCost_.reserve(tasks.size());
+    for (const Task& task : tasks) {
+        serviceCost_.push_back(costs.GetCost(task.sourceNode, task.destinationNode));
+    }
+}
+
+double BatteryPlanner::Walk(RouteView route, int robot, BatteryProfile* profile,
+                            const std::vector<ChargerSlot>* chargers) const {
+    int size = route.size();
+    if (profile) {
+        profile->time.resize(size + 1);
+        profile->energy.resize(size + 1);
+        profile->slack.resize(size + 1);
+        profile->nextStop.resize(size + 1);
+        profile->stopCharger.assign(size, -1);
+        profile->stops = 0;
+        profile->feasible = true;
+        profile->time[0] = 0.0;
+        profile->energy[0] = startEnergy_[robot];
+    }
+
+    double time = 0.0;
+    double energy = startEnergy_[robot];
+    int node = startNodes_[robot];
+    for (int k = 0; k < size; ++k) {
+        const Task& task = tasks_[route[k]];
+        double service = serviceCost_[route[k]];
+        double into = costs_.GetCost(node, task.sourceNode);
+
+        if (enabled_ && energy - into - service < reserve_) {
+            float detour = 0.0f;
+            double wait = 0.0;
+            int charger;
+            if (chargers && (*chargers)[k].charger >= 0) {
+                charger = (*chargers)[k].charger;
+                wait = (*chargers)[k].wait;
+                detour = costs_.GetCost(node, charger) + costs_.GetCost(charger, task.sourceNode);
+            } else {
+                charger = CheapestCharger(node, task.sourceNode, detour);
+            }
+            double toCharger = costs_.GetCost(node, charger);
+            double arrival = energy - toCharger;
+
+            time += toCharger + wait + (capacity_ - std::max(0.0, arrival)) * BatteryModel::CHARGE_TIME_PER_UNIT;
+            energy = capacity_;
+            into = detour - toCharger;
+
+            if (profile) {
+                profile->stopCharger[k] = charger;
+                profile->stops++;
+                if (arrival < 0.0 || energy - into - service < reserve_) profile->feasible = false;
+            }
+        }
+
+        time += into + service;
+        energy -= into + service;
+        node = task.destinationNode;
+        if (profile) {
+            profile->slack[k] = energy - reserve_;   // Margin of the reserve check
+            profile->time[k + 1] = time;
+            profile->energy[k + 1] = energy;
+        }
+    }
+    if (!profile) return time;
+
+    // Backward pass: margins become slack up to the next stop (a stop
+    // absorbs any drain before it)
+    profile->slack[size] = NO_FIT;
+    profile->nextStop[size] = size;
+    for (int k = size - 1; k >= 0; --k) {
+        if (profile->stopCharger[k] >= 0) {
+            profile->slack[k] = NO_FIT;
+            profile->nextStop[k] = k;
+        } else {
+            profile->slack[k] = std::min(profile->slack[k], profile->slack[k + 1]);
+            profile->nextStop[k] = profile->nextStop[k + 1];
+        }
+    }
+    return time;
+}
+
+std::vector<int> BatteryPlanner::Itinerary(RouteView route, const BatteryProfile& profile) const {
+    std::vector<int> nodes;
+    nodes.reserve(route.size() * 2 + profile.stops);
+    for (int k = 0; k < route.size(); ++k) {
+        if (profile.stopCharger[k] >= 0) nodes.push_back(profile.stopCharger[k]);
+        nodes.push_back(tasks_[route[k]].sourceNode);
+        nodes.push_back(tasks_[route[k]].destinationNode);
+    }
+    return nodes;
+}
+
+void BatteryPlanner::CollectStops(RouteView route, int robot, const BatteryProfile& profile,
+                                  std::vector<ChargingStop>& stops) const {
+    int node = startNodes_[robot];
+    for (int k = 0; k < route.size(); ++k) {
+        const Task& task = tasks_[route[k]];
+        int charger = profile.stopCharger[k];
+        if (charger >= 0) {
+            double arrival = profile.energy[k] - costs_.GetCost(node, charger);
+            ChargingStop stop;
+            stop.robot = robot;
+            stop.position = k;
+            stop.fromNode = node;
+            stop.toNode = task.sourceNode;
+            stop.departure = profile.time[k];
+            stop.chargeTime = (capacity_ - std::max(0.0, arrival)) * BatteryModel::CHARGE_TIME_PER_UNIT;
+            stops.push_back(stop);
+        }
+        node = task.destinationNode;
+    }
+}
+
+int BatteryPlanner::CheapestCharger(int from, int to, float& detour) const {
+    int best = model_.chargerNodes.front();
+    detour = std::numeric_limits<float>::max();
+    for (int charger : model_.chargerNodes) {
+        float travel = costs_.GetCost(from, charger) + costs_.GetCost(charger, to);
+        if (travel < detour) {
+            detour = travel;
+            best = charger;
+        }
+    }
+    return best;
+}
+
+} // namespace Layer2
+} // namespace Backend
@@ -0,0 +1,156 @@
+/**
+ * @file ChargerAssignment.cc
+ * @brief Implementation of the charger matching
+ */
+
+#include "../include/ChargerAssignment.hh"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace Backend {
+namespace Layer2 {
+
+namespace {
+
+/// Stand-in for unreachable chargers, so the matching stays finite
+constexpr double UNREACHABLE_COST = 1e12;
+
+double finiteCost(double cost) {
+    return std::isfinite(cost) && cost < UNREACHABLE_COST ? cost : UNREACHABLE_COST;
+}
+
+} // namespace
+
+ChargerAssignment::ChargerAssignment(const std::vector<int>& chargerNodes, const CostMatrixProvider& costs)
+    : chargerNodes_(chargerNodes)
+    , costs_(costs) {}
+
+std::vector<ChargerSlot> ChargerAssignment::Assign(const std::vector<ChargingStop>& stops) const {
+    std::vector<ChargerSlot> slots(stops.size());
+    const size_t chargers = chargerNodes_.size();
+    if (chargers == 0) return slots;
+
+    std::vector<size_t> order(stops.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&stops](size_t a, size_t b) { return stops[a].departure < stops[b].departure; });
+
+    // Every stop of a round needs its own place in a charger's queue
+    const size_t roundLimit = std::min(MAX_ROUND_STOPS, chargers * MAX_QUEUE_PLACES);
+    std::vector<double> busyUntil(chargers, 0.0);
+    std::vector<std::vector<double>> cost;
+    std::vector<std::vector<double>> arrival;
+    for (size_t begin = 0; begin < order.size();) {
+        // A round: stops that would charge at the same time
+        const ChargingStop& first = stops[order[begin]];
+        size_t end = begin + 1;
+        while (end < order.size() && end - begin < roundLimit &&
+               stops[order[end]].departure <= first.departure + first.chargeTime) {
+            ++end;
+        }
+
+        // Column (charger, place in its queue): the q-th robot of the round
+        // at a charger waits for q charges on top of the earlier rounds
+        const size_t rows = end - begin;
+        const size_t places = std::min(rows, MAX_QUEUE_PLACES);
+        double roundCharge = 0.0;
+        for (size_t r = 0; r < rows; ++r) roundCharge += stops[order[begin + r]].chargeTime;
+        roundCharge /= rows;
+        cost.assign(rows, std::vector<double>(chargers * places));
+        arrival.assign(rows, std::vector<double>(chargers));
+        for (size_t r = 0; r < rows; ++r) {
+            const ChargingStop& stop = stops[order[begin + r]];
+            for (size_t c = 0; c < chargers; ++c) {
+                double toCharger = finiteCost(costs_.GetCost(stop.fromNode, chargerNodes_[c]));
+                double detour = toCharger + finiteCost(costs_.GetCost(chargerNodes_[c], stop.toNode));
+                arrival[r][c] = stop.departure + toCharger;
+                double queued = detour + std::max(0.0, busyUntil[c] - arrival[r][c]);
+                for (size_t q = 0; q < places; ++q) {
+                    cost[r][c * places + q] = queued + q * roundCharge;
+                }
+            }
+        }
+
+        // Robots then charge at their charger in order of arrival
+        std::vector<int> columns = SolveAssignment(cost);
+        std::vector<size_t> byArrival(rows);
+        std::iota(byArrival.begin(), byArrival.end(), 0);
+        std::sort(byArrival.begin(), byArrival.end(), [&](size_t a, size_t b) {
+            return arrival[a][columns[a] / places] < arrival[b][columns[b] / places];
+        });
+        for (size_t r : byArrival) {
+            const size_t c = static_cast<size_t>(columns[r]) / places;
+            const ChargingStop& stop = stops[order[begin + r]];
+            double wait = std::max(0.0, busyUntil[c] - arrival[r][c]);
+            slots[order[begin + r]] = {chargerNodes_[c], wait};
+            busyUntil[c] = arrival[r][c] + wait + stop.chargeTime;
+        }
+        begin = end;
+    }
+    return slots;
+}
+
+std::vector<int> ChargerAssignment::SolveAssignment(const std::vector<std::vector<double>>& cost) {
+    // Shortest augmenting paths with row / column potentials (1-based;
+    // column 0 is the virtual start of each augmentation)
+    const size_t n = cost.size();
+    const size_t m = n > 0 ? cost[0].size() : 0;
+    if (n > m) {
+        // Some row would never be placed: the augmentation would not end
+        throw std::invalid_argument("ChargerAssignment: more rows than columns to assign");
+    }
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> u(n + 1, 0.0), v(m + 1, 0.0), minv(m + 1);
+    std::vector<size_t> p(m + 1, 0), way(m + 1, 0);
+    std::vector<char> used(m + 1);
+    for (size_t i = 1; i <= n; ++i) {
+        p[0] = i;
+        size_t j0 = 0;
+        std::fill(minv.begin(), minv.end(), INF);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            used[j0] = 1;
+            const size_t i0 = p[j0];
+            double delta = INF;
+            size_t j1 = 0;
+            for (size_t j = 1; j <= m; ++j) {
+                if (used[j]) continue;
+                double reduced = cost[i0 - 1][j - 1] - u[i0] - v[j];
+                if (reduced < minv[j]) {
+                    minv[j] = reduced;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (size_t j = 0; j <= m; ++j) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do {
+            size_t j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    std::vector<int> column(n, -1);
+    for (size_t j = 1; j <= m; ++j) {
+        if (p[j] != 0) column[p[j] - 1] = static_cast<int>(j - 1);
+    }
+    return column;
+}
+
+} // namespace Layer2
+} // namespace Backend
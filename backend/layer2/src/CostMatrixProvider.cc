@@ -4,14 +4,68 @@
  */
 
 #include "../include/CostMatrixProvider.hh"
+#include "../../common/include/Trace.hh"
+#include "../../common/include/MemoryUsage.hh"
 #include <queue>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace Backend {
 namespace Layer2 {
 
+namespace {
+
+// Cost of edge from -> edge.targetNodeId with the overlay's traversal
+// penalties (see NavMesh::GetNodePenalties; null = none)
+inline float EdgeCost(const Common::Edge& edge, int from, const float* penalty) {
+    return penalty ? edge.cost + 0.5f * (penalty[from] + penalty[edge.targetNodeId]) : edge.cost;
+}
+
+// Sum of count float legs in double
+double SumLegs(const float* legs, size_t count) {
+    double total = 0.0;
+    size_t k = 0;
+#if defined(__SSE2__)
+    __m128d low = _mm_setzero_pd();
+    __m128d high = _mm_setzero_pd();
+    for (; k + 4 <= count; k += 4) {
+        __m128 four = _mm_loadu_ps(legs + k);
+        low = _mm_add_pd(low, _mm_cvtps_pd(four));
+        high = _mm_add_pd(high, _mm_cvtps_pd(_mm_movehl_ps(four, four)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(low, high));
+    total = lanes[0] + lanes[1];
+#endif
+    for (; k < count; ++k) total += legs[k];
+    return total;
+}
+
+// Re-allocate a used x used block of a capacity x capacity matrix at
+// newCapacity x newCapacity, copying it row by row
+template <typename T>
+void GrowMatrix(std::vector<T>& matrix, T unknown, int used, int capacity, int newCapacity) {
+    std::vector<T> grown(static_cast<size_t>(newCapacity) * newCapacity, unknown);
+    for (int row = 0; row < used; ++row) {
+        std::copy_n(matrix.begin() + static_cast<size_t>(row) * capacity, used,
+                    grown.begin() + static_cast<size_t>(row) * newCapacity);
+    }
+    matrix = std::move(grown);
+}
+
+} // namespace
+
 // =============================================================================
 // PRECOMPUTATION
 // =============================================================================
@@ -21,46 +75,156 @@ int CostMatrixProvider::PrecomputeForNodes(const std::vector<int>& nodeIds) {
     
     std::cout << "[CostMatrix] Precomputing costs for " << nodeIds.size() << " nodes..." << std::endl;
     
+    // Entries computed against an older overlay are not reused
+    if (IsStale() && !slotToNode_.empty()) {
+        Clear();
+    }
+    
     int totalPairs = 0;
+    meshVersion_ = navMesh_.GetChangeVersion();
     
-    // For each source node, run Dijkstra to get costs to all other nodes
-    for (int sourceId : nodeIds) {
-        auto distances = RunDijkstra(sourceId);
-        
-        // Store costs to all destination nodes
-        for (int targetId : nodeIds) {
-            if (sourceId == targetId) {
+    // Slots first, so the matrix grows at most once
+    const size_t n = nodeIds.size();
+    std::vector<int> slots(n);
+    for (size_t i = 0; i < n; ++i) {
+        slots[i] = EnsureSlot(nodeIds[i]);
+    }
+    
+    // Only entries not known yet (e.g. after LoadSnapshot) are searched:
+    // a row of a new node in full, a known row only for the new columns
+    std::vector<std::vector<int>> missingTargets(n);
+    std::vector<size_t> pendingRows;
+    for (size_t s = 0; s < n; ++s) {
+        if (slots[s] < 0) continue;
+        for (size_t i = 0; i < n; ++i) {
+            if (slots[i] < 0 || slots[i] == slots[s]) continue;
+            if (LoadEntry(static_cast<size_t>(slots[s]) * slotCapacity_ + slots[i]) == UNKNOWN_COST) {
+                missingTargets[s].push_back(nodeIds[i]);
+            }
+        }
+        if (!missingTargets[s].empty()) pendingRows.push_back(s);
+    }
+    
+    // One search per pending row, spread across workers
+    std::vector<int> rowSources;
+    std::vector<const std::vector<int>*> rowTargets;
+    for (size_t row : pendingRows) {
+        rowSources.push_back(nodeIds[row]);
+        rowTargets.push_back(&missingTargets[row]);
+    }
+    std::vector<std::vector<float>> rowCosts;
+    std::vector<std::vector<uint64_t>> rowRegions;
+    SearchRows(rowSources, rowTargets, rowCosts, rowRegions);
+    
+    // Store the new entries (unreachable pairs as INFINITY_COST)
+    for (size_t k = 0; k < pendingRows.size(); ++k) {
+        size_t row = pendingRows[k];
+        for (size_t i = 0; i < missingTargets[row].size(); ++i) {
+            SetEntry(slots[row], GetSlot(missingTargets[row][i]), rowCosts[k][i]);
+        }
+        uint64_t* regions = RowRegions(slots[row]);
+        for (int w = 0; w < regionWords_; ++w) regions[w] |= rowRegions[k][w];
+    }
+    
+    // Count reachable pairs over the whole requested set
+    for (size_t s = 0; s < n; ++s) {
+        for (size_t i = 0; i < n; ++i) {
+            if (nodeIds[s] == nodeIds[i]) {
                 // Same node = zero cost
-                costMatrix_[{sourceId, targetId}] = 0.0f;
+                if (slots[s] >= 0) SetEntry(slots[s], slots[i], 0.0f);
                 totalPairs++;
-            } else if (distances.count(targetId)) {
-                costMatrix_[{sourceId, targetId}] = distances[targetId];
+            } else if (slots[s] >= 0 && slots[i] >= 0 &&
+                       LoadEntry(static_cast<size_t>(slots[s]) * slotCapacity_ + slots[i]) < INFINITY_COST) {
                 totalPairs++;
-            } else {
-                // No path exists
-                costMatrix_[{sourceId, targetId}] = INFINITY_COST;
             }
         }
     }
     
+    if (n > 1 && pendingRows.size() < n) {
+        std::cout << "[CostMatrix] Reused known costs, searched " << pendingRows.size()
+                  << " of " << n << " rows" << std::endl;
+    }
+    
     std::cout << "[CostMatrix] Precomputed " << totalPairs << " node pairs" << std::endl;
     
     return totalPairs;
 }
 
+void CostMatrixProvider::SearchRows(const std::vector<int>& sourceIds,
+                                    const std::vector<const std::vector<int>*>& targets,
+                                    std::vector<std::vector<float>>& costsOut,
+                                    std::vector<std::vector<uint64_t>>& regionsOut) const {
+    const size_t rows = sourceIds.size();
+    costsOut.assign(rows, {});
+    regionsOut.assign(rows, {});
+    if (rows == 0) return;
+    
+    // One search per row (one per BFS_BATCH rows on unit-cost meshes).
+    // Each worker owns a workspace and writes only its own rows.
+    const float edgeCost = UniformEdgeCost();
+    const size_t batch = BatchSize(edgeCost, rows);
+    const size_t batches = (rows + batch - 1) / batch;
+    int numThreads = std::max(1, std::min(WorkerCount(), static_cast<int>(batches)));
+    
+    std::atomic<size_t> nextBatch{0};
+    auto worker = [&]() {
+        DijkstraWorkspace ws;
+        BfsWorkspace bfs;
+        std::vector<int> sources;
+        std::vector<const std::vector<int>*> batchTargets;
+        std::vector<float*> batchCosts;
+        std::vector<uint64_t*> batchRegions;
+        for (size_t b = nextBatch++; b < batches; b = nextBatch++) {
+            sources.clear();
+            batchTargets.clear();
+            batchCosts.clear();
+            batchRegions.clear();
+            for (size_t row = b * batch; row < std::min(rows, (b + 1) * batch); ++row) {
+                costsOut[row].resize(targets[row]->size());
+                regionsOut[row].assign(regionWords_, 0);
+                sources.push_back(sourceIds[row]);
+                batchTargets.push_back(targets[row]);
+                batchCosts.push_back(costsOut[row].data());
+                batchRegions.push_back(regionsOut[row].data());
+            }
+            if (edgeCost > 0.0f) {
+                RunBitParallelBFS(sources, batchTargets, edgeCost, bfs, batchCosts, batchRegions);
+            } else {
+                ComputeCostsFrom(sources[0], *batchTargets[0], ws, batchCosts[0], batchRegions[0]);
+            }
+        }
+    };
+    
+    RunWorkers(numThreads, worker);
+}
+
 int CostMatrixProvider::AddRowForNode(int fromNodeId, const std::vector<int>& toNodeIds) {
     if (toNodeIds.empty()) return 0;
     
-    // Run Dijkstra from this node
-    auto distances = RunDijkstra(fromNodeId);
+    // The first row sets the version; later rows must not hide that
+    // older rows are stale
+    if (slotToNode_.empty()) meshVersion_ = navMesh_.GetChangeVersion();
+    
+    int fromSlot = EnsureSlot(fromNodeId);
+    
+    // One search from this node
+    std::vector<float> costs(toNodeIds.size(), INFINITY_COST);
+    std::vector<uint64_t> regions(regionWords_, 0);
+    DijkstraWorkspace ws;
+    ComputeCostsFrom(fromNodeId, toNodeIds, ws, costs.data(), regions.data());
+    if (fromSlot >= 0) {
+        uint64_t* rowRegions = RowRegions(fromSlot);
+        for (int w = 0; w < regionWords_; ++w) rowRegions[w] |= regions[w];
+    }
     
     int added = 0;
-    for (int targetId : toNodeIds) {
+    for (size_t i = 0; i < toNodeIds.size(); ++i) {
+        int targetId = toNodeIds[i];
         if (fromNodeId == targetId) {
-            costMatrix_[{fromNodeId, targetId}] = 0.0f;
+            SetEntry(fromSlot, EnsureSlot(targetId), 0.0f);
             added++;
-        } else if (distances.count(targetId)) {
-            costMatrix_[{fromNodeId, targetId}] = distances[targetId];
+        } else if (costs[i] < INFINITY_COST) {
+            SetEntry(fromSlot, EnsureSlot(targetId), costs[i]);
             added++;
         }
     }
@@ -68,24 +232,1029 @@ int CostMatrixProvider::AddRowForNode(int fromNodeId, const std::vector<int>& to
     return added;
 }
 
+int CostMatrixProvider::PrecomputeStartRows(const std::vector<int>& sourceIds, const std::vector<int>& targetIds) {
+    const uint64_t version = navMesh_.GetChangeVersion();
+    const int width = static_cast<int>(slotToNode_.size());
+    const bool reusable = startRowsVersion_ == version && startRowWidth_ == width;
+    
+    std::vector<int> targetSlots;
+    for (int target : targetIds) {
+        int slot = GetSlot(target);
+        if (slot >= 0) targetSlots.push_back(slot);
+    }
+    std::sort(targetSlots.begin(), targetSlots.end());
+    targetSlots.erase(std::unique(targetSlots.begin(), targetSlots.end()), targetSlots.end());
+    
+    // New table: one row per distinct source without a slot, starting from
+    // the entries the previous table had for it
+    const int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
+    std::vector<int> rowOf(numNodes, -1);
+    std::vector<int> rowNodes;
+    for (int source : sourceIds) {
+        if (source < 0 || source >= numNodes || GetSlot(source) >= 0 || rowOf[source] >= 0) continue;
+        rowOf[source] = static_cast<int>(rowNodes.size());
+        rowNodes.push_back(source);
+    }
+    std::vector<float> costs(rowNodes.size() * static_cast<size_t>(width), UNKNOWN_COST);
+    if (reusable) {
+        for (size_t row = 0; row < rowNodes.size(); ++row) {
+            int old = rowNodes[row] < static_cast<int>(startRowOf_.size()) ? startRowOf_[rowNodes[row]] : -1;
+            if (old < 0) continue;
+            std::copy_n(startCosts_.begin() + static_cast<size_t>(old) * width, width,
+                        costs.begin() + row * width);
+        }
+    }
+    
+    // Search only the entries not known yet
+    std::vector<size_t> pendingRows;
+    std::vector<std::vector<int>> missingTargets(rowNodes.size());
+    std::vector<std::vector<int>> missingSlots(rowNodes.size());
+    for (size_t row = 0; row < rowNodes.size(); ++row) {
+        const float* known = costs.data() + row * width;
+        for (int slot : targetSlots) {
+            if (known[slot] != UNKNOWN_COST) continue;
+            missingTargets[row].push_back(slotToNode_[slot]);
+            missingSlots[row].push_back(slot);
+        }
+        if (!missingTargets[row].empty()) pendingRows.push_back(row);
+    }
+    
+    std::vector<int> rowSources;
+    std::vector<const std::vector<int>*> rowTargets;
+    for (size_t row : pendingRows) {
+        rowSources.push_back(rowNodes[row]);
+        rowTargets.push_back(&missingTargets[row]);
+    }
+    std::vector<std::vector<float>> rowCosts;
+    std::vector<std::vector<uint64_t>> rowRegions;
+    SearchRows(rowSources, rowTargets, rowCosts, rowRegions);
+    for (size_t k = 0; k < pendingRows.size(); ++k) {
+        float* out = costs.data() + pendingRows[k] * width;
+        for (size_t i = 0; i < missingSlots[pendingRows[k]].size(); ++i) {
+            out[missingSlots[pendingRows[k]][i]] = rowCosts[k][i];
+        }
+    }
+    
+    startRowOf_ = std::move(rowOf);
+    startRowNodes_ = std::move(rowNodes);
+    startCosts_ = std::move(costs);
+    startRowWidth_ = width;
+    startRowsVersion_ = version;
+    return static_cast<int>(pendingRows.size());
+}
+
+void CostMatrixProvider::ClearStartRows() {
+    startRowOf_.clear();
+    startRowNodes_.clear();
+    startCosts_.clear();
+    startRowWidth_ = 0;
+}
+
 // =============================================================================
-// QUERIES
+// INCREMENTAL INVALIDATION
+// =============================================================================
+
+void CostMatrixProvider::EnsureRegionGrid() {
+    const auto& allNodes = navMesh_.GetAllNodes();
+    int numNodes = static_cast<int>(allNodes.size());
+    if (regionWords_ > 0 && regionNodeCount_ == numNodes) return;
+    
+    int minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for (int id = 0; id < numNodes; ++id) {
+        const auto& c = allNodes[id].coords;
+        if (id == 0 || c.x < minX) minX = c.x;
+        if (id == 0 || c.y < minY) minY = c.y;
+        if (id == 0 || c.x > maxX) maxX = c.x;
+        if (id == 0 || c.y > maxY) maxY = c.y;
+    }
+    regionOriginX_ = minX;
+    regionOriginY_ = minY;
+    regionCols_ = (maxX - minX) / INVALIDATION_REGION_PIXELS + 1;
+    regionRows_ = (maxY - minY) / INVALIDATION_REGION_PIXELS + 1;
+    regionWords_ = (regionCols_ * regionRows_ + 63) / 64;
+    regionNodeCount_ = numNodes;
+    
+    // Existing rows were tracked on another grid: depend on everything
+    rowRegions_.assign(slotToNode_.size() * regionWords_, ~uint64_t(0));
+}
+
+int CostMatrixProvider::RegionOf(int nodeId) const {
+    const auto& c = navMesh_.GetAllNodes()[nodeId].coords;
+    int col = std::clamp((c.x - regionOriginX_) / INVALIDATION_REGION_PIXELS, 0, regionCols_ - 1);
+    int row = std::clamp((c.y - regionOriginY_) / INVALIDATION_REGION_PIXELS, 0, regionRows_ - 1);
+    return row * regionCols_ + col;
+}
+
+std::vector<int> CostMatrixProvider::FindAffectedRows() const {
+    std::vector<int> affected;
+    int slotCount = static_cast<int>(slotToNode_.size());
+    if (slotCount == 0 || !IsStale()) return affected;
+    
+    // Nodes whose blocked state changed since the matrix version
+    const int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
+    if (numNodes != regionNodeCount_) {
+        // Mesh topology changed: nothing can be trusted
+        for (int slot = 0; slot < slotCount; ++slot) affected.push_back(slot);
+        return affected;
+    }
+    
+    // A changed node with a traversal penalty may have become dearer
+    // (like blocked), and any unblocked one cheaper (like freed)
+    std::vector<uint64_t> blockedRegions(regionWords_, 0);
+    bool anyBlocked = false;
+    std::vector<int> freedNodes;
+    for (int id = 0; id < numNodes; ++id) {
+        if (navMesh_.GetNodeChangeVersion(id) <= meshVersion_) continue;
+        bool blocked = navMesh_.IsNodeBlocked(id);
+        if (blocked || navMesh_.GetNodePenalty(id) > 0.0f) {
+            int region = RegionOf(id);
+            blockedRegions[region >> 6] |= uint64_t(1) << (region & 63);
+            anyBlocked = true;
+        }
+        if (!blocked) {
+            freedNodes.push_back(id);
+        }
+    }
+    
+    for (int slot = 0; slot < slotCount; ++slot) {
+        bool hit = false;
+        
+        // Newly blocked (or penalised): only rows whose paths cross its region
+        if (anyBlocked) {
+            const uint64_t* regions = rowRegions_.data() + static_cast<size_t>(slot) * regionWords_;
+            for (int w = 0; w < regionWords_ && !hit; ++w) {
+                hit = (regions[w] & blockedRegions[w]) != 0;
+            }
+        }
+        
+        // Newly freed: only rows where a detour through the node could beat
+        // a known cost (lower bounds, with slack for float rounding)
+        int source = slotToNode_[slot];
+        const size_t rowStart = static_cast<size_t>(slot) * slotCapacity_;
+        for (size_t f = 0; f < freedNodes.size() && !hit; ++f) {
+            int u = freedNodes[f];
+            float toFreed = LowerBound(source, u);
+            for (int col = 0; col < slotCount && !hit; ++col) {
+                float cost = LoadEntry(rowStart + col);
+                if (cost == UNKNOWN_COST || col == slot) continue;
+                float bound = toFreed + LowerBound(u, slotToNode_[col]);
+                hit = bound * (1.0f - 1e-5f) < cost;
+            }
+        }
+        
+        if (hit) affected.push_back(slot);
+    }
+    return affected;
+}
+
+CostMatrixProvider::RowRefresh CostMatrixProvider::PrepareRefresh() const {
+    RowRefresh refresh;
+    refresh.baseVersion = meshVersion_;
+    refresh.meshVersion = navMesh_.GetChangeVersion();
+    refresh.layoutGeneration = layoutGeneration_;
+    refresh.slotCount = static_cast<int>(slotToNode_.size());
+    refresh.slots = FindAffectedRows();
+    
+    const size_t rows = refresh.slots.size();
+    const size_t cols = static_cast<size_t>(refresh.slotCount);
+    refresh.costs.assign(rows * cols, UNKNOWN_COST);
+    refresh.regions.assign(rows * regionWords_, 0);
+    if (rows == 0) return refresh;
+    
+    // Recompute the known entries of each affected row, rows (or BFS
+    // batches of rows) spread across cores as in PrecomputeForNodes
+    const float edgeCost = UniformEdgeCost();
+    const size_t batch = BatchSize(edgeCost, rows);
+    const size_t batches = (rows + batch - 1) / batch;
+    int numThreads = std::max(1, std::min(WorkerCount(), static_cast<int>(batches)));
+    
+    std::atomic<size_t> nextBatch{0};
+    auto worker = [&]() {
+        DijkstraWorkspace ws;
+        BfsWorkspace bfs;
+        std::vector<std::vector<int>> targets(batch);
+        std::vector<std::vector<int>> targetCols(batch);
+        std::vector<std::vector<float>> costs(batch);
+        std::vector<int> sources;
+        std::vector<const std::vector<int>*> targetLists;
+        std::vector<float*> costsOut;
+        std::vector<uint64_t*> regionsOut;
+        for (size_t b = nextBatch++; b < batches; b = nextBatch++) {
+            const size_t first = b * batch;
+            const size_t last = std::min(rows, first + batch);
+            sources.clear();
+            targetLists.clear();
+            costsOut.clear();
+            regionsOut.clear();
+            for (size_t k = first; k < last; ++k) {
+                int slot = refresh.slots[k];
+                const size_t rowStart = static_cast<size_t>(slot) * slotCapacity_;
+                std::vector<int>& rowTargets = targets[k - first];
+                rowTargets.clear();
+                targetCols[k - first].clear();
+                for (size_t col = 0; col < cols; ++col) {
+                    if (LoadEntry(rowStart + col) == UNKNOWN_COST) continue;
+                    rowTargets.push_back(slotToNode_[col]);
+                    targetCols[k - first].push_back(static_cast<int>(col));
+                }
+                costs[k - first].assign(rowTargets.size(), INFINITY_COST);
+                
+                sources.push_back(slotToNode_[slot]);
+                targetLists.push_back(&rowTargets);
+                costsOut.push_back(costs[k - first].data());
+                regionsOut.push_back(refresh.regions.data() + k * regionWords_);
+            }
+            
+            if (edgeCost > 0.0f) {
+                RunBitParallelBFS(sources, targetLists, edgeCost, bfs, costsOut, regionsOut);
+            } else {
+                ComputeCostsFrom(sources[0], *targetLists[0], ws, costsOut[0], regionsOut[0]);
+            }
+            
+            for (size_t k = first; k < last; ++k) {
+                int slot = refresh.slots[k];
+                const std::vector<int>& rowCols = targetCols[k - first];
+                float* out = refresh.costs.data() + k * cols;
+                for (size_t i = 0; i < rowCols.size(); ++i) {
+                    out[rowCols[i]] = (rowCols[i] == slot) ? 0.0f : costs[k - first][i];
+                }
+            }
+        }
+    };
+    
+    RunWorkers(numThreads, worker);
+    
+    return refresh;
+}
+
+bool CostMatrixProvider::CommitRefresh(const RowRefresh& refresh) {
+    // Judged against another matrix state: discard
+    if (refresh.baseVersion != meshVersion_ ||
+        refresh.layoutGeneration != layoutGeneration_ ||
+        refresh.slotCount > static_cast<int>(slotToNode_.size())) {
+        return false;
+    }
+    
+    const size_t cols = static_cast<size_t>(refresh.slotCount);
+    for (size_t k = 0; k < refresh.slots.size(); ++k) {
+        int slot = refresh.slots[k];
+        const float* costs = refresh.costs.data() + k * cols;
+        for (size_t col = 0; col < cols; ++col) {
+            if (costs[col] != UNKNOWN_COST) SetEntry(slot, static_cast<int>(col), costs[col]);
+        }
+        std::copy_n(refresh.regions.data() + k * regionWords_, regionWords_, RowRegions(slot));
+    }
+    meshVersion_ = refresh.meshVersion;
+    return true;
+}
+
+int CostMatrixProvider::RefreshStaleRows() {
+    RowRefresh refresh = PrepareRefresh();
+    if (!CommitRefresh(refresh)) return -1;
+    return static_cast<int>(refresh.slots.size());
+}
+
+// =============================================================================
+// SNAPSHOTS
+// =============================================================================
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'A', 'M', 'R', 'L', '2', 'C', 'M', 'X'};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t fingerprint;
+    uint64_t slotCount;
+};
+
+// FNV-1a, 64 bit
+class Fnv1a {
+private:
+    uint64_t hash = 14695981039346656037ull;
+
+public:
+    void Update(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+    template <typename T>
+    void Update(const T& value) { Update(&value, sizeof(T)); }
+    uint64_t Value() const { return hash; }
+};
+
+} // namespace
+
+uint64_t CostMatrixProvider::ComputeMeshFingerprint(const Backend::Layer1::NavMesh& mesh) {
+    Fnv1a fnv;
+    fnv.Update(SNAPSHOT_FORMAT_VERSION);
+    
+    const auto& nodes = mesh.GetAllNodes();
+    uint64_t nodeCount = nodes.size();
+    fnv.Update(nodeCount);
+    for (size_t id = 0; id < nodes.size(); ++id) {
+        int32_t coords[2] = {nodes[id].coords.x, nodes[id].coords.y};
+        fnv.Update(coords, sizeof(coords));
+        
+        // Costs are computed around blocked nodes, so they are part of the key
+        char blocked = mesh.IsNodeBlocked(static_cast<int>(id)) ? 1 : 0;
+        fnv.Update(blocked);
+        
+        // As are penalties (left out while there are none, so snapshots
+        // of penalty-free meshes keep their keys)
+        if (mesh.GetNodePenalties()) {
+            float penalty = mesh.GetNodePenalty(static_cast<int>(id));
+            fnv.Update(penalty);
+        }
+        
+        const auto& neighbors = mesh.GetNeighbors(static_cast<int>(id));
+        uint32_t degree = static_cast<uint32_t>(neighbors.size());
+        fnv.Update(degree);
+        for (const auto& edge : neighbors) {
+            int32_t target = edge.targetNodeId;
+            float cost = edge.cost;
+            fnv.Update(target);
+            fnv.Update(cost);
+        }
+    }
+    return fnv.Value();
+}
+
+bool CostMatrixProvider::SaveSnapshot(const std::string& path, uint64_t fingerprint) const {
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_FORMAT_VERSION;
+    header.fingerprint = fingerprint;
+    header.slotCount = slotToNode_.size();
+    
+    std::error_code ec;
+    const std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+    
+    // Write next to the target and rename, so a crash never leaves a
+    // truncated snapshot behind
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "[CostMatrix] Failed to open for writing: " << tmpPath << std::endl;
+            return false;
+        }
+        
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::vector<int32_t> nodes(slotToNode_.begin(), slotToNode_.end());
+        file.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(int32_t));
+        
+        // Used block only, row by row as float whatever the storage
+        // (UNKNOWN_COST marks missing entries)
+        std::vector<float> rowCosts(slotToNode_.size());
+        for (size_t row = 0; row < slotToNode_.size(); ++row) {
+            for (size_t col = 0; col < rowCosts.size(); ++col) {
+                rowCosts[col] = LoadEntry(row * slotCapacity_ + col);
+            }
+            file.write(reinterpret_cast<const char*>(rowCosts.data()), rowCosts.size() * sizeof(float));
+        }
+        
+        if (!file.good()) {
+            std::cerr << "[CostMatrix] Snapshot write failed: " << tmpPath << std::endl;
+            file.close();
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "[CostMatrix] Failed to move snapshot into place: " << path << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    
+    std::cout << "[CostMatrix] Wrote snapshot (" << slotToNode_.size() << " nodes) to " << path << std::endl;
+    return true;
+}
+
+bool CostMatrixProvider::LoadSnapshot(const std::string& path, uint64_t fingerprint) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    
+    SnapshotHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header.version != SNAPSHOT_FORMAT_VERSION ||
+        header.fingerprint != fingerprint) {
+        return false;
+    }
+    
+    const uint64_t numNodes = navMesh_.GetAllNodes().size();
+    if (header.slotCount > numNodes) return false;
+    const size_t count = static_cast<size_t>(header.slotCount);
+    
+    std::vector<int32_t> nodes(count);
+    std::vector<float> costs(count * count);
+    if (!file.read(reinterpret_cast<char*>(nodes.data()), count * sizeof(int32_t)) ||
+        !file.read(reinterpret_cast<char*>(costs.data()), costs.size() * sizeof(float))) {
+        return false;
+    }
+    for (int32_t node : nodes) {
+        if (node < 0 || static_cast<uint64_t>(node) >= numNodes) return false;
+    }
+    
+    Clear();
+    meshVersion_ = navMesh_.GetChangeVersion();
+    std::vector<int> slots(count);
+    for (size_t i = 0; i < count; ++i) {
+        slots[i] = EnsureSlot(nodes[i]);
+    }
+    for (size_t row = 0; row < count; ++row) {
+        for (size_t col = 0; col < count; ++col) {
+            float cost = costs[row * count + col];
+            if (cost != UNKNOWN_COST) SetEntry(slots[row], slots[col], cost);
+        }
+        // Paths are not stored: any change may affect a restored row
+        std::fill_n(RowRegions(slots[row]), regionWords_, ~uint64_t(0));
+    }
+    
+    std::cout << "[CostMatrix] Loaded snapshot (" << count << " nodes, "
+              << computedPairs_ << " pairs) from " << path << std::endl;
+    return true;
+}
+
+bool CostMatrixProvider::CopyFrom(const CostMatrixProvider& other) {
+    if (other.navMesh_.GetAllNodes().size() != navMesh_.GetAllNodes().size()) return false;
+    
+    Clear();
+    nodeToSlot_ = other.nodeToSlot_;
+    slotToNode_ = other.slotToNode_;
+    costMatrix_ = other.costMatrix_;
+    quantizedMatrix_ = other.quantizedMatrix_;
+    storage_ = other.storage_;
+    quantStep_ = other.quantStep_;
+    slotCapacity_ = other.slotCapacity_;
+    computedPairs_ = other.computedPairs_;
+    meshVersion_ = other.meshVersion_;
+    
+    landmarkNodes_ = other.landmarkNodes_;
+    landmarkDist_ = other.landmarkDist_;
+    landmarkNodeCount_ = other.landmarkNodeCount_;
+    
+    regionOriginX_ = other.regionOriginX_;
+    regionOriginY_ = other.regionOriginY_;
+    regionCols_ = other.regionCols_;
+    regionRows_ = other.regionRows_;
+    regionWords_ = other.regionWords_;
+    regionNodeCount_ = other.regionNodeCount_;
+    rowRegions_ = other.rowRegions_;
+    return true;
+}
+
+// =============================================================================
+// DENSE STORAGE
+// =============================================================================
+
+int CostMatrixProvider::EnsureSlot(int nodeId) {
+    int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
+    if (nodeId < 0 || nodeId >= numNodes) return -1;
+    
+    EnsureRegionGrid();
+    if (static_cast<int>(nodeToSlot_.size()) < numNodes) {
+        nodeToSlot_.resize(numNodes, -1);
+    }
+    if (nodeToSlot_[nodeId] >= 0) return nodeToSlot_[nodeId];
+    
+    int slot = static_cast<int>(slotToNode_.size());
+    if (slot == 0 && storage_ == CostStorage::QUANTIZED16) {
+        quantStep_ = ComputeQuantStep();
+    }
+    if (slot >= slotCapacity_) {
+        // Double the capacity, copying the used block row by row
+        int newCapacity = std::max(16, slotCapacity_ * 2);
+        if (storage_ == CostStorage::QUANTIZED16) {
+            GrowMatrix(quantizedMatrix_, QUANT_UNKNOWN, slot, slotCapacity_, newCapacity);
+        } else {
+            GrowMatrix(costMatrix_, UNKNOWN_COST, slot, slotCapacity_, newCapacity);
+        }
+        slotCapacity_ = newCapacity;
+    }
+    
+    nodeToSlot_[nodeId] = slot;
+    slotToNode_.push_back(nodeId);
+    rowRegions_.resize(slotToNode_.size() * regionWords_, 0);
+    return slot;
+}
+
+void CostMatrixProvider::SetEntry(int fromSlot, int toSlot, float cost) {
+    if (fromSlot < 0 || toSlot < 0) return;
+    const size_t index = static_cast<size_t>(fromSlot) * slotCapacity_ + toSlot;
+    if (storage_ == CostStorage::FLOAT32) {
+        float& entry = costMatrix_[index];
+        if (entry == UNKNOWN_COST) computedPairs_++;
+        entry = cost;
+        return;
+    }
+    
+    // Costs beyond the code range stay unknown (answered on demand)
+    uint16_t code = QUANT_UNKNOWN;
+    if (cost >= INFINITY_COST) {
+        code = QUANT_INFINITY;
+    } else if (cost >= 0.0f && cost / quantStep_ < QUANT_MAX_CODE + 0.5f) {
+        code = static_cast<uint16_t>(std::lround(cost / quantStep_));
+    }
+    uint16_t& entry = quantizedMatrix_[index];
+    if (entry == QUANT_UNKNOWN && code != QUANT_UNKNOWN) computedPairs_++;
+    if (entry != QUANT_UNKNOWN && code == QUANT_UNKNOWN) computedPairs_--;
+    entry = code;
+}
+
+void CostMatrixProvider::SetStorage(CostStorage storage) {
+    if (storage == storage_) return;
+    Clear();
+    storage_ = storage;
+}
+
+float CostMatrixProvider::ComputeQuantStep() const {
+    // Bounding-box extent in cost units: no shortest path on the mesh is
+    // longer than the box's Manhattan extent times a detour factor (the
+    // exception, behind penalties and blockages, is answered on demand)
+    const auto& nodes = navMesh_.GetAllNodes();
+    if (nodes.empty()) return 1.0f;
+    int minX = nodes[0].coords.x, maxX = minX;
+    int minY = nodes[0].coords.y, maxY = minY;
+    double costPerPixel = 1.0;
+    for (size_t v = 0; v < nodes.size(); ++v) {
+        const auto& coords = nodes[v].coords;
+        minX = std::min(minX, coords.x);
+        maxX = std::max(maxX, coords.x);
+        minY = std::min(minY, coords.y);
+        maxY = std::max(maxY, coords.y);
+        for (const auto& edge : navMesh_.GetNeighbors(static_cast<int>(v))) {
+            const auto& target = nodes[edge.targetNodeId].coords;
+            double length = std::hypot(target.x - coords.x, target.y - coords.y);
+            if (length > 0.0) costPerPixel = std::max(costPerPixel, edge.cost / length);
+        }
+    }
+    double range = (static_cast<double>(maxX - minX) + (maxY - minY)) * costPerPixel * QUANT_DETOUR_FACTOR;
+    return static_cast<float>(std::max(range, 1.0) / QUANT_MAX_CODE);
+}
+
+void CostMatrixProvider::Clear() {
+    nodeToSlot_.clear();
+    slotToNode_.clear();
+    costMatrix_.clear();
+    quantizedMatrix_.clear();
+    slotCapacity_ = 0;
+    computedPairs_ = 0;
+    rowRegions_.clear();
+    layoutGeneration_++;
+    fallbackCache_.Clear();
+    ClearStartRows();
+}
+
+int CostMatrixProvider::WorkerCount() const {
+    if (scheduler_) return static_cast<int>(scheduler_->GetThreadCount()) + 1;
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+void CostMatrixProvider::RunWorkers(int threads, const std::function<void()>& worker) const {
+    if (scheduler_) {
+        scheduler_->ParallelFor(static_cast<size_t>(threads), [&worker](size_t) { worker(); });
+        return;
+    }
+    std::vector<std::thread> helpers;
+    for (int t = 1; t < threads; ++t) {
+        helpers.emplace_back(worker);
+    }
+    worker();
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+}
+
+void CostMatrixProvider::ComputeCostsFrom(int sourceId, const std::vector<int>& targetIds,
+                                          DijkstraWorkspace& ws, float* costsOut,
+                                          uint64_t* regionsOut) const {
+    if (hierarchy_) {
+        std::vector<float> costs = hierarchy_->GetCostsFrom(sourceId, targetIds);
+        std::copy(costs.begin(), costs.end(), costsOut);
+        // No paths to record: depend on everything
+        if (regionsOut) std::fill(regionsOut, regionsOut + regionWords_, ~uint64_t(0));
+        return;
+    }
+    // A few targets: goal-directed searches settle far fewer nodes than
+    // growing one Dijkstra ball out to the farthest target
+    if (HasLandmarks() && targetIds.size() <= LANDMARK_ROW_MAX_TARGETS) {
+        for (size_t i = 0; i < targetIds.size(); ++i) {
+            costsOut[i] = RunAStar(sourceId, targetIds[i]);
+        }
+        if (regionsOut) std::fill(regionsOut, regionsOut + regionWords_, ~uint64_t(0));
+        return;
+    }
+    RunDijkstraToTargets(sourceId, targetIds, ws, costsOut, regionsOut);
+}
+
+// =============================================================================
+// EARLY-EXIT DIJKSTRA
+// =============================================================================
+
+void CostMatrixProvider::DijkstraWorkspace::Begin(int numNodes) {
+    if (static_cast<int>(dist.size()) != numNodes) {
+        dist.assign(numNodes, INFINITY_COST);
+        stamp.assign(numNodes, 0);
+        settledStamp.assign(numNodes, 0);
+        targetStamp.assign(numNodes, 0);
+        pathStamp.assign(numNodes, 0);
+        parent.assign(numNodes, -1);
+        generation = 0;
+    }
+    
+    // Stamps start at 0, so generation 0 is never used; on wrap-around
+    // clear them once
+    if (++generation == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        std::fill(settledStamp.begin(), settledStamp.end(), 0);
+        std::fill(targetStamp.begin(), targetStamp.end(), 0);
+        std::fill(pathStamp.begin(), pathStamp.end(), 0);
+        generation = 1;
+    }
+}
+
+void CostMatrixProvider::RunDijkstraToTargets(int sourceId, const std::vector<int>& targetIds,
+                                              DijkstraWorkspace& ws, float* costsOut,
+                                              uint64_t* regionsOut) const {
+    const int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
+    std::fill(costsOut, costsOut + targetIds.size(), INFINITY_COST);
+    if (sourceId < 0 || sourceId >= numNodes) return;
+    
+    ws.Begin(numNodes);
+    const uint32_t gen = ws.generation;
+    
+    // Distinct reachable targets still to settle: the search would settle
+    // the whole component before giving up on the others
+    const auto components = GetComponents();
+    int pending = 0;
+    for (int t : targetIds) {
+        if (t >= 0 && t < numNodes && ws.targetStamp[t] != gen &&
+            IsReachable(*components, sourceId, t)) {
+            ws.targetStamp[t] = gen;
+            ++pending;
+        }
+    }
+    
+    const float* penalty = navMesh_.GetNodePenalties();
+    ws.open.Reset(QueueUnit(penalty), costUnitMaxSteps_);
+    ws.dist[sourceId] = 0.0f;
+    ws.stamp[sourceId] = gen;
+    ws.parent[sourceId] = -1;
+    ws.open.Push(0.0f, sourceId);
+    
+    while (!ws.open.Empty() && pending > 0) {
+        float d;
+        int u = ws.open.Pop(d);
+        
+        if (ws.settledStamp[u] == gen) continue;
+        ws.settledStamp[u] = gen;
+        if (ws.targetStamp[u] == gen) --pending;
+        
+        for (const auto& edge : navMesh_.GetNeighbors(u)) {
+            int v = edge.targetNodeId;
+            if (navMesh_.IsNodeBlocked(v)) continue;
+            float newDist = d + EdgeCost(edge, u, penalty);
+            
+            if (ws.stamp[v] != gen || newDist < ws.dist[v]) {
+                ws.dist[v] = newDist;
+                ws.stamp[v] = gen;
+                ws.parent[v] = u;
+                ws.open.Push(newDist, v);
+            }
+        }
+    }
+    
+    // Settled targets have their final distance
+    for (size_t i = 0; i < targetIds.size(); ++i) {
+        int t = targetIds[i];
+        if (t >= 0 && t < numNodes && ws.settledStamp[t] == gen) {
+            costsOut[i] = ws.dist[t];
+        }
+    }
+    
+    // Regions crossed by the paths to the targets (each tree node once)
+    if (regionsOut) {
+        for (int t : targetIds) {
+            if (t < 0 || t >= numNodes || ws.settledStamp[t] != gen) continue;
+            for (int v = t; v >= 0 && ws.pathStamp[v] != gen; v = ws.parent[v]) {
+                ws.pathStamp[v] = gen;
+                int region = RegionOf(v);
+                regionsOut[region >> 6] |= uint64_t(1) << (region & 63);
+            }
+        }
+    }
+}
+
+// =============================================================================
+// BIT-PARALLEL BFS (UNIT-COST MESHES)
 // =============================================================================
 
-float CostMatrixProvider::GetCost(int fromNodeId, int toNodeId) const {
-    if (fromNodeId == toNodeId) return 0.0f;
+float CostMatrixProvider::UniformEdgeCost() const {
+    if (hierarchy_ || navMesh_.GetNodePenalties()) return 0.0f;
     
-    auto it = costMatrix_.find({fromNodeId, toNodeId});
-    if (it != costMatrix_.end()) {
-        return it->second;
+    float cost = 0.0f;
+    const int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
+    for (int u = 0; u < numNodes; ++u) {
+        for (const auto& edge : navMesh_.GetNeighbors(u)) {
+            if (cost == 0.0f) cost = edge.cost;
+            if (edge.cost != cost || cost <= 0.0f) return 0.0f;
+        }
+    }
+    return cost;
+}
+
+size_t CostMatrixProvider::BatchSize(float edgeCost, size_t rows) {
+    if (edgeCost <= 0.0f) return 1;
+    // Every core gets a batch before batches grow past one per core
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    return std::clamp<size_t>((rows + cores - 1) / cores, 1, BFS_BATCH);
+}
+
+void CostMatrixProvider::BfsWorkspace::Begin(const Backend::Layer1::NavMesh& mesh) {
+    const int numNodes = static_cast<int>(mesh.GetAllNodes().size());
+    if (static_cast<int>(visited.size()) != numNodes) {
+        level.assign(static_cast<size_t>(numNodes) * BFS_BATCH, 0);
+        targetIndex.assign(numNodes, -1);
+        targets.clear();
     }
+    visited.assign(numNodes, 0);
+    frontier.assign(numNodes, 0);
+    next.assign(numNodes, 0);
+    onPath.assign(numNodes, 0);
+    // targetIndex is reset through the previous batch's targets
+    for (int t : targets) targetIndex[t] = -1;
+    targets.clear();
+    wanted.clear();
     
-    // Not precomputed - run A* on demand
-    return RunAStar(fromNodeId, toNodeId);
+    // Incoming edges, without those into blocked nodes (never taken)
+    offsets.assign(numNodes + 1, 0);
+    for (int u = 0; u < numNodes; ++u) {
+        for (const auto& edge : mesh.GetNeighbors(u)) {
+            int v = edge.targetNodeId;
+            if (v >= 0 && v < numNodes && !mesh.IsNodeBlocked(v)) offsets[v + 1]++;
+        }
+    }
+    for (int v = 0; v < numNodes; ++v) offsets[v + 1] += offsets[v];
+    predecessors.resize(offsets[numNodes]);
+    scratch.assign(offsets.begin(), offsets.end() - 1);
+    for (int u = 0; u < numNodes; ++u) {
+        for (const auto& edge : mesh.GetNeighbors(u)) {
+            int v = edge.targetNodeId;
+            if (v >= 0 && v < numNodes && !mesh.IsNodeBlocked(v)) predecessors[scratch[v]++] = u;
+        }
+    }
+}
+
+void CostMatrixProvider::RunBitParallelBFS(const std::vector<int>& sourceIds,
+                                           const std::vector<const std::vector<int>*>& targets,
+                                           float edgeCost, BfsWorkspace& ws,
+                                           const std::vector<float*>& costsOut,
+                                           const std::vector<uint64_t*>& regionsOut) const {
+    const int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
+    const int count = static_cast<int>(sourceIds.size());
+    ws.Begin(navMesh_);
+    bool wantRegions = std::any_of(regionsOut.begin(), regionsOut.end(), [](uint64_t* r) { return r != nullptr; });
+    if (wantRegions) {
+        ws.region.resize(numNodes);
+        for (int v = 0; v < numNodes; ++v) ws.region[v] = RegionOf(v);
+    }
+    
+    // Union of the targets, with the sources that want each (a source
+    // never waits for a target outside its component)
+    const auto components = GetComponents();
+    int pending = 0;
+    for (int i = 0; i < count; ++i) {
+        std::fill(costsOut[i], costsOut[i] + targets[i]->size(), INFINITY_COST);
+        for (int t : *targets[i]) {
+            if (t < 0 || t >= numNodes || !IsReachable(*components, sourceIds[i], t)) continue;
+            if (ws.targetIndex[t] < 0) {
+                ws.targetIndex[t] = static_cast<int>(ws.targets.size());
+                ws.targets.push_back(t);
+                ws.wanted.push_back(0);
+            }
+            uint64_t& want = ws.wanted[ws.targetIndex[t]];
+            if (!(want & (uint64_t(1) << i))) {
+                want |= uint64_t(1) << i;
+                ++pending;
+            }
+        }
+    }
+    ws.depth.assign(ws.targets.size() * BFS_BATCH, UNREACHED);
+    
+    // Newly reached bits of v at hop count depth
+    auto reach = [&](int v, uint64_t bits, uint32_t depth) {
+        ws.visited[v] |= bits;
+        for (uint64_t b = bits; b; b &= b - 1) {
+            ws.level[static_cast<size_t>(__builtin_ctzll(b)) * numNodes + v] = static_cast<uint16_t>(depth);
+        }
+        int idx = ws.targetIndex[v];
+        if (idx < 0) return;
+        uint64_t hit = bits & ws.wanted[idx];
+        if (!hit) return;
+        ws.wanted[idx] &= ~hit;
+        pending -= __builtin_popcountll(hit);
+        for (uint64_t b = hit; b; b &= b - 1) {
+            ws.depth[static_cast<size_t>(idx) * BFS_BATCH + __builtin_ctzll(b)] = depth;
+        }
+    };
+    
+    uint64_t all = 0;
+    for (int i = 0; i < count; ++i) {
+        int s = sourceIds[i];
+        if (s < 0 || s >= numNodes) continue;
+        all |= uint64_t(1) << i;
+        ws.frontier[s] |= uint64_t(1) << i;
+        reach(s, uint64_t(1) << i, 0);
+    }
+    
+    // Level-synchronous sweep over every node: a node ORs its
+    // predecessors' frontiers, one word op per edge for all sources at
+    // once, and keeps the bits it had not seen yet
+    const int* offsets = ws.offsets.data();
+    const int* predecessors = ws.predecessors.data();
+    bool advanced = true;
+    for (uint32_t depth = 1; advanced && pending > 0; ++depth) {
+        advanced = false;
+        for (int v = 0; v < numNodes; ++v) {
+            uint64_t bits = 0;
+            if (ws.visited[v] != all) {
+                for (int e = offsets[v]; e < offsets[v + 1]; ++e) bits |= ws.frontier[predecessors[e]];
+                bits &= ~ws.visited[v];
+            }
+            ws.next[v] = bits;
+            if (bits) {
+                advanced = true;
+                reach(v, bits, depth);
+            }
+        }
+        ws.frontier.swap(ws.next);
+    }
+    
+    for (int i = 0; i < count; ++i) {
+        const uint64_t bit = uint64_t(1) << i;
+        const uint16_t* levels = ws.level.data() + static_cast<size_t>(i) * numNodes;
+        const std::vector<int>& rowTargets = *targets[i];
+        for (size_t k = 0; k < rowTargets.size(); ++k) {
+            int t = rowTargets[k];
+            if (t < 0 || t >= numNodes || ws.targetIndex[t] < 0) continue;
+            uint32_t depth = ws.depth[static_cast<size_t>(ws.targetIndex[t]) * BFS_BATCH + i];
+            if (depth != UNREACHED) costsOut[i][k] = static_cast<float>(depth) * edgeCost;
+        }
+        if (!regionsOut[i]) continue;
+        
+        // Walk each reached target back to the source, one hop down at a
+        // time (each node's path recorded once per source)
+        for (int t : rowTargets) {
+            if (t < 0 || t >= numNodes || ws.targetIndex[t] < 0) continue;
+            uint32_t depth = ws.depth[static_cast<size_t>(ws.targetIndex[t]) * BFS_BATCH + i];
+            if (depth == UNREACHED) continue;
+            for (int v = t; !(ws.onPath[v] & bit); --depth) {
+                ws.onPath[v] |= bit;
+                int region = ws.region[v];
+                regionsOut[i][region >> 6] |= uint64_t(1) << (region & 63);
+                if (depth == 0) break;
+                
+                int previous = -1;
+                uint16_t down = static_cast<uint16_t>(depth - 1);
+                for (int e = offsets[v]; e < offsets[v + 1]; ++e) {
+                    int u = predecessors[e];
+                    if ((ws.visited[u] & bit) && levels[u] == down) {
+                        previous = u;
+                        break;
+                    }
+                }
+                if (previous < 0) break;    // Never: v was reached from a node one hop closer
+                v = previous;
+            }
+        }
+    }
+}
+
+// =============================================================================
+// QUERIES
+// =============================================================================
+
+float CostMatrixProvider::GetCostSlow(int fromNodeId, int toNodeId) const {
+    // Not precomputed - cached result of an earlier search, if any
+    uint64_t version = navMesh_.GetChangeVersion();
+    float cost;
+    if (fallbackCache_.Find(fromNodeId, toNodeId, version, cost)) {
+        return cost;
+    }
+    
+    if (!IsReachable(fromNodeId, toNodeId)) return INFINITY_COST;
+    
+    TRACE_ZONE("CostMatrixMiss", "layer2");
+    auto searchStart = Common::LatencyHistogram::Clock::now();
+    cost = hierarchy_ ? hierarchy_->GetCost(fromNodeId, toNodeId)
+                      : RunAStar(fromNodeId, toNodeId);
+    missLatency_.RecordSince(searchStart);
+    fallbackCache_.Insert(fromNodeId, toNodeId, version, cost);
+    return cost;
+}
+
+void CostMatrixProvider::GatherLegs(const int* slots, size_t count, float* out) const {
+    const size_t stride = static_cast<size_t>(slotCapacity_);
+    // Pairs not precomputed (and same-node legs without an entry) are
+    // answered as GetCost answers them
+    auto resolve = [this](int from, int to) {
+        return from == to ? 0.0f : GetCostSlow(slotToNode_[from], slotToNode_[to]);
+    };
+    if (storage_ == CostStorage::FLOAT32) {
+        const float* matrix = costMatrix_.data();
+        for (size_t k = 0; k < count; ++k) {
+            float cost = matrix[static_cast<size_t>(slots[k]) * stride + slots[k + 1]];
+            out[k] = cost == UNKNOWN_COST ? resolve(slots[k], slots[k + 1]) : cost;
+        }
+    } else {
+        for (size_t k = 0; k < count; ++k) {
+            float cost = LoadEntry(static_cast<size_t>(slots[k]) * stride + slots[k + 1]);
+            out[k] = cost == UNKNOWN_COST ? resolve(slots[k], slots[k + 1]) : cost;
+        }
+    }
+}
+
+double CostMatrixProvider::GetPathCostBySlots(const int* slots, size_t count, float* legs) const {
+    if (count < 2) return 0.0;
+
+    // Legs a chunk at a time, so the sum reads them from L1
+    constexpr size_t CHUNK = 64;
+    float buffer[CHUNK];
+    double total = 0.0;
+    for (size_t begin = 0; begin + 1 < count; begin += CHUNK) {
+        const size_t chunk = std::min(CHUNK, count - 1 - begin);
+        float* out = legs ? legs + begin : buffer;
+        GatherLegs(slots + begin, chunk, out);
+        total += SumLegs(out, chunk);
+    }
+    return total;
+}
+
+size_t CostMatrixProvider::GetMemoryBytes() const {
+    using Common::VectorBytes;
+    auto components = std::atomic_load(&components_);
+    return VectorBytes(nodeToSlot_) + VectorBytes(slotToNode_) + VectorBytes(costMatrix_) +
+           VectorBytes(quantizedMatrix_) +
+           VectorBytes(landmarkNodes_) + VectorBytes(landmarkDist_) + VectorBytes(rowRegions_) +
+           VectorBytes(startRowOf_) + VectorBytes(startRowNodes_) + VectorBytes(startCosts_) +
+           (components ? VectorBytes(components->labels) : 0) +
+           fallbackCache_.GetMemoryBytes();
 }
 
 bool CostMatrixProvider::HasPath(int fromNodeId, int toNodeId) const {
-    return GetCost(fromNodeId, toNodeId) < INFINITY_COST;
+    return IsReachable(fromNodeId, toNodeId) && GetCost(fromNodeId, toNodeId) < INFINITY_COST;
+}
+
+// =============================================================================
+// CONNECTED COMPONENTS
+// =============================================================================
+
+std::shared_ptr<const CostMatrixProvider::ComponentLabels> CostMatrixProvider::GetComponents() const {
+    const uint64_t version = navMesh_.GetChangeVersion();
+    const size_t numNodes = navMesh_.GetAllNodes().size();
+    auto current = std::atomic_load(&components_);
+    if (current && current->version == version && current->labels.size() == numNodes) {
+        return current;
+    }
+    
+    std::lock_guard<std::mutex> lock(componentsMutex_);
+    current = std::atomic_load(&components_);
+    if (current && current->version == version && current->labels.size() == numNodes) {
+        return current;
+    }
+    auto rebuilt = std::make_shared<ComponentLabels>();
+    rebuilt->version = version;
+    rebuilt->labels = navMesh_.LabelComponents(true);
+    std::atomic_store(&components_, std::shared_ptr<const ComponentLabels>(rebuilt));
+    return rebuilt;
+}
+
+bool CostMatrixProvider::IsReachable(const ComponentLabels& components, int fromNodeId, int toNodeId) const {
+    const int numNodes = static_cast<int>(components.labels.size());
+    if (fromNodeId < 0 || fromNodeId >= numNodes || toNodeId < 0 || toNodeId >= numNodes) return false;
+    if (fromNodeId == toNodeId) return true;
+    
+    // Searches enter nodes through unblocked ones only: a blocked target
+    // is unreachable, a blocked source leaves through any free neighbor
+    const int target = components.labels[toNodeId];
+    if (target < 0) return false;
+    if (components.labels[fromNodeId] >= 0) return components.labels[fromNodeId] == target;
+    for (const auto& edge : navMesh_.GetNeighbors(fromNodeId)) {
+        if (components.labels[edge.targetNodeId] == target) return true;
+    }
+    return false;
 }
 
 // =============================================================================
@@ -95,16 +1264,40 @@ bool CostMatrixProvider::HasPath(int fromNodeId, int toNodeId) const {
 float CostMatrixProvider::RunAStar(int sourceId, int targetId) const {
     if (sourceId == targetId) return 0.0f;
     
-    const auto& allNodes = navMesh_.GetAllNodes();
-    int numNodes = static_cast<int>(allNodes.size());
-    
+    int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
     if (sourceId < 0 || sourceId >= numNodes || 
         targetId < 0 || targetId >= numNodes) {
         return INFINITY_COST;
     }
+    // Either search would settle the source's whole component first
+    if (!IsReachable(sourceId, targetId)) return INFINITY_COST;
+    
+    if (searchMode_ == CostSearchMode::BIDIRECTIONAL) {
+        return RunBidirectional(sourceId, targetId);
+    }
+    return RunUnidirectional(sourceId, targetId);
+}
+
+float CostMatrixProvider::LowerBound(int nodeId, int targetId) const {
+    const auto& allNodes = navMesh_.GetAllNodes();
+    float bound = allNodes[nodeId].coords.DistanceTo(allNodes[targetId].coords);
     
-    // Get target coordinates for heuristic
-    const auto& targetCoords = allNodes[targetId].coords;
+    if (HasLandmarks()) {
+        for (size_t i = 0; i < landmarkNodes_.size(); ++i) {
+            const float* row = landmarkDist_.data() + i * landmarkNodeCount_;
+            float a = row[nodeId];
+            float b = row[targetId];
+            // A landmark in another component says nothing
+            if (a < INFINITY_COST && b < INFINITY_COST) {
+                bound = std::max(bound, std::fabs(a - b));
+            }
+        }
+    }
+    return bound;
+}
+
+float CostMatrixProvider::RunUnidirectional(int sourceId, int targetId) const {
+    int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
     
     // Priority queue: (f-score, nodeId)
     using PQEntry = std::pair<float, int>;
@@ -116,14 +1309,15 @@ float CostMatrixProvider::RunAStar(int sourceId, int targetId) const {
     
     // f-score = g + h (heuristic)
     auto heuristic = [&](int nodeId) -> float {
-        const auto& coords = allNodes[nodeId].coords;
-        return coords.DistanceTo(targetCoords);
+        return LowerBound(nodeId, targetId);
     };
     
     openSet.push({heuristic(sourceId), sourceId});
     
     // Track visited nodes
     std::vector<bool> visited(numNodes, false);
+    uint64_t expanded = 0;
+    const float* penalty = navMesh_.GetNodePenalties();
     
     while (!openSet.empty()) {
         auto [fScore, current] = openSet.top();
@@ -131,17 +1325,20 @@ float CostMatrixProvider::RunAStar(int sourceId, int targetId) const {
         
         if (current == targetId) {
             // Found the target
+            expandedNodes_.fetch_add(expanded, std::memory_order_relaxed);
             return gScore[targetId];
         }
         
         if (visited[current]) continue;
         visited[current] = true;
+        expanded++;
         
         // Explore neighbors
         const auto& neighbors = navMesh_.GetNeighbors(current);
         for (const auto& edge : neighbors) {
             int neighbor = edge.targetNodeId;
-            float tentativeG = gScore[current] + edge.cost;
+            if (navMesh_.IsNodeBlocked(neighbor)) continue;
+            float tentativeG = gScore[current] + EdgeCost(edge, current, penalty);
             
             if (tentativeG < gScore[neighbor]) {
                 gScore[neighbor] = tentativeG;
@@ -152,9 +1349,177 @@ float CostMatrixProvider::RunAStar(int sourceId, int targetId) const {
     }
     
     // No path found
+    expandedNodes_.fetch_add(expanded, std::memory_order_relaxed);
     return INFINITY_COST;
 }
 
+float CostMatrixProvider::RunBidirectional(int sourceId, int targetId) const {
+    // Forward search enters nodes through unblocked edges only, so a
+    // blocked target is unreachable (the source itself may be blocked)
+    if (navMesh_.IsNodeBlocked(targetId)) return INFINITY_COST;
+    
+    int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
+    
+    // Averaged potential p(v) = (h_t(v) - h_s(v)) / 2: consistent for both
+    // directions, so the usual bidirectional stopping rule stays exact.
+    // The backward search walks edges in reverse (undirected assumption).
+    auto potential = [&](int nodeId) -> float {
+        return 0.5f * (LowerBound(nodeId, targetId) - LowerBound(nodeId, sourceId));
+    };
+    
+    using PQEntry = std::pair<float, int>;
+    using MinQueue = std::priority_queue<PQEntry, std::vector<PQEntry>, std::greater<PQEntry>>;
+    MinQueue queues[2];
+    std::vector<float> g[2] = {std::vector<float>(numNodes, INFINITY_COST),
+                               std::vector<float>(numNodes, INFINITY_COST)};
+    std::vector<bool> settled[2] = {std::vector<bool>(numNodes, false),
+                                    std::vector<bool>(numNodes, false)};
+    
+    g[0][sourceId] = 0.0f;
+    g[1][targetId] = 0.0f;
+    queues[0].push({potential(sourceId), sourceId});
+    queues[1].push({-potential(targetId), targetId});
+    
+    float best = INFINITY_COST;
+    uint64_t expanded = 0;
+    const float* penalty = navMesh_.GetNodePenalties();
+    
+    while (!queues[0].empty() && !queues[1].empty()) {
+        // No meeting point left that could beat the best path
+        if (queues[0].top().first + queues[1].top().first >= best) break;
+        
+        int side = (queues[0].top().first <= queues[1].top().first) ? 0 : 1;
+        int other = 1 - side;
+        float sign = (side == 0) ? 1.0f : -1.0f;
+        
+        int u = queues[side].top().second;
+        queues[side].pop();
+        if (settled[side][u]) continue;
+        settled[side][u] = true;
+        expanded++;
+        
+        for (const auto& edge : navMesh_.GetNeighbors(u)) {
+            int v = edge.targetNodeId;
+            // Backward: the forward path would leave v, which only the
+            // source may do while blocked
+            if (navMesh_.IsNodeBlocked(v) && !(side == 1 && v == sourceId)) continue;
+            float tentativeG = g[side][u] + EdgeCost(edge, u, penalty);
+            
+            if (tentativeG < g[side][v]) {
+                g[side][v] = tentativeG;
+                queues[side].push({tentativeG + sign * potential(v), v});
+            }
+            if (g[other][v] < INFINITY_COST) {
+                best = std::min(best, g[side][v] + g[other][v]);
+            }
+        }
+    }
+    
+    expandedNodes_.fetch_add(expanded, std::memory_order_relaxed);
+    return best;
+}
+
+// =============================================================================
+// LANDMARKS
+// =============================================================================
+
+void CostMatrixProvider::DetectCostUnit() {
+    costUnit_ = 0.0f;
+    costUnitMaxSteps_ = 0;
+    
+    // The cheapest edge is the unit candidate; every cost must be an exact
+    // float multiple of it, so distances summed in float stay multiples
+    float unit = 0.0f;
+    const int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
+    for (int u = 0; u < numNodes; ++u) {
+        for (const auto& edge : navMesh_.GetNeighbors(u)) {
+            if (!(edge.cost > 0.0f)) return;
+            if (unit == 0.0f || edge.cost < unit) unit = edge.cost;
+        }
+    }
+    if (unit == 0.0f) return;
+    
+    uint32_t maxSteps = 1;
+    for (int u = 0; u < numNodes; ++u) {
+        for (const auto& edge : navMesh_.GetNeighbors(u)) {
+            float steps = std::round(edge.cost / unit);
+            if (steps > MAX_BUCKET_STEPS || steps * unit != edge.cost) return;
+            maxSteps = std::max(maxSteps, static_cast<uint32_t>(steps));
+        }
+    }
+    costUnit_ = unit;
+    costUnitMaxSteps_ = maxSteps;
+}
+
+void CostMatrixProvider::RunUnblockedDijkstra(int sourceId, std::vector<float>& dist) const {
+    dist.assign(navMesh_.GetAllNodes().size(), INFINITY_COST);
+    dist[sourceId] = 0.0f;
+    
+    MonotoneQueue open;
+    open.Reset(QueueUnit(nullptr), costUnitMaxSteps_);
+    open.Push(0.0f, sourceId);
+    
+    while (!open.Empty()) {
+        float d;
+        int u = open.Pop(d);
+        if (d > dist[u]) continue;
+        
+        for (const auto& edge : navMesh_.GetNeighbors(u)) {
+            float newDist = d + edge.cost;
+            if (newDist < dist[edge.targetNodeId]) {
+                dist[edge.targetNodeId] = newDist;
+                open.Push(newDist, edge.targetNodeId);
+            }
+        }
+    }
+}
+
+int CostMatrixProvider::PrecomputeLandmarks(int count) {
+    landmarkNodes_.clear();
+    landmarkDist_.clear();
+    landmarkNodeCount_ = 0;
+    
+    int numNodes = static_cast<int>(navMesh_.GetAllNodes().size());
+    if (count <= 0 || numNodes == 0) return 0;
+    
+    // minDist[v] = distance from v to the nearest landmark chosen so far
+    std::vector<float> minDist(numNodes, INFINITY_COST);
+    std::vector<float> dist;
+    
+    // Seed: the node farthest from node 0 (within node 0's component)
+    RunUnblockedDijkstra(0, dist);
+    int next = 0;
+    for (int v = 0; v < numNodes; ++v) {
+        if (dist[v] < INFINITY_COST && dist[v] > dist[next]) next = v;
+    }
+    
+    while (static_cast<int>(landmarkNodes_.size()) < count) {
+        RunUnblockedDijkstra(next, dist);
+        landmarkNodes_.push_back(next);
+        landmarkDist_.insert(landmarkDist_.end(), dist.begin(), dist.end());
+        
+        for (int v = 0; v < numNodes; ++v) {
+            minDist[v] = std::min(minDist[v], dist[v]);
+        }
+        
+        // Farthest reachable node from all landmarks; stop when every
+        // node already is one
+        int farthest = -1;
+        for (int v = 0; v < numNodes; ++v) {
+            if (minDist[v] > 0.0f && minDist[v] < INFINITY_COST &&
+                (farthest < 0 || minDist[v] > minDist[farthest])) {
+                farthest = v;
+            }
+        }
+        if (farthest < 0) break;
+        next = farthest;
+    }
+    
+    landmarkNodeCount_ = numNodes;
+    std::cout << "[CostMatrix] Selected " << landmarkNodes_.size() << " ALT landmarks" << std::endl;
+    return static_cast<int>(landmarkNodes_.size());
+}
+
 std::unordered_map<int, float> CostMatrixProvider::RunDijkstra(int sourceId) const {
     std::unordered_map<int, float> distances;
     
@@ -169,17 +1534,18 @@ std::unordered_map<int, float> CostMatrixProvider::RunDijkstra(int sourceId) con
     std::vector<float> dist(numNodes, INFINITY_COST);
     dist[sourceId] = 0.0f;
     
-    // Priority queue: (distance, nodeId)
-    using PQEntry = std::pair<float, int>;
-    std::priority_queue<PQEntry, std::vector<PQEntry>, std::greater<PQEntry>> pq;
-    pq.push({0.0f, sourceId});
+    // Open nodes by distance
+    const float* penalty = navMesh_.GetNodePenalties();
+    MonotoneQueue open;
+    open.Reset(QueueUnit(penalty), costUnitMaxSteps_);
+    open.Push(0.0f, sourceId);
     
     // Visited tracking
     std::vector<bool> visited(numNodes, false);
     
-    while (!pq.empty()) {
-        auto [d, u] = pq.top();
-        pq.pop();
+    while (!open.Empty()) {
+        float d;
+        int u = open.Pop(d);
         
         if (visited[u]) continue;
         visited[u] = true;
@@ -191,11 +1557,12 @@ std::unordered_map<int, float> CostMatrixProvider::RunDijkstra(int sourceId) con
         const auto& neighbors = navMesh_.GetNeighbors(u);
         for (const auto& edge : neighbors) {
             int v = edge.targetNodeId;
-            float newDist = d + edge.cost;
+            if (navMesh_.IsNodeBlocked(v)) continue;
+            float newDist = d + EdgeCost(edge, u, penalty);
             
             if (newDist < dist[v]) {
                 dist[v] = newDist;
-                pq.push({newDist, v});
+                open.Push(newDist, v);
             }
         }
     }
@@ -0,0 +1,76 @@
+/**
+ * @file DemandForecast.cc
+ * @brief Implementation of the demand forecast
+ */
+
+#include "../include/DemandForecast.hh"
+#include "../../common/include/MemoryUsage.hh"
+#include <algorithm>
+#include <cmath>
+
+namespace Backend {
+namespace Layer2 {
+
+DemandForecast::DemandForecast(double halfLifeSeconds)
+    : halfLifeSeconds_(std::max(halfLifeSeconds, 1e-3)) {}
+
+double DemandForecast::DecayTo(double now) const {
+    return now > decayedAt_ ? std::exp2(-(now - decayedAt_) / halfLifeSeconds_) : 1.0;
+}
+
+double DemandForecast::Window(double now) const {
+    // Integral of the decay over the history seen so far
+    const double steady = halfLifeSeconds_ / std::log(2.0);
+    const double age = firstSeen_ >= 0.0 ? std::max(0.0, now - firstSeen_) : 0.0;
+    return std::max(steady * (1.0 - std::exp2(-age / halfLifeSeconds_)), 1.0);
+}
+
+void DemandForecast::Observe(const std::vector<Task>& tasks, double now) {
+    if (tasks.empty()) return;
+    if (firstSeen_ < 0.0) {
+        firstSeen_ = now;
+        decayedAt_ = now;
+    }
+    const double factor = DecayTo(now);
+    if (factor < 1.0) {
+        for (auto& entry : pairWeight_) entry.second *= factor;
+        decayedAt_ = now;
+    }
+    for (const Task& task : tasks) {
+        pairWeight_[PairKey(task.sourceNode, task.destinationNode)] += 1.0;
+    }
+    observed_ += tasks.size();
+}
+
+double DemandForecast::GetRate(int sourceNode, int destinationNode, double now) const {
+    auto it = pairWeight_.find(PairKey(sourceNode, destinationNode));
+    if (it == pairWeight_.end()) return 0.0;
+    return it->second * DecayTo(now) / Window(now);
+}
+
+std::vector<DemandForecast::Demand> DemandForecast::ExpectedPickups(double now, double horizonSeconds,
+                                                                    double minExpected) const {
+    // Never more than seen so far: a short history (a backlog injected at
+    // start) is no rate to extrapolate from
+    std::unordered_map<int, double> bySource;
+    const double scale = DecayTo(now) / std::max(Window(now), horizonSeconds) * horizonSeconds;
+    for (const auto& [key, weight] : pairWeight_) {
+        bySource[static_cast<int>(key >> 32)] += weight * scale;
+    }
+
+    std::vector<Demand> demand;
+    for (const auto& [node, expected] : bySource) {
+        if (expected >= minExpected) demand.push_back({node, expected});
+    }
+    std::sort(demand.begin(), demand.end(), [](const Demand& a, const Demand& b) {
+        return a.expected != b.expected ? a.expected > b.expected : a.node < b.node;
+    });
+    return demand;
+}
+
+size_t DemandForecast::GetMemoryBytes() const {
+    return Common::HashMapBytes(pairWeight_);
+}
+
+} // namespace Layer2
+} // namespace Backend
@@ -0,0 +1,155 @@
+/**
+ * @file FlatSolution.cc
+ * @brief Implementation of the flat multi-route solution
+ */
+
+#include "../include/FlatSolution.hh"
+#include <algorithm>
+#include <utility>
+
+namespace Backend {
+namespace Layer2 {
+
+FlatSolution::FlatSolution(int numRobots, int capacity)
+    : offset_(static_cast<size_t>(std::max(0, numRobots)) + 1, 0) {
+    order_.reserve(static_cast<size_t>(std::max(0, capacity)));
+}
+
+FlatSolution::FlatSolution(const FlatSolution& other)
+    : order_(other.order_)
+    , offset_(other.offset_) {}
+
+FlatSolution& FlatSolution::operator=(const FlatSolution& other) {
+    if (this != &other) {
+        // vector::operator= reuses our capacity when it suffices
+        order_ = other.order_;
+        offset_ = other.offset_;
+        journal_.clear();
+    }
+    return *this;
+}
+
+FlatSolution FlatSolution::FromRoutes(const std::vector<std::vector<int>>& routes) {
+    size_t total = 0;
+    for (const auto& route : routes) total += route.size();
+
+    FlatSolution solution(static_cast<int>(routes.size()), static_cast<int>(total));
+    for (size_t r = 0; r < routes.size(); ++r) {
+        solution.order_.insert(solution.order_.end(), routes[r].begin(), routes[r].end());
+        solution.offset_[r + 1] = static_cast<int>(solution.order_.size());
+    }
+    return solution;
+}
+
+std::vector<std::vector<int>> FlatSolution::ToRoutes() const {
+    std::vector<std::vector<int>> routes(GetRobotCount());
+    for (int r = 0; r < GetRobotCount(); ++r) {
+        RouteView route = Route(r);
+        routes[r].assign(route.begin(), route.end());
+    }
+    return routes;
+}
+
+// =============================================================================
+// EDITS
+// =============================================================================
+
+void FlatSolution::InsertRaw(int robot, int pos, int task) {
+    order_.insert(order_.begin() + offset_[robot] + pos, task);
+    for (size_t r = robot + 1; r < offset_.size(); ++r) {
+        offset_[r]++;
+    }
+}
+
+int FlatSolution::EraseRaw(int robot, int pos) {
+    auto it = order_.begin() + offset_[robot] + pos;
+    int task = *it;
+    order_.erase(it);
+    for (size_t r = robot + 1; r < offset_.size(); ++r) {
+        offset_[r]--;
+    }
+    return task;
+}
+
+void FlatSolution::SwapRaw(int robot1, int pos1, int robot2, int pos2) {
+    std::swap(order_[offset_[robot1] + pos1], order_[offset_[robot2] + pos2]);
+}
+
+void FlatSolution::ExchangeTailsRaw(int robot1, int pos1, int robot2, int pos2) {
+    if (robot1 > robot2) {
+        std::swap(robot1, robot2);
+        std::swap(pos1, pos2);
+    }
+    
+    // [tail1 | routes in between + head2 | tail2] -> [tail2 | middle | tail1]:
+    // reverse the whole span, then each of the three pieces back
+    auto first = order_.begin() + offset_[robot1] + pos1;
+    auto last = order_.begin() + offset_[robot2 + 1];
+    int tail1 = offset_[robot1 + 1] - offset_[robot1] - pos1;
+    int tail2 = offset_[robot2 + 1] - offset_[robot2] - pos2;
+    int middle = static_cast<int>(last - first) - tail1 - tail2;
+    
+    std::reverse(first, last);
+    std::reverse(first, first + tail2);
+    std::reverse(first + tail2, first + tail2 + middle);
+    std::reverse(first + tail2 + middle, last);
+    
+    for (int r = robot1 + 1; r <= robot2; ++r) {
+        offset_[r] += tail2 - tail1;
+    }
+}
+
+void FlatSolution::Insert(int robot, int pos, int task) {
+    InsertRaw(robot, pos, task);
+    journal_.push_back({JournalEntry::INSERTED, robot, pos, 0, 0, task});
+}
+
+int FlatSolution::Erase(int robot, int pos) {
+    int task = EraseRaw(robot, pos);
+    journal_.push_back({JournalEntry::ERASED, robot, pos, 0, 0, task});
+    return task;
+}
+
+void FlatSolution::Swap(int robot1, int pos1, int robot2, int pos2) {
+    SwapRaw(robot1, pos1, robot2, pos2);
+    journal_.push_back({JournalEntry::SWAPPED, robot1, pos1, robot2, pos2, 0});
+}
+
+void FlatSolution::Relocate(int fromRobot, int fromPos, int toRobot, int toPos) {
+    Insert(toRobot, toPos, Erase(fromRobot, fromPos));
+}
+
+void FlatSolution::ExchangeTails(int robot1, int pos1, int robot2, int pos2) {
+    ExchangeTailsRaw(robot1, pos1, robot2, pos2);
+    // After the exchange the tails start at the same positions again
+    journal_.push_back({JournalEntry::TAILS_EXCHANGED, robot1, pos1, robot2, pos2, 0});
+}
+
+void FlatSolution::Clear() {
+    order_.clear();
+    std::fill(offset_.begin(), offset_.end(), 0);
+    journal_.clear();
+}
+
+void FlatSolution::Rollback() {
+    for (auto it = journal_.rbegin(); it != journal_.rend(); ++it) {
+        switch (it->kind) {
+            case JournalEntry::INSERTED:
+                EraseRaw(it->robot1, it->pos1);
+                break;
+            case JournalEntry::ERASED:
+                InsertRaw(it->robot1, it->pos1, it->task);
+                break;
+            case JournalEntry::SWAPPED:
+                SwapRaw(it->robot1, it->pos1, it->robot2, it->pos2);
+                break;
+            case JournalEntry::TAILS_EXCHANGED:
+                ExchangeTailsRaw(it->robot1, it->pos1, it->robot2, it->pos2);
+                break;
+        }
+    }
+    journal_.clear();
+}
+
+} // namespace Layer2
+} // namespace Backend
@@ -0,0 +1,433 @@
+/**
+ * @file GranularLocalSearch.cc
+ * @brief Implementation of the neighbour lists and granular local search
+ */
+
+#include "../include/GranularLocalSearch.hh"
+#include <algorithm>
+#include <utility>
+
+namespace Backend {
+namespace Layer2 {
+
+// =============================================================================
+// NEIGHBOR LISTS
+// =============================================================================
+
+void NeighborLists::Build(
+    const std::vector<Task>& tasks,
+    const std::vector<int>& startNodes,
+    const CostMatrixProvider& costs,
+    int k
+) {
+    int numTasks = static_cast<int>(tasks.size());
+    int numRobots = static_cast<int>(startNodes.size());
+    size_t keep = static_cast<size_t>(std::max(1, k));
+
+    lists_.assign(numTasks, {});
+    std::vector<std::pair<float, int>> scored;
+    scored.reserve(numTasks + numRobots);
+
+    for (int t = 0; t < numTasks; ++t) {
+        scored.clear();
+        for (int u = 0; u < numTasks; ++u) {
+            if (u == t) continue;
+            float chain = std::min(costs.GetCost(tasks[t].destinationNode, tasks[u].sourceNode),
+                                   costs.GetCost(tasks[u].destinationNode, tasks[t].sourceNode));
+            scored.push_back({chain, u});
+        }
+        for (int r = 0; r < numRobots; ++r) {
+            scored.push_back({costs.GetCost(startNodes[r], tasks[t].sourceNode), -r - 1});
+        }
+
+        Keep(t, scored, keep);
+    }
+}
+
+void NeighborLists::BuildPartitioned(
+    const std::vector<Task>& tasks,
+    const std::vector<int>& startNodes,
+    const CostMatrixProvider& costs,
+    int k,
+    const std::vector<int>& taskGroup,
+    const std::vector<int>& robotGroup,
+    const std::vector<std::vector<int>>& nearbyGroups
+) {
+    int numTasks = static_cast<int>(tasks.size());
+    int numRobots = static_cast<int>(startNodes.size());
+    int numGroups = static_cast<int>(nearbyGroups.size());
+    size_t keep = static_cast<size_t>(std::max(1, k));
+
+    // Members of every group, in index order
+    std::vector<std::vector<int>> groupTasks(numGroups);
+    std::vector<std::vector<int>> groupRobots(numGroups);
+    for (int t = 0; t < numTasks; ++t) groupTasks[taskGroup[t]].push_back(t);
+    for (int r = 0; r < numRobots; ++r) groupRobots[robotGroup[r]].push_back(r);
+
+    lists_.assign(numTasks, {});
+    std::vector<std::pair<float, int>> scored;
+
+    for (int t = 0; t < numTasks; ++t) {
+        scored.clear();
+        for (int g : nearbyGroups[taskGroup[t]]) {
+            for (int u : groupTasks[g]) {
+                if (u == t) continue;
+                float chain = std::min(costs.GetCost(tasks[t].destinationNode, tasks[u].sourceNode),
+                                       costs.GetCost(tasks[u].destinationNode, tasks[t].sourceNode));
+                scored.push_back({chain, u});
+            }
+            for (int r : groupRobots[g]) {
+                scored.push_back({costs.GetCost(startNodes[r], tasks[t].sourceNode), -r - 1});
+            }
+        }
+        Keep(t, scored, keep);
+    }
+}
+
+void NeighborLists::Keep(int task, std::vector<std::pair<float, int>>& scored, size_t count) {
+    count = std::min(count, scored.size());
+    std::nth_element(scored.begin(), scored.begin() + count, scored.end());
+    lists_[task].reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        lists_[task].push_back(scored[i].second);
+    }
+}
+
+// =============================================================================
+// GRANULAR LOCAL SEARCH
+// =============================================================================
+
+GranularLocalSearch::GranularLocalSearch(
+    const std::vector<Task>& tasks,
+    const std::vector<int>& startNodes,
+    const CostMatrixProvider& costs,
+    const NeighborLists& neighbors
+)
+    : tasks_(tasks)
+    , startNodes_(startNodes)
+    , costs_(costs)
+    , neighbors_(neighbors)
+    , scorer_(tasks, costs) {
+    serviceCost_.reserve(tasks.size());
+    for (const Task& task : tasks) {
+        serviceCost_.push_back(costs.GetCost(task.sourceNode, task.destinationNode));
+    }
+}
+
+bool GranularLocalSearch::Run(
+    FlatSolution& solution,
+    std::vector<double>& routeTimes,
+    const SolveOptions& options,
+    int maxPasses
+) {
+    int numTasks = static_cast<int>(tasks_.size());
+    int numRobots = solution.GetRobotCount();
+
+    solution_ = &solution;
+    solution.Commit();   // Rejected battery moves roll back to here at most
+    stats_ = Stats();
+    robotOf_.assign(numTasks, -1);
+    positionOf_.assign(numTasks, -1);
+    prefix_.resize(numRobots);
+    if (battery_) profiles_.resize(numRobots);
+    segment_.reserve(MAX_SEGMENT_LENGTH);
+    for (int r = 0; r < numRobots; ++r) {
+        RebuildRoute(r);
+    }
+
+    bool improvedAny = false;
+    for (int pass = 0; pass < maxPasses; ++pass) {
+        if (options.ShouldStop()) break;
+        stats_.passes++;
+
+        bool improved = false;
+        for (int t = 0; t < numTasks; ++t) {
+            if (robotOf_[t] < 0) continue;   // Not in this solution
+
+            Candidate best;
+            TrySegmentMoves(t, best);
+            TryTailExchanges(t, best);
+            if (best.kind != MoveKind::NONE && Apply(best)) {
+                improved = true;
+            }
+        }
+
+        if (!improved) break;
+        improvedAny = true;
+    }
+
+    solution.Commit();
+    routeTimes.resize(numRobots);
+    for (int r = 0; r < numRobots; ++r) {
+        routeTimes[r] = RouteTotal(r);
+    }
+    solution_ = nullptr;
+    return improvedAny;
+}
+
+double GranularLocalSearch::RouteTime(RouteView route, int robot) const {
+    if (battery_) return battery_->Plan(route, robot);
+    return scorer_.RouteTime(route, startNodes_[robot]);
+}
+
+// =============================================================================
+// ROUTE STATE
+// =============================================================================
+
+float GranularLocalSearch::Transition(int pred, int task) const {
+    int from = NeighborLists::IsRobotStart(pred)
+        ? startNodes_[NeighborLists::StartRobot(pred)]
+        : tasks_[pred].destinationNode;
+    return costs_.GetCost(from, tasks_[task].sourceNode);
+}
+
+int GranularLocalSearch::Predecessor(int robot, int pos) const {
+    return pos == 0 ? -robot - 1 : solution_->At(robot, pos - 1);
+}
+
+double GranularLocalSearch::TailTime(int robot, int pos) const {
+    if (pos >= solution_->RouteSize(robot)) return 0.0;
+    return RouteTotal(robot) - prefix_[robot][pos]
+         - Transition(Predecessor(robot, pos), solution_->At(robot, pos));
+}
+
+void GranularLocalSearch::RebuildRoute(int robot) {
+    RouteView route = solution_->Route(robot);
+    std::vector<double>& prefix = prefix_[robot];
+    if (battery_) {
+        battery_->Plan(route, robot, profiles_[robot]);
+        prefix = profiles_[robot].time;
+        for (int i = 0; i < route.size(); ++i) {
+            robotOf_[route[i]] = robot;
+            positionOf_[route[i]] = i;
+        }
+        return;
+    }
+
+    prefix.resize(route.size() + 1);
+    prefix[0] = 0.0;
+
+    int pred = -robot - 1;
+    for (int i = 0; i < route.size(); ++i) {
+        int t = route[i];
+        prefix[i + 1] = prefix[i] + Transition(pred, t) + serviceCost_[t];
+        robotOf_[t] = robot;
+        positionOf_[t] = i;
+        pred = t;
+    }
+}
+
+// =============================================================================
+// MOVE EVALUATION
+// =============================================================================
+
+void GranularLocalSearch::TrySegmentMoves(int task, Candidate& best) const {
+    int robot = robotOf_[task];
+    int pos = positionOf_[task];
+    int routeSize = solution_->RouteSize(robot);
+
+    for (int length = 1; length <= MAX_SEGMENT_LENGTH && pos + length <= routeSize; ++length) {
+        for (int v : neighbors_.Of(task)) {
+            if (NeighborLists::IsRobotStart(v)) {
+                EvaluateSegmentMove(robot, pos, length, v, best);
+                continue;
+            }
+            if (robotOf_[v] < 0) continue;
+
+            // Right after v, and right before it
+            EvaluateSegmentMove(robot, pos, length, v, best);
+            EvaluateSegmentMove(robot, pos, length, Predecessor(robotOf_[v], positionOf_[v]), best);
+        }
+    }
+}
+
+void GranularLocalSearch::TryTailExchanges(int task, Candidate& best) const {
+    int robot = robotOf_[task];
+    int pos = positionOf_[task];
+
+    for (int v : neighbors_.Of(task)) {
+        if (NeighborLists::IsRobotStart(v)) {
+            // That robot starts with this task and the rest of its route
+            int other = NeighborLists::StartRobot(v);
+            if (other != robot) EvaluateTailExchange(robot, pos, other, 0, best);
+            continue;
+        }
+        int other = robotOf_[v];
+        if (other < 0 || other == robot) continue;
+
+        // v followed by task, and task followed by v
+        EvaluateTailExchange(robot, pos, other, positionOf_[v] + 1, best);
+        EvaluateTailExchange(robot, pos + 1, other, positionOf_[v], best);
+    }
+}
+
+void GranularLocalSearch::EvaluateSegmentMove(
+    int robot,
+    int pos,
+    int length,
+    int pred,
+    Candidate& best
+) const {
+    int target = NeighborLists::IsRobotStart(pred) ? NeighborLists::StartRobot(pred) : robotOf_[pred];
+    int targetPos = NeighborLists::IsRobotStart(pred) ? -1 : positionOf_[pred];
+
+    // Inserting after a segment task, or after the segment's own
+    // predecessor (no change), is not a move
+    if (target == robot && targetPos >= pos - 1 && targetPos < pos + length) return;
+
+    int routeSize = solution_->RouteSize(robot);
+    int first = solution_->At(robot, pos);
+    int last = solution_->At(robot, pos + length - 1);
+    int before = Predecessor(robot, pos);
+
+    // Cut the segment out: before -> first ... last -> after becomes before -> after
+    float into = Transition(before, first);
+    double inner = prefix_[robot][pos + length] - prefix_[robot][pos] - into;
+    double removal = -into - inner;
+    if (pos + length < routeSize) {
+        int after = solution_->At(robot, pos + length);
+        removal += Transition(before, after) - Transition(last, after);
+    }
+
+    // Put it between pred and its successor (an edge the cut left intact)
+    double insertion = Transition(pred, first) + inner;
+    if (targetPos + 1 < solution_->RouteSize(target)) {
+        int next = solution_->At(target, targetPos + 1);
+        insertion += Transition(last, next) - Transition(pred, next);
+    }
+
+    Candidate move;
+    move.kind = MoveKind::SEGMENT;
+    move.robot1 = robot;
+    move.pos1 = pos;
+    move.length = length;
+    move.robot2 = target;
+    move.pos2 = (target == robot && targetPos > pos) ? targetPos + 1 - length : targetPos + 1;
+
+    if (target == robot) {
+        double time = RouteTotal(robot) + removal + insertion;
+        if (battery_) {
+            time += battery_->ChargeTimeDelta(profiles_[robot], std::min(pos, targetPos + 1),
+                                              removal + insertion);
+        }
+        Consider(move, time, time, best);
+        return;
+    }
+
+    double time1 = RouteTotal(robot) + removal;
+    double time2 = RouteTotal(target) + insertion;
+    if (battery_) {
+        const BatteryProfile& from = profiles_[robot];
+        const BatteryProfile& into = profiles_[target];
+        time1 += battery_->ChargeTimeDelta(from, pos + length, removal);
+        time2 += battery_->SegmentFits(into.energy[targetPos + 1], Transition(pred, first) + inner)
+            ? battery_->ChargeTimeDelta(into, targetPos + 1, insertion)
+            : BatteryPlanner::NO_FIT;
+    }
+    Consider(move, time1, time2, best);
+}
+
+void GranularLocalSearch::EvaluateTailExchange(
+    int robot1,
+    int pos1,
+    int robot2,
+    int pos2,
+    Candidate& best
+) const {
+    int size1 = solution_->RouteSize(robot1);
+    int size2 = solution_->RouteSize(robot2);
+    if (pos1 >= size1 && pos2 >= size2) return;
+
+    // A tail keeps its stops if the energy it now starts with (prefix
+    // energy minus the new connecting leg) still clears its slack
+    auto tailTime = [&](int to, int toPos, int from, int fromPos) {
+        int head = solution_->At(from, fromPos);
+        float connect = Transition(Predecessor(to, toPos), head);
+        double time = connect + TailTime(from, fromPos);
+        if (battery_) {
+            double drain = profiles_[from].energy[fromPos] - profiles_[to].energy[toPos]
+                         + connect - Transition(Predecessor(from, fromPos), head);
+            time += battery_->ChargeTimeDelta(profiles_[from], fromPos, drain);
+        }
+        return time;
+    };
+
+    double time1 = prefix_[robot1][pos1];
+    if (pos2 < size2) time1 += tailTime(robot1, pos1, robot2, pos2);
+    double time2 = prefix_[robot2][pos2];
+    if (pos1 < size1) time2 += tailTime(robot2, pos2, robot1, pos1);
+
+    Candidate move;
+    move.kind = MoveKind::TAILS;
+    move.robot1 = robot1;
+    move.pos1 = pos1;
+    move.robot2 = robot2;
+    move.pos2 = pos2;
+    Consider(move, time1, time2, best);
+}
+
+void GranularLocalSearch::Consider(
+    Candidate& move,
+    double newTime1,
+    double newTime2,
+    Candidate& best
+) const {
+    double old1 = RouteTotal(move.robot1);
+    if (move.robot1 == move.robot2) {
+        move.deltaMax = newTime1 - old1;
+        move.deltaSum = move.deltaMax;
+    } else {
+        double old2 = RouteTotal(move.robot2);
+        move.deltaMax = std::max(newTime1, newTime2) - std::max(old1, old2);
+        move.deltaSum = (newTime1 + newTime2) - (old1 + old2);
+    }
+
+    // Lexicographic (max, sum) against the best so far, or against no change
+    double refMax = best.kind == MoveKind::NONE ? 0.0 : best.deltaMax;
+    double refSum = best.kind == MoveKind::NONE ? 0.0 : best.deltaSum;
+    bool better = move.deltaMax < refMax - IMPROVEMENT_EPSILON ||
+        (move.deltaMax <= refMax + IMPROVEMENT_EPSILON && move.deltaSum < refSum - IMPROVEMENT_EPSILON);
+    if (better) best = move;
+}
+
+bool GranularLocalSearch::Apply(const Candidate& move) {
+    if (move.kind == MoveKind::TAILS) {
+        solution_->ExchangeTails(move.robot1, move.pos1, move.robot2, move.pos2);
+    } else {
+        segment_.clear();
+        for (int i = 0; i < move.length; ++i) {
+            segment_.push_back(solution_->Erase(move.robot1, move.pos1));
+        }
+        for (int i = 0; i < move.length; ++i) {
+            solution_->Insert(move.robot2, move.pos2 + i, segment_[i]);
+        }
+    }
+
+    // The O(1) battery screen assumed stops stay put: confirm on the exact plan
+    if (battery_) {
+        bool sameRobot = move.robot1 == move.robot2;
+        double old1 = RouteTotal(move.robot1);
+        double old2 = sameRobot ? old1 : RouteTotal(move.robot2);
+        double new1 = battery_->Plan(solution_->Route(move.robot1), move.robot1);
+        double new2 = sameRobot ? new1 : battery_->Plan(solution_->Route(move.robot2), move.robot2);
+        double deltaMax = std::max(new1, new2) - std::max(old1, old2);
+        double deltaSum = sameRobot ? deltaMax : (new1 + new2) - (old1 + old2);
+        if (deltaMax > IMPROVEMENT_EPSILON ||
+            (deltaMax >= -IMPROVEMENT_EPSILON && deltaSum >= -IMPROVEMENT_EPSILON)) {
+            solution_->Rollback();
+            return false;
+        }
+    }
+    solution_->Commit();
+
+    if (move.kind == MoveKind::TAILS) stats_.twoOptStars++;
+    else if (move.length == 1) stats_.relocates++;
+    else stats_.orOpts++;
+
+    RebuildRoute(move.robot1);
+    if (move.robot2 != move.robot1) RebuildRoute(move.robot2);
+    return true;
+}
+
+} // namespace Layer2
+} // namespace Backend
@@ -24,7 +24,8 @@ namespace Layer2 {
 VRPResult HillClimbing::Solve(
     const std::vector<Task>& tasks,
     std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const CostMatrixProvider& costs,
+    const SolveOptions& options
 ) {
     VRPResult result;
     result.algorithmName = GetName();
@@ -64,20 +65,58 @@ VRPResult HillClimbing::Solve(
     std::cout << "[HillClimbing] ETA: ~" << std::fixed << std::setprecision(0) 
               << std::max(1.0, estimatedMs) << " ms\n";
     
-    // Phase 1: Generate initial greedy solution (fast O(n*k))
-    Assignment bestAssignment = GenerateGreedySolution(tasks, robots, costs);
+    // Task endpoints and robot starts, shared by every move
+    SearchContext ctx;
+    ctx.tasks = &tasks;
+    ctx.costs = &costs;
+    ctx.scorer = RouteScorer(tasks, costs);
+    for (const auto& robot : robots) {
+        ctx.startNodes.push_back(robot.GetCurrentNodeId());
+    }
+    BatteryPlanner battery(options.battery, tasks, robots, costs);
+    if (battery.IsEnabled()) ctx.battery = &battery;
+    
+    // Granular neighbourhood: each task is only moved next to its k nearest
+    NeighborLists neighbors;
+    neighbors.Build(tasks, ctx.startNodes, costs, neighborListSize_);
+    GranularLocalSearch granular(tasks, ctx.startNodes, costs, neighbors);
+    granular.SetBatteryPlanner(ctx.battery);
+    int granularMoves = 0;
+    
+    // Phase 1: Start from the warm start, else the greedy solution (fast O(n*k))
+    Assignment bestAssignment = options.HasWarmStart()
+        ? GenerateWarmStartSolution(tasks, robots, costs, options.warmStart)
+        : GenerateGreedySolution(ctx);
     
     // Pre-compute robot times to avoid recalculating
     std::vector<double> robotTimes(numRobots);
     double bestMakespan = 0.0;
     for (int r = 0; r < numRobots; ++r) {
-        robotTimes[r] = CalculateRobotTime(r, bestAssignment[r], robots[r], costs);
+        robotTimes[r] = CalculateRobotTime(r, bestAssignment.Route(r), ctx);
         bestMakespan = std::max(bestMakespan, robotTimes[r]);
     }
     
     std::cout << "[HillClimbing] Initial greedy makespan: " 
               << std::fixed << std::setprecision(2) << bestMakespan << " px\n";
     
+    // Best-so-far report (only built when someone listens)
+    auto reportProgress = [&]() {
+        if (!options.WantsProgress()) return;
+        VRPResult progress;
+        progress.algorithmName = GetName();
+        progress.robotItineraries = AssignmentToItineraries(bestAssignment, ctx, robots);
+        progress.makespan = bestMakespan;
+        progress.isFeasible = true;
+        progress.computationTimeMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+        options.NotifyImprovement(progress);
+    };
+    reportProgress();
+    
+    // No schedule beats the lower bound: stop once close enough to it
+    double lowerBound = MakespanLowerBound(tasks, robots, costs);
+    bool reachedBound = options.ReachedBound(bestMakespan, lowerBound);
+    
     // Phase 2: Fast local search (no restarts for speed, just improve greedy)
     Assignment currentAssignment = bestAssignment;
     std::vector<double> currentTimes = robotTimes;
@@ -85,27 +124,38 @@ VRPResult HillClimbing::Solve(
     
     int totalIterations = 0;
     int improvements = 0;
+    bool stopped = false;
     
     // Simple hill climbing: try to improve until stuck
-    for (int restart = 0; restart < maxRestarts_; ++restart) {
+    for (int restart = 0; restart < maxRestarts_ && !stopped && !reachedBound; ++restart) {
         if (restart > 0) {
             // Random restart: shuffle current solution
-            currentAssignment = GenerateRandomSolution(tasks, numRobots);
-            currentMakespan = 0.0;
-            for (int r = 0; r < numRobots; ++r) {
-                currentTimes[r] = CalculateRobotTime(r, currentAssignment[r], robots[r], costs);
-                currentMakespan = std::max(currentMakespan, currentTimes[r]);
-            }
+            GenerateRandomSolution(currentAssignment, numTasks);
+        }
+        
+        // Granular descent first: cheap per pass, and it does most of the work
+        granular.Run(currentAssignment, currentTimes, options);
+        granularMoves += granular.GetStats().Moves();
+        currentMakespan = *std::max_element(currentTimes.begin(), currentTimes.end());
+        if (currentMakespan < bestMakespan) {
+            bestAssignment = currentAssignment;
+            bestMakespan = currentMakespan;
+            reportProgress();
+            reachedBound = options.ReachedBound(bestMakespan, lowerBound);
         }
         
         int noImprovement = 0;
         
-        while (noImprovement < maxIterations_) {
+        while (noImprovement < maxIterations_ && !reachedBound) {
+            if (options.ShouldStop()) {
+                stopped = true;
+                break;
+            }
             totalIterations++;
             
             // Fast improvement: only try moving from bottleneck robot
             bool improved = TryFastImprovement(currentAssignment, currentTimes, 
-                                                currentMakespan, robots, costs);
+                                                currentMakespan, ctx);
             
             if (improved) {
                 improvements++;
@@ -115,6 +165,8 @@ VRPResult HillClimbing::Solve(
                 if (currentMakespan < bestMakespan) {
                     bestAssignment = currentAssignment;
                     bestMakespan = currentMakespan;
+                    reportProgress();
+                    reachedBound = options.ReachedBound(bestMakespan, lowerBound);
                 }
             } else {
                 noImprovement++;
@@ -127,23 +179,28 @@ VRPResult HillClimbing::Solve(
     std::chrono::duration<double, std::milli> duration = endTime - startTime;
     
     std::cout << "[HillClimbing] Completed: " << totalIterations << " iterations, " 
-              << improvements << " improvements\n";
+              << improvements << " improvements, " << granularMoves << " granular moves"
+              << (reachedBound ? " (within gap of the lower bound)" : "") << "\n";
     std::cout << "[HillClimbing] Final makespan: " 
               << std::fixed << std::setprecision(2) << bestMakespan << " px\n";
     std::cout << "[HillClimbing] Computation time: " 
               << std::fixed << std::setprecision(2) << duration.count() << " ms\n";
     
     // Convert to result format
-    result.robotItineraries = AssignmentToItineraries(bestAssignment, robots);
+    result.robotItineraries = AssignmentToItineraries(bestAssignment, ctx, robots);
     result.makespan = bestMakespan;
     result.isFeasible = true;
+    result.stoppedEarly = stopped;
     result.computationTimeMs = duration.count();
     
     // Calculate total distance
     result.totalDistance = 0.0;
     for (int i = 0; i < numRobots; ++i) {
-        result.totalDistance += CalculateRobotTime(i, bestAssignment[i], robots[i], costs);
+        result.totalDistance += CalculateRobotTime(i, bestAssignment.Route(i), ctx);
     }
+    ApplyLoadPlan(result, tasks, robots, costs, options, bestAssignment);
+    ApplyBatteryPlan(result, tasks, robots, costs, options, bestAssignment);
+    result.SetLowerBound(lowerBound);
     
     // Assign itineraries to robots
     for (const auto& [robotId, itinerary] : result.robotItineraries) {
@@ -162,24 +219,35 @@ VRPResult HillClimbing::Solve(
 // SOLUTION GENERATION
 // =============================================================================
 
-HillClimbing::Assignment HillClimbing::GenerateGreedySolution(
+HillClimbing::Assignment HillClimbing::GenerateWarmStartSolution(
     const std::vector<Task>& tasks,
     const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const CostMatrixProvider& costs,
+    const std::vector<std::vector<int>>& warmStart
 ) const {
-    int numRobots = static_cast<int>(robots.size());
-    Assignment assignment(numRobots);
+    int newTasks = 0;
+    std::vector<std::vector<int>> routes = CompleteWarmStart(tasks, robots, costs, warmStart, newTasks);
+    std::cout << "[HillClimbing] Warm start: " << (tasks.size() - newTasks) << " tasks kept, "
+              << newTasks << " inserted\n";
+    
+    return FlatSolution::FromRoutes(routes);
+}
+
+HillClimbing::Assignment HillClimbing::GenerateGreedySolution(
+    const SearchContext& ctx
+) const {
+    const std::vector<Task>& tasks = *ctx.tasks;
+    const CostMatrixProvider& costs = *ctx.costs;
+    int numRobots = static_cast<int>(ctx.startNodes.size());
+    std::vector<std::vector<int>> routes(numRobots);
     
     // Track current end position and time for each robot
-    std::vector<int> currentEndNode(numRobots);
+    std::vector<int> currentEndNode = ctx.startNodes;
     std::vector<double> currentTime(numRobots, 0.0);
     
-    for (int i = 0; i < numRobots; ++i) {
-        currentEndNode[i] = robots[i].GetCurrentNodeId();
-    }
-    
     // For each task, find the best robot to assign it to
-    for (const auto& task : tasks) {
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        const Task& task = tasks[t];
         int bestRobot = 0;
         double bestFinishTime = std::numeric_limits<double>::max();
         
@@ -199,7 +267,7 @@ HillClimbing::Assignment HillClimbing::GenerateGreedySolution(
         }
         
         // Assign task to best robot
-        assignment[bestRobot].push_back(task);
+        routes[bestRobot].push_back(static_cast<int>(t));
         
         // Update robot's state
         float pickupCost = costs.GetCost(currentEndNode[bestRobot], task.sourceNode);
@@ -208,24 +276,29 @@ HillClimbing::Assignment HillClimbing::GenerateGreedySolution(
         currentEndNode[bestRobot] = task.destinationNode;
     }
     
-    return assignment;
+    return FlatSolution::FromRoutes(routes);
 }
 
-HillClimbing::Assignment HillClimbing::GenerateRandomSolution(
-    const std::vector<Task>& tasks,
-    int numRobots
+void HillClimbing::GenerateRandomSolution(
+    Assignment& assignment,
+    int numTasks
 ) const {
-    Assignment assignment(numRobots);
+    ScratchArena::Frame frame(arena_);
+    int numRobots = assignment.GetRobotCount();
     
     // Shuffle tasks and distribute round-robin
-    std::vector<Task> shuffledTasks = tasks;
+    ArenaVector<int> shuffledTasks(arena_, numTasks);
+    for (int t = 0; t < numTasks; ++t) shuffledTasks.push_back(t);
     std::shuffle(shuffledTasks.begin(), shuffledTasks.end(), rng_);
     
-    for (size_t i = 0; i < shuffledTasks.size(); ++i) {
-        assignment[i % numRobots].push_back(shuffledTasks[i]);
+    // Fill robot by robot so every insertion appends to the flat array
+    assignment.Clear();
+    for (int r = 0; r < numRobots; ++r) {
+        for (int i = r; i < numTasks; i += numRobots) {
+            assignment.PushBack(r, shuffledTasks[i]);
+        }
     }
-    
-    return assignment;
+    assignment.Commit();
 }
 
 // =============================================================================
@@ -234,13 +307,12 @@ HillClimbing::Assignment HillClimbing::GenerateRandomSolution(
 
 double HillClimbing::CalculateMakespan(
     const Assignment& assignment,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const SearchContext& ctx
 ) const {
     double makespan = 0.0;
     
-    for (size_t i = 0; i < robots.size(); ++i) {
-        double robotTime = CalculateRobotTime(i, assignment[i], robots[i], costs);
+    for (int i = 0; i < assignment.GetRobotCount(); ++i) {
+        double robotTime = CalculateRobotTime(i, assignment.Route(i), ctx);
         makespan = std::max(makespan, robotTime);
     }
     
@@ -249,27 +321,12 @@ double HillClimbing::CalculateMakespan(
 
 double HillClimbing::CalculateRobotTime(
     int robotIdx,
-    const std::vector<Task>& robotTasks,
-    const RobotAgent& robot,
-    const CostMatrixProvider& costs
+    RouteView robotTasks,
+    const SearchContext& ctx
 ) const {
-    (void)robotIdx; // Unused but kept for interface consistency
-    
     if (robotTasks.empty()) return 0.0;
-    
-    double totalTime = 0.0;
-    int currentNode = robot.GetCurrentNodeId();
-    
-    for (const auto& task : robotTasks) {
-        // Travel to pickup
-        totalTime += costs.GetCost(currentNode, task.sourceNode);
-        // Travel to dropoff
-        totalTime += costs.GetCost(task.sourceNode, task.destinationNode);
-        // Update position
-        currentNode = task.destinationNode;
-    }
-    
-    return totalTime;
+    if (ctx.battery) return ctx.battery->Plan(robotTasks, robotIdx);
+    return ctx.scorer.RouteTime(robotTasks, ctx.startNodes[robotIdx]);
 }
 
 // =============================================================================
@@ -280,10 +337,9 @@ bool HillClimbing::TryFastImprovement(
     Assignment& assignment,
     std::vector<double>& robotTimes,
     double& currentMakespan,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const SearchContext& ctx
 ) const {
-    int numRobots = static_cast<int>(robots.size());
+    int numRobots = assignment.GetRobotCount();
     
     // Find the bottleneck robot (highest completion time)
     int bottleneck = 0;
@@ -294,12 +350,15 @@ bool HillClimbing::TryFastImprovement(
     }
     
     // If bottleneck has only 1 or 0 tasks, try random swap
-    if (assignment[bottleneck].size() <= 1) {
-        return TryRandomSwap(assignment, robotTimes, currentMakespan, robots, costs);
+    int bottleneckSize = assignment.RouteSize(bottleneck);
+    if (bottleneckSize <= 1) {
+        return TryRandomSwap(assignment, robotTimes, currentMakespan, ctx);
     }
     
     // Try moving the LAST task from bottleneck (most impactful, O(1) removal)
-    Task lastTask = assignment[bottleneck].back();
+    int lastTask = assignment.At(bottleneck, bottleneckSize - 1);
+    double bottleneckNewTime = CalculateRobotTimeWithout(
+        bottleneck, assignment.Route(bottleneck), bottleneckSize - 1, ctx);
     
     // Find best target robot for this task
     int bestTarget = -1;
@@ -309,11 +368,8 @@ bool HillClimbing::TryFastImprovement(
         if (target == bottleneck) continue;
         
         // Calculate new times if we move the task
-        double bottleneckNewTime = CalculateRobotTimeWithout(
-            bottleneck, assignment[bottleneck], assignment[bottleneck].size() - 1, 
-            robots[bottleneck], costs);
         double targetNewTime = CalculateRobotTimeWithExtra(
-            target, assignment[target], lastTask, robots[target], costs);
+            target, assignment.Route(target), lastTask, ctx);
         
         // New makespan = max of all robot times
         double newMakespan = 0.0;
@@ -331,35 +387,33 @@ bool HillClimbing::TryFastImprovement(
     
     if (bestTarget >= 0) {
         // Apply the move
-        assignment[bottleneck].pop_back();
-        assignment[bestTarget].push_back(lastTask);
+        assignment.Relocate(bottleneck, bottleneckSize - 1, bestTarget, assignment.RouteSize(bestTarget));
+        assignment.Commit();
         
         // Update times
-        robotTimes[bottleneck] = CalculateRobotTime(bottleneck, assignment[bottleneck], 
-                                                     robots[bottleneck], costs);
-        robotTimes[bestTarget] = CalculateRobotTime(bestTarget, assignment[bestTarget], 
-                                                     robots[bestTarget], costs);
+        robotTimes[bottleneck] = CalculateRobotTime(bottleneck, assignment.Route(bottleneck), ctx);
+        robotTimes[bestTarget] = CalculateRobotTime(bestTarget, assignment.Route(bestTarget), ctx);
         currentMakespan = bestNewMakespan;
         return true;
     }
     
     // If moving last task doesn't help, try a random 2-opt on bottleneck
-    return TrySimple2Opt(assignment, robotTimes, currentMakespan, bottleneck, robots, costs);
+    return TrySimple2Opt(assignment, robotTimes, currentMakespan, bottleneck, ctx);
 }
 
 bool HillClimbing::TryRandomSwap(
     Assignment& assignment,
     std::vector<double>& robotTimes,
     double& currentMakespan,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const SearchContext& ctx
 ) const {
-    int numRobots = static_cast<int>(robots.size());
+    ScratchArena::Frame frame(arena_);
+    int numRobots = assignment.GetRobotCount();
     
     // Pick two random robots with tasks
-    std::vector<int> candidates;
+    ArenaVector<int> candidates(arena_, numRobots);
     for (int r = 0; r < numRobots; ++r) {
-        if (!assignment[r].empty()) candidates.push_back(r);
+        if (assignment.RouteSize(r) > 0) candidates.push_back(r);
     }
     
     if (candidates.size() < 2) return false;
@@ -373,11 +427,11 @@ bool HillClimbing::TryRandomSwap(
     int r2 = candidates[idx2];
     
     // Swap last tasks
-    std::swap(assignment[r1].back(), assignment[r2].back());
+    assignment.Swap(r1, assignment.RouteSize(r1) - 1, r2, assignment.RouteSize(r2) - 1);
     
     // Recalculate
-    double newTime1 = CalculateRobotTime(r1, assignment[r1], robots[r1], costs);
-    double newTime2 = CalculateRobotTime(r2, assignment[r2], robots[r2], costs);
+    double newTime1 = CalculateRobotTime(r1, assignment.Route(r1), ctx);
+    double newTime2 = CalculateRobotTime(r2, assignment.Route(r2), ctx);
     
     double newMakespan = 0.0;
     for (int r = 0; r < numRobots; ++r) {
@@ -387,13 +441,14 @@ bool HillClimbing::TryRandomSwap(
     }
     
     if (newMakespan < currentMakespan) {
+        assignment.Commit();
         robotTimes[r1] = newTime1;
         robotTimes[r2] = newTime2;
         currentMakespan = newMakespan;
         return true;
     } else {
         // Revert
-        std::swap(assignment[r1].back(), assignment[r2].back());
+        assignment.Rollback();
         return false;
     }
 }
@@ -403,26 +458,26 @@ bool HillClimbing::TrySimple2Opt(
     std::vector<double>& robotTimes,
     double& currentMakespan,
     int robotIdx,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const SearchContext& ctx
 ) const {
-    auto& tasks = assignment[robotIdx];
-    if (tasks.size() < 2) return false;
+    int routeSize = assignment.RouteSize(robotIdx);
+    if (routeSize < 2) return false;
     
     // Just try swapping adjacent pairs (O(n) instead of O(n²))
-    for (size_t i = 0; i < tasks.size() - 1; ++i) {
-        std::swap(tasks[i], tasks[i + 1]);
+    for (int i = 0; i < routeSize - 1; ++i) {
+        assignment.Swap(robotIdx, i, robotIdx, i + 1);
         
-        double newTime = CalculateRobotTime(robotIdx, tasks, robots[robotIdx], costs);
+        double newTime = CalculateRobotTime(robotIdx, assignment.Route(robotIdx), ctx);
         
         if (newTime < robotTimes[robotIdx]) {
+            assignment.Commit();
             double oldRobotTime = robotTimes[robotIdx];
             robotTimes[robotIdx] = newTime;
             
             // Recalculate makespan only if this was the bottleneck
             if (oldRobotTime >= currentMakespan - 0.001) {
                 double newMakespan = 0.0;
-                for (size_t r = 0; r < robots.size(); ++r) {
+                for (size_t r = 0; r < robotTimes.size(); ++r) {
                     newMakespan = std::max(newMakespan, robotTimes[r]);
                 }
                 if (newMakespan < currentMakespan) {
@@ -433,7 +488,7 @@ bool HillClimbing::TrySimple2Opt(
             return true;
         } else {
             // Revert
-            std::swap(tasks[i], tasks[i + 1]);
+            assignment.Rollback();
         }
     }
     
@@ -442,20 +497,25 @@ bool HillClimbing::TrySimple2Opt(
 
 double HillClimbing::CalculateRobotTimeWithout(
     int robotIdx,
-    const std::vector<Task>& robotTasks,
-    size_t excludeIdx,
-    const RobotAgent& robot,
-    const CostMatrixProvider& costs
+    RouteView robotTasks,
+    int excludeIdx,
+    const SearchContext& ctx
 ) const {
-    (void)robotIdx;
+    if (ctx.battery) {
+        std::vector<int> route(robotTasks.begin(), robotTasks.end());
+        route.erase(route.begin() + excludeIdx);
+        return ctx.battery->Plan(RouteView(route.data(), static_cast<int>(route.size())), robotIdx);
+    }
     
+    const std::vector<Task>& tasks = *ctx.tasks;
+    const CostMatrixProvider& costs = *ctx.costs;
     double totalTime = 0.0;
-    int currentNode = robot.GetCurrentNodeId();
+    int currentNode = ctx.startNodes[robotIdx];
     
-    for (size_t i = 0; i < robotTasks.size(); ++i) {
+    for (int i = 0; i < robotTasks.size(); ++i) {
         if (i == excludeIdx) continue;
         
-        const auto& task = robotTasks[i];
+        const Task& task = tasks[robotTasks[i]];
         totalTime += costs.GetCost(currentNode, task.sourceNode);
         totalTime += costs.GetCost(task.sourceNode, task.destinationNode);
         currentNode = task.destinationNode;
@@ -466,25 +526,32 @@ double HillClimbing::CalculateRobotTimeWithout(
 
 double HillClimbing::CalculateRobotTimeWithExtra(
     int robotIdx,
-    const std::vector<Task>& robotTasks,
-    const Task& extraTask,
-    const RobotAgent& robot,
-    const CostMatrixProvider& costs
+    RouteView robotTasks,
+    int extraTask,
+    const SearchContext& ctx
 ) const {
-    (void)robotIdx;
+    if (ctx.battery) {
+        std::vector<int> route(robotTasks.begin(), robotTasks.end());
+        route.push_back(extraTask);
+        return ctx.battery->Plan(RouteView(route.data(), static_cast<int>(route.size())), robotIdx);
+    }
     
+    const std::vector<Task>& tasks = *ctx.tasks;
+    const CostMatrixProvider& costs = *ctx.costs;
     double totalTime = 0.0;
-    int currentNode = robot.GetCurrentNodeId();
+    int currentNode = ctx.startNodes[robotIdx];
     
-    for (const auto& task : robotTasks) {
+    for (int t : robotTasks) {
+        const Task& task = tasks[t];
         totalTime += costs.GetCost(currentNode, task.sourceNode);
         totalTime += costs.GetCost(task.sourceNode, task.destinationNode);
         currentNode = task.destinationNode;
     }
     
     // Add extra task at end
-    totalTime += costs.GetCost(currentNode, extraTask.sourceNode);
-    totalTime += costs.GetCost(extraTask.sourceNode, extraTask.destinationNode);
+    const Task& extra = tasks[extraTask];
+    totalTime += costs.GetCost(currentNode, extra.sourceNode);
+    totalTime += costs.GetCost(extra.sourceNode, extra.destinationNode);
     
     return totalTime;
 }
@@ -495,70 +562,62 @@ double HillClimbing::CalculateRobotTimeWithExtra(
 
 bool HillClimbing::TryImprovement(
     Assignment& assignment,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs,
+    const SearchContext& ctx,
     double& currentMakespan
 ) const {
-    int numRobots = static_cast<int>(robots.size());
+    int numRobots = assignment.GetRobotCount();
     std::vector<double> robotTimes(numRobots);
     for (int r = 0; r < numRobots; ++r) {
-        robotTimes[r] = CalculateRobotTime(r, assignment[r], robots[r], costs);
+        robotTimes[r] = CalculateRobotTime(r, assignment.Route(r), ctx);
     }
     
-    return TryFastImprovement(const_cast<Assignment&>(assignment), robotTimes, 
-                               currentMakespan, robots, costs);
+    return TryFastImprovement(assignment, robotTimes, currentMakespan, ctx);
 }
 
 bool HillClimbing::TryInterRobotMove(
     Assignment& assignment,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs,
+    const SearchContext& ctx,
     double& currentMakespan
 ) const {
     // Delegate to fast version
-    int numRobots = static_cast<int>(robots.size());
+    int numRobots = assignment.GetRobotCount();
     std::vector<double> robotTimes(numRobots);
     for (int r = 0; r < numRobots; ++r) {
-        robotTimes[r] = CalculateRobotTime(r, assignment[r], robots[r], costs);
+        robotTimes[r] = CalculateRobotTime(r, assignment.Route(r), ctx);
     }
-    return TryFastImprovement(const_cast<Assignment&>(assignment), robotTimes, 
-                               currentMakespan, robots, costs);
+    return TryFastImprovement(assignment, robotTimes, currentMakespan, ctx);
 }
 
 bool HillClimbing::TryInterRobotSwap(
     Assignment& assignment,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs,
+    const SearchContext& ctx,
     double& currentMakespan
 ) const {
-    int numRobots = static_cast<int>(robots.size());
+    int numRobots = assignment.GetRobotCount();
     std::vector<double> robotTimes(numRobots);
     for (int r = 0; r < numRobots; ++r) {
-        robotTimes[r] = CalculateRobotTime(r, assignment[r], robots[r], costs);
+        robotTimes[r] = CalculateRobotTime(r, assignment.Route(r), ctx);
     }
-    return TryRandomSwap(const_cast<Assignment&>(assignment), robotTimes, 
-                          currentMakespan, robots, costs);
+    return TryRandomSwap(assignment, robotTimes, currentMakespan, ctx);
 }
 
 bool HillClimbing::TryIntraRobotReorder(
     Assignment& assignment,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs,
+    const SearchContext& ctx,
     double& currentMakespan
 ) const {
-    int numRobots = static_cast<int>(robots.size());
+    int numRobots = assignment.GetRobotCount();
     std::vector<double> robotTimes(numRobots);
     double maxTime = 0.0;
     int bottleneck = 0;
     for (int r = 0; r < numRobots; ++r) {
-        robotTimes[r] = CalculateRobotTime(r, assignment[r], robots[r], costs);
+        robotTimes[r] = CalculateRobotTime(r, assignment.Route(r), ctx);
         if (robotTimes[r] > maxTime) {
             maxTime = robotTimes[r];
             bottleneck = r;
         }
     }
-    return TrySimple2Opt(const_cast<Assignment&>(assignment), robotTimes, 
-                          currentMakespan, bottleneck, robots, costs);
+    return TrySimple2Opt(assignment, robotTimes, currentMakespan, bottleneck, ctx);
 }
 
 // =============================================================================
@@ -567,18 +626,21 @@ bool HillClimbing::TryIntraRobotReorder(
 
 std::map<int, std::vector<int>> HillClimbing::AssignmentToItineraries(
     const Assignment& assignment,
+    const SearchContext& ctx,
     const std::vector<RobotAgent>& robots
 ) const {
+    const std::vector<Task>& tasks = *ctx.tasks;
     std::map<int, std::vector<int>> itineraries;
     
     for (size_t i = 0; i < robots.size(); ++i) {
         int robotId = robots[i].GetRobotId();
         std::vector<int> nodes;
+        nodes.reserve(assignment.RouteSize(static_cast<int>(i)) * 2);
         
         // Expand tasks to pickup/dropoff nodes
-        for (const auto& task : assignment[i]) {
-            nodes.push_back(task.sourceNode);      // Pickup
-            nodes.push_back(task.destinationNode); // Dropoff
+        for (int t : assignment.Route(static_cast<int>(i))) {
+            nodes.push_back(tasks[t].sourceNode);      // Pickup
+            nodes.push_back(tasks[t].destinationNode); // Dropoff
         }
         
         itineraries[robotId] = std::move(nodes);
@@ -4,8 +4,11 @@
  */
 
 #include "../include/IVRPSolver.hh"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <limits>
+#include <unordered_map>
 
 namespace Backend {
 namespace Layer2 {
@@ -14,14 +17,28 @@ void VRPResult::Print() const {
     std::cout << "\n=== VRP Solution (" << algorithmName << ") ===\n";
     std::cout << "Status: " << (isFeasible ? "FEASIBLE" : "INFEASIBLE");
     if (isOptimal) std::cout << " (OPTIMAL)";
+    if (stoppedEarly) std::cout << " (STOPPED EARLY)";
     std::cout << "\n";
     
     std::cout << "Makespan: " << std::fixed << std::setprecision(2) 
-              << makespan << " units\n";
+              << makespan << " units";
+    if (lowerBound > 0.0) {
+        std::cout << " (lower bound " << lowerBound << ", gap "
+                  << std::setprecision(1) << Gap() * 100.0 << "%)";
+    }
+    std::cout << "\n";
     std::cout << "Total Distance: " << std::fixed << std::setprecision(2) 
               << totalDistance << " units\n";
     std::cout << "Computation Time: " << std::fixed << std::setprecision(3) 
               << computationTimeMs << " ms\n";
+    if (!operatorStats.empty()) {
+        std::cout << "Operators (" << weightSegments << " segments):\n";
+        for (const auto& op : operatorStats) {
+            std::cout << "  " << op.name << ": " << op.uses << " uses, " << op.improvements << " improved, "
+                      << op.newBests << " new best, weight " << std::setprecision(2)
+                      << (op.weights.empty() ? 1.0 : op.weights.back()) << "\n";
+        }
+    }
     
     std::cout << "\nRobot Itineraries:\n";
     for (const auto& [robotId, itinerary] : robotItineraries) {
@@ -35,5 +52,243 @@ void VRPResult::Print() const {
     std::cout << "=================================\n";
 }
 
+double IVRPSolver::MakespanLowerBound(
+    const std::vector<Task>& tasks,
+    const std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs
+) {
+    if (tasks.empty() || robots.empty()) return 0.0;
+
+    // Robots parked on the same node reach every pickup at the same cost
+    std::vector<int> starts;
+    starts.reserve(robots.size());
+    for (const auto& robot : robots) starts.push_back(robot.GetCurrentNodeId());
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+    bool multiPick = false;
+    for (const auto& robot : robots) multiPick = multiPick || robot.GetCapacity() > 1;
+
+    double longestTask = 0.0;
+    double totalService = 0.0;
+    for (const Task& task : tasks) {
+        float service = costs.GetCost(task.sourceNode, task.destinationNode);
+        float reach = CostMatrixProvider::GetInfinity();
+        for (int start : starts) {
+            reach = std::min(reach, costs.GetCost(start, task.sourceNode));
+        }
+        // Unreachable tasks would make the bound meaningless: leave them out
+        if (service >= CostMatrixProvider::GetInfinity() || reach >= CostMatrixProvider::GetInfinity()) continue;
+        longestTask = std::max(longestTask, static_cast<double>(reach) + service);
+        totalService += service;
+    }
+    if (multiPick) return longestTask;
+    return std::max(longestTask, totalService / static_cast<double>(robots.size()));
+}
+
+std::vector<std::vector<int>> IVRPSolver::ExtractWarmStart(
+    const std::vector<Task>& tasks,
+    const std::vector<RobotAgent>& robots
+) {
+    // (pickup, dropoff) -> unclaimed task indices, in task order
+    std::unordered_map<uint64_t, std::vector<int>> byEndpoints;
+    auto key = [](int source, int destination) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(source)) << 32) |
+               static_cast<uint32_t>(destination);
+    };
+    for (int t = static_cast<int>(tasks.size()) - 1; t >= 0; --t) {
+        byEndpoints[key(tasks[t].sourceNode, tasks[t].destinationNode)].push_back(t);
+    }
+
+    std::vector<std::vector<int>> routes(robots.size());
+    bool anyMatched = false;
+    for (size_t r = 0; r < robots.size(); ++r) {
+        // Goals not matched yet, oldest first: the pickups a dropoff may close
+        const size_t window = static_cast<size_t>(std::max(1, robots[r].GetCapacity()));
+        std::vector<int> open;
+        const GoalQueue& itinerary = robots[r].GetItinerary();
+        for (size_t i = 0; i < itinerary.size(); ++i) {
+            bool matched = false;
+            for (size_t o = 0; o < open.size() && !matched; ++o) {
+                auto it = byEndpoints.find(key(open[o], itinerary[i]));
+                if (it != byEndpoints.end() && !it->second.empty()) {
+                    routes[r].push_back(it->second.back());
+                    it->second.pop_back();
+                    open.erase(open.begin() + o);
+                    matched = true;
+                }
+            }
+            if (!matched) {
+                open.push_back(itinerary[i]);
+                if (open.size() > window) open.erase(open.begin());
+            }
+            anyMatched = anyMatched || matched;
+        }
+    }
+    if (!anyMatched) routes.clear();
+    return routes;
+}
+
+std::vector<std::vector<int>> IVRPSolver::CompleteWarmStart(
+    const std::vector<Task>& tasks,
+    const std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs,
+    const std::vector<std::vector<int>>& warmStart,
+    int& newTasks
+) {
+    const size_t numRobots = robots.size();
+    std::vector<std::vector<int>> routes(numRobots);
+    std::vector<char> assigned(tasks.size(), 0);
+
+    for (size_t r = 0; r < numRobots && r < warmStart.size(); ++r) {
+        for (int t : warmStart[r]) {
+            if (t < 0 || t >= static_cast<int>(tasks.size()) || assigned[t]) continue;
+            assigned[t] = 1;
+            routes[r].push_back(t);
+        }
+    }
+
+    auto routeTime = [&](size_t r) {
+        float time = 0.0f;
+        int node = robots[r].GetCurrentNodeId();
+        for (int task : routes[r]) {
+            time += costs.GetCost(node, tasks[task].sourceNode);
+            time += costs.GetCost(tasks[task].sourceNode, tasks[task].destinationNode);
+            node = tasks[task].destinationNode;
+        }
+        return time;
+    };
+    std::vector<float> routeTimes(numRobots);
+    for (size_t r = 0; r < numRobots; ++r) {
+        routeTimes[r] = routeTime(r);
+    }
+
+    newTasks = 0;
+    for (int t = 0; t < static_cast<int>(tasks.size()); ++t) {
+        if (assigned[t]) continue;
+
+        const int source = tasks[t].sourceNode;
+        const int destination = tasks[t].destinationNode;
+        const float service = costs.GetCost(source, destination);
+
+        size_t bestRobot = 0;
+        size_t bestPos = 0;
+        float bestTime = std::numeric_limits<float>::max();
+        for (size_t r = 0; r < numRobots; ++r) {
+            // Inserting before position pos only changes the legs around it
+            int prevNode = robots[r].GetCurrentNodeId();
+            for (size_t pos = 0; pos <= routes[r].size(); ++pos) {
+                float delta = costs.GetCost(prevNode, source) + service;
+                if (pos < routes[r].size()) {
+                    int nextSource = tasks[routes[r][pos]].sourceNode;
+                    delta += costs.GetCost(destination, nextSource) - costs.GetCost(prevNode, nextSource);
+                    prevNode = tasks[routes[r][pos]].destinationNode;
+                }
+                float time = routeTimes[r] + delta;
+                if (time < bestTime) {
+                    bestTime = time;
+                    bestRobot = r;
+                    bestPos = pos;
+                }
+            }
+        }
+        routes[bestRobot].insert(routes[bestRobot].begin() + bestPos, t);
+        routeTimes[bestRobot] = routeTime(bestRobot);
+        assigned[t] = 1;
+        newTasks++;
+    }
+    return routes;
+}
+
+void IVRPSolver::ApplyLoadPlan(
+    VRPResult& result,
+    const std::vector<Task>& tasks,
+    const std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs,
+    const SolveOptions& options,
+    const FlatSolution& routes
+) {
+    if (options.battery.IsEnabled()) return;
+    LoadPlanner planner(tasks, robots, costs);
+    if (!planner.IsEnabled()) return;
+
+    const int routeCount = std::min(routes.GetRobotCount(), static_cast<int>(robots.size()));
+    int batches = 0;
+    int multiPicks = 0;
+    result.makespan = 0.0;
+    result.totalDistance = 0.0;
+    for (int r = 0; r < routeCount; ++r) {
+        LoadProfile profile;
+        double time = planner.Plan(routes.Route(r), r, profile);
+        result.makespan = std::max(result.makespan, time);
+        result.totalDistance += time;
+        result.robotItineraries[robots[r].GetRobotId()] = planner.Itinerary(routes.Route(r), profile);
+        batches += profile.Batches();
+        multiPicks += routes.RouteSize(r) - profile.Batches();
+    }
+
+    std::cout << "[Load] " << batches << " trips, " << multiPicks << " tasks picked up with others"
+              << ", makespan " << std::fixed << std::setprecision(2) << result.makespan << "\n";
+}
+
+void IVRPSolver::ApplyBatteryPlan(
+    VRPResult& result,
+    const std::vector<Task>& tasks,
+    const std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs,
+    const SolveOptions& options,
+    const FlatSolution& routes
+) {
+    if (!options.battery.IsEnabled()) return;
+
+    BatteryPlanner planner(options.battery, tasks, robots, costs);
+    const int routeCount = std::min(routes.GetRobotCount(), static_cast<int>(robots.size()));
+    std::vector<BatteryProfile> profiles(routeCount);
+    std::vector<double> times(routeCount);
+    std::vector<ChargingStop> stops;
+    for (int r = 0; r < routeCount; ++r) {
+        times[r] = planner.Plan(routes.Route(r), r, profiles[r]);
+        planner.CollectStops(routes.Route(r), r, profiles[r], stops);
+    }
+
+    // Stops chose their chargers route by route: share them out, then
+    // re-plan the routes that stop with the chargers and queues given
+    const bool matched = options.battery.matchChargers && stops.size() > 1 &&
+                         options.battery.chargerNodes.size() > 1;
+    if (matched) {
+        ChargerAssignment assignment(options.battery.chargerNodes, costs);
+        std::vector<ChargerSlot> slots = assignment.Assign(stops);
+        std::vector<std::vector<ChargerSlot>> chargers(routeCount);
+        for (size_t s = 0; s < stops.size(); ++s) {
+            auto& route = chargers[stops[s].robot];
+            if (route.empty()) route.resize(routes.Route(stops[s].robot).size());
+            route[stops[s].position] = slots[s];
+        }
+        for (int r = 0; r < routeCount; ++r) {
+            if (!chargers[r].empty()) {
+                times[r] = planner.Plan(routes.Route(r), r, profiles[r], chargers[r]);
+            }
+        }
+    }
+
+    int stopCount = 0;
+    bool feasible = true;
+    result.makespan = 0.0;
+    result.totalDistance = 0.0;
+    for (int r = 0; r < routeCount; ++r) {
+        result.makespan = std::max(result.makespan, times[r]);
+        result.totalDistance += times[r];
+        result.robotItineraries[robots[r].GetRobotId()] = planner.Itinerary(routes.Route(r), profiles[r]);
+        stopCount += profiles[r].stops;
+        feasible = feasible && profiles[r].feasible;
+    }
+
+    std::cout << "[Battery] " << stopCount << " charging stops planned" << (matched ? " (chargers matched)" : "")
+              << ", makespan " << std::fixed << std::setprecision(2) << result.makespan << "\n";
+    if (!feasible) {
+        std::cout << "[Battery] WARNING: some tasks need more than a full battery\n";
+    }
+}
+
 } // namespace Layer2
 } // namespace Backend
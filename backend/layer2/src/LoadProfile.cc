@@ -0,0 +1,101 @@
+/**
+ * @file LoadProfile.cc
+ * @brief Implementation of the multi-pick batch planner
+ */
+
+#include "../include/LoadProfile.hh"
+#include <algorithm>
+
+namespace Backend {
+namespace Layer2 {
+
+LoadPlanner::LoadPlanner(
+    const std::vector<Task>& tasks,
+    const std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs
+)
+    : tasks_(tasks)
+    , costs_(costs) {
+    startNodes_.reserve(robots.size());
+    capacity_.reserve(robots.size());
+    for (const auto& robot : robots) {
+        startNodes_.push_back(robot.GetCurrentNodeId());
+        capacity_.push_back(std::max(1, robot.GetCapacity()));
+        enabled_ = enabled_ || capacity_.back() > 1;
+    }
+
+    serviceCost_.reserve(tasks.size());
+    for (const Task& task : tasks) {
+        serviceCost_.push_back(costs.GetCost(task.sourceNode, task.destinationNode));
+    }
+}
+
+void LoadPlanner::Walk(RouteView route, int robot, double* best, int* from) const {
+    const int size = route.size();
+    const int capacity = capacity_[robot];
+    best[0] = 0.0;
+    for (int end = 1; end <= size; ++end) {
+        // Batch [begin, end), grown backwards: each step adds the leg
+        // between two pickups and the one between their dropoffs
+        const Task& last = tasks_[route[end - 1]];
+        double pickupChain = 0.0;
+        double dropoffChain = 0.0;
+        best[end] = CostMatrixProvider::GetInfinity();
+        for (int begin = end - 1; begin >= 0 && end - begin <= capacity; --begin) {
+            const Task& first = tasks_[route[begin]];
+            if (begin < end - 1) {
+                const Task& second = tasks_[route[begin + 1]];
+                pickupChain += costs_.GetCost(first.sourceNode, second.sourceNode);
+                dropoffChain += costs_.GetCost(first.destinationNode, second.destinationNode);
+            }
+            int node = begin == 0 ? startNodes_[robot] : tasks_[route[begin - 1]].destinationNode;
+            // A single task is pickup then dropoff, as the solvers score it
+            double batch = begin == end - 1
+                ? static_cast<double>(serviceCost_[route[begin]])
+                : pickupChain + costs_.GetCost(last.sourceNode, first.destinationNode) + dropoffChain;
+            double time = best[begin] + costs_.GetCost(node, first.sourceNode) + batch;
+            // Ties keep the smaller batch
+            if (time < best[end]) {
+                best[end] = time;
+                if (from) from[end] = begin;
+            }
+        }
+    }
+}
+
+double LoadPlanner::Plan(RouteView route, int robot, LoadProfile& profile) const {
+    const int size = route.size();
+    std::vector<int> from(size + 1, 0);
+    profile.time.resize(size + 1);
+    Walk(route, robot, profile.time.data(), from.data());
+
+    profile.batchStart.clear();
+    profile.maxLoad = 0;
+    for (int end = size; end > 0; end = from[end]) {
+        profile.batchStart.push_back(from[end]);
+        profile.maxLoad = std::max(profile.maxLoad, end - from[end]);
+    }
+    std::reverse(profile.batchStart.begin(), profile.batchStart.end());
+    return profile.Total();
+}
+
+void LoadPlanner::Completion(RouteView route, int robot, std::vector<double>& completion) const {
+    completion.resize(route.size() + 1);
+    Walk(route, robot, completion.data(), nullptr);
+    completion.erase(completion.begin());
+}
+
+std::vector<int> LoadPlanner::Itinerary(RouteView route, const LoadProfile& profile) const {
+    std::vector<int> nodes;
+    nodes.reserve(route.size() * 2);
+    for (int b = 0; b < profile.Batches(); ++b) {
+        int begin = profile.batchStart[b];
+        int end = b + 1 < profile.Batches() ? profile.batchStart[b + 1] : route.size();
+        for (int k = begin; k < end; ++k) nodes.push_back(tasks_[route[k]].sourceNode);
+        for (int k = begin; k < end; ++k) nodes.push_back(tasks_[route[k]].destinationNode);
+    }
+    return nodes;
+}
+
+} // namespace Layer2
+} // namespace Backend
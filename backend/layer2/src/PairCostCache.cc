@@ -0,0 +1,105 @@
+/**
+ * @file PairCostCache.cc
+ * @brief Implementation of the sharded LRU pair-cost cache
+ */
+
+#include "../include/PairCostCache.hh"
+#include "../../common/include/MemoryUsage.hh"
+#include <algorithm>
+
+namespace Backend {
+namespace Layer2 {
+
+PairCostCache::PairCostCache(size_t capacity)
+    : shardCapacity_(std::max<size_t>(1, (capacity + SHARD_COUNT - 1) / SHARD_COUNT)) {}
+
+PairCostCache::Shard& PairCostCache::ShardFor(uint64_t key) {
+    // Mix both node IDs so rows and columns spread over the shards
+    uint64_t h = key * 0x9E3779B97F4A7C15ull;
+    return shards_[(h >> 32) % SHARD_COUNT];
+}
+
+void PairCostCache::SyncVersion(Shard& shard, uint64_t version) {
+    if (shard.version == version) return;
+    shard.lru.clear();
+    shard.index.clear();
+    shard.version = version;
+}
+
+bool PairCostCache::Find(int fromNodeId, int toNodeId, uint64_t version, float& cost) {
+    uint64_t key = MakeKey(fromNodeId, toNodeId);
+    Shard& shard = ShardFor(key);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    SyncVersion(shard, version);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    cost = it->second->second;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void PairCostCache::Insert(int fromNodeId, int toNodeId, uint64_t version, float cost) {
+    uint64_t key = MakeKey(fromNodeId, toNodeId);
+    Shard& shard = ShardFor(key);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    SyncVersion(shard, version);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        // Another thread computed the same pair meanwhile
+        it->second->second = cost;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    if (shard.lru.size() >= shardCapacity_) {
+        shard.index.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+    }
+    shard.lru.emplace_front(key, cost);
+    shard.index.emplace(key, shard.lru.begin());
+}
+
+void PairCostCache::Clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.lru.clear();
+        shard.index.clear();
+    }
+}
+
+size_t PairCostCache::GetSize() {
+    size_t total = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.lru.size();
+    }
+    return total;
+}
+
+size_t PairCostCache::GetMemoryBytes() {
+    // A list node is the entry plus two links
+    const size_t nodeBytes = sizeof(std::pair<uint64_t, float>) + 2 * sizeof(void*);
+    size_t bytes = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        bytes += shard.lru.size() * nodeBytes + Common::HashMapBytes(shard.index);
+    }
+    return bytes;
+}
+
+void PairCostCache::ResetStats() {
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace Layer2
+} // namespace Backend
@@ -0,0 +1,189 @@
+/**
+ * @file PortfolioSolver.cc
+ * @brief Implementation of the parallel VRP solver portfolio
+ */
+
+#include "../include/PortfolioSolver.hh"
+#include "../include/ALNS.hh"
+#include "../include/HillClimbing.hh"
+#include "../include/SimulatedAnnealing.hh"
+#include "../include/TabuSearch.hh"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace Backend {
+namespace Layer2 {
+
+PortfolioSolver::PortfolioSolver(std::vector<std::unique_ptr<IVRPSolver>> members,
+                                 double timeBudgetMs)
+    : members_(std::move(members))
+    , timeBudgetMs_(timeBudgetMs) {
+    if (members_.empty()) {
+        throw std::invalid_argument("PortfolioSolver: at least one member solver is required");
+    }
+    for (const auto& member : members_) {
+        if (!member) {
+            throw std::invalid_argument("PortfolioSolver: member solver is null");
+        }
+    }
+}
+
+std::vector<std::unique_ptr<IVRPSolver>> PortfolioSolver::MakeDefaultMembers(
+    int count, unsigned int baseSeed) {
+    std::vector<std::unique_ptr<IVRPSolver>> members;
+    for (int i = 0; i < count; ++i) {
+        unsigned int seed = baseSeed + static_cast<unsigned int>(i);
+        switch (i % 4) {
+            case 0: members.push_back(std::make_unique<ALNS>(100, 0.25, seed)); break;
+            case 1: members.push_back(std::make_unique<TabuSearch>(80, 15, 25, seed)); break;
+            case 2: members.push_back(std::make_unique<SimulatedAnnealing>(1000.0, 0.95, 1.0, 30, seed)); break;
+            default: members.push_back(std::make_unique<HillClimbing>(50, 5, seed)); break;
+        }
+    }
+    return members;
+}
+
+bool PortfolioSolver::IsExact() const {
+    for (const auto& member : members_) {
+        if (member->IsExact()) return true;
+    }
+    return false;
+}
+
+bool PortfolioSolver::Publish(size_t memberIndex, const VRPResult& result,
+                              const std::vector<RobotAgent>& robots) {
+    std::lock_guard<std::mutex> lock(incumbentMutex_);
+
+    bool better = !incumbent_.valid;
+    if (!better) {
+        const VRPResult& best = incumbent_.result;
+        if (result.isFeasible != best.isFeasible) {
+            better = result.isFeasible;
+        } else if (result.makespan != best.makespan) {
+            better = result.makespan < best.makespan;
+        } else {
+            better = memberIndex < incumbent_.memberIndex;
+        }
+    }
+    if (!better) return false;
+
+    incumbent_.valid = true;
+    incumbent_.result = result;
+    incumbent_.robots = robots;
+    incumbent_.memberIndex = memberIndex;
+    return true;
+}
+
+VRPResult PortfolioSolver::Solve(
+    const std::vector<Task>& tasks,
+    std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs,
+    const SolveOptions& options
+) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Members share the earlier of the portfolio budget and the caller's deadline
+    SolveOptions memberOptions = SolveOptions::WithBudget(timeBudgetMs_);
+    memberOptions.deadline = std::min(memberOptions.deadline, options.deadline);
+    memberOptions.cancelToken = options.cancelToken;
+    memberOptions.warmStart = options.warmStart;
+    memberOptions.battery = options.battery;
+    memberOptions.stopGap = options.stopGap;
+    memberOptions.scheduler = options.scheduler;
+    const bool restart = memberOptions.HasDeadline();
+
+    {
+        std::lock_guard<std::mutex> lock(incumbentMutex_);
+        incumbent_ = Incumbent();
+    }
+
+    std::cout << "[Portfolio] Solving VRP with " << members_.size() << " solvers";
+    if (timeBudgetMs_ > 0.0) {
+        std::cout << " (budget " << std::fixed << std::setprecision(0) << timeBudgetMs_ << " ms)";
+    }
+    std::cout << "\n";
+
+    std::atomic<int> totalRuns{0};
+    std::atomic<bool> reachedBound{false};      // Some run came within the stop gap
+
+    // Improvements from any member are forwarded only when they beat
+    // everything reported so far (serialised, so the callback never races)
+    std::mutex progressMutex;
+    double reportedMakespan = std::numeric_limits<double>::max();
+    auto forwardProgress = [&](const VRPResult& progress) {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        if (progress.makespan >= reportedMakespan) return;
+        reportedMakespan = progress.makespan;
+        VRPResult forwarded = progress;
+        forwarded.algorithmName = GetName() + " (" + progress.algorithmName + ")";
+        forwarded.computationTimeMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+        options.NotifyImprovement(forwarded);
+    };
+
+    // Each member owns its thread: solvers keep a mutable RNG and are not
+    // safe to share, and every run works on a private copy of the robots
+    auto worker = [&](size_t m) {
+        IVRPSolver& member = *members_[m];
+        SolveOptions runOptions = memberOptions;
+        if (options.WantsProgress()) {
+            runOptions.onImprovement = forwardProgress;
+        }
+
+        // With a deadline, restart until it passes (the RNG carries over,
+        // so each run explores differently) or any run gets close enough
+        // to the lower bound; otherwise run once
+        do {
+            std::vector<RobotAgent> runRobots = robots;
+            VRPResult result = member.Solve(tasks, runRobots, costs, runOptions);
+            if (result.isFeasible && runOptions.ReachedBound(result.makespan, result.lowerBound)) {
+                reachedBound.store(true, std::memory_order_relaxed);
+            }
+            Publish(m, result, runRobots);
+            totalRuns.fetch_add(1, std::memory_order_relaxed);
+        } while (restart && !runOptions.ShouldStop() && !reachedBound.load(std::memory_order_relaxed));
+    };
+
+    // On the caller's scheduler when there is one (no threads per solve;
+    // members beyond its free workers start once the ones ahead finish)
+    if (options.scheduler) {
+        options.scheduler->ParallelFor(members_.size(), worker);
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(members_.size() - 1);
+        for (size_t m = 0; m + 1 < members_.size(); ++m) {
+            threads.emplace_back(worker, m);
+        }
+        worker(members_.size() - 1);
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lock(incumbentMutex_);
+    VRPResult result = incumbent_.result;
+    robots = incumbent_.robots;
+
+    result.algorithmName = GetName() + " (" + incumbent_.result.algorithmName + ")";
+    result.stoppedEarly = options.ShouldStop();
+    result.computationTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+    std::cout << "[Portfolio] Best: " << incumbent_.result.algorithmName
+              << " (member " << incumbent_.memberIndex << "), makespan "
+              << std::fixed << std::setprecision(2) << result.makespan
+              << ", " << totalRuns.load() << " runs in "
+              << std::setprecision(2) << result.computationTimeMs << " ms"
+              << (reachedBound.load() ? " (within gap of the lower bound)" : "") << "\n";
+
+    return result;
+}
+
+} // namespace Layer2
+} // namespace Backend
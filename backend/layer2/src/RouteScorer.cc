@@ -0,0 +1,73 @@
+/**
+ * @file RouteScorer.cc
+ * @brief Implementation of the batched route scorer
+ */
+
+#include "../include/RouteScorer.hh"
+
+namespace Backend {
+namespace Layer2 {
+
+RouteScorer::RouteScorer(const std::vector<Task>& tasks, const CostMatrixProvider& costs)
+    : tasks_(&tasks)
+    , costs_(&costs) {
+    slots_.reserve(tasks.size() * 2);
+    slotted_ = true;
+    for (const Task& task : tasks) {
+        slots_.push_back(costs.GetSlot(task.sourceNode));
+        slots_.push_back(costs.GetSlot(task.destinationNode));
+        slotted_ = slotted_ && slots_[slots_.size() - 2] >= 0 && slots_.back() >= 0;
+    }
+}
+
+double RouteScorer::RouteTime(RouteView route, int startNode, float* legs) const {
+    if (route.empty()) return 0.0;
+    if (!slotted_) return WalkRoute(route, startNode, legs);
+
+    // Robot starts usually have no slot: the first leg is looked up alone
+    float first = costs_->GetCost(startNode, (*tasks_)[route[0]].sourceNode);
+    if (legs) legs[0] = first;
+    double total = first;
+
+    // The rest a chunk of slots at a time, each chunk starting where the
+    // previous one ended
+    constexpr int CHUNK = 128;
+    int buffer[CHUNK];
+    int count = 0;
+    size_t leg = 1;
+    auto flush = [&]() {
+        total += costs_->GetPathCostBySlots(buffer, count, legs ? legs + leg : nullptr);
+        leg += count - 1;
+        buffer[0] = buffer[count - 1];
+        count = 1;
+    };
+    for (int t : route) {
+        if (count + 2 > CHUNK) flush();
+        buffer[count++] = slots_[2 * t];
+        buffer[count++] = slots_[2 * t + 1];
+    }
+    flush();
+    return total;
+}
+
+double RouteScorer::WalkRoute(RouteView route, int startNode, float* legs) const {
+    double total = 0.0;
+    int node = startNode;
+    int k = 0;
+    for (int t : route) {
+        const Task& task = (*tasks_)[t];
+        float toPickup = costs_->GetCost(node, task.sourceNode);
+        float service = costs_->GetCost(task.sourceNode, task.destinationNode);
+        if (legs) {
+            legs[k++] = toPickup;
+            legs[k++] = service;
+        }
+        total += toPickup;
+        total += service;
+        node = task.destinationNode;
+    }
+    return total;
+}
+
+} // namespace Layer2
+} // namespace Backend
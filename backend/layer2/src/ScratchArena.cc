@@ -0,0 +1,63 @@
+/**
+ * @file ScratchArena.cc
+ * @brief Implementation of the solver scratch arena
+ */
+
+#include "../include/ScratchArena.hh"
+#include <cstdint>
+
+namespace Backend {
+namespace Layer2 {
+
+ScratchArena::ScratchArena(size_t blockSize)
+    : blockSize_(blockSize > 0 ? blockSize : DEFAULT_BLOCK_SIZE) {}
+
+void* ScratchArena::AllocateBytes(size_t bytes, size_t alignment) {
+    while (true) {
+        if (block_ < blocks_.size()) {
+            Block& block = blocks_[block_];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            size_t start = ((base + offset_ + alignment - 1) & ~(alignment - 1)) - base;
+            if (start + bytes <= block.size) {
+                offset_ = start + bytes;
+                return block.data.get() + start;
+            }
+            // Blocks chained by an earlier overflow are reused before new ones
+            if (block_ + 1 < blocks_.size()) {
+                ++block_;
+                offset_ = 0;
+                continue;
+            }
+        }
+
+        size_t size = blocks_.empty() ? blockSize_ : blocks_.back().size * 2;
+        while (size < bytes + alignment) size *= 2;
+        blocks_.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+        block_ = blocks_.size() - 1;
+        offset_ = 0;
+    }
+}
+
+void ScratchArena::Rewind(size_t block, size_t offset) {
+    block_ = block;
+    offset_ = offset;
+
+    // Fully rewound after an overflow: merge into one block that fits the
+    // high-water mark, so the next pass needs no chaining
+    if (block == 0 && offset == 0 && blocks_.size() > 1) {
+        size_t total = GetCapacity();
+        blocks_.clear();
+        blocks_.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[total]), total});
+    }
+}
+
+size_t ScratchArena::GetCapacity() const {
+    size_t total = 0;
+    for (const Block& block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+} // namespace Layer2
+} // namespace Backend
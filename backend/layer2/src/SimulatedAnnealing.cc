@@ -19,7 +19,8 @@ namespace Layer2 {
 VRPResult SimulatedAnnealing::Solve(
     const std::vector<Task>& tasks,
     std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const CostMatrixProvider& costs,
+    const SolveOptions& options
 ) {
     VRPResult result;
     result.algorithmName = GetName();
@@ -60,61 +61,98 @@ VRPResult SimulatedAnnealing::Solve(
     std::cout << "[SA] ETA: ~" << std::fixed << std::setprecision(0) 
               << std::max(1.0, estimatedMs) << " ms (" << tempSteps << " temp steps)\n";
     
-    // Phase 1: Generate initial greedy solution
-    Assignment currentSolution = GenerateGreedySolution(tasks, robots, costs);
-    double currentMakespan = CalculateMakespan(currentSolution, robots, costs);
+    // Task endpoints and robot starts shared by every chain
+    SearchContext ctx;
+    ctx.tasks = &tasks;
+    ctx.costs = &costs;
+    ctx.scorer = RouteScorer(tasks, costs);
+    for (const auto& robot : robots) {
+        ctx.startNodes.push_back(robot.GetCurrentNodeId());
+    }
+    BatteryPlanner battery(options.battery, tasks, robots, costs);
+    if (battery.IsEnabled()) ctx.battery = &battery;
+    
+    // Phase 1: Start from the warm start, else the greedy solution
+    ChainState chain;
+    chain.current = options.HasWarmStart()
+        ? GenerateWarmStartSolution(tasks, robots, costs, options.warmStart)
+        : GenerateGreedySolution(ctx);
+    EvaluateChain(chain, ctx);
     
-    Assignment bestSolution = currentSolution;
-    double bestMakespan = currentMakespan;
+    Assignment bestSolution = chain.current;
+    double bestMakespan = chain.currentMakespan;
     
     std::cout << "[SA] Initial greedy makespan: " 
-              << std::fixed << std::setprecision(2) << currentMakespan << " px\n";
+              << std::fixed << std::setprecision(2) << chain.currentMakespan << " px\n";
+    
+    // Best-so-far report (only built when someone listens)
+    auto reportProgress = [&]() {
+        if (!options.WantsProgress()) return;
+        VRPResult progress;
+        progress.algorithmName = GetName();
+        progress.robotItineraries = AssignmentToItineraries(bestSolution, ctx, robots);
+        progress.makespan = bestMakespan;
+        progress.isFeasible = true;
+        progress.computationTimeMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+        options.NotifyImprovement(progress);
+    };
+    reportProgress();
     
-    // Phase 2: Simulated Annealing loop
-    double temperature = initialTemperature_;
+    // No schedule beats the lower bound: stop once close enough to it
+    double lowerBound = MakespanLowerBound(tasks, robots, costs);
+    bool reachedBound = options.ReachedBound(bestMakespan, lowerBound);
+    
+    // Phase 2: Simulated Annealing loop (or parallel tempering)
     int totalIter = 0;
     int accepted = 0;
     int improved = 0;
+    bool stopped = false;
     
-    while (temperature > minTemperature_) {
-        for (int i = 0; i < iterationsPerTemp_; ++i) {
-            totalIter++;
-            
-            // Generate neighbor
-            Assignment neighbor = GenerateNeighbor(currentSolution, robots);
-            double neighborMakespan = CalculateMakespan(neighbor, robots, costs);
-            
-            double delta = neighborMakespan - currentMakespan;
-            
-            // Accept or reject
-            bool accept = false;
-            if (delta < 0) {
-                // Better solution - always accept
-                accept = true;
-                improved++;
-            } else {
-                // Worse solution - accept with probability exp(-delta/T)
-                double probability = std::exp(-delta / temperature);
-                if (uniformDist_(rng_) < probability) {
-                    accept = true;
+    if (replicaCount_ > 1 && !reachedBound) {
+        TemperingStats stats;
+        RunParallelTempering(chain, totalIterations, ctx, options,
+                             bestSolution, bestMakespan, reportProgress, lowerBound, stats);
+        totalIter = stats.iterations;
+        accepted = stats.accepted;
+        improved = stats.improved;
+        stopped = stats.stopped;
+        reachedBound = stats.reachedBound;
+        std::cout << "[SA] Parallel tempering: " << replicaCount_ << " replicas, "
+                  << stats.exchangesAccepted << "/" << stats.exchangesTried << " exchanges accepted\n";
+    } else {
+        double temperature = initialTemperature_;
+        
+        while (temperature > minTemperature_ && !stopped && !reachedBound) {
+            for (int i = 0; i < iterationsPerTemp_; ++i) {
+                if (options.ShouldStop()) {
+                    stopped = true;
+                    break;
                 }
-            }
-            
-            if (accept) {
-                accepted++;
-                currentSolution = neighbor;
-                currentMakespan = neighborMakespan;
+                totalIter++;
+                
+                StepResult step = MetropolisStep(chain, temperature, rng_, arena_, ctx);
+                if (step.improved) improved++;
                 
-                // Update best
-                if (currentMakespan < bestMakespan) {
-                    bestSolution = currentSolution;
-                    bestMakespan = currentMakespan;
+                if (step.accepted) {
+                    accepted++;
+                    
+                    // Update best
+                    if (chain.currentMakespan < bestMakespan) {
+                        bestSolution = chain.current;
+                        bestMakespan = chain.currentMakespan;
+                        reportProgress();
+                        if (options.ReachedBound(bestMakespan, lowerBound)) {
+                            reachedBound = true;
+                            break;
+                        }
+                    }
                 }
             }
+            
+            // Cool down
+            temperature *= coolingRate_;
         }
-        
-        // Cool down
-        temperature *= coolingRate_;
     }
     
     // Record timing
@@ -122,23 +160,28 @@ VRPResult SimulatedAnnealing::Solve(
     std::chrono::duration<double, std::milli> duration = endTime - startTime;
     
     std::cout << "[SA] Completed: " << totalIter << " iterations, " 
-              << accepted << " accepted, " << improved << " improvements\n";
+              << accepted << " accepted, " << improved << " improvements"
+              << (reachedBound ? " (within gap of the lower bound)" : "") << "\n";
     std::cout << "[SA] Final makespan: " 
               << std::fixed << std::setprecision(2) << bestMakespan << " px\n";
     std::cout << "[SA] Computation time: " 
               << std::fixed << std::setprecision(2) << duration.count() << " ms\n";
     
     // Convert to result format
-    result.robotItineraries = AssignmentToItineraries(bestSolution, robots);
+    result.robotItineraries = AssignmentToItineraries(bestSolution, ctx, robots);
     result.makespan = bestMakespan;
     result.isFeasible = true;
+    result.stoppedEarly = stopped;
     result.computationTimeMs = duration.count();
     
     // Calculate total distance
     result.totalDistance = 0.0;
-    for (size_t i = 0; i < robots.size(); ++i) {
-        result.totalDistance += CalculateRobotTime(bestSolution[i], robots[i], costs);
+    for (int i = 0; i < numRobots; ++i) {
+        result.totalDistance += CalculateRobotTime(bestSolution.Route(i), i, ctx);
     }
+    ApplyLoadPlan(result, tasks, robots, costs, options, bestSolution);
+    ApplyBatteryPlan(result, tasks, robots, costs, options, bestSolution);
+    result.SetLowerBound(lowerBound);
     
     // Assign itineraries to robots
     for (const auto& [robotId, itinerary] : result.robotItineraries) {
@@ -157,22 +200,33 @@ VRPResult SimulatedAnnealing::Solve(
 // SOLUTION GENERATION
 // =============================================================================
 
-SimulatedAnnealing::Assignment SimulatedAnnealing::GenerateGreedySolution(
+SimulatedAnnealing::Assignment SimulatedAnnealing::GenerateWarmStartSolution(
     const std::vector<Task>& tasks,
     const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const CostMatrixProvider& costs,
+    const std::vector<std::vector<int>>& warmStart
 ) const {
-    int numRobots = static_cast<int>(robots.size());
-    Assignment assignment(numRobots);
+    int newTasks = 0;
+    std::vector<std::vector<int>> routes = CompleteWarmStart(tasks, robots, costs, warmStart, newTasks);
+    std::cout << "[SA] Warm start: " << (tasks.size() - newTasks) << " tasks kept, "
+              << newTasks << " inserted\n";
     
-    std::vector<int> currentEndNode(numRobots);
-    std::vector<double> currentTime(numRobots, 0.0);
+    return FlatSolution::FromRoutes(routes);
+}
+
+SimulatedAnnealing::Assignment SimulatedAnnealing::GenerateGreedySolution(
+    const SearchContext& ctx
+) const {
+    const std::vector<Task>& tasks = *ctx.tasks;
+    const CostMatrixProvider& costs = *ctx.costs;
+    int numRobots = static_cast<int>(ctx.startNodes.size());
+    std::vector<std::vector<int>> routes(numRobots);
     
-    for (int i = 0; i < numRobots; ++i) {
-        currentEndNode[i] = robots[i].GetCurrentNodeId();
-    }
+    std::vector<int> currentEndNode = ctx.startNodes;
+    std::vector<double> currentTime(numRobots, 0.0);
     
-    for (const auto& task : tasks) {
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        const Task& task = tasks[t];
         int bestRobot = 0;
         double bestFinishTime = std::numeric_limits<double>::max();
         
@@ -187,148 +241,302 @@ SimulatedAnnealing::Assignment SimulatedAnnealing::GenerateGreedySolution(
             }
         }
         
-        assignment[bestRobot].push_back(task);
+        routes[bestRobot].push_back(static_cast<int>(t));
         float pickupCost = costs.GetCost(currentEndNode[bestRobot], task.sourceNode);
         float deliveryCost = costs.GetCost(task.sourceNode, task.destinationNode);
         currentTime[bestRobot] += pickupCost + deliveryCost;
         currentEndNode[bestRobot] = task.destinationNode;
     }
     
-    return assignment;
+    return FlatSolution::FromRoutes(routes);
 }
 
 // =============================================================================
 // COST CALCULATION
 // =============================================================================
 
-double SimulatedAnnealing::CalculateMakespan(
-    const Assignment& assignment,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
-) const {
-    double makespan = 0.0;
+void SimulatedAnnealing::EvaluateChain(ChainState& state, const SearchContext& ctx) const {
+    int numRobots = state.current.GetRobotCount();
+    state.robotTimes.resize(numRobots);
+    state.currentMakespan = 0.0;
     
-    for (size_t i = 0; i < robots.size(); ++i) {
-        double robotTime = CalculateRobotTime(assignment[i], robots[i], costs);
-        makespan = std::max(makespan, robotTime);
+    for (int r = 0; r < numRobots; ++r) {
+        state.robotTimes[r] = CalculateRobotTime(state.current.Route(r), r, ctx);
+        state.currentMakespan = std::max(state.currentMakespan, state.robotTimes[r]);
     }
-    
-    return makespan;
 }
 
 double SimulatedAnnealing::CalculateRobotTime(
-    const std::vector<Task>& robotTasks,
-    const RobotAgent& robot,
-    const CostMatrixProvider& costs
+    RouteView route,
+    int robot,
+    const SearchContext& ctx
 ) const {
-    if (robotTasks.empty()) return 0.0;
-    
-    double totalTime = 0.0;
-    int currentNode = robot.GetCurrentNodeId();
-    
-    for (const auto& task : robotTasks) {
-        totalTime += costs.GetCost(currentNode, task.sourceNode);
-        totalTime += costs.GetCost(task.sourceNode, task.destinationNode);
-        currentNode = task.destinationNode;
-    }
-    
-    return totalTime;
+    if (route.empty()) return 0.0;
+    if (ctx.battery) return ctx.battery->Plan(route, robot);
+    return ctx.scorer.RouteTime(route, ctx.startNodes[robot]);
 }
 
 // =============================================================================
 // NEIGHBOR GENERATION
 // =============================================================================
 
-SimulatedAnnealing::Assignment SimulatedAnnealing::GenerateNeighbor(
-    const Assignment& current,
-    const std::vector<RobotAgent>& robots
+void SimulatedAnnealing::ApplyRandomMove(
+    Assignment& solution,
+    std::mt19937& rng,
+    ScratchArena& arena,
+    int& robotA,
+    int& robotB
 ) const {
-    Assignment neighbor = current;
-    int numRobots = static_cast<int>(robots.size());
+    ScratchArena::Frame frame(arena);
+    int numRobots = solution.GetRobotCount();
+    robotA = -1;
+    robotB = -1;
     
     // Choose a random move type
     std::uniform_int_distribution<int> moveTypeDist(0, 2);
-    int moveType = moveTypeDist(rng_);
+    int moveType = moveTypeDist(rng);
     
     switch (moveType) {
         case 0: {
             // Move: Transfer a task from one robot to another
-            std::vector<int> nonEmpty;
+            ArenaVector<int> nonEmpty(arena, numRobots);
             for (int r = 0; r < numRobots; ++r) {
-                if (!neighbor[r].empty()) nonEmpty.push_back(r);
+                if (solution.RouteSize(r) > 0) nonEmpty.push_back(r);
             }
             if (nonEmpty.empty()) break;
             
             std::uniform_int_distribution<size_t> srcDist(0, nonEmpty.size() - 1);
-            int srcRobot = nonEmpty[srcDist(rng_)];
+            int srcRobot = nonEmpty[srcDist(rng)];
             
-            std::uniform_int_distribution<size_t> taskDist(0, neighbor[srcRobot].size() - 1);
-            size_t taskIdx = taskDist(rng_);
+            std::uniform_int_distribution<int> taskDist(0, solution.RouteSize(srcRobot) - 1);
+            int taskIdx = taskDist(rng);
             
             std::uniform_int_distribution<int> dstDist(0, numRobots - 1);
-            int dstRobot = dstDist(rng_);
+            int dstRobot = dstDist(rng);
             
             if (dstRobot != srcRobot) {
-                Task task = neighbor[srcRobot][taskIdx];
-                neighbor[srcRobot].erase(neighbor[srcRobot].begin() + taskIdx);
-                
                 // Insert at random position in destination
-                if (neighbor[dstRobot].empty()) {
-                    neighbor[dstRobot].push_back(task);
-                } else {
-                    std::uniform_int_distribution<size_t> posDist(0, neighbor[dstRobot].size());
-                    size_t pos = posDist(rng_);
-                    neighbor[dstRobot].insert(neighbor[dstRobot].begin() + pos, task);
+                int pos = 0;
+                if (solution.RouteSize(dstRobot) > 0) {
+                    std::uniform_int_distribution<int> posDist(0, solution.RouteSize(dstRobot));
+                    pos = posDist(rng);
                 }
+                solution.Relocate(srcRobot, taskIdx, dstRobot, pos);
+                robotA = srcRobot;
+                robotB = dstRobot;
             }
             break;
         }
         
         case 1: {
             // Swap: Exchange tasks between two robots
-            std::vector<int> nonEmpty;
+            ArenaVector<int> nonEmpty(arena, numRobots);
             for (int r = 0; r < numRobots; ++r) {
-                if (!neighbor[r].empty()) nonEmpty.push_back(r);
+                if (solution.RouteSize(r) > 0) nonEmpty.push_back(r);
             }
             if (nonEmpty.size() < 2) break;
             
             std::uniform_int_distribution<size_t> robotDist(0, nonEmpty.size() - 1);
-            size_t idx1 = robotDist(rng_);
-            size_t idx2 = robotDist(rng_);
-            while (idx2 == idx1) idx2 = robotDist(rng_);
+            size_t idx1 = robotDist(rng);
+            size_t idx2 = robotDist(rng);
+            while (idx2 == idx1) idx2 = robotDist(rng);
             
             int r1 = nonEmpty[idx1];
             int r2 = nonEmpty[idx2];
             
-            std::uniform_int_distribution<size_t> task1Dist(0, neighbor[r1].size() - 1);
-            std::uniform_int_distribution<size_t> task2Dist(0, neighbor[r2].size() - 1);
+            std::uniform_int_distribution<int> task1Dist(0, solution.RouteSize(r1) - 1);
+            std::uniform_int_distribution<int> task2Dist(0, solution.RouteSize(r2) - 1);
+            int pos1 = task1Dist(rng);
+            int pos2 = task2Dist(rng);
             
-            std::swap(neighbor[r1][task1Dist(rng_)], neighbor[r2][task2Dist(rng_)]);
+            solution.Swap(r1, pos1, r2, pos2);
+            robotA = r1;
+            robotB = r2;
             break;
         }
         
         case 2: {
             // Reorder: Swap two tasks within the same robot
-            std::vector<int> withMultiple;
+            ArenaVector<int> withMultiple(arena, numRobots);
             for (int r = 0; r < numRobots; ++r) {
-                if (neighbor[r].size() >= 2) withMultiple.push_back(r);
+                if (solution.RouteSize(r) >= 2) withMultiple.push_back(r);
             }
             if (withMultiple.empty()) break;
             
             std::uniform_int_distribution<size_t> robotDist(0, withMultiple.size() - 1);
-            int robot = withMultiple[robotDist(rng_)];
+            int robot = withMultiple[robotDist(rng)];
             
-            std::uniform_int_distribution<size_t> taskDist(0, neighbor[robot].size() - 1);
-            size_t idx1 = taskDist(rng_);
-            size_t idx2 = taskDist(rng_);
-            while (idx2 == idx1) idx2 = taskDist(rng_);
+            std::uniform_int_distribution<int> taskDist(0, solution.RouteSize(robot) - 1);
+            int idx1 = taskDist(rng);
+            int idx2 = taskDist(rng);
+            while (idx2 == idx1) idx2 = taskDist(rng);
             
-            std::swap(neighbor[robot][idx1], neighbor[robot][idx2]);
+            solution.Swap(robot, idx1, robot, idx2);
+            robotA = robot;
             break;
         }
     }
+}
+
+SimulatedAnnealing::StepResult SimulatedAnnealing::MetropolisStep(
+    ChainState& state,
+    double temperature,
+    std::mt19937& rng,
+    ScratchArena& arena,
+    const SearchContext& ctx
+) const {
+    StepResult step;
     
-    return neighbor;
+    // Generate the neighbour in place; only its changed routes are re-walked
+    int robotA;
+    int robotB;
+    ApplyRandomMove(state.current, rng, arena, robotA, robotB);
+    
+    double timeA = robotA >= 0 ? CalculateRobotTime(state.current.Route(robotA), robotA, ctx) : 0.0;
+    double timeB = robotB >= 0 ? CalculateRobotTime(state.current.Route(robotB), robotB, ctx) : 0.0;
+    double neighborMakespan = 0.0;
+    for (int r = 0; r < static_cast<int>(state.robotTimes.size()); ++r) {
+        double time = r == robotA ? timeA : r == robotB ? timeB : state.robotTimes[r];
+        neighborMakespan = std::max(neighborMakespan, time);
+    }
+    
+    double delta = neighborMakespan - state.currentMakespan;
+    
+    // Accept or reject
+    if (delta < 0) {
+        // Better solution - always accept
+        step.accepted = true;
+        step.improved = true;
+    } else {
+        // Worse solution - accept with probability exp(-delta/T)
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        double probability = std::exp(-delta / temperature);
+        step.accepted = uniform(rng) < probability;
+    }
+    
+    if (step.accepted) {
+        state.current.Commit();
+        if (robotA >= 0) state.robotTimes[robotA] = timeA;
+        if (robotB >= 0) state.robotTimes[robotB] = timeB;
+        state.currentMakespan = neighborMakespan;
+    } else {
+        state.current.Rollback();
+    }
+    return step;
+}
+
+// =============================================================================
+// PARALLEL TEMPERING
+// =============================================================================
+
+void SimulatedAnnealing::RunParallelTempering(
+    const ChainState& initial,
+    int stepsPerReplica,
+    const SearchContext& ctx,
+    const SolveOptions& options,
+    Assignment& bestSolution,
+    double& bestMakespan,
+    const std::function<void()>& onImprovement,
+    double lowerBound,
+    TemperingStats& stats
+) const {
+    const int numReplicas = replicaCount_;
+    
+    // Replica k gets seed + k; an unseeded solver draws its base seed once
+    unsigned int baseSeed = seed_ != 0 ? seed_ : static_cast<unsigned int>(rng_());
+    
+    // Geometric ladder, coldest first
+    std::vector<Replica> replicas(numReplicas);
+    double ratio = initialTemperature_ / minTemperature_;
+    for (int k = 0; k < numReplicas; ++k) {
+        Replica& replica = replicas[k];
+        replica.state = initial;
+        replica.best = initial.current;
+        replica.bestMakespan = initial.currentMakespan;
+        replica.temperature = minTemperature_ * std::pow(ratio, static_cast<double>(k) / (numReplicas - 1));
+        replica.rng.seed(baseSeed + static_cast<unsigned int>(k));
+    }
+    
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<char> finished(numReplicas, 0);
+    int round = 0;
+    
+    for (int done = 0; done < stepsPerReplica; done += exchangeInterval_, ++round) {
+        int steps = std::min(exchangeInterval_, stepsPerReplica - done);
+        
+        // Each replica owns its state, RNG and scratch, so the jobs share nothing
+        auto runReplica = [&](size_t k) {
+            finished[k] = RunReplicaSteps(replicas[k], steps, ctx, options) ? 0 : 1;
+        };
+        if (options.scheduler) {
+            options.scheduler->ParallelFor(static_cast<size_t>(numReplicas), runReplica);
+        } else {
+            for (int k = 0; k < numReplicas; ++k) {
+                runReplica(static_cast<size_t>(k));
+            }
+        }
+        
+        // Publish the best replica
+        for (const Replica& replica : replicas) {
+            if (replica.bestMakespan < bestMakespan) {
+                bestSolution = replica.best;
+                bestMakespan = replica.bestMakespan;
+                onImprovement();
+            }
+        }
+        
+        if (std::find(finished.begin(), finished.end(), 1) != finished.end()) {
+            stats.stopped = true;
+            break;
+        }
+        if (options.ReachedBound(bestMakespan, lowerBound)) {
+            stats.reachedBound = true;
+            break;
+        }
+        
+        // Exchange neighbouring rungs, alternating even and odd pairs
+        for (int k = round % 2; k + 1 < numReplicas; k += 2) {
+            Replica& cold = replicas[k];
+            Replica& hot = replicas[k + 1];
+            double exponent = (cold.state.currentMakespan - hot.state.currentMakespan) *
+                              (1.0 / cold.temperature - 1.0 / hot.temperature);
+            stats.exchangesTried++;
+            if (exponent >= 0.0 || uniform(rng_) < std::exp(exponent)) {
+                std::swap(cold.state, hot.state);
+                stats.exchangesAccepted++;
+            }
+        }
+    }
+    
+    for (const Replica& replica : replicas) {
+        stats.iterations += replica.iterations;
+        stats.accepted += replica.accepted;
+        stats.improved += replica.improved;
+    }
+}
+
+bool SimulatedAnnealing::RunReplicaSteps(
+    Replica& replica,
+    int steps,
+    const SearchContext& ctx,
+    const SolveOptions& options
+) const {
+    for (int i = 0; i < steps; ++i) {
+        if (options.ShouldStop()) return false;
+        replica.iterations++;
+        
+        StepResult step = MetropolisStep(replica.state, replica.temperature, replica.rng, replica.arena, ctx);
+        if (step.improved) replica.improved++;
+        
+        if (step.accepted) {
+            replica.accepted++;
+            if (replica.state.currentMakespan < replica.bestMakespan) {
+                replica.best = replica.state.current;
+                replica.bestMakespan = replica.state.currentMakespan;
+            }
+        }
+    }
+    return true;
 }
 
 // =============================================================================
@@ -337,17 +545,20 @@ SimulatedAnnealing::Assignment SimulatedAnnealing::GenerateNeighbor(
 
 std::map<int, std::vector<int>> SimulatedAnnealing::AssignmentToItineraries(
     const Assignment& assignment,
+    const SearchContext& ctx,
     const std::vector<RobotAgent>& robots
 ) const {
+    const std::vector<Task>& tasks = *ctx.tasks;
     std::map<int, std::vector<int>> itineraries;
     
     for (size_t i = 0; i < robots.size(); ++i) {
         int robotId = robots[i].GetRobotId();
         std::vector<int> nodes;
+        nodes.reserve(assignment.RouteSize(static_cast<int>(i)) * 2);
         
-        for (const auto& task : assignment[i]) {
-            nodes.push_back(task.sourceNode);
-            nodes.push_back(task.destinationNode);
+        for (int t : assignment.Route(static_cast<int>(i))) {
+            nodes.push_back(tasks[t].sourceNode);
+            nodes.push_back(tasks[t].destinationNode);
         }
         
         itineraries[robotId] = std::move(nodes);
@@ -19,7 +19,8 @@ namespace Layer2 {
 VRPResult TabuSearch::Solve(
     const std::vector<Task>& tasks,
     std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const CostMatrixProvider& costs,
+    const SolveOptions& options
 ) {
     VRPResult result;
     result.algorithmName = GetName();
@@ -50,56 +51,113 @@ VRPResult TabuSearch::Solve(
     int numTasks = static_cast<int>(tasks.size());
     int numRobots = static_cast<int>(robots.size());
     
-    std::cout << "[TS] Solving VRP: " << numTasks 
+    std::cout << "[TS] Solving VRP: " << numTasks
               << " tasks, " << numRobots << " robots\n";
     
     // Estimate time
     double estimatedMs = maxIterations_ * neighborhoodSize_ * 0.05;
-    std::cout << "[TS] ETA: ~" << std::fixed << std::setprecision(0) 
+    std::cout << "[TS] ETA: ~" << std::fixed << std::setprecision(0)
               << std::max(1.0, estimatedMs) << " ms (tabu tenure=" << tabuTenure_ << ")\n";
     
-    // Phase 1: Generate initial greedy solution
-    Assignment currentSolution = GenerateGreedySolution(tasks, robots, costs);
-    double currentMakespan = CalculateMakespan(currentSolution, robots, costs);
+    // Task endpoints and robot starts, looked up once for the whole search
+    SearchContext ctx;
+    ctx.tasks = &tasks;
+    ctx.costs = &costs;
+    ctx.scorer = RouteScorer(tasks, costs);
+    for (const auto& robot : robots) {
+        ctx.startNodes.push_back(robot.GetCurrentNodeId());
+    }
+    ctx.serviceCost.reserve(numTasks);
+    for (const Task& task : tasks) {
+        ctx.serviceCost.push_back(costs.GetCost(task.sourceNode, task.destinationNode));
+    }
+    ctx.candidates.Build(tasks, ctx.startNodes, costs, candidateListSize_);
+    BatteryPlanner battery(options.battery, tasks, robots, costs);
+    if (battery.IsEnabled()) ctx.battery = &battery;
+    
+    // Phase 1: Start from the warm start, else the greedy solution
+    Routes currentRoutes = options.HasWarmStart()
+        ? GenerateWarmStartSolution(tasks, robots, costs, options.warmStart)
+        : GenerateGreedySolution(ctx);
+    
+    std::vector<double> routeTimes(numRobots);
+    std::vector<TaskSlot> slots(numTasks);
+    double currentMakespan = 0.0;
+    for (int r = 0; r < numRobots; ++r) {
+        routeTimes[r] = CalculateRobotTime(currentRoutes.Route(r), r, ctx);
+        currentMakespan = std::max(currentMakespan, routeTimes[r]);
+        for (int p = 0; p < currentRoutes.RouteSize(r); ++p) {
+            slots[currentRoutes.At(r, p)] = {r, p};
+        }
+    }
     
-    Assignment bestSolution = currentSolution;
+    Routes bestRoutes = currentRoutes;
     double bestMakespan = currentMakespan;
     
-    std::cout << "[TS] Initial greedy makespan: " 
+    std::cout << "[TS] Initial greedy makespan: "
               << std::fixed << std::setprecision(2) << currentMakespan << " px\n";
     
+    // Best-so-far report (only built when someone listens)
+    auto reportProgress = [&]() {
+        if (!options.WantsProgress()) return;
+        VRPResult progress;
+        progress.algorithmName = GetName();
+        progress.robotItineraries = RoutesToItineraries(bestRoutes, ctx, robots);
+        progress.makespan = bestMakespan;
+        progress.isFeasible = true;
+        progress.computationTimeMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+        options.NotifyImprovement(progress);
+    };
+    reportProgress();
+    
+    // No schedule beats the lower bound: stop once close enough to it
+    double lowerBound = MakespanLowerBound(tasks, robots, costs);
+    bool reachedBound = options.ReachedBound(bestMakespan, lowerBound);
+    
     // Phase 2: Tabu Search loop
-    std::deque<Move> tabuList;
+    TabuMemory tabu;
     int iterationsWithoutImprovement = 0;
     int totalIterations = 0;
     int improvements = 0;
+    bool stopped = false;
     
-    while (iterationsWithoutImprovement < maxIterations_) {
+    while (iterationsWithoutImprovement < maxIterations_ && !reachedBound) {
+        if (options.ShouldStop()) {
+            stopped = true;
+            break;
+        }
         totalIterations++;
         
-        // Generate neighbors
-        auto neighbors = GenerateNeighbors(currentSolution, robots, neighborhoodSize_);
-        
-        // Find best non-tabu neighbor (or aspiration)
-        Assignment bestNeighbor;
-        Move bestMove;
-        double bestNeighborMakespan = std::numeric_limits<double>::max();
+        // Sample neighbors and keep the best admissible one (or aspiration).
+        // Ties on makespan go to the move that adds the least total time.
+        Move bestMove{};
+        MoveEval bestEval{};
+        double bestTotalDelta = 0.0;
         bool found = false;
         
-        for (const auto& [neighbor, move] : neighbors) {
-            double neighborMakespan = CalculateMakespan(neighbor, robots, costs);
+        int bottleneckRobot = static_cast<int>(
+            std::max_element(routeTimes.begin(), routeTimes.end()) - routeTimes.begin());
+        
+        for (int i = 0; i < neighborhoodSize_; ++i) {
+            Move move;
+            if (!SampleMove(currentRoutes, slots, bottleneckRobot, ctx, move)) continue;
             
-            bool isTabu = IsTabu(move, tabuList);
+            MoveEval eval = EvaluateMove(currentRoutes, routeTimes, move, ctx);
             
             // Aspiration: accept if it's the best ever
-            if (isTabu && neighborMakespan >= bestMakespan) {
+            if (eval.makespan >= bestMakespan && IsTabu(move, tabu, totalIterations)) {
                 continue;
             }
             
-            if (neighborMakespan < bestNeighborMakespan) {
-                bestNeighborMakespan = neighborMakespan;
-                bestNeighbor = neighbor;
+            double totalDelta = eval.time1 - routeTimes[move.robot1];
+            if (move.robot2 != move.robot1) totalDelta += eval.time2 - routeTimes[move.robot2];
+            
+            if (!found || eval.makespan < bestEval.makespan ||
+                (eval.makespan == bestEval.makespan && totalDelta < bestTotalDelta)) {
                 bestMove = move;
+                bestEval = eval;
+                bestTotalDelta = totalDelta;
                 found = true;
             }
         }
@@ -110,49 +168,68 @@ VRPResult TabuSearch::Solve(
             continue;
         }
         
-        // Move to best neighbor
-        currentSolution = bestNeighbor;
-        currentMakespan = bestNeighborMakespan;
-        
-        // Add move to tabu list
-        tabuList.push_back(GetReverseMove(bestMove));
-        if (static_cast<int>(tabuList.size()) > tabuTenure_) {
-            tabuList.pop_front();
+        // Move to best neighbor (route times re-walked to avoid drift)
+        ApplyMove(currentRoutes, slots, bestMove);
+        routeTimes[bestMove.robot1] = CalculateRobotTime(currentRoutes.Route(bestMove.robot1), bestMove.robot1, ctx);
+        if (bestMove.robot2 != bestMove.robot1) {
+            routeTimes[bestMove.robot2] = CalculateRobotTime(currentRoutes.Route(bestMove.robot2), bestMove.robot2, ctx);
         }
+        currentMakespan = *std::max_element(routeTimes.begin(), routeTimes.end());
+        
+        // Forbid undoing the move
+        MakeTabu(bestMove, tabu, totalIterations);
         
         // Update best
         if (currentMakespan < bestMakespan) {
-            bestSolution = currentSolution;
+            bestRoutes = currentRoutes;
             bestMakespan = currentMakespan;
             improvements++;
             iterationsWithoutImprovement = 0;
+            reportProgress();
+            reachedBound = options.ReachedBound(bestMakespan, lowerBound);
         } else {
             iterationsWithoutImprovement++;
         }
     }
     
+    // Polish the best routes to a granular local optimum (never raises the makespan)
+    if (!stopped && !reachedBound) {
+        GranularLocalSearch granular(tasks, ctx.startNodes, costs, ctx.candidates);
+        granular.SetBatteryPlanner(ctx.battery);
+        if (granular.Run(bestRoutes, routeTimes, options)) {
+            bestMakespan = *std::max_element(routeTimes.begin(), routeTimes.end());
+            reportProgress();
+        }
+        std::cout << "[TS] Granular polish: " << granular.GetStats().Moves() << " moves\n";
+    }
+    
     // Record timing
     auto endTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double, std::milli> duration = endTime - startTime;
     
-    std::cout << "[TS] Completed: " << totalIterations << " iterations, " 
-              << improvements << " improvements\n";
-    std::cout << "[TS] Final makespan: " 
+    std::cout << "[TS] Completed: " << totalIterations << " iterations, "
+              << improvements << " improvements"
+              << (reachedBound ? " (within gap of the lower bound)" : "") << "\n";
+    std::cout << "[TS] Final makespan: "
               << std::fixed << std::setprecision(2) << bestMakespan << " px\n";
-    std::cout << "[TS] Computation time: " 
+    std::cout << "[TS] Computation time: "
               << std::fixed << std::setprecision(2) << duration.count() << " ms\n";
     
     // Convert to result format
-    result.robotItineraries = AssignmentToItineraries(bestSolution, robots);
+    result.robotItineraries = RoutesToItineraries(bestRoutes, ctx, robots);
     result.makespan = bestMakespan;
     result.isFeasible = true;
+    result.stoppedEarly = stopped;
     result.computationTimeMs = duration.count();
     
     // Calculate total distance
     result.totalDistance = 0.0;
-    for (size_t i = 0; i < robots.size(); ++i) {
-        result.totalDistance += CalculateRobotTime(bestSolution[i], robots[i], costs);
+    for (int i = 0; i < numRobots; ++i) {
+        result.totalDistance += CalculateRobotTime(bestRoutes.Route(i), i, ctx);
     }
+    ApplyLoadPlan(result, tasks, robots, costs, options, bestRoutes);
+    ApplyBatteryPlan(result, tasks, robots, costs, options, bestRoutes);
+    result.SetLowerBound(lowerBound);
     
     // Assign itineraries to robots
     for (const auto& [robotId, itinerary] : result.robotItineraries) {
@@ -171,29 +248,33 @@ VRPResult TabuSearch::Solve(
 // SOLUTION GENERATION
 // =============================================================================
 
-TabuSearch::Assignment TabuSearch::GenerateGreedySolution(
+TabuSearch::Routes TabuSearch::GenerateWarmStartSolution(
     const std::vector<Task>& tasks,
     const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+    const CostMatrixProvider& costs,
+    const std::vector<std::vector<int>>& warmStart
 ) const {
-    int numRobots = static_cast<int>(robots.size());
-    Assignment assignment(numRobots);
+    int newTasks = 0;
+    std::vector<std::vector<int>> routes = CompleteWarmStart(tasks, robots, costs, warmStart, newTasks);
+    std::cout << "[TS] Warm start: " << (tasks.size() - newTasks) << " tasks kept, "
+              << newTasks << " inserted\n";
+    return FlatSolution::FromRoutes(routes);
+}
+
+TabuSearch::Routes TabuSearch::GenerateGreedySolution(const SearchContext& ctx) const {
+    int numRobots = static_cast<int>(ctx.startNodes.size());
+    std::vector<std::vector<int>> routes(numRobots);
     
-    std::vector<int> currentEndNode(numRobots);
+    std::vector<int> currentEndNode = ctx.startNodes;
     std::vector<double> currentTime(numRobots, 0.0);
     
-    for (int i = 0; i < numRobots; ++i) {
-        currentEndNode[i] = robots[i].GetCurrentNodeId();
-    }
-    
-    for (const auto& task : tasks) {
+    for (int t = 0; t < static_cast<int>(ctx.tasks->size()); ++t) {
         int bestRobot = 0;
         double bestFinishTime = std::numeric_limits<double>::max();
         
         for (int r = 0; r < numRobots; ++r) {
-            float pickupCost = costs.GetCost(currentEndNode[r], task.sourceNode);
-            float deliveryCost = costs.GetCost(task.sourceNode, task.destinationNode);
-            double finishTime = currentTime[r] + pickupCost + deliveryCost;
+            float pickupCost = ctx.Cost(currentEndNode[r], ctx.Source(t));
+            double finishTime = currentTime[r] + pickupCost + ctx.serviceCost[t];
             
             if (finishTime < bestFinishTime) {
                 bestFinishTime = finishTime;
@@ -201,231 +282,270 @@ TabuSearch::Assignment TabuSearch::GenerateGreedySolution(
             }
         }
         
-        assignment[bestRobot].push_back(task);
-        float pickupCost = costs.GetCost(currentEndNode[bestRobot], task.sourceNode);
-        float deliveryCost = costs.GetCost(task.sourceNode, task.destinationNode);
-        currentTime[bestRobot] += pickupCost + deliveryCost;
-        currentEndNode[bestRobot] = task.destinationNode;
+        routes[bestRobot].push_back(t);
+        float pickupCost = ctx.Cost(currentEndNode[bestRobot], ctx.Source(t));
+        currentTime[bestRobot] += pickupCost + ctx.serviceCost[t];
+        currentEndNode[bestRobot] = ctx.Destination(t);
     }
     
-    return assignment;
+    return FlatSolution::FromRoutes(routes);
 }
 
 // =============================================================================
 // COST CALCULATION
 // =============================================================================
 
-double TabuSearch::CalculateMakespan(
-    const Assignment& assignment,
-    const std::vector<RobotAgent>& robots,
-    const CostMatrixProvider& costs
+double TabuSearch::CalculateRobotTime(
+    RouteView route,
+    int robot,
+    const SearchContext& ctx
 ) const {
-    double makespan = 0.0;
-    
-    for (size_t i = 0; i < robots.size(); ++i) {
-        double robotTime = CalculateRobotTime(assignment[i], robots[i], costs);
-        makespan = std::max(makespan, robotTime);
-    }
-    
-    return makespan;
+    if (route.empty()) return 0.0;
+    if (ctx.battery) return ctx.battery->Plan(route, robot);
+    return ctx.scorer.RouteTime(route, ctx.startNodes[robot]);
 }
 
-double TabuSearch::CalculateRobotTime(
-    const std::vector<Task>& robotTasks,
-    const RobotAgent& robot,
-    const CostMatrixProvider& costs
+// =============================================================================
+// NEIGHBOR GENERATION
+// =============================================================================
+
+bool TabuSearch::SampleMove(
+    const Routes& routes,
+    const std::vector<TaskSlot>& slots,
+    int bottleneckRobot,
+    const SearchContext& ctx,
+    Move& move
 ) const {
-    if (robotTasks.empty()) return 0.0;
+    // Half the samples start from the bottleneck robot: only moves that
+    // touch it can lower the makespan
+    int t;
+    RouteView bottleneck = routes.Route(bottleneckRobot);
+    std::uniform_int_distribution<int> coinDist(0, 1);
+    if (!bottleneck.empty() && coinDist(rng_) == 0) {
+        std::uniform_int_distribution<int> posDist(0, bottleneck.size() - 1);
+        t = bottleneck[posDist(rng_)];
+    } else {
+        std::uniform_int_distribution<int> taskDist(0, static_cast<int>(slots.size()) - 1);
+        t = taskDist(rng_);
+    }
+    
+    const std::vector<int>& candidates = ctx.candidates.Of(t);
+    if (candidates.empty()) return false;
     
-    double totalTime = 0.0;
-    int currentNode = robot.GetCurrentNodeId();
+    std::uniform_int_distribution<size_t> candidateDist(0, candidates.size() - 1);
+    int c = candidates[candidateDist(rng_)];
+    const TaskSlot& a = slots[t];
     
-    for (const auto& task : robotTasks) {
-        totalTime += costs.GetCost(currentNode, task.sourceNode);
-        totalTime += costs.GetCost(task.sourceNode, task.destinationNode);
-        currentNode = task.destinationNode;
+    if (c < 0) {
+        // A robot start: move the task to the front of that robot's route
+        int robot = -c - 1;
+        if (robot == a.robot) return false;
+        move = {0, a.robot, robot, a.position, 0, t, -1};
+        return true;
     }
     
-    return totalTime;
+    const TaskSlot& b = slots[c];
+    if (b.robot == a.robot) {
+        // Reorder: Swap the task with its neighbour on the same robot
+        move = {2, a.robot, a.robot, a.position, b.position, t, c};
+    } else if (coinDist(rng_) == 0) {
+        // Transfer: Move the task right behind its neighbour on another robot
+        move = {0, a.robot, b.robot, a.position, b.position + 1, t, -1};
+    } else {
+        // Swap: Exchange the task with its neighbour on another robot
+        move = {1, a.robot, b.robot, a.position, b.position, t, c};
+    }
+    return true;
 }
 
-// =============================================================================
-// NEIGHBOR GENERATION
-// =============================================================================
-
-std::vector<std::pair<TabuSearch::Assignment, TabuSearch::Move>> 
-TabuSearch::GenerateNeighbors(
-    const Assignment& current,
-    const std::vector<RobotAgent>& robots,
-    int count
+TabuSearch::MoveEval TabuSearch::EvaluateMove(
+    const Routes& routes,
+    const std::vector<double>& routeTimes,
+    const Move& move,
+    const SearchContext& ctx
 ) const {
-    std::vector<std::pair<Assignment, Move>> neighbors;
-    neighbors.reserve(count);
+    // Node a robot stands on after the task at pos (pos < 0: its start)
+    auto endNode = [&](RouteView route, int robot, int pos) {
+        return pos < 0 ? ctx.startNodes[robot] : ctx.Destination(route[pos]);
+    };
+    
+    // Time change when the task at pos is replaced by another task
+    auto replaceDelta = [&](RouteView route, int robot, int pos, int oldTask, int newTask) {
+        int prev = endNode(route, robot, pos - 1);
+        double delta = ctx.Cost(prev, ctx.Source(newTask)) + ctx.serviceCost[newTask]
+                     - ctx.Cost(prev, ctx.Source(oldTask)) - ctx.serviceCost[oldTask];
+        if (pos + 1 < route.size()) {
+            int nextSource = ctx.Source(route[pos + 1]);
+            delta += ctx.Cost(ctx.Destination(newTask), nextSource)
+                   - ctx.Cost(ctx.Destination(oldTask), nextSource);
+        }
+        return delta;
+    };
     
-    int numRobots = static_cast<int>(robots.size());
-    std::uniform_int_distribution<int> moveTypeDist(0, 2);
+    MoveEval eval;
+    RouteView route1 = routes.Route(move.robot1);
+    RouteView route2 = routes.Route(move.robot2);
     
-    for (int i = 0; i < count; ++i) {
-        Move move;
-        move.type = moveTypeDist(rng_);
-        
-        switch (move.type) {
-            case 0: {
-                // Transfer: Move a task from one robot to another
-                std::vector<int> nonEmpty;
-                for (int r = 0; r < numRobots; ++r) {
-                    if (!current[r].empty()) nonEmpty.push_back(r);
-                }
-                if (nonEmpty.empty()) continue;
-                
-                std::uniform_int_distribution<size_t> srcDist(0, nonEmpty.size() - 1);
-                move.robot1 = nonEmpty[srcDist(rng_)];
-                
-                std::uniform_int_distribution<size_t> taskDist(0, current[move.robot1].size() - 1);
-                move.taskIdx1 = static_cast<int>(taskDist(rng_));
-                
-                std::uniform_int_distribution<int> dstDist(0, numRobots - 1);
-                move.robot2 = dstDist(rng_);
-                move.taskIdx2 = static_cast<int>(current[move.robot2].size()); // Append
-                
-                if (move.robot1 == move.robot2) continue;
-                break;
+    switch (move.type) {
+        case 0: {
+            // Transfer: close the gap in robot1, open one in robot2
+            int t = move.task1;
+            int prev = endNode(route1, move.robot1, move.pos1 - 1);
+            double removal = -(ctx.Cost(prev, ctx.Source(t)) + ctx.serviceCost[t]);
+            if (move.pos1 + 1 < route1.size()) {
+                int nextSource = ctx.Source(route1[move.pos1 + 1]);
+                removal += ctx.Cost(prev, nextSource) - ctx.Cost(ctx.Destination(t), nextSource);
             }
             
-            case 1: {
-                // Swap: Exchange tasks between two robots
-                std::vector<int> nonEmpty;
-                for (int r = 0; r < numRobots; ++r) {
-                    if (!current[r].empty()) nonEmpty.push_back(r);
-                }
-                if (nonEmpty.size() < 2) continue;
-                
-                std::uniform_int_distribution<size_t> robotDist(0, nonEmpty.size() - 1);
-                size_t idx1 = robotDist(rng_);
-                size_t idx2 = robotDist(rng_);
-                while (idx2 == idx1) idx2 = robotDist(rng_);
-                
-                move.robot1 = nonEmpty[idx1];
-                move.robot2 = nonEmpty[idx2];
-                
-                std::uniform_int_distribution<size_t> task1Dist(0, current[move.robot1].size() - 1);
-                std::uniform_int_distribution<size_t> task2Dist(0, current[move.robot2].size() - 1);
-                
-                move.taskIdx1 = static_cast<int>(task1Dist(rng_));
-                move.taskIdx2 = static_cast<int>(task2Dist(rng_));
-                break;
+            int prev2 = endNode(route2, move.robot2, move.pos2 - 1);
+            double insertion = ctx.Cost(prev2, ctx.Source(t)) + ctx.serviceCost[t];
+            if (move.pos2 < route2.size()) {
+                int nextSource = ctx.Source(route2[move.pos2]);
+                insertion += ctx.Cost(ctx.Destination(t), nextSource) - ctx.Cost(prev2, nextSource);
             }
             
-            case 2: {
-                // Reorder: Swap two tasks within the same robot
-                std::vector<int> withMultiple;
-                for (int r = 0; r < numRobots; ++r) {
-                    if (current[r].size() >= 2) withMultiple.push_back(r);
-                }
-                if (withMultiple.empty()) continue;
-                
-                std::uniform_int_distribution<size_t> robotDist(0, withMultiple.size() - 1);
-                move.robot1 = withMultiple[robotDist(rng_)];
-                move.robot2 = move.robot1;
-                
-                std::uniform_int_distribution<size_t> taskDist(0, current[move.robot1].size() - 1);
-                move.taskIdx1 = static_cast<int>(taskDist(rng_));
-                move.taskIdx2 = static_cast<int>(taskDist(rng_));
-                while (move.taskIdx2 == move.taskIdx1) 
-                    move.taskIdx2 = static_cast<int>(taskDist(rng_));
-                break;
-            }
+            eval.time1 = routeTimes[move.robot1] + removal;
+            eval.time2 = routeTimes[move.robot2] + insertion;
+            break;
         }
         
-        Assignment neighbor = ApplyMove(current, move);
-        neighbors.emplace_back(neighbor, move);
+        case 1: {
+            // Swap between robots
+            eval.time1 = routeTimes[move.robot1] +
+                replaceDelta(route1, move.robot1, move.pos1, move.task1, move.task2);
+            eval.time2 = routeTimes[move.robot2] +
+                replaceDelta(route2, move.robot2, move.pos2, move.task2, move.task1);
+            break;
+        }
+        
+        default: {
+            // Reorder within robot: only the legs into and out of the two
+            // positions change (service times are a permutation invariant)
+            int i = std::min(move.pos1, move.pos2);
+            int j = std::max(move.pos1, move.pos2);
+            int len = route1.size();
+            auto taskAt = [&](int p) { return p == i ? route1[j] : (p == j ? route1[i] : route1[p]); };
+            auto oldLeg = [&](int p) {
+                int from = p == 0 ? ctx.startNodes[move.robot1] : ctx.Destination(route1[p - 1]);
+                return ctx.Cost(from, ctx.Source(route1[p]));
+            };
+            auto newLeg = [&](int p) {
+                int from = p == 0 ? ctx.startNodes[move.robot1] : ctx.Destination(taskAt(p - 1));
+                return ctx.Cost(from, ctx.Source(taskAt(p)));
+            };
+            
+            int legs[4] = {i, i + 1, j, j + 1};
+            double delta = 0.0;
+            for (int l = 0; l < 4; ++l) {
+                int p = legs[l];
+                if (p >= len) continue;
+                bool seen = false;
+                for (int m = 0; m < l; ++m) seen = seen || legs[m] == p;
+                if (seen) continue;
+                delta += newLeg(p) - oldLeg(p);
+            }
+            
+            eval.time1 = routeTimes[move.robot1] + delta;
+            eval.time2 = eval.time1;
+            break;
+        }
     }
     
-    return neighbors;
+    eval.makespan = std::max(eval.time1, eval.time2);
+    for (int r = 0; r < static_cast<int>(routeTimes.size()); ++r) {
+        if (r != move.robot1 && r != move.robot2) {
+            eval.makespan = std::max(eval.makespan, routeTimes[r]);
+        }
+    }
+    return eval;
 }
 
-TabuSearch::Assignment TabuSearch::ApplyMove(
-    const Assignment& current,
+void TabuSearch::ApplyMove(
+    Routes& routes,
+    std::vector<TaskSlot>& slots,
     const Move& move
 ) const {
-    Assignment neighbor = current;
+    auto reindex = [&](int robot, int from) {
+        RouteView route = routes.Route(robot);
+        for (int p = from; p < route.size(); ++p) {
+            slots[route[p]] = {robot, p};
+        }
+    };
     
     switch (move.type) {
-        case 0: {
+        case 0:
             // Transfer
-            if (move.robot1 >= 0 && move.robot1 < static_cast<int>(neighbor.size()) &&
-                move.taskIdx1 >= 0 && move.taskIdx1 < static_cast<int>(neighbor[move.robot1].size())) {
-                Task task = neighbor[move.robot1][move.taskIdx1];
-                neighbor[move.robot1].erase(neighbor[move.robot1].begin() + move.taskIdx1);
-                neighbor[move.robot2].push_back(task);
-            }
+            routes.Relocate(move.robot1, move.pos1, move.robot2, move.pos2);
+            reindex(move.robot1, move.pos1);
+            reindex(move.robot2, move.pos2);
             break;
-        }
         
-        case 1: {
+        case 1:
             // Swap between robots
-            if (move.robot1 >= 0 && move.robot1 < static_cast<int>(neighbor.size()) &&
-                move.robot2 >= 0 && move.robot2 < static_cast<int>(neighbor.size()) &&
-                move.taskIdx1 >= 0 && move.taskIdx1 < static_cast<int>(neighbor[move.robot1].size()) &&
-                move.taskIdx2 >= 0 && move.taskIdx2 < static_cast<int>(neighbor[move.robot2].size())) {
-                std::swap(neighbor[move.robot1][move.taskIdx1], 
-                          neighbor[move.robot2][move.taskIdx2]);
-            }
+            routes.Swap(move.robot1, move.pos1, move.robot2, move.pos2);
+            slots[move.task1] = {move.robot2, move.pos2};
+            slots[move.task2] = {move.robot1, move.pos1};
             break;
-        }
         
-        case 2: {
+        default:
             // Reorder within robot
-            if (move.robot1 >= 0 && move.robot1 < static_cast<int>(neighbor.size()) &&
-                move.taskIdx1 >= 0 && move.taskIdx1 < static_cast<int>(neighbor[move.robot1].size()) &&
-                move.taskIdx2 >= 0 && move.taskIdx2 < static_cast<int>(neighbor[move.robot1].size())) {
-                std::swap(neighbor[move.robot1][move.taskIdx1], 
-                          neighbor[move.robot1][move.taskIdx2]);
-            }
+            routes.Swap(move.robot1, move.pos1, move.robot1, move.pos2);
+            slots[move.task1].position = move.pos2;
+            slots[move.task2].position = move.pos1;
             break;
-        }
     }
     
-    return neighbor;
+    // Tabu memory, not the journal, prevents undoing a move
+    routes.Commit();
 }
 
 // =============================================================================
 // TABU MANAGEMENT
 // =============================================================================
 
-bool TabuSearch::IsTabu(const Move& move, const std::deque<Move>& tabuList) const {
-    for (const auto& tabuMove : tabuList) {
-        if (move == tabuMove) return true;
+bool TabuSearch::IsTabu(const Move& move, const TabuMemory& tabu, int iteration) const {
+    auto banned = [&](uint64_t key) {
+        auto it = tabu.find(key);
+        return it != tabu.end() && it->second > iteration;
+    };
+    
+    switch (move.type) {
+        case 0:
+            return banned(PlacementKey(move.task1, move.robot2));
+        case 1:
+            return banned(PlacementKey(move.task1, move.robot2)) ||
+                   banned(PlacementKey(move.task2, move.robot1));
+        default:
+            return banned(PairKey(move.task1, move.task2));
     }
-    return false;
 }
 
-TabuSearch::Move TabuSearch::GetReverseMove(const Move& move) const {
-    Move reverse = move;
+void TabuSearch::MakeTabu(const Move& move, TabuMemory& tabu, int iteration) const {
+    int expiry = iteration + tabuTenure_;
     
     switch (move.type) {
         case 0:
-            // Reverse of transfer: transfer back
-            std::swap(reverse.robot1, reverse.robot2);
-            reverse.taskIdx1 = move.taskIdx2;
-            reverse.taskIdx2 = move.taskIdx1;
+            // The task may not go back to the robot it left
+            tabu[PlacementKey(move.task1, move.robot1)] = expiry;
             break;
-        
         case 1:
-        case 2:
+            tabu[PlacementKey(move.task1, move.robot1)] = expiry;
+            tabu[PlacementKey(move.task2, move.robot2)] = expiry;
+            break;
+        default:
             // Swap is self-inverse
+            tabu[PairKey(move.task1, move.task2)] = expiry;
             break;
     }
-    
-    return reverse;
 }
 
 // =============================================================================
 // UTILITY
 // =============================================================================
 
-std::map<int, std::vector<int>> TabuSearch::AssignmentToItineraries(
-    const Assignment& assignment,
+std::map<int, std::vector<int>> TabuSearch::RoutesToItineraries(
+    const Routes& routes,
+    const SearchContext& ctx,
     const std::vector<RobotAgent>& robots
 ) const {
     std::map<int, std::vector<int>> itineraries;
@@ -433,10 +553,11 @@ std::map<int, std::vector<int>> TabuSearch::AssignmentToItineraries(
     for (size_t i = 0; i < robots.size(); ++i) {
         int robotId = robots[i].GetRobotId();
         std::vector<int> nodes;
+        nodes.reserve(routes.RouteSize(static_cast<int>(i)) * 2);
         
-        for (const auto& task : assignment[i]) {
-            nodes.push_back(task.sourceNode);
-            nodes.push_back(task.destinationNode);
+        for (int t : routes.Route(static_cast<int>(i))) {
+            nodes.push_back(ctx.Source(t));
+            nodes.push_back(ctx.Destination(t));
         }
         
         itineraries[robotId] = std::move(nodes);
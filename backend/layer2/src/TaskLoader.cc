@@ -7,14 +7,393 @@
 
 #include "../include/TaskLoader.hh"
 #include <fstream>
-#include <sstream>
 #include <iostream>
 #include <random>
 #include <algorithm>
+#include <charconv>
+#include <climits>
+#include <deque>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace Backend {
 namespace Layer2 {
 
+namespace {
+
+// =============================================================================
+// FILE MAPPING
+// =============================================================================
+
+/**
+ * @brief Read-only mapping of a task file, unmapped on destruction.
+ *
+ * An empty file maps nothing and views as an empty string.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filepath) {
+        int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) return;
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0) {
+            open_ = true;
+            size_ = static_cast<size_t>(st.st_size);
+            if (size_ > 0) {
+                void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED) {
+                    open_ = false;
+                    size_ = 0;
+                } else {
+                    data_ = static_cast<const char*>(data);
+                    ::madvise(data, size_, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        ::close(fd);  // The mapping outlives the descriptor
+    }
+
+    ~MappedFile() {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsOpen() const { return open_; }
+    std::string_view View() const { return data_ ? std::string_view(data_, size_) : std::string_view(); }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+};
+
+// =============================================================================
+// STREAMING JSON CURSOR
+// =============================================================================
+
+/// A task field value: a string (view into the buffer) or an integer
+struct FieldValue {
+    bool present = false;
+    bool isString = false;
+    std::string_view text;
+    long long number = -1;
+};
+
+/// Fields of one task object
+struct TaskFields {
+    size_t offset = 0;      ///< Byte offset of the object
+    long long id = -1;
+    FieldValue source;
+    FieldValue destination;
+};
+
+/**
+ * @brief Single-pass JSON reader over a byte buffer.
+ *
+ * Strings are returned as views into the buffer; only strings with escape
+ * sequences are decoded, into storage owned by the cursor that stays valid
+ * while it lives. Any failure records the byte offset and a message, and
+ * every call after that fails too.
+ */
+class JsonCursor {
+public:
+    explicit JsonCursor(std::string_view content) : data_(content.data()), end_(content.data() + content.size()) {}
+
+    bool Failed() const { return !error_.empty(); }
+    size_t ErrorOffset() const { return errorOffset_; }
+    const std::string& Error() const { return error_; }
+    size_t Offset() const { return static_cast<size_t>(pos_ - data_); }
+
+    /// Skip whitespace and consume c if it is next
+    bool Accept(char c) {
+        SkipWhitespace();
+        if (pos_ < end_ && *pos_ == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool Expect(char c) {
+        if (Accept(c)) return true;
+        return Fail(std::string("expected '") + c + "'");
+    }
+
+    /// Next value's first byte after whitespace (0 at the end)
+    char Peek() {
+        SkipWhitespace();
+        return pos_ < end_ ? *pos_ : '\0';
+    }
+
+    bool ReadString(std::string_view& out) {
+        if (!Expect('"')) return false;
+        const char* start = pos_;
+        while (pos_ < end_ && *pos_ != '"' && *pos_ != '\\') ++pos_;
+        if (pos_ < end_ && *pos_ == '"') {
+            out = std::string_view(start, pos_ - start);
+            ++pos_;
+            return true;
+        }
+        return DecodeEscaped(start, out);
+    }
+
+    /// Read a number; integral is false for fractions and exponents
+    bool ReadInteger(long long& out, bool& integral) {
+        SkipWhitespace();
+        const char* start = pos_;
+        if (pos_ < end_ && *pos_ == '-') ++pos_;
+        if (pos_ >= end_ || !IsDigit(*pos_)) return Fail("expected a number");
+        while (pos_ < end_ && IsDigit(*pos_)) ++pos_;
+
+        integral = true;
+        if (pos_ < end_ && *pos_ == '.') {
+            integral = false;
+            ++pos_;
+            if (pos_ >= end_ || !IsDigit(*pos_)) return Fail("expected digits after '.'");
+            while (pos_ < end_ && IsDigit(*pos_)) ++pos_;
+        }
+        if (pos_ < end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+            integral = false;
+            ++pos_;
+            if (pos_ < end_ && (*pos_ == '+' || *pos_ == '-')) ++pos_;
+            if (pos_ >= end_ || !IsDigit(*pos_)) return Fail("expected exponent digits");
+            while (pos_ < end_ && IsDigit(*pos_)) ++pos_;
+        }
+
+        out = -1;
+        if (integral && std::from_chars(start, pos_, out).ec != std::errc()) integral = false;
+        return true;
+    }
+
+    /// Skip one value of any type and nesting (iteratively)
+    bool SkipValue() {
+        std::string open;   // Brackets of the containers being skipped
+        for (;;) {
+            char c = Peek();
+            if (c == '{' || c == '[') {
+                ++pos_;
+                if (!Accept(c == '{' ? '}' : ']')) {
+                    open += c;
+                    if (c == '{' && !SkipKey()) return false;
+                    continue;
+                }
+            } else if (c == '"') {
+                std::string_view ignored;
+                if (!ReadString(ignored)) return false;
+            } else if (c == 't' || c == 'f' || c == 'n') {
+                if (!ReadLiteral(c == 't' ? "true" : c == 'f' ? "false" : "null")) return false;
+            } else {
+                long long ignored;
+                bool integral;
+                if (!ReadInteger(ignored, integral)) return false;
+            }
+
+            // A value ended: close the containers it completes, or step to the next element
+            while (!open.empty()) {
+                if (Accept(',')) {
+                    if (open.back() == '{' && !SkipKey()) return false;
+                    break;
+                }
+                if (!Expect(open.back() == '{' ? '}' : ']')) return false;
+                open.pop_back();
+            }
+            if (open.empty()) return true;
+        }
+    }
+
+    bool Fail(const std::string& message) {
+        if (error_.empty()) {
+            errorOffset_ = Offset();
+            error_ = pos_ < end_ ? message : message + " (unexpected end of input)";
+        }
+        pos_ = end_;
+        return false;
+    }
+
+private:
+    const char* data_;
+    const char* pos_ = data_;
+    const char* end_;
+    std::deque<std::string> decoded_;   ///< Owns unescaped strings (stable addresses)
+    std::string error_;
+    size_t errorOffset_ = 0;
+
+    static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+    void SkipWhitespace() {
+        while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t')) ++pos_;
+    }
+
+    bool ReadLiteral(std::string_view word) {
+        if (static_cast<size_t>(end_ - pos_) < word.size() || std::string_view(pos_, word.size()) != word) {
+            return Fail("unexpected character");
+        }
+        pos_ += word.size();
+        return true;
+    }
+
+    bool SkipKey() {
+        std::string_view key;
+        return ReadString(key) && Expect(':');
+    }
+
+    /// Continue a string that has an escape at pos_ (start is after the quote)
+    bool DecodeEscaped(const char* start, std::string_view& out) {
+        std::string text(start, pos_ - start);
+        while (pos_ < end_ && *pos_ != '"') {
+            if (*pos_ != '\\') {
+                text += *pos_++;
+                continue;
+            }
+            if (++pos_ >= end_) break;
+            char c = *pos_++;
+            switch (c) {
+                case '"': case '\\': case '/': text += c; break;
+                case 'b': text += '\b'; break;
+                case 'f': text += '\f'; break;
+                case 'n': text += '\n'; break;
+                case 'r': text += '\r'; break;
+                case 't': text += '\t'; break;
+                case 'u': {
+                    unsigned code = 0;
+                    if (end_ - pos_ < 4 || std::from_chars(pos_, pos_ + 4, code, 16).ptr != pos_ + 4) {
+                        return Fail("bad \\u escape");
+                    }
+                    pos_ += 4;
+                    // UTF-8 encode (POI names are ASCII; surrogates are kept as-is)
+                    if (code < 0x80) {
+                        text += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        text += static_cast<char>(0xC0 | (code >> 6));
+                        text += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        text += static_cast<char>(0xE0 | (code >> 12));
+                        text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        text += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default:
+                    --pos_;
+                    return Fail("bad escape sequence");
+            }
+        }
+        if (pos_ >= end_) return Fail("unterminated string");
+        ++pos_;
+        decoded_.push_back(std::move(text));
+        out = decoded_.back();
+        return true;
+    }
+};
+
+bool ReadField(JsonCursor& cursor, FieldValue& value) {
+    value.present = true;
+    if (cursor.Peek() == '"') {
+        value.isString = true;
+        return cursor.ReadString(value.text);
+    }
+    char c = cursor.Peek();
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        bool integral;
+        if (!cursor.ReadInteger(value.number, integral)) return false;
+        if (!integral) value.number = -1;
+        return true;
+    }
+    value.present = false;      // Wrong type: counts as missing
+    return cursor.SkipValue();
+}
+
+/**
+ * @brief Stream the objects of the top-level "tasks" array to onTask.
+ *
+ * Accepts "pickup" or "source" and "dropoff" or "destination"; other
+ * fields, and elements that are not objects, are skipped.
+ *
+ * @param error If set, receives what was wrong when false is returned
+ * @return false if the document has no "tasks" array or a syntax error
+ *         (tasks streamed before the error have been delivered)
+ */
+template <typename OnTask>
+bool StreamTasks(std::string_view content, OnTask&& onTask, std::string* error = nullptr) {
+    JsonCursor cursor(content);
+    bool foundTasks = false;
+
+    if (cursor.Expect('{') && !cursor.Accept('}')) {
+        do {
+            std::string_view key;
+            if (!cursor.ReadString(key) || !cursor.Expect(':')) break;
+            if (key != "tasks" || foundTasks || cursor.Peek() != '[') {
+                if (!cursor.SkipValue()) break;
+                continue;
+            }
+
+            foundTasks = true;
+            cursor.Expect('[');
+            if (cursor.Accept(']')) continue;
+            do {
+                if (cursor.Peek() != '{') {
+                    std::cerr << "[TaskLoader] WARNING: Skipping non-object task at byte " << cursor.Offset() << "\n";
+                    if (!cursor.SkipValue()) break;
+                    continue;
+                }
+
+                TaskFields fields;
+                fields.offset = cursor.Offset();
+                cursor.Expect('{');
+                if (!cursor.Accept('}')) {
+                    do {
+                        std::string_view field;
+                        if (!cursor.ReadString(field) || !cursor.Expect(':')) break;
+                        bool ok;
+                        if (field == "id") {
+                            FieldValue id;
+                            ok = ReadField(cursor, id);
+                            if (id.present && !id.isString) fields.id = id.number;
+                        } else if (field == "pickup" || (field == "source" && !fields.source.present)) {
+                            ok = ReadField(cursor, fields.source);
+                        } else if (field == "dropoff" || (field == "destination" && !fields.destination.present)) {
+                            ok = ReadField(cursor, fields.destination);
+                        } else {
+                            ok = cursor.SkipValue();
+                        }
+                        if (!ok) break;
+                    } while (cursor.Accept(','));
+                    if (!cursor.Failed()) cursor.Expect('}');
+                }
+                if (cursor.Failed()) break;
+                onTask(fields);
+            } while (cursor.Accept(','));
+            if (!cursor.Failed()) cursor.Expect(']');
+        } while (!cursor.Failed() && cursor.Accept(','));
+        if (!cursor.Failed()) cursor.Expect('}');
+    }
+
+    std::string problem;
+    if (cursor.Failed()) {
+        problem = "Malformed JSON at byte " + std::to_string(cursor.ErrorOffset()) + ": " + cursor.Error();
+    } else if (!foundTasks) {
+        problem = "No 'tasks' array found in JSON";
+    } else {
+        return true;
+    }
+    std::cerr << "[TaskLoader] ERROR: " << problem << std::endl;
+    if (error) *error = std::move(problem);
+    return false;
+}
+
+/// Upper estimate of the task count for reserving (a compact task object is ~40 bytes)
+size_t EstimateTaskCount(std::string_view content) {
+    return content.size() / 40;
+}
+
+} // namespace
+
 // =============================================================================
 // PUBLIC METHODS
 // =============================================================================
@@ -24,43 +403,44 @@ std::vector<Task> TaskLoader::LoadTasksWithPOI(const std::string& filepath,
                                                 const Backend::Layer1::POIRegistry& poiRegistry) {
     std::vector<Task> tasks;
     
-    // Read file content
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
+    // Map file content
+    MappedFile file(filepath);
+    if (!file.IsOpen()) {
         std::cerr << "[TaskLoader] ERROR: Cannot open file: " << filepath << std::endl;
         return tasks;
     }
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string content = buffer.str();
-    file.close();
-    
     // Parse JSON with POI resolution
-    tasks = ParseJSONWithPOI(content, poiRegistry);
+    tasks = ParseJSONWithPOI(file.View(), poiRegistry);
     
     // Validate against NavMesh
     return ValidateTasks(tasks, mesh);
 }
 
+std::vector<Task> TaskLoader::ParseTasksWithPOI(std::string_view content,
+                                                 const Backend::Layer1::NavMesh& mesh,
+                                                 const Backend::Layer1::POIRegistry& poiRegistry,
+                                                 size_t* rejected,
+                                                 std::string* error) {
+    size_t objects = 0;
+    std::vector<Task> tasks = ValidateTasks(ParseJSONWithPOI(content, poiRegistry, &objects, error), mesh);
+    if (rejected) *rejected = objects - tasks.size();
+    return tasks;
+}
+
 std::vector<Task> TaskLoader::LoadTasks(const std::string& filepath,
                                         const Backend::Layer1::NavMesh& mesh) {
     std::vector<Task> tasks;
     
-    // Read file content
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
+    // Map file content
+    MappedFile file(filepath);
+    if (!file.IsOpen()) {
         std::cerr << "[TaskLoader] ERROR: Cannot open file: " << filepath << std::endl;
         return tasks;
     }
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string content = buffer.str();
-    file.close();
-    
     // Parse JSON
-    tasks = ParseJSON(content);
+    tasks = ParseJSON(file.View());
     
     // Validate against NavMesh
     return ValidateTasks(tasks, mesh);
@@ -73,19 +453,31 @@ std::vector<Task> TaskLoader::ValidateTasks(const std::vector<Task>& tasks,
     
     int invalidCount = 0;
     
+    // Components of the mesh without the overlay: a task whose nodes
+    // differ can never be served, whatever the obstacles do
+    std::vector<int> components;
+    if (!tasks.empty()) components = mesh.LabelComponents(false);
+    
     for (const auto& task : tasks) {
         bool sourceValid = IsValidNodeId(task.sourceNode, mesh);
         bool destValid = IsValidNodeId(task.destinationNode, mesh);
         
-        if (sourceValid && destValid) {
+        if (sourceValid && destValid &&
+            components[task.sourceNode] == components[task.destinationNode]) {
             validTasks.push_back(task);
+        } else if (sourceValid && destValid) {
+            invalidCount++;
+            std::cerr << "[TaskLoader] WARNING: Task " << task.taskId
+                      << " is unreachable (source=" << task.sourceNode
+                      << " and dest=" << task.destinationNode
+                      << " are not connected)\n";
         } else {
             invalidCount++;
             std::cerr << "[TaskLoader] WARNING: Task " << task.taskId 
                       << " has invalid nodes (source=" << task.sourceNode
                       << " valid=" << sourceValid
                       << ", dest=" << task.destinationNode 
-                      << " valid=" << destValid << ")" << std::endl;
+                      << " valid=" << destValid << ")\n";
         }
     }
     
@@ -160,216 +552,76 @@ bool TaskLoader::IsValidNodeId(int nodeId, const Backend::Layer1::NavMesh& mesh)
     return nodeId >= 0 && nodeId < static_cast<int>(allNodes.size());
 }
 
-std::vector<Task> TaskLoader::ParseJSON(const std::string& content) {
+std::vector<Task> TaskLoader::ParseJSON(std::string_view content) {
     std::vector<Task> tasks;
-    
-    // Find "tasks" array
-    size_t tasksPos = content.find("\"tasks\"");
-    if (tasksPos == std::string::npos) {
-        std::cerr << "[TaskLoader] ERROR: No 'tasks' array found in JSON" << std::endl;
-        return tasks;
-    }
-    
-    // Find opening bracket of array
-    size_t arrayStart = content.find('[', tasksPos);
-    if (arrayStart == std::string::npos) {
-        std::cerr << "[TaskLoader] ERROR: Malformed JSON - no array start" << std::endl;
-        return tasks;
-    }
-    
-    // Find closing bracket
-    size_t arrayEnd = content.rfind(']');
-    if (arrayEnd == std::string::npos || arrayEnd <= arrayStart) {
-        std::cerr << "[TaskLoader] ERROR: Malformed JSON - no array end" << std::endl;
-        return tasks;
-    }
-    
-    // Parse each task object
-    size_t pos = arrayStart;
-    while (pos < arrayEnd) {
-        // Find next object start
-        size_t objStart = content.find('{', pos);
-        if (objStart == std::string::npos || objStart >= arrayEnd) break;
-        
-        // Find object end
-        size_t objEnd = content.find('}', objStart);
-        if (objEnd == std::string::npos || objEnd >= arrayEnd) break;
-        
-        std::string obj = content.substr(objStart, objEnd - objStart + 1);
-        
-        // Extract fields
-        int id = -1, source = -1, dest = -1;
-        
-        // Parse "id"
-        size_t idPos = obj.find("\"id\"");
-        if (idPos != std::string::npos) {
-            size_t colonPos = obj.find(':', idPos);
-            if (colonPos != std::string::npos) {
-                id = std::atoi(obj.c_str() + colonPos + 1);
-            }
-        }
-        
-        // Parse "source"
-        size_t sourcePos = obj.find("\"source\"");
-        if (sourcePos != std::string::npos) {
-            size_t colonPos = obj.find(':', sourcePos);
-            if (colonPos != std::string::npos) {
-                source = std::atoi(obj.c_str() + colonPos + 1);
-            }
-        }
-        
-        // Parse "destination"
-        size_t destPos = obj.find("\"destination\"");
-        if (destPos != std::string::npos) {
-            size_t colonPos = obj.find(':', destPos);
-            if (colonPos != std::string::npos) {
-                dest = std::atoi(obj.c_str() + colonPos + 1);
-            }
-        }
-        
+    tasks.reserve(EstimateTaskCount(content));
+
+    StreamTasks(content, [&](const TaskFields& fields) {
+        const FieldValue& source = fields.source;
+        const FieldValue& dest = fields.destination;
+        bool numeric = source.present && !source.isString && dest.present && !dest.isString;
+
         // Create task if all fields are valid
-        if (id >= 0 && source >= 0 && dest >= 0) {
-            tasks.emplace_back(id, source, dest);
+        if (fields.id >= 0 && numeric && source.number >= 0 && dest.number >= 0
+            && fields.id <= INT_MAX && source.number <= INT_MAX && dest.number <= INT_MAX) {
+            tasks.emplace_back(static_cast<int>(fields.id), static_cast<int>(source.number),
+                               static_cast<int>(dest.number));
         } else {
-            std::cerr << "[TaskLoader] WARNING: Skipping malformed task object" << std::endl;
+            std::cerr << "[TaskLoader] WARNING: Skipping malformed task object at byte "
+                      << fields.offset << "\n";
         }
-        
-        pos = objEnd + 1;
-    }
-    
+    });
+
     std::cout << "[TaskLoader] Parsed " << tasks.size() << " tasks from JSON" << std::endl;
-    
+
     return tasks;
 }
 
-std::vector<Task> TaskLoader::ParseJSONWithPOI(const std::string& content,
-                                                const Backend::Layer1::POIRegistry& poiRegistry) {
+std::vector<Task> TaskLoader::ParseJSONWithPOI(std::string_view content,
+                                                const Backend::Layer1::POIRegistry& poiRegistry,
+                                                size_t* objects,
+                                                std::string* error) {
     std::vector<Task> tasks;
-    
-    // Find "tasks" array
-    size_t tasksPos = content.find("\"tasks\"");
-    if (tasksPos == std::string::npos) {
-        std::cerr << "[TaskLoader] ERROR: No 'tasks' array found in JSON" << std::endl;
-        return tasks;
-    }
-    
-    // Find opening bracket of array
-    size_t arrayStart = content.find('[', tasksPos);
-    if (arrayStart == std::string::npos) {
-        std::cerr << "[TaskLoader] ERROR: Malformed JSON - no array start" << std::endl;
-        return tasks;
-    }
-    
-    // Find closing bracket
-    size_t arrayEnd = content.rfind(']');
-    if (arrayEnd == std::string::npos || arrayEnd <= arrayStart) {
-        std::cerr << "[TaskLoader] ERROR: Malformed JSON - no array end" << std::endl;
-        return tasks;
-    }
-    
-    // Parse each task object
-    size_t pos = arrayStart;
-    while (pos < arrayEnd) {
-        // Find next object start
-        size_t objStart = content.find('{', pos);
-        if (objStart == std::string::npos || objStart >= arrayEnd) break;
-        
-        // Find object end
-        size_t objEnd = content.find('}', objStart);
-        if (objEnd == std::string::npos || objEnd >= arrayEnd) break;
-        
-        std::string obj = content.substr(objStart, objEnd - objStart + 1);
-        
-        // Extract fields
-        int id = -1;
-        std::string sourceId, destId;
-        int sourceNode = -1, destNode = -1;
-        
-        // Parse "id"
-        size_t idPos = obj.find("\"id\"");
-        if (idPos != std::string::npos) {
-            size_t colonPos = obj.find(':', idPos);
-            if (colonPos != std::string::npos) {
-                id = std::atoi(obj.c_str() + colonPos + 1);
-            }
-        }
-        
-        // Parse "pickup" or "source" (string POI ID) - support both field names
-        size_t sourcePos = obj.find("\"pickup\"");
-        if (sourcePos == std::string::npos) {
-            sourcePos = obj.find("\"source\"");  // Fallback to old format
-        }
-        if (sourcePos != std::string::npos) {
-            size_t colonPos = obj.find(':', sourcePos);
-            if (colonPos != std::string::npos) {
-                // Skip whitespace and find the opening quote of the value
-                size_t searchStart = colonPos + 1;
-                while (searchStart < obj.size() && std::isspace(obj[searchStart])) {
-                    searchStart++;
-                }
-                // Now find the first quote (should be the value's opening quote)
-                if (searchStart < obj.size() && obj[searchStart] == '"') {
-                    size_t quoteEnd = obj.find('"', searchStart + 1);
-                    if (quoteEnd != std::string::npos) {
-                        sourceId = obj.substr(searchStart + 1, quoteEnd - searchStart - 1);
-                    }
-                }
-            }
-        }
-        
-        // Parse "dropoff" or "destination" (string POI ID) - support both field names
-        size_t destPos = obj.find("\"dropoff\"");
-        if (destPos == std::string::npos) {
-            destPos = obj.find("\"destination\"");  // Fallback to old format
-        }
-        if (destPos != std::string::npos) {
-            size_t colonPos = obj.find(':', destPos);
-            if (colonPos != std::string::npos) {
-                // Skip whitespace and find the opening quote of the value
-                size_t searchStart = colonPos + 1;
-                while (searchStart < obj.size() && std::isspace(obj[searchStart])) {
-                    searchStart++;
-                }
-                // Now find the first quote (should be the value's opening quote)
-                if (searchStart < obj.size() && obj[searchStart] == '"') {
-                    size_t quoteEnd = obj.find('"', searchStart + 1);
-                    if (quoteEnd != std::string::npos) {
-                        destId = obj.substr(searchStart + 1, quoteEnd - searchStart - 1);
-                    }
-                }
-            }
-        }
-        
-        // Resolve POI IDs to node IDs
-        if (!sourceId.empty()) {
-            sourceNode = poiRegistry.GetNodeForPOI(sourceId);
-            if (sourceNode < 0) {
-                std::cerr << "[TaskLoader] WARNING: Unknown POI '" << sourceId 
-                          << "' for task " << id << std::endl;
-            }
-        }
-        if (!destId.empty()) {
-            destNode = poiRegistry.GetNodeForPOI(destId);
-            if (destNode < 0) {
-                std::cerr << "[TaskLoader] WARNING: Unknown POI '" << destId 
-                          << "' for task " << id << std::endl;
+    tasks.reserve(EstimateTaskCount(content));
+
+    // Interned POI table: each distinct name is resolved (and warned about) once.
+    // Keys view the mapped file or the cursor's decoded strings, both alive here.
+    std::unordered_map<std::string_view, int> poiNodes;
+    auto resolve = [&](const FieldValue& value, long long id) {
+        if (!value.present || !value.isString || value.text.empty()) return -1;
+        auto it = poiNodes.find(value.text);
+        if (it == poiNodes.end()) {
+            int node = poiRegistry.GetNodeForPOI(std::string(value.text));
+            if (node < 0) {
+                std::cerr << "[TaskLoader] WARNING: Unknown POI '" << value.text
+                          << "' (first used by task " << id << ")\n";
             }
+            it = poiNodes.emplace(value.text, node).first;
         }
-        
+        return it->second;
+    };
+
+    size_t seen = 0;
+    StreamTasks(content, [&](const TaskFields& fields) {
+        seen++;
+        int sourceNode = resolve(fields.source, fields.id);
+        int destNode = resolve(fields.destination, fields.id);
+
         // Create task if all fields are valid
-        if (id >= 0 && sourceNode >= 0 && destNode >= 0) {
-            tasks.emplace_back(id, sourceNode, destNode, sourceId, destId);
+        if (fields.id >= 0 && fields.id <= INT_MAX && sourceNode >= 0 && destNode >= 0) {
+            tasks.emplace_back(static_cast<int>(fields.id), sourceNode, destNode,
+                               std::string(fields.source.text), std::string(fields.destination.text));
         } else {
-            std::cerr << "[TaskLoader] WARNING: Skipping task " << id 
-                      << " (source='" << sourceId << "'→" << sourceNode 
-                      << ", dest='" << destId << "'→" << destNode << ")" << std::endl;
+            std::cerr << "[TaskLoader] WARNING: Skipping task " << fields.id
+                      << " at byte " << fields.offset
+                      << " (source='" << fields.source.text << "'→" << sourceNode
+                      << ", dest='" << fields.destination.text << "'→" << destNode << ")\n";
         }
-        
-        pos = objEnd + 1;
-    }
-    
+    }, error);
+
+    if (objects) *objects = seen;
     std::cout << "[TaskLoader] Parsed " << tasks.size() << " tasks from JSON (POI format)" << std::endl;
-    
+
     return tasks;
 }
 
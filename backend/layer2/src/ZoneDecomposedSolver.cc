@@ -0,0 +1,420 @@
+/**
+ * @file ZoneDecomposedSolver.cc
+ * @brief Implementation of the zone decomposition front-end
+ */
+
+#include "../include/ZoneDecomposedSolver.hh"
+#include "../include/FlatSolution.hh"
+#include "../include/GranularLocalSearch.hh"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+namespace Backend {
+namespace Layer2 {
+
+ZoneDecomposedSolver::ZoneDecomposedSolver(SolverFactory factory, int robotsPerZone)
+    : factory_(std::move(factory))
+    , robotsPerZone_(std::max(1, robotsPerZone)) {
+    if (!factory_) {
+        throw std::invalid_argument("ZoneDecomposedSolver: a solver factory is required");
+    }
+}
+
+// =============================================================================
+// MAIN SOLVE METHOD
+// =============================================================================
+
+VRPResult ZoneDecomposedSolver::Solve(
+    const std::vector<Task>& tasks,
+    std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs,
+    const SolveOptions& options
+) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    int numTasks = static_cast<int>(tasks.size());
+    int numRobots = static_cast<int>(robots.size());
+    int zoneCount = std::min(numTasks, (numRobots + robotsPerZone_ - 1) / robotsPerZone_);
+
+    // Small fleets (and the empty cases) are solved as a whole
+    if (zoneCount <= 1) {
+        return factory_(0)->Solve(tasks, robots, costs, options);
+    }
+
+    ZonePlan plan = PlanZones(tasks, robots, costs, zoneCount);
+    zoneCount = plan.zoneCount;
+
+    std::cout << "[Zones] Solving VRP: " << numTasks << " tasks, " << numRobots
+              << " robots in " << zoneCount << " zones\n";
+
+    // Split tasks, robots and the warm start by zone
+    struct ZoneRun {
+        std::vector<int> taskIndices;       ///< Into tasks
+        std::vector<int> robotIndices;      ///< Into robots
+        std::vector<Task> tasks;
+        std::vector<RobotAgent> robots;
+        SolveOptions options;
+        std::unique_ptr<IVRPSolver> solver;
+        VRPResult result;
+    };
+    std::vector<ZoneRun> runs(zoneCount);
+    std::vector<int> localIndex(numTasks);
+
+    for (int t = 0; t < numTasks; ++t) {
+        ZoneRun& run = runs[plan.taskZone[t]];
+        localIndex[t] = static_cast<int>(run.tasks.size());
+        run.taskIndices.push_back(t);
+        run.tasks.push_back(tasks[t]);
+    }
+    for (int r = 0; r < numRobots; ++r) {
+        ZoneRun& run = runs[plan.robotZone[r]];
+        run.robotIndices.push_back(r);
+        run.robots.push_back(robots[r]);
+    }
+
+    std::vector<int> activeZones;
+    for (int z = 0; z < zoneCount; ++z) {
+        ZoneRun& run = runs[z];
+        if (run.tasks.empty()) continue;
+        activeZones.push_back(z);
+
+        run.options.deadline = options.deadline;
+        run.options.cancelToken = options.cancelToken;
+        run.options.battery = options.battery;
+        run.options.stopGap = options.stopGap;
+        run.options.scheduler = options.scheduler;
+        run.solver = factory_(z);   // Factories need not be thread-safe
+
+        // Tasks a robot carries stay with it only if they fall in its zone
+        if (options.HasWarmStart()) {
+            std::vector<std::vector<int>> warmStart(run.robots.size());
+            bool any = false;
+            for (size_t i = 0; i < run.robotIndices.size(); ++i) {
+                size_t r = static_cast<size_t>(run.robotIndices[i]);
+                if (r >= options.warmStart.size()) continue;
+                for (int t : options.warmStart[r]) {
+                    if (t < 0 || t >= numTasks || plan.taskZone[t] != z) continue;
+                    warmStart[i].push_back(localIndex[t]);
+                    any = true;
+                }
+            }
+            if (any) run.options.warmStart = std::move(warmStart);
+        }
+    }
+
+    // One thread per zone (or maxThreads_ taking zones in turn), the
+    // calling thread among them; with a scheduler, as many ParallelFor jobs
+    size_t threadCount = activeZones.size();
+    if (maxThreads_ > 0) threadCount = std::min(threadCount, static_cast<size_t>(maxThreads_));
+    std::atomic<size_t> nextZone{0};
+    auto worker = [&]() {
+        for (size_t i = nextZone.fetch_add(1); i < activeZones.size(); i = nextZone.fetch_add(1)) {
+            ZoneRun& run = runs[activeZones[i]];
+            run.result = run.solver->Solve(run.tasks, run.robots, costs, run.options);
+        }
+    };
+
+    if (options.scheduler) {
+        options.scheduler->ParallelFor(threadCount, [&worker](size_t) { worker(); });
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (size_t i = 0; i + 1 < threadCount; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Merge the zone routes back into global task indices
+    std::vector<std::vector<int>> routes(numRobots);
+    bool zoneStopped = false;
+    for (int z : activeZones) {
+        ZoneRun& run = runs[z];
+        zoneStopped = zoneStopped || run.result.stoppedEarly;
+        std::cout << "[Zones] Zone " << z << ": " << run.tasks.size() << " tasks, "
+                  << run.robots.size() << " robots, makespan " << std::fixed
+                  << std::setprecision(2) << run.result.makespan << "\n";
+        if (!run.result.isFeasible) continue;   // Its tasks are re-inserted below
+
+        for (RobotAgent& robot : run.robots) {
+            auto it = run.result.robotItineraries.find(robot.GetRobotId());
+            robot.AssignItinerary(it != run.result.robotItineraries.end()
+                                      ? it->second : std::vector<int>());
+        }
+        std::vector<std::vector<int>> local = ExtractWarmStart(run.tasks, run.robots);
+        for (size_t i = 0; i < local.size(); ++i) {
+            for (int t : local[i]) {
+                routes[run.robotIndices[i]].push_back(run.taskIndices[t]);
+            }
+        }
+    }
+    int reinserted = 0;
+    routes = CompleteWarmStart(tasks, robots, costs, routes, reinserted);
+
+    // Cross-boundary pass: tasks near a border may move to the next zone.
+    // A robot start is grouped where the robot stands, not by the zone it
+    // served, so tasks around a robot sent far away can still come back to it.
+    std::vector<int> startNodes;
+    std::vector<int> startZone;
+    startNodes.reserve(numRobots);
+    startZone.reserve(numRobots);
+    for (const auto& robot : robots) {
+        startNodes.push_back(robot.GetCurrentNodeId());
+        startZone.push_back(NearestZone(plan, costs, robot.GetCurrentNodeId()));
+    }
+    NeighborLists neighbors;
+    neighbors.BuildPartitioned(tasks, startNodes, costs, NeighborLists::DEFAULT_SIZE,
+                               plan.taskZone, startZone, NearbyZones(plan, costs));
+    GranularLocalSearch boundary(tasks, startNodes, costs, neighbors);
+    BatteryPlanner battery(options.battery, tasks, robots, costs);
+    boundary.SetBatteryPlanner(&battery);
+
+    FlatSolution solution = FlatSolution::FromRoutes(routes);
+    std::vector<double> routeTimes(numRobots);
+    for (int r = 0; r < numRobots; ++r) {
+        routeTimes[r] = boundary.RouteTime(solution.Route(r), r);
+    }
+    double mergedMakespan = *std::max_element(routeTimes.begin(), routeTimes.end());
+
+    // Zones are each bounded on their own robots; the gap is judged on the whole fleet
+    double lowerBound = MakespanLowerBound(tasks, robots, costs);
+    if (!options.ReachedBound(mergedMakespan, lowerBound)) {
+        boundary.Run(solution, routeTimes, options, DEFAULT_BOUNDARY_PASSES);
+    }
+
+    VRPResult result;
+    result.algorithmName = GetName() + " (" + runs[activeZones.front()].result.algorithmName + ")";
+    result.isFeasible = true;
+    result.isOptimal = false;
+    result.stoppedEarly = zoneStopped || options.ShouldStop();
+    result.makespan = 0.0;
+    result.totalDistance = 0.0;
+    for (int r = 0; r < numRobots; ++r) {
+        result.makespan = std::max(result.makespan, routeTimes[r]);
+        result.totalDistance += routeTimes[r];
+
+        std::vector<int>& nodes = result.robotItineraries[robots[r].GetRobotId()];
+        nodes.reserve(solution.RouteSize(r) * 2);
+        for (int t : solution.Route(r)) {
+            nodes.push_back(tasks[t].sourceNode);
+            nodes.push_back(tasks[t].destinationNode);
+        }
+    }
+    ApplyLoadPlan(result, tasks, robots, costs, options, solution);
+    ApplyBatteryPlan(result, tasks, robots, costs, options, solution);
+    result.SetLowerBound(lowerBound);
+    for (RobotAgent& robot : robots) {
+        robot.AssignItinerary(result.robotItineraries[robot.GetRobotId()]);
+    }
+    result.computationTimeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+
+    std::cout << "[Zones] Boundary pass: " << boundary.GetStats().Moves() << " moves"
+              << (reinserted > 0 ? ", " + std::to_string(reinserted) + " tasks re-inserted" : "")
+              << ", makespan " << std::fixed << std::setprecision(2) << mergedMakespan
+              << " -> " << result.makespan << "\n";
+    std::cout << "[Zones] Computation time: " << std::fixed << std::setprecision(2)
+              << result.computationTimeMs << " ms\n";
+
+    options.NotifyImprovement(result);
+    return result;
+}
+
+// =============================================================================
+// ZONE PLANNING
+// =============================================================================
+
+ZoneDecomposedSolver::ZonePlan ZoneDecomposedSolver::PlanZones(
+    const std::vector<Task>& tasks,
+    const std::vector<RobotAgent>& robots,
+    const CostMatrixProvider& costs,
+    int zoneCount
+) const {
+    int numTasks = static_cast<int>(tasks.size());
+    int numRobots = static_cast<int>(robots.size());
+    ZonePlan plan;
+
+    // Farthest-first centres: each new centre is the pickup worst served so far
+    std::vector<float> nearest(numTasks, std::numeric_limits<float>::max());
+    int next = 0;
+    while (static_cast<int>(plan.centreNodes.size()) < zoneCount) {
+        int centre = tasks[next].sourceNode;
+        plan.centreNodes.push_back(centre);
+
+        float farthest = 0.0f;
+        for (int t = 0; t < numTasks; ++t) {
+            nearest[t] = std::min(nearest[t], costs.GetCost(centre, tasks[t].sourceNode));
+            if (nearest[t] > farthest) {
+                farthest = nearest[t];
+                next = t;
+            }
+        }
+        if (farthest <= 0.0f) break;   // Fewer distinct pickups than zones
+    }
+    plan.zoneCount = static_cast<int>(plan.centreNodes.size());
+
+    auto assignTasks = [&]() {
+        plan.taskZone.assign(numTasks, 0);
+        for (int t = 0; t < numTasks; ++t) {
+            float best = std::numeric_limits<float>::max();
+            for (int z = 0; z < plan.zoneCount; ++z) {
+                float cost = costs.GetCost(plan.centreNodes[z], tasks[t].sourceNode);
+                if (cost < best) {
+                    best = cost;
+                    plan.taskZone[t] = z;
+                }
+            }
+        }
+    };
+
+    // k-medoids rounds over a bounded sample of each zone's pickups
+    std::vector<std::vector<int>> members(plan.zoneCount);
+    for (int round = 0; round < MEDOID_ROUNDS; ++round) {
+        assignTasks();
+        for (auto& zoneMembers : members) zoneMembers.clear();
+        for (int t = 0; t < numTasks; ++t) members[plan.taskZone[t]].push_back(t);
+
+        for (int z = 0; z < plan.zoneCount; ++z) {
+            if (members[z].empty()) continue;
+            size_t stride = std::max<size_t>(1, members[z].size() / MEDOID_SAMPLE);
+            double bestSum = std::numeric_limits<double>::max();
+            for (size_t i = 0; i < members[z].size(); i += stride) {
+                int candidate = tasks[members[z][i]].sourceNode;
+                double sum = 0.0;
+                for (size_t j = 0; j < members[z].size(); j += stride) {
+                    sum += costs.GetCost(candidate, tasks[members[z][j]].sourceNode);
+                }
+                if (sum < bestSum) {
+                    bestSum = sum;
+                    plan.centreNodes[z] = candidate;
+                }
+            }
+        }
+    }
+    assignTasks();
+
+    // Work of a zone: its services plus reaching them from the centre
+    std::vector<double> zoneWork(plan.zoneCount, 0.0);
+    for (int t = 0; t < numTasks; ++t) {
+        int z = plan.taskZone[t];
+        zoneWork[z] += costs.GetCost(tasks[t].sourceNode, tasks[t].destinationNode)
+                     + costs.GetCost(plan.centreNodes[z], tasks[t].sourceNode);
+    }
+    std::vector<int> quota = AllocateRobots(zoneWork, numRobots);
+
+    // Nearest (robot, zone) pairs first until every zone has its quota
+    std::vector<std::tuple<float, int, int>> pairs;
+    pairs.reserve(static_cast<size_t>(numRobots) * plan.zoneCount);
+    for (int r = 0; r < numRobots; ++r) {
+        for (int z = 0; z < plan.zoneCount; ++z) {
+            if (quota[z] == 0) continue;
+            pairs.emplace_back(costs.GetCost(robots[r].GetCurrentNodeId(), plan.centreNodes[z]), r, z);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    plan.robotZone.assign(numRobots, -1);
+    for (const auto& [cost, r, z] : pairs) {
+        if (plan.robotZone[r] >= 0 || quota[z] == 0) continue;
+        plan.robotZone[r] = z;
+        quota[z]--;
+    }
+
+    // Robots left over (no zone had measurable work) join their nearest centre
+    for (int r = 0; r < numRobots; ++r) {
+        if (plan.robotZone[r] < 0) {
+            plan.robotZone[r] = NearestZone(plan, costs, robots[r].GetCurrentNodeId());
+        }
+    }
+
+    return plan;
+}
+
+int ZoneDecomposedSolver::NearestZone(
+    const ZonePlan& plan,
+    const CostMatrixProvider& costs,
+    int node
+) const {
+    int nearest = 0;
+    float best = std::numeric_limits<float>::max();
+    for (int z = 0; z < plan.zoneCount; ++z) {
+        float cost = costs.GetCost(node, plan.centreNodes[z]);
+        if (cost < best) {
+            best = cost;
+            nearest = z;
+        }
+    }
+    return nearest;
+}
+
+std::vector<int> ZoneDecomposedSolver::AllocateRobots(
+    const std::vector<double>& zoneWork,
+    int robotCount
+) const {
+    int zones = static_cast<int>(zoneWork.size());
+    double totalWork = 0.0;
+    for (double work : zoneWork) totalWork += work;
+
+    // Largest remainder on the proportional shares, at least one robot per zone with work
+    std::vector<int> quota(zones, 0);
+    std::vector<std::pair<double, int>> remainders;
+    int assigned = 0;
+    for (int z = 0; z < zones; ++z) {
+        if (zoneWork[z] <= 0.0) continue;
+        double share = robotCount * zoneWork[z] / totalWork;
+        quota[z] = std::max(1, static_cast<int>(std::floor(share)));
+        remainders.push_back({share - std::floor(share), z});
+        assigned += quota[z];
+    }
+    if (remainders.empty()) return quota;
+    std::sort(remainders.begin(), remainders.end(), std::greater<std::pair<double, int>>());
+    for (size_t i = 0; assigned < robotCount; i = (i + 1) % remainders.size()) {
+        quota[remainders[i].second]++;
+        assigned++;
+    }
+
+    // The minimum of one may overshoot: take back from the largest quotas
+    while (assigned > robotCount) {
+        int largest = static_cast<int>(std::max_element(quota.begin(), quota.end()) - quota.begin());
+        quota[largest]--;
+        assigned--;
+    }
+    return quota;
+}
+
+std::vector<std::vector<int>> ZoneDecomposedSolver::NearbyZones(
+    const ZonePlan& plan,
+    const CostMatrixProvider& costs
+) const {
+    std::vector<std::vector<int>> nearby(plan.zoneCount);
+    std::vector<std::pair<float, int>> scored;
+
+    for (int z = 0; z < plan.zoneCount; ++z) {
+        scored.clear();
+        for (int w = 0; w < plan.zoneCount; ++w) {
+            if (w != z) scored.push_back({costs.GetCost(plan.centreNodes[z], plan.centreNodes[w]), w});
+        }
+        size_t keep = std::min<size_t>(NEARBY_ZONES, scored.size());
+        std::partial_sort(scored.begin(), scored.begin() + keep, scored.end());
+
+        nearby[z].push_back(z);
+        for (size_t i = 0; i < keep; ++i) {
+            nearby[z].push_back(scored[i].second);
+        }
+    }
+    return nearby;
+}
+
+} // namespace Layer2
+} // namespace Backend
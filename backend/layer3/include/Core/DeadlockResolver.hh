@@ -0,0 +1,219 @@
+/**
+ * @file DeadlockResolver.hh
+ * @brief Detects robots that wait on each other forever and makes way
+ *
+ * A robot that ORCA stops in front of another waits in COLLISION_WAIT
+ * until the way clears. Two robots meeting head-on in a one-robot-wide
+ * aisle wait for each other, and a robot parked in an aisle holds up
+ * everyone behind it: the way never clears. The resolver builds the
+ * wait-for graph of the waiting robots every tick and, once a robot has
+ * waited long enough, breaks cycles and long blocks by rerouting a robot
+ * around the one in its way, backing it off into a pocket, or letting a
+ * parked robot yield.
+ */
+
+#ifndef LAYER3_CORE_DEADLOCKRESOLVER_HH
+#define LAYER3_CORE_DEADLOCKRESOLVER_HH
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/RobotDriver.hh"
+#include "NavMesh.hh"
+#include "Physics/SpatialHash.hh"
+
+namespace Backend {
+namespace Layer3 {
+namespace Core {
+
+/**
+ * @brief Configuration of the deadlock resolver.
+ */
+struct DeadlockConfig {
+    double waitSeconds;       ///< Time waiting on another robot before it is resolved
+    double contactGap;        ///< Gap between two robots' edges within which the one ahead holds the other (pixels)
+    double stallSpeed;        ///< Below this speed a held robot counts as waiting (pixels/second)
+    double progressPixels;    ///< Distance that ends a wait, however slowly it was covered
+    double holdSeconds;       ///< Time a robot that backed off keeps the way clear
+    int maxSearchNodes;       ///< NavMesh nodes a detour or pocket search may expand
+
+    /**
+     * @brief Defaults for ORCA's default stop distance and safety margin
+     *        at DECIMETERS.
+     */
+    DeadlockConfig()
+        : waitSeconds(2.0)
+        , contactGap(20.0)         // safetyMargin + stopDistance + 5 px of crawling
+        , stallSpeed(2.0)
+        , progressPixels(5.0)      // One tile
+        , holdSeconds(4.0)
+        , maxSearchNodes(4000)
+    {}
+};
+
+/**
+ * @brief Deadlock counters and times since construction.
+ */
+struct DeadlockStats {
+    uint64_t cycles;              ///< Wait-for cycles found
+    uint64_t longBlocks;          ///< Robots held up by a parked robot
+    uint64_t reroutes;            ///< Resolved by a detour around the robot in the way
+    uint64_t backOffs;            ///< Resolved by backing off into a pocket
+    uint64_t yields;              ///< Resolved by a parked robot making way
+    uint64_t unresolved;          ///< Nothing could be done (retried after waitSeconds)
+    double blockedSeconds;        ///< Robot-seconds spent waiting on another robot
+    double longestWaitSeconds;    ///< Longest single wait so far
+    int waitingRobots;            ///< Robots waiting on another at the last Update
+
+    DeadlockStats()
+        : cycles(0)
+        , longBlocks(0)
+        , reroutes(0)
+        , backOffs(0)
+        , yields(0)
+        , unresolved(0)
+        , blockedSeconds(0.0)
+        , longestWaitSeconds(0.0)
+        , waitingRobots(0) {}
+
+    uint64_t GetResolved() const { return reroutes + backOffs + yields; }
+};
+
+/**
+ * @brief Wait-for graph over a fleet and the actions that break it.
+ *
+ * Robot a waits for b if b is the closest robot ahead of a within
+ * contactGap of its edge and a, on its way to a goal (not held by the
+ * dynamic overlay), has stalled below stallSpeed without covering
+ * progressPixels since b came in its way. Stop-and-wait leaves such robots
+ * creeping back and forth between COLLISION_WAIT and MOVING, which is why
+ * the wait ends by progress, not by state. Each robot waits for at most
+ * one other, so following the edges from a waiting robot either returns
+ * to it (a cycle) or ends at a robot that waits for nobody.
+ *
+ * Once a robot has waited waitSeconds:
+ * - In a cycle, robots try in order of rising priority (a robot without a
+ *   package before one with, then the one farther from its goal, then
+ *   the higher ID) to reroute to their goal around the robot they wait
+ *   for, else to back off to the nearest node clear of that robot and its
+ *   path; the first that can, does.
+ * - Behind a parked robot (IDLE, ARRIVED, STUCK), the waiting robot
+ *   reroutes around it, or else a parked IDLE / ARRIVED robot yields by
+ *   backing off clear of the waiting robot's path.
+ *
+ * A detour or a pocket can pass too close to the other robot for ORCA to
+ * let either through, leaving both waiting as before. A robot does not
+ * repeat what already failed against the same robot: after a detour to
+ * the same goal it backs off instead (or, behind a parked robot, lets it
+ * yield), and while backing off from it the other robot makes way.
+ *
+ * Only robots on their way look for a robot in their way, among those a
+ * grid of the fleet's positions puts within contact (so a tick costs
+ * O(N), not O(N^2)); parked robots (arrived, idle, charging at rest) are
+ * skipped as waiters but still block others.
+ *
+ * Routes avoid nodes blocked in the NavMesh overlay, so call Update with
+ * the overlay locked against changes. Not thread-safe.
+ */
+class DeadlockResolver {
+private:
+    const Backend::Layer1::NavMesh* navMesh_;
+    DeadlockConfig config_;
+    DeadlockStats stats_;
+
+    /// A robot held up by another since it was at from
+    struct Wait {
+        Backend::Common::Coordinates from;
+        double seconds;         ///< Of those spent below stallSpeed
+    };
+    std::unordered_map<int, Wait> waits_;       ///< Robot ID -> its current wait
+
+    /// A detour a robot took around another to a goal
+    struct Detour {
+        int around;             ///< Robot ID
+        int goal;               ///< NavMesh node
+    };
+    std::unordered_map<int, Detour> detours_;   ///< Robot ID -> its last detour
+    std::unordered_map<int, int> backOffs_;     ///< Robot ID -> ID of the robot it last backed off from
+
+    // Per robot of the last Update (index into its robots)
+    std::vector<int> waitsFor_;
+    std::vector<char> handled_;
+
+    Physics::SpatialHash grid_;         ///< Positions, when Update is given no grid
+    std::vector<size_t> nearby_;        ///< Grid query results (reused)
+    double maxRadius_;                  ///< Largest robot radius of the last Update
+
+    // Node searches (stamped, so nothing is cleared between them)
+    std::vector<uint32_t> stamp_;
+    std::vector<int> parent_;
+    std::vector<float> cost_;
+    uint32_t currentStamp_;
+
+    /// Index of the robot in the way of robot i (-1 if none)
+    int FindBlocker(const std::vector<RobotDriver*>& robots, const Physics::SpatialHash& grid, size_t i);
+
+    /// Whether a goes before b when choosing who makes way
+    bool Yields(const RobotDriver& a, const RobotDriver& b) const;
+
+    /// Per node: whether it lies within clearance of other (and, if
+    /// alongPath, of the rest of other's path)
+    std::vector<char> NodesWithin(const RobotDriver& other, double clearance, bool alongPath) const;
+
+    /// Nodes robot must not enter next to other: those closer than
+    /// contact, but never closer than robot already is
+    std::vector<char> NodesInTheWay(const RobotDriver& robot, const RobotDriver& other) const;
+
+    /// Cheapest route between nodes avoiding blocked and avoid nodes (empty if none)
+    std::vector<int> FindRoute(int start, int goal, const std::vector<char>& avoid);
+
+    /// Route to the nearest node outside clear that avoids avoid (empty if none)
+    std::vector<int> FindPocket(int start, const std::vector<char>& avoid, const std::vector<char>& clear);
+
+    /// Route to its goal around other, if robot has a goal and there is one
+    bool TryReroute(RobotDriver& robot, const RobotDriver& other);
+
+    /// Back robot off clear of other and other's path
+    bool TryBackOff(RobotDriver& robot, const RobotDriver& other);
+
+    /// Resolve a cycle of waiting robots
+    void ResolveCycle(const std::vector<RobotDriver*>& robots, const std::vector<int>& cycle);
+
+    /// Resolve robots[waiting] held up by the parked robots[parked]
+    void ResolveBlock(const std::vector<RobotDriver*>& robots, int waiting, int parked);
+
+public:
+    /**
+     * @brief Construct for a NavMesh (must outlive the resolver).
+     */
+    explicit DeadlockResolver(const Backend::Layer1::NavMesh& navMesh,
+                              const DeadlockConfig& config = DeadlockConfig());
+
+    /**
+     * @brief Advance wait times by dt and resolve what has waited too long.
+     *
+     * Call once per tick, after the drivers were stepped, with every
+     * robot of the fleet (parked ones included: they block others).
+     * Buckets the robots into a grid of its own first.
+     */
+    void Update(const std::vector<RobotDriver*>& robots, float dt);
+
+    /**
+     * @brief Update with the caller's grid of the fleet, e.g. the tick's
+     *        neighbor grid.
+     *
+     * Item k of grid must be robots[k] at its current position (Move the
+     * items after stepping), and null robots must not be in it.
+     */
+    void Update(const std::vector<RobotDriver*>& robots, const Physics::SpatialHash& grid, float dt);
+
+    const DeadlockStats& GetStats() const { return stats_; }
+    const DeadlockConfig& GetConfig() const { return config_; }
+};
+
+} // namespace Core
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_CORE_DEADLOCKRESOLVER_HH
@@ -14,9 +14,14 @@
 #include <functional>
 
 #include "Core/RobotDriver.hh"
+#include "Core/WorkerPool.hh"
 #include "Physics/ObstacleData.hh"
+#include "Physics/SpatialHash.hh"
 #include "Coordinates.hh"
 
+/// Times private kernels for the microbenchmarks (backend/kernel_benchmark.cc)
+struct KernelBenchmarkAccess;
+
 namespace Backend {
 namespace Layer3 {
 namespace Core {
@@ -30,13 +35,15 @@ struct LoopStats {
     double avgTickTimeMs;           ///< Average tick computation time (ms)
     double maxTickTimeMs;           ///< Maximum tick computation time (ms)
     int totalCollisionAvoidances;   ///< Number of collision avoidance events
+    size_t activeRobots;            ///< Robots updated by the last tick (the rest were parked)
     
     LoopStats()
         : tickCount(0)
         , totalTimeMs(0.0)
         , avgTickTimeMs(0.0)
         , maxTickTimeMs(0.0)
-        , totalCollisionAvoidances(0) {}
+        , totalCollisionAvoidances(0)
+        , activeRobots(0) {}
 };
 
 /**
@@ -53,8 +60,11 @@ using TickCallback = std::function<void(int, float)>;
  * Responsibilities:
  * 1. Maintain list of all RobotDrivers
  * 2. Run physics loop at configurable frequency (default 50ms)
- * 3. Gather neighbor data for each robot
- * 4. Call UpdateLoop on each driver
+ * 3. Gather neighbor data for each robot (from a uniform grid rebuilt each
+ *    tick, so a tick is O(N) for fleets of bounded density)
+ * 4. Step each driver in two phases: all velocities from a snapshot of
+ *    the tick-start positions (sharded over a WorkerPool), then all moves
+ *    in robot order. Results do not depend on robot order or thread count.
  * 5. Track statistics
  * 
  * Usage:
@@ -69,7 +79,17 @@ using TickCallback = std::function<void(int, float)>;
  *   manager.RunTicks(100);
  */
 class FastLoopManager {
+public:
+    /// Fewest robots worth handing to another thread
+    static constexpr size_t MIN_ROBOTS_PER_SHARD = 32;
+
 private:
+    /// Neighbor buffers of one shard (reused every tick)
+    struct ShardScratch {
+        std::vector<size_t> indices;                ///< Grid query result
+        Physics::KinematicsStore neighbors;
+    };
+    
     // Robots being managed
     std::vector<RobotDriver> robots_;
     
@@ -80,6 +100,16 @@ private:
     // Statistics
     LoopStats stats_;
     
+    // Neighbor gathering (reused every tick)
+    Physics::KinematicsStore snapshot_;             ///< Per robot, kinematics at tick start
+    Physics::SpatialHash neighborGrid_;             ///< snapshot_ positions, cell size = neighborRadius_
+    std::vector<ShardScratch> shardScratch_;
+    std::vector<size_t> activeRobots_;              ///< Robots not parked at tick start (the ones stepped)
+    
+    // Threads
+    size_t threadCount_;                    ///< 0 = one per hardware thread
+    std::unique_ptr<WorkerPool> workers_;   ///< Started on the first tick that needs it
+    
     // Callbacks
     TickCallback onTick_;
     
@@ -127,12 +157,14 @@ public:
      * @param id Robot ID
      * @param position Starting position
      * @param navMesh NavMesh reference
+     * @param pathService Service the robot requests paths from
      * @return Reference to the created robot
      */
     RobotDriver& CreateRobot(
         int id,
         const Backend::Common::Coordinates& position,
-        const Backend::Layer1::NavMesh& navMesh
+        const Backend::Layer1::NavMesh& navMesh,
+        Pathfinding::PathfindingService& pathService
     );
     
     /**
@@ -167,6 +199,12 @@ public:
      * @brief Clear all robots.
      */
     void ClearRobots();
+    
+    /**
+     * @brief Tell every robot which NavMesh nodes the overlay changed
+     *        (RobotDriver::OnMapChanged; call between ticks).
+     */
+    void NotifyMapChanged(const std::vector<int>& changedNodeIds);
 
     // =========================================================================
     // SIMULATION CONTROL
@@ -225,6 +263,12 @@ public:
      */
     void SetNeighborRadius(double radius) { neighborRadius_ = radius; }
     
+    /**
+     * @brief Set the threads stepping robots, the calling one included
+     *        (0 = one per hardware thread, 1 = no worker threads).
+     */
+    void SetThreadCount(size_t threads);
+    
     /**
      * @brief Set tick callback.
      */
@@ -259,14 +303,19 @@ public:
     void PrintRobotStates() const;
 
 private:
+    friend struct ::KernelBenchmarkAccess;
+    
     // =========================================================================
     // INTERNAL METHODS
     // =========================================================================
     
     /**
-     * @brief Gather neighbors for a specific robot.
+     * @brief Gather neighbors for a specific robot from the tick snapshot.
+     * 
+     * @param scratch Its neighbors are cleared, then filled with robots
+     *        within neighborRadius_
      */
-    std::vector<Physics::ObstacleData> GatherNeighbors(size_t robotIndex) const;
+    void GatherNeighbors(size_t robotIndex, ShardScratch& scratch) const;
     
     /**
      * @brief Execute one physics tick for all robots.
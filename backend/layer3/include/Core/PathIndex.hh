@@ -0,0 +1,90 @@
+/**
+ * @file PathIndex.hh
+ * @brief Which robots' paths cross which NavMesh nodes
+ *
+ * An obstacle update changes the overlay of a few nodes; only robots whose
+ * path crosses one of them can find it blocked. The index keeps, per
+ * robot, the nodes its current path crosses (sampled like
+ * RobotDriver::IsRemainingPathBlocked) and the inverse lists, so an update
+ * costs work proportional to the robots using the changed aisle instead
+ * of a path scan per robot.
+ */
+
+#ifndef LAYER3_CORE_PATHINDEX_HH
+#define LAYER3_CORE_PATHINDEX_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Core/RobotDriver.hh"
+#include "NavMesh.hh"
+
+namespace Backend {
+namespace Layer3 {
+namespace Core {
+
+/**
+ * @brief Inverted index NavMesh node -> robots whose path crosses it.
+ *
+ * Robots are identified by a dense slot (their index in the fleet). A
+ * robot's entry is rebuilt when its path version changes; the whole path
+ * stays indexed until then, so lookups may return robots that already
+ * drove past a node (OnMapChanged filters them), never miss one.
+ *
+ * Not thread-safe: update and query from the fleet thread.
+ */
+class PathIndex {
+public:
+    explicit PathIndex(const Backend::Layer1::NavMesh& mesh);
+
+    /**
+     * @brief Re-index a robot's path if it changed since the last call.
+     *
+     * @return true if the entry was rebuilt
+     */
+    bool Update(size_t slot, const RobotDriver& driver);
+
+    /// Drop a robot's entry
+    void Remove(size_t slot);
+
+    /**
+     * @brief Robots whose indexed path crosses one of nodes or a node next
+     *        to one (robots pushed off their path by ORCA drive there).
+     *
+     * @param slotsOut Ascending slots, cleared first
+     */
+    void FindRobots(const std::vector<int>& nodes, std::vector<size_t>& slotsOut);
+
+    /// Nodes indexed for a robot (sorted, empty if none)
+    const std::vector<int>& GetNodes(size_t slot) const;
+
+    /// Bytes held by the entries and inverse lists
+    size_t GetMemoryBytes() const;
+
+private:
+    struct Entry {
+        uint64_t pathVersion = 0;
+        bool indexed = false;
+        std::vector<int> nodes;         // Sorted, unique
+    };
+
+    const Backend::Layer1::NavMesh& navMesh_;
+    std::vector<Entry> entries_;                // Per slot
+    std::vector<std::vector<size_t>> nodeSlots_;    // Per node: slots whose path crosses it
+
+    // FindRobots scratch: a slot / node is marked when stamp == generation_
+    std::vector<uint32_t> slotStamp_;
+    std::vector<uint32_t> nodeStamp_;
+    uint32_t generation_ = 0;
+
+    // Nodes under path, sampled every half tile from its first waypoint
+    void CollectNodes(const std::vector<Backend::Common::Coordinates>& path, std::vector<int>& nodesOut) const;
+    void Unlink(size_t slot);
+};
+
+} // namespace Core
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_CORE_PATHINDEX_HH
@@ -9,15 +9,21 @@
 #ifndef LAYER3_CORE_ROBOTDRIVER_HH
 #define LAYER3_CORE_ROBOTDRIVER_HH
 
-#include <vector>
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "Vector2.hh"
+#include "Pathfinding/DStarLite.hh"
 #include "Pathfinding/PathfindingService.hh"
 #include "Physics/ORCASolver.hh"
 #include "Physics/ObstacleData.hh"
 #include "Coordinates.hh"
 #include "NavMesh.hh"
+#include "Resolution.hh"
 
 namespace Backend {
 namespace Layer3 {
@@ -35,6 +41,21 @@ enum class DriverState {
     COLLISION_WAIT      ///< Waiting for obstacle to clear
 };
 
+/**
+ * @brief Convert driver state to string.
+ */
+inline const char* DriverStateToString(DriverState state) {
+    switch (state) {
+        case DriverState::IDLE: return "IDLE";
+        case DriverState::COMPUTING_PATH: return "COMPUTING_PATH";
+        case DriverState::MOVING: return "MOVING";
+        case DriverState::ARRIVED: return "ARRIVED";
+        case DriverState::STUCK: return "STUCK";
+        case DriverState::COLLISION_WAIT: return "COLLISION_WAIT";
+        default: return "UNKNOWN";
+    }
+}
+
 /**
  * @brief Configuration for robot driver.
  */
@@ -44,6 +65,7 @@ struct DriverConfig {
     double waypointThreshold;     ///< Distance to consider waypoint reached (pixels)
     double goalThreshold;         ///< Distance to consider goal reached (pixels)
     double robotRadius;           ///< Robot collision radius (pixels)
+    bool incrementalReplanning;   ///< Repair a path the dynamic overlay blocks (OnMapChanged)
     
     /**
      * @brief Default configuration for DECIMETERS resolution.
@@ -54,7 +76,23 @@ struct DriverConfig {
         , waypointThreshold(5.0)   // 0.5m at DECIMETERS
         , goalThreshold(3.0)       // 0.3m at DECIMETERS
         , robotRadius(3.0)         // 0.3m at DECIMETERS
+        , incrementalReplanning(true)
     {}
+    
+    /**
+     * @brief The default configuration in pixels of res.
+     */
+    static DriverConfig ForResolution(Backend::Common::Resolution res) {
+        const double scale = Backend::Common::GetPixelsPerMeter(res) /
+                             double(Backend::Common::GetPixelsPerMeter(Backend::Common::Resolution::DECIMETERS));
+        DriverConfig config;
+        config.maxSpeed *= scale;
+        config.acceleration *= scale;
+        config.waypointThreshold *= scale;
+        config.goalThreshold *= scale;
+        config.robotRadius *= scale;
+        return config;
+    }
 };
 
 /**
@@ -73,7 +111,7 @@ using GoalReachedCallback = std::function<void(int robotId, int goalNodeId)>;
  * 5. Report position/velocity updates to simulator
  * 
  * Usage:
- *   RobotDriver driver(0, startPos, navMesh);
+ *   RobotDriver driver(0, startPos, navMesh, pathService);
  *   driver.SetGoal(targetNodeId);
  *   
  *   // In physics loop:
@@ -93,21 +131,81 @@ private:
     Backend::Common::Coordinates currentPosition_;  // Integer position for grid lookups
     Vector2 currentVelocity_;
     double currentSpeed_;
-    bool hasPackage_;                           // Whether robot is carrying a package
+    int loadCount_;                             // Packages on board
     
     // Path following
     std::vector<Backend::Common::Coordinates> currentPath_;
+    std::vector<double> pathArcLength_;         // Per waypoint: path length from currentPath_[0]
+    uint64_t pathVersion_ = 0;                  // Bumped whenever currentPath_ is replaced or cleared
     size_t pathIndex_;
     int currentGoalNodeId_;
     
+    // Scheduled path (FollowSchedule): per waypoint, earliest arrival on
+    // scheduleClock_ (empty = follow currentPath_ at full speed)
+    std::vector<double> waypointTimes_;
+    double scheduleClock_;
+    bool scheduleReachesGoal_;
+    bool timedLeg_;             ///< SetTimedGoal: waypointTimes_ holds the arrival, no ORCA
+    
     // Reference to NavMesh for node lookups
     const Backend::Layer1::NavMesh* navMesh_;
     
+    // Detour around the dynamic overlay (OnMapChanged): kept across map
+    // changes so later ones only repair it
+    Pathfinding::DStarLite replanner_;
+    Backend::Common::Coordinates replanTarget_;  ///< Exact end of the path being repaired
+    bool pathBlocked_;                          ///< No detour exists; waiting for the overlay to clear
+    
+    // Back-off (BackOff): drive clear of another robot, hold, then resume
+    bool backingOff_;
+    double backOffHold_;                        ///< Seconds still to hold once clear
+    bool backOffResumes_;                       ///< Whether a goal is resumed afterwards
+    Backend::Common::Coordinates resumeTarget_; ///< Exact goal to resume
+    
+    // Service computing this robot's paths (shared with the rest of its fleet)
+    Pathfinding::PathfindingService* pathService_;
+    
     // ORCA solver for collision avoidance
     Physics::ORCASolver orcaSolver_;
     
     // Callbacks
     GoalReachedCallback onGoalReached_;
+    
+    // Step computed by ComputeVelocity, applied by Integrate
+    bool pendingMove_;          ///< Advance position by currentVelocity_
+    bool pendingGoalReached_;   ///< Fire onGoalReached_
+    bool pendingBackOffEnd_;    ///< The back-off hold is over (EndBackOff)
+    
+    /**
+     * @brief Result of a path request handed over by a service worker.
+     * 
+     * Shared with the request's callback, so a result that arrives after
+     * the driver was moved or destroyed is harmless.
+     */
+    struct PathMailbox {
+        std::mutex mutex;
+        uint64_t ticket = 0;            ///< Current request; older results are dropped
+        bool ready = false;
+        Pathfinding::PathResult result;
+    };
+    std::shared_ptr<PathMailbox> pathMailbox_;
+    
+    /**
+     * @brief Paths of legs after the current goal (PrefetchItinerary),
+     *        shared with the request's callback like PathMailbox.
+     */
+    struct PrefetchMailbox {
+        std::mutex mutex;
+        uint64_t ticket = 0;            ///< Current request; older results are dropped
+        bool ready = false;
+        Pathfinding::ItineraryResult result;
+    };
+    std::shared_ptr<PrefetchMailbox> prefetchMailbox_;
+    std::vector<Backend::Common::Coordinates> prefetchPoints_;  ///< Start, then each leg's goal
+    uint64_t prefetchedPaths_;          ///< Goals whose path was ready when set
+    
+    /// Take a prefetched path from the robot's position to target, if one is ready
+    bool TakePrefetchedPath(const Backend::Common::Coordinates& target, Pathfinding::PathResult& path);
 
 public:
     // =========================================================================
@@ -120,17 +218,19 @@ public:
      * @param id Unique robot identifier
      * @param startPosition Initial position (pixels)
      * @param navMesh Reference to NavMesh for node lookups
+     * @param pathService Service for path requests (must outlive the driver)
      * @param config Driver configuration
      */
     RobotDriver(
         int id,
         const Backend::Common::Coordinates& startPosition,
         const Backend::Layer1::NavMesh& navMesh,
+        Pathfinding::PathfindingService& pathService,
         const DriverConfig& config = DriverConfig()
     );
     
     /**
-     * @brief Default constructor (for containers).
+     * @brief Default constructor (for containers; cannot request paths).
      */
     RobotDriver();
 
@@ -144,25 +244,131 @@ public:
      * Looks up the node's coordinates from NavMesh and requests a path.
      * 
      * @param nodeId Target NavMesh node ID
+     * @param priority Scheduling class of the path request
      * @return true if path request was initiated
      */
-    bool SetGoal(int nodeId);
+    bool SetGoal(int nodeId,
+                 Pathfinding::PathPriority priority = Pathfinding::PathPriority::ACTIVE_GOAL);
     
     /**
      * @brief Set a new goal by coordinates.
      * 
-     * Directly requests a path to the given position.
+     * Directly requests a path to the given position. If the
+     * PathfindingService has workers the request is queued and the driver
+     * waits in COMPUTING_PATH until Integrate picks up the result;
+     * otherwise the path is computed before returning. A queued request
+     * of this robot that has not started yet is superseded.
      * 
      * @param target Target position (pixels)
-     * @return true if path request was initiated
+     * @param priority Scheduling class of the path request
+     * @return true if path request was initiated (if computed here: and succeeded)
+     */
+    bool SetGoalPosition(const Backend::Common::Coordinates& target,
+                         Pathfinding::PathPriority priority = Pathfinding::PathPriority::ACTIVE_GOAL);
+    
+    /**
+     * @brief Plan the paths of the goals that follow the current one.
+     * 
+     * The legs (current goal to nodeIds[0], then on to each next node)
+     * are computed together on the service's workers at PREFETCH priority.
+     * A later SetGoal / SetGoalPosition whose target ends a leg starting
+     * where the robot then stands takes that path without waiting in
+     * COMPUTING_PATH, unless the map version moved on. A new itinerary
+     * replaces the previous one; legs already planned are not requested
+     * again. Only with service workers.
+     * 
+     * @return true if the legs are planned or being planned
      */
-    bool SetGoalPosition(const Backend::Common::Coordinates& target);
+    bool PrefetchItinerary(const std::vector<int>& nodeIds);
     
     /**
-     * @brief Cancel current goal and stop.
+     * @brief Set a goal whose path comes from a fleet-wide planner.
+     * 
+     * Requests nothing: the driver waits in COMPUTING_PATH until
+     * FollowSchedule hands it a plan.
+     * 
+     * @return false if the node does not exist
+     */
+    bool SetScheduledGoal(int nodeId);
+    
+    /**
+     * @brief Drive straight to a node, arriving travelSeconds from now.
+     * 
+     * Kinematic simulation: no path request, no ORCA and no acceleration
+     * limits. The robot moves along the line to the node at the pace that
+     * lands it there on time and then arrives as usual. Map changes,
+     * reroutes and back-offs leave the leg alone.
+     * 
+     * @return false if the node does not exist
+     */
+    bool SetTimedGoal(int nodeId, double travelSeconds);
+    
+    /**
+     * @brief Seconds until a SetTimedGoal leg arrives (-1 if not on one).
+     */
+    double GetTimedLegSecondsLeft() const;
+    
+    /**
+     * @brief Follow timed waypoints (e.g. a MultiAgentPlanner window).
+     * 
+     * Waypoint i is not passed before arrivalTimes[i] seconds from now;
+     * repeating a waypoint with a later time makes the robot wait there.
+     * If the schedule does not end at the goal the robot holds its last
+     * waypoint until the next schedule. An empty schedule means the goal
+     * is unreachable (STUCK).
+     * 
+     * @param waypoints Positions to visit (pixels)
+     * @param arrivalTimes Earliest arrival per waypoint (seconds from now)
+     * @param reachesGoal Whether the last waypoint is the goal
+     */
+    void FollowSchedule(const std::vector<Backend::Common::Coordinates>& waypoints,
+                        const std::vector<double>& arrivalTimes,
+                        bool reachesGoal);
+    
+    /**
+     * @brief Cancel current goal and stop (drops a queued path request).
      */
     void CancelGoal();
     
+    /**
+     * @brief The dynamic overlay of the NavMesh changed these nodes.
+     * 
+     * A moving driver whose remaining path crosses a blocked node detours
+     * along a D* Lite route over the NavMesh; once it has one, later
+     * changes only repair that route instead of searching again. With no
+     * detour it holds in COLLISION_WAIT (IsPathBlocked) until a change
+     * opens one or clears its path.
+     * Scheduled paths are left to their planner, and nothing happens
+     * unless config.incrementalReplanning. Call with the overlay locked
+     * against changes.
+     */
+    void OnMapChanged(const std::vector<int>& changedNodeIds);
+    
+    /**
+     * @brief Drive to the current goal along a NavMesh route instead
+     *        (e.g. around a robot in the way); no search.
+     * 
+     * route runs from the robot's node to the goal's. The path keeps the
+     * node centres where the route turns and ends at the goal's exact
+     * position. Only for a MOVING or COLLISION_WAIT driver that is not on
+     * a schedule.
+     * 
+     * @return false if the driver does not qualify
+     */
+    bool Reroute(const std::vector<int>& route);
+    
+    /**
+     * @brief Make way: drive along route to its last node, hold there for
+     *        holdSeconds, then request the path to the goal again.
+     * 
+     * An IDLE or ARRIVED driver stays IDLE where the route ends instead.
+     * Not for drivers on a schedule or waiting for a path; a new goal
+     * ends the back-off.
+     * 
+     * @return false if the driver does not qualify
+     */
+    bool BackOff(const std::vector<int>& route, double holdSeconds);
+    
     /**
      * @brief Check if robot has an active goal.
      */
@@ -197,6 +403,29 @@ public:
      * @param neighbors Other robots/obstacles for collision avoidance
      */
     void UpdateLoop(float dt, const std::vector<Physics::ObstacleData>& neighbors);
+    
+    /**
+     * @brief UpdateLoop with neighbors packed in a KinematicsStore.
+     */
+    void UpdateLoop(float dt, const Physics::KinematicsStore& neighbors);
+    
+    /**
+     * @brief First phase of UpdateLoop: new velocity and state only.
+     * 
+     * Leaves the position alone and defers the goal callback, so the
+     * robots of a tick can be stepped concurrently (each on its own
+     * driver) from a snapshot of their obstacle data.
+     */
+    void ComputeVelocity(float dt, const std::vector<Physics::ObstacleData>& neighbors);
+    void ComputeVelocity(float dt, const Physics::KinematicsStore& neighbors);
+    
+    /**
+     * @brief Second phase of UpdateLoop: move by the computed velocity and
+     *        fire the goal callback if the goal was reached.
+     * 
+     * A driver in COMPUTING_PATH instead takes its path if it has arrived.
+     */
+    void Integrate(float dt);
 
     // =========================================================================
     // GETTERS - State
@@ -208,6 +437,7 @@ public:
     Vector2 GetVelocity() const { return currentVelocity_; }
     double GetSpeed() const { return currentSpeed_; }
     double GetRadius() const { return config_.robotRadius; }
+    double GetMaxSpeed() const { return config_.maxSpeed; }
     
     /**
      * @brief Get obstacle data for this robot (for ORCA).
@@ -215,12 +445,24 @@ public:
     Physics::ObstacleData GetObstacleData() const;
     
     /**
-     * @brief Get remaining path length.
+     * @brief Get remaining path length (constant time).
      */
     double GetRemainingPathLength() const;
     
     /**
-     * @brief Get ETA to goal in seconds.
+     * @brief Path length from the robot to a waypoint of GetPath()
+     *        (0 for waypoints already passed; constant time).
+     */
+    double GetPathLengthTo(size_t waypointIndex) const;
+    
+    /**
+     * @brief Seconds until a waypoint of GetPath() is reached at full
+     *        speed, or at its scheduled time if that is later.
+     */
+    double GetTimeToWaypoint(size_t waypointIndex) const;
+    
+    /**
+     * @brief Get ETA to goal in seconds (GetTimeToWaypoint of the last one).
      */
     double GetETA() const;
     
@@ -229,10 +471,60 @@ public:
      */
     const std::vector<Backend::Common::Coordinates>& GetPath() const { return currentPath_; }
     
+    /// Bytes held by the driver and its path buffers (mailboxes, written
+    /// by path workers, are left out)
+    size_t GetMemoryBytes() const;
+    
+    /**
+     * @brief Changes whenever GetPath() does (to publish paths only when they change).
+     */
+    uint64_t GetPathVersion() const { return pathVersion_; }
+    
+    /**
+     * @brief Whether the driver is at rest with nothing to do: a tick
+     *        (UpdateLoop) would leave it unchanged, so a loop may skip it
+     *        until it gets a goal. It still counts as an obstacle.
+     */
+    bool IsParked() const {
+        return (state_ == DriverState::IDLE || state_ == DriverState::ARRIVED ||
+                state_ == DriverState::STUCK) && currentSpeed_ == 0.0;
+    }
+    
+    /**
+     * @brief Whether the driver holds because the overlay blocks its path.
+     */
+    bool IsPathBlocked() const { return pathBlocked_; }
+    
+    /**
+     * @brief Whether the driver follows a detour that OnMapChanged repairs
+     *        (it must then hear of every overlay change).
+     */
+    bool IsDetouring() const { return replanner_.HasPlan(); }
+    
+    /**
+     * @brief Whether the driver is making way for another (BackOff).
+     */
+    bool IsBackingOff() const { return backingOff_; }
+    
+    /**
+     * @brief Index in GetPath() of the waypoint being driven to.
+     */
+    size_t GetPathIndex() const { return pathIndex_; }
+    
     /**
      * @brief Check if robot is carrying a package.
      */
-    bool HasPackage() const { return hasPackage_; }
+    bool HasPackage() const { return loadCount_ > 0; }
+    
+    /**
+     * @brief Packages on board (multi-pick batches carry several).
+     */
+    int GetLoadCount() const { return loadCount_; }
+    
+    /**
+     * @brief Goals whose path came from PrefetchItinerary.
+     */
+    uint64_t GetPrefetchedPaths() const { return prefetchedPaths_; }
 
     // =========================================================================
     // SETTERS
@@ -262,14 +554,15 @@ public:
      */
     void SetPosition(const Backend::Common::Coordinates& pos) {
         currentPosition_ = pos;
+        precisePosition_ = Vector2(static_cast<double>(pos.x), static_cast<double>(pos.y));
     }
     
     /**
-     * @brief Set whether robot is carrying a package.
+     * @brief Set how many packages the robot carries.
      * This should be called by Layer 2 when robot reaches PICKUP/DROPOFF POIs.
      */
-    void SetHasPackage(bool hasPackage) {
-        hasPackage_ = hasPackage;
+    void SetLoadCount(int loadCount) {
+        loadCount_ = std::max(0, loadCount);
     }
 
     // =========================================================================
@@ -291,6 +584,11 @@ private:
      */
     Vector2 CalculatePreferredVelocity() const;
     
+    /**
+     * @brief ComputeVelocity of a SetTimedGoal leg.
+     */
+    void StepTimedLeg(float dt);
+    
     /**
      * @brief Check if current waypoint is reached.
      */
@@ -301,6 +599,11 @@ private:
      */
     bool IsGoalReached() const;
     
+    /**
+     * @brief Recompute pathArcLength_ (and bump pathVersion_) after currentPath_ was assigned.
+     */
+    void RebuildArcLengths();
+    
     /**
      * @brief Advance to next waypoint.
      */
@@ -311,6 +614,43 @@ private:
      */
     void OnPathReceived(const Pathfinding::PathResult& result);
     
+    /**
+     * @brief Whether the rest of currentPath_ runs over a blocked node.
+     */
+    bool IsRemainingPathBlocked() const;
+    
+    /**
+     * @brief Follow replanner_'s route to replanTarget_ (or wait if none).
+     */
+    void FollowDetour();
+    
+    /**
+     * @brief Path along a NavMesh route: the node centres where it turns,
+     *        then target. Starts following it.
+     */
+    void FollowRoute(const std::vector<int>& route, const Backend::Common::Coordinates& target);
+    
+    /**
+     * @brief Back-off hold is over: resume the goal, or stop.
+     */
+    void EndBackOff();
+    
+    /**
+     * @brief Invalidate any outstanding path request; returns the new ticket.
+     */
+    uint64_t NextPathTicket();
+    
+    /**
+     * @brief OnPathReceived with the mailbox result, if one has arrived.
+     */
+    void ReceivePendingPath();
+    
+    /**
+     * @brief ComputeVelocity for either neighbor representation.
+     */
+    template <typename Neighbors>
+    void ComputeVelocityFrom(float dt, const Neighbors& neighbors);
+    
     /**
      * @brief Apply velocity with acceleration limits.
      */
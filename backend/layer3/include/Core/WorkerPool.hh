@@ -0,0 +1,76 @@
+/**
+ * @file WorkerPool.hh
+ * @brief Persistent threads for sharding work inside a physics tick
+ *
+ * Starting threads costs tens of microseconds each, which a 20 Hz loop
+ * pays every tick. The pool starts its threads once and hands them the
+ * shards of each Run; the calling thread works on shards too.
+ */
+
+#ifndef LAYER3_CORE_WORKERPOOL_HH
+#define LAYER3_CORE_WORKERPOOL_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Backend {
+namespace Layer3 {
+namespace Core {
+
+/**
+ * @brief Fixed set of threads running the jobs of one Run at a time.
+ *
+ * Jobs are claimed in any order by any thread, so they must not depend on
+ * each other or throw. Run is not reentrant and is meant to be called from
+ * one thread at a time.
+ */
+class WorkerPool {
+private:
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;          ///< Workers: a Run started or the pool stops
+    std::condition_variable done_;          ///< Caller: all workers finished the Run
+    uint64_t generation_;                   ///< Incremented by every Run
+    size_t busyWorkers_;                    ///< Workers still in the current Run
+    bool stopping_;
+
+    const std::function<void(size_t)>* job_;
+    size_t jobCount_;
+    std::atomic<size_t> nextJob_;
+
+    void WorkerLoop();
+    void RunJobs();
+
+public:
+    /**
+     * @param threads Threads working on a Run, the caller included
+     *        (0 = one per hardware thread; 1 = the caller only)
+     */
+    explicit WorkerPool(size_t threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Threads working on a Run, the caller included.
+     */
+    size_t GetThreadCount() const { return workers_.size() + 1; }
+
+    /**
+     * @brief Run job(0) .. job(jobs - 1) and return when all have finished.
+     */
+    void Run(size_t jobs, const std::function<void(size_t)>& job);
+};
+
+} // namespace Core
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_CORE_WORKERPOOL_HH
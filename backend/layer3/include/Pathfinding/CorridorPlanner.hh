@@ -0,0 +1,87 @@
+/**
+ * @file CorridorPlanner.hh
+ * @brief Coarse NavMesh routes that confine Theta* to a corridor
+ *
+ * Theta* searches the full-resolution grid, so a cross-warehouse query
+ * expands most of the free floor. The NavMesh describes the same floor
+ * with one node per tile: an A* route over it is cheap, and the tiles
+ * along the route (widened by a margin) are all the fine search needs.
+ */
+
+#ifndef LAYER3_PATHFINDING_CORRIDORPLANNER_HH
+#define LAYER3_PATHFINDING_CORRIDORPLANNER_HH
+
+#include <vector>
+
+#include "Pathfinding/ThetaStarSolver.hh"
+#include "Coordinates.hh"
+#include "NavMesh.hh"
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+/**
+ * @brief Two-level planning front end: NavMesh route -> SearchCorridor.
+ *
+ * Routes use the static graph (the node overlay is written by the obstacle
+ * loop and is not read here; the fine search does not see dynamic
+ * obstacles either). Node geometry comes from the mesh: uniform tiles of
+ * GetTileSize() centred on the node, or the node's rectangle on
+ * region-merged meshes.
+ *
+ * Read-only after construction: concurrent queries are safe. The NavMesh
+ * must outlive the planner.
+ */
+class CorridorPlanner {
+public:
+    static constexpr int DEFAULT_MARGIN_TILES = 1;
+
+private:
+    const Backend::Layer1::NavMesh& mesh_;
+    int tileSize_;
+    int marginTiles_;
+
+    /// Pixel rectangle covered by a node
+    Backend::Layer1::RegionRect NodeRect(int nodeId) const;
+
+public:
+    /**
+     * @param navMesh Mesh to route on (tile size must be set)
+     * @param marginTiles Tiles added around every route node
+     * @throws std::invalid_argument if the tile size is unset or the margin negative
+     */
+    explicit CorridorPlanner(const Backend::Layer1::NavMesh& navMesh,
+                             int marginTiles = DEFAULT_MARGIN_TILES);
+
+    /**
+     * @brief A* route between the nodes at start and end.
+     *
+     * @param settled If given, receives the number of nodes expanded
+     * @return Node IDs from start to end, empty if unreachable
+     */
+    std::vector<int> FindRoute(const Backend::Common::Coordinates& start,
+                               const Backend::Common::Coordinates& end,
+                               int* settled = nullptr) const;
+
+    /**
+     * @brief Corridor of a route over a width x height map.
+     *
+     * Holds every route node's rectangle and the tiles around start and
+     * end, each widened by the margin, in cells of step pixels (the
+     * ThetaStarSolver::GridStep of the map).
+     */
+    void BuildCorridor(const std::vector<int>& route,
+                       const Backend::Common::Coordinates& start,
+                       const Backend::Common::Coordinates& end,
+                       int width, int height, int step,
+                       ThetaStarSolver::SearchCorridor& corridor) const;
+
+    int GetMarginTiles() const { return marginTiles_; }
+};
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_PATHFINDING_CORRIDORPLANNER_HH
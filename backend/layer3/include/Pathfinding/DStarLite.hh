@@ -0,0 +1,136 @@
+/**
+ * @file DStarLite.hh
+ * @brief Incremental NavMesh routes that are repaired, not recomputed
+ *
+ * When a forklift blocks an aisle, every robot whose path crosses it
+ * needs a detour, and as the forklift moves the detours change again.
+ * D* Lite (Koenig & Likhachev 2002) keeps the search state of the last
+ * route: after the overlay changes only the nodes whose distance to the
+ * goal changed are expanded again, usually a small fraction of a fresh
+ * search.
+ */
+
+#ifndef LAYER3_PATHFINDING_DSTARLITE_HH
+#define LAYER3_PATHFINDING_DSTARLITE_HH
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "NavMesh.hh"
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+/**
+ * @brief D* Lite from a moving start to a fixed goal node.
+ *
+ * Searches backwards from the goal over the NavMesh, so that the robot's
+ * advance only shifts the heuristic (the key modifier km) instead of
+ * invalidating the search. Edges touching a blocked node of the overlay
+ * cost infinity, except at the start (a robot may always drive off the
+ * node it stands on); traversal penalties of the overlay are added as
+ * in the cost matrix. Edge costs must be symmetric, as NavMeshGenerator
+ * builds them (neighbours double as predecessors).
+ *
+ * Copyable (the state is plain vectors) so drivers holding one stay
+ * copyable. Not thread-safe; the overlay must not change during a call.
+ */
+class DStarLite {
+public:
+    static constexpr float INFINITE_COST = std::numeric_limits<float>::infinity();
+
+private:
+    /// Priority of a node: lexicographic (min(g, rhs) + h + km, min(g, rhs))
+    using Key = std::pair<float, float>;
+    using OpenEntry = std::pair<Key, int>;
+
+    const Backend::Layer1::NavMesh* mesh_;
+    int start_;
+    int goal_;
+    float km_;
+
+    std::vector<float> g_;      ///< Settled distance to the goal
+    std::vector<float> rhs_;    ///< One-step lookahead distance
+    std::vector<Key> openKey_;  ///< Key of the node's live open entry
+    std::vector<char> inOpen_;  ///< Entries not live are skipped when popped
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> open_;
+
+    uint64_t lastExpansions_;
+    uint64_t totalExpansions_;
+
+    float Heuristic(int a, int b) const;
+    float EdgeCost(int from, int to, float cost) const;
+    Key CalculateKey(int node) const;
+
+    /// Recompute rhs of a node and (re)queue it if inconsistent
+    void UpdateVertex(int node);
+
+    /// UpdateVertex for a node and its neighbours (its edge costs changed)
+    void UpdateAround(int node);
+
+    /// Smallest live key (INFINITE_COST pair if the open list is empty)
+    Key TopKey();
+
+    /// Expand until the start is consistent; true if it reaches the goal
+    bool ComputeShortestPath();
+
+public:
+    DStarLite();
+    explicit DStarLite(const Backend::Layer1::NavMesh& navMesh);
+
+    /**
+     * @brief Start over: search from start to goal.
+     *
+     * @return true if the goal is reachable
+     */
+    bool Plan(int startNodeId, int goalNodeId);
+
+    /**
+     * @brief The robot has reached another node.
+     *
+     * Expands only what the new start needs (usually nothing if it lies
+     * on the route).
+     *
+     * @return true if the goal is reachable from there
+     */
+    bool MoveStart(int startNodeId);
+
+    /**
+     * @brief Repair the route after these nodes changed blocked state
+     *        or penalty.
+     *
+     * @return true if the goal is still (or again) reachable
+     */
+    bool NotifyChanged(const std::vector<int>& changedNodeIds);
+
+    /**
+     * @brief Node IDs from the start to the goal along the current
+     *        shortest route (empty if unreachable or no plan).
+     */
+    std::vector<int> GetRoute() const;
+
+    bool HasPlan() const { return goal_ >= 0; }
+    int GetGoal() const { return goal_; }
+    int GetStart() const { return start_; }
+
+    /// Route cost from the start (INFINITE_COST if unreachable)
+    float GetCost() const { return HasPlan() ? g_[start_] : INFINITE_COST; }
+
+    /// Drop the search state (the next route needs Plan)
+    void Reset() { goal_ = -1; }
+
+    /// Nodes expanded by the last Plan / NotifyChanged, and since construction
+    uint64_t GetLastExpansions() const { return lastExpansions_; }
+    uint64_t GetTotalExpansions() const { return totalExpansions_; }
+};
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_PATHFINDING_DSTARLITE_HH
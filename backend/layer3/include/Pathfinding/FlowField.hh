@@ -0,0 +1,129 @@
+/**
+ * @file FlowField.hh
+ * @brief Precomputed paths from everywhere to one busy goal
+ *
+ * Most robots of a shift drive to the same few dropoffs and chargers, and
+ * each of them searched its own path there. A flow field is one Dijkstra
+ * from the goal over the whole lattice: afterwards the next step towards
+ * the goal from any cell is a table lookup, and a path is read off by
+ * following the steps.
+ */
+
+#ifndef LAYER3_PATHFINDING_FLOWFIELD_HH
+#define LAYER3_PATHFINDING_FLOWFIELD_HH
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Pathfinding/ThetaStarSolver.hh"
+#include "Coordinates.hh"
+#include "InflatedBitMap.hh"
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+/**
+ * @brief Integration and direction field of one goal on the Theta* lattice.
+ *
+ * Cells and moves are those of JumpPointSolver (pixels at multiples of
+ * the map's ThetaStarSolver::GridStep, free where the safety map is, 8-connected without cutting a
+ * blocked corner). The integration field holds every cell's octile
+ * distance to the goal, the direction field the neighbour that distance
+ * continues through. Paths are string-pulled like Theta* paths.
+ *
+ * Built once at construction; the map must not change while the field is
+ * used (build a new one instead). All queries are const, so concurrent
+ * readers are safe.
+ */
+class FlowField {
+public:
+    static constexpr int DIRECTIONS = 8;
+    static constexpr uint8_t NO_DIRECTION = 0xFF;   ///< Goal cell, or the goal is unreachable
+    static constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+
+private:
+    const Backend::Layer1::InflatedBitMap* safetyMap_;
+    ThetaStarSolver smoother_;      ///< Line of sight and SimplifyPath
+    Backend::Common::Coordinates goal_;
+    int gridStep_;                  ///< Lattice spacing in pixels (fixed by the map's resolution)
+
+    // Lattice with a blocked border of one cell: cell (c, r) is padded
+    // index (r + 1) * stride_ + (c + 1)
+    int columns_;
+    int rows_;
+    int stride_;
+    int32_t goalCell_;
+    std::vector<uint8_t> free_;
+    std::vector<float> distance_;       ///< Integration field (pixels to the goal)
+    std::vector<uint8_t> direction_;    ///< Direction field (N, NE, E, ... NW)
+
+    // Unit steps of the directions N, NE, E, SE, S, SW, W, NW (even = straight)
+    std::array<int32_t, DIRECTIONS> offset_;
+
+    int32_t CellAt(int column, int row) const { return (row + 1) * stride_ + (column + 1); }
+    int ColumnOf(int32_t cell) const { return cell % stride_ - 1; }
+    int RowOf(int32_t cell) const { return cell / stride_ - 1; }
+
+    /// Lattice cell of a point (clamped to the map)
+    int32_t CellOf(const Backend::Common::Coordinates& point) const;
+
+    /// Whether the step from cell in direction is allowed
+    bool CanStep(int32_t cell, int direction) const;
+
+    /// Dijkstra from the goal, filling distance_ and direction_
+    void Integrate();
+
+public:
+    /**
+     * @brief Build the fields of goal over safetyMap.
+     *
+     * The map must outlive the field. A goal on a blocked cell gives a
+     * field that reaches nothing.
+     */
+    FlowField(const Backend::Layer1::InflatedBitMap& safetyMap,
+              const Backend::Common::Coordinates& goal);
+
+    const Backend::Common::Coordinates& GetGoal() const { return goal_; }
+
+    /// Whether point lies in the goal's lattice cell (the field serves paths to it)
+    bool HasGoalCell(const Backend::Common::Coordinates& point) const { return CellOf(point) == goalCell_; }
+
+    /// Pixels from point's cell to the goal along the lattice (UNREACHABLE if none)
+    float GetDistance(const Backend::Common::Coordinates& point) const { return distance_[CellOf(point)]; }
+
+    bool IsReachable(const Backend::Common::Coordinates& point) const { return GetDistance(point) != UNREACHABLE; }
+
+    /**
+     * @brief Next lattice point towards the goal from point's cell.
+     *
+     * @return false at the goal cell or if the goal is unreachable
+     */
+    bool GetNextStep(const Backend::Common::Coordinates& point, Backend::Common::Coordinates& next) const;
+
+    /**
+     * @brief Path from start to end, which must lie in the goal's cell.
+     *
+     * Follows the direction field and string-pulls the result; no search.
+     * The path starts and ends at the exact coordinates. As with
+     * JumpPointSolver, pathLength is the lattice distance before smoothing
+     * (the straight distance if the ends see each other), nodesExpanded
+     * the cells followed.
+     */
+    PathResult ComputePath(const Backend::Common::Coordinates& start,
+                           const Backend::Common::Coordinates& end) const;
+
+    /// Bytes held by the lattice and both fields
+    size_t GetMemoryBytes() const {
+        return free_.size() * sizeof(uint8_t) + distance_.size() * sizeof(float) +
+               direction_.size() * sizeof(uint8_t);
+    }
+};
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_PATHFINDING_FLOWFIELD_HH
@@ -0,0 +1,128 @@
+/**
+ * @file JumpPointSolver.hh
+ * @brief Jump Point Search (JPS / JPS+) over the Theta* search lattice
+ *
+ * The search lattice is a uniform-cost 8-connected grid, where most
+ * optimal paths have many symmetric equivalents that A* (and Theta*)
+ * all expand. Jump Point Search only expands the points where an optimal
+ * path may have to turn, and JPS+ precomputes the jumps between them.
+ */
+
+#ifndef LAYER3_PATHFINDING_JUMPPOINTSOLVER_HH
+#define LAYER3_PATHFINDING_JUMPPOINTSOLVER_HH
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Pathfinding/ThetaStarSolver.hh"
+#include "Coordinates.hh"
+#include "InflatedBitMap.hh"
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+/**
+ * @brief How JumpPointSolver finds the next jump point in a direction.
+ */
+enum class JumpPointMode {
+    ONLINE,         ///< Scan the lattice cell by cell (JPS, Harabor & Grastien 2011)
+    PRECOMPUTED     ///< Look up per-cell jump distances built once per map (JPS+, Rabin 2015)
+};
+
+/**
+ * @brief Grid-optimal search with jump points, smoothed like Theta*.
+ *
+ * Nodes are the ThetaStarSolver lattice: pixels at multiples of the
+ * map's GridStep, free if the safety map is free there, with the same moves
+ * (8-connected, no diagonal past a blocked orthogonal neighbour; the
+ * variant of Harabor & Grastien 2014). The search finds a shortest
+ * octile path through the jump points, and ThetaStarSolver::SimplifyPath
+ * then string-pulls it. PathResult::pathLength is the octile length of
+ * the grid path before smoothing.
+ *
+ * The lattice (and in PRECOMPUTED mode 8 jump distances per cell) is
+ * built from the map at construction; the map must not change
+ * afterwards. ComputePath is const and uses a workspace per calling
+ * thread, so concurrent queries are safe.
+ */
+class JumpPointSolver {
+public:
+    static constexpr int DIRECTIONS = 8;
+
+private:
+    JumpPointMode mode_;
+    const Backend::Layer1::InflatedBitMap* safetyMap_;
+    ThetaStarSolver smoother_;      ///< Line of sight and SimplifyPath
+    int gridStep_;                  ///< Lattice spacing in pixels (fixed by the map's resolution)
+
+    // Lattice with a blocked border of one cell: cell (c, r) is padded
+    // index (r + 1) * stride_ + (c + 1), also its workspace node
+    int columns_;
+    int rows_;
+    int stride_;
+    std::vector<uint8_t> free_;
+
+    // Unit steps of the directions N, NE, E, SE, S, SW, W, NW (even = straight)
+    std::array<int32_t, DIRECTIONS> offset_;
+
+    // PRECOMPUTED: per cell and direction, steps to the next jump point
+    // (> 0) or minus the free steps before a wall (<= 0)
+    std::vector<int16_t> jumpDistance_;
+
+    void BuildJumpDistances();
+
+    int32_t CellAt(int column, int row) const { return (row + 1) * stride_ + (column + 1); }
+    int ColumnOf(int32_t cell) const { return cell % stride_ - 1; }
+    int RowOf(int32_t cell) const { return cell / stride_ - 1; }
+
+    /// Whether cell, entered by straight direction, has a forced neighbour
+    bool HasForcedNeighbor(int32_t cell, int direction) const;
+
+    /// Whether the diagonal step from cell in direction is allowed
+    bool CanStepDiagonal(int32_t cell, int direction) const;
+
+    /// ONLINE: next jump point from cell in direction (goal counts), -1 if none
+    int32_t Jump(int32_t cell, int direction, int32_t goal) const;
+
+    /// Directions to search from cell, reached from its parent by direction (-1 = start)
+    int SuccessorDirections(int32_t cell, int direction, std::array<int, DIRECTIONS>& out) const;
+
+    /// Octile distance in pixels between two cells
+    double Octile(int32_t a, int32_t b) const;
+
+public:
+    /**
+     * @brief Build the lattice of safetyMap (and the jump tables).
+     *
+     * @throws std::invalid_argument if PRECOMPUTED and the lattice is
+     *         too large for 16-bit jump distances
+     */
+    JumpPointSolver(const Backend::Layer1::InflatedBitMap& safetyMap,
+                    JumpPointMode mode = JumpPointMode::PRECOMPUTED);
+
+    /**
+     * @brief Compute a smoothed grid-optimal path from start to end.
+     *
+     * Both ends snap to the lattice as in ThetaStarSolver; the returned
+     * path starts and ends at the exact coordinates.
+     */
+    PathResult ComputePath(
+        const Backend::Common::Coordinates& start,
+        const Backend::Common::Coordinates& end
+    ) const;
+
+    JumpPointMode GetMode() const { return mode_; }
+
+    /// Bytes held by the lattice and jump tables
+    size_t GetMemoryBytes() const {
+        return free_.size() * sizeof(uint8_t) + jumpDistance_.size() * sizeof(int16_t);
+    }
+};
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_PATHFINDING_JUMPPOINTSOLVER_HH
@@ -0,0 +1,194 @@
+/**
+ * @file MultiAgentPlanner.hh
+ * @brief Windowed cooperative planning of the whole fleet on the NavMesh
+ *
+ * Robots that plan independently meet head-on in aisles and only ORCA
+ * sorts it out, by stopping one of them. Windowed Hierarchical
+ * Cooperative A* (WHCA*, Silver 2005) plans the robots one after the
+ * other in space-time: each one avoids the nodes the robots before it
+ * reserved in a reservation table, so the conflicts of the next few
+ * seconds are resolved by planning (wait here, take the other aisle)
+ * rather than by braking.
+ */
+
+#ifndef LAYER3_PATHFINDING_MULTIAGENTPLANNER_HH
+#define LAYER3_PATHFINDING_MULTIAGENTPLANNER_HH
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "NavMesh.hh"
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+/**
+ * @brief Which robot holds which NavMesh node at which tick.
+ */
+class ReservationTable {
+private:
+    std::unordered_map<uint64_t, int> owner_;   ///< (node, tick) -> robot
+
+    static uint64_t Key(int nodeId, int tick) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(nodeId)) << 32) | static_cast<uint32_t>(tick);
+    }
+
+public:
+    /// Claim a node at a tick (a tick already held by another robot stays theirs)
+    void Reserve(int nodeId, int tick, int robotId) { owner_.emplace(Key(nodeId, tick), robotId); }
+
+    /// True if nobody but robotId holds the node at the tick
+    bool IsFree(int nodeId, int tick, int robotId) const {
+        auto it = owner_.find(Key(nodeId, tick));
+        return it == owner_.end() || it->second == robotId;
+    }
+
+    /// True if IsFree for every tick in [first, last]
+    bool IsFree(int nodeId, int first, int last, int robotId) const {
+        for (int tick = first; tick <= last; ++tick) {
+            if (!IsFree(nodeId, tick, robotId)) return false;
+        }
+        return true;
+    }
+
+    void Clear() { owner_.clear(); }
+    size_t Size() const { return owner_.size(); }
+};
+
+/**
+ * @brief Configuration of MultiAgentPlanner.
+ */
+struct MultiAgentConfig {
+    double tickSeconds = 0.25;      ///< Duration of one planning tick
+    int windowTicks = 32;           ///< Ticks planned cooperatively (the rest of the route ignores other robots)
+    double speed = 16.0;            ///< Robot cruise speed (pixels/second): sets how many ticks an edge takes
+    int maxExpansions = 20000;      ///< Space-time states expanded per robot before it waits in place
+    double clearance = 0.0;         ///< Nodes closer than this to a planned node are held too (pixels; e.g. the robot diameter)
+};
+
+/**
+ * @brief One robot to plan: where it is, where it goes.
+ */
+struct MultiAgentQuery {
+    int robotId;
+    int startNodeId;
+    int goalNodeId;             ///< -1 = no goal: the robot holds its node for the window
+};
+
+/**
+ * @brief A robot's windowed plan.
+ *
+ * Step i enters nodes[i] at ticks[i] (ticks from the start of the plan;
+ * step 0 is the start node at tick 0). Two consecutive steps on the same
+ * node are a wait until the later tick.
+ */
+struct MultiAgentPlan {
+    int robotId = -1;
+    std::vector<int> nodes;
+    std::vector<int> ticks;
+    bool reachesGoal = false;   ///< Ends on the goal within the window
+    bool reachable = true;      ///< False if the goal cannot be reached at all
+};
+
+/**
+ * @brief Prioritized windowed space-time A* over the NavMesh (WHCA*).
+ *
+ * Plan() searches the robots in query order. A robot's state is (node,
+ * tick); it may wait a tick or take an edge, which lasts
+ * ceil(cost / (speed * tickSeconds)) ticks, and holds both endpoints for
+ * every tick of the traversal (so two robots cannot swap across an edge
+ * or follow each other closer than one tick), together with the nodes
+ * within the clearance of them. Every robot first keeps its
+ * start node for ticks 0 and 1, so nobody is planned into a robot that
+ * has not moved away yet. The search ends at the goal, if the robot can
+ * stay there until the window closes, or at the end of the window, with
+ * the true route distance to the goal (a reverse Dijkstra per goal,
+ * cached) as the estimate of the rest. Blocked nodes of the dynamic
+ * overlay are avoided like reserved ones.
+ *
+ * Plans are only collision-free among themselves for windowTicks: call
+ * Plan again (with new priorities, e.g. rotated) well before the window
+ * runs out. Not thread-safe; the NavMesh must outlive the planner.
+ */
+class MultiAgentPlanner {
+public:
+    static constexpr int UNREACHABLE = -1;
+    static constexpr size_t MAX_CACHED_GOALS = 256;
+
+private:
+    const Backend::Layer1::NavMesh& mesh_;
+    MultiAgentConfig config_;
+
+    // Incoming edges as CSR (the heuristic runs Dijkstra backwards from the goal)
+    std::vector<int> reverseOffsets_;
+    std::vector<int> reverseSources_;
+    std::vector<int> reverseTicks_;
+    
+    // Per node, the other nodes within the clearance (CSR)
+    std::vector<int> footprintOffsets_;
+    std::vector<int> footprintNodes_;
+
+    // Per goal: ticks from every node to it (UNREACHABLE if none)
+    std::unordered_map<int, std::vector<int>> goalDistances_;
+
+    ReservationTable reservations_;
+    uint64_t expansions_;
+
+    /// Planning ticks to traverse an edge of this cost (at least one)
+    int EdgeTicks(float cost) const;
+
+    /// Build the reverse adjacency and footprints, drop cached distances
+    void IndexMesh();
+    
+    /// Reserve a node and its footprint
+    void Hold(int nodeId, int tick, int robotId);
+
+    /// Distances to goal, computed on first use
+    const std::vector<int>& DistancesTo(int goalNodeId);
+
+    /// Space-time A* for one robot against reservations_; false if it found nothing
+    bool SearchWindow(const MultiAgentQuery& query, MultiAgentPlan& plan);
+
+    /// Record a plan's steps (and the goal until the window closes) in reservations_
+    void ReservePlan(const MultiAgentPlan& plan);
+
+public:
+    /**
+     * @throws std::invalid_argument if the window, tick or speed is not positive
+     */
+    explicit MultiAgentPlanner(const Backend::Layer1::NavMesh& navMesh,
+                               const MultiAgentConfig& config = MultiAgentConfig());
+
+    /**
+     * @brief Plan the next window for all robots, earlier queries first.
+     *
+     * Robots that cannot find a plan (search limit hit, boxed in) wait on
+     * their start node; those whose goal is unreachable come back with
+     * reachable = false.
+     *
+     * @return One plan per query, in query order
+     */
+    std::vector<MultiAgentPlan> Plan(const std::vector<MultiAgentQuery>& queries);
+
+    /**
+     * @brief Re-read the graph (call after the mesh's edges changed).
+     */
+    void Reindex() { IndexMesh(); }
+
+    const MultiAgentConfig& GetConfig() const { return config_; }
+    double GetTickSeconds() const { return config_.tickSeconds; }
+
+    /// Space-time states expanded by the last Plan
+    uint64_t GetLastExpansions() const { return expansions_; }
+
+    /// Reservations made by the last Plan
+    size_t GetLastReservations() const { return reservations_.Size(); }
+};
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_PATHFINDING_MULTIAGENTPLANNER_HH
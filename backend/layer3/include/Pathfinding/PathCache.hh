@@ -0,0 +1,130 @@
+/**
+ * @file PathCache.hh
+ * @brief Bounded, thread-safe cache of computed robot paths
+ *
+ * Robots keep driving the same legs (charger -> pickup -> dropoff), and
+ * Theta* snaps both ends of a query to its lattice, so a query from the
+ * same start tile to the same goal tile repeats an earlier search. The
+ * cache keeps the smoothed waypoints of such searches.
+ */
+
+#ifndef LAYER3_PATHFINDING_PATHCACHE_HH
+#define LAYER3_PATHFINDING_PATHCACHE_HH
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "Pathfinding/ThetaStarSolver.hh"
+#include "Coordinates.hh"
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+/**
+ * @brief Sharded LRU map (start tile, goal tile) -> PathResult.
+ *
+ * Same layout as Layer2::PairCostCache: SHARD_COUNT shards with their own
+ * mutex, LRU list and capacity, entries tagged with the map version they
+ * were computed against (a lookup with another version misses and drops
+ * the shard's stale entries). A tile is tileSize x tileSize pixels.
+ *
+ * The cache only stores and looks up; callers decide whether a stored path
+ * still fits the exact endpoints of a query and record hits and misses.
+ * Counters are relaxed atomics.
+ */
+class PathCache {
+public:
+    static constexpr size_t SHARD_COUNT = 16;
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+private:
+    struct Shard {
+        std::mutex mutex;
+
+        // Most recently used at the front
+        std::list<std::pair<uint64_t, PathResult>> lru;
+        std::unordered_map<uint64_t, std::list<std::pair<uint64_t, PathResult>>::iterator> index;
+
+        // Map version of every entry in this shard
+        uint64_t version = 0;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards_;
+    size_t shardCapacity_;
+    int tileSize_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> savedMicroseconds_{0};
+
+    uint64_t MakeKey(const Backend::Common::Coordinates& start,
+                     const Backend::Common::Coordinates& end) const;
+
+    Shard& ShardFor(uint64_t key);
+
+    // Drop all entries of a shard whose version differs (caller holds the lock)
+    static void SyncVersion(Shard& shard, uint64_t version);
+
+public:
+    /**
+     * @param capacity Maximum number of entries, split evenly over the shards
+     * @param tileSize Side of a key tile in pixels (the solver's lattice step)
+     * @throws std::invalid_argument if tileSize is not positive
+     */
+    explicit PathCache(size_t capacity = DEFAULT_CAPACITY,
+                       int tileSize = ThetaStarSolver::GridStep(Backend::Common::Resolution::DECIMETERS));
+
+    PathCache(const PathCache&) = delete;
+    PathCache& operator=(const PathCache&) = delete;
+
+    /**
+     * @brief Look up the path between the tiles of start and end.
+     *
+     * @return true and copies the stored result on a hit (the entry
+     *         becomes most recent)
+     */
+    bool Find(const Backend::Common::Coordinates& start,
+              const Backend::Common::Coordinates& end,
+              uint64_t version, PathResult& result);
+
+    /**
+     * @brief Insert or refresh the path between the tiles of start and end,
+     *        evicting the shard's least recently used entry when it is full.
+     */
+    void Insert(const Backend::Common::Coordinates& start,
+                const Backend::Common::Coordinates& end,
+                uint64_t version, const PathResult& result);
+
+    /**
+     * @brief Remove every entry (counters are kept).
+     */
+    void Clear();
+
+    // --- Stats ---
+    void RecordHit(double savedMs);
+    void RecordMiss() { misses_.fetch_add(1, std::memory_order_relaxed); }
+
+    size_t GetSize();
+    size_t GetMemoryBytes();        ///< Estimated bytes held by all shards, waypoints included
+    size_t GetCapacity() const { return shardCapacity_ * SHARD_COUNT; }
+    uint64_t GetHits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t GetMisses() const { return misses_.load(std::memory_order_relaxed); }
+    double GetHitRate() const;
+
+    /// Search time of the original computations that hits replaced
+    double GetSavedMs() const { return savedMicroseconds_.load(std::memory_order_relaxed) / 1000.0; }
+    void ResetStats();
+};
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_PATHFINDING_PATHCACHE_HH
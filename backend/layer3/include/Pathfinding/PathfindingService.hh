@@ -2,22 +2,34 @@
  * @file PathfindingService.hh
  * @brief Centralized pathfinding service with FIFO request queue
  * 
- * Provides a singleton service for managing pathfinding requests.
- * Requests are processed in FIFO order (no priority).
+ * Provides a service object for managing pathfinding requests. Each
+ * instance serves one safety map, so several fleets (or what-if
+ * simulations) can plan side by side in one process.
  */
 
 #ifndef LAYER3_PATHFINDING_PATHFINDINGSERVICE_HH
 #define LAYER3_PATHFINDING_PATHFINDINGSERVICE_HH
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <future>
+#include <thread>
+#include <vector>
 
+#include "Pathfinding/CorridorPlanner.hh"
+#include "Pathfinding/FlowField.hh"
+#include "Pathfinding/JumpPointSolver.hh"
+#include "Pathfinding/PathCache.hh"
 #include "Pathfinding/ThetaStarSolver.hh"
 #include "Coordinates.hh"
 #include "InflatedBitMap.hh"
+#include "LatencyHistogram.hh"
 
 namespace Backend {
 namespace Layer3 {
@@ -28,6 +40,48 @@ namespace Pathfinding {
  */
 using PathCallback = std::function<void(const PathResult&)>;
 
+/**
+ * @brief Paths of the legs of an itinerary (RequestItinerary).
+ */
+struct ItineraryResult {
+    std::vector<PathResult> legs;   ///< One per goal, in order (empty if the request was dropped)
+    uint64_t mapVersion = 0;        ///< Map version the legs were planned at
+};
+
+/**
+ * @brief Callback type for itinerary completion.
+ */
+using ItineraryCallback = std::function<void(const ItineraryResult&)>;
+
+/**
+ * @brief Grid search used for robot paths.
+ */
+enum class PathAlgorithm {
+    THETA_STAR,     ///< Any-angle Theta* (ThetaStarSolver, basic or lazy)
+    JPS,            ///< Jump Point Search + smoothing (JumpPointSolver, ONLINE)
+    JPS_PLUS        ///< JPS with precomputed jump distances + smoothing (JumpPointSolver, PRECOMPUTED)
+};
+
+/**
+ * @brief Scheduling class of a path request (most urgent first).
+ */
+enum class PathPriority {
+    EMERGENCY,      ///< Reroute of a robot that blocks others
+    ACTIVE_GOAL,    ///< Path to a robot's current goal
+    PREFETCH        ///< Speculative path for a later goal
+};
+
+constexpr size_t PATH_PRIORITY_COUNT = 3;
+
+/**
+ * @brief Scheduling options of a path request.
+ */
+struct PathRequestOptions {
+    PathPriority priority = PathPriority::ACTIVE_GOAL;
+    int ownerId = -1;                           ///< Robot the path is for; a newer request of the same owner supersedes a queued one (-1 = none)
+    std::chrono::milliseconds maxWait{0};       ///< Give up unless a worker starts it within this long (0 = no deadline)
+};
+
 /**
  * @brief A pathfinding request in the queue.
  */
@@ -37,15 +91,49 @@ struct PathRequest {
     Backend::Common::Coordinates end;        ///< Goal position
     PathCallback callback;                   ///< Completion callback
     std::promise<PathResult>* promise;       ///< For synchronous waiting (optional)
+    PathPriority priority;                   ///< Scheduling class
+    int ownerId;                             ///< Robot the path is for (-1 = none)
+    std::chrono::steady_clock::time_point deadline;  ///< Latest start (time_point::max() = none)
+    std::vector<Backend::Common::Coordinates> legEnds;  ///< Itinerary: goals after end, each leg from the previous goal
+    ItineraryCallback itineraryCallback;     ///< Itinerary: completion callback (instead of callback)
 };
 
 /**
- * @brief Singleton pathfinding service.
+ * @brief Pathfinding service for one safety map.
+ * 
+ * Owned by whoever owns the map (e.g. FleetManager) and handed to the
+ * RobotDrivers by reference; instances share no state. Manages a queue of path requests and processes them using ThetaStarSolver.
+ * 
+ * Scheduling: the next request is taken from the most urgent non-empty
+ * priority class; within a class, earliest deadline first, then FIFO.
+ * A request with an owner replaces the owner's queued request of the same
+ * kind (PREFETCH, or a path to the current goal), and requests not
+ * started by their deadline are dropped. Superseded,
+ * cancelled and expired requests complete with a failed result (callback
+ * invoked, promise set) without being computed.
+ * 
+ * With EnablePathCache, successful paths are kept per (start tile, goal
+ * tile, map version) and a repeated query copies the stored waypoints,
+ * after checking that its exact endpoints see the inner waypoints.
+ * 
+ * With EnableCorridorPlanning, a search first routes over the NavMesh and
+ * runs Theta* only in the corridor of tiles along that route, falling
+ * back to the whole map when the corridor does not connect the endpoints.
  * 
- * Manages a FIFO queue of path requests and processes them using ThetaStarSolver.
+ * RequestItinerary plans every leg of a list of goals as one request: a
+ * single worker searches the legs back to back, so they share its search
+ * workspace (and flow fields and cache as any request).
+ * 
+ * SetAlgorithm replaces Theta* by Jump Point Search (corridors then do
+ * not apply: JPS already skips the open floor between turning points).
+ * 
+ * With StartWorkers the queue is consumed by dedicated threads as requests
+ * arrive, and callbacks / promises complete on those threads. Without
+ * workers, requests wait until ProcessNextRequest or ProcessAllRequests is
+ * called (RequestPathSync processes the queue on the caller's thread).
  * 
  * Usage:
- *   auto& service = PathfindingService::GetInstance();
+ *   PathfindingService service;
  *   service.Initialize(safetyMap);
  *   
  *   // Async request with callback
@@ -58,42 +146,100 @@ struct PathRequest {
  */
 class PathfindingService {
 private:
-    // Singleton instance
-    static PathfindingService* instance_;
-    static std::mutex instanceMutex_;
-    
-    // Request queue (FIFO, no priority)
-    std::deque<PathRequest> requestQueue_;
+    // Request queues, one per PathPriority (see class comment for the order)
+    std::array<std::deque<PathRequest>, PATH_PRIORITY_COUNT> requestQueues_;
     std::mutex queueMutex_;
+    std::condition_variable queueReady_;    ///< Workers: a request arrived or they stop
+    
+    // Worker threads consuming the queue (empty = processed on demand)
+    std::vector<std::thread> workers_;
+    bool stopping_;
     
     // Pathfinding solver
     ThetaStarSolver solver_;
     
+    // Jump Point Search over safetyMap_ (nullptr unless selected)
+    PathAlgorithm algorithm_;
+    std::unique_ptr<JumpPointSolver> jumpPointSolver_;
+    
     // Reference to the safety map
     const Backend::Layer1::InflatedBitMap* safetyMap_;
     
+    // Computed paths (nullptr = disabled) and the version they are tagged with
+    std::unique_ptr<PathCache> pathCache_;
+    std::function<uint64_t()> mapVersion_;
+    
+    // Coarse route front end (nullptr = Theta* over the whole map)
+    std::unique_ptr<CorridorPlanner> corridorPlanner_;
+    std::atomic<uint64_t> corridorFallbacks_;
+    
+    // Flow fields of busy goals, each with the map version it was built at
+    struct FlowFieldEntry {
+        Backend::Common::Coordinates goal;
+        uint64_t version;
+        std::shared_ptr<const FlowField> field;
+    };
+    std::vector<FlowFieldEntry> flowFields_;
+    mutable std::mutex flowFieldMutex_;     ///< Guards flowFields_ (fields themselves are immutable)
+    std::atomic<uint64_t> flowFieldPaths_;
+    
+    // Time of every query, whichever of field, cache or search answered it
+    Backend::Common::LatencyHistogram queryLatency_;
+    
     // Request counter
     int nextRequestId_;
     
-    // Private constructor for singleton
-    PathfindingService();
+    // Requests dropped without computing (guarded by queueMutex_)
+    int requestsSuperseded_;
+    int requestsExpired_;
+    
+    void WorkerLoop();
+    
+    /// Assign an id, drop the owner's queued request, queue and wake a worker
+    int Enqueue(PathRequest request);
+    
+    /// Invoke the callback and / or set the promise of a finished request
+    /// (an itinerary's callback gets no legs: only for dropped ones)
+    static void Complete(PathRequest& request, const PathResult& result);
+    
+    /// Whether a newer request of first's owner replaces queued request second
+    static bool Supersedes(const PathRequest& first, const PathRequest& second);
+    
+    /// Paths of the legs of an itinerary request
+    ItineraryResult SolveItinerary(const PathRequest& request);
+    static PathResult FailedResult();
+    
+    /// Field whose goal cell holds end (rebuilt if the map version moved on), or nullptr
+    std::shared_ptr<const FlowField> FlowFieldFor(const Backend::Common::Coordinates& end);
+    
+    /// FindPath, timed into queryLatency_
+    PathResult Solve(const Backend::Common::Coordinates& start,
+                     const Backend::Common::Coordinates& end);
+    
+    /// Path from a flow field or the cache if one fits, else from the solver
+    PathResult FindPath(const Backend::Common::Coordinates& start,
+                        const Backend::Common::Coordinates& end);
+    
+    /// Build or drop jumpPointSolver_ for algorithm_ and safetyMap_
+    void PrepareAlgorithm();
+    
+    /// Search with the selected algorithm (Theta* in the route corridor if corridor planning is on)
+    PathResult Search(const Backend::Common::Coordinates& start,
+                      const Backend::Common::Coordinates& end);
 
 public:
     // =========================================================================
-    // SINGLETON ACCESS
+    // CONSTRUCTOR
     // =========================================================================
     
-    /**
-     * @brief Get the singleton instance.
-     */
-    static PathfindingService& GetInstance();
+    PathfindingService();
     
     /**
-     * @brief Destroy the singleton instance.
+     * @brief Stops the workers; queued requests complete as failed.
      */
-    static void DestroyInstance();
+    ~PathfindingService();
     
-    // Delete copy/move
+    // Delete copy/move (workers and callbacks hold this)
     PathfindingService(const PathfindingService&) = delete;
     PathfindingService& operator=(const PathfindingService&) = delete;
     PathfindingService(PathfindingService&&) = delete;
@@ -106,7 +252,8 @@ public:
     /**
      * @brief Initialize with a safety map.
      * 
-     * Must be called before any path requests.
+     * Must be called before any path requests. Drops flow fields built
+     * for a previous map.
      * 
      * @param safetyMap Inflated bitmap for collision checking
      */
@@ -116,6 +263,117 @@ public:
      * @brief Check if service is initialized.
      */
     bool IsInitialized() const { return safetyMap_ != nullptr; }
+    
+    /**
+     * @brief Select basic or lazy Theta* (before requests are processed).
+     */
+    void SetSearchMode(ThetaStarMode mode) { solver_.SetMode(mode); }
+    
+    /**
+     * @brief Select the grid search (before requests are processed).
+     * 
+     * JPS / JPS_PLUS index the safety map, now or at Initialize.
+     */
+    void SetAlgorithm(PathAlgorithm algorithm);
+    PathAlgorithm GetAlgorithm() const { return algorithm_; }
+    
+    /**
+     * @brief Plan in two levels: NavMesh route, then Theta* in its corridor.
+     * 
+     * Call before requests are processed. The mesh must outlive the service
+     * (or DisableCorridorPlanning) and describe the same floor as the
+     * safety map.
+     * 
+     * @param marginTiles Tiles of slack around the route
+     */
+    void EnableCorridorPlanning(const Backend::Layer1::NavMesh& navMesh,
+                                int marginTiles = CorridorPlanner::DEFAULT_MARGIN_TILES);
+    void DisableCorridorPlanning() { corridorPlanner_.reset(); }
+    bool HasCorridorPlanning() const { return corridorPlanner_ != nullptr; }
+    
+    /**
+     * @brief Corridor searches that failed and were redone on the whole map.
+     */
+    uint64_t GetCorridorFallbacks() const { return corridorFallbacks_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Cache up to capacity computed paths (0 = disable and drop the cache).
+     * 
+     * Call after Initialize (key tiles are the lattice of the map) and
+     * before requests are processed, like SetMapVersionSource.
+     */
+    void EnablePathCache(size_t capacity);
+    
+    /**
+     * @brief Counter that changes whenever cached paths may have become
+     *        invalid (e.g. the NavMesh overlay's change version).
+     * 
+     * Called from the workers: read something they may read concurrently.
+     */
+    void SetMapVersionSource(std::function<uint64_t()> source) { mapVersion_ = std::move(source); }
+    
+    /// Current value of the map version source (0 without one)
+    uint64_t GetMapVersion() const { return mapVersion_ ? mapVersion_() : 0; }
+    
+    /**
+     * @brief The path cache with its hit / miss / savings counters (nullptr if disabled).
+     */
+    PathCache* GetPathCache() const { return pathCache_.get(); }
+    
+    /**
+     * @brief Keep a flow field towards goal (e.g. a busy dropoff or charger).
+     * 
+     * Paths ending in the goal's lattice cell are then read off the field
+     * instead of searched. The field is built now, and again on first use
+     * after the map version changed. Requires Initialize; a goal already
+     * covered is ignored.
+     */
+    void AddFlowFieldGoal(const Backend::Common::Coordinates& goal);
+    
+    /**
+     * @brief Keep flow fields towards exactly these goals (e.g. the busiest
+     *        ones as traffic shifts).
+     * 
+     * Fields of goals still listed are kept, the others dropped, and those
+     * of new goals built now, like AddFlowFieldGoal. Requires Initialize.
+     */
+    void SetFlowFieldGoals(const std::vector<Backend::Common::Coordinates>& goals);
+    
+    /// Drop all flow fields
+    void ClearFlowFields();
+    
+    size_t GetFlowFieldCount() const;
+    
+    /// Paths served from flow fields
+    uint64_t GetFlowFieldPaths() const { return flowFieldPaths_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Time of every path query (queued, itinerary legs and immediate).
+     */
+    const Backend::Common::LatencyHistogram& GetQueryLatency() const { return queryLatency_; }
+    
+    /**
+     * @brief Start threads that process queued requests as they arrive.
+     * 
+     * Call from the thread that owns the service (as StopWorkers and
+     * HasWorkers). Does nothing if workers are already running.
+     * 
+     * @param threads Number of workers (0 = none)
+     * @param onWorkerStart Run first on each worker (e.g. to pin it to CPUs)
+     */
+    void StartWorkers(size_t threads, std::function<void()> onWorkerStart = nullptr);
+    
+    /**
+     * @brief Stop and join the workers once their current request is done.
+     * 
+     * Requests still queued then complete as failed (as ClearQueue).
+     */
+    void StopWorkers();
+    
+    /**
+     * @brief True if worker threads consume the queue.
+     */
+    bool HasWorkers() const { return !workers_.empty(); }
 
     // =========================================================================
     // PATH REQUESTS
@@ -124,18 +382,41 @@ public:
     /**
      * @brief Request a path asynchronously.
      * 
-     * The request is added to the FIFO queue and processed in order.
-     * The callback is invoked when the path is computed.
+     * The request is added to the queue and scheduled by its options.
+     * The callback is invoked when the path is computed (or dropped).
      * 
      * @param start Starting position (pixels)
      * @param end Goal position (pixels)
      * @param callback Function to call with the result
+     * @param options Priority, owner and deadline
      * @return Request ID
      */
     int RequestPath(
         const Backend::Common::Coordinates& start,
         const Backend::Common::Coordinates& end,
-        PathCallback callback
+        PathCallback callback,
+        const PathRequestOptions& options = PathRequestOptions()
+    );
+    
+    /**
+     * @brief Request the paths of an itinerary asynchronously.
+     * 
+     * Leg i runs from goals[i - 1] (from start for the first) to goals[i].
+     * One worker computes all legs in order and then invokes the callback
+     * with them; a leg that fails does not stop the others. Meant for
+     * PathPriority::PREFETCH: paths for goals a robot drives to later.
+     * 
+     * @param start Starting position of the first leg (pixels)
+     * @param goals Goal of each leg (pixels)
+     * @param callback Function to call with the legs
+     * @param options Priority, owner and deadline
+     * @return Request ID (-1 if not queued: no goals or not initialized)
+     */
+    int RequestItinerary(
+        const Backend::Common::Coordinates& start,
+        const std::vector<Backend::Common::Coordinates>& goals,
+        ItineraryCallback callback,
+        const PathRequestOptions& options = PathRequestOptions()
     );
     
     /**
@@ -145,13 +426,29 @@ public:
      * 
      * @param start Starting position (pixels)
      * @param end Goal position (pixels)
+     * @param options Priority, owner and deadline
      * @return PathResult with the computed path
      */
     PathResult RequestPathSync(
         const Backend::Common::Coordinates& start,
-        const Backend::Common::Coordinates& end
+        const Backend::Common::Coordinates& end,
+        const PathRequestOptions& options = PathRequestOptions()
     );
     
+    /**
+     * @brief Drop a queued request (one already being computed still completes).
+     * 
+     * @return true if the request was still queued
+     */
+    bool CancelRequest(int requestId);
+    
+    /**
+     * @brief Drop every queued request of an owner.
+     * 
+     * @return Number of requests dropped
+     */
+    int CancelRequestsOf(int ownerId);
+    
     /**
      * @brief Compute a path immediately (bypass queue).
      * 
@@ -171,11 +468,12 @@ public:
     // =========================================================================
     
     /**
-     * @brief Process the next request in the queue.
+     * @brief Process the most urgent request in the queue.
      * 
-     * Call this from a worker thread or main loop.
+     * Call this from a worker thread or main loop. Expired requests are
+     * dropped on the way.
      * 
-     * @return true if a request was processed
+     * @return true if a request was processed or dropped
      */
     bool ProcessNextRequest();
     
@@ -192,7 +490,14 @@ public:
     size_t GetQueueSize() const;
     
     /**
-     * @brief Clear all pending requests.
+     * @brief Estimated bytes held by the JPS tables, flow fields, path
+     *        cache and pending requests. Search workspaces are per thread
+     *        and counted by SearchWorkspace::GetLiveBytes.
+     */
+    size_t GetMemoryBytes() const;
+    
+    /**
+     * @brief Clear all pending requests (they complete as failed).
      */
     void ClearQueue();
 
@@ -204,6 +509,16 @@ public:
      * @brief Get total requests processed.
      */
     int GetTotalRequestsProcessed() const { return nextRequestId_ - 1; }
+    
+    /**
+     * @brief Requests replaced by a newer request of the same owner.
+     */
+    int GetRequestsSuperseded() const;
+    
+    /**
+     * @brief Requests dropped because their deadline passed.
+     */
+    int GetRequestsExpired() const;
 };
 
 } // namespace Pathfinding
@@ -10,16 +10,17 @@
 #ifndef LAYER3_PATHFINDING_THETASTARSOLVER_HH
 #define LAYER3_PATHFINDING_THETASTARSOLVER_HH
 
-#include <vector>
-#include <queue>
-#include <unordered_map>
-#include <unordered_set>
+#include <array>
+#include <atomic>
 #include <cmath>
-#include <functional>
+#include <cstdint>
 #include <limits>
+#include <utility>
+#include <vector>
 
 #include "Coordinates.hh"
 #include "InflatedBitMap.hh"
+#include "Resolution.hh"
 
 namespace Backend {
 namespace Layer3 {
@@ -36,6 +37,16 @@ struct PathResult {
     double computeTimeMs;                             ///< Computation time
 };
 
+/**
+ * @brief When Theta* checks line of sight to a node's candidate parent.
+ */
+enum class ThetaStarMode {
+    BASIC,  ///< On every relaxation of a neighbor (Nash et al. 2007)
+    LAZY    ///< Once per expansion, assuming sight until then (Lazy Theta*, Nash et al. 2010)
+};
+
+class JumpPointSolver;
+
 /**
  * @brief Theta* pathfinding solver.
  * 
@@ -47,45 +58,160 @@ struct PathResult {
  * 
  * This produces smooth "any-angle" paths instead of jagged grid paths.
  * 
+ * In LAZY mode step 2 is deferred: a neighbor takes the grandparent as
+ * parent unchecked, and the line of sight is tested only when the node is
+ * expanded; if it fails, the node falls back to its best expanded neighbor.
+ * This needs one check per expansion instead of one per relaxation, for
+ * paths of about the same length.
+ * 
+ * Line of sight first tries the clearance field of the InflatedBitMap:
+ * when both endpoints are farther from obstacles than the segment is long
+ * no cell can be blocked, and the walk is skipped.
+ * 
  * Uses the InflatedBitMap from Layer 1 for safety checks (robot clearance).
+ * 
+ * Search state lives in a SearchWorkspace: flat arrays over the search
+ * lattice (one cell per GridStep pixels) reset in O(1) by a generation
+ * counter, and an indexed 4-ary heap with decrease-key as the open set.
+ * After the first query on a map, queries allocate nothing but their
+ * result. ComputePath without a workspace uses one per calling thread.
+ * 
+ * The lattice is LATTICE_METERS wide at every resolution. The search is
+ * instantiated per resolution so its step is a constant in the inner
+ * loop; ComputePath picks the instantiation from the map's resolution.
+ * 
+ * A SearchCorridor limits the search to the cells along a coarse route
+ * (see CorridorPlanner), so long queries expand a band instead of the map.
  */
 class ThetaStarSolver {
-private:
-    // Grid step size for node generation
-    static constexpr int GRID_STEP = 5;  // 5 pixels = 0.5m at DECIMETERS resolution
+public:
+    // Lattice spacing for node generation (both ends of a query snap to it)
+    static constexpr double LATTICE_METERS = 0.5;
+    
+    /// Lattice spacing in pixels of a map at res (5 at DECIMETERS)
+    static constexpr int GridStep(Backend::Common::Resolution res) {
+        return Backend::Common::MetersToPixels(LATTICE_METERS, res);
+    }
     
+private:
+    ThetaStarMode mode_;
+
+public:
     /**
-     * @brief Internal node for pathfinding.
+     * @brief Reusable per-thread state of a search.
+     * 
+     * Nodes are lattice cells (x / step, y / step): every node of a search
+     * is the start plus multiples of the step, so no two share a
+     * cell. A workspace serves one search at a time.
      */
-    struct Node {
-        int x, y;              ///< Grid coordinates
-        double gCost;          ///< Cost from start
-        double fCost;          ///< gCost + heuristic
-        int parentX, parentY;  ///< Parent node coordinates
-        
-        bool operator>(const Node& other) const {
-            return fCost > other.fCost;
-        }
+    class SearchWorkspace {
+    public:
+        static constexpr int32_t NONE = -1;
+        static constexpr int32_t CLOSED = -2;   ///< heapPosition of an expanded node
+        static constexpr size_t HEAP_ARITY = 4;
+        
+    private:
+        friend class ThetaStarSolver;
+        friend class JumpPointSolver;   // Same lattice and open set
+        
+        int columns_ = 0;
+        int rows_ = 0;
+        uint32_t generation_ = 0;
+        
+        std::vector<uint32_t> stamp_;           ///< Per node: generation it was last reached in
+        std::vector<double> gCost_;             ///< Per node: cost from start
+        std::vector<double> fCost_;             ///< Per node: gCost + heuristic (heap key)
+        std::vector<int32_t> parent_;           ///< Per node: parent node
+        std::vector<int32_t> heapPosition_;     ///< Per node: index in heap_, or CLOSED
+        std::vector<int32_t> heap_;             ///< Open set (min on fCost_)
+        
+        /// Bytes last added to the live total (refreshed by Begin, so
+        /// heap growth within a search shows up at the next one)
+        size_t accountedBytes_ = 0;
+        static std::atomic<size_t> liveBytes_;
+        
+        /// Start a search on a columns x rows lattice (O(1) unless resized)
+        void Begin(int columns, int rows);
+        
+        bool IsReached(int32_t node) const { return stamp_[node] == generation_; }
+        bool IsClosed(int32_t node) const { return IsReached(node) && heapPosition_[node] == CLOSED; }
+        
+        /// Reach node (first time this search) with its costs and parent
+        void Reach(int32_t node, double gCost, double fCost, int32_t parent);
+        
+        /// Add a reached node to the open set (fCost_ set), or move it up after a decrease
+        void PushOrDecrease(int32_t node);
+        
+        /// Remove and close the open node with the least fCost_
+        int32_t PopMin();
+        
+        void SiftUp(size_t position);
+        void SiftDown(size_t position);
+        
+    public:
+        SearchWorkspace() = default;
+        SearchWorkspace(const SearchWorkspace&) = delete;
+        SearchWorkspace& operator=(const SearchWorkspace&) = delete;
+        ~SearchWorkspace();
+        
+        /// Bytes held by this workspace's arrays
+        size_t GetMemoryBytes() const;
+        
+        /// Bytes held by every live workspace (per-thread ones included)
+        static size_t GetLiveBytes() { return liveBytes_.load(std::memory_order_relaxed); }
     };
-    
+
     /**
-     * @brief Hash function for (x, y) pairs.
+     * @brief Lattice cells a search may expand (Theta* restricted to a
+     *        corridor of a coarse route).
+     * 
+     * Cells are step x step pixel squares from (0, 0), i.e. the cells of
+     * the search lattice, so the step must be the GridStep of the map. Line-of-sight checks still see the whole
+     * map, so a path may cut across cells outside the corridor.
      */
-    struct PairHash {
-        size_t operator()(const std::pair<int, int>& p) const {
-            return std::hash<int>()(p.first) ^ (std::hash<int>()(p.second) << 16);
+    class SearchCorridor {
+    private:
+        int step_ = 1;
+        int columns_ = 0;
+        int rows_ = 0;
+        uint32_t generation_ = 0;
+        std::vector<uint32_t> stamp_;           ///< Per cell: generation it was last added in
+        
+    public:
+        /// Empty corridor of step-pixel cells over a width x height pixel map (O(1) unless resized)
+        void Reset(int width, int height, int step);
+        
+        /// Add the cells overlapping the pixel rectangle [x, x + w) x [y, y + h)
+        void AddRect(int x, int y, int w, int h);
+        
+        int GetStep() const { return step_; }
+        
+        /// Whether cell (column, row) is in the corridor
+        bool ContainsCell(int column, int row) const {
+            return column >= 0 && row >= 0 && column < columns_ && row < rows_ &&
+                   stamp_[static_cast<size_t>(row) * columns_ + column] == generation_;
+        }
+        
+        /// Whether pixel (x, y) lies in a cell of the corridor
+        bool Contains(int x, int y) const {
+            return x >= 0 && y >= 0 && ContainsCell(x / step_, y / step_);
         }
     };
 
-public:
     // =========================================================================
     // CONSTRUCTOR
     // =========================================================================
     
     /**
-     * @brief Default constructor.
+     * @param mode When to check line of sight to the grandparent
+     */
+    explicit ThetaStarSolver(ThetaStarMode mode = ThetaStarMode::BASIC) : mode_(mode) {}
+    
+    /**
+     * @brief Change the mode (not while a ComputePath is running).
      */
-    ThetaStarSolver() = default;
+    void SetMode(ThetaStarMode mode) { mode_ = mode; }
+    ThetaStarMode GetMode() const { return mode_; }
 
     // =========================================================================
     // MAIN INTERFACE
@@ -94,6 +220,8 @@ public:
     /**
      * @brief Compute a smooth path from start to end.
      * 
+     * Thread-safe: uses the calling thread's workspace.
+     * 
      * @param start Starting position (pixel coordinates)
      * @param end Goal position (pixel coordinates)
      * @param safetyMap Inflated bitmap for collision checking
@@ -104,6 +232,22 @@ public:
         const Backend::Common::Coordinates& end,
         const Backend::Layer1::InflatedBitMap& safetyMap
     ) const;
+    
+    /**
+     * @brief Compute a path with the search state in workspace.
+     * 
+     * @param corridor If given, only nodes inside it are expanded (the
+     *        search fails if the corridor does not connect start and end)
+     * @throws std::invalid_argument if the corridor's step is not the
+     *         GridStep of safetyMap
+     */
+    PathResult ComputePath(
+        const Backend::Common::Coordinates& start,
+        const Backend::Common::Coordinates& end,
+        const Backend::Layer1::InflatedBitMap& safetyMap,
+        SearchWorkspace& workspace,
+        const SearchCorridor* corridor = nullptr
+    ) const;
 
     // =========================================================================
     // LINE OF SIGHT
@@ -113,7 +257,8 @@ public:
      * @brief Check if there is line-of-sight between two points.
      * 
      * Uses Bresenham's line algorithm to check all cells between
-     * the two points against the safety map.
+     * the two points against the safety map, unless the clearance field
+     * already proves the segment free.
      * 
      * @param x1, y1 First point (pixels)
      * @param x2, y2 Second point (pixels)
@@ -126,6 +271,35 @@ public:
         const Backend::Layer1::InflatedBitMap& safetyMap
     ) const;
 
+    // =========================================================================
+    // PATH SMOOTHING
+    // =========================================================================
+    
+    /**
+     * @brief Post-process path to remove redundant waypoints.
+     * 
+     * Keeps, from each waypoint, the furthest later one in line of sight.
+     */
+    std::vector<Backend::Common::Coordinates> SimplifyPath(
+        const std::vector<Backend::Common::Coordinates>& path,
+        const Backend::Layer1::InflatedBitMap& safetyMap
+    ) const;
+
+    /**
+     * @brief Put the exact start and end on a path between their lattice
+     *        points.
+     * 
+     * An end replaces its lattice point only if it sees the next waypoint
+     * in; otherwise it is joined to the lattice point, which sight was
+     * checked from.
+     */
+    void AttachEndpoints(
+        std::vector<Backend::Common::Coordinates>& path,
+        const Backend::Common::Coordinates& start,
+        const Backend::Common::Coordinates& end,
+        const Backend::Layer1::InflatedBitMap& safetyMap
+    ) const;
+
 private:
     // =========================================================================
     // INTERNAL HELPERS
@@ -141,37 +315,47 @@ private:
     }
     
     /**
-     * @brief Get 8-connected neighbors.
+     * @brief ComputePath on the lattice of STEP pixels.
      */
-    std::vector<std::pair<int, int>> GetNeighbors(
+    template <int STEP>
+    PathResult Search(
+        const Backend::Common::Coordinates& start,
+        const Backend::Common::Coordinates& end,
+        const Backend::Layer1::InflatedBitMap& safetyMap,
+        SearchWorkspace& workspace,
+        const SearchCorridor* corridor
+    ) const;
+    
+    /**
+     * @brief Get 8-connected neighbors STEP pixels away.
+     * 
+     * @return Number of neighbors written to out
+     */
+    template <int STEP>
+    int GetNeighbors(
         int x, int y,
-        const Backend::Layer1::InflatedBitMap& safetyMap
+        const Backend::Layer1::InflatedBitMap& safetyMap,
+        std::array<std::pair<int, int>, 8>& out
     ) const;
     
     /**
-     * @brief Reconstruct path from parent map.
+     * @brief Reconstruct path from the workspace's parents.
      */
+    template <int STEP>
     std::vector<Backend::Common::Coordinates> ReconstructPath(
-        int endX, int endY,
-        const std::unordered_map<std::pair<int, int>, std::pair<int, int>, PairHash>& parents,
-        const Backend::Common::Coordinates& start,
-        const Backend::Common::Coordinates& end
+        int32_t endNode,
+        int offsetX, int offsetY,
+        const SearchWorkspace& workspace
     ) const;
     
     /**
      * @brief Snap coordinate to grid.
      */
-    int SnapToGrid(int coord) const {
-        return (coord / GRID_STEP) * GRID_STEP;
+    template <int STEP>
+    static int SnapToGrid(int coord) {
+        return (coord / STEP) * STEP;
     }
     
-    /**
-     * @brief Post-process path to remove redundant waypoints.
-     */
-    std::vector<Backend::Common::Coordinates> SimplifyPath(
-        const std::vector<Backend::Common::Coordinates>& path,
-        const Backend::Layer1::InflatedBitMap& safetyMap
-    ) const;
 };
 
 } // namespace Pathfinding
@@ -0,0 +1,113 @@
+/**
+ * @file KinematicsStore.hh
+ * @brief Structure-of-arrays positions and velocities of many robots
+ *
+ * The physics loops hand every robot its neighbors each tick. As an array
+ * of ObstacleData a neighbor set interleaves ids, integer coordinates and
+ * velocities; the ORCA kernels instead want each field packed so that
+ * they can process several neighbors per instruction.
+ */
+
+#ifndef LAYER3_PHYSICS_KINEMATICSSTORE_HH
+#define LAYER3_PHYSICS_KINEMATICSSTORE_HH
+
+#include <cstddef>
+#include <vector>
+
+#include "Physics/ObstacleData.hh"
+
+namespace Backend {
+namespace Layer3 {
+namespace Physics {
+
+/**
+ * @brief Packed x / y / vx / vy / radius arrays of a set of obstacles.
+ *
+ * The arrays are kept at a multiple of LANES entries so that SIMD kernels
+ * can read whole vectors past Size(); entries beyond Size() hold finite
+ * but meaningless values. Clearing keeps the capacity for the next tick.
+ */
+class KinematicsStore {
+public:
+    /// Array length granularity (widest vector read by a kernel)
+    static constexpr size_t LANES = 4;
+
+private:
+    size_t size_ = 0;
+    std::vector<int> id_;
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> vx_;
+    std::vector<double> vy_;
+    std::vector<double> radius_;
+
+    void Grow() {
+        size_t length = x_.size() + LANES;
+        id_.resize(length, -1);
+        x_.resize(length, 0.0);
+        y_.resize(length, 0.0);
+        vx_.resize(length, 0.0);
+        vy_.resize(length, 0.0);
+        radius_.resize(length, 0.0);
+    }
+
+public:
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+
+    /// Size() rounded up to LANES (entries readable by kernels)
+    size_t PaddedSize() const { return (size_ + LANES - 1) / LANES * LANES; }
+
+    /// Bytes held by the lanes
+    size_t GetMemoryBytes() const {
+        return id_.capacity() * sizeof(int) +
+               (x_.capacity() + y_.capacity() + vx_.capacity() + vy_.capacity() + radius_.capacity()) * sizeof(double);
+    }
+
+    void Clear() { size_ = 0; }
+
+    void Reserve(size_t count) {
+        while (x_.size() < count) Grow();
+    }
+
+    void Push(int id, double x, double y, double vx, double vy, double radius) {
+        if (size_ == x_.size()) Grow();
+        id_[size_] = id;
+        x_[size_] = x;
+        y_[size_] = y;
+        vx_[size_] = vx;
+        vy_[size_] = vy;
+        radius_[size_] = radius;
+        ++size_;
+    }
+
+    void Push(const ObstacleData& obstacle) {
+        Push(obstacle.id, obstacle.position.x, obstacle.position.y,
+             obstacle.velocity.x, obstacle.velocity.y, obstacle.radius);
+    }
+
+    /// Append entry k of another store
+    void PushFrom(const KinematicsStore& other, size_t k) {
+        Push(other.id_[k], other.x_[k], other.y_[k], other.vx_[k], other.vy_[k], other.radius_[k]);
+    }
+
+    /// Entry k as ObstacleData
+    ObstacleData Get(size_t k) const {
+        Backend::Common::Coordinates position{static_cast<int>(x_[k]), static_cast<int>(y_[k])};
+        return ObstacleData(id_[k], position, Vector2(vx_[k], vy_[k]), radius_[k]);
+    }
+
+    // --- Packed fields (PaddedSize() readable entries) ---
+    const int* Ids() const { return id_.data(); }
+    const double* X() const { return x_.data(); }
+    const double* Y() const { return y_.data(); }
+    const double* VX() const { return vx_.data(); }
+    const double* VY() const { return vy_.data(); }
+    const double* Radius() const { return radius_.data(); }
+};
+
+} // namespace Physics
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_PHYSICS_KINEMATICSSTORE_HH
@@ -2,8 +2,9 @@
  * @file ORCASolver.hh
  * @brief Optimal Reciprocal Collision Avoidance solver
  * 
- * Implements local collision avoidance using velocity obstacles.
- * For this iteration, implements basic repulsion/stop-and-wait logic.
+ * Implements local collision avoidance using velocity obstacles: either
+ * a basic repulsion/stop-and-wait heuristic, or full ORCA (one half-plane
+ * of permitted velocities per neighbor, solved as a 2-D linear program).
  */
 
 #ifndef LAYER3_PHYSICS_ORCASOLVER_HH
@@ -13,12 +14,22 @@
 #include <cmath>
 
 #include "Vector2.hh"
+#include "Resolution.hh"
 #include "Physics/ObstacleData.hh"
+#include "Physics/KinematicsStore.hh"
 
 namespace Backend {
 namespace Layer3 {
 namespace Physics {
 
+/**
+ * @brief How CalculateSafeVelocity avoids neighbors.
+ */
+enum class AvoidanceMethod {
+    HEURISTIC,      ///< Stop-and-wait, slowdown and repulsion
+    HALF_PLANES     ///< ORCA half-planes and linear programming
+};
+
 /**
  * @brief Configuration parameters for ORCA.
  */
@@ -29,6 +40,8 @@ struct ORCAConfig {
     double responsiveness;        ///< How quickly to respond to threats (0-1)
     double stopDistance;          ///< Distance at which to stop completely (pixels)
     double slowdownDistance;      ///< Distance at which to start slowing down (pixels)
+    AvoidanceMethod method;       ///< Heuristic or half-plane solver
+    double timeStep;              ///< Time to resolve an overlap in (seconds, HALF_PLANES)
     
     /**
      * @brief Default constructor with sensible defaults.
@@ -40,7 +53,31 @@ struct ORCAConfig {
         , responsiveness(0.5)      // 50% velocity correction per tick
         , stopDistance(10.0)       // 1m at DECIMETERS
         , slowdownDistance(30.0)   // 3m at DECIMETERS
+        , method(AvoidanceMethod::HEURISTIC)
+        , timeStep(0.05)           // One 50ms physics tick
     {}
+    
+    /**
+     * @brief The default configuration in pixels of res.
+     */
+    static ORCAConfig ForResolution(Backend::Common::Resolution res) {
+        const double scale = Backend::Common::GetPixelsPerMeter(res) /
+                             double(Backend::Common::GetPixelsPerMeter(Backend::Common::Resolution::DECIMETERS));
+        ORCAConfig config;
+        config.safetyMargin *= scale;
+        config.maxSpeed *= scale;
+        config.stopDistance *= scale;
+        config.slowdownDistance *= scale;
+        return config;
+    }
+};
+
+/**
+ * @brief Permitted velocities: the half-plane left of direction through point.
+ */
+struct HalfPlane {
+    Vector2 point;
+    Vector2 direction;             ///< Unit vector
 };
 
 /**
@@ -48,12 +85,29 @@ struct ORCAConfig {
  * 
  * This implementation uses a simplified approach:
  * 1. Basic Repulsion: Push velocity away from nearby obstacles
- * 2. Stop-and-Wait: Stop completely if collision is imminent
+ * 2. Stop-and-Wait: Stop completely if collision is imminent with the
+ *    closest neighbor ahead (one behind never holds a robot back)
  * 
  * The full ORCA algorithm constructs half-plane constraints from
  * velocity obstacles, but this simpler approach is sufficient
  * to prove the architecture.
  * 
+ * With AvoidanceMethod::HALF_PLANES the solver is proper ORCA (van den
+ * Berg et al., "Reciprocal n-body collision avoidance"): each neighbor
+ * contributes the half-plane of velocities that stay collision-free for
+ * timeHorizon, with half of the avoidance left to the neighbor (all of
+ * it when the neighbor is standing still), and the permitted velocity
+ * closest to the preferred one within maxSpeed is found by an incremental
+ * 2-D linear program. When the half-planes leave no velocity (dense
+ * crowds) a 3-D linear program picks the velocity violating them least.
+ * Robots therefore keep sliding past each other instead of stopping.
+ * 
+ * The heuristic's per-neighbor work (distances, repulsion, collision prediction) runs
+ * as SIMD passes over a KinematicsStore (SSE2, two neighbors per
+ * instruction, with a scalar fallback elsewhere); only the reductions over
+ * their results are sequential, in neighbor order. Passes use buffers of
+ * the solver, so one solver serves one thread at a time.
+ * 
  * Usage:
  *   ORCASolver solver;
  *   Vector2 safeVel = solver.CalculateSafeVelocity(myData, neighbors, preferredVel);
@@ -61,6 +115,19 @@ struct ORCAConfig {
 class ORCASolver {
 private:
     ORCAConfig config_;
+    
+    /// Per-neighbor results of the passes (padded like the store)
+    struct PassBuffers {
+        std::vector<double> distance;       ///< Center to center
+        std::vector<double> combinedRadius; ///< Radii plus safety margin
+        std::vector<double> repulsionX;     ///< Repulsion (0 outside influence range)
+        std::vector<double> repulsionY;
+        std::vector<unsigned char> collides;///< WillCollide at the current velocity
+        std::vector<HalfPlane> halfPlanes;  ///< One per neighbor (HALF_PLANES)
+        std::vector<HalfPlane> projected;   ///< 3-D linear program scratch
+        KinematicsStore packed;             ///< Neighbors given as ObstacleData
+    };
+    mutable PassBuffers buffers_;
 
 public:
     // =========================================================================
@@ -111,42 +178,101 @@ public:
         const std::vector<ObstacleData>& neighbors,
         const Vector2& preferredVelocity
     ) const;
+    
+    /**
+     * @brief Calculate a collision-free velocity from packed neighbors.
+     */
+    Vector2 CalculateSafeVelocity(
+        const ObstacleData& me,
+        const KinematicsStore& neighbors,
+        const Vector2& preferredVelocity
+    ) const;
 
 private:
     // =========================================================================
-    // COLLISION DETECTION
+    // HALF-PLANE SOLVER
     // =========================================================================
     
+    /// Determinants below this are treated as parallel lines
+    static constexpr double LP_EPSILON = 1e-5;
+    
     /**
-     * @brief Find the closest obstacle distance.
+     * @brief Full ORCA: half-planes of all neighbors, then linear programs.
      */
-    double FindClosestObstacleDistance(
+    Vector2 SolveHalfPlanes(
         const ObstacleData& me,
-        const std::vector<ObstacleData>& neighbors
+        const KinematicsStore& neighbors,
+        const Vector2& preferredVelocity
     ) const;
     
     /**
-     * @brief Check if a velocity will cause collision within time horizon.
+     * @brief Optimum on the boundary of half-plane line subject to the earlier ones.
+     * 
+     * @return False if they leave no point of that boundary within radius
+     */
+    static bool LinearProgram1(
+        const std::vector<HalfPlane>& lines,
+        size_t line,
+        double radius,
+        const Vector2& optimum,
+        bool directionOptimum,
+        Vector2& result
+    );
+    
+    /**
+     * @brief Velocity within radius and all half-planes closest to optimum
+     *        (or furthest along it, for a direction optimum).
+     * 
+     * @return Number of lines on success, else the first infeasible line
+     *         (result then satisfies the lines before it)
      */
-    bool WillCollide(
-        const ObstacleData& me,
-        const ObstacleData& neighbor,
-        const Vector2& velocity,
-        double timeHorizon
+    static size_t LinearProgram2(
+        const std::vector<HalfPlane>& lines,
+        double radius,
+        const Vector2& optimum,
+        bool directionOptimum,
+        Vector2& result
+    );
+    
+    /**
+     * @brief Velocity minimising the largest violation of lines from
+     *        beginLine on, when LinearProgram2 found them infeasible.
+     */
+    void LinearProgram3(
+        const std::vector<HalfPlane>& lines,
+        size_t beginLine,
+        double radius,
+        Vector2& result
     ) const;
-
+    
     // =========================================================================
-    // VELOCITY MODIFICATION
+    // SIMD PASSES
     // =========================================================================
     
     /**
-     * @brief Apply repulsion forces from all neighbors.
+     * @brief Distances and combined radii of all neighbors.
      */
-    Vector2 ApplyRepulsion(
+    void DistancePass(const ObstacleData& me, const KinematicsStore& neighbors) const;
+    
+    /**
+     * @brief Repulsion of every neighbor within its influence range.
+     */
+    void RepulsionPass(const ObstacleData& me, const KinematicsStore& neighbors) const;
+    
+    /**
+     * @brief Whether velocity collides within the time horizon with each
+     *        neighbor from begin on.
+     */
+    void CollisionPass(
         const ObstacleData& me,
-        const std::vector<ObstacleData>& neighbors,
-        const Vector2& velocity
+        const KinematicsStore& neighbors,
+        const Vector2& velocity,
+        size_t begin
     ) const;
+
+    // =========================================================================
+    // VELOCITY MODIFICATION
+    // =========================================================================
     
     /**
      * @brief Scale velocity based on closest obstacle.
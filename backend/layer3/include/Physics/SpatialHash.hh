@@ -0,0 +1,99 @@
+/**
+ * @file SpatialHash.hh
+ * @brief Uniform grid for radius neighbor queries between robots
+ *
+ * Comparing every robot with every other one each physics tick is O(N^2).
+ * The grid buckets robots by cell (cell size = query radius), so a query
+ * only looks at the 3 x 3 cells around a position. Cells are hashed into
+ * a table of about twice the item count, so the grid works for any map
+ * extent and is rebuilt in O(N) every tick without allocating once its
+ * tables have grown.
+ */
+
+#ifndef LAYER3_PHYSICS_SPATIALHASH_HH
+#define LAYER3_PHYSICS_SPATIALHASH_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Backend {
+namespace Layer3 {
+namespace Physics {
+
+/**
+ * @brief Hashed uniform grid of indexed points (e.g. robot positions).
+ *
+ * Items are indices 0..count-1 given to Reset. Each cell keeps a linked
+ * list of its items, so an item can be moved to its new position in O(1)
+ * after it has moved within a tick. Queries return items in index order.
+ */
+class SpatialHash {
+public:
+    static constexpr int32_t NONE = -1;
+
+    /**
+     * @param cellSize Side of a cell (pixels), normally the query radius
+     */
+    explicit SpatialHash(double cellSize = 100.0);
+
+    /**
+     * @brief Set the cell side (applies from the next Reset).
+     */
+    void SetCellSize(double cellSize);
+    double GetCellSize() const { return cellSize_; }
+
+    /**
+     * @brief Empty the grid and make room for count items.
+     */
+    void Reset(size_t count);
+
+    /**
+     * @brief Add item at (x, y); item must be < the count given to Reset.
+     */
+    void Insert(size_t item, double x, double y);
+
+    /**
+     * @brief Update the position of an inserted item.
+     */
+    void Move(size_t item, double x, double y);
+
+    /**
+     * @brief Items within radius of (x, y), in index order.
+     *
+     * @param out Cleared, then filled (kept by the caller to reuse its capacity)
+     */
+    void Query(double x, double y, double radius, std::vector<size_t>& out) const;
+
+    /// Bytes held by the buckets and per-item arrays
+    size_t GetMemoryBytes() const {
+        return (head_.capacity() + next_.capacity() + previous_.capacity()) * sizeof(int32_t) +
+               (cellX_.capacity() + cellY_.capacity()) * sizeof(int64_t) +
+               (x_.capacity() + y_.capacity()) * sizeof(double);
+    }
+
+private:
+    double cellSize_;
+    double inverseCellSize_;
+    size_t bucketMask_;
+
+    std::vector<int32_t> head_;         ///< Per bucket: first item (NONE = empty)
+    std::vector<int32_t> next_;         ///< Per item: next item in its bucket
+    std::vector<int32_t> previous_;     ///< Per item: previous item in its bucket
+    std::vector<int64_t> cellX_;        ///< Per item: cell column
+    std::vector<int64_t> cellY_;        ///< Per item: cell row
+    std::vector<double> x_;             ///< Per item: position
+    std::vector<double> y_;
+
+    int64_t CellOf(double coordinate) const;
+    size_t Bucket(int64_t cellX, int64_t cellY) const;
+
+    void Link(size_t item);
+    void Unlink(size_t item);
+};
+
+} // namespace Physics
+} // namespace Layer3
+} // namespace Backend
+
+#endif // LAYER3_PHYSICS_SPATIALHASH_HH
@@ -8,26 +8,42 @@
  * 3. Create RobotDriver(s)
  * 4. Set goal and run simulation
  * 5. Verify movement towards goal
+ * 
+ * Phase 2 also compares the grid searches (Theta*, JPS, JPS+) on the
+ * same node-to-node queries, phase 7 plans a group of robots
+ * cooperatively (MultiAgentPlanner) window after window, and phase 8
+ * repairs routes (DStarLite) while a forklift moves across them.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <chrono>
 #include <cmath>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
 
 // Layer 1 includes
 #include "StaticBitMap.hh"
 #include "InflatedBitMap.hh"
 #include "NavMesh.hh"
 #include "NavMeshGenerator.hh"
+#include "PackedGrid.hh"
 
 // Layer 3 includes
 #include "Vector2.hh"
 #include "Pathfinding/ThetaStarSolver.hh"
+#include "Pathfinding/DStarLite.hh"
+#include "Pathfinding/FlowField.hh"
+#include "Pathfinding/JumpPointSolver.hh"
+#include "Pathfinding/MultiAgentPlanner.hh"
 #include "Pathfinding/PathfindingService.hh"
 #include "Physics/ObstacleData.hh"
 #include "Physics/ORCASolver.hh"
 #include "Core/RobotDriver.hh"
+#include "Core/DeadlockResolver.hh"
 #include "Core/FastLoopManager.hh"
 
 // Common includes
@@ -46,6 +62,17 @@ const Resolution MAP_RESOLUTION = Resolution::DECIMETERS;
 const float ROBOT_RADIUS_METERS = 0.3f;
 const int SIMULATION_TICKS = 50;
 const float TICK_DURATION_MS = 50.0f;
+const int SEARCH_COMPARISON_QUERIES = 200;
+const int COOPERATIVE_ROBOTS = 12;
+const int COOPERATIVE_MAX_WINDOWS = 60;
+const int FORKLIFT_SIZE = 15;
+const int FORKLIFT_STEPS = 30;
+const int DETOUR_MAX_TICKS = 2000;
+const int FLOW_FIELD_QUERIES = 200;
+const int DEADLOCK_MAX_TICKS = 4000;
+const int DEADLOCK_LANE_PX = 80;
+const int ITINERARY_LEGS = 5;
+const int ITINERARY_MAX_TICKS = 20000;
 
 // =============================================================================
 // HELPER FUNCTIONS
@@ -116,10 +143,120 @@ int main() {
     
     PrintHeader("PHASE 2: Initializing Services");
     
-    auto& pathService = Pathfinding::PathfindingService::GetInstance();
+    Pathfinding::PathfindingService pathService;
     pathService.Initialize(inflatedMap);
     std::cout << "[INFO] PathfindingService initialized\n";
     
+    // Same queries for every search: pairs of NavMesh nodes
+    {
+        const auto& meshNodes = navMesh.GetAllNodes();
+        std::vector<std::pair<Coordinates, Coordinates>> queries;
+        for (int q = 0; q < SEARCH_COMPARISON_QUERIES && !meshNodes.empty(); ++q) {
+            size_t a = (static_cast<size_t>(q) * 7919) % meshNodes.size();
+            size_t b = (static_cast<size_t>(q) * 104729 + meshNodes.size() / 2) % meshNodes.size();
+            queries.push_back({meshNodes[a].coords, meshNodes[b].coords});
+        }
+        
+        Pathfinding::ThetaStarSolver basicTheta(Pathfinding::ThetaStarMode::BASIC);
+        Pathfinding::ThetaStarSolver lazyTheta(Pathfinding::ThetaStarMode::LAZY);
+        Pathfinding::JumpPointSolver jps(inflatedMap, Pathfinding::JumpPointMode::ONLINE);
+        Pathfinding::JumpPointSolver jpsPlus(inflatedMap, Pathfinding::JumpPointMode::PRECOMPUTED);
+        
+        std::vector<std::pair<std::string, std::function<Pathfinding::PathResult(const Coordinates&, const Coordinates&)>>> searches = {
+            {"Theta*", [&](const Coordinates& a, const Coordinates& b) { return basicTheta.ComputePath(a, b, inflatedMap); }},
+            {"Lazy Theta*", [&](const Coordinates& a, const Coordinates& b) { return lazyTheta.ComputePath(a, b, inflatedMap); }},
+            {"JPS", [&](const Coordinates& a, const Coordinates& b) { return jps.ComputePath(a, b); }},
+            {"JPS+", [&](const Coordinates& a, const Coordinates& b) { return jpsPlus.ComputePath(a, b); }},
+        };
+        
+        auto lengthOf = [](const Pathfinding::PathResult& result) {
+            double length = 0.0;
+            for (size_t k = 1; k < result.path.size(); ++k) {
+                length += std::hypot(result.path[k].x - result.path[k - 1].x,
+                                     result.path[k].y - result.path[k - 1].y);
+            }
+            return length;
+        };
+        
+        // Per search, per query: path length (< 0 = no path)
+        std::vector<std::vector<double>> lengths(searches.size());
+        int blockedSegments = 0;
+        
+        const auto savedFlags = std::cout.flags();
+        const auto savedPrecision = std::cout.precision();
+        std::cout << "\n[INFO] Grid search comparison (" << queries.size() << " queries):\n";
+        for (size_t s = 0; s < searches.size(); ++s) {
+            const auto& [name, search] = searches[s];
+            int found = 0;
+            long expanded = 0;
+            double timeMs = 0.0;
+            double length = 0.0;
+            for (const auto& [from, to] : queries) {
+                Pathfinding::PathResult result = search(from, to);
+                lengths[s].push_back(result.success ? lengthOf(result) : -1.0);
+                if (!result.success) continue;
+                found++;
+                expanded += result.nodesExpanded;
+                timeMs += result.computeTimeMs;
+                length += lengths[s].back();
+                for (size_t k = 1; k < result.path.size(); ++k) {
+                    if (!basicTheta.HasLineOfSight(result.path[k - 1].x, result.path[k - 1].y,
+                                                   result.path[k].x, result.path[k].y, inflatedMap)) {
+                        blockedSegments++;
+                    }
+                }
+            }
+            std::cout << "  " << std::left << std::setw(12) << name << std::right
+                      << " │ found " << std::setw(4) << found
+                      << " │ expanded " << std::setw(8) << expanded
+                      << " │ " << std::setw(8) << std::fixed << std::setprecision(2) << timeMs << " ms"
+                      << " │ length " << std::setw(9) << std::setprecision(0) << length << " px\n";
+        }
+        std::cout << "  (JPS+ lattice and jump tables: " << jpsPlus.GetMemoryBytes() / 1024 << " KiB)\n";
+        std::cout.flags(savedFlags);
+        std::cout.precision(savedPrecision);
+        
+        // All four must find the same queries. JPS and JPS+ search the same
+        // lattice, so their lengths match; any-angle paths are never
+        // longer than the lattice's and at most its octile detour shorter,
+        // give or take the joins of the exact ends to their lattice points
+        const double LATTICE_TOLERANCE_PX = 1.0;
+        const double OCTILE_RATIO = std::sqrt(4.0 - 2.0 * std::sqrt(2.0));  // Longest octile / straight line
+        const double SNAP_TOLERANCE_PX =
+            2.0 * std::sqrt(2.0) * Pathfinding::ThetaStarSolver::GridStep(inflatedMap.GetResolution());
+        int disagreements = 0;
+        double worstRatio = 1.0;
+        for (size_t q = 0; q < queries.size(); ++q) {
+            const double theta = lengths[0][q];
+            const double lazy = lengths[1][q];
+            const double lattice = lengths[2][q];
+            const double latticePlus = lengths[3][q];
+            bool sameFound = (theta < 0) == (lazy < 0) && (theta < 0) == (lattice < 0) &&
+                             (theta < 0) == (latticePlus < 0);
+            if (!sameFound) {
+                disagreements++;
+                continue;
+            }
+            if (theta < 0) continue;
+            bool agree = std::abs(lattice - latticePlus) <= LATTICE_TOLERANCE_PX;
+            for (double anyAngle : {theta, lazy}) {
+                agree = agree && anyAngle <= lattice + SNAP_TOLERANCE_PX &&
+                        anyAngle * OCTILE_RATIO >= lattice - SNAP_TOLERANCE_PX;
+                if (anyAngle > 0) worstRatio = std::max(worstRatio, lattice / anyAngle);
+            }
+            if (!agree) disagreements++;
+        }
+        std::cout << "[RESULT] " << disagreements << " queries disagree, " << blockedSegments
+                  << " path segments cross obstacles (lattice / any-angle up to " << std::setprecision(3)
+                  << worstRatio << ")\n";
+        std::cout.precision(savedPrecision);
+        if (queries.empty() || disagreements > 0 || blockedSegments > 0) {
+            std::cerr << "[ERROR] Grid searches disagree or leave the free space!\n";
+            return 1;
+        }
+        std::cout << "[SUCCESS] ✓ Every search finds the same paths, clear of obstacles\n";
+    }
+    
     // =========================================================================
     // PHASE 3: Create Robot and Set Goal
     // =========================================================================
@@ -165,7 +302,7 @@ int main() {
               << distance * GetConversionFactorToMeters(MAP_RESOLUTION) << " meters)\n";
     
     // Create robot driver
-    Core::RobotDriver driver(0, startPos, navMesh);
+    Core::RobotDriver driver(0, startPos, navMesh, pathService);
     
     // Configure driver
     Core::DriverConfig config;
@@ -265,8 +402,8 @@ int main() {
     Coordinates robot1End{50, mapHeight / 2 + 10};
     
     // Create robots first (don't store references as vector may reallocate)
-    manager.CreateRobot(0, robot0Start, navMesh);
-    manager.CreateRobot(1, robot1Start, navMesh);
+    manager.CreateRobot(0, robot0Start, navMesh, pathService);
+    manager.CreateRobot(1, robot1Start, navMesh, pathService);
     
     // Now set goals using index-based access
     manager.GetRobotByIndex(0).SetGoalPosition(robot0End);
@@ -320,16 +457,412 @@ int main() {
     std::cout << "\n[STATS] Total ticks: " << stats.tickCount << "\n";
     std::cout << "[STATS] Avg tick time: " << std::setprecision(3) << stats.avgTickTimeMs << " ms\n";
     std::cout << "[STATS] Max tick time: " << stats.maxTickTimeMs << " ms\n";
+    std::cout << "[STATS] Robots stepped by the last tick: " << stats.activeRobots << "/" << manager.GetRobotCount() << " (rest parked)\n";
     std::cout << "[STATS] Simulation time: " << manager.GetSimulationTime() << " seconds\n";
     
+    // =========================================================================
+    // PHASE 7: Cooperative Planning (MultiAgentPlanner)
+    // =========================================================================
+    
+    PrintHeader("PHASE 7: Cooperative Planning (" + std::to_string(COOPERATIVE_ROBOTS) + " robots)");
+    
+    // Robots spread over the node list cross the map towards each other's side
+    Pathfinding::MultiAgentConfig plannerConfig;
+    plannerConfig.clearance = 2.0 * ROBOT_RADIUS_METERS * 10.0;
+    Pathfinding::MultiAgentPlanner planner(navMesh, plannerConfig);
+    const int window = planner.GetConfig().windowTicks;
+    const int numNodes = static_cast<int>(nodes.size());
+    std::vector<Pathfinding::MultiAgentQuery> queries;
+    for (int r = 0; r < COOPERATIVE_ROBOTS; ++r) {
+        int start = r * (numNodes / COOPERATIVE_ROBOTS);
+        queries.push_back({r, start, numNodes - 1 - start});
+    }
+    
+    // Execute half of every window, as the fleet loop does, and check that
+    // no two robots ever hold the same node at the same tick
+    int windows = 0;
+    int arrived = 0;
+    int conflicts = 0;
+    uint64_t expanded = 0;
+    auto planStart = std::chrono::high_resolution_clock::now();
+    while (windows < COOPERATIVE_MAX_WINDOWS && arrived < COOPERATIVE_ROBOTS) {
+        auto plans = planner.Plan(queries);
+        windows++;
+        expanded += planner.GetLastExpansions();
+        
+        Pathfinding::ReservationTable held;
+        for (const auto& plan : plans) {
+            for (size_t i = 0; i + 1 < plan.nodes.size(); ++i) {
+                for (int tick = plan.ticks[i]; tick <= std::min(plan.ticks[i + 1], window); ++tick) {
+                    for (int node : {plan.nodes[i], plan.nodes[i + 1]}) {
+                        if (!held.IsFree(node, tick, plan.robotId)) conflicts++;
+                        held.Reserve(node, tick, plan.robotId);
+                    }
+                }
+            }
+        }
+        
+        arrived = 0;
+        for (size_t r = 0; r < queries.size(); ++r) {
+            const auto& plan = plans[r];
+            for (size_t i = 0; i < plan.nodes.size() && plan.ticks[i] <= window / 2; ++i) {
+                queries[r].startNodeId = plan.nodes[i];
+            }
+            if (queries[r].startNodeId == queries[r].goalNodeId) {
+                queries[r].goalNodeId = -1;
+            }
+            if (queries[r].goalNodeId < 0) arrived++;
+        }
+        std::rotate(queries.begin(), queries.begin() + 1, queries.end());
+    }
+    auto planEnd = std::chrono::high_resolution_clock::now();
+    double planMs = std::chrono::duration<double, std::milli>(planEnd - planStart).count();
+    
+    std::cout << "[RESULT] Arrived: " << arrived << "/" << COOPERATIVE_ROBOTS
+              << " after " << windows << " windows of " << window << " ticks\n";
+    std::cout << "[RESULT] Node conflicts between plans: " << conflicts << "\n";
+    std::cout << "[STATS] " << expanded << " space-time states, "
+              << std::setprecision(2) << planMs / windows << " ms per window\n";
+    if (conflicts == 0 && arrived == COOPERATIVE_ROBOTS) {
+        std::cout << "[SUCCESS] ✓ Robots reached their goals on conflict-free plans\n";
+    }
+    
+    // =========================================================================
+    // PHASE 8: Incremental Replanning (DStarLite)
+    // =========================================================================
+    
+    PrintHeader("PHASE 8: Incremental Replanning (forklift across the route)");
+    
+    // Goal: the NavMesh node farthest (in edges) from the start node that
+    // its graph connects to it
+    int detourGoal = static_cast<int>(startNodeIdx);
+    {
+        std::vector<int> hops(nodes.size(), -1);
+        std::vector<int> frontier{detourGoal};
+        hops[detourGoal] = 0;
+        for (size_t head = 0; head < frontier.size(); ++head) {
+            int u = frontier[head];
+            detourGoal = u;
+            for (const auto& edge : navMesh.GetNeighbors(u)) {
+                if (hops[edge.targetNodeId] < 0) {
+                    hops[edge.targetNodeId] = hops[u] + 1;
+                    frontier.push_back(edge.targetNodeId);
+                }
+            }
+        }
+    }
+    
+    // The forklift drives along the row of the route's middle node; every
+    // move reclassifies its old and new footprint, and the route is
+    // repaired. A fresh search on the same overlay checks the repair.
+    Pathfinding::DStarLite replanner(navMesh);
+    replanner.Plan(static_cast<int>(startNodeIdx), detourGoal);
+    std::vector<int> initialRoute = replanner.GetRoute();
+    const int forkliftY = initialRoute.empty() ? mapHeight / 2
+                                               : nodes[initialRoute[initialRoute.size() / 2]].coords.y;
+    PackedGrid overlay(mapWidth, mapHeight, true);
+    auto paintForklift = [&](int x, bool blocked) {
+        int top = forkliftY - FORKLIFT_SIZE / 2;
+        for (int y = std::max(0, top); y < std::min(mapHeight, top + FORKLIFT_SIZE); ++y) {
+            for (int cx = std::max(0, x); cx < std::min(mapWidth, x + FORKLIFT_SIZE); ++cx) {
+                overlay.Set(cx, y, !blocked);
+            }
+        }
+        return navMesh.UpdateBlockedRegion(x, top, FORKLIFT_SIZE, FORKLIFT_SIZE, overlay);
+    };
+    
+    uint64_t repairExpanded = 0;
+    uint64_t freshExpanded = 0;
+    int mismatches = 0;
+    int forkliftX = 0;
+    const int forkliftStep = std::max(1, (mapWidth - FORKLIFT_SIZE) / FORKLIFT_STEPS);
+    for (int step = 0; step < FORKLIFT_STEPS; ++step) {
+        std::vector<int> changed = paintForklift(forkliftX, false);
+        forkliftX += forkliftStep;
+        std::vector<int> blocked = paintForklift(forkliftX, true);
+        changed.insert(changed.end(), blocked.begin(), blocked.end());
+        
+        replanner.NotifyChanged(changed);
+        repairExpanded += replanner.GetLastExpansions();
+        
+        Pathfinding::DStarLite fresh(navMesh);
+        fresh.Plan(replanner.GetStart(), replanner.GetGoal());
+        freshExpanded += fresh.GetLastExpansions();
+        if (std::abs(fresh.GetCost() - replanner.GetCost()) > 1e-2f) mismatches++;
+    }
+    navMesh.ClearBlocked();
+    
+    std::cout << "[INFO] Route: node " << startNodeIdx << " to node " << detourGoal << ", "
+              << initialRoute.size() << " nodes\n";
+    std::cout << "[RESULT] " << FORKLIFT_STEPS << " forklift moves: repairs expanded "
+              << repairExpanded << " nodes, fresh searches " << freshExpanded << "\n";
+    std::cout << "[RESULT] Route cost mismatches against fresh searches: " << mismatches << "\n";
+    
+    // A driver whose path a parked forklift blocks detours (or waits until
+    // it leaves) and still arrives
+    Core::RobotDriver detourDriver(1, startPos, navMesh, pathService);
+    detourDriver.SetConfig(config);
+    detourDriver.SetGoal(detourGoal);
+    const auto& detourPath = detourDriver.GetPath();
+    Coordinates parked = detourPath.empty() ? startPos : detourPath[detourPath.size() / 2];
+    overlay = PackedGrid(mapWidth, mapHeight, true);
+    int parkedX = parked.x - FORKLIFT_SIZE / 2;
+    int parkedY = parked.y - FORKLIFT_SIZE / 2;
+    for (int y = std::max(0, parkedY); y < std::min(mapHeight, parkedY + FORKLIFT_SIZE); ++y) {
+        for (int x = std::max(0, parkedX); x < std::min(mapWidth, parkedX + FORKLIFT_SIZE); ++x) {
+            overlay.Set(x, y, false);
+        }
+    }
+    detourDriver.OnMapChanged(navMesh.UpdateBlockedRegion(parkedX, parkedY, FORKLIFT_SIZE, FORKLIFT_SIZE, overlay));
+    
+    int detourTicks = 0;
+    int ticksOnBlocked = 0;
+    bool waited = false;
+    while (detourTicks < DETOUR_MAX_TICKS && detourDriver.GetState() != Core::DriverState::ARRIVED) {
+        if (detourDriver.IsPathBlocked()) {
+            // No way around: the forklift leaves
+            waited = true;
+            navMesh.ClearBlocked();
+            std::vector<int> cleared;
+            for (int n = 0; n < numNodes; ++n) {
+                if (navMesh.GetNodeChangeVersion(n) == navMesh.GetChangeVersion()) cleared.push_back(n);
+            }
+            detourDriver.OnMapChanged(cleared);
+        }
+        detourDriver.UpdateLoop(TICK_DURATION_MS / 1000.0f, noNeighbors);
+        int at = navMesh.GetNodeIdAt(detourDriver.GetPosition());
+        if (at >= 0 && navMesh.IsNodeBlocked(at)) ticksOnBlocked++;
+        detourTicks++;
+    }
+    navMesh.ClearBlocked();
+    
+    bool detourArrived = detourDriver.GetState() == Core::DriverState::ARRIVED;
+    std::cout << "[RESULT] Blocked driver " << (detourArrived ? "arrived" : "did not arrive")
+              << " after " << detourTicks << " ticks" << (waited ? " (waited for the forklift)" : "")
+              << ", " << ticksOnBlocked << " ticks on blocked nodes\n";
+    if (mismatches == 0 && detourArrived && ticksOnBlocked == 0) {
+        std::cout << "[SUCCESS] ✓ Routes repaired incrementally around the forklift\n";
+    }
+    
+    // =========================================================================
+    // PHASE 9: Flow Field (many robots, one dropoff)
+    // =========================================================================
+    
+    PrintHeader("PHASE 9: Flow Field (" + std::to_string(FLOW_FIELD_QUERIES) + " robots to one goal)");
+    
+    {
+        const auto& meshNodes = navMesh.GetAllNodes();
+        Coordinates goal = meshNodes[meshNodes.size() / 2].coords;
+        
+        auto buildStart = std::chrono::high_resolution_clock::now();
+        Pathfinding::FlowField field(inflatedMap, goal);
+        double buildMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - buildStart).count();
+        Pathfinding::JumpPointSolver lattice(inflatedMap, Pathfinding::JumpPointMode::ONLINE);
+        
+        // Same lattice and moves as JPS: every start must agree on
+        // reachability and distance
+        Pathfinding::ThetaStarSolver anyAngle(Pathfinding::ThetaStarMode::BASIC);
+        auto lengthOf = [](const Pathfinding::PathResult& result) {
+            double length = 0.0;
+            for (size_t k = 1; k < result.path.size(); ++k) {
+                length += std::hypot(result.path[k].x - result.path[k - 1].x,
+                                     result.path[k].y - result.path[k - 1].y);
+            }
+            return length;
+        };
+        int agreed = 0;
+        int found = 0;
+        Coordinates fieldStart = goal;
+        double fieldMs = 0.0;
+        double searchMs = 0.0;
+        double fieldLength = 0.0;
+        double thetaLength = 0.0;
+        for (int q = 0; q < FLOW_FIELD_QUERIES; ++q) {
+            Coordinates from = meshNodes[(static_cast<size_t>(q) * 7919) % meshNodes.size()].coords;
+            Pathfinding::PathResult viaField = field.ComputePath(from, goal);
+            Pathfinding::PathResult viaSearch = lattice.ComputePath(from, goal);
+            fieldMs += viaField.computeTimeMs;
+            searchMs += viaSearch.computeTimeMs;
+            if (viaField.success) {
+                if (found++ == 0) fieldStart = from;
+                Pathfinding::PathResult viaTheta = anyAngle.ComputePath(from, goal, inflatedMap);
+                if (viaTheta.success) {
+                    fieldLength += lengthOf(viaField);
+                    thetaLength += lengthOf(viaTheta);
+                }
+            }
+            if (viaField.success == viaSearch.success &&
+                (!viaField.success || std::abs(viaField.pathLength - viaSearch.pathLength) < 1.0)) {
+                agreed++;
+            }
+        }
+        
+        std::cout << "[INFO] Field built in " << std::fixed << std::setprecision(2) << buildMs << " ms ("
+                  << field.GetMemoryBytes() / 1024 << " KiB)\n";
+        std::cout << "[RESULT] " << found << " reachable, " << agreed << "/" << FLOW_FIELD_QUERIES
+                  << " agree with JPS │ field " << fieldMs << " ms vs search " << searchMs << " ms\n";
+        std::cout << "[RESULT] Smoothed length " << std::setprecision(0) << fieldLength
+                  << " px (Theta* " << thetaLength << " px)\n";
+        if (agreed == FLOW_FIELD_QUERIES) {
+            std::cout << "[SUCCESS] ✓ Flow field paths match the searched ones\n";
+        }
+        
+        // The fleet re-ranks its busiest goals as traffic shifts: a goal
+        // that stays keeps its field, one dropped is searched again, and
+        // a field is rebuilt once the overlay version moves on
+        Coordinates other = meshNodes[meshNodes.size() / 4].coords;
+        uint64_t overlayVersion = 0;
+        Pathfinding::PathfindingService fieldService;
+        fieldService.Initialize(inflatedMap);
+        fieldService.SetMapVersionSource([&overlayVersion] { return overlayVersion; });
+        fieldService.SetFlowFieldGoals({goal, other});
+        fieldService.SetFlowFieldGoals({goal});
+        fieldService.ComputePathImmediate(fieldStart, goal);
+        fieldService.ComputePathImmediate(fieldStart, other);
+        overlayVersion++;
+        bool rebuilt = fieldService.ComputePathImmediate(fieldStart, goal).success;
+        std::cout << "[RESULT] Re-ranked goals: " << fieldService.GetFlowFieldCount() << " field kept, "
+                  << fieldService.GetFlowFieldPaths() << "/3 paths read off it\n";
+        if (found > 0 && fieldService.GetFlowFieldCount() == 1 && fieldService.GetFlowFieldPaths() == 2 && rebuilt) {
+            std::cout << "[SUCCESS] ✓ Only the goals still listed keep flow fields\n";
+        }
+    }
+    
+    // =========================================================================
+    // PHASE 10: Deadlock Resolution (head-on on one line)
+    // =========================================================================
+    
+    PrintHeader("PHASE 10: Deadlock Resolution (head-on on one line)");
+    
+    {
+        // Two nodes that see each other along a row: both paths are the
+        // same straight line
+        Coordinates west{50, mapHeight / 2};
+        Coordinates east{mapWidth - 50, mapHeight / 2};
+        Pathfinding::ThetaStarSolver sight;
+        for (const auto& node : navMesh.GetAllNodes()) {
+            Coordinates across{node.coords.x + DEADLOCK_LANE_PX, node.coords.y};
+            int other = navMesh.GetNodeIdAt(across);
+            if (other >= 0 && navMesh.GetAllNodes()[other].coords.y == node.coords.y &&
+                sight.HasLineOfSight(node.coords.x, node.coords.y, across.x, across.y, inflatedMap)) {
+                west = node.coords;
+                east = navMesh.GetAllNodes()[other].coords;
+                break;
+            }
+        }
+        std::cout << "[INFO] Lane (" << west.x << "," << west.y << ") ↔ (" << east.x << "," << east.y << ")\n";
+        
+        // Stop-and-wait halts both robots nose to nose: without the
+        // resolver they wait forever
+        for (bool resolve : {false, true}) {
+            std::vector<Core::RobotDriver> pair;
+            pair.emplace_back(0, west, navMesh, pathService);
+            pair.emplace_back(1, east, navMesh, pathService);
+            pair[0].SetGoalPosition(east);
+            pair[1].SetGoalPosition(west);
+            pair[1].SetLoadCount(1);
+            
+            Core::DeadlockResolver resolver(navMesh);
+            std::vector<Core::RobotDriver*> robots{&pair[0], &pair[1]};
+            int ticks = 0;
+            auto arrived = [&pair]() {
+                return pair[0].GetState() == Core::DriverState::ARRIVED &&
+                       pair[1].GetState() == Core::DriverState::ARRIVED;
+            };
+            while (ticks < DEADLOCK_MAX_TICKS && !arrived()) {
+                std::vector<Physics::ObstacleData> of0{pair[1].GetObstacleData()};
+                std::vector<Physics::ObstacleData> of1{pair[0].GetObstacleData()};
+                pair[0].ComputeVelocity(TICK_DURATION_MS / 1000.0f, of0);
+                pair[1].ComputeVelocity(TICK_DURATION_MS / 1000.0f, of1);
+                pair[0].Integrate(TICK_DURATION_MS / 1000.0f);
+                pair[1].Integrate(TICK_DURATION_MS / 1000.0f);
+                if (resolve) {
+                    resolver.Update(robots, TICK_DURATION_MS / 1000.0f);
+                }
+                ticks++;
+            }
+            
+            const auto& deadlocks = resolver.GetStats();
+            std::cout << "[RESULT] " << (resolve ? "With" : "Without") << " resolver: "
+                      << (arrived() ? "both arrived" : "still waiting") << " after " << ticks << " ticks";
+            if (resolve) {
+                std::cout << " (" << deadlocks.cycles << " cycles, " << deadlocks.reroutes << " rerouted, "
+                          << deadlocks.backOffs << " backed off, " << std::setprecision(1)
+                          << deadlocks.blockedSeconds << " robot-s waiting)";
+            }
+            std::cout << "\n";
+            if (resolve && arrived()) {
+                std::cout << "[SUCCESS] ✓ Head-on deadlock resolved\n";
+            }
+        }
+    }
+    
+    // =========================================================================
+    // PHASE 11: Itinerary Prefetch (legs planned while driving)
+    // =========================================================================
+    
+    PrintHeader("PHASE 11: Itinerary Prefetch (" + std::to_string(ITINERARY_LEGS) + " legs)");
+    
+    {
+        // Workers plan in real time: each tick also lasts a millisecond, so
+        // ticks in COMPUTING_PATH measure the planning latency
+        Pathfinding::PathfindingService workerService;
+        workerService.Initialize(inflatedMap);
+        workerService.StartWorkers(1);
+        
+        const auto& meshNodes = navMesh.GetAllNodes();
+        std::vector<int> itinerary;
+        for (int leg = 0; leg < ITINERARY_LEGS; ++leg) {
+            itinerary.push_back(static_cast<int>((static_cast<size_t>(leg) * 104729 + 17) % meshNodes.size()));
+        }
+        Coordinates start = meshNodes[(meshNodes.size() / 3)].coords;
+        
+        for (bool prefetch : {false, true}) {
+            Core::RobotDriver robot(0, start, navMesh, workerService);
+            const std::vector<Physics::ObstacleData> noNeighbors;
+            size_t next = 0;
+            int ticks = 0;
+            int waiting = 0;
+            int reached = 0;
+            auto dispatch = [&]() {
+                robot.SetGoal(itinerary[next++]);
+                if (prefetch && next < itinerary.size()) {
+                    robot.PrefetchItinerary(std::vector<int>(itinerary.begin() + next, itinerary.end()));
+                }
+            };
+            dispatch();
+            while (ticks < ITINERARY_MAX_TICKS) {
+                auto state = robot.GetState();
+                if (state == Core::DriverState::ARRIVED || state == Core::DriverState::STUCK) {
+                    reached += state == Core::DriverState::ARRIVED ? 1 : 0;
+                    if (next == itinerary.size()) break;
+                    dispatch();
+                }
+                if (robot.GetState() == Core::DriverState::COMPUTING_PATH) {
+                    waiting++;
+                }
+                robot.UpdateLoop(TICK_DURATION_MS / 1000.0f, noNeighbors);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                ticks++;
+            }
+            
+            std::cout << "[RESULT] " << (prefetch ? "With" : "Without") << " prefetch: " << reached << "/"
+                      << itinerary.size() << " goals in " << ticks << " ticks, " << waiting
+                      << " ticks waiting for a path (" << robot.GetPrefetchedPaths() << " prefetched)\n";
+            if (prefetch && robot.GetPrefetchedPaths() + 1 == itinerary.size()) {
+                std::cout << "[SUCCESS] ✓ Every leg after the first was ready on arrival\n";
+            }
+        }
+        workerService.StopWorkers();
+    }
+    
     // =========================================================================
     // CLEANUP
     // =========================================================================
     
     PrintHeader("TEST COMPLETE");
     
-    Pathfinding::PathfindingService::DestroyInstance();
-    
     std::cout << "[INFO] Layer 3 integration test completed successfully!\n\n";
     
     return 0;
@@ -0,0 +1,405 @@
+/**
+ * @file DeadlockResolver.cc
+ * @brief Implementation of the deadlock resolver
+ */
+
+#include "Core/DeadlockResolver.hh"
+#include "Trace.hh"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace Backend {
+namespace Layer3 {
+namespace Core {
+
+namespace {
+
+double DistanceToSegment(double px, double py, double ax, double ay, double bx, double by) {
+    double dx = bx - ax;
+    double dy = by - ay;
+    double lengthSq = dx * dx + dy * dy;
+    double t = lengthSq > 0.0 ? std::clamp(((px - ax) * dx + (py - ay) * dy) / lengthSq, 0.0, 1.0) : 0.0;
+    return std::hypot(px - (ax + t * dx), py - (ay + t * dy));
+}
+
+double DistanceBetween(const RobotDriver& a, const RobotDriver& b) {
+    return std::hypot(static_cast<double>(a.GetPosition().x - b.GetPosition().x),
+                      static_cast<double>(a.GetPosition().y - b.GetPosition().y));
+}
+
+} // namespace
+
+DeadlockResolver::DeadlockResolver(const Backend::Layer1::NavMesh& navMesh, const DeadlockConfig& config)
+    : navMesh_(&navMesh)
+    , config_(config)
+    , maxRadius_(0.0)
+    , currentStamp_(0) {}
+
+// =============================================================================
+// WAIT-FOR GRAPH
+// =============================================================================
+
+int DeadlockResolver::FindBlocker(const std::vector<RobotDriver*>& robots, const Physics::SpatialHash& grid,
+                                  size_t i) {
+    const RobotDriver& robot = *robots[i];
+    auto state = robot.GetState();
+    if ((state != DriverState::MOVING && state != DriverState::COLLISION_WAIT) || robot.IsPathBlocked()) {
+        return -1;
+    }
+    const auto& path = robot.GetPath();
+    if (robot.GetPathIndex() >= path.size()) {
+        return -1;
+    }
+
+    // Ahead as ORCA sees it: towards the next waypoint
+    const auto& position = robot.GetPosition();
+    const auto& next = path[robot.GetPathIndex()];
+    double headingX = next.x - position.x;
+    double headingY = next.y - position.y;
+
+    // Only robots whose edge may lie within contactGap of this one's
+    grid.Query(position.x, position.y, robot.GetRadius() + maxRadius_ + config_.contactGap, nearby_);
+
+    int blocker = -1;
+    double closestGap = config_.contactGap;
+    for (size_t j : nearby_) {
+        if (j == i || j >= robots.size() || !robots[j]) continue;
+        const auto& other = robots[j]->GetPosition();
+        double dx = other.x - position.x;
+        double dy = other.y - position.y;
+        if (dx * headingX + dy * headingY <= 0.0) continue;
+        double gap = std::hypot(dx, dy) - robot.GetRadius() - robots[j]->GetRadius();
+        if (gap <= closestGap) {
+            closestGap = gap;
+            blocker = static_cast<int>(j);
+        }
+    }
+    return blocker;
+}
+
+void DeadlockResolver::Update(const std::vector<RobotDriver*>& robots, float dt) {
+    double maxRadius = 0.0;
+    for (const RobotDriver* robot : robots) {
+        if (robot) maxRadius = std::max(maxRadius, robot->GetRadius());
+    }
+    grid_.SetCellSize(std::max(2.0 * maxRadius + config_.contactGap, 1.0));
+    grid_.Reset(robots.size());
+    for (size_t i = 0; i < robots.size(); ++i) {
+        if (robots[i]) grid_.Insert(i, robots[i]->GetPosition().x, robots[i]->GetPosition().y);
+    }
+    Update(robots, grid_, dt);
+}
+
+void DeadlockResolver::Update(const std::vector<RobotDriver*>& robots, const Physics::SpatialHash& grid, float dt) {
+    TRACE_ZONE("DeadlockUpdate", "layer3");
+    const size_t count = robots.size();
+    waitsFor_.assign(count, -1);
+    handled_.assign(count, 0);
+    maxRadius_ = 0.0;
+    for (const RobotDriver* robot : robots) {
+        if (robot) maxRadius_ = std::max(maxRadius_, robot->GetRadius());
+    }
+
+    int waiting = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!robots[i]) continue;
+        const RobotDriver& robot = *robots[i];
+        int blocker = robot.IsParked() ? -1 : FindBlocker(robots, grid, i);
+        if (blocker < 0) {
+            waits_.erase(robot.GetRobotId());
+            continue;
+        }
+        Wait& wait = waits_.try_emplace(robot.GetRobotId(), Wait{robot.GetPosition(), 0.0}).first->second;
+        if (std::hypot(robot.GetPosition().x - wait.from.x, robot.GetPosition().y - wait.from.y) > config_.progressPixels) {
+            wait = Wait{robot.GetPosition(), 0.0};
+        }
+        if (robot.GetSpeed() < config_.stallSpeed) {
+            wait.seconds += dt;
+            stats_.blockedSeconds += dt;
+            stats_.longestWaitSeconds = std::max(stats_.longestWaitSeconds, wait.seconds);
+        }
+        if (wait.seconds > 0.0) {
+            waitsFor_[i] = blocker;
+            waiting++;
+        }
+    }
+    stats_.waitingRobots = waiting;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (waitsFor_[i] < 0 || handled_[i] || waits_[robots[i]->GetRobotId()].seconds < config_.waitSeconds) {
+            continue;
+        }
+
+        // Follow the edges until they return (a cycle), end at a robot
+        // waiting for nobody, or reach one already dealt with this tick
+        std::vector<int> chain;
+        std::vector<int> chainIndex(count, -1);
+        int at = static_cast<int>(i);
+        while (at >= 0 && chainIndex[at] < 0 && !handled_[at]) {
+            chainIndex[at] = static_cast<int>(chain.size());
+            chain.push_back(at);
+            at = waitsFor_[at];
+        }
+        for (int k : chain) {
+            handled_[k] = 1;
+            waits_.erase(robots[k]->GetRobotId());
+        }
+
+        if (at >= 0 && chainIndex[at] >= 0) {
+            stats_.cycles++;
+            ResolveCycle(robots, std::vector<int>(chain.begin() + chainIndex[at], chain.end()));
+        } else if (at < 0 && robots[chain.back()]->IsParked()) {
+            stats_.longBlocks++;
+            ResolveBlock(robots, chain[chain.size() - 2], chain.back());
+        }
+    }
+}
+
+bool DeadlockResolver::Yields(const RobotDriver& a, const RobotDriver& b) const {
+    // Loaded robots keep going; then the one closer to its goal
+    if (a.HasPackage() != b.HasPackage()) {
+        return !a.HasPackage();
+    }
+    double remainingA = a.GetRemainingPathLength();
+    double remainingB = b.GetRemainingPathLength();
+    if (remainingA != remainingB) {
+        return remainingA > remainingB;
+    }
+    return a.GetRobotId() > b.GetRobotId();
+}
+
+// =============================================================================
+// RESOLUTION
+// =============================================================================
+
+void DeadlockResolver::ResolveCycle(const std::vector<RobotDriver*>& robots, const std::vector<int>& cycle) {
+    std::vector<int> order = cycle;
+    std::sort(order.begin(), order.end(), [&robots, this](int a, int b) {
+        return Yields(*robots[a], *robots[b]);
+    });
+
+    std::cout << "[Deadlock] Robots";
+    for (int k : cycle) std::cout << " " << robots[k]->GetRobotId();
+    std::cout << " wait for each other: ";
+    for (int k : order) {
+        RobotDriver& robot = *robots[k];
+        const RobotDriver& other = *robots[waitsFor_[k]];
+        if (TryReroute(robot, other)) {
+            stats_.reroutes++;
+            std::cout << "robot " << robot.GetRobotId() << " reroutes\n";
+            return;
+        }
+        if (TryBackOff(robot, other)) {
+            stats_.backOffs++;
+            std::cout << "robot " << robot.GetRobotId() << " backs off\n";
+            return;
+        }
+    }
+    stats_.unresolved++;
+    std::cout << "no robot can make way\n";
+}
+
+void DeadlockResolver::ResolveBlock(const std::vector<RobotDriver*>& robots, int waiting, int parked) {
+    RobotDriver& robot = *robots[waiting];
+    RobotDriver& blocker = *robots[parked];
+    std::cout << "[Deadlock] Robot " << robot.GetRobotId() << " held up by parked robot "
+              << blocker.GetRobotId() << ": ";
+    if (TryReroute(robot, blocker)) {
+        stats_.reroutes++;
+        std::cout << "rerouting\n";
+        return;
+    }
+    if (TryBackOff(blocker, robot)) {
+        stats_.yields++;
+        std::cout << "robot " << blocker.GetRobotId() << " yields\n";
+        return;
+    }
+    stats_.unresolved++;
+    std::cout << "no way around\n";
+}
+
+bool DeadlockResolver::TryReroute(RobotDriver& robot, const RobotDriver& other) {
+    // A robot backing off already gave way; its goal comes later
+    const auto& path = robot.GetPath();
+    if (robot.IsBackingOff() || path.empty()) {
+        return false;
+    }
+    int start = navMesh_->GetNodeIdAt(robot.GetPosition());
+    int goal = navMesh_->GetNodeIdAt(path.back());
+    if (start < 0 || goal < 0) {
+        return false;
+    }
+
+    // The last detour around other to this goal ended here again
+    auto detour = detours_.find(robot.GetRobotId());
+    if (detour != detours_.end() && detour->second.around == other.GetRobotId() && detour->second.goal == goal) {
+        return false;
+    }
+
+    std::vector<char> avoid = NodesInTheWay(robot, other);
+    if (avoid[goal]) {
+        return false;
+    }
+    std::vector<int> route = FindRoute(start, goal, avoid);
+    if (route.empty() || !robot.Reroute(route)) {
+        return false;
+    }
+    detours_[robot.GetRobotId()] = Detour{other.GetRobotId(), goal};
+    return true;
+}
+
+bool DeadlockResolver::TryBackOff(RobotDriver& robot, const RobotDriver& other) {
+    int start = navMesh_->GetNodeIdAt(robot.GetPosition());
+    if (start < 0) {
+        return false;
+    }
+    // Still on the way into the pocket it took from other
+    auto backOff = backOffs_.find(robot.GetRobotId());
+    if (robot.IsBackingOff() && backOff != backOffs_.end() && backOff->second == other.GetRobotId()) {
+        return false;
+    }
+
+    double clearance = robot.GetRadius() + other.GetRadius() + config_.contactGap;
+    std::vector<int> pocket = FindPocket(start, NodesInTheWay(robot, other), NodesWithin(other, clearance, true));
+    if (pocket.empty() || !robot.BackOff(pocket, config_.holdSeconds)) {
+        return false;
+    }
+    backOffs_[robot.GetRobotId()] = other.GetRobotId();
+    return true;
+}
+
+// =============================================================================
+// NODE SEARCHES
+// =============================================================================
+
+std::vector<char> DeadlockResolver::NodesWithin(const RobotDriver& other, double clearance, bool alongPath) const {
+    // other's position, then the waypoints it still has to pass
+    std::vector<Backend::Common::Coordinates> points{other.GetPosition()};
+    if (alongPath) {
+        const auto& path = other.GetPath();
+        for (size_t k = other.GetPathIndex(); k < path.size(); ++k) {
+            points.push_back(path[k]);
+        }
+    }
+
+    const auto& nodes = navMesh_->GetAllNodes();
+    std::vector<char> within(nodes.size(), 0);
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        double x = nodes[n].coords.x;
+        double y = nodes[n].coords.y;
+        for (size_t k = 0; k < points.size() && !within[n]; ++k) {
+            const auto& from = points[k];
+            const auto& to = points[std::min(k + 1, points.size() - 1)];
+            within[n] = DistanceToSegment(x, y, from.x, from.y, to.x, to.y) < clearance;
+        }
+    }
+    return within;
+}
+
+std::vector<char> DeadlockResolver::NodesInTheWay(const RobotDriver& robot, const RobotDriver& other) const {
+    double contact = robot.GetRadius() + other.GetRadius() + config_.contactGap;
+    return NodesWithin(other, std::min(contact, DistanceBetween(robot, other) - 1.0), false);
+}
+
+std::vector<int> DeadlockResolver::FindRoute(int start, int goal, const std::vector<char>& avoid) {
+    const auto& nodes = navMesh_->GetAllNodes();
+    auto heuristic = [&nodes, goal](int node) {
+        return static_cast<float>(std::hypot(nodes[node].coords.x - nodes[goal].coords.x,
+                                             nodes[node].coords.y - nodes[goal].coords.y));
+    };
+
+    if (stamp_.size() != nodes.size()) {
+        stamp_.assign(nodes.size(), 0);
+        parent_.assign(nodes.size(), -1);
+        cost_.assign(nodes.size(), 0.0f);
+    }
+    currentStamp_++;
+
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    stamp_[start] = currentStamp_;
+    cost_[start] = 0.0f;
+    parent_[start] = start;
+    open.push({heuristic(start), start});
+
+    int expanded = 0;
+    while (!open.empty() && expanded < config_.maxSearchNodes) {
+        auto [priority, node] = open.top();
+        open.pop();
+        if (priority > cost_[node] + heuristic(node)) continue;
+        if (node == goal) {
+            std::vector<int> route;
+            for (int at = goal; at != start; at = parent_[at]) route.push_back(at);
+            route.push_back(start);
+            std::reverse(route.begin(), route.end());
+            return route;
+        }
+        expanded++;
+        for (const auto& edge : navMesh_->GetNeighbors(node)) {
+            int next = edge.targetNodeId;
+            if (avoid[next] || navMesh_->IsNodeBlocked(next)) continue;
+            float through = cost_[node] + edge.cost;
+            if (stamp_[next] != currentStamp_ || through < cost_[next]) {
+                stamp_[next] = currentStamp_;
+                cost_[next] = through;
+                parent_[next] = node;
+                open.push({through + heuristic(next), next});
+            }
+        }
+    }
+    return {};
+}
+
+std::vector<int> DeadlockResolver::FindPocket(int start, const std::vector<char>& avoid, const std::vector<char>& clear) {
+    // FindRoute without a goal: the first node settled outside clear
+    const auto& nodes = navMesh_->GetAllNodes();
+    if (stamp_.size() != nodes.size()) {
+        stamp_.assign(nodes.size(), 0);
+        parent_.assign(nodes.size(), -1);
+        cost_.assign(nodes.size(), 0.0f);
+    }
+    currentStamp_++;
+
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    stamp_[start] = currentStamp_;
+    cost_[start] = 0.0f;
+    parent_[start] = start;
+    open.push({0.0f, start});
+
+    int expanded = 0;
+    while (!open.empty() && expanded < config_.maxSearchNodes) {
+        auto [distance, node] = open.top();
+        open.pop();
+        if (distance > cost_[node]) continue;
+        if (!clear[node]) {
+            std::vector<int> route;
+            for (int at = node; at != start; at = parent_[at]) route.push_back(at);
+            route.push_back(start);
+            std::reverse(route.begin(), route.end());
+            return route;
+        }
+        expanded++;
+        for (const auto& edge : navMesh_->GetNeighbors(node)) {
+            int next = edge.targetNodeId;
+            if (avoid[next] || navMesh_->IsNodeBlocked(next)) continue;
+            float through = distance + edge.cost;
+            if (stamp_[next] != currentStamp_ || through < cost_[next]) {
+                stamp_[next] = currentStamp_;
+                cost_[next] = through;
+                parent_[next] = node;
+                open.push({through, next});
+            }
+        }
+    }
+    return {};
+}
+
+} // namespace Core
+} // namespace Layer3
+} // namespace Backend
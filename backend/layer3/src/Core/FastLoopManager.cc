@@ -19,12 +19,14 @@ namespace Core {
 FastLoopManager::FastLoopManager()
     : tickDuration_(0.05f)        // 50ms default
     , neighborRadius_(100.0)      // 10m at DECIMETERS
+    , threadCount_(0)
     , isRunning_(false)
     , simulationTime_(0.0) {}
 
 FastLoopManager::FastLoopManager(float tickDurationMs)
     : tickDuration_(tickDurationMs / 1000.0f)
     , neighborRadius_(100.0)
+    , threadCount_(0)
     , isRunning_(false)
     , simulationTime_(0.0) {}
 
@@ -45,9 +47,10 @@ int FastLoopManager::AddRobot(RobotDriver&& robot) {
 RobotDriver& FastLoopManager::CreateRobot(
     int id,
     const Backend::Common::Coordinates& position,
-    const Backend::Layer1::NavMesh& navMesh
+    const Backend::Layer1::NavMesh& navMesh,
+    Pathfinding::PathfindingService& pathService
 ) {
-    robots_.emplace_back(id, position, navMesh);
+    robots_.emplace_back(id, position, navMesh, pathService);
     return robots_.back();
 }
 
@@ -79,6 +82,12 @@ void FastLoopManager::ClearRobots() {
     robots_.clear();
 }
 
+void FastLoopManager::NotifyMapChanged(const std::vector<int>& changedNodeIds) {
+    for (auto& robot : robots_) {
+        robot.OnMapChanged(changedNodeIds);
+    }
+}
+
 // =============================================================================
 // SIMULATION CONTROL
 // =============================================================================
@@ -115,6 +124,13 @@ void FastLoopManager::SetTickDuration(float durationMs) {
     tickDuration_ = durationMs / 1000.0f;
 }
 
+void FastLoopManager::SetThreadCount(size_t threads) {
+    if (threads != threadCount_) {
+        threadCount_ = threads;
+        workers_.reset();
+    }
+}
+
 // =============================================================================
 // STATISTICS
 // =============================================================================
@@ -151,44 +167,64 @@ void FastLoopManager::PrintRobotStates() const {
 // INTERNAL METHODS
 // =============================================================================
 
-std::vector<Physics::ObstacleData> FastLoopManager::GatherNeighbors(size_t robotIndex) const {
-    std::vector<Physics::ObstacleData> neighbors;
+void FastLoopManager::GatherNeighbors(size_t robotIndex, ShardScratch& scratch) const {
+    scratch.neighbors.Clear();
     
-    if (robotIndex >= robots_.size()) {
-        return neighbors;
+    if (robotIndex >= snapshot_.Size()) {
+        return;
     }
     
-    const auto& me = robots_[robotIndex];
-    const auto& myPos = me.GetPosition();
+    neighborGrid_.Query(snapshot_.X()[robotIndex], snapshot_.Y()[robotIndex], neighborRadius_, scratch.indices);
     
-    for (size_t i = 0; i < robots_.size(); ++i) {
-        if (i == robotIndex) continue;
-        
-        const auto& other = robots_[i];
-        const auto& otherPos = other.GetPosition();
-        
-        // Calculate distance
-        double dx = otherPos.x - myPos.x;
-        double dy = otherPos.y - myPos.y;
-        double dist = std::sqrt(dx * dx + dy * dy);
-        
-        // Only include neighbors within radius
-        if (dist <= neighborRadius_) {
-            neighbors.push_back(other.GetObstacleData());
+    for (size_t i : scratch.indices) {
+        if (i != robotIndex) {
+            scratch.neighbors.PushFrom(snapshot_, i);
         }
     }
-    
-    return neighbors;
 }
 
 void FastLoopManager::ExecuteTick() {
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    // Update all robots
+    // Snapshot tick-start positions and bucket them: O(N) per tick instead
+    // of comparing all pairs. Parked robots stay in the grid as obstacles
+    // but are not stepped, so the work scales with the robots in motion
+    snapshot_.Clear();
+    neighborGrid_.SetCellSize(std::max(neighborRadius_, 1.0));
+    neighborGrid_.Reset(robots_.size());
+    activeRobots_.clear();
     for (size_t i = 0; i < robots_.size(); ++i) {
-        auto neighbors = GatherNeighbors(i);
-        robots_[i].UpdateLoop(tickDuration_, neighbors);
+        snapshot_.Push(robots_[i].GetObstacleData());
+        neighborGrid_.Insert(i, snapshot_.X()[i], snapshot_.Y()[i]);
+        if (!robots_[i].IsParked()) {
+            activeRobots_.push_back(i);
+        }
+    }
+    const size_t count = activeRobots_.size();
+    
+    // Phase 1: velocities from the snapshot only, sharded over the workers
+    if (!workers_) {
+        workers_ = std::make_unique<WorkerPool>(threadCount_);
+    }
+    size_t shards = std::min(workers_->GetThreadCount(),
+                             std::max<size_t>(1, count / MIN_ROBOTS_PER_SHARD));
+    if (shardScratch_.size() < shards) {
+        shardScratch_.resize(shards);
+    }
+    workers_->Run(shards, [&](size_t shard) {
+        ShardScratch& scratch = shardScratch_[shard];
+        for (size_t k = shard * count / shards; k < (shard + 1) * count / shards; ++k) {
+            size_t i = activeRobots_[k];
+            GatherNeighbors(i, scratch);
+            robots_[i].ComputeVelocity(tickDuration_, scratch.neighbors);
+        }
+    });
+    
+    // Phase 2: move, in robot order (goal callbacks run on this thread)
+    for (size_t i : activeRobots_) {
+        robots_[i].Integrate(tickDuration_);
     }
+    stats_.activeRobots = count;
     
     // Update simulation time
     simulationTime_ += tickDuration_;
@@ -0,0 +1,126 @@
+/**
+ * @file PathIndex.cc
+ * @brief Implementation of the path index
+ */
+
+#include "Core/PathIndex.hh"
+#include <algorithm>
+#include <cmath>
+
+namespace Backend {
+namespace Layer3 {
+namespace Core {
+
+PathIndex::PathIndex(const Backend::Layer1::NavMesh& mesh)
+    : navMesh_(mesh)
+    , nodeSlots_(mesh.GetAllNodes().size())
+    , nodeStamp_(mesh.GetAllNodes().size(), 0) {}
+
+bool PathIndex::Update(size_t slot, const RobotDriver& driver) {
+    if (slot >= entries_.size()) {
+        entries_.resize(slot + 1);
+        slotStamp_.resize(slot + 1, 0);
+    }
+    Entry& entry = entries_[slot];
+    if (entry.indexed && entry.pathVersion == driver.GetPathVersion()) return false;
+
+    Unlink(slot);
+    CollectNodes(driver.GetPath(), entry.nodes);
+    for (int node : entry.nodes) nodeSlots_[node].push_back(slot);
+    entry.pathVersion = driver.GetPathVersion();
+    entry.indexed = true;
+    return true;
+}
+
+void PathIndex::Remove(size_t slot) {
+    if (slot >= entries_.size()) return;
+    Unlink(slot);
+    entries_[slot].indexed = false;
+}
+
+void PathIndex::Unlink(size_t slot) {
+    Entry& entry = entries_[slot];
+    for (int node : entry.nodes) {
+        auto& slots = nodeSlots_[node];
+        auto it = std::find(slots.begin(), slots.end(), slot);
+        if (it != slots.end()) {
+            *it = slots.back();
+            slots.pop_back();
+        }
+    }
+    entry.nodes.clear();
+}
+
+void PathIndex::CollectNodes(const std::vector<Backend::Common::Coordinates>& path,
+                             std::vector<int>& nodesOut) const {
+    nodesOut.clear();
+    if (path.empty()) return;
+
+    const int numNodes = static_cast<int>(nodeSlots_.size());
+    auto addAt = [this, &nodesOut, numNodes](double x, double y) {
+        int node = navMesh_.GetNodeIdAt({static_cast<int>(std::round(x)), static_cast<int>(std::round(y))});
+        if (node >= 0 && node < numNodes && (nodesOut.empty() || nodesOut.back() != node)) {
+            nodesOut.push_back(node);
+        }
+    };
+
+    // Sample every half tile, so no tile a segment crosses is skipped
+    const double step = std::max(1.0, navMesh_.GetTileSize() * 0.5);
+    addAt(path[0].x, path[0].y);
+    for (size_t i = 1; i < path.size(); ++i) {
+        double fromX = path[i - 1].x;
+        double fromY = path[i - 1].y;
+        double toX = path[i].x;
+        double toY = path[i].y;
+        int samples = static_cast<int>(std::ceil(std::hypot(toX - fromX, toY - fromY) / step));
+        for (int k = 1; k <= samples; ++k) {
+            double t = static_cast<double>(k) / samples;
+            addAt(fromX + (toX - fromX) * t, fromY + (toY - fromY) * t);
+        }
+    }
+    std::sort(nodesOut.begin(), nodesOut.end());
+    nodesOut.erase(std::unique(nodesOut.begin(), nodesOut.end()), nodesOut.end());
+}
+
+void PathIndex::FindRobots(const std::vector<int>& nodes, std::vector<size_t>& slotsOut) {
+    slotsOut.clear();
+    if (++generation_ == 0) {
+        std::fill(slotStamp_.begin(), slotStamp_.end(), 0);
+        std::fill(nodeStamp_.begin(), nodeStamp_.end(), 0);
+        generation_ = 1;
+    }
+
+    const int numNodes = static_cast<int>(nodeSlots_.size());
+    auto visit = [this, &slotsOut, numNodes](int node) {
+        if (node < 0 || node >= numNodes || nodeStamp_[node] == generation_) return;
+        nodeStamp_[node] = generation_;
+        for (size_t slot : nodeSlots_[node]) {
+            if (slotStamp_[slot] == generation_) continue;
+            slotStamp_[slot] = generation_;
+            slotsOut.push_back(slot);
+        }
+    };
+    for (int node : nodes) {
+        visit(node);
+        if (node < 0 || node >= numNodes) continue;
+        for (const auto& edge : navMesh_.GetNeighbors(node)) visit(edge.targetNodeId);
+    }
+    std::sort(slotsOut.begin(), slotsOut.end());
+}
+
+const std::vector<int>& PathIndex::GetNodes(size_t slot) const {
+    static const std::vector<int> none;
+    return slot < entries_.size() ? entries_[slot].nodes : none;
+}
+
+size_t PathIndex::GetMemoryBytes() const {
+    size_t bytes = entries_.capacity() * sizeof(Entry) + nodeSlots_.capacity() * sizeof(std::vector<size_t>) +
+                   (slotStamp_.capacity() + nodeStamp_.capacity()) * sizeof(uint32_t);
+    for (const auto& entry : entries_) bytes += entry.nodes.capacity() * sizeof(int);
+    for (const auto& slots : nodeSlots_) bytes += slots.capacity() * sizeof(size_t);
+    return bytes;
+}
+
+} // namespace Core
+} // namespace Layer3
+} // namespace Backend
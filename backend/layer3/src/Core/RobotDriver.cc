@@ -4,8 +4,12 @@
  */
 
 #include "Core/RobotDriver.hh"
+#include "Trace.hh"
+#include "MemoryUsage.hh"
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace Backend {
 namespace Layer3 {
@@ -22,15 +26,32 @@ RobotDriver::RobotDriver()
     , currentPosition_{0, 0}
     , currentVelocity_()
     , currentSpeed_(0.0)
-    , hasPackage_(false)
+    , loadCount_(0)
     , pathIndex_(0)
     , currentGoalNodeId_(-1)
-    , navMesh_(nullptr) {}
+    , scheduleClock_(0.0)
+    , scheduleReachesGoal_(false)
+    , timedLeg_(false)
+    , navMesh_(nullptr)
+    , replanTarget_{0, 0}
+    , pathBlocked_(false)
+    , backingOff_(false)
+    , backOffHold_(0.0)
+    , backOffResumes_(false)
+    , resumeTarget_{0, 0}
+    , pathService_(nullptr)
+    , pendingMove_(false)
+    , pendingGoalReached_(false)
+    , pendingBackOffEnd_(false)
+    , pathMailbox_(std::make_shared<PathMailbox>())
+    , prefetchMailbox_(std::make_shared<PrefetchMailbox>())
+    , prefetchedPaths_(0) {}
 
 RobotDriver::RobotDriver(
     int id,
     const Backend::Common::Coordinates& startPosition,
     const Backend::Layer1::NavMesh& navMesh,
+    Pathfinding::PathfindingService& pathService,
     const DriverConfig& config
 )
     : robotId_(id)
@@ -40,16 +61,33 @@ RobotDriver::RobotDriver(
     , currentPosition_(startPosition)
     , currentVelocity_()
     , currentSpeed_(0.0)
-    , hasPackage_(false)
+    , loadCount_(0)
     , pathIndex_(0)
     , currentGoalNodeId_(-1)  // Will be set by SetStartNode() after construction
-    , navMesh_(&navMesh) {}
+    , scheduleClock_(0.0)
+    , scheduleReachesGoal_(false)
+    , timedLeg_(false)
+    , navMesh_(&navMesh)
+    , replanner_(navMesh)
+    , replanTarget_{0, 0}
+    , pathBlocked_(false)
+    , backingOff_(false)
+    , backOffHold_(0.0)
+    , backOffResumes_(false)
+    , resumeTarget_{0, 0}
+    , pathService_(&pathService)
+    , pendingMove_(false)
+    , pendingGoalReached_(false)
+    , pendingBackOffEnd_(false)
+    , pathMailbox_(std::make_shared<PathMailbox>())
+    , prefetchMailbox_(std::make_shared<PrefetchMailbox>())
+    , prefetchedPaths_(0) {}
 
 // =============================================================================
 // GOAL SETTING
 // =============================================================================
 
-bool RobotDriver::SetGoal(int nodeId) {
+bool RobotDriver::SetGoal(int nodeId, Pathfinding::PathPriority priority) {
     if (!navMesh_) {
         std::cerr << "[RobotDriver " << robotId_ << "] ERROR: NavMesh not set\n";
         return false;
@@ -64,15 +102,21 @@ bool RobotDriver::SetGoal(int nodeId) {
         
         // Get coordinates from the node (coords field contains x,y)
         Backend::Common::Coordinates target = nodes[nodeId].coords;
-        return SetGoalPosition(target);
+        return SetGoalPosition(target, priority);
     }
     
     std::cerr << "[RobotDriver " << robotId_ << "] ERROR: Node " << nodeId << " not found\n";
     return false;
 }
 
-bool RobotDriver::SetGoalPosition(const Backend::Common::Coordinates& target) {
-    auto& pathService = Pathfinding::PathfindingService::GetInstance();
+bool RobotDriver::SetGoalPosition(const Backend::Common::Coordinates& target,
+                                  Pathfinding::PathPriority priority) {
+    TRACE_ZONE("SetGoalPosition", "layer3");
+    if (!pathService_) {
+        std::cerr << "[RobotDriver " << robotId_ << "] ERROR: PathfindingService not set\n";
+        return false;
+    }
+    auto& pathService = *pathService_;
     
     if (!pathService.IsInitialized()) {
         std::cerr << "[RobotDriver " << robotId_ << "] ERROR: PathfindingService not initialized\n";
@@ -81,12 +125,47 @@ bool RobotDriver::SetGoalPosition(const Backend::Common::Coordinates& target) {
     
     // Clear current path
     currentPath_.clear();
+    pathVersion_++;
+    waypointTimes_.clear();
+    timedLeg_ = false;
     pathIndex_ = 0;
+    replanner_.Reset();
+    pathBlocked_ = false;
+    backingOff_ = false;
+    
+    // Planned while the previous leg was driven: nothing to wait for
+    Pathfinding::PathResult prefetched;
+    if (TakePrefetchedPath(target, prefetched)) {
+        NextPathTicket();
+        prefetchedPaths_++;
+        OnPathReceived(prefetched);
+        return true;
+    }
     
     // Set state to computing
     state_ = DriverState::COMPUTING_PATH;
+    uint64_t ticket = NextPathTicket();
+    
+    // Off the caller's thread when the service has workers: the result
+    // waits in the mailbox until Integrate takes it
+    if (pathService.HasWorkers()) {
+        Pathfinding::PathRequestOptions options;
+        options.priority = priority;
+        options.ownerId = robotId_;
+        
+        std::shared_ptr<PathMailbox> mailbox = pathMailbox_;
+        pathService.RequestPath(currentPosition_, target,
+            [mailbox, ticket](const Pathfinding::PathResult& result) {
+                std::lock_guard<std::mutex> lock(mailbox->mutex);
+                if (mailbox->ticket == ticket) {
+                    mailbox->result = result;
+                    mailbox->ready = true;
+                }
+            }, options);
+        return true;
+    }
     
-    // Request path (synchronous for simplicity)
+    // Otherwise synchronous
     auto result = pathService.ComputePathImmediate(currentPosition_, target);
     
     OnPathReceived(result);
@@ -94,15 +173,267 @@ bool RobotDriver::SetGoalPosition(const Backend::Common::Coordinates& target) {
     return result.success;
 }
 
+bool RobotDriver::PrefetchItinerary(const std::vector<int>& nodeIds) {
+    if (!pathService_ || !pathService_->HasWorkers() || !navMesh_ || nodeIds.empty()) {
+        return false;
+    }
+    
+    // Legs start at the current goal, or here if there is none
+    const auto& nodes = navMesh_->GetAllNodes();
+    auto isNode = [&nodes](int nodeId) {
+        return nodeId >= 0 && static_cast<size_t>(nodeId) < nodes.size();
+    };
+    std::vector<Backend::Common::Coordinates> points;
+    points.reserve(nodeIds.size() + 1);
+    bool driving = state_ != DriverState::IDLE && state_ != DriverState::ARRIVED &&
+                   state_ != DriverState::STUCK;
+    points.push_back(driving && isNode(currentGoalNodeId_) ? nodes[currentGoalNodeId_].coords
+                                                           : currentPosition_);
+    for (int nodeId : nodeIds) {
+        if (!isNode(nodeId)) {
+            std::cerr << "[RobotDriver " << robotId_ << "] ERROR: Node " << nodeId << " not found\n";
+            return false;
+        }
+        points.push_back(nodes[nodeId].coords);
+    }
+    
+    // The robot moved on to the next goal of the itinerary already planned
+    if (std::search(prefetchPoints_.begin(), prefetchPoints_.end(), points.begin(), points.end()) !=
+        prefetchPoints_.end()) {
+        return true;
+    }
+    
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(prefetchMailbox_->mutex);
+        prefetchMailbox_->ready = false;
+        ticket = ++prefetchMailbox_->ticket;
+    }
+    prefetchPoints_ = points;
+    
+    Pathfinding::PathRequestOptions options;
+    options.priority = Pathfinding::PathPriority::PREFETCH;
+    options.ownerId = robotId_;
+    
+    std::shared_ptr<PrefetchMailbox> mailbox = prefetchMailbox_;
+    std::vector<Backend::Common::Coordinates> goals(points.begin() + 1, points.end());
+    pathService_->RequestItinerary(points.front(), goals,
+        [mailbox, ticket](const Pathfinding::ItineraryResult& result) {
+            std::lock_guard<std::mutex> lock(mailbox->mutex);
+            if (mailbox->ticket == ticket && !result.legs.empty()) {
+                mailbox->result = result;
+                mailbox->ready = true;
+            }
+        }, options);
+    return true;
+}
+
+bool RobotDriver::TakePrefetchedPath(const Backend::Common::Coordinates& target,
+                                     Pathfinding::PathResult& path) {
+    if (prefetchPoints_.empty()) {
+        return false;
+    }
+    const uint64_t version = pathService_->GetMapVersion();
+    
+    std::lock_guard<std::mutex> lock(prefetchMailbox_->mutex);
+    const auto& result = prefetchMailbox_->result;
+    if (!prefetchMailbox_->ready || result.mapVersion != version) {
+        return false;
+    }
+    for (size_t leg = 0; leg < result.legs.size(); ++leg) {
+        const auto& from = prefetchPoints_[leg];
+        double dx = from.x - currentPosition_.x;
+        double dy = from.y - currentPosition_.y;
+        if (prefetchPoints_[leg + 1] == target && result.legs[leg].success &&
+            std::sqrt(dx * dx + dy * dy) <= config_.waypointThreshold) {
+            path = result.legs[leg];
+            path.path.front() = currentPosition_;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t RobotDriver::NextPathTicket() {
+    std::lock_guard<std::mutex> lock(pathMailbox_->mutex);
+    pathMailbox_->ready = false;
+    return ++pathMailbox_->ticket;
+}
+
+void RobotDriver::ReceivePendingPath() {
+    Pathfinding::PathResult result;
+    {
+        std::lock_guard<std::mutex> lock(pathMailbox_->mutex);
+        if (!pathMailbox_->ready) {
+            return;
+        }
+        pathMailbox_->ready = false;
+        result = std::move(pathMailbox_->result);
+    }
+    OnPathReceived(result);
+}
+
+bool RobotDriver::SetScheduledGoal(int nodeId) {
+    if (!navMesh_ || nodeId < 0 || static_cast<size_t>(nodeId) >= navMesh_->GetAllNodes().size()) {
+        std::cerr << "[RobotDriver " << robotId_ << "] ERROR: Node " << nodeId << " not found\n";
+        return false;
+    }
+    NextPathTicket();
+    currentGoalNodeId_ = nodeId;
+    currentPath_.clear();
+    pathVersion_++;
+    waypointTimes_.clear();
+    timedLeg_ = false;
+    pathIndex_ = 0;
+    replanner_.Reset();
+    pathBlocked_ = false;
+    backingOff_ = false;
+    state_ = DriverState::COMPUTING_PATH;
+    return true;
+}
+
+bool RobotDriver::SetTimedGoal(int nodeId, double travelSeconds) {
+    if (!navMesh_ || nodeId < 0 || static_cast<size_t>(nodeId) >= navMesh_->GetAllNodes().size()) {
+        std::cerr << "[RobotDriver " << robotId_ << "] ERROR: Node " << nodeId << " not found\n";
+        return false;
+    }
+    NextPathTicket();
+    if (state_ == DriverState::COMPUTING_PATH && pathService_) {
+        pathService_->CancelRequestsOf(robotId_);
+    }
+    currentGoalNodeId_ = nodeId;
+    currentPath_ = {navMesh_->GetAllNodes()[nodeId].coords};
+    RebuildArcLengths();
+    waypointTimes_ = {std::max(0.0, travelSeconds)};
+    scheduleClock_ = 0.0;
+    scheduleReachesGoal_ = true;
+    timedLeg_ = true;
+    pathIndex_ = 0;
+    replanner_.Reset();
+    pathBlocked_ = false;
+    backingOff_ = false;
+    state_ = DriverState::MOVING;
+    return true;
+}
+
+double RobotDriver::GetTimedLegSecondsLeft() const {
+    if (!timedLeg_ || state_ != DriverState::MOVING) return -1.0;
+    return std::max(0.0, waypointTimes_.back() - scheduleClock_);
+}
+
+void RobotDriver::FollowSchedule(const std::vector<Backend::Common::Coordinates>& waypoints,
+                                 const std::vector<double>& arrivalTimes,
+                                 bool reachesGoal) {
+    if (waypoints.empty() || waypoints.size() != arrivalTimes.size()) {
+        std::cerr << "[RobotDriver " << robotId_ << "] No schedule to goal " << currentGoalNodeId_ << "\n";
+        currentPath_.clear();
+        pathVersion_++;
+        waypointTimes_.clear();
+        timedLeg_ = false;
+        state_ = DriverState::STUCK;
+        return;
+    }
+    
+    currentPath_ = waypoints;
+    RebuildArcLengths();
+    backingOff_ = false;
+    waypointTimes_ = arrivalTimes;
+    timedLeg_ = false;
+    scheduleClock_ = 0.0;
+    scheduleReachesGoal_ = reachesGoal;
+    pathIndex_ = 0;
+    if (state_ != DriverState::COLLISION_WAIT) {
+        state_ = DriverState::MOVING;
+    }
+}
+
 void RobotDriver::CancelGoal() {
+    NextPathTicket();
+    if (state_ == DriverState::COMPUTING_PATH) {
+        pathService_->CancelRequestsOf(robotId_);
+    }
     currentPath_.clear();
+    pathVersion_++;
+    waypointTimes_.clear();
+    timedLeg_ = false;
     pathIndex_ = 0;
+    replanner_.Reset();
+    pathBlocked_ = false;
+    backingOff_ = false;
     currentGoalNodeId_ = -1;
     currentVelocity_ = Vector2::Zero();
     currentSpeed_ = 0.0;
     state_ = DriverState::IDLE;
 }
 
+void RobotDriver::OnMapChanged(const std::vector<int>& changedNodeIds) {
+    if (!config_.incrementalReplanning || !navMesh_ || !waypointTimes_.empty() ||
+        (state_ != DriverState::MOVING && state_ != DriverState::COLLISION_WAIT)) {
+        return;
+    }
+    
+    int startNode = navMesh_->GetNodeIdAt(currentPosition_);
+    if (startNode < 0) return;
+    
+    // Already detouring: repair the route from where the robot is now
+    if (replanner_.HasPlan()) {
+        replanner_.MoveStart(startNode);
+        uint64_t expansions = replanner_.GetLastExpansions();
+        replanner_.NotifyChanged(changedNodeIds);
+        expansions += replanner_.GetLastExpansions();
+        if (expansions > 0 || pathBlocked_ || IsRemainingPathBlocked()) {
+            FollowDetour();
+        }
+        return;
+    }
+    
+    if (currentPath_.empty() || !IsRemainingPathBlocked()) return;
+    
+    replanTarget_ = currentPath_.back();
+    int goalNode = navMesh_->GetNodeIdAt(replanTarget_);
+    if (goalNode < 0) return;
+    replanner_.Plan(startNode, goalNode);
+    std::cout << "[RobotDriver " << robotId_ << "] Path blocked, detouring ("
+              << replanner_.GetLastExpansions() << " nodes searched)\n";
+    FollowDetour();
+}
+
+bool RobotDriver::Reroute(const std::vector<int>& route) {
+    if (!navMesh_ || route.empty() || currentPath_.empty() || !waypointTimes_.empty() ||
+        (state_ != DriverState::MOVING && state_ != DriverState::COLLISION_WAIT)) {
+        return false;
+    }
+    Backend::Common::Coordinates target = backingOff_ ? resumeTarget_ : currentPath_.back();
+    replanner_.Reset();
+    backingOff_ = false;
+    FollowRoute(route, target);
+    return true;
+}
+
+bool RobotDriver::BackOff(const std::vector<int>& route, double holdSeconds) {
+    if (!navMesh_ || route.empty() || !waypointTimes_.empty()) {
+        return false;
+    }
+    if (state_ == DriverState::MOVING || state_ == DriverState::COLLISION_WAIT) {
+        if (currentPath_.empty()) return false;
+        // Backing off again keeps the first back-off's goal (or lack of one)
+        if (!backingOff_) {
+            resumeTarget_ = currentPath_.back();
+            backOffResumes_ = true;
+        }
+    } else if (state_ == DriverState::IDLE || state_ == DriverState::ARRIVED) {
+        backOffResumes_ = false;
+    } else {
+        return false;
+    }
+    
+    replanner_.Reset();
+    backingOff_ = true;
+    backOffHold_ = holdSeconds;
+    FollowRoute(route, navMesh_->GetAllNodes()[route.back()].coords);
+    return true;
+}
+
 bool RobotDriver::HasGoal() const {
     return state_ == DriverState::MOVING || state_ == DriverState::COMPUTING_PATH;
 }
@@ -112,6 +443,23 @@ bool RobotDriver::HasGoal() const {
 // =============================================================================
 
 void RobotDriver::UpdateLoop(float dt, const std::vector<Physics::ObstacleData>& neighbors) {
+    TRACE_ZONE("DriverUpdate", "layer3");
+    ComputeVelocity(dt, neighbors);
+    Integrate(dt);
+}
+
+void RobotDriver::UpdateLoop(float dt, const Physics::KinematicsStore& neighbors) {
+    TRACE_ZONE("DriverUpdate", "layer3");
+    ComputeVelocity(dt, neighbors);
+    Integrate(dt);
+}
+
+template <typename Neighbors>
+void RobotDriver::ComputeVelocityFrom(float dt, const Neighbors& neighbors) {
+    pendingMove_ = false;
+    pendingGoalReached_ = false;
+    pendingBackOffEnd_ = false;
+    
     // Handle different states
     switch (state_) {
         case DriverState::IDLE:
@@ -131,16 +479,34 @@ void RobotDriver::UpdateLoop(float dt, const std::vector<Physics::ObstacleData>&
             // Continue to movement logic
             break;
     }
+    if (timedLeg_) {
+        StepTimedLeg(dt);
+        return;
+    }
+    scheduleClock_ += dt;
+    
+    // Blocked path without a detour: hold until OnMapChanged frees it
+    if (pathBlocked_) {
+        currentVelocity_ = Vector2::Zero();
+        currentSpeed_ = 0.0;
+        return;
+    }
+    
+    // Backing off: hold where the way is clear instead of arriving there
+    if (backingOff_ && IsGoalReached()) {
+        currentVelocity_ = Vector2::Zero();
+        currentSpeed_ = 0.0;
+        backOffHold_ -= dt;
+        pendingBackOffEnd_ = backOffHold_ <= 0.0;
+        return;
+    }
     
     // Check if goal reached
     if (IsGoalReached()) {
         currentVelocity_ = Vector2::Zero();
         currentSpeed_ = 0.0;
         state_ = DriverState::ARRIVED;
-        
-        if (onGoalReached_) {
-            onGoalReached_(robotId_, currentGoalNodeId_);
-        }
+        pendingGoalReached_ = true;
         return;
     }
     
@@ -170,6 +536,61 @@ void RobotDriver::UpdateLoop(float dt, const std::vector<Physics::ObstacleData>&
         state_ = DriverState::MOVING;
     }
     
+    pendingMove_ = true;
+}
+
+void RobotDriver::StepTimedLeg(float dt) {
+    double left = waypointTimes_.back() - scheduleClock_;
+    if (left <= 0.0) {
+        currentVelocity_ = Vector2::Zero();
+        currentSpeed_ = 0.0;
+        timedLeg_ = false;
+        state_ = DriverState::ARRIVED;
+        pendingGoalReached_ = true;
+        return;
+    }
+    
+    // The share of the remaining line this step covers; the last step
+    // lands on the goal exactly
+    const Backend::Common::Coordinates& goal = currentPath_.back();
+    Vector2 toGoal = Vector2(goal.x, goal.y) - precisePosition_;
+    double share = std::min(static_cast<double>(dt), left) / left;
+    currentVelocity_ = toGoal * (share / dt);
+    currentSpeed_ = currentVelocity_.Magnitude();
+    scheduleClock_ += dt;
+    pendingMove_ = true;
+}
+
+void RobotDriver::ComputeVelocity(float dt, const std::vector<Physics::ObstacleData>& neighbors) {
+    ComputeVelocityFrom(dt, neighbors);
+}
+
+void RobotDriver::ComputeVelocity(float dt, const Physics::KinematicsStore& neighbors) {
+    ComputeVelocityFrom(dt, neighbors);
+}
+
+void RobotDriver::Integrate(float dt) {
+    if (pendingGoalReached_) {
+        pendingGoalReached_ = false;
+        if (onGoalReached_) {
+            onGoalReached_(robotId_, currentGoalNodeId_);
+        }
+        return;
+    }
+    if (pendingBackOffEnd_) {
+        pendingBackOffEnd_ = false;
+        EndBackOff();
+        return;
+    }
+    if (state_ == DriverState::COMPUTING_PATH) {
+        ReceivePendingPath();
+        return;
+    }
+    if (!pendingMove_) {
+        return;
+    }
+    pendingMove_ = false;
+    
     // STEP 4: Update position using precise floating-point math
     precisePosition_ = precisePosition_ + currentVelocity_ * static_cast<double>(dt);
     
@@ -195,42 +616,47 @@ double RobotDriver::GetRemainingPathLength() const {
     if (pathIndex_ >= currentPath_.size()) {
         return 0.0;
     }
+    return GetPathLengthTo(currentPath_.size() - 1);
+}
+
+double RobotDriver::GetPathLengthTo(size_t waypointIndex) const {
+    if (pathIndex_ >= currentPath_.size() || waypointIndex < pathIndex_) {
+        return 0.0;
+    }
+    waypointIndex = std::min(waypointIndex, currentPath_.size() - 1);
     
-    double length = 0.0;
-    
-    // Distance to next waypoint (use precise position)
+    // Distance to next waypoint (use precise position), then along the path
     const auto& nextWP = currentPath_[pathIndex_];
     double dx = static_cast<double>(nextWP.x) - precisePosition_.x;
     double dy = static_cast<double>(nextWP.y) - precisePosition_.y;
-    length += std::sqrt(dx * dx + dy * dy);
+    return std::sqrt(dx * dx + dy * dy) + pathArcLength_[waypointIndex] - pathArcLength_[pathIndex_];
+}
+
+double RobotDriver::GetTimeToWaypoint(size_t waypointIndex) const {
+    if (config_.maxSpeed < 1e-6) return std::numeric_limits<double>::max();
+    double seconds = GetPathLengthTo(waypointIndex) / config_.maxSpeed;
     
-    // Sum remaining waypoint-to-waypoint distances
-    for (size_t i = pathIndex_; i + 1 < currentPath_.size(); ++i) {
-        const auto& a = currentPath_[i];
-        const auto& b = currentPath_[i + 1];
-        dx = b.x - a.x;
-        dy = b.y - a.y;
-        length += std::sqrt(dx * dx + dy * dy);
+    // A scheduled waypoint is not passed before its time
+    if (!waypointTimes_.empty() && pathIndex_ < currentPath_.size() && waypointIndex >= pathIndex_) {
+        waypointIndex = std::min(waypointIndex, waypointTimes_.size() - 1);
+        seconds = std::max(seconds, waypointTimes_[waypointIndex] - scheduleClock_);
     }
-    
-    return length;
+    return seconds;
+}
+
+size_t RobotDriver::GetMemoryBytes() const {
+    using Backend::Common::VectorBytes;
+    return sizeof(*this) + VectorBytes(currentPath_) + VectorBytes(pathArcLength_) +
+           VectorBytes(waypointTimes_) + VectorBytes(prefetchPoints_);
 }
 
 double RobotDriver::GetETA() const {
-    if (config_.maxSpeed < 1e-6) return std::numeric_limits<double>::max();
-    return GetRemainingPathLength() / config_.maxSpeed;
+    if (currentPath_.empty()) return 0.0;
+    return GetTimeToWaypoint(currentPath_.size() - 1);
 }
 
 std::string RobotDriver::GetStateString() const {
-    switch (state_) {
-        case DriverState::IDLE: return "IDLE";
-        case DriverState::COMPUTING_PATH: return "COMPUTING_PATH";
-        case DriverState::MOVING: return "MOVING";
-        case DriverState::ARRIVED: return "ARRIVED";
-        case DriverState::STUCK: return "STUCK";
-        case DriverState::COLLISION_WAIT: return "COLLISION_WAIT";
-        default: return "UNKNOWN";
-    }
+    return DriverStateToString(state_);
 }
 
 // =============================================================================
@@ -259,6 +685,14 @@ Vector2 RobotDriver::CalculatePreferredVelocity() const {
     
     // Slow down near goal
     double speed = config_.maxSpeed;
+    
+    // On a schedule, just fast enough to arrive on time
+    if (!waypointTimes_.empty()) {
+        double remaining = waypointTimes_[pathIndex_] - scheduleClock_;
+        if (remaining > 0.0) {
+            speed = std::min(speed, distance / remaining);
+        }
+    }
     if (pathIndex_ == currentPath_.size() - 1) {
         // Final waypoint - slow down as we approach
         double slowdownDist = config_.goalThreshold * 3.0;
@@ -286,6 +720,11 @@ bool RobotDriver::IsWaypointReached() const {
         ? config_.goalThreshold 
         : config_.waypointThreshold;
     
+    // A scheduled waypoint is only passed once its time has come
+    if (!waypointTimes_.empty() && scheduleClock_ < waypointTimes_[pathIndex_]) {
+        return false;
+    }
+    
     return dist < threshold;
 }
 
@@ -293,6 +732,10 @@ bool RobotDriver::IsGoalReached() const {
     if (currentPath_.empty()) {
         return false;
     }
+    if (!waypointTimes_.empty() &&
+        (!scheduleReachesGoal_ || scheduleClock_ < waypointTimes_.back())) {
+        return false;
+    }
     
     const auto& goal = currentPath_.back();
     double dx = static_cast<double>(goal.x) - precisePosition_.x;
@@ -302,6 +745,109 @@ bool RobotDriver::IsGoalReached() const {
     return dist < config_.goalThreshold;
 }
 
+bool RobotDriver::IsRemainingPathBlocked() const {
+    // Sample every half tile, so no tile a segment crosses is skipped
+    const double step = std::max(1.0, navMesh_->GetTileSize() * 0.5);
+    auto blockedAt = [this](double x, double y) {
+        int node = navMesh_->GetNodeIdAt({static_cast<int>(std::round(x)), static_cast<int>(std::round(y))});
+        return node >= 0 && navMesh_->IsNodeBlocked(node);
+    };
+    
+    double fromX = precisePosition_.x;
+    double fromY = precisePosition_.y;
+    for (size_t i = pathIndex_; i < currentPath_.size(); ++i) {
+        double toX = currentPath_[i].x;
+        double toY = currentPath_[i].y;
+        double length = std::hypot(toX - fromX, toY - fromY);
+        int samples = static_cast<int>(std::ceil(length / step));
+        for (int k = 1; k <= samples; ++k) {
+            double t = static_cast<double>(k) / samples;
+            if (blockedAt(fromX + (toX - fromX) * t, fromY + (toY - fromY) * t)) {
+                return true;
+            }
+        }
+        fromX = toX;
+        fromY = toY;
+    }
+    return false;
+}
+
+void RobotDriver::FollowDetour() {
+    std::vector<int> route = replanner_.GetRoute();
+    if (route.empty()) {
+        // No way around on the NavMesh (also if its graph does not connect
+        // the path's ends): hold until the path itself is clear again
+        if (!IsRemainingPathBlocked()) {
+            replanner_.Reset();
+            pathBlocked_ = false;
+            state_ = DriverState::MOVING;
+            return;
+        }
+        if (!pathBlocked_) {
+            std::cerr << "[RobotDriver " << robotId_ << "] No detour, waiting for the path to clear\n";
+        }
+        pathBlocked_ = true;
+        state_ = DriverState::COLLISION_WAIT;
+        return;
+    }
+    
+    FollowRoute(route, replanTarget_);
+}
+
+void RobotDriver::FollowRoute(const std::vector<int>& route, const Backend::Common::Coordinates& target) {
+    // Node centres where the route turns, then the exact target
+    const auto& nodes = navMesh_->GetAllNodes();
+    currentPath_.clear();
+    for (size_t i = 1; i + 1 < route.size(); ++i) {
+        const auto& prev = nodes[route[i - 1]].coords;
+        const auto& here = nodes[route[i]].coords;
+        const auto& next = nodes[route[i + 1]].coords;
+        bool straight = (here.x - prev.x) * (next.y - here.y) == (here.y - prev.y) * (next.x - here.x);
+        if (!straight) {
+            currentPath_.push_back(here);
+        }
+    }
+    currentPath_.push_back(target);
+    RebuildArcLengths();
+    waypointTimes_.clear();
+    pathIndex_ = 0;
+    pathBlocked_ = false;
+    state_ = DriverState::MOVING;
+}
+
+void RobotDriver::EndBackOff() {
+    backingOff_ = false;
+    if (backOffResumes_) {
+        std::cout << "[RobotDriver " << robotId_ << "] Way cleared, resuming goal " << currentGoalNodeId_ << "\n";
+        SetGoalPosition(resumeTarget_);
+        return;
+    }
+    
+    // Made way while parked: rest where it backed off to
+    currentPath_.clear();
+    pathVersion_++;
+    pathIndex_ = 0;
+    int node = navMesh_->GetNodeIdAt(currentPosition_);
+    if (node >= 0) {
+        currentGoalNodeId_ = node;
+    }
+    state_ = DriverState::IDLE;
+}
+
+void RobotDriver::RebuildArcLengths() {
+    pathVersion_++;
+    pathArcLength_.resize(currentPath_.size());
+    double length = 0.0;
+    for (size_t i = 0; i < currentPath_.size(); ++i) {
+        if (i > 0) {
+            double dx = currentPath_[i].x - currentPath_[i - 1].x;
+            double dy = currentPath_[i].y - currentPath_[i - 1].y;
+            length += std::sqrt(dx * dx + dy * dy);
+        }
+        pathArcLength_[i] = length;
+    }
+}
+
 void RobotDriver::AdvanceWaypoint() {
     if (pathIndex_ < currentPath_.size()) {
         pathIndex_++;
@@ -316,7 +862,11 @@ void RobotDriver::OnPathReceived(const Pathfinding::PathResult& result) {
     }
     
     currentPath_ = result.path;
+    RebuildArcLengths();
+    waypointTimes_.clear();
     pathIndex_ = 0;
+    replanner_.Reset();
+    pathBlocked_ = false;
     state_ = DriverState::MOVING;
     
     std::cout << "[RobotDriver " << robotId_ << "] Path received: " 
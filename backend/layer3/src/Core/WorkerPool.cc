@@ -0,0 +1,89 @@
+/**
+ * @file WorkerPool.cc
+ * @brief Implementation of the persistent tick worker pool
+ */
+
+#include "Core/WorkerPool.hh"
+#include <algorithm>
+
+namespace Backend {
+namespace Layer3 {
+namespace Core {
+
+WorkerPool::WorkerPool(size_t threads)
+    : generation_(0)
+    , busyWorkers_(0)
+    , stopping_(false)
+    , job_(nullptr)
+    , jobCount_(0)
+    , nextJob_(0) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 1; i < threads; ++i) {
+        workers_.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void WorkerPool::RunJobs() {
+    for (size_t job = nextJob_.fetch_add(1); job < jobCount_; job = nextJob_.fetch_add(1)) {
+        (*job_)(job);
+    }
+}
+
+void WorkerPool::WorkerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_) return;
+        seen = generation_;
+
+        lock.unlock();
+        RunJobs();
+        lock.lock();
+
+        if (--busyWorkers_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+void WorkerPool::Run(size_t jobs, const std::function<void(size_t)>& job) {
+    if (workers_.empty() || jobs <= 1) {
+        for (size_t i = 0; i < jobs; ++i) job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        jobCount_ = jobs;
+        nextJob_ = 0;
+        busyWorkers_ = workers_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    RunJobs();
+
+    // Every worker takes part in every Run, so none can miss the next one
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return busyWorkers_ == 0; });
+    job_ = nullptr;
+}
+
+} // namespace Core
+} // namespace Layer3
+} // namespace Backend
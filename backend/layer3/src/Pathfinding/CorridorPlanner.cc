@@ -0,0 +1,144 @@
+/**
+ * @file CorridorPlanner.cc
+ * @brief Implementation of the NavMesh route / corridor front end
+ */
+
+#include "Pathfinding/CorridorPlanner.hh"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+CorridorPlanner::CorridorPlanner(const Backend::Layer1::NavMesh& navMesh, int marginTiles)
+    : mesh_(navMesh)
+    , tileSize_(navMesh.GetTileSize())
+    , marginTiles_(marginTiles) {
+    if (tileSize_ <= 0) {
+        throw std::invalid_argument("CorridorPlanner: NavMesh tile size is not set");
+    }
+    if (marginTiles < 0) {
+        throw std::invalid_argument("CorridorPlanner: margin must not be negative");
+    }
+}
+
+Backend::Layer1::RegionRect CorridorPlanner::NodeRect(int nodeId) const {
+    if (mesh_.HasRegions()) {
+        return mesh_.GetNodeRegions()[nodeId];
+    }
+    const auto& center = mesh_.GetAllNodes()[nodeId].coords;
+    return {center.x - tileSize_ / 2, center.y - tileSize_ / 2, tileSize_, tileSize_};
+}
+
+// =============================================================================
+// ROUTE
+// =============================================================================
+
+std::vector<int> CorridorPlanner::FindRoute(
+    const Backend::Common::Coordinates& start,
+    const Backend::Common::Coordinates& end,
+    int* settled
+) const {
+    std::vector<int> route;
+    if (settled) *settled = 0;
+
+    int sourceId = mesh_.GetNodeIdAt(start);
+    int targetId = mesh_.GetNodeIdAt(end);
+    if (sourceId < 0 || targetId < 0) {
+        return route;
+    }
+    if (sourceId == targetId) {
+        route.push_back(sourceId);
+        return route;
+    }
+
+    const auto& nodes = mesh_.GetAllNodes();
+    const int numNodes = static_cast<int>(nodes.size());
+    const auto& goal = nodes[targetId].coords;
+    auto heuristic = [&](int nodeId) -> float {
+        float dx = static_cast<float>(nodes[nodeId].coords.x - goal.x);
+        float dy = static_cast<float>(nodes[nodeId].coords.y - goal.y);
+        return std::sqrt(dx * dx + dy * dy);
+    };
+
+    // Priority queue: (f-score, nodeId)
+    using PQEntry = std::pair<float, int>;
+    std::priority_queue<PQEntry, std::vector<PQEntry>, std::greater<PQEntry>> openSet;
+    std::vector<float> gScore(numNodes, std::numeric_limits<float>::max());
+    std::vector<int> parent(numNodes, -1);
+    std::vector<bool> visited(numNodes, false);
+
+    gScore[sourceId] = 0.0f;
+    openSet.push({heuristic(sourceId), sourceId});
+    int expanded = 0;
+
+    while (!openSet.empty()) {
+        int current = openSet.top().second;
+        openSet.pop();
+
+        if (current == targetId) {
+            for (int n = targetId; n != sourceId; n = parent[n]) {
+                route.push_back(n);
+            }
+            route.push_back(sourceId);
+            std::reverse(route.begin(), route.end());
+            break;
+        }
+
+        if (visited[current]) continue;
+        visited[current] = true;
+        expanded++;
+
+        for (const auto& edge : mesh_.GetNeighbors(current)) {
+            int neighbor = edge.targetNodeId;
+            float tentativeG = gScore[current] + edge.cost;
+            if (tentativeG < gScore[neighbor]) {
+                gScore[neighbor] = tentativeG;
+                parent[neighbor] = current;
+                openSet.push({tentativeG + heuristic(neighbor), neighbor});
+            }
+        }
+    }
+
+    if (settled) *settled = expanded;
+    return route;
+}
+
+// =============================================================================
+// CORRIDOR
+// =============================================================================
+
+void CorridorPlanner::BuildCorridor(
+    const std::vector<int>& route,
+    const Backend::Common::Coordinates& start,
+    const Backend::Common::Coordinates& end,
+    int width, int height, int step,
+    ThetaStarSolver::SearchCorridor& corridor
+) const {
+    const int margin = marginTiles_ * tileSize_;
+    auto addWidened = [&](const Backend::Layer1::RegionRect& rect) {
+        corridor.AddRect(rect.x - margin, rect.y - margin, rect.w + 2 * margin, rect.h + 2 * margin);
+    };
+
+    corridor.Reset(width, height, step);
+    for (int nodeId : route) {
+        addWidened(NodeRect(nodeId));
+    }
+
+    // The endpoints need not lie inside their nearest node's tile
+    for (const auto& point : {start, end}) {
+        int x = point.x - point.x % tileSize_;
+        int y = point.y - point.y % tileSize_;
+        addWidened({x, y, tileSize_, tileSize_});
+    }
+}
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
@@ -0,0 +1,204 @@
+/**
+ * @file DStarLite.cc
+ * @brief Implementation of D* Lite over the NavMesh
+ */
+
+#include "Pathfinding/DStarLite.hh"
+#include <algorithm>
+#include <cmath>
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+DStarLite::DStarLite()
+    : mesh_(nullptr)
+    , start_(-1)
+    , goal_(-1)
+    , km_(0.0f)
+    , lastExpansions_(0)
+    , totalExpansions_(0) {}
+
+DStarLite::DStarLite(const Backend::Layer1::NavMesh& navMesh)
+    : DStarLite() {
+    mesh_ = &navMesh;
+}
+
+float DStarLite::Heuristic(int a, int b) const {
+    const auto& nodes = mesh_->GetAllNodes();
+    float dx = static_cast<float>(nodes[a].coords.x - nodes[b].coords.x);
+    float dy = static_cast<float>(nodes[a].coords.y - nodes[b].coords.y);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+float DStarLite::EdgeCost(int from, int to, float cost) const {
+    // The robot can always leave the node it is on
+    bool blocked = (from != start_ && mesh_->IsNodeBlocked(from)) ||
+                   (to != start_ && mesh_->IsNodeBlocked(to));
+    if (blocked) return INFINITE_COST;
+    // Traversal penalties count like in the cost matrix
+    if (mesh_->GetNodePenalties()) {
+        cost += 0.5f * (mesh_->GetNodePenalty(from) + mesh_->GetNodePenalty(to));
+    }
+    return cost;
+}
+
+void DStarLite::UpdateAround(int node) {
+    UpdateVertex(node);
+    for (const auto& edge : mesh_->GetNeighbors(node)) {
+        UpdateVertex(edge.targetNodeId);
+    }
+}
+
+DStarLite::Key DStarLite::CalculateKey(int node) const {
+    float best = std::min(g_[node], rhs_[node]);
+    return {best + Heuristic(start_, node) + km_, best};
+}
+
+void DStarLite::UpdateVertex(int node) {
+    if (node != goal_) {
+        float best = INFINITE_COST;
+        for (const auto& edge : mesh_->GetNeighbors(node)) {
+            best = std::min(best, EdgeCost(node, edge.targetNodeId, edge.cost) + g_[edge.targetNodeId]);
+        }
+        rhs_[node] = best;
+    }
+    if (g_[node] != rhs_[node]) {
+        Key key = CalculateKey(node);
+        openKey_[node] = key;
+        inOpen_[node] = 1;
+        open_.push({key, node});
+    } else {
+        inOpen_[node] = 0;
+    }
+}
+
+DStarLite::Key DStarLite::TopKey() {
+    while (!open_.empty()) {
+        const auto& [key, node] = open_.top();
+        if (inOpen_[node] && key == openKey_[node]) {
+            return key;
+        }
+        open_.pop();
+    }
+    return {INFINITE_COST, INFINITE_COST};
+}
+
+bool DStarLite::ComputeShortestPath() {
+    lastExpansions_ = 0;
+    while (TopKey() < CalculateKey(start_) || rhs_[start_] != g_[start_]) {
+        if (open_.empty()) break;
+        auto [oldKey, node] = open_.top();
+        open_.pop();
+        lastExpansions_++;
+
+        Key newKey = CalculateKey(node);
+        if (oldKey < newKey) {
+            openKey_[node] = newKey;
+            open_.push({newKey, node});
+        } else if (g_[node] > rhs_[node]) {
+            // Overconsistent: settle and relax the predecessors
+            g_[node] = rhs_[node];
+            inOpen_[node] = 0;
+            for (const auto& edge : mesh_->GetNeighbors(node)) {
+                UpdateVertex(edge.targetNodeId);
+            }
+        } else {
+            // Underconsistent: the node got worse, so do its dependants
+            g_[node] = INFINITE_COST;
+            UpdateVertex(node);
+            for (const auto& edge : mesh_->GetNeighbors(node)) {
+                UpdateVertex(edge.targetNodeId);
+            }
+        }
+    }
+    totalExpansions_ += lastExpansions_;
+    return g_[start_] != INFINITE_COST;
+}
+
+// =============================================================================
+// ROUTES
+// =============================================================================
+
+bool DStarLite::Plan(int startNodeId, int goalNodeId) {
+    const size_t numNodes = mesh_ ? mesh_->GetAllNodes().size() : 0;
+    if (startNodeId < 0 || goalNodeId < 0 ||
+        static_cast<size_t>(startNodeId) >= numNodes || static_cast<size_t>(goalNodeId) >= numNodes) {
+        goal_ = -1;
+        return false;
+    }
+
+    start_ = startNodeId;
+    goal_ = goalNodeId;
+    km_ = 0.0f;
+    g_.assign(numNodes, INFINITE_COST);
+    rhs_.assign(numNodes, INFINITE_COST);
+    openKey_.assign(numNodes, Key{INFINITE_COST, INFINITE_COST});
+    inOpen_.assign(numNodes, 0);
+    open_ = {};
+
+    rhs_[goal_] = 0.0f;
+    UpdateVertex(goal_);
+    return ComputeShortestPath();
+}
+
+bool DStarLite::MoveStart(int startNodeId) {
+    if (!HasPlan() || startNodeId < 0 || static_cast<size_t>(startNodeId) >= g_.size()) {
+        return false;
+    }
+    if (startNodeId != start_) {
+        // Queued keys are relative to the old start: shift them all at once
+        int oldStart = start_;
+        km_ += Heuristic(oldStart, startNodeId);
+        start_ = startNodeId;
+
+        // Edges of a blocked start only counted while the robot stood there
+        if (mesh_->IsNodeBlocked(oldStart)) UpdateAround(oldStart);
+        if (mesh_->IsNodeBlocked(startNodeId)) UpdateAround(startNodeId);
+    }
+    return ComputeShortestPath();
+}
+
+bool DStarLite::NotifyChanged(const std::vector<int>& changedNodeIds) {
+    if (!HasPlan()) {
+        return false;
+    }
+
+    // A node's blocked state changes the cost of every edge touching it
+    for (int node : changedNodeIds) {
+        if (node < 0 || static_cast<size_t>(node) >= g_.size()) continue;
+        UpdateAround(node);
+    }
+    return ComputeShortestPath();
+}
+
+std::vector<int> DStarLite::GetRoute() const {
+    std::vector<int> route;
+    if (!HasPlan() || g_[start_] == INFINITE_COST) {
+        return route;
+    }
+
+    route.push_back(start_);
+    for (int node = start_; node != goal_ && route.size() <= g_.size();) {
+        int next = -1;
+        float best = INFINITE_COST;
+        for (const auto& edge : mesh_->GetNeighbors(node)) {
+            float through = EdgeCost(node, edge.targetNodeId, edge.cost) + g_[edge.targetNodeId];
+            if (through < best) {
+                best = through;
+                next = edge.targetNodeId;
+            }
+        }
+        if (next < 0) {
+            route.clear();
+            break;
+        }
+        route.push_back(next);
+        node = next;
+    }
+    return route;
+}
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
@@ -0,0 +1,172 @@
+/**
+ * @file FlowField.cc
+ * @brief Implementation of the goal flow field
+ */
+
+#include "Pathfinding/FlowField.hh"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+namespace {
+
+// Directions N, NE, E, SE, S, SW, W, NW: straight ones are even, the
+// components of diagonal d are d - 1 and d + 1 (mod 8)
+constexpr int DX[] = {0, 1, 1, 1, 0, -1, -1, -1};
+constexpr int DY[] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+inline bool IsDiagonal(int direction) { return (direction & 1) != 0; }
+inline int Opposite(int direction) { return (direction + 4) & 7; }
+
+} // namespace
+
+// =============================================================================
+// CONSTRUCTOR
+// =============================================================================
+
+FlowField::FlowField(const Backend::Layer1::InflatedBitMap& safetyMap,
+                     const Backend::Common::Coordinates& goal)
+    : safetyMap_(&safetyMap)
+    , goal_(goal)
+    , gridStep_(ThetaStarSolver::GridStep(safetyMap.GetResolution())) {
+    auto [width, height] = safetyMap.GetDimensions();
+    columns_ = (width + gridStep_ - 1) / gridStep_;
+    rows_ = (height + gridStep_ - 1) / gridStep_;
+    stride_ = columns_ + 2;
+
+    free_.assign(static_cast<size_t>(stride_) * (rows_ + 2), 0);
+    for (int row = 0; row < rows_; ++row) {
+        for (int column = 0; column < columns_; ++column) {
+            Backend::Common::Coordinates pixel{column * gridStep_, row * gridStep_};
+            free_[CellAt(column, row)] = safetyMap.IsAccessible(pixel) ? 1 : 0;
+        }
+    }
+
+    for (int d = 0; d < DIRECTIONS; ++d) {
+        offset_[d] = DY[d] * stride_ + DX[d];
+    }
+
+    goalCell_ = CellOf(goal);
+    Integrate();
+}
+
+int32_t FlowField::CellOf(const Backend::Common::Coordinates& point) const {
+    int column = std::clamp(point.x / gridStep_, 0, columns_ - 1);
+    int row = std::clamp(point.y / gridStep_, 0, rows_ - 1);
+    return CellAt(column, row);
+}
+
+bool FlowField::CanStep(int32_t cell, int direction) const {
+    if (!free_[cell + offset_[direction]]) return false;
+    if (!IsDiagonal(direction)) return true;
+    return free_[cell + offset_[(direction + 7) & 7]] && free_[cell + offset_[(direction + 1) & 7]];
+}
+
+// =============================================================================
+// FIELDS
+// =============================================================================
+
+void FlowField::Integrate() {
+    distance_.assign(free_.size(), UNREACHABLE);
+    direction_.assign(free_.size(), NO_DIRECTION);
+    if (!free_[goalCell_]) {
+        return;
+    }
+
+    // Moves are symmetric, so searching out from the goal gives every
+    // cell's distance to it; the step back is the way there
+    const float straightCost = static_cast<float>(gridStep_);
+    const float diagonalCost = static_cast<float>(gridStep_ * std::sqrt(2.0));
+    using Entry = std::pair<float, int32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    distance_[goalCell_] = 0.0f;
+    open.push({0.0f, goalCell_});
+    while (!open.empty()) {
+        auto [d, cell] = open.top();
+        open.pop();
+        if (d > distance_[cell]) continue;
+        for (int dir = 0; dir < DIRECTIONS; ++dir) {
+            if (!CanStep(cell, dir)) continue;
+            int32_t next = cell + offset_[dir];
+            float through = d + (IsDiagonal(dir) ? diagonalCost : straightCost);
+            if (through < distance_[next]) {
+                distance_[next] = through;
+                direction_[next] = static_cast<uint8_t>(Opposite(dir));
+                open.push({through, next});
+            }
+        }
+    }
+}
+
+bool FlowField::GetNextStep(const Backend::Common::Coordinates& point, Backend::Common::Coordinates& next) const {
+    int32_t cell = CellOf(point);
+    uint8_t dir = direction_[cell];
+    if (dir == NO_DIRECTION) {
+        return false;
+    }
+    int32_t to = cell + offset_[dir];
+    next = {ColumnOf(to) * gridStep_, RowOf(to) * gridStep_};
+    return true;
+}
+
+PathResult FlowField::ComputePath(const Backend::Common::Coordinates& start,
+                                  const Backend::Common::Coordinates& end) const {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    PathResult result;
+    result.success = false;
+    result.pathLength = 0.0;
+    result.nodesExpanded = 0;
+    result.computeTimeMs = 0.0;
+
+    int32_t cell = CellOf(start);
+    if (distance_[cell] == UNREACHABLE || CellOf(end) != goalCell_) {
+        return result;
+    }
+
+    auto finish = [&]() {
+        auto endTime = std::chrono::high_resolution_clock::now();
+        result.computeTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+        return result;
+    };
+
+    // Direct line of sight between the snapped ends, as JumpPointSolver
+    const int startX = ColumnOf(cell) * gridStep_;
+    const int startY = RowOf(cell) * gridStep_;
+    const int endX = ColumnOf(goalCell_) * gridStep_;
+    const int endY = RowOf(goalCell_) * gridStep_;
+    if (smoother_.HasLineOfSight(startX, startY, endX, endY, *safetyMap_)) {
+        result.path.push_back({startX, startY});
+        result.path.push_back({endX, endY});
+        smoother_.AttachEndpoints(result.path, start, end, *safetyMap_);
+        result.success = true;
+        result.pathLength = std::hypot(endX - startX, endY - startY);
+        result.nodesExpanded = 1;
+        return finish();
+    }
+    result.pathLength = distance_[cell];
+
+    std::vector<Backend::Common::Coordinates> path;
+    path.push_back({startX, startY});
+    while (cell != goalCell_) {
+        cell += offset_[direction_[cell]];
+        path.push_back({ColumnOf(cell) * gridStep_, RowOf(cell) * gridStep_});
+        result.nodesExpanded++;
+    }
+    smoother_.AttachEndpoints(path, start, end, *safetyMap_);
+
+    result.path = smoother_.SimplifyPath(path, *safetyMap_);
+    result.success = true;
+    return finish();
+}
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
@@ -0,0 +1,336 @@
+/**
+ * @file JumpPointSolver.cc
+ * @brief Implementation of Jump Point Search (JPS / JPS+)
+ */
+
+#include "Pathfinding/JumpPointSolver.hh"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+namespace {
+
+// Directions N, NE, E, SE, S, SW, W, NW: straight ones are even, the
+// components of diagonal d are d - 1 and d + 1 (mod 8)
+constexpr int DX[] = {0, 1, 1, 1, 0, -1, -1, -1};
+constexpr int DY[] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+// Direction index of (dx, dy) at [(dy + 1) * 3 + (dx + 1)]
+constexpr int DIRECTION_OF[] = {7, 0, 1, 6, -1, 2, 5, 4, 3};
+
+inline bool IsDiagonal(int direction) { return (direction & 1) != 0; }
+inline int Turn(int direction, int eighths) { return (direction + eighths) & 7; }
+inline int Sign(int value) { return (value > 0) - (value < 0); }
+
+} // namespace
+
+// =============================================================================
+// CONSTRUCTOR
+// =============================================================================
+
+JumpPointSolver::JumpPointSolver(const Backend::Layer1::InflatedBitMap& safetyMap, JumpPointMode mode)
+    : mode_(mode)
+    , safetyMap_(&safetyMap)
+    , gridStep_(ThetaStarSolver::GridStep(safetyMap.GetResolution())) {
+    auto [width, height] = safetyMap.GetDimensions();
+    columns_ = (width + gridStep_ - 1) / gridStep_;
+    rows_ = (height + gridStep_ - 1) / gridStep_;
+    stride_ = columns_ + 2;
+
+    free_.assign(static_cast<size_t>(stride_) * (rows_ + 2), 0);
+    for (int row = 0; row < rows_; ++row) {
+        for (int column = 0; column < columns_; ++column) {
+            Backend::Common::Coordinates pixel{column * gridStep_, row * gridStep_};
+            free_[CellAt(column, row)] = safetyMap.IsAccessible(pixel) ? 1 : 0;
+        }
+    }
+
+    for (int d = 0; d < DIRECTIONS; ++d) {
+        offset_[d] = DY[d] * stride_ + DX[d];
+    }
+
+    if (mode_ == JumpPointMode::PRECOMPUTED) {
+        if (std::max(columns_, rows_) > std::numeric_limits<int16_t>::max()) {
+            throw std::invalid_argument("JumpPointSolver: lattice too large for precomputed jumps");
+        }
+        BuildJumpDistances();
+    }
+}
+
+// =============================================================================
+// JUMP TABLES (JPS+)
+// =============================================================================
+
+void JumpPointSolver::BuildJumpDistances() {
+    const int32_t cells = static_cast<int32_t>(free_.size());
+    jumpDistance_.assign(static_cast<size_t>(cells) * DIRECTIONS, 0);
+    auto distance = [this](int32_t cell, int direction) -> int16_t& {
+        return jumpDistance_[static_cast<size_t>(cell) * DIRECTIONS + direction];
+    };
+
+    // Each cell continues the entry of its neighbour in the direction, so
+    // visit cells against it; diagonals build on the straight entries
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int d = pass; d < DIRECTIONS; d += 2) {
+            const bool descending = offset_[d] > 0;
+            for (int32_t i = 0; i < cells; ++i) {
+                int32_t cell = descending ? cells - 1 - i : i;
+                if (!free_[cell]) continue;
+
+                int32_t next = cell + offset_[d];
+                bool stepOk = IsDiagonal(d) ? CanStepDiagonal(cell, d) : free_[next] != 0;
+                if (!stepOk) {
+                    distance(cell, d) = 0;
+                    continue;
+                }
+
+                bool jumpPoint = IsDiagonal(d)
+                    ? (distance(next, Turn(d, -1)) > 0 || distance(next, Turn(d, 1)) > 0)
+                    : HasForcedNeighbor(next, d);
+                if (jumpPoint) {
+                    distance(cell, d) = 1;
+                } else {
+                    int16_t beyond = distance(next, d);
+                    distance(cell, d) = static_cast<int16_t>(beyond > 0 ? beyond + 1 : beyond - 1);
+                }
+            }
+        }
+    }
+}
+
+// =============================================================================
+// MOVES AND PRUNING
+// =============================================================================
+
+bool JumpPointSolver::HasForcedNeighbor(int32_t cell, int direction) const {
+    // A side cell is forced when the cell beside the one we came from is
+    // blocked: no path through the predecessor reaches it as cheaply
+    for (int turn : {2, -2}) {
+        int32_t side = cell + offset_[Turn(direction, turn)];
+        if (free_[side] && !free_[side - offset_[direction]]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JumpPointSolver::CanStepDiagonal(int32_t cell, int direction) const {
+    return free_[cell + offset_[direction]] &&
+           free_[cell + offset_[Turn(direction, -1)]] &&
+           free_[cell + offset_[Turn(direction, 1)]];
+}
+
+int32_t JumpPointSolver::Jump(int32_t cell, int direction, int32_t goal) const {
+    if (!IsDiagonal(direction)) {
+        while (true) {
+            cell += offset_[direction];
+            if (!free_[cell]) return -1;
+            if (cell == goal || HasForcedNeighbor(cell, direction)) return cell;
+        }
+    }
+
+    // Diagonal: stop where a straight component finds a jump point
+    while (true) {
+        if (!CanStepDiagonal(cell, direction)) return -1;
+        cell += offset_[direction];
+        if (cell == goal ||
+            Jump(cell, Turn(direction, -1), goal) >= 0 ||
+            Jump(cell, Turn(direction, 1), goal) >= 0) {
+            return cell;
+        }
+    }
+}
+
+int JumpPointSolver::SuccessorDirections(int32_t cell, int direction,
+                                         std::array<int, DIRECTIONS>& out) const {
+    int count = 0;
+    if (direction < 0) {
+        for (int d = 0; d < DIRECTIONS; ++d) out[count++] = d;
+        return count;
+    }
+
+    out[count++] = direction;
+    if (IsDiagonal(direction)) {
+        out[count++] = Turn(direction, -1);
+        out[count++] = Turn(direction, 1);
+        return count;
+    }
+
+    // Straight: forced sides, and the diagonal between them and the move
+    for (int turn : {2, -2}) {
+        int side = Turn(direction, turn);
+        int32_t sideCell = cell + offset_[side];
+        if (free_[sideCell] && !free_[sideCell - offset_[direction]]) {
+            out[count++] = side;
+            out[count++] = Turn(direction, turn / 2);
+        }
+    }
+    return count;
+}
+
+double JumpPointSolver::Octile(int32_t a, int32_t b) const {
+    int dx = std::abs(ColumnOf(a) - ColumnOf(b));
+    int dy = std::abs(RowOf(a) - RowOf(b));
+    return gridStep_ * (std::max(dx, dy) + (std::sqrt(2.0) - 1.0) * std::min(dx, dy));
+}
+
+// =============================================================================
+// MAIN PATHFINDING
+// =============================================================================
+
+PathResult JumpPointSolver::ComputePath(
+    const Backend::Common::Coordinates& start,
+    const Backend::Common::Coordinates& end
+) const {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    PathResult result;
+    result.success = false;
+    result.pathLength = 0.0;
+    result.nodesExpanded = 0;
+    result.computeTimeMs = 0.0;
+
+    // Snap to the lattice (clamped to the map)
+    auto cellOf = [this](const Backend::Common::Coordinates& point) {
+        int column = std::clamp(point.x / gridStep_, 0, columns_ - 1);
+        int row = std::clamp(point.y / gridStep_, 0, rows_ - 1);
+        return CellAt(column, row);
+    };
+    const int32_t startCell = cellOf(start);
+    const int32_t goalCell = cellOf(end);
+
+    if (!free_[startCell]) {
+        std::cerr << "[JumpPoint] Start position is not accessible: "
+                  << start.x << ", " << start.y << "\n";
+        return result;
+    }
+    if (!free_[goalCell]) {
+        std::cerr << "[JumpPoint] End position is not accessible: "
+                  << end.x << ", " << end.y << "\n";
+        return result;
+    }
+
+    auto finish = [&]() {
+        auto endTime = std::chrono::high_resolution_clock::now();
+        result.computeTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+        return result;
+    };
+
+    // Trivial case: direct line of sight between the snapped ends
+    const int startX = ColumnOf(startCell) * gridStep_;
+    const int startY = RowOf(startCell) * gridStep_;
+    const int endX = ColumnOf(goalCell) * gridStep_;
+    const int endY = RowOf(goalCell) * gridStep_;
+    if (smoother_.HasLineOfSight(startX, startY, endX, endY, *safetyMap_)) {
+        result.path.push_back({startX, startY});
+        result.path.push_back({endX, endY});
+        smoother_.AttachEndpoints(result.path, start, end, *safetyMap_);
+        result.success = true;
+        result.pathLength = std::hypot(endX - startX, endY - startY);
+        result.nodesExpanded = 1;
+        return finish();
+    }
+
+    thread_local ThetaStarSolver::SearchWorkspace workspace;
+    workspace.Begin(stride_, rows_ + 2);
+    workspace.Reach(startCell, 0.0, Octile(startCell, goalCell), startCell);
+    workspace.PushOrDecrease(startCell);
+
+    const int goalColumn = ColumnOf(goalCell);
+    const int goalRow = RowOf(goalCell);
+    std::array<int, DIRECTIONS> directions;
+
+    while (!workspace.heap_.empty()) {
+        int32_t current = workspace.PopMin();
+        result.nodesExpanded++;
+
+        if (current == goalCell) {
+            std::vector<Backend::Common::Coordinates> path;
+            for (int32_t cell = current;; cell = workspace.parent_[cell]) {
+                path.push_back({ColumnOf(cell) * gridStep_, RowOf(cell) * gridStep_});
+                if (workspace.parent_[cell] == cell) break;
+            }
+            std::reverse(path.begin(), path.end());
+            smoother_.AttachEndpoints(path, start, end, *safetyMap_);
+
+            result.path = smoother_.SimplifyPath(path, *safetyMap_);
+            result.success = true;
+            result.pathLength = workspace.gCost_[current];
+            return finish();
+        }
+
+        // Direction current was reached in (-1 at the start)
+        int32_t parent = workspace.parent_[current];
+        int arrival = -1;
+        if (parent != current) {
+            int dx = Sign(ColumnOf(current) - ColumnOf(parent));
+            int dy = Sign(RowOf(current) - RowOf(parent));
+            arrival = DIRECTION_OF[(dy + 1) * 3 + (dx + 1)];
+        }
+
+        const int column = ColumnOf(current);
+        const int row = RowOf(current);
+        int count = SuccessorDirections(current, arrival, directions);
+        for (int i = 0; i < count; ++i) {
+            const int d = directions[i];
+            int32_t successor = -1;
+
+            if (mode_ == JumpPointMode::ONLINE) {
+                successor = Jump(current, d, goalCell);
+            } else {
+                // JPS+: the table jump, or the goal / the cell aligned with
+                // it when that comes first
+                int reach = jumpDistance_[static_cast<size_t>(current) * DIRECTIONS + d];
+                int toColumn = goalColumn - column;
+                int toRow = goalRow - row;
+                int steps = 0;
+                if (IsDiagonal(d)) {
+                    if (Sign(toColumn) == DX[d] && Sign(toRow) == DY[d]) {
+                        steps = std::min(std::abs(toColumn), std::abs(toRow));
+                    }
+                } else if (DX[d] == 0 ? (toColumn == 0 && Sign(toRow) == DY[d])
+                                      : (toRow == 0 && Sign(toColumn) == DX[d])) {
+                    steps = std::abs(toColumn) + std::abs(toRow);
+                }
+
+                if (steps > 0 && steps <= std::abs(reach)) {
+                    successor = current + steps * offset_[d];
+                } else if (reach > 0) {
+                    successor = current + reach * offset_[d];
+                }
+            }
+
+            if (successor < 0 || workspace.IsClosed(successor)) {
+                continue;
+            }
+
+            double tentativeG = workspace.gCost_[current] + Octile(current, successor);
+            double fCost = tentativeG + Octile(successor, goalCell);
+            if (!workspace.IsReached(successor)) {
+                workspace.Reach(successor, tentativeG, fCost, current);
+                workspace.PushOrDecrease(successor);
+            } else if (tentativeG < workspace.gCost_[successor]) {
+                workspace.gCost_[successor] = tentativeG;
+                workspace.fCost_[successor] = fCost;
+                workspace.parent_[successor] = current;
+                workspace.PushOrDecrease(successor);
+            }
+        }
+    }
+
+    std::cerr << "[JumpPoint] No path found from (" << startX << "," << startY
+              << ") to (" << endX << "," << endY << ")\n";
+    return finish();
+}
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
@@ -0,0 +1,284 @@
+/**
+ * @file MultiAgentPlanner.cc
+ * @brief Implementation of the windowed cooperative planner
+ */
+
+#include "Pathfinding/MultiAgentPlanner.hh"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+MultiAgentPlanner::MultiAgentPlanner(const Backend::Layer1::NavMesh& navMesh,
+                                     const MultiAgentConfig& config)
+    : mesh_(navMesh)
+    , config_(config)
+    , expansions_(0) {
+    if (config_.windowTicks <= 0 || config_.tickSeconds <= 0.0 || config_.speed <= 0.0) {
+        throw std::invalid_argument("MultiAgentPlanner: window, tick and speed must be positive");
+    }
+    IndexMesh();
+}
+
+int MultiAgentPlanner::EdgeTicks(float cost) const {
+    double ticks = std::ceil(cost / (config_.speed * config_.tickSeconds));
+    return std::max(1, static_cast<int>(ticks));
+}
+
+void MultiAgentPlanner::IndexMesh() {
+    const int numNodes = static_cast<int>(mesh_.GetAllNodes().size());
+
+    reverseOffsets_.assign(numNodes + 1, 0);
+    for (int u = 0; u < numNodes; ++u) {
+        for (const auto& edge : mesh_.GetNeighbors(u)) {
+            reverseOffsets_[edge.targetNodeId + 1]++;
+        }
+    }
+    for (int v = 0; v < numNodes; ++v) {
+        reverseOffsets_[v + 1] += reverseOffsets_[v];
+    }
+
+    reverseSources_.resize(reverseOffsets_[numNodes]);
+    reverseTicks_.resize(reverseOffsets_[numNodes]);
+    std::vector<int> fill(reverseOffsets_.begin(), reverseOffsets_.end() - 1);
+    for (int u = 0; u < numNodes; ++u) {
+        for (const auto& edge : mesh_.GetNeighbors(u)) {
+            int slot = fill[edge.targetNodeId]++;
+            reverseSources_[slot] = u;
+            reverseTicks_[slot] = EdgeTicks(edge.cost);
+        }
+    }
+
+    // Footprints: walk the graph outwards while nodes stay within the clearance
+    const auto& nodes = mesh_.GetAllNodes();
+    const double clearance2 = config_.clearance * config_.clearance;
+    footprintOffsets_.assign(1, 0);
+    footprintNodes_.clear();
+    std::vector<int> seenBy(numNodes, -1);
+    std::vector<int> frontier;
+    for (int n = 0; n < numNodes; ++n) {
+        seenBy[n] = n;
+        frontier.assign(1, n);
+        while (!frontier.empty()) {
+            int u = frontier.back();
+            frontier.pop_back();
+            for (const auto& edge : mesh_.GetNeighbors(u)) {
+                int v = edge.targetNodeId;
+                if (seenBy[v] == n) continue;
+                seenBy[v] = n;
+                double dx = nodes[v].coords.x - nodes[n].coords.x;
+                double dy = nodes[v].coords.y - nodes[n].coords.y;
+                if (dx * dx + dy * dy < clearance2) {
+                    footprintNodes_.push_back(v);
+                    frontier.push_back(v);
+                }
+            }
+        }
+        footprintOffsets_.push_back(static_cast<int>(footprintNodes_.size()));
+    }
+    
+    goalDistances_.clear();
+}
+
+void MultiAgentPlanner::Hold(int nodeId, int tick, int robotId) {
+    reservations_.Reserve(nodeId, tick, robotId);
+    for (int slot = footprintOffsets_[nodeId]; slot < footprintOffsets_[nodeId + 1]; ++slot) {
+        reservations_.Reserve(footprintNodes_[slot], tick, robotId);
+    }
+}
+
+const std::vector<int>& MultiAgentPlanner::DistancesTo(int goalNodeId) {
+    auto it = goalDistances_.find(goalNodeId);
+    if (it != goalDistances_.end()) {
+        return it->second;
+    }
+    if (goalDistances_.size() >= MAX_CACHED_GOALS) {
+        goalDistances_.clear();
+    }
+
+    const int numNodes = static_cast<int>(reverseOffsets_.size()) - 1;
+    std::vector<int>& dist = goalDistances_[goalNodeId];
+    dist.assign(numNodes, UNREACHABLE);
+
+    // Dijkstra over incoming edges: dist[n] = ticks from n to the goal
+    using PQEntry = std::pair<int, int>;
+    std::priority_queue<PQEntry, std::vector<PQEntry>, std::greater<PQEntry>> open;
+    dist[goalNodeId] = 0;
+    open.push({0, goalNodeId});
+    while (!open.empty()) {
+        auto [d, v] = open.top();
+        open.pop();
+        if (d > dist[v]) continue;
+        for (int slot = reverseOffsets_[v]; slot < reverseOffsets_[v + 1]; ++slot) {
+            int u = reverseSources_[slot];
+            int du = d + reverseTicks_[slot];
+            if (dist[u] == UNREACHABLE || du < dist[u]) {
+                dist[u] = du;
+                open.push({du, u});
+            }
+        }
+    }
+    return dist;
+}
+
+// =============================================================================
+// SPACE-TIME SEARCH
+// =============================================================================
+
+bool MultiAgentPlanner::SearchWindow(const MultiAgentQuery& query, MultiAgentPlan& plan) {
+    const int window = config_.windowTicks;
+    const int robot = query.robotId;
+    const int goal = query.goalNodeId;
+    const std::vector<int>& dist = DistancesTo(goal);
+    if (dist[query.startNodeId] == UNREACHABLE) {
+        plan.reachable = false;
+        return false;
+    }
+
+    struct State {
+        int node;
+        int tick;
+        int parent;     ///< Index in states, -1 for the start
+    };
+    std::vector<State> states;
+    std::unordered_map<uint64_t, int> stateIndex;   ///< (node, tick clamped to the window) -> states
+    auto key = [window](int node, int tick) {
+        return static_cast<uint64_t>(node) * static_cast<uint64_t>(window + 1) + std::min(tick, window);
+    };
+
+    // (f, -tick, state): lowest f first, later ticks first among equals
+    using OpenEntry = std::tuple<int, int, int>;
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> open;
+    std::vector<bool> closed;
+
+    auto push = [&](int node, int tick, int parent) {
+        uint64_t k = key(node, tick);
+        if (stateIndex.count(k)) return;
+        int index = static_cast<int>(states.size());
+        stateIndex.emplace(k, index);
+        states.push_back({node, tick, parent});
+        closed.push_back(false);
+        open.push({tick + dist[node], -tick, index});
+    };
+
+    push(query.startNodeId, 0, -1);
+    int terminal = -1;
+    int expansions = 0;
+
+    while (!open.empty() && expansions < config_.maxExpansions) {
+        int index = std::get<2>(open.top());
+        open.pop();
+        if (closed[index]) continue;
+        closed[index] = true;
+        expansions++;
+
+        const State state = states[index];
+        if (state.node == goal && reservations_.IsFree(goal, state.tick, window, robot)) {
+            plan.reachesGoal = true;
+            terminal = index;
+            break;
+        }
+        if (state.tick >= window) {
+            terminal = index;
+            break;
+        }
+
+        // Wait a tick
+        if (reservations_.IsFree(state.node, state.tick + 1, robot)) {
+            push(state.node, state.tick + 1, index);
+        }
+
+        // Take an edge: both endpoints are held while it is traversed
+        for (const auto& edge : mesh_.GetNeighbors(state.node)) {
+            int next = edge.targetNodeId;
+            if (dist[next] == UNREACHABLE || mesh_.IsEdgeBlocked(state.node, next)) continue;
+            int arrival = state.tick + EdgeTicks(edge.cost);
+            int last = std::min(arrival, window);
+            if (reservations_.IsFree(state.node, state.tick + 1, last, robot) &&
+                reservations_.IsFree(next, state.tick, last, robot)) {
+                push(next, arrival, index);
+            }
+        }
+    }
+    expansions_ += static_cast<uint64_t>(expansions);
+    if (terminal < 0) {
+        return false;
+    }
+
+    // Walk back, keeping only the first and last step of every wait
+    std::vector<int> chain;
+    for (int i = terminal; i >= 0; i = states[i].parent) {
+        chain.push_back(i);
+    }
+    std::reverse(chain.begin(), chain.end());
+    for (size_t i = 0; i < chain.size(); ++i) {
+        const State& state = states[chain[i]];
+        bool waitContinues = i >= 1 && i + 1 < chain.size() &&
+                             states[chain[i - 1]].node == state.node &&
+                             states[chain[i + 1]].node == state.node;
+        if (!waitContinues) {
+            plan.nodes.push_back(state.node);
+            plan.ticks.push_back(state.tick);
+        }
+    }
+    return true;
+}
+
+void MultiAgentPlanner::ReservePlan(const MultiAgentPlan& plan) {
+    const int window = config_.windowTicks;
+    for (size_t i = 0; i + 1 < plan.nodes.size(); ++i) {
+        int last = std::min(plan.ticks[i + 1], window);
+        for (int tick = plan.ticks[i]; tick <= last; ++tick) {
+            Hold(plan.nodes[i], tick, plan.robotId);
+            Hold(plan.nodes[i + 1], tick, plan.robotId);
+        }
+    }
+    // The robot stays where the plan ends until the window closes
+    for (int tick = plan.ticks.back(); tick <= window; ++tick) {
+        Hold(plan.nodes.back(), tick, plan.robotId);
+    }
+}
+
+// =============================================================================
+// PLANNING
+// =============================================================================
+
+std::vector<MultiAgentPlan> MultiAgentPlanner::Plan(const std::vector<MultiAgentQuery>& queries) {
+    const int window = config_.windowTicks;
+    reservations_.Clear();
+    expansions_ = 0;
+
+    // Robots keep their node until they have had a chance to leave it;
+    // robots without a goal keep it for the whole window
+    for (const auto& query : queries) {
+        int hold = query.goalNodeId < 0 ? window : 1;
+        for (int tick = 0; tick <= hold; ++tick) {
+            reservations_.Reserve(query.startNodeId, tick, query.robotId);
+        }
+    }
+
+    std::vector<MultiAgentPlan> plans(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const auto& query = queries[i];
+        MultiAgentPlan& plan = plans[i];
+        plan.robotId = query.robotId;
+
+        if (query.goalNodeId < 0 || !SearchWindow(query, plan)) {
+            plan.nodes.assign({query.startNodeId, query.startNodeId});
+            plan.ticks.assign({0, window});
+            plan.reachesGoal = query.goalNodeId == query.startNodeId;
+        }
+        ReservePlan(plan);
+    }
+    return plans;
+}
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
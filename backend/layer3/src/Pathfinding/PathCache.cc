@@ -0,0 +1,140 @@
+/**
+ * @file PathCache.cc
+ * @brief Implementation of the sharded LRU path cache
+ */
+
+#include "Pathfinding/PathCache.hh"
+#include "MemoryUsage.hh"
+#include <algorithm>
+#include <stdexcept>
+
+namespace Backend {
+namespace Layer3 {
+namespace Pathfinding {
+
+PathCache::PathCache(size_t capacity, int tileSize)
+    : shardCapacity_(std::max<size_t>(1, (capacity + SHARD_COUNT - 1) / SHARD_COUNT))
+    , tileSize_(tileSize) {
+    if (tileSize <= 0) {
+        throw std::invalid_argument("PathCache: tile size must be positive");
+    }
+}
+
+uint64_t PathCache::MakeKey(const Backend::Common::Coordinates& start,
+                            const Backend::Common::Coordinates& end) const {
+    // 16 bits per tile coordinate (maps up to 65536 tiles a side);
+    // truncating division matches the solver's snapping
+    auto tile = [this](int coordinate) {
+        return static_cast<uint64_t>(static_cast<uint16_t>(coordinate / tileSize_));
+    };
+    return (tile(start.x) << 48) | (tile(start.y) << 32) | (tile(end.x) << 16) | tile(end.y);
+}
+
+PathCache::Shard& PathCache::ShardFor(uint64_t key) {
+    // Mix both tiles so legs from one start spread over the shards
+    uint64_t h = key * 0x9E3779B97F4A7C15ull;
+    return shards_[(h >> 32) % SHARD_COUNT];
+}
+
+void PathCache::SyncVersion(Shard& shard, uint64_t version) {
+    if (shard.version == version) return;
+    shard.lru.clear();
+    shard.index.clear();
+    shard.version = version;
+}
+
+bool PathCache::Find(const Backend::Common::Coordinates& start,
+                     const Backend::Common::Coordinates& end,
+                     uint64_t version, PathResult& result) {
+    uint64_t key = MakeKey(start, end);
+    Shard& shard = ShardFor(key);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    SyncVersion(shard, version);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        return false;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    result = it->second->second;
+    return true;
+}
+
+void PathCache::Insert(const Backend::Common::Coordinates& start,
+                       const Backend::Common::Coordinates& end,
+                       uint64_t version, const PathResult& result) {
+    uint64_t key = MakeKey(start, end);
+    Shard& shard = ShardFor(key);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    SyncVersion(shard, version);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        // Recomputed meanwhile (another thread, or the stored path did not fit)
+        it->second->second = result;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    if (shard.lru.size() >= shardCapacity_) {
+        shard.index.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+    }
+    shard.lru.emplace_front(key, result);
+    shard.index.emplace(key, shard.lru.begin());
+}
+
+void PathCache::Clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.lru.clear();
+        shard.index.clear();
+    }
+}
+
+void PathCache::RecordHit(double savedMs) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    savedMicroseconds_.fetch_add(static_cast<uint64_t>(std::max(savedMs, 0.0) * 1000.0),
+                                 std::memory_order_relaxed);
+}
+
+size_t PathCache::GetSize() {
+    size_t total = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.lru.size();
+    }
+    return total;
+}
+
+size_t PathCache::GetMemoryBytes() {
+    const size_t nodeBytes = sizeof(std::pair<uint64_t, PathResult>) + 2 * sizeof(void*);
+    size_t bytes = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        bytes += shard.lru.size() * nodeBytes + Backend::Common::HashMapBytes(shard.index);
+        for (const auto& entry : shard.lru) {
+            bytes += Backend::Common::VectorBytes(entry.second.path);
+        }
+    }
+    return bytes;
+}
+
+double PathCache::GetHitRate() const {
+    uint64_t hits = GetHits();
+    uint64_t total = hits + GetMisses();
+    return total > 0 ? static_cast<double>(hits) / total : 0.0;
+}
+
+void PathCache::ResetStats() {
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+    savedMicroseconds_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace Pathfinding
+} // namespace Layer3
+} // namespace Backend
@@ -1,57 +1,223 @@
 /**
  * @file PathfindingService.cc
- * @brief Implementation of the pathfinding service singleton
+ * @brief Implementation of the pathfinding service
  */
 
 #include "Pathfinding/PathfindingService.hh"
+#include "Trace.hh"
+#include "MemoryUsage.hh"
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 
 namespace Backend {
 namespace Layer3 {
 namespace Pathfinding {
 
-// =============================================================================
-// STATIC MEMBERS
-// =============================================================================
-
-PathfindingService* PathfindingService::instance_ = nullptr;
-std::mutex PathfindingService::instanceMutex_;
-
 // =============================================================================
 // CONSTRUCTOR
 // =============================================================================
 
 PathfindingService::PathfindingService()
-    : safetyMap_(nullptr)
-    , nextRequestId_(1) {}
+    : stopping_(false)
+    , algorithm_(PathAlgorithm::THETA_STAR)
+    , safetyMap_(nullptr)
+    , corridorFallbacks_(0)
+    , flowFieldPaths_(0)
+    , nextRequestId_(1)
+    , requestsSuperseded_(0)
+    , requestsExpired_(0) {}
+
+PathfindingService::~PathfindingService() {
+    StopWorkers();
+    ClearQueue();
+}
 
 // =============================================================================
-// SINGLETON ACCESS
+// INITIALIZATION
 // =============================================================================
 
-PathfindingService& PathfindingService::GetInstance() {
-    std::lock_guard<std::mutex> lock(instanceMutex_);
-    if (instance_ == nullptr) {
-        instance_ = new PathfindingService();
+void PathfindingService::Initialize(const Backend::Layer1::InflatedBitMap& safetyMap) {
+    safetyMap_ = &safetyMap;
+    PrepareAlgorithm();
+    ClearFlowFields();
+    std::cout << "[PathfindingService] Initialized with safety map\n";
+}
+
+void PathfindingService::SetAlgorithm(PathAlgorithm algorithm) {
+    algorithm_ = algorithm;
+    PrepareAlgorithm();
+}
+
+void PathfindingService::PrepareAlgorithm() {
+    if (algorithm_ == PathAlgorithm::THETA_STAR || safetyMap_ == nullptr) {
+        jumpPointSolver_.reset();
+        return;
+    }
+    
+    JumpPointMode mode = (algorithm_ == PathAlgorithm::JPS_PLUS)
+        ? JumpPointMode::PRECOMPUTED
+        : JumpPointMode::ONLINE;
+    jumpPointSolver_ = std::make_unique<JumpPointSolver>(*safetyMap_, mode);
+}
+
+void PathfindingService::EnablePathCache(size_t capacity) {
+    if (capacity == 0) {
+        pathCache_.reset();
+        return;
+    }
+    auto resolution = safetyMap_ ? safetyMap_->GetResolution() : Backend::Common::Resolution::DECIMETERS;
+    pathCache_ = std::make_unique<PathCache>(capacity, ThetaStarSolver::GridStep(resolution));
+}
+
+void PathfindingService::EnableCorridorPlanning(const Backend::Layer1::NavMesh& navMesh, int marginTiles) {
+    corridorPlanner_ = std::make_unique<CorridorPlanner>(navMesh, marginTiles);
+}
+
+void PathfindingService::AddFlowFieldGoal(const Backend::Common::Coordinates& goal) {
+    if (!safetyMap_ || FlowFieldFor(goal)) {
+        return;
+    }
+    uint64_t version = mapVersion_ ? mapVersion_() : 0;
+    auto field = std::make_shared<const FlowField>(*safetyMap_, goal);
+    
+    std::lock_guard<std::mutex> lock(flowFieldMutex_);
+    flowFields_.push_back({goal, version, std::move(field)});
+}
+
+void PathfindingService::SetFlowFieldGoals(const std::vector<Backend::Common::Coordinates>& goals) {
+    if (!safetyMap_) {
+        return;
     }
-    return *instance_;
+    auto covers = [](const std::vector<FlowFieldEntry>& entries, const Backend::Common::Coordinates& goal) {
+        return std::find_if(entries.begin(), entries.end(), [&goal](const FlowFieldEntry& entry) {
+            return entry.field->HasGoalCell(goal);
+        });
+    };
+    
+    std::vector<FlowFieldEntry> kept;
+    {
+        std::lock_guard<std::mutex> lock(flowFieldMutex_);
+        for (const auto& goal : goals) {
+            auto it = covers(flowFields_, goal);
+            if (it != flowFields_.end() && covers(kept, goal) == kept.end()) {
+                kept.push_back(*it);
+            }
+        }
+    }
+    
+    // New fields are built without holding up the workers
+    uint64_t version = mapVersion_ ? mapVersion_() : 0;
+    for (const auto& goal : goals) {
+        if (covers(kept, goal) == kept.end()) {
+            kept.push_back({goal, version, std::make_shared<const FlowField>(*safetyMap_, goal)});
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(flowFieldMutex_);
+    flowFields_ = std::move(kept);
+}
+
+void PathfindingService::ClearFlowFields() {
+    std::lock_guard<std::mutex> lock(flowFieldMutex_);
+    flowFields_.clear();
+}
+
+size_t PathfindingService::GetFlowFieldCount() const {
+    std::lock_guard<std::mutex> lock(flowFieldMutex_);
+    return flowFields_.size();
 }
 
-void PathfindingService::DestroyInstance() {
-    std::lock_guard<std::mutex> lock(instanceMutex_);
-    if (instance_ != nullptr) {
-        delete instance_;
-        instance_ = nullptr;
+std::shared_ptr<const FlowField> PathfindingService::FlowFieldFor(const Backend::Common::Coordinates& end) {
+    std::unique_lock<std::mutex> lock(flowFieldMutex_);
+    auto it = std::find_if(flowFields_.begin(), flowFields_.end(),
+                           [&end](const FlowFieldEntry& entry) { return entry.field->HasGoalCell(end); });
+    if (it == flowFields_.end()) {
+        return nullptr;
     }
+    
+    uint64_t version = mapVersion_ ? mapVersion_() : 0;
+    if (it->version == version) {
+        return it->field;
+    }
+    
+    // Rebuild without holding up the other workers; whoever finishes
+    // first installs theirs
+    Backend::Common::Coordinates goal = it->goal;
+    lock.unlock();
+    auto field = std::make_shared<const FlowField>(*safetyMap_, goal);
+    lock.lock();
+    for (auto& entry : flowFields_) {
+        if (entry.field->HasGoalCell(end)) {
+            if (entry.version != version) {
+                entry.version = version;
+                entry.field = std::move(field);
+            }
+            return entry.field;
+        }
+    }
+    return nullptr;
 }
 
 // =============================================================================
-// INITIALIZATION
+// WORKER THREADS
 // =============================================================================
 
-void PathfindingService::Initialize(const Backend::Layer1::InflatedBitMap& safetyMap) {
-    safetyMap_ = &safetyMap;
-    std::cout << "[PathfindingService] Initialized with safety map\n";
+void PathfindingService::StartWorkers(size_t threads, std::function<void()> onWorkerStart) {
+    if (!workers_.empty()) {
+        return;
+    }
+    
+    stopping_ = false;
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, onWorkerStart]() {
+            if (onWorkerStart) onWorkerStart();
+            WorkerLoop();
+        });
+    }
+    std::cout << "[PathfindingService] Started " << threads << " worker thread(s)\n";
+}
+
+void PathfindingService::StopWorkers() {
+    if (workers_.empty()) {
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+    }
+    queueReady_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+    
+    // Nobody takes what is left: fail it so RequestPathSync callers and
+    // drivers waiting on a callback do not wait forever
+    ClearQueue();
+}
+
+void PathfindingService::WorkerLoop() {
+    TRACE_THREAD_NAME("PathWorker");
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueReady_.wait(lock, [this] {
+                if (stopping_) return true;
+                for (const auto& queue : requestQueues_) {
+                    if (!queue.empty()) return true;
+                }
+                return false;
+            });
+            if (stopping_) {
+                return;
+            }
+        }
+        
+        // Another worker may take the request first: then this is a no-op
+        ProcessNextRequest();
+    }
 }
 
 // =============================================================================
@@ -61,57 +227,93 @@ void PathfindingService::Initialize(const Backend::Layer1::InflatedBitMap& safet
 int PathfindingService::RequestPath(
     const Backend::Common::Coordinates& start,
     const Backend::Common::Coordinates& end,
-    PathCallback callback
+    PathCallback callback,
+    const PathRequestOptions& options
 ) {
     if (!IsInitialized()) {
         std::cerr << "[PathfindingService] ERROR: Not initialized!\n";
         if (callback) {
-            PathResult empty;
-            empty.success = false;
-            callback(empty);
+            callback(FailedResult());
         }
         return -1;
     }
     
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    
     PathRequest request;
-    request.requestId = nextRequestId_++;
     request.start = start;
     request.end = end;
     request.callback = callback;
     request.promise = nullptr;
+    request.priority = options.priority;
+    request.ownerId = options.ownerId;
+    request.deadline = std::chrono::steady_clock::time_point::max();
+    if (options.maxWait.count() > 0) {
+        request.deadline = std::chrono::steady_clock::now() + options.maxWait;
+    }
     
-    requestQueue_.push_back(request);
+    return Enqueue(std::move(request));
+}
+
+int PathfindingService::RequestItinerary(
+    const Backend::Common::Coordinates& start,
+    const std::vector<Backend::Common::Coordinates>& goals,
+    ItineraryCallback callback,
+    const PathRequestOptions& options
+) {
+    if (!IsInitialized()) {
+        std::cerr << "[PathfindingService] ERROR: Not initialized!\n";
+    }
+    if (!IsInitialized() || goals.empty()) {
+        if (callback) {
+            callback(ItineraryResult());
+        }
+        return -1;
+    }
     
-    return request.requestId;
+    PathRequest request;
+    request.start = start;
+    request.end = goals.front();
+    request.legEnds.assign(goals.begin() + 1, goals.end());
+    request.callback = nullptr;
+    request.itineraryCallback = std::move(callback);
+    request.promise = nullptr;
+    request.priority = options.priority;
+    request.ownerId = options.ownerId;
+    request.deadline = std::chrono::steady_clock::time_point::max();
+    if (options.maxWait.count() > 0) {
+        request.deadline = std::chrono::steady_clock::now() + options.maxWait;
+    }
+    
+    return Enqueue(std::move(request));
 }
 
 PathResult PathfindingService::RequestPathSync(
     const Backend::Common::Coordinates& start,
-    const Backend::Common::Coordinates& end
+    const Backend::Common::Coordinates& end,
+    const PathRequestOptions& options
 ) {
     if (!IsInitialized()) {
         std::cerr << "[PathfindingService] ERROR: Not initialized!\n";
-        PathResult empty;
-        empty.success = false;
-        return empty;
+        return FailedResult();
     }
     
     std::promise<PathResult> promise;
     std::future<PathResult> future = promise.get_future();
     
-    {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        
-        PathRequest request;
-        request.requestId = nextRequestId_++;
-        request.start = start;
-        request.end = end;
-        request.callback = nullptr;
-        request.promise = &promise;
-        
-        requestQueue_.push_back(request);
+    PathRequest request;
+    request.start = start;
+    request.end = end;
+    request.callback = nullptr;
+    request.promise = &promise;
+    request.priority = options.priority;
+    request.ownerId = options.ownerId;
+    request.deadline = std::chrono::steady_clock::time_point::max();
+    if (options.maxWait.count() > 0) {
+        request.deadline = std::chrono::steady_clock::now() + options.maxWait;
+    }
+    Enqueue(std::move(request));
+    
+    if (HasWorkers()) {
+        return future.get();
     }
     
     // Process until our request is done
@@ -132,18 +334,226 @@ PathResult PathfindingService::RequestPathSync(
     return future.get();
 }
 
+int PathfindingService::Enqueue(PathRequest request) {
+    std::vector<PathRequest> superseded;
+    int requestId;
+    {
+        Backend::Common::TracedLockGuard<std::mutex> lock(queueMutex_, "Wait path queue");
+        
+        // Coalesce: the owner's newer request replaces its queued one
+        if (request.ownerId >= 0) {
+            for (auto& queue : requestQueues_) {
+                for (auto it = queue.begin(); it != queue.end();) {
+                    if (Supersedes(request, *it)) {
+                        superseded.push_back(std::move(*it));
+                        it = queue.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            requestsSuperseded_ += static_cast<int>(superseded.size());
+        }
+        
+        request.requestId = nextRequestId_++;
+        requestId = request.requestId;
+        requestQueues_[static_cast<size_t>(request.priority)].push_back(std::move(request));
+    }
+    queueReady_.notify_one();
+    
+    for (auto& dropped : superseded) {
+        Complete(dropped, FailedResult());
+    }
+    return requestId;
+}
+
+bool PathfindingService::Supersedes(const PathRequest& first, const PathRequest& second) {
+    // A prefetch never drops the path a robot is waiting for, nor the
+    // other way round
+    return first.ownerId == second.ownerId &&
+           (first.priority == PathPriority::PREFETCH) == (second.priority == PathPriority::PREFETCH);
+}
+
+void PathfindingService::Complete(PathRequest& request, const PathResult& result) {
+    if (request.callback) {
+        request.callback(result);
+    }
+    
+    if (request.itineraryCallback) {
+        request.itineraryCallback(ItineraryResult());
+    }
+    
+    if (request.promise) {
+        request.promise->set_value(result);
+    }
+}
+
+PathResult PathfindingService::FailedResult() {
+    PathResult result;
+    result.success = false;
+    result.pathLength = 0.0;
+    result.nodesExpanded = 0;
+    result.computeTimeMs = 0.0;
+    return result;
+}
+
+bool PathfindingService::CancelRequest(int requestId) {
+    PathRequest cancelled;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        for (auto& queue : requestQueues_) {
+            for (auto it = queue.begin(); it != queue.end(); ++it) {
+                if (it->requestId == requestId) {
+                    cancelled = std::move(*it);
+                    queue.erase(it);
+                    found = true;
+                    break;
+                }
+            }
+            if (found) break;
+        }
+    }
+    
+    if (found) {
+        Complete(cancelled, FailedResult());
+    }
+    return found;
+}
+
+int PathfindingService::CancelRequestsOf(int ownerId) {
+    std::vector<PathRequest> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        for (auto& queue : requestQueues_) {
+            for (auto it = queue.begin(); it != queue.end();) {
+                if (it->ownerId == ownerId) {
+                    cancelled.push_back(std::move(*it));
+                    it = queue.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+    
+    for (auto& request : cancelled) {
+        Complete(request, FailedResult());
+    }
+    return static_cast<int>(cancelled.size());
+}
+
 PathResult PathfindingService::ComputePathImmediate(
     const Backend::Common::Coordinates& start,
     const Backend::Common::Coordinates& end
 ) {
     if (!IsInitialized()) {
         std::cerr << "[PathfindingService] ERROR: Not initialized!\n";
-        PathResult empty;
-        empty.success = false;
-        return empty;
+        return FailedResult();
     }
     
-    return solver_.ComputePath(start, end, *safetyMap_);
+    return Solve(start, end);
+}
+
+PathResult PathfindingService::Solve(
+    const Backend::Common::Coordinates& start,
+    const Backend::Common::Coordinates& end
+) {
+    TRACE_ZONE("PathQuery", "layer3");
+    auto queryStart = Backend::Common::LatencyHistogram::Clock::now();
+    PathResult result = FindPath(start, end);
+    queryLatency_.RecordSince(queryStart);
+    return result;
+}
+
+PathResult PathfindingService::FindPath(
+    const Backend::Common::Coordinates& start,
+    const Backend::Common::Coordinates& end
+) {
+    // Busy goals: follow the field (starts it does not reach, e.g. off
+    // the lattice's free cells, are left to the search)
+    if (auto field = FlowFieldFor(end)) {
+        PathResult result = field->ComputePath(start, end);
+        if (result.success) {
+            flowFieldPaths_.fetch_add(1, std::memory_order_relaxed);
+            return result;
+        }
+    }
+    
+    if (!pathCache_) {
+        return Search(start, end);
+    }
+    
+    auto lookupStart = std::chrono::high_resolution_clock::now();
+    uint64_t version = mapVersion_ ? mapVersion_() : 0;
+    
+    // A stored path was smoothed for other points of the same tiles: it
+    // fits if the exact endpoints still see the inner waypoints
+    PathResult cached;
+    if (pathCache_->Find(start, end, version, cached)) {
+        auto& path = cached.path;
+        path.front() = start;
+        path.back() = end;
+        const auto& first = path[1];
+        const auto& last = path[path.size() - 2];
+        if (solver_.HasLineOfSight(start.x, start.y, first.x, first.y, *safetyMap_) &&
+            solver_.HasLineOfSight(last.x, last.y, end.x, end.y, *safetyMap_)) {
+            pathCache_->RecordHit(cached.computeTimeMs);
+            cached.nodesExpanded = 0;
+            auto lookupEnd = std::chrono::high_resolution_clock::now();
+            cached.computeTimeMs = std::chrono::duration<double, std::milli>(lookupEnd - lookupStart).count();
+            return cached;
+        }
+    }
+    pathCache_->RecordMiss();
+    
+    PathResult result = Search(start, end);
+    if (result.success) {
+        pathCache_->Insert(start, end, version, result);
+    }
+    return result;
+}
+
+PathResult PathfindingService::Search(
+    const Backend::Common::Coordinates& start,
+    const Backend::Common::Coordinates& end
+) {
+    if (jumpPointSolver_) {
+        return jumpPointSolver_->ComputePath(start, end);
+    }
+    if (!corridorPlanner_) {
+        return solver_.ComputePath(start, end, *safetyMap_);
+    }
+    
+    TRACE_ZONE("ThetaStarSearch", "layer3");
+    auto searchStart = std::chrono::high_resolution_clock::now();
+    thread_local ThetaStarSolver::SearchWorkspace workspace;
+    thread_local ThetaStarSolver::SearchCorridor corridor;
+    
+    int settled = 0;
+    std::vector<int> route = corridorPlanner_->FindRoute(start, end, &settled);
+    
+    PathResult result = FailedResult();
+    if (!route.empty()) {
+        auto [width, height] = safetyMap_->GetDimensions();
+        corridorPlanner_->BuildCorridor(route, start, end,
+                                        static_cast<int>(width), static_cast<int>(height),
+                                        ThetaStarSolver::GridStep(safetyMap_->GetResolution()), corridor);
+        result = solver_.ComputePath(start, end, *safetyMap_, workspace, &corridor);
+    }
+    
+    // The mesh only keeps whole free tiles: the grid may connect the
+    // endpoints where the route or its corridor does not
+    if (!result.success) {
+        corridorFallbacks_.fetch_add(1, std::memory_order_relaxed);
+        result = solver_.ComputePath(start, end, *safetyMap_, workspace);
+    }
+    
+    // Count and time both levels
+    result.nodesExpanded += settled;
+    auto searchEnd = std::chrono::high_resolution_clock::now();
+    result.computeTimeMs = std::chrono::duration<double, std::milli>(searchEnd - searchStart).count();
+    return result;
 }
 
 // =============================================================================
@@ -152,31 +562,78 @@ PathResult PathfindingService::ComputePathImmediate(
 
 bool PathfindingService::ProcessNextRequest() {
     PathRequest request;
+    bool found = false;
+    std::vector<PathRequest> expired;
     
     {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        if (requestQueue_.empty()) {
-            return false;
+        Backend::Common::TracedLockGuard<std::mutex> lock(queueMutex_, "Wait path queue");
+        const auto now = std::chrono::steady_clock::now();
+        
+        for (auto& queue : requestQueues_) {
+            // Requests past their deadline are no longer worth a worker
+            for (auto it = queue.begin(); it != queue.end();) {
+                if (it->deadline < now) {
+                    expired.push_back(std::move(*it));
+                    it = queue.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            if (found || queue.empty()) {
+                continue;
+            }
+            
+            // Most urgent class: earliest deadline, then oldest (smallest id)
+            auto next = queue.begin();
+            for (auto it = std::next(queue.begin()); it != queue.end(); ++it) {
+                if (it->deadline < next->deadline ||
+                    (it->deadline == next->deadline && it->requestId < next->requestId)) {
+                    next = it;
+                }
+            }
+            request = std::move(*next);
+            queue.erase(next);
+            found = true;
         }
-        request = requestQueue_.front();
-        requestQueue_.pop_front();
+        requestsExpired_ += static_cast<int>(expired.size());
     }
     
-    // Compute path
-    PathResult result = solver_.ComputePath(request.start, request.end, *safetyMap_);
-    
-    // Invoke callback or set promise
-    if (request.callback) {
-        request.callback(result);
+    for (auto& dropped : expired) {
+        Complete(dropped, FailedResult());
+    }
+    if (!found) {
+        return !expired.empty();
     }
     
-    if (request.promise) {
-        request.promise->set_value(result);
+    if (request.itineraryCallback) {
+        ItineraryResult itinerary = SolveItinerary(request);
+        request.itineraryCallback(itinerary);
+        return true;
     }
     
+    // Compute path
+    PathResult result = Solve(request.start, request.end);
+    Complete(request, result);
+    
     return true;
 }
 
+ItineraryResult PathfindingService::SolveItinerary(const PathRequest& request) {
+    ItineraryResult itinerary;
+    itinerary.mapVersion = GetMapVersion();
+    itinerary.legs.reserve(request.legEnds.size() + 1);
+    
+    // Back to back on this thread: every leg reuses the workspace the
+    // previous one sized, and a leg starts where the last one ended
+    itinerary.legs.push_back(Solve(request.start, request.end));
+    Backend::Common::Coordinates from = request.end;
+    for (const auto& to : request.legEnds) {
+        itinerary.legs.push_back(Solve(from, to));
+        from = to;
+    }
+    return itinerary;
+}
+
 int PathfindingService::ProcessAllRequests() {
     int count = 0;
     while (ProcessNextRequest()) {
@@ -185,14 +642,57 @@ int PathfindingService::ProcessAllRequests() {
     return count;
 }
 
+size_t PathfindingService::GetMemoryBytes() const {
+    size_t bytes = jumpPointSolver_ ? jumpPointSolver_->GetMemoryBytes() : 0;
+    {
+        std::lock_guard<std::mutex> lock(flowFieldMutex_);
+        bytes += Backend::Common::VectorBytes(flowFields_);
+        for (const auto& entry : flowFields_) bytes += entry.field->GetMemoryBytes();
+    }
+    if (pathCache_) bytes += pathCache_->GetMemoryBytes();
+    
+    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(queueMutex_));
+    for (const auto& queue : requestQueues_) {
+        bytes += queue.size() * sizeof(PathRequest);
+        for (const auto& request : queue) bytes += Backend::Common::VectorBytes(request.legEnds);
+    }
+    return bytes;
+}
+
 size_t PathfindingService::GetQueueSize() const {
     std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(queueMutex_));
-    return requestQueue_.size();
+    size_t size = 0;
+    for (const auto& queue : requestQueues_) {
+        size += queue.size();
+    }
+    return size;
 }
 
 void PathfindingService::ClearQueue() {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    requestQueue_.clear();
+    std::vector<PathRequest> cleared;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        for (auto& queue : requestQueues_) {
+            for (auto& request : queue) {
+                cleared.push_back(std::move(request));
+            }
+            queue.clear();
+        }
+    }
+    
+    for (auto& request : cleared) {
+        Complete(request, FailedResult());
+    }
+}
+
+int PathfindingService::GetRequestsSuperseded() const {
+    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(queueMutex_));
+    return requestsSuperseded_;
+}
+
+int PathfindingService::GetRequestsExpired() const {
+    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(queueMutex_));
+    return requestsExpired_;
 }
 
 } // namespace Pathfinding
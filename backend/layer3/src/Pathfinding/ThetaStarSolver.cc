@@ -4,14 +4,211 @@
  */
 
 #include "Pathfinding/ThetaStarSolver.hh"
+#include "GridView.hh"
+#include "MemoryUsage.hh"
 #include <chrono>
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 namespace Backend {
 namespace Layer3 {
 namespace Pathfinding {
 
+namespace {
+
+/**
+ * @brief Line-of-sight test on an inflated map, set up once per search.
+ * 
+ * A cell is accessible when its clearance exceeds the inflation radius
+ * (and it is outside the border band). Every cell of a Bresenham segment
+ * lies within half the segment length (plus rounding) of an endpoint, and
+ * clearance drops by at most the distance moved, so if both endpoints
+ * clear the radius by more than that the whole segment is free. The
+ * border band is a frame, so cells of a segment between two accessible
+ * endpoints are never in it. Otherwise the packed grid is walked run by run.
+ */
+class SightTest {
+private:
+    Backend::Layer1::PackedGridView view_;
+    const int* clearanceSq_;    ///< nullptr: clearance field unavailable
+    int width_;
+    double radius_;
+    
+public:
+    explicit SightTest(const Backend::Layer1::InflatedBitMap& safetyMap)
+        : view_(safetyMap.GetRawData())
+        , clearanceSq_(nullptr)
+        , width_(view_.Width())
+        , radius_(safetyMap.GetInflationRadiusPixels()) {
+        const std::vector<int>& field = safetyMap.GetClearanceField();
+        if (field.size() == static_cast<size_t>(view_.Width()) * view_.Height()) {
+            clearanceSq_ = field.data();
+        }
+    }
+    
+    bool operator()(int x1, int y1, int x2, int y2) const {
+        if (clearanceSq_ && view_.IsFree(x1, y1) && view_.IsFree(x2, y2)) {
+            int nearSq = std::min(clearanceSq_[static_cast<size_t>(y1) * width_ + x1],
+                                  clearanceSq_[static_cast<size_t>(y2) * width_ + x2]);
+            if (nearSq == Backend::Layer1::InflatedBitMap::NO_OBSTACLE) return true;
+            
+            double dx = x2 - x1;
+            double dy = y2 - y1;
+            double reach = radius_ + 0.5 * std::sqrt(dx * dx + dy * dy) + 1.0;
+            if (nearSq > reach * reach) return true;
+        }
+        return Backend::Layer1::HasLineOfSight(view_, x1, y1, x2, y2);
+    }
+};
+
+} // namespace
+
+// =============================================================================
+// SEARCH WORKSPACE
+// =============================================================================
+
+std::atomic<size_t> ThetaStarSolver::SearchWorkspace::liveBytes_{0};
+
+ThetaStarSolver::SearchWorkspace::~SearchWorkspace() {
+    liveBytes_.fetch_sub(accountedBytes_, std::memory_order_relaxed);
+}
+
+size_t ThetaStarSolver::SearchWorkspace::GetMemoryBytes() const {
+    using Backend::Common::VectorBytes;
+    return VectorBytes(stamp_) + VectorBytes(gCost_) + VectorBytes(fCost_) +
+           VectorBytes(parent_) + VectorBytes(heapPosition_) + VectorBytes(heap_);
+}
+
+void ThetaStarSolver::SearchWorkspace::Begin(int columns, int rows) {
+    size_t nodes = static_cast<size_t>(columns) * rows;
+    if (columns != columns_ || rows != rows_) {
+        columns_ = columns;
+        rows_ = rows;
+        stamp_.assign(nodes, 0);
+        gCost_.resize(nodes);
+        fCost_.resize(nodes);
+        parent_.resize(nodes);
+        heapPosition_.resize(nodes);
+        generation_ = 0;
+    }
+    heap_.clear();
+    
+    size_t bytes = GetMemoryBytes();
+    if (bytes != accountedBytes_) {
+        liveBytes_.fetch_add(bytes - accountedBytes_, std::memory_order_relaxed);
+        accountedBytes_ = bytes;
+    }
+    
+    // Stamps from 2^32 searches ago would look current: clear them on wrap
+    if (++generation_ == 0) {
+        std::fill(stamp_.begin(), stamp_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+void ThetaStarSolver::SearchWorkspace::Reach(int32_t node, double gCost, double fCost, int32_t parent) {
+    stamp_[node] = generation_;
+    gCost_[node] = gCost;
+    fCost_[node] = fCost;
+    parent_[node] = parent;
+    heapPosition_[node] = NONE;
+}
+
+void ThetaStarSolver::SearchWorkspace::PushOrDecrease(int32_t node) {
+    if (heapPosition_[node] == NONE) {
+        heapPosition_[node] = static_cast<int32_t>(heap_.size());
+        heap_.push_back(node);
+    }
+    SiftUp(static_cast<size_t>(heapPosition_[node]));
+}
+
+int32_t ThetaStarSolver::SearchWorkspace::PopMin() {
+    int32_t top = heap_.front();
+    heapPosition_[top] = CLOSED;
+    
+    int32_t last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+        heap_[0] = last;
+        heapPosition_[last] = 0;
+        SiftDown(0);
+    }
+    return top;
+}
+
+void ThetaStarSolver::SearchWorkspace::SiftUp(size_t position) {
+    int32_t node = heap_[position];
+    double key = fCost_[node];
+    while (position > 0) {
+        size_t parent = (position - 1) / HEAP_ARITY;
+        if (fCost_[heap_[parent]] <= key) break;
+        heap_[position] = heap_[parent];
+        heapPosition_[heap_[position]] = static_cast<int32_t>(position);
+        position = parent;
+    }
+    heap_[position] = node;
+    heapPosition_[node] = static_cast<int32_t>(position);
+}
+
+void ThetaStarSolver::SearchWorkspace::SiftDown(size_t position) {
+    int32_t node = heap_[position];
+    double key = fCost_[node];
+    const size_t size = heap_.size();
+    while (true) {
+        size_t first = position * HEAP_ARITY + 1;
+        if (first >= size) break;
+        
+        size_t best = first;
+        size_t last = std::min(first + HEAP_ARITY, size);
+        for (size_t child = first + 1; child < last; ++child) {
+            if (fCost_[heap_[child]] < fCost_[heap_[best]]) best = child;
+        }
+        if (fCost_[heap_[best]] >= key) break;
+        
+        heap_[position] = heap_[best];
+        heapPosition_[heap_[position]] = static_cast<int32_t>(position);
+        position = best;
+    }
+    heap_[position] = node;
+    heapPosition_[node] = static_cast<int32_t>(position);
+}
+
+// =============================================================================
+// SEARCH CORRIDOR
+// =============================================================================
+
+void ThetaStarSolver::SearchCorridor::Reset(int width, int height, int step) {
+    int columns = (width + step - 1) / step;
+    int rows = (height + step - 1) / step;
+    if (step != step_ || columns != columns_ || rows != rows_) {
+        step_ = step;
+        columns_ = columns;
+        rows_ = rows;
+        stamp_.assign(static_cast<size_t>(columns) * rows, 0);
+        generation_ = 0;
+    }
+    
+    if (++generation_ == 0) {
+        std::fill(stamp_.begin(), stamp_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+void ThetaStarSolver::SearchCorridor::AddRect(int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) return;
+    
+    int firstColumn = std::max(0, x / step_);
+    int firstRow = std::max(0, y / step_);
+    int lastColumn = std::min(columns_ - 1, (x + w - 1) / step_);
+    int lastRow = std::min(rows_ - 1, (y + h - 1) / step_);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            stamp_[static_cast<size_t>(row) * columns_ + column] = generation_;
+        }
+    }
+}
+
 // =============================================================================
 // MAIN PATHFINDING
 // =============================================================================
@@ -20,6 +217,36 @@ PathResult ThetaStarSolver::ComputePath(
     const Backend::Common::Coordinates& start,
     const Backend::Common::Coordinates& end,
     const Backend::Layer1::InflatedBitMap& safetyMap
+) const {
+    thread_local SearchWorkspace workspace;
+    return ComputePath(start, end, safetyMap, workspace);
+}
+
+PathResult ThetaStarSolver::ComputePath(
+    const Backend::Common::Coordinates& start,
+    const Backend::Common::Coordinates& end,
+    const Backend::Layer1::InflatedBitMap& safetyMap,
+    SearchWorkspace& workspace,
+    const SearchCorridor* corridor
+) const {
+    // The one runtime branch on the resolution: the lattice step is a
+    // constant from here on
+    return Backend::Common::DispatchResolution(safetyMap.GetResolution(), [&](auto policy) {
+        constexpr int step = GridStep(decltype(policy)::RESOLUTION);
+        if (corridor && corridor->GetStep() != step) {
+            throw std::invalid_argument("ThetaStarSolver: corridor step does not match the map");
+        }
+        return Search<step>(start, end, safetyMap, workspace, corridor);
+    });
+}
+
+template <int STEP>
+PathResult ThetaStarSolver::Search(
+    const Backend::Common::Coordinates& start,
+    const Backend::Common::Coordinates& end,
+    const Backend::Layer1::InflatedBitMap& safetyMap,
+    SearchWorkspace& workspace,
+    const SearchCorridor* corridor
 ) const {
     auto startTime = std::chrono::high_resolution_clock::now();
     
@@ -33,10 +260,10 @@ PathResult ThetaStarSolver::ComputePath(
     auto [width, height] = safetyMap.GetDimensions();
     
     // Convert to grid coordinates
-    int startX = SnapToGrid(start.x);
-    int startY = SnapToGrid(start.y);
-    int endX = SnapToGrid(end.x);
-    int endY = SnapToGrid(end.y);
+    int startX = SnapToGrid<STEP>(start.x);
+    int startY = SnapToGrid<STEP>(start.y);
+    int endX = SnapToGrid<STEP>(end.x);
+    int endY = SnapToGrid<STEP>(end.y);
     
     // Clamp to map bounds
     startX = std::clamp(startX, 0, static_cast<int>(width - 1));
@@ -62,10 +289,14 @@ PathResult ThetaStarSolver::ComputePath(
         return result;
     }
     
+    const SightTest hasLineOfSight(safetyMap);
+    const bool lazy = (mode_ == ThetaStarMode::LAZY);
+    
     // Check for trivial case: direct line of sight
-    if (HasLineOfSight(startX, startY, endX, endY, safetyMap)) {
-        result.path.push_back(start);
-        result.path.push_back(end);
+    if (hasLineOfSight(startX, startY, endX, endY)) {
+        result.path.push_back(startCoord);
+        result.path.push_back(endCoord);
+        AttachEndpoints(result.path, start, end, safetyMap);
         result.success = true;
         result.pathLength = Heuristic(startX, startY, endX, endY);
         result.nodesExpanded = 1;
@@ -75,49 +306,67 @@ PathResult ThetaStarSolver::ComputePath(
         return result;
     }
     
-    // Priority queue (min-heap by fCost)
-    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> openSet;
+    // Search lattice: the start plus multiples of STEP, one node per cell
+    const int columns = (static_cast<int>(width) + STEP - 1) / STEP;
+    const int rows = (static_cast<int>(height) + STEP - 1) / STEP;
+    const int offsetX = startX % STEP;
+    const int offsetY = startY % STEP;
+    auto nodeOf = [columns](int x, int y) {
+        return static_cast<int32_t>((y / STEP) * columns + x / STEP);
+    };
+    auto xOf = [columns, offsetX](int32_t node) { return (node % columns) * STEP + offsetX; };
+    auto yOf = [columns, offsetY](int32_t node) { return (node / columns) * STEP + offsetY; };
     
-    // Maps for tracking
-    std::unordered_map<std::pair<int, int>, double, PairHash> gCosts;
-    std::unordered_map<std::pair<int, int>, std::pair<int, int>, PairHash> parents;
-    std::unordered_set<std::pair<int, int>, PairHash> closedSet;
+    workspace.Begin(columns, rows);
     
-    // Initialize start node
-    Node startNode;
-    startNode.x = startX;
-    startNode.y = startY;
-    startNode.gCost = 0.0;
-    startNode.fCost = Heuristic(startX, startY, endX, endY);
-    startNode.parentX = startX;
-    startNode.parentY = startY;
+    // Initialize start node (its own parent)
+    int32_t startNode = nodeOf(startX, startY);
+    workspace.Reach(startNode, 0.0, Heuristic(startX, startY, endX, endY), startNode);
+    workspace.PushOrDecrease(startNode);
     
-    openSet.push(startNode);
-    gCosts[{startX, startY}] = 0.0;
-    parents[{startX, startY}] = {startX, startY};
+    std::array<std::pair<int, int>, 8> neighbors;
     
     // A* main loop with Theta* modifications
-    while (!openSet.empty()) {
-        Node current = openSet.top();
-        openSet.pop();
-        
-        std::pair<int, int> currentKey = {current.x, current.y};
+    while (!workspace.heap_.empty()) {
+        int32_t current = workspace.PopMin();
+        int currentX = xOf(current);
+        int currentY = yOf(current);
+        int neighborCount = GetNeighbors<STEP>(currentX, currentY, safetyMap, neighbors);
+        result.nodesExpanded++;
         
-        // Skip if already processed
-        if (closedSet.count(currentKey)) {
-            continue;
+        // Lazy Theta*: verify the parent assumed visible when current was
+        // reached, else take the best path through an expanded neighbor
+        if (lazy) {
+            int32_t parent = workspace.parent_[current];
+            if (parent != current &&
+                !hasLineOfSight(xOf(parent), yOf(parent), currentX, currentY)) {
+                double bestG = std::numeric_limits<double>::infinity();
+                for (int i = 0; i < neighborCount; ++i) {
+                    auto [nx, ny] = neighbors[i];
+                    int32_t neighbor = nodeOf(nx, ny);
+                    if (!workspace.IsClosed(neighbor)) continue;
+                    
+                    double g = workspace.gCost_[neighbor] + Heuristic(nx, ny, currentX, currentY);
+                    if (g < bestG) {
+                        bestG = g;
+                        workspace.parent_[current] = neighbor;
+                    }
+                }
+                if (bestG < std::numeric_limits<double>::infinity()) {
+                    workspace.gCost_[current] = bestG;
+                }
+            }
         }
-        
-        closedSet.insert(currentKey);
-        result.nodesExpanded++;
+        double currentG = workspace.gCost_[current];
         
         // Goal check (with tolerance for grid snapping)
-        if (std::abs(current.x - endX) <= GRID_STEP && 
-            std::abs(current.y - endY) <= GRID_STEP) {
+        if (std::abs(currentX - endX) <= STEP && 
+            std::abs(currentY - endY) <= STEP) {
             // Reconstruct path
-            result.path = ReconstructPath(current.x, current.y, parents, start, end);
+            result.path = ReconstructPath<STEP>(current, offsetX, offsetY, workspace);
+            AttachEndpoints(result.path, start, end, safetyMap);
             result.success = true;
-            result.pathLength = gCosts[currentKey];
+            result.pathLength = currentG;
             
             // Simplify path for even smoother results
             result.path = SimplifyPath(result.path, safetyMap);
@@ -128,51 +377,48 @@ PathResult ThetaStarSolver::ComputePath(
         }
         
         // Get parent of current
-        auto parentIt = parents.find(currentKey);
-        int parentX = (parentIt != parents.end()) ? parentIt->second.first : current.x;
-        int parentY = (parentIt != parents.end()) ? parentIt->second.second : current.y;
+        int32_t parent = workspace.parent_[current];
+        int parentX = xOf(parent);
+        int parentY = yOf(parent);
+        double parentG = workspace.gCost_[parent];
         
         // Explore neighbors
-        auto neighbors = GetNeighbors(current.x, current.y, safetyMap);
-        
-        for (const auto& [nx, ny] : neighbors) {
-            std::pair<int, int> neighborKey = {nx, ny};
+        for (int i = 0; i < neighborCount; ++i) {
+            auto [nx, ny] = neighbors[i];
+            int32_t neighbor = nodeOf(nx, ny);
             
-            if (closedSet.count(neighborKey)) {
+            if (workspace.IsClosed(neighbor)) {
+                continue;
+            }
+            if (corridor && !corridor->ContainsCell(nx / STEP, ny / STEP)) {
                 continue;
             }
             
             // Theta* key innovation: check line-of-sight to grandparent
+            // (lazy mode assumes it and checks on expansion)
             double tentativeG;
-            int newParentX, newParentY;
+            int32_t newParent;
             
-            if (HasLineOfSight(parentX, parentY, nx, ny, safetyMap)) {
+            if (lazy || hasLineOfSight(parentX, parentY, nx, ny)) {
                 // Path 2: Direct path from grandparent (Theta* optimization)
-                tentativeG = gCosts[{parentX, parentY}] + Heuristic(parentX, parentY, nx, ny);
-                newParentX = parentX;
-                newParentY = parentY;
+                tentativeG = parentG + Heuristic(parentX, parentY, nx, ny);
+                newParent = parent;
             } else {
                 // Path 1: Standard A* (through current node)
-                tentativeG = current.gCost + Heuristic(current.x, current.y, nx, ny);
-                newParentX = current.x;
-                newParentY = current.y;
+                tentativeG = currentG + Heuristic(currentX, currentY, nx, ny);
+                newParent = current;
             }
             
-            // Check if this is a better path
-            auto gIt = gCosts.find(neighborKey);
-            if (gIt == gCosts.end() || tentativeG < gIt->second) {
-                gCosts[neighborKey] = tentativeG;
-                parents[neighborKey] = {newParentX, newParentY};
-                
-                Node neighborNode;
-                neighborNode.x = nx;
-                neighborNode.y = ny;
-                neighborNode.gCost = tentativeG;
-                neighborNode.fCost = tentativeG + Heuristic(nx, ny, endX, endY);
-                neighborNode.parentX = newParentX;
-                neighborNode.parentY = newParentY;
-                
-                openSet.push(neighborNode);
+            // Check if this is a better path (decrease-key if already open)
+            double fCost = tentativeG + Heuristic(nx, ny, endX, endY);
+            if (!workspace.IsReached(neighbor)) {
+                workspace.Reach(neighbor, tentativeG, fCost, newParent);
+                workspace.PushOrDecrease(neighbor);
+            } else if (tentativeG < workspace.gCost_[neighbor]) {
+                workspace.gCost_[neighbor] = tentativeG;
+                workspace.fCost_[neighbor] = fCost;
+                workspace.parent_[neighbor] = newParent;
+                workspace.PushOrDecrease(neighbor);
             }
         }
     }
@@ -181,8 +427,11 @@ PathResult ThetaStarSolver::ComputePath(
     auto endTime = std::chrono::high_resolution_clock::now();
     result.computeTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
     
-    std::cerr << "[ThetaStar] No path found from (" << startX << "," << startY 
-              << ") to (" << endX << "," << endY << ")\n";
+    // A corridor miss is the caller's to handle (typically a full search)
+    if (!corridor) {
+        std::cerr << "[ThetaStar] No path found from (" << startX << "," << startY 
+                  << ") to (" << endX << "," << endY << ")\n";
+    }
     
     return result;
 }
@@ -196,137 +445,88 @@ bool ThetaStarSolver::HasLineOfSight(
     int x2, int y2,
     const Backend::Layer1::InflatedBitMap& safetyMap
 ) const {
-    // Bresenham's line algorithm
-    int dx = std::abs(x2 - x1);
-    int dy = std::abs(y2 - y1);
-    int sx = (x1 < x2) ? 1 : -1;
-    int sy = (y1 < y2) ? 1 : -1;
-    int err = dx - dy;
-    
-    int x = x1;
-    int y = y1;
-    
-    while (true) {
-        // Check if current cell is accessible
-        Backend::Common::Coordinates coord{x, y};
-        if (!safetyMap.IsAccessible(coord)) {
-            return false;
-        }
-        
-        // Reached destination
-        if (x == x2 && y == y2) {
-            break;
-        }
-        
-        int e2 = 2 * err;
-        
-        if (e2 > -dy) {
-            err -= dy;
-            x += sx;
-        }
-        
-        if (e2 < dx) {
-            err += dx;
-            y += sy;
-        }
-    }
-    
-    return true;
+    return SightTest(safetyMap)(x1, y1, x2, y2);
 }
 
 // =============================================================================
 // NEIGHBOR GENERATION
 // =============================================================================
 
-std::vector<std::pair<int, int>> ThetaStarSolver::GetNeighbors(
+template <int STEP>
+int ThetaStarSolver::GetNeighbors(
     int x, int y,
-    const Backend::Layer1::InflatedBitMap& safetyMap
+    const Backend::Layer1::InflatedBitMap& safetyMap,
+    std::array<std::pair<int, int>, 8>& out
 ) const {
-    std::vector<std::pair<int, int>> neighbors;
-    neighbors.reserve(8);
+    int count = 0;
     
-    auto [width, height] = safetyMap.GetDimensions();
+    const Backend::Layer1::PackedGridView view(safetyMap.GetRawData());
+    const int width = view.Width();
+    const int height = view.Height();
     
     // 8-connected neighbors
     static const int dx[] = {-1, 0, 1, -1, 1, -1, 0, 1};
     static const int dy[] = {-1, -1, -1, 0, 0, 1, 1, 1};
     
     for (int i = 0; i < 8; ++i) {
-        int nx = x + dx[i] * GRID_STEP;
-        int ny = y + dy[i] * GRID_STEP;
+        int nx = x + dx[i] * STEP;
+        int ny = y + dy[i] * STEP;
         
         // Bounds check
-        if (nx < 0 || nx >= static_cast<int>(width) ||
-            ny < 0 || ny >= static_cast<int>(height)) {
+        if (nx < 0 || nx >= width ||
+            ny < 0 || ny >= height) {
             continue;
         }
         
-        // Accessibility check
-        Backend::Common::Coordinates coord{nx, ny};
-        if (safetyMap.IsAccessible(coord)) {
+        // Accessibility check (in bounds from here on; the corner cells
+        // below share one coordinate with (nx, ny), so they are too)
+        if (view.IsFreeUnchecked(nx, ny)) {
             // For diagonal moves, also check the two adjacent cells
             if (dx[i] != 0 && dy[i] != 0) {
                 // Diagonal move - check corner cutting
-                Backend::Common::Coordinates adj1{x + dx[i] * GRID_STEP, y};
-                Backend::Common::Coordinates adj2{x, y + dy[i] * GRID_STEP};
-                if (safetyMap.IsAccessible(adj1) && safetyMap.IsAccessible(adj2)) {
-                    neighbors.emplace_back(nx, ny);
+                if (view.IsFreeUnchecked(nx, y) && view.IsFreeUnchecked(x, ny)) {
+                    out[count++] = {nx, ny};
                 }
             } else {
-                neighbors.emplace_back(nx, ny);
+                out[count++] = {nx, ny};
             }
         }
     }
     
-    return neighbors;
+    return count;
 }
 
 // =============================================================================
 // PATH RECONSTRUCTION
 // =============================================================================
 
+template <int STEP>
 std::vector<Backend::Common::Coordinates> ThetaStarSolver::ReconstructPath(
-    int endX, int endY,
-    const std::unordered_map<std::pair<int, int>, std::pair<int, int>, PairHash>& parents,
-    const Backend::Common::Coordinates& start,
-    const Backend::Common::Coordinates& end
+    int32_t endNode,
+    int offsetX, int offsetY,
+    const SearchWorkspace& workspace
 ) const {
     std::vector<Backend::Common::Coordinates> path;
     
-    int x = endX;
-    int y = endY;
-    
-    // Trace back from end to start
+    // Trace back from end to start (the start is its own parent)
+    int32_t node = endNode;
     while (true) {
-        Backend::Common::Coordinates coord{x, y};
+        Backend::Common::Coordinates coord{
+            (node % workspace.columns_) * STEP + offsetX,
+            (node / workspace.columns_) * STEP + offsetY
+        };
         path.push_back(coord);
         
-        auto it = parents.find({x, y});
-        if (it == parents.end()) {
+        int32_t parent = workspace.parent_[node];
+        if (parent == node) {
             break;
         }
-        
-        int px = it->second.first;
-        int py = it->second.second;
-        
-        // Reached start
-        if (px == x && py == y) {
-            break;
-        }
-        
-        x = px;
-        y = py;
+        node = parent;
     }
     
     // Reverse to get start-to-end order
     std::reverse(path.begin(), path.end());
     
-    // Replace first and last with exact coordinates
-    if (!path.empty()) {
-        path.front() = start;
-        path.back() = end;
-    }
-    
     return path;
 }
 
@@ -342,6 +542,7 @@ std::vector<Backend::Common::Coordinates> ThetaStarSolver::SimplifyPath(
         return path;
     }
     
+    const SightTest hasLineOfSight(safetyMap);
     std::vector<Backend::Common::Coordinates> simplified;
     simplified.push_back(path.front());
     
@@ -352,12 +553,11 @@ std::vector<Backend::Common::Coordinates> ThetaStarSolver::SimplifyPath(
         size_t furthest = current + 1;
         
         for (size_t i = current + 2; i < path.size(); ++i) {
-            if (HasLineOfSight(
+            if (hasLineOfSight(
                 path[current].x,
                 path[current].y,
                 path[i].x,
-                path[i].y,
-                safetyMap
+                path[i].y
             )) {
                 furthest = i;
             }
@@ -370,6 +570,28 @@ std::vector<Backend::Common::Coordinates> ThetaStarSolver::SimplifyPath(
     return simplified;
 }
 
+void ThetaStarSolver::AttachEndpoints(
+    std::vector<Backend::Common::Coordinates>& path,
+    const Backend::Common::Coordinates& start,
+    const Backend::Common::Coordinates& end,
+    const Backend::Layer1::InflatedBitMap& safetyMap
+) const {
+    const SightTest hasLineOfSight(safetyMap);
+    
+    if (path.size() > 1 && hasLineOfSight(start.x, start.y, path[1].x, path[1].y)) {
+        path.front() = start;
+    } else if (path.empty() || !(path.front() == start)) {
+        path.insert(path.begin(), start);
+    }
+    
+    const size_t last = path.size() - 1;
+    if (last > 0 && hasLineOfSight(path[last - 1].x, path[last - 1].y, end.x, end.y)) {
+        path.back() = end;
+    } else if (!(path.back() == end)) {
+        path.push_back(end);
+    }
+}
+
 } // namespace Pathfinding
 } // namespace Layer3
 } // namespace Backend
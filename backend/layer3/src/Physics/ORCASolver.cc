@@ -5,7 +5,13 @@
 
 #include "Physics/ORCASolver.hh"
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace Backend {
 namespace Layer3 {
@@ -19,26 +25,49 @@ Vector2 ORCASolver::CalculateSafeVelocity(
     const ObstacleData& me,
     const std::vector<ObstacleData>& neighbors,
     const Vector2& preferredVelocity
+) const {
+    KinematicsStore& packed = buffers_.packed;
+    packed.Clear();
+    for (const auto& neighbor : neighbors) {
+        packed.Push(neighbor);
+    }
+    return CalculateSafeVelocity(me, packed, preferredVelocity);
+}
+
+Vector2 ORCASolver::CalculateSafeVelocity(
+    const ObstacleData& me,
+    const KinematicsStore& neighbors,
+    const Vector2& preferredVelocity
 ) const {
     // If no neighbors, return preferred velocity (clamped)
-    if (neighbors.empty()) {
+    if (neighbors.Empty()) {
         return ClampSpeed(preferredVelocity);
     }
+    if (config_.method == AvoidanceMethod::HALF_PLANES) {
+        return SolveHalfPlanes(me, neighbors, preferredVelocity);
+    }
+    const size_t count = neighbors.Size();
     
-    // Find closest obstacle
+    // Find closest obstacle ahead: one behind or beside cannot be run
+    // into, and must not hold a robot that is backing away from it. Nor
+    // can one ahead that the line of travel passes at least combined
+    // radius away: two robots side by side that both head slightly
+    // towards each other would otherwise stop each other for good
+    DistancePass(me, neighbors);
     double closestDistance = std::numeric_limits<double>::max();
     double closestCombinedRadius = 0.0;
-    int closestIdx = -1;
+    const Vector2 myPosition = me.GetPositionVec();
+    const double preferredSpeed = preferredVelocity.Magnitude();
     
-    for (size_t i = 0; i < neighbors.size(); ++i) {
-        double dist = me.DistanceTo(neighbors[i]);
-        double combinedR = me.CombinedRadius(neighbors[i]) + config_.safetyMargin;
-        double clearance = dist - combinedR;
+    for (size_t i = 0; i < count; ++i) {
+        Vector2 toNeighbor = Vector2(neighbors.X()[i], neighbors.Y()[i]) - myPosition;
+        if (toNeighbor.Dot(preferredVelocity) <= 0.0) continue;
+        if (std::abs(toNeighbor.Cross(preferredVelocity)) >= buffers_.combinedRadius[i] * preferredSpeed) continue;
+        double clearance = buffers_.distance[i] - buffers_.combinedRadius[i];
         
         if (clearance < closestDistance) {
             closestDistance = clearance;
-            closestCombinedRadius = combinedR;
-            closestIdx = static_cast<int>(i);
+            closestCombinedRadius = buffers_.combinedRadius[i];
         }
     }
     
@@ -58,21 +87,34 @@ Vector2 ORCASolver::CalculateSafeVelocity(
     }
     
     // PHASE 3: Apply Repulsion
-    // Push velocity away from nearby obstacles
-    velocity = ApplyRepulsion(me, neighbors, velocity);
+    // Push velocity away from nearby obstacles (summed in neighbor order)
+    RepulsionPass(me, neighbors);
+    Vector2 repulsionForce = Vector2::Zero();
+    for (size_t i = 0; i < count; ++i) {
+        if (buffers_.repulsionX[i] != 0.0 || buffers_.repulsionY[i] != 0.0) {
+            repulsionForce += Vector2(buffers_.repulsionX[i], buffers_.repulsionY[i]);
+        }
+    }
+    velocity = velocity + repulsionForce * config_.responsiveness;
     
     // PHASE 4: Check for future collisions
-    // If velocity would cause collision within time horizon, reduce further
-    for (const auto& neighbor : neighbors) {
-        if (WillCollide(me, neighbor, velocity, config_.timeHorizon)) {
-            // Reduce velocity towards obstacle
-            Vector2 toObstacle = neighbor.GetPositionVec() - me.GetPositionVec();
-            Vector2 toObstacleDir = toObstacle.Normalized();
-            
-            // Remove component towards obstacle
-            double dotProduct = velocity.Dot(toObstacleDir);
-            if (dotProduct > 0) {
-                velocity = velocity - toObstacleDir * (dotProduct * config_.responsiveness);
+    // If velocity would cause collision within time horizon, reduce further.
+    // Each reduction changes the velocity, so the later neighbors are checked
+    // again with the new one.
+    CollisionPass(me, neighbors, velocity, 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (!buffers_.collides[i]) continue;
+        
+        // Reduce velocity towards obstacle
+        Vector2 toObstacle = Vector2(neighbors.X()[i], neighbors.Y()[i]) - myPosition;
+        Vector2 toObstacleDir = toObstacle.Normalized();
+        
+        // Remove component towards obstacle
+        double dotProduct = velocity.Dot(toObstacleDir);
+        if (dotProduct > 0) {
+            velocity = velocity - toObstacleDir * (dotProduct * config_.responsiveness);
+            if (i + 1 < count) {
+                CollisionPass(me, neighbors, velocity, i + 1);
             }
         }
     }
@@ -82,101 +124,379 @@ Vector2 ORCASolver::CalculateSafeVelocity(
 }
 
 // =============================================================================
-// COLLISION DETECTION
+// HALF-PLANE SOLVER
 // =============================================================================
 
-double ORCASolver::FindClosestObstacleDistance(
+Vector2 ORCASolver::SolveHalfPlanes(
     const ObstacleData& me,
-    const std::vector<ObstacleData>& neighbors
+    const KinematicsStore& neighbors,
+    const Vector2& preferredVelocity
 ) const {
-    double closest = std::numeric_limits<double>::max();
+    const double invTimeHorizon = 1.0 / config_.timeHorizon;
+    const double invTimeStep = 1.0 / config_.timeStep;
+    const Vector2 myPos = me.GetPositionVec();
     
-    for (const auto& neighbor : neighbors) {
-        double dist = me.DistanceTo(neighbor);
-        double clearance = dist - me.CombinedRadius(neighbor);
-        closest = std::min(closest, clearance);
+    std::vector<HalfPlane>& lines = buffers_.halfPlanes;
+    lines.clear();
+    
+    for (size_t i = 0; i < neighbors.Size(); ++i) {
+        Vector2 neighborVelocity(neighbors.VX()[i], neighbors.VY()[i]);
+        Vector2 relativePosition = Vector2(neighbors.X()[i], neighbors.Y()[i]) - myPos;
+        Vector2 relativeVelocity = me.velocity - neighborVelocity;
+        double distSq = relativePosition.MagnitudeSquared();
+        double combinedRadius = me.radius + neighbors.Radius()[i] + config_.safetyMargin;
+        double combinedRadiusSq = combinedRadius * combinedRadius;
+        
+        HalfPlane line;
+        Vector2 u;
+        
+        if (distSq > combinedRadiusSq) {
+            // No collision yet: velocity obstacle is a cone truncated at
+            // the time horizon
+            Vector2 w = relativeVelocity - relativePosition * invTimeHorizon;
+            double wLengthSq = w.MagnitudeSquared();
+            double dotProduct = w.Dot(relativePosition);
+            
+            if (dotProduct < 0.0 && dotProduct * dotProduct > combinedRadiusSq * wLengthSq) {
+                // Closest to the cut-off circle
+                double wLength = std::sqrt(wLengthSq);
+                Vector2 unitW = w / wLength;
+                line.direction = Vector2(unitW.y, -unitW.x);
+                u = unitW * (combinedRadius * invTimeHorizon - wLength);
+            } else {
+                // Closest to a leg of the cone
+                double leg = std::sqrt(distSq - combinedRadiusSq);
+                if (relativePosition.Cross(w) > 0.0) {
+                    line.direction = Vector2(
+                        relativePosition.x * leg - relativePosition.y * combinedRadius,
+                        relativePosition.x * combinedRadius + relativePosition.y * leg) / distSq;
+                } else {
+                    line.direction = -Vector2(
+                        relativePosition.x * leg + relativePosition.y * combinedRadius,
+                        -relativePosition.x * combinedRadius + relativePosition.y * leg) / distSq;
+                }
+                u = line.direction * relativeVelocity.Dot(line.direction) - relativeVelocity;
+            }
+        } else {
+            // Already overlapping: separate within one time step
+            Vector2 w = relativeVelocity - relativePosition * invTimeStep;
+            double wLength = w.Magnitude();
+            Vector2 unitW = wLength > 1e-10 ? w / wLength : Vector2(1.0, 0.0);
+            line.direction = Vector2(unitW.y, -unitW.x);
+            u = unitW * (combinedRadius * invTimeStep - wLength);
+        }
+        
+        // Reciprocal: each robot takes half, unless the neighbor stands still
+        double responsibility = neighborVelocity.MagnitudeSquared() < 1e-6 ? 1.0 : 0.5;
+        line.point = me.velocity + u * responsibility;
+        lines.push_back(line);
     }
     
-    return closest;
+    Vector2 result;
+    size_t failed = LinearProgram2(lines, config_.maxSpeed, preferredVelocity, false, result);
+    if (failed < lines.size()) {
+        LinearProgram3(lines, failed, config_.maxSpeed, result);
+    }
+    return ClampSpeed(result);
 }
 
-bool ORCASolver::WillCollide(
-    const ObstacleData& me,
-    const ObstacleData& neighbor,
-    const Vector2& velocity,
-    double timeHorizon
-) const {
-    // Predict positions after timeHorizon
-    Vector2 myPos = me.GetPositionVec();
-    Vector2 neighborPos = neighbor.GetPositionVec();
-    
-    // Relative velocity (assuming neighbor continues at current velocity)
-    Vector2 relVel = velocity - neighbor.velocity;
-    
-    // Relative position
-    Vector2 relPos = myPos - neighborPos;
-    
-    // Check if we're getting closer
-    double approachRate = relPos.Normalized().Dot(relVel);
-    if (approachRate >= 0) {
-        // Moving apart, no collision
+bool ORCASolver::LinearProgram1(
+    const std::vector<HalfPlane>& lines,
+    size_t line,
+    double radius,
+    const Vector2& optimum,
+    bool directionOptimum,
+    Vector2& result
+) {
+    // Segment of the line inside the speed circle
+    double dotProduct = lines[line].point.Dot(lines[line].direction);
+    double discriminant = dotProduct * dotProduct + radius * radius - lines[line].point.MagnitudeSquared();
+    if (discriminant < 0.0) {
         return false;
     }
     
-    // Time to closest approach
-    double closestT = -relPos.Dot(relVel) / (relVel.MagnitudeSquared() + 1e-10);
-    if (closestT < 0 || closestT > timeHorizon) {
-        return false;
+    double sqrtDiscriminant = std::sqrt(discriminant);
+    double tLeft = -dotProduct - sqrtDiscriminant;
+    double tRight = -dotProduct + sqrtDiscriminant;
+    
+    // Clip it by the earlier half-planes
+    for (size_t i = 0; i < line; ++i) {
+        double denominator = lines[line].direction.Cross(lines[i].direction);
+        double numerator = lines[i].direction.Cross(lines[line].point - lines[i].point);
+        
+        if (std::fabs(denominator) <= LP_EPSILON) {
+            // Parallel: either all of the line is permitted by i or none
+            if (numerator < 0.0) return false;
+            continue;
+        }
+        
+        double t = numerator / denominator;
+        if (denominator >= 0.0) {
+            tRight = std::min(tRight, t);
+        } else {
+            tLeft = std::max(tLeft, t);
+        }
+        if (tLeft > tRight) return false;
     }
     
-    // Distance at closest approach
-    Vector2 closestRelPos = relPos + relVel * closestT;
-    double closestDist = closestRelPos.Magnitude();
+    if (directionOptimum) {
+        double t = optimum.Dot(lines[line].direction) > 0.0 ? tRight : tLeft;
+        result = lines[line].point + lines[line].direction * t;
+    } else {
+        double t = std::clamp(lines[line].direction.Dot(optimum - lines[line].point), tLeft, tRight);
+        result = lines[line].point + lines[line].direction * t;
+    }
+    return true;
+}
+
+size_t ORCASolver::LinearProgram2(
+    const std::vector<HalfPlane>& lines,
+    double radius,
+    const Vector2& optimum,
+    bool directionOptimum,
+    Vector2& result
+) {
+    if (directionOptimum) {
+        // optimum is a unit direction
+        result = optimum * radius;
+    } else {
+        result = optimum.LimitMagnitude(radius);
+    }
     
-    double combinedRadius = me.CombinedRadius(neighbor) + config_.safetyMargin;
+    // Incremental: the optimum only moves when a half-plane excludes it
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (lines[i].direction.Cross(lines[i].point - result) > 0.0) {
+            Vector2 previous = result;
+            if (!LinearProgram1(lines, i, radius, optimum, directionOptimum, result)) {
+                result = previous;
+                return i;
+            }
+        }
+    }
+    return lines.size();
+}
+
+void ORCASolver::LinearProgram3(
+    const std::vector<HalfPlane>& lines,
+    size_t beginLine,
+    double radius,
+    Vector2& result
+) const {
+    std::vector<HalfPlane>& projected = buffers_.projected;
+    double distance = 0.0;
     
-    return closestDist < combinedRadius;
+    for (size_t i = beginLine; i < lines.size(); ++i) {
+        if (lines[i].direction.Cross(lines[i].point - result) <= distance) {
+            continue;   // Violated no more than the current worst
+        }
+        
+        // Half-planes of velocities violating line j no more than line i
+        projected.clear();
+        for (size_t j = 0; j < i; ++j) {
+            HalfPlane line;
+            double determinant = lines[i].direction.Cross(lines[j].direction);
+            
+            if (std::fabs(determinant) <= LP_EPSILON) {
+                if (lines[i].direction.Dot(lines[j].direction) > 0.0) {
+                    continue;   // Same direction: no constraint
+                }
+                line.point = (lines[i].point + lines[j].point) * 0.5;
+            } else {
+                line.point = lines[i].point + lines[i].direction *
+                    (lines[j].direction.Cross(lines[i].point - lines[j].point) / determinant);
+            }
+            line.direction = (lines[j].direction - lines[i].direction).Normalized();
+            projected.push_back(line);
+        }
+        
+        // Furthest into half-plane i subject to those
+        Vector2 previous = result;
+        if (LinearProgram2(projected, radius, lines[i].direction.Perpendicular(), true, result) < projected.size()) {
+            // Only fails through rounding: keep the previous result
+            result = previous;
+        }
+        distance = lines[i].direction.Cross(lines[i].point - result);
+    }
 }
 
 // =============================================================================
-// VELOCITY MODIFICATION
+// SIMD PASSES
 // =============================================================================
+//
+// Each pass evaluates the scalar formulas of the original per-neighbor
+// loops, two neighbors at a time, with the same operation order (IEEE
+// results are identical to the scalar fallback). Lanes past Size() read
+// padding and their results are never used.
 
-Vector2 ORCASolver::ApplyRepulsion(
+void ORCASolver::DistancePass(const ObstacleData& me, const KinematicsStore& neighbors) const {
+    const size_t padded = neighbors.PaddedSize();
+    buffers_.distance.resize(padded);
+    buffers_.combinedRadius.resize(padded);
+    
+    const double* x = neighbors.X();
+    const double* y = neighbors.Y();
+    const double* radius = neighbors.Radius();
+    double* distance = buffers_.distance.data();
+    double* combined = buffers_.combinedRadius.data();
+    
+#if defined(__SSE2__)
+    const __m128d myX = _mm_set1_pd(me.position.x);
+    const __m128d myY = _mm_set1_pd(me.position.y);
+    const __m128d myRadius = _mm_set1_pd(me.radius);
+    const __m128d margin = _mm_set1_pd(config_.safetyMargin);
+    for (size_t i = 0; i < padded; i += 2) {
+        __m128d dx = _mm_sub_pd(myX, _mm_loadu_pd(x + i));
+        __m128d dy = _mm_sub_pd(myY, _mm_loadu_pd(y + i));
+        __m128d squared = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        _mm_storeu_pd(distance + i, _mm_sqrt_pd(squared));
+        _mm_storeu_pd(combined + i, _mm_add_pd(_mm_add_pd(myRadius, _mm_loadu_pd(radius + i)), margin));
+    }
+#else
+    for (size_t i = 0; i < padded; ++i) {
+        double dx = me.position.x - x[i];
+        double dy = me.position.y - y[i];
+        distance[i] = std::sqrt(dx * dx + dy * dy);
+        combined[i] = (me.radius + radius[i]) + config_.safetyMargin;
+    }
+#endif
+}
+
+void ORCASolver::RepulsionPass(const ObstacleData& me, const KinematicsStore& neighbors) const {
+    const size_t padded = neighbors.PaddedSize();
+    buffers_.repulsionX.resize(padded);
+    buffers_.repulsionY.resize(padded);
+    
+    const double* x = neighbors.X();
+    const double* y = neighbors.Y();
+    const double* distance = buffers_.distance.data();
+    const double* combined = buffers_.combinedRadius.data();
+    double* repulsionX = buffers_.repulsionX.data();
+    double* repulsionY = buffers_.repulsionY.data();
+    
+    // Repulsion strength inversely proportional to distance, only within
+    // influence range: (penetration / influenceRange) * maxSpeed * 0.5
+    // along the unit vector from the neighbor
+#if defined(__SSE2__)
+    const __m128d myX = _mm_set1_pd(me.position.x);
+    const __m128d myY = _mm_set1_pd(me.position.y);
+    const __m128d slowdown = _mm_set1_pd(config_.slowdownDistance);
+    const __m128d maxSpeed = _mm_set1_pd(config_.maxSpeed);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d minDistance = _mm_set1_pd(1e-6);
+    for (size_t i = 0; i < padded; i += 2) {
+        __m128d toMeX = _mm_sub_pd(myX, _mm_loadu_pd(x + i));
+        __m128d toMeY = _mm_sub_pd(myY, _mm_loadu_pd(y + i));
+        __m128d dist = _mm_loadu_pd(distance + i);
+        __m128d influence = _mm_add_pd(_mm_loadu_pd(combined + i), slowdown);
+        __m128d inRange = _mm_and_pd(_mm_cmpngt_pd(dist, influence), _mm_cmpnlt_pd(dist, minDistance));
+        
+        __m128d penetration = _mm_sub_pd(influence, dist);
+        __m128d strength = _mm_mul_pd(_mm_mul_pd(_mm_div_pd(penetration, influence), maxSpeed), half);
+        __m128d forceX = _mm_mul_pd(_mm_div_pd(toMeX, dist), strength);
+        __m128d forceY = _mm_mul_pd(_mm_div_pd(toMeY, dist), strength);
+        _mm_storeu_pd(repulsionX + i, _mm_and_pd(forceX, inRange));
+        _mm_storeu_pd(repulsionY + i, _mm_and_pd(forceY, inRange));
+    }
+#else
+    for (size_t i = 0; i < padded; ++i) {
+        double influenceRange = combined[i] + config_.slowdownDistance;
+        if (distance[i] > influenceRange || distance[i] < 1e-6) {
+            repulsionX[i] = 0.0;
+            repulsionY[i] = 0.0;
+            continue;
+        }
+        double penetration = influenceRange - distance[i];
+        double strength = (penetration / influenceRange) * config_.maxSpeed * 0.5;
+        repulsionX[i] = ((me.position.x - x[i]) / distance[i]) * strength;
+        repulsionY[i] = ((me.position.y - y[i]) / distance[i]) * strength;
+    }
+#endif
+}
+
+void ORCASolver::CollisionPass(
     const ObstacleData& me,
-    const std::vector<ObstacleData>& neighbors,
-    const Vector2& velocity
+    const KinematicsStore& neighbors,
+    const Vector2& velocity,
+    size_t begin
 ) const {
-    Vector2 repulsionForce = Vector2::Zero();
+    const size_t padded = neighbors.PaddedSize();
+    buffers_.collides.resize(padded);
     
-    Vector2 myPos = me.GetPositionVec();
+    const double* x = neighbors.X();
+    const double* y = neighbors.Y();
+    const double* vx = neighbors.VX();
+    const double* vy = neighbors.VY();
+    const double* distance = buffers_.distance.data();
+    const double* combined = buffers_.combinedRadius.data();
+    unsigned char* collides = buffers_.collides.data();
     
-    for (const auto& neighbor : neighbors) {
-        Vector2 neighborPos = neighbor.GetPositionVec();
-        Vector2 toMe = myPos - neighborPos;
+    // Relative position p and velocity v (neighbor assumed to keep its
+    // velocity): a collision needs the robots approaching, the closest
+    // approach t = -(p.v) / (|v|^2 + 1e-10) within [0, timeHorizon], and
+    // the distance there below the combined radius
+#if defined(__SSE2__)
+    const __m128d myX = _mm_set1_pd(me.position.x);
+    const __m128d myY = _mm_set1_pd(me.position.y);
+    const __m128d velX = _mm_set1_pd(velocity.x);
+    const __m128d velY = _mm_set1_pd(velocity.y);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d signBit = _mm_set1_pd(-0.0);
+    const __m128d epsilon = _mm_set1_pd(1e-10);
+    const __m128d horizon = _mm_set1_pd(config_.timeHorizon);
+    for (size_t i = begin & ~static_cast<size_t>(1); i < padded; i += 2) {
+        __m128d relX = _mm_sub_pd(myX, _mm_loadu_pd(x + i));
+        __m128d relY = _mm_sub_pd(myY, _mm_loadu_pd(y + i));
+        __m128d relVelX = _mm_sub_pd(velX, _mm_loadu_pd(vx + i));
+        __m128d relVelY = _mm_sub_pd(velY, _mm_loadu_pd(vy + i));
+        __m128d magnitude = _mm_loadu_pd(distance + i);
         
-        double dist = toMe.Magnitude();
-        double combinedR = me.CombinedRadius(neighbor) + config_.safetyMargin;
+        // Approach rate along the unit relative position (0 if coincident)
+        __m128d approachRate = _mm_add_pd(_mm_mul_pd(_mm_div_pd(relX, magnitude), relVelX),
+                                          _mm_mul_pd(_mm_div_pd(relY, magnitude), relVelY));
+        __m128d approaching = _mm_and_pd(_mm_cmplt_pd(approachRate, zero), _mm_cmpnlt_pd(magnitude, epsilon));
         
-        // Only apply repulsion within influence range
-        double influenceRange = combinedR + config_.slowdownDistance;
-        if (dist > influenceRange || dist < 1e-6) {
-            continue;
-        }
+        __m128d dot = _mm_add_pd(_mm_mul_pd(relX, relVelX), _mm_mul_pd(relY, relVelY));
+        __m128d speedSquared = _mm_add_pd(_mm_mul_pd(relVelX, relVelX), _mm_mul_pd(relVelY, relVelY));
+        __m128d closestT = _mm_div_pd(_mm_xor_pd(dot, signBit), _mm_add_pd(speedSquared, epsilon));
+        __m128d inHorizon = _mm_and_pd(_mm_cmpnlt_pd(closestT, zero), _mm_cmpngt_pd(closestT, horizon));
         
-        // Repulsion strength inversely proportional to distance
-        // Stronger when closer to collision
-        double penetration = influenceRange - dist;
-        double strength = (penetration / influenceRange) * config_.maxSpeed * 0.5;
+        __m128d closestX = _mm_add_pd(relX, _mm_mul_pd(relVelX, closestT));
+        __m128d closestY = _mm_add_pd(relY, _mm_mul_pd(relVelY, closestT));
+        __m128d closestDist = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(closestX, closestX), _mm_mul_pd(closestY, closestY)));
+        __m128d hits = _mm_and_pd(_mm_and_pd(approaching, inHorizon),
+                                  _mm_cmplt_pd(closestDist, _mm_loadu_pd(combined + i)));
         
-        Vector2 repulsion = toMe.Normalized() * strength;
-        repulsionForce += repulsion;
+        int mask = _mm_movemask_pd(hits);
+        collides[i] = static_cast<unsigned char>(mask & 1);
+        collides[i + 1] = static_cast<unsigned char>((mask >> 1) & 1);
     }
-    
-    // Blend repulsion with original velocity
-    return velocity + repulsionForce * config_.responsiveness;
+#else
+    for (size_t i = begin; i < padded; ++i) {
+        collides[i] = 0;
+        double relX = me.position.x - x[i];
+        double relY = me.position.y - y[i];
+        double relVelX = velocity.x - vx[i];
+        double relVelY = velocity.y - vy[i];
+        double magnitude = distance[i];
+        
+        if (magnitude < 1e-10) continue;
+        double approachRate = (relX / magnitude) * relVelX + (relY / magnitude) * relVelY;
+        if (approachRate >= 0) continue;
+        
+        double closestT = -(relX * relVelX + relY * relVelY) / ((relVelX * relVelX + relVelY * relVelY) + 1e-10);
+        if (closestT < 0 || closestT > config_.timeHorizon) continue;
+        
+        double closestX = relX + relVelX * closestT;
+        double closestY = relY + relVelY * closestT;
+        collides[i] = std::sqrt(closestX * closestX + closestY * closestY) < combined[i];
+    }
+#endif
 }
 
+// =============================================================================
+// VELOCITY MODIFICATION
+// =============================================================================
+
 Vector2 ORCASolver::ApplySlowdown(
     const Vector2& velocity,
     double closestDistance,
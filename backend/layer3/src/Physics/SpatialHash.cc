@@ -0,0 +1,122 @@
+/**
+ * @file SpatialHash.cc
+ * @brief Implementation of the hashed uniform neighbor grid
+ */
+
+#include "Physics/SpatialHash.hh"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Backend {
+namespace Layer3 {
+namespace Physics {
+
+SpatialHash::SpatialHash(double cellSize)
+    : cellSize_(1.0)
+    , inverseCellSize_(1.0)
+    , bucketMask_(0) {
+    SetCellSize(cellSize);
+}
+
+void SpatialHash::SetCellSize(double cellSize) {
+    if (!(cellSize > 0.0)) {
+        throw std::invalid_argument("SpatialHash: cell size must be positive");
+    }
+    cellSize_ = cellSize;
+    inverseCellSize_ = 1.0 / cellSize;
+}
+
+void SpatialHash::Reset(size_t count) {
+    // Power-of-two table of at least twice the items: few cells share a bucket
+    size_t buckets = 16;
+    while (buckets < 2 * count) buckets <<= 1;
+    bucketMask_ = buckets - 1;
+
+    head_.assign(buckets, NONE);
+    next_.resize(count);
+    previous_.resize(count);
+    cellX_.resize(count);
+    cellY_.resize(count);
+    x_.resize(count);
+    y_.resize(count);
+}
+
+int64_t SpatialHash::CellOf(double coordinate) const {
+    return static_cast<int64_t>(std::floor(coordinate * inverseCellSize_));
+}
+
+size_t SpatialHash::Bucket(int64_t cellX, int64_t cellY) const {
+    uint64_t key = static_cast<uint64_t>(cellX) * 73856093u ^ static_cast<uint64_t>(cellY) * 19349663u;
+    return static_cast<size_t>(key) & bucketMask_;
+}
+
+void SpatialHash::Link(size_t item) {
+    int32_t& first = head_[Bucket(cellX_[item], cellY_[item])];
+    previous_[item] = NONE;
+    next_[item] = first;
+    if (first != NONE) previous_[first] = static_cast<int32_t>(item);
+    first = static_cast<int32_t>(item);
+}
+
+void SpatialHash::Unlink(size_t item) {
+    if (previous_[item] != NONE) {
+        next_[previous_[item]] = next_[item];
+    } else {
+        head_[Bucket(cellX_[item], cellY_[item])] = next_[item];
+    }
+    if (next_[item] != NONE) previous_[next_[item]] = previous_[item];
+}
+
+void SpatialHash::Insert(size_t item, double x, double y) {
+    x_[item] = x;
+    y_[item] = y;
+    cellX_[item] = CellOf(x);
+    cellY_[item] = CellOf(y);
+    Link(item);
+}
+
+void SpatialHash::Move(size_t item, double x, double y) {
+    x_[item] = x;
+    y_[item] = y;
+    int64_t cellX = CellOf(x);
+    int64_t cellY = CellOf(y);
+    if (cellX == cellX_[item] && cellY == cellY_[item]) return;
+
+    Unlink(item);
+    cellX_[item] = cellX;
+    cellY_[item] = cellY;
+    Link(item);
+}
+
+void SpatialHash::Query(double x, double y, double radius, std::vector<size_t>& out) const {
+    out.clear();
+    if (radius < 0.0) return;
+
+    double radiusSquared = radius * radius;
+    int64_t minX = CellOf(x - radius);
+    int64_t maxX = CellOf(x + radius);
+    int64_t minY = CellOf(y - radius);
+    int64_t maxY = CellOf(y + radius);
+
+    for (int64_t cellY = minY; cellY <= maxY; ++cellY) {
+        for (int64_t cellX = minX; cellX <= maxX; ++cellX) {
+            for (int32_t item = head_[Bucket(cellX, cellY)]; item != NONE; item = next_[item]) {
+                // Other cells hashed into the same bucket are skipped here,
+                // so every item is seen from its own cell only
+                if (cellX_[item] != cellX || cellY_[item] != cellY) continue;
+
+                double dx = x_[item] - x;
+                double dy = y_[item] - y;
+                if (dx * dx + dy * dy <= radiusSquared) {
+                    out.push_back(static_cast<size_t>(item));
+                }
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
+
+} // namespace Physics
+} // namespace Layer3
+} // namespace Backend
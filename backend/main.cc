@@ -16,6 +16,7 @@
 #include <chrono>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 
 // Global flag for signal handling
 std::atomic<bool> g_running(true);
@@ -37,6 +38,22 @@ void printUsage(const char* programName) {
     std::cout << "  --demo        Run dynamic task injection demo (Scenarios A, B, C)\n";
     std::cout << "  --cli         Interactive CLI mode for live task injection\n";
     std::cout << "  --from-json   Indicate data was imported from JSON (display info)\n";
+    std::cout << "  --trace FILE  Write a Chrome trace on exit (needs a make TRACING=1 build)\n";
+    std::cout << "  --physics-threads N  Step robots zone by zone on N threads (0 = all cores, default: 1)\n";
+    std::cout << "  --background-threads N  Workers for replans, cost refreshes and checkpoints (0 = all cores, default: 0)\n";
+    std::cout << "  --checkpoint FILE  Checkpoint the fleet to FILE while running and resume from it on start\n";
+    std::cout << "  --event-log FILE  Record task arrivals, solves and goal completions to FILE\n";
+    std::cout << "  --replay FILE  Replay an event log at maximum speed (implies --batch)\n";
+    std::cout << "  --pin ROLE=CPUS  Run a thread role on CPUS, e.g. physics=3 or solver=0-2\n";
+    std::cout << "                   (roles: physics, strategic, obstacle, solver, io)\n";
+    std::cout << "  --priority ROLE=CLASS  Scheduling class of a role: normal, high, low, realtime\n";
+    std::cout << "  --isolate-physics  Keep every other thread off the physics CPUs (last CPU if not pinned)\n";
+    std::cout << "  --push-port N  Push telemetry, paths and obstacles over WebSocket on 127.0.0.1:N\n";
+    std::cout << "  --ingest-port N  Accept task batches (length-prefixed JSON) on 127.0.0.1:N\n";
+    std::cout << "  --ingest-socket PATH  Accept task batches on a Unix socket\n";
+    std::cout << "  --robot-class NAME:RADIUS:COUNT  COUNT robots of RADIUS meters (repeatable; the rest keep the default size)\n";
+    std::cout << "  --fidelity full|kinematic  Kinematic: legs take their cost-matrix travel time, no paths or ORCA\n";
+    std::cout << "                   (with --batch the fleet loop jumps from arrival to arrival)\n";
     std::cout << "\nExamples:\n";
     std::cout << "  " << programName << "\n";
     std::cout << "  " << programName << " --tasks custom_tasks.json --robots 5\n";
@@ -48,6 +65,23 @@ void printUsage(const char* programName) {
     std::cout << "\n";
 }
 
+/**
+ * @brief Write the recorded trace zones as Chrome trace JSON.
+ */
+void writeTrace(const std::string& path) {
+    auto& tracer = Backend::Common::Tracer::Instance();
+    size_t events = tracer.GetEventCount();
+    if (tracer.WriteChromeTrace(path)) {
+        std::cout << "[Trace] Wrote " << events << " events to " << path
+                  << " (open in chrome://tracing or ui.perfetto.dev)\n";
+#ifndef MECALUX_TRACING
+        std::cout << "[Trace] Tracing is compiled out: rebuild with make TRACING=1\n";
+#endif
+    } else {
+        std::cerr << "[Trace] Could not write " << path << "\n";
+    }
+}
+
 /**
  * @brief Create random tasks between POI nodes.
  * 
@@ -86,6 +120,26 @@ int main(int argc, char* argv[]) {
     bool demoMode = false;
     bool cliMode = false;
     bool fromJson = false;
+    std::string tracePath;  // Empty = no trace on exit
+    int physicsThreads = 1;
+    int backgroundThreads = 0;
+    std::string checkpointPath;  // Empty = no checkpoints
+    std::string eventLogPath;    // Empty = no event log
+    std::string replayPath;      // Empty = live tasks
+    Backend::ThreadPlacementConfig threadPlacement;  // Default: left to the OS
+    int pushPort = 0;  // Default: no push server
+    int ingestPort = 0;  // Default: no task ingestion endpoint
+    std::string ingestSocket;
+    std::vector<Backend::RobotClassConfig> robotClasses;  // Default: one robot size
+    Backend::SimulationFidelity fidelity = Backend::SimulationFidelity::FULL;
+    
+    // "role=value" of --pin / --priority
+    auto splitRole = [](const std::string& text, Backend::ThreadRole& role, std::string& value) {
+        size_t eq = text.find('=');
+        if (eq == std::string::npos || !Backend::ParseThreadRole(text.substr(0, eq), role)) return false;
+        value = text.substr(eq + 1);
+        return true;
+    };
     
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -115,6 +169,81 @@ int main(int argc, char* argv[]) {
         else if (arg == "--from-json") {
             fromJson = true;
         }
+        else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        }
+        else if (arg == "--physics-threads" && i + 1 < argc) {
+            physicsThreads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--background-threads" && i + 1 < argc) {
+            backgroundThreads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpointPath = argv[++i];
+        }
+        else if (arg == "--event-log" && i + 1 < argc) {
+            eventLogPath = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+            batchMode = true;
+        }
+        else if (arg == "--pin" && i + 1 < argc) {
+            Backend::ThreadRole role;
+            std::string cpus;
+            std::vector<int> parsed;
+            if (!splitRole(argv[++i], role, cpus) || !Backend::ParseCpuList(cpus, parsed)) {
+                std::cerr << "Bad --pin " << argv[i] << " (expected ROLE=CPUS)\n";
+                return 1;
+            }
+            threadPlacement[role].cpus = cpus;
+        }
+        else if (arg == "--priority" && i + 1 < argc) {
+            Backend::ThreadRole role;
+            std::string priority;
+            if (!splitRole(argv[++i], role, priority) ||
+                !Backend::ParseThreadPriority(priority, threadPlacement[role].priority)) {
+                std::cerr << "Bad --priority " << argv[i] << " (expected ROLE=normal|high|low|realtime)\n";
+                return 1;
+            }
+        }
+        else if (arg == "--isolate-physics") {
+            threadPlacement.isolatePhysics = true;
+        }
+        else if (arg == "--push-port" && i + 1 < argc) {
+            pushPort = std::stoi(argv[++i]);
+        }
+        else if (arg == "--ingest-port" && i + 1 < argc) {
+            ingestPort = std::stoi(argv[++i]);
+        }
+        else if (arg == "--ingest-socket" && i + 1 < argc) {
+            ingestSocket = argv[++i];
+        }
+        else if (arg == "--robot-class" && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t first = spec.find(':');
+            size_t second = first == std::string::npos ? first : spec.find(':', first + 1);
+            Backend::RobotClassConfig robotClass;
+            try {
+                if (second == std::string::npos) throw std::invalid_argument(spec);
+                robotClass.name = spec.substr(0, first);
+                robotClass.radiusMeters = std::stof(spec.substr(first + 1, second - first - 1));
+                robotClass.count = std::stoi(spec.substr(second + 1));
+            } catch (const std::exception&) {
+                std::cerr << "Bad --robot-class " << spec << " (expected NAME:RADIUS:COUNT)\n";
+                return 1;
+            }
+            robotClasses.push_back(robotClass);
+        }
+        else if (arg == "--fidelity" && i + 1 < argc) {
+            std::string level = argv[++i];
+            if (level != "full" && level != "kinematic") {
+                std::cerr << "Bad --fidelity " << level << " (expected full or kinematic)\n";
+                return 1;
+            }
+            fidelity = level == "kinematic" ? Backend::SimulationFidelity::KINEMATIC
+                                            : Backend::SimulationFidelity::FULL;
+        }
         else {
             std::cerr << "Unknown option: " << arg << "\n";
             printUsage(argv[0]);
@@ -150,6 +279,24 @@ int main(int argc, char* argv[]) {
     config.orcaTickMs = 50.0f;   // 20 Hz physics
     config.warehouseTickMs = 1000.0f;  // 1 Hz strategic
     config.batchMode = batchMode;
+    config.physicsThreads = physicsThreads;
+    config.backgroundThreads = backgroundThreads;
+    config.checkpointPath = checkpointPath;
+    config.eventLogPath = eventLogPath;
+    config.replayPath = replayPath;
+    config.threadPlacement = threadPlacement;
+    config.pushServerPort = pushPort;
+    config.ingestPort = ingestPort;
+    config.ingestSocketPath = ingestSocket;
+    config.robotClasses = robotClasses;
+    config.simulationFidelity = fidelity;
+    if (!replayPath.empty()) {
+        // Paths computed inline arrive the tick they are asked for, every run
+        config.pathfindingThreads = 0;
+        demoMode = false;
+        cliMode = false;
+        std::cout << "[Main] REPLAY: " << replayPath << " (batch, inline path planning)\n";
+    }
     
     // If using JSON-imported data, ensure we use the generated files
     if (fromJson) {
@@ -184,10 +331,16 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    // Load tasks
-    int numTasks = manager.LoadTasks(taskPath);
-    if (numTasks == 0) {
-        std::cerr << "[Main] Warning: No tasks loaded from " << taskPath << "\n";
+    // Resume a checkpointed shift, else load tasks (a replay brings its own)
+    if (!replayPath.empty()) {
+        std::cout << "[Main] Tasks come from the replayed log\n";
+    } else if (manager.RestoreCheckpoint()) {
+        std::cout << "[Main] Resuming from checkpoint, " << taskPath << " not loaded\n";
+    } else {
+        int numTasks = manager.LoadTasks(taskPath);
+        if (numTasks == 0) {
+            std::cerr << "[Main] Warning: No tasks loaded from " << taskPath << "\n";
+        }
     }
     
     // Set up callbacks
@@ -297,6 +450,7 @@ int main(int argc, char* argv[]) {
         std::cout << "       inject <N>  - Inject N random tasks (≤5 = Cheap Insertion, >5 = Background Re-plan)\n";
         std::cout << "       status      - Show robot states and queue info\n";
         std::cout << "       stats       - Show system statistics\n";
+        std::cout << "       trace FILE  - Write the recorded trace zones (Chrome trace JSON)\n";
         std::cout << "       help        - Show this help message\n";
         std::cout << "       quit        - Stop the system and exit\n";
         std::cout << "\n[CLI] Threshold: ≤5 tasks triggers Cheap Insertion, >5 triggers Background Re-plan\n";
@@ -347,6 +501,7 @@ int main(int argc, char* argv[]) {
                 std::cout << "                     (≤5 = Cheap Insertion, >5 = Background Re-plan)\n";
                 std::cout << "       status      - Show robot states and queue info\n";
                 std::cout << "       stats       - Show system statistics\n";
+                std::cout << "       trace FILE  - Write the recorded trace zones (Chrome trace JSON)\n";
                 std::cout << "       help        - Show this help message\n";
                 std::cout << "       quit        - Stop the system and exit\n\n";
                 
@@ -372,8 +527,13 @@ int main(int argc, char* argv[]) {
                                   << " -> dropoff=" << t.destinationNode << "\n";
                     }
                     
-                    manager.InjectTasks(tasks);
-                    std::cout << "[CLI] Tasks injected successfully!\n\n";
+                    size_t queued = manager.InjectTasks(tasks);
+                    if (queued == tasks.size()) {
+                        std::cout << "[CLI] Tasks injected successfully!\n\n";
+                    } else {
+                        std::cout << "[CLI] Injection queue full: " << tasks.size() - queued
+                                  << " tasks refused, try again later\n\n";
+                    }
                     
                 } else {
                     std::cout << "[CLI] Usage: inject <N> where N is a positive integer\n";
@@ -394,6 +554,14 @@ int main(int argc, char* argv[]) {
                           << " / " << stats.totalTasks << "\n";
                 std::cout << "[CLI] Dynamic tasks injected: " << (taskIdCounter - 1000) << "\n\n";
                 
+            } else if (cmd == "trace") {
+                std::string path;
+                if (iss >> path) {
+                    writeTrace(path);
+                } else {
+                    std::cout << "[CLI] Usage: trace <file>\n";
+                }
+                
             } else if (!cmd.empty()) {
                 std::cout << "[CLI] Unknown command: '" << cmd << "'. Type 'help' for commands.\n";
             }
@@ -447,6 +615,9 @@ int main(int argc, char* argv[]) {
     // Stop the system
     std::cout << "\n[Main] Stopping fleet management system...\n";
     manager.Stop();
+    if (!tracePath.empty()) {
+        writeTrace(tracePath);
+    }
     
     // Print final statistics
     auto stats = manager.GetStats();
@@ -0,0 +1,496 @@
+/**
+ * @file scenario_sweep.cc
+ * @brief What-if sweeps: many FleetManager simulations of one site in parallel
+ *
+ * Capacity planning asks the same questions of one warehouse with different
+ * fleets and solvers. Instead of running fleet_manager --batch once per
+ * configuration (re-parsing the map and recomputing the cost matrix every
+ * time), the sweep initializes one FleetManager, shares its static layers
+ * (map, inflation, NavMesh, POI cost matrix; FleetManager::ShareStaticLayers)
+ * and runs every scenario as a batch-mode FleetManager built on them, --jobs
+ * at a time. Each scenario is one fleet size x solver x seed of the grid.
+ *
+ * As in fleet_stress.cc, orders arrive as a seeded Poisson process of
+ * --order-rate orders per robot per simulated hour, simulated time is fleet
+ * loop ticks times the tick period, and a scenario ends after --duration
+ * simulated seconds or --max-wall seconds of real time. Scenarios running
+ * side by side share the CPUs, so compare their simulated results
+ * (throughput, backlog); tick and replan latencies are only comparable
+ * within one sweep.
+ *
+ * Usage:
+ *   make sweep ARGS="--robots 5,10,20,40,80 --solvers alns,portfolio:4,adaptive:200,zones:20,horizon --seeds 1,2"
+ *   ./build/scenario_sweep --robots 10,20 --solvers alns,portfolio:4 --jobs 4 --csv sweep.csv
+ *
+ * Options:
+ *   --robots a,b,...           Fleet sizes (default 5,10,20; capped by the site's chargers)
+ *   --solvers s,t,...          Replan solvers (default alns):
+ *                                alns          the default single ALNS
+ *                                portfolio:N   N solvers per replan (solverPortfolioSize)
+ *                                tempering:N   annealing with N tempering replicas (solverTemperingReplicas)
+ *                                adaptive:MS   solver tier per replan for an MS target (replanLatencyTargetMs)
+ *                                zones:N       zones of about N robots solved concurrently (solverZoneRobots)
+ *                                horizon       rolling-horizon batching of injected tasks
+ *   --seeds a,b,...            Order stream seeds (default 1)
+ *   --base DIR                 Site directory, as fleet_manager's working directory (default .)
+ *   --map FILE                 Map, relative to --base (default: SystemConfig::mapPath)
+ *   --order-rate R             Orders per robot per simulated hour (default 30)
+ *   --duration S               Simulated seconds per scenario (default 300)
+ *   --max-wall S               Real seconds per scenario before it is cut short (default 120)
+ *   --fidelity full|kinematic  SystemConfig::simulationFidelity (default full; kinematic
+ *                              drives cost-matrix travel times from arrival to arrival)
+ *   --queue-seconds S          SystemConfig::kinematicQueueSeconds (default 0)
+ *   --jobs N                   Scenarios run at once (default: hardware threads / 3,
+ *                              one per fleet, strategic and obstacle loop)
+ *   --label TEXT               Recorded in the JSON output (e.g. a commit)
+ *   --csv FILE                 Write the results as CSV
+ *   --json FILE                Write the results as JSON
+ *   --verbose 1                Keep the fleet managers' own logging (stdout)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FleetManager.hh"
+
+using namespace Backend;
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+
+const int POLL_INTERVAL_MS = 1;
+
+struct SweepOptions {
+    std::vector<int> robotCounts = {5, 10, 20};
+    std::vector<std::string> solvers = {"alns"};
+    std::vector<unsigned int> seeds = {1};
+    std::string baseDir = ".";
+    std::string mapPath;
+    float tickMs = 50.0f;               ///< The site's orca_tick_ms (FleetManager::Initialize applies it)
+    double orderRate = 30.0;
+    double durationSeconds = 300.0;
+    double maxWallSeconds = 120.0;
+    SimulationFidelity fidelity = SimulationFidelity::FULL;
+    double queueSeconds = 0.0;
+    int jobs = 0;
+    std::string label;
+    std::string csvPath;
+    std::string jsonPath;
+    bool verbose = false;
+};
+
+/// One point of the grid
+struct Scenario {
+    int robots = 0;
+    std::string solver;
+    unsigned int seed = 1;
+};
+
+struct ScenarioResult {
+    Scenario scenario;
+    bool ok = false;
+    int robots = 0;                     ///< Robots created (the site may have fewer chargers)
+    double simSeconds = 0.0;
+    double wallSeconds = 0.0;
+    bool cutShort = false;              ///< --max-wall reached before --duration
+    int injected = 0;
+    int completed = 0;
+    int backlog = 0;                    ///< Tasks injected but not completed at the end
+    uint64_t refused = 0;
+    double throughputPerHour = 0.0;
+    Common::LatencyHistogram::Summary physicsTick;
+    Common::LatencyHistogram::Summary replanSolve;
+};
+
+// =============================================================================
+// HELPER FUNCTIONS
+// =============================================================================
+
+std::vector<std::string> Split(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+unsigned int Draw(std::mt19937& rng, size_t n) {
+    return static_cast<unsigned int>(rng() % n);
+}
+
+/// Exponential inter-arrival time for a rate in events per second
+double DrawInterval(std::mt19937& rng, double ratePerSecond) {
+    double u = (static_cast<double>(rng()) + 1.0) / (static_cast<double>(std::mt19937::max()) + 2.0);
+    return -std::log(u) / ratePerSecond;
+}
+
+Common::LatencyHistogram::Summary FindMetric(const std::vector<API::LatencyMetric>& metrics,
+                                             const std::string& name) {
+    for (const auto& metric : metrics) {
+        if (metric.name == name) return metric.summary;
+    }
+    return Common::LatencyHistogram::Summary();
+}
+
+/**
+ * @brief Apply a --solvers entry to config.
+ *
+ * @return false if the entry is not one of the documented forms
+ */
+bool ApplySolver(const std::string& solver, SystemConfig& config) {
+    size_t colon = solver.find(':');
+    std::string name = solver.substr(0, colon);
+    int value = colon == std::string::npos ? 0 : std::atoi(solver.c_str() + colon + 1);
+    if (name == "alns" && colon == std::string::npos) return true;
+    if (name == "horizon" && colon == std::string::npos) {
+        config.rollingHorizon = true;
+        return true;
+    }
+    if (value <= 0) return false;
+    if (name == "portfolio") {
+        config.solverPortfolioSize = value;
+    } else if (name == "tempering") {
+        config.solverTemperingReplicas = value;
+    } else if (name == "adaptive") {
+        config.replanLatencyTargetMs = value;
+    } else if (name == "zones") {
+        config.solverZoneRobots = value;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/// Settings every fleet of the sweep shares
+SystemConfig BaseConfig(const SweepOptions& options) {
+    SystemConfig config;
+    config.batchMode = true;
+    config.pathfindingThreads = 0;      // Paths arrive the tick they are asked for, as in a replay
+    config.backgroundThreads = 2;       // Scenarios run --jobs at a time, each with its own workers
+    config.telemetryRingSlots = 0;
+    config.memoryReportIntervalMs = 0;
+    config.simulationFidelity = options.fidelity;
+    config.kinematicQueueSeconds = options.queueSeconds;
+    if (!options.mapPath.empty()) config.mapPath = options.mapPath;
+    return config;
+}
+
+// =============================================================================
+// SCENARIO RUN
+// =============================================================================
+
+ScenarioResult RunScenario(const SweepOptions& options, const Scenario& scenario,
+                           const std::shared_ptr<const StaticLayers>& layers) {
+    ScenarioResult result;
+    result.scenario = scenario;
+
+    SystemConfig config = BaseConfig(options);
+    config.numRobots = scenario.robots;
+    ApplySolver(scenario.solver, config);
+
+    FleetManager manager(config, options.baseDir);
+    manager.UseStaticLayers(layers);
+    if (!manager.Initialize()) {
+        std::cerr << "[Sweep] FleetManager failed to initialize (" << scenario.robots << " robots, "
+                  << scenario.solver << ")\n";
+        return result;
+    }
+    if (auto snapshot = manager.GetFleetSnapshot()) {
+        result.robots = static_cast<int>(snapshot->robots.size());
+    }
+    std::vector<int> pickups = manager.GetPickupNodes();
+    std::vector<int> dropoffs = manager.GetDropoffNodes();
+    if (result.robots == 0 || pickups.empty() || dropoffs.empty()) {
+        std::cerr << "[Sweep] Site has no robots, pickups or dropoffs\n";
+        return result;
+    }
+
+    // The same stream for every solver, scaled to the fleet
+    std::mt19937 rng(scenario.seed);
+    const double ratePerSecond = options.orderRate * result.robots / 3600.0;
+    double nextArrival = DrawInterval(rng, ratePerSecond);
+
+    const double tickSeconds = options.tickMs / 1000.0;
+    auto wallStart = std::chrono::steady_clock::now();
+    manager.Start();
+
+    double simSeconds = 0.0;
+    while (simSeconds < options.durationSeconds) {
+        simSeconds = manager.GetStats().fleetLoopCount * tickSeconds;
+        while (nextArrival <= simSeconds && nextArrival < options.durationSeconds) {
+            int source = pickups[Draw(rng, pickups.size())];
+            int dest = dropoffs[Draw(rng, dropoffs.size())];
+            if (manager.InjectTask(source, dest)) ++result.injected;
+            nextArrival += DrawInterval(rng, ratePerSecond);
+        }
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        if (wall >= options.maxWallSeconds) {
+            result.cutShort = true;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+    }
+
+    manager.Stop();
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    FleetStats stats = manager.GetStats();
+    result.ok = true;
+    result.simSeconds = stats.fleetLoopCount * tickSeconds;
+    result.completed = stats.completedTasks;
+    result.backlog = std::max(0, result.injected - result.completed);
+    result.refused = manager.GetInjectionsRefused();
+    result.throughputPerHour = result.simSeconds > 0.0 ? result.completed * 3600.0 / result.simSeconds : 0.0;
+
+    std::vector<API::LatencyMetric> metrics = manager.GetLatencyMetrics();
+    result.physicsTick = FindMetric(metrics, "physics_tick");
+    result.replanSolve = FindMetric(metrics, "replan_solve");
+    return result;
+}
+
+// =============================================================================
+// OUTPUT
+// =============================================================================
+
+void WriteTable(std::ostream& out, const std::vector<ScenarioResult>& results) {
+    out << std::left << std::setw(7) << "robots" << std::setw(16) << "solver" << std::setw(6) << "seed"
+        << std::right << std::setw(9) << "sim_s" << std::setw(9) << "wall_s" << std::setw(10) << "injected"
+        << std::setw(11) << "completed" << std::setw(9) << "backlog" << std::setw(10) << "tasks/h"
+        << std::setw(12) << "tick_p99" << std::setw(12) << "replan_p99" << "\n";
+    out << std::fixed;
+    for (const auto& r : results) {
+        out << std::left << std::setw(7) << (r.ok ? r.robots : r.scenario.robots)
+            << std::setw(16) << r.scenario.solver << std::setw(6) << r.scenario.seed << std::right;
+        if (!r.ok) {
+            out << "  failed\n";
+            continue;
+        }
+        out << std::setprecision(1) << std::setw(9) << r.simSeconds << std::setw(9) << r.wallSeconds
+            << std::setw(10) << r.injected << std::setw(11) << r.completed << std::setw(9) << r.backlog
+            << std::setw(10) << r.throughputPerHour << std::setprecision(2)
+            << std::setw(9) << r.physicsTick.p99Us / 1000.0 << " ms"
+            << std::setw(9) << r.replanSolve.p99Us / 1000.0 << " ms"
+            << (r.cutShort ? "  (cut short)" : "") << "\n";
+    }
+}
+
+void WriteCSV(std::ostream& out, const std::vector<ScenarioResult>& results) {
+    out << "robots,solver,seed,ok,sim_s,wall_s,cut_short,injected,completed,backlog,refused,"
+        << "throughput_per_hour,tick_p50_ms,tick_p99_ms,tick_max_ms,replans,replan_p50_ms,replan_p99_ms\n";
+    out << std::fixed;
+    for (const auto& r : results) {
+        out << (r.ok ? r.robots : r.scenario.robots) << "," << r.scenario.solver << "," << r.scenario.seed
+            << "," << (r.ok ? 1 : 0) << "," << std::setprecision(1) << r.simSeconds << ","
+            << std::setprecision(3) << r.wallSeconds << "," << (r.cutShort ? 1 : 0) << ","
+            << r.injected << "," << r.completed << "," << r.backlog << "," << r.refused << ","
+            << std::setprecision(1) << r.throughputPerHour << "," << std::setprecision(3)
+            << r.physicsTick.p50Us / 1000.0 << "," << r.physicsTick.p99Us / 1000.0 << ","
+            << r.physicsTick.maxUs / 1000.0 << "," << r.replanSolve.count << ","
+            << r.replanSolve.p50Us / 1000.0 << "," << r.replanSolve.p99Us / 1000.0 << "\n";
+    }
+}
+
+void WriteJSON(std::ostream& out, const std::vector<ScenarioResult>& results, const SweepOptions& options,
+               int jobs, double setupSeconds, double sweepSeconds) {
+    std::time_t now = std::time(nullptr);
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << std::fixed << "{\n"
+        << "  \"label\": \"" << options.label << "\",\n"
+        << "  \"timestamp\": \"" << timestamp << "\",\n"
+        << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+        << "  \"jobs\": " << jobs << ",\n"
+        << std::setprecision(1)
+        << "  \"order_rate_per_robot_hour\": " << options.orderRate << ",\n"
+        << "  \"duration_s\": " << options.durationSeconds << ",\n"
+        << std::setprecision(3)
+        << "  \"setup_s\": " << setupSeconds << ",\n"
+        << "  \"sweep_s\": " << sweepSeconds << ",\n"
+        << "  \"scenarios\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"robots\": " << (r.ok ? r.robots : r.scenario.robots)
+            << ", \"solver\": \"" << r.scenario.solver << "\", \"seed\": " << r.scenario.seed
+            << ", \"ok\": " << (r.ok ? "true" : "false") << std::setprecision(1)
+            << ", \"sim_s\": " << r.simSeconds << std::setprecision(3) << ", \"wall_s\": " << r.wallSeconds
+            << ", \"cut_short\": " << (r.cutShort ? "true" : "false") << ", \"injected\": " << r.injected
+            << ", \"completed\": " << r.completed << ", \"backlog\": " << r.backlog
+            << ", \"refused\": " << r.refused << std::setprecision(1)
+            << ", \"throughput_per_hour\": " << r.throughputPerHour << std::setprecision(3)
+            << ", \"tick_p99_ms\": " << r.physicsTick.p99Us / 1000.0
+            << ", \"replans\": " << r.replanSolve.count
+            << ", \"replan_p99_ms\": " << r.replanSolve.p99Us / 1000.0 << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+bool ParseArguments(int argc, char** argv, SweepOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--robots") {
+            options.robotCounts.clear();
+            for (const auto& item : Split(value)) options.robotCounts.push_back(std::max(1, std::atoi(item.c_str())));
+        } else if (arg == "--solvers") {
+            options.solvers = Split(value);
+        } else if (arg == "--seeds") {
+            options.seeds.clear();
+            for (const auto& item : Split(value)) {
+                options.seeds.push_back(static_cast<unsigned int>(std::strtoul(item.c_str(), nullptr, 10)));
+            }
+        } else if (arg == "--base") {
+            options.baseDir = value;
+        } else if (arg == "--map") {
+            options.mapPath = value;
+        } else if (arg == "--order-rate") {
+            options.orderRate = std::max(0.1, std::atof(value.c_str()));
+        } else if (arg == "--duration") {
+            options.durationSeconds = std::max(1.0, std::atof(value.c_str()));
+        } else if (arg == "--max-wall") {
+            options.maxWallSeconds = std::max(1.0, std::atof(value.c_str()));
+        } else if (arg == "--fidelity") {
+            if (value != "full" && value != "kinematic") {
+                std::cerr << "--fidelity takes full or kinematic\n";
+                return false;
+            }
+            options.fidelity = value == "kinematic" ? SimulationFidelity::KINEMATIC : SimulationFidelity::FULL;
+        } else if (arg == "--queue-seconds") {
+            options.queueSeconds = std::max(0.0, std::atof(value.c_str()));
+        } else if (arg == "--jobs") {
+            options.jobs = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--label") {
+            options.label = value;
+        } else if (arg == "--csv") {
+            options.csvPath = value;
+        } else if (arg == "--json") {
+            options.jsonPath = value;
+        } else if (arg == "--verbose") {
+            options.verbose = value != "0";
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.robotCounts.empty() || options.solvers.empty() || options.seeds.empty()) {
+        std::cerr << "--robots, --solvers and --seeds need at least one value each\n";
+        return false;
+    }
+    SystemConfig probe;
+    for (const auto& solver : options.solvers) {
+        if (!ApplySolver(solver, probe)) {
+            std::cerr << "Unknown solver " << solver
+                      << " (expected alns, portfolio:N, tempering:N, adaptive:MS, zones:N or horizon)\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    SweepOptions options;
+    if (!ParseArguments(argc, argv, options)) return 1;
+
+    // The fleet managers log every tick's events to stdout; muted unless
+    // asked for so the table on stdout stays readable
+    std::streambuf* stdoutBuffer = std::cout.rdbuf();
+    if (!options.verbose) std::cout.rdbuf(nullptr);
+
+    // POIs and the tick period come from the site's system_config.json
+    options.tickMs = SystemConfig::LoadFromJSON(options.baseDir + "/system_config.json").orcaTickMs;
+
+    std::vector<Scenario> scenarios;
+    for (int robots : options.robotCounts) {
+        for (const auto& solver : options.solvers) {
+            for (unsigned int seed : options.seeds) scenarios.push_back({robots, solver, seed});
+        }
+    }
+
+    // Static layers: built (or loaded from the map cache) once, by a fleet
+    // that is never started
+    auto setupStart = std::chrono::steady_clock::now();
+    std::shared_ptr<const StaticLayers> layers;
+    {
+        SystemConfig config = BaseConfig(options);
+        config.numRobots = 1;
+        FleetManager prototype(config, options.baseDir);
+        if (!prototype.Initialize()) {
+            std::cout.rdbuf(stdoutBuffer);
+            std::cerr << "[Sweep] Could not load the site from " << options.baseDir << "\n";
+            return 1;
+        }
+        layers = prototype.ShareStaticLayers();
+    }
+    double setupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - setupStart).count();
+
+    const int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const int jobs = std::min(static_cast<int>(scenarios.size()),
+                              options.jobs > 0 ? options.jobs : std::max(1, hardwareThreads / 3));
+    std::cerr << "[Sweep] Static layers ready in " << std::fixed << std::setprecision(2) << setupSeconds
+              << " s; " << scenarios.size() << " scenarios, " << jobs << " at a time\n";
+
+    std::vector<ScenarioResult> results(scenarios.size());
+    std::atomic<size_t> nextScenario{0};
+    std::mutex logMutex;
+    auto worker = [&]() {
+        for (size_t k = nextScenario++; k < scenarios.size(); k = nextScenario++) {
+            results[k] = RunScenario(options, scenarios[k], layers);
+            const ScenarioResult& r = results[k];
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cerr << "[Sweep] " << std::setw(3) << (k + 1) << "/" << scenarios.size() << " "
+                      << r.scenario.robots << " robots, " << r.scenario.solver << ", seed " << r.scenario.seed
+                      << ": " << std::setprecision(0) << r.throughputPerHour << " tasks/h ("
+                      << r.completed << "/" << r.injected << ") in " << std::setprecision(1)
+                      << r.wallSeconds << " s" << (r.cutShort ? " (cut short)" : "") << "\n";
+        }
+    };
+    auto sweepStart = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 1; t < jobs; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+    double sweepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - sweepStart).count();
+
+    std::cout.rdbuf(stdoutBuffer);
+    std::cout.clear();
+
+    std::cerr << "[Sweep] " << scenarios.size() << " scenarios in " << std::setprecision(1)
+              << sweepSeconds << " s\n";
+    WriteTable(std::cout, results);
+    if (!options.csvPath.empty()) {
+        std::ofstream csv(options.csvPath);
+        WriteCSV(csv, results);
+        std::cerr << "[Sweep] Wrote " << results.size() << " scenarios to " << options.csvPath << "\n";
+    }
+    if (!options.jsonPath.empty()) {
+        std::ofstream json(options.jsonPath);
+        WriteJSON(json, results, options, jobs, setupSeconds, sweepSeconds);
+        std::cerr << "[Sweep] Wrote " << results.size() << " scenarios to " << options.jsonPath << "\n";
+    }
+    return 0;
+}
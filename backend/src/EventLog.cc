@@ -0,0 +1,183 @@
+/**
+ * @file EventLog.cc
+ * @brief Encoding, buffering and reading of the shift event log
+ */
+
+#include "EventLog.hh"
+#include "BinaryIO.hh"
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+
+namespace Backend {
+
+namespace {
+
+const char EVENT_LOG_MAGIC[8] = {'A', 'M', 'R', 'E', 'V', 'L', 'O', 'G'};
+constexpr uint32_t EVENT_LOG_FORMAT_VERSION = 1;
+
+/// Type, payload size and tick ahead of every payload
+constexpr size_t RECORD_HEADER_BYTES = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+
+} // namespace
+
+bool EventLog::Open(const std::string& path, const EventLogHeader& header) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    const std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "[EventLog] Failed to open for writing: " << path << std::endl;
+        return false;
+    }
+
+    std::string bytes(EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC));
+    BinaryWriter writer(bytes);
+    writer.Put<uint32_t>(EVENT_LOG_FORMAT_VERSION);
+    writer.Put<uint32_t>(0);
+    writer.Put<uint64_t>(header.meshFingerprint);
+    writer.Put<int32_t>(header.robotCount);
+    writer.Put<float>(header.tickMs);
+    file_.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    file_.flush();
+    bytesWritten_ = bytes.size();
+    return file_.good();
+}
+
+void EventLog::AppendRecord(const LoggedEvent& event) {
+    std::string payload;
+    BinaryWriter writer(payload);
+    switch (event.type) {
+        case EventType::TASKS_ADDED:
+        case EventType::TASK_BATCH:
+            writer.PutTasks(event.tasks);
+            break;
+        case EventType::GOAL_REACHED:
+            writer.Put<int32_t>(event.robotId);
+            writer.Put<int32_t>(event.nodeId);
+            break;
+        case EventType::FULL_SOLVE:
+        case EventType::REPLAN_FINISHED:
+            break;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) return;
+    BinaryWriter record(buffer_);
+    record.Put<uint32_t>(static_cast<uint32_t>(event.type));
+    record.Put<uint32_t>(static_cast<uint32_t>(payload.size()));
+    record.Put<uint64_t>(event.tick);
+    buffer_.append(payload);
+    events_++;
+}
+
+void EventLog::LogTasks(EventType type, uint64_t tick, const std::vector<Layer2::Task>& tasks) {
+    LoggedEvent event;
+    event.type = type;
+    event.tick = tick;
+    event.tasks = tasks;
+    AppendRecord(event);
+}
+
+void EventLog::LogMarker(EventType type, uint64_t tick) {
+    LoggedEvent event;
+    event.type = type;
+    event.tick = tick;
+    AppendRecord(event);
+}
+
+void EventLog::LogGoalReached(uint64_t tick, int robotId, int nodeId) {
+    LoggedEvent event;
+    event.type = EventType::GOAL_REACHED;
+    event.tick = tick;
+    event.robotId = robotId;
+    event.nodeId = nodeId;
+    AppendRecord(event);
+}
+
+void EventLog::Flush(size_t minBytes) {
+    // Swap the buffer out: appenders are not held up by the write
+    std::string pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!file_.is_open() || buffer_.empty() || buffer_.size() < minBytes) return;
+        pending.swap(buffer_);
+    }
+    // Only the main loop (or Close) flushes, so writes stay in order
+    file_.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+    file_.flush();
+    std::lock_guard<std::mutex> lock(mutex_);
+    bytesWritten_ += pending.size();
+}
+
+void EventLog::Close() {
+    Flush();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_.is_open()) file_.close();
+}
+
+uint64_t EventLog::GetEventCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+}
+
+uint64_t EventLog::GetBytesWritten() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytesWritten_;
+}
+
+bool EventLog::Read(const std::string& path, EventLogHeader& header, std::vector<LoggedEvent>& events) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (bytes.size() < sizeof(EVENT_LOG_MAGIC) ||
+        std::memcmp(bytes.data(), EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC)) != 0) {
+        return false;
+    }
+    BinaryReader reader(bytes);
+    reader.Skip(sizeof(EVENT_LOG_MAGIC));
+    if (reader.Get<uint32_t>() != EVENT_LOG_FORMAT_VERSION) return false;
+    reader.Get<uint32_t>();
+    header.meshFingerprint = reader.Get<uint64_t>();
+    header.robotCount = reader.Get<int32_t>();
+    header.tickMs = reader.Get<float>();
+    if (!reader.IsOk()) return false;
+
+    events.clear();
+    while (bytes.size() - reader.GetOffset() >= RECORD_HEADER_BYTES) {
+        LoggedEvent event;
+        uint32_t type = reader.Get<uint32_t>();
+        uint32_t size = reader.Get<uint32_t>();
+        event.tick = reader.Get<uint64_t>();
+        if (bytes.size() - reader.GetOffset() < size) break;
+
+        BinaryReader payload(bytes.data() + reader.GetOffset(), size);
+        reader.Skip(size);
+        event.type = static_cast<EventType>(type);
+        switch (event.type) {
+            case EventType::TASKS_ADDED:
+            case EventType::TASK_BATCH:
+                event.tasks = payload.GetTasks();
+                break;
+            case EventType::GOAL_REACHED:
+                event.robotId = payload.Get<int32_t>();
+                event.nodeId = payload.Get<int32_t>();
+                break;
+            case EventType::FULL_SOLVE:
+            case EventType::REPLAN_FINISHED:
+                break;
+            default:
+                continue;
+        }
+        if (!payload.IsOk()) break;
+        events.push_back(std::move(event));
+    }
+    return true;
+}
+
+} // namespace Backend
@@ -0,0 +1,130 @@
+/**
+ * @file FleetCheckpoint.cc
+ * @brief Encoding of fleet checkpoints
+ */
+
+#include "FleetCheckpoint.hh"
+#include "BinaryIO.hh"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace Backend {
+
+namespace {
+
+const char CHECKPOINT_MAGIC[8] = {'A', 'M', 'R', 'F', 'L', 'E', 'E', 'T'};
+constexpr uint32_t CHECKPOINT_FORMAT_VERSION = 2;
+
+std::string Encode(const FleetCheckpoint& checkpoint) {
+    std::string bytes;
+    BinaryWriter writer(bytes);
+    bytes.append(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    writer.Put<uint32_t>(CHECKPOINT_FORMAT_VERSION);
+    writer.Put<uint32_t>(0);
+    writer.Put<uint64_t>(checkpoint.meshFingerprint);
+    writer.Put<uint64_t>(checkpoint.sequence);
+    writer.Put<int32_t>(checkpoint.nextTaskId);
+    writer.Put<int32_t>(checkpoint.totalTasks);
+    writer.Put<int32_t>(checkpoint.waypointsVisited);
+
+    writer.Put<uint32_t>(static_cast<uint32_t>(checkpoint.robots.size()));
+    for (const auto& robot : checkpoint.robots) {
+        writer.Put<int32_t>(robot.id);
+        writer.Put<int32_t>(static_cast<int32_t>(robot.status));
+        writer.Put<int32_t>(robot.currentNodeId);
+        writer.Put<int32_t>(robot.positionX);
+        writer.Put<int32_t>(robot.positionY);
+        writer.Put<int32_t>(robot.loadCount);
+        writer.PutNodes(robot.itinerary);
+    }
+    writer.PutTasks(checkpoint.pendingTasks);
+    writer.PutTasks(checkpoint.queuedTasks);
+    return bytes;
+}
+
+} // namespace
+
+bool FleetCheckpoint::Save(const std::string& path, const FleetCheckpoint& checkpoint) {
+    const std::string bytes = Encode(checkpoint);
+
+    std::error_code ec;
+    const std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+
+    // Write next to the target and rename: a crash mid-write keeps the
+    // previous checkpoint
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "[Checkpoint] Failed to open for writing: " << tmpPath << std::endl;
+            return false;
+        }
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file.good()) {
+            std::cerr << "[Checkpoint] Write failed: " << tmpPath << std::endl;
+            file.close();
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "[Checkpoint] Failed to move checkpoint into place: " << path << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool FleetCheckpoint::Load(const std::string& path, uint64_t meshFingerprint, FleetCheckpoint& checkpoint) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (bytes.size() < sizeof(CHECKPOINT_MAGIC) ||
+        std::memcmp(bytes.data(), CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+        return false;
+    }
+    BinaryReader reader(bytes);
+    reader.Get<uint64_t>();     // magic
+    if (reader.Get<uint32_t>() != CHECKPOINT_FORMAT_VERSION) return false;
+    reader.Get<uint32_t>();
+
+    FleetCheckpoint loaded;
+    loaded.meshFingerprint = reader.Get<uint64_t>();
+    if (!reader.IsOk() || loaded.meshFingerprint != meshFingerprint) return false;
+    loaded.sequence = reader.Get<uint64_t>();
+    loaded.nextTaskId = reader.Get<int32_t>();
+    loaded.totalTasks = reader.Get<int32_t>();
+    loaded.waypointsVisited = reader.Get<int32_t>();
+
+    // Six fields and an itinerary length per robot
+    loaded.robots.resize(reader.GetCount(6 * sizeof(int32_t) + sizeof(uint32_t)));
+    for (auto& robot : loaded.robots) {
+        robot.id = reader.Get<int32_t>();
+        int32_t status = reader.Get<int32_t>();
+        if (status < 0 || status > static_cast<int32_t>(Layer2::RobotStatus::ERROR)) return false;
+        robot.status = static_cast<Layer2::RobotStatus>(status);
+        robot.currentNodeId = reader.Get<int32_t>();
+        robot.positionX = reader.Get<int32_t>();
+        robot.positionY = reader.Get<int32_t>();
+        robot.loadCount = reader.Get<int32_t>();
+        if (robot.loadCount < 0) return false;
+        robot.itinerary = reader.GetNodes();
+    }
+    loaded.pendingTasks = reader.GetTasks();
+    loaded.queuedTasks = reader.GetTasks();
+
+    if (!reader.IsOk() || !reader.AtEnd()) return false;
+    checkpoint = std::move(loaded);
+    return true;
+}
+
+} // namespace Backend
@@ -14,6 +14,8 @@
 #include <iomanip>
 #include <cmath>
 #include <algorithm>
+#include <sstream>
+#include <filesystem>
 
 namespace Backend {
 
@@ -80,7 +82,18 @@ void FleetStats::Print() const {
     std::cout << "║ Simulation Time: " << std::setw(10) << std::fixed << std::setprecision(2) 
               << simulationTime << " s                          ║\n";
     std::cout << "║ Fleet Loops:     " << std::setw(10) << fleetLoopCount << "                              ║\n";
+    std::cout << "║ Driver Steps:    " << std::setw(10) << driverSteps << "                              ║\n";
     std::cout << "║ Main Loops:      " << std::setw(10) << mainLoopCount << "                              ║\n";
+    std::cout << "╠═══════════════════════════════════════════════════════════════╣\n";
+    const std::pair<const char*, const LoopTimingStats*> loops[] = {
+        {"Fleet    ", &fleetLoopTiming}, {"Main     ", &mainLoopTiming}, {"Obstacle ", &obstacleLoopTiming}};
+    for (const auto& [name, timing] : loops) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << timing->overruns << " overruns, late "
+             << timing->meanLatenessMs << "/" << timing->maxLatenessMs << " ms, jitter "
+             << timing->jitterMs << " ms";
+        std::cout << "║ " << name << std::left << std::setw(48) << line.str() << std::right << "║\n";
+    }
     std::cout << "╚═══════════════════════════════════════════════════════════════╝\n";
 }
 
@@ -88,10 +101,25 @@ void FleetStats::Print() const {
 // CONSTRUCTOR & DESTRUCTOR
 // =============================================================================
 
+namespace {
+
+/// Loop tick in milliseconds as a scheduler period
+LoopScheduler::Clock::duration loopPeriod(float tickMs) {
+    return std::chrono::duration_cast<LoopScheduler::Clock::duration>(
+        std::chrono::duration<double, std::milli>(tickMs));
+}
+
+} // namespace
+
 FleetManager::FleetManager(const SystemConfig& config, const std::string& basePath)
     : config_(config)
     , basePath_(basePath)
+    , injectionQueue_(static_cast<size_t>(std::max(1, config.injectionQueueCapacity)))
+    , injectionsRefused_(0)
     , running_(false)
+    , mainLoopScheduler_(loopPeriod(config.warehouseTickMs), OverrunPolicy::SKIP)
+    , fleetLoopScheduler_(loopPeriod(config.orcaTickMs), OverrunPolicy::CATCH_UP)
+    , obstacleLoopScheduler_(loopPeriod(config.obstacleTickMs), OverrunPolicy::SKIP)
     , apiService_(basePath + "/../api")  // API at repo root: backend/../api
     , history_()                          // Explicitly initialize empty history
     , lastCompletedTotal_(0)              // Reset completed counter
@@ -103,6 +131,9 @@ FleetManager::FleetManager(const SystemConfig& config, const std::string& basePa
     std::cout << "║                  Bridging Layers 1, 2, and 3 together                     ║\n";
     std::cout << "╚═══════════════════════════════════════════════════════════════════════════╝\n";
     
+    mainLoopScheduler_.SetTickHistogram(&mainTickLatency_);
+    fleetLoopScheduler_.SetTickHistogram(&physicsTickLatency_);
+    
     // Reset robots.json to clean state on startup
     // This prevents stale data from previous runs
     std::string robotsJsonPath = basePath + "/../api/output/robots.json";
@@ -136,29 +167,121 @@ bool FleetManager::Initialize() {
     config_.poiConfigPath = fileConfig.poiConfigPath;
     // Keep: numRobots, batchMode, robotSpeedMps, warehouseTickMs from CLI/defaults
     
-    // Initialize all layers
+    initializeThreadPlacement();
+    if (!taskScheduler_) {
+        taskScheduler_ = std::make_unique<Common::TaskScheduler>(
+            static_cast<size_t>(std::max(0, config_.backgroundThreads)));
+    }
+    
+    // Initialize all layers. Layer 2 and Layer 3 only read the Layer 1
+    // products, so the pathfinding service, flow fields and planners are
+    // set up while the cost matrix is precomputed.
+    using StartupClock = std::chrono::steady_clock;
+    auto elapsedMs = [](StartupClock::time_point since) {
+        return std::chrono::duration<double, std::milli>(StartupClock::now() - since).count();
+    };
+    auto startupBegin = StartupClock::now();
+    
     if (!initializeLayer1()) {
         std::cerr << "[FleetManager] ERROR: Layer 1 initialization failed!\n";
         return false;
     }
+    double layer1Ms = elapsedMs(startupBegin);
+    
+    auto layersBegin = StartupClock::now();
+    std::future<bool> layer3Future;
+    double layer3Ms = 0.0;
+    if (config_.parallelStartup) {
+        layer3Future = taskScheduler_->Submit(Common::TaskPriority::HIGH, [this, &elapsedMs, &layer3Ms, layersBegin]() {
+            bool ok = initializeLayer3();
+            layer3Ms = elapsedMs(layersBegin);
+            return ok;
+        });
+    }
+    
+    bool layer2Ok = initializeLayer2();
+    double layer2Ms = elapsedMs(layersBegin);
+    bool layer3Ok = true;
+    if (layer3Future.valid()) {
+        layer3Ok = layer3Future.get();
+    } else if (layer2Ok) {
+        auto layer3Begin = StartupClock::now();
+        layer3Ok = initializeLayer3();
+        layer3Ms = elapsedMs(layer3Begin);
+    }
     
-    if (!initializeLayer2()) {
+    if (!layer2Ok) {
         std::cerr << "[FleetManager] ERROR: Layer 2 initialization failed!\n";
         return false;
     }
     
-    if (!initializeLayer3()) {
+    if (!layer3Ok) {
         std::cerr << "[FleetManager] ERROR: Layer 3 initialization failed!\n";
         return false;
     }
     
+    // Checkpoints and event logs are keyed by the mesh before any obstacle overlay
+    if (!config_.checkpointPath.empty() || !config_.eventLogPath.empty() || !config_.replayPath.empty()) {
+        meshFingerprint_ = Layer2::CostMatrixProvider::ComputeMeshFingerprint(*navMesh_);
+    }
+    
     // Create robots
     createRobots();
     
+    // Telemetry goes to the shared-memory ring (batch mode publishes none)
+    if (!config_.batchMode) {
+        apiService_.StartWriter([this]() { threadPlacement_.Apply(ThreadRole::IO); });
+        int robots = static_cast<int>(drivers_.size());
+        if (apiService_.OpenTelemetryRing(config_.telemetryRingSlots, robots)) {
+            std::cout << "[API] Telemetry ring: orca/telemetry.ring (" << config_.telemetryRingSlots
+                      << " frames of " << robots << " robots)\n";
+        } else if (config_.telemetryRingSlots > 0) {
+            std::cerr << "[API] Warning: could not map orca/telemetry.ring, writing orca_tick_N.json files\n";
+        }
+        
+        if (config_.pushServerPort > 0) {
+            pushServer_ = std::make_unique<PushServer>();
+            if (pushServer_->Start(config_.pushServerPort, config_.pushServerAddress,
+                                   [this]() { threadPlacement_.Apply(ThreadRole::IO); })) {
+                apiService_.SetPushServer(pushServer_.get());
+            } else {
+                std::cerr << "[API] Warning: push server not started, clients must go through api/server.js\n";
+                pushServer_.reset();
+            }
+        }
+        startTaskIngestion();
+    }
+    
+    if (!initializeEventLog()) {
+        std::cerr << "[FleetManager] ERROR: Event log initialization failed!\n";
+        return false;
+    }
+    
     std::cout << "[FleetManager] System initialized successfully!\n";
+    std::cout << std::fixed << std::setprecision(1)
+              << "[FleetManager] Startup: " << elapsedMs(startupBegin) << " ms (Layer 1 " << layer1Ms
+              << " ms, Layer 2 " << layer2Ms << " ms, Layer 3 " << layer3Ms << " ms"
+              << (config_.parallelStartup ? " in parallel" : "") << ")\n";
     return true;
 }
 
+std::shared_ptr<const StaticLayers> FleetManager::ShareStaticLayers() const {
+    if (!navMesh_ || !costMatrix_) return nullptr;
+    if (sharedLayers_ && !ownMesh_) return sharedLayers_;
+    
+    auto layers = std::make_shared<StaticLayers>();
+    layers->key = Layer1::MapCache::ComputeKey(
+        basePath_ + "/" + config_.mapPath, config_.robotRadiusMeters, config_.mapResolution,
+        static_cast<std::uint32_t>(std::max(0, config_.navMeshMaxRegionTiles)));
+    layers->staticMap = staticMap_;
+    layers->inflatedMap = inflatedMap_;
+    layers->navMesh = config_.congestionCosts ? std::make_shared<const Layer1::NavMesh>(*navMesh_) : navMesh_;
+    auto costs = std::make_shared<Layer2::CostMatrixProvider>(*layers->navMesh);
+    costs->CopyFrom(*costMatrix_);
+    layers->costMatrix = std::move(costs);
+    return layers;
+}
+
 void FleetManager::Start() {
     if (running_.load()) {
         std::cout << "[FleetManager] Already running!\n";
@@ -169,6 +292,8 @@ void FleetManager::Start() {
     
     running_ = true;
     startTime_ = std::chrono::steady_clock::now();
+    lastCheckpointAt_ = startTime_;
+    lastMemoryReportAt_ = startTime_;
     
     // Start threads
     mainThread_ = std::thread(&FleetManager::runMainLoop, this);
@@ -189,6 +314,18 @@ void FleetManager::Stop() {
     std::cout << "\n[FleetManager] Stopping worker threads...\n";
     
     running_ = false;
+    replanCancel_ = true;   // A running replan returns early instead of holding up shutdown
+    
+    // No tasks come in while the loops wind down
+    for (auto& server : ingestServers_) {
+        server->Stop();
+        TaskIngestStats ingest = server->GetStats();
+        std::cout << "  - Task ingestion: " << ingest.batches << " batches on " << ingest.connections
+                  << " connections, " << ingest.tasksAccepted << " tasks accepted, " << ingest.tasksRejected
+                  << " rejected, " << ingest.tasksRefused << " refused (" << ingest.busyReplies
+                  << " busy replies, " << ingest.errorReplies << " unparsable)\n";
+    }
+    ingestServers_.clear();
     
     // Join threads
     if (mainThread_.joinable()) {
@@ -204,8 +341,126 @@ void FleetManager::Stop() {
         std::cout << "  - Obstacle Thread stopped\n";
     }
     
-    // Cleanup Layer 3 service
-    Layer3::Pathfinding::PathfindingService::DestroyInstance();
+    // Stop Layer 3 path workers (the services live as long as the drivers)
+    for (auto& entry : classPathServices_) entry.second->StopWorkers();
+    if (pathService_) {
+        pathService_->StopWorkers();
+        if (const auto* pathCache = pathService_->GetPathCache()) {
+            std::cout << "  - Path cache: " << pathCache->GetHits() << " hits / "
+                      << pathCache->GetMisses() << " misses ("
+                      << static_cast<int>(pathCache->GetHitRate() * 100.0) << "%), "
+                      << pathCache->GetSavedMs() << " ms of search saved\n";
+        }
+        if (pathService_->GetFlowFieldCount() > 0) {
+            std::cout << "  - Flow fields: " << pathService_->GetFlowFieldPaths() << " paths from "
+                      << pathService_->GetFlowFieldCount() << " goals\n";
+        }
+    }
+    if (replaying_) {
+        ReplayStats replay = GetReplayStats();
+        std::cout << "  - Replay: " << replay.matched << " of " << replay.loggedGoals
+                  << " logged goals reached at their tick";
+        if (replayFirstDivergence_ != UINT64_MAX) {
+            std::cout << ", " << replay.diverged << " diverged (first at tick " << replayFirstDivergence_ << ")";
+        }
+        if (replay.beyondLog > 0) {
+            std::cout << ", " << replay.beyondLog << " more after the log ends";
+        }
+        if (replay.missedReplans > 0) {
+            std::cout << ", " << replay.missedReplans << " logged replans had no solve to apply";
+        }
+        std::cout << "\n";
+    }
+    if (pushServer_) {
+        apiService_.SetPushServer(nullptr);
+        PushServerStats push = pushServer_->GetStats();
+        pushServer_->Stop();
+        std::cout << "  - Push server: " << push.clientsAccepted << " clients (" << push.clientsDropped
+                  << " dropped), " << push.framesSent << " frames sent, " << push.framesDecimated
+                  << " decimated, " << push.bytesSent << " bytes, " << push.httpRequests << " HTTP requests\n";
+        if (push.binaryKeyframesSent + push.binaryDeltasSent > 0) {
+            std::cout << "  - Binary telemetry: " << push.binaryKeyframesSent << " keyframes, "
+                      << push.binaryDeltasSent << " deltas\n";
+        }
+        if (push.framesFiltered + push.framesThrottled + push.subscriptionsRejected > 0) {
+            std::cout << "  - Subscriptions: " << push.framesFiltered << " frames filtered, "
+                      << push.framesThrottled << " throttled, " << push.subscriptionsRejected
+                      << " rejected on binary connections\n";
+        }
+    }
+    if (eventLog_) {
+        eventLog_->Close();
+        std::cout << "  - Event log: " << eventLog_->GetEventCount() << " events, "
+                  << eventLog_->GetBytesWritten() << " bytes to " << config_.eventLogPath << "\n";
+    }
+    
+    // Final checkpoint: a restart resumes from where this run stopped
+    if (!config_.checkpointPath.empty()) {
+        if (checkpointFuture_.valid() && checkpointFuture_.get()) checkpointsWritten_++;
+        if (auto checkpoint = captureCheckpoint()) {
+            checkpoint->sequence = checkpointSequence_++;
+            if (FleetCheckpoint::Save(getCheckpointFile(), *checkpoint)) {
+                checkpointsWritten_++;
+            } else {
+                checkpointFailures_++;
+            }
+        }
+        std::cout << "  - Checkpoints: " << checkpointsWritten_ << " written to " << config_.checkpointPath;
+        if (checkpointFailures_ > 0) std::cout << " (" << checkpointFailures_ << " failed)";
+        std::cout << "\n";
+    }
+    if (GetInjectionsRefused() > 0) {
+        std::cout << "  - Injection queue: " << GetInjectionsRefused() << " tasks refused while full\n";
+    }
+    if (config_.itineraryPrefetchLegs > 0 && !multiAgentPlanner_) {
+        uint64_t prefetched = 0;
+        size_t dispatched = 0;
+        for (const auto& driver : drivers_) {
+            if (driver) prefetched += driver->GetPrefetchedPaths();
+        }
+        for (const auto& [robotId, goals] : goalsDispatched_) {
+            dispatched += goals;
+        }
+        std::cout << "  - Itinerary prefetch: " << prefetched << " of " << dispatched
+                  << " goals left without waiting for a path\n";
+    }
+    if (physicsWorkers_) {
+        std::cout << "  - Physics zones: " << physicsZones_.size() << " on " << physicsWorkers_->GetThreadCount()
+                  << " threads, " << zoneHandoffs_ << " robot hand-offs between zones\n";
+    }
+    if (taskScheduler_) {
+        Common::TaskScheduler::Stats tasks = taskScheduler_->GetStats();
+        std::cout << "  - Background tasks: " << tasks.executed << " on " << taskScheduler_->GetThreadCount()
+                  << " workers (" << tasks.submitted[0] << " high, " << tasks.submitted[1] << " normal, "
+                  << tasks.submitted[2] << " low priority), " << tasks.stolen << " stolen\n";
+    }
+    if (deadlockResolver_) {
+        const auto& deadlocks = deadlockResolver_->GetStats();
+        std::cout << "  - Deadlocks: " << deadlocks.cycles << " cycles, " << deadlocks.longBlocks
+                  << " long blocks; " << deadlocks.reroutes << " rerouted, " << deadlocks.backOffs
+                  << " backed off, " << deadlocks.yields << " yielded, " << deadlocks.unresolved
+                  << " unresolved; " << deadlocks.blockedSeconds << " robot-s waiting (longest "
+                  << deadlocks.longestWaitSeconds << " s)\n";
+    }
+    auto latencies = GetLatencyMetrics();
+    for (const auto& metric : latencies) {
+        const auto& summary = metric.summary;
+        if (summary.count == 0) continue;
+        std::cout << "  - Latency " << metric.name << ": p50 / p99 / p99.9 = " << std::fixed
+                  << std::setprecision(2) << summary.p50Us / 1000.0 << " / " << summary.p99Us / 1000.0
+                  << " / " << summary.p999Us / 1000.0 << " ms (max " << summary.maxUs / 1000.0
+                  << " ms, " << summary.count << " samples)\n";
+    }
+    Common::MemoryReport memory = GetMemoryReport();
+    PrintMemoryReport(memory);
+    if (!config_.batchMode) {
+        apiService_.WriteMetrics(latencies, &memory);
+        apiService_.StopWriter();
+        API::APIWriterStats writer = apiService_.GetWriterStats();
+        std::cout << "  - API writer: " << writer.filesWritten << " files, " << writer.coalesced
+                  << " superseded before reaching disk, " << writer.dropped << " dropped (queue full), "
+                  << "largest backlog " << writer.maxBacklog << "\n";
+    }
     
     std::cout << "[FleetManager] All threads stopped.\n";
     
@@ -220,42 +475,118 @@ void FleetManager::Stop() {
 bool FleetManager::initializeLayer1() {
     std::cout << "\n[FleetManager] ═══════════════ Layer 1: Infrastructure ═══════════════\n";
     
+    TRACE_ZONE("Initialize Layer 1", "startup");
     try {
-        // Load static map
         std::string mapPath = basePath_ + "/" + config_.mapPath;
-        std::cout << "[Layer 1] Loading map from: " << mapPath << "\n";
         
-        staticMap_ = std::make_unique<Layer1::StaticBitMap>(
-            Layer1::StaticBitMap::CreateFromFile(mapPath, config_.mapResolution)
-        );
+        // The POI file needs no map: parse it while the map is built
+        std::string poiPath = basePath_ + "/" + config_.poiConfigPath;
+        std::cout << "[Layer 1] Loading POIs from: " << poiPath << "\n";
+        auto loadPOIs = [poiPath]() {
+            auto registry = std::make_unique<Layer1::POIRegistry>();
+            bool loaded = registry->LoadFromJSON(poiPath);
+            return std::make_pair(std::move(registry), loaded);
+        };
+        std::future<std::pair<std::unique_ptr<Layer1::POIRegistry>, bool>> poiFuture;
+        if (config_.parallelStartup) {
+            poiFuture = taskScheduler_->Submit(Common::TaskPriority::HIGH, loadPOIs);
+        }
         
-        auto [width, height] = staticMap_->GetDimensions();
-        std::cout << "[Layer 1] Map size: " << width << "x" << height << " pixels\n";
+        auto siteKey = [this, &mapPath]() {
+            return Layer1::MapCache::ComputeKey(
+                mapPath, config_.robotRadiusMeters, config_.mapResolution,
+                static_cast<std::uint32_t>(std::max(0, config_.navMeshMaxRegionTiles)));
+        };
         
-        // Create inflated map
-        std::cout << "[Layer 1] Creating inflated map (robot radius: " 
-                  << config_.robotRadiusMeters << "m)...\n";
-        inflatedMap_ = std::make_unique<Layer1::InflatedBitMap>(
-            *staticMap_, config_.robotRadiusMeters
-        );
+        // Another manager's products (scenario sweeps): nothing to build
+        bool fromShared = false;
+        if (sharedLayers_) {
+            if (sharedLayers_->key != siteKey()) {
+                std::cerr << "[Layer 1] Shared static layers were built for another map, "
+                          << "robot radius, resolution or tiling\n";
+                return false;
+            }
+            staticMap_ = sharedLayers_->staticMap;
+            inflatedMap_ = sharedLayers_->inflatedMap;
+            navMesh_ = sharedLayers_->navMesh;
+            if (config_.congestionCosts) {
+                // Penalties are written to the mesh overlay: keep them to this fleet
+                ownMesh_ = std::make_shared<Layer1::NavMesh>(*sharedLayers_->navMesh);
+                navMesh_ = ownMesh_;
+            }
+            fromShared = true;
+        }
+        
+        // Try the binary cache first (map + inflation + NavMesh in one mmap)
+        bool fromCache = false;
+        std::string cachePath;
+        std::uint64_t cacheKey = 0;
+        if (!fromShared && !config_.mapCachePath.empty()) {
+            cachePath = basePath_ + "/" + config_.mapCachePath;
+            cacheKey = siteKey();
+            Layer1::MapCache::Contents cached;
+            if (Layer1::MapCache::Load(cachePath, cacheKey, cached)) {
+                staticMap_ = std::move(cached.staticMap);
+                inflatedMap_ = std::move(cached.inflatedMap);
+                ownMesh_ = std::move(cached.navMesh);
+                navMesh_ = ownMesh_;
+                fromCache = true;
+            }
+        }
+        
+        if (!fromShared && !fromCache) {
+            // Load static map
+            std::cout << "[Layer 1] Loading map from: " << mapPath << "\n";
+            
+            staticMap_ = std::make_unique<Layer1::StaticBitMap>(
+                Layer1::StaticBitMap::CreateFromFile(mapPath, config_.mapResolution)
+            );
+            
+            // Create inflated map
+            std::cout << "[Layer 1] Creating inflated map (robot radius: " 
+                      << config_.robotRadiusMeters << "m)...\n";
+            inflatedMap_ = std::make_unique<Layer1::InflatedBitMap>(
+                *staticMap_, config_.robotRadiusMeters
+            );
+            
+            // Generate NavMesh
+            std::cout << "[Layer 1] Generating NavMesh...\n";
+            ownMesh_ = std::make_shared<Layer1::NavMesh>();
+            Layer1::NavMeshGenerator generator;
+            if (config_.navMeshMaxRegionTiles > 0) {
+                generator.SetTilingMode(Layer1::NavMeshGenerator::TilingMode::MERGED_RECTANGLES,
+                                        config_.navMeshMaxRegionTiles);
+            }
+            generator.ComputeRecast(*inflatedMap_, *ownMesh_);
+            navMesh_ = ownMesh_;
+            
+            // Cold build: write the cache for the next start
+            if (!cachePath.empty()) {
+                Layer1::MapCache::Save(cachePath, cacheKey, *staticMap_, *inflatedMap_, *navMesh_);
+            }
+        }
+        
+        auto [width, height] = staticMap_->GetDimensions();
+        std::cout << "[Layer 1] Map size: " << width << "x" << height << " pixels"
+                  << (fromShared ? " (shared)" : fromCache ? " (from cache)" : "") << "\n";
         
         // Create dynamic map (copy of inflated)
         dynamicMap_ = std::make_unique<Layer1::DynamicBitMap>(*staticMap_);
         
-        // Generate NavMesh
-        std::cout << "[Layer 1] Generating NavMesh...\n";
-        navMesh_ = std::make_unique<Layer1::NavMesh>();
-        Layer1::NavMeshGenerator generator;
-        generator.ComputeRecast(*inflatedMap_, *navMesh_);
-        
         std::cout << "[Layer 1] NavMesh: " << navMesh_->GetAllNodes().size() << " nodes\n";
         
-        // Load POI Registry
-        std::string poiPath = basePath_ + "/" + config_.poiConfigPath;
-        std::cout << "[Layer 1] Loading POIs from: " << poiPath << "\n";
+        // Binary copies of the graph and the inflated grid that visualization
+        // consumers map instead of parsing (shared layers were exported by their owner)
+        if (!fromShared && !config_.graphExportDir.empty()) {
+            std::string exportDir = basePath_ + "/" + config_.graphExportDir;
+            Layer1::GraphExport::WriteGraph(exportDir + "/navmesh.navgraph", *navMesh_);
+            Layer1::GraphExport::WriteBitmap(exportDir + "/navmesh.navbits", inflatedMap_->GetRawData());
+        }
         
-        poiRegistry_ = std::make_unique<Layer1::POIRegistry>();
-        if (poiRegistry_->LoadFromJSON(poiPath)) {
+        // POI Registry (mapped once the NavMesh exists)
+        auto [registry, poisLoaded] = poiFuture.valid() ? poiFuture.get() : loadPOIs();
+        poiRegistry_ = std::move(registry);
+        if (poisLoaded) {
             poiRegistry_->MapToNavMesh(*navMesh_);
             std::cout << "[Layer 1] POIs loaded: " << poiRegistry_->GetPOICount() << " total\n";
             std::cout << "          - Charging: " << poiRegistry_->GetNodesByType(Layer1::POIType::CHARGING).size() << "\n";
@@ -276,10 +607,29 @@ bool FleetManager::initializeLayer1() {
 bool FleetManager::initializeLayer2() {
     std::cout << "\n[FleetManager] ═══════════════ Layer 2: Planning ═══════════════\n";
     
+    TRACE_ZONE("Initialize Layer 2", "startup");
     try {
         // Create cost matrix provider
         std::cout << "[Layer 2] Creating cost matrix provider...\n";
         costMatrix_ = std::make_unique<Layer2::CostMatrixProvider>(*navMesh_);
+        costMatrix_->SetScheduler(taskScheduler_.get());
+        if (config_.quantizedCostMatrix) {
+            costMatrix_->SetStorage(Layer2::CostStorage::QUANTIZED16);
+        }
+        
+        // Large sites: plan on the cluster abstraction instead of the flat mesh
+        int nodeCount = static_cast<int>(navMesh_->GetAllNodes().size());
+        if (config_.hierarchyMinNodes > 0 && nodeCount >= config_.hierarchyMinNodes) {
+            std::cout << "[Layer 2] Building hierarchical NavMesh (" << nodeCount << " nodes)...\n";
+            navHierarchy_ = std::make_unique<Layer1::HierarchicalNavMesh>(*navMesh_);
+            costMatrix_->SetHierarchy(navHierarchy_.get());
+        } else if (config_.costLandmarkCount > 0 && !sharedLayers_) {
+            // Flat mesh: tighten the A* heuristic for cold queries
+            costMatrix_->PrecomputeLandmarks(config_.costLandmarkCount);
+        }
+        if (config_.bidirectionalCostSearch) {
+            costMatrix_->SetSearchMode(Layer2::CostSearchMode::BIDIRECTIONAL);
+        }
         
         // Precompute costs for POI nodes
         if (poiRegistry_) {
@@ -297,17 +647,100 @@ bool FleetManager::initializeLayer2() {
             }
             
             if (!poiNodes.empty()) {
+                // Reuse the last run's costs when the mesh is unchanged;
+                // only POIs missing from the snapshot are searched
+                std::string snapshotPath;
+                std::uint64_t fingerprint = 0;
+                if (sharedLayers_ && sharedLayers_->costMatrix) {
+                    costMatrix_->CopyFrom(*sharedLayers_->costMatrix);
+                } else if (!config_.costMatrixCachePath.empty()) {
+                    snapshotPath = basePath_ + "/" + config_.costMatrixCachePath;
+                    fingerprint = Layer2::CostMatrixProvider::ComputeMeshFingerprint(*navMesh_);
+                    costMatrix_->LoadSnapshot(snapshotPath, fingerprint);
+                }
+                size_t knownPairs = costMatrix_->GetMatrixSize();
+                
                 std::cout << "[Layer 2] Precomputing costs for " << poiNodes.size() << " POI nodes...\n";
                 int computed = costMatrix_->PrecomputeForNodes(poiNodes);
                 std::cout << "[Layer 2] Computed " << computed << " node pairs\n";
+                
+                if (!snapshotPath.empty() && costMatrix_->GetMatrixSize() != knownPairs) {
+                    costMatrix_->SaveSnapshot(snapshotPath, fingerprint);
+                }
             }
         }
         
         // Create VRP solver (ALNS - Adaptive Large Neighborhood Search)
-        // ALNS uses "Destroy and Repair" with Regret-2 insertion
-        // Parameters: iterations=100, destruction=25%, seed=42
-        std::cout << "[Layer 2] Creating VRP solver (ALNS)...\n";
-        vrpSolver_ = std::make_unique<Layer2::ALNS>(100, 0.25, 42);
+        // ALNS uses "Destroy and Repair" with Regret-k insertion
+        // Parameters: iterations=100, destruction=25%, seed=42, k=solverRegretK
+        // Zone z of a decomposed solve gets its own seeds
+        auto makeSolver = [this](int zone) -> std::unique_ptr<Layer2::IVRPSolver> {
+            unsigned int seedOffset = static_cast<unsigned int>(zone);
+            if (config_.solverPortfolioSize > 1) {
+                // Idle cores run other algorithms / seeds; the best makespan wins
+                return std::make_unique<Layer2::PortfolioSolver>(
+                    Layer2::PortfolioSolver::MakeDefaultMembers(
+                        config_.solverPortfolioSize,
+                        Layer2::PortfolioSolver::DEFAULT_BASE_SEED + seedOffset * config_.solverPortfolioSize),
+                    static_cast<double>(config_.solverTimeBudgetMs));
+            }
+            if (config_.solverTemperingReplicas > 1) {
+                // Replicas share the scheduler workers between exchanges
+                auto annealing = std::make_unique<Layer2::SimulatedAnnealing>(1000.0, 0.95, 1.0, 30, 42 + seedOffset);
+                annealing->SetParallelTempering(config_.solverTemperingReplicas);
+                return annealing;
+            }
+            return std::make_unique<Layer2::ALNS>(100, 0.25, 42 + seedOffset, config_.solverRegretK);
+        };
+        
+        if (config_.solverPortfolioSize > 1) {
+            std::cout << "[Layer 2] Creating VRP solver portfolio ("
+                      << config_.solverPortfolioSize << " solvers)...\n";
+        } else if (config_.solverTemperingReplicas > 1) {
+            std::cout << "[Layer 2] Creating VRP solver (parallel tempering, "
+                      << config_.solverTemperingReplicas << " replicas)...\n";
+        } else {
+            std::cout << "[Layer 2] Creating VRP solver (ALNS)...\n";
+        }
+        // Large fleets: zones of about solverZoneRobots robots solved concurrently
+        auto makeZoned = [this](Layer2::ZoneDecomposedSolver::SolverFactory factory)
+            -> std::unique_ptr<Layer2::IVRPSolver> {
+            if (config_.solverZoneRobots > 0) {
+                auto zoned = std::make_unique<Layer2::ZoneDecomposedSolver>(factory, config_.solverZoneRobots);
+                if (threadPlacement_.IsActive()) {
+                    // Zones share the solver CPUs with each zone's portfolio
+                    int cpus = static_cast<int>(threadPlacement_.GetCpuCount(ThreadRole::SOLVER));
+                    zoned->SetMaxThreads(std::max(1, cpus / std::max(1, config_.solverPortfolioSize)));
+                }
+                return zoned;
+            }
+            return factory(0);
+        };
+        if (config_.solverZoneRobots > 0) {
+            std::cout << "[Layer 2] Decomposing replans into zones of "
+                      << config_.solverZoneRobots << " robots\n";
+        }
+        
+        if (config_.replanLatencyTargetMs > 0) {
+            // Tiers from the configured solver down to a short local search;
+            // each replan runs the best one its measured latency allows
+            std::vector<std::unique_ptr<Layer2::IVRPSolver>> tiers;
+            tiers.push_back(makeZoned(makeSolver));
+            tiers.push_back(makeZoned([this](int zone) -> std::unique_ptr<Layer2::IVRPSolver> {
+                return std::make_unique<Layer2::ALNS>(25, 0.25, 42 + static_cast<unsigned int>(zone), config_.solverRegretK);
+            }));
+            tiers.push_back(makeZoned([](int zone) -> std::unique_ptr<Layer2::IVRPSolver> {
+                return std::make_unique<Layer2::HillClimbing>(50, 2, 42 + static_cast<unsigned int>(zone));
+            }));
+            std::cout << "[Layer 2] Adapting solver tier to a " << config_.replanLatencyTargetMs
+                      << " ms replan target (" << tiers.size() << " tiers)\n";
+            auto adaptive = std::make_unique<Layer2::AdaptiveSolver>(
+                std::move(tiers), static_cast<double>(config_.replanLatencyTargetMs));
+            adaptiveSolver_ = adaptive.get();
+            vrpSolver_ = std::move(adaptive);
+        } else {
+            vrpSolver_ = makeZoned(makeSolver);
+        }
         
         return true;
         
@@ -320,14 +753,93 @@ bool FleetManager::initializeLayer2() {
 bool FleetManager::initializeLayer3() {
     std::cout << "\n[FleetManager] ═══════════════ Layer 3: Physics ═══════════════\n";
     
+    TRACE_ZONE("Initialize Layer 3", "startup");
     try {
         // Initialize pathfinding service
         std::cout << "[Layer 3] Initializing PathfindingService...\n";
-        auto& pathService = Layer3::Pathfinding::PathfindingService::GetInstance();
-        pathService.Initialize(*inflatedMap_);
+        pathService_ = std::make_unique<Layer3::Pathfinding::PathfindingService>();
+        configurePathService(*pathService_, *inflatedMap_, *navMesh_);
+        
+        // Robots of another size plan on their inflation of the same
+        // clearance field; classes of one radius share the service
+        if (!config_.robotClasses.empty()) {
+            Layer1::NavMeshGenerator generator;
+            if (config_.navMeshMaxRegionTiles > 0) {
+                generator.SetTilingMode(Layer1::NavMeshGenerator::TilingMode::MERGED_RECTANGLES,
+                                        config_.navMeshMaxRegionTiles);
+            }
+            inflationVariants_ = std::make_unique<Layer1::InflationVariants>(*inflatedMap_, *navMesh_, generator);
+            for (const RobotClassConfig& robotClass : config_.robotClasses) {
+                if (robotClass.count <= 0) continue;
+                pathServiceFor(robotClass.radiusMeters);
+                std::cout << "[Layer 3] Robot class " << robotClass.name << ": " << robotClass.count
+                          << " robots, radius " << robotClass.radiusMeters << " m\n";
+            }
+        }
         
         std::cout << "[Layer 3] PathfindingService ready\n";
         
+        // Kinematic legs need no paths: nothing to plan or untangle
+        const bool kinematic = config_.simulationFidelity == SimulationFidelity::KINEMATIC;
+        if (kinematic) {
+            std::cout << "[Layer 3] Kinematic simulation: legs take their cost-matrix travel time";
+            if (config_.kinematicQueueSeconds > 0.0) {
+                std::cout << " + " << config_.kinematicQueueSeconds << " s per robot bound for the same node";
+            }
+            std::cout << "\n";
+        }
+        
+        if (config_.multiAgentPlanning && !kinematic) {
+            Layer3::Pathfinding::MultiAgentConfig plannerConfig;
+            plannerConfig.windowTicks = config_.multiAgentWindowTicks;
+            const double pixelsPerMeter = Common::GetPixelsPerMeter(config_.mapResolution);
+            plannerConfig.speed = config_.robotSpeedMps * pixelsPerMeter;  // pixels/s, as the drivers
+            plannerConfig.tickSeconds = config_.multiAgentTickSeconds > 0.0
+                ? config_.multiAgentTickSeconds
+                : navMesh_->GetTileSize() / plannerConfig.speed;
+            float widest = config_.robotRadiusMeters;
+            for (const RobotClassConfig& robotClass : config_.robotClasses) {
+                if (robotClass.count > 0) widest = std::max(widest, robotClass.radiusMeters);
+            }
+            plannerConfig.clearance = 2.0 * widest * pixelsPerMeter;  // the widest robots one diameter apart
+            multiAgentPlanner_ = std::make_unique<Layer3::Pathfinding::MultiAgentPlanner>(
+                *navMesh_, plannerConfig);
+            std::cout << "[Layer 3] Multi-agent planning: " << plannerConfig.windowTicks
+                      << " x " << plannerConfig.tickSeconds << " s reservation window\n";
+        }
+        
+        // Reservations already keep cooperative plans apart
+        if (config_.deadlockResolution && !multiAgentPlanner_ && !kinematic) {
+            Layer3::Core::DeadlockConfig deadlockConfig;
+            deadlockConfig.waitSeconds = config_.deadlockWaitSeconds;
+            deadlockResolver_ = std::make_unique<Layer3::Core::DeadlockResolver>(*navMesh_, deadlockConfig);
+            std::cout << "[Layer 3] Deadlock resolution after " << deadlockConfig.waitSeconds << " s of waiting\n";
+        }
+
+        if (config_.poiSlotScheduling && poiRegistry_) {
+            float holdingPixels = static_cast<float>(
+                Common::MetersToPixels(config_.poiHoldingDistanceMeters, config_.mapResolution));
+            poiSchedule_ = std::make_unique<Layer1::POISchedule>(*poiRegistry_, *navMesh_,
+                                                                config_.poiSlotSeconds, holdingPixels);
+            std::cout << "[Layer 3] POI slot scheduling: " << poiSchedule_->GetStationCount()
+                      << " stations, " << config_.poiSlotSeconds << " s slots\n";
+        }
+        
+        if (config_.congestionCosts) {
+            congestionMap_ = std::make_unique<Layer1::CongestionMap>(
+                navMesh_->GetAllNodes().size(),
+                config_.robotSpeedMps * Common::GetPixelsPerMeter(config_.mapResolution),
+                config_.congestionHalfLifeSeconds);
+            std::cout << "[Layer 3] Congestion costs: " << config_.congestionHalfLifeSeconds
+                      << " s half-life, refreshed every " << config_.congestionRefreshMs << " ms\n";
+        }
+        
+        if (config_.demandForecast && poiRegistry_) {
+            demandForecast_ = std::make_unique<Layer2::DemandForecast>(config_.forecastHalfLifeSeconds);
+            std::cout << "[Layer 3] Demand forecast: " << config_.forecastHorizonSeconds
+                      << " s horizon, repositioning every " << config_.repositionIntervalMs << " ms\n";
+        }
+
         return true;
         
     } catch (const std::exception& e) {
@@ -336,6 +848,90 @@ bool FleetManager::initializeLayer3() {
     }
 }
 
+void FleetManager::configurePathService(Layer3::Pathfinding::PathfindingService& service,
+                                        const Layer1::InflatedBitMap& safetyMap, const Layer1::NavMesh& mesh) {
+    service.Initialize(safetyMap);
+    service.SetSearchMode(config_.lazyThetaStar
+        ? Layer3::Pathfinding::ThetaStarMode::LAZY
+        : Layer3::Pathfinding::ThetaStarMode::BASIC);
+    service.SetAlgorithm(config_.pathAlgorithm);
+    
+    // With tiles the size of the Theta* lattice a corridor saves nothing
+    if (config_.corridorPlanning &&
+        config_.pathAlgorithm == Layer3::Pathfinding::PathAlgorithm::THETA_STAR &&
+        mesh.GetTileSize() > Layer3::Pathfinding::ThetaStarSolver::GridStep(config_.mapResolution)) {
+        service.EnableCorridorPlanning(mesh, config_.corridorMarginTiles);
+        std::cout << "[Layer 3] Two-level planning: NavMesh route + Theta* corridor ("
+                  << config_.corridorMarginTiles << " tile margin)\n";
+    }
+    
+    // Cached paths and flow fields are renewed whenever the overlay
+    // changes (flow fields of the busiest goals: refreshFlowFieldGoals)
+    service.SetMapVersionSource([this] { return pathMapVersion_.load(std::memory_order_acquire); });
+    if (config_.pathCacheCapacity > 0) {
+        service.EnablePathCache(static_cast<size_t>(config_.pathCacheCapacity));
+    }
+    
+    // Drivers wait in COMPUTING_PATH instead of blocking the fleet loop
+    if (config_.pathfindingThreads > 0) {
+        service.StartWorkers(static_cast<size_t>(config_.pathfindingThreads),
+                             [this]() { threadPlacement_.Apply(ThreadRole::SOLVER); });
+    }
+}
+
+Layer3::Pathfinding::PathfindingService& FleetManager::pathServiceFor(float radiusMeters) {
+    const int radiusPixels = Layer1::InflatedBitMap::RadiusToPixels(radiusMeters, config_.mapResolution);
+    if (!inflationVariants_ || radiusPixels == inflatedMap_->GetInflationRadiusPixels()) {
+        return *pathService_;
+    }
+    auto& service = classPathServices_[radiusPixels];
+    if (!service) {
+        service = std::make_unique<Layer3::Pathfinding::PathfindingService>();
+        configurePathService(*service, inflationVariants_->GetMap(radiusPixels),
+                             inflationVariants_->GetNavMesh(radiusPixels));
+    }
+    return *service;
+}
+
+void FleetManager::noteGoalTraffic(const std::vector<Layer2::Task>& tasks) {
+    if (config_.flowFieldGoals <= 0) return;
+    for (const Layer2::Task& task : tasks) {
+        goalTraffic_[task.destinationNode]++;
+    }
+    refreshFlowFieldGoals();
+}
+
+void FleetManager::refreshFlowFieldGoals() {
+    if (config_.flowFieldGoals <= 0 || !pathService_) return;
+    
+    // Busiest first; ties to the lower node, so a replay picks the same
+    const auto& nodes = navMesh_->GetAllNodes();
+    std::vector<std::pair<uint64_t, int>> ranked;
+    for (const auto& [node, count] : goalTraffic_) {
+        if (node >= 0 && static_cast<size_t>(node) < nodes.size()) ranked.emplace_back(count, node);
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    if (ranked.size() > static_cast<size_t>(config_.flowFieldGoals)) {
+        ranked.resize(static_cast<size_t>(config_.flowFieldGoals));
+    }
+    
+    std::vector<int> busiest;
+    for (const auto& entry : ranked) busiest.push_back(entry.second);
+    std::sort(busiest.begin(), busiest.end());
+    if (busiest == flowFieldNodes_) return;
+    flowFieldNodes_ = std::move(busiest);
+    
+    std::vector<Common::Coordinates> goals;
+    for (int node : flowFieldNodes_) goals.push_back(nodes[node].coords);
+    pathService_->SetFlowFieldGoals(goals);
+    for (auto& entry : classPathServices_) entry.second->SetFlowFieldGoals(goals);
+    if (!config_.batchMode) {
+        std::cout << "[Layer 3] Flow fields for the " << goals.size() << " busiest dropoff / charging goals\n";
+    }
+}
+
 void FleetManager::createRobots() {
     std::cout << "\n[FleetManager] ═══════════════ Creating Robots ═══════════════\n";
     
@@ -371,6 +967,15 @@ void FleetManager::createRobots() {
     
     std::cout << "[FleetManager] Creating " << numRobots << " robots...\n";
     
+    // Robot classes take the first robots in order, the rest has the default size
+    robotRadii_.assign(static_cast<size_t>(numRobots), config_.robotRadiusMeters);
+    size_t classed = 0;
+    for (const RobotClassConfig& robotClass : config_.robotClasses) {
+        for (int k = 0; k < robotClass.count && classed < robotRadii_.size(); ++k) {
+            robotRadii_[classed++] = robotClass.radiusMeters;
+        }
+    }
+    
     for (int i = 0; i < numRobots; ++i) {
         // Each robot gets its own unique charging station
         int startNode = chargingNodes[i];
@@ -382,13 +987,13 @@ void FleetManager::createRobots() {
             1.0f,                           // battery capacity
             chargingNodes[i],               // charging station (unique per robot)
             config_.robotSpeedMps,          // speed
-            1                               // capacity (packets)
+            std::max(1, config_.robotLoadCapacity)  // capacity (packets)
         );
         agent.SetCurrentNodeId(startNode);
         agent.SetStatus(Layer2::RobotStatus::IDLE);
         
         {
-            std::lock_guard<std::mutex> lock(fleetMutex_);
+            Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
             fleetRegistry_[i] = agent;
         }
         
@@ -396,26 +1001,46 @@ void FleetManager::createRobots() {
         auto driver = std::make_unique<Layer3::Core::RobotDriver>(
             i,
             startPos,
-            *navMesh_
+            *navMesh_,
+            pathServiceFor(robotRadii_[i])
         );
         
         // Set the current node ID so API reports valid targetNodeId from start
         driver->SetCurrentNodeId(startNode);
         
         // Configure driver with robot parameters
-        Layer3::Core::DriverConfig driverConfig;
-        driverConfig.maxSpeed = config_.robotSpeedMps * 10.0;  // m/s to decimeters/s
-        driverConfig.robotRadius = config_.robotRadiusMeters * 10.0;  // m to decimeters
-        driverConfig.waypointThreshold = 5.0;
-        driverConfig.goalThreshold = 3.0;
+        const double pixelsPerMeter = Common::GetPixelsPerMeter(config_.mapResolution);
+        auto driverConfig = Layer3::Core::DriverConfig::ForResolution(config_.mapResolution);
+        driverConfig.maxSpeed = config_.robotSpeedMps * pixelsPerMeter;
+        driverConfig.robotRadius = robotRadii_[i] * pixelsPerMeter;
         driver->SetConfig(driverConfig);
         
+        auto orcaConfig = Layer3::Physics::ORCAConfig::ForResolution(config_.mapResolution);
+        orcaConfig.maxSpeed = driverConfig.maxSpeed;
+        orcaConfig.timeStep = config_.orcaTickMs / 1000.0;
+        if (config_.orcaHalfPlanes) {
+            orcaConfig.method = Layer3::Physics::AvoidanceMethod::HALF_PLANES;
+        }
+        driver->SetORCAConfig(orcaConfig);
+        
         // Set goal reached callback
         driver->SetOnGoalReached([this](int robotId, int goalNode) {
             std::cout << "[FleetManager] Robot " << robotId << " reached node " << goalNode << "\n";
             
-            // Track waypoints for task completion (2 waypoints = 1 task)
-            totalWaypointsVisited_.fetch_add(1);
+            // Track waypoints for task completion (2 waypoints = 1 task);
+            // a holding spot is none
+            bool positioning = robotId >= 0 && static_cast<size_t>(robotId) < positioningGoals_.size() &&
+                               positioningGoals_[robotId] == goalNode;
+            if (positioning) {
+                positioningGoals_[robotId] = -1;
+            } else {
+                totalWaypointsVisited_.fetch_add(1);
+            }
+            
+            // Invoked inside the tick: ticks completed so far
+            uint64_t tick = static_cast<uint64_t>(stats_.fleetLoopCount);
+            if (eventLog_) eventLog_->LogGoalReached(tick, robotId, goalNode);
+            if (replaying_) compareReplayGoal(tick, robotId, goalNode);
             
             // Update package state based on POI type
             // NOTE: No lock needed here - callback is invoked from runFleetLoop which already holds fleetMutex_
@@ -423,15 +1048,18 @@ void FleetManager::createRobots() {
                 if (robotId >= 0 && robotId < static_cast<int>(drivers_.size())) {
                     auto& driver = drivers_[robotId];
                     
+                    // Multi-pick batches pick several packages up before the first dropoff
                     if (poiRegistry_->NodeHasPOIType(goalNode, Layer1::POIType::PICKUP)) {
-                        driver->SetHasPackage(true);
-                        std::cout << "[FleetManager] Robot " << robotId << " picked up package at node " << goalNode << "\n";
+                        driver->SetLoadCount(driver->GetLoadCount() + 1);
+                        std::cout << "[FleetManager] Robot " << robotId << " picked up package at node " << goalNode
+                                  << " (" << driver->GetLoadCount() << " on board)\n";
                     }
                     else if (poiRegistry_->NodeHasPOIType(goalNode, Layer1::POIType::DROPOFF)) {
-                        driver->SetHasPackage(false);
-                        std::cout << "[FleetManager] Robot " << robotId << " dropped off package at node " << goalNode << "\n";
+                        driver->SetLoadCount(driver->GetLoadCount() - 1);
+                        std::cout << "[FleetManager] Robot " << robotId << " dropped off package at node " << goalNode
+                                  << " (" << driver->GetLoadCount() << " on board)\n";
                     }
-                    // If it's a CHARGING station or intermediate waypoint, hasPackage stays the same
+                    // If it's a CHARGING station or intermediate waypoint, the load stays the same
                 }
             }
             
@@ -440,7 +1068,7 @@ void FleetManager::createRobots() {
         });
         
         {
-            std::lock_guard<std::mutex> lock(fleetMutex_);
+            Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
             drivers_.push_back(std::move(driver));
         }
         
@@ -448,142 +1076,687 @@ void FleetManager::createRobots() {
                   << ", Position=(" << startPos.x << "," << startPos.y << ")\n";
     }
     
+    // Every robot charges at its home station: the first flow fields,
+    // until tasks show which dropoffs are busier
+    if (config_.flowFieldGoals > 0) {
+        for (int i = 0; i < numRobots; ++i) goalTraffic_[chargingNodes[i]]++;
+        refreshFlowFieldGoals();
+    }
+    
+    {
+        Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
+        publishFleetSnapshot();
+    }
+    
     std::cout << "[FleetManager] " << numRobots << " robots created\n";
 }
 
 // =============================================================================
-// TASK MANAGEMENT
+// CHECKPOINTS
 // =============================================================================
 
-int FleetManager::LoadTasks(const std::string& filepath) {
-    std::cout << "\n[FleetManager] Loading tasks from: " << filepath << "\n";
+std::string FleetManager::getCheckpointFile() const {
+    if (std::filesystem::path(config_.checkpointPath).is_absolute()) return config_.checkpointPath;
+    return basePath_ + "/" + config_.checkpointPath;
+}
+
+bool FleetManager::RestoreCheckpoint() {
+    if (config_.checkpointPath.empty() || running_.load()) return false;
     
-    if (!poiRegistry_) {
-        std::cerr << "[FleetManager] ERROR: POIRegistry not initialized!\n";
-        return 0;
+    std::string path = getCheckpointFile();
+    FleetCheckpoint checkpoint;
+    if (!FleetCheckpoint::Load(path, meshFingerprint_, checkpoint)) {
+        std::cout << "[Checkpoint] No checkpoint of this map at " << path << "\n";
+        return false;
     }
     
-    std::vector<Layer2::Task> tasks = Layer2::TaskLoader::LoadTasksWithPOI(
-        filepath, *navMesh_, *poiRegistry_
-    );
+    // Node IDs must exist and every robot must still be in the fleet
+    const int nodeCount = static_cast<int>(navMesh_->GetAllNodes().size());
+    auto validNode = [nodeCount](int node) { return node >= 0 && node < nodeCount; };
+    bool valid = true;
+    for (const auto& robot : checkpoint.robots) {
+        valid = valid && fleetRegistry_.count(robot.id) > 0 &&
+                robot.id < static_cast<int>(drivers_.size()) && validNode(robot.currentNodeId) &&
+                std::all_of(robot.itinerary.begin(), robot.itinerary.end(), validNode);
+    }
+    for (const auto* tasks : {&checkpoint.pendingTasks, &checkpoint.queuedTasks}) {
+        for (const auto& task : *tasks) {
+            valid = valid && validNode(task.sourceNode) && validNode(task.destinationNode);
+        }
+    }
+    if (!valid) {
+        std::cerr << "[Checkpoint] " << path << " does not match this fleet, starting fresh\n";
+        return false;
+    }
     
+    size_t goals = 0;
     {
-        std::lock_guard<std::mutex> lock(taskMutex_);
-        pendingTasks_ = tasks;
-        stats_.totalTasks = static_cast<int>(tasks.size());
-        stats_.pendingTasks = static_cast<int>(tasks.size());
+        Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
+        for (const auto& robot : checkpoint.robots) {
+            auto& agent = fleetRegistry_[robot.id];
+            agent.SetCurrentNodeId(robot.currentNodeId);
+            agent.SetStatus(Layer2::RobotStatus::IDLE);
+            goals += robot.itinerary.size();
+            agent.AssignItinerary(robot.itinerary);
+            
+            // The driver plans a path to its first goal on the next tick
+            auto& driver = *drivers_[robot.id];
+            driver.SetPosition({robot.positionX, robot.positionY});
+            driver.SetCurrentNodeId(robot.currentNodeId);
+            driver.SetLoadCount(robot.loadCount);
+        }
+        publishPlan("checkpoint restore");
     }
     
-    std::cout << "[FleetManager] Loaded " << tasks.size() << " tasks\n";
-    return static_cast<int>(tasks.size());
-}
-
-void FleetManager::AddTask(const Layer2::Task& task) {
-    std::lock_guard<std::mutex> lock(taskMutex_);
-    pendingTasks_.push_back(task);
-    stats_.totalTasks++;
-    stats_.pendingTasks++;
-}
-
-int FleetManager::GetPendingTaskCount() const {
-    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(taskMutex_));
-    return static_cast<int>(pendingTasks_.size());
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        pendingTasks_ = checkpoint.pendingTasks;
+        // Queued tasks are counted again when the main loop takes them in
+        stats_.totalTasks = checkpoint.totalTasks - static_cast<int>(checkpoint.queuedTasks.size());
+        stats_.pendingTasks = static_cast<int>(pendingTasks_.size());
+    }
+    totalWaypointsVisited_ = checkpoint.waypointsVisited;
+    nextTaskId_ = std::max(nextTaskId_.load(), checkpoint.nextTaskId);
+    checkpointSequence_ = checkpoint.sequence + 1;
+    
+    std::cout << "[Checkpoint] Restored checkpoint " << checkpoint.sequence << " from " << path << ": "
+              << checkpoint.robots.size() << " robots with " << goals << " goals, "
+              << checkpoint.pendingTasks.size() << " pending and "
+              << checkpoint.queuedTasks.size() << " queued tasks\n";
+    if (!checkpoint.queuedTasks.empty()) {
+        InjectTasks(checkpoint.queuedTasks);
+    }
+    return true;
 }
 
-void FleetManager::InjectTasks(const std::vector<Layer2::Task>& tasks) {
-    if (tasks.empty()) return;
+std::shared_ptr<FleetCheckpoint> FleetManager::captureCheckpoint() const {
+    // Both snapshots are immutable: nothing here waits for the fleet loop
+    std::shared_ptr<const PlanSnapshot> plan = std::atomic_load(&planSnapshot_);
+    std::shared_ptr<const FleetSnapshot> fleet = GetFleetSnapshot();
+    if (!fleet || fleet->planVersion != (plan ? plan->version : 0)) return nullptr;
+    
+    auto checkpoint = std::make_shared<FleetCheckpoint>();
+    checkpoint->meshFingerprint = meshFingerprint_;
+    checkpoint->nextTaskId = nextTaskId_.load();
+    checkpoint->waypointsVisited = totalWaypointsVisited_.load();
+    checkpoint->robots.reserve(fleet->robots.size());
+    for (const auto& robot : fleet->robots) {
+        FleetCheckpoint::Robot saved;
+        saved.id = robot.id;
+        saved.status = robot.status;
+        saved.currentNodeId = robot.currentNodeId;
+        saved.positionX = robot.position.x;
+        saved.positionY = robot.position.y;
+        saved.loadCount = robot.loadCount;
+        
+        // The goal being driven to, then the plan's goals not handed out yet
+        // (goals leave the front of a plan's itinerary until the next plan)
+        bool driving = robot.driverState != Layer3::Core::DriverState::IDLE &&
+                       robot.driverState != Layer3::Core::DriverState::ARRIVED;
+        if (driving && robot.targetNodeId >= 0) {
+            saved.itinerary.push_back(robot.targetNodeId);
+        }
+        if (plan) {
+            auto it = plan->itineraries.find(robot.id);
+            if (it != plan->itineraries.end()) {
+                size_t remaining = std::min(static_cast<size_t>(std::max(0, robot.remainingWaypoints)),
+                                            it->second.size());
+                saved.itinerary.insert(saved.itinerary.end(), it->second.end() - remaining, it->second.end());
+            }
+        }
+        checkpoint->robots.push_back(std::move(saved));
+    }
     
-    std::lock_guard<std::mutex> lock(injectionMutex_);
-    for (const auto& task : tasks) {
-        injectionQueue_.push(task);
+    {
+        std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(taskMutex_));
+        checkpoint->pendingTasks = pendingTasks_;
+        checkpoint->totalTasks = stats_.totalTasks;
     }
     
-    std::cout << "[FleetManager] Injected " << tasks.size() << " new tasks (queue size: " 
-              << injectionQueue_.size() << ")\n";
+    // Injected tasks not in any itinerary yet: those of a running replan
+    // (a horizon replan also re-plans queued work, only its batch is new)
+    // and those waiting for one
+    auto& queued = checkpoint->queuedTasks;
+    if (replanInProgress_.load() && !replanIsHorizon_) {
+        queued.insert(queued.end(), replanTasks_.begin(), replanTasks_.end());
+    }
+    if (replanInProgress_.load() && replanIsHorizon_) {
+        queued.insert(queued.end(), horizonBatch_.begin(), horizonBatch_.end());
+    }
+    queued.insert(queued.end(), replanMergeTasks_.begin(), replanMergeTasks_.end());
+    queued.insert(queued.end(), horizonTasks_.begin(), horizonTasks_.end());
+    return checkpoint;
 }
 
-void FleetManager::InjectTask(int sourceNodeId, int destNodeId) {
-    Layer2::Task task;
-    task.taskId = nextTaskId_.fetch_add(1);
-    task.sourceNode = sourceNodeId;
-    task.destinationNode = destNodeId;
+void FleetManager::checkMemoryReport() {
+    if (config_.memoryReportIntervalMs <= 0) return;
     
-    std::lock_guard<std::mutex> lock(injectionMutex_);
-    injectionQueue_.push(task);
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastMemoryReportAt_ < std::chrono::milliseconds(config_.memoryReportIntervalMs)) return;
+    lastMemoryReportAt_ = now;
     
-    std::cout << "[FleetManager] Injected task " << task.taskId 
-              << " (" << sourceNodeId << " → " << destNodeId << ")\n";
+    TRACE_ZONE("MemoryReport", "main");
+    auto report = std::make_shared<const Common::MemoryReport>(GetMemoryReport());
+    if (!config_.batchMode) PrintMemoryReport(*report);
+    std::atomic_store(&memoryReport_, std::move(report));
 }
 
-int FleetManager::GetInjectionQueueSize() const {
-    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(injectionMutex_));
-    return static_cast<int>(injectionQueue_.size());
+void FleetManager::checkCheckpoint() {
+    if (config_.checkpointPath.empty()) return;
+    
+    // One write at a time; a slow disk delays checkpoints, never the loop
+    if (checkpointFuture_.valid()) {
+        if (checkpointFuture_.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) return;
+        if (checkpointFuture_.get()) {
+            checkpointsWritten_++;
+        } else {
+            checkpointFailures_++;
+        }
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastCheckpointAt_ < std::chrono::milliseconds(config_.checkpointIntervalMs)) return;
+    
+    std::shared_ptr<FleetCheckpoint> checkpoint = captureCheckpoint();
+    if (!checkpoint) return;
+    checkpoint->sequence = checkpointSequence_++;
+    lastCheckpointAt_ = now;
+    
+    std::string path = getCheckpointFile();
+    checkpointFuture_ = taskScheduler_->Submit(Common::TaskPriority::LOW, [this, checkpoint, path]() {
+        threadPlacement_.Apply(ThreadRole::IO);
+        TRACE_ZONE("WriteCheckpoint", "main");
+        return FleetCheckpoint::Save(path, *checkpoint);
+    });
 }
 
-bool FleetManager::IsAllTasksComplete() const {
-    // Check injection queue
-    {
-        std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(injectionMutex_));
-        if (!injectionQueue_.empty()) {
+// =============================================================================
+// THREAD PLACEMENT
+// =============================================================================
+
+void FleetManager::initializeThreadPlacement() {
+    threadPlacement_.Resolve(config_.threadPlacement);
+    if (!threadPlacement_.IsActive()) return;
+    std::cout << threadPlacement_.Describe();
+    
+    // Planning bursts get the solver CPUs and no more, whatever else asked for
+    int solverCpus = static_cast<int>(threadPlacement_.GetCpuCount(ThreadRole::SOLVER));
+    if (config_.solverPortfolioSize > solverCpus) {
+        std::cout << "[Threads] Solver portfolio capped from " << config_.solverPortfolioSize
+                  << " to " << solverCpus << " (solver CPUs)\n";
+        config_.solverPortfolioSize = solverCpus;
+    }
+    if (config_.pathfindingThreads > solverCpus) {
+        std::cout << "[Threads] Path workers capped from " << config_.pathfindingThreads
+                  << " to " << solverCpus << " (solver CPUs)\n";
+        config_.pathfindingThreads = solverCpus;
+    }
+    if (config_.backgroundThreads == 0 || config_.backgroundThreads > solverCpus) {
+        std::cout << "[Threads] Background workers capped to " << solverCpus << " (solver CPUs)\n";
+        config_.backgroundThreads = solverCpus;
+    }
+}
+
+// =============================================================================
+// EVENT LOG AND REPLAY
+// =============================================================================
+
+bool FleetManager::initializeEventLog() {
+    EventLogHeader header;
+    header.meshFingerprint = meshFingerprint_;
+    header.robotCount = static_cast<int>(drivers_.size());
+    header.tickMs = config_.orcaTickMs;
+    
+    if (!config_.replayPath.empty()) {
+        EventLogHeader logged;
+        if (!EventLog::Read(config_.replayPath, logged, replayEvents_)) {
+            std::cerr << "[Replay] Not an event log: " << config_.replayPath << "\n";
             return false;
         }
-    }
-    
-    // Check pending tasks
-    {
-        std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(taskMutex_));
-        if (!pendingTasks_.empty()) {
+        if (logged.meshFingerprint != header.meshFingerprint || logged.robotCount != header.robotCount) {
+            std::cerr << "[Replay] " << config_.replayPath << " was recorded on another map or fleet ("
+                      << logged.robotCount << " robots)\n";
             return false;
         }
-    }
-    
-    // Check if background re-plan is in progress
-    if (replanInProgress_.load()) {
-        return false;
-    }
-    
-    // Check all robots are IDLE with empty itineraries
-    {
-        std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(fleetMutex_));
-        for (const auto& [id, agent] : fleetRegistry_) {
-            // Check if robot has pending waypoints
-            if (!agent.GetItinerary().empty()) {
-                return false;
-            }
-            // Check if robot is still busy
-            if (agent.GetStatus() != Layer2::RobotStatus::IDLE) {
-                return false;
-            }
+        if (logged.tickMs != header.tickMs) {
+            std::cout << "[Replay] WARNING: recorded at " << logged.tickMs << " ms per tick, replaying at "
+                      << header.tickMs << " ms\n";
+        }
+        if (config_.rollingHorizon) {
+            std::cout << "[Replay] WARNING: horizon windows close on wall-clock time, runs may differ\n";
         }
         
-        // Also check drivers are IDLE or ARRIVED
-        for (const auto& driver : drivers_) {
-            if (driver) {
-                auto state = driver->GetState();
-                if (state != Layer3::Core::DriverState::IDLE && 
-                    state != Layer3::Core::DriverState::ARRIVED) {
-                    return false;
-                }
+        replayGoals_.assign(drivers_.size(), {});
+        replayGoalCursor_.assign(drivers_.size(), 0);
+        size_t inputs = 0;
+        for (const auto& event : replayEvents_) {
+            if (event.IsInput()) {
+                inputs++;
+            } else if (event.robotId >= 0 && static_cast<size_t>(event.robotId) < replayGoals_.size()) {
+                replayGoals_[event.robotId].emplace_back(event.tick, event.nodeId);
             }
         }
+        replaying_ = true;
+        replayInputsLeft_ = inputs;
+        replayHoldTick_ = 0;    // Inputs logged before the first tick come first
+        std::cout << "[Replay] " << replayEvents_.size() << " events (" << inputs << " inputs) over "
+                  << (replayEvents_.empty() ? 0 : replayEvents_.back().tick) << " ticks from "
+                  << config_.replayPath << "\n";
     }
     
+    if (!config_.eventLogPath.empty()) {
+        eventLog_ = std::make_unique<EventLog>();
+        if (!eventLog_->Open(config_.eventLogPath, header)) {
+            eventLog_.reset();
+            return false;
+        }
+        std::cout << "[EventLog] Recording to " << config_.eventLogPath << "\n";
+    }
     return true;
 }
 
-// =============================================================================
+uint64_t FleetManager::getFleetTick() const {
+    auto fleet = GetFleetSnapshot();
+    return fleet ? static_cast<uint64_t>(fleet->fleetLoopCount) : 0;
+}
+
+void FleetManager::runReplayStep() {
+    TRACE_ZONE("ReplayStep", "main");
+    // The fleet loop is held at the next input's tick, so this is exact
+    const uint64_t tick = getFleetTick();
+    while (replayCursor_ < replayEvents_.size() && replayEvents_[replayCursor_].tick <= tick) {
+        const LoggedEvent& event = replayEvents_[replayCursor_++];
+        switch (event.type) {
+            case EventType::TASKS_ADDED: {
+                {
+                    std::lock_guard<std::mutex> lock(taskMutex_);
+                    pendingTasks_.insert(pendingTasks_.end(), event.tasks.begin(), event.tasks.end());
+                    stats_.totalTasks += static_cast<int>(event.tasks.size());
+                    stats_.pendingTasks = static_cast<int>(pendingTasks_.size());
+                }
+                if (eventLog_) eventLog_->LogTasks(EventType::TASKS_ADDED, tick, event.tasks);
+                break;
+            }
+            case EventType::TASK_BATCH:
+                processTaskBatch(event.tasks);
+                break;
+            case EventType::FULL_SOLVE:
+                runVRPSolver();
+                initialSolveComplete_ = true;
+                break;
+            case EventType::REPLAN_FINISHED:
+                // Taken at the logged tick however long the solve takes here
+                if (replanInProgress_.load()) {
+                    replanFuture_.wait();
+                    checkBackgroundReplan();
+                } else {
+                    replayMissedReplans_++;
+                }
+                break;
+            case EventType::GOAL_REACHED:
+                continue;
+        }
+        replayInputsLeft_--;
+    }
+    
+    // Outcomes need no stop: run up to the next input
+    while (replayCursor_ < replayEvents_.size() && !replayEvents_[replayCursor_].IsInput()) {
+        replayCursor_++;
+    }
+    replayHoldTick_.store(replayCursor_ < replayEvents_.size() ? replayEvents_[replayCursor_].tick : UINT64_MAX,
+                          std::memory_order_release);
+}
+
+void FleetManager::compareReplayGoal(uint64_t tick, int robotId, int nodeId) {
+    if (robotId < 0 || static_cast<size_t>(robotId) >= replayGoals_.size()) return;
+    size_t next = replayGoalCursor_[robotId]++;
+    const auto& logged = replayGoals_[robotId];
+    if (next >= logged.size()) {
+        replayGoalsBeyondLog_++;    // The recording stopped before this robot got here
+        return;
+    }
+    if (logged[next].first == tick && logged[next].second == nodeId) {
+        replayGoalsMatched_++;
+    } else {
+        replayGoalsDiverged_++;
+        replayFirstDivergence_ = std::min(replayFirstDivergence_, tick);
+    }
+}
+
+// =============================================================================
+// TASK MANAGEMENT
+// =============================================================================
+
+int FleetManager::LoadTasks(const std::string& filepath) {
+    std::cout << "\n[FleetManager] Loading tasks from: " << filepath << "\n";
+    
+    if (!poiRegistry_) {
+        std::cerr << "[FleetManager] ERROR: POIRegistry not initialized!\n";
+        return 0;
+    }
+    
+    std::vector<Layer2::Task> tasks = Layer2::TaskLoader::LoadTasksWithPOI(
+        filepath, *navMesh_, *poiRegistry_
+    );
+    
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        pendingTasks_ = tasks;
+        stats_.totalTasks = static_cast<int>(tasks.size());
+        stats_.pendingTasks = static_cast<int>(tasks.size());
+    }
+    if (eventLog_) eventLog_->LogTasks(EventType::TASKS_ADDED, getFleetTick(), tasks);
+    
+    std::cout << "[FleetManager] Loaded " << tasks.size() << " tasks\n";
+    return static_cast<int>(tasks.size());
+}
+
+void FleetManager::AddTask(const Layer2::Task& task) {
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        pendingTasks_.push_back(task);
+        stats_.totalTasks++;
+        stats_.pendingTasks++;
+    }
+    if (eventLog_) eventLog_->LogTasks(EventType::TASKS_ADDED, getFleetTick(), {task});
+}
+
+int FleetManager::GetPendingTaskCount() const {
+    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(taskMutex_));
+    return static_cast<int>(pendingTasks_.size());
+}
+
+size_t FleetManager::InjectTasks(const std::vector<Layer2::Task>& tasks) {
+    if (tasks.empty()) return 0;
+    
+    // In order until the queue is full: the caller retries the rest
+    size_t queued = 0;
+    for (const auto& task : tasks) {
+        Layer2::Task copy = task;
+        if (!injectionQueue_.TryPush(copy)) break;
+        queued++;
+    }
+    
+    std::cout << "[FleetManager] Injected " << queued << " new tasks (queue size: " 
+              << injectionQueue_.SizeApprox() << ")\n";
+    if (queued < tasks.size()) {
+        injectionsRefused_.fetch_add(tasks.size() - queued, std::memory_order_relaxed);
+        std::cout << "[FleetManager] WARNING: Injection queue full, refused "
+                  << tasks.size() - queued << " tasks\n";
+    }
+    return queued;
+}
+
+void FleetManager::startTaskIngestion() {
+    auto makeServer = [this]() {
+        return std::make_unique<TaskIngestServer>(
+            [this](std::string_view document, size_t capacity) { return ingestBatch(document, capacity); },
+            [this]() { return injectionQueue_.SizeApprox() + static_cast<size_t>(GetPendingTaskCount()); },
+            static_cast<size_t>(std::max(1, config_.ingestMaxBacklog)));
+    };
+    auto placement = [this]() { threadPlacement_.Apply(ThreadRole::IO); };
+    
+    if (config_.ingestPort > 0) {
+        auto server = makeServer();
+        if (server->Start(config_.ingestPort, config_.ingestAddress, placement)) {
+            ingestServers_.push_back(std::move(server));
+        } else {
+            std::cerr << "[FleetManager] Warning: task ingestion not started on port " << config_.ingestPort << "\n";
+        }
+    }
+    if (!config_.ingestSocketPath.empty()) {
+        auto server = makeServer();
+        if (server->StartUnix(config_.ingestSocketPath, placement)) {
+            ingestServers_.push_back(std::move(server));
+        } else {
+            std::cerr << "[FleetManager] Warning: task ingestion not started on " << config_.ingestSocketPath << "\n";
+        }
+    }
+}
+
+TaskIngestResult FleetManager::ingestBatch(std::string_view document, size_t capacity) {
+    TaskIngestResult result;
+    std::vector<Layer2::Task> tasks =
+        Layer2::TaskLoader::ParseTasksWithPOI(document, *navMesh_, *poiRegistry_, &result.rejected, &result.error);
+    
+    // The batch's ids are its own; the fleet numbers tasks itself
+    std::vector<int> batchIds;
+    batchIds.reserve(tasks.size());
+    for (auto& task : tasks) batchIds.push_back(task.taskId);
+    tasks.resize(std::min(capacity, tasks.size()));
+    for (auto& task : tasks) task.taskId = nextTaskId_.fetch_add(1);
+    
+    // A prefix goes in; the rest (queue full, then over capacity) is refused in order
+    size_t queued = InjectTasks(tasks);
+    for (size_t i = 0; i < queued; ++i) {
+        result.ids.push_back(batchIds[i]);
+        result.taskIds.push_back(tasks[i].taskId);
+    }
+    result.refusedIds.assign(batchIds.begin() + static_cast<long>(queued), batchIds.end());
+    return result;
+}
+
+bool FleetManager::InjectTask(int sourceNodeId, int destNodeId) {
+    Layer2::Task task;
+    task.taskId = nextTaskId_.fetch_add(1);
+    task.sourceNode = sourceNodeId;
+    task.destinationNode = destNodeId;
+    int taskId = task.taskId;
+    
+    if (!injectionQueue_.TryPush(task)) {
+        injectionsRefused_.fetch_add(1, std::memory_order_relaxed);
+        std::cout << "[FleetManager] WARNING: Injection queue full, refused task " << taskId << "\n";
+        return false;
+    }
+    
+    std::cout << "[FleetManager] Injected task " << taskId 
+              << " (" << sourceNodeId << " → " << destNodeId << ")\n";
+    return true;
+}
+
+int FleetManager::GetInjectionQueueSize() const {
+    return static_cast<int>(injectionQueue_.SizeApprox());
+}
+
+bool FleetManager::IsAllTasksComplete() const {
+    // A replay is done once every logged input was acted on
+    if (replayInputsLeft_.load() > 0) {
+        return false;
+    }
+    
+    // Check injection queue
+    if (!injectionQueue_.EmptyApprox()) {
+        return false;
+    }
+    
+    // Check pending tasks
+    {
+        std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(taskMutex_));
+        if (!pendingTasks_.empty()) {
+            return false;
+        }
+    }
+    
+    // Check if background re-plan is in progress
+    if (replanInProgress_.load()) {
+        return false;
+    }
+    
+    // Check all robots are IDLE with empty itineraries and their drivers
+    // IDLE or ARRIVED
+    auto fleet = GetFleetSnapshot();
+    if (!fleet) {
+        return false;
+    }
+    for (const auto& robot : fleet->robots) {
+        if (robot.remainingWaypoints > 0 || robot.status != Layer2::RobotStatus::IDLE) {
+            return false;
+        }
+        if (robot.driverState != Layer3::Core::DriverState::IDLE &&
+            robot.driverState != Layer3::Core::DriverState::ARRIVED) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+// =============================================================================
 // MONITORING
 // =============================================================================
 
 FleetStats FleetManager::GetStats() const {
     auto now = std::chrono::steady_clock::now();
     FleetStats stats = stats_;
+    stats.mainLoopTiming = mainLoopScheduler_.GetStats();
+    stats.fleetLoopTiming = fleetLoopScheduler_.GetStats();
+    stats.obstacleLoopTiming = obstacleLoopScheduler_.GetStats();
     stats.simulationTime = std::chrono::duration<double>(now - startTime_).count();
     // Compute completed tasks from waypoint counter (2 waypoints = 1 task)
     stats.completedTasks = totalWaypointsVisited_.load() / 2;
     return stats;
 }
 
+ReplayStats FleetManager::GetReplayStats() const {
+    ReplayStats replay;
+    for (const auto& goals : replayGoals_) replay.loggedGoals += goals.size();
+    replay.matched = replayGoalsMatched_;
+    replay.diverged = replayGoalsDiverged_;
+    replay.beyondLog = replayGoalsBeyondLog_;
+    replay.missedReplans = replayMissedReplans_;
+    return replay;
+}
+
+std::vector<API::LatencyMetric> FleetManager::GetLatencyMetrics() const {
+    std::vector<API::LatencyMetric> metrics = {
+        {"physics_tick", "Fleet loop work per 20 Hz tick", physicsTickLatency_.GetSummary()},
+        {"main_tick", "Main loop work per tick", mainTickLatency_.GetSummary()},
+        {"replan_solve", "Background VRP solve", replanSolveLatency_.GetSummary()},
+        {"api_write", "Telemetry and robots.json write", apiWriteLatency_.GetSummary()},
+    };
+    if (pathService_) {
+        metrics.push_back({"path_query", "Path query (flow field, cache or Theta* search)",
+                           pathService_->GetQueryLatency().GetSummary()});
+    }
+    if (costMatrix_) {
+        metrics.push_back({"cost_matrix_miss", "On-demand search for a pair outside the cost matrix",
+                           costMatrix_->GetMissLatency().GetSummary()});
+    }
+    return metrics;
+}
+
+Common::MemoryReport FleetManager::GetMemoryReport() {
+    using Common::MemoryReport;
+    using Common::VectorBytes;
+    using Common::HashMapBytes;
+    MemoryReport report;
+    report.timestamp = stats_.fleetLoopCount * config_.orcaTickMs / 1000.0;
+    report.rssBytes = Common::ReadResidentBytes();
+    
+    // Map: sized by the pixel grid and the mesh cut from it (fixed after
+    // startup; the obstacle loop only rewrites contents)
+    if (staticMap_) {
+        auto [width, height] = staticMap_->GetDimensions();
+        report.mapPixels = static_cast<size_t>(width) * height;
+        report.Add("static_map", MemoryReport::Scale::MAP, staticMap_->GetMemoryBytes());
+    }
+    if (inflatedMap_) report.Add("inflated_map", MemoryReport::Scale::MAP, inflatedMap_->GetMemoryBytes());
+    if (inflationVariants_) {
+        report.Add("inflation_variants", MemoryReport::Scale::MAP, inflationVariants_->GetMemoryBytes());
+    }
+    if (dynamicMap_) report.Add("dynamic_map", MemoryReport::Scale::MAP, dynamicMap_->GetMemoryBytes());
+    if (navMesh_) report.Add("navmesh", MemoryReport::Scale::MAP, navMesh_->GetMemoryBytes());
+    if (navHierarchy_) report.Add("nav_hierarchy", MemoryReport::Scale::MAP, navHierarchy_->GetMemoryBytes());
+    if (congestionMap_) {
+        report.Add("congestion_map", MemoryReport::Scale::MAP,
+                   congestionMap_->GetMemoryBytes() + VectorBytes(congestionPenalties_));
+    }
+    
+    // POIs: the registry and the POI x POI cost matrix
+    if (poiRegistry_) {
+        report.pois = poiRegistry_->GetPOICount();
+        report.Add("poi_registry", MemoryReport::Scale::POI, poiRegistry_->GetMemoryBytes());
+    }
+    if (costMatrix_) report.Add("cost_matrix", MemoryReport::Scale::POI, costMatrix_->GetMemoryBytes());
+    if (poiSchedule_) report.Add("poi_schedule", MemoryReport::Scale::POI, poiSchedule_->GetMemoryBytes());
+    if (demandForecast_) {
+        auto expected = std::atomic_load(&expectedPickups_);
+        report.Add("demand_forecast", MemoryReport::Scale::POI,
+                   demandForecast_->GetMemoryBytes() + (expected ? VectorBytes(*expected) : 0));
+    }
+    
+    // Robots: drivers, agents and the fleet loop's per-robot scratch
+    {
+        std::lock_guard<std::mutex> lock(fleetMutex_);
+        size_t driverBytes = VectorBytes(drivers_);
+        for (const auto& driver : drivers_) {
+            if (!driver) continue;
+            report.robots++;
+            driverBytes += driver->GetMemoryBytes();
+        }
+        report.Add("drivers", MemoryReport::Scale::ROBOT, driverBytes);
+        if (pathIndex_) report.Add("path_index", MemoryReport::Scale::ROBOT, pathIndex_->GetMemoryBytes());
+        
+        // A map node is the pair plus three links and a colour
+        const size_t agentNode = sizeof(std::pair<const int, Layer2::RobotAgent>) + 4 * sizeof(void*);
+        report.Add("fleet_registry", MemoryReport::Scale::ROBOT, fleetRegistry_.size() * agentNode);
+        
+        size_t physicsBytes = neighborGrid_.GetMemoryBytes() + tickObstacles_.GetMemoryBytes() +
+                              neighbors_.GetMemoryBytes() + VectorBytes(tickObstacleOf_) +
+                              VectorBytes(neighborIndices_) + VectorBytes(driverTickDebt_) +
+                              VectorBytes(driverTicksToSkip_) + VectorBytes(driverStepDt_) +
+                              VectorBytes(physicsZones_) + VectorBytes(busyZones_) +
+                              VectorBytes(driverZone_) + VectorBytes(driverSubsteps_) +
+                              VectorBytes(deadlockRobots_) + VectorBytes(publishedPathVersions_) +
+                              VectorBytes(congestionTracks_) + VectorBytes(positioningGoals_) +
+                              VectorBytes(repositionTargets_) + HashMapBytes(parkingSpots_);
+        for (const auto& zone : physicsZones_) {
+            physicsBytes += VectorBytes(zone.drivers) + VectorBytes(zone.indices) + zone.neighbors.GetMemoryBytes();
+        }
+        report.Add("physics_scratch", MemoryReport::Scale::ROBOT, physicsBytes);
+    }
+    report.Add("api", MemoryReport::Scale::ROBOT, apiService_.GetMemoryBytes() +
+               historyBytes_.load(std::memory_order_relaxed));
+    
+    // Workload: paths and tasks in flight
+    if (pathService_) {
+        size_t serviceBytes = pathService_->GetMemoryBytes();
+        for (const auto& entry : classPathServices_) serviceBytes += entry.second->GetMemoryBytes();
+        report.Add("path_service", MemoryReport::Scale::OTHER, serviceBytes);
+    }
+    report.Add("search_workspaces", MemoryReport::Scale::OTHER,
+               Layer3::Pathfinding::ThetaStarSolver::SearchWorkspace::GetLiveBytes());
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        report.Add("pending_tasks", MemoryReport::Scale::OTHER,
+                   VectorBytes(pendingTasks_) + VectorBytes(horizonTasks_) + VectorBytes(replanTasks_));
+    }
+    return report;
+}
+
+void FleetManager::PrintMemoryReport(const Common::MemoryReport& report) {
+    using Common::MemoryReport;
+    auto kib = [](double bytes) { return bytes / 1024.0; };
+    
+    std::vector<MemoryReport::Entry> entries = report.entries;
+    std::sort(entries.begin(), entries.end(),
+              [](const MemoryReport::Entry& a, const MemoryReport::Entry& b) { return a.bytes > b.bytes; });
+    
+    std::cout << std::fixed << std::setprecision(1)
+              << "[Memory] " << kib(report.GetTotalBytes()) << " KiB tracked";
+    if (report.rssBytes > 0) std::cout << ", " << kib(report.rssBytes) << " KiB resident";
+    std::cout << " at t=" << report.timestamp << " s\n";
+    for (const auto& entry : entries) {
+        std::cout << "  - " << std::left << std::setw(18) << entry.name << std::setw(6)
+                  << MemoryReport::ScaleName(entry.scale) << std::right << std::setw(12)
+                  << kib(entry.bytes) << " KiB\n";
+    }
+    std::cout << "  = " << std::setprecision(2)
+              << report.GetBytesPerPixel() << " B per map pixel (" << report.mapPixels << "), "
+              << report.GetBytesPerPOI() << " B per POI (" << report.pois << "), "
+              << report.GetBytesPerRobot() << " B per robot (" << report.robots << ")\n";
+}
+
 void FleetManager::PrintRobotStates() const {
     std::cout << "\n╔═══════════════════════════════════════════════════════════════════════════╗\n";
     std::cout << "║                           ROBOT STATES                                    ║\n";
@@ -591,25 +1764,19 @@ void FleetManager::PrintRobotStates() const {
     std::cout << "║  ID │  Status   │ L2 Node │    L3 Position    │ L3 State     │ Itinerary ║\n";
     std::cout << "╠═══════════════════════════════════════════════════════════════════════════╣\n";
     
-    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(fleetMutex_));
-    
-    for (const auto& [id, agent] : fleetRegistry_) {
-        const auto* driver = GetRobotDriver(id);
-        
-        std::cout << "║ " << std::setw(3) << id 
-                  << " │ " << std::setw(9) << Layer2::StatusToString(agent.GetStatus())
-                  << " │ " << std::setw(7) << agent.GetCurrentNodeId()
-                  << " │ ";
-        
-        if (driver) {
-            const auto& pos = driver->GetPosition();
-            std::cout << "(" << std::setw(5) << pos.x << "," << std::setw(5) << pos.y << ")";
-            std::cout << " │ " << std::setw(12) << driver->GetStateString();
-        } else {
-            std::cout << "   (N/A)   │      N/A     ";
+    // The last published state: never waits for the fleet loop
+    if (auto fleet = GetFleetSnapshot()) {
+        for (const auto& robot : fleet->robots) {
+            std::cout << "║ " << std::setw(3) << robot.id 
+                      << " │ " << std::setw(9) << Layer2::StatusToString(robot.status)
+                      << " │ " << std::setw(7) << robot.currentNodeId
+                      << " │ ";
+            
+            std::cout << "(" << std::setw(5) << robot.position.x << "," << std::setw(5) << robot.position.y << ")";
+            std::cout << " │ " << std::setw(12) << Layer3::Core::DriverStateToString(robot.driverState);
+            
+            std::cout << " │ " << std::setw(9) << robot.remainingWaypoints << " ║\n";
         }
-        
-        std::cout << " │ " << std::setw(9) << agent.GetItinerary().size() << " ║\n";
     }
     
     std::cout << "╚═══════════════════════════════════════════════════════════════════════════╝\n";
@@ -646,25 +1813,38 @@ std::vector<int> FleetManager::GetDropoffNodes() const {
 
 void FleetManager::runMainLoop() {
     std::cout << "[MainLoop] Started (1 Hz)\n";
+    TRACE_THREAD_NAME("MainLoop");
+    threadPlacement_.Apply(ThreadRole::STRATEGIC);
     
-    const auto tickDuration = std::chrono::milliseconds(
-        static_cast<int>(config_.warehouseTickMs)
-    );
+    // Kinematic batch runs: the fleet loop runs a strategic tick ahead at most
+    const bool kinematicLockstep = config_.simulationFidelity == SimulationFidelity::KINEMATIC &&
+                                   config_.batchMode && !replaying_;
+    const uint64_t ticksPerMainTick =
+        std::max<uint64_t>(1, static_cast<uint64_t>(std::lround(config_.warehouseTickMs / config_.orcaTickMs)));
     
+    mainLoopScheduler_.Start();
     while (running_.load()) {
-        auto tickStart = std::chrono::steady_clock::now();
+        mainLoopScheduler_.BeginTick();
         
         // =====================================================================
         // STEP 1: Check for background re-plan completion (Scenario C)
         // =====================================================================
-        if (replanInProgress_.load()) {
+        if (replanInProgress_.load() && !replaying_) {
             checkBackgroundReplan();
         }
         
+        // Stale cost rows after obstacle changes: refresh in the background
+        checkCostMatrixRefresh();
+        
         // =====================================================================
         // STEP 2: Process any newly injected tasks (Scenarios B & C)
+        // (replay: the logged inputs due at this fleet tick, steps 1-3 alike)
         // =====================================================================
-        processInjectedTasks();
+        if (replaying_) {
+            runReplayStep();
+        } else {
+            processInjectedTasks();
+        }
         
         // =====================================================================
         // STEP 3: Check for pending tasks from file load and idle robots
@@ -678,11 +1858,9 @@ void FleetManager::runMainLoop() {
             havePendingTasks = !pendingTasks_.empty();
         }
         
-        {
-            std::lock_guard<std::mutex> fleetLock(fleetMutex_);
-            for (const auto& [id, agent] : fleetRegistry_) {
-                if (agent.GetStatus() == Layer2::RobotStatus::IDLE && 
-                    !agent.GetState().HasPendingGoals()) {
+        if (auto fleet = GetFleetSnapshot()) {
+            for (const auto& robot : fleet->robots) {
+                if (robot.status == Layer2::RobotStatus::IDLE && robot.remainingWaypoints == 0) {
                     haveIdleRobots = true;
                     break;
                 }
@@ -691,21 +1869,30 @@ void FleetManager::runMainLoop() {
         
         // Run VRP solver if we have pending tasks and idle robots
         // (This is Scenario A: Full batch solve)
-        if (havePendingTasks && haveIdleRobots && !replanInProgress_.load()) {
+        if (havePendingTasks && haveIdleRobots && !replanInProgress_.load() && !replaying_) {
             std::cout << "\n[MainLoop] ══════════ SCENARIO A: Full VRP Solve ══════════\n";
             runVRPSolver();
             initialSolveComplete_ = true;
         }
         
+        checkCheckpoint();
+        checkMemoryReport();
+        if (eventLog_) {
+            eventLog_->Flush(config_.batchMode ? EVENT_LOG_FLUSH_BYTES : 0);
+        }
+        
         stats_.mainLoopCount++;
         
-        // SLEEP: In live mode, maintain 1 Hz rate. In batch mode, skip sleep.
+        if (kinematicLockstep) {
+            auto fleet = GetFleetSnapshot();
+            uint64_t tick = fleet ? static_cast<uint64_t>(fleet->fleetLoopCount) : 0;
+            kinematicHoldTick_.store(tick + ticksPerMainTick, std::memory_order_release);
+        }
+        
+        // SLEEP: In live mode, until the next 1 Hz deadline. In batch mode, skip sleep.
+        mainLoopScheduler_.EndTick();
         if (!config_.batchMode) {
-            auto elapsed = std::chrono::steady_clock::now() - tickStart;
-            auto sleepTime = tickDuration - elapsed;
-            if (sleepTime > std::chrono::milliseconds(0)) {
-                std::this_thread::sleep_for(sleepTime);
-            }
+            mainLoopScheduler_.WaitForNextTick();
         }
     }
     
@@ -715,88 +1902,196 @@ void FleetManager::runMainLoop() {
 void FleetManager::runFleetLoop() {
     std::cout << "[FleetLoop] Started (" << (config_.batchMode ? "BATCH" : "20 Hz") << ")\n";
     
-    const float dt = config_.orcaTickMs / 1000.0f;  // Convert to seconds
-    const auto tickDuration = std::chrono::milliseconds(
-        static_cast<int>(config_.orcaTickMs)
-    );
-    
+    const float tickDt = config_.orcaTickMs / 1000.0f;  // Convert to seconds
+    const bool kinematic = config_.simulationFidelity == SimulationFidelity::KINEMATIC;
+    const bool kinematicLockstep = kinematic && config_.batchMode && !replaying_;
+    TRACE_THREAD_NAME("FleetLoop");
+    threadPlacement_.Apply(ThreadRole::PHYSICS);  // Zone workers start on this thread and inherit it
+    fleetLoopScheduler_.Start();
     while (running_.load()) {
-        auto tickStart = std::chrono::steady_clock::now();
-        
-        // Telemetry data to broadcast (collected inside lock, sent outside)
-        std::vector<API::RobotTelemetry> telemetry;
+        // Replay: the main loop acts on this tick's logged inputs first
+        if (replaying_ &&
+            static_cast<uint64_t>(stats_.fleetLoopCount) >= replayHoldTick_.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const uint64_t kinematicHold = kinematicHoldTick_.load(std::memory_order_acquire);
+        if (kinematicLockstep && static_cast<uint64_t>(stats_.fleetLoopCount) >= kinematicHold) {
+            std::this_thread::yield();
+            continue;
+        }
         
-        // Data for WriteRobotsJSON (collected inside lock, written outside)
-        API::TasksInfo tasksInfo;
-        std::vector<API::ChargingStationStatus> stationStatuses;
-        std::vector<API::HistoryPoint> historySnapshot;  // Atomic copy of history
+        fleetLoopScheduler_.BeginTick();
         
         // =====================================================================
-        // CRITICAL SECTION: Update Physics & Gather Data
+        // CRITICAL SECTION: Update Physics & Publish the Fleet
         // =====================================================================
         {
-            std::lock_guard<std::mutex> lock(fleetMutex_);
+            Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
+            TRACE_ZONE("PhysicsTick", "fleet");
             
-            // Gather all obstacle data for ORCA
-            std::vector<Layer3::Physics::ObstacleData> allObstacles;
-            for (const auto& driver : drivers_) {
-                if (driver) {
-                    allObstacles.push_back(driver->GetObstacleData());
+            // Kinematic batch runs jump from event to event (ticks pass
+            // unobserved, nothing depends on wall time) up to the hold
+            const int ticks = kinematicLockstep
+                ? std::min(kinematicStepTicks(tickDt),
+                           static_cast<int>(kinematicHold - static_cast<uint64_t>(stats_.fleetLoopCount)))
+                : 1;
+            const float dt = tickDt * ticks;
+            
+            // Snapshot all obstacle data for ORCA and bucket it by position,
+            // so each robot only looks at the robots around it (kinematic
+            // legs have no ORCA)
+            if (!kinematic) {
+                TRACE_ZONE("GatherNeighbors", "fleet");
+                tickObstacles_.Clear();
+                tickObstacleOf_.assign(drivers_.size(), 0);
+                for (size_t i = 0; i < drivers_.size(); ++i) {
+                    if (drivers_[i]) {
+                        tickObstacleOf_[i] = tickObstacles_.Size();
+                        tickObstacles_.Push(drivers_[i]->GetObstacleData());
+                    }
+                }
+                driverTickDebt_.resize(drivers_.size(), 0.0f);
+                driverTicksToSkip_.resize(drivers_.size(), 0);
+                driverStepDt_.resize(drivers_.size(), 0.0f);
+                neighborGrid_.SetCellSize(std::max(config_.orcaNeighborRadiusMeters *
+                                                   Common::GetPixelsPerMeter(config_.mapResolution), 1.0));
+                neighborGrid_.Reset(tickObstacles_.Size());
+                for (size_t k = 0; k < tickObstacles_.Size(); ++k) {
+                    neighborGrid_.Insert(k, tickObstacles_.X()[k], tickObstacles_.Y()[k]);
                 }
             }
             
-            // Update each robot
-            for (size_t i = 0; i < drivers_.size(); ++i) {
-                if (!drivers_[i]) continue;
-                
-                int robotId = drivers_[i]->GetRobotId();
-                
-                // Gather neighbors (exclude self)
-                std::vector<Layer3::Physics::ObstacleData> neighbors;
-                for (size_t j = 0; j < allObstacles.size(); ++j) {
-                    if (i != j) {
-                        neighbors.push_back(allObstacles[j]);
+            // Overlay changes and cooperative plans are handed out before
+            // anyone moves. Both read the overlay; while a cost refresh
+            // holds it they wait for a later tick instead of stalling this one
+            // (a recording or replay waits for it, so both see the same ticks)
+            {
+                std::unique_lock<std::mutex> meshLock(mapMutex_, std::defer_lock);
+                if (waitsForOverlay()) {
+                    meshLock.lock();
+                } else {
+                    meshLock.try_lock();
+                }
+                if (meshLock.owns_lock()) {
+                    TRACE_ZONE("MapChanges", "fleet");
+                    refreshCongestionPenalties(stats_.fleetLoopCount * tickDt);
+                    notifyMapChanges();
+                    if (multiAgentPlanner_) {
+                        planMultiAgentWindow();
                     }
                 }
+            }
+            
+            // Update each robot (all at once, zone by zone, when sharded)
+            const bool sharded = config_.physicsThreads != 1 && !kinematic;
+            if (sharded) {
+                stepDriversByZone(dt);
+            }
+            for (size_t i = 0; i < drivers_.size(); ++i) {
+                if (!drivers_[i]) continue;
                 
                 // Update driver physics
-                drivers_[i]->UpdateLoop(dt, neighbors);
+                if (!sharded) {
+                    stepDriver(i, dt);
+                }
                 
                 // Sync L3 position to L2 agent
-                syncL3toL2(robotId);
+                syncL3toL2(*drivers_[i]);
                 
                 // Check if driver needs a new goal from L2 itinerary
-                feedL2toL3(robotId);
-                
-                // Collect telemetry data for API broadcast
-                auto it = fleetRegistry_.find(robotId);
-                if (it != fleetRegistry_.end()) {
-                    API::RobotTelemetry t;
-                    t.id = robotId;
-                    t.pos = drivers_[i]->GetPosition();
-                    t.velocity = drivers_[i]->GetVelocity();
-                    t.status = Layer2::StatusToString(it->second.GetStatus());
-                    t.driverState = drivers_[i]->GetStateString();
-                    t.battery = 1.0f;  // TODO: Implement battery simulation
-                    t.currentNodeId = it->second.GetCurrentNodeId();
-                    t.targetNodeId = drivers_[i]->GetGoalNodeId();
-                    t.remainingWaypoints = static_cast<int>(it->second.GetItinerary().size());
-                    t.hasPackage = drivers_[i]->HasPackage();
-                    telemetry.push_back(t);
+                TRACE_ZONE("FeedGoals", "fleet");
+                feedL2toL3(*drivers_[i]);
+            }
+            sampleCongestion(stats_.fleetLoopCount * tickDt);
+            repositionIdleRobots(stats_.fleetLoopCount * tickDt);
+            
+            // Robots waiting on each other: detours and back-offs read the
+            // overlay, so a refresh holding it postpones them a tick
+            if (deadlockResolver_) {
+                std::unique_lock<std::mutex> meshLock(mapMutex_, std::defer_lock);
+                if (waitsForOverlay()) {
+                    meshLock.lock();
+                } else {
+                    meshLock.try_lock();
+                }
+                if (meshLock.owns_lock()) {
+                    TRACE_ZONE("Deadlocks", "fleet");
+                    
+                    // The tick's neighbor grid lists the drivers in this
+                    // order: brought up to where they moved, it finds who
+                    // is in whose way
+                    deadlockRobots_.clear();
+                    for (const auto& driver : drivers_) {
+                        if (!driver) continue;
+                        neighborGrid_.Move(deadlockRobots_.size(), driver->GetPosition().x, driver->GetPosition().y);
+                        deadlockRobots_.push_back(driver.get());
+                    }
+                    deadlockResolver_->Update(deadlockRobots_, neighborGrid_, dt);
+                }
+            }
+            
+            stats_.fleetLoopCount += ticks;
+            
+            if (!config_.batchMode) {
+                changedPaths_.clear();
+                publishedPathVersions_.resize(drivers_.size(), 0);
+                for (size_t i = 0; i < drivers_.size(); ++i) {
+                    if (!drivers_[i] || drivers_[i]->GetPathVersion() == publishedPathVersions_[i]) continue;
+                    publishedPathVersions_[i] = drivers_[i]->GetPathVersion();
+                    changedPaths_.push_back({static_cast<int>(i), drivers_[i]->GetPath(), publishedPathVersions_[i]});
                 }
             }
             
-            stats_.fleetLoopCount++;
+            // Everything below reads this instead of the live robots
+            publishFleetSnapshot();
+        }
+        // =====================================================================
+        // END CRITICAL SECTION - Mutex released here
+        // =====================================================================
+        
+        // I/O SECTION: Broadcast telemetry outside the lock (skip in batch mode for speed)
+        if (!config_.batchMode) {
+            TRACE_ZONE("Telemetry", "api");
+            std::shared_ptr<const FleetSnapshot> fleet = GetFleetSnapshot();
+            
+            // Refilled in place: the strings keep their buffers between ticks
+            std::vector<API::RobotTelemetry>& telemetry = telemetry_;
+            telemetry.resize(fleet->robots.size());
+            for (size_t i = 0; i < fleet->robots.size(); ++i) {
+                const RobotSnapshot& robot = fleet->robots[i];
+                API::RobotTelemetry& t = telemetry[i];
+                t.id = robot.id;
+                t.pos = robot.position;
+                t.velocity = robot.velocity;
+                t.status = Layer2::StatusToString(robot.status);
+                t.driverState = Layer3::Core::DriverStateToString(robot.driverState);
+                t.battery = 1.0f;  // TODO: Implement battery simulation
+                t.currentNodeId = robot.currentNodeId;
+                t.targetNodeId = robot.targetNodeId;
+                t.remainingWaypoints = robot.remainingWaypoints;
+                t.loadCount = robot.loadCount;
+            }
+            auto writeStart = Common::LatencyHistogram::Clock::now();
+            apiService_.BroadcastTelemetry(telemetry);
+            if (!changedPaths_.empty()) {
+                apiService_.BroadcastPaths(changedPaths_);
+            }
+            apiWriteLatency_.RecordSince(writeStart);
             
             // =========================================================
-            // Gather data for robots.json every 20 ticks (~1 Hz)
+            // Write aggregated robots.json every 20 ticks (~1 Hz)
             // =========================================================
-            if (stats_.fleetLoopCount % 20 == 0) {
+            if (fleet->fleetLoopCount % 20 == 0) {
+                TRACE_ZONE("RobotsJSON", "api");
+                API::TasksInfo tasksInfo;
+                std::vector<API::ChargingStationStatus> stationStatuses;
+                API::DeadlockInfo deadlockInfo;
+                
                 // Count active tasks (robots with non-empty itineraries or BUSY status)
                 int activeTasks = 0;
-                for (const auto& [id, agent] : fleetRegistry_) {
-                    if (agent.GetStatus() == Layer2::RobotStatus::BUSY || 
-                        !agent.GetItinerary().empty()) {
+                for (const auto& robot : fleet->robots) {
+                    if (robot.status == Layer2::RobotStatus::BUSY || robot.remainingWaypoints > 0) {
                         activeTasks++;
                     }
                 }
@@ -810,11 +2105,8 @@ void FleetManager::runFleetLoop() {
                     tasksInfo.pending = static_cast<int>(pendingTasks_.size());
                 }
                 
-                // Get injection queue size
-                {
-                    std::lock_guard<std::mutex> injLock(const_cast<std::mutex&>(injectionMutex_));
-                    tasksInfo.pending += static_cast<int>(injectionQueue_.size());
-                }
+                // Get injection queue size (lock-free)
+                tasksInfo.pending += static_cast<int>(injectionQueue_.SizeApprox());
                 
                 // Build charging station statuses
                 if (poiRegistry_ && navMesh_) {
@@ -832,10 +2124,8 @@ void FleetManager::runFleetLoop() {
                         station.robotId = -1;
                         
                         // Check if any robot is at this charging station
-                        for (const auto& driver : drivers_) {
-                            if (!driver) continue;
-                            
-                            const auto& pos = driver->GetPosition();
+                        for (const auto& robot : fleet->robots) {
+                            const auto& pos = robot.position;
                             // Check if robot is within 50 pixels (~5 decimeters) of station
                             float dx = static_cast<float>(pos.x - node.coords.x);
                             float dy = static_cast<float>(pos.y - node.coords.y);
@@ -843,7 +2133,7 @@ void FleetManager::runFleetLoop() {
                             
                             if (distSq < 2500.0f) {  // 50^2 = 2500
                                 station.status = "OCCUPIED";
-                                station.robotId = driver->GetRobotId();
+                                station.robotId = robot.id;
                                 break;
                             }
                         }
@@ -852,9 +2142,7 @@ void FleetManager::runFleetLoop() {
                     }
                 }
                 
-                // =========================================================
-                // ATOMIC HISTORY UPDATE (inside fleetMutex_)
-                // =========================================================
+                // History of completed tasks (fleet thread only)
                 auto now = std::chrono::system_clock::now();
                 auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
                     now.time_since_epoch()).count();
@@ -876,37 +2164,36 @@ void FleetManager::runFleetLoop() {
                     if (static_cast<int>(history_.size()) > HISTORY_LIMIT) {
                         history_.erase(history_.begin()); // FIFO: remove oldest
                     }
+                    historyBytes_.store(Common::VectorBytes(history_), std::memory_order_relaxed);
                     
                     // Update tracking for next delta
                     lastCompletedTotal_ = tasksInfo.completed;
                     lastHistoryUpdate_ = ms;
                 }
                 
-                // Create immutable snapshot for I/O (outside lock)
-                historySnapshot = history_;
-            }
-        }
-        // =====================================================================
-        // END CRITICAL SECTION - Mutex released here
-        // =====================================================================
-        
-        // I/O SECTION: Broadcast telemetry outside the lock (skip in batch mode for speed)
-        if (!config_.batchMode) {
-            apiService_.BroadcastTelemetry(telemetry);
-            
-            // Write aggregated robots.json every 20 ticks (~1 Hz)
-            if (stats_.fleetLoopCount % 20 == 0) {
-                apiService_.WriteRobotsJSON(telemetry, tasksInfo, stationStatuses, historySnapshot);
+                if (deadlockResolver_) {
+                    const auto& deadlocks = deadlockResolver_->GetStats();
+                    deadlockInfo.waiting = deadlocks.waitingRobots;
+                    deadlockInfo.detected = static_cast<long long>(deadlocks.cycles + deadlocks.longBlocks);
+                    deadlockInfo.resolved = static_cast<long long>(deadlocks.GetResolved());
+                    deadlockInfo.blockedSeconds = deadlocks.blockedSeconds;
+                    deadlockInfo.longestWaitSeconds = deadlocks.longestWaitSeconds;
+                }
+                
+                writeStart = Common::LatencyHistogram::Clock::now();
+                apiService_.WriteRobotsJSON(telemetry, tasksInfo, stationStatuses, history_, deadlockInfo);
+                apiWriteLatency_.RecordSince(writeStart);
+                
+                // Same cadence: percentiles and memory for scrapers and alerts
+                auto memory = std::atomic_load(&memoryReport_);
+                apiService_.WriteMetrics(GetLatencyMetrics(), memory.get());
             }
         }
         
-        // SLEEP: In live mode, maintain 20 Hz rate. In batch mode, skip sleep.
+        // SLEEP: In live mode, until the next 20 Hz deadline. In batch mode, skip sleep.
+        fleetLoopScheduler_.EndTick();
         if (!config_.batchMode) {
-            auto elapsed = std::chrono::steady_clock::now() - tickStart;
-            auto sleepTime = tickDuration - elapsed;
-            if (sleepTime > std::chrono::milliseconds(0)) {
-                std::this_thread::sleep_for(sleepTime);
-            }
+            fleetLoopScheduler_.WaitForNextTick();
         }
     }
     
@@ -916,12 +2203,11 @@ void FleetManager::runFleetLoop() {
 void FleetManager::runObstacleLoop() {
     std::cout << "[ObstacleLoop] Started (" << (config_.batchMode ? "BATCH" : "1 Hz") << ")\n";
     
-    const auto tickDuration = std::chrono::milliseconds(
-        static_cast<int>(config_.obstacleTickMs)
-    );
-    
+    TRACE_THREAD_NAME("ObstacleLoop");
+    threadPlacement_.Apply(ThreadRole::OBSTACLE);
+    obstacleLoopScheduler_.Start();
     while (running_.load()) {
-        auto tickStart = std::chrono::steady_clock::now();
+        obstacleLoopScheduler_.BeginTick();
         
         // Obstacle data to broadcast (collected inside lock, sent outside)
         std::vector<API::ObstacleInfo> obstacleInfo;
@@ -930,13 +2216,21 @@ void FleetManager::runObstacleLoop() {
         // CRITICAL SECTION: Update Dynamic Obstacles
         // =====================================================================
         {
-            std::lock_guard<std::mutex> lock(mapMutex_);
+            Common::TracedLockGuard<std::mutex> lock(mapMutex_, "Wait mapMutex_");
+            TRACE_ZONE("ObstacleTick", "map");
             
             // Placeholder: Update dynamic obstacles
             // In a real system, this would:
             // 1. Get sensor data (e.g., forklift positions)
             // 2. Convert to DynamicObstacle objects
             // 3. Call dynamicMap_->Update(obstacles, *staticMap_)
+            // 4. For each footprint that appeared or moved (old and new rect),
+            //    reclassify only the NavMesh tiles under it:
+            //    navMesh_->UpdateBlockedRegion(x, y, w, h, snapshot.GetGrid())
+            //    (snapshot = Layer1::DynamicBitMap::Snapshot(*dynamicMap_)).
+            //    The main loop then recomputes only the affected cost rows
+            //    (checkCostMatrixRefresh), and the fleet loop repairs the
+            //    paths of drivers the change blocks (notifyMapChanges).
             
             // Future: dynamicMap_->Update(obstacles, *staticMap_);
             
@@ -952,18 +2246,16 @@ void FleetManager::runObstacleLoop() {
         
         // I/O SECTION: Broadcast obstacles outside the lock (skip in batch mode)
         if (!config_.batchMode) {
+            TRACE_ZONE("BroadcastObstacles", "api");
             apiService_.BroadcastObstacles(obstacleInfo);
         }
         
         stats_.obstacleLoopCount++;
         
-        // SLEEP: In live mode, maintain 1 Hz rate. In batch mode, skip sleep.
+        // SLEEP: In live mode, until the next 1 Hz deadline. In batch mode, skip sleep.
+        obstacleLoopScheduler_.EndTick();
         if (!config_.batchMode) {
-            auto elapsed = std::chrono::steady_clock::now() - tickStart;
-            auto sleepTime = tickDuration - elapsed;
-            if (sleepTime > std::chrono::milliseconds(0)) {
-                std::this_thread::sleep_for(sleepTime);
-            }
+            obstacleLoopScheduler_.WaitForNextTick();
         }
     }
     
@@ -974,20 +2266,11 @@ void FleetManager::runObstacleLoop() {
 // BRIDGE LOGIC
 // =============================================================================
 
-void FleetManager::syncL3toL2(int robotId) {
-    // Find the driver
-    Layer3::Core::RobotDriver* driver = nullptr;
-    for (auto& d : drivers_) {
-        if (d && d->GetRobotId() == robotId) {
-            driver = d.get();
-            break;
-        }
-    }
-    
-    if (!driver) return;
+void FleetManager::syncL3toL2(const Layer3::Core::RobotDriver& driver) {
+    int robotId = driver.GetRobotId();
     
     // Get driver position
-    const auto& pos = driver->GetPosition();
+    const auto& pos = driver.GetPosition();
     
     // Find nearest NavMesh node
     int nearestNode = findNearestNode(pos);
@@ -998,7 +2281,7 @@ void FleetManager::syncL3toL2(int robotId) {
         it->second.SetCurrentNodeId(nearestNode);
         
         // Update status based on driver state
-        auto driverState = driver->GetState();
+        auto driverState = driver.GetState();
         if (driverState == Layer3::Core::DriverState::MOVING ||
             driverState == Layer3::Core::DriverState::COMPUTING_PATH) {
             it->second.SetStatus(Layer2::RobotStatus::BUSY);
@@ -1012,20 +2295,11 @@ void FleetManager::syncL3toL2(int robotId) {
     }
 }
 
-void FleetManager::feedL2toL3(int robotId) {
-    // Find the driver
-    Layer3::Core::RobotDriver* driver = nullptr;
-    for (auto& d : drivers_) {
-        if (d && d->GetRobotId() == robotId) {
-            driver = d.get();
-            break;
-        }
-    }
-    
-    if (!driver) return;
+void FleetManager::feedL2toL3(Layer3::Core::RobotDriver& driver) {
+    int robotId = driver.GetRobotId();
     
     // Check if driver is idle or arrived
-    auto driverState = driver->GetState();
+    auto driverState = driver.GetState();
     if (driverState != Layer3::Core::DriverState::IDLE &&
         driverState != Layer3::Core::DriverState::ARRIVED) {
         return;  // Driver is busy
@@ -1037,20 +2311,538 @@ void FleetManager::feedL2toL3(int robotId) {
     
     auto& agent = it->second;
     if (!agent.GetState().HasPendingGoals()) {
+        // Parked at its POI it keeps the slot; one it will not reach is freed
+        if (poiSchedule_) {
+            int reserved = poiSchedule_->GetReservedNode(robotId);
+            if (reserved >= 0 && reserved != agent.GetCurrentNodeId()) {
+                poiSchedule_->Release(robotId);
+            }
+        }
         return;  // No pending goals
     }
     
+    if (poiSchedule_) {
+        const double now = stats_.fleetLoopCount * config_.orcaTickMs / 1000.0;
+        if (!admitToPOI(driver, agent.GetState().PeekNextGoal(), now)) {
+            return;  // Its slot is later: waiting for it
+        }
+    }
+    
     // Pop next goal from L2 itinerary
     int nextGoal = agent.GetMutableState().PopNextGoal();
     
     if (nextGoal >= 0) {
         std::cout << "[Bridge] Robot " << robotId << ": L2→L3 SetGoal(" << nextGoal << ")\n";
-        driver->SetGoal(nextGoal);
+        if (static_cast<size_t>(robotId) < positioningGoals_.size()) {
+            positioningGoals_[robotId] = -1;
+        }
+        if (static_cast<size_t>(robotId) < repositionTargets_.size()) {
+            repositionTargets_[robotId] = -1;
+        }
+        if (startTimedLeg(driver, nextGoal)) {
+            // Kinematic: no path to plan or prefetch
+        } else if (multiAgentPlanner_) {
+            driver.SetScheduledGoal(nextGoal);
+            multiAgentGoalsChanged_ = true;
+        } else {
+            driver.SetGoal(nextGoal);
+            
+            // The next legs are planned while this one is driven
+            const Layer2::GoalQueue& rest = agent.GetItinerary();
+            size_t legs = std::min(rest.size(), static_cast<size_t>(std::max(0, config_.itineraryPrefetchLegs)));
+            if (legs > 0) {
+                driver.PrefetchItinerary(std::vector<int>(rest.begin(), rest.begin() + legs));
+            }
+        }
         agent.SetStatus(Layer2::RobotStatus::BUSY);
+        goalsDispatched_[robotId]++;
     }
 }
 
+bool FleetManager::admitToPOI(Layer3::Core::RobotDriver& driver, int goalNode, double now) {
+    const int robotId = driver.GetRobotId();
+    if (!poiSchedule_->IsScheduled(goalNode)) {
+        poiSchedule_->Release(robotId);  // Leaving the POI it was at
+        return true;
+    }
+    
+    const Common::Coordinates& position = driver.GetPosition();
+    const Common::Coordinates& goal = navMesh_->GetAllNodes()[goalNode].coords;
+    const double pixelsPerSecond = config_.robotSpeedMps * Common::GetPixelsPerMeter(config_.mapResolution);
+    const double eta = now + std::hypot(goal.x - position.x, goal.y - position.y) / pixelsPerSecond;
+    const double start = poiSchedule_->Reserve(goalNode, robotId, eta, now);
+    if (start <= eta + POI_SLOT_SLACK_SECONDS) {
+        return true;
+    }
+    
+    int holding = poiSchedule_->GetHoldingNode(goalNode);
+    if (holding >= 0 && driver.GetGoalNodeId() != holding) {
+        std::cout << "[Bridge] Robot " << robotId << ": POI node " << goalNode << " booked for another "
+                  << std::ceil(start - eta) << " s, holding at node " << holding << "\n";
+        positioningGoals_.resize(std::max(positioningGoals_.size(), static_cast<size_t>(robotId) + 1), -1);
+        positioningGoals_[robotId] = holding;
+        if (startTimedLeg(driver, holding)) {
+            // Kinematic: on its way
+        } else if (multiAgentPlanner_) {
+            driver.SetScheduledGoal(holding);
+            multiAgentGoalsChanged_ = true;
+        } else {
+            driver.SetGoal(holding);
+        }
+    }
+    return false;
+}
+
+bool FleetManager::startTimedLeg(Layer3::Core::RobotDriver& driver, int goalNode) {
+    if (config_.simulationFidelity != SimulationFidelity::KINEMATIC || !costMatrix_) return false;
+    
+    int start = navMesh_->GetNodeIdAt(driver.GetPosition());
+    if (start < 0) return false;
+    float cost;
+    {
+        std::lock_guard<std::mutex> meshLock(mapMutex_);
+        cost = costMatrix_->GetCost(start, goalNode);
+    }
+    if (!(cost < Layer2::CostMatrixProvider::GetInfinity())) return false;
+    
+    double seconds = cost / driver.GetMaxSpeed();
+    if (config_.kinematicQueueSeconds > 0.0) {
+        int queued = 0;
+        for (const auto& other : drivers_) {
+            if (other && other.get() != &driver && other->HasGoal() && other->GetGoalNodeId() == goalNode) ++queued;
+        }
+        seconds += queued * config_.kinematicQueueSeconds;
+    }
+    return driver.SetTimedGoal(goalNode, seconds);
+}
+
+int FleetManager::kinematicStepTicks(float dt) const {
+    double seconds = KINEMATIC_MAX_STEP_SECONDS;
+    for (const auto& driver : drivers_) {
+        if (!driver) continue;
+        const auto state = driver->GetState();
+        if (state == Layer3::Core::DriverState::IDLE || state == Layer3::Core::DriverState::ARRIVED ||
+            state == Layer3::Core::DriverState::STUCK) {
+            continue;
+        }
+        double left = driver->GetTimedLegSecondsLeft();
+        if (left < 0.0) return 1;  // Waiting for or following a path
+        seconds = std::min(seconds, left);
+    }
+    return std::max(1, static_cast<int>(seconds / dt));
+}
+
+void FleetManager::stepDriver(size_t index, float dt) {
+    auto& driver = *drivers_[index];
+    if (config_.simulationFidelity == SimulationFidelity::KINEMATIC) {
+        if (driver.IsParked()) return;
+        neighbors_.Clear();
+        driver.UpdateLoop(dt, neighbors_);
+        stats_.driverSteps++;
+        return;
+    }
+    
+    int substeps = planDriverStep(index, dt, neighborIndices_, neighbors_);
+    for (int step = 0; step < substeps; ++step) {
+        driver.UpdateLoop(driverStepDt_[index] / substeps, neighbors_);
+    }
+    stats_.driverSteps += substeps;
+}
+
+int FleetManager::planDriverStep(size_t index, float dt, std::vector<size_t>& indices,
+                                 Layer3::Physics::KinematicsStore& neighbors) {
+    auto& driver = *drivers_[index];
+    
+    // Parked drivers (idle, arrived, charging at rest) stay in the grid as
+    // obstacles for the others but are not stepped
+    if (driver.IsParked()) {
+        driverTickDebt_[index] = 0.0f;
+        driverTicksToSkip_[index] = 0;
+        return 0;
+    }
+    
+    const bool adaptive = config_.adaptiveTickRate;
+    const bool moving = driver.GetState() == Layer3::Core::DriverState::MOVING;
+    if (adaptive && moving && driverTicksToSkip_[index] > 0) {
+        driverTicksToSkip_[index]--;
+        driverTickDebt_[index] += dt;
+        return 0;
+    }
+    driverStepDt_[index] = dt + driverTickDebt_[index];
+    driverTickDebt_[index] = 0.0f;
+    
+    bool isolated = gatherDriverNeighbors(index, dt, indices, neighbors);
+    
+    int substeps = 1;
+    if (adaptive && config_.adaptiveCrowdNeighbors > 0) {
+        int crowd = static_cast<int>(neighbors.Size());
+        substeps = std::clamp(1 + crowd / config_.adaptiveCrowdNeighbors, 1, std::max(1, config_.adaptiveMaxSubsteps));
+    }
+    
+    if (adaptive && isolated && moving) {
+        driverTicksToSkip_[index] = std::max(1, config_.adaptiveCoarseTicks) - 1;
+    }
+    return substeps;
+}
+
+bool FleetManager::gatherDriverNeighbors(size_t index, float dt, std::vector<size_t>& indices,
+                                         Layer3::Physics::KinematicsStore& neighbors) const {
+    // Gather neighbors within ORCA's reach (exclude self); adaptive steps
+    // also look as far as anyone could come before the next step
+    const bool adaptive = config_.adaptiveTickRate;
+    const size_t self = tickObstacleOf_[index];
+    const double x = tickObstacles_.X()[self];
+    const double y = tickObstacles_.Y()[self];
+    const int coarseTicks = std::max(1, config_.adaptiveCoarseTicks);
+    const double pixelsPerMeter = Common::GetPixelsPerMeter(config_.mapResolution);
+    const double reach = config_.orcaNeighborRadiusMeters * pixelsPerMeter;
+    const double pixelsPerSecond = config_.robotSpeedMps * pixelsPerMeter;  // as the drivers
+    const double closing = 2.0 * pixelsPerSecond * dt * coarseTicks;
+    const double lookout = adaptive ? reach + closing : reach;
+    neighborGrid_.Query(x, y, lookout, indices);
+    neighbors.Clear();
+    bool isolated = true;
+    for (size_t k : indices) {
+        if (k == self) continue;
+        isolated = false;
+        double dx = tickObstacles_.X()[k] - x;
+        double dy = tickObstacles_.Y()[k] - y;
+        if (!adaptive || dx * dx + dy * dy <= reach * reach) {
+            neighbors.PushFrom(tickObstacles_, k);
+        }
+    }
+    return isolated;
+}
+
+void FleetManager::stepDriversByZone(float dt) {
+    if (!physicsWorkers_) {
+        size_t threads = config_.physicsThreads > 0 ? static_cast<size_t>(config_.physicsThreads) : 0;
+        physicsWorkers_ = std::make_unique<Layer3::Core::WorkerPool>(threads);
+        
+        // A grid of about square zones over the map
+        auto [width, height] = staticMap_->GetDimensions();
+        int zones = config_.physicsZones > 0
+            ? config_.physicsZones
+            : 4 * static_cast<int>(physicsWorkers_->GetThreadCount());
+        double aspect = static_cast<double>(width) / std::max<double>(1.0, height);
+        zoneColumns_ = std::clamp(static_cast<int>(std::round(std::sqrt(zones * aspect))), 1, zones);
+        int rows = (zones + zoneColumns_ - 1) / zoneColumns_;
+        zoneWidth_ = std::max(1.0, static_cast<double>(width) / zoneColumns_);
+        zoneHeight_ = std::max(1.0, static_cast<double>(height) / rows);
+        physicsZones_.assign(static_cast<size_t>(zoneColumns_) * rows, PhysicsZone());
+        std::cout << "[FleetLoop] Physics on " << physicsWorkers_->GetThreadCount() << " threads over "
+                  << zoneColumns_ << "x" << rows << " zones\n";
+    }
+    const int zoneRows = static_cast<int>(physicsZones_.size()) / zoneColumns_;
+    
+    // Hand each driver to the zone under its tick-start position
+    for (auto& zone : physicsZones_) {
+        zone.drivers.clear();
+        zone.steps = 0;
+    }
+    driverZone_.resize(drivers_.size(), -1);
+    driverSubsteps_.assign(drivers_.size(), 0);
+    for (size_t i = 0; i < drivers_.size(); ++i) {
+        if (!drivers_[i]) continue;
+        const size_t self = tickObstacleOf_[i];
+        int column = std::clamp(static_cast<int>(tickObstacles_.X()[self] / zoneWidth_), 0, zoneColumns_ - 1);
+        int row = std::clamp(static_cast<int>(tickObstacles_.Y()[self] / zoneHeight_), 0, zoneRows - 1);
+        int zone = row * zoneColumns_ + column;
+        if (driverZone_[i] >= 0 && driverZone_[i] != zone) {
+            zoneHandoffs_++;
+        }
+        driverZone_[i] = zone;
+        physicsZones_[zone].drivers.push_back(i);
+    }
+    busyZones_.clear();
+    for (size_t z = 0; z < physicsZones_.size(); ++z) {
+        if (!physicsZones_[z].drivers.empty()) busyZones_.push_back(z);
+    }
+    
+    // Round 0 plans every driver; each later round takes one more sub-step
+    // of the drivers that need it. Velocities on the workers, moves here
+    int rounds = 1;
+    for (int round = 0; round < rounds; ++round) {
+        physicsWorkers_->Run(busyZones_.size(), [&](size_t job) {
+            TRACE_ZONE("PhysicsZone", "fleet");
+            PhysicsZone& zone = physicsZones_[busyZones_[job]];
+            for (size_t i : zone.drivers) {
+                if (round == 0) {
+                    driverSubsteps_[i] = planDriverStep(i, dt, zone.indices, zone.neighbors);
+                    zone.steps += driverSubsteps_[i];
+                } else if (driverSubsteps_[i] > round) {
+                    gatherDriverNeighbors(i, dt, zone.indices, zone.neighbors);
+                } else {
+                    continue;
+                }
+                if (driverSubsteps_[i] > round) {
+                    drivers_[i]->ComputeVelocity(driverStepDt_[i] / driverSubsteps_[i], zone.neighbors);
+                }
+            }
+        });
+        for (size_t i = 0; i < drivers_.size(); ++i) {
+            if (driverSubsteps_[i] > round) {
+                drivers_[i]->Integrate(driverStepDt_[i] / driverSubsteps_[i]);
+                rounds = std::max(rounds, driverSubsteps_[i]);
+            }
+        }
+    }
+    for (size_t z : busyZones_) {
+        stats_.driverSteps += physicsZones_[z].steps;
+    }
+}
+
+void FleetManager::notifyMapChanges() {
+    uint64_t version = navMesh_->GetChangeVersion();
+    if (version == meshVersionSeen_) {
+        return;
+    }
+    
+    std::vector<int> changed;
+    const int numNodes = static_cast<int>(navMesh_->GetAllNodes().size());
+    for (int n = 0; n < numNodes; ++n) {
+        if (navMesh_->GetNodeChangeVersion(n) > meshVersionSeen_) {
+            changed.push_back(n);
+        }
+    }
+    meshVersionSeen_ = version;
+    pathMapVersion_.store(version, std::memory_order_release);
+    
+    // Only drivers whose path crosses a changed node can find it blocked
+    if (!pathIndex_) pathIndex_ = std::make_unique<Layer3::Core::PathIndex>(*navMesh_);
+    for (size_t i = 0; i < drivers_.size(); ++i) {
+        if (drivers_[i]) pathIndex_->Update(i, *drivers_[i]);
+    }
+    pathIndex_->FindRobots(changed, affectedDrivers_);
+    size_t next = 0;
+    for (size_t i = 0; i < drivers_.size(); ++i) {
+        bool affected = next < affectedDrivers_.size() && affectedDrivers_[next] == i;
+        if (affected) ++next;
+        if (drivers_[i] && (affected || drivers_[i]->IsDetouring() || drivers_[i]->IsPathBlocked())) {
+            drivers_[i]->OnMapChanged(changed);
+        }
+    }
+    
+    // Cooperative plans are only valid for the overlay they were made on
+    multiAgentGoalsChanged_ = true;
+}
+
+void FleetManager::sampleCongestion(double now) {
+    if (!congestionMap_ || now - congestionSampledAt_ < CONGESTION_SAMPLE_SECONDS) return;
+    congestionSampledAt_ = now;
+    
+    // A traversal counts when the robot drove into a node and out of it
+    // again; one that stopped there (a pick, a charge) is not delayed
+    congestionTracks_.resize(drivers_.size());
+    for (size_t i = 0; i < drivers_.size(); ++i) {
+        if (!drivers_[i]) continue;
+        const Common::Coordinates& position = drivers_[i]->GetPosition();
+        auto state = drivers_[i]->GetState();
+        bool moving = state == Layer3::Core::DriverState::MOVING ||
+                      state == Layer3::Core::DriverState::COLLISION_WAIT;
+        int node = navMesh_->GetNodeIdAt(position);
+        
+        CongestionTrack& track = congestionTracks_[i];
+        if (node != track.node) {
+            if (track.node >= 0 && track.enRoute && moving) {
+                double dx = position.x - track.enteredFrom.x;
+                double dy = position.y - track.enteredFrom.y;
+                congestionMap_->RecordTraversal(track.node, now - track.enteredAt, std::sqrt(dx * dx + dy * dy));
+            }
+            track = {node, now, position, moving};
+        } else if (!moving) {
+            track.enRoute = false;
+        }
+    }
+}
+
+void FleetManager::refreshCongestionPenalties(double now) {
+    if (!congestionMap_ || now - congestionRefreshedAt_ < config_.congestionRefreshMs / 1000.0) return;
+    congestionRefreshedAt_ = now;
+    TRACE_ZONE("CongestionPenalties", "fleet");
+    
+    // Below a second of driving the change is not worth replanning for
+    const float minPenalty = static_cast<float>(
+        config_.robotSpeedMps * Common::GetPixelsPerMeter(config_.mapResolution));
+    congestionMap_->Decay(now);
+    congestionMap_->ComputePenalties(congestionPenalties_, minPenalty);
+    std::vector<int> changed = ownMesh_->UpdatePenalties(congestionPenalties_, minPenalty);
+    if (!changed.empty() && !config_.batchMode) {
+        std::cout << "[Congestion] " << changed.size() << " node penalties changed, "
+                  << navMesh_->GetPenalizedNodeCount() << " nodes penalized\n";
+    }
+}
+
+void FleetManager::planMultiAgentWindow() {
+    if (--multiAgentTicksLeft_ > 0 && !multiAgentGoalsChanged_) {
+        return;
+    }
+    const double tickSeconds = multiAgentPlanner_->GetTickSeconds();
+    const double halfWindowMs = 500.0 * multiAgentPlanner_->GetConfig().windowTicks * tickSeconds;
+    multiAgentTicksLeft_ = std::max(1, static_cast<int>(halfWindowMs / config_.orcaTickMs));
+    multiAgentGoalsChanged_ = false;
+    
+    // Robots on their way first (rotated), then those holding their node.
+    // A robot stuck on an unreachable goal tries again once the overlay
+    // changed (notifyMapChanges then asks for this window).
+    multiAgentStuckAt_.resize(drivers_.size(), UINT64_MAX);
+    std::vector<Layer3::Pathfinding::MultiAgentQuery> queries;
+    std::vector<size_t> queryDrivers;
+    std::vector<Layer3::Pathfinding::MultiAgentQuery> holders;
+    for (size_t k = 0; k < drivers_.size(); ++k) {
+        const size_t index = (k + multiAgentRound_) % drivers_.size();
+        auto* driver = drivers_[index].get();
+        if (!driver) continue;
+        int startNode = navMesh_->GetNodeIdAt(driver->GetPosition());
+        if (startNode < 0) continue;
+        auto state = driver->GetState();
+        bool onTheWay = state == Layer3::Core::DriverState::MOVING ||
+                        state == Layer3::Core::DriverState::COMPUTING_PATH ||
+                        state == Layer3::Core::DriverState::COLLISION_WAIT ||
+                        (state == Layer3::Core::DriverState::STUCK && multiAgentStuckAt_[index] != meshVersionSeen_);
+        if (onTheWay && driver->GetGoalNodeId() >= 0) {
+            queries.push_back({driver->GetRobotId(), startNode, driver->GetGoalNodeId()});
+            queryDrivers.push_back(index);
+        } else {
+            holders.push_back({driver->GetRobotId(), startNode, -1});
+        }
+    }
+    multiAgentRound_++;
+    if (queries.empty()) {
+        return;
+    }
+    queries.insert(queries.end(), holders.begin(), holders.end());
+    
+    auto plans = multiAgentPlanner_->Plan(queries);
+    const auto& nodes = navMesh_->GetAllNodes();
+    Layer3::Pathfinding::ThetaStarSolver lineOfSight;
+    for (size_t i = 0; i < queryDrivers.size(); ++i) {
+        const auto& plan = plans[i];
+        auto& driver = *drivers_[queryDrivers[i]];
+        if (!plan.reachable) {
+            driver.FollowSchedule({}, {}, false);
+            multiAgentStuckAt_[queryDrivers[i]] = meshVersionSeen_;
+            continue;
+        }
+        
+        // Leave from where the robot is, not from its node's centre
+        std::vector<Common::Coordinates> steps;
+        for (size_t step = 0; step < plan.nodes.size(); ++step) {
+            steps.push_back(step == 0 ? driver.GetPosition() : nodes[plan.nodes[step]].coords);
+        }
+        
+        // Straighten the node-to-node staircase where the robot sees far
+        // enough (waits stay where they are, with their times)
+        std::vector<Common::Coordinates> waypoints{steps[0]};
+        std::vector<double> times{0.0};
+        for (size_t from = 0; from + 1 < steps.size();) {
+            size_t to = from + 1;
+            while (to + 1 < steps.size() && !(steps[to] == steps[to + 1]) &&
+                   lineOfSight.HasLineOfSight(steps[from].x, steps[from].y,
+                                              steps[to + 1].x, steps[to + 1].y, *inflatedMap_)) {
+                to++;
+            }
+            waypoints.push_back(steps[to]);
+            times.push_back(plan.ticks[to] * tickSeconds);
+            from = to;
+        }
+        driver.FollowSchedule(waypoints, times, plan.reachesGoal);
+    }
+}
+
+void FleetManager::publishPlan(const char* reason) {
+    std::shared_ptr<const PlanSnapshot> previous = std::atomic_load(&planSnapshot_);
+    
+    auto snapshot = std::make_shared<PlanSnapshot>();
+    snapshot->version = previous ? previous->version + 1 : 1;
+    
+    int changed = 0;
+    int nextGoalChanged = 0;
+    for (const auto& [robotId, agent] : fleetRegistry_) {
+        const Layer2::GoalQueue& goals = agent.GetItinerary();
+        size_t dispatched = goalsDispatched_[robotId];
+        
+        // What the previous plan still had queued, less the goals handed out since
+        std::vector<int> pending;
+        if (previous) {
+            auto it = previous->itineraries.find(robotId);
+            if (it != previous->itineraries.end()) {
+                size_t handedOut = std::min(dispatched - previous->dispatched.at(robotId), it->second.size());
+                pending.assign(it->second.begin() + handedOut, it->second.end());
+            }
+        }
+        
+        if (goals != pending) {
+            changed++;
+            int oldNext = pending.empty() ? -1 : pending.front();
+            int newNext = goals.empty() ? -1 : goals.front();
+            if (oldNext != newNext) nextGoalChanged++;
+        }
+        
+        snapshot->itineraries.emplace(robotId, goals.ToVector());
+        snapshot->dispatched.emplace(robotId, dispatched);
+    }
+    
+    uint64_t version = snapshot->version;
+    std::atomic_store(&planSnapshot_, std::shared_ptr<const PlanSnapshot>(std::move(snapshot)));
+    std::cout << "[Plan] v" << version << " (" << reason << "): "
+              << changed << " of " << fleetRegistry_.size() << " robots changed, "
+              << nextGoalChanged << " with a new next goal\n";
+    
+    publishFleetSnapshot();
+}
+
+std::shared_ptr<FleetSnapshot> FleetManager::takeFreeFleetSnapshot() {
+    for (const auto& pooled : snapshotPool_) {
+        // Only the pool holds it, and only the pool can hand it out again
+        if (pooled.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);    // After the last reader let go
+            std::vector<RobotSnapshot> robots = std::move(pooled->robots);
+            robots.clear();
+            *pooled = FleetSnapshot();
+            pooled->robots = std::move(robots);
+            return pooled;
+        }
+    }
+    
+    // All held (a slow reader): grow the pool, or leave the extra to its readers
+    auto snapshot = std::make_shared<FleetSnapshot>();
+    if (snapshotPool_.size() < FLEET_SNAPSHOT_POOL) snapshotPool_.push_back(snapshot);
+    return snapshot;
+}
+
+void FleetManager::publishFleetSnapshot() {
+    std::shared_ptr<const FleetSnapshot> previous = std::atomic_load(&fleetSnapshot_);
+    
+    std::shared_ptr<FleetSnapshot> snapshot = takeFreeFleetSnapshot();
+    snapshot->version = previous ? previous->version + 1 : 1;
+    snapshot->fleetLoopCount = stats_.fleetLoopCount;
+    if (auto plan = std::atomic_load(&planSnapshot_)) {
+        snapshot->planVersion = plan->version;
+    }
+    snapshot->robots.reserve(fleetRegistry_.size());
+    for (const auto& [robotId, agent] : fleetRegistry_) {
+        RobotSnapshot robot;
+        robot.id = robotId;
+        robot.status = agent.GetStatus();
+        robot.currentNodeId = agent.GetCurrentNodeId();
+        robot.remainingWaypoints = static_cast<int>(agent.GetItinerary().size());
+        if (robotId >= 0 && robotId < static_cast<int>(drivers_.size()) && drivers_[robotId]) {
+            const auto& driver = *drivers_[robotId];
+            robot.targetNodeId = driver.GetGoalNodeId();
+            robot.position = driver.GetPosition();
+            robot.velocity = driver.GetVelocity();
+            robot.driverState = driver.GetState();
+            robot.loadCount = driver.GetLoadCount();
+        }
+        snapshot->robots.push_back(robot);
+    }
+    
+    std::atomic_store(&fleetSnapshot_, std::shared_ptr<const FleetSnapshot>(std::move(snapshot)));
+}
+
 void FleetManager::runVRPSolver() {
+    TRACE_ZONE("VRPSolver", "main");
     std::cout << "\n[MainLoop] Running VRP solver...\n";
     
     // Get tasks and robots
@@ -1074,20 +2866,35 @@ void FleetManager::runVRPSolver() {
         return;
     }
     
-    // Run VRP solver
-    auto result = vrpSolver_->Solve(tasks, robots, *costMatrix_);
+    if (!replanInProgress_.load()) prefetchStartCosts(tasks, robots);
+    
+    // Run VRP solver, keeping the order robots already follow for tasks they carry
+    Layer2::SolveOptions options;
+    options.warmStart = Layer2::IVRPSolver::ExtractWarmStart(tasks, robots);
+    options.battery = makeBatteryModel();
+    options.stopGap = config_.solverStopGap;
+    options.scheduler = taskScheduler_.get();
+    auto result = vrpSolver_->Solve(tasks, robots, *costMatrix_, options);
     
     if (!result.isFeasible) {
+        if (eventLog_) eventLog_->LogMarker(EventType::FULL_SOLVE, getFleetTick());
         std::cerr << "[MainLoop] VRP solver returned infeasible solution!\n";
         return;
     }
     
     result.Print();
+    noteGoalTraffic(tasks);
     
     // Assign itineraries to robots
     {
         std::lock_guard<std::mutex> fleetLock(fleetMutex_);
         
+        // Logged at the tick the plan takes effect: the fleet ran on while
+        // it was solved, and a replay holds it there instead
+        if (eventLog_) {
+            eventLog_->LogMarker(EventType::FULL_SOLVE, static_cast<uint64_t>(stats_.fleetLoopCount));
+        }
+        
         for (const auto& [robotId, itinerary] : result.robotItineraries) {
             auto it = fleetRegistry_.find(robotId);
             if (it != fleetRegistry_.end()) {
@@ -1096,7 +2903,9 @@ void FleetManager::runVRPSolver() {
                           << itinerary.size() << " waypoints\n";
             }
         }
+        publishPlan("initial solve");
     }
+    recordPlannedTasks(tasks, result);
     
     // Clear pending tasks (they've been assigned)
     {
@@ -1110,15 +2919,120 @@ void FleetManager::runVRPSolver() {
 // DYNAMIC SCHEDULING (Scenarios B & C)
 // =============================================================================
 
+void FleetManager::repositionIdleRobots(double now) {
+    if (!demandForecast_ || now - repositionedAt_ < config_.repositionIntervalMs / 1000.0) return;
+    repositionedAt_ = now;
+    auto expected = std::atomic_load(&expectedPickups_);
+    if (!expected || expected->empty()) return;
+    
+    TRACE_ZONE("Reposition", "fleet");
+    repositionTargets_.resize(drivers_.size(), -1);
+    positioningGoals_.resize(std::max(positioningGoals_.size(), drivers_.size()), -1);
+    
+    // Idle robots without work; robots heading for or parked at a pickup
+    // cover it. A robot parked for a pickup no longer expecting work is idle.
+    std::unordered_map<int, double> covered;
+    for (const Layer2::DemandForecast::Demand& demand : *expected) covered[demand.node] = 0.0;
+    std::vector<size_t> idle;
+    for (size_t i = 0; i < drivers_.size(); ++i) {
+        if (!drivers_[i]) continue;
+        auto agent = fleetRegistry_.find(static_cast<int>(i));
+        if (agent == fleetRegistry_.end()) continue;
+        if (repositionTargets_[i] >= 0 && !covered.count(repositionTargets_[i])) repositionTargets_[i] = -1;
+        const int goal = drivers_[i]->GetGoalNodeId();
+        if (repositionTargets_[i] >= 0) {
+            covered[repositionTargets_[i]] += 1.0;
+        } else if (auto at = covered.find(goal); at != covered.end()) {
+            at->second += 1.0;
+        }
+        
+        auto state = drivers_[i]->GetState();
+        if ((state == Layer3::Core::DriverState::IDLE || state == Layer3::Core::DriverState::ARRIVED) &&
+            agent->second.GetStatus() == Layer2::RobotStatus::IDLE &&
+            !agent->second.GetState().HasPendingGoals() && repositionTargets_[i] < 0) {
+            idle.push_back(i);
+        }
+    }
+    
+    const float parkingPixels = static_cast<float>(
+        Common::MetersToPixels(config_.poiHoldingDistanceMeters, config_.mapResolution));
+    const auto& nodes = navMesh_->GetAllNodes();
+    for (const Layer2::DemandForecast::Demand& demand : *expected) {
+        if (idle.empty()) break;
+        if (demand.node < 0 || demand.node >= static_cast<int>(nodes.size())) continue;
+        auto spot = parkingSpots_.find(demand.node);
+        if (spot == parkingSpots_.end()) {
+            // Read as the deadlock resolver does: a refresh holding the mesh
+            // postpones the pickup to the next round
+            std::unique_lock<std::mutex> meshLock(mapMutex_, std::defer_lock);
+            if (waitsForOverlay()) {
+                meshLock.lock();
+            } else {
+                meshLock.try_lock();
+            }
+            if (!meshLock.owns_lock()) continue;
+            spot = parkingSpots_.emplace(demand.node, Layer1::POISchedule::FindHoldingNode(
+                *navMesh_, *poiRegistry_, demand.node, parkingPixels)).first;
+        }
+        if (spot->second < 0) continue;
+        
+        const Common::Coordinates& at = nodes[demand.node].coords;
+        double& cover = covered[demand.node];
+        while (!idle.empty() && demand.expected - cover >= REPOSITION_MIN_DEFICIT) {
+            auto nearest = std::min_element(idle.begin(), idle.end(), [&](size_t a, size_t b) {
+                const Common::Coordinates& pa = drivers_[a]->GetPosition();
+                const Common::Coordinates& pb = drivers_[b]->GetPosition();
+                return std::hypot(pa.x - at.x, pa.y - at.y) < std::hypot(pb.x - at.x, pb.y - at.y);
+            });
+            const size_t i = *nearest;
+            idle.erase(nearest);
+            cover += 1.0;
+            repositionTargets_[i] = demand.node;
+            if (drivers_[i]->GetGoalNodeId() == spot->second) continue;  // Already parked there
+            
+            std::cout << "[Bridge] Robot " << i << ": expecting " << demand.expected << " pickups at node "
+                      << demand.node << ", parking at node " << spot->second << "\n";
+            positioningGoals_[i] = spot->second;
+            if (startTimedLeg(*drivers_[i], spot->second)) {
+                // Kinematic: on its way
+            } else if (multiAgentPlanner_) {
+                drivers_[i]->SetScheduledGoal(spot->second);
+                multiAgentGoalsChanged_ = true;
+            } else {
+                drivers_[i]->SetGoal(spot->second);
+            }
+        }
+    }
+}
+
 void FleetManager::processInjectedTasks() {
-    // Drain the injection queue
+    TRACE_ZONE("ProcessInjectedTasks", "main");
+    // Drain the injection queue (producers are never held up meanwhile)
     std::vector<Layer2::Task> newTasks;
-    {
-        std::lock_guard<std::mutex> lock(injectionMutex_);
-        while (!injectionQueue_.empty()) {
-            newTasks.push_back(injectionQueue_.front());
-            injectionQueue_.pop();
-        }
+    newTasks.reserve(injectionQueue_.SizeApprox());
+    injectionQueue_.PopBatch(newTasks);
+    processTaskBatch(newTasks);
+}
+
+void FleetManager::processTaskBatch(const std::vector<Layer2::Task>& newTasks) {
+    if (eventLog_ && !newTasks.empty()) {
+        eventLog_->LogTasks(EventType::TASK_BATCH, getFleetTick(), newTasks);
+    }
+    
+    noteGoalTraffic(newTasks);
+    
+    // Fleet time, so a replay forecasts the same
+    if (demandForecast_ && !newTasks.empty()) {
+        const double now = getFleetTick() * config_.orcaTickMs / 1000.0;
+        demandForecast_->Observe(newTasks, now);
+        std::atomic_store(&expectedPickups_, std::shared_ptr<const std::vector<Layer2::DemandForecast::Demand>>(
+            std::make_shared<std::vector<Layer2::DemandForecast::Demand>>(
+                demandForecast_->ExpectedPickups(now, config_.forecastHorizonSeconds, REPOSITION_MIN_DEFICIT))));
+    }
+    
+    if (config_.rollingHorizon) {
+        processRollingHorizon(newTasks);
+        return;
     }
     
     if (newTasks.empty()) {
@@ -1184,69 +3098,205 @@ void FleetManager::processInjectedTasks() {
 }
 
 void FleetManager::runCheapInsertion(const std::vector<Layer2::Task>& tasks) {
-    std::lock_guard<std::mutex> lock(fleetMutex_);
+    TRACE_ZONE("CheapInsertion", "main");
+    // Plan on a snapshot: the fleet lock is only taken again to commit
+    std::vector<InsertionRoute> routes = snapshotInsertionRoutes();
+    const auto& meshNodes = navMesh_->GetAllNodes();
+    
+    size_t candidateCount = routes.size();
+    if (config_.insertionCandidateRobots > 0) {
+        candidateCount = std::min(candidateCount, static_cast<size_t>(config_.insertionCandidateRobots));
+    }
     
+    std::vector<Layer2::Task> unassigned;
+    std::vector<std::pair<long long, size_t>> nearest;  // (squared pixel distance, route)
     for (const auto& task : tasks) {
-        int bestRobotId = -1;
-        float bestCost = std::numeric_limits<float>::max();
+        // Screen: the routes passing nearest the pickup, by straight-line distance
+        const Common::Coordinates& pickup = meshNodes[task.sourceNode].coords;
+        nearest.clear();
+        for (size_t r = 0; r < routes.size(); ++r) {
+            long long best = std::numeric_limits<long long>::max();
+            for (int node : routes[r].nodes) {
+                long long dx = meshNodes[node].coords.x - pickup.x;
+                long long dy = meshNodes[node].coords.y - pickup.y;
+                best = std::min(best, dx * dx + dy * dy);
+            }
+            nearest.emplace_back(best, r);
+        }
+        if (candidateCount < nearest.size()) {
+            std::nth_element(nearest.begin(), nearest.begin() + candidateCount, nearest.end());
+            nearest.resize(candidateCount);
+        }
         
-        // Find the robot with the cheapest insertion cost
-        for (const auto& [robotId, agent] : fleetRegistry_) {
-            float cost = calculateInsertionCost(agent, task);
-            if (cost < bestCost) {
-                bestCost = cost;
-                bestRobotId = robotId;
+        // Find the cheapest insertion among the candidates (ties: the shorter route)
+        size_t bestRoute = 0;
+        InsertionSlot best;
+        for (const auto& candidate : nearest) {
+            InsertionSlot slot = findCheapestInsertion(routes[candidate.second], task);
+            if (slot.slot < 0) continue;
+            bool tie = best.slot >= 0 && std::abs(slot.cost - best.cost) < 1e-3f;
+            if (best.slot < 0 || (tie ? routes[candidate.second].totalCost < routes[bestRoute].totalCost
+                                      : slot.cost < best.cost)) {
+                best = slot;
+                bestRoute = candidate.second;
             }
         }
         
-        if (bestRobotId >= 0) {
-            // Insert task at the end of this robot's itinerary
-            auto it = fleetRegistry_.find(bestRobotId);
-            if (it != fleetRegistry_.end()) {
-                // Get mutable itinerary and append pickup + dropoff
-                auto& state = it->second.GetMutableState();
-                state.currentItinerary.push_back(task.sourceNode);
-                state.currentItinerary.push_back(task.destinationNode);
-                
-                std::cout << "[Insertion] Task " << task.taskId << " assigned to Robot " 
-                          << bestRobotId << " (extra cost: " << std::fixed 
-                          << std::setprecision(1) << bestCost << " px)\n";
+        if (best.slot < 0) {
+            unassigned.push_back(task);
+            continue;
+        }
+        
+        InsertionRoute& route = routes[bestRoute];
+        route.nodes.insert(route.nodes.begin() + best.slot + 1, {task.sourceNode, task.destinationNode});
+        route.kinds.insert(route.kinds.begin() + best.slot + 1, {1, -1});
+        route.firstChange = std::min(route.firstChange, static_cast<size_t>(best.slot));
+        route.inserted.push_back(task);
+        refreshInsertionRoute(route);
+        
+        std::cout << "[Insertion] Task " << task.taskId << " assigned to Robot " 
+                  << route.robotId << " at goal " << best.slot << " (extra cost: " << std::fixed 
+                  << std::setprecision(1) << best.cost << " px)\n";
+    }
+    
+    // Commit
+    {
+        Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
+        for (const auto& route : routes) {
+            if (route.inserted.empty()) continue;
+            auto it = fleetRegistry_.find(route.robotId);
+            if (it == fleetRegistry_.end()) {
+                unassigned.insert(unassigned.end(), route.inserted.begin(), route.inserted.end());
+                continue;
             }
-        } else {
-            // No robot available, add to pending tasks for next VRP solve
-            std::lock_guard<std::mutex> taskLock(taskMutex_);
+            
+            // Goals reached since the snapshot were popped off the front; the
+            // plan still holds if no insertion went before the goals left
+            const Layer2::GoalQueue& live = it->second.GetItinerary();
+            size_t popped = route.original.size() - std::min(route.original.size(), live.size());
+            bool onlyPopped = live.size() <= route.original.size() &&
+                              std::equal(live.begin(), live.end(), route.original.begin() + popped);
+            
+            if (onlyPopped && popped <= route.firstChange) {
+                it->second.AssignItinerary(std::vector<int>(route.nodes.begin() + 1 + popped, route.nodes.end()));
+            } else {
+                std::vector<int> appended;
+                for (const auto& task : route.inserted) {
+                    appended.push_back(task.sourceNode);
+                    appended.push_back(task.destinationNode);
+                }
+                it->second.AppendToItinerary(appended);
+                std::cout << "[Insertion] Robot " << route.robotId
+                          << " changed course while planning, appended its " << route.inserted.size() << " tasks\n";
+            }
+        }
+        publishPlan("insertion");
+    }
+    
+    if (!unassigned.empty()) {
+        // No robot available, add to pending tasks for next VRP solve
+        std::lock_guard<std::mutex> taskLock(taskMutex_);
+        for (const auto& task : unassigned) {
             pendingTasks_.push_back(task);
-            stats_.pendingTasks++;
             std::cout << "[Insertion] No robot available for task " << task.taskId 
                       << ", queued for next solve\n";
         }
+        stats_.pendingTasks += static_cast<int>(unassigned.size());
     }
 }
 
 void FleetManager::launchBackgroundReplan(const std::vector<Layer2::Task>& tasks) {
     if (replanInProgress_.load()) {
-        std::cout << "[Replan] Background re-plan already in progress, queuing tasks...\n";
-        std::lock_guard<std::mutex> lock(taskMutex_);
-        for (const auto& task : tasks) {
-            pendingTasks_.push_back(task);
+        replanMergeTasks_.insert(replanMergeTasks_.end(), tasks.begin(), tasks.end());
+        if (replanIsHorizon_ || replanMerges_ >= MAX_REPLAN_MERGES) {
+            std::cout << "[Replan] Background re-plan in progress, queuing " << tasks.size()
+                      << " tasks for the next one\n";
+            return;
+        }
+        
+        // The running plan no longer covers all work: have it return its
+        // best solution so far and re-solve everything from there
+        std::cout << "[Replan] Preempting background re-plan to merge " << tasks.size() << " tasks\n";
+        replanPreempted_ = true;
+        replanCancel_ = true;
+        // A replay takes the result when the log says it was taken
+        if (!replaying_ &&
+            replanFuture_.wait_for(std::chrono::milliseconds(PREEMPT_WAIT_MS)) == std::future_status::ready) {
+            checkBackgroundReplan();
         }
-        stats_.pendingTasks += static_cast<int>(tasks.size());
         return;
     }
     
-    replanInProgress_ = true;
-    
     // Capture current robot states for the solver
     std::vector<Layer2::RobotAgent> robots;
     {
-        std::lock_guard<std::mutex> lock(fleetMutex_);
+        Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
+        for (const auto& [id, agent] : fleetRegistry_) {
+            robots.push_back(agent);
+        }
+    }
+    
+    replanIsHorizon_ = false;
+    replanTasks_ = tasks;
+    replanMerges_ = 0;
+    startBackgroundSolve(tasks, std::move(robots));
+}
+
+void FleetManager::launchMergedReplan(const Layer2::VRPResult* incumbent, bool carryOver) {
+    std::vector<Layer2::Task> tasks;
+    if (carryOver) {
+        tasks = std::move(replanTasks_);
+    }
+    size_t newTasks = replanMergeTasks_.size();
+    tasks.insert(tasks.end(), replanMergeTasks_.begin(), replanMergeTasks_.end());
+    replanMergeTasks_.clear();
+    
+    std::vector<Layer2::RobotAgent> robots;
+    {
+        Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
         for (const auto& [id, agent] : fleetRegistry_) {
             robots.push_back(agent);
         }
     }
     
+    // Warm start: the superseded plan's routes, matched to the merged
+    // tasks by endpoints; the solver inserts the new tasks into them
+    std::vector<std::vector<int>> warmStart;
+    if (incumbent) {
+        std::vector<Layer2::RobotAgent> planned = robots;
+        for (auto& robot : planned) {
+            auto it = incumbent->robotItineraries.find(robot.GetRobotId());
+            robot.AssignItinerary(it != incumbent->robotItineraries.end() ? it->second : std::vector<int>());
+        }
+        warmStart = Layer2::IVRPSolver::ExtractWarmStart(tasks, planned);
+    }
+    
+    std::cout << "[Replan] Merged re-plan: " << tasks.size() << " tasks ("
+              << newTasks << " new"
+              << (incumbent ? ", warm-started from the superseded plan" : "") << ")\n";
+    
+    replanMerges_ = carryOver ? replanMerges_ + 1 : 0;
+    replanIsHorizon_ = false;
+    replanTasks_ = tasks;
+    startBackgroundSolve(tasks, std::move(robots), std::move(warmStart));
+}
+
+void FleetManager::startBackgroundSolve(const std::vector<Layer2::Task>& tasks,
+                                        std::vector<Layer2::RobotAgent> robots,
+                                        std::vector<std::vector<int>> warmStart) {
+    prefetchStartCosts(tasks, robots);
+    replanInProgress_ = true;
+    replanCancel_ = false;
+    replanLaunchedAt_ = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(replanProgressMutex_);
+        replanBestMakespan_ = 0.0;
+        replanImprovements_ = 0;
+        replanImprovementsLogged_ = 0;
+    }
+    
     // Launch async solver
-    std::cout << "[Replan] Launching VRP solver in background thread...\n";
+    std::cout << "[Replan] Launching VRP solver on a background worker...\n";
     std::cout << "[Replan] Tasks: " << tasks.size() << ", Robots: " << robots.size() << "\n";
     
     // Capture necessary data for the lambda
@@ -1254,24 +3304,131 @@ void FleetManager::launchBackgroundReplan(const std::vector<Layer2::Task>& tasks
     auto* costs = costMatrix_.get();
     
     // Use mutable lambda since Solve requires non-const robots reference
-    replanFuture_ = std::async(std::launch::async, [solver, costs, tasks, robots]() mutable {
-        return solver->Solve(tasks, robots, *costs);
+    int deadlineMs = config_.replanDeadlineMs;
+    Layer2::BatteryModel battery = makeBatteryModel();
+    if (warmStart.empty()) {
+        warmStart = Layer2::IVRPSolver::ExtractWarmStart(tasks, robots);
+    }
+    double stopGap = config_.solverStopGap;
+    auto* scheduler = taskScheduler_.get();
+    replanFuture_ = taskScheduler_->Submit(Common::TaskPriority::HIGH, [this, solver, costs, scheduler, tasks, robots, deadlineMs,
+                                                                        battery, stopGap,
+                                                                        warmStart = std::move(warmStart)]() mutable {
+        threadPlacement_.Apply(ThreadRole::SOLVER);     // Solver member threads inherit it
+        Layer2::SolveOptions options = Layer2::SolveOptions::WithBudget(deadlineMs);
+        options.cancelToken = &replanCancel_;
+        options.warmStart = std::move(warmStart);
+        options.battery = battery;
+        options.stopGap = stopGap;
+        options.scheduler = scheduler;      // Repair scans split over the other workers
+        options.onImprovement = [this](const Layer2::VRPResult& progress) {
+            std::lock_guard<std::mutex> lock(replanProgressMutex_);
+            replanBestMakespan_ = progress.makespan;
+            replanImprovements_++;
+        };
+        TRACE_THREAD_NAME("ReplanSolver");
+        TRACE_ZONE("VRPSolve", "layer2");
+        auto solveStart = Common::LatencyHistogram::Clock::now();
+        Layer2::VRPResult result = solver->Solve(tasks, robots, *costs, options);
+        replanSolveLatency_.RecordSince(solveStart);
+        return result;
     });
     
-    std::cout << "[Replan] Background solver started (ETA: ~" 
-              << config_.estimatedReplanTimeMs << " ms)\n";
+    std::cout << "[Replan] Background solver started (ETA: ~" << std::fixed << std::setprecision(0)
+              << expectedReplanMs(tasks.size(), robots.size()) << " ms)\n";
+}
+
+void FleetManager::prefetchStartCosts(const std::vector<Layer2::Task>& tasks,
+                                      const std::vector<Layer2::RobotAgent>& robots) {
+    if (!costMatrix_ || costRefreshInProgress_) return;
+    TRACE_ZONE("PrefetchStartCosts", "layer2");
+    
+    std::vector<int> starts;
+    std::vector<int> targets;
+    for (const auto& robot : robots) {
+        starts.push_back(robot.GetCurrentNodeId());
+        if (robot.GetChargingStationNode() >= 0) targets.push_back(robot.GetChargingStationNode());
+    }
+    for (const auto& task : tasks) {
+        targets.push_back(task.sourceNode);
+        targets.push_back(task.destinationNode);
+    }
+    
+    std::lock_guard<std::mutex> lock(mapMutex_);
+    int searched = costMatrix_->PrecomputeStartRows(starts, targets);
+    if (searched > 0 && !config_.batchMode) {
+        std::cout << "[CostMatrix] Searched " << searched << " robot start rows ("
+                  << costMatrix_->GetStartRowCount() << " robots off POIs)\n";
+    }
+}
+
+void FleetManager::checkCostMatrixRefresh() {
+    TRACE_ZONE("CheckCostMatrixRefresh", "main");
+    if (!costMatrix_) return;
+    
+    if (costRefreshInProgress_) {
+        // Swap in only between solves: solvers read the matrix lock-free
+        if (replanInProgress_.load() ||
+            costRefreshFuture_.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+            return;
+        }
+        costRefreshInProgress_ = false;
+        
+        Layer2::CostMatrixProvider::RowRefresh refresh = costRefreshFuture_.get();
+        std::lock_guard<std::mutex> lock(mapMutex_);  // Kinematic legs read the matrix on the fleet thread
+        if (costMatrix_->CommitRefresh(refresh)) {
+            std::cout << "[CostMatrix] Refreshed " << refresh.slots.size() << " of "
+                      << refresh.slotCount << " rows after overlay changes\n";
+        }
+        return;
+    }
+    
+    if (replanInProgress_.load()) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(mapMutex_);
+        if (!costMatrix_->IsStale()) return;
+        
+        // The hierarchy answers the row searches, so bring it up to date
+        // first (no solver is running)
+        if (navHierarchy_ && navHierarchy_->IsStale()) {
+            navHierarchy_->Refresh();
+        }
+    }
+    
+    // Rows are searched off the main loop; the overlay stays locked while
+    // they are, so the obstacle loop waits instead of racing the searches
+    auto* costs = costMatrix_.get();
+    costRefreshFuture_ = taskScheduler_->Submit(Common::TaskPriority::NORMAL, [this, costs]() {
+        TRACE_THREAD_NAME("CostRefresh");
+        threadPlacement_.Apply(ThreadRole::SOLVER);
+        TRACE_ZONE("PrepareRefresh", "layer2");
+        std::lock_guard<std::mutex> lock(mapMutex_);
+        return costs->PrepareRefresh();
+    });
+    costRefreshInProgress_ = true;
 }
 
 void FleetManager::checkBackgroundReplan() {
+    TRACE_ZONE("CheckBackgroundReplan", "main");
     if (!replanInProgress_.load()) {
         return;
     }
     
     // Check if the future is ready (non-blocking)
     if (replanFuture_.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+        {
+            std::lock_guard<std::mutex> lock(replanProgressMutex_);
+            if (replanImprovements_ != replanImprovementsLogged_) {
+                replanImprovementsLogged_ = replanImprovements_;
+                std::cout << "[Replan] Best so far: makespan " << std::fixed << std::setprecision(2)
+                          << replanBestMakespan_ << " (" << replanImprovements_ << " improvements)\n";
+            }
+        }
+        
         // Still computing - check if any robots should wait
         // (Scenario C: Smart wait logic)
-        std::lock_guard<std::mutex> lock(fleetMutex_);
+        Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
         
         for (auto& [id, agent] : fleetRegistry_) {
             if (agent.GetStatus() == Layer2::RobotStatus::IDLE && 
@@ -1291,11 +3448,46 @@ void FleetManager::checkBackgroundReplan() {
     
     // Re-plan is ready - apply the new itineraries!
     std::cout << "\n[Replan] ══════════ Background re-plan complete! ══════════\n";
+    if (eventLog_) eventLog_->LogMarker(EventType::REPLAN_FINISHED, getFleetTick());
+    
+    // Latency as the main loop sees it (sizes the rolling-horizon window)
+    double latencyMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - replanLaunchedAt_).count();
+    replanLatencyMs_ = replanLatencyMs_ > 0.0
+        ? replanLatencyMs_ + HORIZON_SMOOTHING * (latencyMs - replanLatencyMs_)
+        : latencyMs;
     
+    std::optional<Layer2::VRPResult> superseded;    // Warm start for the merged re-solve
+    bool carryOver = false;                         // Its tasks still need a plan
     try {
         Layer2::VRPResult result = replanFuture_.get();
         
-        if (!result.isFeasible) {
+        if (replanPreempted_ && !replanIsHorizon_) {
+            // Cancelled for newer tasks: re-solved with them below, not applied
+            std::cout << "[Replan] Superseded by " << replanMergeTasks_.size()
+                      << " new tasks after " << std::fixed << std::setprecision(0) << latencyMs << " ms\n";
+            carryOver = true;
+            if (result.isFeasible) {
+                superseded = std::move(result);
+            }
+        } else if (replanIsHorizon_) {
+            // Queued tasks were only re-planned, never removed: if the plan
+            // cannot be applied, robots still hold them and only the batch
+            // goes back into the window, which closes again at once
+            bool applied = result.isFeasible && applyHorizonReplan(result);
+            if (applied) {
+                result.Print();
+            } else {
+                std::cerr << "[Horizon] WARNING: " << (result.isFeasible ? "Fleet moved past the kept goals while solving"
+                                                                        : "Solver returned infeasible solution")
+                          << ", re-queuing " << horizonBatch_.size() << " tasks\n";
+                requeueHorizonBatch();
+            }
+            horizonBatch_.clear();
+            horizonPrefixes_.clear();
+            horizonSolveTasks_.clear();
+            robotsWaitingForReplan_.clear();
+        } else if (!result.isFeasible) {
             std::cerr << "[Replan] WARNING: Solver returned infeasible solution!\n";
         } else {
             result.Print();
@@ -1303,7 +3495,7 @@ void FleetManager::checkBackgroundReplan() {
             // APPEND MODE: Add optimized tasks to existing itineraries
             // (Starter tasks are already assigned and being worked on)
             {
-                std::lock_guard<std::mutex> lock(fleetMutex_);
+                Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
                 
                 for (const auto& [robotId, newItinerary] : result.robotItineraries) {
                     auto it = fleetRegistry_.find(robotId);
@@ -1313,9 +3505,7 @@ void FleetManager::checkBackgroundReplan() {
                         size_t existingSize = state.currentItinerary.size();
                         
                         // Append new optimized waypoints to the end
-                        for (int waypoint : newItinerary) {
-                            state.currentItinerary.push_back(waypoint);
-                        }
+                        state.currentItinerary.Append(newItinerary.begin(), newItinerary.end());
                         
                         std::cout << "[Replan] Robot " << robotId << ": appended " 
                                   << newItinerary.size() << " waypoints (had " 
@@ -1323,6 +3513,7 @@ void FleetManager::checkBackgroundReplan() {
                                   << state.currentItinerary.size() << ")\n";
                     }
                 }
+                publishPlan("replan");
             }
             
             // Clear waiting robots list
@@ -1332,34 +3523,379 @@ void FleetManager::checkBackgroundReplan() {
         }
     } catch (const std::exception& e) {
         std::cerr << "[Replan] ERROR: Background solver threw exception: " << e.what() << "\n";
+        carryOver = !replanIsHorizon_;
+        if (replanIsHorizon_) {
+            std::cerr << "[Horizon] Re-queuing " << horizonBatch_.size() << " tasks\n";
+            requeueHorizonBatch();
+            horizonBatch_.clear();
+            horizonPrefixes_.clear();
+            horizonSolveTasks_.clear();
+            robotsWaitingForReplan_.clear();
+        }
     }
     
     replanInProgress_ = false;
+    replanPreempted_ = false;
+    
+    // Tasks that arrived meanwhile: solve them now rather than after the next solve
+    if (!replanMergeTasks_.empty()) {
+        launchMergedReplan(superseded ? &*superseded : nullptr, carryOver);
+    }
 }
 
-float FleetManager::calculateInsertionCost(const Layer2::RobotAgent& robot, 
-                                           const Layer2::Task& task) const {
-    // Get the robot's current position (or last itinerary node)
-    int lastNode = robot.GetCurrentNodeId();
-    const auto& itinerary = robot.GetItinerary();
-    if (!itinerary.empty()) {
-        lastNode = itinerary.back();
+// =============================================================================
+// ROLLING HORIZON
+// =============================================================================
+
+void FleetManager::processRollingHorizon(const std::vector<Layer2::Task>& newTasks) {
+    auto now = std::chrono::steady_clock::now();
+    
+    // Arrival rate, sampled once per main-loop tick
+    if (arrivalSampledAt_ != std::chrono::steady_clock::time_point()) {
+        double seconds = std::chrono::duration<double>(now - arrivalSampledAt_).count();
+        if (seconds > 0.0) {
+            double rate = static_cast<double>(newTasks.size()) / seconds;
+            arrivalRatePerSec_ += HORIZON_SMOOTHING * (rate - arrivalRatePerSec_);
+        }
+    }
+    arrivalSampledAt_ = now;
+    
+    if (!newTasks.empty()) {
+        stats_.totalTasks += static_cast<int>(newTasks.size());
+        if (horizonTasks_.empty()) {
+            horizonOpenedAt_ = now;
+        }
+        horizonTasks_.insert(horizonTasks_.end(), newTasks.begin(), newTasks.end());
     }
     
-    // Cost = distance from last node to pickup + distance from pickup to dropoff
-    float costToPickup = costMatrix_->GetCost(lastNode, task.sourceNode);
-    float costPickupToDropoff = costMatrix_->GetCost(task.sourceNode, task.destinationNode);
+    // One replan at a time: a window that closes meanwhile waits for it
+    if (horizonTasks_.empty() || replanInProgress_.load()) return;
     
-    // If costs are invalid (unreachable), return infinity
-    if (costToPickup < 0 || costPickupToDropoff < 0) {
-        return std::numeric_limits<float>::max();
+    double openMs = std::chrono::duration<double, std::milli>(now - horizonOpenedAt_).count();
+    double windowMs = horizonWindowMs();
+    bool closes = openMs >= windowMs;
+    if (!closes && openMs >= config_.horizonMinWindowMs) {
+        // Past the minimum window, a robot out of work does not wait for the rest
+        Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
+        for (const auto& [id, agent] : fleetRegistry_) {
+            if (agent.GetStatus() == Layer2::RobotStatus::IDLE && !agent.GetState().HasPendingGoals()) {
+                closes = true;
+                break;
+            }
+        }
+    }
+    if (!closes) return;
+    
+    std::cout << "\n[Horizon] ══════════ Window closed ══════════\n";
+    std::cout << "[Horizon] " << horizonTasks_.size() << " tasks in " << std::fixed << std::setprecision(0)
+              << openMs << " ms (window " << windowMs << " ms, " << std::setprecision(2)
+              << arrivalRatePerSec_ << " tasks/s, solver " << std::setprecision(0)
+              << replanLatencyMs_ << " ms)\n";
+    launchHorizonReplan();
+}
+
+double FleetManager::horizonWindowMs() const {
+    // Horizon replans re-plan queued work too, so their own measured latency comes first
+    double latencyMs = replanLatencyMs_ > 0.0
+        ? replanLatencyMs_ : expectedReplanMs(horizonTasks_.size(), fleetRegistry_.size());
+    double windowMs = HORIZON_LATENCY_FACTOR * latencyMs;
+    if (arrivalRatePerSec_ > 0.0) {
+        // Time to gather as many tasks as would trigger a full replan (Scenario C)
+        windowMs = std::max(windowMs, 1000.0 * (config_.batchThreshold + 1) / arrivalRatePerSec_);
+    }
+    double minMs = config_.horizonMinWindowMs;
+    return std::clamp(windowMs, minMs, std::max(minMs, static_cast<double>(config_.horizonMaxWindowMs)));
+}
+
+double FleetManager::expectedReplanMs(size_t tasks, size_t robots) const {
+    if (adaptiveSolver_) {
+        double predictedMs = adaptiveSolver_->Predict(tasks, robots);
+        if (predictedMs >= 0.0) return predictedMs;
+    }
+    return replanLatencyMs_ > 0.0 ? replanLatencyMs_ : config_.estimatedReplanTimeMs;
+}
+
+void FleetManager::launchHorizonReplan() {
+    std::vector<Layer2::RobotAgent> robots;
+    std::vector<InsertionRoute> routes = snapshotInsertionRoutes(&robots);
+    
+    horizonBatch_ = std::move(horizonTasks_);
+    horizonTasks_.clear();
+    horizonPrefixes_.clear();
+    std::vector<Layer2::Task> tasks = horizonBatch_;
+    
+    // Queued tasks keep their ids; plannedTasks_ stays as is until the result is applied
+    std::map<int, std::vector<Layer2::Task>> available = plannedTasks_;
+    
+    for (size_t r = 0; r < routes.size(); ++r) {
+        const InsertionRoute& route = routes[r];
+        size_t last = route.nodes.size() - 1;
+        
+        // Keep the task in progress (up to the first point free of a
+        // package), then horizonFrozenTasks more
+        size_t cut = 0;
+        while (cut < last && !route.freeAfter[cut]) ++cut;
+        for (int frozen = 0; frozen < config_.horizonFrozenTasks && cut < last; ++frozen) {
+            size_t pickup = cut + 1;
+            while (pickup <= last && route.kinds[pickup] != 1) ++pickup;
+            if (pickup > last) {
+                cut = last;
+                break;
+            }
+            cut = pickup;
+            while (cut < last && !route.freeAfter[cut]) ++cut;
+        }
+        
+        // The rest must read as (pickup, dropoff) pairs and charging stops;
+        // charging is re-planned with the route, or left to the robot when low
+        std::vector<int> queued;
+        bool readable = poiRegistry_ != nullptr;
+        for (size_t k = cut + 1; readable && k <= last; ++k) {
+            if (route.kinds[k] == 1 && k < last && route.kinds[k + 1] == -1) {
+                queued.push_back(route.nodes[k]);
+                queued.push_back(route.nodes[k + 1]);
+                ++k;
+            } else if (route.kinds[k] != 0 ||
+                       !poiRegistry_->NodeHasPOIType(route.nodes[k], Layer1::POIType::CHARGING)) {
+                readable = false;
+            }
+        }
+        if (!readable) {
+            cut = last;
+            queued.clear();
+        }
+        
+        horizonPrefixes_[route.robotId] = HorizonPrefix{route.original, cut};
+        
+        // The solver starts the robot where its kept goals end, with its
+        // queued tasks in their current order as the warm start
+        robots[r].SetCurrentNodeId(route.nodes[cut]);
+        robots[r].AssignItinerary(queued);
+        for (size_t k = 0; k + 1 < queued.size(); k += 2) {
+            tasks.push_back(takePlannedTask(available, route.robotId, queued[k], queued[k + 1]));
+        }
+    }
+    
+    std::cout << "[Horizon] Re-planning " << horizonBatch_.size() << " new + "
+              << (tasks.size() - horizonBatch_.size()) << " queued tasks\n";
+    horizonSolveTasks_ = tasks;
+    replanIsHorizon_ = true;
+    startBackgroundSolve(tasks, std::move(robots));
+}
+
+bool FleetManager::applyHorizonReplan(const Layer2::VRPResult& result) {
+    Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
+    
+    // Check every robot before changing any: the plan is applied whole
+    std::map<int, std::vector<int>> itineraries;
+    for (const auto& [robotId, prefix] : horizonPrefixes_) {
+        auto it = fleetRegistry_.find(robotId);
+        if (it == fleetRegistry_.end()) return false;
+        
+        // Since launch, reached goals left the front and charging goals
+        // may have been pushed onto it (UpdateState on low battery)
+        const Layer2::GoalQueue& live = it->second.GetItinerary();
+        const std::vector<int>& original = prefix.original;
+        size_t popped = 0;
+        while (popped <= original.size()) {
+            size_t rest = original.size() - popped;
+            if (rest <= live.size() && std::equal(original.begin() + popped, original.end(), live.end() - rest)) break;
+            ++popped;
+        }
+        if (popped > prefix.kept) return false;
+        
+        size_t pushed = live.size() - (original.size() - popped);
+        for (size_t k = 0; k < pushed; ++k) {
+            if (!poiRegistry_ || !poiRegistry_->NodeHasPOIType(live[k], Layer1::POIType::CHARGING)) return false;
+        }
+        
+        std::vector<int> itinerary(live.begin(), live.begin() + pushed);
+        itinerary.insert(itinerary.end(), original.begin() + popped, original.begin() + prefix.kept);
+        auto solved = result.robotItineraries.find(robotId);
+        if (solved != result.robotItineraries.end()) {
+            itinerary.insert(itinerary.end(), solved->second.begin(), solved->second.end());
+        }
+        itineraries[robotId] = std::move(itinerary);
+    }
+    
+    for (auto& [robotId, itinerary] : itineraries) {
+        auto& agent = fleetRegistry_.at(robotId);
+        std::cout << "[Horizon] Robot " << robotId << ": " << agent.GetItinerary().size()
+                  << " -> " << itinerary.size() << " waypoints\n";
+        agent.AssignItinerary(std::move(itinerary));
+    }
+    publishPlan("horizon replan");
+    recordPlannedTasks(horizonSolveTasks_, result);
+    return true;
+}
+
+void FleetManager::requeueHorizonBatch() {
+    horizonTasks_.insert(horizonTasks_.begin(), horizonBatch_.begin(), horizonBatch_.end());
+    horizonOpenedAt_ = replanLaunchedAt_ - std::chrono::milliseconds(config_.horizonMaxWindowMs);
+}
+
+void FleetManager::recordPlannedTasks(const std::vector<Layer2::Task>& tasks, const Layer2::VRPResult& result) {
+    std::multimap<std::pair<int, int>, const Layer2::Task*> byEndpoints;
+    for (const auto& task : tasks) {
+        byEndpoints.emplace(std::make_pair(task.sourceNode, task.destinationNode), &task);
     }
     
-    return costToPickup + costPickupToDropoff;
+    for (const auto& [robotId, itinerary] : result.robotItineraries) {
+        std::vector<Layer2::Task>& planned = plannedTasks_[robotId];
+        planned.clear();
+        for (size_t k = 0; k + 1 < itinerary.size(); ++k) {
+            auto it = byEndpoints.find({itinerary[k], itinerary[k + 1]});
+            if (it == byEndpoints.end()) continue;
+            planned.push_back(*it->second);
+            byEndpoints.erase(it);
+            ++k;
+        }
+    }
+}
+
+Layer2::Task FleetManager::takePlannedTask(std::map<int, std::vector<Layer2::Task>>& available,
+                                           int robotId, int pickup, int dropoff) {
+    auto planned = available.find(robotId);
+    if (planned != available.end()) {
+        auto& tasks = planned->second;
+        auto it = std::find_if(tasks.begin(), tasks.end(), [&](const Layer2::Task& task) {
+            return task.sourceNode == pickup && task.destinationNode == dropoff;
+        });
+        if (it != tasks.end()) {
+            Layer2::Task task = std::move(*it);
+            tasks.erase(it);
+            return task;
+        }
+    }
+    return Layer2::Task(nextTaskId_++, pickup, dropoff);
+}
+
+std::vector<FleetManager::InsertionRoute> FleetManager::snapshotInsertionRoutes(
+    std::vector<Layer2::RobotAgent>* agents) {
+    std::vector<InsertionRoute> routes;
+    {
+        Common::TracedLockGuard<std::mutex> lock(fleetMutex_, "Wait fleetMutex_");
+        routes.reserve(fleetRegistry_.size());
+        for (const auto& [robotId, agent] : fleetRegistry_) {
+            if (agents) agents->push_back(agent);
+            
+            InsertionRoute route;
+            route.robotId = robotId;
+            route.original = agent.GetItinerary().ToVector();
+            route.capacity = std::max(1, agent.GetCapacity());
+            
+            // A driving robot is next free at its goal, carrying what that goal leaves it with
+            int start = agent.GetCurrentNodeId();
+            const Layer3::Core::RobotDriver* driver = nullptr;
+            for (const auto& d : drivers_) {
+                if (d && d->GetRobotId() == robotId) {
+                    driver = d.get();
+                    break;
+                }
+            }
+            if (driver) {
+                route.loadAtStart = driver->GetLoadCount();
+                auto driverState = driver->GetState();
+                if (driverState != Layer3::Core::DriverState::IDLE &&
+                    driverState != Layer3::Core::DriverState::ARRIVED &&
+                    driver->GetGoalNodeId() >= 0) {
+                    start = driver->GetGoalNodeId();
+                    if (poiRegistry_ && poiRegistry_->NodeHasPOIType(start, Layer1::POIType::PICKUP)) {
+                        route.loadAtStart++;
+                    } else if (poiRegistry_ && poiRegistry_->NodeHasPOIType(start, Layer1::POIType::DROPOFF)) {
+                        route.loadAtStart = std::max(0, route.loadAtStart - 1);
+                    }
+                }
+            }
+            
+            route.nodes.reserve(route.original.size() + 1);
+            route.nodes.push_back(start);
+            route.nodes.insert(route.nodes.end(), route.original.begin(), route.original.end());
+            routes.push_back(std::move(route));
+        }
+    }
+    
+    // Goals already planned are told apart by POI type, as in the
+    // goal-reached callback (without POIs, only route ends are known to be free)
+    for (auto& route : routes) {
+        route.kinds.assign(route.nodes.size(), 0);
+        if (!poiRegistry_) {
+            route.loadAtStart = 1;
+            continue;
+        }
+        for (size_t k = 1; k < route.nodes.size(); ++k) {
+            if (poiRegistry_->NodeHasPOIType(route.nodes[k], Layer1::POIType::PICKUP)) {
+                route.kinds[k] = 1;
+            } else if (poiRegistry_->NodeHasPOIType(route.nodes[k], Layer1::POIType::DROPOFF)) {
+                route.kinds[k] = -1;
+            }
+        }
+    }
+    
+    for (auto& route : routes) {
+        refreshInsertionRoute(route);
+    }
+    return routes;
+}
+
+void FleetManager::refreshInsertionRoute(InsertionRoute& route) const {
+    size_t count = route.nodes.size();
+    route.legCosts.resize(count - 1);
+    route.totalCost = 0.0f;
+    for (size_t k = 0; k + 1 < count; ++k) {
+        route.legCosts[k] = costMatrix_->GetCost(route.nodes[k], route.nodes[k + 1]);
+        route.totalCost += std::max(0.0f, route.legCosts[k]);
+    }
+    
+    // Packets on board: multi-pick batches pick several up before the first dropoff
+    route.freeAfter.resize(count);
+    int load = std::min(route.loadAtStart, route.capacity);
+    for (size_t k = 0; k < count; ++k) {
+        load = std::clamp(load + route.kinds[k], 0, route.capacity);
+        route.freeAfter[k] = load == 0;
+    }
+}
+
+FleetManager::InsertionSlot FleetManager::findCheapestInsertion(const InsertionRoute& route,
+                                                                const Layer2::Task& task) const {
+    InsertionSlot best;
+    float service = costMatrix_->GetCost(task.sourceNode, task.destinationNode);
+    if (service < 0) return best;
+    
+    int last = static_cast<int>(route.nodes.size()) - 1;
+    for (int k = 0; k <= last; ++k) {
+        if (k < last && !route.freeAfter[k]) continue;
+        
+        // nodes[k] -> pickup -> dropoff (-> nodes[k + 1] instead of nodes[k] -> nodes[k + 1])
+        float toPickup = costMatrix_->GetCost(route.nodes[k], task.sourceNode);
+        if (toPickup < 0) continue;
+        float cost = toPickup + service;
+        if (k < last) {
+            float rejoin = costMatrix_->GetCost(task.destinationNode, route.nodes[k + 1]);
+            if (rejoin < 0 || route.legCosts[k] < 0) continue;
+            cost += rejoin - route.legCosts[k];
+        }
+        
+        if (cost < best.cost) {
+            best.cost = cost;
+            best.slot = k;
+        }
+    }
+    return best;
+}
+
+Layer2::BatteryModel FleetManager::makeBatteryModel() const {
+    Layer2::BatteryModel model;
+    if (!config_.solverBatteryAware || !poiRegistry_) return model;
+    
+    model.chargerNodes = poiRegistry_->GetNodesByType(Layer1::POIType::CHARGING);
+    model.costPerSecond = config_.robotSpeedMps / Common::GetConversionFactorToMeters(config_.mapResolution);
+    model.matchChargers = config_.chargerMatching;
+    return model;
 }
 
 int FleetManager::estimateRobotRemainingTimeMs(int robotId) const {
-    // Estimate based on itinerary length and robot speed
+    // Current leg from the driver's path, the rest from the cost matrix
     std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(fleetMutex_));
     
     auto it = fleetRegistry_.find(robotId);
@@ -1367,17 +3903,29 @@ int FleetManager::estimateRobotRemainingTimeMs(int robotId) const {
         return 0;
     }
     
-    const auto& itinerary = it->second.GetItinerary();
-    if (itinerary.empty()) {
-        return 0;
+    float timeSeconds = 0.0f;
+    int legStart = -1;
+    if (robotId >= 0 && robotId < static_cast<int>(drivers_.size()) && drivers_[robotId]) {
+        const auto& driver = *drivers_[robotId];
+        if (driver.HasGoal() || driver.GetState() == Layer3::Core::DriverState::COLLISION_WAIT) {
+            timeSeconds += static_cast<float>(driver.GetETA());
+            legStart = driver.GetGoalNodeId();
+        }
     }
     
-    // Rough estimate: assume average 500 pixels per waypoint at 16 pixels/s
-    float avgPixelsPerWaypoint = 500.0f;
-    float speedPixelsPerSec = config_.robotSpeedMps * 10.0f;  // Convert to decimeters/s
+    const auto& itinerary = it->second.GetItinerary();
     
-    float totalPixels = static_cast<float>(itinerary.size()) * avgPixelsPerWaypoint;
-    float timeSeconds = totalPixels / speedPixelsPerSec;
+    // Rough estimate where no cost is known: 500 pixels per waypoint
+    const float avgPixelsPerWaypoint = 500.0f;
+    float speedPixelsPerSec = config_.robotSpeedMps / Common::GetConversionFactorToMeters(config_.mapResolution);
+    float totalPixels = 0.0f;
+    for (int node : itinerary) {
+        float cost = (costMatrix_ && legStart >= 0) ? costMatrix_->GetCost(legStart, node)
+                                                    : Layer2::CostMatrixProvider::GetInfinity();
+        totalPixels += cost < Layer2::CostMatrixProvider::GetInfinity() ? cost : avgPixelsPerWaypoint;
+        legStart = node;
+    }
+    timeSeconds += totalPixels / speedPixelsPerSec;
     
     return static_cast<int>(timeSeconds * 1000.0f);
 }
@@ -0,0 +1,100 @@
+/**
+ * @file LoopScheduler.cc
+ * @brief Implementation of the fixed-rate loop scheduler
+ */
+
+#include "LoopScheduler.hh"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace Backend {
+
+namespace {
+
+double ToMs(LoopScheduler::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+LoopScheduler::LoopScheduler(Clock::duration period, OverrunPolicy policy, int maxCatchUpTicks)
+    : period_(std::max(period, Clock::duration(1)))
+    , policy_(policy)
+    , maxCatchUpTicks_(std::max(0, maxCatchUpTicks))
+    , started_(false)
+    , tickHistogram_(nullptr)
+    , latenessSumMs_(0.0)
+    , jitterSquaresSum_(0.0)
+    , intervals_(0) {}
+
+void LoopScheduler::Start() {
+    deadline_ = Clock::now();
+    previousStart_ = deadline_;
+    started_ = true;
+}
+
+void LoopScheduler::BeginTick() {
+    if (!started_) {
+        Start();
+    }
+    tickStart_ = Clock::now();
+
+    double latenessMs = std::max(0.0, ToMs(tickStart_ - deadline_));
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    latenessSumMs_ += latenessMs;
+    stats_.maxLatenessMs = std::max(stats_.maxLatenessMs, latenessMs);
+    if (stats_.ticks > 0) {
+        double deviationMs = ToMs(tickStart_ - previousStart_) - ToMs(period_);
+        jitterSquaresSum_ += deviationMs * deviationMs;
+        intervals_++;
+    }
+    previousStart_ = tickStart_;
+}
+
+void LoopScheduler::EndTick() {
+    const auto now = Clock::now();
+    Clock::time_point next = deadline_ + period_;
+    uint64_t skipped = 0;
+    bool overrun = now > next;
+
+    // Deadlines after next that have passed too
+    if (overrun) {
+        auto behind = static_cast<uint64_t>((now - next) / period_);
+        uint64_t keep = policy_ == OverrunPolicy::CATCH_UP
+            ? std::min<uint64_t>(behind, static_cast<uint64_t>(maxCatchUpTicks_))
+            : 0;
+        skipped = behind - keep;
+        next += period_ * static_cast<Clock::rep>(skipped);
+    }
+    deadline_ = next;
+    if (tickHistogram_) {
+        tickHistogram_->Record(now - tickStart_);
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_.ticks++;
+    stats_.maxTickMs = std::max(stats_.maxTickMs, ToMs(now - tickStart_));
+    if (overrun) {
+        stats_.overruns++;
+        stats_.skippedTicks += skipped;
+    }
+}
+
+void LoopScheduler::WaitForNextTick() const {
+    std::this_thread::sleep_until(deadline_);
+}
+
+LoopTimingStats LoopScheduler::GetStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    LoopTimingStats stats = stats_;
+    if (stats.ticks > 0) {
+        stats.meanLatenessMs = latenessSumMs_ / static_cast<double>(stats.ticks);
+    }
+    if (intervals_ > 0) {
+        stats.jitterMs = std::sqrt(jitterSquaresSum_ / static_cast<double>(intervals_));
+    }
+    return stats;
+}
+
+} // namespace Backend
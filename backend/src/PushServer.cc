@@ -0,0 +1,790 @@
+/**
+ * @file PushServer.cc
+ * @brief WebSocket handshake, framing and the non-blocking I/O loop
+ */
+
+#include "PushServer.hh"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Backend {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const CHANNEL_NAMES[PUSH_CHANNEL_COUNT] = {"telemetry", "paths", "obstacles"};
+
+/// RFC 6455 key suffix
+const char* const WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+constexpr uint8_t OPCODE_TEXT = 0x1;
+constexpr uint8_t OPCODE_BINARY = 0x2;
+constexpr uint8_t OPCODE_CLOSE = 0x8;
+constexpr uint8_t OPCODE_PING = 0x9;
+constexpr uint8_t OPCODE_PONG = 0xA;
+
+/// SHA-1 of data (the handshake is its only use)
+std::array<uint8_t, 20> Sha1(const std::string& data) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string message = data;
+    uint64_t bits = static_cast<uint64_t>(data.size()) * 8;
+    message.push_back(static_cast<char>(0x80));
+    while (message.size() % 64 != 56) message.push_back('\0');
+    for (int i = 7; i >= 0; --i) message.push_back(static_cast<char>((bits >> (i * 8)) & 0xFF));
+
+    auto rotl = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto* p = reinterpret_cast<const uint8_t*>(message.data() + chunk + i * 4);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+            uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rotl(b, 30); b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    std::array<uint8_t, 20> digest{};
+    for (int i = 0; i < 20; ++i) digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - (i % 4) * 8));
+    return digest;
+}
+
+std::string Base64(const uint8_t* data, size_t size) {
+    static const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t n = uint32_t(data[i]) << 16;
+        if (i + 1 < size) n |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) n |= data[i + 2];
+        out.push_back(table[(n >> 18) & 63]);
+        out.push_back(table[(n >> 12) & 63]);
+        out.push_back(i + 1 < size ? table[(n >> 6) & 63] : '=');
+        out.push_back(i + 2 < size ? table[n & 63] : '=');
+    }
+    return out;
+}
+
+/// Unmasked server frame
+std::string EncodeFrame(uint8_t opcode, const std::string& payload) {
+    std::string frame;
+    frame.reserve(payload.size() + 10);
+    frame.push_back(static_cast<char>(0x80 | opcode));
+    if (payload.size() < 126) {
+        frame.push_back(static_cast<char>(payload.size()));
+    } else if (payload.size() <= 0xFFFF) {
+        frame.push_back(static_cast<char>(126));
+        frame.push_back(static_cast<char>((payload.size() >> 8) & 0xFF));
+        frame.push_back(static_cast<char>(payload.size() & 0xFF));
+    } else {
+        frame.push_back(static_cast<char>(127));
+        for (int i = 7; i >= 0; --i) {
+            frame.push_back(static_cast<char>((static_cast<uint64_t>(payload.size()) >> (i * 8)) & 0xFF));
+        }
+    }
+    frame.append(payload);
+    return frame;
+}
+
+/// Value of header name in an HTTP request head ("" if absent)
+std::string HeaderValue(const std::string& head, const std::string& name) {
+    std::string lowerHead = head;
+    std::transform(lowerHead.begin(), lowerHead.end(), lowerHead.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    std::string key = "\r\n" + name + ":";
+    std::transform(key.begin(), key.end(), key.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    size_t pos = lowerHead.find(key);
+    if (pos == std::string::npos) return "";
+    size_t start = pos + key.size();
+    size_t end = head.find("\r\n", start);
+    std::string value = head.substr(start, end - start);
+    value.erase(0, value.find_first_not_of(" \t"));
+    value.erase(value.find_last_not_of(" \t") + 1);
+    return value;
+}
+
+constexpr uint64_t NO_KEYFRAME = UINT64_MAX;
+
+/// Position just after "key": in a flat JSON object (npos if absent)
+size_t FindValue(const std::string& text, const char* key) {
+    size_t pos = text.find(std::string("\"") + key + "\"");
+    if (pos == std::string::npos) return pos;
+    pos = text.find(':', pos);
+    if (pos == std::string::npos) return pos;
+    return text.find_first_not_of(" \t\r\n", pos + 1);
+}
+
+/// Numbers of a JSON array starting at pos ('[')
+bool ParseNumberArray(const std::string& text, size_t pos, std::vector<long>& values) {
+    values.clear();
+    if (pos == std::string::npos || text[pos] != '[') return false;
+    size_t end = text.find(']', pos);
+    if (end == std::string::npos) return false;
+    const char* p = text.c_str() + pos + 1;
+    const char* last = text.c_str() + end;
+    while (p < last) {
+        char* next = nullptr;
+        long value = std::strtol(p, &next, 10);
+        if (next == p) {
+            ++p;
+            continue;
+        }
+        values.push_back(value);
+        p = next;
+    }
+    return true;
+}
+
+/// Wrapping every channel's document gets
+std::string ChannelMessage(size_t channel, const std::string& document) {
+    return EncodeFrame(OPCODE_TEXT, std::string("{\"type\":\"") + CHANNEL_NAMES[channel] + "\",\"data\":" + document + "}");
+}
+
+std::string HttpResponse(const char* status, const std::string& body,
+                         const char* contentType = "application/json") {
+    return std::string("HTTP/1.1 ") + status + "\r\n"
+           "Content-Type: " + contentType + "\r\n"
+           "Access-Control-Allow-Origin: *\r\n"
+           "Cache-Control: no-store\r\n"
+           "Connection: close\r\n"
+           "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+} // namespace
+
+const char* ToString(PushChannel channel) {
+    return CHANNEL_NAMES[static_cast<size_t>(channel)];
+}
+
+bool PushInterest::WantsRobot(int robotId) const {
+    return robots.empty() || std::binary_search(robots.begin(), robots.end(), robotId);
+}
+
+bool PushInterest::WantsPosition(int x, int y) const {
+    return !hasViewport || (x >= minX && x <= maxX && y >= minY && y <= maxY);
+}
+
+/**
+ * @brief One connection (HTTP until it upgrades).
+ */
+struct PushServer::Client {
+    int fd = -1;
+    bool websocket = false;
+    bool binary = false;                ///< Binary streams instead of JSON where a channel has one
+    bool closeWhenSent = false;         ///< HTTP reply or close frame queued last
+    bool closed = false;
+    std::string input;
+    std::string control;                ///< Handshake / HTTP reply / pongs, before the next data frame
+    std::shared_ptr<const std::string> sending;     ///< Data frame being written
+    size_t sendOffset = 0;
+    int sendingKind = 0;                ///< 0 text, 1 binary keyframe, 2 binary delta
+    std::array<std::shared_ptr<const std::string>, PUSH_CHANNEL_COUNT> queued;
+    std::array<uint64_t, PUSH_CHANNEL_COUNT> queuedKeyframe;    ///< Binary keyframe in queued, else NO_KEYFRAME
+    std::array<uint64_t, PUSH_CHANNEL_COUNT> binaryBase;        ///< Last binary keyframe put on the wire
+    size_t nextChannel = 0;             ///< Round robin over queued
+    PushInterest interest;
+    std::array<PushClientMemory, PUSH_CHANNEL_COUNT> memory;
+    Clock::time_point lastTelemetry{};  ///< Last telemetry frame queued (for interest.maxRateHz)
+    Clock::time_point lastProgress = Clock::now();
+
+    Client() {
+        queuedKeyframe.fill(NO_KEYFRAME);
+        binaryBase.fill(NO_KEYFRAME);
+    }
+
+    bool HasOutput() const {
+        if (sending || !control.empty()) return true;
+        for (const auto& frame : queued) {
+            if (frame) return true;
+        }
+        return false;
+    }
+};
+
+PushServer::PushServer() = default;
+
+PushServer::~PushServer() {
+    Stop();
+}
+
+// =============================================================================
+// LIFECYCLE
+// =============================================================================
+
+bool PushServer::Start(int port, const std::string& address, std::function<void()> onThreadStart) {
+    if (running_.load()) return true;
+#ifdef _WIN32
+    (void)port;
+    (void)address;
+    (void)onThreadStart;
+    std::cerr << "[PushServer] Not supported on this platform\n";
+    return false;
+#else
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "[PushServer] Bad address: " << address << "\n";
+        return false;
+    }
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) return false;
+    int yes = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd_, MAX_CLIENTS) != 0) {
+        std::cerr << "[PushServer] Could not listen on " << address << ":" << port
+                  << ": " << std::strerror(errno) << "\n";
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &length);
+    port_ = ntohs(addr.sin_port);
+
+    int wake[2];
+    if (pipe2(wake, O_NONBLOCK | O_CLOEXEC) != 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    wakeRead_ = wake[0];
+    wakeWrite_ = wake[1];
+
+    running_ = true;
+    ioThread_ = std::thread([this, onThreadStart]() {
+        if (onThreadStart) onThreadStart();
+        RunIO();
+    });
+    std::cout << "[PushServer] Listening on ws://" << address << ":" << port_ << "/\n";
+    return true;
+#endif
+}
+
+void PushServer::Stop() {
+    if (!running_.exchange(false)) return;
+#ifndef _WIN32
+    char byte = 1;
+    (void)!write(wakeWrite_, &byte, 1);
+    if (ioThread_.joinable()) ioThread_.join();
+
+    for (auto& client : clients_) close(client->fd);
+    clients_.clear();
+    close(listenFd_);
+    close(wakeRead_);
+    close(wakeWrite_);
+    listenFd_ = wakeRead_ = wakeWrite_ = -1;
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_.clients = 0;
+#endif
+}
+
+// =============================================================================
+// PUBLISHING
+// =============================================================================
+
+void PushServer::Publish(PushChannel channel, Encoder encode, FilteredEncoder filtered, Encoder snapshot) {
+    if (!running_.load()) return;
+    {
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        pending_[static_cast<size_t>(channel)] = {std::move(encode), std::move(filtered), std::move(snapshot)};
+    }
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.messagesPublished++;
+    }
+#ifndef _WIN32
+    if (!wakePending_.exchange(true)) {
+        char byte = 1;
+        (void)!write(wakeWrite_, &byte, 1);
+    }
+#endif
+}
+
+void PushServer::PublishBinary(PushChannel channel, BinaryEncoder encode) {
+    if (!running_.load()) return;
+    {
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        pendingBinary_[static_cast<size_t>(channel)] = std::move(encode);
+    }
+#ifndef _WIN32
+    if (!wakePending_.exchange(true)) {
+        char byte = 1;
+        (void)!write(wakeWrite_, &byte, 1);
+    }
+#endif
+}
+
+PushServerStats PushServer::GetStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+#ifndef _WIN32
+
+void PushServer::TakePublished() {
+    // Clear the flag first: a Publish after the swap writes to the pipe again
+    wakePending_ = false;
+    char drain[64];
+    while (read(wakeRead_, drain, sizeof(drain)) > 0) {}
+
+    std::array<PendingMessage, PUSH_CHANNEL_COUNT> messages;
+    std::array<BinaryEncoder, PUSH_CHANNEL_COUNT> binaryMessages;
+    {
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        messages.swap(pending_);
+        binaryMessages.swap(pendingBinary_);
+    }
+    const auto now = Clock::now();
+    for (size_t channel = 0; channel < PUSH_CHANNEL_COUNT; ++channel) {
+        PendingMessage& message = messages[channel];
+        if (!message.encode) continue;
+        auto document = std::make_shared<const std::string>(message.encode());
+        latestDocument_[channel] = document;
+        latestFrame_[channel] = std::make_shared<const std::string>(ChannelMessage(channel, *document));
+        snapshotEncoder_[channel] = std::move(message.snapshot);
+        snapshotDocument_[channel].reset();
+        snapshotFrame_[channel].reset();
+
+        for (auto& client : clients_) {
+            if (!client->websocket || client->closeWhenSent) continue;
+            if (!client->interest.Wants(static_cast<PushChannel>(channel))) continue;
+            if (client->binary && latestBinaryFrame_[channel]) continue;
+            if (Throttled(*client, channel, now)) continue;
+            if (message.filtered && client->interest.FiltersRobots()) {
+                std::string own = message.filtered(client->interest, client->memory[channel]);
+                if (own.empty()) continue;
+                Enqueue(*client, channel, std::make_shared<const std::string>(ChannelMessage(channel, own)));
+                std::lock_guard<std::mutex> lock(statsMutex_);
+                stats_.framesFiltered++;
+                continue;
+            }
+            Enqueue(*client, channel, latestFrame_[channel]);
+        }
+    }
+
+    for (size_t channel = 0; channel < PUSH_CHANNEL_COUNT; ++channel) {
+        if (!binaryMessages[channel]) continue;
+        PushBinaryFrame frame = binaryMessages[channel]();
+        latestBinaryId_[channel] = frame.id;
+        latestBinaryDocument_[channel] = std::make_shared<const std::string>(std::move(frame.keyframe));
+        latestBinaryFrame_[channel] = std::make_shared<const std::string>(
+            EncodeFrame(OPCODE_BINARY, *latestBinaryDocument_[channel]));
+        std::shared_ptr<const std::string> delta;
+        if (!frame.delta.empty()) delta = std::make_shared<const std::string>(EncodeFrame(OPCODE_BINARY, frame.delta));
+
+        for (auto& client : clients_) {
+            if (!client->websocket || !client->binary || client->closeWhenSent) continue;
+            if (!client->interest.Wants(static_cast<PushChannel>(channel))) continue;
+            if (Throttled(*client, channel, now)) continue;
+            if (delta && client->binaryBase[channel] == frame.base) {
+                Enqueue(*client, channel, delta);
+            } else {
+                Enqueue(*client, channel, latestBinaryFrame_[channel], frame.id);
+            }
+        }
+    }
+}
+
+bool PushServer::Throttled(Client& client, size_t channel, Clock::time_point now) {
+    if (channel != static_cast<size_t>(PushChannel::TELEMETRY) || client.interest.maxRateHz <= 0) return false;
+    if (now - client.lastTelemetry < std::chrono::milliseconds(1000 / client.interest.maxRateHz)) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.framesThrottled++;
+        return true;
+    }
+    client.lastTelemetry = now;
+    return false;
+}
+
+std::shared_ptr<const std::string> PushServer::SnapshotDocument(size_t channel) {
+    if (!snapshotEncoder_[channel]) return latestDocument_[channel];
+    if (!snapshotDocument_[channel]) {
+        snapshotDocument_[channel] = std::make_shared<const std::string>(snapshotEncoder_[channel]());
+    }
+    return snapshotDocument_[channel];
+}
+
+std::shared_ptr<const std::string> PushServer::SnapshotFrame(size_t channel) {
+    if (!snapshotEncoder_[channel]) return latestFrame_[channel];
+    if (!snapshotFrame_[channel]) {
+        snapshotFrame_[channel] = std::make_shared<const std::string>(ChannelMessage(channel, *SnapshotDocument(channel)));
+    }
+    return snapshotFrame_[channel];
+}
+
+void PushServer::Enqueue(Client& client, size_t channel, const std::shared_ptr<const std::string>& frame,
+                         uint64_t keyframeId) {
+    if (client.queued[channel]) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.framesDecimated++;
+    }
+    client.queued[channel] = frame;
+    client.queuedKeyframe[channel] = keyframeId;
+}
+
+// =============================================================================
+// I/O LOOP
+// =============================================================================
+
+void PushServer::RunIO() {
+    std::vector<pollfd> fds;
+    while (running_.load()) {
+        fds.clear();
+        fds.push_back({wakeRead_, POLLIN, 0});
+        fds.push_back({listenFd_, POLLIN, 0});
+        for (const auto& client : clients_) {
+            short events = POLLIN;
+            if (client->HasOutput()) events |= POLLOUT;
+            fds.push_back({client->fd, events, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), POLL_TIMEOUT_MS) < 0 && errno != EINTR) break;
+        if (!running_.load()) break;
+
+        if (fds[0].revents & POLLIN) TakePublished();
+        if (fds[1].revents & POLLIN) AcceptClients();
+
+        // Clients accepted above have no pollfd yet; they are polled next round
+        const auto now = Clock::now();
+        for (size_t i = 2; i < fds.size(); ++i) {
+            Client& client = *clients_[i - 2];
+            if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                client.closed = true;
+                continue;
+            }
+            if (fds[i].revents & POLLIN) ReadClient(client);
+            if (!client.closed && client.HasOutput()) WriteClient(client);
+            if (!client.closed && client.HasOutput() &&
+                now - client.lastProgress > std::chrono::milliseconds(CLIENT_STALL_MS)) {
+                DropClient(client, "stalled");
+            }
+        }
+
+        size_t before = clients_.size();
+        clients_.erase(std::remove_if(clients_.begin(), clients_.end(), [](const std::unique_ptr<Client>& client) {
+            if (client->closed) close(client->fd);
+            return client->closed;
+        }), clients_.end());
+        if (clients_.size() != before) {
+            size_t websockets = std::count_if(clients_.begin(), clients_.end(),
+                                              [](const std::unique_ptr<Client>& c) { return c->websocket; });
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            stats_.clients = websockets;
+        }
+    }
+}
+
+void PushServer::AcceptClients() {
+    while (true) {
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (clients_.size() >= static_cast<size_t>(MAX_CLIENTS)) {
+            close(fd);
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            stats_.clientsDropped++;
+            continue;
+        }
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        clients_.push_back(std::move(client));
+    }
+}
+
+void PushServer::DropClient(Client& client, const char* reason) {
+    if (client.closed) return;
+    client.closed = true;
+    std::cout << "[PushServer] Dropped client (" << reason << ")\n";
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_.clientsDropped++;
+}
+
+void PushServer::ReadClient(Client& client) {
+    char buffer[4096];
+    while (true) {
+        ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            client.input.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            client.closed = true;
+            return;
+        }
+        break;
+    }
+
+    if (client.websocket) {
+        HandleClientFrames(client);
+        return;
+    }
+    size_t end = client.input.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        if (client.input.size() > MAX_REQUEST_BYTES) DropClient(client, "request too large");
+        return;
+    }
+    std::string head = client.input.substr(0, end + 2);
+    client.input.erase(0, end + 4);
+    HandleRequest(client, head);
+}
+
+void PushServer::HandleRequest(Client& client, const std::string& head) {
+    size_t methodEnd = head.find(' ');
+    size_t pathEnd = methodEnd == std::string::npos ? std::string::npos : head.find(' ', methodEnd + 1);
+    std::string method = head.substr(0, methodEnd);
+    std::string target = pathEnd == std::string::npos ? "" : head.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+    std::string path = target.substr(0, target.find('?'));
+    std::string query = path.size() < target.size() ? target.substr(path.size() + 1) : "";
+
+    std::string key = HeaderValue(head, "Sec-WebSocket-Key");
+    std::string upgrade = HeaderValue(head, "Upgrade");
+    std::transform(upgrade.begin(), upgrade.end(), upgrade.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (method == "GET" && upgrade == "websocket" && !key.empty()) {
+        auto digest = Sha1(key + WEBSOCKET_GUID);
+        client.control = "HTTP/1.1 101 Switching Protocols\r\n"
+                         "Upgrade: websocket\r\n"
+                         "Connection: Upgrade\r\n"
+                         "Sec-WebSocket-Accept: " + Base64(digest.data(), digest.size()) + "\r\n\r\n";
+        client.websocket = true;
+        client.binary = path == "/binary" || ("&" + query + "&").find("&format=binary&") != std::string::npos;
+        for (size_t channel = 0; channel < PUSH_CHANNEL_COUNT; ++channel) {
+            if (client.binary && latestBinaryFrame_[channel]) {
+                client.queued[channel] = latestBinaryFrame_[channel];
+                client.queuedKeyframe[channel] = latestBinaryId_[channel];
+            } else if (auto snapshot = SnapshotFrame(channel)) {
+                client.queued[channel] = snapshot;
+            }
+        }
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.clientsAccepted++;
+        stats_.clients++;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.httpRequests++;
+    }
+    client.closeWhenSent = true;
+    if (method != "GET") {
+        client.control = HttpResponse("405 Method Not Allowed", "{\"error\":\"GET only\"}");
+        return;
+    }
+    if (path == "/") {
+        client.control = HttpResponse("200 OK", "{\"channels\":[\"telemetry\",\"paths\",\"obstacles\"]}");
+        return;
+    }
+    for (size_t channel = 0; channel < PUSH_CHANNEL_COUNT; ++channel) {
+        if (path == std::string("/") + CHANNEL_NAMES[channel] + ".bin") {
+            client.control = latestBinaryDocument_[channel]
+                ? HttpResponse("200 OK", *latestBinaryDocument_[channel], "application/octet-stream")
+                : HttpResponse("404 Not Found", "{\"error\":\"no binary stream\"}");
+            return;
+        }
+        if (path == std::string("/") + CHANNEL_NAMES[channel]) {
+            auto snapshot = SnapshotDocument(channel);
+            client.control = snapshot
+                ? HttpResponse("200 OK", *snapshot)
+                : HttpResponse("404 Not Found", "{\"error\":\"nothing published yet\"}");
+            return;
+        }
+    }
+    client.control = HttpResponse("404 Not Found", "{\"error\":\"unknown path\"}");
+}
+
+void PushServer::HandleClientFrames(Client& client) {
+    const auto* data = reinterpret_cast<const uint8_t*>(client.input.data());
+    size_t size = client.input.size();
+    size_t offset = 0;
+    while (size - offset >= 2) {
+        uint8_t opcode = data[offset] & 0x0F;
+        bool masked = (data[offset + 1] & 0x80) != 0;
+        uint64_t length = data[offset + 1] & 0x7F;
+        size_t header = 2;
+        if (length == 126) {
+            if (size - offset < 4) break;
+            length = (uint64_t(data[offset + 2]) << 8) | data[offset + 3];
+            header = 4;
+        } else if (length == 127) {
+            if (size - offset < 10) break;
+            length = 0;
+            for (int i = 0; i < 8; ++i) length = (length << 8) | data[offset + 2 + i];
+            header = 10;
+        }
+        // Clients must mask (RFC 6455 5.1); none has a reason to send much
+        if (!masked || length > MAX_CLIENT_MESSAGE_BYTES) {
+            DropClient(client, "bad frame");
+            return;
+        }
+        if (size - offset < header + 4 + length) break;
+
+        const uint8_t* mask = data + offset + header;
+        std::string payload(static_cast<size_t>(length), '\0');
+        for (size_t i = 0; i < length; ++i) payload[i] = static_cast<char>(mask[i % 4] ^ data[offset + header + 4 + i]);
+        offset += header + 4 + static_cast<size_t>(length);
+
+        if (opcode == OPCODE_CLOSE) {
+            client.control += EncodeFrame(OPCODE_CLOSE, payload.substr(0, 2));
+            client.closeWhenSent = true;
+            client.queued = {};
+            break;
+        }
+        if (opcode == OPCODE_PING) client.control += EncodeFrame(OPCODE_PONG, payload);
+        if (opcode == OPCODE_TEXT) Subscribe(client, payload);
+        // Binary / pong from clients carry nothing the server acts on
+    }
+    client.input.erase(0, offset);
+}
+
+void PushServer::Subscribe(Client& client, const std::string& message) {
+    size_t type = FindValue(message, "type");
+    if (type == std::string::npos || message.compare(type, 11, "\"subscribe\"") != 0) return;
+
+    PushInterest interest;
+    size_t channels = FindValue(message, "channels");
+    if (channels != std::string::npos && message[channels] == '[') {
+        size_t end = message.find(']', channels);
+        std::string list = message.substr(channels, end == std::string::npos ? std::string::npos : end - channels);
+        interest.channels = 0;
+        for (size_t channel = 0; channel < PUSH_CHANNEL_COUNT; ++channel) {
+            if (list.find(std::string("\"") + CHANNEL_NAMES[channel] + "\"") != std::string::npos) {
+                interest.channels |= 1u << channel;
+            }
+        }
+    }
+    std::vector<long> values;
+    if (ParseNumberArray(message, FindValue(message, "viewport"), values) && values.size() == 4) {
+        interest.hasViewport = true;
+        interest.minX = static_cast<int>(std::min(values[0], values[2]));
+        interest.minY = static_cast<int>(std::min(values[1], values[3]));
+        interest.maxX = static_cast<int>(std::max(values[0], values[2]));
+        interest.maxY = static_cast<int>(std::max(values[1], values[3]));
+    }
+    if (ParseNumberArray(message, FindValue(message, "robots"), values)) {
+        interest.robots.assign(values.begin(), values.end());
+        std::sort(interest.robots.begin(), interest.robots.end());
+    }
+    size_t rate = FindValue(message, "rate");
+    if (rate != std::string::npos) interest.maxRateHz = std::max(0, std::atoi(message.c_str() + rate));
+    size_t changed = FindValue(message, "changedOnly");
+    interest.changedOnly = changed != std::string::npos && message.compare(changed, 4, "true") == 0;
+
+    // A binary stream is one delta chain shared by every binary client, so
+    // it cannot be narrowed per client: refuse rather than ignore the filter
+    if (client.binary && interest.FiltersRobots()) {
+        client.control += EncodeFrame(OPCODE_TEXT, "{\"type\":\"error\",\"error\":\"robots, viewport and "
+                                                   "changedOnly need a JSON connection\"}");
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.subscriptionsRejected++;
+        return;
+    }
+
+    // Frames queued under the old subscription go out; memories restart
+    client.interest = std::move(interest);
+    client.memory = {};
+    client.lastTelemetry = {};
+    for (size_t channel = 0; channel < PUSH_CHANNEL_COUNT; ++channel) {
+        if (!client.interest.Wants(static_cast<PushChannel>(channel))) {
+            client.queued[channel].reset();
+            client.queuedKeyframe[channel] = NO_KEYFRAME;
+        }
+    }
+}
+
+void PushServer::WriteClient(Client& client) {
+    while (!client.closed) {
+        // Control bytes never go in the middle of a data frame
+        if (!client.sending && client.control.empty()) {
+            for (size_t i = 0; i < PUSH_CHANNEL_COUNT && !client.sending; ++i) {
+                size_t channel = (client.nextChannel + i) % PUSH_CHANNEL_COUNT;
+                if (!client.queued[channel]) continue;
+                client.sending = std::move(client.queued[channel]);
+                client.queued[channel].reset();
+                client.sendOffset = 0;
+                client.sendingKind = 0;
+                if (client.binary && latestBinaryFrame_[channel]) {
+                    // From here the keyframe reaches the client before anything else
+                    client.sendingKind = client.queuedKeyframe[channel] != NO_KEYFRAME ? 1 : 2;
+                    if (client.sendingKind == 1) client.binaryBase[channel] = client.queuedKeyframe[channel];
+                }
+                client.queuedKeyframe[channel] = NO_KEYFRAME;
+                client.nextChannel = channel + 1;
+            }
+        }
+
+        const char* bytes;
+        size_t remaining;
+        if (client.sending) {
+            bytes = client.sending->data() + client.sendOffset;
+            remaining = client.sending->size() - client.sendOffset;
+        } else if (!client.control.empty()) {
+            bytes = client.control.data();
+            remaining = client.control.size();
+        } else {
+            if (client.closeWhenSent) client.closed = true;
+            return;
+        }
+
+        ssize_t n = send(client.fd, bytes, remaining, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) client.closed = true;
+            return;
+        }
+        client.lastProgress = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            stats_.bytesSent += static_cast<uint64_t>(n);
+            if (client.sending && static_cast<size_t>(n) == remaining) {
+                stats_.framesSent++;
+                if (client.sendingKind == 1) stats_.binaryKeyframesSent++;
+                if (client.sendingKind == 2) stats_.binaryDeltasSent++;
+            }
+        }
+        if (client.sending) {
+            client.sendOffset += static_cast<size_t>(n);
+            if (client.sendOffset == client.sending->size()) client.sending.reset();
+        } else {
+            client.control.erase(0, static_cast<size_t>(n));
+        }
+    }
+}
+
+#else
+
+void PushServer::RunIO() {}
+
+#endif
+
+} // namespace Backend
@@ -0,0 +1,368 @@
+/**
+ * @file TaskIngestServer.cc
+ * @brief Length-prefixed JSON batches, acks and backpressure over poll
+ */
+
+#include "TaskIngestServer.hh"
+#include "../api/JsonWriter.hh"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace Backend {
+
+namespace {
+
+constexpr size_t FRAME_HEADER_BYTES = 4;
+constexpr size_t ACK_BYTES_PER_TASK = 12;
+
+/// The top-level "batch" number of a document (-1 if absent)
+long long BatchNumber(std::string_view document) {
+    size_t pos = document.find("\"batch\"");
+    if (pos == std::string_view::npos) return -1;
+    pos = document.find(':', pos);
+    if (pos == std::string_view::npos) return -1;
+    std::string digits(document.substr(pos + 1, 24));
+    char* end = nullptr;
+    long long value = std::strtoll(digits.c_str(), &end, 10);
+    return end == digits.c_str() ? -1 : value;
+}
+
+void IntArray(API::JsonWriter& out, const std::vector<int>& values) {
+    out.Raw("[");
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) out.Raw(",");
+        out.Int(values[i]);
+    }
+    out.Raw("]");
+}
+
+} // namespace
+
+/**
+ * @brief One connection.
+ */
+struct TaskIngestServer::Client {
+    int fd = -1;
+    bool closed = false;
+    bool closeWhenSent = false;     ///< Error reply queued last
+    bool paused = false;            ///< Refused tasks: not read until the backlog drains
+    std::string input;
+    std::string output;
+};
+
+TaskIngestServer::TaskIngestServer(BatchHandler handler, BacklogProbe backlog, size_t maxBacklog)
+    : handler_(std::move(handler)), backlog_(std::move(backlog)), maxBacklog_(std::max<size_t>(1, maxBacklog)) {}
+
+TaskIngestServer::~TaskIngestServer() {
+    Stop();
+}
+
+TaskIngestStats TaskIngestServer::GetStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+void TaskIngestServer::QueueMessage(Client& client, const std::string& json) {
+    uint32_t length = static_cast<uint32_t>(json.size());
+    char header[FRAME_HEADER_BYTES] = {static_cast<char>(length >> 24), static_cast<char>(length >> 16),
+                                       static_cast<char>(length >> 8), static_cast<char>(length)};
+    client.output.append(header, FRAME_HEADER_BYTES);
+    client.output += json;
+}
+
+void TaskIngestServer::HandleBatch(Client& client, std::string_view document) {
+    size_t backlog = backlog_();
+    size_t capacity = backlog < maxBacklog_ ? maxBacklog_ - backlog : 0;
+    long long batch = BatchNumber(document);
+
+    TaskIngestResult result;
+    if (capacity > 0) result = handler_(document, capacity);
+    const bool busy = capacity == 0;
+    client.paused = busy || !result.refusedIds.empty();
+
+    const char* status = busy                        ? "busy"
+                         : !result.error.empty()     ? "error"
+                         : result.refusedIds.empty() ? "ok"
+                                                     : "partial";
+
+    API::JsonWriter out(128 + result.error.size() +
+                        (result.ids.size() * 2 + result.refusedIds.size()) * ACK_BYTES_PER_TASK);
+    out.Raw("{\"type\":\"ack\",\"batch\":").Int(batch).Raw(",\"status\":").String(status);
+    if (!result.error.empty()) out.Raw(",\"error\":").String(result.error);
+    out.Raw(",\"accepted\":").UInt(result.ids.size()).Raw(",\"ids\":");
+    IntArray(out, result.ids);
+    out.Raw(",\"taskIds\":");
+    IntArray(out, result.taskIds);
+    out.Raw(",\"rejected\":").UInt(result.rejected)
+       .Raw(",\"refused\":").UInt(result.refusedIds.size()).Raw(",\"refusedIds\":");
+    IntArray(out, result.refusedIds);
+    out.Raw(",\"backlog\":").UInt(backlog_()).Raw("}");
+    QueueMessage(client, out.Take());
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_.batches++;
+    stats_.tasksAccepted += result.ids.size();
+    stats_.tasksRejected += result.rejected;
+    stats_.tasksRefused += result.refusedIds.size();
+    if (busy) stats_.busyReplies++;
+    if (!result.error.empty()) stats_.errorReplies++;
+}
+
+#ifndef _WIN32
+
+bool TaskIngestServer::Start(int port, const std::string& address, std::function<void()> onThreadStart) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "[TaskIngest] Bad address: " << address << "\n";
+        return false;
+    }
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) return false;
+    int yes = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd_, MAX_CLIENTS) != 0) {
+        std::cerr << "[TaskIngest] Could not listen on " << address << ":" << port
+                  << ": " << std::strerror(errno) << "\n";
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    socklen_t length = sizeof(addr);
+    getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &length);
+    port_ = ntohs(addr.sin_port);
+
+    if (!StartThread(std::move(onThreadStart))) return false;
+    std::cout << "[TaskIngest] Listening on tcp://" << address << ":" << port_ << "\n";
+    return true;
+}
+
+bool TaskIngestServer::StartUnix(const std::string& path, std::function<void()> onThreadStart) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[TaskIngest] Bad socket path: " << path << "\n";
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) return false;
+    unlink(path.c_str());
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd_, MAX_CLIENTS) != 0) {
+        std::cerr << "[TaskIngest] Could not listen on " << path << ": " << std::strerror(errno) << "\n";
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    unixPath_ = path;
+
+    if (!StartThread(std::move(onThreadStart))) return false;
+    std::cout << "[TaskIngest] Listening on unix:" << path << "\n";
+    return true;
+}
+
+bool TaskIngestServer::StartThread(std::function<void()> onThreadStart) {
+    int wake[2];
+    if (pipe2(wake, O_NONBLOCK | O_CLOEXEC) != 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    wakeRead_ = wake[0];
+    wakeWrite_ = wake[1];
+
+    running_ = true;
+    ioThread_ = std::thread([this, onThreadStart]() {
+        if (onThreadStart) onThreadStart();
+        RunIO();
+    });
+    return true;
+}
+
+void TaskIngestServer::Stop() {
+    if (!running_.exchange(false)) return;
+    char byte = 1;
+    (void)!write(wakeWrite_, &byte, 1);
+    if (ioThread_.joinable()) ioThread_.join();
+
+    for (auto& client : clients_) close(client->fd);
+    clients_.clear();
+    close(listenFd_);
+    close(wakeRead_);
+    close(wakeWrite_);
+    listenFd_ = wakeRead_ = wakeWrite_ = -1;
+    if (!unixPath_.empty()) unlink(unixPath_.c_str());
+}
+
+void TaskIngestServer::RunIO() {
+    std::vector<pollfd> fds;
+    while (running_.load()) {
+        ResumeClients();
+
+        fds.clear();
+        fds.push_back({wakeRead_, POLLIN, 0});
+        fds.push_back({listenFd_, POLLIN, 0});
+        for (const auto& client : clients_) {
+            short events = 0;
+            if (!client->paused && !client->closeWhenSent) events |= POLLIN;
+            if (!client->output.empty()) events |= POLLOUT;
+            fds.push_back({client->fd, events, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), POLL_TIMEOUT_MS) < 0 && errno != EINTR) break;
+        if (!running_.load()) break;
+
+        if (fds[1].revents & POLLIN) AcceptClients();
+
+        // Clients accepted above have no pollfd yet; they are polled next round
+        for (size_t i = 2; i < fds.size(); ++i) {
+            Client& client = *clients_[i - 2];
+            if (fds[i].revents & (POLLERR | POLLNVAL)) {
+                client.closed = true;
+                continue;
+            }
+            if (fds[i].revents & (POLLIN | POLLHUP)) ReadClient(client);
+            if (!client.closed && !client.output.empty()) WriteClient(client);
+            if (client.closeWhenSent && client.output.empty()) client.closed = true;
+        }
+
+        clients_.erase(std::remove_if(clients_.begin(), clients_.end(), [](const std::unique_ptr<Client>& client) {
+            if (client->closed) close(client->fd);
+            return client->closed;
+        }), clients_.end());
+    }
+}
+
+void TaskIngestServer::AcceptClients() {
+    while (true) {
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (clients_.size() >= static_cast<size_t>(MAX_CLIENTS)) {
+            close(fd);
+            continue;
+        }
+        if (unixPath_.empty()) {
+            int yes = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        }
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        clients_.push_back(std::move(client));
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.connections++;
+    }
+}
+
+void TaskIngestServer::ReadClient(Client& client) {
+    char buffer[16 * 1024];
+    while (true) {
+        ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            client.input.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            // Batches already received are still answered, as far as the socket takes it
+            ProcessFrames(client);
+            WriteClient(client);
+            client.closed = true;
+            return;
+        }
+        break;
+    }
+    ProcessFrames(client);
+}
+
+void TaskIngestServer::ProcessFrames(Client& client) {
+    size_t offset = 0;
+    while (!client.paused && !client.closeWhenSent && client.input.size() - offset >= FRAME_HEADER_BYTES) {
+        const auto* header = reinterpret_cast<const unsigned char*>(client.input.data() + offset);
+        uint32_t length = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) |
+                          (uint32_t(header[2]) << 8) | uint32_t(header[3]);
+        if (length > MAX_FRAME_BYTES) {
+            QueueMessage(client, "{\"type\":\"error\",\"message\":\"frame too large\"}");
+            client.closeWhenSent = true;
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            stats_.protocolErrors++;
+            break;
+        }
+        if (client.input.size() - offset < FRAME_HEADER_BYTES + length) break;
+        HandleBatch(client, std::string_view(client.input).substr(offset + FRAME_HEADER_BYTES, length));
+        offset += FRAME_HEADER_BYTES + length;
+    }
+    client.input.erase(0, offset);
+}
+
+void TaskIngestServer::ResumeClients() {
+    bool anyPaused = std::any_of(clients_.begin(), clients_.end(),
+                                 [](const std::unique_ptr<Client>& client) { return client->paused; });
+    if (!anyPaused) return;
+    size_t backlog = backlog_();
+    if (backlog * 100 >= maxBacklog_ * RESUME_PERCENT) return;
+
+    API::JsonWriter out(48);
+    out.Raw("{\"type\":\"resume\",\"backlog\":").UInt(backlog).Raw("}");
+    const std::string message = out.Take();
+    for (auto& client : clients_) {
+        if (!client->paused) continue;
+        client->paused = false;
+        QueueMessage(*client, message);
+        // Batches that arrived while paused are next in line
+        ProcessFrames(*client);
+    }
+}
+
+void TaskIngestServer::WriteClient(Client& client) {
+    while (!client.output.empty()) {
+        ssize_t n = send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) client.closed = true;
+            return;
+        }
+        client.output.erase(0, static_cast<size_t>(n));
+    }
+}
+
+#else
+
+bool TaskIngestServer::Start(int, const std::string&, std::function<void()>) {
+    std::cerr << "[TaskIngest] Not supported on this platform\n";
+    return false;
+}
+
+bool TaskIngestServer::StartUnix(const std::string&, std::function<void()>) {
+    std::cerr << "[TaskIngest] Not supported on this platform\n";
+    return false;
+}
+
+bool TaskIngestServer::StartThread(std::function<void()>) { return false; }
+void TaskIngestServer::Stop() { running_ = false; }
+void TaskIngestServer::RunIO() {}
+void TaskIngestServer::AcceptClients() {}
+void TaskIngestServer::ReadClient(Client&) {}
+void TaskIngestServer::ProcessFrames(Client&) {}
+void TaskIngestServer::ResumeClients() {}
+void TaskIngestServer::WriteClient(Client&) {}
+
+#endif
+
+} // namespace Backend
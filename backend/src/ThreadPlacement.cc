@@ -0,0 +1,272 @@
+/**
+ * @file ThreadPlacement.cc
+ * @brief Resolution and application of thread CPU / priority placement
+ */
+
+#include "ThreadPlacement.hh"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Backend {
+
+namespace {
+
+constexpr int HIGH_NICE = -10;
+constexpr int LOW_NICE = 10;
+constexpr int REALTIME_FIFO_PRIORITY = 10;  ///< Below threaded IRQ handlers (50), so a long tick cannot starve them
+
+const char* const ROLE_NAMES[THREAD_ROLE_COUNT] = {"physics", "strategic", "obstacle", "solver", "io"};
+
+/// CPUs as "0-2,5"
+std::string FormatCpus(const std::vector<int>& cpus) {
+    std::ostringstream out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (i > 0) out << ",";
+        out << cpus[i];
+        if (j > i) out << "-" << cpus[j];
+        i = j + 1;
+    }
+    return out.str();
+}
+
+std::vector<int> GetProcessCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        int count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < count; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::vector<int> Without(const std::vector<int>& cpus, const std::vector<int>& removed) {
+    std::vector<int> kept;
+    std::set_difference(cpus.begin(), cpus.end(), removed.begin(), removed.end(), std::back_inserter(kept));
+    return kept;
+}
+
+} // namespace
+
+bool ThreadPlacementConfig::IsSet() const {
+    if (isolatePhysics) return true;
+    for (const auto& role : roles) {
+        if (!role.cpus.empty() || role.priority != ThreadPriority::NORMAL) return true;
+    }
+    return false;
+}
+
+const char* ToString(ThreadRole role) {
+    return ROLE_NAMES[static_cast<size_t>(role)];
+}
+
+const char* ToString(ThreadPriority priority) {
+    switch (priority) {
+        case ThreadPriority::NORMAL:   return "normal";
+        case ThreadPriority::HIGH:     return "high";
+        case ThreadPriority::LOW:      return "low";
+        case ThreadPriority::REALTIME: return "realtime";
+    }
+    return "normal";
+}
+
+bool ParseThreadRole(const std::string& text, ThreadRole& role) {
+    for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+        if (text == ROLE_NAMES[i]) {
+            role = static_cast<ThreadRole>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseThreadPriority(const std::string& text, ThreadPriority& priority) {
+    for (ThreadPriority p : {ThreadPriority::NORMAL, ThreadPriority::HIGH,
+                             ThreadPriority::LOW, ThreadPriority::REALTIME}) {
+        if (text == ToString(p)) {
+            priority = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseCpuList(const std::string& text, std::vector<int>& cpus) {
+    cpus.clear();
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        size_t dash = item.find('-');
+        try {
+            size_t used = 0;
+            int first = std::stoi(item, &used);
+            int last = first;
+            if (dash != std::string::npos) {
+                if (used != dash) throw std::invalid_argument(item);
+                size_t lastUsed = 0;
+                last = std::stoi(item.substr(dash + 1), &lastUsed);
+                if (dash + 1 + lastUsed != item.size()) throw std::invalid_argument(item);
+            } else if (used != item.size()) {
+                throw std::invalid_argument(item);
+            }
+            if (first < 0 || last < first) throw std::invalid_argument(item);
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        } catch (const std::exception&) {
+            cpus.clear();
+            return false;
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return !cpus.empty();
+}
+
+// =============================================================================
+// RESOLUTION
+// =============================================================================
+
+void ThreadPlacement::Resolve(const ThreadPlacementConfig& config) {
+    active_ = config.IsSet();
+    if (!active_) return;
+    allowedCpus_ = GetProcessCpus();
+
+    for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+        const ThreadRoleConfig& requested = config.roles[i];
+        ResolvedRole& role = roles_[i];
+        role.priority = requested.priority;
+        role.cpus.clear();
+        if (requested.cpus.empty()) continue;
+
+        std::vector<int> cpus;
+        if (!ParseCpuList(requested.cpus, cpus)) {
+            std::cerr << "[Threads] Warning: bad CPU list \"" << requested.cpus << "\" for "
+                      << ROLE_NAMES[i] << ", running it on any CPU\n";
+            continue;
+        }
+        std::vector<int> unusable = Without(cpus, allowedCpus_);
+        if (!unusable.empty()) {
+            std::cerr << "[Threads] Warning: CPUs " << FormatCpus(unusable) << " of " << ROLE_NAMES[i]
+                      << " are not available to this process (allowed: " << FormatCpus(allowedCpus_) << ")\n";
+        }
+        role.cpus = Without(cpus, unusable);
+    }
+
+    if (!config.isolatePhysics) return;
+    ResolvedRole& physics = roles_[static_cast<size_t>(ThreadRole::PHYSICS)];
+    if (physics.cpus.empty()) {
+        if (allowedCpus_.size() < 2) {
+            std::cerr << "[Threads] Warning: isolating physics needs 2 or more CPUs, this process has "
+                      << allowedCpus_.size() << "\n";
+            return;
+        }
+        physics.cpus = {allowedCpus_.back()};
+    }
+
+    // Every other role gets what physics leaves; a role confined to the
+    // physics CPUs alone is moved to the rest
+    std::vector<int> remaining = Without(allowedCpus_, physics.cpus);
+    if (remaining.empty()) {
+        std::cerr << "[Threads] Warning: physics CPUs " << FormatCpus(physics.cpus)
+                  << " are all this process has, nothing left to isolate them from\n";
+        return;
+    }
+    for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+        if (i == static_cast<size_t>(ThreadRole::PHYSICS)) continue;
+        ResolvedRole& role = roles_[i];
+        std::vector<int> kept = Without(role.cpus.empty() ? allowedCpus_ : role.cpus, physics.cpus);
+        role.cpus = kept.empty() ? remaining : kept;
+    }
+}
+
+// =============================================================================
+// APPLICATION
+// =============================================================================
+
+bool ThreadPlacement::Apply(ThreadRole role) const {
+    if (!active_) return true;
+    const size_t index = static_cast<size_t>(role);
+    const ResolvedRole& placement = roles_[index];
+    std::string failure;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : placement.cpus.empty() ? allowedCpus_ : placement.cpus) CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) failure = std::string("affinity: ") + std::strerror(rc);
+
+    sched_param param{};
+    int policy = SCHED_OTHER;
+    int nice = 0;
+    switch (placement.priority) {
+        case ThreadPriority::NORMAL:   break;
+        case ThreadPriority::HIGH:     nice = HIGH_NICE; break;
+        case ThreadPriority::LOW:      policy = SCHED_BATCH; nice = LOW_NICE; break;
+        case ThreadPriority::REALTIME:
+            policy = SCHED_FIFO;
+            param.sched_priority = REALTIME_FIFO_PRIORITY;
+            break;
+    }
+    rc = pthread_setschedparam(pthread_self(), policy, &param);
+    if (rc != 0) {
+        failure += std::string(failure.empty() ? "" : "; ") + ToString(placement.priority) + " priority: " + std::strerror(rc);
+    } else if (policy != SCHED_FIFO) {
+        // Nice values are per thread on Linux
+        const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+        if (setpriority(PRIO_PROCESS, tid, nice) != 0) {
+            failure += std::string(failure.empty() ? "" : "; ") + "nice " + std::to_string(nice) + ": " + std::strerror(errno);
+        }
+    }
+#else
+    failure = "not supported on this platform";
+#endif
+
+    if (failure.empty()) return true;
+    if (!warned_[index].exchange(true)) {
+        std::cerr << "[Threads] Warning: could not place " << ROLE_NAMES[index] << " thread (" << failure << ")\n";
+    }
+    return false;
+}
+
+size_t ThreadPlacement::GetCpuCount(ThreadRole role) const {
+    const ResolvedRole& placement = roles_[static_cast<size_t>(role)];
+    if (!placement.cpus.empty()) return placement.cpus.size();
+    if (!allowedCpus_.empty()) return allowedCpus_.size();
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::string ThreadPlacement::Describe() const {
+    std::ostringstream out;
+    for (size_t i = 0; i < THREAD_ROLE_COUNT; ++i) {
+        const ResolvedRole& role = roles_[i];
+        out << "[Threads] " << ROLE_NAMES[i] << ": CPUs "
+            << FormatCpus(role.cpus.empty() ? allowedCpus_ : role.cpus)
+            << ", " << ToString(role.priority) << " priority\n";
+    }
+    return out.str();
+}
+
+} // namespace Backend
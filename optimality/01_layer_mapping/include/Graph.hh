@@ -2,13 +2,17 @@
 #define GRAPH_H
 
 #include <vector>
-#include <unordered_map>
 #include <utility>
 #include <iostream>
 #include <string>
-#include <set>
+#include <cstddef>
 
 //Where node is 
+//Nodes live at dense indices (in the order they were added) and nodeId maps
+//to one through indexById. Once frozen (loadFromStream, read_graph, freeze)
+//the adjacency is one CSR layout, the same as Backend::Layer1::NavMesh:
+//csrOffsets[i]..csrOffsets[i + 1] are node i's edges in csrEdges, sorted by
+//destination id. See NavMeshConversion.hh to go between the two.
 class Graph {
 
 public:
@@ -37,15 +41,32 @@ public:
         double speed { 1.6 };     
         double distance { 0.0 };
         int nodeDestinationId { -1 };
+        int destinationIndex { -1 };   // Dense index of nodeDestinationId
         Edge() = default;
-        Edge(double s, double d, int destId) : speed(s), distance(d), nodeDestinationId(destId) {}
+        Edge(double s, double d, int destId, int destIndex = -1)
+            : speed(s), distance(d), nodeDestinationId(destId), destinationIndex(destIndex) {}
         
-        // Add operator< for set compatibility
+        // Edges of a node are kept ordered by destination
         bool operator<(const Edge& other) const {
             return nodeDestinationId < other.nodeDestinationId;
         }
     };
 
+    //EDGE RANGE (contiguous run of a node's edges, valid until the graph is modified)
+    class EdgeRange {
+    public:
+        EdgeRange() = default;
+        EdgeRange(const Edge* b, const Edge* e) : first(b), last(e) {}
+        const Edge* begin() const { return first; }
+        const Edge* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+        const Edge& operator[](size_t i) const { return first[i]; }
+    private:
+        const Edge* first { nullptr };
+        const Edge* last { nullptr };
+    };
+
     //Constructor and Destructor
     Graph();
     ~Graph();
@@ -54,8 +75,28 @@ public:
     int addNode(int nodeId, NodeType type, double x, double y);
     bool addEdge(int fromNodeId, int toNodeId, double distance = 0.0, double speed = 1.6);
     const Node* getNode(int nodeId) const;
-    const std::vector<Edge>& getEdges(int nodeId) const;
+    EdgeRange getEdges(int nodeId) const;
     int getNumVertices() const;
+
+    // Dense index access (0 .. getNumVertices() - 1)
+    int getNodeIndex(int nodeId) const;     // -1 if there is no such node
+    const Node& getNodeByIndex(int index) const { return nodes[index]; }
+    EdgeRange getEdgesByIndex(int index) const;
+    const std::vector<Node>& getAllNodes() const { return nodes; }
+
+    // Pack the adjacency into the CSR arrays; adding nodes or edges afterwards
+    // is allowed but un-freezes the graph.
+    void freeze();
+    bool isFrozen() const { return frozen; }
+
+    // Replace the whole graph with an already-frozen CSR layout. offsets must
+    // have nodes.size() + 1 entries, ending at edges.size(), and every edge a
+    // valid destinationIndex. Throws std::invalid_argument otherwise.
+    void loadFrozen(std::vector<Node> nodes, std::vector<int> offsets, std::vector<Edge> edges);
+
+    // Raw CSR arrays (empty unless frozen)
+    const std::vector<int>& getCSROffsets() const { return csrOffsets; }
+    const std::vector<Edge>& getCSREdges() const { return csrEdges; }
     void printGraph() const;
     void read_graph();
     
@@ -68,12 +109,19 @@ public:
 
 private:
     //Private Members
-    int numVertices;
     int nextNodeId;
+    bool frozen;
 
     //Graph Definition
-    std::unordered_map<int, Node> nodes;  // Store nodes by ID
-    std::unordered_map<int, std::set<Edge>> adjacencyList;  // Changed to unordered_map of sets
+    std::vector<Node> nodes;                        // By dense index
+    std::vector<int> indexById;                     // nodeId -> index (-1 = none)
+    std::vector<std::vector<Edge>> adjacencyList;   // While building, sorted by destination id
+    std::vector<int> csrOffsets;                    // Frozen: numVertices + 1 entries
+    std::vector<Edge> csrEdges;
+
+    // Back to per-node lists so edges can be added
+    void thaw();
+    bool insertEdge(int fromIndex, const Edge& edge);
 };
 
 #endif // GRAPH_H
@@ -0,0 +1,86 @@
+#ifndef NAVMESH_CONVERSION_HH
+#define NAVMESH_CONVERSION_HH
+
+// Converts between the optimality Graph and the backend's
+// Backend::Layer1::NavMesh. Both keep nodes at dense indices and edges in
+// the same CSR layout, so a conversion is a copy of the three arrays with
+// the units changed: Graph coordinates and distances are map units (as in
+// the graph files), NavMesh ones pixels.
+//
+// Header-only so the optimality tools need not link the backend: include it
+// from code built with the backend's common/include and layer1/include on
+// the include path, and link layer1's NavMesh.
+
+#include "Graph.hh"
+#include "NavMesh.hh"
+
+#include <cmath>
+#include <vector>
+
+namespace NavMeshConversion {
+
+    // Graph -> NavMesh. Node i of the mesh is node i of the graph (its
+    // nodeId is dropped, and so are types and speeds); edge costs are the
+    // distances in pixels.
+    inline void toNavMesh(const Graph& graph, Backend::Layer1::NavMesh& mesh, double pixelsPerUnit) {
+        const std::vector<Graph::Node>& nodes = graph.getAllNodes();
+
+        std::vector<Backend::Common::Node> meshNodes;
+        meshNodes.reserve(nodes.size());
+        for (const Graph::Node& node : nodes) {
+            Backend::Common::Node meshNode;
+            meshNode.coords.x = static_cast<int>(std::lround(node.coordinates.first * pixelsPerUnit));
+            meshNode.coords.y = static_cast<int>(std::lround(node.coordinates.second * pixelsPerUnit));
+            meshNodes.push_back(meshNode);
+        }
+
+        std::vector<int> offsets(nodes.size() + 1, 0);
+        std::vector<Backend::Common::Edge> meshEdges;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            offsets[i] = static_cast<int>(meshEdges.size());
+            for (const Graph::Edge& edge : graph.getEdgesByIndex(static_cast<int>(i))) {
+                Backend::Common::Edge meshEdge;
+                meshEdge.targetNodeId = edge.destinationIndex;
+                meshEdge.cost = static_cast<float>(edge.distance * pixelsPerUnit);
+                meshEdges.push_back(meshEdge);
+            }
+        }
+        offsets[nodes.size()] = static_cast<int>(meshEdges.size());
+
+        mesh.LoadFrozen(std::move(meshNodes), std::move(offsets), std::move(meshEdges));
+    }
+
+    // NavMesh -> Graph. Node IDs are the mesh indices and every node is a
+    // Waypoint (addNode with the same ID retypes one without un-freezing
+    // the graph); edges get the default speed.
+    inline void fromNavMesh(const Backend::Layer1::NavMesh& mesh, Graph& graph, double pixelsPerUnit) {
+        const std::vector<Backend::Common::Node>& meshNodes = mesh.GetAllNodes();
+
+        std::vector<Graph::Node> nodes;
+        nodes.reserve(meshNodes.size());
+        for (size_t i = 0; i < meshNodes.size(); i++) {
+            nodes.emplace_back(static_cast<int>(i), Graph::NodeType::Waypoint,
+                               meshNodes[i].coords.x / pixelsPerUnit,
+                               meshNodes[i].coords.y / pixelsPerUnit);
+        }
+
+        std::vector<int> offsets(meshNodes.size() + 1, 0);
+        std::vector<Graph::Edge> edges;
+        for (size_t i = 0; i < meshNodes.size(); i++) {
+            offsets[i] = static_cast<int>(edges.size());
+            for (const Backend::Common::Edge& meshEdge : mesh.GetNeighbors(static_cast<int>(i))) {
+                Graph::Edge edge;
+                edge.distance = meshEdge.cost / pixelsPerUnit;
+                edge.nodeDestinationId = meshEdge.targetNodeId;
+                edge.destinationIndex = meshEdge.targetNodeId;
+                edges.push_back(edge);
+            }
+        }
+        offsets[meshNodes.size()] = static_cast<int>(edges.size());
+
+        graph.loadFrozen(std::move(nodes), std::move(offsets), std::move(edges));
+    }
+
+} // namespace NavMeshConversion
+
+#endif // NAVMESH_CONVERSION_HH
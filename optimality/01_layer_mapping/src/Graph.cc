@@ -7,11 +7,12 @@
 #include <cmath>
 #include <iomanip>
 #include <set>
+#include <stdexcept>
 using namespace std;
 
 
 // Constructor
-Graph::Graph() : numVertices(0), nextNodeId(0) {
+Graph::Graph() : nextNodeId(0), frozen(false) {
     // Initialize empty graph
     cout << "Graph constructor called" << endl;
 }
@@ -44,6 +45,7 @@ void Graph::loadFromStream(istream& in) {
         addEdge(fromNode, toNode);
         addEdge(toNode, fromNode);
     }
+    freeze();
 }
 
 
@@ -68,8 +70,7 @@ void Graph::read_graph() {
         addEdge(fromNode, toNode);
         addEdge(toNode, fromNode);
     }
-
-
+    freeze();
 }
 
 
@@ -87,17 +88,26 @@ Graph::NodeType Graph::charToNodeType(char c) const {
     }
 }
 
-// Add a node with specific ID
+// Add a node with specific ID (replaces the node already holding that ID)
 int Graph::addNode(int nodeId, NodeType type, double x, double y) {
+    if (nodeId < 0) {
+        return -1;
+    }
+    if (nodeId >= static_cast<int>(indexById.size())) {
+        indexById.resize(nodeId + 1, -1);
+    }
+
     Node newNode(nodeId, type, x, y);
-    nodes[nodeId] = newNode;
-    
-    // Initialize empty set of edges for this node if it doesn't exist
-    if (adjacencyList.find(nodeId) == adjacencyList.end()) {
-        adjacencyList[nodeId] = set<Edge>();
+    int index = indexById[nodeId];
+    if (index >= 0) {
+        nodes[index] = newNode;
+    } else {
+        thaw();
+        indexById[nodeId] = static_cast<int>(nodes.size());
+        nodes.push_back(newNode);
+        adjacencyList.emplace_back();
     }
     
-    numVertices++;
     if (nodeId >= nextNodeId) {
         nextNodeId = nodeId + 1;
     }
@@ -108,56 +118,155 @@ int Graph::addNode(int nodeId, NodeType type, double x, double y) {
 // Add an edge between two nodes
 bool Graph::addEdge(int fromNodeId, int toNodeId, double distance, double speed) {
     // Check if both nodes exist
-    if (nodes.find(fromNodeId) == nodes.end() || nodes.find(toNodeId) == nodes.end()) {
+    int fromIndex = getNodeIndex(fromNodeId);
+    int toIndex = getNodeIndex(toNodeId);
+    if (fromIndex < 0 || toIndex < 0) {
         return false;
     }
     
     // Calculate distance if not provided
     if (distance == 0.0) {
-        const Node* fromNode = getNode(fromNodeId);
-        const Node* toNode = getNode(toNodeId);
-        if (fromNode && toNode) {
-            double dx = fromNode->coordinates.first - toNode->coordinates.first;
-            double dy = fromNode->coordinates.second - toNode->coordinates.second;
-            distance = sqrt(dx * dx + dy * dy);
-        }
+        const Node& fromNode = nodes[fromIndex];
+        const Node& toNode = nodes[toIndex];
+        double dx = fromNode.coordinates.first - toNode.coordinates.first;
+        double dy = fromNode.coordinates.second - toNode.coordinates.second;
+        distance = sqrt(dx * dx + dy * dy);
     }
     
     // Add edges to both nodes (undirected graph)
-    Edge newEdge1(speed, distance, toNodeId);
-    Edge newEdge2(speed, distance, fromNodeId);
-    
-    adjacencyList[fromNodeId].insert(newEdge1);
-    adjacencyList[toNodeId].insert(newEdge2);
+    thaw();
+    insertEdge(fromIndex, Edge(speed, distance, toNodeId, toIndex));
+    insertEdge(toIndex, Edge(speed, distance, fromNodeId, fromIndex));
     
     return true;
 }
 
+// Keep the first edge to a destination, in destination order
+bool Graph::insertEdge(int fromIndex, const Edge& edge) {
+    vector<Edge>& edges = adjacencyList[fromIndex];
+    auto it = lower_bound(edges.begin(), edges.end(), edge);
+    if (it != edges.end() && it->nodeDestinationId == edge.nodeDestinationId) {
+        return false;
+    }
+    edges.insert(it, edge);
+    return true;
+}
+
+// Pack the per-node lists into the CSR arrays
+void Graph::freeze() {
+    if (frozen) {
+        return;
+    }
+    csrOffsets.assign(nodes.size() + 1, 0);
+    size_t total = 0;
+    for (size_t i = 0; i < adjacencyList.size(); i++) {
+        total += adjacencyList[i].size();
+    }
+    csrEdges.clear();
+    csrEdges.reserve(total);
+    for (size_t i = 0; i < adjacencyList.size(); i++) {
+        csrOffsets[i] = static_cast<int>(csrEdges.size());
+        csrEdges.insert(csrEdges.end(), adjacencyList[i].begin(), adjacencyList[i].end());
+    }
+    csrOffsets[nodes.size()] = static_cast<int>(csrEdges.size());
+    vector<vector<Edge>>().swap(adjacencyList);
+    frozen = true;
+}
+
+// Unpack the CSR arrays into per-node lists
+void Graph::thaw() {
+    if (!frozen) {
+        return;
+    }
+    adjacencyList.assign(nodes.size(), vector<Edge>());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        adjacencyList[i].assign(csrEdges.begin() + csrOffsets[i], csrEdges.begin() + csrOffsets[i + 1]);
+    }
+    csrOffsets.clear();
+    csrEdges.clear();
+    frozen = false;
+}
+
+// Replace the graph with a frozen layout built elsewhere (e.g. from a NavMesh)
+void Graph::loadFrozen(vector<Node> newNodes, vector<int> offsets, vector<Edge> edges) {
+    if (offsets.size() != newNodes.size() + 1 || offsets.front() != 0 ||
+        offsets.back() != static_cast<int>(edges.size())) {
+        throw invalid_argument("Graph::loadFrozen: offsets do not match nodes and edges");
+    }
+    for (size_t i = 0; i + 1 < offsets.size(); i++) {
+        if (offsets[i] > offsets[i + 1]) {
+            throw invalid_argument("Graph::loadFrozen: offsets are not ascending");
+        }
+    }
+
+    vector<int> newIndexById;
+    int newNextNodeId = 0;
+    for (size_t i = 0; i < newNodes.size(); i++) {
+        int nodeId = newNodes[i].nodeId;
+        if (nodeId < 0) {
+            throw invalid_argument("Graph::loadFrozen: negative node ID");
+        }
+        if (nodeId >= static_cast<int>(newIndexById.size())) {
+            newIndexById.resize(nodeId + 1, -1);
+        }
+        if (newIndexById[nodeId] >= 0) {
+            throw invalid_argument("Graph::loadFrozen: duplicate node ID");
+        }
+        newIndexById[nodeId] = static_cast<int>(i);
+        newNextNodeId = max(newNextNodeId, nodeId + 1);
+    }
+    for (size_t i = 0; i + 1 < offsets.size(); i++) {
+        for (int e = offsets[i]; e < offsets[i + 1]; e++) {
+            Edge& edge = edges[e];
+            if (edge.destinationIndex < 0 || edge.destinationIndex >= static_cast<int>(newNodes.size())) {
+                throw invalid_argument("Graph::loadFrozen: edge to a missing node");
+            }
+            edge.nodeDestinationId = newNodes[edge.destinationIndex].nodeId;
+        }
+        sort(edges.begin() + offsets[i], edges.begin() + offsets[i + 1]);
+    }
+
+    nodes = move(newNodes);
+    indexById = move(newIndexById);
+    csrOffsets = move(offsets);
+    csrEdges = move(edges);
+    vector<vector<Edge>>().swap(adjacencyList);
+    nextNodeId = newNextNodeId;
+    frozen = true;
+}
+
 // Get node by ID
 const Graph::Node* Graph::getNode(int nodeId) const {
-    auto it = nodes.find(nodeId);
-    if (it != nodes.end()) {
-        return &(it->second);
+    int index = getNodeIndex(nodeId);
+    return index >= 0 ? &nodes[index] : nullptr;
+}
+
+// Dense index of a node ID
+int Graph::getNodeIndex(int nodeId) const {
+    if (nodeId < 0 || nodeId >= static_cast<int>(indexById.size())) {
+        return -1;
     }
-    return nullptr;
+    return indexById[nodeId];
 }
 
 // Get all edges from a node
-const vector<Graph::Edge>& Graph::getEdges(int nodeId) const {
-    static vector<Edge> result;
-    
-    auto it = adjacencyList.find(nodeId);
-    if (it != adjacencyList.end()) {
-        result.clear();
-        result.insert(result.end(), it->second.begin(), it->second.end());
+Graph::EdgeRange Graph::getEdges(int nodeId) const {
+    int index = getNodeIndex(nodeId);
+    return index >= 0 ? getEdgesByIndex(index) : EdgeRange();
+}
 
+Graph::EdgeRange Graph::getEdgesByIndex(int index) const {
+    if (frozen) {
+        const Edge* base = csrEdges.data();
+        return EdgeRange(base + csrOffsets[index], base + csrOffsets[index + 1]);
     }
-    return result;
+    const vector<Edge>& edges = adjacencyList[index];
+    return EdgeRange(edges.data(), edges.data() + edges.size());
 }
 
 // Get number of vertices
 int Graph::getNumVertices() const {
-    return numVertices;
+    return static_cast<int>(nodes.size());
 }
 
 // Load graph from file
@@ -174,7 +283,7 @@ bool Graph::generateSVG(const string& filename, int width, int height) const {
     double minX = 0, maxX = 0, minY = 0, maxY = 0;
     bool first = true;
     
-    for (const auto& [nodeId, node] : nodes) {
+    for (const auto& node : nodes) {
         if (first) {
             minX = maxX = node.coordinates.first;
             minY = maxY = node.coordinates.second;
@@ -252,45 +361,43 @@ bool Graph::generateSVG(const string& filename, int width, int height) const {
     file << "<g id=\"edges\">\n";
     set<pair<int, int>> drawnEdges; // Track drawn edges to avoid duplicates
     
-    for (const auto& [nodeId, node] : nodes) {
+    for (size_t index = 0; index < nodes.size(); index++) {
+        const Node& node = nodes[index];
+        int nodeId = node.nodeId;
         double x1 = transformX(node.coordinates.first);
         double y1 = transformY(node.coordinates.second);
         
-        auto edgeIt = adjacencyList.find(nodeId);
-        if (edgeIt != adjacencyList.end()) {
-            for (const auto& edge : edgeIt->second) {
-                int destId = edge.nodeDestinationId;
-                
-                // Only draw each edge once (for undirected graph)
-                auto edgePair = make_pair(min(nodeId, destId), max(nodeId, destId));
-                if (drawnEdges.count(edgePair)) continue;
-                drawnEdges.insert(edgePair);
-                
-                const Node* destNode = getNode(destId);
-                if (destNode) {
-                    double x2 = transformX(destNode->coordinates.first);
-                    double y2 = transformY(destNode->coordinates.second);
-                    
-                    file << "<line x1=\"" << x1 << "\" y1=\"" << y1 
-                         << "\" x2=\"" << x2 << "\" y2=\"" << y2 
-                         << "\" stroke=\"#94a3b8\" stroke-width=\"2\" opacity=\"0.6\"/>\n";
-                    
-                    // Add distance label in the middle of the edge
-                    double midX = (x1 + x2) / 2;
-                    double midY = (y1 + y2) / 2;
-                    file << "<text x=\"" << midX << "\" y=\"" << midY 
-                         << "\" font-family=\"Arial\" font-size=\"10\" fill=\"#64748b\" "
-                         << "text-anchor=\"middle\">" << fixed << setprecision(1) 
-                         << edge.distance << "</text>\n";
-                }
-            }
+        for (const auto& edge : getEdgesByIndex(static_cast<int>(index))) {
+            int destId = edge.nodeDestinationId;
+            
+            // Only draw each edge once (for undirected graph)
+            auto edgePair = make_pair(min(nodeId, destId), max(nodeId, destId));
+            if (drawnEdges.count(edgePair)) continue;
+            drawnEdges.insert(edgePair);
+            
+            const Node& destNode = nodes[edge.destinationIndex];
+            double x2 = transformX(destNode.coordinates.first);
+            double y2 = transformY(destNode.coordinates.second);
+            
+            file << "<line x1=\"" << x1 << "\" y1=\"" << y1 
+                 << "\" x2=\"" << x2 << "\" y2=\"" << y2 
+                 << "\" stroke=\"#94a3b8\" stroke-width=\"2\" opacity=\"0.6\"/>\n";
+            
+            // Add distance label in the middle of the edge
+            double midX = (x1 + x2) / 2;
+            double midY = (y1 + y2) / 2;
+            file << "<text x=\"" << midX << "\" y=\"" << midY 
+                 << "\" font-family=\"Arial\" font-size=\"10\" fill=\"#64748b\" "
+                 << "text-anchor=\"middle\">" << fixed << setprecision(1) 
+                 << edge.distance << "</text>\n";
         }
     }
     file << "</g>\n";
     
     // Draw nodes
     file << "<g id=\"nodes\">\n";
-    for (const auto& [nodeId, node] : nodes) {
+    for (const auto& node : nodes) {
+        int nodeId = node.nodeId;
         double x = transformX(node.coordinates.first);
         double y = transformY(node.coordinates.second);
         string color = getNodeColor(node.type);
@@ -1,6 +1,8 @@
 #ifndef ALGORITHM_HH
 #define ALGORITHM_HH
 
+#include <atomic>
+#include <iostream>
 #include <queue>
 #include "Graph.hh"
 #include "Robot.hh"
@@ -11,6 +13,7 @@ struct AlgorithmResult {
     std::vector<std::vector<Task>> assignment;
     double computationTimeMs = 0.0;
     bool isOptimal = false; // True only if the result is guaranteed to be the global optimum.
+    bool stoppedEarly = false; // Stopped at its time limit: the best result found until then.
     std::string algorithmName;
 };
 
@@ -57,6 +60,27 @@ public:
      * @return Algorithm description
      */
     virtual std::string getDescription() const = 0;
+
+    /**
+     * @brief Send what execute() reports to another stream (default: std::cout)
+     */
+    void setOutput(std::ostream& stream) { output = &stream; }
+
+    /**
+     * @brief Ask a running execute() to return early with its best result so far
+     *
+     * Safe to call from any thread; execute() checks it between steps.
+     */
+    void requestStop() { stopFlag.store(true); }
+
+protected:
+    std::ostream& out() const { return *output; }
+    bool stopRequested() const { return stopFlag.load(std::memory_order_relaxed); }
+
+    std::atomic<bool> stopFlag{false};
+
+private:
+    std::ostream* output = &std::cout;
 };
 
 #endif // ALGORITHM_HH
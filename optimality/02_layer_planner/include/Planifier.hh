@@ -37,6 +37,7 @@ public:
     int getChargingRobots() const;
     const Graph& getGraph() const;
     std::queue<Task> getPendingTasks() const;
+    std::queue<Robot> getAvailableRobotQueue() const; // In the order executePlan() assigns them
 
     // Setters
     void setNumRobots(int numRobots);
@@ -45,11 +46,20 @@ public:
     void setChargingRobots(int num);
     void setPendingTasks(int num);
 
+    // Task and robot updates for callers that advance time (the simulator)
+    void addTask(const Task& task);
+    // Busy robot -> available, at the given position and battery; false if it is not busy
+    bool releaseRobot(int robotId, const std::pair<double, double>& position, double batteryLevel);
+
     // Strategy Pattern: Set the planning algorithm
     void setAlgorithm(std::unique_ptr<Algorithm> algorithm);
 
+    // Time limit per algorithm in the comparison modes (0 = none); an algorithm
+    // past it is asked to stop and its best result so far is reported
+    void setAlgorithmTimeout(double seconds);
+
     // Planning methods
-    void plan(int algorithmChoice = 0);  // 0 = interactive, 1-4 = direct selection
+    void plan(int algorithmChoice = 0);  // 0 / -1 = comparison (all / heuristics), 1-3 = direct selection
     AlgorithmResult executePlan();       // Execute the currently set algorithm and return result
 
 
@@ -60,9 +70,16 @@ private:
     std::queue<Robot> chargingRobots;
     const int totalRobots;
     std::queue<Task> pendingTasks;
+    double algorithmTimeoutSeconds;
     
     // Strategy Pattern: Current planning algorithm
     std::unique_ptr<Algorithm> currentAlgorithm;
+
+    // Every robot idle at the start position, fully charged
+    std::queue<Robot> initialRobots() const;
+
+    // Comparison modes: run algorithms firstAlgorithm..3 concurrently
+    ComparisonReport compare(int firstAlgorithm);
 };
 
 #endif // PLANIFIER_H
\ No newline at end of file
@@ -2,18 +2,28 @@
 #define BRUTEFORCE_HH
 
 #include "Algorithm.hh"
+#include "utils/TSPSolver.hh"
 #include <string>
 #include <vector>
 #include <utility>
 
 /**
- * @brief Brute Force planning algorithm implementation
+ * @brief Exact planning algorithm: branch-and-bound over task assignments
  * 
- * This algorithm explores all possible task assignments to find
- * the optimal solution (placeholder for actual implementation).
+ * Finds the assignment of tasks to robots, and the order of each robot's
+ * tasks, with the lowest makespan. Instead of enumerating every assignment
+ * it branches on one task at a time and prunes with makespan lower bounds
+ * (Held-Karp times of each robot's tasks without battery limits, see
+ * TSPSolver::SequenceTable) against an incumbent seeded by Greedy. Idle
+ * robots in the same state are interchangeable, so a task only opens the
+ * first of them. The top of the tree is split into subtrees that worker
+ * threads search in parallel, sharing the incumbent.
  */
 class BruteForce : public Algorithm {
 public:
+    // Larger problems are refused (the sequence tables grow as 2^tasks).
+    static constexpr int MAX_EXACT_TASKS = TSPSolver::MAX_TABLE_TASKS;
+
     BruteForce() = default;
     ~BruteForce() override = default;
 
@@ -29,24 +39,6 @@ public:
 
     std::string getName() const override;
     std::string getDescription() const override;
-
-    // Calculates the makespan for a given assignment of tasks to robots.
-    double calculateMakespan(
-        const std::vector<std::vector<Task>>& assignment,
-         std::vector<Robot>& robots,
-        const Graph& graph
-    );
-
-    // Recursive function to find the best assignment using backtracking.
-    void findBestAssignment(
-        int taskIndex,
-        const std::vector<Task>& tasks,
-         std::vector<Robot>& robots,
-        const Graph& graph,
-        std::vector<std::vector<Task>>& currentAssignment,
-        std::vector<std::vector<Task>>& bestAssignment,
-        double& minMakespan
-    );
 };
 
 #endif // BRUTEFORCE_HH
@@ -3,6 +3,7 @@
 
 #include "Algorithm.hh"
 #include "utils/SchedulerUtils.hh"
+#include "utils/DistanceOracle.hh"
 #include <string>
 #include <vector>
 #include <utility>
@@ -44,28 +45,37 @@ public:
     std::vector<std::vector<Task>> generateGreedySolution(
         std::vector<Robot>& simulatedRobots,
         const std::vector<Task>& tasks,
-        const Graph& graph,
-        const SchedulerUtils::BatteryConfig& config,
-        int chargingNodeId
+        const DistanceOracle& oracle,
+        const SchedulerUtils::BatteryConfig& config
     );
 
 private:
+    // Completion time of one robot's task sequence (0 if it has none)
+    double calculateRobotTime(
+        const std::vector<Task>& sequence,
+        const Robot& robot,
+        int startLocation,
+        const DistanceOracle& oracle,
+        const SchedulerUtils::BatteryConfig& config
+    );
+
     // Calculate makespan for a given assignment
     double calculateMakespan(
         const std::vector<std::vector<Task>>& assignment,
         const std::vector<Robot>& robots,
-        const Graph& graph,
-        const SchedulerUtils::BatteryConfig& config,
-        int chargingNodeId
+        const std::vector<int>& startLocations,
+        const DistanceOracle& oracle,
+        const SchedulerUtils::BatteryConfig& config
     );
 
-    // Try to improve solution by swapping tasks
+    // Try to improve solution by swapping tasks; a move re-times only the
+    // robots it touches
     bool tryImprovement(
         std::vector<std::vector<Task>>& assignment,
         const std::vector<Robot>& robots,
-        const Graph& graph,
+        const std::vector<int>& startLocations,
+        const DistanceOracle& oracle,
         const SchedulerUtils::BatteryConfig& config,
-        int chargingNodeId,
         double& currentMakespan
     );
 };
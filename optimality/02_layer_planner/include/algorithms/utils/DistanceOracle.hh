@@ -0,0 +1,53 @@
+#ifndef DISTANCE_ORACLE_HH
+#define DISTANCE_ORACLE_HH
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "Graph.hh"
+#include "Robot.hh"
+#include "Task.hh"
+
+// Distances between every place a schedule can take a robot, computed once
+// per instance. Locations (dense indices) are the graph's charging, pickup
+// and dropoff nodes, any other node a task names, and the robots' starting
+// positions. The planners' inner loops read the matrix instead of looking
+// nodes up and taking a square root per step.
+//
+// Distances are SchedulerUtils::calculateDistance (straight line), so every
+// schedule costs exactly what it did computed from coordinates.
+class DistanceOracle {
+public:
+    DistanceOracle(const Graph& graph, const std::vector<Task>& tasks, const std::vector<Robot>& robots);
+
+    int size() const { return numLocations; }
+
+    // Location of a node, -1 if the graph has no such node
+    int nodeLocation(int nodeId) const {
+        return nodeId >= 0 && nodeId < static_cast<int>(locationByNode.size()) ? locationByNode[nodeId] : -1;
+    }
+
+    // Location at exactly these coordinates, -1 if none (e.g. a robot's position)
+    int positionLocation(const std::pair<double, double>& position) const;
+
+    double distance(int from, int to) const { return matrix[static_cast<size_t>(from) * numLocations + to]; }
+
+    const std::pair<double, double>& position(int location) const { return positions[location]; }
+
+    // The station robots charge at (SchedulerUtils::getChargingNodeId), -1 if the graph has none
+    int chargerLocation() const { return charger; }
+    double distanceToCharger(int from) const { return toCharger[from]; }
+
+private:
+    int numLocations;
+    int charger;
+    std::vector<int> locationByNode;                    // nodeId -> location (-1 = not covered)
+    std::vector<std::pair<double, double>> positions;   // By location
+    std::vector<double> matrix;                         // [from * size() + to]
+    std::vector<double> toCharger;
+
+    int addLocation(const std::pair<double, double>& position);
+    void addNode(const Graph& graph, int nodeId);
+};
+
+#endif // DISTANCE_ORACLE_HH
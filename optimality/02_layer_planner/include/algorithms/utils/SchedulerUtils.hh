@@ -4,6 +4,7 @@
 #include "Graph.hh"
 #include "Robot.hh"
 #include "Task.hh"
+#include "DistanceOracle.hh"
 
 // A utility class for common, stateless scheduling calculations.
 class SchedulerUtils {
@@ -55,6 +56,24 @@ public:
         const Graph& graph,
         const BatteryConfig& config
     );
+
+    // The same two over a DistanceOracle's locations (what the planners' inner loops use)
+    static TaskBatteryInfo calculateTaskBatteryConsumption(
+        const DistanceOracle& oracle,
+        int currentLocation,
+        int originLocation,
+        int destLocation,
+        double currentBattery,
+        const BatteryConfig& config
+    );
+
+    static void performCharging(
+        int& currentLocation,
+        double& currentBattery,
+        double& totalTime,
+        const DistanceOracle& oracle,
+        const BatteryConfig& config
+    );
 };
 
 #endif // SCHEDULER_UTILS_HH
@@ -1,19 +1,76 @@
 #ifndef TSP_SOLVER_HH
 #define TSP_SOLVER_HH
 
+#include <cstdint>
 #include <vector>
 #include "Graph.hh"
 #include "Robot.hh"
 #include "Task.hh"
+#include "SchedulerUtils.hh"
+#include "DistanceOracle.hh"
 
 class TSPSolver {
 public:
-    // Finds the minimum time for one robot by checking all task permutations.
+    // Largest task list a SequenceTable covers (its tables hold 2^n * n entries).
+    static constexpr int MAX_TABLE_TASKS = 16;
+
+    // Finds the minimum time for one robot over every ordering of its tasks.
     static double findOptimalSequenceTime(
         const Robot& robot,
         const std::vector<Task>& tasks,
-        const Graph& graph
+        const DistanceOracle& oracle
     );
+
+    /**
+     * @brief Optimal orderings of any subset of a fixed task list for one robot.
+     *
+     * Built once per robot (and task list), read by any number of threads.
+     * Held-Karp DP over (subset, last task) gives, for every subset, the
+     * best time ignoring the battery; charging only ever adds time (the
+     * detour through the station and the charge itself), so that is a lower
+     * bound on the real optimum. solve() simulates the DP's ordering with the
+     * battery rules and, when it never stops to charge, it is the optimum;
+     * otherwise it searches the orderings depth-first, pruned against that
+     * first simulation and the remaining tasks' loaded travel.
+     */
+    class SequenceTable {
+    public:
+        SequenceTable(const Robot& robot, const std::vector<Task>& tasks, const DistanceOracle& oracle);
+
+        int size() const { return numTasks; }
+
+        // Best time of the tasks in mask without battery limits.
+        double lowerBound(uint32_t mask) const { return bestByMask[mask]; }
+
+        // Optimal time of the tasks in mask with the battery rules (max() if
+        // no ordering is feasible); order receives their indices in sequence.
+        double solve(uint32_t mask, std::vector<int>* order = nullptr) const;
+
+    private:
+        const Robot& robot;
+        const DistanceOracle& oracle;
+        SchedulerUtils::BatteryConfig config;
+        int numTasks;
+        int startLocation;
+        uint32_t invalidMask;                   // Tasks naming a missing node
+
+        std::vector<int> originLocation;        // Oracle locations per task
+        std::vector<int> destLocation;
+
+        std::vector<double> loadedTime;         // Origin -> destination
+        std::vector<double> startTime;          // Robot position -> origin
+        std::vector<double> linkTime;           // [i * n + j]: destination of i -> origin of j
+        std::vector<double> dp;                 // [mask * n + last]: best time ending at last
+        std::vector<double> bestByMask;
+
+        // One task of a sequence, as the scheduler runs it; false if the battery cannot make it.
+        bool runTask(int task, int& location, double& battery, double& time, bool& charged) const;
+        double simulate(const std::vector<int>& order, bool& charged) const;
+        void search(uint32_t remaining, int location, double battery, double time,
+                    std::vector<int>& current, double& best, std::vector<int>& bestOrder,
+                    double target) const;
+        std::vector<int> heldKarpOrder(uint32_t mask) const;
+    };
 };
 
 #endif // TSP_SOLVER_HH
@@ -15,14 +15,14 @@ bool fileExists(const string& filename) {
 }
 
 void usage(const char* progname) {
-    cerr << "Usage: " << progname << " [algorithmID] [graphID] [numTasks] [numRobots]" << endl;
+    cerr << "Usage: " << progname << " [algorithmID] [graphID] [numTasks] [numRobots] [timeLimit]" << endl;
     cerr << "       " << progname << " -h | --help" << endl;
     cerr << endl;
     cerr << "Arguments:" << endl;
     cerr << "  algorithmID   : Algorithm selection (default: 1)" << endl;
     cerr << "                 -1 = Heuristics Only (runs Greedy and Hill Climbing)" << endl;
     cerr << "                  0 = Comparison Mode (runs all 3 algorithms)" << endl;
-    cerr << "                  1 = Brute Force (optimal, exhaustive search)" << endl;
+    cerr << "                  1 = Brute Force (optimal, branch-and-bound)" << endl;
     cerr << "                  2 = Greedy (fast heuristic)" << endl;
     cerr << "                  3 = Hill Climbing (improved greedy via local search)" << endl;
     cerr << "  graphID       : Graph number from 1-10 (default: 1)" << endl;
@@ -31,6 +31,8 @@ void usage(const char* progname) {
     cerr << "                  Loads from tests/graphN/M_tasks.inp (M = numTasks)" << endl;
     cerr << "                  If file doesn't exist, generates it automatically with seed=16" << endl;
     cerr << "  numRobots     : Number of robots (default: 2, range: 1-10)" << endl;
+    cerr << "  timeLimit     : Seconds each algorithm may run in comparison modes (default: 60, 0 = none)" << endl;
+    cerr << "                  The algorithms run concurrently; one past the limit reports its best so far" << endl;
     cerr << endl;
     cerr << "Options:" << endl;
     cerr << "  -h, --help    : Show this help message" << endl;
@@ -45,6 +47,7 @@ void usage(const char* progname) {
     cerr << "  " << progname << " 0 1 12        # Compare all algorithms, graph1, 12 tasks, 2 robots" << endl;
     cerr << "  " << progname << " 3 1 20        # Use algorithm 3, graph1, 20 tasks, 2 robots" << endl;
     cerr << "  " << progname << " 2 4 30 3      # Use algorithm 2, graph4, 30 tasks, 3 robots" << endl;
+    cerr << "  " << progname << " 0 1 16 4 10   # Compare all algorithms, at most 10 s each" << endl;
     exit(1);
 }
 
@@ -82,8 +85,9 @@ int main(int argc, char* argv[]) {
     int graphID = 1;      // Default: graph1
     int numTasks = 15;    // Default: 15 tasks
     int numRobots = 2;    // Default: 2 robots
+    double timeLimit = 60.0;  // Default: 60 s per algorithm when comparing
     
-    if (argc > 5) {
+    if (argc > 6) {
         cerr << "Error: Too many arguments" << endl;
         usage(argv[0]);
     }
@@ -119,7 +123,7 @@ int main(int argc, char* argv[]) {
     }
     
     // Parse numRobots
-    if (argc == 5) {
+    if (argc >= 5) {
         numRobots = atoi(argv[4]);
         if (numRobots < 1 || numRobots > 10) {
             cerr << "Error: numRobots must be between 1 and 10" << endl;
@@ -127,6 +131,15 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // Parse timeLimit
+    if (argc == 6) {
+        timeLimit = atof(argv[5]);
+        if (timeLimit < 0) {
+            cerr << "Error: timeLimit must be 0 or more seconds" << endl;
+            usage(argv[0]);
+        }
+    }
+    
     // Construct file paths
     string graphFile = "../01_layer_mapping/tests/distributions/graph" + 
                        to_string(graphID) + ".inp";
@@ -206,6 +219,7 @@ int main(int argc, char* argv[]) {
     cout << endl;
     
     // Run planning algorithm
+    P.setAlgorithmTimeout(timeLimit);
     P.plan(algorithm);
 
     return 0;
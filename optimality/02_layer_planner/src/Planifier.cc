@@ -4,17 +4,22 @@
 #include "algorithms/03_HillClimbing.hh"
 #include <memory>
 #include <iomanip>
+#include <chrono>
+#include <future>
+#include <sstream>
 using namespace std;
 
+namespace {
+    // How often the comparison modes look for finished (or overdue) algorithms
+    const chrono::milliseconds COMPARISON_POLL_INTERVAL(10);
+}
+
 
 // Constructors and Destructor
 Planifier::Planifier(const Graph& graph, int numRobots, queue<Task> tasks) 
-    : G(graph), totalRobots(numRobots), pendingTasks(tasks), currentAlgorithm(nullptr) {
-    // Initialize robots with proper IDs
-    for (int i = 0; i < totalRobots; i++) {
-        Robot robot(i, {0.0, 0.0}, 100.0, -1, 1.6, 100);
-        availableRobots.push(robot);
-    }
+    : G(graph), totalRobots(numRobots), pendingTasks(tasks), algorithmTimeoutSeconds(0.0),
+      currentAlgorithm(nullptr) {
+    availableRobots = initialRobots();
 }
 
 Planifier::~Planifier() {}
@@ -26,6 +31,7 @@ int Planifier::getBusyRobots() const { return busyRobots.size(); }
 int Planifier::getChargingRobots() const { return chargingRobots.size(); }
 const Graph& Planifier::getGraph() const { return G; }
 queue<Task> Planifier::getPendingTasks() const { return pendingTasks; }
+queue<Robot> Planifier::getAvailableRobotQueue() const { return availableRobots; }
 
 // Setters
 void Planifier::setNumRobots(int numRobots) { const_cast<int&>(this->totalRobots) = numRobots; }
@@ -42,6 +48,40 @@ void Planifier::setPendingTasks(int num) { //igual que el de dalt pero amb tasks
     while (pendingTasks.size() > static_cast<size_t>(num)) pendingTasks.pop();
 }
 
+void Planifier::addTask(const Task& task) { pendingTasks.push(task); }
+
+bool Planifier::releaseRobot(int robotId, const pair<double, double>& position, double batteryLevel) {
+    bool released = false;
+    queue<Robot> stillBusy;
+    while (!busyRobots.empty()) {
+        Robot robot = busyRobots.front();
+        busyRobots.pop();
+        if (!released && robot.getId() == robotId) {
+            robot.setPosition(position);
+            robot.setBatteryLevel(batteryLevel);
+            robot.freeRobot();
+            availableRobots.push(robot);
+            released = true;
+        } else {
+            stillBusy.push(robot);
+        }
+    }
+    busyRobots.swap(stillBusy);
+    return released;
+}
+
+void Planifier::setAlgorithmTimeout(double seconds) { algorithmTimeoutSeconds = seconds > 0.0 ? seconds : 0.0; }
+
+// Initialize robots with proper IDs
+queue<Robot> Planifier::initialRobots() const {
+    queue<Robot> robots;
+    for (int i = 0; i < totalRobots; i++) {
+        Robot robot(i, {0.0, 0.0}, 100.0, -1, 1.6, 100);
+        robots.push(robot);
+    }
+    return robots;
+}
+
 // Strategy Pattern: Set the planning algorithm
 void Planifier::setAlgorithm(unique_ptr<Algorithm> algorithm) {
     currentAlgorithm = std::move(algorithm);
@@ -95,71 +135,7 @@ void Planifier::plan(int algorithmChoice) {
         cout << "========================================" << endl;
         cout << endl;
         
-        // Save original tasks
-        vector<Task> taskList;
-        queue<Task> tempTasks = pendingTasks;
-        while (!tempTasks.empty()) {
-            taskList.push_back(tempTasks.front());
-            tempTasks.pop();
-        }
-        
-        ComparisonReport report;
-        
-        // Determine which algorithms to run
-        int startAlg = includeOptimal ? 1 : 2;  // Start from 1 (BruteForce) or 2 (Greedy)
-        int endAlg = 3;  // Always end with 3 (HillClimbing)
-        
-        // Run each algorithm
-        for (int alg = startAlg; alg <= endAlg; alg++) {
-            // Recreate task queue
-            pendingTasks = queue<Task>();
-            for (const Task& t : taskList) {
-                pendingTasks.push(t);
-            }
-            
-            // Recreate robot queues
-            availableRobots = queue<Robot>();
-            busyRobots = queue<Robot>();
-            chargingRobots = queue<Robot>();
-            for (int i = 0; i < totalRobots; i++) {
-                Robot robot(i, {0.0, 0.0}, 100.0, -1, 1.6, 100);
-                availableRobots.push(robot);
-            }
-            
-            // Print algorithm header
-            if (alg == 1) {
-                cout << "--- BRUTE FORCE (Optimal) ---" << endl;
-                setAlgorithm(make_unique<BruteForce>());
-            } else if (alg == 2) {
-                cout << "--- GREEDY (Fast Heuristic) ---" << endl;
-                setAlgorithm(make_unique<Greedy>());
-            } else if (alg == 3) {
-                cout << "--- HILL CLIMBING (Improved Greedy) ---" << endl;
-                setAlgorithm(make_unique<HillClimbing>());
-            }
-            
-            // Execute algorithm and collect result
-            AlgorithmResult result = currentAlgorithm->execute(
-                G,
-                availableRobots,
-                busyRobots,
-                chargingRobots,
-                pendingTasks,
-                totalRobots,
-                true  // compactMode = true for comparison
-            );
-            
-            // Store result in comparison report
-            if (alg == 1) {
-                report.bruteForceResult = result;
-            } else if (alg == 2) {
-                report.greedyResult = result;
-            } else if (alg == 3) {
-                report.hillClimbingResult = result;
-            }
-            
-            cout << endl;
-        }
+        ComparisonReport report = compare(includeOptimal ? 1 : 2);
         
         // Print comparison summary
         cout << "========================================" << endl;
@@ -169,17 +145,21 @@ void Planifier::plan(int algorithmChoice) {
         if (report.bruteForceResult.has_value()) {
             cout << "Brute Force:   Makespan = " << fixed << setprecision(2) 
                  << report.bruteForceResult->makespan << "s, Time = " 
-                 << report.bruteForceResult->computationTimeMs << "ms (Optimal)" << endl;
+                 << report.bruteForceResult->computationTimeMs << "ms"
+                 << (report.bruteForceResult->isOptimal ? " (Optimal)" : "")
+                 << (report.bruteForceResult->stoppedEarly ? " (time limit)" : "") << endl;
         }
         if (report.greedyResult.has_value()) {
             cout << "Greedy:        Makespan = " << fixed << setprecision(2) 
                  << report.greedyResult->makespan << "s, Time = " 
-                 << report.greedyResult->computationTimeMs << "ms" << endl;
+                 << report.greedyResult->computationTimeMs << "ms"
+                 << (report.greedyResult->stoppedEarly ? " (time limit)" : "") << endl;
         }
         if (report.hillClimbingResult.has_value()) {
             cout << "Hill Climbing: Makespan = " << fixed << setprecision(2) 
                  << report.hillClimbingResult->makespan << "s, Time = " 
-                 << report.hillClimbingResult->computationTimeMs << "ms" << endl;
+                 << report.hillClimbingResult->computationTimeMs << "ms"
+                 << (report.hillClimbingResult->stoppedEarly ? " (time limit)" : "") << endl;
         }
         
         cout << "========================================" << endl;
@@ -204,4 +184,87 @@ void Planifier::plan(int algorithmChoice) {
     
     // Execute the selected algorithm
     executePlan();
-}
\ No newline at end of file
+}
+
+// Each algorithm runs on its own thread with its own copy of the robots and
+// tasks, reporting into a buffer that is printed when it finishes, so the
+// comparison takes as long as the slowest algorithm (or its time limit).
+Planifier::ComparisonReport Planifier::compare(int firstAlgorithm) {
+    struct Run {
+        int algorithmId = 0;
+        string header;
+        unique_ptr<Algorithm> algorithm;
+        ostringstream output;
+        future<AlgorithmResult> result;
+        bool stopRequested = false;
+        bool finished = false;
+    };
+
+    vector<unique_ptr<Run>> runs;
+    for (int alg = firstAlgorithm; alg <= 3; alg++) {
+        auto run = make_unique<Run>();
+        run->algorithmId = alg;
+        if (alg == 1) {
+            run->header = "--- BRUTE FORCE (Optimal) ---";
+            run->algorithm = make_unique<BruteForce>();
+        } else if (alg == 2) {
+            run->header = "--- GREEDY (Fast Heuristic) ---";
+            run->algorithm = make_unique<Greedy>();
+        } else {
+            run->header = "--- HILL CLIMBING (Improved Greedy) ---";
+            run->algorithm = make_unique<HillClimbing>();
+        }
+        run->algorithm->setOutput(run->output);
+        runs.push_back(std::move(run));
+    }
+
+    auto startTime = chrono::steady_clock::now();
+    for (auto& run : runs) {
+        Run* r = run.get();
+        r->result = async(launch::async, [this, r, tasks = pendingTasks]() mutable {
+            queue<Robot> available = initialRobots();
+            queue<Robot> busy;
+            queue<Robot> charging;
+            return r->algorithm->execute(G, available, busy, charging, tasks, totalRobots,
+                                         true);  // compactMode = true for comparison
+        });
+    }
+
+    ComparisonReport report;
+    size_t remaining = runs.size();
+    while (remaining > 0) {
+        for (auto& run : runs) {
+            if (run->finished) continue;
+            if (run->result.wait_for(COMPARISON_POLL_INTERVAL) != future_status::ready) {
+                chrono::duration<double> elapsed = chrono::steady_clock::now() - startTime;
+                if (algorithmTimeoutSeconds > 0.0 && !run->stopRequested && elapsed.count() >= algorithmTimeoutSeconds) {
+                    run->algorithm->requestStop();
+                    run->stopRequested = true;
+                }
+                continue;
+            }
+
+            AlgorithmResult result = run->result.get();
+            result.stoppedEarly = run->stopRequested;
+            run->finished = true;
+            remaining--;
+
+            // Store result in comparison report
+            if (run->algorithmId == 1) {
+                report.bruteForceResult = result;
+            } else if (run->algorithmId == 2) {
+                report.greedyResult = result;
+            } else {
+                report.hillClimbingResult = result;
+            }
+
+            cout << run->header << endl;
+            cout << run->output.str();
+            if (result.stoppedEarly) {
+                cout << "(stopped at the " << algorithmTimeoutSeconds << " s time limit)" << endl;
+            }
+            cout << endl;
+        }
+    }
+    return report;
+}
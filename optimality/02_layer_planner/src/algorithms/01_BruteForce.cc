@@ -1,6 +1,8 @@
 #include "../../include/algorithms/01_BruteForce.hh"
+#include "../../include/algorithms/02_Greedy.hh"
 #include "../../include/algorithms/utils/SchedulerUtils.hh"
 #include "../../include/algorithms/utils/TSPSolver.hh"
+#include "../../include/algorithms/utils/DistanceOracle.hh"
 #include "../../include/algorithms/utils/AssignmentPrinter.hh"
 #include <iostream>
 #include <iomanip>
@@ -9,6 +11,11 @@
 #include <limits>
 #include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 using namespace std;
 
 string BruteForce::getName() const {
@@ -16,91 +23,239 @@ string BruteForce::getName() const {
 }
 
 string BruteForce::getDescription() const {
-    return "Truly optimal brute force: Finds optimal partition AND optimal task ordering (solves TSP per robot)";
+    return "Exact branch-and-bound: Finds optimal partition AND optimal task ordering (Held-Karp per robot)";
 }
 
 
-bool complexity_warnings(const vector<Task>& tasksVec, const vector<Robot>& robotsVec, bool compactMode) {
-    // Calculate complexity and check feasibility
-    // For truly optimal brute force: 
-    // - Partition complexity: numRobots^numTasks
-    // - TSP complexity per robot: factorial of tasks per robot
-    // - Total: R^T * (T/R)! per robot ≈ R^T * ((T/R)!)^R
-    // 
-    // Practical limits:
-    // - 8 tasks, 2 robots: 2^8 * 4! * 4! = 256 * 24 * 24 ≈ 147k operations (fast)
-    // - 10 tasks, 2 robots: 2^10 * 5! * 5! = 1024 * 120 * 120 ≈ 15M operations (slow but feasible)
-    // - 12 tasks, 2 robots: 2^12 * 6! * 6! = 4096 * 720 * 720 ≈ 2.1B operations (VERY SLOW)
-    
-    double logPartitionComplexity = tasksVec.size() * log(robotsVec.size());
-    double estimatedPartitions = exp(logPartitionComplexity);
-    
-    // Estimate average tasks per robot and factorial complexity
-    int tasksPerRobot = (tasksVec.size() + robotsVec.size() - 1) / robotsVec.size(); // Ceiling division
-    double factorialComplexity = 1.0;
-    for (int i = 2; i <= tasksPerRobot; ++i) {
-        factorialComplexity *= i;
-    }
-    // Approximate total for all robots (simplified)
-    double tspComplexity = pow(factorialComplexity, robotsVec.size());
-    double estimatedComplexity = estimatedPartitions * tspComplexity;
-    
-    const double MAX_COMPLEXITY = 5e7; // 50 million operations (allows up to 10 tasks with 2 robots)
-    
-    if (estimatedComplexity > MAX_COMPLEXITY) {
-        cout << "\n❌ ERROR: Truly optimal brute force complexity too high for this problem!" << endl;
-        cout << "   Problem size: " << robotsVec.size() << " robots, " << tasksVec.size() << " tasks" << endl;
-        cout << "   Partition complexity: " << robotsVec.size() << "^" << tasksVec.size() 
-             << " ≈ " << (long long)(estimatedPartitions) << " partitions" << endl;
-        cout << "   TSP complexity per partition: ~" << tasksPerRobot << "! per robot" << endl;
-        cout << "   Total estimated operations: ";
-        cout << "   Total estimated operations: ";
-        if (estimatedComplexity > 1e15) {
-            cout << " (astronomical - would take days/weeks)" << endl;
-        } else if (estimatedComplexity > 1e12) {
-            cout << (long long)(estimatedComplexity / 1e12) << " trillion" << endl;
-        } else if (estimatedComplexity > 1e9) {
-            cout << (long long)(estimatedComplexity / 1e9) << " billion" << endl;
-        } else {
-            cout << (long long)(estimatedComplexity / 1e6) << " million" << endl;
+namespace {
+    const double INF = numeric_limits<double>::max();
+
+    // Subtrees handed out to the worker threads (per thread)
+    const size_t SUBTREES_PER_THREAD = 16;
+
+    struct SearchNode {
+        int taskIndex;              // Next task to place
+        vector<uint32_t> masks;     // Tasks placed so far, per robot
+        double bound;
+    };
+
+    /**
+     * @brief Branch-and-bound over the robot each task goes to.
+     *
+     * Tasks are placed longest first, so bounds rise early. A node's bound
+     * is the larger of the Held-Karp time of every robot's tasks and, for
+     * every task still to place, the cheapest robot to add it to; a leaf
+     * costs the battery-aware optimum of each robot's tasks. Both come from
+     * one SequenceTable per group of robots in the same state, so they are
+     * shared by all threads; the exact costs are cached per thread.
+     */
+    class BranchAndBound {
+    public:
+        BranchAndBound(const vector<Robot>& robots, const vector<Task>& tasks, const DistanceOracle& oracle,
+                       const atomic<bool>& stop)
+            : robots(robots), tasks(tasks), numTasks(static_cast<int>(tasks.size())), stop(stop),
+              incumbent(INF), bestMasks(robots.size(), 0) {
+            // Robots with the same starting position and battery are interchangeable
+            classOf.resize(robots.size());
+            tables.resize(robots.size());
+            for (size_t r = 0; r < robots.size(); ++r) {
+                classOf[r] = static_cast<int>(r);
+                for (size_t q = 0; q < r; ++q) {
+                    if (robots[q].getPosition() == robots[r].getPosition() &&
+                        robots[q].getBatteryLevel() == robots[r].getBatteryLevel()) {
+                        classOf[r] = classOf[q];
+                        break;
+                    }
+                }
+                if (classOf[r] == static_cast<int>(r)) {
+                    tables[r] = make_unique<TSPSolver::SequenceTable>(robots[r], tasks, oracle);
+                }
+            }
         }
-        cout << "   Maximum feasible: ~" << (long long)(MAX_COMPLEXITY / 1e6) << " million operations" << endl;
-        cout << "\n   Please use a faster algorithm:" << endl;
-        cout << "     - Algorithm 2: Greedy (fast heuristic)" << endl;
-        cout << "     - Algorithm 3: Hill Climbing (improved greedy)" << endl;
-        cout << "\n   Aborting truly optimal brute force execution." << endl;
-        
-        return true; // Abort execution
-    }
-    
-    // Warning for moderately large problem instances
-    if (estimatedComplexity > 1e6 && estimatedComplexity <= MAX_COMPLEXITY) {
-        cout << "\n⚠️  WARNING: This will take significant time..." << endl;
-        cout << "    Partition complexity: " << robotsVec.size() << "^" << tasksVec.size() 
-             << " ≈ " << (long long)(estimatedPartitions) << " partitions" << endl;
-        cout << "    TSP per partition: ~" << tasksPerRobot << "! ≈ " 
-             << (long long)factorialComplexity << " permutations per robot" << endl;
-        cout << "    Total operations: ~" << (long long)(estimatedComplexity / 1e6) << " million" << endl;
-        cout << "    Continuing... (press Ctrl+C to abort)\n" << endl;
-    }
-    
-    return false; // Continue execution
+
+        // Start from a known assignment (masks per robot); ignored if infeasible
+        void seed(const vector<uint32_t>& masks) {
+            unordered_map<uint64_t, double> memo;
+            double makespan = 0.0;
+            for (size_t r = 0; r < robots.size(); ++r) {
+                makespan = max(makespan, cost(r, masks[r], memo));
+            }
+            if (makespan < incumbent.load()) {
+                incumbent.store(makespan);
+                bestMasks = masks;
+            }
+        }
+
+        void run(unsigned threads) {
+            // Split the top of the tree until every thread has enough subtrees
+            vector<SearchNode> frontier;
+            frontier.push_back({0, vector<uint32_t>(robots.size(), 0), 0.0});
+            while (frontier.size() < threads * SUBTREES_PER_THREAD && frontier[0].taskIndex < numTasks &&
+                   !stopped()) {
+                vector<SearchNode> next;
+                for (SearchNode& node : frontier) {
+                    nodes++;
+                    for (size_t r : children(node.taskIndex, node.masks)) {
+                        SearchNode child{node.taskIndex + 1, node.masks, 0.0};
+                        child.masks[r] |= 1u << node.taskIndex;
+                        child.bound = bound(child.taskIndex, child.masks);
+                        if (child.bound < incumbent.load()) next.push_back(move(child));
+                    }
+                }
+                frontier.swap(next);
+                if (frontier.empty()) return;
+            }
+            // Most promising first, so the incumbent drops early for everyone
+            sort(frontier.begin(), frontier.end(),
+                 [](const SearchNode& a, const SearchNode& b) { return a.bound < b.bound; });
+            subtrees = frontier.size();
+
+            atomic<size_t> nextSubtree(0);
+            auto worker = [&]() {
+                unordered_map<uint64_t, double> memo;
+                vector<uint32_t> masks;
+                for (size_t i = nextSubtree++; i < frontier.size() && !stopped(); i = nextSubtree++) {
+                    masks = frontier[i].masks;
+                    search(frontier[i].taskIndex, masks, memo);
+                }
+            };
+            threads = max(1u, min<unsigned>(threads, static_cast<unsigned>(frontier.size())));
+            vector<thread> pool;
+            for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+            worker();
+            for (thread& t : pool) t.join();
+        }
+
+        double makespan() const { return incumbent.load(); }
+
+        // Each robot's tasks in their optimal order
+        vector<vector<Task>> assignment() const {
+            vector<vector<Task>> result(robots.size());
+            vector<int> order;
+            for (size_t r = 0; r < robots.size(); ++r) {
+                table(r).solve(bestMasks[r], &order);
+                for (int task : order) result[r].push_back(tasks[task]);
+            }
+            return result;
+        }
+
+        // Whether the search was cut short (the incumbent may not be optimal)
+        bool stopped() const { return stop.load(memory_order_relaxed); }
+
+        uint64_t nodesExplored() const { return nodes.load(); }
+        uint64_t leavesEvaluated() const { return leaves.load(); }
+        size_t subtreeCount() const { return subtrees; }
+
+    private:
+        const vector<Robot>& robots;
+        const vector<Task>& tasks;
+        int numTasks;
+        const atomic<bool>& stop;
+        vector<int> classOf;
+        vector<unique_ptr<TSPSolver::SequenceTable>> tables;   // At each class's first robot
+
+        atomic<double> incumbent;
+        mutex bestMutex;
+        vector<uint32_t> bestMasks;
+        atomic<uint64_t> nodes{0};
+        atomic<uint64_t> leaves{0};
+        size_t subtrees = 0;
+
+        const TSPSolver::SequenceTable& table(size_t r) const { return *tables[classOf[r]]; }
+
+        double cost(size_t r, uint32_t mask, unordered_map<uint64_t, double>& memo) const {
+            if (mask == 0) return 0.0;
+            uint64_t key = (uint64_t(classOf[r]) << 32) | mask;
+            auto it = memo.find(key);
+            if (it != memo.end()) return it->second;
+            double value = table(r).solve(mask);
+            memo.emplace(key, value);
+            return value;
+        }
+
+        double bound(int taskIndex, const vector<uint32_t>& masks) const {
+            double result = 0.0;
+            for (size_t r = 0; r < robots.size(); ++r) {
+                result = max(result, table(r).lowerBound(masks[r]));
+            }
+            // Every task left has to go somewhere
+            for (int j = taskIndex; j < numTasks; ++j) {
+                double cheapest = INF;
+                for (size_t r = 0; r < robots.size(); ++r) {
+                    cheapest = min(cheapest, table(r).lowerBound(masks[r] | (1u << j)));
+                }
+                result = max(result, cheapest);
+            }
+            return result;
+        }
+
+        // Robots worth giving the task: of interchangeable idle robots only the first
+        vector<size_t> children(int taskIndex, const vector<uint32_t>& masks) const {
+            vector<pair<double, size_t>> ranked;
+            for (size_t r = 0; r < robots.size(); ++r) {
+                if (masks[r] == 0) {
+                    bool earlierIdle = false;
+                    for (size_t q = 0; q < r && !earlierIdle; ++q) {
+                        earlierIdle = classOf[q] == classOf[r] && masks[q] == 0;
+                    }
+                    if (earlierIdle) continue;
+                }
+                ranked.push_back({table(r).lowerBound(masks[r] | (1u << taskIndex)), r});
+            }
+            sort(ranked.begin(), ranked.end());
+            vector<size_t> result;
+            for (const auto& entry : ranked) result.push_back(entry.second);
+            return result;
+        }
+
+        void search(int taskIndex, vector<uint32_t>& masks, unordered_map<uint64_t, double>& memo) {
+            nodes++;
+            if (stopped() || bound(taskIndex, masks) >= incumbent.load()) return;
+
+            if (taskIndex == numTasks) {
+                evaluate(masks, memo);
+                return;
+            }
+
+            for (size_t r : children(taskIndex, masks)) {
+                masks[r] |= 1u << taskIndex;
+                search(taskIndex + 1, masks, memo);
+                masks[r] &= ~(1u << taskIndex);
+            }
+        }
+
+        void evaluate(const vector<uint32_t>& masks, unordered_map<uint64_t, double>& memo) {
+            leaves++;
+            // Likely slowest robot first: it is the one that usually settles it
+            vector<pair<double, size_t>> order;
+            for (size_t r = 0; r < robots.size(); ++r) {
+                if (masks[r] != 0) order.push_back({table(r).lowerBound(masks[r]), r});
+            }
+            sort(order.rbegin(), order.rend());
+
+            double makespan = 0.0;
+            for (const auto& entry : order) {
+                makespan = max(makespan, cost(entry.second, masks[entry.second], memo));
+                if (makespan >= incumbent.load()) return;
+            }
+
+            lock_guard<mutex> lock(bestMutex);
+            if (makespan < incumbent.load()) {
+                incumbent.store(makespan);
+                bestMasks = masks;
+            }
+        }
+    };
 }
 
 // --- Main Method Implementation ---
 
 
 // Let N be the number of Robots and M the number of Tasks
-// The cost is O(N^M * (M/N)!)
-// 
-// This algorithm finds the optimal PARTITION and optimal SCHEDULE:
-// - For each partition (N^M combinations), it solves the TSP for each robot
-// - Each robot's task ordering is optimized by checking all permutations
-// - This ensures we find the truly optimal makespan
-// 
-// COMPLEXITY WARNING: With M tasks split among N robots, each robot gets ~M/N tasks.
-// For each partition, we must check (M/N)! permutations per robot.
-// Example: 12 tasks, 2 robots = 2^12 partitions * 6! * 6! ≈ 2 billion operations
+// The worst case is still O(N^M) assignments, but the lower bounds prune
+// all but a small part of the tree, and each robot's task ordering costs a
+// table lookup (Held-Karp, O(2^M * M^2) once per robot state) instead of
+// (M/N)! permutations per assignment.
 AlgorithmResult BruteForce::execute(
     const Graph& graph,
     queue<Robot>& availableRobots,
@@ -111,25 +266,24 @@ AlgorithmResult BruteForce::execute(
     bool compactMode
 ) {
     (void)chargingRobots; // Unused in brute force
-    (void)totalRobots;    // Unused in brute force
-    
+        
     AlgorithmResult result;
     result.algorithmName = getName();
-    result.isOptimal = true; // Brute force is always optimal
+    result.isOptimal = true; // Brute force is optimal unless stopped early
     
-    if (!compactMode) cout << "Executing Brute Force Algorithm..." << endl;
+    if (!compactMode) out() << "Executing Brute Force Algorithm..." << endl;
     
     // --- 1. PREPARATION ---
     auto startTime = chrono::high_resolution_clock::now();
 
     if (pendingTasks.empty()) {
-        if (!compactMode) cout << "No pending tasks to assign." << endl;
+        if (!compactMode) out() << "No pending tasks to assign." << endl;
         result.makespan = 0.0;
         result.computationTimeMs = 0.0;
         return result;
     }
     if (availableRobots.empty()) {
-        if (!compactMode) cout << "No available robots to perform tasks." << endl;
+        if (!compactMode) out() << "No available robots to perform tasks." << endl;
         result.makespan = 0.0;
         result.computationTimeMs = 0.0;
         return result;
@@ -148,10 +302,18 @@ AlgorithmResult BruteForce::execute(
         pendingTasks.pop(); // All tasks are now considered for assignment
     }
 
-    if (!compactMode) cout << "Assigning " << tasksVec.size() << " tasks to " << robotsVec.size() << " available robots." << endl;
+    if (!compactMode) out() << "Assigning " << tasksVec.size() << " tasks to " << robotsVec.size() << " available robots." << endl;
     
-    if (complexity_warnings(tasksVec, robotsVec, compactMode)) {
-        // Complexity too high - abort and return all robots and tasks to queues
+    if (static_cast<int>(tasksVec.size()) > MAX_EXACT_TASKS) {
+        out() << "\n❌ ERROR: Too many tasks for the exact search!" << endl;
+        out() << "   Problem size: " << robotsVec.size() << " robots, " << tasksVec.size() << " tasks" << endl;
+        out() << "   Maximum: " << MAX_EXACT_TASKS << " tasks" << endl;
+        out() << "\n   Please use a faster algorithm:" << endl;
+        out() << "     - Algorithm 2: Greedy (fast heuristic)" << endl;
+        out() << "     - Algorithm 3: Hill Climbing (improved greedy)" << endl;
+        out() << "\n   Aborting brute force execution." << endl;
+
+        // Return all robots and tasks to queues
         for (const auto& robot : robotsVec) {
             availableRobots.push(robot);
         }
@@ -166,25 +328,81 @@ AlgorithmResult BruteForce::execute(
         return result;
     }
     
-    // --- 2. BRUTE-FORCE ALGORITHM ---
+    // --- 2. BRANCH-AND-BOUND ---
     
-    double minMakespan = numeric_limits<double>::max();
-    vector<vector<Task>> bestAssignment(robotsVec.size());
-    vector<vector<Task>> currentAssignment(robotsVec.size());
+    DistanceOracle oracle(graph, tasksVec, robotsVec);
+
+    // Longest tasks first: they raise the bounds soonest
+    vector<double> loadedLength(tasksVec.size(), 0.0);
+    for (size_t i = 0; i < tasksVec.size(); ++i) {
+        int originLocation = oracle.nodeLocation(tasksVec[i].getOriginNode());
+        int destLocation = oracle.nodeLocation(tasksVec[i].getDestinationNode());
+        if (originLocation >= 0 && destLocation >= 0) {
+            loadedLength[i] = oracle.distance(originLocation, destLocation);
+        }
+    }
+    vector<size_t> byLength(tasksVec.size());
+    for (size_t i = 0; i < byLength.size(); ++i) byLength[i] = i;
+    stable_sort(byLength.begin(), byLength.end(),
+                [&](size_t a, size_t b) { return loadedLength[a] > loadedLength[b]; });
+    vector<Task> orderedTasks;
+    for (size_t i : byLength) orderedTasks.push_back(tasksVec[i]);
+
+    BranchAndBound search(robotsVec, orderedTasks, oracle, stopFlag);
+
+    // Incumbent: Greedy's partition, each robot's tasks in their best order
+    {
+        queue<Robot> greedyAvailable, greedyBusy, greedyCharging;
+        queue<Task> greedyTasks;
+        for (const auto& robot : robotsVec) greedyAvailable.push(robot);
+        for (const auto& task : orderedTasks) greedyTasks.push(task);
+        AlgorithmResult greedy = Greedy().execute(graph, greedyAvailable, greedyBusy, greedyCharging,
+                                                  greedyTasks, totalRobots, true);
+        if (greedy.assignment.size() == robotsVec.size()) {
+            vector<uint32_t> masks(robotsVec.size(), 0);
+            uint32_t used = 0;
+            for (size_t r = 0; r < greedy.assignment.size(); ++r) {
+                for (const Task& task : greedy.assignment[r]) {
+                    for (size_t j = 0; j < orderedTasks.size(); ++j) {
+                        if (!(used & (1u << j)) && orderedTasks[j].getTaskId() == task.getTaskId()) {
+                            used |= 1u << j;
+                            masks[r] |= 1u << j;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (used == (1u << orderedTasks.size()) - 1) search.seed(masks);
+        }
+    }
+    double seedMakespan = search.makespan();
+
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    search.run(threads);
     
-    // Start the recursive search for the best assignment
-    findBestAssignment(0, tasksVec, robotsVec, graph, currentAssignment, bestAssignment, minMakespan);
+    double minMakespan = search.makespan();
+    result.isOptimal = !search.stopped();
+    vector<vector<Task>> bestAssignment(robotsVec.size());
+    if (minMakespan != numeric_limits<double>::max()) {
+        bestAssignment = search.assignment();
+    }
     
     auto endTime = chrono::high_resolution_clock::now();
     chrono::duration<double, milli> algorithmDuration = endTime - startTime;
 
     // --- 3. OUTPUT AND STATE UPDATE ---
     
-    if (!compactMode) cout << "\n--- Brute Force Result ---" << endl;
-    cout << "Algorithm computation time: " << algorithmDuration.count() << " ms" << endl;
+    if (!compactMode) out() << "\n--- Brute Force Result ---" << endl;
+    out() << "Algorithm computation time: " << algorithmDuration.count() << " ms" << endl;
+    if (!compactMode) {
+        out() << "Branch-and-bound: " << search.nodesExplored() << " nodes, " << search.leavesEvaluated()
+             << " leaves, " << search.subtreeCount() << " subtrees on " << threads << " threads";
+        if (seedMakespan != numeric_limits<double>::max()) out() << " (Greedy incumbent: " << seedMakespan << " s)";
+        out() << endl;
+    }
     
     if (minMakespan == numeric_limits<double>::max()) {
-        if (!compactMode) cout << "No valid assignment could be found." << endl;
+        if (!compactMode) out() << "No valid assignment could be found." << endl;
         // Push robots back to available queue if no assignment was made
         for (const auto& robot : robotsVec) {
             availableRobots.push(robot);
@@ -194,8 +412,8 @@ AlgorithmResult BruteForce::execute(
         return result;
     }
 
-    cout << "Optimal assignment found with a makespan (max robot completion time) of: " 
-         << minMakespan << " seconds." << endl;
+    out() << (result.isOptimal ? "Optimal assignment found" : "Search stopped early; best assignment found")
+          << " with a makespan (max robot completion time) of: " << minMakespan << " seconds." << endl;
 
     // Print beautified assignment
     if (!compactMode) AssignmentPrinter::printBeautifiedAssignment(getName(), robotsVec, bestAssignment, graph);
@@ -212,7 +430,7 @@ AlgorithmResult BruteForce::execute(
             availableRobots.push(robot);
         }
     }
-    if (!compactMode) cout << "--------------------------" << endl;
+    if (!compactMode) out() << "--------------------------" << endl;
     
     // Populate result struct
     result.makespan = minMakespan;
@@ -221,71 +439,3 @@ AlgorithmResult BruteForce::execute(
     
     return result;
 }
-
-
-// --- Helper Function Definitions ---
-
-/**
- * @brief Calculates the makespan (maximum completion time) for a complete assignment.
- * This version finds the OPTIMAL task ordering for each robot by checking all permutations.
- */
-double BruteForce::calculateMakespan(
-    const vector<vector<Task>>& assignment,
-    vector<Robot>& robots,
-    const Graph& graph
-) {
-    double maxTime = 0.0;
-
-    for (size_t i = 0; i < robots.size(); ++i) {
-        // For each robot, find the minimum possible time by using TSP solver
-        double robotMinTime = TSPSolver::findOptimalSequenceTime(robots[i], assignment[i], graph);
-        
-        if (robotMinTime > maxTime) {
-            maxTime = robotMinTime;
-        }
-    }
-    
-    return maxTime;
-}
-
-
-/**
- * @brief Recursively explores all possible task assignments to find the optimal one.
- * @param taskIndex The index of the current task in `tasks` to be assigned.
- */
-void BruteForce::findBestAssignment(
-    int taskIndex,
-    const vector<Task>& tasks,
-     vector<Robot>& robots,
-    const Graph& graph,
-    vector<vector<Task>>& currentAssignment,
-    vector<vector<Task>>& bestAssignment,
-    double& minMakespan
-) {
-    // BASE CASE: All tasks have been assigned.
-    if (taskIndex == tasks.size()) {
-        // Calculate the cost (makespan) of the current complete assignment.
-        double currentMakespan = calculateMakespan(currentAssignment, robots, graph);
-        
-        // If this assignment is better than the best one found so far, update it.
-        if (currentMakespan < minMakespan) {
-            minMakespan = currentMakespan;
-            bestAssignment = currentAssignment;
-        }
-        return;
-    }
-
-    // RECURSIVE STEP: Try assigning the current task to each robot.
-    const Task& currentTask = tasks[taskIndex];
-    for (size_t i = 0; i < robots.size(); ++i) {
-        // Assign the task to robot 'i'.
-        currentAssignment[i].push_back(currentTask);
-
-        // Recurse to assign the next task.
-        findBestAssignment(taskIndex + 1, tasks, robots, graph, currentAssignment, bestAssignment, minMakespan);
-
-        // BACKTRACK: Remove the task from robot 'i' so it can be assigned
-        // to the next robot in the next iteration of this loop.
-        currentAssignment[i].pop_back();
-    }
-}
\ No newline at end of file
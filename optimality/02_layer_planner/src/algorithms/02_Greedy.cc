@@ -1,6 +1,7 @@
 #include "../../include/algorithms/02_Greedy.hh"
 #include "../../include/algorithms/utils/SchedulerUtils.hh"
 #include "../../include/algorithms/utils/AssignmentPrinter.hh"
+#include "../../include/algorithms/utils/DistanceOracle.hh"
 #include <iostream>
 #include <iomanip>
 #include <vector>
@@ -9,7 +10,7 @@
 #include <chrono>
 #include <random>
 #include <algorithm>
-#include <unordered_map>
+#include <set>
 using namespace std;
 
 string Greedy::getName() const {
@@ -25,9 +26,9 @@ namespace {
     double calculateMakespanSequential(
         const vector<vector<Task>>& assignment,
         const vector<Robot>& initialRobots,
-        const Graph& graph,
-        const SchedulerUtils::BatteryConfig& config,
-        int chargingNodeId
+        const vector<int>& initialLocations,
+        const DistanceOracle& oracle,
+        const SchedulerUtils::BatteryConfig& config
     ) {
         double maxTime = 0.0;
 
@@ -37,27 +38,27 @@ namespace {
             // Simulate this robot's sequence from its starting state
             double totalTime = 0.0;
             double currentBattery = initialRobots[i].getBatteryLevel();
-            pair<double, double> currentPos = initialRobots[i].getPosition();
+            int currentLocation = initialLocations[i];
 
             for (const Task& task : assignment[i]) {
-                const Graph::Node* originNode = graph.getNode(task.getOriginNode());
-                const Graph::Node* destNode = graph.getNode(task.getDestinationNode());
-                if (!originNode || !destNode) continue;
+                int originLocation = oracle.nodeLocation(task.getOriginNode());
+                int destLocation = oracle.nodeLocation(task.getDestinationNode());
+                if (originLocation < 0 || destLocation < 0) continue;
 
                 auto taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                    currentPos, originNode, destNode, currentBattery, config
+                    oracle, currentLocation, originLocation, destLocation, currentBattery, config
                 );
 
-                if (chargingNodeId != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
-                    SchedulerUtils::performCharging(currentPos, currentBattery, totalTime, chargingNodeId, graph, config);
+                if (oracle.chargerLocation() != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
+                    SchedulerUtils::performCharging(currentLocation, currentBattery, totalTime, oracle, config);
                     taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                        currentPos, originNode, destNode, currentBattery, config
+                        oracle, currentLocation, originLocation, destLocation, currentBattery, config
                     );
                 }
 
                 totalTime += taskInfo.timeToOrigin + taskInfo.timeForTask;
                 currentBattery -= taskInfo.totalBatteryNeeded;
-                currentPos = destNode->coordinates;
+                currentLocation = destLocation;
             }
 
             if (totalTime > maxTime) {
@@ -91,18 +92,18 @@ AlgorithmResult Greedy::execute(
     result.algorithmName = getName();
     result.isOptimal = false;
     
-    if (!compactMode) cout << "Executing Greedy Algorithm..." << endl;
+    if (!compactMode) out() << "Executing Greedy Algorithm..." << endl;
     
     auto startTime = chrono::high_resolution_clock::now();
 
     if (pendingTasks.empty()) {
-        if (!compactMode) cout << "No pending tasks to assign." << endl;
+        if (!compactMode) out() << "No pending tasks to assign." << endl;
         result.makespan = 0.0;
         result.computationTimeMs = 0.0;
         return result;
     }
     if (availableRobots.empty()) {
-        if (!compactMode) cout << "No available robots to perform tasks." << endl;
+        if (!compactMode) out() << "No available robots to perform tasks." << endl;
         result.makespan = 0.0;
         result.computationTimeMs = 0.0;
         return result;
@@ -121,7 +122,7 @@ AlgorithmResult Greedy::execute(
     }
 
     if (!compactMode) { 
-        cout << "Assigning " << tasksVec.size() << " tasks to " 
+        out() << "Assigning " << tasksVec.size() << " tasks to " 
              << originalRobots.size() << " robots using greedy strategy." << endl; 
     }
 
@@ -132,17 +133,23 @@ AlgorithmResult Greedy::execute(
     }
     
     SchedulerUtils::BatteryConfig config(originalRobots[0]);
-    int chargingNodeId = SchedulerUtils::getChargingNodeId(graph);
-    if (chargingNodeId == -1 && !compactMode) {
+    DistanceOracle oracle(graph, tasksVec, originalRobots);
+    if (oracle.chargerLocation() == -1 && !compactMode) {
         cerr << "Warning: No charging node found in graph. Battery constraints ignored." << endl;
     }
+    vector<int> originalLocations;
+    for (const Robot& robot : originalRobots) {
+        originalLocations.push_back(oracle.positionLocation(robot.getPosition()));
+    }
 
     const int NUM_RANDOM_STARTS = 5;
     double bestMakespan = numeric_limits<double>::max();
     vector<vector<Task>> bestAssignment;
     
     for (int trial = 0; trial < NUM_RANDOM_STARTS; ++trial) {
+        if (trial > 0 && stopRequested()) break;     // Keep the orderings tried so far
         vector<Robot> trialRobots = originalRobots;
+        vector<int> trialLocations = originalLocations;
         vector<vector<Task>> trialAssignment(trialRobots.size());
         
         vector<Task> shuffledTasks = tasksVec;
@@ -151,65 +158,76 @@ AlgorithmResult Greedy::execute(
             shuffle(shuffledTasks.begin(), shuffledTasks.end(), default_random_engine(seed));
         }
         
-        // This is the same logic as HillClimbing's generateGreedySolution
-        unordered_map<int, double> robotCompletionTimes;
+        // This is the same logic as HillClimbing's generateGreedySolution.
+        // Robots are kept ordered by the time they are free: one free at t
+        // cannot finish the task before t plus the task's own travel time,
+        // so the scan stops at the first robot that cannot beat the best
+        // end time found (ties still go to the lowest index)
+        vector<double> robotTimes(trialRobots.size(), 0.0);
+        set<pair<double, size_t>> robotsByTime;
+        for (size_t i = 0; i < trialRobots.size(); ++i) {
+            robotsByTime.insert({0.0, i});
+        }
         for (const auto& task : shuffledTasks) {
+            int originLocation = oracle.nodeLocation(task.getOriginNode());
+            int destLocation = oracle.nodeLocation(task.getDestinationNode());
+            if (originLocation < 0 || destLocation < 0) continue;
+            const double timeForTask = oracle.distance(originLocation, destLocation) / config.robotSpeed;
+
             int bestRobotIdx = -1;
             double minEndTime = numeric_limits<double>::max();
 
-            for (size_t i = 0; i < trialRobots.size(); ++i) {
-                Robot tempRobot = trialRobots[i];
-                double tempTime = robotCompletionTimes[tempRobot.getId()];
-                
-                const Graph::Node* originNode = graph.getNode(task.getOriginNode());
-                const Graph::Node* destNode = graph.getNode(task.getDestinationNode());
-                if (!originNode || !destNode) continue;
+            for (const auto& [freeAt, i] : robotsByTime) {
+                if (freeAt + timeForTask > minEndTime) break;
 
+                const Robot& tempRobot = trialRobots[i];
+                double tempTime = freeAt;
                 auto taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                    tempRobot.getPosition(), originNode, destNode, tempRobot.getBatteryLevel(), config);
+                    oracle, trialLocations[i], originLocation, destLocation, tempRobot.getBatteryLevel(), config);
                 
-                auto tempPos = tempRobot.getPosition();
+                int tempLocation = trialLocations[i];
                 auto tempBat = tempRobot.getBatteryLevel();
-                if (chargingNodeId != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
-                    SchedulerUtils::performCharging(tempPos, tempBat, tempTime, chargingNodeId, graph, config);
-                    taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(tempPos, originNode, destNode, tempBat, config);
+                if (oracle.chargerLocation() != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
+                    SchedulerUtils::performCharging(tempLocation, tempBat, tempTime, oracle, config);
+                    taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
+                        oracle, tempLocation, originLocation, destLocation, tempBat, config);
                 }
                 double endTime = tempTime + taskInfo.timeToOrigin + taskInfo.timeForTask;
 
-                if (endTime < minEndTime) {
+                if (endTime < minEndTime || (endTime == minEndTime && static_cast<int>(i) < bestRobotIdx)) {
                     minEndTime = endTime;
-                    bestRobotIdx = i;
+                    bestRobotIdx = static_cast<int>(i);
                 }
             }
 
             if (bestRobotIdx != -1) {
                 Robot& chosenRobot = trialRobots[bestRobotIdx];
-                double& robotTime = robotCompletionTimes[chosenRobot.getId()];
-
-                const Graph::Node* originNode = graph.getNode(task.getOriginNode());
-                const Graph::Node* destNode = graph.getNode(task.getDestinationNode());
+                int& robotLocation = trialLocations[bestRobotIdx];
+                double& robotTime = robotTimes[bestRobotIdx];
+                robotsByTime.erase({robotTime, static_cast<size_t>(bestRobotIdx)});
                 
                 auto taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                    chosenRobot.getPosition(), originNode, destNode, chosenRobot.getBatteryLevel(), config);
+                    oracle, robotLocation, originLocation, destLocation, chosenRobot.getBatteryLevel(), config);
 
-                if (chargingNodeId != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
-                    auto robotPos = chosenRobot.getPosition();
+                if (oracle.chargerLocation() != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
                     auto robotBat = chosenRobot.getBatteryLevel();
-                    SchedulerUtils::performCharging(robotPos, robotBat, robotTime, chargingNodeId, graph, config);
-                    chosenRobot.setPosition(robotPos);
+                    SchedulerUtils::performCharging(robotLocation, robotBat, robotTime, oracle, config);
                     chosenRobot.setBatteryLevel(robotBat);
-                    taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(chosenRobot.getPosition(), originNode, destNode, chosenRobot.getBatteryLevel(), config);
+                    taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
+                        oracle, robotLocation, originLocation, destLocation, chosenRobot.getBatteryLevel(), config);
                 }
                 
                 robotTime += taskInfo.timeToOrigin + taskInfo.timeForTask;
                 chosenRobot.setBatteryLevel(chosenRobot.getBatteryLevel() - taskInfo.totalBatteryNeeded);
-                chosenRobot.setPosition(destNode->coordinates);
+                chosenRobot.setPosition(oracle.position(destLocation));
+                robotLocation = destLocation;
                 trialAssignment[bestRobotIdx].push_back(task);
+                robotsByTime.insert({robotTime, static_cast<size_t>(bestRobotIdx)});
             }
         }
         
         // Use the correct sequential makespan calculator
-        double trialMakespan = calculateMakespanSequential(trialAssignment, originalRobots, graph, config, chargingNodeId);
+        double trialMakespan = calculateMakespanSequential(trialAssignment, originalRobots, originalLocations, oracle, config);
 
         if (trialMakespan < bestMakespan) {
             bestMakespan = trialMakespan;
@@ -236,12 +254,12 @@ AlgorithmResult Greedy::execute(
     }
     
     if (!compactMode) {
-        cout << "\n--- Greedy Algorithm Result ---" << endl;
-        cout << "Algorithm computation time: " << result.computationTimeMs << " ms" << endl;
-        cout << "Makespan (max robot completion time): " << fixed << setprecision(2) 
+        out() << "\n--- Greedy Algorithm Result ---" << endl;
+        out() << "Algorithm computation time: " << result.computationTimeMs << " ms" << endl;
+        out() << "Makespan (max robot completion time): " << fixed << setprecision(2) 
              << result.makespan << " seconds." << endl;
         AssignmentPrinter::printBeautifiedAssignment(getName(), originalRobots, bestAssignment, graph);
-        cout << "--------------------------" << endl;
+        out() << "--------------------------" << endl;
     }
     
     return result;
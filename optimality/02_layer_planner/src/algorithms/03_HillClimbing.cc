@@ -39,18 +39,18 @@ AlgorithmResult HillClimbing::execute(
     result.algorithmName = getName();
     result.isOptimal = false; // Hill climbing is a heuristic
     
-    if (!compactMode) cout << "Executing Hill Climbing Algorithm..." << endl;
+    if (!compactMode) out() << "Executing Hill Climbing Algorithm..." << endl;
     
     auto startTime = chrono::high_resolution_clock::now();
 
     if (pendingTasks.empty()) {
-        if (!compactMode) cout << "No pending tasks to assign." << endl;
+        if (!compactMode) out() << "No pending tasks to assign." << endl;
         result.makespan = 0.0;
         result.computationTimeMs = 0.0;
         return result;
     }
     if (availableRobots.empty()) {
-        if (!compactMode) cout << "No available robots to perform tasks." << endl;
+        if (!compactMode) out() << "No available robots to perform tasks." << endl;
         result.makespan = 0.0;
         result.computationTimeMs = 0.0;
         return result;
@@ -72,7 +72,7 @@ AlgorithmResult HillClimbing::execute(
     vector<Robot>& robots = originalRobots; // Use a reference for clarity
 
     if (!compactMode) {
-        cout << "Assigning " << tasksVec.size() << " tasks to " 
+        out() << "Assigning " << tasksVec.size() << " tasks to " 
              << robots.size() << " robots using hill climbing strategy." << endl;
     }
 
@@ -84,46 +84,51 @@ AlgorithmResult HillClimbing::execute(
     }
     SchedulerUtils::BatteryConfig config(robots[0]);
     
-    // Get charging node
-    int chargingNodeId = SchedulerUtils::getChargingNodeId(graph);
-    if (chargingNodeId == -1 && !compactMode) {
+    // Distances between every location of the instance (and the charging node)
+    DistanceOracle oracle(graph, tasksVec, originalRobots);
+    if (oracle.chargerLocation() == -1 && !compactMode) {
         cerr << "Warning: No charging node found in graph. Battery constraints ignored." << endl;
     }
+    vector<int> startLocations;
+    for (const Robot& robot : originalRobots) {
+        startLocations.push_back(oracle.positionLocation(robot.getPosition()));
+    }
 
     // Phase 1: Generate initial greedy solution
-    if (!compactMode) cout << "Phase 1: Generating initial greedy solution..." << endl;
+    if (!compactMode) out() << "Phase 1: Generating initial greedy solution..." << endl;
     
     // Create a mutable copy of robots for the greedy simulation
     vector<Robot> simulatedRobotsForGreedy = originalRobots;
     vector<vector<Task>> assignment = generateGreedySolution(
-        simulatedRobotsForGreedy, tasksVec, graph, config, chargingNodeId
+        simulatedRobotsForGreedy, tasksVec, oracle, config
     );
     
     // Use the CORRECT makespan calculator, passing the ORIGINAL robots
-    double currentMakespan = calculateMakespan(assignment, originalRobots, graph, config, chargingNodeId);
-    if (!compactMode) cout << "Initial greedy makespan: " << fixed << setprecision(2) << currentMakespan << "s" << endl;
+    double currentMakespan = calculateMakespan(assignment, originalRobots, startLocations, oracle, config);
+    if (!compactMode) out() << "Initial greedy makespan: " << fixed << setprecision(2) << currentMakespan << "s" << endl;
 
     // Phase 2: Hill climbing improvement
-    if (!compactMode) cout << "Phase 2: Improving solution through local search..." << endl;
+    if (!compactMode) out() << "Phase 2: Improving solution through local search..." << endl;
     int improvementCount = 0;
     int maxIterations = 100;
     int iterationsWithoutImprovement = 0;
     int maxWithoutImprovement = 20;
     
     for (int iteration = 0; iteration < maxIterations; ++iteration) {
-        bool improved = tryImprovement(assignment, robots, graph, config, chargingNodeId, currentMakespan);
+        if (stopRequested()) break;     // Keep the best solution so far
+        bool improved = tryImprovement(assignment, robots, startLocations, oracle, config, currentMakespan);
         
         if (improved) {
             improvementCount++;
             iterationsWithoutImprovement = 0;
             if (!compactMode) {
-                cout << "  Iteration " << iteration + 1 << ": Improved makespan to " 
+                out() << "  Iteration " << iteration + 1 << ": Improved makespan to " 
                      << fixed << setprecision(2) << currentMakespan << "s" << endl;
             }
         } else {
             iterationsWithoutImprovement++;
             if (iterationsWithoutImprovement >= maxWithoutImprovement) {
-                if (!compactMode) cout << "No improvement for " << maxWithoutImprovement << " iterations. Stopping." << endl;
+                if (!compactMode) out() << "No improvement for " << maxWithoutImprovement << " iterations. Stopping." << endl;
                 break;
             }
         }
@@ -132,10 +137,10 @@ AlgorithmResult HillClimbing::execute(
     auto endTime = chrono::high_resolution_clock::now();
     chrono::duration<double, milli> duration = endTime - startTime;
 
-    if (!compactMode) cout << "\n--- Hill Climbing Result ---" << endl;
-    cout << "Algorithm computation time: " << duration.count() << " ms" << endl;
-    cout << "Total improvements: " << improvementCount << endl;
-    cout << "Final makespan (max robot completion time): " << fixed << setprecision(2) 
+    if (!compactMode) out() << "\n--- Hill Climbing Result ---" << endl;
+    out() << "Algorithm computation time: " << duration.count() << " ms" << endl;
+    out() << "Total improvements: " << improvementCount << endl;
+    out() << "Final makespan (max robot completion time): " << fixed << setprecision(2) 
          << currentMakespan << " seconds." << endl;
 
     // Print beautified assignment
@@ -151,7 +156,7 @@ AlgorithmResult HillClimbing::execute(
         }
     }
     
-    if (!compactMode) cout << "--------------------------" << endl;
+    if (!compactMode) out() << "--------------------------" << endl;
     
     // Populate result struct
     result.makespan = currentMakespan;
@@ -167,35 +172,38 @@ AlgorithmResult HillClimbing::execute(
 vector<vector<Task>> HillClimbing::generateGreedySolution(
     vector<Robot>& simulatedRobots,
     const vector<Task>& tasks,
-    const Graph& graph,
-    const SchedulerUtils::BatteryConfig& config,
-    int chargingNodeId
+    const DistanceOracle& oracle,
+    const SchedulerUtils::BatteryConfig& config
 ) {
     vector<vector<Task>> assignment(simulatedRobots.size());
     unordered_map<int, double> robotCompletionTimes;
+    vector<int> robotLocations;
+    for (const Robot& robot : simulatedRobots) {
+        robotLocations.push_back(oracle.positionLocation(robot.getPosition()));
+    }
 
     for (const auto& task : tasks) {
         int bestRobotIdx = -1;
         double minEndTime = numeric_limits<double>::max();
 
         for (size_t i = 0; i < simulatedRobots.size(); ++i) {
-            Robot tempRobot = simulatedRobots[i];
+            const Robot& tempRobot = simulatedRobots[i];
             double tempTime = robotCompletionTimes[tempRobot.getId()];
             
-            const Graph::Node* originNode = graph.getNode(task.getOriginNode());
-            const Graph::Node* destNode = graph.getNode(task.getDestinationNode());
-            if (!originNode || !destNode) continue;
+            int originLocation = oracle.nodeLocation(task.getOriginNode());
+            int destLocation = oracle.nodeLocation(task.getDestinationNode());
+            if (originLocation < 0 || destLocation < 0) continue;
             
             auto taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                tempRobot.getPosition(), originNode, destNode, tempRobot.getBatteryLevel(), config);
+                oracle, robotLocations[i], originLocation, destLocation, tempRobot.getBatteryLevel(), config);
             
-            auto tempPos = tempRobot.getPosition();
+            int tempLocation = robotLocations[i];
             auto tempBat = tempRobot.getBatteryLevel();
 
-            if (chargingNodeId != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
-                SchedulerUtils::performCharging(tempPos, tempBat, tempTime, chargingNodeId, graph, config);
+            if (oracle.chargerLocation() != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
+                SchedulerUtils::performCharging(tempLocation, tempBat, tempTime, oracle, config);
                 taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                    tempPos, originNode, destNode, tempBat, config
+                    oracle, tempLocation, originLocation, destLocation, tempBat, config
                 );
             }
             
@@ -209,29 +217,29 @@ vector<vector<Task>> HillClimbing::generateGreedySolution(
 
         if (bestRobotIdx != -1) {
             Robot& chosenRobot = simulatedRobots[bestRobotIdx];
+            int& robotLocation = robotLocations[bestRobotIdx];
             double& robotTime = robotCompletionTimes[chosenRobot.getId()];
 
-            const Graph::Node* originNode = graph.getNode(task.getOriginNode());
-            const Graph::Node* destNode = graph.getNode(task.getDestinationNode());
+            int originLocation = oracle.nodeLocation(task.getOriginNode());
+            int destLocation = oracle.nodeLocation(task.getDestinationNode());
             
             auto taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                chosenRobot.getPosition(), originNode, destNode, chosenRobot.getBatteryLevel(), config);
+                oracle, robotLocation, originLocation, destLocation, chosenRobot.getBatteryLevel(), config);
 
-            if (chargingNodeId != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
-                auto robotPos = chosenRobot.getPosition();
+            if (oracle.chargerLocation() != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
                 auto robotBat = chosenRobot.getBatteryLevel();
-                SchedulerUtils::performCharging(robotPos, robotBat, robotTime, chargingNodeId, graph, config);
-                chosenRobot.setPosition(robotPos);
+                SchedulerUtils::performCharging(robotLocation, robotBat, robotTime, oracle, config);
                 chosenRobot.setBatteryLevel(robotBat);
                 
                 taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                    chosenRobot.getPosition(), originNode, destNode, chosenRobot.getBatteryLevel(), config
+                    oracle, robotLocation, originLocation, destLocation, chosenRobot.getBatteryLevel(), config
                 );
             }
             
             robotTime += taskInfo.timeToOrigin + taskInfo.timeForTask;
             chosenRobot.setBatteryLevel(chosenRobot.getBatteryLevel() - taskInfo.totalBatteryNeeded);
-            chosenRobot.setPosition(destNode->coordinates);
+            chosenRobot.setPosition(oracle.position(destLocation));
+            robotLocation = destLocation;
             assignment[bestRobotIdx].push_back(task);
         }
     }
@@ -239,49 +247,59 @@ vector<vector<Task>> HillClimbing::generateGreedySolution(
 }
 
 /**
- * @brief Calculate makespan for an assignment
+ * @brief Completion time of one robot's task sequence
  */
-double HillClimbing::calculateMakespan(
-    const vector<vector<Task>>& assignment,
-    const vector<Robot>& robots,
-    const Graph& graph,
-    const SchedulerUtils::BatteryConfig& config,
-    int chargingNodeId
+double HillClimbing::calculateRobotTime(
+    const vector<Task>& sequence,
+    const Robot& robot,
+    int startLocation,
+    const DistanceOracle& oracle,
+    const SchedulerUtils::BatteryConfig& config
 ) {
-    double maxTime = 0.0;
-
-    for (size_t i = 0; i < robots.size(); ++i) {
-        if (assignment[i].empty()) continue;
+    int currentLocation = startLocation;
+    double currentBattery = robot.getBatteryLevel();
+    double totalTime = 0.0;
 
-        pair<double, double> currentPos = robots[i].getPosition();
-        double currentBattery = robots[i].getBatteryLevel();
-        double totalTime = 0.0;
+    for (const Task& task : sequence) {
+        int originLocation = oracle.nodeLocation(task.getOriginNode());
+        int destLocation = oracle.nodeLocation(task.getDestinationNode());
+        
+        if (originLocation < 0 || destLocation < 0) continue;
 
-        for (const Task& task : assignment[i]) {
-            const Graph::Node* originNode = graph.getNode(task.getOriginNode());
-            const Graph::Node* destNode = graph.getNode(task.getDestinationNode());
-            
-            if (!originNode || !destNode) continue;
+        SchedulerUtils::TaskBatteryInfo taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
+            oracle, currentLocation, originLocation, destLocation, currentBattery, config
+        );
 
-            SchedulerUtils::TaskBatteryInfo taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                currentPos, originNode, destNode, currentBattery, config
+        // Check if charging needed
+        if (oracle.chargerLocation() != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
+            SchedulerUtils::performCharging(currentLocation, currentBattery, totalTime, oracle, config);
+            taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
+                oracle, currentLocation, originLocation, destLocation, currentBattery, config
             );
+        }
 
-            // Check if charging needed
-            if (chargingNodeId != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
-                SchedulerUtils::performCharging(currentPos, currentBattery, totalTime,
-                               chargingNodeId, graph, config);
-                taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                    currentPos, originNode, destNode, currentBattery, config
-                );
-            }
+        totalTime += taskInfo.timeToOrigin + taskInfo.timeForTask;
+        currentBattery -= taskInfo.totalBatteryNeeded;
+        currentLocation = destLocation;
+    }
 
-            totalTime += taskInfo.timeToOrigin + taskInfo.timeForTask;
-            currentBattery -= taskInfo.totalBatteryNeeded;
-            currentPos = destNode->coordinates;
-        }
+    return totalTime;
+}
 
-        maxTime = max(maxTime, totalTime);
+/**
+ * @brief Calculate makespan for an assignment
+ */
+double HillClimbing::calculateMakespan(
+    const vector<vector<Task>>& assignment,
+    const vector<Robot>& robots,
+    const vector<int>& startLocations,
+    const DistanceOracle& oracle,
+    const SchedulerUtils::BatteryConfig& config
+) {
+    double maxTime = 0.0;
+
+    for (size_t i = 0; i < robots.size(); ++i) {
+        maxTime = max(maxTime, calculateRobotTime(assignment[i], robots[i], startLocations[i], oracle, config));
     }
 
     return maxTime;
@@ -289,17 +307,44 @@ double HillClimbing::calculateMakespan(
 
 /**
  * @brief Try to improve solution by swapping tasks between robots
+ *
+ * Robot completion times are computed once per call; a candidate move
+ * re-times the (at most two) robots it changes and takes the makespan
+ * over the cached times of the rest. Only moves touching every robot
+ * that sets the makespan are re-timed at all.
  */
 bool HillClimbing::tryImprovement(
     vector<vector<Task>>& assignment,
     const vector<Robot>& robots,
-    const Graph& graph,
+    const vector<int>& startLocations,
+    const DistanceOracle& oracle,
     const SchedulerUtils::BatteryConfig& config,
-    int chargingNodeId,
     double& currentMakespan
 ) {
+    vector<double> robotTimes(assignment.size());
+    for (size_t r = 0; r < assignment.size(); ++r) {
+        robotTimes[r] = calculateRobotTime(assignment[r], robots[r], startLocations[r], oracle, config);
+    }
+
+    // Makespan with robots i and j re-timed (i == j: one robot changed).
+    // While an untouched robot still finishes at currentMakespan no move
+    // can improve: that robot's time is returned without re-timing
+    auto makespanAfterMove = [&](size_t i, size_t j) {
+        double makespan = 0.0;
+        for (size_t r = 0; r < robotTimes.size(); ++r) {
+            if (r != i && r != j) makespan = max(makespan, robotTimes[r]);
+        }
+        if (makespan >= currentMakespan) return makespan;
+        makespan = max(makespan, calculateRobotTime(assignment[i], robots[i], startLocations[i], oracle, config));
+        if (j != i) {
+            makespan = max(makespan, calculateRobotTime(assignment[j], robots[j], startLocations[j], oracle, config));
+        }
+        return makespan;
+    };
+
     // Try swapping tasks between different robots
     for (size_t i = 0; i < assignment.size(); ++i) {
+        if (stopRequested()) return false;
         for (size_t j = i + 1; j < assignment.size(); ++j) {
             if (assignment[i].empty() || assignment[j].empty()) continue;
 
@@ -312,7 +357,7 @@ bool HillClimbing::tryImprovement(
                     assignment[j][tj] = temp;
 
                     // Calculate new makespan
-                    double newMakespan = calculateMakespan(assignment, robots, graph, config, chargingNodeId);
+                    double newMakespan = makespanAfterMove(i, j);
 
                     if (newMakespan < currentMakespan) {
                         // Accept the swap
@@ -330,6 +375,7 @@ bool HillClimbing::tryImprovement(
 
     // Try moving tasks between robots
     for (size_t i = 0; i < assignment.size(); ++i) {
+        if (stopRequested()) return false;
         for (size_t j = 0; j < assignment.size(); ++j) {
             if (i == j || assignment[i].empty()) continue;
 
@@ -339,7 +385,7 @@ bool HillClimbing::tryImprovement(
                 assignment[i].erase(assignment[i].begin() + ti);
                 assignment[j].push_back(task);
 
-                double newMakespan = calculateMakespan(assignment, robots, graph, config, chargingNodeId);
+                double newMakespan = makespanAfterMove(i, j);
 
                 if (newMakespan < currentMakespan) {
                     currentMakespan = newMakespan;
@@ -355,6 +401,7 @@ bool HillClimbing::tryImprovement(
 
     // Try swapping tasks within the same robot (optimize execution order)
     for (size_t i = 0; i < assignment.size(); ++i) {
+        if (stopRequested()) return false;
         if (assignment[i].size() < 2) continue;  // Need at least 2 tasks to swap
 
         // Try swapping each pair of tasks within this robot's queue
@@ -366,7 +413,7 @@ bool HillClimbing::tryImprovement(
                 assignment[i][tj] = temp;
 
                 // Calculate new makespan
-                double newMakespan = calculateMakespan(assignment, robots, graph, config, chargingNodeId);
+                double newMakespan = makespanAfterMove(i, i);
 
                 if (newMakespan < currentMakespan) {
                     // Accept the swap
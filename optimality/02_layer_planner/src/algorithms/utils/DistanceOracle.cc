@@ -0,0 +1,54 @@
+#include "../../../include/algorithms/utils/DistanceOracle.hh"
+#include "../../../include/algorithms/utils/SchedulerUtils.hh"
+
+DistanceOracle::DistanceOracle(const Graph& graph, const std::vector<Task>& tasks, const std::vector<Robot>& robots)
+    : numLocations(0), charger(-1) {
+    for (const Graph::Node& node : graph.getAllNodes()) {
+        if (node.type == Graph::NodeType::Charging || node.type == Graph::NodeType::Pickup ||
+            node.type == Graph::NodeType::Dropoff) {
+            addNode(graph, node.nodeId);
+        }
+    }
+    for (const Task& task : tasks) {
+        addNode(graph, task.getOriginNode());
+        addNode(graph, task.getDestinationNode());
+    }
+    for (const Robot& robot : robots) {
+        if (positionLocation(robot.getPosition()) < 0) addLocation(robot.getPosition());
+    }
+
+    numLocations = static_cast<int>(positions.size());
+    matrix.assign(static_cast<size_t>(numLocations) * numLocations, 0.0);
+    for (int from = 0; from < numLocations; ++from) {
+        for (int to = 0; to < numLocations; ++to) {
+            matrix[static_cast<size_t>(from) * numLocations + to] =
+                SchedulerUtils::calculateDistance(positions[from], positions[to]);
+        }
+    }
+
+    int chargingNodeId = SchedulerUtils::getChargingNodeId(graph);
+    charger = nodeLocation(chargingNodeId);
+    toCharger.assign(numLocations, 0.0);
+    if (charger >= 0) {
+        for (int from = 0; from < numLocations; ++from) toCharger[from] = distance(from, charger);
+    }
+}
+
+int DistanceOracle::positionLocation(const std::pair<double, double>& position) const {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        if (positions[i] == position) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int DistanceOracle::addLocation(const std::pair<double, double>& position) {
+    positions.push_back(position);
+    return static_cast<int>(positions.size()) - 1;
+}
+
+void DistanceOracle::addNode(const Graph& graph, int nodeId) {
+    const Graph::Node* node = graph.getNode(nodeId);
+    if (!node) return;
+    if (nodeId >= static_cast<int>(locationByNode.size())) locationByNode.resize(nodeId + 1, -1);
+    if (locationByNode[nodeId] < 0) locationByNode[nodeId] = addLocation(node->coordinates);
+}
@@ -26,6 +26,53 @@ int SchedulerUtils::getChargingNodeId(const Graph& graph) {
     return -1;
 }
 
+namespace {
+    SchedulerUtils::TaskBatteryInfo taskBatteryFromDistances(
+        double distanceToOrigin,
+        double distanceForTask,
+        double currentBattery,
+        const SchedulerUtils::BatteryConfig& config
+    ) {
+        SchedulerUtils::TaskBatteryInfo info;
+        double percentageConsumePerSecond = 100.0 / config.batteryLifeSpan;
+        
+        // Calculate travel to origin (empty robot, uses alpha)
+        info.distanceToOrigin = distanceToOrigin;
+        info.timeToOrigin = info.distanceToOrigin / config.robotSpeed;
+        info.batteryToOrigin = info.timeToOrigin * percentageConsumePerSecond * config.alpha;
+        
+        // Calculate task execution (loaded robot, no alpha)
+        info.distanceForTask = distanceForTask;
+        info.timeForTask = info.distanceForTask / config.robotSpeed;
+        info.batteryForTask = info.timeForTask * percentageConsumePerSecond;
+        
+        // Calculate totals
+        info.totalBatteryNeeded = info.batteryToOrigin + info.batteryForTask;
+        info.batteryAfterTask = currentBattery - info.totalBatteryNeeded;
+        
+        return info;
+    }
+
+    // Travel to the station (empty, uses alpha) and charge to full
+    void chargeAfterTravel(double distToCharging, double& currentBattery, double& totalTime,
+                           const SchedulerUtils::BatteryConfig& config) {
+        double percentageConsumePerSecond = 100.0 / config.batteryLifeSpan;
+        
+        // 1. Travel to charging station
+        double timeToCharging = distToCharging / config.robotSpeed;
+        
+        // Update battery for travel to charging station (without load, uses alpha)
+        currentBattery -= timeToCharging * percentageConsumePerSecond * config.alpha;
+        totalTime += timeToCharging;
+        
+        // 2. Charge battery to full
+        double batteryNeeded = config.fullBattery - currentBattery;
+        double chargingTime = batteryNeeded / config.batteryRechargeRate;
+        currentBattery = config.fullBattery;
+        totalTime += chargingTime;
+    }
+}
+
 SchedulerUtils::TaskBatteryInfo SchedulerUtils::calculateTaskBatteryConsumption(
     const std::pair<double, double>& currentPos,
     const Graph::Node* originNode,
@@ -33,24 +80,26 @@ SchedulerUtils::TaskBatteryInfo SchedulerUtils::calculateTaskBatteryConsumption(
     double currentBattery,
     const BatteryConfig& config
 ) {
-    TaskBatteryInfo info;
-    double percentageConsumePerSecond = 100.0 / config.batteryLifeSpan;
-    
-    // Calculate travel to origin (empty robot, uses alpha)
-    info.distanceToOrigin = calculateDistance(currentPos, originNode->coordinates);
-    info.timeToOrigin = info.distanceToOrigin / config.robotSpeed;
-    info.batteryToOrigin = info.timeToOrigin * percentageConsumePerSecond * config.alpha;
-    
-    // Calculate task execution (loaded robot, no alpha)
-    info.distanceForTask = calculateDistance(originNode->coordinates, destNode->coordinates);
-    info.timeForTask = info.distanceForTask / config.robotSpeed;
-    info.batteryForTask = info.timeForTask * percentageConsumePerSecond;
-    
-    // Calculate totals
-    info.totalBatteryNeeded = info.batteryToOrigin + info.batteryForTask;
-    info.batteryAfterTask = currentBattery - info.totalBatteryNeeded;
-    
-    return info;
+    return taskBatteryFromDistances(
+        calculateDistance(currentPos, originNode->coordinates),
+        calculateDistance(originNode->coordinates, destNode->coordinates),
+        currentBattery, config
+    );
+}
+
+SchedulerUtils::TaskBatteryInfo SchedulerUtils::calculateTaskBatteryConsumption(
+    const DistanceOracle& oracle,
+    int currentLocation,
+    int originLocation,
+    int destLocation,
+    double currentBattery,
+    const BatteryConfig& config
+) {
+    return taskBatteryFromDistances(
+        oracle.distance(currentLocation, originLocation),
+        oracle.distance(originLocation, destLocation),
+        currentBattery, config
+    );
 }
 
 bool SchedulerUtils::shouldCharge(double batteryAfterTask, double threshold) {
@@ -68,22 +117,24 @@ void SchedulerUtils::performCharging(
     const Graph::Node* chargingNode = graph.getNode(chargingNodeId);
     if (!chargingNode) return;
     
-    double percentageConsumePerSecond = 100.0 / config.batteryLifeSpan;
+    chargeAfterTravel(calculateDistance(currentPos, chargingNode->coordinates), currentBattery, totalTime, config);
     
-    // 1. Travel to charging station
-    double distToCharging = calculateDistance(currentPos, chargingNode->coordinates);
-    double timeToCharging = distToCharging / config.robotSpeed;
-    
-    // Update battery for travel to charging station (without load, uses alpha)
-    currentBattery -= timeToCharging * percentageConsumePerSecond * config.alpha;
-    totalTime += timeToCharging;
+    // 3. Update position to charging station
+    currentPos = chargingNode->coordinates;
+}
+
+void SchedulerUtils::performCharging(
+    int& currentLocation,
+    double& currentBattery,
+    double& totalTime,
+    const DistanceOracle& oracle,
+    const BatteryConfig& config
+) {
+    int charger = oracle.chargerLocation();
+    if (charger < 0) return;
     
-    // 2. Charge battery to full
-    double batteryNeeded = config.fullBattery - currentBattery;
-    double chargingTime = batteryNeeded / config.batteryRechargeRate;
-    currentBattery = config.fullBattery;
-    totalTime += chargingTime;
+    chargeAfterTravel(oracle.distanceToCharger(currentLocation), currentBattery, totalTime, config);
     
     // 3. Update position to charging station
-    currentPos = chargingNode->coordinates;
+    currentLocation = charger;
 }
@@ -6,44 +6,53 @@
 double TSPSolver::findOptimalSequenceTime(
     const Robot& robot,
     const std::vector<Task>& tasks,
-    const Graph& graph
+    const DistanceOracle& oracle
 ) {
     if (tasks.empty()) {
         return 0.0;
     }
+    if (static_cast<int>(tasks.size()) <= MAX_TABLE_TASKS) {
+        SequenceTable table(robot, tasks, oracle);
+        return table.solve((1u << tasks.size()) - 1);
+    }
+
+    // Beyond the table's reach: every permutation
 
     std::vector<Task> permutableTasks = tasks;
     std::sort(permutableTasks.begin(), permutableTasks.end());
 
     double minTimeForThisRobot = std::numeric_limits<double>::max();
     SchedulerUtils::BatteryConfig config(robot);
-    int chargingNodeId = SchedulerUtils::getChargingNodeId(graph);
+    int startLocation = oracle.positionLocation(robot.getPosition());
+    if (startLocation < 0) {
+        return minTimeForThisRobot;
+    }
 
     do {
         double timeForThisPermutation = 0.0;
         double currentBattery = robot.getBatteryLevel();
-        std::pair<double, double> currentPos = robot.getPosition();
+        int currentLocation = startLocation;
         bool validPermutation = true;
 
         for (const auto& task : permutableTasks) {
-            const Graph::Node* originNode = graph.getNode(task.getOriginNode());
-            const Graph::Node* destNode = graph.getNode(task.getDestinationNode());
+            int originLocation = oracle.nodeLocation(task.getOriginNode());
+            int destLocation = oracle.nodeLocation(task.getDestinationNode());
             
-            if (!originNode || !destNode) {
+            if (originLocation < 0 || destLocation < 0) {
                 validPermutation = false;
                 break;
             }
 
             SchedulerUtils::TaskBatteryInfo taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                currentPos, originNode, destNode, currentBattery, config
+                oracle, currentLocation, originLocation, destLocation, currentBattery, config
             );
 
-            if (chargingNodeId != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
-                SchedulerUtils::performCharging(currentPos, currentBattery, timeForThisPermutation, 
-                                                chargingNodeId, graph, config);
+            if (oracle.chargerLocation() != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
+                SchedulerUtils::performCharging(currentLocation, currentBattery, timeForThisPermutation, 
+                                                oracle, config);
                 
                 taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
-                    currentPos, originNode, destNode, currentBattery, config
+                    oracle, currentLocation, originLocation, destLocation, currentBattery, config
                 );
             }
             
@@ -54,7 +63,7 @@ double TSPSolver::findOptimalSequenceTime(
 
             timeForThisPermutation += taskInfo.timeToOrigin + taskInfo.timeForTask;
             currentBattery -= taskInfo.totalBatteryNeeded;
-            currentPos = destNode->coordinates;
+            currentLocation = destLocation;
         }
 
         if (validPermutation && timeForThisPermutation < minTimeForThisRobot) {
@@ -65,3 +74,192 @@ double TSPSolver::findOptimalSequenceTime(
 
     return minTimeForThisRobot;
 }
+
+
+// --- SequenceTable ---
+
+TSPSolver::SequenceTable::SequenceTable(const Robot& robot, const std::vector<Task>& tasks,
+                                        const DistanceOracle& oracle)
+    : robot(robot),
+      oracle(oracle),
+      config(robot),
+      numTasks(static_cast<int>(tasks.size())),
+      startLocation(oracle.positionLocation(robot.getPosition())),
+      invalidMask(0) {
+    const int n = numTasks;
+    const double INF = std::numeric_limits<double>::max();
+
+    originLocation.assign(n, -1);
+    destLocation.assign(n, -1);
+    for (int i = 0; i < n; ++i) {
+        originLocation[i] = oracle.nodeLocation(tasks[i].getOriginNode());
+        destLocation[i] = oracle.nodeLocation(tasks[i].getDestinationNode());
+        if (originLocation[i] < 0 || destLocation[i] < 0 || startLocation < 0) invalidMask |= 1u << i;
+    }
+
+    loadedTime.assign(n, 0.0);
+    startTime.assign(n, 0.0);
+    linkTime.assign(static_cast<size_t>(n) * n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        if (invalidMask & (1u << i)) continue;
+        loadedTime[i] = oracle.distance(originLocation[i], destLocation[i]) / config.robotSpeed;
+        startTime[i] = oracle.distance(startLocation, originLocation[i]) / config.robotSpeed;
+        for (int j = 0; j < n; ++j) {
+            if (invalidMask & (1u << j)) continue;
+            linkTime[i * n + j] = oracle.distance(destLocation[i], originLocation[j]) / config.robotSpeed;
+        }
+    }
+
+    // Held-Karp: dp[mask][last] = best time covering mask and ending with last
+    const uint32_t full = 1u << n;
+    dp.assign(static_cast<size_t>(full) * n, INF);
+    bestByMask.assign(full, INF);
+    bestByMask[0] = 0.0;
+    for (int j = 0; j < n; ++j) {
+        dp[(size_t(1) << j) * n + j] = startTime[j] + loadedTime[j];
+    }
+    for (uint32_t mask = 1; mask < full; ++mask) {
+        double best = INF;
+        for (int last = 0; last < n; ++last) {
+            if (!(mask & (1u << last))) continue;
+            double value = dp[size_t(mask) * n + last];
+            if (value == INF) continue;
+            if (value < best) best = value;
+            for (int next = 0; next < n; ++next) {
+                if (mask & (1u << next)) continue;
+                double& slot = dp[size_t(mask | (1u << next)) * n + next];
+                double candidate = value + linkTime[last * n + next] + loadedTime[next];
+                if (candidate < slot) slot = candidate;
+            }
+        }
+        bestByMask[mask] = best;
+    }
+}
+
+std::vector<int> TSPSolver::SequenceTable::heldKarpOrder(uint32_t mask) const {
+    const int n = numTasks;
+    std::vector<int> order;
+    if (mask == 0) return order;
+
+    int last = -1;
+    for (int j = 0; j < n; ++j) {
+        if ((mask & (1u << j)) && (last < 0 || dp[size_t(mask) * n + j] < dp[size_t(mask) * n + last])) last = j;
+    }
+    while (true) {
+        order.push_back(last);
+        uint32_t rest = mask & ~(1u << last);
+        if (rest == 0) break;
+        // The predecessor that produced dp[mask][last]
+        int previous = -1;
+        double previousValue = std::numeric_limits<double>::max();
+        for (int k = 0; k < n; ++k) {
+            if (!(rest & (1u << k))) continue;
+            double value = dp[size_t(rest) * n + k] + linkTime[k * n + last];
+            if (value < previousValue) {
+                previousValue = value;
+                previous = k;
+            }
+        }
+        mask = rest;
+        last = previous;
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+bool TSPSolver::SequenceTable::runTask(int task, int& location, double& battery,
+                                       double& time, bool& charged) const {
+    SchedulerUtils::TaskBatteryInfo taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
+        oracle, location, originLocation[task], destLocation[task], battery, config
+    );
+
+    if (oracle.chargerLocation() != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
+        SchedulerUtils::performCharging(location, battery, time, oracle, config);
+        taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(
+            oracle, location, originLocation[task], destLocation[task], battery, config
+        );
+        charged = true;
+    }
+
+    if (taskInfo.batteryAfterTask < 0) {
+        return false;
+    }
+
+    time += taskInfo.timeToOrigin + taskInfo.timeForTask;
+    battery -= taskInfo.totalBatteryNeeded;
+    location = destLocation[task];
+    return true;
+}
+
+double TSPSolver::SequenceTable::simulate(const std::vector<int>& order, bool& charged) const {
+    int location = startLocation;
+    double battery = robot.getBatteryLevel();
+    double time = 0.0;
+    charged = false;
+    for (int task : order) {
+        if (!runTask(task, location, battery, time, charged)) return std::numeric_limits<double>::max();
+    }
+    return time;
+}
+
+void TSPSolver::SequenceTable::search(uint32_t remaining, int location, double battery,
+                                      double time, std::vector<int>& current, double& best,
+                                      std::vector<int>& bestOrder, double target) const {
+    if (remaining == 0) {
+        if (time < best) {
+            best = time;
+            bestOrder = current;
+        }
+        return;
+    }
+    if (best <= target) return;     // Already matches the lower bound
+
+    // Every remaining task still needs its loaded leg, and the next one an approach
+    double rest = 0.0;
+    double approach = std::numeric_limits<double>::max();
+    for (int j = 0; j < numTasks; ++j) {
+        if (!(remaining & (1u << j))) continue;
+        rest += loadedTime[j];
+        approach = std::min(approach, oracle.distance(location, originLocation[j]) / config.robotSpeed);
+    }
+    if (time + rest + approach >= best) return;
+
+    // Nearest first, so good sequences are found early
+    std::vector<std::pair<double, int>> candidates;
+    for (int j = 0; j < numTasks; ++j) {
+        if (!(remaining & (1u << j))) continue;
+        candidates.push_back({oracle.distance(location, originLocation[j]), j});
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const auto& candidate : candidates) {
+        int j = candidate.second;
+        int nextLocation = location;
+        double nextBattery = battery;
+        double nextTime = time;
+        bool charged = false;
+        if (!runTask(j, nextLocation, nextBattery, nextTime, charged)) continue;
+        current.push_back(j);
+        search(remaining & ~(1u << j), nextLocation, nextBattery, nextTime, current, best, bestOrder, target);
+        current.pop_back();
+    }
+}
+
+double TSPSolver::SequenceTable::solve(uint32_t mask, std::vector<int>* order) const {
+    if (order) order->clear();
+    if (mask == 0) return 0.0;
+    if (mask & invalidMask) return std::numeric_limits<double>::max();
+
+    std::vector<int> bestOrder = heldKarpOrder(mask);
+    bool charged = false;
+    double best = simulate(bestOrder, charged);
+    if (charged || best == std::numeric_limits<double>::max()) {
+        // The battery changed the picture: search the orderings for the real optimum
+        std::vector<int> current;
+        search(mask, startLocation, robot.getBatteryLevel(), 0.0, current, best, bestOrder,
+               bestByMask[mask]);
+    }
+
+    if (order && best != std::numeric_limits<double>::max()) *order = bestOrder;
+    return best;
+}
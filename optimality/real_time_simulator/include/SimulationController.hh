@@ -7,6 +7,7 @@
 #include <mutex>
 #include <chrono>
 #include <queue>
+#include <map>
 #include <vector>
 #include "Planifier.hh"
 #include "Graph.hh"
@@ -24,6 +25,11 @@
  * - Main thread: Runs the simulation loop (updateRobots, updateScheduler)
  * - Input thread: Handles user commands asynchronously
  * - Uses Planifier as a library for state management and scheduling
+ *
+ * In time-warp mode there is no input thread and no wall clock: simulation
+ * time jumps from one event (a robot finishing its tasks, a task arriving)
+ * to the next, and the scheduler runs only at those events, so a whole task
+ * stream is played out as fast as the scheduler can plan it.
  */
 class SimulationController {
 public:
@@ -85,6 +91,26 @@ public:
      */
     void addTask(const Task& task);
 
+    /**
+     * @brief Add a task to the pending queue when simulation time reaches arrivalTime
+     * 
+     * Call before start().
+     * 
+     * @param arrivalTime Simulation time of the arrival (seconds)
+     * @param task The task to add
+     */
+    void scheduleTaskArrival(double arrivalTime, const Task& task);
+
+    /**
+     * @brief Run as a discrete-event simulation instead of in real time
+     * 
+     * Call before start(). start() then returns once every task is done
+     * and no more are due to arrive.
+     * 
+     * @param enabled true for time warp, false for real time (default)
+     */
+    void setTimeWarp(bool enabled);
+
     /**
      * @brief Get current simulation statistics
      */
@@ -103,6 +129,18 @@ private:
     int schedulingAlgorithm;    // Current algorithm choice (1-3)
     double schedulerInterval;   // How often to run scheduler (seconds)
     double lastSchedulerRun;    // Last time scheduler was executed
+    bool timeWarp;              // Jump between events instead of following the wall clock
+    
+    // A busy robot as its current assignment leaves it
+    struct RobotCompletion {
+        int robotId;
+        double finishTime;                      // Simulation time it finishes its tasks
+        int numTasks;
+        std::pair<double, double> position;     // Where it ends up
+        double batteryLevel;
+    };
+    std::vector<RobotCompletion> activeRobots;
+    std::multimap<double, Task> taskArrivals;   // By arrival time
     
     // Threading
     std::thread inputThread;
@@ -122,9 +160,35 @@ private:
      */
     void simulationLoop();
     
+    /**
+     * @brief Time-warp simulation loop
+     * 
+     * Advances to the next event, applies it and runs the scheduler, until
+     * no events remain or the simulation is stopped
+     */
+    void timeWarpLoop();
+    
+    /**
+     * @brief Time of the next robot completion or task arrival
+     * 
+     * @return Simulation time of the event, infinity if there is none
+     */
+    double nextEventTime() const;
+    
+    /**
+     * @brief Record when each robot given tasks by a scheduler cycle finishes them
+     * 
+     * @param robots The robots the cycle planned for, in assignment order
+     * @param result The cycle's result
+     */
+    void trackAssignment(const std::vector<Robot>& robots, const AlgorithmResult& result);
+    
     /**
      * @brief Update all robots' states
      * 
+     * Frees the robots that have finished their tasks by the current
+     * simulation time and adds the tasks that have arrived by then.
+     * 
      * @param deltaTime Time elapsed since last update
      */
     void updateRobots(double deltaTime);
@@ -3,6 +3,7 @@
 #include <queue>
 #include <sstream>
 #include <string>
+#include <vector>
 #include "SimulationController.hh"
 #include "Graph.hh"
 #include "Task.hh"
@@ -77,7 +78,7 @@ queue<Task> loadTasks(int graphId, int numTasks) {
 void printUsage(const char* programName) {
     cout << "=== Real-Time Warehouse Simulation ===" << endl;
     cout << endl;
-    cout << "Usage: " << programName << " <graphId> [numRobots] [numTasks]" << endl;
+    cout << "Usage: " << programName << " <graphId> [numRobots] [numTasks] [arrivalInterval] [--warp]" << endl;
     cout << endl;
     cout << "Arguments:" << endl;
     cout << "  graphId    - Graph identifier (1-10)" << endl;
@@ -85,12 +86,18 @@ void printUsage(const char* programName) {
     cout << "  numTasks   - Number of initial tasks to load (e.g., 10, 12, 15)" << endl;
     cout << "               Loads from test_data/graph<N>/<numTasks>_tasks.inp" << endl;
     cout << "               (default: none - start with empty task queue)" << endl;
+    cout << "  arrivalInterval - Seconds between the loaded tasks' arrivals" << endl;
+    cout << "               (default: 0 - all tasks present at the start)" << endl;
+    cout << "  --warp     - Time warp: jump from event to event (robot finishing," << endl;
+    cout << "               task arriving) instead of running in real time, and" << endl;
+    cout << "               exit once everything is done" << endl;
     cout << endl;
     cout << "Examples:" << endl;
     cout << "  " << programName << " 1                # Graph 1, 5 robots, no initial tasks" << endl;
     cout << "  " << programName << " 3 10             # Graph 3, 10 robots, no initial tasks" << endl;
     cout << "  " << programName << " 1 5 10           # Graph 1, 5 robots, load 10 tasks" << endl;
     cout << "  " << programName << " 1 8 15           # Graph 1, 8 robots, load 15 tasks" << endl;
+    cout << "  " << programName << " 1 5 1000 30 --warp # Graph 1, 5 robots, 1000 tasks, one every 30s, time warp" << endl;
     cout << endl;
     cout << "During simulation, type 'help' for available commands." << endl;
     cout << "=======================================" << endl;
@@ -103,15 +110,26 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
-    // Parse command line arguments
-    if (argc < 2) {
+    // Parse command line arguments (--warp may appear anywhere)
+    bool timeWarp = false;
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--warp") {
+            timeWarp = true;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    
+    if (args.empty()) {
         printUsage(argv[0]);
         return 1;
     }
     
-    int graphId = atoi(argv[1]);
-    int numRobots = (argc >= 3) ? atoi(argv[2]) : 5;
-    int numTasks = (argc >= 4) ? atoi(argv[3]) : -1;
+    int graphId = atoi(args[0].c_str());
+    int numRobots = (args.size() >= 2) ? atoi(args[1].c_str()) : 5;
+    int numTasks = (args.size() >= 3) ? atoi(args[2].c_str()) : -1;
+    double arrivalInterval = (args.size() >= 4) ? atof(args[3].c_str()) : 0.0;
     
     // Validate inputs
     if (graphId < 1 || graphId > 10) {
@@ -124,6 +142,11 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (arrivalInterval < 0) {
+        cerr << "Error: arrivalInterval must not be negative" << endl;
+        return 1;
+    }
+    
     // Load graph
     cout << "Loading graph " << graphId << "..." << endl;
     Graph graph = loadGraph(graphId);
@@ -141,10 +164,20 @@ int main(int argc, char* argv[]) {
     
     cout << endl;
     
+    // With an arrival interval the loaded tasks arrive over time instead
+    queue<Task> arrivingTasks;
+    if (arrivalInterval > 0) {
+        swap(arrivingTasks, initialTasks);
+    }
+    
     // Create and start simulation controller
     SimulationController controller(graph, numRobots, initialTasks);
+    controller.setTimeWarp(timeWarp);
+    for (int i = 0; !arrivingTasks.empty(); i++, arrivingTasks.pop()) {
+        controller.scheduleTaskArrival(i * arrivalInterval, arrivingTasks.front());
+    }
     
-    // Start the simulation (this blocks until user quits)
+    // Start the simulation (this blocks until user quits, or in time warp until all tasks are done)
     controller.start();
     
     return 0;
@@ -2,13 +2,48 @@
 #include "algorithms/01_BruteForce.hh"
 #include "algorithms/02_Greedy.hh"
 #include "algorithms/03_HillClimbing.hh"
+#include "algorithms/utils/SchedulerUtils.hh"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <limits>
 #include <string>
 
 using namespace std;
 
+namespace {
+    // Runs a robot's tasks in order as the planners cost them (charging when
+    // a task would leave the battery low); leaves the robot at the end of the
+    // last one and returns the time taken
+    double runSequence(const Graph& graph, Robot& robot, const vector<Task>& tasks) {
+        SchedulerUtils::BatteryConfig config(robot);
+        int chargingNodeId = SchedulerUtils::getChargingNodeId(graph);
+        pair<double, double> position = robot.getPosition();
+        double battery = robot.getBatteryLevel();
+        double time = 0.0;
+
+        for (const Task& task : tasks) {
+            const Graph::Node* origin = graph.getNode(task.getOriginNode());
+            const Graph::Node* destination = graph.getNode(task.getDestinationNode());
+            if (!origin || !destination) continue;
+
+            auto taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(position, origin, destination, battery, config);
+            if (chargingNodeId != -1 && SchedulerUtils::shouldCharge(taskInfo.batteryAfterTask, config.lowBatteryThreshold)) {
+                SchedulerUtils::performCharging(position, battery, time, chargingNodeId, graph, config);
+                taskInfo = SchedulerUtils::calculateTaskBatteryConsumption(position, origin, destination, battery, config);
+            }
+
+            time += taskInfo.timeToOrigin + taskInfo.timeForTask;
+            battery -= taskInfo.totalBatteryNeeded;
+            position = destination->coordinates;
+        }
+
+        robot.setPosition(position);
+        robot.setBatteryLevel(battery);
+        return time;
+    }
+}
+
 SimulationController::SimulationController(
     const Graph& graph, 
     int numRobots, 
@@ -22,6 +57,7 @@ SimulationController::SimulationController(
     schedulingAlgorithm(2),  // Default to Greedy
     schedulerInterval(5.0),  // Run scheduler every 5 seconds
     lastSchedulerRun(0.0),
+    timeWarp(false),
     tasksCompleted(0),
     tasksAdded(initialTasks.size()),
     schedulerCycles(0)
@@ -36,6 +72,9 @@ SimulationController::SimulationController(
 SimulationController::~SimulationController() {
     if (running) {
         stop();
+    } else if (inputThread.joinable()) {
+        // Stopped by the quit command; the input thread has seen it
+        inputThread.join();
     }
 }
 
@@ -54,6 +93,16 @@ void SimulationController::start() {
     cout << "Graph: " << graph.getNumVertices() << " nodes" << endl;
     cout << "Robots: " << planifier->getNumRobots() << endl;
     cout << "Initial Tasks: " << tasksAdded << endl;
+    cout << "Scheduled Arrivals: " << taskArrivals.size() << endl;
+    if (timeWarp) {
+        cout << "Mode: Time warp (scheduler runs at each completion or arrival)" << endl;
+        cout << "========================================" << endl;
+        cout << endl;
+        
+        timeWarpLoop();
+        stop();
+        return;
+    }
     cout << "Time Step: " << timeStep << "s" << endl;
     cout << "Scheduler Interval: " << schedulerInterval << "s" << endl;
     cout << endl;
@@ -127,17 +176,7 @@ void SimulationController::setSchedulingAlgorithm(int algorithmChoice) {
 void SimulationController::addTask(const Task& task) {
     lock_guard<mutex> lock(taskMutex);
     
-    // Get current pending tasks, add new one, update planifier
-    queue<Task> currentTasks = planifier->getPendingTasks();
-    currentTasks.push(task);
-    
-    // Update the planifier's task queue
-    // Note: This is a simplified approach. In a real implementation,
-    // you might want to add a method to Planifier to add tasks directly
-    planifier->setPendingTasks(currentTasks.size());
-    while (!currentTasks.empty()) {
-        currentTasks.pop();
-    }
+    planifier->addTask(task);
     
     tasksAdded++;
     
@@ -146,6 +185,15 @@ void SimulationController::addTask(const Task& task) {
          << " (" << task.getOriginNode() << " -> " << task.getDestinationNode() << ")" << endl;
 }
 
+void SimulationController::scheduleTaskArrival(double arrivalTime, const Task& task) {
+    lock_guard<mutex> lock(taskMutex);
+    taskArrivals.emplace(arrivalTime, task);
+}
+
+void SimulationController::setTimeWarp(bool enabled) {
+    timeWarp = enabled;
+}
+
 void SimulationController::printStatus() const {
     lock_guard<mutex> lock(statusMutex);
     
@@ -196,22 +244,87 @@ void SimulationController::simulationLoop() {
     }
 }
 
-void SimulationController::updateRobots(double deltaTime) {
-    // This is a placeholder for robot state updates
-    // In a full implementation, this would:
-    // 1. Move robots along their paths
-    // 2. Update battery levels
-    // 3. Detect task completions
-    // 4. Move robots between queues (busy -> available, available -> charging, etc.)
-    
-    // For now, we'll just update battery levels as a demonstration
-    // Note: This would require access to robot queues and methods to update them
-    
-    // TODO: Implement robot movement and state transitions
-    // This requires either:
-    // - Making Planifier expose its robot queues
-    // - Adding update methods to Planifier
-    // - Implementing robot state management here
+void SimulationController::timeWarpLoop() {
+    auto wallStart = chrono::high_resolution_clock::now();
+    
+    // Tasks present (or due) at the start
+    updateRobots(0.0);
+    runSchedulerCycle();
+    
+    while (running) {
+        double nextEvent = nextEventTime();
+        if (nextEvent == numeric_limits<double>::infinity()) {
+            break;
+        }
+        
+        double deltaTime = nextEvent - simulationTime;
+        simulationTime = nextEvent;
+        updateRobots(deltaTime);
+        runSchedulerCycle();
+    }
+    
+    chrono::duration<double> wallElapsed = chrono::high_resolution_clock::now() - wallStart;
+    cout << endl;
+    cout << "[T=" << fixed << setprecision(1) << simulationTime << "s] No more events ("
+         << planifier->getPendingTasks().size() << " tasks left unassigned). Simulated in "
+         << setprecision(3) << wallElapsed.count() << "s of wall time." << endl;
+}
+
+double SimulationController::nextEventTime() const {
+    lock_guard<mutex> lock(taskMutex);
+    
+    double next = numeric_limits<double>::infinity();
+    for (const RobotCompletion& completion : activeRobots) {
+        next = min(next, completion.finishTime);
+    }
+    if (!taskArrivals.empty()) {
+        next = min(next, taskArrivals.begin()->first);
+    }
+    return next;
+}
+
+void SimulationController::updateRobots(double /*deltaTime*/) {
+    vector<Task> arrived;
+    {
+        lock_guard<mutex> lock(taskMutex);
+        
+        // Robots done with their assignment become available where it left them
+        for (size_t i = 0; i < activeRobots.size();) {
+            const RobotCompletion& completion = activeRobots[i];
+            if (completion.finishTime > simulationTime) {
+                ++i;
+                continue;
+            }
+            planifier->releaseRobot(completion.robotId, completion.position, completion.batteryLevel);
+            tasksCompleted += completion.numTasks;
+            cout << "[T=" << fixed << setprecision(1) << simulationTime << "s] Robot " << completion.robotId
+                 << " finished " << completion.numTasks << " task(s)" << endl;
+            activeRobots[i] = activeRobots.back();
+            activeRobots.pop_back();
+        }
+        
+        while (!taskArrivals.empty() && taskArrivals.begin()->first <= simulationTime) {
+            arrived.push_back(taskArrivals.begin()->second);
+            taskArrivals.erase(taskArrivals.begin());
+        }
+    }
+    
+    for (const Task& task : arrived) {
+        addTask(task);
+    }
+}
+
+void SimulationController::trackAssignment(const vector<Robot>& robots, const AlgorithmResult& result) {
+    for (size_t i = 0; i < robots.size() && i < result.assignment.size(); ++i) {
+        if (result.assignment[i].empty()) {
+            continue;
+        }
+        Robot robot = robots[i];
+        double duration = runSequence(graph, robot, result.assignment[i]);
+        activeRobots.push_back({robot.getId(), simulationTime + duration,
+                                static_cast<int>(result.assignment[i].size()),
+                                robot.getPosition(), robot.getBatteryLevel()});
+    }
 }
 
 void SimulationController::runSchedulerCycle() {
@@ -226,8 +339,15 @@ void SimulationController::runSchedulerCycle() {
     cout << "[T=" << fixed << setprecision(1) << simulationTime 
          << "s] ========== SCHEDULER CYCLE " << (schedulerCycles + 1) << " ==========" << endl;
     
+    // The robots being planned for, in the order the assignment lists them
+    vector<Robot> robots;
+    for (queue<Robot> available = planifier->getAvailableRobotQueue(); !available.empty(); available.pop()) {
+        robots.push_back(available.front());
+    }
+    
     // Execute the current algorithm
     AlgorithmResult result = planifier->executePlan();
+    trackAssignment(robots, result);
     
     schedulerCycles++;
     
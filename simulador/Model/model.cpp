@@ -13,6 +13,10 @@
 #include <iostream>
 #include <cmath>
 #include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <map>
 using namespace std;
 // === Local stuff:
 static int material = 1;
@@ -20,29 +24,51 @@ static void loadMTL(std::string filename);
 static int findMat(string material);
 static void omplenormals(vector<Face> &_faces, 
 			 vector<Vertex> const &_vertices);
-static void ompleVBOs(vector<Face> &_faces, 
-	              vector<Vertex> const &_vertices,
-	              vector<Normal> const &_normals,
-		      float *&_VBO_vert, float *&_VBO_norm,
-		      float *&_VBO_mata, float *&_VBO_matd, float *&_VBO_matsp, float *&_VBO_matsh);
+static void ompleVBO(vector<Face> &_faces, 
+	             vector<Vertex> const &_vertices,
+	             vector<Normal> const &_normals,
+		     vector<float> &_VBO);
 
 static bool fvtn = false;
 static bool fvt = false;
 static bool texcoord = false;
 static string modelPath("");
+static vector<string> mtlFiles;   // MTL files read by the current load()
+
+// Binary cache: "MBIN", version, the OBJ's stamp, the MTL files' names and
+// stamps, the triangle count, the bounds and the interleaved VBO
+static const char CACHE_MAGIC[4] = {'M', 'B', 'I', 'N'};
+static const uint32_t CACHE_VERSION = 1;
+
+struct FileStamp {
+  int64_t mtime;
+  int64_t size;
+};
+
+static bool fileStamp(const string &filename, FileStamp &stamp) {
+  struct stat info;
+  if (stat(filename.c_str(), &info) != 0) return false;
+  stamp.mtime = (int64_t) info.st_mtime;
+  stamp.size = (int64_t) info.st_size;
+  return true;
+}
+
+template <typename T>
+static bool readRaw(istream &input, T &value) {
+  return (bool) input.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+template <typename T>
+static void writeRaw(ostream &output, const T &value) {
+  output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
 
 // ======== Constructors and Destructors =======
-Model::Model() : _vertices(0), _normals(0), _faces(0) {
-  _VBO_vertices = _VBO_normals = _VBO_matamb = _VBO_matdiff = _VBO_matspec = _VBO_matshin = NULL;
+Model::Model() : _vertices(0), _normals(0), _faces(0), _numTriangles(0), _numLODTriangles(0) {
+  for (int i = 0; i < 3; ++i) _boundsMin[i] = _boundsMax[i] = 0;
 }
 
 Model::~Model() {
-  if (_VBO_vertices != NULL) delete _VBO_vertices;
-  if (_VBO_normals != NULL) delete _VBO_normals;
-  if (_VBO_matamb != NULL) delete _VBO_matamb;
-  if (_VBO_matdiff != NULL) delete _VBO_matdiff;
-  if (_VBO_matspec != NULL) delete _VBO_matspec;
-  if (_VBO_matshin != NULL) delete _VBO_matshin;
 }
 
 Material::Material() : name("__load_object_default_material__") {
@@ -54,12 +80,19 @@ Material::Material() : name("__load_object_default_material__") {
 
 // ========= Public methods ==========
 void Model::load(std::string filename) {
-  if (! _vertices.empty()) {
-    // unload previous model:
-    _vertices.erase(_vertices.begin(), _vertices.end());
-    _normals.erase(_normals.begin(), _normals.end());
-    _faces.erase(_faces.begin(), _faces.end());
+  // unload previous model:
+  _vertices.clear();
+  _normals.clear();
+  _faces.clear();
+  _VBO.clear();
+  _numTriangles = 0;
+
+  const string cacheName = filename + ".mbin";
+  if (loadCache(cacheName)) {
+    buildLOD(MODEL_LOD_CELLS);
+    return;
   }
+
   size_t fiPath = filename.rfind("/");
   if (fiPath == string::npos) modelPath = "";
   else modelPath = filename.substr(0, fiPath+1);
@@ -69,6 +102,7 @@ void Model::load(std::string filename) {
     cerr << "Cannot load OBJ file " << filename << endl;
     return;
   }
+  mtlFiles.clear();
   string line;
   stringstream ss;
   while (getline(input, line)) {
@@ -168,9 +202,13 @@ void Model::load(std::string filename) {
   }
   omplenormals(_faces, _vertices);  // afegim normals per cara...
 
-  // Omplim els vectors per als VBO
-  ompleVBOs(_faces, _vertices, _normals, _VBO_vertices, _VBO_normals, 
-            _VBO_matamb, _VBO_matdiff, _VBO_matspec, _VBO_matshin);
+  // Omplim el vector per al VBO
+  ompleVBO(_faces, _vertices, _normals, _VBO);
+  _numTriangles = _faces.size();
+  computeBounds();
+  buildLOD(MODEL_LOD_CELLS);
+
+  saveCache(cacheName, mtlFiles);
 }
 
 // ======= helper methods for checking and debugging ==========
@@ -211,6 +249,146 @@ void Model::dumpModel() const {
 }
 
 //======== private methods and auxiliary functions ==========
+void Model::computeBounds() {
+  if (_vertices.empty()) return;
+  for (int j = 0; j < 3; ++j) _boundsMin[j] = _boundsMax[j] = _vertices[j];
+  for (unsigned int i = 3; i < _vertices.size(); i += 3) {
+    for (int j = 0; j < 3; ++j) {
+      if (_vertices[i+j] < _boundsMin[j]) _boundsMin[j] = _vertices[i+j];
+      if (_vertices[i+j] > _boundsMax[j]) _boundsMax[j] = _vertices[i+j];
+    }
+  }
+}
+
+// Vertex clustering: every vertex moves to the mean of the vertices in its
+// grid cell, and triangles left with two corners in one cell are dropped.
+// Normals and materials stay per vertex, so shading keeps its look.
+void Model::buildLOD(int cellsPerSide) {
+  _LODVBO.clear();
+  _numLODTriangles = 0;
+  if (_numTriangles == 0) return;
+
+  float extent = 0;
+  for (int j = 0; j < 3; ++j) extent = max(extent, _boundsMax[j] - _boundsMin[j]);
+  if (extent <= 0) return;
+  const float cellSize = extent / cellsPerSide;
+
+  const unsigned int vertices = _numTriangles * 3;
+  vector<long> cellOf(vertices);
+  map<long, unsigned int> cellIndex;
+  vector<float> sums;     // x, y, z, count per cell
+  for (unsigned int v = 0; v < vertices; ++v) {
+    const float *position = &_VBO[v * MODEL_VERTEX_FLOATS];
+    long key = 0;
+    for (int j = 0; j < 3; ++j) {
+      long cell = (long) ((position[j] - _boundsMin[j]) / cellSize);
+      cell = min(max(cell, 0L), (long) cellsPerSide);
+      key = key * (cellsPerSide + 1) + cell;
+    }
+    map<long, unsigned int>::iterator it = cellIndex.find(key);
+    if (it == cellIndex.end()) {
+      it = cellIndex.insert(make_pair(key, (unsigned int) (sums.size() / 4))).first;
+      sums.resize(sums.size() + 4, 0.0f);
+    }
+    float *sum = &sums[it->second * 4];
+    for (int j = 0; j < 3; ++j) sum[j] += position[j];
+    sum[3] += 1;
+    cellOf[v] = it->second;
+  }
+
+  for (unsigned int t = 0; t < _numTriangles; ++t) {
+    const long a = cellOf[3*t], b = cellOf[3*t+1], c = cellOf[3*t+2];
+    if (a == b || b == c || a == c) continue;
+    for (int i = 0; i < 3; ++i) {
+      const float *source = &_VBO[(3*t+i) * MODEL_VERTEX_FLOATS];
+      const float *sum = &sums[cellOf[3*t+i] * 4];
+      _LODVBO.insert(_LODVBO.end(), source, source + MODEL_VERTEX_FLOATS);
+      float *vertex = &_LODVBO[_LODVBO.size() - MODEL_VERTEX_FLOATS];
+      for (int j = 0; j < 3; ++j) vertex[j] = sum[j] / sum[3];
+    }
+    ++_numLODTriangles;
+  }
+}
+
+// The cache was written from this OBJ and these MTL files, unchanged since
+bool Model::loadCache(const string & cacheName) {
+  fstream input(cacheName.data(), ios::in | ios::binary);
+  if (input.rdstate() != ios::goodbit) return false;
+
+  char magic[4];
+  uint32_t version;
+  if (!input.read(magic, 4) || memcmp(magic, CACHE_MAGIC, 4) != 0) return false;
+  if (!readRaw(input, version) || version != CACHE_VERSION) return false;
+
+  // Source files: the OBJ first, then its MTL files
+  uint32_t sources;
+  if (!readRaw(input, sources) || sources == 0) return false;
+  for (uint32_t s = 0; s < sources; ++s) {
+    uint32_t length;
+    FileStamp cached, current;
+    if (!readRaw(input, length) || length > 4096) return false;
+    string name(length, ' ');
+    if (length > 0 && !input.read(&name[0], length)) return false;
+    if (!readRaw(input, cached.mtime) || !readRaw(input, cached.size)) return false;
+    if (s == 0) name = cacheName.substr(0, cacheName.size() - 5);   // The OBJ moves with its cache
+    if (!fileStamp(name, current)) return false;
+    if (current.mtime != cached.mtime || current.size != cached.size) return false;
+  }
+
+  uint32_t triangles;
+  if (!readRaw(input, triangles)) return false;
+  if (!readRaw(input, _boundsMin) || !readRaw(input, _boundsMax)) return false;
+  vector<float> data((size_t) triangles * 3 * MODEL_VERTEX_FLOATS);
+  if (!data.empty() && !input.read(reinterpret_cast<char *>(&data[0]), data.size() * sizeof(float)))
+    return false;
+  if (input.peek() != EOF) return false;   // Truncated or longer than it claims: not ours
+
+  _VBO.swap(data);
+  _numTriangles = triangles;
+  return true;
+}
+
+// Written beside the OBJ; a read-only model directory just means no cache
+void Model::saveCache(const string & cacheName, const vector<string> & mtlFiles) const {
+  vector<string> sources(1, cacheName.substr(0, cacheName.size() - 5));
+  sources.insert(sources.end(), mtlFiles.begin(), mtlFiles.end());
+
+  const string tmpName = cacheName + ".tmp";
+  {
+    fstream output(tmpName.data(), ios::out | ios::binary | ios::trunc);
+    if (output.rdstate() != ios::goodbit) return;
+
+    output.write(CACHE_MAGIC, 4);
+    writeRaw(output, CACHE_VERSION);
+    writeRaw(output, (uint32_t) sources.size());
+    for (unsigned int s = 0; s < sources.size(); ++s) {
+      FileStamp stamp;
+      if (!fileStamp(sources[s], stamp)) {
+        output.close();
+        remove(tmpName.c_str());
+        return;
+      }
+      writeRaw(output, (uint32_t) sources[s].size());
+      output.write(sources[s].data(), sources[s].size());
+      writeRaw(output, stamp.mtime);
+      writeRaw(output, stamp.size);
+    }
+    writeRaw(output, (uint32_t) _numTriangles);
+    writeRaw(output, _boundsMin);
+    writeRaw(output, _boundsMax);
+    if (!_VBO.empty())
+      output.write(reinterpret_cast<const char *>(&_VBO[0]), _VBO.size() * sizeof(float));
+    if (!output) {
+      output.close();
+      remove(tmpName.c_str());
+      return;
+    }
+  }
+  // Readers never see a half-written cache
+  remove(cacheName.c_str());
+  rename(tmpName.c_str(), cacheName.c_str());
+}
+
 void Model::parseVOnly(stringstream & ss, string & block) {
 #if DEBUGPARSER
   cout << "Entering parseVOnly(..., \""<< block << "\")" << endl;
@@ -369,6 +547,7 @@ static void loadMTL(std::string filename) {
     cerr << "Cannot load MTL file " << filename << endl;
     return;
   }
+  mtlFiles.push_back(filename);
   string line;
   stringstream ss;
   while (getline(input, line)) {
@@ -455,39 +634,34 @@ static void omplenormals(vector<Face> &_faces,
   }
 }
 
-static void ompleVBOs(vector<Face> &_faces, 
-		      const vector<Vertex> &_vertices,
-                      const vector<Normal> &_normals,
-		      float *&_VBO_vert, float *&_VBO_norm, 
-                      float *&_VBO_mata, float *&_VBO_matd, float *&_VBO_matsp, float *&_VBO_matsh) 
+static void ompleVBO(vector<Face> &_faces, 
+		     const vector<Vertex> &_vertices,
+                     const vector<Normal> &_normals,
+		     vector<float> &_VBO) 
 {
-  // Creem els VBOs amb 3*3*faces.size() doubles cadascun
-  _VBO_vert = new float[3*3*_faces.size()];  
-  _VBO_norm = new float[3*3*_faces.size()];
-  _VBO_mata = new float[3*3*_faces.size()];
-  _VBO_matd = new float[3*3*_faces.size()];
-  _VBO_matsp = new float[3*3*_faces.size()];
-  _VBO_matsh = new float[3*_faces.size()];
+  // Creem el VBO entrellaçat amb MODEL_VERTEX_FLOATS floats per vèrtex
+  _VBO.assign(3*MODEL_VERTEX_FLOATS*_faces.size(), 0.0f);
 
   int index = 0;
   for (unsigned int f = 0; f < _faces.size(); ++f) {
     Material &mat = Materials[_faces[f].mat];
     for (int i = 0; i < 3; ++i) {
       int P =_faces[f].v[i];
+      float *vertex = &_VBO[index];
       for (int j = 0; j < 3; ++j) {
-        _VBO_vert[index+j] = _vertices[P+j];
+        vertex[j] = _vertices[P+j];
 	if (_normals.size() != 0) {
-          _VBO_norm[index+j] = _normals[_faces[f].n[i]+j];
+          vertex[MODEL_NORMAL_OFFSET+j] = _normals[_faces[f].n[i]+j];
         }
 	else {
-          _VBO_norm[index+j] = _faces[f].normalC[j];
+          vertex[MODEL_NORMAL_OFFSET+j] = _faces[f].normalC[j];
         }	
-        _VBO_mata[index+j] = mat.ambient[j];
-        _VBO_matd[index+j] = mat.diffuse[j];
-        _VBO_matsp[index+j] = mat.specular[j];
+        vertex[MODEL_MATAMB_OFFSET+j] = mat.ambient[j];
+        vertex[MODEL_MATDIFF_OFFSET+j] = mat.diffuse[j];
+        vertex[MODEL_MATSPEC_OFFSET+j] = mat.specular[j];
       }
-      _VBO_matsh[index/3] = mat.shininess;
-      index += 3;
+      vertex[MODEL_MATSHIN_OFFSET] = mat.shininess;
+      index += MODEL_VERTEX_FLOATS;
     }
   }
 }
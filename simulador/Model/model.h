@@ -40,10 +40,25 @@ struct Face{
   double normalC[3];
 };
 
+// Interleaved VBO layout: per vertex, position, normal, ambient, diffuse and
+// specular (3 floats each) followed by shininess
+const int MODEL_VERTEX_FLOATS = 16;
+const int MODEL_NORMAL_OFFSET = 3;
+const int MODEL_MATAMB_OFFSET = 6;
+const int MODEL_MATDIFF_OFFSET = 9;
+const int MODEL_MATSPEC_OFFSET = 12;
+const int MODEL_MATSHIN_OFFSET = 15;
+// Resolution of the LOD mesh (cells along the model's longest side)
+const int MODEL_LOD_CELLS = 16;
+
 class Model {
  public:
   Model();
   ~Model();
+  // Loads filename.obj; the VBO data and the bounds are cached in
+  // filename.obj.mbin and read from there while the OBJ and its MTL files
+  // keep their timestamps and sizes (vertices(), normals() and faces() are
+  // then left empty: only numTriangles(), the bounds and VBO() are filled)
   void load(std::string filename);
   const std::vector<Vertex>& vertices() const {
     return _vertices;
@@ -57,23 +72,26 @@ class Model {
   void dumpStats() const;
   void dumpModel() const;
 
-  float *VBO_vertices () {
-    return _VBO_vertices;
+  unsigned int numTriangles () const {
+    return _numTriangles;
   }
-  float *VBO_normals () {
-    return _VBO_normals;
+  const float *boundsMin () const {
+    return _boundsMin;
   }
-  float *VBO_matamb () {
-    return _VBO_matamb;
+  const float *boundsMax () const {
+    return _boundsMax;
   }
-  float *VBO_matdiff () {
-    return _VBO_matdiff;
+  // numTriangles()*3*MODEL_VERTEX_FLOATS floats
+  const float *VBO () const {
+    return _VBO.empty() ? NULL : &_VBO[0];
   }
-  float *VBO_matspec () {
-    return _VBO_matspec;
+  // Simplified copy of VBO() for distant instances (same layout); built by
+  // load() by clustering vertices on a grid of cellsPerSide cells per side
+  unsigned int numLODTriangles () const {
+    return _numLODTriangles;
   }
-  float *VBO_matshin () {
-    return _VBO_matshin;
+  const float *LODVBO () const {
+    return _LODVBO.empty() ? NULL : &_LODVBO[0];
   }
 
  private:
@@ -81,9 +99,16 @@ class Model {
   std::vector<Normal> _normals;
   std::vector<Face> _faces;
 
-  float *_VBO_vertices, *_VBO_normals;
-  float *_VBO_matamb, *_VBO_matdiff, *_VBO_matspec, *_VBO_matshin;
+  unsigned int _numTriangles;
+  float _boundsMin[3], _boundsMax[3];
+  std::vector<float> _VBO;
+  unsigned int _numLODTriangles;
+  std::vector<float> _LODVBO;
 
+  bool loadCache(const std::string & cacheName);
+  void saveCache(const std::string & cacheName, const std::vector<std::string> & mtlFiles) const;
+  void computeBounds();
+  void buildLOD(int cellsPerSide);
   void parseVOnly(std::stringstream & ss, std::string & block);
   void parseVN(std::stringstream & ss, std::string & block);
   void parseVT(std::stringstream & ss, std::string & block);
@@ -3,6 +3,93 @@
 #include <iostream>
 #include <QImage>
 #include <QPainter>
+#include <QDateTime>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Poses kept per robot (covers the interpolation delay at any frame rate used)
+const size_t POSE_HISTORY = 8;
+// Render this many frame intervals behind the newest frame, within these bounds
+const float INTERPOLATION_FRAMES = 1.5f;
+const float MIN_INTERPOLATION_DELAY_MS = 40.0f;
+const float MAX_INTERPOLATION_DELAY_MS = 600.0f;
+// Past the newest pose, keep moving at the last speed for at most this long
+const qint64 MAX_EXTRAPOLATION_MS = 250;
+// Frame redraw period while following the backend (~60 fps)
+const int ANIMATION_INTERVAL_MS = 16;
+// Static objects are bucketed in cells of this size (world units) for culling
+const float STATIC_CELL_SIZE = 4.0f;
+// Instances whose bounding sphere covers fewer pixels of radius use the LOD mesh
+const float LOD_PIXEL_RADIUS = 24.0f;
+
+// What a camera sees: the frustum planes (normalised, pointing inwards) and
+// how many pixels a world unit covers at a distance
+struct CullView {
+  glm::vec4 planes[6];
+  glm::vec3 eye;
+  float pixelsPerUnit;   // At distance 1 in perspective, anywhere in ortho
+  bool perspective;
+};
+
+CullView makeCullView(const glm::mat4& proj, const glm::mat4& view, int viewportHeight)
+{
+  CullView cull;
+  const glm::mat4 viewProj = proj * view;
+  const glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+  const glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+  const glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+  const glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+  cull.planes[0] = row3 + row0;   // Left
+  cull.planes[1] = row3 - row0;   // Right
+  cull.planes[2] = row3 + row1;   // Bottom
+  cull.planes[3] = row3 - row1;   // Top
+  cull.planes[4] = row3 + row2;   // Near
+  cull.planes[5] = row3 - row2;   // Far
+  for (glm::vec4& plane : cull.planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+  cull.eye = glm::vec3(glm::inverse(view)[3]);
+  cull.perspective = proj[3][3] == 0.0f;
+  cull.pixelsPerUnit = proj[1][1] * 0.5f * float(viewportHeight);
+  return cull;
+}
+
+bool boxVisible(const CullView& cull, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+  for (const glm::vec4& plane : cull.planes) {
+    // Corner furthest along the plane's normal
+    glm::vec3 corner(plane.x >= 0 ? boxMax.x : boxMin.x,
+                     plane.y >= 0 ? boxMax.y : boxMin.y,
+                     plane.z >= 0 ? boxMax.z : boxMin.z);
+    if (glm::dot(glm::vec3(plane), corner) + plane.w < 0) return false;
+  }
+  return true;
+}
+
+bool sphereVisible(const CullView& cull, const glm::vec3& centre, float radius)
+{
+  for (const glm::vec4& plane : cull.planes) {
+    if (glm::dot(glm::vec3(plane), centre) + plane.w < -radius) return false;
+  }
+  return true;
+}
+
+bool useLOD(const CullView& cull, const glm::vec3& centre, float radius)
+{
+  float pixels = radius * cull.pixelsPerUnit;
+  if (cull.perspective) pixels /= std::max(glm::length(centre - cull.eye), 1e-3f);
+  return pixels < LOD_PIXEL_RADIUS;
+}
+
+float lerpAngle(float from, float to, float t)
+{
+  float delta = std::fmod(to - from + 540.0f, 360.0f) - 180.0f;   // Shortest way round
+  return from + delta * t;
+}
+
+}
 
 // Helper function to generate industrial floor texture
 QImage generateIndustrialFloor(int size = 512) {
@@ -51,7 +138,12 @@ SimuladorGLWidget::SimuladorGLWidget (QWidget* parent) : QOpenGLWidget(parent)
   //animationTimer->start(16);
   robotCamera = false;  // Initialize to false - start with normal camera
   staticObjectsDirty = true;  // Initially need to draw static objects
+  staticCullValid = false;
   monitoringBackend_ = false;
+  clockOffsetMs_ = 0;
+  hasClockOffset_ = false;
+  lastFrameMs_ = 0;
+  frameIntervalMs_ = 50.0f;
   
   // Initialize telemetry reader
   telemetryReader_ = new TelemetryReader(this);
@@ -139,9 +231,71 @@ void SimuladorGLWidget::modifyselectedRobotID(QString robotID){
 
 void SimuladorGLWidget::updateAnimation() {
   makeCurrent();
+  if (monitoringBackend_) {
+    interpolateRobots();
+  }
   update();
 }
 
+float SimuladorGLWidget::interpolationDelay() const
+{
+  return std::min(MAX_INTERPOLATION_DELAY_MS,
+                  std::max(MIN_INTERPOLATION_DELAY_MS, frameIntervalMs_ * INTERPOLATION_FRAMES));
+}
+
+void SimuladorGLWidget::interpolateRobots()
+{
+  if (!hasClockOffset_) return;
+  
+  // Render time on the backend's clock
+  const qint64 renderMs = QDateTime::currentMSecsSinceEpoch() - clockOffsetMs_ - qint64(interpolationDelay());
+  
+  bool selectedRobotMoved = false;
+  for (auto& entry : poseHistory_) {
+    const std::deque<PoseSample>& history = entry.second;
+    if (history.empty()) continue;
+    
+    // Newest pose at or before renderMs, and the one after it
+    size_t next = 0;
+    while (next < history.size() && history[next].timeMs <= renderMs) next++;
+    
+    PoseSample pose;
+    if (next == 0) {
+      pose = history.front();   // Render time before the buffer: oldest pose
+    } else if (next < history.size()) {
+      const PoseSample& a = history[next - 1];
+      const PoseSample& b = history[next];
+      float t = b.timeMs > a.timeMs ? float(renderMs - a.timeMs) / float(b.timeMs - a.timeMs) : 1.0f;
+      pose = a;
+      pose.x = a.x + (b.x - a.x) * t;
+      pose.y = a.y + (b.y - a.y) * t;
+      pose.angle = lerpAngle(a.angle, b.angle, t);
+    } else {
+      // Past the newest pose (late frame): extrapolate along the last step
+      pose = history.back();
+      if (history.size() >= 2) {
+        const PoseSample& a = history[history.size() - 2];
+        const PoseSample& b = history.back();
+        qint64 ahead = std::min(renderMs - b.timeMs, MAX_EXTRAPOLATION_MS);
+        if (b.timeMs > a.timeMs && ahead > 0) {
+          float t = float(ahead) / float(b.timeMs - a.timeMs);
+          pose.x = b.x + (b.x - a.x) * t;
+          pose.y = b.y + (b.y - a.y) * t;
+        }
+      }
+    }
+    
+    robots[entry.first] = std::make_tuple(pose.x, pose.y, pose.angle, pose.hasBox);
+    if (entry.first == selectedRObotID) selectedRobotMoved = true;
+  }
+  
+  // In robot camera mode, the camera follows the selected robot
+  if (robotCamera && selectedRobotMoved) {
+    viewTransform();
+    projectTransform();
+  }
+}
+
 void SimuladorGLWidget::iniEscena ()
 {
   creaBuffersModels();
@@ -246,7 +400,7 @@ void SimuladorGLWidget::eliminarRobot(int robotID){
   update();
 }
 
-void SimuladorGLWidget::modelTransforRobot (int id, float x, float y,float angle){
+glm::mat4 SimuladorGLWidget::robotTransform (float x, float y, float angle){
     glm::mat4 TG(1.0f);
     
     // Position translation
@@ -258,7 +412,12 @@ void SimuladorGLWidget::modelTransforRobot (int id, float x, float y,float angle
     //TG= glm::scale(TG, escalaModel);  // Scale down robot size
     // Model adjustments
     TG = glm::translate(TG, glm::vec3(-centreCapsaModels[1].x, -minY[1], -centreCapsaModels[1].z));
-    
+    return TG;
+}
+
+void SimuladorGLWidget::modelTransforRobot (int id, float x, float y,float angle){
+    Q_UNUSED(id);
+    glm::mat4 TG = robotTransform(x, y, angle);
     glUniformMatrix4fv(transLoc, 1, GL_FALSE, &TG[0][0]);
 }
 
@@ -278,9 +437,14 @@ void SimuladorGLWidget::paintGL ()
   // Reset color multiplier to white (neutral) for proper material rendering
   glUniform3fv(colorLoc, 1, &white[0]);
 
-  // First pass: Draw all non-selected robots normally
+  // First pass: Draw all non-selected robots normally, one instanced draw per model
   glStencilFunc(GL_ALWAYS, 1, 0xFF);
   glStencilMask(0x00);
+  const CullView cullView = makeCullView(Proj, View, alt);
+  for (int modelIndex = 1; modelIndex <= 2; modelIndex++) {
+        robotInstances[modelIndex].clear();
+        robotLodInstances[modelIndex].clear();
+  }
   for (const auto& robot : robots) {
         if (robot.first == selectedRObotID) continue;
         
@@ -291,14 +455,33 @@ void SimuladorGLWidget::paintGL ()
 
         // Select model based on whether robot is carrying a box
         const int modelIndex = hasBox ? 2 : 1;  // Model 2 = with box, Model 1 = without box
-
-        // Ensure color multiplier is white for proper material colors
-        glUniform3fv(colorLoc, 1, &white[0]);
         
-        modelTransforRobot(robot.first, x, y, dir);
-        glBindVertexArray(VAO_models[modelIndex]);
-        glDrawArrays(GL_TRIANGLES, 0, models[modelIndex].faces().size() * 3);
+        // Skip robots outside the view; distant ones get the simplified mesh
+        const glm::vec3 centre(x, 0.5f * dimensions[modelIndex].y, y);
+        const float radius = 0.5f * glm::length(dimensions[modelIndex]);
+        if (!sphereVisible(cullView, centre, radius)) continue;
+        std::vector<glm::mat4>& instances = useLOD(cullView, centre, radius) ? robotLodInstances[modelIndex]
+                                                                               : robotInstances[modelIndex];
+        instances.push_back(robotTransform(x, y, dir));
     }
+  glUniform1i(instancedLoc, 1);
+  for (int modelIndex = 1; modelIndex <= 2; modelIndex++) {
+        if (!robotInstances[modelIndex].empty()) {
+          uploadInstances(robotInstanceVBO[modelIndex], robotInstances[modelIndex],
+                          robotInstanceCapacity[modelIndex], GL_DYNAMIC_DRAW);
+          glBindVertexArray(VAO_models[modelIndex]);
+          glDrawArraysInstanced(GL_TRIANGLES, 0, models[modelIndex].numTriangles() * 3,
+                                GLsizei(robotInstances[modelIndex].size()));
+        }
+        if (!robotLodInstances[modelIndex].empty()) {
+          uploadInstances(robotLodInstanceVBO[modelIndex], robotLodInstances[modelIndex],
+                          robotLodInstanceCapacity[modelIndex], GL_DYNAMIC_DRAW);
+          glBindVertexArray(VAO_robotLod[modelIndex]);
+          glDrawArraysInstanced(GL_TRIANGLES, 0, models[modelIndex].numLODTriangles() * 3,
+                                GLsizei(robotLodInstances[modelIndex].size()));
+        }
+  }
+  glUniform1i(instancedLoc, 0);
 
     // If we have a selected robot, draw it with outline
     if (selectedRObotID != -1) {
@@ -319,7 +502,7 @@ void SimuladorGLWidget::paintGL ()
             
             modelTransforRobot(selectedRObotID, x, y, angle);
             glBindVertexArray(VAO_models[modelIndex]);
-            glDrawArrays(GL_TRIANGLES, 0, models[modelIndex].faces().size() * 3);
+            glDrawArrays(GL_TRIANGLES, 0, models[modelIndex].numTriangles() * 3);
 
             // Second render: Draw slightly scaled outline
             if(!robotCamera){
@@ -341,7 +524,7 @@ void SimuladorGLWidget::paintGL ()
               glm::vec3 outlineColor(1.0f, 0.0f, 0.0f); // Red outline
               glUniform3fv(colorLoc, 1, &outlineColor[0]);
               glUniformMatrix4fv(transLoc, 1, GL_FALSE, &TG[0][0]);
-              glDrawArrays(GL_TRIANGLES, 0, models[modelIndex].faces().size() * 3);
+              glDrawArrays(GL_TRIANGLES, 0, models[modelIndex].numTriangles() * 3);
             }
             // Restore states
             glEnable(GL_DEPTH_TEST);
@@ -383,35 +566,27 @@ void SimuladorGLWidget::paintStaticObjects()
     glStencilMask(0x00);
     glUniform3fv(colorLoc, 1, &white[0]);
     
-    const std::vector<WarehouseObject>& warehouseObjects = warehouseLoader.getObjects();
-    for (const auto& obj : warehouseObjects) {
-        if (obj.modelIndex < 0 || obj.modelIndex >= NUM_MODELS) {
-            continue; // Skip invalid model indices
+    // Up to two instanced draws per model (full and LOD mesh), from the
+    // transforms culled when the layout or the camera last changed
+    if (staticObjectsDirty) {
+        rebuildStaticInstances();
+    }
+    const glm::mat4 viewProj = Proj * View;
+    if (!staticCullValid || viewProj != staticCullViewProj) {
+        cullStaticObjects(viewProj);
+    }
+    glUniform1i(instancedLoc, 1);
+    for (int i = 0; i < NUM_MODELS; i++) {
+        if (staticInstanceCount[i] > 0) {
+          glBindVertexArray(VAO_static[i]);
+          glDrawArraysInstanced(GL_TRIANGLES, 0, models[i].numTriangles() * 3, staticInstanceCount[i]);
+        }
+        if (staticLodInstanceCount[i] > 0) {
+          glBindVertexArray(VAO_staticLod[i]);
+          glDrawArraysInstanced(GL_TRIANGLES, 0, models[i].numLODTriangles() * 3, staticLodInstanceCount[i]);
         }
-        
-        // Create transformation matrix with JSON dimensions for scaling
-        glm::mat4 TG(1.0f);
-        
-        // 1. Translate to object center position
-        TG = glm::translate(TG, obj.center);
-        
-        // 2. Rotate around Y axis
-        TG = glm::rotate(TG, glm::radians(-obj.rotation), glm::vec3(0, 1, 0));
-        
-        // 3. Scale model to match JSON dimensions
-        // obj.dimensions contains [width, height, depth] from JSON
-        glm::vec3 scaleFactors = obj.dimensions / dimensions[obj.modelIndex];
-        TG = glm::scale(TG, scaleFactors);
-        
-        // 4. Center the model at origin (after scaling)
-        TG = glm::translate(TG, glm::vec3(-centreCapsaModels[obj.modelIndex].x, 
-                                          -minY[obj.modelIndex], 
-                                          -centreCapsaModels[obj.modelIndex].z));
-        
-        glUniformMatrix4fv(transLoc, 1, GL_FALSE, &TG[0][0]);
-        glBindVertexArray(VAO_models[obj.modelIndex]);
-        glDrawArrays(GL_TRIANGLES, 0, models[obj.modelIndex].faces().size() * 3);
     }
+    glUniform1i(instancedLoc, 0);
     
     // Debug: Draw picking zones as black points on the ground
     
@@ -683,26 +858,9 @@ void SimuladorGLWidget::wheelEvent(QWheelEvent *event)
 
 void SimuladorGLWidget::calculaCapsaModel (Model &p, float &escala, float ampladaDesitjada, glm::vec3 &centreCapsa,float &minY,float &minX,float &minZ,glm::vec3 &dimensions)
 {
-  // Càlcul capsa contenidora i valors transformacions inicials
-  float minx, miny, minz, maxx, maxy, maxz;
-  minx = maxx = p.vertices()[0];
-  miny = maxy = p.vertices()[1];
-  minz = maxz = p.vertices()[2];
-  for (unsigned int i = 3; i < p.vertices().size(); i+=3)
-  {
-    if (p.vertices()[i+0] < minx)
-      minx = p.vertices()[i+0];
-    if (p.vertices()[i+0] > maxx)
-      maxx = p.vertices()[i+0];
-    if (p.vertices()[i+1] < miny)
-      miny = p.vertices()[i+1];
-    if (p.vertices()[i+1] > maxy)
-      maxy = p.vertices()[i+1];
-    if (p.vertices()[i+2] < minz)
-      minz = p.vertices()[i+2];
-    if (p.vertices()[i+2] > maxz)
-      maxz = p.vertices()[i+2];
-  }
+  // Capsa contenidora (calculada en carregar el model, o llegida de la cache)
+  float minx = p.boundsMin()[0], miny = p.boundsMin()[1], minz = p.boundsMin()[2];
+  float maxx = p.boundsMax()[0], maxy = p.boundsMax()[1], maxz = p.boundsMax()[2];
   
   escala = ampladaDesitjada/(maxx-minx);
   centreCapsa = glm::vec3((minx+maxx)/2.0f,(miny+maxy)/2.0f,(minz+maxz)/2.0f);
@@ -717,7 +875,17 @@ void SimuladorGLWidget::creaBuffersModels ()
 {  
   // Creació de VAos i VBOs per pintar els models
   glGenVertexArrays(NUM_MODELS, &VAO_models[0]);
+  glGenVertexArrays(NUM_MODELS, &VAO_static[0]);
+  glGenVertexArrays(NUM_MODELS, &VAO_robotLod[0]);
+  glGenVertexArrays(NUM_MODELS, &VAO_staticLod[0]);
+  glGenBuffers(NUM_MODELS, &robotInstanceVBO[0]);
+  glGenBuffers(NUM_MODELS, &staticInstanceVBO[0]);
+  glGenBuffers(NUM_MODELS, &robotLodInstanceVBO[0]);
+  glGenBuffers(NUM_MODELS, &staticLodInstanceVBO[0]);
   
+  // Every instance buffer holds at least one transform, so a non-instanced
+  // draw (which still fetches instance 0) never reads past a buffer
+  const std::vector<glm::mat4> identity(1, glm::mat4(1.0f));
   
   for (int i = 0; i < NUM_MODELS; i++)
   {	
@@ -727,59 +895,133 @@ void SimuladorGLWidget::creaBuffersModels ()
 	  // Calculem la capsa contenidora del model
     std::cout<< "Calculant capsa model " << objNames[i] << std::endl;
     calculaCapsaModel (models[i], escalaModels[i], ampladesDesitjades[i], centreCapsaModels[i],minY[i],minX[i],minZ[i], dimensions[i]);
-  
-	  glBindVertexArray(VAO_models[i]);
-
-	  // Creació dels buffers del model fantasma
-	  GLuint VBO[6];
-	  // Buffer de posicions
-	  glGenBuffers(6, VBO);
-	  glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-	  glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*models[i].faces().size()*3*3, models[i].VBO_vertices(), GL_STATIC_DRAW);
-
-	  // Activem l'atribut vertexLoc
-	  glVertexAttribPointer(vertexLoc, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	  glEnableVertexAttribArray(vertexLoc);
-
-	  // Buffer de normals
-	  glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
-	  glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*models[i].faces().size()*3*3, models[i].VBO_normals(), GL_STATIC_DRAW);
-
-	  glVertexAttribPointer(normalLoc, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	  glEnableVertexAttribArray(normalLoc);
-
-	  // En lloc del color, ara passem tots els paràmetres dels materials
-	  // Buffer de component ambient
-	  glBindBuffer(GL_ARRAY_BUFFER, VBO[2]);
-	  glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*models[i].faces().size()*3*3, models[i].VBO_matamb(), GL_STATIC_DRAW);
 
-	  glVertexAttribPointer(matambLoc, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	  glEnableVertexAttribArray(matambLoc);
-
-	  // Buffer de component difusa
-	  glBindBuffer(GL_ARRAY_BUFFER, VBO[3]);
-	  glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*models[i].faces().size()*3*3, models[i].VBO_matdiff(), GL_STATIC_DRAW);
+	  // Creació del buffer del model: posició, normal i material entrellaçats
+	  glGenBuffers(1, &VBO_models[i]);
+	  glBindBuffer(GL_ARRAY_BUFFER, VBO_models[i]);
+	  glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*models[i].numTriangles()*3*MODEL_VERTEX_FLOATS, models[i].VBO(), GL_STATIC_DRAW);
+	  // i la versió simplificada per a les instàncies llunyanes
+	  glGenBuffers(1, &VBO_lod[i]);
+	  glBindBuffer(GL_ARRAY_BUFFER, VBO_lod[i]);
+	  glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*models[i].numLODTriangles()*3*MODEL_VERTEX_FLOATS, models[i].LODVBO(), GL_STATIC_DRAW);
+
+	  // Buffers d'instàncies
+	  robotInstanceCapacity[i] = 0;
+	  staticInstanceCapacity[i] = 0;
+	  robotLodInstanceCapacity[i] = 0;
+	  staticLodInstanceCapacity[i] = 0;
+	  staticInstanceCount[i] = 0;
+	  staticLodInstanceCount[i] = 0;
+	  uploadInstances(robotInstanceVBO[i], identity, robotInstanceCapacity[i], GL_DYNAMIC_DRAW);
+	  uploadInstances(staticInstanceVBO[i], identity, staticInstanceCapacity[i], GL_DYNAMIC_DRAW);
+	  uploadInstances(robotLodInstanceVBO[i], identity, robotLodInstanceCapacity[i], GL_DYNAMIC_DRAW);
+	  uploadInstances(staticLodInstanceVBO[i], identity, staticLodInstanceCapacity[i], GL_DYNAMIC_DRAW);
+
+	  // VAO per als robots (i els dibuixos individuals) i VAO per als objectes estàtics,
+	  // amb el model complet i amb el simplificat
+	  glBindVertexArray(VAO_models[i]);
+	  bindModelAttributes(VBO_models[i], robotInstanceVBO[i]);
+	  glBindVertexArray(VAO_static[i]);
+	  bindModelAttributes(VBO_models[i], staticInstanceVBO[i]);
+	  glBindVertexArray(VAO_robotLod[i]);
+	  bindModelAttributes(VBO_lod[i], robotLodInstanceVBO[i]);
+	  glBindVertexArray(VAO_staticLod[i]);
+	  bindModelAttributes(VBO_lod[i], staticLodInstanceVBO[i]);
+  }
+  
+  glBindVertexArray (0);
+}
 
-	  glVertexAttribPointer(matdiffLoc, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	  glEnableVertexAttribArray(matdiffLoc);
+void SimuladorGLWidget::bindModelAttributes (GLuint vertexVBO, GLuint instanceVBO)
+{
+  const GLsizei stride = sizeof(GLfloat) * MODEL_VERTEX_FLOATS;
+  const GLuint locations[6] = {GLuint(vertexLoc), GLuint(normalLoc), GLuint(matambLoc),
+                               GLuint(matdiffLoc), GLuint(matspecLoc), GLuint(matshinLoc)};
+  const int sizes[6] = {3, 3, 3, 3, 3, 1};
+  const int offsets[6] = {0, MODEL_NORMAL_OFFSET, MODEL_MATAMB_OFFSET,
+                          MODEL_MATDIFF_OFFSET, MODEL_MATSPEC_OFFSET, MODEL_MATSHIN_OFFSET};
+  
+  glBindBuffer(GL_ARRAY_BUFFER, vertexVBO);
+  for (int attribute = 0; attribute < 6; attribute++) {
+    glVertexAttribPointer(locations[attribute], sizes[attribute], GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<const void*>(sizeof(GLfloat) * offsets[attribute]));
+    glEnableVertexAttribArray(locations[attribute]);
+  }
 
-	  // Buffer de component especular
-	  glBindBuffer(GL_ARRAY_BUFFER, VBO[4]);
-	  glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*models[i].faces().size()*3*3, models[i].VBO_matspec(), GL_STATIC_DRAW);
+  // instanceTG: a mat4 takes 4 attribute locations (one per column), advanced per instance
+  if (instanceTGLoc < 0) return;
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+  for (int column = 0; column < 4; column++) {
+    GLuint loc = GLuint(instanceTGLoc + column);
+    glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                          reinterpret_cast<const void*>(sizeof(glm::vec4) * column));
+    glEnableVertexAttribArray(loc);
+    glVertexAttribDivisor(loc, 1);
+  }
+}
 
-	  glVertexAttribPointer(matspecLoc, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	  glEnableVertexAttribArray(matspecLoc);
+void SimuladorGLWidget::uploadInstances (GLuint vbo, const std::vector<glm::mat4>& instances, size_t& capacity, GLenum usage)
+{
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  if (instances.size() > capacity) {
+    // Grow with slack, so a fleet growing robot by robot reallocates rarely
+    capacity = usage == GL_STATIC_DRAW ? instances.size() : instances.size() * 2;
+    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * capacity, nullptr, usage);
+  }
+  if (!instances.empty()) {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::mat4) * instances.size(), instances.data());
+  }
+}
 
-	  // Buffer de component shininness
-	  glBindBuffer(GL_ARRAY_BUFFER, VBO[5]);
-	  glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*models[i].faces().size()*3, models[i].VBO_matshin(), GL_STATIC_DRAW);
+void SimuladorGLWidget::rebuildStaticInstances ()
+{
+  std::vector<ModelBounds> bounds(NUM_MODELS);
+  for (int i = 0; i < NUM_MODELS; i++) {
+    bounds[i].centre = centreCapsaModels[i];
+    bounds[i].minY = minY[i];
+    bounds[i].dimensions = dimensions[i];
+  }
+  
+  staticCells = warehouseLoader.buildStaticCells(bounds, STATIC_CELL_SIZE);
+  staticCullValid = false;
+  staticObjectsDirty = false;
+}
 
-	  glVertexAttribPointer(matshinLoc, 1, GL_FLOAT, GL_FALSE, 0, 0);
-	  glEnableVertexAttribArray(matshinLoc);
+void SimuladorGLWidget::cullStaticObjects (const glm::mat4& viewProj)
+{
+  const CullView cullView = makeCullView(Proj, View, alt);
+  for (int i = 0; i < NUM_MODELS; i++) {
+    staticVisible[i].clear();
+    staticVisibleLod[i].clear();
   }
   
-  glBindVertexArray (0);
+  for (const StaticCell& cell : staticCells) {
+    if (!boxVisible(cullView, cell.boundsMin, cell.boundsMax)) continue;
+    for (int i = 0; i < NUM_MODELS; i++) {
+      const std::vector<glm::mat4>& instances = cell.instances[i];
+      const std::vector<glm::vec4>& spheres = cell.spheres[i];
+      for (size_t k = 0; k < instances.size(); k++) {
+        const glm::vec3 centre(spheres[k]);
+        if (!sphereVisible(cullView, centre, spheres[k].w)) continue;
+        if (useLOD(cullView, centre, spheres[k].w)) {
+          staticVisibleLod[i].push_back(instances[k]);
+        } else {
+          staticVisible[i].push_back(instances[k]);
+        }
+      }
+    }
+  }
+  
+  for (int i = 0; i < NUM_MODELS; i++) {
+    staticInstanceCount[i] = GLsizei(staticVisible[i].size());
+    staticLodInstanceCount[i] = GLsizei(staticVisibleLod[i].size());
+    uploadInstances(staticInstanceVBO[i], staticVisible[i], staticInstanceCapacity[i], GL_DYNAMIC_DRAW);
+    uploadInstances(staticLodInstanceVBO[i], staticVisibleLod[i], staticLodInstanceCapacity[i], GL_DYNAMIC_DRAW);
+  }
+  staticCullViewProj = viewProj;
+  staticCullValid = true;
 }
+
 void SimuladorGLWidget::iniMaterialTerra ()
 {
   // Donem valors al material del terra
@@ -948,6 +1190,10 @@ void SimuladorGLWidget::carregaShaders()
   projLoc = glGetUniformLocation (program->programId(), "proj");
   viewLoc = glGetUniformLocation (program->programId(), "view");
   colorLoc = glGetUniformLocation (program->programId(), "colorMul");
+  instancedLoc = glGetUniformLocation (program->programId(), "instanced");
+  // Obtenim identificador per a l'atribut “instanceTG” (TG per instància)
+  instanceTGLoc = glGetAttribLocation (program->programId(), "instanceTG");
+  glUniform1i(instancedLoc, 0);
   
   // Create separate shader program for textured floor
   QOpenGLShader floorFs (QOpenGLShader::Fragment, this);
@@ -991,6 +1237,9 @@ void SimuladorGLWidget::startBackendMonitoring(const QString& telemetryDir)
     qDebug() << "Starting backend monitoring from:" << telemetryDir;
     telemetryReader_->startMonitoring(telemetryDir);
     monitoringBackend_ = true;
+    poseHistory_.clear();
+    hasClockOffset_ = false;
+    animationTimer->start(ANIMATION_INTERVAL_MS);
 }
 
 void SimuladorGLWidget::stopBackendMonitoring()
@@ -998,6 +1247,7 @@ void SimuladorGLWidget::stopBackendMonitoring()
     qDebug() << "Stopping backend monitoring";
     telemetryReader_->stopMonitoring();
     monitoringBackend_ = false;
+    animationTimer->stop();
 }
 
 bool SimuladorGLWidget::isMonitoringBackend() const
@@ -1007,48 +1257,61 @@ bool SimuladorGLWidget::isMonitoringBackend() const
 
 void SimuladorGLWidget::updateRobotsFromBackend(const std::map<int, TelemetryReader::RobotData>& robotData)
 {
-    makeCurrent();
+    if (robotData.empty()) return;
     
-    bool selectedRobotUpdated = false;
+    // Frame timing on the backend clock: every robot of a frame has its time
+    const qint64 frameMs = robotData.begin()->second.timestampMs;
+    if (frameMs <= lastFrameMs_) {
+        if (frameMs + qint64(MAX_INTERPOLATION_DELAY_MS) * 4 >= lastFrameMs_) return;  // Same or older frame
+        // Far in the past: the backend restarted, start over
+        poseHistory_.clear();
+        hasClockOffset_ = false;
+    } else if (lastFrameMs_ > 0 && hasClockOffset_) {
+        float interval = float(frameMs - lastFrameMs_);
+        frameIntervalMs_ += (std::min(interval, MAX_INTERPOLATION_DELAY_MS) - frameIntervalMs_) * 0.2f;
+    }
+    lastFrameMs_ = frameMs;
     
-    // Update robot positions from backend data
+    // Clock offset: the smallest arrival delay seen is the best estimate of
+    // the clocks' difference; creep up slowly so clock drift is followed
+    const qint64 offset = QDateTime::currentMSecsSinceEpoch() - frameMs;
+    if (!hasClockOffset_ || offset < clockOffsetMs_) {
+        clockOffsetMs_ = offset;
+        hasClockOffset_ = true;
+    } else {
+        clockOffsetMs_ += (offset - clockOffsetMs_) / 100;
+    }
+    
+    // Buffer the poses; interpolateRobots draws them
     for (const auto& pair : robotData) {
         int robotId = pair.first;
         const TelemetryReader::RobotData& data = pair.second;
+        std::deque<PoseSample>& history = poseHistory_[robotId];
         
         // Convert coordinates from backend scale to simulator scale (divide by 10)
-        float x = data.x / 10.0f;
-        float y = data.y / 10.0f;
+        PoseSample pose;
+        pose.timeMs = frameMs;
+        pose.x = data.x / 10.0f;
+        pose.y = data.y / 10.0f;
+        pose.hasBox = data.hasPackage;
         
         // Calculate angle from velocity vector
-        float angle = 0.0f;
         if (data.vx != 0.0f || data.vy != 0.0f) {
             // atan2 gives angle in radians, convert to degrees
-            angle = atan2(data.vx, data.vy) * 180.0f / M_PI;
-        } else if (robots.find(robotId) != robots.end()) {
+            pose.angle = atan2(data.vx, data.vy) * 180.0f / M_PI;
+        } else if (!history.empty()) {
             // If not moving, keep the previous angle
-            angle = std::get<2>(robots[robotId]);
+            pose.angle = history.back().angle;
+        } else {
+            pose.angle = robots.find(robotId) != robots.end() ? std::get<2>(robots[robotId]) : 0.0f;
         }
         
         if(robots.find(robotId) == robots.end()) {
           emit robotAfegit(robotId);
+          robots[robotId] = std::make_tuple(pose.x, pose.y, pose.angle, pose.hasBox);
         }
         
-        // Update robot tuple (x, y, angle, hasPackage)
-        robots[robotId] = std::make_tuple(x, y, angle, data.hasPackage);
-        
-        // Track if we updated the selected robot
-        if (robotId == selectedRObotID) {
-            selectedRobotUpdated = true;
-        }
-    }
-    
-    // If we're in robot camera mode and the selected robot was updated,
-    // update the view and projection transforms
-    if (robotCamera && selectedRobotUpdated && selectedRObotID != -1) {
-        viewTransform();
-        projectTransform();
+        history.push_back(pose);
+        if (history.size() > POSE_HISTORY) history.pop_front();
     }
-    
-    update();
 }
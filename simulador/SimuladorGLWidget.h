@@ -6,6 +6,7 @@
 #include <QKeyEvent>
 #include <QMouseEvent>
 #include <QTimer>
+#include <deque>
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
@@ -50,6 +51,24 @@ class SimuladorGLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_3_C
     float Speed = 1.5f;
     bool robotCamera;  // Add this to track which camera is active
     bool monitoringBackend_;  // Track if we're monitoring backend data
+    
+    // Backend poses are buffered and drawn interpolated a little in the past
+    // (interpolationDelay()), so motion stays smooth at any telemetry rate
+    struct PoseSample {
+        qint64 timeMs;      // Backend frame time
+        float x, y;         // Simulator coordinates
+        float angle;        // Degrees
+        bool hasBox;
+    };
+    std::map<int, std::deque<PoseSample>> poseHistory_;
+    qint64 clockOffsetMs_;      // Local clock minus backend clock (smallest seen, plus drift)
+    bool hasClockOffset_;
+    qint64 lastFrameMs_;        // Backend time of the newest frame
+    float frameIntervalMs_;     // Smoothed time between frames
+    
+    // interpolateRobots - sets robots to the buffered poses at the render time
+    void interpolateRobots();
+    float interpolationDelay() const;
   protected:
     // initializeGL - Aqui incluim les inicialitzacions del contexte grafic.
     virtual void initializeGL ( );
@@ -84,6 +103,16 @@ class SimuladorGLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_3_C
 
     // creaBuffersModels - Aquí carreguem els fitxers obj i fem la inicialització dels diferents VAOS i VBOs
     void creaBuffersModels ();    
+    // bindModelAttributes - points the bound VAO at a model's interleaved vertexVBO and at instanceVBO for instanceTG
+    void bindModelAttributes (GLuint vertexVBO, GLuint instanceVBO);
+    // uploadInstances - writes instance transforms to vbo (growing it when needed)
+    void uploadInstances (GLuint vbo, const std::vector<glm::mat4>& instances, size_t& capacity, GLenum usage);
+    // rebuildStaticInstances - buckets the warehouse objects in staticCells (when staticObjectsDirty)
+    void rebuildStaticInstances ();
+    // cullStaticObjects - uploads the static objects inside the view, far ones to the LOD buffers
+    void cullStaticObjects (const glm::mat4& viewProj);
+    // robotTransform - model transform of a robot at (x, y) facing angle (degrees)
+    glm::mat4 robotTransform (float x, float y, float angle);
     // calculaCapsaModel - Calcula la capsa contenidora d'un Model p retornant el centre absolut de la seva capsa contenidora a centreCapsa, i el factor d'escala necessari per a que la seva amplada sigui ampladaDesitjada (dimensió en X desitjada).
     void calculaCapsaModel (Model &p, float &escala, float ampladaDesitjada, glm::vec3 &centreCapsa, float &minY, float &minX, float &minZ, glm::vec3 &dimensions);
 
@@ -114,6 +143,33 @@ class SimuladorGLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_3_C
     
     // Array amb els VAOs dels models carregats
     GLuint VAO_models[NUM_MODELS];        
+    GLuint VBO_models[NUM_MODELS];      // Interleaved vertex data of each model (shared by both VAOs)
+    GLuint VBO_lod[NUM_MODELS];         // Simplified vertex data (Model::LODVBO), for distant instances
+    // Instanced drawing: robots are redrawn every frame from robotInstanceVBO,
+    // the warehouse objects from staticInstanceVBO (refilled only when the
+    // layout or the camera changes); both hold only what is inside the view
+    // frustum, and instances that would cover few pixels go to the *Lod
+    // buffers instead and are drawn with the simplified mesh
+    GLuint VAO_static[NUM_MODELS];
+    GLuint VAO_robotLod[NUM_MODELS];
+    GLuint VAO_staticLod[NUM_MODELS];
+    GLuint robotInstanceVBO[NUM_MODELS];
+    GLuint staticInstanceVBO[NUM_MODELS];
+    GLuint robotLodInstanceVBO[NUM_MODELS];
+    GLuint staticLodInstanceVBO[NUM_MODELS];
+    size_t robotInstanceCapacity[NUM_MODELS];
+    size_t staticInstanceCapacity[NUM_MODELS];
+    size_t robotLodInstanceCapacity[NUM_MODELS];
+    size_t staticLodInstanceCapacity[NUM_MODELS];
+    GLsizei staticInstanceCount[NUM_MODELS];
+    GLsizei staticLodInstanceCount[NUM_MODELS];
+    std::vector<glm::mat4> robotInstances[NUM_MODELS];  // Reused every frame
+    std::vector<glm::mat4> robotLodInstances[NUM_MODELS];
+    std::vector<glm::mat4> staticVisible[NUM_MODELS];   // Reused by cullStaticObjects
+    std::vector<glm::mat4> staticVisibleLod[NUM_MODELS];
+    std::vector<StaticCell> staticCells;     // Warehouse objects bucketed on the floor
+    glm::mat4 staticCullViewProj;            // Camera the static buffers were culled for
+    bool staticCullValid;
     GLuint VAO_Terra; // VAO específic per al terra
     // Array on es guarden els centres de las capses contenidores de tots els models
     glm::vec3 centreCapsaModels[NUM_MODELS];        
@@ -167,11 +223,12 @@ class SimuladorGLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_3_C
     QOpenGLShaderProgram *program;
     QOpenGLShaderProgram *floorProgram;  // Separate program for textured floor
     // uniform locations
-    GLuint transLoc, projLoc, viewLoc, colorLoc;
+    GLuint transLoc, projLoc, viewLoc, colorLoc, instancedLoc;
     GLuint floorTransLoc, floorProjLoc, floorViewLoc;  // Floor shader uniforms
     GLuint floorTextureLoc;  // Texture uniform for floor
     // attribute locations
     GLuint vertexLoc, normalLoc, matambLoc, matdiffLoc, matspecLoc, matshinLoc;
+    GLint instanceTGLoc;  // First of the 4 locations of the mat4 attribute
     GLuint floorVertexLoc, floorNormalLoc, floorTexCoordLoc;  // Floor shader attributes
     GLuint floorMatambLoc, floorMatdiffLoc, floorMatspecLoc, floorMatshinLoc;
     // texture ID
@@ -1,9 +1,64 @@
 #include "TelemetryReader.h"
 #include <QFile>
 #include <QDir>
+#include <QDateTime>
 #include <QDebug>
+#include <QGuiApplication>
 #include <QJsonParseError>
+#include <QScreen>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+// Layout of backend/api/TelemetryRing.hh (version 1)
+const char RING_MAGIC[8] = {'A', 'M', 'R', 'T', 'E', 'L', 'E', 'M'};
+const quint32 RING_VERSION = 1;
+const int RING_HEADER_BYTES = 64;
+const int RING_SLOT_HEADER_BYTES = 32;
+const int RING_FRAMES_WRITTEN_OFFSET = 32;
+const int RING_STATUS_COUNT = 4;
+const int RING_DRIVER_STATE_COUNT = 6;
+
+// Shared by every robot (QString is implicitly shared: assigning one copies no text)
+const QString& ringStatusName(quint8 index)
+{
+    static const QString names[RING_STATUS_COUNT] = {
+        QStringLiteral("IDLE"), QStringLiteral("BUSY"), QStringLiteral("CHARGING"), QStringLiteral("ERROR")};
+    return names[index < RING_STATUS_COUNT ? index : 0];
+}
+
+const QString& ringDriverStateName(quint8 index)
+{
+    static const QString names[RING_DRIVER_STATE_COUNT] = {
+        QStringLiteral("IDLE"), QStringLiteral("COMPUTING_PATH"), QStringLiteral("MOVING"),
+        QStringLiteral("ARRIVED"), QStringLiteral("STUCK"), QStringLiteral("COLLISION_WAIT")};
+    return names[index < RING_DRIVER_STATE_COUNT ? index : 0];
+}
+
+// Reopen the ring after this many updates without a frame (the backend
+// replaces the file when it restarts)
+const int RING_REOPEN_UPDATES = 20;
+
+// Ring poll interval when the display refresh rate is unknown (60 Hz)
+const int RING_DEFAULT_POLL_MS = 16;
+
+template <typename T>
+T readValue(const uchar* at)
+{
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+
+quint64 loadSequence(const uchar* at)
+{
+    return reinterpret_cast<const std::atomic<quint64>*>(at)->load(std::memory_order_acquire);
+}
+
+}
+
 
 TelemetryReader::TelemetryReader(QObject *parent)
     : QObject(parent)
@@ -11,6 +66,10 @@ TelemetryReader::TelemetryReader(QObject *parent)
     , fileWatcher_(new QFileSystemWatcher(this))
     , lastTickRead_(-1)
     , isMonitoring_(false)
+    , updateIntervalMs_(50)
+    , ring_(nullptr)
+    , ringFramesRead_(0)
+    , ringIdleUpdates_(0)
 {
     // Connect timer to update function
     connect(updateTimer_, &QTimer::timeout, this, &TelemetryReader::updateFromLatestFile);
@@ -20,7 +79,7 @@ TelemetryReader::TelemetryReader(QObject *parent)
             this, &TelemetryReader::onDirectoryChanged);
     
     // Default: 50ms update interval (20Hz)
-    updateTimer_->setInterval(50);
+    updateTimer_->setInterval(updateIntervalMs_);
 }
 
 TelemetryReader::~TelemetryReader()
@@ -41,6 +100,7 @@ void TelemetryReader::startMonitoring(const QString& telemetryDir)
     
     // Reset tick counter to allow reading from a restarted backend
     lastTickRead_ = -1;
+    closeRing();
     
     // Start watching the directory
     if (!fileWatcher_->directories().contains(telemetryDir_)) {
@@ -62,13 +122,17 @@ void TelemetryReader::stopMonitoring()
         fileWatcher_->removePaths(fileWatcher_->directories());
     }
     
+    closeRing();
     isMonitoring_ = false;
     qDebug() << "Stopped monitoring telemetry";
 }
 
 void TelemetryReader::setUpdateInterval(int ms)
 {
-    updateTimer_->setInterval(ms);
+    updateIntervalMs_ = ms;
+    if (!ring_) {
+        updateTimer_->setInterval(ms);
+    }
 }
 
 std::map<int, TelemetryReader::RobotData> TelemetryReader::getCurrentRobots() const
@@ -78,14 +142,39 @@ std::map<int, TelemetryReader::RobotData> TelemetryReader::getCurrentRobots() co
 
 void TelemetryReader::onDirectoryChanged(const QString& path)
 {
+    Q_UNUSED(path);
+    if (ring_) return;  // Ring frames are polled, the directory only changes on restart
+
     // When directory changes, try to read the latest file immediately
     updateFromLatestFile();
 }
 
+QString TelemetryReader::readLatestPointer()
+{
+    QFile pointer(QDir(telemetryDir_).filePath("latest"));
+    if (!pointer.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromUtf8(pointer.readLine(256)).trimmed();
+}
+
 QString TelemetryReader::findLatestOrcaFile()
 {
     QDir dir(telemetryDir_);
     
+    // The backend points orca/latest at the newest tick file: one small read
+    QString latestName = readLatestPointer();
+    if (latestName.startsWith("orca_tick_") && latestName.endsWith(".json")) {
+        bool ok;
+        int tick = latestName.mid(10, latestName.length() - 15).toInt(&ok);
+        if (!ok || tick <= lastTickRead_) {
+            return QString();
+        }
+        lastTickRead_ = tick;
+        return dir.filePath(latestName);
+    }
+    
+    // Older backends: list the directory
     // Get all orca_tick_*.json files
     QStringList filters;
     filters << "orca_tick_*.json";
@@ -127,6 +216,16 @@ void TelemetryReader::updateFromLatestFile()
 {
     if (!isMonitoring_) return;
     
+    if (ring_ || openRing()) {
+        if (readRing()) {
+            ringIdleUpdates_ = 0;
+            emit robotsUpdated(currentRobots_);
+        } else if (++ringIdleUpdates_ >= RING_REOPEN_UPDATES) {
+            closeRing();
+        }
+        return;
+    }
+    
     QString latestFile = findLatestOrcaFile();
     if (latestFile.isEmpty()) {
         // No new data available, but keep checking
@@ -167,6 +266,11 @@ bool TelemetryReader::parseOrcaFile(const QString& filepath)
     // Read tick number (for debugging)
     int tick = root["tick"].toInt(-1);
     
+    // Frame time (local time with milliseconds); the arrival time if absent
+    QDateTime frameTime = QDateTime::fromString(root["timestamp"].toString(), Qt::ISODateWithMs);
+    qint64 timestampMs = frameTime.isValid() ? frameTime.toMSecsSinceEpoch()
+                                             : QDateTime::currentMSecsSinceEpoch();
+    
     // Read robots array
     QJsonArray robotsArray = root["robots"].toArray();
     
@@ -188,6 +292,7 @@ bool TelemetryReader::parseOrcaFile(const QString& filepath)
         robot.driverState = robotObj["driverState"].toString();
         robot.battery = robotObj["battery"].toDouble();
         robot.hasPackage = robotObj["hasPackage"].toBool();
+        robot.timestampMs = timestampMs;
         
         currentRobots_[robot.id] = robot;
     }
@@ -195,3 +300,109 @@ bool TelemetryReader::parseOrcaFile(const QString& filepath)
     //qDebug() << "Parsed tick" << tick << "with" << currentRobots_.size() << "robots";
     return true;
 }
+
+bool TelemetryReader::openRing()
+{
+    ringFile_.setFileName(QDir(telemetryDir_).filePath("telemetry.ring"));
+    if (!ringFile_.exists() || !ringFile_.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    qint64 size = ringFile_.size();
+    uchar* mapping = size >= RING_HEADER_BYTES ? ringFile_.map(0, size) : nullptr;
+    if (!mapping || std::memcmp(mapping, RING_MAGIC, sizeof(RING_MAGIC)) != 0 ||
+        readValue<quint32>(mapping + 8) != RING_VERSION) {
+        ringFile_.close();
+        return false;
+    }
+    
+    quint32 slotCount = readValue<quint32>(mapping + 16);
+    quint32 slotBytes = readValue<quint32>(mapping + 20);
+    if (slotCount == 0 || RING_HEADER_BYTES + qint64(slotCount) * slotBytes > size) {
+        ringFile_.close();
+        return false;
+    }
+    
+    ring_ = mapping;
+    ringFramesRead_ = 0;
+    ringIdleUpdates_ = 0;
+    
+    // Frames are shown as soon as the display can, not one timer period late
+    QScreen* screen = QGuiApplication::primaryScreen();
+    int pollMs = screen && screen->refreshRate() > 0 ? qMax(1, int(1000.0 / screen->refreshRate()))
+                                                     : RING_DEFAULT_POLL_MS;
+    updateTimer_->setInterval(qMin(updateIntervalMs_, pollMs));
+    qDebug() << "Reading telemetry ring:" << ringFile_.fileName();
+    return true;
+}
+
+void TelemetryReader::closeRing()
+{
+    if (ring_) {
+        ringFile_.unmap(ring_);
+        ring_ = nullptr;
+    }
+    if (ringFile_.isOpen()) {
+        ringFile_.close();
+    }
+    updateTimer_->setInterval(updateIntervalMs_);
+}
+
+bool TelemetryReader::readRing()
+{
+    quint64 framesWritten = loadSequence(ring_ + RING_FRAMES_WRITTEN_OFFSET);
+    if (framesWritten == 0 || framesWritten == ringFramesRead_) {
+        return false;
+    }
+    
+    quint32 slotCount = readValue<quint32>(ring_ + 16);
+    quint32 slotBytes = readValue<quint32>(ring_ + 20);
+    quint32 maxRobots = readValue<quint32>(ring_ + 24);
+    quint32 recordBytes = readValue<quint32>(ring_ + 28);
+    quint64 frame = framesWritten - 1;
+    const uchar* slot = ring_ + RING_HEADER_BYTES + (frame % slotCount) * slotBytes;
+    
+    // Copy the frame, then check the writer did not start over it meanwhile
+    quint64 seqFront = loadSequence(slot);
+    if (seqFront != frame + 1) {
+        return false;
+    }
+    qint64 timestampMs = readValue<qint64>(slot + 16);
+    quint32 robotCount = std::min(readValue<quint32>(slot + 24), maxRobots);
+    ringFrame_.resize(int(robotCount * recordBytes));   // Keeps its capacity between frames
+    std::memcpy(ringFrame_.data(), slot + RING_SLOT_HEADER_BYTES, size_t(ringFrame_.size()));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (loadSequence(slot + slotBytes - sizeof(quint64)) != seqFront) {
+        return false;   // Torn: the next update reads a newer frame
+    }
+    
+    // A frame almost always holds the robots of the last one: update them
+    // in place, and start over only when the fleet changed
+    auto decode = [&]() {
+        const uchar* records = reinterpret_cast<const uchar*>(ringFrame_.constData());
+        for (quint32 i = 0; i < robotCount; ++i) {
+            const uchar* at = records + i * recordBytes;
+            qint32 id = readValue<qint32>(at);
+            
+            RobotData& robot = currentRobots_[id];
+            robot.id = id;
+            robot.x = readValue<qint32>(at + 4);
+            robot.y = readValue<qint32>(at + 8);
+            robot.vx = readValue<float>(at + 12);
+            robot.vy = readValue<float>(at + 16);
+            robot.battery = readValue<float>(at + 20);
+            robot.status = ringStatusName(at[36]);
+            robot.driverState = ringDriverStateName(at[37]);
+            robot.hasPackage = at[38] != 0;
+            robot.timestampMs = timestampMs;
+        }
+    };
+    decode();
+    if (currentRobots_.size() != robotCount) {
+        currentRobots_.clear();
+        decode();
+    }
+    
+    ringFramesRead_ = framesWritten;
+    return true;
+}
@@ -2,6 +2,7 @@
 #define TELEMETRY_READER_H
 
 #include <QObject>
+#include <QFile>
 #include <QTimer>
 #include <QFileSystemWatcher>
 #include <QString>
@@ -12,10 +13,17 @@
 #include <tuple>
 
 /**
- * @brief Reads robot telemetry from backend JSON files
+ * @brief Reads robot telemetry from the backend
  * 
  * This class monitors the backend's output directory and reads
- * robot position/state data from orca_tick_*.json files
+ * robot position/state data from the shared-memory ring telemetry.ring
+ * (layout: backend/api/TelemetryRing.hh), or from orca_tick_*.json
+ * files when the backend writes those instead
+ * 
+ * The ring is polled at the display refresh rate: a poll without a new
+ * frame is one atomic load, and a new frame is decoded into the robots
+ * already held (no per-frame allocation). The JSON files are found
+ * through the orca/latest pointer, without listing the directory.
  */
 class TelemetryReader : public QObject
 {
@@ -32,6 +40,7 @@ public:
         QString driverState;
         float battery;
         bool hasPackage;
+        qint64 timestampMs;     // Backend wall clock of the frame (ms since the epoch)
     };
 
     explicit TelemetryReader(QObject *parent = nullptr);
@@ -58,6 +67,12 @@ private slots:
 private:
     bool parseOrcaFile(const QString& filepath);
     QString findLatestOrcaFile();
+    QString readLatestPointer();    // orca/latest (file name of the newest tick), or empty
+    
+    // Shared-memory ring
+    bool openRing();
+    void closeRing();
+    bool readRing();    // true if a new frame was read into currentRobots_
 
     QTimer* updateTimer_;
     QFileSystemWatcher* fileWatcher_;
@@ -65,6 +80,13 @@ private:
     std::map<int, RobotData> currentRobots_;
     int lastTickRead_;
     bool isMonitoring_;
+    int updateIntervalMs_;      // Set by setUpdateInterval (JSON files; the ring may be polled faster)
+    
+    QFile ringFile_;
+    uchar* ring_;               // Mapping of ringFile_ (nullptr = closed)
+    quint64 ringFramesRead_;    // ring framesWritten at the last frame read
+    int ringIdleUpdates_;       // Updates since the last new frame
+    QByteArray ringFrame_;      // Copy of the frame being read (reused)
 };
 
 #endif // TELEMETRY_READER_H
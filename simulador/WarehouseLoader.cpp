@@ -1,9 +1,11 @@
 #include "WarehouseLoader.h"
+#include "glm/gtc/matrix_transform.hpp"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
+#include <cmath>
 
 WarehouseLoader::WarehouseLoader() : nextRobotID(1), floorSize(30.0f, 30.0f) {
 }
@@ -192,3 +194,64 @@ void WarehouseLoader::clear() {
     nextRobotID = 1;
     floorSize = glm::vec2(30.0f, 30.0f);
 }
+
+// Model transform of a static object: its model normalised to the JSON box
+static glm::mat4 staticObjectTransform(const WarehouseObject& obj, const ModelBounds& model) {
+    glm::mat4 TG(1.0f);
+    
+    // 1. Translate to object center position
+    TG = glm::translate(TG, obj.center);
+    
+    // 2. Rotate around Y axis
+    TG = glm::rotate(TG, glm::radians(-obj.rotation), glm::vec3(0, 1, 0));
+    
+    // 3. Scale model to match JSON dimensions
+    TG = glm::scale(TG, obj.dimensions / model.dimensions);
+    
+    // 4. Center the model at origin (after scaling)
+    TG = glm::translate(TG, glm::vec3(-model.centre.x, -model.minY, -model.centre.z));
+    
+    return TG;
+}
+
+std::vector<StaticCell> WarehouseLoader::buildStaticCells(const std::vector<ModelBounds>& models, float cellSize) const {
+    std::map<std::pair<int, int>, StaticCell> grid;
+    
+    for (const auto& obj : objects) {
+        if (obj.modelIndex < 0 || obj.modelIndex >= int(models.size())) {
+            continue; // Skip invalid model indices
+        }
+        
+        // World box of the object: its footprint rotated around Y, from its base up
+        float angle = glm::radians(obj.rotation);
+        float c = std::fabs(std::cos(angle));
+        float sn = std::fabs(std::sin(angle));
+        glm::vec3 half(0.5f * (c * obj.dimensions.x + sn * obj.dimensions.z),
+                       0.5f * obj.dimensions.y,
+                       0.5f * (sn * obj.dimensions.x + c * obj.dimensions.z));
+        glm::vec3 centre = obj.center + glm::vec3(0.0f, half.y, 0.0f);
+        
+        std::pair<int, int> key(int(std::floor(obj.center.x / cellSize)), int(std::floor(obj.center.z / cellSize)));
+        auto it = grid.find(key);
+        if (it == grid.end()) {
+            StaticCell cell;
+            cell.boundsMin = centre - half;
+            cell.boundsMax = centre + half;
+            cell.instances.resize(models.size());
+            cell.spheres.resize(models.size());
+            it = grid.insert(std::make_pair(key, cell)).first;
+        }
+        StaticCell& cell = it->second;
+        cell.boundsMin = glm::min(cell.boundsMin, centre - half);
+        cell.boundsMax = glm::max(cell.boundsMax, centre + half);
+        cell.instances[obj.modelIndex].push_back(staticObjectTransform(obj, models[obj.modelIndex]));
+        cell.spheres[obj.modelIndex].push_back(glm::vec4(centre, glm::length(half)));
+    }
+    
+    std::vector<StaticCell> cells;
+    cells.reserve(grid.size());
+    for (auto& entry : grid) {
+        cells.push_back(std::move(entry.second));
+    }
+    return cells;
+}
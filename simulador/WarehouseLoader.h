@@ -16,6 +16,23 @@ struct WarehouseObject {
     WarehouseObject() : modelIndex(0), center(0.0f), dimensions(1.0f), rotation(0.0f) {}
 };
 
+// Normalization of a model (its bounding box); see SimuladorGLWidget::calculaCapsaModel
+struct ModelBounds {
+    glm::vec3 centre;         // Centre of the bounding box
+    float minY;               // Bottom of the bounding box
+    glm::vec3 dimensions;     // Size of the bounding box
+};
+
+// One cell of the static object grid: the transforms of the objects whose
+// centre falls inside it, by model index, with a bounding sphere each
+// (centre, radius) and the box around all of them
+struct StaticCell {
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    std::vector<std::vector<glm::mat4>> instances;
+    std::vector<std::vector<glm::vec4>> spheres;
+};
+
 struct RobotData {
     float x;                  // X position
     float y;                  // Y position (Z in world coordinates)
@@ -55,6 +72,11 @@ public:
     // Get all picking zones
     const std::vector<PickingZone>& getPickingZones() const { return pickingZones; }
     
+    // Model transforms of the static objects by model index, bucketed in a
+    // grid of cellSize x cellSize floor cells so the widget can cull whole
+    // cells (objects with an invalid index and empty cells are left out)
+    std::vector<StaticCell> buildStaticCells(const std::vector<ModelBounds>& models, float cellSize) const;
+    
     // Clear all data
     void clear();
     
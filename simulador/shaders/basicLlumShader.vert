@@ -8,9 +8,12 @@ in vec3 matdiff;
 in vec3 matspec;
 in float matshin;
 
+in mat4 instanceTG;     // Model transform per instance (instanced draws)
+
 uniform mat4 proj;
 uniform mat4 view;
 uniform mat4 TG;
+uniform bool instanced; // true: use instanceTG instead of TG
 uniform vec3 colorMul;  // Add color multiplier uniform
 
 out vec4 vertexSCO;
@@ -28,8 +31,9 @@ void main()
     fmatspec = matspec * colorMul;
     fmatshin = matshin;
     
-    mat3 normalMatrix = inverse(transpose(mat3 (view * TG)));
+    mat4 model = instanced ? instanceTG : TG;
+    mat3 normalMatrix = inverse(transpose(mat3 (view * model)));
     normalSCO = vec3(normalMatrix * normal);
-    vertexSCO = view * TG * vec4 (vertex, 1.0);
-    gl_Position = proj * view * TG * vec4 (vertex, 1.0);
+    vertexSCO = view * model * vec4 (vertex, 1.0);
+    gl_Position = proj * view * model * vec4 (vertex, 1.0);
 }
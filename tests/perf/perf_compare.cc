@@ -0,0 +1,396 @@
+/**
+ * @file perf_compare.cc
+ * @brief Compares a perf-check run against the checked-in baseline
+ *
+ * Reads kernels.json (backend/kernel_benchmark) and stress.json
+ * (backend/fleet_stress) from a baseline directory and a results
+ * directory, prints one line per kernel and per stress metric, and exits
+ * with 1 if any of them regressed past its threshold.
+ *
+ * Kernels compare median ns/op. Their threshold is noise-aware: the larger
+ * of --min-tolerance and --noise-factor times the coefficient of variation
+ * of the slower of the two runs, so a kernel that jitters by 8% needs to
+ * slow down by 24% before it fails while a stable one fails at 15%.
+ *
+ * Stress runs have one sample per fleet size, so each metric has a fixed
+ * relative tolerance plus an absolute floor below which differences are
+ * noise (a tick p99 going from 0.02 to 0.05 ms is not a regression).
+ * Throughput counts completed tasks, so its threshold is at least
+ * --noise-factor / sqrt(tasks completed in the baseline): a run of 20
+ * tasks needs to lose two thirds of them, one of 400 a fifth.
+ * A run with no background replan fails outright: its replan metrics are
+ * zero, so the replan p99 gate would pass without measuring anything.
+ *
+ * Usage:
+ *   ./build/perf_compare perf/baseline perf/results/<commit>
+ *
+ * Options (after the two directories):
+ *   --min-tolerance F          Smallest kernel threshold (default 0.15)
+ *   --noise-factor K           Kernel threshold in coefficients of variation (default 3)
+ *   --stress-scale S           Multiplies every stress tolerance (default 1)
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// FLAT JSON
+// =============================================================================
+
+/**
+ * @brief A JSON document flattened to path -> scalar, e.g.
+ *        "benchmarks[2].median_ns" -> "812.3" (strings without quotes).
+ *
+ * Enough for the benchmark outputs, which are written by hand and carry
+ * no escapes.
+ */
+class FlatJSON {
+public:
+    bool Load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) return false;
+        text_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        pos_ = 0;
+        values_.clear();
+        return ParseValue("") && (SkipSpace(), pos_ == text_.size());
+    }
+
+    bool Has(const std::string& key) const { return values_.count(key) > 0; }
+
+    std::string Get(const std::string& key) const {
+        auto it = values_.find(key);
+        return it == values_.end() ? std::string() : it->second;
+    }
+
+    double Number(const std::string& key) const { return std::atof(Get(key).c_str()); }
+
+private:
+    std::string text_;
+    size_t pos_ = 0;
+    std::map<std::string, std::string> values_;
+
+    void SkipSpace() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+    }
+
+    bool ParseString(std::string& out) {
+        if (pos_ >= text_.size() || text_[pos_] != '"') return false;
+        size_t end = text_.find('"', pos_ + 1);
+        if (end == std::string::npos) return false;
+        out = text_.substr(pos_ + 1, end - pos_ - 1);
+        pos_ = end + 1;
+        return true;
+    }
+
+    bool ParseValue(const std::string& path) {
+        SkipSpace();
+        if (pos_ >= text_.size()) return false;
+        char c = text_[pos_];
+        if (c == '{') {
+            ++pos_;
+            SkipSpace();
+            if (pos_ < text_.size() && text_[pos_] == '}') return ++pos_, true;
+            while (true) {
+                SkipSpace();
+                std::string key;
+                if (!ParseString(key)) return false;
+                SkipSpace();
+                if (pos_ >= text_.size() || text_[pos_++] != ':') return false;
+                if (!ParseValue(path.empty() ? key : path + "." + key)) return false;
+                SkipSpace();
+                if (pos_ < text_.size() && text_[pos_] == ',') { ++pos_; continue; }
+                if (pos_ < text_.size() && text_[pos_] == '}') return ++pos_, true;
+                return false;
+            }
+        }
+        if (c == '[') {
+            ++pos_;
+            SkipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ']') return ++pos_, true;
+            for (int index = 0;; ++index) {
+                if (!ParseValue(path + "[" + std::to_string(index) + "]")) return false;
+                SkipSpace();
+                if (pos_ < text_.size() && text_[pos_] == ',') { ++pos_; continue; }
+                if (pos_ < text_.size() && text_[pos_] == ']') return ++pos_, true;
+                return false;
+            }
+        }
+        if (c == '"') {
+            std::string value;
+            if (!ParseString(value)) return false;
+            values_[path] = value;
+            return true;
+        }
+        size_t start = pos_;
+        while (pos_ < text_.size() && text_[pos_] != ',' && text_[pos_] != '}' && text_[pos_] != ']' &&
+               !std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+        if (pos_ == start) return false;
+        values_[path] = text_.substr(start, pos_ - start);
+        return true;
+    }
+};
+
+// =============================================================================
+// COMPARISON
+// =============================================================================
+
+struct CompareOptions {
+    std::string baselineDir;
+    std::string resultsDir;
+    double minTolerance = 0.15;
+    double noiseFactor = 3.0;
+    double stressScale = 1.0;
+};
+
+/// One stress metric; tolerance is relative, floor absolute (metric units)
+struct StressMetric {
+    std::string key;
+    std::string label;
+    std::string unit;
+    bool higherIsBetter;
+    double tolerance;
+    double floor;
+    bool counted;                       ///< Proportional to completed tasks (Poisson noise)
+};
+
+// Tolerances from the spread of repeated runs on one machine: inline path
+// planning keeps throughput within ~10%, tail latencies move by a third.
+// Path queries are too few per run for a stable p99, so their mean is used.
+// A run has a handful of background solves whose batches depend on how far
+// the simulation got while the last one ran, so their p99 (the slowest)
+// spreads up to threefold and only a doubling fails
+const std::vector<StressMetric> STRESS_METRICS = {
+    {"wall_s", "wall time", "s", false, 0.30, 0.5, false},
+    {"throughput_per_hour", "throughput", "tasks/h", true, 0.20, 0.0, true},
+    {"physics_tick.mean_ms", "physics tick mean", "ms", false, 0.30, 0.05, false},
+    {"physics_tick.p99_ms", "physics tick p99", "ms", false, 0.50, 1.0, false},
+    {"main_tick.p99_ms", "strategic tick p99", "ms", false, 0.50, 2.0, false},
+    {"replan_solve.p99_ms", "replan p99", "ms", false, 1.00, 10.0, false},
+    {"path_query.mean_ms", "path query mean", "ms", false, 0.50, 0.5, false},
+    {"peak_rss_kb", "peak RSS", "KB", false, 0.25, 4096.0, false},
+};
+
+struct Summary {
+    int compared = 0;
+    int regressions = 0;
+    int improvements = 0;
+    int missing = 0;
+};
+
+std::string Percent(double fraction) {
+    std::ostringstream out;
+    out << std::showpos << std::fixed << std::setprecision(1) << fraction * 100.0 << "%";
+    return out.str();
+}
+
+std::string Verdict(double change, double threshold, bool beyondFloor) {
+    if (!beyondFloor) return "ok";
+    if (change > threshold) return "REGRESSED";
+    if (change < -threshold) return "improved";
+    return "ok";
+}
+
+void Tally(const std::string& verdict, Summary& summary) {
+    ++summary.compared;
+    if (verdict == "REGRESSED") ++summary.regressions;
+    if (verdict == "improved") ++summary.improvements;
+}
+
+void CompareKernels(const FlatJSON& baseline, const FlatJSON& current, const CompareOptions& options,
+                    Summary& summary) {
+    std::map<std::string, int> currentIndex;
+    for (int i = 0; current.Has("benchmarks[" + std::to_string(i) + "].name"); ++i) {
+        currentIndex[current.Get("benchmarks[" + std::to_string(i) + "].name")] = i;
+    }
+
+    std::cout << "Kernels (median ns/op; threshold = max(" << Percent(options.minTolerance).substr(1)
+              << ", " << options.noiseFactor << " x CV))\n";
+    std::cout << "  " << std::left << std::setw(34) << "kernel" << std::right << std::setw(12) << "baseline"
+              << std::setw(12) << "current" << std::setw(10) << "change" << std::setw(11) << "threshold"
+              << "  verdict\n";
+    for (int i = 0; baseline.Has("benchmarks[" + std::to_string(i) + "].name"); ++i) {
+        std::string prefix = "benchmarks[" + std::to_string(i) + "].";
+        std::string name = baseline.Get(prefix + "name");
+        auto it = currentIndex.find(name);
+        if (it == currentIndex.end()) {
+            std::cout << "  " << std::left << std::setw(34) << name << std::right << "  missing from this run\n";
+            ++summary.missing;
+            continue;
+        }
+        std::string currentPrefix = "benchmarks[" + std::to_string(it->second) + "].";
+        double base = baseline.Number(prefix + "median_ns");
+        double now = current.Number(currentPrefix + "median_ns");
+        auto cv = [](const FlatJSON& json, const std::string& at) {
+            double mean = json.Number(at + "mean_ns");
+            return mean > 0.0 ? json.Number(at + "stddev_ns") / mean : 0.0;
+        };
+        double noise = std::max(cv(baseline, prefix), cv(current, currentPrefix));
+        double threshold = std::max(options.minTolerance, options.noiseFactor * noise);
+        double change = base > 0.0 ? (now - base) / base : 0.0;
+        std::string verdict = Verdict(change, threshold, base > 0.0);
+        Tally(verdict, summary);
+
+        std::cout << "  " << std::left << std::setw(34) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << base << std::setw(12) << now << std::setw(10)
+                  << Percent(change) << std::setw(11) << Percent(threshold).substr(1) << "  " << verdict << "\n";
+        currentIndex.erase(it);
+    }
+    for (const auto& extra : currentIndex) {
+        std::cout << "  " << std::left << std::setw(34) << extra.first << std::right << "  new (no baseline)\n";
+    }
+}
+
+void CompareStress(const FlatJSON& baseline, const FlatJSON& current, const CompareOptions& options,
+                   Summary& summary) {
+    std::map<int, int> currentIndex;
+    for (int i = 0; current.Has("runs[" + std::to_string(i) + "].robots"); ++i) {
+        currentIndex[static_cast<int>(current.Number("runs[" + std::to_string(i) + "].robots"))] = i;
+    }
+
+    std::cout << "Stress (per fleet size; thresholds per metric";
+    if (options.stressScale != 1.0) std::cout << " x " << options.stressScale;
+    std::cout << ")\n";
+    std::cout << "  " << std::left << std::setw(34) << "scenario" << std::right << std::setw(12) << "baseline"
+              << std::setw(12) << "current" << std::setw(10) << "change" << std::setw(11) << "threshold"
+              << "  verdict\n";
+    for (int i = 0; baseline.Has("runs[" + std::to_string(i) + "].robots"); ++i) {
+        std::string prefix = "runs[" + std::to_string(i) + "].";
+        int robots = static_cast<int>(baseline.Number(prefix + "robots"));
+        std::string scenario = std::to_string(robots) + " robots";
+        auto it = currentIndex.find(robots);
+        if (it == currentIndex.end()) {
+            std::cout << "  " << std::left << std::setw(34) << scenario << std::right << "  missing from this run\n";
+            ++summary.missing;
+            continue;
+        }
+        std::string currentPrefix = "runs[" + std::to_string(it->second) + "].";
+        if (current.Get(currentPrefix + "cut_short") == "true") {
+            std::cout << "  " << std::left << std::setw(34) << scenario << std::right
+                      << "  cut short by --max-wall (REGRESSED)\n";
+            ++summary.compared;
+            ++summary.regressions;
+            continue;
+        }
+        if (current.Number(currentPrefix + "replan_solve.count") <= 0.0) {
+            std::cout << "  " << std::left << std::setw(34) << scenario << std::right
+                      << "  no background replans ran (REGRESSED)\n";
+            ++summary.compared;
+            ++summary.regressions;
+            continue;
+        }
+        for (const auto& metric : STRESS_METRICS) {
+            if (!baseline.Has(prefix + metric.key) || !current.Has(currentPrefix + metric.key)) continue;
+            double base = baseline.Number(prefix + metric.key);
+            double now = current.Number(currentPrefix + metric.key);
+            double threshold = metric.tolerance * options.stressScale;
+            if (metric.counted) {
+                double completed = baseline.Number(prefix + "completed");
+                threshold = std::max(threshold, completed > 0.0 ? options.noiseFactor / std::sqrt(completed) : 1.0);
+            }
+            // Worse is positive either way round
+            double change = base > 0.0 ? (now - base) / base : 0.0;
+            double worse = metric.higherIsBetter ? -change : change;
+            bool beyondFloor = base > 0.0 && std::fabs(now - base) > metric.floor;
+            std::string verdict = Verdict(worse, threshold, beyondFloor);
+            Tally(verdict, summary);
+
+            std::cout << "  " << std::left << std::setw(34) << (scenario + " " + metric.label) << std::right
+                      << std::fixed << std::setprecision(2) << std::setw(12) << base << std::setw(12) << now
+                      << std::setw(10) << Percent(change) << std::setw(11) << Percent(threshold).substr(1)
+                      << "  " << verdict << (verdict == "ok" ? "" : " (" + metric.unit + ")") << "\n";
+        }
+    }
+}
+
+/// Results measured on another machine are not comparable; say so up front
+void CheckMachine(const FlatJSON& baseline, const FlatJSON& current, const std::string& what) {
+    if (baseline.Get("hardware_threads") != current.Get("hardware_threads")) {
+        std::cout << "WARNING: " << what << " baseline was recorded with " << baseline.Get("hardware_threads")
+                  << " hardware threads, this run has " << current.Get("hardware_threads")
+                  << " (refresh it with make perf-baseline)\n";
+    }
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+bool ParseArguments(int argc, char** argv, CompareOptions& options) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " BASELINE_DIR RESULTS_DIR [--min-tolerance F] "
+                  << "[--noise-factor K] [--stress-scale S]\n";
+        return false;
+    }
+    options.baselineDir = argv[1];
+    options.resultsDir = argv[2];
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--min-tolerance") {
+            options.minTolerance = std::max(0.0, std::atof(value.c_str()));
+        } else if (arg == "--noise-factor") {
+            options.noiseFactor = std::max(0.0, std::atof(value.c_str()));
+        } else if (arg == "--stress-scale") {
+            options.stressScale = std::max(0.0, std::atof(value.c_str()));
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    CompareOptions options;
+    if (!ParseArguments(argc, argv, options)) return 2;
+
+    Summary summary;
+    const std::vector<std::string> suites = {"kernels.json", "stress.json"};
+    for (const auto& suite : suites) {
+        FlatJSON baseline;
+        FlatJSON current;
+        if (!baseline.Load(options.baselineDir + "/" + suite)) {
+            std::cout << "No baseline " << options.baselineDir << "/" << suite << ", skipped\n\n";
+            continue;
+        }
+        if (!current.Load(options.resultsDir + "/" + suite)) {
+            std::cerr << "Could not read " << options.resultsDir << "/" << suite << "\n";
+            return 2;
+        }
+        std::cout << suite << ": baseline " << baseline.Get("label") << " (" << baseline.Get("timestamp")
+                  << "), current " << current.Get("label") << " (" << current.Get("timestamp") << ")\n";
+        CheckMachine(baseline, current, suite);
+        if (suite == "kernels.json") {
+            CompareKernels(baseline, current, options, summary);
+        } else {
+            CompareStress(baseline, current, options, summary);
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << summary.compared << " compared, " << summary.regressions << " regressed, "
+              << summary.improvements << " improved";
+    if (summary.missing > 0) std::cout << ", " << summary.missing << " missing";
+    std::cout << "\n";
+    if (summary.regressions > 0 || summary.missing > 0) {
+        std::cout << "PERF CHECK FAILED\n";
+        return 1;
+    }
+    std::cout << "PERF CHECK PASSED\n";
+    return 0;
+}